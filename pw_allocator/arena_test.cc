@@ -0,0 +1,114 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/arena.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw::allocator {
+namespace {
+
+struct Pair {
+  uint32_t first;
+  uint64_t second;
+};
+
+TEST(Arena, AllocatesInOrder) {
+  alignas(8) std::byte buffer[64];
+  Arena arena(buffer);
+
+  void* first = arena.Allocate(8, 8);
+  void* second = arena.Allocate(8, 8);
+  EXPECT_EQ(first, &buffer[0]);
+  EXPECT_EQ(second, &buffer[8]);
+  EXPECT_EQ(arena.used(), 16u);
+  EXPECT_EQ(arena.available(), 48u);
+}
+
+TEST(Arena, AlignsAllocations) {
+  alignas(8) std::byte buffer[64];
+  Arena arena(buffer);
+
+  ASSERT_NE(arena.Allocate(1, 1), nullptr);
+  void* aligned = arena.Allocate(4, 8);
+  EXPECT_EQ(aligned, &buffer[8]);
+
+  Pair* pair = arena.New<Pair>(Pair{1, 2});
+  ASSERT_NE(pair, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(pair) % alignof(Pair), 0u);
+  EXPECT_EQ(pair->first, 1u);
+  EXPECT_EQ(pair->second, 2u);
+}
+
+TEST(Arena, ReturnsNullWhenFull) {
+  alignas(8) std::byte buffer[32];
+  Arena arena(buffer);
+
+  EXPECT_NE(arena.Allocate(24, 8), nullptr);
+  EXPECT_EQ(arena.Allocate(16, 8), nullptr);
+  EXPECT_NE(arena.Allocate(8, 8), nullptr);
+  EXPECT_EQ(arena.Allocate(1, 1), nullptr);
+  EXPECT_EQ(arena.Allocate(SIZE_MAX, 1), nullptr);
+}
+
+TEST(Arena, NewArray) {
+  alignas(8) std::byte buffer[64];
+  Arena arena(buffer);
+
+  std::span<uint32_t> values = arena.NewArray<uint32_t>(4);
+  ASSERT_EQ(values.size(), 4u);
+  for (uint32_t value : values) {
+    EXPECT_EQ(value, 0u);
+  }
+
+  EXPECT_TRUE(arena.NewArray<uint32_t>(100).empty());
+  EXPECT_TRUE(arena.NewArray<uint64_t>(SIZE_MAX / 4).empty());
+}
+
+TEST(Arena, CheckpointRollsBack) {
+  alignas(8) std::byte buffer[64];
+  Arena arena(buffer);
+
+  ASSERT_NE(arena.Allocate(8, 8), nullptr);
+  {
+    Arena::Checkpoint checkpoint(arena);
+    ASSERT_NE(arena.Allocate(16, 8), nullptr);
+    {
+      Arena::Checkpoint nested(arena);
+      ASSERT_NE(arena.Allocate(16, 8), nullptr);
+      EXPECT_EQ(arena.used(), 40u);
+    }
+    EXPECT_EQ(arena.used(), 24u);
+  }
+  EXPECT_EQ(arena.used(), 8u);
+  EXPECT_EQ(arena.peak_used(), 40u);
+
+  // Memory released by the checkpoint is reused.
+  EXPECT_EQ(arena.Allocate(8, 8), &buffer[8]);
+}
+
+TEST(Arena, Reset) {
+  alignas(8) std::byte buffer[64];
+  Arena arena(buffer);
+
+  ASSERT_NE(arena.Allocate(64, 1), nullptr);
+  arena.Reset();
+  EXPECT_EQ(arena.used(), 0u);
+  EXPECT_EQ(arena.Allocate(64, 1), &buffer[0]);
+}
+
+}  // namespace
+}  // namespace pw::allocator
@@ -0,0 +1,89 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Allocates and frees blocks from a FreeListHeap, both on an empty heap and on
+// a fragmented one where frees merge with free neighbors.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "pw_allocator/freelist_heap.h"
+#include "pw_benchmark/benchmark.h"
+
+namespace pw::allocator {
+namespace {
+
+using benchmark::DoNotOptimize;
+
+constexpr size_t kHeapSize = 16 * 1024;
+constexpr size_t kLiveAllocations = 64;
+
+alignas(Block) std::array<std::byte, kHeapSize> heap_buffer;
+
+void AllocateFree(benchmark::State& state, size_t size) {
+  FreeListHeapBuffer heap(heap_buffer);
+
+  size_t failures = 0;
+  for (auto _ : state) {
+    void* ptr = heap.Allocate(size);
+    DoNotOptimize(ptr);
+    if (ptr == nullptr) {
+      failures += 1;
+    } else {
+      heap.Free(ptr);
+    }
+  }
+  EXPECT_EQ(failures, 0u);
+}
+
+PW_BENCHMARK(FreeListHeap, AllocateFree_32B) { AllocateFree(state, 32); }
+PW_BENCHMARK(FreeListHeap, AllocateFree_256B) { AllocateFree(state, 256); }
+
+PW_BENCHMARK(FreeListHeap, AllocateFree_Fragmented) {
+  FreeListHeapBuffer heap(heap_buffer);
+  std::array<void*, kLiveAllocations> live;
+
+  uint32_t random = 1;
+  const auto next_random = [&random] {
+    random = random * 1664525u + 1013904223u;
+    return random >> 8;
+  };
+
+  for (void*& ptr : live) {
+    ptr = heap.Allocate(8 + next_random() % 120);
+    ASSERT_NE(ptr, nullptr);
+  }
+
+  size_t failures = 0;
+  for (auto _ : state) {
+    void*& ptr = live[next_random() % kLiveAllocations];
+    if (ptr != nullptr) {
+      heap.Free(ptr);
+    }
+    ptr = heap.Allocate(8 + next_random() % 120);
+    failures += ptr == nullptr ? 1 : 0;
+  }
+  EXPECT_EQ(failures, 0u);
+
+  for (void* ptr : live) {
+    if (ptr != nullptr) {
+      heap.Free(ptr);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace pw::allocator
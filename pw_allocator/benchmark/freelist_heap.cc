@@ -0,0 +1,107 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures FreeListHeap allocation and free throughput on alloc/free-heavy
+// workloads. Each workload keeps a set of live allocations and repeatedly
+// frees one and allocates a replacement, so frees frequently merge with free
+// neighbors that must be removed from the free list. Build for a device target
+// to measure on a microcontroller.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_allocator/freelist_heap.h"
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+
+namespace {
+
+using pw::allocator::Block;
+using pw::allocator::FreeListHeapBuffer;
+
+constexpr size_t kHeapSize = 256 * 1024;
+constexpr size_t kLiveAllocations = 512;
+constexpr size_t kOperations = 200000;
+
+alignas(Block) std::array<std::byte, kHeapSize> heap_buffer;
+std::array<void*, kLiveAllocations> live;
+
+uint32_t random_state = 1;
+
+uint32_t Random() {
+  random_state = random_state * 1664525u + 1013904223u;
+  return random_state >> 8;
+}
+
+struct Workload {
+  const char* name;
+  size_t min_size;
+  size_t max_size;
+};
+
+constexpr Workload kWorkloads[] = {
+    {"small (8-64 B)", 8, 64},
+    {"mixed (8-512 B)", 8, 512},
+    {"large (128-512 B)", 128, 512},
+};
+
+size_t RandomSize(const Workload& workload) {
+  return workload.min_size +
+         Random() % (workload.max_size - workload.min_size + 1);
+}
+
+void Run(const Workload& workload) {
+  FreeListHeapBuffer heap(heap_buffer);
+  random_state = 1;
+
+  for (void*& ptr : live) {
+    ptr = heap.Allocate(RandomSize(workload));
+    PW_CHECK_NOTNULL(ptr);
+  }
+
+  const auto start = pw::chrono::SystemClock::now();
+  for (size_t i = 0; i < kOperations; ++i) {
+    void*& ptr = live[Random() % kLiveAllocations];
+    heap.Free(ptr);
+    ptr = heap.Allocate(RandomSize(workload));
+    PW_CHECK_NOTNULL(ptr);
+  }
+  const auto elapsed = pw::chrono::SystemClock::now() - start;
+
+  for (void* ptr : live) {
+    heap.Free(ptr);
+  }
+
+  const auto nanoseconds =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+  PW_LOG_INFO("%-20s %6ld ns per free + allocate",
+              workload.name,
+              static_cast<long>(nanoseconds.count() / kOperations));
+}
+
+}  // namespace
+
+int main() {
+  PW_LOG_INFO("%u free/allocate pairs with %u live allocations",
+              static_cast<unsigned>(kOperations),
+              static_cast<unsigned>(kLiveAllocations));
+
+  for (const Workload& workload : kWorkloads) {
+    Run(workload);
+  }
+  return 0;
+}
@@ -0,0 +1,97 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/block_cache.h"
+
+#include <new>
+
+#include "pw_allocator/block.h"
+
+namespace pw::allocator {
+namespace {
+
+// Returns the index of the smallest class that can hold size bytes.
+size_t ClassForRequest(size_t size) {
+  size_t index = 0;
+  for (size_t class_size = BlockCache::kMinSize; class_size < size;
+       class_size *= 2) {
+    index += 1;
+  }
+  return index;
+}
+
+}  // namespace
+
+void* BlockCache::Take(size_t size) {
+  if (size > kMaxSize) {
+    return nullptr;
+  }
+
+  SizeClass& size_class = classes_[ClassForRequest(size)];
+  FreeBlock* block = size_class.head;
+  if (block == nullptr) {
+    return nullptr;
+  }
+  size_class.head = block->next;
+  size_class.count -= 1;
+  return block;
+}
+
+bool BlockCache::Put(void* ptr) {
+  const size_t inner_size =
+      Block::FromUsableSpace(static_cast<std::byte*>(ptr))->InnerSize();
+
+  // File the block under the largest class it can hold. Blocks much larger
+  // than the largest class are left to the heap so that they can be reused
+  // for large requests.
+  if (inner_size < kMinSize || inner_size >= 2 * kMaxSize) {
+    return false;
+  }
+  size_t index = 0;
+  for (size_t class_size = kMinSize * 2;
+       class_size <= inner_size && index + 1 < kNumClasses;
+       class_size *= 2) {
+    index += 1;
+  }
+
+  SizeClass& size_class = classes_[index];
+  if (size_class.count == kMaxBlocksPerClass) {
+    return false;
+  }
+  size_class.head = new (ptr) FreeBlock{size_class.head};
+  size_class.count += 1;
+  return true;
+}
+
+void* BlockCache::TakeAny() {
+  for (SizeClass& size_class : classes_) {
+    if (size_class.head != nullptr) {
+      FreeBlock* block = size_class.head;
+      size_class.head = block->next;
+      size_class.count -= 1;
+      return block;
+    }
+  }
+  return nullptr;
+}
+
+size_t BlockCache::size() const {
+  size_t total = 0;
+  for (const SizeClass& size_class : classes_) {
+    total += size_class.count;
+  }
+  return total;
+}
+
+}  // namespace pw::allocator
@@ -0,0 +1,124 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/block_cache.h"
+
+#include <array>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_allocator/freelist_heap.h"
+
+namespace pw::allocator {
+namespace {
+
+class BlockCacheTest : public ::testing::Test {
+ protected:
+  BlockCacheTest() : heap_(buffer_) {}
+
+  alignas(Block) std::byte buffer_[4096] = {};
+  FreeListHeapBuffer<> heap_;
+  BlockCache cache_;
+};
+
+TEST(BlockCache, RoundUp) {
+  EXPECT_EQ(BlockCache::RoundUp(1), 16u);
+  EXPECT_EQ(BlockCache::RoundUp(16), 16u);
+  EXPECT_EQ(BlockCache::RoundUp(17), 32u);
+  EXPECT_EQ(BlockCache::RoundUp(200), 256u);
+  EXPECT_EQ(BlockCache::RoundUp(256), 256u);
+  EXPECT_EQ(BlockCache::RoundUp(257), 257u);
+}
+
+TEST_F(BlockCacheTest, Empty) {
+  EXPECT_EQ(cache_.size(), 0u);
+  EXPECT_EQ(cache_.Take(16), nullptr);
+  EXPECT_EQ(cache_.TakeAny(), nullptr);
+}
+
+TEST_F(BlockCacheTest, PutThenTake_ReturnsSameBlock) {
+  void* ptr = heap_.Allocate(BlockCache::RoundUp(20));
+  ASSERT_NE(ptr, nullptr);
+
+  ASSERT_TRUE(cache_.Put(ptr));
+  EXPECT_EQ(cache_.size(), 1u);
+
+  EXPECT_EQ(cache_.Take(16), nullptr);  // Different class.
+  EXPECT_EQ(cache_.Take(25), ptr);
+  EXPECT_EQ(cache_.size(), 0u);
+  heap_.Free(ptr);
+}
+
+TEST_F(BlockCacheTest, TakenBlocksHoldTheRequest) {
+  for (size_t size = 1; size <= BlockCache::kMaxSize; size += 7) {
+    void* ptr = heap_.Allocate(BlockCache::RoundUp(size));
+    ASSERT_NE(ptr, nullptr);
+    ASSERT_TRUE(cache_.Put(ptr));
+
+    void* taken = cache_.Take(size);
+    ASSERT_EQ(taken, ptr);
+    Block* block = Block::FromUsableSpace(static_cast<std::byte*>(taken));
+    EXPECT_GE(block->InnerSize(), size);
+    heap_.Free(taken);
+  }
+}
+
+TEST_F(BlockCacheTest, LargeBlock_NotCached) {
+  void* ptr = heap_.Allocate(2 * BlockCache::kMaxSize);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_FALSE(cache_.Put(ptr));
+  EXPECT_EQ(cache_.size(), 0u);
+  EXPECT_EQ(cache_.Take(BlockCache::kMaxSize + 1), nullptr);
+  heap_.Free(ptr);
+}
+
+TEST_F(BlockCacheTest, FullClass_RejectsBlocks) {
+  std::array<void*, BlockCache::kMaxBlocksPerClass + 1> blocks;
+  for (void*& ptr : blocks) {
+    ptr = heap_.Allocate(BlockCache::RoundUp(32));
+    ASSERT_NE(ptr, nullptr);
+  }
+
+  for (size_t i = 0; i < BlockCache::kMaxBlocksPerClass; ++i) {
+    EXPECT_TRUE(cache_.Put(blocks[i]));
+  }
+  EXPECT_FALSE(cache_.Put(blocks.back()));
+  EXPECT_EQ(cache_.size(), BlockCache::kMaxBlocksPerClass);
+  heap_.Free(blocks.back());
+
+  // Blocks come back most recently cached first.
+  for (size_t i = BlockCache::kMaxBlocksPerClass; i > 0; --i) {
+    EXPECT_EQ(cache_.Take(32), blocks[i - 1]);
+    heap_.Free(blocks[i - 1]);
+  }
+}
+
+TEST_F(BlockCacheTest, TakeAny_EmptiesCache) {
+  void* small = heap_.Allocate(BlockCache::RoundUp(8));
+  void* large = heap_.Allocate(BlockCache::RoundUp(100));
+  ASSERT_TRUE(cache_.Put(small));
+  ASSERT_TRUE(cache_.Put(large));
+
+  size_t freed = 0;
+  while (void* ptr = cache_.TakeAny()) {
+    heap_.Free(ptr);
+    freed += 1;
+  }
+  EXPECT_EQ(freed, 2u);
+  EXPECT_EQ(cache_.size(), 0u);
+  EXPECT_EQ(heap_.heap_stats().bytes_allocated, 0u);
+}
+
+}  // namespace
+}  // namespace pw::allocator
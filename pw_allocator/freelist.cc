@@ -31,9 +31,13 @@ Status FreeList::AddChunk(std::span<std::byte> chunk) {
 
   size_t chunk_ptr = FindChunkPtrForSize(chunk.size(), false);
 
-  // Add it to the correct list.
+  // Add it to the front of the correct list.
   aliased.node->size = chunk.size();
   aliased.node->next = chunks_[chunk_ptr];
+  aliased.node->prev = nullptr;
+  if (aliased.node->next != nullptr) {
+    aliased.node->next->prev = aliased.node;
+  }
   chunks_[chunk_ptr] = aliased.node;
 
   return OkStatus();
@@ -75,41 +79,32 @@ std::span<std::byte> FreeList::FindChunk(size_t size) const {
 }
 
 Status FreeList::RemoveChunk(std::span<std::byte> chunk) {
-  size_t chunk_ptr = FindChunkPtrForSize(chunk.size(), true);
+  // Chunks too small to hold a node are never added.
+  if (chunk.size() < sizeof(FreeListNode)) {
+    return Status::NotFound();
+  }
 
-  // Walk that list, finding the chunk.
   union {
     FreeListNode* node;
     std::byte* data;
-  } aliased, aliased_next;
+  } aliased;
+  aliased.data = chunk.data();
+  FreeListNode* node = aliased.node;
 
-  // Check head first.
-  if (chunks_[chunk_ptr] == nullptr) {
+  // The node's neighbors (or the bucket head) must link back to it. This
+  // catches chunks that are not in the list without walking the bucket.
+  size_t chunk_ptr = FindChunkPtrForSize(chunk.size(), false);
+  FreeListNode*& link =
+      node->prev == nullptr ? chunks_[chunk_ptr] : node->prev->next;
+  if (node->size != chunk.size() || link != node) {
     return Status::NotFound();
   }
 
-  aliased.node = chunks_[chunk_ptr];
-  if (aliased.data == chunk.data()) {
-    chunks_[chunk_ptr] = aliased.node->next;
-
-    return OkStatus();
+  link = node->next;
+  if (node->next != nullptr) {
+    node->next->prev = node->prev;
   }
-
-  // No? Walk the nodes.
-  aliased.node = chunks_[chunk_ptr];
-
-  while (aliased.node->next != nullptr) {
-    aliased_next.node = aliased.node->next;
-    if (aliased_next.data == chunk.data()) {
-      // Found it, remove this node out of the chain
-      aliased.node->next = aliased_next.node->next;
-      return OkStatus();
-    }
-
-    aliased.node = aliased.node->next;
-  }
-
-  return Status::NotFound();
+  return OkStatus();
 }
 
 size_t FreeList::FindChunkPtrForSize(size_t size, bool non_null) const {
@@ -14,15 +14,17 @@
 
 #include "pw_allocator/freelist_heap.h"
 
+#include <algorithm>
 #include <cstring>
 
+#include "pw_allocator/freelist_heap_metrics.h"
 #include "pw_assert/check.h"
 #include "pw_log/log.h"
 
 namespace pw::allocator {
 
 FreeListHeap::FreeListHeap(std::span<std::byte> region, FreeList& freelist)
-    : freelist_(freelist), heap_stats_() {
+    : freelist_(freelist), heap_stats_(), metrics_(nullptr) {
   Block* block;
   PW_CHECK_OK(
       Block::Init(region, &block),
@@ -36,10 +38,12 @@ FreeListHeap::FreeListHeap(std::span<std::byte> region, FreeList& freelist)
 
 void* FreeListHeap::Allocate(size_t size) {
   // Find a chunk in the freelist. Split it if needed, then return
+  heap_stats_.allocation_sizes[SizeBucket(size)] += 1;
 
   auto chunk = freelist_.FindChunk(size);
 
   if (chunk.data() == nullptr) {
+    heap_stats_.failed_allocate_calls += 1;
     return nullptr;
   }
   freelist_.RemoveChunk(chunk);
@@ -57,13 +61,26 @@ void* FreeListHeap::Allocate(size_t size) {
 
   chunk_block->MarkUsed();
 
-  heap_stats_.bytes_allocated += size;
-  heap_stats_.cumulative_allocated += size;
+  // Count the block's full inner size, which is what Free() subtracts.
+  const size_t size_allocated = chunk_block->InnerSize();
+  heap_stats_.bytes_allocated += size_allocated;
+  heap_stats_.cumulative_allocated += size_allocated;
   heap_stats_.total_allocate_calls += 1;
+  if (heap_stats_.bytes_allocated > heap_stats_.peak_bytes_allocated) {
+    heap_stats_.peak_bytes_allocated = heap_stats_.bytes_allocated;
+  }
 
   return chunk_block->UsableSpace();
 }
 
+void* FreeListHeap::Allocate(size_t size, uint32_t call_site) {
+  void* ptr = Allocate(size);
+  if (metrics_ != nullptr) {
+    metrics_->RecordCallSite(call_site, size, ptr != nullptr);
+  }
+  return ptr;
+}
+
 void FreeListHeap::Free(void* ptr) {
   std::byte* bytes = static_cast<std::byte*>(ptr);
 
@@ -163,6 +180,32 @@ void* FreeListHeap::Calloc(size_t num, size_t size) {
   return ptr;
 }
 
+FreeListHeap::FragmentationStats FreeListHeap::fragmentation_stats() const {
+  FragmentationStats stats = {};
+
+  // The first block starts at the beginning of the region.
+  const Block* block = reinterpret_cast<const Block*>(region_.data());
+  while (true) {
+    if (!block->Used()) {
+      stats.free_bytes += block->InnerSize();
+      stats.free_blocks += 1;
+      stats.largest_free_block =
+          std::max(stats.largest_free_block, block->InnerSize());
+    }
+    if (block->Last()) {
+      break;
+    }
+    block = block->Next();
+  }
+
+  if (stats.free_bytes != 0u) {
+    stats.fragmentation_percent = static_cast<uint32_t>(
+        (stats.free_bytes - stats.largest_free_block) * 100 /
+        stats.free_bytes);
+  }
+  return stats;
+}
+
 void FreeListHeap::LogHeapStats() {
   PW_LOG_INFO(" ");
   PW_LOG_INFO("    The current heap information: ");
@@ -170,6 +213,8 @@ void FreeListHeap::LogHeapStats() {
               static_cast<unsigned int>(heap_stats_.total_bytes));
   PW_LOG_INFO("          The current allocated heap memory is %u bytes.",
               static_cast<unsigned int>(heap_stats_.bytes_allocated));
+  PW_LOG_INFO("          The peak allocated heap memory is %u bytes.",
+              static_cast<unsigned int>(heap_stats_.peak_bytes_allocated));
   PW_LOG_INFO("          The cumulative allocated heap memory is %u bytes.",
               static_cast<unsigned int>(heap_stats_.cumulative_allocated));
   PW_LOG_INFO("          The cumulative freed heap memory is %u bytes.",
@@ -181,6 +226,27 @@ void FreeListHeap::LogHeapStats() {
   PW_LOG_INFO(
       "          free() is called %u times. (realloc() counted as one time)",
       static_cast<unsigned int>(heap_stats_.total_free_calls));
+  PW_LOG_INFO("          %u allocations failed.",
+              static_cast<unsigned int>(heap_stats_.failed_allocate_calls));
+
+  const FragmentationStats fragmentation = fragmentation_stats();
+  PW_LOG_INFO(
+      "          %u bytes are free in %u blocks; the largest is %u bytes "
+      "(%u%% fragmented).",
+      static_cast<unsigned int>(fragmentation.free_bytes),
+      static_cast<unsigned int>(fragmentation.free_blocks),
+      static_cast<unsigned int>(fragmentation.largest_free_block),
+      static_cast<unsigned int>(fragmentation.fragmentation_percent));
+
+  size_t limit = kSmallestSizeBucket;
+  for (size_t i = 0; i + 1 < kSizeHistogramBuckets; ++i, limit *= 2) {
+    PW_LOG_INFO("          Allocations of up to %u bytes: %u",
+                static_cast<unsigned int>(limit),
+                static_cast<unsigned int>(heap_stats_.allocation_sizes[i]));
+  }
+  PW_LOG_INFO("          Allocations of more than %u bytes: %u",
+              static_cast<unsigned int>(limit / 2),
+              static_cast<unsigned int>(heap_stats_.allocation_sizes.back()));
   PW_LOG_INFO(" ");
 }
 
@@ -0,0 +1,140 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/freelist_heap_metrics.h"
+
+#include <algorithm>
+
+#include "pw_assert/check.h"
+
+namespace pw::allocator {
+namespace {
+
+constexpr metric::Token kAllocationsToken =
+    PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, "allocations");
+constexpr metric::Token kBytesToken =
+    PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, "bytes");
+constexpr metric::Token kFailuresToken =
+    PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, "failures");
+
+uint32_t ToMetric(size_t value) {
+  return static_cast<uint32_t>(std::min<size_t>(value, UINT32_MAX));
+}
+
+}  // namespace
+
+FreeListHeapMetrics::CallSite::CallSite(uint32_t tag, metric::Group& parent)
+    : group(tag),
+      allocations(kAllocationsToken, 0u, group.metrics()),
+      bytes(kBytesToken, 0u, group.metrics()),
+      failures(kFailuresToken, 0u, group.metrics()) {
+  parent.Add(group);
+}
+
+FreeListHeapMetrics::FreeListHeapMetrics(FreeListHeap& heap)
+    : heap_(heap),
+      updated_(false),
+      last_update_ms_(0),
+      last_allocate_calls_(0),
+      last_free_calls_(0),
+      num_call_sites_(0) {
+  PW_CHECK_PTR_EQ(heap_.metrics_,
+                  nullptr,
+                  "A FreeListHeapMetrics is already attached to this heap");
+  heap_.metrics_ = this;
+}
+
+FreeListHeapMetrics::~FreeListHeapMetrics() {
+  heap_.metrics_ = nullptr;
+  for (size_t i = 0; i < num_call_sites_; ++i) {
+    call_site(i).~CallSite();
+  }
+}
+
+void FreeListHeapMetrics::Update(uint32_t now_ms) {
+  const FreeListHeap::HeapStats& stats = heap_.heap_stats();
+
+  total_bytes_.Set(ToMetric(stats.total_bytes));
+  bytes_allocated_.Set(ToMetric(stats.bytes_allocated));
+  peak_bytes_allocated_.Set(ToMetric(stats.peak_bytes_allocated));
+  allocate_calls_.Set(ToMetric(stats.total_allocate_calls));
+  free_calls_.Set(ToMetric(stats.total_free_calls));
+  failed_allocate_calls_.Set(ToMetric(stats.failed_allocate_calls));
+
+  const FreeListHeap::FragmentationStats fragmentation =
+      heap_.fragmentation_stats();
+  free_bytes_.Set(ToMetric(fragmentation.free_bytes));
+  free_blocks_.Set(ToMetric(fragmentation.free_blocks));
+  largest_free_block_.Set(ToMetric(fragmentation.largest_free_block));
+  fragmentation_percent_.Set(fragmentation.fragmentation_percent);
+
+  static_assert(FreeListHeap::kSizeHistogramBuckets == 8u);
+  metric::TypedMetric<uint32_t>* const histogram[] = {&size_le_16_,
+                                                      &size_le_32_,
+                                                      &size_le_64_,
+                                                      &size_le_128_,
+                                                      &size_le_256_,
+                                                      &size_le_512_,
+                                                      &size_le_1024_,
+                                                      &size_gt_1024_};
+  for (size_t i = 0; i < FreeListHeap::kSizeHistogramBuckets; ++i) {
+    histogram[i]->Set(ToMetric(stats.allocation_sizes[i]));
+  }
+
+  // Rates are only meaningful once there is a previous sample to compare to.
+  const uint32_t elapsed_ms = now_ms - last_update_ms_;
+  if (updated_ && elapsed_ms != 0u) {
+    allocations_per_second_.Set(ToMetric(
+        uint64_t{stats.total_allocate_calls - last_allocate_calls_} * 1000 /
+        elapsed_ms));
+    frees_per_second_.Set(ToMetric(
+        uint64_t{stats.total_free_calls - last_free_calls_} * 1000 /
+        elapsed_ms));
+  }
+
+  updated_ = true;
+  last_update_ms_ = now_ms;
+  last_allocate_calls_ = stats.total_allocate_calls;
+  last_free_calls_ = stats.total_free_calls;
+}
+
+void FreeListHeapMetrics::RecordCallSite(uint32_t tag,
+                                         size_t size,
+                                         bool succeeded) {
+  CallSite* site = nullptr;
+  for (size_t i = 0; i < num_call_sites_; ++i) {
+    if (call_site(i).group.name() == tag) {
+      site = &call_site(i);
+      break;
+    }
+  }
+
+  if (site == nullptr) {
+    if (num_call_sites_ == kMaxCallSites) {
+      untracked_allocations_.Increment();
+      return;
+    }
+    site = new (&call_sites_[num_call_sites_]) CallSite(tag, call_sites_group_);
+    num_call_sites_ += 1;
+  }
+
+  if (succeeded) {
+    site->allocations.Increment();
+    site->bytes.Increment(ToMetric(size));
+  } else {
+    site->failures.Increment();
+  }
+}
+
+}  // namespace pw::allocator
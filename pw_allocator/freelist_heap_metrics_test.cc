@@ -0,0 +1,161 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/freelist_heap_metrics.h"
+
+#include "gtest/gtest.h"
+#include "pw_allocator/freelist_heap.h"
+
+namespace pw::allocator {
+namespace {
+
+constexpr metric::Token kBytesAllocated = PW_TOKENIZE_STRING_MASK(
+    "metrics", _PW_METRIC_TOKEN_MASK, "bytes_allocated");
+constexpr metric::Token kAllocationsPerSecond = PW_TOKENIZE_STRING_MASK(
+    "metrics", _PW_METRIC_TOKEN_MASK, "allocations_per_second");
+constexpr metric::Token kFreesPerSecond = PW_TOKENIZE_STRING_MASK(
+    "metrics", _PW_METRIC_TOKEN_MASK, "frees_per_second");
+constexpr metric::Token kUntrackedAllocations = PW_TOKENIZE_STRING_MASK(
+    "metrics", _PW_METRIC_TOKEN_MASK, "untracked_allocations");
+constexpr metric::Token kAllocations =
+    PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, "allocations");
+constexpr metric::Token kBytes =
+    PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, "bytes");
+constexpr metric::Token kFailures =
+    PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, "failures");
+constexpr metric::Token kCallSites =
+    PW_TOKENIZE_STRING_DOMAIN("metrics", "call_sites");
+
+const metric::Metric* FindMetric(const metric::Group& group,
+                                 metric::Token name) {
+  for (const metric::Metric& metric : group.metrics()) {
+    if (metric.name() == name) {
+      return &metric;
+    }
+  }
+  return nullptr;
+}
+
+const metric::Group* FindGroup(const metric::Group& group,
+                               metric::Token name) {
+  for (const metric::Group& child : group.children()) {
+    if (child.name() == name) {
+      return &child;
+    }
+  }
+  return nullptr;
+}
+
+uint32_t Value(const metric::Group& group, metric::Token name) {
+  const metric::Metric* metric = FindMetric(group, name);
+  EXPECT_NE(metric, nullptr);
+  return metric == nullptr ? 0u : metric->as_int();
+}
+
+class FreeListHeapMetricsTest : public ::testing::Test {
+ protected:
+  FreeListHeapMetricsTest() : allocator_(buffer_), metrics_(allocator_.heap()) {}
+
+  alignas(Block) std::byte buffer_[2048] = {};
+  FreeListHeapBuffer<> allocator_;
+  FreeListHeapMetrics metrics_;
+};
+
+TEST_F(FreeListHeapMetricsTest, Update_CopiesHeapStats) {
+  void* ptr = allocator_.Allocate(64);
+  ASSERT_NE(ptr, nullptr);
+
+  metrics_.Update(0);
+  EXPECT_EQ(Value(metrics_.metrics(), kBytesAllocated),
+            allocator_.heap_stats().bytes_allocated);
+
+  allocator_.Free(ptr);
+  metrics_.Update(1);
+  EXPECT_EQ(Value(metrics_.metrics(), kBytesAllocated), 0u);
+}
+
+TEST_F(FreeListHeapMetricsTest, Update_ComputesRates) {
+  metrics_.Update(1000);
+  EXPECT_EQ(Value(metrics_.metrics(), kAllocationsPerSecond), 0u);
+
+  for (int i = 0; i < 10; ++i) {
+    allocator_.Free(allocator_.Allocate(32));
+  }
+  allocator_.Allocate(32);
+
+  metrics_.Update(1500);  // 11 allocations and 10 frees in 500 ms.
+  EXPECT_EQ(Value(metrics_.metrics(), kAllocationsPerSecond), 22u);
+  EXPECT_EQ(Value(metrics_.metrics(), kFreesPerSecond), 20u);
+
+  metrics_.Update(2500);  // No calls in the last second.
+  EXPECT_EQ(Value(metrics_.metrics(), kAllocationsPerSecond), 0u);
+  EXPECT_EQ(Value(metrics_.metrics(), kFreesPerSecond), 0u);
+}
+
+TEST_F(FreeListHeapMetricsTest, CallSites_CountedByTag) {
+  PW_ALLOCATOR_CALL_SITE(kParser, "parser");
+  PW_ALLOCATOR_CALL_SITE(kPackets, "packets");
+
+  allocator_.Free(allocator_.Allocate(100, kParser));
+  allocator_.Free(allocator_.Allocate(20, kParser));
+  allocator_.Free(allocator_.Allocate(64, kPackets));
+  EXPECT_EQ(allocator_.Allocate(4096, kPackets), nullptr);
+
+  const metric::Group* call_sites = FindGroup(metrics_.metrics(), kCallSites);
+  ASSERT_NE(call_sites, nullptr);
+
+  const metric::Group* parser = FindGroup(*call_sites, kParser);
+  ASSERT_NE(parser, nullptr);
+  EXPECT_EQ(Value(*parser, kAllocations), 2u);
+  EXPECT_EQ(Value(*parser, kBytes), 120u);
+  EXPECT_EQ(Value(*parser, kFailures), 0u);
+
+  const metric::Group* packets = FindGroup(*call_sites, kPackets);
+  ASSERT_NE(packets, nullptr);
+  EXPECT_EQ(Value(*packets, kAllocations), 1u);
+  EXPECT_EQ(Value(*packets, kBytes), 64u);
+  EXPECT_EQ(Value(*packets, kFailures), 1u);
+}
+
+TEST_F(FreeListHeapMetricsTest, CallSites_ExtraTagsAreUntracked) {
+  for (uint32_t tag = 1; tag <= FreeListHeapMetrics::kMaxCallSites + 2;
+       ++tag) {
+    allocator_.Free(allocator_.Allocate(16, tag));
+  }
+
+  const metric::Group* call_sites = FindGroup(metrics_.metrics(), kCallSites);
+  ASSERT_NE(call_sites, nullptr);
+  EXPECT_EQ(call_sites->children().size(),
+            FreeListHeapMetrics::kMaxCallSites);
+  EXPECT_EQ(Value(metrics_.metrics(), kUntrackedAllocations), 2u);
+}
+
+TEST(FreeListHeapMetrics, Detached_CallSitesIgnored) {
+  alignas(Block) std::byte buffer[512] = {};
+  FreeListHeapBuffer<> allocator(buffer);
+
+  { FreeListHeapMetrics metrics(allocator.heap()); }
+
+  // With no metrics attached, tagged allocations behave like untagged ones.
+  void* ptr = allocator.Allocate(16, 1234);
+  EXPECT_NE(ptr, nullptr);
+  allocator.Free(ptr);
+
+  FreeListHeapMetrics metrics(allocator.heap());
+  metrics.Update(0);
+  EXPECT_EQ(Value(metrics.metrics(), kBytesAllocated), 0u);
+}
+
+}  // namespace
+}  // namespace pw::allocator
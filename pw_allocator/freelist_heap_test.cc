@@ -274,4 +274,80 @@ TEST(FreeListHeap, CallocTooLarge) {
 
   EXPECT_EQ(allocator.Calloc(1, kAllocSize), nullptr);
 }
+
+TEST(FreeListHeap, Stats_TrackPeakAndFreedBytes) {
+  constexpr size_t N = 2048;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  FreeListHeapBuffer allocator(buf);
+
+  // Odd sizes are rounded up to the block alignment, and the rounded size is
+  // counted both when allocated and when freed.
+  void* ptr1 = allocator.Allocate(13);
+  void* ptr2 = allocator.Allocate(200);
+  ASSERT_NE(ptr1, nullptr);
+  ASSERT_NE(ptr2, nullptr);
+  const size_t peak = allocator.heap_stats().bytes_allocated;
+  EXPECT_GE(peak, 213u);
+
+  allocator.Free(ptr1);
+  allocator.Free(ptr2);
+  EXPECT_EQ(allocator.heap_stats().bytes_allocated, 0u);
+  EXPECT_EQ(allocator.heap_stats().peak_bytes_allocated, peak);
+  EXPECT_EQ(allocator.heap_stats().cumulative_freed,
+            allocator.heap_stats().cumulative_allocated);
+}
+
+TEST(FreeListHeap, Stats_AllocationSizeHistogram) {
+  constexpr size_t N = 2048;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  FreeListHeapBuffer allocator(buf);
+
+  allocator.Free(allocator.Allocate(1));
+  allocator.Free(allocator.Allocate(16));
+  allocator.Free(allocator.Allocate(17));
+  allocator.Free(allocator.Allocate(1000));
+  EXPECT_EQ(allocator.Allocate(4096), nullptr);
+
+  const FreeListHeap::HeapStats& stats = allocator.heap_stats();
+  EXPECT_EQ(stats.allocation_sizes[0], 2u);  // <= 16
+  EXPECT_EQ(stats.allocation_sizes[1], 1u);  // <= 32
+  EXPECT_EQ(stats.allocation_sizes[6], 1u);  // <= 1024
+  EXPECT_EQ(stats.allocation_sizes[7], 1u);  // > 1024
+  EXPECT_EQ(stats.failed_allocate_calls, 1u);
+}
+
+TEST(FreeListHeap, FragmentationStats) {
+  constexpr size_t N = 2048;
+  constexpr size_t kAllocSize = 256;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  FreeListHeapBuffer allocator(buf);
+
+  FreeListHeap::FragmentationStats stats = allocator.fragmentation_stats();
+  EXPECT_EQ(stats.free_blocks, 1u);
+  EXPECT_EQ(stats.largest_free_block, stats.free_bytes);
+  EXPECT_EQ(stats.fragmentation_percent, 0u);
+
+  void* ptr1 = allocator.Allocate(kAllocSize);
+  void* ptr2 = allocator.Allocate(kAllocSize);
+  void* ptr3 = allocator.Allocate(kAllocSize);
+  ASSERT_NE(ptr3, nullptr);
+
+  // Freeing the first block leaves two free blocks separated by ptr2.
+  allocator.Free(ptr1);
+  stats = allocator.fragmentation_stats();
+  EXPECT_EQ(stats.free_blocks, 2u);
+  EXPECT_EQ(stats.free_bytes - stats.largest_free_block, kAllocSize);
+  EXPECT_EQ(stats.fragmentation_percent,
+            kAllocSize * 100 / stats.free_bytes);
+
+  allocator.Free(ptr2);
+  allocator.Free(ptr3);
+  stats = allocator.fragmentation_stats();
+  EXPECT_EQ(stats.free_blocks, 1u);
+  EXPECT_EQ(stats.fragmentation_percent, 0u);
+}
+
 }  // namespace pw::allocator
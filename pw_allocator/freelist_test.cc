@@ -172,4 +172,47 @@ TEST(FreeList, CanStoreMultipleChunksPerBucket) {
   EXPECT_TRUE(chunk2.data() == data1 || chunk2.data() == data2);
 }
 
+TEST(FreeList, CanRemoveChunksFromAnyPosition) {
+  FreeListBuffer<SIZE> list(example_sizes);
+  constexpr size_t kN = 512;
+
+  byte data1[kN] = {std::byte(0)};
+  byte data2[kN] = {std::byte(0)};
+  byte data3[kN] = {std::byte(0)};
+
+  // List is data3 -> data2 -> data1 -> NULL.
+  list.AddChunk(std::span(data1, kN));
+  list.AddChunk(std::span(data2, kN));
+  list.AddChunk(std::span(data3, kN));
+
+  // Middle, then tail, then head.
+  EXPECT_EQ(list.RemoveChunk(std::span(data2, kN)), OkStatus());
+  EXPECT_EQ(list.RemoveChunk(std::span(data2, kN)), Status::NotFound());
+  EXPECT_EQ(list.RemoveChunk(std::span(data1, kN)), OkStatus());
+  EXPECT_EQ(list.FindChunk(kN).data(), data3);
+  EXPECT_EQ(list.RemoveChunk(std::span(data3, kN)), OkStatus());
+
+  EXPECT_EQ(list.FindChunk(kN).size(), static_cast<size_t>(0));
+}
+
+TEST(FreeList, RemoveChunkWithWrongSizeReturnsNotFound) {
+  FreeListBuffer<SIZE> list(example_sizes);
+  constexpr size_t kN = 512;
+
+  byte data[kN] = {std::byte(0)};
+
+  list.AddChunk(std::span(data, kN));
+  EXPECT_EQ(list.RemoveChunk(std::span(data, kN / 2)), Status::NotFound());
+  EXPECT_EQ(list.RemoveChunk(std::span(data, kN)), OkStatus());
+}
+
+TEST(FreeList, RemoveTooSmallChunkReturnsNotFound) {
+  FreeListBuffer<SIZE> list(example_sizes);
+
+  byte data[4] = {std::byte(0)};
+
+  EXPECT_EQ(list.AddChunk(std::span(data)), Status::OutOfRange());
+  EXPECT_EQ(list.RemoveChunk(std::span(data)), Status::NotFound());
+}
+
 }  // namespace pw::allocator
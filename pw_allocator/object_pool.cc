@@ -0,0 +1,60 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/object_pool.h"
+
+namespace pw::allocator::internal {
+
+void ObjectPoolBase::Init(std::byte* storage, size_t slot_size) {
+  storage_ = storage;
+
+  // Link the slots in address order, so the first allocations are adjacent.
+  FreeSlot* next = nullptr;
+  for (size_t i = capacity_; i > 0u; --i) {
+    FreeSlot* slot = new (storage + (i - 1) * slot_size) FreeSlot{next};
+    next = slot;
+  }
+  free_list_ = next;
+}
+
+void* ObjectPoolBase::Pop() {
+  FreeSlot* slot = free_list_;
+  if (slot == nullptr) {
+    failures_.Increment();
+    return nullptr;
+  }
+  free_list_ = slot->next;
+
+  allocations_.Increment();
+  in_use_.Increment();
+  if (in_use_.value() > peak_in_use_.value()) {
+    peak_in_use_.Set(in_use_.value());
+  }
+  return slot;
+}
+
+void ObjectPoolBase::Push(void* slot) {
+  free_list_ = new (slot) FreeSlot{free_list_};
+  in_use_.Set(in_use_.value() - 1);
+}
+
+bool ObjectPoolBase::Contains(const void* ptr, size_t slot_size) const {
+  const std::byte* bytes = static_cast<const std::byte*>(ptr);
+  if (bytes < storage_ || bytes >= storage_ + capacity_ * slot_size) {
+    return false;
+  }
+  return static_cast<size_t>(bytes - storage_) % slot_size == 0u;
+}
+
+}  // namespace pw::allocator::internal
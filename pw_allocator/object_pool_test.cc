@@ -0,0 +1,151 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/object_pool.h"
+
+#include <array>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw::allocator {
+namespace {
+
+struct Point {
+  Point(int x_value, int y_value) : x(x_value), y(y_value) {}
+
+  int x;
+  int y;
+};
+
+// Counts constructions and destructions.
+struct Tracked {
+  Tracked() { live += 1; }
+  ~Tracked() { live -= 1; }
+
+  static int live;
+};
+
+int Tracked::live = 0;
+
+uint32_t MetricValue(const metric::Group& group, metric::Token name) {
+  for (const metric::Metric& metric : group.metrics()) {
+    if (metric.name() == name) {
+      return metric.as_int();
+    }
+  }
+  return UINT32_MAX;
+}
+
+#define METRIC_TOKEN(name) \
+  PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, name)
+
+TEST(ObjectPool, NewConstructsObject) {
+  ObjectPool<Point, 4> pool;
+
+  Point* point = pool.New(1, 2);
+  ASSERT_NE(point, nullptr);
+  EXPECT_EQ(point->x, 1);
+  EXPECT_EQ(point->y, 2);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(point) % alignof(Point), 0u);
+  EXPECT_EQ(pool.available(), 3u);
+
+  pool.Delete(point);
+  EXPECT_EQ(pool.available(), 4u);
+}
+
+TEST(ObjectPool, ReturnsNullWhenEmpty) {
+  ObjectPool<Point, 3> pool;
+
+  std::array<Point*, 3> points;
+  for (int i = 0; i < 3; ++i) {
+    points[i] = pool.New(i, i);
+    ASSERT_NE(points[i], nullptr);
+  }
+  EXPECT_EQ(pool.New(0, 0), nullptr);
+  EXPECT_EQ(pool.available(), 0u);
+
+  // Objects don't overlap.
+  EXPECT_NE(points[0], points[1]);
+  EXPECT_NE(points[1], points[2]);
+  EXPECT_EQ(points[0]->x, 0);
+  EXPECT_EQ(points[2]->x, 2);
+
+  pool.Delete(points[1]);
+  Point* reused = pool.New(5, 5);
+  EXPECT_EQ(reused, points[1]);
+}
+
+TEST(ObjectPool, DeleteRunsDestructor) {
+  ObjectPool<Tracked, 2> pool;
+
+  Tracked* tracked = pool.New();
+  EXPECT_EQ(Tracked::live, 1);
+  pool.Delete(tracked);
+  EXPECT_EQ(Tracked::live, 0);
+
+  pool.Delete(nullptr);
+  EXPECT_EQ(pool.available(), 2u);
+}
+
+TEST(ObjectPool, Metrics) {
+  ObjectPool<uint8_t, 2> pool;
+
+  uint8_t* a = pool.New(uint8_t{1});
+  uint8_t* b = pool.New(uint8_t{2});
+  EXPECT_EQ(pool.New(uint8_t{3}), nullptr);
+  pool.Delete(a);
+  pool.Delete(b);
+
+  constexpr metric::Token kInUse = METRIC_TOKEN("in_use");
+  constexpr metric::Token kPeakInUse = METRIC_TOKEN("peak_in_use");
+  constexpr metric::Token kAllocations = METRIC_TOKEN("allocations");
+  constexpr metric::Token kFailures = METRIC_TOKEN("failures");
+
+  const metric::Group& metrics = pool.metrics();
+  EXPECT_EQ(MetricValue(metrics, kInUse), 0u);
+  EXPECT_EQ(MetricValue(metrics, kPeakInUse), 2u);
+  EXPECT_EQ(MetricValue(metrics, kAllocations), 2u);
+  EXPECT_EQ(MetricValue(metrics, kFailures), 1u);
+}
+
+// Lock that records whether it is held.
+struct TestLock {
+  void lock() {
+    EXPECT_FALSE(locked);
+    locked = true;
+    lock_count += 1;
+  }
+  void unlock() {
+    EXPECT_TRUE(locked);
+    locked = false;
+  }
+
+  bool locked = false;
+  static int lock_count;
+};
+
+int TestLock::lock_count = 0;
+
+TEST(ObjectPool, UsesLock) {
+  ObjectPool<Point, 2, TestLock> pool;
+
+  Point* point = pool.New(3, 4);
+  ASSERT_NE(point, nullptr);
+  pool.Delete(point);
+  EXPECT_EQ(TestLock::lock_count, 2);
+}
+
+}  // namespace
+}  // namespace pw::allocator
@@ -0,0 +1,130 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "pw_bytes/span.h"
+
+namespace pw::allocator {
+
+// A monotonic (bump-pointer) allocator over a caller-provided buffer.
+//
+// Allocating advances an offset into the buffer, so it is O(1) and cannot
+// fragment. Individual allocations are never freed; instead, memory is
+// released all at once with Reset() or when a Checkpoint goes out of scope.
+// This suits per-request scratch memory: one region sized for the largest
+// request replaces a worst-case buffer on the stack of every thread.
+//
+// Destructors are not run for objects in an arena, so only trivially
+// destructible types may be created with New() and NewArray().
+//
+// This class is not thread safe.
+class Arena {
+ public:
+  // Records the arena's position on construction and releases everything
+  // allocated after that point on destruction. Checkpoints may be nested, but
+  // must be destroyed in the reverse order of their creation.
+  class Checkpoint {
+   public:
+    explicit Checkpoint(Arena& arena) : arena_(arena), used_(arena.used_) {}
+    ~Checkpoint() { arena_.used_ = used_; }
+
+    Checkpoint(const Checkpoint&) = delete;
+    Checkpoint& operator=(const Checkpoint&) = delete;
+
+   private:
+    Arena& arena_;
+    const size_t used_;
+  };
+
+  constexpr Arena(ByteSpan buffer) : buffer_(buffer), used_(0), peak_used_(0) {}
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Returns size bytes aligned to alignment, which must be a power of two, or
+  // nullptr if the arena does not have enough space left.
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    const uintptr_t start = reinterpret_cast<uintptr_t>(buffer_.data());
+    const uintptr_t aligned =
+        (start + used_ + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    const size_t offset = aligned - start;
+
+    if (offset > buffer_.size() || buffer_.size() - offset < size) {
+      return nullptr;
+    }
+
+    used_ = offset + size;
+    if (used_ > peak_used_) {
+      peak_used_ = used_;
+    }
+    return buffer_.data() + offset;
+  }
+
+  // Constructs an object in the arena. Returns nullptr if there is no space.
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "Arena does not run destructors");
+    void* ptr = Allocate(sizeof(T), alignof(T));
+    return ptr == nullptr ? nullptr : new (ptr) T(std::forward<Args>(args)...);
+  }
+
+  // Allocates an array of value-initialized objects. Returns an empty span if
+  // there is no space.
+  template <typename T>
+  std::span<T> NewArray(size_t count) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "Arena does not run destructors");
+    if (count > buffer_.size() / sizeof(T)) {
+      return std::span<T>();
+    }
+    void* ptr = Allocate(sizeof(T) * count, alignof(T));
+    if (ptr == nullptr) {
+      return std::span<T>();
+    }
+    T* array = static_cast<T*>(ptr);
+    for (size_t i = 0; i < count; ++i) {
+      new (&array[i]) T();
+    }
+    return std::span(array, count);
+  }
+
+  // Releases all allocations.
+  void Reset() { used_ = 0; }
+
+  // Bytes in use, including alignment padding.
+  size_t used() const { return used_; }
+
+  // Bytes left, before accounting for alignment.
+  size_t available() const { return buffer_.size() - used_; }
+
+  size_t capacity() const { return buffer_.size(); }
+
+  // The most bytes ever in use, for sizing the buffer.
+  size_t peak_used() const { return peak_used_; }
+
+ private:
+  const ByteSpan buffer_;
+  size_t used_;
+  size_t peak_used_;
+};
+
+}  // namespace pw::allocator
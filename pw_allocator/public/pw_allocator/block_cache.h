@@ -0,0 +1,95 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace pw::allocator {
+
+// A small cache of free heap blocks, kept outside of the heap.
+//
+// A BlockCache holds blocks that were freed by the program but not yet
+// returned to the heap, sorted into a few small size classes. Allocating from
+// the cache needs no lock, so giving each thread its own BlockCache in front of
+// a shared, locked heap lets most small allocations and frees avoid the lock.
+//
+// Cached blocks are still allocated as far as the heap is concerned. Requests
+// that the cache is meant to serve must be rounded up with RoundUp() before
+// they are passed to the heap, so that any block freed into a size class can
+// hold every request for that class. Blocks are linked through their usable
+// space, so the cache needs no memory of its own besides the list heads.
+//
+// The constructor is constexpr and the class is trivially destructible, so a
+// BlockCache can be a thread_local variable without runtime initialization.
+class BlockCache {
+ public:
+  // Size classes are powers of two from kMinSize to kMaxSize.
+  static constexpr size_t kMinSize = 16;
+  static constexpr size_t kMaxSize = 256;
+  static constexpr size_t kNumClasses = 5;
+  static_assert(kMinSize << (kNumClasses - 1) == kMaxSize);
+
+  // Blocks held per size class. Further blocks go back to the heap.
+  static constexpr size_t kMaxBlocksPerClass = 8;
+
+  constexpr BlockCache() : classes_{} {}
+
+  BlockCache(const BlockCache&) = delete;
+  BlockCache& operator=(const BlockCache&) = delete;
+
+  // Returns the size to request from the heap for an allocation of size
+  // bytes: the size of its class, or size itself if it is too large to cache.
+  static constexpr size_t RoundUp(size_t size) {
+    if (size > kMaxSize) {
+      return size;
+    }
+    size_t class_size = kMinSize;
+    while (class_size < size) {
+      class_size *= 2;
+    }
+    return class_size;
+  }
+
+  // Removes and returns a cached block that can hold size bytes, or returns
+  // nullptr if the request is too large or its class is empty.
+  void* Take(size_t size);
+
+  // Caches a block that was allocated from a Block-based heap. Returns false,
+  // leaving the block untouched, if it is too small or too large to cache or
+  // its class is full; the caller must then free it to the heap.
+  bool Put(void* ptr);
+
+  // Removes and returns any cached block, or nullptr if the cache is empty.
+  // Used to return every block to the heap, for example before a thread
+  // exits.
+  void* TakeAny();
+
+  // The number of blocks in the cache.
+  size_t size() const;
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct SizeClass {
+    FreeBlock* head;
+    size_t count;
+  };
+
+  std::array<SizeClass, kNumClasses> classes_;
+};
+
+}  // namespace pw::allocator
@@ -26,7 +26,7 @@ class FreeListBuffer;
 
 // Basic freelist implementation for an allocator.
 // This implementation buckets by chunk size, with a list of user-provided
-// buckets. Each bucket is a linked list of storage chunks. Because this
+// buckets. Each bucket is a doubly linked list of storage chunks. Because this
 // freelist uses the added chunks themselves as list nodes, there is lower bound
 // of sizeof(FreeList.FreeListNode) bytes for chunks which can be added to this
 // freelist. There is also an implicit bucket for "everything else", for chunks
@@ -73,9 +73,14 @@ class FreeList {
   // = 0 on failure (if there were no chunks available for that allocation).
   std::span<std::byte> FindChunk(size_t size) const;
 
-  // Remove a chunk from this freelist. Returns:
+  // Remove a chunk from this freelist. Chunks are doubly linked, so this is
+  // O(1). Returns:
   //   OK: The chunk was removed successfully
   //   NOT_FOUND: The chunk could not be found in this freelist.
+  //
+  // A chunk that is not in the list is detected by checking that its links
+  // point back to it, which reads the chunk's contents. The chunk must not
+  // hold a stale node from a different freelist.
   Status RemoveChunk(std::span<std::byte> chunk);
 
  private:
@@ -88,8 +93,8 @@ class FreeList {
   friend class FreeListBuffer;
 
   struct FreeListNode {
-    // TODO: Double-link this? It'll make removal easier/quicker.
     FreeListNode* next;
+    FreeListNode* prev;
     size_t size;
   };
 
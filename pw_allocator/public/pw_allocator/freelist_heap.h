@@ -14,7 +14,9 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <span>
 
 #include "pw_allocator/block.h"
@@ -22,18 +24,44 @@
 
 namespace pw::allocator {
 
+class FreeListHeapMetrics;
+
 class FreeListHeap {
  public:
   template <size_t kNumBuckets>
   friend class FreeListHeapBuffer;
+
+  // Allocation requests are counted in power-of-two size buckets: bucket i
+  // counts requests of up to 16 << i bytes, and the last bucket counts all
+  // larger requests.
+  static constexpr size_t kSizeHistogramBuckets = 8;
+  static constexpr size_t kSmallestSizeBucket = 16;
+
   struct HeapStats {
     size_t total_bytes;
     size_t bytes_allocated;
+    size_t peak_bytes_allocated;
     size_t cumulative_allocated;
     size_t cumulative_freed;
     size_t total_allocate_calls;
     size_t total_free_calls;
+    size_t failed_allocate_calls;
+    std::array<size_t, kSizeHistogramBuckets> allocation_sizes;
   };
+
+  // A snapshot of the free space in the heap. Computing it walks every block,
+  // so it is O(n) in the number of blocks.
+  struct FragmentationStats {
+    size_t free_bytes;
+    size_t free_blocks;
+    size_t largest_free_block;
+
+    // The percentage of free bytes that are not in the largest free block: 0
+    // if all free memory is contiguous, approaching 100 as it is split into
+    // many small blocks.
+    uint32_t fragmentation_percent;
+  };
+
   FreeListHeap(std::span<std::byte> region, FreeList& freelist);
 
   void* Allocate(size_t size);
@@ -41,9 +69,30 @@ class FreeListHeap {
   void* Realloc(void* ptr, size_t size);
   void* Calloc(size_t num, size_t size);
 
+  // Allocates memory and attributes it to a call site. The tag is a token from
+  // PW_ALLOCATOR_CALL_SITE; it is only recorded if a FreeListHeapMetrics is
+  // attached to the heap.
+  void* Allocate(size_t size, uint32_t call_site);
+
+  const HeapStats& heap_stats() const { return heap_stats_; }
+  FragmentationStats fragmentation_stats() const;
+
+  // Returns the bucket in HeapStats::allocation_sizes for a request.
+  static constexpr size_t SizeBucket(size_t size) {
+    size_t bucket = 0;
+    for (size_t limit = kSmallestSizeBucket;
+         limit < size && bucket + 1 < kSizeHistogramBuckets;
+         limit *= 2) {
+      bucket += 1;
+    }
+    return bucket;
+  }
+
   void LogHeapStats();
 
  private:
+  friend class FreeListHeapMetrics;
+
   std::span<std::byte> BlockToSpan(Block* block) {
     return std::span<std::byte>(block->UsableSpace(), block->InnerSize());
   }
@@ -53,6 +102,7 @@ class FreeListHeap {
   std::span<std::byte> region_;
   FreeList& freelist_;
   HeapStats heap_stats_;
+  FreeListHeapMetrics* metrics_;
 };
 
 template <size_t kNumBuckets = 6>
@@ -69,10 +119,20 @@ class FreeListHeapBuffer {
   void* Realloc(void* ptr, size_t size) { return heap_.Realloc(ptr, size); }
   void* Calloc(size_t num, size_t size) { return heap_.Calloc(num, size); }
 
+  void* Allocate(size_t size, uint32_t call_site) {
+    return heap_.Allocate(size, call_site);
+  }
+
   const FreeListHeap::HeapStats& heap_stats() const {
     return heap_.heap_stats_;
   };
 
+  FreeListHeap::FragmentationStats fragmentation_stats() const {
+    return heap_.fragmentation_stats();
+  }
+
+  FreeListHeap& heap() { return heap_; }
+
   void LogHeapStats() { heap_.LogHeapStats(); }
 
  private:
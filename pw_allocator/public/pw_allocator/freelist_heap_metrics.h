@@ -0,0 +1,144 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#include "pw_allocator/freelist_heap.h"
+#include "pw_metric/metric.h"
+
+// The number of call sites a FreeListHeapMetrics tracks. Allocations from
+// further call sites are counted in the untracked_allocations metric.
+#ifndef PW_ALLOCATOR_HEAP_METRICS_MAX_CALL_SITES
+#define PW_ALLOCATOR_HEAP_METRICS_MAX_CALL_SITES 8
+#endif  // PW_ALLOCATOR_HEAP_METRICS_MAX_CALL_SITES
+
+// Declares a tokenized tag for a heap allocation call site. The tag is also
+// the name of the call site's metric group, so it is tokenized in the
+// "metrics" domain.
+//
+//   PW_ALLOCATOR_CALL_SITE(kPacketBuffer, "packet_buffer");
+//   void* buffer = heap.Allocate(size, kPacketBuffer);
+//
+#define PW_ALLOCATOR_CALL_SITE(variable_name, call_site_name) \
+  static constexpr uint32_t variable_name =                   \
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, call_site_name)
+
+namespace pw::allocator {
+
+// Exports a FreeListHeap's statistics through pw_metric.
+//
+// The heap's counters are copied into the metrics by Update(), which also
+// computes the allocation and free rates since the previous Update(). Call it
+// periodically, or before the metrics are read, with a monotonic time.
+//
+// While a FreeListHeapMetrics is attached to a heap, allocations made with
+// FreeListHeap::Allocate(size, call_site) are counted per call site, in a
+// child group named by the call site's tag. The first kMaxCallSites tags seen
+// are tracked.
+//
+// This class is not synchronized; it must be used under the same lock as the
+// heap.
+class FreeListHeapMetrics {
+ public:
+  static constexpr size_t kMaxCallSites =
+      PW_ALLOCATOR_HEAP_METRICS_MAX_CALL_SITES;
+
+  // Attaches to the heap. Only one FreeListHeapMetrics may be attached to a
+  // heap at a time.
+  explicit FreeListHeapMetrics(FreeListHeap& heap);
+
+  // Detaches from the heap.
+  ~FreeListHeapMetrics();
+
+  FreeListHeapMetrics(const FreeListHeapMetrics&) = delete;
+  FreeListHeapMetrics& operator=(const FreeListHeapMetrics&) = delete;
+
+  // Copies the heap's statistics into the metrics. now_ms is a monotonic time
+  // in milliseconds; the first call only records the time, and later calls
+  // set the per-second rates from the calls made since the previous Update().
+  // Computing the fragmentation statistics walks the heap, so this is O(n) in
+  // the number of blocks.
+  void Update(uint32_t now_ms);
+
+  metric::Group& metrics() { return metrics_; }
+  const metric::Group& metrics() const { return metrics_; }
+
+ private:
+  friend class FreeListHeap;
+
+  struct CallSite {
+    CallSite(uint32_t tag, metric::Group& parent);
+
+    metric::Group group;
+    metric::TypedMetric<uint32_t> allocations;
+    metric::TypedMetric<uint32_t> bytes;
+    metric::TypedMetric<uint32_t> failures;
+  };
+
+  // Called by the heap for each allocation with a call site tag.
+  void RecordCallSite(uint32_t tag, size_t size, bool succeeded);
+
+  CallSite& call_site(size_t index) {
+    return *std::launder(reinterpret_cast<CallSite*>(&call_sites_[index]));
+  }
+
+  FreeListHeap& heap_;
+
+  bool updated_;
+  uint32_t last_update_ms_;
+  size_t last_allocate_calls_;
+  size_t last_free_calls_;
+
+  // Call sites are constructed in place as tags are first seen.
+  std::array<std::aligned_storage_t<sizeof(CallSite), alignof(CallSite)>,
+             kMaxCallSites>
+      call_sites_;
+  size_t num_call_sites_;
+
+  PW_METRIC_GROUP(metrics_, "freelist_heap");
+  PW_METRIC(metrics_, total_bytes_, "total_bytes", 0u);
+  PW_METRIC(metrics_, bytes_allocated_, "bytes_allocated", 0u);
+  PW_METRIC(metrics_, peak_bytes_allocated_, "peak_bytes_allocated", 0u);
+  PW_METRIC(metrics_, free_bytes_, "free_bytes", 0u);
+  PW_METRIC(metrics_, free_blocks_, "free_blocks", 0u);
+  PW_METRIC(metrics_, largest_free_block_, "largest_free_block", 0u);
+  PW_METRIC(metrics_, fragmentation_percent_, "fragmentation_percent", 0u);
+  PW_METRIC(metrics_, allocate_calls_, "allocate_calls", 0u);
+  PW_METRIC(metrics_, free_calls_, "free_calls", 0u);
+  PW_METRIC(metrics_, failed_allocate_calls_, "failed_allocate_calls", 0u);
+  PW_METRIC(metrics_, allocations_per_second_, "allocations_per_second", 0u);
+  PW_METRIC(metrics_, frees_per_second_, "frees_per_second", 0u);
+  PW_METRIC(metrics_, untracked_allocations_, "untracked_allocations", 0u);
+
+  // Allocation counts by requested size, matching
+  // FreeListHeap::HeapStats::allocation_sizes.
+  PW_METRIC_GROUP(metrics_, allocation_sizes_, "allocation_sizes");
+  PW_METRIC(allocation_sizes_, size_le_16_, "le_16", 0u);
+  PW_METRIC(allocation_sizes_, size_le_32_, "le_32", 0u);
+  PW_METRIC(allocation_sizes_, size_le_64_, "le_64", 0u);
+  PW_METRIC(allocation_sizes_, size_le_128_, "le_128", 0u);
+  PW_METRIC(allocation_sizes_, size_le_256_, "le_256", 0u);
+  PW_METRIC(allocation_sizes_, size_le_512_, "le_512", 0u);
+  PW_METRIC(allocation_sizes_, size_le_1024_, "le_1024", 0u);
+  PW_METRIC(allocation_sizes_, size_gt_1024_, "gt_1024", 0u);
+
+  PW_METRIC_GROUP(metrics_, call_sites_group_, "call_sites");
+};
+
+}  // namespace pw::allocator
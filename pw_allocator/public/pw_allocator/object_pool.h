@@ -0,0 +1,153 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "pw_assert/assert.h"
+#include "pw_metric/metric.h"
+
+namespace pw::allocator {
+namespace internal {
+
+// Lock type for ObjectPools that are only used from one context.
+struct NoLock {
+  constexpr void lock() {}
+  constexpr void unlock() {}
+};
+
+// The type-independent part of ObjectPool: an intrusive singly linked free
+// list threaded through the unused slots, and the pool's metrics.
+class ObjectPoolBase {
+ public:
+  ObjectPoolBase(const ObjectPoolBase&) = delete;
+  ObjectPoolBase& operator=(const ObjectPoolBase&) = delete;
+
+  // The number of objects that can be allocated before the pool is empty.
+  size_t available() const { return capacity_ - in_use_.value(); }
+
+  // Metrics for the pool: objects in use, the peak number in use, total
+  // allocations, and allocations that failed because the pool was empty.
+  metric::Group& metrics() { return metrics_; }
+  const metric::Group& metrics() const { return metrics_; }
+
+ protected:
+  ObjectPoolBase(size_t capacity)
+      : free_list_(nullptr), storage_(nullptr), capacity_(capacity) {}
+
+  // Links every slot into the free list. Called once the storage exists.
+  void Init(std::byte* storage, size_t slot_size);
+
+  // Removes a slot from the free list. Returns nullptr if the pool is empty.
+  void* Pop();
+
+  // Returns a slot to the free list.
+  void Push(void* slot);
+
+  bool Contains(const void* ptr, size_t slot_size) const;
+
+ private:
+  struct FreeSlot {
+    FreeSlot* next;
+  };
+
+  FreeSlot* free_list_;
+  std::byte* storage_;
+  const size_t capacity_;
+
+  PW_METRIC_GROUP(metrics_, "object_pool");
+  PW_METRIC(metrics_, in_use_, "in_use", 0u);
+  PW_METRIC(metrics_, peak_in_use_, "peak_in_use", 0u);
+  PW_METRIC(metrics_, allocations_, "allocations", 0u);
+  PW_METRIC(metrics_, failures_, "failures", 0u);
+};
+
+}  // namespace internal
+
+// A pool of kCapacity objects of type T. Allocating and freeing an object
+// pops and pushes a slot on an intrusive free list, so both are O(1) and
+// never fragment. The pool does no other bookkeeping per object; a free slot
+// holds the list pointer and an allocated slot holds the object.
+//
+// By default the pool is not synchronized and must only be used from one
+// context. To share a pool between threads and interrupts, pass a lock type,
+// such as pw::sync::InterruptSpinLock. The lock is only held while a slot is
+// removed from or returned to the list, not while the object is constructed
+// or destroyed.
+//
+//   pw::allocator::ObjectPool<TraceEvent, 32, pw::sync::InterruptSpinLock>
+//       trace_event_pool;
+//
+//   TraceEvent* event = trace_event_pool.New(id, timestamp);
+//   if (event != nullptr) {
+//     ...
+//     trace_event_pool.Delete(event);
+//   }
+//
+template <typename T, size_t kCapacity, typename Lock = internal::NoLock>
+class ObjectPool : public internal::ObjectPoolBase {
+ public:
+  static_assert(kCapacity > 0u, "An ObjectPool must hold at least one object");
+
+  ObjectPool() : ObjectPoolBase(kCapacity) {
+    Init(reinterpret_cast<std::byte*>(slots_), sizeof(Slot));
+  }
+
+  // Objects must all be freed before the pool is destroyed.
+  ~ObjectPool() = default;
+
+  static constexpr size_t capacity() { return kCapacity; }
+
+  // Constructs an object in a free slot. Returns nullptr if the pool is empty.
+  template <typename... Args>
+  T* New(Args&&... args) {
+    void* slot;
+    {
+      std::lock_guard lock(lock_);
+      slot = Pop();
+    }
+    if (slot == nullptr) {
+      return nullptr;
+    }
+    return new (slot) T(std::forward<Args>(args)...);
+  }
+
+  // Destroys an object from New() and returns its slot to the pool.
+  void Delete(T* object) {
+    if (object == nullptr) {
+      return;
+    }
+    PW_DASSERT(Contains(object, sizeof(Slot)));
+    object->~T();
+
+    std::lock_guard lock(lock_);
+    Push(object);
+  }
+
+ private:
+  union Slot {
+    void* next;
+    std::aligned_storage_t<sizeof(T), alignof(T)> object;
+  };
+
+  Lock lock_;
+  Slot slots_[kCapacity];
+};
+
+}  // namespace pw::allocator
@@ -0,0 +1,131 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_allocator/block.h"
+
+// The largest block a TlsfHeap can manage is 2^PW_ALLOCATOR_TLSF_MAX_SIZE_LOG2
+// bytes. Each additional power of two adds one row of free lists to the heap's
+// bookkeeping.
+#ifndef PW_ALLOCATOR_TLSF_MAX_SIZE_LOG2
+#define PW_ALLOCATOR_TLSF_MAX_SIZE_LOG2 24
+#endif  // PW_ALLOCATOR_TLSF_MAX_SIZE_LOG2
+
+namespace pw::allocator {
+
+// A two-level segregated fit (TLSF) heap built on Block.
+//
+// Free blocks are kept in a two-dimensional array of size classes. The first
+// level divides sizes by powers of two, and the second level divides each
+// power of two into kSecondLevelCount linear steps. A bitmap for each level
+// records which lists are non-empty, so a suitable free block is found with
+// two find-first-set operations instead of a list walk. Free lists are doubly
+// linked through the usable space of free blocks, so a block adjacent to a
+// freed block is unlinked in constant time when they are merged. Allocate and
+// Free are O(1), and an allocation never uses a block more than one size class
+// larger than it needs, which bounds fragmentation.
+//
+// Blocks use the same header as FreeListHeap. Every block must be able to hold
+// the two free list pointers, so allocations are at least kMinInnerSize bytes.
+//
+// This class is not thread safe.
+class TlsfHeap {
+ public:
+  struct HeapStats {
+    size_t total_bytes;
+    size_t bytes_allocated;
+    size_t cumulative_allocated;
+    size_t cumulative_freed;
+    size_t total_allocate_calls;
+    size_t total_free_calls;
+  };
+
+  static constexpr size_t kSecondLevelLog2 = 3;
+  static constexpr size_t kSecondLevelCount = size_t(1) << kSecondLevelLog2;
+
+  // Free blocks store two list pointers, so no block is smaller than this.
+  static constexpr size_t kMinInnerSize = 2 * sizeof(Block*);
+
+  // The region must be aligned to alignof(Block) and no larger than
+  // 2^PW_ALLOCATOR_TLSF_MAX_SIZE_LOG2 bytes.
+  TlsfHeap(std::span<std::byte> region);
+
+  TlsfHeap(const TlsfHeap&) = delete;
+  TlsfHeap& operator=(const TlsfHeap&) = delete;
+
+  void* Allocate(size_t size);
+  void Free(void* ptr);
+  void* Realloc(void* ptr, size_t size);
+  void* Calloc(size_t num, size_t size);
+
+  const HeapStats& heap_stats() const { return heap_stats_; }
+
+  void LogHeapStats() const;
+
+ private:
+  // Links stored in the usable space of each free block.
+  struct FreeLinks {
+    Block* next;
+    Block* prev;
+  };
+  static_assert(sizeof(FreeLinks) == kMinInnerSize);
+
+  static constexpr size_t kAlignLog2 = alignof(Block) == 8   ? 3
+                                       : alignof(Block) == 4 ? 2
+                                                             : 1;
+  static_assert(size_t(1) << kAlignLog2 == alignof(Block));
+
+  // Sizes below kSmallBlockSize share first-level list 0, which is divided
+  // into steps of alignof(Block).
+  static constexpr size_t kFirstLevelShift = kSecondLevelLog2 + kAlignLog2;
+  static constexpr size_t kSmallBlockSize = size_t(1) << kFirstLevelShift;
+  static constexpr size_t kFirstLevelCount =
+      PW_ALLOCATOR_TLSF_MAX_SIZE_LOG2 - kFirstLevelShift + 1;
+
+  static_assert(PW_ALLOCATOR_TLSF_MAX_SIZE_LOG2 > kFirstLevelShift);
+  static_assert(kFirstLevelCount <= 32, "The first-level bitmap is 32 bits");
+  static_assert(kSecondLevelCount <= 32, "Second-level bitmaps are 32 bits");
+
+  static FreeLinks& Links(Block* block) {
+    return *reinterpret_cast<FreeLinks*>(block->UsableSpace());
+  }
+
+  // Maps a block size to the free list that holds blocks of that size.
+  static void Mapping(size_t size, size_t& first, size_t& second);
+
+  void InsertBlock(Block* block);
+  void RemoveBlock(Block* block);
+
+  // Returns a free block of at least size bytes, or nullptr if there is none.
+  Block* FindSuitableBlock(size_t size);
+
+  // Returns the head of the first non-empty list at or after the given size
+  // class, or nullptr if all of them are empty.
+  Block* FindInLargerLists(size_t first, size_t second) const;
+
+  void InvalidFreeCrash();
+
+  std::span<std::byte> region_;
+  uint32_t first_level_bitmap_;
+  std::array<uint32_t, kFirstLevelCount> second_level_bitmaps_;
+  std::array<std::array<Block*, kSecondLevelCount>, kFirstLevelCount> lists_;
+  HeapStats heap_stats_;
+};
+
+}  // namespace pw::allocator
@@ -0,0 +1,304 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/tlsf_heap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "pw_assert/check.h"
+#include "pw_log/log.h"
+
+namespace pw::allocator {
+namespace {
+
+size_t MostSignificantBit(size_t value) {
+  return std::numeric_limits<unsigned long long>::digits - 1 -
+         __builtin_clzll(static_cast<unsigned long long>(value));
+}
+
+size_t FirstSetBit(uint32_t value) { return __builtin_ctz(value); }
+
+}  // namespace
+
+TlsfHeap::TlsfHeap(std::span<std::byte> region)
+    : region_(region),
+      first_level_bitmap_(0),
+      second_level_bitmaps_{},
+      lists_{},
+      heap_stats_() {
+  PW_CHECK_UINT_LE(region.size(),
+                   size_t(1) << PW_ALLOCATOR_TLSF_MAX_SIZE_LOG2,
+                   "Region too large; increase "
+                   "PW_ALLOCATOR_TLSF_MAX_SIZE_LOG2");
+
+  Block* block;
+  PW_CHECK_OK(Block::Init(region, &block),
+              "Failed to initialize TlsfHeap region; misaligned or too small");
+
+  if (block->InnerSize() >= kMinInnerSize) {
+    InsertBlock(block);
+  }
+  heap_stats_.total_bytes = region.size();
+}
+
+void* TlsfHeap::Allocate(size_t size) {
+  // Larger requests cannot succeed, and rejecting them up front keeps the
+  // size arithmetic below from overflowing.
+  if (size > region_.size()) {
+    return nullptr;
+  }
+
+  size_t inner_size = std::max(size, kMinInnerSize);
+  inner_size = (inner_size + alignof(Block) - 1) & ~(alignof(Block) - 1);
+
+  Block* block = FindSuitableBlock(inner_size);
+  if (block == nullptr) {
+    return nullptr;
+  }
+  RemoveBlock(block);
+  block->CrashIfInvalid();
+
+  // Return the tail of the block to the heap if it can hold a free block.
+  if (block->InnerSize() - inner_size >=
+      sizeof(Block) + 2 * PW_ALLOCATOR_POISON_OFFSET + kMinInnerSize) {
+    Block* remainder;
+    if (block->Split(inner_size, &remainder).ok()) {
+      InsertBlock(remainder);
+    }
+  }
+
+  block->MarkUsed();
+
+  heap_stats_.bytes_allocated += block->InnerSize();
+  heap_stats_.cumulative_allocated += block->InnerSize();
+  heap_stats_.total_allocate_calls += 1;
+
+  return block->UsableSpace();
+}
+
+void TlsfHeap::Free(void* ptr) {
+  std::byte* bytes = static_cast<std::byte*>(ptr);
+
+  if (bytes < region_.data() || bytes >= region_.data() + region_.size()) {
+    InvalidFreeCrash();
+    return;
+  }
+
+  Block* block = Block::FromUsableSpace(bytes);
+  block->CrashIfInvalid();
+
+  if (!block->Used()) {
+    InvalidFreeCrash();
+    return;
+  }
+
+  const size_t size_freed = block->InnerSize();
+  block->MarkFree();
+
+  // Merge with free neighbors. Their list links make unlinking them O(1).
+  Block* prev = block->Prev();
+  if (prev != nullptr && !prev->Used()) {
+    RemoveBlock(prev);
+    block->MergePrev();
+    block = prev;
+  }
+
+  if (!block->Last()) {
+    Block* next = block->Next();
+    if (!next->Used()) {
+      RemoveBlock(next);
+      block->MergeNext();
+    }
+  }
+
+  InsertBlock(block);
+
+  heap_stats_.bytes_allocated -= size_freed;
+  heap_stats_.cumulative_freed += size_freed;
+  heap_stats_.total_free_calls += 1;
+}
+
+// Follows the contract of the C standard realloc() function.
+void* TlsfHeap::Realloc(void* ptr, size_t size) {
+  if (size == 0) {
+    Free(ptr);
+    return nullptr;
+  }
+
+  if (ptr == nullptr) {
+    return Allocate(size);
+  }
+
+  std::byte* bytes = static_cast<std::byte*>(ptr);
+  if (bytes < region_.data() || bytes >= region_.data() + region_.size()) {
+    return nullptr;
+  }
+
+  Block* block = Block::FromUsableSpace(bytes);
+  if (!block->Used()) {
+    return nullptr;
+  }
+
+  const size_t old_size = block->InnerSize();
+  if (old_size >= size) {
+    return ptr;
+  }
+
+  void* new_ptr = Allocate(size);
+  if (new_ptr == nullptr) {
+    return nullptr;
+  }
+  std::memcpy(new_ptr, ptr, old_size);
+
+  Free(ptr);
+  return new_ptr;
+}
+
+void* TlsfHeap::Calloc(size_t num, size_t size) {
+  if (size != 0u && num > std::numeric_limits<size_t>::max() / size) {
+    return nullptr;
+  }
+
+  void* ptr = Allocate(num * size);
+  if (ptr != nullptr) {
+    std::memset(ptr, 0, num * size);
+  }
+  return ptr;
+}
+
+void TlsfHeap::LogHeapStats() const {
+  PW_LOG_INFO("TLSF heap: %u of %u bytes allocated",
+              static_cast<unsigned>(heap_stats_.bytes_allocated),
+              static_cast<unsigned>(heap_stats_.total_bytes));
+  PW_LOG_INFO("  cumulative allocated: %u bytes in %u calls",
+              static_cast<unsigned>(heap_stats_.cumulative_allocated),
+              static_cast<unsigned>(heap_stats_.total_allocate_calls));
+  PW_LOG_INFO("  cumulative freed: %u bytes in %u calls",
+              static_cast<unsigned>(heap_stats_.cumulative_freed),
+              static_cast<unsigned>(heap_stats_.total_free_calls));
+}
+
+void TlsfHeap::Mapping(size_t size, size_t& first, size_t& second) {
+  if (size < kSmallBlockSize) {
+    first = 0;
+    second = size >> kAlignLog2;
+    return;
+  }
+
+  const size_t msb = MostSignificantBit(size);
+  first = msb - kFirstLevelShift + 1;
+  second = (size >> (msb - kSecondLevelLog2)) ^ kSecondLevelCount;
+}
+
+void TlsfHeap::InsertBlock(Block* block) {
+  size_t first;
+  size_t second;
+  Mapping(block->InnerSize(), first, second);
+
+  Block*& head = lists_[first][second];
+  Links(block) = FreeLinks{head, nullptr};
+  if (head != nullptr) {
+    Links(head).prev = block;
+  }
+  head = block;
+
+  first_level_bitmap_ |= uint32_t(1) << first;
+  second_level_bitmaps_[first] |= uint32_t(1) << second;
+}
+
+void TlsfHeap::RemoveBlock(Block* block) {
+  size_t first;
+  size_t second;
+  Mapping(block->InnerSize(), first, second);
+
+  const FreeLinks links = Links(block);
+  if (links.next != nullptr) {
+    Links(links.next).prev = links.prev;
+  }
+  if (links.prev != nullptr) {
+    Links(links.prev).next = links.next;
+    return;
+  }
+
+  // The block was the head of its list.
+  lists_[first][second] = links.next;
+  if (links.next == nullptr) {
+    second_level_bitmaps_[first] &= ~(uint32_t(1) << second);
+    if (second_level_bitmaps_[first] == 0u) {
+      first_level_bitmap_ &= ~(uint32_t(1) << first);
+    }
+  }
+}
+
+Block* TlsfHeap::FindSuitableBlock(size_t size) {
+  // Round the size up to the next list boundary, so that every block in the
+  // list that is found is large enough. Sizes in the first list are exact.
+  size_t rounded_size = size;
+  if (size >= kSmallBlockSize) {
+    rounded_size +=
+        (size_t(1) << (MostSignificantBit(size) - kSecondLevelLog2)) - 1;
+  }
+
+  size_t first;
+  size_t second;
+  Mapping(rounded_size, first, second);
+  if (Block* block = FindInLargerLists(first, second); block != nullptr) {
+    return block;
+  }
+
+  // Blocks in the list for the unrounded size may still be large enough. This
+  // only matters when the heap is nearly exhausted, so walking the list is
+  // acceptable.
+  Mapping(size, first, second);
+  for (Block* block = lists_[first][second]; block != nullptr;
+       block = Links(block).next) {
+    if (block->InnerSize() >= size) {
+      return block;
+    }
+  }
+  return nullptr;
+}
+
+Block* TlsfHeap::FindInLargerLists(size_t first, size_t second) const {
+  if (first >= kFirstLevelCount) {
+    return nullptr;
+  }
+
+  // Look for a non-empty list in this size class or a larger one in the same
+  // power of two, then in the next non-empty power of two.
+  uint32_t second_map =
+      second_level_bitmaps_[first] & (~uint32_t(0) << second);
+  if (second_map == 0u) {
+    if (first + 1 >= kFirstLevelCount) {
+      return nullptr;
+    }
+    const uint32_t first_map =
+        first_level_bitmap_ & (~uint32_t(0) << (first + 1));
+    if (first_map == 0u) {
+      return nullptr;
+    }
+    first = FirstSetBit(first_map);
+    second_map = second_level_bitmaps_[first];
+  }
+
+  return lists_[first][FirstSetBit(second_map)];
+}
+
+void TlsfHeap::InvalidFreeCrash() {
+  PW_DCHECK(false, "You tried to free an invalid pointer!");
+}
+
+}  // namespace pw::allocator
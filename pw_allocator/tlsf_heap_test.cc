@@ -0,0 +1,214 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/tlsf_heap.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+
+namespace pw::allocator {
+namespace {
+
+constexpr size_t kHeapSize = 2048;
+
+TEST(TlsfHeap, CanAllocate) {
+  alignas(Block) std::byte buf[kHeapSize] = {};
+  TlsfHeap heap(buf);
+
+  void* ptr = heap.Allocate(512);
+
+  ASSERT_NE(ptr, nullptr);
+  // The first allocation comes from the start of the region.
+  EXPECT_EQ(ptr, &buf[0] + sizeof(Block) + PW_ALLOCATOR_POISON_OFFSET);
+}
+
+TEST(TlsfHeap, AllocationsDontOverlap) {
+  alignas(Block) std::byte buf[kHeapSize] = {};
+  TlsfHeap heap(buf);
+
+  void* ptr1 = heap.Allocate(512);
+  void* ptr2 = heap.Allocate(512);
+
+  ASSERT_NE(ptr1, nullptr);
+  ASSERT_NE(ptr2, nullptr);
+
+  uintptr_t ptr1_end = reinterpret_cast<uintptr_t>(ptr1) + 512;
+  EXPECT_GT(reinterpret_cast<uintptr_t>(ptr2), ptr1_end);
+}
+
+TEST(TlsfHeap, CanFreeAndReuse) {
+  alignas(Block) std::byte buf[kHeapSize] = {};
+  TlsfHeap heap(buf);
+
+  void* ptr1 = heap.Allocate(512);
+  heap.Free(ptr1);
+  void* ptr2 = heap.Allocate(512);
+
+  EXPECT_EQ(ptr1, ptr2);
+}
+
+TEST(TlsfHeap, ReusesFreedSmallBlock) {
+  alignas(Block) std::byte buf[kHeapSize] = {};
+  TlsfHeap heap(buf);
+
+  void* ptr1 = heap.Allocate(24);
+  void* guard = heap.Allocate(24);
+  ASSERT_NE(guard, nullptr);
+  heap.Free(ptr1);
+
+  // The freed block is not adjacent to the rest of the free space, so an
+  // allocation of the same size must find it in its list.
+  EXPECT_EQ(heap.Allocate(24), ptr1);
+}
+
+TEST(TlsfHeap, ReturnsNullWhenAllocationTooLarge) {
+  alignas(Block) std::byte buf[kHeapSize] = {};
+  TlsfHeap heap(buf);
+
+  EXPECT_EQ(heap.Allocate(kHeapSize), nullptr);
+  EXPECT_EQ(heap.Allocate(SIZE_MAX), nullptr);
+}
+
+TEST(TlsfHeap, ReturnsNullWhenFull) {
+  alignas(Block) std::byte buf[kHeapSize] = {};
+  TlsfHeap heap(buf);
+
+  EXPECT_NE(heap.Allocate(kHeapSize - sizeof(Block) -
+                          2 * PW_ALLOCATOR_POISON_OFFSET),
+            nullptr);
+  EXPECT_EQ(heap.Allocate(1), nullptr);
+}
+
+TEST(TlsfHeap, ReturnedPointersAreAligned) {
+  alignas(Block) std::byte buf[kHeapSize] = {};
+  TlsfHeap heap(buf);
+
+  for (size_t size : {1, 5, 13, 100}) {
+    void* ptr = heap.Allocate(size);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignof(Block), 0u);
+  }
+}
+
+TEST(TlsfHeap, CoalescesFreedBlocks) {
+  alignas(Block) std::byte buf[kHeapSize] = {};
+  TlsfHeap heap(buf);
+
+  std::array<void*, 16> ptrs;
+  for (void*& ptr : ptrs) {
+    ptr = heap.Allocate(64);
+    ASSERT_NE(ptr, nullptr);
+  }
+
+  // Free in an order that merges with previous, next, and both neighbors.
+  for (size_t i = 0; i < ptrs.size(); i += 2) {
+    heap.Free(ptrs[i]);
+  }
+  for (size_t i = 1; i < ptrs.size(); i += 2) {
+    heap.Free(ptrs[i]);
+  }
+
+  EXPECT_EQ(heap.heap_stats().bytes_allocated, 0u);
+  EXPECT_EQ(heap.Allocate(kHeapSize - sizeof(Block) -
+                          2 * PW_ALLOCATOR_POISON_OFFSET),
+            &buf[0] + sizeof(Block) + PW_ALLOCATOR_POISON_OFFSET);
+}
+
+TEST(TlsfHeap, MixedSizes) {
+  alignas(Block) std::byte buf[8192] = {};
+  TlsfHeap heap(buf);
+
+  // Allocate and free a pseudo-random mix of sizes and check that every live
+  // allocation keeps its contents.
+  std::array<std::byte*, 32> ptrs{};
+  std::array<size_t, 32> sizes{};
+  uint32_t state = 1;
+  for (int round = 0; round < 1000; ++round) {
+    state = state * 1103515245u + 12345u;
+    const size_t slot = (state >> 8) % ptrs.size();
+
+    if (ptrs[slot] != nullptr) {
+      for (size_t i = 0; i < sizes[slot]; ++i) {
+        ASSERT_EQ(ptrs[slot][i], std::byte(slot));
+      }
+      heap.Free(ptrs[slot]);
+      ptrs[slot] = nullptr;
+    } else {
+      sizes[slot] = 1 + (state >> 16) % 300;
+      ptrs[slot] = static_cast<std::byte*>(heap.Allocate(sizes[slot]));
+      if (ptrs[slot] != nullptr) {
+        std::memset(ptrs[slot], static_cast<int>(slot), sizes[slot]);
+      }
+    }
+  }
+
+  for (std::byte* ptr : ptrs) {
+    if (ptr != nullptr) {
+      heap.Free(ptr);
+    }
+  }
+  EXPECT_EQ(heap.heap_stats().bytes_allocated, 0u);
+  EXPECT_NE(heap.Allocate(sizeof(buf) - sizeof(Block) -
+                          2 * PW_ALLOCATOR_POISON_OFFSET),
+            nullptr);
+}
+
+TEST(TlsfHeap, ReallocHasSameContent) {
+  alignas(Block) std::byte buf[kHeapSize] = {};
+  TlsfHeap heap(buf);
+
+  constexpr char kData[] = "pigweed";
+  void* ptr = heap.Allocate(sizeof(kData));
+  ASSERT_NE(ptr, nullptr);
+  std::memcpy(ptr, kData, sizeof(kData));
+
+  void* new_ptr = heap.Realloc(ptr, 256);
+  ASSERT_NE(new_ptr, nullptr);
+  EXPECT_NE(new_ptr, ptr);
+  EXPECT_EQ(std::memcmp(new_ptr, kData, sizeof(kData)), 0);
+}
+
+TEST(TlsfHeap, ReallocTooLarge) {
+  alignas(Block) std::byte buf[kHeapSize] = {};
+  TlsfHeap heap(buf);
+
+  void* ptr = heap.Allocate(512);
+  EXPECT_EQ(heap.Realloc(ptr, kHeapSize), nullptr);
+}
+
+TEST(TlsfHeap, CanCalloc) {
+  alignas(Block) std::byte buf[kHeapSize];
+  std::memset(buf, 0xff, sizeof(buf));
+  TlsfHeap heap(buf);
+
+  std::byte* ptr = static_cast<std::byte*>(heap.Calloc(16, 8));
+  ASSERT_NE(ptr, nullptr);
+  for (size_t i = 0; i < 16 * 8; ++i) {
+    EXPECT_EQ(ptr[i], std::byte(0));
+  }
+}
+
+TEST(TlsfHeap, CallocOverflow) {
+  alignas(Block) std::byte buf[kHeapSize] = {};
+  TlsfHeap heap(buf);
+
+  EXPECT_EQ(heap.Calloc(SIZE_MAX / 2, 4), nullptr);
+}
+
+}  // namespace
+}  // namespace pw::allocator
@@ -0,0 +1,114 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#include "pw_analog/microvolt_converter.h"
+
+#include <array>
+#include <cstdlib>
+#include <limits>
+
+#include "gtest/gtest.h"
+
+namespace pw::analog {
+namespace {
+
+constexpr int32_t kMin = std::numeric_limits<int32_t>::min();
+constexpr int32_t kMax = std::numeric_limits<int32_t>::max();
+
+// The conversion done by MicrovoltInput for a single sample.
+int32_t Expected(AnalogInput::Limits limits,
+                 MicrovoltReferences references,
+                 int32_t sample) {
+  return static_cast<int32_t>(
+      ((int64_t{sample} - limits.min) *
+       (int64_t{references.max_voltage_uv} - references.min_voltage_uv)) /
+          (int64_t{limits.max} - limits.min) +
+      references.min_voltage_uv);
+}
+
+void ExpectMatchesDivision(AnalogInput::Limits limits,
+                           MicrovoltReferences references) {
+  const MicrovoltConverter converter(limits, references);
+  const int64_t step =
+      std::max<int64_t>(1, (int64_t{limits.max} - limits.min) / 997);
+  for (int64_t sample = limits.min; sample <= limits.max; sample += step) {
+    const int32_t expected =
+        Expected(limits, references, static_cast<int32_t>(sample));
+    const int32_t actual = converter.Convert(static_cast<int32_t>(sample));
+    EXPECT_LE(std::abs(int64_t{expected} - actual), 1);
+  }
+  EXPECT_EQ(references.max_voltage_uv, converter.Convert(limits.max));
+  EXPECT_EQ(references.min_voltage_uv, converter.Convert(limits.min));
+}
+
+TEST(MicrovoltConverter, Unipolar12Bit) {
+  ExpectMatchesDivision({.min = 0, .max = 4095},
+                        {.max_voltage_uv = 3300000, .min_voltage_uv = 0});
+}
+
+TEST(MicrovoltConverter, Bipolar16Bit) {
+  ExpectMatchesDivision(
+      {.min = -32768, .max = 32767},
+      {.max_voltage_uv = 10000000, .min_voltage_uv = -10000000});
+}
+
+TEST(MicrovoltConverter, Inverted) {
+  ExpectMatchesDivision({.min = 0, .max = 1023},
+                        {.max_voltage_uv = 0, .min_voltage_uv = 5000000});
+}
+
+TEST(MicrovoltConverter, FullRange) {
+  const MicrovoltConverter converter(
+      {.min = kMin, .max = kMax},
+      {.max_voltage_uv = kMax, .min_voltage_uv = kMin});
+  EXPECT_EQ(kMin, converter.Convert(kMin));
+  EXPECT_EQ(-1, converter.Convert(-1));
+  EXPECT_EQ(0, converter.Convert(0));
+  EXPECT_EQ(kMax, converter.Convert(kMax));
+
+  const MicrovoltConverter inverted(
+      {.min = kMin, .max = kMax},
+      {.max_voltage_uv = kMin, .min_voltage_uv = kMax});
+  EXPECT_EQ(kMax, inverted.Convert(kMin));
+  EXPECT_EQ(0, inverted.Convert(-1));
+  EXPECT_EQ(kMin, inverted.Convert(kMax));
+}
+
+TEST(MicrovoltConverter, Block) {
+  const MicrovoltConverter converter(
+      {.min = 0, .max = 4096},
+      {.max_voltage_uv = 1800000, .min_voltage_uv = 0});
+  constexpr std::array<int32_t, 4> kSamples = {0, 1024, 2048, 4096};
+  std::array<int32_t, 4> microvolts;
+
+  converter.Convert(kSamples, microvolts);
+  EXPECT_EQ(0, microvolts[0]);
+  EXPECT_EQ(450000, microvolts[1]);
+  EXPECT_EQ(900000, microvolts[2]);
+  EXPECT_EQ(1800000, microvolts[3]);
+}
+
+TEST(MicrovoltConverter, BlockInPlace) {
+  const MicrovoltConverter converter(
+      {.min = -2048, .max = 2047},
+      {.max_voltage_uv = 2047000, .min_voltage_uv = -2048000});
+  std::array<int32_t, 3> samples = {-2048, 0, 2047};
+
+  converter.Convert(samples, samples);
+  EXPECT_EQ(-2048000, samples[0]);
+  EXPECT_EQ(0, samples[1]);
+  EXPECT_EQ(2047000, samples[2]);
+}
+
+}  // namespace
+}  // namespace pw::analog
@@ -13,6 +13,8 @@
 // the License.
 #include "pw_analog/microvolt_input.h"
 
+#include <array>
+
 #include "gtest/gtest.h"
 
 namespace pw {
@@ -282,6 +284,20 @@ TEST(MicrovoltInputTest, ReadMicrovoltsWithInvertedReferenceAtMin) {
 
   EXPECT_EQ(result.value(), kInvertedReferenceMinVoltageUv);
 }
+
+TEST(MicrovoltInputTest, ConvertBlockToMicrovolts) {
+  TestMicrovoltInput voltage_input =
+      TestMicrovoltInput({.min = kBipolarLimitsMin, .max = kBipolarLimitsMax},
+                         {.max_voltage_uv = kBipolarReferenceMaxVoltageUv,
+                          .min_voltage_uv = kBipolarReferenceMinVoltageUv});
+  const std::array<int32_t, 3> samples = {kBipolarLimitsMin, 0, 2048};
+  std::array<int32_t, 3> microvolts;
+
+  voltage_input.ConvertToMicrovolts(samples, microvolts);
+  EXPECT_EQ(microvolts[0], kBipolarReferenceMinVoltageUv);
+  EXPECT_EQ(microvolts[1], 0);
+  EXPECT_EQ(microvolts[2], kBipolarReferenceMaxVoltageUv / 2);
+}
 }  // namespace
 }  // namespace analog
 }  // namespace pw
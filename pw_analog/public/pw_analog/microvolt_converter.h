@@ -0,0 +1,94 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_analog/analog_input.h"
+#include "pw_assert/assert.h"
+
+namespace pw::analog {
+
+// Specifies the max and min microvolt range an analog input can measure.
+// * These values do not change at run time.
+// * Inversion of min/max is supported.
+struct MicrovoltReferences {
+  int32_t max_voltage_uv;  // Microvolts at AnalogInput::Limits::max
+  int32_t min_voltage_uv;  // Microvolts at AnalogInput::Limits::min.
+};
+
+// Converts ADC samples to microvolts with a fixed-point multiply and shift,
+// rather than the 64-bit division MicrovoltInput does for each sample. The
+// scale factor is computed once, so converting a block of samples from a
+// SampleStream is a tight loop that the compiler can unroll or vectorize.
+//
+// Results are rounded to the nearest microvolt, where
+// MicrovoltInput::TryReadMicrovoltsUntil() truncates, so they may differ by one
+// microvolt. Limits::min and Limits::max must differ.
+class MicrovoltConverter {
+ public:
+  constexpr MicrovoltConverter(AnalogInput::Limits limits,
+                               MicrovoltReferences references)
+      : min_sample_(limits.min),
+        min_voltage_uv_(references.min_voltage_uv),
+        shift_(Shift(int64_t{references.max_voltage_uv} -
+                     references.min_voltage_uv)),
+        scale_((int64_t{references.max_voltage_uv} -
+                references.min_voltage_uv) *
+               (int64_t{1} << shift_) /
+               (int64_t{limits.max} - limits.min)) {}
+
+  // Converts one sample, which must be within the limits.
+  constexpr int32_t Convert(int32_t sample) const {
+    const int64_t scaled = (int64_t{sample} - min_sample_) * scale_;
+    return static_cast<int32_t>(((scaled + (int64_t{1} << (shift_ - 1))) >>
+                                 shift_) +
+                                min_voltage_uv_);
+  }
+
+  // Converts a block of samples. microvolts must be at least as large as
+  // samples, and may be the same span to convert in place.
+  void Convert(std::span<const int32_t> samples,
+               std::span<int32_t> microvolts) const {
+    PW_ASSERT(microvolts.size() >= samples.size());
+    const int32_t* in = samples.data();
+    int32_t* out = microvolts.data();
+    for (size_t i = 0; i < samples.size(); ++i) {
+      out[i] = Convert(in[i]);
+    }
+  }
+
+ private:
+  // The largest fraction width, up to 32 bits, for which the scaled voltage
+  // range, and so the product of any in-range sample and the scale, fits in an
+  // int64_t.
+  static constexpr int Shift(int64_t range_uv) {
+    int bits = 0;
+    for (uint64_t magnitude = range_uv < 0 ? -range_uv : range_uv;
+         magnitude != 0;
+         magnitude >>= 1) {
+      bits += 1;
+    }
+    return bits > 30 ? 62 - bits : 32;
+  }
+
+  int32_t min_sample_;
+  int32_t min_voltage_uv_;
+  int shift_;
+  int64_t scale_;
+};
+
+}  // namespace pw::analog
@@ -12,7 +12,12 @@
 // License for the specific language governing permissions and limitations under
 // the License.
 #pragma once
+
+#include <cstdint>
+#include <span>
+
 #include "pw_analog/analog_input.h"
+#include "pw_analog/microvolt_converter.h"
 #include "pw_chrono/system_clock.h"
 #include "pw_result/result.h"
 #include "pw_status/try.h"
@@ -29,12 +34,7 @@ namespace pw::analog {
 class MicrovoltInput : public AnalogInput {
  public:
   // Specifies the max and min microvolt range the analog input can measure.
-  // * These values do not change at run time.
-  // * Inversion of min/max is supported.
-  struct References {
-    int32_t max_voltage_uv;  // Microvolts at AnalogInput::Limits::max
-    int32_t min_voltage_uv;  // Microvolts at AnalogInput::Limits::min.
-  };
+  using References = MicrovoltReferences;
 
   virtual ~MicrovoltInput() = default;
 
@@ -76,6 +76,16 @@ class MicrovoltInput : public AnalogInput {
            reference.min_voltage_uv;
   }
 
+  // Converts a block of samples from this input, such as one delivered by a
+  // SampleStream, to microvolts. microvolts must be at least as large as
+  // samples, and may be the same span to convert in place. See
+  // MicrovoltConverter.
+  void ConvertToMicrovolts(std::span<const int32_t> samples,
+                           std::span<int32_t> microvolts) const {
+    MicrovoltConverter(GetLimits(), GetReferences())
+        .Convert(samples, microvolts);
+  }
+
  private:
   // Returns the reference voltage needed to calculate the voltage.
   // These values do not change at run time.
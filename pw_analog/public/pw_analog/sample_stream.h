@@ -0,0 +1,121 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_analog/analog_input.h"
+#include "pw_function/function.h"
+#include "pw_status/status.h"
+
+namespace pw::analog {
+
+// Interface for continuous sampling of one ADC channel, for rates at which
+// reading a sample per call to AnalogInput is too slow.
+//
+// The driver samples continuously into a ring of equally sized blocks, usually
+// with circular DMA. Each time a block fills, the callback receives it while
+// the driver fills the next one. With two blocks, this is the usual double
+// buffering with DMA half-transfer and transfer-complete interrupts:
+//
+//   std::array<int32_t, 2 * 256> samples;
+//
+//   adc_stream.Start(samples, /*block_size=*/256,
+//                    [](Status status, std::span<const int32_t> block) {
+//                      if (status.ok()) {
+//                        filter.Process(block);
+//                      }
+//                    });
+//
+// The ADC backend interface is up to the user to define and implement, as with
+// AnalogInput. Drivers implement DoStart() and DoStop(), and call
+// BlockComplete() each time a block fills.
+//
+// Start() and Stop() are not thread safe, and must not be called from the
+// callback.
+class SampleStream {
+ public:
+  // Called for each filled block, usually in interrupt context. The block is
+  // only valid until the driver reaches it again, so it must be processed or
+  // copied within one block period. If the driver reports that samples were
+  // lost, the callback is called with DATA_LOSS and an empty block; sampling
+  // continues.
+  using Callback = Function<void(Status, std::span<const int32_t>)>;
+
+  virtual ~SampleStream() = default;
+
+  // Starts sampling into buffer, which is split into blocks of block_size
+  // samples. buffer must hold at least two blocks and remain valid until
+  // Stop().
+  //
+  // Returns:
+  //   Ok: Sampling started.
+  //   FailedPrecondition: Sampling is already running.
+  //   InvalidArgument: buffer is not a multiple of block_size, or holds fewer
+  //       than two blocks.
+  //   Other statuses left up to the implementer.
+  Status Start(std::span<int32_t> buffer,
+               size_t block_size,
+               Callback&& callback);
+
+  // Stops sampling. The callback is not called after Stop() returns.
+  void Stop();
+
+  bool running() const { return running_; }
+
+  // The number of times samples were lost since Start().
+  uint32_t overrun_count() const { return overrun_count_; }
+
+  // Returns the range of the ADC samples.
+  // These values do not change at run time.
+  virtual AnalogInput::Limits GetLimits() const = 0;
+
+ protected:
+  constexpr SampleStream()
+      : block_size_(0),
+        block_count_(0),
+        next_block_(0),
+        overrun_count_(0),
+        running_(false) {}
+
+  // Called by the driver when the next block in the ring has filled. Blocks
+  // fill in order, starting with the first block of the buffer and wrapping
+  // around to it after the last.
+  void BlockComplete();
+
+  // Called by the driver when samples were lost, for example because the DMA
+  // overran or the ADC overflowed. The driver should resume with the first
+  // block of the buffer; the callback is told of the loss.
+  void Overrun();
+
+ private:
+  // Starts continuous sampling into the buffer.
+  virtual Status DoStart(std::span<int32_t> buffer, size_t block_size) = 0;
+
+  // Stops sampling. BlockComplete() and Overrun() must not be called after
+  // this returns, nor still be running.
+  virtual void DoStop() = 0;
+
+  std::span<int32_t> buffer_;
+  size_t block_size_;
+  size_t block_count_;
+  size_t next_block_;
+  uint32_t overrun_count_;
+  bool running_;
+  Callback callback_;
+};
+
+}  // namespace pw::analog
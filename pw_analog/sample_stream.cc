@@ -0,0 +1,77 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_analog/sample_stream.h"
+
+#include <utility>
+
+namespace pw::analog {
+
+Status SampleStream::Start(std::span<int32_t> buffer,
+                           size_t block_size,
+                           Callback&& callback) {
+  if (running_) {
+    return Status::FailedPrecondition();
+  }
+  if (block_size == 0 || buffer.size() % block_size != 0 ||
+      buffer.size() / block_size < 2) {
+    return Status::InvalidArgument();
+  }
+
+  buffer_ = buffer;
+  block_size_ = block_size;
+  block_count_ = buffer.size() / block_size;
+  next_block_ = 0;
+  overrun_count_ = 0;
+  callback_ = std::move(callback);
+
+  // The driver may complete a block as soon as it starts.
+  running_ = true;
+  if (Status status = DoStart(buffer, block_size); !status.ok()) {
+    running_ = false;
+    callback_ = nullptr;
+    return status;
+  }
+  return OkStatus();
+}
+
+void SampleStream::Stop() {
+  if (!running_) {
+    return;
+  }
+  DoStop();
+  running_ = false;
+  callback_ = nullptr;
+}
+
+void SampleStream::BlockComplete() {
+  if (!running_) {
+    return;
+  }
+  const std::span<const int32_t> block =
+      buffer_.subspan(next_block_ * block_size_, block_size_);
+  next_block_ = next_block_ + 1 == block_count_ ? 0 : next_block_ + 1;
+  callback_(OkStatus(), block);
+}
+
+void SampleStream::Overrun() {
+  if (!running_) {
+    return;
+  }
+  overrun_count_ += 1;
+  next_block_ = 0;
+  callback_(Status::DataLoss(), std::span<const int32_t>());
+}
+
+}  // namespace pw::analog
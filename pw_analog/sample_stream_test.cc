@@ -0,0 +1,162 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#include "pw_analog/sample_stream.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+
+namespace pw::analog {
+namespace {
+
+// Fake driver that fills blocks on demand with incrementing samples.
+class TestSampleStream : public SampleStream {
+ public:
+  AnalogInput::Limits GetLimits() const override { return {0, 4095}; }
+
+  // Fills the next block, as the DMA would, and reports it.
+  void FillBlock() {
+    for (size_t i = 0; i < block_size_; ++i) {
+      buffer_[position_ + i] = next_sample_++;
+    }
+    position_ = (position_ + block_size_) % buffer_.size();
+    BlockComplete();
+  }
+
+  void LoseSamples() {
+    position_ = 0;
+    Overrun();
+  }
+
+  Status start_status = OkStatus();
+  bool started = false;
+
+ private:
+  Status DoStart(std::span<int32_t> buffer, size_t block_size) override {
+    buffer_ = buffer;
+    block_size_ = block_size;
+    position_ = 0;
+    started = start_status.ok();
+    return start_status;
+  }
+
+  void DoStop() override { started = false; }
+
+  std::span<int32_t> buffer_;
+  size_t block_size_ = 0;
+  size_t position_ = 0;
+  int32_t next_sample_ = 0;
+};
+
+class SampleStreamTest : public ::testing::Test {
+ protected:
+  Status Start(size_t block_size) {
+    return stream_.Start(
+        buffer_, block_size, [this](Status status, std::span<const int32_t> b) {
+          last_status_ = status;
+          last_block_ = b;
+          callbacks_ += 1;
+        });
+  }
+
+  TestSampleStream stream_;
+  std::array<int32_t, 8> buffer_ = {};
+  Status last_status_;
+  std::span<const int32_t> last_block_;
+  size_t callbacks_ = 0;
+};
+
+TEST_F(SampleStreamTest, Start_InvalidBlockSize) {
+  EXPECT_EQ(Status::InvalidArgument(), Start(0));
+  EXPECT_EQ(Status::InvalidArgument(), Start(3));
+  EXPECT_EQ(Status::InvalidArgument(), Start(8));
+  EXPECT_FALSE(stream_.running());
+  EXPECT_FALSE(stream_.started);
+}
+
+TEST_F(SampleStreamTest, Start_AlreadyRunning) {
+  ASSERT_EQ(OkStatus(), Start(4));
+  EXPECT_EQ(Status::FailedPrecondition(), Start(4));
+  EXPECT_TRUE(stream_.running());
+}
+
+TEST_F(SampleStreamTest, Start_DriverError) {
+  stream_.start_status = Status::Unavailable();
+  EXPECT_EQ(Status::Unavailable(), Start(4));
+  EXPECT_FALSE(stream_.running());
+}
+
+TEST_F(SampleStreamTest, BlocksDeliveredInRingOrder) {
+  ASSERT_EQ(OkStatus(), Start(4));
+  ASSERT_TRUE(stream_.started);
+
+  stream_.FillBlock();
+  ASSERT_EQ(1u, callbacks_);
+  EXPECT_EQ(OkStatus(), last_status_);
+  EXPECT_EQ(buffer_.data(), last_block_.data());
+  ASSERT_EQ(4u, last_block_.size());
+  EXPECT_EQ(0, last_block_[0]);
+
+  stream_.FillBlock();
+  EXPECT_EQ(buffer_.data() + 4, last_block_.data());
+  EXPECT_EQ(4, last_block_[0]);
+
+  stream_.FillBlock();
+  EXPECT_EQ(buffer_.data(), last_block_.data());
+  EXPECT_EQ(8, last_block_[0]);
+  EXPECT_EQ(11, last_block_[3]);
+  EXPECT_EQ(3u, callbacks_);
+}
+
+TEST_F(SampleStreamTest, MoreThanTwoBlocks) {
+  ASSERT_EQ(OkStatus(), Start(2));
+
+  for (int block = 0; block < 5; ++block) {
+    stream_.FillBlock();
+  }
+  EXPECT_EQ(buffer_.data(), last_block_.data());
+  EXPECT_EQ(8, last_block_[0]);
+}
+
+TEST_F(SampleStreamTest, Overrun_ReportsDataLossAndRestartsRing) {
+  ASSERT_EQ(OkStatus(), Start(4));
+  stream_.FillBlock();
+
+  stream_.LoseSamples();
+  EXPECT_EQ(Status::DataLoss(), last_status_);
+  EXPECT_TRUE(last_block_.empty());
+  EXPECT_EQ(1u, stream_.overrun_count());
+  EXPECT_TRUE(stream_.running());
+
+  stream_.FillBlock();
+  EXPECT_EQ(OkStatus(), last_status_);
+  EXPECT_EQ(buffer_.data(), last_block_.data());
+  EXPECT_EQ(4, last_block_[0]);
+}
+
+TEST_F(SampleStreamTest, Stop_NoMoreCallbacks) {
+  ASSERT_EQ(OkStatus(), Start(4));
+  stream_.Stop();
+  EXPECT_FALSE(stream_.running());
+  EXPECT_FALSE(stream_.started);
+
+  stream_.FillBlock();
+  EXPECT_EQ(0u, callbacks_);
+
+  ASSERT_EQ(OkStatus(), Start(4));
+  EXPECT_EQ(0u, stream_.overrun_count());
+}
+
+}  // namespace
+}  // namespace pw::analog
@@ -0,0 +1,37 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <cstring>
+#include <span>
+
+#include "pw_assert_tokenized/handler.h"
+#include "pw_log/levels.h"
+#include "pw_log/log.h"
+#include "pw_log/options.h"
+#include "pw_tokenizer/base64.h"
+
+// Logs the token as a prefixed Base64 message, which detokenizers expand in
+// place, so the assert is displayed with the rest of the log. As with
+// pw_assert_log, the logger is responsible for crashing or rebooting the device
+// after a FATAL log.
+extern "C" void pw_assert_tokenized_HandleFailure(uint32_t token) {
+  std::byte encoded_token[sizeof(token)];
+  std::memcpy(encoded_token, &token, sizeof(token));
+
+  char message[pw::tokenizer::Base64EncodedBufferSize(sizeof(token))];
+  pw::tokenizer::PrefixedBase64Encode(encoded_token, message);
+
+  PW_LOG(PW_LOG_LEVEL_FATAL, PW_LOG_DEFAULT_FLAGS, "%s", message);
+  PW_UNREACHABLE;
+}
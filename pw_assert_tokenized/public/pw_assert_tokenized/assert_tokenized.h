@@ -0,0 +1,62 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <stdint.h>
+
+#include "pw_assert_tokenized/handler.h"
+#include "pw_preprocessor/util.h"
+#include "pw_tokenizer/tokenize.h"
+
+// Each assert failure is tokenized along with its file and line, so the code at
+// an assert site is the comparison and a single call with one constant
+// argument. The message, its arguments, and the values of compared arguments
+// are not part of the token and are not sent. They are still expanded in an
+// unreachable branch, so variables used only in assert messages are not
+// reported as unused, but they are never evaluated.
+#define _PW_ASSERT_TOKENIZED_FAILURE(reason, ...)                          \
+  do {                                                                     \
+    const uint32_t _pw_assert_tokenized_token =                            \
+        PW_TOKENIZE_STRING(__FILE__ ":" PW_STRINGIFY(__LINE__) ": " reason); \
+    if (0) {                                                               \
+      _pw_assert_tokenized_IgnoreArguments(0, __VA_ARGS__);                \
+    }                                                                      \
+    pw_assert_tokenized_HandleFailure(_pw_assert_tokenized_token);         \
+  } while (0)
+
+static inline void _pw_assert_tokenized_IgnoreArguments(int unused, ...) {
+  (void)unused;
+}
+
+#define PW_HANDLE_CRASH(...) _PW_ASSERT_TOKENIZED_FAILURE("Crash", __VA_ARGS__)
+
+#define PW_HANDLE_ASSERT_FAILURE(condition_string, ...) \
+  _PW_ASSERT_TOKENIZED_FAILURE("Check failed: " condition_string, __VA_ARGS__)
+
+// Sample string tokenized for a binary comparison:
+//
+//   foo.cc:25: Check failed: old_x < new_x
+//
+// The compared values are already in registers for the comparison, but passing
+// them would add instructions to every call site, so they are left out.
+#define PW_HANDLE_ASSERT_BINARY_COMPARE_FAILURE(arg_a_str,                \
+                                                arg_a_val,                \
+                                                comparison_op_str,        \
+                                                arg_b_str,                \
+                                                arg_b_val,                \
+                                                type_fmt,                 \
+                                                ...)                      \
+  _PW_ASSERT_TOKENIZED_FAILURE(                                           \
+      "Check failed: " arg_a_str " " comparison_op_str " " arg_b_str,     \
+      __VA_ARGS__)
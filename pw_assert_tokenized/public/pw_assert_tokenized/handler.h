@@ -0,0 +1,33 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <stdint.h>
+
+#include "pw_preprocessor/compiler.h"
+#include "pw_preprocessor/util.h"
+
+PW_EXTERN_C_START
+
+// Application-defined handler for failed asserts with pw_assert_tokenized. The
+// token is for a string of the form "<file>:<line>: <reason>", such as
+//
+//   "foo.cc:25: Check failed: old_x < new_x"
+//
+// The handler must not return. pw_assert_tokenized provides a handler that logs
+// the token with pw_log, in the :log_handler target; applications may instead
+// define their own, for example to store the token in a crash snapshot.
+void pw_assert_tokenized_HandleFailure(uint32_t token) PW_NO_RETURN;
+
+PW_EXTERN_C_END
@@ -0,0 +1,157 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_async/dispatcher.h"
+
+#include <mutex>
+
+namespace pw::async {
+
+using chrono::SystemClock;
+
+void Context::WakeAt(SystemClock::time_point deadline) {
+  std::lock_guard lock(dispatcher_.lock_);
+  if (!task_.timer_armed_ || deadline < task_.deadline_) {
+    task_.deadline_ = deadline;
+    task_.timer_armed_ = true;
+  }
+}
+
+Status Dispatcher::Post(Task& task) {
+  {
+    std::lock_guard lock(lock_);
+    if (task.active()) {
+      return Status::FailedPrecondition();
+    }
+    task.dispatcher_ = this;
+    task.woken_ = true;
+    task.timer_armed_ = false;
+    tasks_.push_back(task);
+  }
+
+  notification_.release();
+  return OkStatus();
+}
+
+Status Dispatcher::Cancel(Task& task) {
+  std::lock_guard lock(lock_);
+  if (task.dispatcher_ != this) {
+    return Status::NotFound();
+  }
+  tasks_.remove(task);
+  task.dispatcher_ = nullptr;
+  return OkStatus();
+}
+
+void Dispatcher::RunUntilStalled() {
+  while (true) {
+    const SystemClock::time_point now = SystemClock::now();
+
+    Task* task;
+    {
+      std::lock_guard lock(lock_);
+      task = TakeRunnable(now);
+    }
+    if (task == nullptr) {
+      return;
+    }
+
+    Context context(*this, *task);
+    const Poll result = task->DoPoll(context);
+
+    std::lock_guard lock(lock_);
+
+    // The task may have cancelled itself.
+    if (task->dispatcher_ != this) {
+      continue;
+    }
+
+    // Pending tasks go to the back of the list, so that a task which keeps
+    // waking itself does not starve the others.
+    tasks_.remove(*task);
+    if (result == Poll::kReady) {
+      task->dispatcher_ = nullptr;
+    } else {
+      tasks_.push_back(*task);
+    }
+  }
+}
+
+void Dispatcher::RequestStop() {
+  {
+    std::lock_guard lock(lock_);
+    stop_requested_ = true;
+  }
+  notification_.release();
+}
+
+void Dispatcher::Run() {
+  while (true) {
+    RunUntilStalled();
+
+    SystemClock::time_point deadline;
+    bool has_deadline;
+    {
+      std::lock_guard lock(lock_);
+      if (stop_requested_) {
+        stop_requested_ = false;
+        return;
+      }
+      has_deadline = NextDeadline(deadline);
+    }
+
+    // Wakeups that arrive before this are latched by the notification, so
+    // none is missed.
+    if (has_deadline) {
+      notification_.try_acquire_until(deadline);
+    } else {
+      notification_.acquire();
+    }
+  }
+}
+
+void Dispatcher::Wake(Task& task) {
+  {
+    std::lock_guard lock(lock_);
+    if (task.dispatcher_ != this) {
+      return;
+    }
+    task.woken_ = true;
+  }
+  notification_.release();
+}
+
+Task* Dispatcher::TakeRunnable(SystemClock::time_point now) {
+  for (Task& task : tasks_) {
+    if (task.woken_ || (task.timer_armed_ && task.deadline_ <= now)) {
+      task.woken_ = false;
+      task.timer_armed_ = false;
+      return &task;
+    }
+  }
+  return nullptr;
+}
+
+bool Dispatcher::NextDeadline(SystemClock::time_point& deadline) const {
+  bool found = false;
+  for (const Task& task : tasks_) {
+    if (task.timer_armed_ && (!found || task.deadline_ < deadline)) {
+      deadline = task.deadline_;
+      found = true;
+    }
+  }
+  return found;
+}
+
+}  // namespace pw::async
@@ -0,0 +1,203 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_async/dispatcher.h"
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+
+namespace pw::async {
+namespace {
+
+using namespace std::chrono_literals;
+using chrono::SystemClock;
+
+// Counts its polls and finishes after a set number of them.
+class CountingTask : public Task {
+ public:
+  explicit CountingTask(int polls_until_ready = 1)
+      : polls_until_ready_(polls_until_ready) {}
+
+  int polls = 0;
+  Waker waker;
+
+ private:
+  Poll DoPoll(Context& context) override {
+    polls += 1;
+    waker = context.GetWaker();
+    return polls < polls_until_ready_ ? Poll::kPending : Poll::kReady;
+  }
+
+  const int polls_until_ready_;
+};
+
+TEST(Dispatcher, PostedTask_PolledUntilReady) {
+  Dispatcher dispatcher;
+  CountingTask task(1);
+
+  ASSERT_EQ(OkStatus(), dispatcher.Post(task));
+  EXPECT_TRUE(task.active());
+
+  dispatcher.RunUntilStalled();
+  EXPECT_EQ(task.polls, 1);
+  EXPECT_FALSE(task.active());
+}
+
+TEST(Dispatcher, PendingTask_PolledOnlyWhenWoken) {
+  Dispatcher dispatcher;
+  CountingTask task(3);
+
+  ASSERT_EQ(OkStatus(), dispatcher.Post(task));
+  dispatcher.RunUntilStalled();
+  EXPECT_EQ(task.polls, 1);
+
+  dispatcher.RunUntilStalled();
+  EXPECT_EQ(task.polls, 1);
+
+  // Several wakeups before a poll poll the task once.
+  task.waker.Wake();
+  task.waker.Wake();
+  dispatcher.RunUntilStalled();
+  EXPECT_EQ(task.polls, 2);
+
+  task.waker.Wake();
+  dispatcher.RunUntilStalled();
+  EXPECT_EQ(task.polls, 3);
+  EXPECT_FALSE(task.active());
+
+  // Waking a finished task does nothing.
+  task.waker.Wake();
+  dispatcher.RunUntilStalled();
+  EXPECT_EQ(task.polls, 3);
+}
+
+TEST(Dispatcher, PostActiveTask_FailedPrecondition) {
+  Dispatcher dispatcher;
+  CountingTask task(2);
+
+  ASSERT_EQ(OkStatus(), dispatcher.Post(task));
+  EXPECT_EQ(Status::FailedPrecondition(), dispatcher.Post(task));
+}
+
+TEST(Dispatcher, Cancel_TaskNotPolledAgain) {
+  Dispatcher dispatcher;
+  CountingTask task(2);
+
+  ASSERT_EQ(OkStatus(), dispatcher.Post(task));
+  dispatcher.RunUntilStalled();
+
+  EXPECT_EQ(OkStatus(), dispatcher.Cancel(task));
+  EXPECT_FALSE(task.active());
+  EXPECT_EQ(Status::NotFound(), dispatcher.Cancel(task));
+
+  task.waker.Wake();
+  dispatcher.RunUntilStalled();
+  EXPECT_EQ(task.polls, 1);
+}
+
+struct PollLog {
+  int ids[6] = {};
+  int count = 0;
+};
+
+// Wakes itself until it has been polled three times.
+class SelfWakingTask : public Task {
+ public:
+  SelfWakingTask(PollLog& log, int id) : log_(log), id_(id) {}
+
+ private:
+  Poll DoPoll(Context& context) override {
+    log_.ids[log_.count++] = id_;
+    polls_ += 1;
+    if (polls_ == 3) {
+      return Poll::kReady;
+    }
+    context.GetWaker().Wake();
+    return Poll::kPending;
+  }
+
+  PollLog& log_;
+  const int id_;
+  int polls_ = 0;
+};
+
+TEST(Dispatcher, SelfWakingTasks_TakeTurns) {
+  Dispatcher dispatcher;
+  PollLog log;
+  SelfWakingTask first(log, 1);
+  SelfWakingTask second(log, 2);
+
+  ASSERT_EQ(OkStatus(), dispatcher.Post(first));
+  ASSERT_EQ(OkStatus(), dispatcher.Post(second));
+  dispatcher.RunUntilStalled();
+
+  EXPECT_FALSE(first.active());
+  EXPECT_FALSE(second.active());
+  ASSERT_EQ(log.count, 6);
+  for (int i = 0; i < log.count; ++i) {
+    EXPECT_EQ(log.ids[i], i % 2 + 1);
+  }
+}
+
+// Waits on a timer, then stops the dispatcher.
+class SleepingTask : public Task {
+ public:
+  explicit SleepingTask(SystemClock::duration delay) : delay_(delay) {}
+
+  SystemClock::time_point deadline;
+  SystemClock::time_point woken_at;
+
+ private:
+  Poll DoPoll(Context& context) override {
+    if (!slept_) {
+      slept_ = true;
+      deadline = SystemClock::TimePointAfterAtLeast(delay_);
+      context.WakeAt(deadline);
+      return Poll::kPending;
+    }
+    woken_at = SystemClock::now();
+    context.dispatcher().RequestStop();
+    return Poll::kReady;
+  }
+
+  const SystemClock::duration delay_;
+  bool slept_ = false;
+};
+
+TEST(Dispatcher, Timer_WakesTaskAfterDeadline) {
+  Dispatcher dispatcher;
+  SleepingTask task(SystemClock::for_at_least(5ms));
+
+  ASSERT_EQ(OkStatus(), dispatcher.Post(task));
+  dispatcher.Start();
+
+  EXPECT_FALSE(task.active());
+  EXPECT_GE(task.woken_at, task.deadline);
+}
+
+TEST(Dispatcher, RequestStop_RunReturnsWhenIdle) {
+  Dispatcher dispatcher;
+  CountingTask task(2);
+
+  ASSERT_EQ(OkStatus(), dispatcher.Post(task));
+  dispatcher.RequestStop();
+  dispatcher.Start();
+
+  EXPECT_EQ(task.polls, 1);
+  EXPECT_TRUE(task.active());
+}
+
+}  // namespace
+}  // namespace pw::async
@@ -0,0 +1,141 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_async/future.h"
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+
+namespace pw::async {
+namespace {
+
+// Waits for a Future and records its value.
+class WaitingTask : public Task {
+ public:
+  explicit WaitingTask(Future<Status>& future) : future_(future) {}
+
+  int polls = 0;
+  std::optional<Status> result;
+
+ protected:
+  Poll DoPoll(Context& context) override {
+    polls += 1;
+    result = future_.Take(context);
+    return result.has_value() ? Poll::kReady : Poll::kPending;
+  }
+
+  Future<Status>& future_;
+};
+
+TEST(Future, Set_WakesWaitingTask) {
+  Dispatcher dispatcher;
+  Future<Status> future;
+  WaitingTask task(future);
+
+  ASSERT_EQ(OkStatus(), dispatcher.Post(task));
+  dispatcher.RunUntilStalled();
+  EXPECT_EQ(task.polls, 1);
+  EXPECT_FALSE(future.ready());
+
+  future.Set(Status::DataLoss());
+  EXPECT_TRUE(future.ready());
+
+  dispatcher.RunUntilStalled();
+  EXPECT_EQ(task.polls, 2);
+  EXPECT_EQ(task.result, Status::DataLoss());
+  EXPECT_FALSE(future.ready());
+}
+
+TEST(Future, SetBeforePoll_ReadyOnFirstPoll) {
+  Dispatcher dispatcher;
+  Future<Status> future;
+  WaitingTask task(future);
+
+  future.Set(OkStatus());
+  ASSERT_EQ(OkStatus(), dispatcher.Post(task));
+  dispatcher.RunUntilStalled();
+
+  EXPECT_EQ(task.polls, 1);
+  EXPECT_EQ(task.result, OkStatus());
+}
+
+TEST(Future, Setter_CompletesFromCallback) {
+  Dispatcher dispatcher;
+  Future<Status> future;
+  WaitingTask task(future);
+
+  Function<void(Status)> callback = future.Setter();
+
+  ASSERT_EQ(OkStatus(), dispatcher.Post(task));
+  dispatcher.RunUntilStalled();
+
+  callback(Status::Unavailable());
+  dispatcher.RunUntilStalled();
+  EXPECT_EQ(task.result, Status::Unavailable());
+}
+
+// Stops the dispatcher once its future is set.
+class StoppingTask : public WaitingTask {
+ public:
+  using WaitingTask::WaitingTask;
+
+ private:
+  Poll DoPoll(Context& context) override {
+    Poll poll = WaitingTask::DoPoll(context);
+    if (poll == Poll::kReady) {
+      context.dispatcher().RequestStop();
+    }
+    return poll;
+  }
+};
+
+// Sets a future after waiting on a timer.
+class SettingTask : public Task {
+ public:
+  explicit SettingTask(Future<Status>& future) : future_(future) {}
+
+ private:
+  Poll DoPoll(Context& context) override {
+    if (!slept_) {
+      slept_ = true;
+      context.WakeAfter(chrono::SystemClock::for_at_least(
+          std::chrono::milliseconds(1)));
+      return Poll::kPending;
+    }
+    future_.Set(Status::Cancelled());
+    return Poll::kReady;
+  }
+
+  Future<Status>& future_;
+  bool slept_ = false;
+};
+
+TEST(Future, SetByAnotherTask_RunReturnsOnceDone) {
+  Dispatcher dispatcher;
+  Future<Status> future;
+  StoppingTask waiting_task(future);
+  SettingTask setting_task(future);
+
+  ASSERT_EQ(OkStatus(), dispatcher.Post(waiting_task));
+  ASSERT_EQ(OkStatus(), dispatcher.Post(setting_task));
+  dispatcher.Start();
+
+  EXPECT_FALSE(waiting_task.active());
+  EXPECT_FALSE(setting_task.active());
+  EXPECT_EQ(waiting_task.result, Status::Cancelled());
+}
+
+}  // namespace
+}  // namespace pw::async
@@ -0,0 +1,198 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_chrono/system_clock.h"
+#include "pw_containers/intrusive_list.h"
+#include "pw_status/status.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/timed_thread_notification.h"
+#include "pw_thread/thread_core.h"
+
+namespace pw::async {
+
+class Context;
+class Dispatcher;
+class Task;
+
+// The result of polling a task.
+enum class Poll : bool {
+  kPending,  // The task is waiting, and will be polled again when woken.
+  kReady,    // The task is finished, and is removed from its dispatcher.
+};
+
+// Wakes a task so that its dispatcher polls it again. A task gets a Waker from
+// its Context and hands it to whatever it is waiting on, such as a Future or a
+// driver's completion callback.
+//
+// Waking a task that has finished or been cancelled does nothing, but a Waker
+// must not be used after its task is destroyed.
+class Waker {
+ public:
+  constexpr Waker() : dispatcher_(nullptr), task_(nullptr) {}
+
+  // Schedules the task to be polled. Waking a task more than once before it is
+  // polled polls it once. Waking an empty Waker does nothing.
+  //
+  // This is IRQ and thread safe.
+  void Wake() const;
+
+  bool empty() const { return task_ == nullptr; }
+
+ private:
+  friend class Context;
+
+  constexpr Waker(Dispatcher& dispatcher, Task& task)
+      : dispatcher_(&dispatcher), task_(&task) {}
+
+  Dispatcher* dispatcher_;
+  Task* task_;
+};
+
+// Passed to Task::DoPoll() to let the task arrange to be polled again.
+class Context {
+ public:
+  Context(const Context&) = delete;
+  Context& operator=(const Context&) = delete;
+
+  Dispatcher& dispatcher() const { return dispatcher_; }
+
+  // Returns a Waker that wakes the task being polled.
+  Waker GetWaker() const { return Waker(dispatcher_, task_); }
+
+  // Wakes the task being polled once the deadline is reached. A task has one
+  // timer, which is cleared each time the task is polled. If the timer is set
+  // more than once during a poll, the earliest deadline is kept.
+  void WakeAt(chrono::SystemClock::time_point deadline);
+
+  void WakeAfter(chrono::SystemClock::duration delay) {
+    WakeAt(chrono::SystemClock::TimePointAfterAtLeast(delay));
+  }
+
+ private:
+  friend class Dispatcher;
+
+  constexpr Context(Dispatcher& dispatcher, Task& task)
+      : dispatcher_(dispatcher), task_(task) {}
+
+  Dispatcher& dispatcher_;
+  Task& task_;
+};
+
+// An asynchronous operation, written as a state machine that the dispatcher
+// polls. Each call to DoPoll() advances the task as far as it can without
+// blocking, then returns kPending after arranging to be woken, or kReady when
+// the task is done.
+//
+//   class Blink : public pw::async::Task {
+//    private:
+//     pw::async::Poll DoPoll(pw::async::Context& context) override {
+//       ToggleLed();
+//       context.WakeAfter(std::chrono::milliseconds(500));
+//       return pw::async::Poll::kPending;
+//     }
+//   };
+//
+// Tasks are not copied or allocated by the dispatcher; a task must outlive its
+// time on the dispatcher.
+class Task : public IntrusiveList<Task>::Item {
+ public:
+  constexpr Task()
+      : dispatcher_(nullptr), woken_(false), timer_armed_(false), deadline_() {}
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  virtual ~Task() = default;
+
+  // True if the task is posted to a dispatcher and has not finished.
+  bool active() const { return dispatcher_ != nullptr; }
+
+ private:
+  friend class Context;
+  friend class Dispatcher;
+
+  virtual Poll DoPoll(Context& context) = 0;
+
+  // These members are guarded by the dispatcher's lock.
+  Dispatcher* dispatcher_;
+  bool woken_;
+  bool timer_armed_;
+  chrono::SystemClock::time_point deadline_;
+};
+
+// Runs tasks on a single thread. Tasks run one at a time, each until it
+// returns from DoPoll(), so many concurrent operations share one stack.
+//
+// The dispatcher is a ThreadCore: start a thread with it to poll tasks as they
+// are woken. The thread sleeps while no task is runnable, until a task is woken
+// or its timer expires. Alternatively, call RunUntilStalled() from an existing
+// loop.
+class Dispatcher : public thread::ThreadCore {
+ public:
+  Dispatcher() : stop_requested_(false) {}
+
+  Dispatcher(const Dispatcher&) = delete;
+  Dispatcher& operator=(const Dispatcher&) = delete;
+
+  // Adds a task to the dispatcher. The task is polled as soon as the
+  // dispatcher runs. Returns FAILED_PRECONDITION if the task is already
+  // active. This is thread safe.
+  Status Post(Task& task) PW_LOCKS_EXCLUDED(lock_);
+
+  // Removes a task without polling it again. Returns NOT_FOUND if the task is
+  // not posted to this dispatcher. This must be called from the dispatcher's
+  // thread, for example from another task, so that the task is not being
+  // polled.
+  Status Cancel(Task& task) PW_LOCKS_EXCLUDED(lock_);
+
+  // Polls tasks until none is runnable, then returns.
+  void RunUntilStalled() PW_LOCKS_EXCLUDED(lock_);
+
+  // Makes Run() return once no task is runnable. This is IRQ and thread safe.
+  void RequestStop() PW_LOCKS_EXCLUDED(lock_);
+
+ private:
+  friend class Context;
+  friend class Waker;
+
+  // Polls tasks as they are woken, until RequestStop() is called.
+  void Run() final PW_LOCKS_EXCLUDED(lock_);
+
+  void Wake(Task& task) PW_LOCKS_EXCLUDED(lock_);
+
+  // Returns the first task that is woken or whose timer has expired, or
+  // nullptr if there is none. Clears the task's wakeup and timer.
+  Task* TakeRunnable(chrono::SystemClock::time_point now)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the earliest armed timer, if any task has one.
+  bool NextDeadline(chrono::SystemClock::time_point& deadline) const
+      PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  mutable sync::InterruptSpinLock lock_;
+  IntrusiveList<Task> tasks_ PW_GUARDED_BY(lock_);
+  bool stop_requested_ PW_GUARDED_BY(lock_);
+
+  sync::TimedThreadNotification notification_;
+};
+
+inline void Waker::Wake() const {
+  if (task_ != nullptr) {
+    dispatcher_->Wake(*task_);
+  }
+}
+
+}  // namespace pw::async
@@ -0,0 +1,105 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "pw_async/dispatcher.h"
+#include "pw_function/function.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+
+namespace pw::async {
+
+// A value that a task waits for, produced by some other context: an interrupt,
+// another thread, or the callback of an asynchronous API such as
+// pw::kvs::AsyncFlashMemory or a pw_rpc client call. The Future holds the
+// value, so nothing is allocated.
+//
+//   class EraseTask : public pw::async::Task {
+//    private:
+//     pw::async::Poll DoPoll(pw::async::Context& context) override {
+//       if (!started_) {
+//         started_ = true;
+//         flash_.Erase(0, 1, erased_.Setter());
+//       }
+//       std::optional<pw::Status> status = erased_.Take(context);
+//       if (!status.has_value()) {
+//         return pw::async::Poll::kPending;
+//       }
+//       PW_LOG_INFO("Erase finished: %s", status->str());
+//       return pw::async::Poll::kReady;
+//     }
+//
+//     bool started_ = false;
+//     pw::async::Future<pw::Status> erased_;
+//   };
+//
+// A Future is used by one task at a time, and may be reused once its value is
+// taken.
+template <typename T>
+class Future {
+ public:
+  Future() = default;
+
+  Future(const Future&) = delete;
+  Future& operator=(const Future&) = delete;
+
+  // Sets the value and wakes the task waiting for it. A value that was set but
+  // not yet taken is replaced. This is thread safe, and IRQ safe if moving a T
+  // is.
+  void Set(T value) PW_LOCKS_EXCLUDED(lock_) {
+    Waker waker;
+    {
+      std::lock_guard lock(lock_);
+      value_ = std::move(value);
+      waker = std::exchange(waker_, Waker());
+    }
+    waker.Wake();
+  }
+
+  // Returns a callback that sets this Future, for APIs that report their
+  // result through a callback. The Future must outlive the callback.
+  Function<void(T)> Setter() {
+    return [this](T value) { Set(std::move(value)); };
+  }
+
+  // Called from a task's DoPoll(). Returns the value and clears the Future if
+  // the value is set. Otherwise, returns std::nullopt and wakes the task when
+  // the value is set.
+  std::optional<T> Take(Context& context) PW_LOCKS_EXCLUDED(lock_) {
+    std::lock_guard lock(lock_);
+    if (!value_.has_value()) {
+      waker_ = context.GetWaker();
+      return std::nullopt;
+    }
+    std::optional<T> value = std::move(value_);
+    value_.reset();
+    return value;
+  }
+
+  bool ready() const PW_LOCKS_EXCLUDED(lock_) {
+    std::lock_guard lock(lock_);
+    return value_.has_value();
+  }
+
+ private:
+  mutable sync::InterruptSpinLock lock_;
+  std::optional<T> value_ PW_GUARDED_BY(lock_);
+  Waker waker_ PW_GUARDED_BY(lock_);
+};
+
+}  // namespace pw::async
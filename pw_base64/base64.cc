@@ -14,13 +14,18 @@
 
 #include "pw_base64/base64.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+
+#include "pw_base64_private/config.h"
 
 namespace pw::base64 {
 namespace {
 
 // Encoding functions
 constexpr size_t kEncodedGroupSize = 4;
+constexpr size_t kDecodedGroupSize = 3;
 constexpr char kChar62 = '+';  // URL safe encoding uses - instead
 constexpr char kChar63 = '/';  // URL safe encoding uses _ instead
 constexpr char kPadding = '=';
@@ -33,80 +38,164 @@ constexpr char encode_bits[64] = {
     'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x',     'y',    'z',
     '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', kChar62, kChar63};
 
-constexpr char BitGroup0Char(uint8_t byte0) {
-  return encode_bits[(byte0 & 0b11111100) >> 2];
-}
-constexpr char BitGroup1Char(uint8_t byte0, uint8_t byte1 = 0) {
-  return encode_bits[((byte0 & 0b00000011) << 4) | ((byte1 & 0b11110000) >> 4)];
+// Encodes one group, which is packed into the low 24 bits of a word.
+inline void EncodeGroup(uint32_t group, char* output) {
+  output[0] = encode_bits[(group >> 18) & 0b111111];
+  output[1] = encode_bits[(group >> 12) & 0b111111];
+  output[2] = encode_bits[(group >> 6) & 0b111111];
+  output[3] = encode_bits[group & 0b111111];
 }
-constexpr char BitGroup2Char(uint8_t byte1, uint8_t byte2 = 0) {
-  return encode_bits[((byte1 & 0b00001111) << 2) | ((byte2 & 0b11000000) >> 6)];
+
+// Encodes the last 1 or 2 bytes, padded with =, to stay Python-compatible.
+void EncodeFinalGroup(const uint8_t* bytes, size_t remaining, char* output) {
+  uint32_t group = uint32_t{bytes[0]} << 16;
+  if (remaining == 2u) {
+    group |= uint32_t{bytes[1]} << 8;
+  }
+  EncodeGroup(group, output);
+  output[3] = kPadding;
+  if (remaining == 1u) {
+    output[2] = kPadding;
+  }
 }
-constexpr char BitGroup3Char(uint8_t byte2) {
-  return encode_bits[byte2 & 0b00111111];
+
+void EncodeGroups(const uint8_t* bytes, size_t groups, char* output) {
+#if PW_BASE64_USE_SIMD
+  const size_t encoded =
+      _pw_Base64InternalEncodeGroupsSimd(bytes, groups, output);
+  bytes += encoded * kDecodedGroupSize;
+  output += encoded * kEncodedGroupSize;
+  groups -= encoded;
+#endif  // PW_BASE64_USE_SIMD
+  _pw_Base64InternalEncodeGroupsScalar(bytes, groups, output);
 }
 
 // Decoding functions
-constexpr char kMinValidChar = '+';
-constexpr char kMaxValidChar = 'z';
 constexpr uint8_t kX = 0xff;  // Value used for invalid characters
 
+constexpr uint8_t DecodeChar(char ch) {
+  if (ch >= 'A' && ch <= 'Z') {
+    return ch - 'A';
+  }
+  if (ch >= 'a' && ch <= 'z') {
+    return ch - 'a' + 26;
+  }
+  if (ch >= '0' && ch <= '9') {
+    return ch - '0' + 52;
+  }
+  if (ch == kChar62 || ch == '-') {
+    return 62;
+  }
+  if (ch == kChar63 || ch == '_') {
+    return 63;
+  }
+  if (ch == kPadding) {
+    return 0;
+  }
+  return kX;
+}
+
 // Table that decodes a Base64 character to its 6-bit value. Supports the
-// standard (+/) and URL-safe (-_) alphabets. Starts from the lowest-value valid
-// character, which is +.
-constexpr uint8_t decode_char[] = {
-    62, kX, 62, kX, 63, 52, 53, 54, 55, 56,  //  0 - 09
-    57, 58, 59, 60, 61, kX, kX, kX, 0,  kX,  // 10 - 19
-    kX, kX, 0,  1,  2,  3,  4,  5,  6,  7,   // 20 - 29
-    8,  9,  10, 11, 12, 13, 14, 15, 16, 17,  // 30 - 39
-    18, 19, 20, 21, 22, 23, 24, 25, kX, kX,  // 40 - 49
-    kX, kX, 63, kX, 26, 27, 28, 29, 30, 31,  // 50 - 59
-    32, 33, 34, 35, 36, 37, 38, 39, 40, 41,  // 60 - 69
-    42, 43, 44, 45, 46, 47, 48, 49, 50, 51,  // 70 - 79
+// standard (+/) and URL-safe (-_) alphabets. It covers every character value,
+// so any character can be looked up without a range check.
+struct DecodeTable {
+  constexpr DecodeTable() : values{} {
+    for (size_t i = 0; i < sizeof(values); ++i) {
+      values[i] = DecodeChar(static_cast<char>(i));
+    }
+  }
+  uint8_t values[256];
 };
 
+constexpr DecodeTable decode_char;
+
 constexpr uint8_t CharToBits(char ch) {
-  return decode_char[ch - kMinValidChar];
+  return decode_char.values[static_cast<uint8_t>(ch)];
 }
 
-constexpr uint8_t Byte0(uint8_t bits0, uint8_t bits1) {
-  return (bits0 << 2) | ((bits1 & 0b110000) >> 4);
+// Decodes whole groups and reports whether they were all valid. Decoding can
+// occur in place, since each group is read before its bytes are written.
+bool DecodeGroups(const char* base64, size_t groups, uint8_t* output) {
+#if PW_BASE64_USE_SIMD
+  const size_t decoded =
+      _pw_Base64InternalDecodeGroupsSimd(base64, groups, output);
+  base64 += decoded * kEncodedGroupSize;
+  output += decoded * kDecodedGroupSize;
+  groups -= decoded;
+#endif  // PW_BASE64_USE_SIMD
+  return _pw_Base64InternalDecodeGroupsScalar(base64, groups, output);
 }
-constexpr uint8_t Byte1(uint8_t bits1, uint8_t bits2) {
-  return ((bits1 & 0b001111) << 4) | ((bits2 & 0b111100) >> 2);
-}
-constexpr uint8_t Byte2(uint8_t bits2, uint8_t bits3) {
-  return ((bits2 & 0b000011) << 6) | bits3;
+
+size_t PaddingSize(const char* base64, size_t base64_size_bytes) {
+  if (base64[base64_size_bytes - 2] == kPadding) {
+    return 2;
+  }
+  if (base64[base64_size_bytes - 1] == kPadding) {
+    return 1;
+  }
+  return 0;
 }
 
 }  // namespace
 
+extern "C" void _pw_Base64InternalEncodeGroupsScalar(const void* binary_data,
+                                                     size_t groups,
+                                                     char* output) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(binary_data);
+
+  // Load each group of 3 source bytes into a word and encode it as 4 output
+  // characters.
+  for (; groups > 0u; --groups) {
+    EncodeGroup((uint32_t{bytes[0]} << 16) | (uint32_t{bytes[1]} << 8) |
+                    uint32_t{bytes[2]},
+                output);
+    bytes += kDecodedGroupSize;
+    output += kEncodedGroupSize;
+  }
+}
+
+extern "C" bool _pw_Base64InternalDecodeGroupsScalar(const char* base64,
+                                                     size_t groups,
+                                                     void* output) {
+  uint8_t* binary = static_cast<uint8_t*>(output);
+
+  // Invalid characters decode as kX, which has bits that valid characters
+  // don't. OR the values together to check them all with one branch at the
+  // end.
+  uint32_t all_bits = 0;
+  for (; groups > 0u; --groups) {
+    const uint32_t bits0 = CharToBits(base64[0]);
+    const uint32_t bits1 = CharToBits(base64[1]);
+    const uint32_t bits2 = CharToBits(base64[2]);
+    const uint32_t bits3 = CharToBits(base64[3]);
+    all_bits |= bits0 | bits1 | bits2 | bits3;
+
+    const uint32_t group = (bits0 << 18) | (bits1 << 12) | (bits2 << 6) | bits3;
+    binary[0] = static_cast<uint8_t>(group >> 16);
+    binary[1] = static_cast<uint8_t>(group >> 8);
+    binary[2] = static_cast<uint8_t>(group);
+
+    base64 += kEncodedGroupSize;
+    binary += kDecodedGroupSize;
+  }
+  return all_bits <= 0b111111;
+}
+
 extern "C" void pw_Base64Encode(const void* binary_data,
                                 const size_t binary_size_bytes,
                                 char* output) {
   const uint8_t* bytes = static_cast<const uint8_t*>(binary_data);
 
-  // Encode groups of 3 source bytes into 4 output characters.
-  size_t remaining = binary_size_bytes;
-  for (; remaining >= 3u; remaining -= 3u, bytes += 3) {
-    *output++ = BitGroup0Char(bytes[0]);
-    *output++ = BitGroup1Char(bytes[0], bytes[1]);
-    *output++ = BitGroup2Char(bytes[1], bytes[2]);
-    *output++ = BitGroup3Char(bytes[2]);
-  }
+  const size_t groups = binary_size_bytes / kDecodedGroupSize;
+  EncodeGroups(bytes, groups, output);
 
   // If the source data length isn't a multiple of 3, pad the end with either 1
-  // or 2 '=' characters, to stay Python-compatible.
+  // or 2 '=' characters.
+  const size_t remaining = binary_size_bytes % kDecodedGroupSize;
   if (remaining > 0u) {
-    *output++ = BitGroup0Char(bytes[0]);
-    if (remaining == 1u) {
-      *output++ = BitGroup1Char(bytes[0]);
-      *output++ = kPadding;
-    } else {
-      *output++ = BitGroup1Char(bytes[0], bytes[1]);
-      *output++ = BitGroup2Char(bytes[1]);
-    }
-    *output++ = kPadding;
+    EncodeFinalGroup(&bytes[groups * kDecodedGroupSize],
+                     remaining,
+                     &output[groups * kEncodedGroupSize]);
   }
 }
 
@@ -118,26 +207,11 @@ extern "C" size_t pw_Base64Decode(const char* base64,
     return 0;
   }
 
-  uint8_t* binary = static_cast<uint8_t*>(output);
-  for (size_t ch = 0; ch < base64_size_bytes; ch += kEncodedGroupSize) {
-    const uint8_t char0 = CharToBits(base64[ch + 0]);
-    const uint8_t char1 = CharToBits(base64[ch + 1]);
-    const uint8_t char2 = CharToBits(base64[ch + 2]);
-    const uint8_t char3 = CharToBits(base64[ch + 3]);
-
-    *binary++ = Byte0(char0, char1);
-    *binary++ = Byte1(char1, char2);
-    *binary++ = Byte2(char2, char3);
-  }
-
-  size_t pad = 0;
-  if (base64[base64_size_bytes - 2] == kPadding) {
-    pad = 2;
-  } else if (base64[base64_size_bytes - 1] == kPadding) {
-    pad = 1;
-  }
-
-  return binary - static_cast<uint8_t*>(output) - pad;
+  // Check the padding first, since decoding in place overwrites it.
+  const size_t padding = PaddingSize(base64, base64_size_bytes);
+  const size_t groups = base64_size_bytes / kEncodedGroupSize;
+  DecodeGroups(base64, groups, static_cast<uint8_t*>(output));
+  return groups * kDecodedGroupSize - padding;
 }
 
 extern "C" bool pw_Base64IsValid(const char* base64_data, size_t base64_size) {
@@ -146,8 +220,7 @@ extern "C" bool pw_Base64IsValid(const char* base64_data, size_t base64_size) {
   }
 
   for (size_t i = 0; i < base64_size; ++i) {
-    if (base64_data[i] < kMinValidChar || base64_data[i] > kMaxValidChar ||
-        CharToBits(base64_data[i]) == kX /* invalid char */) {
+    if (CharToBits(base64_data[i]) == kX /* invalid char */) {
       return false;
     }
   }
@@ -166,10 +239,177 @@ size_t Encode(std::span<const std::byte> binary,
 
 size_t Decode(std::string_view base64, std::span<std::byte> output_buffer) {
   if (output_buffer.size_bytes() < MaxDecodedSize(base64.size()) ||
-      !IsValid(base64)) {
+      base64.size() % kEncodedGroupSize != 0u || base64.empty()) {
+    return 0;
+  }
+
+  // Check the characters while decoding them, rather than in a separate pass.
+  const size_t padding = PaddingSize(base64.data(), base64.size());
+  if (!DecodeGroups(base64.data(),
+                    base64.size() / kEncodedGroupSize,
+                    reinterpret_cast<uint8_t*>(output_buffer.data()))) {
     return 0;
   }
-  return Decode(base64, output_buffer.data());
+  return MaxDecodedSize(base64.size()) - padding;
+}
+
+StatusWithSize Encoder::Encode(std::span<const std::byte> binary,
+                               std::span<char> output_buffer) {
+  const size_t groups =
+      (pending_size_ + binary.size_bytes()) / kDecodedGroupSize;
+  if (output_buffer.size_bytes() < groups * kEncodedGroupSize) {
+    return StatusWithSize::ResourceExhausted();
+  }
+
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(binary.data());
+  size_t remaining = binary.size_bytes();
+  char* output = output_buffer.data();
+
+  // Complete the group left over from the previous call, if there is one.
+  if (pending_size_ != 0u) {
+    const size_t copied =
+        std::min(remaining, kDecodedGroupSize - pending_size_);
+    std::memcpy(&pending_[pending_size_], bytes, copied);
+    pending_size_ += copied;
+    bytes += copied;
+    remaining -= copied;
+
+    if (pending_size_ < kDecodedGroupSize) {
+      return StatusWithSize(0);
+    }
+    EncodeGroups(pending_.data(), 1, output);
+    output += kEncodedGroupSize;
+    pending_size_ = 0;
+  }
+
+  const size_t whole_groups = remaining / kDecodedGroupSize;
+  EncodeGroups(bytes, whole_groups, output);
+  output += whole_groups * kEncodedGroupSize;
+  bytes += whole_groups * kDecodedGroupSize;
+  remaining -= whole_groups * kDecodedGroupSize;
+
+  std::memcpy(pending_.data(), bytes, remaining);
+  pending_size_ = remaining;
+  return StatusWithSize(output - output_buffer.data());
+}
+
+StatusWithSize Encoder::Finish(std::span<char> output_buffer) {
+  if (pending_size_ == 0u) {
+    return StatusWithSize(0);
+  }
+  if (output_buffer.size_bytes() < kEncodedGroupSize) {
+    return StatusWithSize::ResourceExhausted();
+  }
+  EncodeFinalGroup(pending_.data(), pending_size_, output_buffer.data());
+  pending_size_ = 0;
+  return StatusWithSize(kEncodedGroupSize);
+}
+
+StatusWithSize Decoder::Decode(std::string_view base64,
+                               std::span<std::byte> output_buffer) {
+  if (failed_) {
+    return StatusWithSize::DataLoss();
+  }
+
+  const size_t groups = (pending_size_ + base64.size()) / kEncodedGroupSize;
+  if (output_buffer.size_bytes() < groups * kDecodedGroupSize) {
+    return StatusWithSize::ResourceExhausted();
+  }
+
+  const char* input = base64.data();
+  size_t remaining = base64.size();
+  std::byte* output = output_buffer.data();
+
+  // Complete the group left over from the previous call, if there is one.
+  if (pending_size_ != 0u) {
+    const size_t copied =
+        std::min(remaining, kEncodedGroupSize - pending_size_);
+    std::memcpy(&pending_[pending_size_], input, copied);
+    pending_size_ += copied;
+    input += copied;
+    remaining -= copied;
+
+    if (pending_size_ < kEncodedGroupSize) {
+      return StatusWithSize(0);
+    }
+    pending_size_ = 0;
+    if (Status status = DecodeWithPadding(pending_.data(), 1, output);
+        !status.ok()) {
+      return StatusWithSize(status, 0);
+    }
+  }
+
+  const size_t whole_groups = remaining / kEncodedGroupSize;
+  if (Status status = DecodeWithPadding(input, whole_groups, output);
+      !status.ok()) {
+    return StatusWithSize(status, 0);
+  }
+  input += whole_groups * kEncodedGroupSize;
+  remaining -= whole_groups * kEncodedGroupSize;
+
+  if (remaining != 0u && padded_) {
+    failed_ = true;
+    return StatusWithSize::DataLoss();
+  }
+  std::memcpy(pending_.data(), input, remaining);
+  pending_size_ = remaining;
+  return StatusWithSize(output - output_buffer.data());
+}
+
+Status Decoder::Finish() {
+  const bool complete = pending_size_ == 0u && !failed_;
+  Reset();
+  return complete ? OkStatus() : Status::DataLoss();
+}
+
+// Decodes whole groups, the last of which may be padded, and advances output
+// past the decoded bytes.
+Status Decoder::DecodeWithPadding(const char* base64,
+                                  size_t groups,
+                                  std::byte*& output) {
+  if (groups == 0u) {
+    return OkStatus();
+  }
+
+  // Data after a padded group is an error, so = may only be in the last group
+  // of the data. Find it with memchr so the rest can be decoded in bulk.
+  const size_t size = groups * kEncodedGroupSize;
+  const char* padding =
+      static_cast<const char*>(std::memchr(base64, kPadding, size));
+  const size_t unpadded_groups = padding == nullptr ? groups : groups - 1;
+
+  if (padded_ || (padding != nullptr &&
+                  static_cast<size_t>(padding - base64) <
+                      size - kEncodedGroupSize + 2)) {
+    failed_ = true;  // Data after padding, or = in the first 2 characters.
+    return Status::DataLoss();
+  }
+
+  uint8_t* binary = reinterpret_cast<uint8_t*>(output);
+  if (!DecodeGroups(base64, unpadded_groups, binary)) {
+    failed_ = true;
+    return Status::DataLoss();
+  }
+  output += unpadded_groups * kDecodedGroupSize;
+
+  if (padding != nullptr) {
+    const char* group = &base64[unpadded_groups * kEncodedGroupSize];
+    // The group must be xx== or xxx=.
+    if (group[3] != kPadding) {
+      failed_ = true;
+      return Status::DataLoss();
+    }
+    uint8_t decoded[kDecodedGroupSize];
+    if (!DecodeGroups(group, 1, decoded)) {
+      failed_ = true;
+      return Status::DataLoss();
+    }
+    const size_t decoded_size = group[2] == kPadding ? 1 : 2;
+    std::memcpy(output, decoded, decoded_size);
+    output += decoded_size;
+    padded_ = true;
+  }
+  return OkStatus();
 }
 
 }  // namespace pw::base64
@@ -14,9 +14,13 @@
 
 #include "pw_base64/base64.h"
 
+#include <array>
+#include <cstdint>
 #include <cstring>
+#include <string>
 
 #include "gtest/gtest.h"
+#include "pw_base64_private/config.h"
 
 namespace pw::base64 {
 namespace {
@@ -499,5 +503,277 @@ TEST(Base64CLinkage, Decode) {
   EXPECT_STREQ("fo", output);
 }
 
+// Encodes one bit at a time, as a reference for the optimized implementations.
+std::string ReferenceEncode(const std::byte* data, size_t size) {
+  constexpr char kChars[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string encoded;
+  for (size_t bit = 0; bit < size * 8; bit += 6) {
+    unsigned index = 0;
+    for (size_t i = bit; i < bit + 6; ++i) {
+      const unsigned value =
+          i < size * 8 ? (static_cast<unsigned>(data[i / 8]) >> (7 - i % 8)) & 1
+                       : 0;
+      index = (index << 1) | value;
+    }
+    encoded.push_back(kChars[index]);
+  }
+  while (encoded.size() % 4 != 0u) {
+    encoded.push_back('=');
+  }
+  return encoded;
+}
+
+// Long enough for several blocks of each vector implementation.
+constexpr size_t kMaxTestSize = 300;
+
+std::array<std::byte, kMaxTestSize> PseudorandomData() {
+  std::array<std::byte, kMaxTestSize> data;
+  uint32_t value = 1;
+  for (std::byte& byte : data) {
+    value = value * 1103515245u + 12345u;
+    byte = static_cast<std::byte>(value >> 16);
+  }
+  return data;
+}
+
+const std::array<std::byte, kMaxTestSize> kTestData = PseudorandomData();
+
+TEST(Base64, Encode_AllSizes_MatchesReference) {
+  char output[EncodedSize(kMaxTestSize)];
+  for (size_t size = 0; size <= kMaxTestSize; ++size) {
+    const std::string expected = ReferenceEncode(kTestData.data(), size);
+    ASSERT_EQ(expected.size(),
+              Encode(std::span(kTestData).first(size), std::span(output)));
+    EXPECT_EQ(expected, std::string_view(output, expected.size()));
+  }
+}
+
+TEST(Base64, Decode_AllSizes_RoundTrips) {
+  std::byte output[kMaxTestSize];
+  for (size_t size = 0; size <= kMaxTestSize; ++size) {
+    const std::string encoded = ReferenceEncode(kTestData.data(), size);
+    ASSERT_EQ(size, Decode(encoded, std::span(output)));
+    EXPECT_EQ(0, std::memcmp(kTestData.data(), output, size));
+
+    // Decode in place.
+    std::string buffer = encoded;
+    ASSERT_EQ(size, Decode(buffer, buffer.data()));
+    EXPECT_EQ(0, std::memcmp(kTestData.data(), buffer.data(), size));
+  }
+}
+
+TEST(Base64, Decode_UrlSafeLongData) {
+  std::string encoded = ReferenceEncode(kTestData.data(), kMaxTestSize);
+  for (char& ch : encoded) {
+    if (ch == '+') {
+      ch = '-';
+    } else if (ch == '/') {
+      ch = '_';
+    }
+  }
+  std::byte output[kMaxTestSize];
+  ASSERT_EQ(kMaxTestSize, Decode(encoded, std::span(output)));
+  EXPECT_EQ(0, std::memcmp(kTestData.data(), output, kMaxTestSize));
+}
+
+TEST(Base64, Decode_InvalidCharacterAtEachPosition) {
+  const std::string encoded = ReferenceEncode(kTestData.data(), kMaxTestSize);
+  std::byte output[kMaxTestSize];
+  for (char invalid : {'*', ' ', '\0', '\x80', '\xff'}) {
+    for (size_t i = 0; i < encoded.size(); ++i) {
+      std::string corrupted = encoded;
+      corrupted[i] = invalid;
+      EXPECT_EQ(0u, Decode(corrupted, std::span(output)));
+      EXPECT_FALSE(IsValid(corrupted));
+    }
+  }
+}
+
+TEST(Base64, Decode_EveryCharacter_MatchesIsValid) {
+  // Long enough that the character is decoded by the vector implementations.
+  std::string encoded(128, 'A');
+  std::byte output[MaxDecodedSize(128)];
+  for (int ch = 0; ch < 256; ++ch) {
+    encoded[70] = static_cast<char>(ch);
+    EXPECT_EQ(IsValid(encoded), Decode(encoded, std::span(output)) != 0u);
+
+    std::byte scalar[MaxDecodedSize(128)];
+    if (_pw_Base64InternalDecodeGroupsScalar(
+            encoded.data(), encoded.size() / 4, scalar)) {
+      EXPECT_EQ(0, std::memcmp(scalar, output, sizeof(output)));
+    }
+  }
+}
+
+#if PW_BASE64_USE_SIMD
+
+TEST(Base64, Simd_MatchesScalar) {
+  constexpr size_t kGroups = kMaxTestSize / 3;
+  char scalar[kGroups * 4];
+  char simd[kGroups * 4];
+  _pw_Base64InternalEncodeGroupsScalar(kTestData.data(), kGroups, scalar);
+  const size_t encoded =
+      _pw_Base64InternalEncodeGroupsSimd(kTestData.data(), kGroups, simd);
+  ASSERT_LE(encoded, kGroups);
+  EXPECT_EQ(0, std::memcmp(scalar, simd, encoded * 4));
+
+  std::byte decoded[kGroups * 3];
+  ASSERT_EQ(encoded,
+            _pw_Base64InternalDecodeGroupsSimd(scalar, encoded, decoded));
+  EXPECT_EQ(0, std::memcmp(kTestData.data(), decoded, encoded * 3));
+}
+
+#endif  // PW_BASE64_USE_SIMD
+
+TEST(Base64Encoder, Chunks_MatchEncode) {
+  const std::string expected = ReferenceEncode(kTestData.data(), kMaxTestSize);
+
+  for (size_t chunk_size = 1; chunk_size <= 70; ++chunk_size) {
+    Encoder encoder;
+    char output[EncodedSize(kMaxTestSize)];
+    size_t written = 0;
+
+    for (size_t i = 0; i < kMaxTestSize; i += chunk_size) {
+      const auto chunk = std::span(kTestData).subspan(
+          i, std::min(chunk_size, kMaxTestSize - i));
+      const StatusWithSize result =
+          encoder.Encode(chunk, std::span(output).subspan(written));
+      ASSERT_EQ(OkStatus(), result.status());
+      EXPECT_LE(result.size(), EncodedSize(chunk.size()));
+      written += result.size();
+    }
+    const StatusWithSize result =
+        encoder.Finish(std::span(output).subspan(written));
+    ASSERT_EQ(OkStatus(), result.status());
+    written += result.size();
+
+    EXPECT_EQ(expected, std::string_view(output, written));
+  }
+}
+
+TEST(Base64Encoder, Finish_Padding) {
+  Encoder encoder;
+  char output[8] = {};
+
+  EXPECT_EQ(0u,
+            encoder.Encode(std::as_bytes(std::span("f", 1)), output).size());
+  EXPECT_EQ(4u, encoder.Finish(output).size());
+  EXPECT_STREQ("Zg==", output);
+
+  EXPECT_EQ(0u, encoder.Finish(output).size());
+  EXPECT_EQ(0u,
+            encoder.Encode(std::as_bytes(std::span("fo", 2)), output).size());
+  EXPECT_EQ(4u, encoder.Finish(output).size());
+  EXPECT_STREQ("Zm8=", output);
+}
+
+TEST(Base64Encoder, OutputTooSmall) {
+  Encoder encoder;
+  char output[4] = {};
+
+  EXPECT_EQ(Status::ResourceExhausted(),
+            encoder.Encode(std::as_bytes(std::span("foobar", 6)), output)
+                .status());
+  EXPECT_EQ(OkStatus(),
+            encoder.Encode(std::as_bytes(std::span("foob", 4)), output)
+                .status());
+  EXPECT_EQ(0, std::memcmp("Zm9v", output, 4));
+  EXPECT_EQ(Status::ResourceExhausted(),
+            encoder.Finish(std::span(output, 3)).status());
+  EXPECT_EQ(4u, encoder.Finish(output).size());
+  EXPECT_EQ(0, std::memcmp("Yg==", output, 4));
+}
+
+TEST(Base64Decoder, Chunks_MatchDecode) {
+  const std::string encoded = ReferenceEncode(kTestData.data(), kMaxTestSize);
+
+  for (size_t chunk_size = 1; chunk_size <= 70; ++chunk_size) {
+    Decoder decoder;
+    std::byte output[kMaxTestSize];
+    size_t written = 0;
+
+    for (size_t i = 0; i < encoded.size(); i += chunk_size) {
+      const std::string_view chunk =
+          std::string_view(encoded).substr(i, chunk_size);
+      const StatusWithSize result =
+          decoder.Decode(chunk, std::span(output).subspan(written));
+      ASSERT_EQ(OkStatus(), result.status());
+      written += result.size();
+    }
+    EXPECT_EQ(OkStatus(), decoder.Finish());
+    ASSERT_EQ(kMaxTestSize, written);
+    EXPECT_EQ(0, std::memcmp(kTestData.data(), output, kMaxTestSize));
+  }
+}
+
+TEST(Base64Decoder, Padding) {
+  Decoder decoder;
+  std::byte output[8];
+
+  EXPECT_EQ(1u, decoder.Decode("Zg==", output).size());
+  EXPECT_EQ(std::byte{'f'}, output[0]);
+  EXPECT_EQ(OkStatus(), decoder.Finish());
+
+  EXPECT_EQ(0u, decoder.Decode("Zm", output).size());
+  EXPECT_EQ(2u, decoder.Decode("8=", output).size());
+  EXPECT_EQ(std::byte{'o'}, output[1]);
+  EXPECT_EQ(OkStatus(), decoder.Finish());
+}
+
+TEST(Base64Decoder, DataAfterPadding) {
+  Decoder decoder;
+  std::byte output[8];
+
+  EXPECT_EQ(Status::DataLoss(), decoder.Decode("Zg==Zg==", output).status());
+  decoder.Reset();
+
+  EXPECT_EQ(OkStatus(), decoder.Decode("Zg==", output).status());
+  EXPECT_EQ(OkStatus(), decoder.Decode("", output).status());
+  EXPECT_EQ(Status::DataLoss(), decoder.Decode("Z", output).status());
+  EXPECT_EQ(Status::DataLoss(), decoder.Finish());
+}
+
+TEST(Base64Decoder, MisplacedPadding) {
+  std::byte output[8];
+  for (std::string_view bad : {"====", "Z===", "Zg=g", "=gg=", "Zm9v=m9v"}) {
+    Decoder decoder;
+    EXPECT_EQ(Status::DataLoss(), decoder.Decode(bad, output).status());
+  }
+}
+
+TEST(Base64Decoder, InvalidCharacter_FailsUntilReset) {
+  Decoder decoder;
+  std::byte output[8];
+
+  EXPECT_EQ(Status::DataLoss(), decoder.Decode("Zm9v*m9v", output).status());
+  EXPECT_EQ(Status::DataLoss(), decoder.Decode("Zm9v", output).status());
+  decoder.Reset();
+  EXPECT_EQ(3u, decoder.Decode("Zm9v", output).size());
+  EXPECT_EQ(OkStatus(), decoder.Finish());
+}
+
+TEST(Base64Decoder, IncompleteGroup) {
+  Decoder decoder;
+  std::byte output[8];
+
+  EXPECT_EQ(3u, decoder.Decode("Zm9vY", output).size());
+  EXPECT_EQ(Status::DataLoss(), decoder.Finish());
+
+  // Finish() resets the decoder.
+  EXPECT_EQ(3u, decoder.Decode("Zm9v", output).size());
+  EXPECT_EQ(OkStatus(), decoder.Finish());
+}
+
+TEST(Base64Decoder, OutputTooSmall) {
+  Decoder decoder;
+  std::byte output[6];
+
+  EXPECT_EQ(Status::ResourceExhausted(),
+            decoder.Decode("Zm9vYmFy", std::span(output, 5)).status());
+  EXPECT_EQ(6u, decoder.Decode("Zm9vYmFy", output).size());
+  EXPECT_EQ(OkStatus(), decoder.Finish());
+}
+
 }  // namespace
 }  // namespace pw::base64
@@ -0,0 +1,143 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures the throughput of Base64 encoding and decoding. The portable
+// implementation is compared with the configured one, which uses vector
+// instructions if PW_BASE64_USE_SIMD is set, and with the streaming Encoder and
+// Decoder given the data in pieces the size of a log line. The time per binary
+// byte is logged.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_assert/check.h"
+#include "pw_base64/base64.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+
+namespace {
+
+constexpr size_t kBufferSize = 3 * 1024;
+constexpr size_t kIterations = 2000;
+constexpr int64_t kTotalBytes = kBufferSize * kIterations;
+constexpr size_t kChunkSize = 64;
+
+std::array<std::byte, kBufferSize> binary;
+std::array<char, pw::base64::EncodedSize(kBufferSize)> expected;
+std::array<char, pw::base64::EncodedSize(kBufferSize)> encoded;
+std::array<std::byte, kBufferSize> decoded;
+
+void EncodeScalar() {
+  _pw_Base64InternalEncodeGroupsScalar(
+      binary.data(), binary.size() / 3, encoded.data());
+}
+
+void EncodeConfigured() { pw::base64::Encode(binary, encoded.data()); }
+
+void EncodeStreaming() {
+  pw::base64::Encoder encoder;
+  size_t written = 0;
+  for (size_t i = 0; i < binary.size(); i += kChunkSize) {
+    written += encoder
+                   .Encode(std::span(binary).subspan(i, kChunkSize),
+                           std::span(encoded).subspan(written))
+                   .size();
+  }
+  encoder.Finish(std::span(encoded).subspan(written)).IgnoreError();
+}
+
+void DecodeScalar() {
+  PW_CHECK(_pw_Base64InternalDecodeGroupsScalar(
+      encoded.data(), encoded.size() / 4, decoded.data()));
+}
+
+void DecodeConfigured() {
+  PW_CHECK_UINT_EQ(pw::base64::Decode(
+                       std::string_view(encoded.data(), encoded.size()),
+                       std::span(decoded)),
+                   kBufferSize);
+}
+
+void DecodeStreaming() {
+  pw::base64::Decoder decoder;
+  const std::string_view base64(encoded.data(), encoded.size());
+  size_t written = 0;
+  for (size_t i = 0; i < base64.size(); i += kChunkSize) {
+    written +=
+        decoder
+            .Decode(base64.substr(i, kChunkSize),
+                    std::span(decoded).subspan(written))
+            .size();
+  }
+  PW_CHECK_OK(decoder.Finish());
+}
+
+struct Benchmark {
+  const char* name;
+  void (*function)();
+  bool decodes;
+};
+
+constexpr Benchmark kBenchmarks[] = {
+    {"encode portable", EncodeScalar, false},
+    {"encode configured", EncodeConfigured, false},
+    {"encode streaming", EncodeStreaming, false},
+    {"decode portable", DecodeScalar, true},
+    {"decode configured", DecodeConfigured, true},
+    {"decode streaming", DecodeStreaming, true},
+};
+
+}  // namespace
+
+int main() {
+  uint32_t value = 1;
+  for (std::byte& byte : binary) {
+    value = value * 1103515245u + 12345u;
+    byte = static_cast<std::byte>(value >> 16);
+  }
+  _pw_Base64InternalEncodeGroupsScalar(
+      binary.data(), binary.size() / 3, expected.data());
+
+  PW_LOG_INFO("Encoding and decoding %u bytes %u times",
+              static_cast<unsigned>(kBufferSize),
+              static_cast<unsigned>(kIterations));
+
+  for (const Benchmark& benchmark : kBenchmarks) {
+    encoded = expected;
+    decoded = {};
+
+    const auto start = pw::chrono::SystemClock::now();
+    for (size_t i = 0; i < kIterations; ++i) {
+      benchmark.function();
+    }
+    const auto elapsed = pw::chrono::SystemClock::now() - start;
+
+    if (benchmark.decodes) {
+      PW_CHECK(std::equal(binary.begin(), binary.end(), decoded.begin()));
+    } else {
+      PW_CHECK(std::equal(expected.begin(), expected.end(), encoded.begin()));
+    }
+
+    const auto picoseconds =
+        std::chrono::duration_cast<std::chrono::duration<int64_t, std::pico>>(
+            elapsed);
+    PW_LOG_INFO("%-18s %6ld ps/byte",
+                benchmark.name,
+                static_cast<long>(picoseconds.count() / kTotalBytes));
+  }
+  return 0;
+}
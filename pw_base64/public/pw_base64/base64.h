@@ -59,14 +59,42 @@ size_t pw_Base64Decode(const char* base64,
 // Equivalent to pw::base64::IsValid().
 bool pw_Base64IsValid(const char* base64_data, size_t base64_size);
 
+// The implementations behind the functions above, which are exposed for
+// testing and benchmarking. Do not call them directly. They work on whole
+// groups: 3 bytes are encoded as 4 characters. The decode functions decode = as
+// 0 bits and return false if any character is not in either alphabet; the
+// output is then unspecified.
+void _pw_Base64InternalEncodeGroupsScalar(const void* binary_data,
+                                          size_t groups,
+                                          char* output);
+bool _pw_Base64InternalDecodeGroupsScalar(const char* base64,
+                                          size_t groups,
+                                          void* output);
+
+// Only available if PW_BASE64_USE_SIMD is set. These process as many of the
+// leading groups as they can with vector instructions and return how many they
+// processed, which is 0 if the CPU does not support the instructions. Decoding
+// stops before a block with = or an invalid character.
+size_t _pw_Base64InternalEncodeGroupsSimd(const void* binary_data,
+                                          size_t groups,
+                                          char* output);
+size_t _pw_Base64InternalDecodeGroupsSimd(const char* base64,
+                                          size_t groups,
+                                          void* output);
+
 // C++ API, which uses the C functions internally.
 #ifdef __cplusplus
 }  // extern "C"
 
+#include <array>
+#include <cstdint>
 #include <span>
 #include <string_view>
 #include <type_traits>
 
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
 namespace pw::base64 {
 
 // Returns the size of the given number of bytes when encoded as Base64. Base64
@@ -115,7 +143,8 @@ inline size_t Decode(std::string_view base64, void* output) {
 
 // Decodes the provided Base64 data, if the data is valid and fits in the output
 // buffer. Returns the number of bytes written, which will be 0 if the data is
-// invalid or doesn't fit.
+// invalid or doesn't fit. The data is checked as it is decoded, so the output
+// buffer contents are unspecified if the data is invalid.
 size_t Decode(std::string_view base64, std::span<std::byte> output_buffer);
 
 // Returns true if the provided string is valid Base64 encoded data. Accepts
@@ -124,6 +153,73 @@ inline bool IsValid(std::string_view base64) {
   return pw_Base64IsValid(base64.data(), base64.size());
 }
 
+// Encodes data that is provided in pieces, such as data read from a stream, as
+// Base64. The output is the same as encoding all of the data at once with
+// Encode(). Groups of 3 bytes are encoded as they are completed; the 1 or 2
+// bytes left over are held until the next call.
+class Encoder {
+ public:
+  constexpr Encoder() = default;
+
+  // Encodes a piece of the data. Returns the number of characters written,
+  // which is at most EncodedSize(binary.size_bytes()).
+  //
+  // Returns:
+  //
+  // OK - the completed groups were written.
+  // RESOURCE_EXHAUSTED - the output buffer is too small; nothing was encoded.
+  StatusWithSize Encode(std::span<const std::byte> binary,
+                        std::span<char> output_buffer);
+
+  // Writes the last group, padded with =, if there are bytes left over, and
+  // resets the encoder for new data. Writes 0 or 4 characters, or returns
+  // RESOURCE_EXHAUSTED if they don't fit.
+  StatusWithSize Finish(std::span<char> output_buffer);
+
+ private:
+  std::array<uint8_t, 3> pending_ = {};
+  uint8_t pending_size_ = 0;
+};
+
+// Decodes Base64 data that is provided in pieces, such as lines of a log. Each
+// piece may end anywhere; up to 3 characters of an incomplete group are held
+// until the next call. Accepts either the standard (+/) or URL-safe (-_)
+// alphabets. Unlike Decode(), the decoder rejects data after a padded group.
+class Decoder {
+ public:
+  constexpr Decoder() = default;
+
+  // Decodes a piece of the data. Returns the number of bytes written, which is
+  // at most MaxDecodedSize(base64.size() + 3).
+  //
+  // Returns:
+  //
+  // OK - the completed groups were decoded.
+  // RESOURCE_EXHAUSTED - the output buffer is too small; nothing was decoded.
+  // DATA_LOSS - the data has an invalid character or continues after padding.
+  //     The output buffer contents are unspecified, and the decoder returns
+  //     DATA_LOSS until it is Reset().
+  StatusWithSize Decode(std::string_view base64,
+                        std::span<std::byte> output_buffer);
+
+  // Checks that the data ended with a complete group and resets the decoder
+  // for new data. Returns DATA_LOSS if the data was incomplete or invalid.
+  Status Finish();
+
+  // Discards any held characters and errors.
+  void Reset() { *this = Decoder(); }
+
+ private:
+  Status DecodeWithPadding(const char* base64,
+                           size_t groups,
+                           std::byte*& output);
+
+  std::array<char, 4> pending_ = {};
+  uint8_t pending_size_ = 0;
+  bool padded_ = false;  // A padded group ended the data.
+  bool failed_ = false;
+};
+
 }  // namespace pw::base64
 
 #endif  // __cplusplus
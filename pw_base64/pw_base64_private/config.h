@@ -0,0 +1,31 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Configuration macros for the pw_base64 module.
+#pragma once
+
+// Whether to encode and decode with SSSE3 instructions on x86-64, in
+// 16-character blocks. Other targets use the portable implementation, which
+// works on one group at a time in a 32-bit word.
+//
+// Most x86-64 compilers don't assume SSSE3 by default, so the SSSE3 code is
+// compiled with a function attribute and only used if the CPU reports support
+// for it at run time. This requires GCC or Clang.
+#ifndef PW_BASE64_USE_SIMD
+#if defined(__x86_64__) && defined(__GNUC__)
+#define PW_BASE64_USE_SIMD 1
+#else
+#define PW_BASE64_USE_SIMD 0
+#endif  // defined(__x86_64__) && defined(__GNUC__)
+#endif  // PW_BASE64_USE_SIMD
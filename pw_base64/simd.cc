@@ -0,0 +1,190 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Vector implementations of Base64 encoding and decoding. The SSSE3 versions
+// are based on Wojciech Muła's "Base64 encoding and decoding with SIMD
+// instructions" (http://0x80.pl/articles/index.html#base64-algorithm-new).
+
+#include "pw_base64/base64.h"
+#include "pw_base64_private/config.h"
+
+#if PW_BASE64_USE_SIMD
+
+#include <cstdint>
+#include <cstring>
+
+#if !defined(__x86_64__)
+#error "PW_BASE64_USE_SIMD is only supported on x86-64"
+#endif  // !defined(__x86_64__)
+
+#include <immintrin.h>
+
+namespace pw::base64 {
+namespace {
+
+constexpr size_t kEncodedGroupSize = 4;
+constexpr size_t kDecodedGroupSize = 3;
+
+bool HasSsse3() {
+#if defined(__SSSE3__)
+  return true;
+#else
+  return __builtin_cpu_supports("ssse3");
+#endif  // defined(__SSSE3__)
+}
+
+// The offset from each index to its character, by the ranges computed below.
+alignas(16) constexpr int8_t kEncodeOffsets[16] = {
+    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+    '/' - 63, 'A',      0,        0};
+
+inline __m128i Load(const int8_t (&table)[16]) {
+  return _mm_load_si128(reinterpret_cast<const __m128i*>(table));
+}
+
+// Each block encodes 12 bytes as 16 characters, but loads 16 bytes, so the
+// last block must be followed by at least 4 more bytes.
+constexpr size_t kEncodeBlockGroups = 4;
+constexpr size_t kEncodeMinGroups = 6;
+
+__attribute__((target("ssse3"))) size_t EncodeSsse3(const uint8_t* bytes,
+                                                   size_t groups,
+                                                   char* output) {
+  size_t encoded = 0;
+  for (; groups - encoded >= kEncodeMinGroups; encoded += kEncodeBlockGroups) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+
+    // Arrange each group's bytes b0, b1, b2 in a 32-bit lane as b1 b0 b2 b1, so
+    // that each 6-bit index can be moved into its own byte with multiplies.
+    in = _mm_shuffle_epi8(
+        in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i indices_0_2 =
+        _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)),
+                        _mm_set1_epi32(0x04000040));
+    const __m128i indices_1_3 =
+        _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)),
+                        _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(indices_0_2, indices_1_3);
+
+    // Map each index to the offset from the index to its character. Indices
+    // 52-63 map to 1-12, indices 0-25 to 13, and indices 26-51 to 0.
+    __m128i ranges = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    ranges = _mm_or_si128(
+        ranges,
+        _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices),
+                      _mm_set1_epi8(13)));
+    const __m128i offsets = _mm_shuffle_epi8(Load(kEncodeOffsets), ranges);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output),
+                     _mm_add_epi8(indices, offsets));
+
+    bytes += kEncodeBlockGroups * kDecodedGroupSize;
+    output += kEncodeBlockGroups * kEncodedGroupSize;
+  }
+  return encoded;
+}
+
+// Each block decodes 16 characters to 12 bytes.
+constexpr size_t kDecodeBlockGroups = 4;
+
+// Valid characters, as a bitmap indexed by each character's nibbles: the first
+// table has a bit for each high nibble that is valid with the low nibble, and
+// the second maps the high nibble to that bit. High nibbles 8-15 map to no
+// bits, so characters above 127 are invalid.
+alignas(16) constexpr int8_t kValidHighNibbles[16] = {
+    0x2a, 0x3e, 0x3e, 0x3e, 0x3e, 0x3e, 0x3e, 0x3e,
+    0x3e, 0x3e, 0x3c, 0x15, 0x14, 0x15, 0x14, 0x1d};
+alignas(16) constexpr int8_t kHighNibbleBits[16] = {
+    0, 0, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0, 0, 0, 0, 0, 0, 0, 0};
+
+// The offset from each valid character to its value, by high nibble. This is
+// right for letters, digits, and +; -, /, and _ are adjusted separately.
+alignas(16) constexpr int8_t kDecodeShifts[16] = {
+    0, 0, 62 - '+', 52 - '0', -'A', -'A', 26 - 'a', 26 - 'a',
+    0, 0, 0,        0,        0,    0,    0,        0};
+
+__attribute__((target("ssse3"))) size_t DecodeSsse3(const char* base64,
+                                                   size_t groups,
+                                                   uint8_t* output) {
+  const __m128i valid_high_nibbles = Load(kValidHighNibbles);
+  const __m128i high_nibble_bits = Load(kHighNibbleBits);
+  const __m128i shifts = Load(kDecodeShifts);
+
+  size_t decoded = 0;
+  for (; groups - decoded >= kDecodeBlockGroups;
+       decoded += kDecodeBlockGroups) {
+    const __m128i chars =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(base64));
+    const __m128i high_nibbles =
+        _mm_and_si128(_mm_srli_epi32(chars, 4), _mm_set1_epi8(0x0f));
+    const __m128i low_nibbles = _mm_and_si128(chars, _mm_set1_epi8(0x0f));
+
+    const __m128i valid =
+        _mm_and_si128(_mm_shuffle_epi8(valid_high_nibbles, low_nibbles),
+                      _mm_shuffle_epi8(high_nibble_bits, high_nibbles));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(valid, _mm_setzero_si128())) != 0) {
+      break;  // Padding or an invalid character; leave it to the caller.
+    }
+
+    const __m128i adjustments = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('-')),
+                                   _mm_set1_epi8('+' - '-')),
+                     _mm_and_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('/')),
+                                   _mm_set1_epi8(63 - '/' - (62 - '+')))),
+        _mm_and_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('_')),
+                      _mm_set1_epi8(63 - '_' + 'A')));
+    const __m128i values = _mm_add_epi8(
+        chars,
+        _mm_add_epi8(_mm_shuffle_epi8(shifts, high_nibbles), adjustments));
+
+    // Combine pairs of 6-bit values into 12 bits, then pairs of those into each
+    // group's 24 bits, and put the groups' bytes in order.
+    const __m128i pairs =
+        _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    const __m128i bytes = _mm_shuffle_epi8(
+        words,
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+    // Store exactly 12 bytes, since the output may end right after them.
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output), bytes);
+    const uint32_t last_bytes =
+        static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(bytes, 8)));
+    std::memcpy(&output[8], &last_bytes, sizeof(last_bytes));
+
+    base64 += kDecodeBlockGroups * kEncodedGroupSize;
+    output += kDecodeBlockGroups * kDecodedGroupSize;
+  }
+  return decoded;
+}
+
+}  // namespace
+
+extern "C" size_t _pw_Base64InternalEncodeGroupsSimd(const void* binary_data,
+                                                     size_t groups,
+                                                     char* output) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(binary_data);
+  return HasSsse3() ? EncodeSsse3(bytes, groups, output) : 0;
+}
+
+extern "C" size_t _pw_Base64InternalDecodeGroupsSimd(const char* base64,
+                                                     size_t groups,
+                                                     void* output) {
+  uint8_t* binary = static_cast<uint8_t*>(output);
+  return HasSsse3() ? DecodeSsse3(base64, groups, binary) : 0;
+}
+
+}  // namespace pw::base64
+
+#endif  // PW_BASE64_USE_SIMD
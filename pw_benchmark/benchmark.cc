@@ -0,0 +1,97 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_benchmark/benchmark.h"
+
+#include <algorithm>
+
+#include "pw_benchmark/config.h"
+
+namespace pw::benchmark::internal {
+namespace {
+
+// Picks the iteration count for the next run from how long the last one took.
+// This aims 40% past the minimum time, so the next run is likely long enough,
+// but grows at most 10x per run, since very short runs are timed poorly.
+uint32_t NextIterations(uint32_t iterations,
+                        uint64_t elapsed,
+                        uint64_t min_ticks,
+                        uint32_t max_iterations) {
+  const uint64_t most = uint64_t{iterations} * 10;
+  uint64_t next = most;
+  if (elapsed != 0) {
+    next = uint64_t{iterations} * min_ticks * 14 / (elapsed * 10);
+  }
+  next = std::clamp(next, uint64_t{iterations} + 1, most);
+  return static_cast<uint32_t>(std::min<uint64_t>(next, max_iterations));
+}
+
+}  // namespace
+
+std::optional<unit_test::BenchmarkResult> Run(BenchmarkFunction benchmark,
+                                              const Options& options) {
+  timer::Init();
+  const uint64_t min_ticks =
+      timer::TicksPerSecond() * options.min_time_ms / 1000;
+
+  if (options.warmup_iterations != 0u) {
+    State warmup(options.warmup_iterations);
+    benchmark(warmup);
+    if (!warmup.finished_) {
+      return std::nullopt;
+    }
+  }
+
+  uint32_t iterations = 1;
+  while (true) {
+    State state(iterations);
+    benchmark(state);
+    if (!state.finished_) {
+      return std::nullopt;
+    }
+
+    if (state.elapsed_ >= min_ticks || iterations >= options.max_iterations) {
+      return unit_test::BenchmarkResult{
+          .iterations = iterations,
+          .total_time = state.elapsed_,
+          .time_units = timer::Units(),
+      };
+    }
+    iterations = NextIterations(
+        iterations, state.elapsed_, min_ticks, options.max_iterations);
+  }
+}
+
+void RunAndReport(BenchmarkFunction benchmark, int line) {
+  constexpr Options kOptions = {
+      .warmup_iterations = cfg::kWarmupIterations,
+      .min_time_ms = cfg::kMinTimeMs,
+      .max_iterations = cfg::kMaxIterations,
+  };
+
+  unit_test::internal::Framework& framework =
+      unit_test::internal::Framework::Get();
+  const std::optional<unit_test::BenchmarkResult> result =
+      Run(benchmark, kOptions);
+  if (!result.has_value()) {
+    framework.ExpectationResult("for (auto _ : state)",
+                                "(benchmark loop did not complete)",
+                                line,
+                                false);
+    return;
+  }
+  framework.RecordBenchmark(result.value());
+}
+
+}  // namespace pw::benchmark::internal
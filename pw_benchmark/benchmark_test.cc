@@ -0,0 +1,137 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_benchmark/benchmark.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace pw::benchmark {
+namespace {
+
+using internal::Options;
+using internal::Run;
+
+// The iteration counts of the runs of RecordingBenchmark, and how many times
+// its loop body ran in each.
+struct Recorded {
+  std::array<uint32_t, 32> iterations;
+  std::array<uint32_t, 32> loops;
+  size_t runs;
+} recorded;
+
+void RecordingBenchmark(State& state) {
+  uint32_t loops = 0;
+  for (auto _ : state) {
+    loops += 1;
+    DoNotOptimize(loops);
+  }
+  if (recorded.runs < recorded.iterations.size()) {
+    recorded.iterations[recorded.runs] = state.iterations();
+    recorded.loops[recorded.runs] = loops;
+  }
+  recorded.runs += 1;
+}
+
+void EarlyReturnBenchmark(State&) {}
+
+class BenchmarkRun : public ::testing::Test {
+ protected:
+  BenchmarkRun() { recorded = {}; }
+};
+
+TEST_F(BenchmarkRun, ScalesIterationsToMinTime) {
+  constexpr Options kOptions = {
+      .warmup_iterations = 0, .min_time_ms = 5, .max_iterations = 100000000};
+
+  const auto result = Run(RecordingBenchmark, kOptions);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_GE(result->total_time, 5u * timer::TicksPerSecond() / 1000u);
+  EXPECT_GT(result->iterations, 1u);
+  EXPECT_STREQ(result->time_units, timer::Units());
+}
+
+TEST_F(BenchmarkRun, StopsAtMaxIterations) {
+  constexpr Options kOptions = {
+      .warmup_iterations = 0, .min_time_ms = 100000, .max_iterations = 100};
+
+  const auto result = Run(RecordingBenchmark, kOptions);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->iterations, 100u);
+  EXPECT_EQ(recorded.iterations[recorded.runs - 1], 100u);
+}
+
+TEST_F(BenchmarkRun, IterationsGrowEachRun) {
+  constexpr Options kOptions = {
+      .warmup_iterations = 0, .min_time_ms = 100000, .max_iterations = 1000};
+
+  ASSERT_TRUE(Run(RecordingBenchmark, kOptions).has_value());
+  ASSERT_GE(recorded.runs, 2u);
+  EXPECT_EQ(recorded.iterations[0], 1u);
+  for (size_t i = 1; i < recorded.runs; ++i) {
+    EXPECT_GT(recorded.iterations[i], recorded.iterations[i - 1]);
+    EXPECT_LE(recorded.iterations[i], recorded.iterations[i - 1] * 10);
+  }
+}
+
+TEST_F(BenchmarkRun, LoopRunsIterationsTimes) {
+  constexpr Options kOptions = {
+      .warmup_iterations = 0, .min_time_ms = 100000, .max_iterations = 1000};
+
+  ASSERT_TRUE(Run(RecordingBenchmark, kOptions).has_value());
+  for (size_t i = 0; i < recorded.runs; ++i) {
+    EXPECT_EQ(recorded.loops[i], recorded.iterations[i]);
+  }
+}
+
+TEST_F(BenchmarkRun, WarmupRunsFirst) {
+  constexpr Options kOptions = {
+      .warmup_iterations = 3, .min_time_ms = 100000, .max_iterations = 10};
+
+  ASSERT_TRUE(Run(RecordingBenchmark, kOptions).has_value());
+  EXPECT_EQ(recorded.iterations[0], 3u);
+  EXPECT_EQ(recorded.iterations[1], 1u);
+}
+
+TEST_F(BenchmarkRun, LoopNotCompleted_ReturnsNothing) {
+  constexpr Options kOptions = {
+      .warmup_iterations = 1, .min_time_ms = 1, .max_iterations = 10};
+  EXPECT_FALSE(Run(EarlyReturnBenchmark, kOptions).has_value());
+}
+
+std::array<char, 64> source;
+std::array<char, 64> destination;
+
+PW_BENCHMARK(BenchmarkMacro, Memcpy64) {
+  for (auto _ : state) {
+    std::memcpy(destination.data(), source.data(), source.size());
+    ClobberMemory();
+  }
+}
+
+PW_BENCHMARK(BenchmarkMacro, PauseTiming) {
+  uint32_t value = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    value = 0;
+    state.ResumeTiming();
+    value += 1;
+    DoNotOptimize(value);
+  }
+}
+
+}  // namespace
+}  // namespace pw::benchmark
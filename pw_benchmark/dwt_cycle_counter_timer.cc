@@ -0,0 +1,36 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Times benchmarks in CPU cycles with pw::chrono::DwtCycleClock, which counts
+// with the cycle counter of the Data Watchpoint and Trace (DWT) unit on ARMv7-M
+// and ARMv8-M Mainline cores.
+
+#include "pw_benchmark/timer.h"
+#include "pw_chrono/dwt_cycle_clock.h"
+
+namespace pw::benchmark::timer {
+
+using chrono::DwtCycleClock;
+
+void Init() { DwtCycleClock::Enable(); }
+
+uint64_t Now() {
+  return static_cast<uint64_t>(DwtCycleClock::now().time_since_epoch().count());
+}
+
+uint64_t TicksPerSecond() { return DwtCycleClock::period::den; }
+
+const char* Units() { return "cycles"; }
+
+}  // namespace pw::benchmark::timer
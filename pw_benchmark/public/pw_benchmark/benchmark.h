@@ -0,0 +1,186 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "pw_benchmark/timer.h"
+#include "pw_preprocessor/concat.h"
+#include "pw_unit_test/event_handler.h"
+#include "pw_unit_test/framework.h"
+
+// Defines a benchmark. Benchmarks are registered and run as pw_unit_test test
+// cases, so they are filtered by suite and reported through the registered
+// event handler like any other test. The body times a range-based for loop
+// over the State:
+//
+//   PW_BENCHMARK(Checksum, Crc32_1KiB) {
+//     for (auto _ : state) {
+//       pw::benchmark::DoNotOptimize(pw::checksum::Crc32::Calculate(kData));
+//     }
+//   }
+//
+// The loop runs a few untimed warmup iterations first, then is run again with
+// more and more iterations until it takes at least the configured minimum
+// time. The time per iteration of the final run is reported.
+#define PW_BENCHMARK(suite_name, benchmark_name)                      \
+  static void _PW_BENCHMARK_FUNCTION(suite_name, benchmark_name)(     \
+      ::pw::benchmark::State & state);                                \
+                                                                      \
+  PW_TEST(suite_name, benchmark_name) {                               \
+    ::pw::benchmark::internal::RunAndReport(                          \
+        _PW_BENCHMARK_FUNCTION(suite_name, benchmark_name), __LINE__); \
+  }                                                                   \
+                                                                      \
+  static void _PW_BENCHMARK_FUNCTION(suite_name, benchmark_name)(     \
+      [[maybe_unused]] ::pw::benchmark::State & state)
+
+// BENCHMARK() is a generic name which could conflict with other benchmark
+// libraries. If PW_BENCHMARK_DONT_DEFINE_BENCHMARK is set, it is not defined.
+#if !(defined(PW_BENCHMARK_DONT_DEFINE_BENCHMARK) && \
+      PW_BENCHMARK_DONT_DEFINE_BENCHMARK)
+#define BENCHMARK PW_BENCHMARK
+#endif  // !PW_BENCHMARK_DONT_DEFINE_BENCHMARK
+
+namespace pw::benchmark {
+
+class State;
+
+namespace internal {
+
+using BenchmarkFunction = void (*)(State&);
+
+struct Options {
+  // Iterations run, untimed, before the benchmark is measured.
+  uint32_t warmup_iterations;
+
+  // The minimum time a timed run should take.
+  uint32_t min_time_ms;
+
+  // The most iterations a timed run may have.
+  uint32_t max_iterations;
+};
+
+// Runs a benchmark, scaling up its iterations until a run takes at least
+// min_time_ms or reaches max_iterations. Returns the final run's timing, or
+// nothing if the benchmark did not complete its loop, such as when an ASSERT
+// failed.
+std::optional<unit_test::BenchmarkResult> Run(BenchmarkFunction benchmark,
+                                              const Options& options);
+
+// Runs a benchmark with the configured options and reports its timing to the
+// current test.
+void RunAndReport(BenchmarkFunction benchmark, int line);
+
+}  // namespace internal
+
+// Keeps the compiler from optimizing away the computation of a value.
+template <typename T>
+inline void DoNotOptimize(T& value) {
+#if defined(__clang__)
+  asm volatile("" : "+r,m"(value) : : "memory");
+#else
+  // GCC may reject "+r,m" as an impossible constraint for constant-propagated
+  // values, but accepts the alternatives in the other order.
+  asm volatile("" : "+m,r"(value) : : "memory");
+#endif  // defined(__clang__)
+}
+
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Forces pending writes to memory, so that they are part of the measurement.
+inline void ClobberMemory() { asm volatile("" : : : "memory"); }
+
+// Controls a run of a benchmark. The benchmark's loop is timed by iterating
+// over the State, which runs the loop iterations() times.
+class State {
+ public:
+  class Iterator {
+   public:
+    // The loop variable, which is unused. Marking the type keeps compilers
+    // from warning about it in "for (auto _ : state)".
+    struct [[maybe_unused]] Value {};
+
+    Value operator*() const { return Value(); }
+
+    Iterator& operator++() {
+      remaining_ -= 1;
+      return *this;
+    }
+
+    // Stops the timer when the loop ends.
+    bool operator!=(const Iterator&) const {
+      if (remaining_ != 0u) {
+        return true;
+      }
+      state_->Finish();
+      return false;
+    }
+
+   private:
+    friend class State;
+
+    constexpr Iterator(State* state, uint32_t remaining)
+        : state_(state), remaining_(remaining) {}
+
+    State* state_;
+    uint32_t remaining_;
+  };
+
+  State(const State&) = delete;
+  State& operator=(const State&) = delete;
+
+  // Starts the timer as the loop starts.
+  Iterator begin() {
+    start_ = timer::Now();
+    return Iterator(this, iterations_);
+  }
+
+  Iterator end() { return Iterator(this, 0); }
+
+  // The number of times the loop runs.
+  uint32_t iterations() const { return iterations_; }
+
+  // Excludes part of an iteration, such as resetting inputs, from the timing.
+  // Pausing and resuming takes two timer reads, so it is only suitable for
+  // iterations that are long compared to the timer's overhead.
+  void PauseTiming() { elapsed_ += timer::Now() - start_; }
+  void ResumeTiming() { start_ = timer::Now(); }
+
+ private:
+  friend std::optional<unit_test::BenchmarkResult> internal::Run(
+      internal::BenchmarkFunction, const internal::Options&);
+
+  constexpr explicit State(uint32_t iterations)
+      : iterations_(iterations), start_(0), elapsed_(0), finished_(false) {}
+
+  void Finish() {
+    elapsed_ += timer::Now() - start_;
+    finished_ = true;
+  }
+
+  const uint32_t iterations_;
+  uint64_t start_;
+  uint64_t elapsed_;
+  bool finished_;
+};
+
+}  // namespace pw::benchmark
+
+#define _PW_BENCHMARK_FUNCTION(suite_name, benchmark_name) \
+  PW_CONCAT(suite_name, _, benchmark_name, _Benchmark)
@@ -0,0 +1,56 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Configuration macros for the pw_benchmark module.
+#pragma once
+
+#include <cstdint>
+
+// The number of iterations a benchmark runs, untimed, before it is measured.
+// This warms up caches and lazily initialized state.
+#ifndef PW_BENCHMARK_CONFIG_WARMUP_ITERATIONS
+#define PW_BENCHMARK_CONFIG_WARMUP_ITERATIONS 10
+#endif  // PW_BENCHMARK_CONFIG_WARMUP_ITERATIONS
+
+// The iteration count is scaled up until a timed run takes at least this long,
+// so that the timer's resolution and overhead do not skew the results.
+#ifndef PW_BENCHMARK_CONFIG_MIN_TIME_MS
+#define PW_BENCHMARK_CONFIG_MIN_TIME_MS 100
+#endif  // PW_BENCHMARK_CONFIG_MIN_TIME_MS
+
+// The most iterations a timed run may have, regardless of how long it took.
+#ifndef PW_BENCHMARK_CONFIG_MAX_ITERATIONS
+#define PW_BENCHMARK_CONFIG_MAX_ITERATIONS 100000000
+#endif  // PW_BENCHMARK_CONFIG_MAX_ITERATIONS
+
+// The frequency of the CPU clock, which the Cortex-M SysTick timer counts. Must
+// be set when using the systick timer backend.
+#ifndef PW_BENCHMARK_CONFIG_CPU_CLOCK_HZ
+#define PW_BENCHMARK_CONFIG_CPU_CLOCK_HZ 0
+#endif  // PW_BENCHMARK_CONFIG_CPU_CLOCK_HZ
+
+namespace pw::benchmark::cfg {
+
+inline constexpr uint32_t kWarmupIterations =
+    PW_BENCHMARK_CONFIG_WARMUP_ITERATIONS;
+inline constexpr uint32_t kMinTimeMs = PW_BENCHMARK_CONFIG_MIN_TIME_MS;
+inline constexpr uint32_t kMaxIterations = PW_BENCHMARK_CONFIG_MAX_ITERATIONS;
+inline constexpr uint64_t kCpuClockHz = PW_BENCHMARK_CONFIG_CPU_CLOCK_HZ;
+
+}  // namespace pw::benchmark::cfg
+
+#undef PW_BENCHMARK_CONFIG_WARMUP_ITERATIONS
+#undef PW_BENCHMARK_CONFIG_MIN_TIME_MS
+#undef PW_BENCHMARK_CONFIG_MAX_ITERATIONS
+#undef PW_BENCHMARK_CONFIG_CPU_CLOCK_HZ
@@ -0,0 +1,37 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+// The timer that benchmarks are measured with. Backends implement these
+// functions; benchmarks are only run from one thread at a time, so backends
+// need not be thread safe.
+namespace pw::benchmark::timer {
+
+// Prepares the timer, such as by enabling a cycle counter. Called before each
+// benchmark, so it must be safe to call repeatedly.
+void Init();
+
+// Returns the timer's current count. The count must not go backwards or wrap
+// while a benchmark runs.
+uint64_t Now();
+
+// The number of timer counts per second.
+uint64_t TicksPerSecond();
+
+// The unit of the timer's counts, such as "ns" or "cycles", for reporting.
+const char* Units();
+
+}  // namespace pw::benchmark::timer
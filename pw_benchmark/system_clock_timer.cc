@@ -0,0 +1,38 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Times benchmarks with pw::chrono::SystemClock, in nanoseconds. The results
+// are only as precise as the system clock, so benchmarks run longer on targets
+// with a coarse clock.
+
+#include <chrono>
+
+#include "pw_benchmark/timer.h"
+#include "pw_chrono/system_clock.h"
+
+namespace pw::benchmark::timer {
+
+void Init() {}
+
+uint64_t Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             chrono::SystemClock::now().time_since_epoch())
+      .count();
+}
+
+uint64_t TicksPerSecond() { return 1'000'000'000; }
+
+const char* Units() { return "ns"; }
+
+}  // namespace pw::benchmark::timer
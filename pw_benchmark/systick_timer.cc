@@ -0,0 +1,74 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Times benchmarks in CPU cycles with the SysTick timer, which every ARMv7-M
+// core has. Unlike the DWT cycle counter, SysTick is emulated by QEMU. This
+// takes over SysTick, so it cannot be used on targets that use it otherwise,
+// such as for an RTOS tick.
+
+#include "pw_benchmark/config.h"
+#include "pw_benchmark/timer.h"
+
+namespace pw::benchmark::timer {
+namespace {
+
+static_assert(cfg::kCpuClockHz != 0u,
+              "PW_BENCHMARK_CONFIG_CPU_CLOCK_HZ must be set to use the SysTick "
+              "timer");
+
+volatile uint32_t& cortex_m_syst_csr =
+    *reinterpret_cast<volatile uint32_t*>(0xE000E010u);
+volatile uint32_t& cortex_m_syst_rvr =
+    *reinterpret_cast<volatile uint32_t*>(0xE000E014u);
+volatile uint32_t& cortex_m_syst_cvr =
+    *reinterpret_cast<volatile uint32_t*>(0xE000E018u);
+
+constexpr uint32_t kSystCsrEnableMask = 1u << 0;
+constexpr uint32_t kSystCsrClksourceMask = 1u << 2;
+constexpr uint32_t kSystMaxCount = (1u << 24) - 1;
+
+// SysTick is 24 bits, so it wraps far sooner than the DWT cycle counter. Now()
+// extends it to 64 bits, which works as long as no timed run spans a wrap. A
+// timed run is at most 10 times the minimum time, so keep that under a wrap.
+static_assert(cfg::kCpuClockHz * cfg::kMinTimeMs / 1000 * 10 < kSystMaxCount,
+              "PW_BENCHMARK_CONFIG_MIN_TIME_MS is too long to time with "
+              "SysTick at this clock rate");
+
+uint32_t last_count = 0;
+uint64_t wraps = 0;
+
+}  // namespace
+
+void Init() {
+  // Count down from the maximum on the processor clock, with no interrupt.
+  cortex_m_syst_rvr = kSystMaxCount;
+  cortex_m_syst_cvr = 0;
+  cortex_m_syst_csr = kSystCsrEnableMask | kSystCsrClksourceMask;
+}
+
+uint64_t Now() {
+  // SysTick counts down, so flip it to count up.
+  const uint32_t count = kSystMaxCount - (cortex_m_syst_cvr & kSystMaxCount);
+  if (count < last_count) {
+    wraps += 1;
+  }
+  last_count = count;
+  return (wraps << 24) | count;
+}
+
+uint64_t TicksPerSecond() { return cfg::kCpuClockHz; }
+
+const char* Units() { return "cycles"; }
+
+}  // namespace pw::benchmark::timer
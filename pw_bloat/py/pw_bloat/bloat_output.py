@@ -15,8 +15,8 @@
 
 import abc
 import enum
-from typing import (Callable, Collection, Dict, List, Optional, Tuple, Type,
-                    Union)
+from typing import (Callable, Collection, Dict, List, Optional, Sequence,
+                    Tuple, Type, Union)
 
 from pw_bloat.binary_diff import BinaryDiff, FormattedDiff
 
@@ -88,10 +88,12 @@ class TableOutput(Output):
                            Type[LineCharset]] = AsciiCharset,
             preprocess: Callable[[str], str] = identity,
             # TODO(frolv): Make this a Literal type.
-            justify: str = 'rjust'):
+            justify: str = 'rjust',
+            columns: Sequence[str] = FormattedDiff._fields):
         self._cs = charset
         self._preprocess = preprocess
         self._justify = justify
+        self._columns = columns
 
         super().__init__(title, diffs)
 
@@ -100,7 +102,7 @@ class TableOutput(Output):
 
         # Calculate the width of each column in the table.
         max_label = len(self.LABEL_COLUMN)
-        column_widths = [len(field) for field in FormattedDiff._fields]
+        column_widths = [len(field) for field in self._columns]
 
         for diff in self._diffs:
             max_label = max(max_label, len(diff.label))
@@ -117,7 +119,7 @@ class TableOutput(Output):
 
         titles = [
             self._center_align(val.capitalize(), column_widths[i])
-            for i, val in enumerate(FormattedDiff._fields)
+            for i, val in enumerate(self._columns)
         ]
         column_names = [self._center_align(self.LABEL_COLUMN, max_label)
                         ] + titles
@@ -199,7 +201,9 @@ class TableOutput(Output):
 
 class RstOutput(TableOutput):
     """Tabular output in ASCII format, which is also valid RST."""
-    def __init__(self, diffs: Collection[BinaryDiff] = ()):
+    def __init__(self,
+                 diffs: Collection[BinaryDiff] = (),
+                 columns: Sequence[str] = FormattedDiff._fields):
         # Use RST line blocks within table cells to force each value to appear
         # on a new line in the HTML output.
         def add_rst_block(val: str) -> str:
@@ -209,4 +213,5 @@ class RstOutput(TableOutput):
                          diffs,
                          AsciiCharset,
                          preprocess=add_rst_block,
-                         justify='ljust')
+                         justify='ljust',
+                         columns=columns)
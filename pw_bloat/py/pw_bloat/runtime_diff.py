@@ -0,0 +1,96 @@
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""The runtime_diff module defines a class which stores benchmark time diffs."""
+
+import collections
+import re
+from typing import Dict, Generator, Optional
+
+from pw_bloat.binary_diff import BinaryDiff, FormattedDiff, format_percent
+
+BenchmarkTime = collections.namedtuple('BenchmarkTime', ['time', 'units'])
+
+# Columns of a runtime report table.
+RUNTIME_COLUMNS = ('benchmark', 'before', 'delta', 'after')
+
+# Matches the benchmark results printed by the pw_unit_test event handlers,
+# which may be prefixed with log metadata.
+_BENCHMARK_RESULT = re.compile(
+    r'\[    BENCH \] (?P<name>\S+): '
+    r'(?P<time>\d+(\.\d+)?) (?P<units>\S+)/iteration')
+
+
+def parse_benchmarks(output: str) -> Dict[str, BenchmarkTime]:
+    """Parses the time per iteration of each benchmark from test output."""
+    results: Dict[str, BenchmarkTime] = collections.OrderedDict()
+    for line in output.splitlines():
+        match = _BENCHMARK_RESULT.search(line)
+        if match:
+            results[match['name']] = BenchmarkTime(float(match['time']),
+                                                   match['units'])
+
+    return results
+
+
+def format_time(time: float, units: str, force_sign: bool = False) -> str:
+    """Formats a time per iteration to a tenth of a unit."""
+    prefix = '+' if force_sign and time > 0 else ''
+    return '{}{:,.1f} {}'.format(prefix, time, units)
+
+
+class RuntimeDiff(BinaryDiff):
+    """A diff of the benchmark times of a binary against a base binary."""
+    def __init__(self, label: str, before: Dict[str, BenchmarkTime],
+                 after: Dict[str, BenchmarkTime]):
+        super().__init__(label)
+        self._before = before
+        self._after = after
+
+    def formatted_segments(self) -> Generator[FormattedDiff, None, None]:
+        """Yields the times of each benchmark in either binary, formatted."""
+
+        if not self._before and not self._after:
+            yield FormattedDiff('(none)', '', '', '')
+            return
+
+        names = list(self._after)
+        names.extend(name for name in self._before if name not in self._after)
+
+        for name in names:
+            before: Optional[BenchmarkTime] = self._before.get(name)
+            after: Optional[BenchmarkTime] = self._after.get(name)
+
+            if before is None or after is None or before.units != after.units:
+                yield FormattedDiff(
+                    name,
+                    format_time(*before) if before else '(none)',
+                    '',
+                    format_time(*after) if after else '(none)',
+                )
+                continue
+
+            delta = after.time - before.time
+            if before.time:
+                percent = format_percent(delta / before.time, force_sign=True)
+                delta_str = '{} ({})'.format(
+                    format_time(delta, after.units, force_sign=True), percent)
+            else:
+                delta_str = format_time(delta, after.units, force_sign=True)
+
+            yield FormattedDiff(
+                name,
+                format_time(*before),
+                delta_str,
+                format_time(*after),
+            )
@@ -0,0 +1,158 @@
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""
+runtime_report is a script which generates a benchmark time report card for
+binaries, in the style of a size report.
+"""
+
+import argparse
+import logging
+import os
+import subprocess
+import sys
+from typing import Dict, List, Optional, Sequence
+
+import pw_cli.log
+
+from pw_bloat import bloat_output
+from pw_bloat.runtime_diff import (BenchmarkTime, RuntimeDiff, RUNTIME_COLUMNS,
+                                   parse_benchmarks)
+
+_LOG = logging.getLogger(__name__)
+
+
+def parse_args() -> argparse.Namespace:
+    """Parses the script's arguments."""
+    def binary_and_base(arg: str) -> List[str]:
+        args = arg.split(';')
+        if len(args) != 2:
+            raise argparse.ArgumentTypeError(
+                f'Argument must be a ;-delimited binary and base: "{arg}"')
+        return args
+
+    parser = argparse.ArgumentParser(
+        'Generate a benchmark time report card for binaries')
+    parser.add_argument('--labels',
+                        type=lambda arg: arg.split(';'),
+                        default=[],
+                        help='Labels for output binaries')
+    parser.add_argument('--out-dir',
+                        type=str,
+                        required=True,
+                        help='Directory in which to write output files')
+    parser.add_argument('--target',
+                        type=str,
+                        required=True,
+                        help='Build target name')
+    parser.add_argument('--title',
+                        type=str,
+                        default='pw_bloat',
+                        help='Report title')
+    parser.add_argument('--runner',
+                        type=str,
+                        help=('Script which runs a binary, passed as its first '
+                              'argument, and prints its output; by default, '
+                              'binaries are run directly'))
+    parser.add_argument('--runner-arg',
+                        dest='runner_args',
+                        action='append',
+                        default=[],
+                        help='Argument to pass to the runner after the binary')
+    parser.add_argument('diff_targets',
+                        type=binary_and_base,
+                        nargs='+',
+                        metavar='DIFF_TARGET',
+                        help='Binary;base pairs to process')
+
+    return parser.parse_args()
+
+
+def run_benchmarks(binary: str,
+                   runner: Optional[str] = None,
+                   runner_args: Sequence[str] = ()) -> str:
+    """Runs a binary containing benchmarks and returns its output.
+
+    Args:
+        binary: Path to the binary.
+        runner: Optional path to a script which runs the binary.
+        runner_args: Additional arguments to pass to the runner.
+
+    Returns:
+        The output of the binary.
+
+    Raises:
+        subprocess.CalledProcessError: The binary failed.
+    """
+
+    if runner is None:
+        cmd = [binary]
+    else:
+        cmd = [runner, binary, *runner_args]
+        if runner.endswith('.py'):
+            cmd.insert(0, sys.executable)
+
+    return subprocess.check_output(cmd, stderr=subprocess.STDOUT).decode(
+        errors='replace')
+
+
+def main() -> int:
+    """Program entry point."""
+
+    args = parse_args()
+
+    # Bases are often shared between binaries, so only run each one once.
+    results: Dict[str, Dict[str, BenchmarkTime]] = {}
+
+    def benchmarks(binary: str) -> Dict[str, BenchmarkTime]:
+        if binary not in results:
+            output = run_benchmarks(binary, args.runner, args.runner_args)
+            results[binary] = parse_benchmarks(output)
+        return results[binary]
+
+    diffs: List[RuntimeDiff] = []
+
+    for i, (binary, base) in enumerate(args.diff_targets):
+        binary_name = (args.labels[i]
+                       if i < len(args.labels) else os.path.basename(binary))
+        try:
+            diffs.append(
+                RuntimeDiff(binary_name, benchmarks(base), benchmarks(binary)))
+        except subprocess.CalledProcessError as err:
+            _LOG.error('%s: failed to run %s:\n%s', sys.argv[0],
+                       ' '.join(err.cmd), err.output.decode(errors='replace'))
+            return 1
+
+    def write_file(filename: str, contents: str) -> None:
+        path = os.path.join(args.out_dir, filename)
+        with open(path, 'w') as output_file:
+            output_file.write(contents)
+        _LOG.debug('Output written to %s', path)
+
+    out = bloat_output.TableOutput(args.title,
+                                   diffs,
+                                   charset=bloat_output.LineCharset,
+                                   columns=RUNTIME_COLUMNS)
+    rst = bloat_output.RstOutput(diffs, columns=RUNTIME_COLUMNS)
+    write_file(f'{args.target}', rst.diff())
+
+    complete_output = out.diff() + '\n'
+    write_file(f'{args.target}.txt', complete_output)
+    print(complete_output)
+
+    return 0
+
+
+if __name__ == '__main__':
+    pw_cli.log.install()
+    sys.exit(main())
@@ -20,7 +20,7 @@ setuptools.setup(
     version='0.0.1',
     author='Pigweed Authors',
     author_email='pigweed-developers@googlegroups.com',
-    description='Tools for generating binary size report cards',
+    description='Tools for generating binary size and runtime report cards',
     packages=setuptools.find_packages(),
     package_data={'pw_bloat': ['py.typed']},
     zip_safe=False,
@@ -81,6 +81,29 @@ Status BlobStore::LoadMetadata() {
 
 size_t BlobStore::MaxDataSizeBytes() const { return partition_.size_bytes(); }
 
+Status BlobStore::Verify() {
+  if (!initialized_) {
+    return Status::FailedPrecondition();
+  }
+
+  // The checksum state is shared with writes, and a failed blob is discarded,
+  // so nothing may be using the blob.
+  if (writer_open_ || readers_open_ != 0) {
+    return Status::Unavailable();
+  }
+
+  if (!ValidToRead()) {
+    return Status::FailedPrecondition();
+  }
+
+  if (!ValidateChecksum().ok()) {
+    PW_LOG_ERROR("Blob verify - Invalidating blob with invalid checksum");
+    Invalidate();
+    return Status::DataLoss();
+  }
+  return OkStatus();
+}
+
 Status BlobStore::OpenWrite() {
   if (!initialized_) {
     return Status::FailedPrecondition();
@@ -161,7 +184,8 @@ Status BlobStore::CloseWrite() {
                   std::min(checksum.size(), sizeof(metadata_.checksum)));
     }
 
-    if (!ValidateChecksum().ok()) {
+    if (verification_ == WriteVerification::kFull &&
+        !ValidateChecksum().ok()) {
       Invalidate();
       return Status::DataLoss();
     }
@@ -242,8 +266,9 @@ Status BlobStore::Write(ConstByteSpan data) {
       return OkStatus();
     }
 
-    // The write buffer is full, flush to flash.
-    if (!CommitToFlash(write_buffer_).ok()) {
+    // The write buffer is full, flush to flash. Only the first
+    // flash_write_size_bytes_ of the buffer are used by non-deferred writes.
+    if (!CommitToFlash(write_buffer_.first(flash_write_size_bytes_)).ok()) {
       return Status::DataLoss();
     }
 
@@ -364,17 +389,44 @@ Status BlobStore::CommitToFlash(ConstByteSpan source, size_t data_bytes) {
     data_bytes = source.size_bytes();
   }
   flash_erased_ = false;
-  StatusWithSize result = partition_.Write(flash_address_, source);
+  const kvs::FlashPartition::Address address = flash_address_;
+  Status status = partition_.Write(address, source).status();
   flash_address_ += data_bytes;
   if (checksum_algo_ != nullptr) {
     checksum_algo_->Update(source.first(data_bytes));
   }
 
-  if (!result.status().ok()) {
+  const bool sampled =
+      verification_ == WriteVerification::kSampled &&
+      (address / flash_write_size_bytes_) % kSampledWriteInterval == 0;
+  if (status.ok() && sampled) {
+    status = VerifyFlashWrite(address, source);
+  }
+
+  if (!status.ok()) {
     valid_data_ = false;
   }
 
-  return result.status();
+  return status;
+}
+
+Status BlobStore::VerifyFlashWrite(kvs::FlashPartition::Address address,
+                                   ConstByteSpan data) {
+  constexpr size_t kReadBufferSizeBytes = 32;
+  std::array<std::byte, kReadBufferSizeBytes> buffer;
+  while (!data.empty()) {
+    const size_t read_size = std::min(data.size_bytes(), buffer.size());
+    PW_TRY(partition_.Read(address, std::span(buffer).first(read_size)));
+
+    if (std::memcmp(buffer.data(), data.data(), read_size) != 0) {
+      PW_LOG_ERROR("Blob flash write at 0x%x did not read back",
+                   static_cast<unsigned>(address));
+      return Status::DataLoss();
+    }
+    address += read_size;
+    data = data.subspan(read_size);
+  }
+  return OkStatus();
 }
 
 // Needs to be in .cc file since PW_CHECK doesn't like being in .h files.
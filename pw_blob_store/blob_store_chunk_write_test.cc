@@ -50,16 +50,25 @@ class BlobStoreChunkTest : public ::testing::Test {
   }
 
   // Fill the source buffer with random pattern based on given seed, written to
-  // BlobStore in specified chunk size.
-  void ChunkWriteTest(size_t chunk_size) {
+  // BlobStore in specified chunk size. The flash write size defaults to the
+  // size of the write buffer.
+  void ChunkWriteTest(size_t chunk_size, size_t flash_write_size = 0) {
     constexpr size_t kBufferSize = 256;
     kvs::ChecksumCrc16 checksum;
 
+    if (flash_write_size == 0) {
+      flash_write_size = kBufferSize;
+    }
+
     char name[16] = {};
-    snprintf(name, sizeof(name), "Blob%u", static_cast<unsigned>(chunk_size));
+    snprintf(name,
+             sizeof(name),
+             "Blob%u_%u",
+             static_cast<unsigned>(chunk_size),
+             static_cast<unsigned>(flash_write_size));
 
     BlobStoreBuffer<kBufferSize> blob(
-        name, partition_, &checksum, kvs::TestKvs(), kBufferSize);
+        name, partition_, &checksum, kvs::TestKvs(), flash_write_size);
     EXPECT_EQ(OkStatus(), blob.Init());
 
     BlobStore::BlobWriter writer(blob);
@@ -162,6 +171,16 @@ TEST_F(BlobStoreChunkTest, ChunkWrite4096) {
   ChunkWriteTest(4096);
 }
 
+TEST_F(BlobStoreChunkTest, ChunkWrite5_FlashWriteSmallerThanBuffer) {
+  InitSourceBufferToRandom(0x5150);
+  ChunkWriteTest(5, kFlashAlignment);
+}
+
+TEST_F(BlobStoreChunkTest, ChunkWrite45_FlashWriteSmallerThanBuffer) {
+  InitSourceBufferToRandom(0x4545);
+  ChunkWriteTest(45, kFlashAlignment);
+}
+
 TEST_F(BlobStoreChunkTest, ChunkWriteSingleFull) {
   InitSourceBufferToRandom(0x98765);
   ChunkWriteTest(kBlobDataSize);
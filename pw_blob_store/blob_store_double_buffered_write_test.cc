@@ -0,0 +1,190 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_blob_store/double_buffered_writer.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/test_key_value_store.h"
+#include "pw_random/xor_shift.h"
+
+namespace pw::blob_store {
+namespace {
+
+constexpr size_t kFlashAlignment = 16;
+constexpr size_t kSectorSize = 2048;
+constexpr size_t kSectorCount = 2;
+constexpr size_t kBlobDataSize = kSectorCount * kSectorSize;
+
+constexpr size_t kFlashWriteSize = 64;
+constexpr size_t kWriterBufferSize = 4 * kFlashWriteSize;
+constexpr size_t kHalfSize = kWriterBufferSize / 2;
+
+class TestWriter final : public DoubleBufferedWriterBuffer<kWriterBufferSize> {
+ public:
+  using DoubleBufferedWriterBuffer::DoubleBufferedWriterBuffer;
+
+  size_t buffers_ready = 0;
+
+ private:
+  void BufferReady() override { buffers_ready += 1; }
+};
+
+class DoubleBufferedWriteTest : public ::testing::Test {
+ protected:
+  DoubleBufferedWriteTest()
+      : flash_(kFlashAlignment),
+        partition_(&flash_),
+        blob_("DoubleBuffered",
+              partition_,
+              &checksum_,
+              kvs::TestKvs(),
+              kFlashWriteSize),
+        writer_(blob_) {
+    random::XorShiftStarRng64 rng(0xb10b);
+    rng.Get(source_);
+  }
+
+  void SetUp() override {
+    ASSERT_EQ(OkStatus(), blob_.Init());
+    ASSERT_EQ(OkStatus(), writer_.Open());
+  }
+
+  bool FlashErased() const {
+    for (std::byte b : flash_.buffer()) {
+      if (b != kvs::FakeFlashMemory::kErasedValue) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Reads back the blob and compares it to the first size bytes of source_.
+  void VerifyBlob(size_t size) {
+    BlobStore::BlobReader reader(blob_);
+    ASSERT_EQ(OkStatus(), reader.Open());
+    ASSERT_EQ(size, reader.ConservativeReadLimit());
+
+    std::array<std::byte, kBlobDataSize> read_buffer;
+    Result<ByteSpan> result = reader.Read(std::span(read_buffer).first(size));
+    ASSERT_EQ(OkStatus(), result.status());
+    EXPECT_EQ(0, std::memcmp(read_buffer.data(), source_.data(), size));
+    EXPECT_EQ(OkStatus(), reader.Close());
+  }
+
+  ConstByteSpan source(size_t offset, size_t size) const {
+    return std::span(source_).subspan(offset, size);
+  }
+
+  kvs::FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  kvs::FlashPartition partition_;
+  kvs::ChecksumCrc16 checksum_;
+  BlobStoreBuffer<kFlashWriteSize> blob_;
+  TestWriter writer_;
+  std::array<std::byte, kBlobDataSize> source_;
+};
+
+TEST_F(DoubleBufferedWriteTest, Write_FullBuffer_HandsOffWithoutProgramming) {
+  ASSERT_EQ(OkStatus(), writer_.Write(source(0, kHalfSize)));
+
+  EXPECT_EQ(writer_.buffers_ready, 1u);
+  EXPECT_TRUE(writer_.commit_pending());
+  EXPECT_TRUE(FlashErased());
+
+  EXPECT_EQ(OkStatus(), writer_.CommitPending());
+  EXPECT_FALSE(writer_.commit_pending());
+  EXPECT_EQ(0, std::memcmp(flash_.buffer().data(), source_.data(), kHalfSize));
+
+  EXPECT_EQ(OkStatus(), writer_.Close());
+  VerifyBlob(kHalfSize);
+}
+
+TEST_F(DoubleBufferedWriteTest, Write_WhileCommitPending_FillsOtherBuffer) {
+  ASSERT_EQ(OkStatus(), writer_.Write(source(0, kHalfSize)));
+  EXPECT_EQ(writer_.ConservativeWriteLimit(), kHalfSize);
+
+  ASSERT_EQ(OkStatus(), writer_.Write(source(kHalfSize, kHalfSize)));
+  EXPECT_EQ(writer_.ConservativeWriteLimit(), 0u);
+  EXPECT_EQ(Status::ResourceExhausted(), writer_.Write(source(0, 1)));
+
+  // The commit also picks up the second buffer, which filled in the meantime.
+  EXPECT_EQ(OkStatus(), writer_.CommitPending());
+  EXPECT_EQ(writer_.ConservativeWriteLimit(), kWriterBufferSize);
+
+  EXPECT_EQ(OkStatus(), writer_.Close());
+  VerifyBlob(kWriterBufferSize);
+}
+
+TEST_F(DoubleBufferedWriteTest, Write_SpansBuffers_HandsOffFirst) {
+  ASSERT_EQ(OkStatus(), writer_.Write(source(0, kHalfSize - 10)));
+  EXPECT_FALSE(writer_.commit_pending());
+
+  ASSERT_EQ(OkStatus(), writer_.Write(source(kHalfSize - 10, 20)));
+  EXPECT_TRUE(writer_.commit_pending());
+  EXPECT_EQ(writer_.ConservativeWriteLimit(), kHalfSize - 10);
+
+  EXPECT_EQ(OkStatus(), writer_.Close());
+  VerifyBlob(kHalfSize + 10);
+}
+
+TEST_F(DoubleBufferedWriteTest, Write_WholeBlob) {
+  constexpr size_t kChunkSize = 48;
+
+  for (size_t offset = 0; offset < kBlobDataSize;) {
+    const size_t size = std::min(kChunkSize, kBlobDataSize - offset);
+    const Status status = writer_.Write(source(offset, size));
+    if (status.IsResourceExhausted()) {
+      ASSERT_EQ(OkStatus(), writer_.CommitPending());
+      continue;
+    }
+    ASSERT_EQ(OkStatus(), status);
+    offset += size;
+  }
+  EXPECT_EQ(Status::OutOfRange(), writer_.Write(source(0, 1)));
+
+  EXPECT_EQ(OkStatus(), writer_.Close());
+  VerifyBlob(kBlobDataSize);
+}
+
+TEST_F(DoubleBufferedWriteTest, Close_CommitsBufferedData) {
+  ASSERT_EQ(OkStatus(), writer_.Write(source(0, 100)));
+  EXPECT_TRUE(FlashErased());
+
+  EXPECT_EQ(OkStatus(), writer_.Close());
+  VerifyBlob(100);
+}
+
+TEST_F(DoubleBufferedWriteTest, CommitError_FailsWritesAndClose) {
+  flash_.InjectWriteError(kvs::FlashError::Unconditional(Status::Internal()));
+
+  ASSERT_EQ(OkStatus(), writer_.Write(source(0, kHalfSize)));
+  EXPECT_EQ(Status::DataLoss(), writer_.CommitPending());
+
+  EXPECT_EQ(writer_.ConservativeWriteLimit(), 0u);
+  EXPECT_EQ(Status::DataLoss(), writer_.Write(source(0, 1)));
+  EXPECT_EQ(Status::DataLoss(), writer_.Close());
+
+  BlobStore::BlobReader reader(blob_);
+  EXPECT_EQ(Status::FailedPrecondition(), reader.Open());
+}
+
+}  // namespace
+}  // namespace pw::blob_store
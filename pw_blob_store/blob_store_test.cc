@@ -275,6 +275,40 @@ TEST_F(BlobStoreTest, OffsetRead) {
   VerifyFlash(read_buffer, kOffset);
 }
 
+TEST_F(BlobStoreTest, SeekRead) {
+  InitSourceBufferToRandom(0x11309);
+  WriteTestBlock();
+
+  constexpr size_t kOffset = 10;
+  ASSERT_LT(kOffset, kBlobDataSize);
+
+  kvs::ChecksumCrc16 checksum;
+
+  char name[16] = "TestBlobBlock";
+  constexpr size_t kBufferSize = 16;
+  BlobStoreBuffer<kBufferSize> blob(
+      name, partition_, &checksum, kvs::TestKvs(), kBufferSize);
+  EXPECT_EQ(OkStatus(), blob.Init());
+  BlobStore::BlobReader reader(blob);
+  EXPECT_EQ(Status::FailedPrecondition(), reader.Seek(kOffset));
+  ASSERT_EQ(OkStatus(), reader.Open());
+
+  std::array<std::byte, kBlobDataSize - kOffset> read_buffer;
+  ASSERT_EQ(OkStatus(), reader.Read(read_buffer).status());
+  EXPECT_EQ(kBlobDataSize - kOffset, reader.Tell());
+
+  // Go back and read from the offset again.
+  ASSERT_EQ(OkStatus(), reader.Seek(kOffset));
+  EXPECT_EQ(kOffset, reader.Tell());
+  ASSERT_EQ(read_buffer.size(), reader.ConservativeReadLimit());
+  ASSERT_EQ(OkStatus(), reader.Read(read_buffer).status());
+  VerifyFlash(read_buffer, kOffset);
+
+  EXPECT_EQ(Status::OutOfRange(), reader.Seek(1, stream::Whence::kCurrent));
+  EXPECT_EQ(Status::OutOfRange(), reader.Read(read_buffer).status());
+  EXPECT_EQ(OkStatus(), reader.Close());
+}
+
 TEST_F(BlobStoreTest, InvalidReadOffset) {
   InitSourceBufferToRandom(0x11309);
   WriteTestBlock();
@@ -0,0 +1,220 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_blob_store/blob_store.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/test_key_value_store.h"
+#include "pw_random/xor_shift.h"
+
+namespace pw::blob_store {
+namespace {
+
+using Verification = BlobStore::WriteVerification;
+
+constexpr size_t kFlashAlignment = 16;
+constexpr size_t kSectorSize = 2048;
+constexpr size_t kSectorCount = 2;
+constexpr size_t kBlobDataSize = kSectorCount * kSectorSize;
+constexpr size_t kWriteSize = 64;
+
+// Fake flash that counts the bytes read from it, and can corrupt a byte as it
+// is written.
+class CheckedFlash
+    : public kvs::FakeFlashMemoryBuffer<kSectorSize, kSectorCount> {
+ public:
+  CheckedFlash() : FakeFlashMemoryBuffer(kFlashAlignment) {}
+
+  StatusWithSize Read(Address address, std::span<std::byte> output) override {
+    bytes_read += output.size();
+    return FakeFlashMemoryBuffer::Read(address, output);
+  }
+
+  StatusWithSize Write(Address address,
+                       std::span<const std::byte> data) override {
+    StatusWithSize result = FakeFlashMemoryBuffer::Write(address, data);
+    if (corrupt_address.has_value() && *corrupt_address >= address &&
+        *corrupt_address < address + data.size()) {
+      buffer()[*corrupt_address] ^= std::byte{0x01};
+    }
+    return result;
+  }
+
+  size_t bytes_read = 0;
+  std::optional<Address> corrupt_address;
+};
+
+class VerificationTest : public ::testing::Test {
+ protected:
+  VerificationTest() : partition_(&flash_) {
+    random::XorShiftStarRng64 rng(0x5eed);
+    rng.Get(source_);
+  }
+
+  // Writes the source data to a new blob, and returns the status of Close.
+  Status WriteBlob(BlobStore& blob) {
+    EXPECT_EQ(OkStatus(), blob.Init());
+    flash_.bytes_read = 0;
+
+    BlobStore::BlobWriter writer(blob);
+    EXPECT_EQ(OkStatus(), writer.Open());
+    for (ConstByteSpan data = source_; !data.empty();
+         data = data.subspan(kWriteSize)) {
+      if (Status status = writer.Write(data.first(kWriteSize)); !status.ok()) {
+        writer.Close();
+        return status;
+      }
+    }
+    return writer.Close();
+  }
+
+  bool Readable(BlobStore& blob) {
+    BlobStore::BlobReader reader(blob);
+    return reader.Open().ok() && reader.Close().ok();
+  }
+
+  CheckedFlash flash_;
+  kvs::FlashPartition partition_;
+  kvs::ChecksumCrc16 checksum_;
+  std::array<std::byte, kBlobDataSize> source_;
+};
+
+TEST_F(VerificationTest, Full_CloseReadsBackBlob) {
+  BlobStoreBuffer<kWriteSize> blob(
+      "Full", partition_, &checksum_, kvs::TestKvs(), kWriteSize);
+
+  EXPECT_EQ(OkStatus(), WriteBlob(blob));
+  EXPECT_GE(flash_.bytes_read, kBlobDataSize);
+  EXPECT_TRUE(Readable(blob));
+}
+
+TEST_F(VerificationTest, Full_CorruptWrite_CloseFails) {
+  BlobStoreBuffer<kWriteSize> blob(
+      "FullBad", partition_, &checksum_, kvs::TestKvs(), kWriteSize);
+  flash_.corrupt_address = kBlobDataSize - 1;
+
+  EXPECT_EQ(Status::DataLoss(), WriteBlob(blob));
+  EXPECT_FALSE(Readable(blob));
+}
+
+TEST_F(VerificationTest, Sampled_ReadsBackSampleOfWrites) {
+  BlobStoreBuffer<kWriteSize> blob("Sampled",
+                                   partition_,
+                                   &checksum_,
+                                   kvs::TestKvs(),
+                                   kWriteSize,
+                                   Verification::kSampled);
+
+  EXPECT_EQ(OkStatus(), WriteBlob(blob));
+  EXPECT_EQ(flash_.bytes_read,
+            kBlobDataSize / BlobStore::kSampledWriteInterval);
+  EXPECT_TRUE(Readable(blob));
+}
+
+TEST_F(VerificationTest, Sampled_CorruptSampledWrite_WriteFails) {
+  BlobStoreBuffer<kWriteSize> blob("SampledBad",
+                                   partition_,
+                                   &checksum_,
+                                   kvs::TestKvs(),
+                                   kWriteSize,
+                                   Verification::kSampled);
+  flash_.corrupt_address = kWriteSize * BlobStore::kSampledWriteInterval + 3;
+
+  EXPECT_EQ(Status::DataLoss(), WriteBlob(blob));
+  EXPECT_FALSE(Readable(blob));
+}
+
+TEST_F(VerificationTest, Deferred_CloseDoesNotRead) {
+  BlobStoreBuffer<kWriteSize> blob("Deferred",
+                                   partition_,
+                                   &checksum_,
+                                   kvs::TestKvs(),
+                                   kWriteSize,
+                                   Verification::kDeferred);
+
+  EXPECT_EQ(OkStatus(), WriteBlob(blob));
+  EXPECT_EQ(flash_.bytes_read, 0u);
+
+  EXPECT_EQ(OkStatus(), blob.Verify());
+  EXPECT_GE(flash_.bytes_read, kBlobDataSize);
+  EXPECT_TRUE(Readable(blob));
+}
+
+TEST_F(VerificationTest, Deferred_CorruptWrite_VerifyDiscardsBlob) {
+  BlobStoreBuffer<kWriteSize> blob("DeferredBad",
+                                   partition_,
+                                   &checksum_,
+                                   kvs::TestKvs(),
+                                   kWriteSize,
+                                   Verification::kDeferred);
+  flash_.corrupt_address = 100;
+
+  EXPECT_EQ(OkStatus(), WriteBlob(blob));
+  EXPECT_EQ(Status::DataLoss(), blob.Verify());
+  EXPECT_FALSE(Readable(blob));
+}
+
+TEST_F(VerificationTest, Deferred_CorruptWrite_InitDiscardsBlob) {
+  {
+    BlobStoreBuffer<kWriteSize> blob("DeferredInit",
+                                     partition_,
+                                     &checksum_,
+                                     kvs::TestKvs(),
+                                     kWriteSize,
+                                     Verification::kDeferred);
+    flash_.corrupt_address = 100;
+    EXPECT_EQ(OkStatus(), WriteBlob(blob));
+  }
+
+  BlobStoreBuffer<kWriteSize> blob("DeferredInit",
+                                   partition_,
+                                   &checksum_,
+                                   kvs::TestKvs(),
+                                   kWriteSize,
+                                   Verification::kDeferred);
+  EXPECT_EQ(OkStatus(), blob.Init());
+  EXPECT_FALSE(Readable(blob));
+}
+
+TEST_F(VerificationTest, Verify_ReaderOpen_Unavailable) {
+  BlobStoreBuffer<kWriteSize> blob("VerifyOpen",
+                                   partition_,
+                                   &checksum_,
+                                   kvs::TestKvs(),
+                                   kWriteSize,
+                                   Verification::kDeferred);
+  ASSERT_EQ(OkStatus(), WriteBlob(blob));
+
+  BlobStore::BlobReader reader(blob);
+  ASSERT_EQ(OkStatus(), reader.Open());
+  EXPECT_EQ(Status::Unavailable(), blob.Verify());
+  EXPECT_EQ(OkStatus(), reader.Close());
+}
+
+TEST_F(VerificationTest, Verify_NoBlob_FailedPrecondition) {
+  BlobStoreBuffer<kWriteSize> blob(
+      "VerifyEmpty", partition_, &checksum_, kvs::TestKvs(), kWriteSize);
+  EXPECT_EQ(OkStatus(), blob.Init());
+  EXPECT_EQ(Status::FailedPrecondition(), blob.Verify());
+}
+
+}  // namespace
+}  // namespace pw::blob_store
@@ -0,0 +1,183 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_blob_store/double_buffered_writer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "pw_assert/check.h"
+
+namespace pw::blob_store {
+
+DoubleBufferedWriter::DoubleBufferedWriter(BlobStore& store, ByteSpan buffer)
+    : writer_(store),
+      max_data_size_bytes_(store.MaxDataSizeBytes()),
+      buffers_{buffer.first(buffer.size_bytes() / 2),
+               buffer.subspan(buffer.size_bytes() / 2,
+                              buffer.size_bytes() / 2)},
+      filling_(0),
+      filled_bytes_(0),
+      pending_bytes_(0),
+      bytes_written_(0) {
+  PW_CHECK_UINT_GT(half_size(), 0);
+}
+
+Status DoubleBufferedWriter::Open() {
+  {
+    std::lock_guard lock(state_lock_);
+    filling_ = 0;
+    filled_bytes_ = 0;
+    pending_bytes_ = 0;
+    bytes_written_ = 0;
+    commit_status_ = OkStatus();
+  }
+  return writer_.Open();
+}
+
+Status DoubleBufferedWriter::Close() {
+  std::lock_guard commit_lock(commit_lock_);
+
+  // Commit whatever is waiting, then the partly filled buffer. Errors are kept
+  // in commit_status_.
+  CommitHandedOff();
+  {
+    std::lock_guard lock(state_lock_);
+    HandOff();
+  }
+  CommitHandedOff();
+
+  Status commit_status;
+  {
+    std::lock_guard lock(state_lock_);
+    commit_status = commit_status_;
+  }
+
+  // The blob is closed either way, which invalidates it after an error.
+  const Status close_status = writer_.Close();
+  return commit_status.ok() ? close_status : Status::DataLoss();
+}
+
+Status DoubleBufferedWriter::CommitPending() {
+  std::lock_guard commit_lock(commit_lock_);
+  return CommitHandedOff();
+}
+
+bool DoubleBufferedWriter::commit_pending() const {
+  std::lock_guard lock(state_lock_);
+  return pending_bytes_ != 0;
+}
+
+size_t DoubleBufferedWriter::ConservativeWriteLimit() const {
+  std::lock_guard lock(state_lock_);
+  return WriteLimit();
+}
+
+Status DoubleBufferedWriter::DoWrite(ConstByteSpan data) {
+  PW_DCHECK(writer_.IsOpen());
+  {
+    std::lock_guard lock(state_lock_);
+    if (!commit_status_.ok()) {
+      return Status::DataLoss();
+    }
+    if (bytes_written_ == max_data_size_bytes_) {
+      return Status::OutOfRange();
+    }
+    if (data.size_bytes() > WriteLimit()) {
+      return Status::ResourceExhausted();
+    }
+    bytes_written_ += data.size_bytes();
+  }
+
+  // The worker only hands off a full buffer, so the free part of the filling
+  // buffer is the writing thread's alone, and is filled without the lock.
+  bool handed_off = false;
+  while (!data.empty()) {
+    ByteSpan free_space;
+    {
+      std::lock_guard lock(state_lock_);
+      if (filled_bytes_ == half_size()) {
+        // The limit check above ensures the other buffer is free.
+        PW_CHECK(HandOff());
+        handed_off = true;
+      }
+      free_space = buffers_[filling_].subspan(filled_bytes_);
+    }
+
+    const size_t copy_size = std::min(free_space.size_bytes(), data.size());
+    std::memcpy(free_space.data(), data.data(), copy_size);
+    data = data.subspan(copy_size);
+
+    std::lock_guard lock(state_lock_);
+    filled_bytes_ += copy_size;
+    if (filled_bytes_ == half_size()) {
+      handed_off |= HandOff();
+    }
+  }
+
+  if (handed_off) {
+    BufferReady();
+  }
+  return OkStatus();
+}
+
+bool DoubleBufferedWriter::HandOff() {
+  if (pending_bytes_ != 0 || filled_bytes_ == 0) {
+    return false;
+  }
+  pending_bytes_ = filled_bytes_;
+  filling_ = 1 - filling_;
+  filled_bytes_ = 0;
+  return true;
+}
+
+size_t DoubleBufferedWriter::WriteLimit() const {
+  if (!commit_status_.ok()) {
+    return 0;
+  }
+  const size_t buffer_space =
+      half_size() - filled_bytes_ + (pending_bytes_ == 0 ? half_size() : 0);
+  return std::min(buffer_space, max_data_size_bytes_ - bytes_written_);
+}
+
+Status DoubleBufferedWriter::CommitHandedOff() {
+  while (true) {
+    ConstByteSpan pending;
+    {
+      std::lock_guard lock(state_lock_);
+      if (pending_bytes_ == 0) {
+        return commit_status_;
+      }
+      pending = buffers_[1 - filling_].first(pending_bytes_);
+    }
+
+    // Flash is programmed without the lock, while Write() fills the other
+    // buffer.
+    const Status status = writer_.Write(pending);
+
+    std::lock_guard lock(state_lock_);
+    if (commit_status_.ok() && !status.ok()) {
+      commit_status_ = status;
+    }
+    pending_bytes_ = 0;
+
+    // Writes may have filled the other buffer during the commit.
+    if (filled_bytes_ == half_size()) {
+      HandOff();
+    }
+  }
+}
+
+}  // namespace pw::blob_store
@@ -0,0 +1,544 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_blob_store/multi_blob_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "pw_assert/check.h"
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+
+namespace pw::blob_store {
+
+Status MultiBlobStore::BlobReader::Open(std::string_view name) {
+  PW_DASSERT(!open_);
+  if (!store_.initialized_) {
+    return Status::FailedPrecondition();
+  }
+
+  const Entry* entry = store_.FindEntry(name);
+  if (entry == nullptr) {
+    return Status::NotFound();
+  }
+
+  address_ = entry->address;
+  size_ = entry->size_bytes;
+  offset_ = 0;
+  open_ = true;
+  store_.readers_open_ += 1;
+  return OkStatus();
+}
+
+Result<ConstByteSpan> MultiBlobStore::BlobReader::GetMemoryMappedBlob() const {
+  PW_DASSERT(open_);
+  std::byte* mcu_address =
+      store_.partition_.PartitionAddressToMcuAddress(address_);
+  if (mcu_address == nullptr) {
+    return Status::Unimplemented();
+  }
+  return ConstByteSpan(mcu_address, size_);
+}
+
+StatusWithSize MultiBlobStore::BlobReader::DoRead(ByteSpan dest) {
+  PW_DASSERT(open_);
+  if (offset_ >= size_) {
+    return StatusWithSize::OutOfRange();
+  }
+
+  const size_t read_size = std::min(size_ - offset_, dest.size_bytes());
+  StatusWithSize result =
+      store_.partition_.Read(address_ + offset_, dest.first(read_size));
+  if (result.ok()) {
+    offset_ += result.size();
+  }
+  return result;
+}
+
+Status MultiBlobStore::BlobReader::DoSeek(ptrdiff_t offset,
+                                          stream::Whence origin) {
+  if (!open_) {
+    return Status::FailedPrecondition();
+  }
+  Result<size_t> position =
+      stream::internal::SeekPosition(offset, origin, offset_, size_);
+  if (!position.ok()) {
+    return position.status();
+  }
+  offset_ = position.value();
+  return OkStatus();
+}
+
+Status MultiBlobStore::Init() {
+  if (initialized_) {
+    return OkStatus();
+  }
+
+  PW_CHECK_UINT_GE(partition_.sector_count(), 2);
+  const size_t write_buffer_size_alignment =
+      write_buffer_.size_bytes() % partition_.alignment_bytes();
+  PW_CHECK_UINT_EQ(write_buffer_size_alignment, 0);
+  PW_CHECK_UINT_GE(write_buffer_.size_bytes(), record_size());
+
+  for (Entry& entry : entries_) {
+    entry.name_length = 0;
+  }
+  index_end_ = 0;
+  data_end_ = data_start();
+
+  // Replay the index. It ends at the first erased record.
+  bool found_records = false;
+  for (kvs::FlashPartition::Address address = 0;
+       address + record_size() <= partition_.sector_size_bytes();
+       address += record_size()) {
+    IndexRecord record;
+    PW_TRY(partition_.Read(address, sizeof(record), &record));
+    if (partition_.AppearsErased(std::as_bytes(std::span(&record, 1)))) {
+      break;
+    }
+    index_end_ = address + record_size();
+
+    // A record that was only partly written is skipped.
+    if (record.magic != kRecordMagic ||
+        record.record_crc != record.CalculateRecordCrc()) {
+      PW_LOG_WARN("MultiBlobStore skipping invalid index record at 0x%x",
+                  static_cast<unsigned>(address));
+      continue;
+    }
+    found_records = true;
+    PW_TRY(ApplyRecord(record));
+  }
+
+  if (!found_records && index_end_ != 0) {
+    PW_LOG_INFO("MultiBlobStore erasing index with no valid records");
+    PW_TRY(partition_.Erase(0, 1));
+    index_end_ = 0;
+  }
+
+  // A writer that was not closed may have left data after the last blob. Start
+  // the next blob in a fresh sector if the rest of this one is not erased.
+  if (data_end_ % partition_.sector_size_bytes() != 0) {
+    const size_t sector_end =
+        AlignUp(data_end_, partition_.sector_size_bytes());
+    bool erased = false;
+    PW_TRY(partition_.IsRegionErased(
+        data_end_, sector_end - data_end_, &erased));
+    if (!erased) {
+      data_end_ = sector_end;
+    }
+  }
+
+  PW_LOG_DEBUG("MultiBlobStore init with %u blobs, %u bytes free",
+               static_cast<unsigned>(blob_count()),
+               static_cast<unsigned>(FreeBytes()));
+  initialized_ = true;
+  return OkStatus();
+}
+
+StatusWithSize MultiBlobStore::BlobSize(std::string_view name) const {
+  const Entry* entry = FindEntry(name);
+  if (entry == nullptr) {
+    return StatusWithSize::NotFound();
+  }
+  return StatusWithSize(entry->size_bytes);
+}
+
+Status MultiBlobStore::Delete(std::string_view name) {
+  // The write buffer holds the record, so it cannot have writer data in it.
+  if (writer_open_) {
+    return Status::Unavailable();
+  }
+
+  Entry* entry = FindEntry(name);
+  if (entry == nullptr) {
+    return Status::NotFound();
+  }
+  return AppendRecord(*entry, /*deleted=*/true);
+}
+
+Status MultiBlobStore::Verify(std::string_view name) {
+  const Entry* entry = FindEntry(name);
+  if (entry == nullptr) {
+    return Status::NotFound();
+  }
+
+  checksum::Crc32 crc;
+  std::array<std::byte, 32> buffer;
+  for (size_t offset = 0; offset < entry->size_bytes;) {
+    const size_t read_size =
+        std::min(size_t(entry->size_bytes - offset), buffer.size());
+    if (!partition_
+             .Read(entry->address + offset, std::span(buffer).first(read_size))
+             .ok()) {
+      return Status::DataLoss();
+    }
+    crc.Update(std::span(buffer).first(read_size));
+    offset += read_size;
+  }
+  return crc.value() == entry->crc ? OkStatus() : Status::DataLoss();
+}
+
+Status MultiBlobStore::Compact(ByteSpan sector_buffer) {
+  if (writer_open_ || readers_open_ != 0) {
+    return Status::Unavailable();
+  }
+  if (sector_buffer.size_bytes() < partition_.sector_size_bytes()) {
+    return Status::InvalidArgument();
+  }
+
+  PW_LOG_INFO("MultiBlobStore compacting, reclaiming %u bytes",
+              static_cast<unsigned>(ReclaimableBytes()));
+  if (!MoveData(sector_buffer).ok() || !RewriteIndex().ok()) {
+    return Status::DataLoss();
+  }
+  return OkStatus();
+}
+
+size_t MultiBlobStore::blob_count() const {
+  return std::count_if(entries_.begin(), entries_.end(), [](const Entry& e) {
+    return e.name_length != 0;
+  });
+}
+
+size_t MultiBlobStore::ReclaimableBytes() const {
+  size_t used = 0;
+  for (const Entry& entry : entries_) {
+    if (entry.name_length != 0) {
+      used += AlignToFlash(entry.size_bytes);
+    }
+  }
+  return data_end_ - data_start() - used;
+}
+
+Status MultiBlobStore::OpenWrite(std::string_view name) {
+  if (!initialized_) {
+    return Status::FailedPrecondition();
+  }
+  if (writer_open_) {
+    return Status::Unavailable();
+  }
+  if (name.empty() || name.size() > kMaxNameLength) {
+    return Status::InvalidArgument();
+  }
+
+  // Make sure the blob can be added to the index before writing any data.
+  if (index_end_ + record_size() > partition_.sector_size_bytes() ||
+      (FindEntry(name) == nullptr && FreeEntry() == nullptr)) {
+    return Status::ResourceExhausted();
+  }
+
+  writer_entry_ = {};
+  std::copy(name.begin(), name.end(), writer_entry_.name.begin());
+  writer_entry_.name_length = static_cast<uint8_t>(name.size());
+  writer_entry_.address = data_end_;
+  writer_buffered_ = 0;
+  writer_crc_ = checksum::Crc32();
+  writer_status_ = OkStatus();
+  writer_open_ = true;
+  return OkStatus();
+}
+
+Status MultiBlobStore::Write(ConstByteSpan data) {
+  if (!writer_status_.ok()) {
+    return Status::DataLoss();
+  }
+  if (data.empty()) {
+    return OkStatus();
+  }
+  if (WriteLimit() == 0) {
+    return Status::OutOfRange();
+  }
+  if (data.size_bytes() > WriteLimit()) {
+    return Status::ResourceExhausted();
+  }
+
+  writer_crc_.Update(data);
+  writer_entry_.size_bytes += data.size_bytes();
+
+  const size_t alignment = partition_.alignment_bytes();
+  kvs::FlashPartition::Address address =
+      writer_entry_.address + writer_entry_.size_bytes - data.size_bytes() -
+      writer_buffered_;
+
+  while (!data.empty()) {
+    // Write whole aligned chunks straight from the data when nothing is
+    // buffered.
+    if (writer_buffered_ == 0 && data.size_bytes() >= alignment) {
+      const size_t write_size =
+          data.size_bytes() - data.size_bytes() % alignment;
+      writer_status_ = CommitToFlash(address, data.first(write_size));
+      address += write_size;
+      data = data.subspan(write_size);
+    } else {
+      const size_t copy_size =
+          std::min(write_buffer_.size_bytes() - writer_buffered_, data.size());
+      std::memcpy(
+          write_buffer_.data() + writer_buffered_, data.data(), copy_size);
+      writer_buffered_ += copy_size;
+      data = data.subspan(copy_size);
+
+      if (writer_buffered_ == write_buffer_.size_bytes()) {
+        writer_status_ = CommitToFlash(address, write_buffer_);
+        address += writer_buffered_;
+        writer_buffered_ = 0;
+      }
+    }
+
+    if (!writer_status_.ok()) {
+      return Status::DataLoss();
+    }
+  }
+  return OkStatus();
+}
+
+size_t MultiBlobStore::WriteLimit() const {
+  if (!writer_status_.ok()) {
+    return 0;
+  }
+  return partition_.size_bytes() - writer_entry_.address -
+         writer_entry_.size_bytes;
+}
+
+Status MultiBlobStore::CloseWrite() {
+  PW_DASSERT(writer_open_);
+  writer_open_ = false;
+
+  // Pad the rest of the data to the flash alignment.
+  if (writer_status_.ok() && writer_buffered_ != 0) {
+    const size_t padded_size = AlignToFlash(writer_buffered_);
+    std::memset(write_buffer_.data() + writer_buffered_,
+                static_cast<int>(partition_.erased_memory_content()),
+                padded_size - writer_buffered_);
+    writer_status_ = CommitToFlash(
+        writer_entry_.address + writer_entry_.size_bytes - writer_buffered_,
+        write_buffer_.first(padded_size));
+  }
+
+  // The blob's space is used whether or not it makes it to the index.
+  data_end_ = AlignToFlash(writer_entry_.address + writer_entry_.size_bytes);
+
+  writer_entry_.crc = writer_crc_.value();
+  if (!writer_status_.ok() ||
+      !AppendRecord(writer_entry_, /*deleted=*/false).ok()) {
+    return Status::DataLoss();
+  }
+  return OkStatus();
+}
+
+void MultiBlobStore::DiscardWrite() {
+  PW_DASSERT(writer_open_);
+  writer_open_ = false;
+
+  // Buffered bytes never reached flash, so the space after the written data is
+  // still erased.
+  data_end_ = writer_entry_.address + writer_entry_.size_bytes -
+              writer_buffered_;
+}
+
+Status MultiBlobStore::CommitToFlash(kvs::FlashPartition::Address address,
+                                     ConstByteSpan data) {
+  // Flash writes may not cross sectors, so the data is written one sector at a
+  // time.
+  const size_t sector_size = partition_.sector_size_bytes();
+  while (!data.empty()) {
+    if (address % sector_size == 0) {
+      PW_TRY(partition_.Erase(address, 1));
+    }
+    const size_t write_size =
+        std::min(data.size_bytes(), sector_size - address % sector_size);
+    PW_TRY(partition_.Write(address, data.first(write_size)));
+    address += write_size;
+    data = data.subspan(write_size);
+  }
+  return OkStatus();
+}
+
+Status MultiBlobStore::AppendRecord(const Entry& entry, bool deleted) {
+  if (index_end_ + record_size() > partition_.sector_size_bytes()) {
+    return Status::ResourceExhausted();
+  }
+
+  // The index ends after this record even if writing it fails partway.
+  const kvs::FlashPartition::Address address = index_end_;
+  index_end_ += record_size();
+  if (!WriteRecord(address, entry, deleted).ok()) {
+    return Status::DataLoss();
+  }
+
+  Entry* existing = FindEntry(entry.name_view());
+  if (deleted) {
+    PW_DCHECK_NOTNULL(existing);
+    existing->name_length = 0;
+    return OkStatus();
+  }
+
+  if (existing == nullptr) {
+    existing = FreeEntry();
+    PW_DCHECK_NOTNULL(existing);
+  }
+  *existing = entry;
+  return OkStatus();
+}
+
+Status MultiBlobStore::WriteRecord(kvs::FlashPartition::Address address,
+                                   const Entry& entry,
+                                   bool deleted) {
+  IndexRecord record = {
+      .magic = kRecordMagic,
+      .address = deleted ? 0 : entry.address,
+      .size_bytes = deleted ? kDeletedSize : entry.size_bytes,
+      .crc = deleted ? 0 : entry.crc,
+      .name = {},
+      .record_crc = 0,
+  };
+  std::copy_n(entry.name.begin(), entry.name_length, record.name.begin());
+  record.record_crc = record.CalculateRecordCrc();
+
+  const ByteSpan buffer = write_buffer_.first(record_size());
+  std::memset(buffer.data(),
+              static_cast<int>(partition_.erased_memory_content()),
+              buffer.size_bytes());
+  std::memcpy(buffer.data(), &record, sizeof(record));
+  return partition_.Write(address, buffer).status();
+}
+
+Status MultiBlobStore::ApplyRecord(const IndexRecord& record) {
+  const std::string_view name(
+      record.name.data(),
+      std::find(record.name.begin(), record.name.end(), '\0') -
+          record.name.begin());
+  Entry* entry = FindEntry(name);
+
+  if (record.size_bytes == kDeletedSize) {
+    if (entry != nullptr) {
+      entry->name_length = 0;
+    }
+    return OkStatus();
+  }
+
+  // Superseded copies still take up space until the store is compacted.
+  data_end_ = std::max<size_t>(
+      data_end_, AlignToFlash(record.address + record.size_bytes));
+
+  if (entry == nullptr) {
+    entry = FreeEntry();
+    if (entry == nullptr) {
+      PW_LOG_ERROR("MultiBlobStore has too few entries for the stored blobs");
+      return Status::ResourceExhausted();
+    }
+  }
+  std::copy(name.begin(), name.end(), entry->name.begin());
+  entry->name_length = static_cast<uint8_t>(name.size());
+  entry->address = record.address;
+  entry->size_bytes = record.size_bytes;
+  entry->crc = record.crc;
+  return OkStatus();
+}
+
+Status MultiBlobStore::MoveData(ByteSpan sector_buffer) {
+  // Blobs keep their order, so sorting them by address makes each blob's new
+  // address the sum of the sizes before it. Unused entries sort last.
+  std::sort(
+      entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) {
+        if (a.name_length == 0 || b.name_length == 0) {
+          return a.name_length > b.name_length;
+        }
+        return a.address < b.address;
+      });
+
+  const size_t sector_size = partition_.sector_size_bytes();
+  const size_t compacted_end = data_end_ - ReclaimableBytes();
+  ByteSpan sector = sector_buffer.first(sector_size);
+
+  // Each sector is rebuilt in RAM and then rewritten. Blobs only move towards
+  // the start of the partition, so the data for a sector is either in it or in
+  // a later sector, neither of which has been rewritten yet.
+  for (size_t sector_start = data_start(); sector_start < compacted_end;
+       sector_start += sector_size) {
+    std::memset(sector.data(),
+                static_cast<int>(partition_.erased_memory_content()),
+                sector.size_bytes());
+    const size_t sector_end = sector_start + sector_size;
+
+    size_t new_address = data_start();
+    for (const Entry& entry : entries_) {
+      if (entry.name_length == 0) {
+        break;
+      }
+      const size_t begin = std::max(new_address, sector_start);
+      const size_t end = std::min(new_address + entry.size_bytes, sector_end);
+      if (begin < end) {
+        PW_TRY(partition_.Read(
+            entry.address + (begin - new_address),
+            sector.subspan(begin - sector_start, end - begin)));
+      }
+      new_address += AlignToFlash(entry.size_bytes);
+    }
+
+    PW_TRY(partition_.Erase(sector_start, 1));
+    const size_t used = std::min(compacted_end, sector_end) - sector_start;
+    PW_TRY(partition_.Write(sector_start, sector.first(used)));
+  }
+
+  size_t new_address = data_start();
+  for (Entry& entry : entries_) {
+    if (entry.name_length == 0) {
+      break;
+    }
+    entry.address = new_address;
+    new_address += AlignToFlash(entry.size_bytes);
+  }
+  data_end_ = compacted_end;
+  return OkStatus();
+}
+
+Status MultiBlobStore::RewriteIndex() {
+  PW_TRY(partition_.Erase(0, 1));
+  index_end_ = 0;
+  for (const Entry& entry : entries_) {
+    if (entry.name_length == 0) {
+      continue;
+    }
+    PW_TRY(WriteRecord(index_end_, entry, /*deleted=*/false));
+    index_end_ += record_size();
+  }
+  return OkStatus();
+}
+
+MultiBlobStore::Entry* MultiBlobStore::FindEntry(std::string_view name) {
+  return const_cast<Entry*>(std::as_const(*this).FindEntry(name));
+}
+
+const MultiBlobStore::Entry* MultiBlobStore::FindEntry(
+    std::string_view name) const {
+  for (const Entry& entry : entries_) {
+    if (entry.name_length != 0 && entry.name_view() == name) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+MultiBlobStore::Entry* MultiBlobStore::FreeEntry() {
+  for (Entry& entry : entries_) {
+    if (entry.name_length == 0) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace pw::blob_store
@@ -0,0 +1,313 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_blob_store/multi_blob_store.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_random/xor_shift.h"
+
+namespace pw::blob_store {
+namespace {
+
+constexpr size_t kFlashAlignment = 16;
+constexpr size_t kSectorSize = 512;
+constexpr size_t kSectorCount = 6;
+constexpr size_t kDataSize = (kSectorCount - 1) * kSectorSize;
+constexpr size_t kMaxBlobs = 4;
+
+using TestStore = MultiBlobStoreBuffer<kMaxBlobs>;
+
+class MultiBlobStoreTest : public ::testing::Test {
+ protected:
+  MultiBlobStoreTest()
+      : flash_(kFlashAlignment), partition_(&flash_), store_(partition_) {
+    random::XorShiftStarRng64 rng(0x3b10b);
+    rng.Get(source_);
+  }
+
+  void SetUp() override {
+    ASSERT_EQ(OkStatus(), partition_.Erase());
+    ASSERT_EQ(OkStatus(), store_.Init());
+  }
+
+  // Writes a blob with size bytes of source_ from offset, in small pieces.
+  void WriteBlob(std::string_view name, size_t offset, size_t size) {
+    MultiBlobStore::BlobWriter writer(store_);
+    ASSERT_EQ(OkStatus(), writer.Open(name));
+    ConstByteSpan data = std::span(source_).subspan(offset, size);
+    while (!data.empty()) {
+      const size_t write_size = std::min<size_t>(data.size(), 21);
+      ASSERT_EQ(OkStatus(), writer.Write(data.first(write_size)));
+      data = data.subspan(write_size);
+    }
+    ASSERT_EQ(OkStatus(), writer.Close());
+  }
+
+  // Checks that the blob holds size bytes of source_ from offset.
+  void ExpectBlob(MultiBlobStore& store,
+                  std::string_view name,
+                  size_t offset,
+                  size_t size) {
+    MultiBlobStore::BlobReader reader(store);
+    ASSERT_EQ(OkStatus(), reader.Open(name));
+    ASSERT_EQ(reader.size(), size);
+
+    std::array<std::byte, kDataSize> buffer;
+    Result<ByteSpan> result = reader.Read(std::span(buffer).first(size));
+    ASSERT_EQ(OkStatus(), result.status());
+    ASSERT_EQ(result.value().size(), size);
+    EXPECT_EQ(0, std::memcmp(buffer.data(), &source_[offset], size));
+    EXPECT_EQ(OkStatus(), store.Verify(name));
+  }
+
+  kvs::FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  kvs::FlashPartition partition_;
+  TestStore store_;
+  std::array<std::byte, kDataSize> source_;
+};
+
+TEST_F(MultiBlobStoreTest, WriteRead_SeveralBlobsShareSectors) {
+  WriteBlob("a", 0, 100);
+  WriteBlob("b", 100, 7);
+  WriteBlob("c", 200, 600);
+
+  EXPECT_EQ(store_.blob_count(), 3u);
+  ExpectBlob(store_, "a", 0, 100);
+  ExpectBlob(store_, "b", 100, 7);
+  ExpectBlob(store_, "c", 200, 600);
+
+  // Each blob takes its aligned size, not whole sectors.
+  EXPECT_EQ(store_.FreeBytes(), kDataSize - 112 - 16 - 608);
+}
+
+TEST_F(MultiBlobStoreTest, Init_LoadsIndex) {
+  WriteBlob("a", 0, 100);
+  WriteBlob("b", 100, 300);
+
+  TestStore reloaded(partition_);
+  ASSERT_EQ(OkStatus(), reloaded.Init());
+  EXPECT_EQ(reloaded.blob_count(), 2u);
+  EXPECT_EQ(reloaded.FreeBytes(), store_.FreeBytes());
+  ExpectBlob(reloaded, "a", 0, 100);
+  ExpectBlob(reloaded, "b", 100, 300);
+}
+
+TEST_F(MultiBlobStoreTest, Read_MissingBlob_NotFound) {
+  MultiBlobStore::BlobReader reader(store_);
+  EXPECT_EQ(Status::NotFound(), reader.Open("missing"));
+  EXPECT_EQ(Status::NotFound(), store_.BlobSize("missing").status());
+}
+
+TEST_F(MultiBlobStoreTest, Write_Replace_OpenReaderKeepsOldCopy) {
+  WriteBlob("a", 0, 100);
+
+  MultiBlobStore::BlobReader old_reader(store_);
+  ASSERT_EQ(OkStatus(), old_reader.Open("a"));
+
+  WriteBlob("a", 500, 50);
+  EXPECT_EQ(store_.blob_count(), 1u);
+  ExpectBlob(store_, "a", 500, 50);
+
+  std::array<std::byte, 100> buffer;
+  ASSERT_EQ(OkStatus(), old_reader.Read(buffer).status());
+  EXPECT_EQ(0, std::memcmp(buffer.data(), source_.data(), buffer.size()));
+}
+
+TEST_F(MultiBlobStoreTest, Write_Discard_NotStored) {
+  WriteBlob("a", 0, 100);
+
+  MultiBlobStore::BlobWriter writer(store_);
+  ASSERT_EQ(OkStatus(), writer.Open("a"));
+  ASSERT_EQ(OkStatus(), writer.Write(std::span(source_).subspan(300, 40)));
+  writer.Discard();
+
+  ExpectBlob(store_, "a", 0, 100);
+  WriteBlob("b", 400, 30);
+  ExpectBlob(store_, "b", 400, 30);
+}
+
+TEST_F(MultiBlobStoreTest, Write_SecondWriter_Unavailable) {
+  MultiBlobStore::BlobWriter writer(store_);
+  ASSERT_EQ(OkStatus(), writer.Open("a"));
+
+  MultiBlobStore::BlobWriter other(store_);
+  EXPECT_EQ(Status::Unavailable(), other.Open("b"));
+  EXPECT_EQ(OkStatus(), writer.Close());
+}
+
+TEST_F(MultiBlobStoreTest, Write_BadName_InvalidArgument) {
+  MultiBlobStore::BlobWriter writer(store_);
+  EXPECT_EQ(Status::InvalidArgument(), writer.Open(""));
+  EXPECT_EQ(Status::InvalidArgument(),
+            writer.Open("a name that is longer than the limit"));
+}
+
+TEST_F(MultiBlobStoreTest, Write_TooManyBlobs_ResourceExhausted) {
+  for (char name : std::string_view("abcd")) {
+    WriteBlob(std::string_view(&name, 1), 0, 10);
+  }
+  MultiBlobStore::BlobWriter writer(store_);
+  EXPECT_EQ(Status::ResourceExhausted(), writer.Open("e"));
+
+  // Replacing an existing blob needs no new entry.
+  WriteBlob("a", 0, 20);
+}
+
+TEST_F(MultiBlobStoreTest, Write_PartitionFull_ResourceExhausted) {
+  MultiBlobStore::BlobWriter writer(store_);
+  ASSERT_EQ(OkStatus(), writer.Open("a"));
+  ASSERT_EQ(writer.ConservativeWriteLimit(), kDataSize);
+  EXPECT_EQ(OkStatus(), writer.Write(std::span(source_).first(kDataSize - 1)));
+  EXPECT_EQ(Status::ResourceExhausted(),
+            writer.Write(std::span(source_).first(2)));
+  EXPECT_EQ(OkStatus(), writer.Write(std::span(source_).first(1)));
+  EXPECT_EQ(Status::OutOfRange(), writer.Write(std::span(source_).first(1)));
+  EXPECT_EQ(OkStatus(), writer.Close());
+}
+
+TEST_F(MultiBlobStoreTest, Delete_PersistsAcrossInit) {
+  WriteBlob("a", 0, 100);
+  WriteBlob("b", 100, 100);
+  ASSERT_EQ(OkStatus(), store_.Delete("a"));
+  EXPECT_EQ(Status::NotFound(), store_.Delete("a"));
+
+  TestStore reloaded(partition_);
+  ASSERT_EQ(OkStatus(), reloaded.Init());
+  EXPECT_EQ(reloaded.blob_count(), 1u);
+  EXPECT_EQ(Status::NotFound(), reloaded.BlobSize("a").status());
+  ExpectBlob(reloaded, "b", 100, 100);
+}
+
+TEST_F(MultiBlobStoreTest, Verify_CorruptBlob_DataLoss) {
+  WriteBlob("a", 0, 100);
+  flash_.buffer()[kSectorSize + 50] ^= std::byte{0x80};
+  EXPECT_EQ(Status::DataLoss(), store_.Verify("a"));
+}
+
+TEST_F(MultiBlobStoreTest, Compact_ReclaimsReplacedAndDeletedBlobs) {
+  WriteBlob("a", 0, 300);
+  WriteBlob("b", 300, 400);
+  WriteBlob("c", 700, 250);
+  WriteBlob("a", 1000, 333);
+  ASSERT_EQ(OkStatus(), store_.Delete("b"));
+  WriteBlob("d", 1400, 500);
+
+  const size_t reclaimable = store_.ReclaimableBytes();
+  EXPECT_EQ(reclaimable, 304u + 400u);
+  const size_t free_bytes = store_.FreeBytes();
+
+  std::array<std::byte, kSectorSize> sector_buffer;
+  ASSERT_EQ(OkStatus(), store_.Compact(sector_buffer));
+
+  EXPECT_EQ(store_.ReclaimableBytes(), 0u);
+  EXPECT_EQ(store_.FreeBytes(), free_bytes + reclaimable);
+  ExpectBlob(store_, "a", 1000, 333);
+  ExpectBlob(store_, "c", 700, 250);
+  ExpectBlob(store_, "d", 1400, 500);
+
+  // The compacted store reloads, and has room for new blobs.
+  TestStore reloaded(partition_);
+  ASSERT_EQ(OkStatus(), reloaded.Init());
+  EXPECT_EQ(reloaded.FreeBytes(), store_.FreeBytes());
+  ExpectBlob(reloaded, "a", 1000, 333);
+  ExpectBlob(reloaded, "d", 1400, 500);
+
+  WriteBlob("b", 0, 600);
+  ExpectBlob(store_, "b", 0, 600);
+  ExpectBlob(store_, "c", 700, 250);
+}
+
+TEST_F(MultiBlobStoreTest, Compact_FullIndex_MakesRoom) {
+  const size_t records_per_sector = kSectorSize / 48;
+  for (size_t i = 0; i < records_per_sector; ++i) {
+    WriteBlob("a", i, 10);
+  }
+
+  MultiBlobStore::BlobWriter writer(store_);
+  EXPECT_EQ(Status::ResourceExhausted(), writer.Open("a"));
+
+  std::array<std::byte, kSectorSize> sector_buffer;
+  ASSERT_EQ(OkStatus(), store_.Compact(sector_buffer));
+  WriteBlob("a", 20, 10);
+  ExpectBlob(store_, "a", 20, 10);
+}
+
+TEST_F(MultiBlobStoreTest, Compact_ReaderOpen_Unavailable) {
+  WriteBlob("a", 0, 100);
+
+  MultiBlobStore::BlobReader reader(store_);
+  ASSERT_EQ(OkStatus(), reader.Open("a"));
+
+  std::array<std::byte, kSectorSize> sector_buffer;
+  EXPECT_EQ(Status::Unavailable(), store_.Compact(sector_buffer));
+  reader.Close();
+  EXPECT_EQ(OkStatus(), store_.Compact(sector_buffer));
+}
+
+TEST_F(MultiBlobStoreTest, Init_UnclosedWriterData_NextBlobSkipsIt) {
+  WriteBlob("a", 0, 100);
+
+  // Data left by a writer that never closed, after the last blob.
+  ASSERT_EQ(OkStatus(),
+            partition_.Write(kSectorSize + 112, std::span(source_).first(32))
+                .status());
+
+  TestStore reloaded(partition_);
+  ASSERT_EQ(OkStatus(), reloaded.Init());
+  EXPECT_EQ(reloaded.FreeBytes(), kDataSize - kSectorSize);
+
+  MultiBlobStore::BlobWriter writer(reloaded);
+  ASSERT_EQ(OkStatus(), writer.Open("b"));
+  ASSERT_EQ(OkStatus(), writer.Write(std::span(source_).first(64)));
+  ASSERT_EQ(OkStatus(), writer.Close());
+  ExpectBlob(reloaded, "a", 0, 100);
+  ExpectBlob(reloaded, "b", 0, 64);
+}
+
+TEST_F(MultiBlobStoreTest, Init_UnformattedPartition_Erased) {
+  std::memset(flash_.buffer().data(), 0x5a, flash_.buffer().size());
+
+  TestStore store(partition_);
+  ASSERT_EQ(OkStatus(), store.Init());
+  EXPECT_EQ(store.blob_count(), 0u);
+
+  MultiBlobStore::BlobWriter writer(store);
+  ASSERT_EQ(OkStatus(), writer.Open("a"));
+  ASSERT_EQ(OkStatus(), writer.Write(std::span(source_).first(64)));
+  ASSERT_EQ(OkStatus(), writer.Close());
+  ExpectBlob(store, "a", 0, 64);
+}
+
+TEST_F(MultiBlobStoreTest, Read_MemoryMapped) {
+  WriteBlob("a", 0, 100);
+  WriteBlob("b", 100, 200);
+
+  MultiBlobStore::BlobReader reader(store_);
+  ASSERT_EQ(OkStatus(), reader.Open("b"));
+  Result<ConstByteSpan> blob = reader.GetMemoryMappedBlob();
+  ASSERT_EQ(OkStatus(), blob.status());
+  ASSERT_EQ(blob.value().size(), 200u);
+  EXPECT_EQ(0, std::memcmp(blob.value().data(), &source_[100], 200));
+}
+
+}  // namespace
+}  // namespace pw::blob_store
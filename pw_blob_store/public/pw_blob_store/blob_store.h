@@ -48,6 +48,28 @@ namespace pw::blob_store {
 //  3) BlobReader::Close().
 class BlobStore {
  public:
+  // How a finished write is checked against the data in flash. The checksum is
+  // always calculated from the data as it is written, so none of these needs a
+  // second pass over flash to produce it.
+  enum class WriteVerification {
+    // Close reads back the whole blob and verifies it against the checksum.
+    // This doubles the flash traffic of a write.
+    kFull,
+
+    // The first flash write, and one in every kSampledWriteInterval after it,
+    // is read back and compared to the data while it is still in RAM. Close
+    // does not read back the blob.
+    kSampled,
+
+    // Close does not read back the blob. It is verified against its checksum
+    // the next time the BlobStore is initialized, or by calling Verify().
+    kDeferred,
+  };
+
+  // With WriteVerification::kSampled, one in this many flash writes is read
+  // back as it is made.
+  static constexpr size_t kSampledWriteInterval = 8;
+
   // Implement the stream::Writer and erase interface for a BlobStore. If not
   // already erased, the Write will do any needed erase.
   //
@@ -180,7 +202,7 @@ class BlobStore {
 
   // Implement stream::Reader interface for BlobStore. Multiple readers may be
   // open at the same time, but readers may not be open with a writer open.
-  class BlobReader final : public stream::Reader {
+  class BlobReader final : public stream::SeekableReader {
    public:
     constexpr BlobReader(BlobStore& store)
         : store_(store), open_(false), offset_(0) {}
@@ -257,6 +279,23 @@ class BlobStore {
       return status;
     }
 
+    // Seeks within the readable data. Returns FAILED_PRECONDITION if the
+    // reader is not open.
+    Status DoSeek(ptrdiff_t offset, stream::Whence origin) override {
+      if (!open_) {
+        return Status::FailedPrecondition();
+      }
+      Result<size_t> position = stream::internal::SeekPosition(
+          offset, origin, offset_, store_.ReadableDataBytes());
+      if (!position.ok()) {
+        return position.status();
+      }
+      offset_ = position.value();
+      return OkStatus();
+    }
+
+    size_t DoTell() const override { return offset_; }
+
     BlobStore& store_;
     bool open_;
     size_t offset_;
@@ -275,18 +314,21 @@ class BlobStore {
   //     This should be chosen to balance optimal write size and required buffer
   //     size. Must be greater than or equal to flash write alignment, less than
   //     or equal to flash sector size.
+  // verification - How a finished write is checked against flash.
   BlobStore(std::string_view name,
             kvs::FlashPartition& partition,
             kvs::ChecksumAlgorithm* checksum_algo,
             kvs::KeyValueStore& kvs,
             ByteSpan write_buffer,
-            size_t flash_write_size_bytes)
+            size_t flash_write_size_bytes,
+            WriteVerification verification = WriteVerification::kFull)
       : name_(name),
         partition_(partition),
         checksum_algo_(checksum_algo),
         kvs_(kvs),
         write_buffer_(write_buffer),
         flash_write_size_bytes_(flash_write_size_bytes),
+        verification_(verification),
         initialized_(false),
         valid_data_(false),
         flash_erased_(false),
@@ -308,6 +350,17 @@ class BlobStore {
   // Maximum number of data bytes this BlobStore is able to store.
   size_t MaxDataSizeBytes() const;
 
+  // Read back the stored blob and verify it against its checksum. This is the
+  // check that WriteVerification::kSampled and kDeferred skip on close, and
+  // can be run when the system has time for it. A blob that fails is
+  // discarded. Returns:
+  //
+  // OK - the blob is valid.
+  // DATA_LOSS - the blob did not match its checksum and was discarded.
+  // FAILED_PRECONDITION - there is no blob to verify.
+  // UNAVAILABLE - a writer or reader is open.
+  Status Verify();
+
  private:
   typedef uint32_t ChecksumValue;
 
@@ -449,6 +502,10 @@ class BlobStore {
 
   Status CalculateChecksumFromFlash(size_t bytes_to_check);
 
+  // Reads back a flash write that was just made and compares it to the data.
+  Status VerifyFlashWrite(kvs::FlashPartition::Address address,
+                          ConstByteSpan data);
+
   const std::string_view MetadataKey() { return name_; }
 
   // Changes to the metadata format should also get a different key signature to
@@ -480,6 +537,8 @@ class BlobStore {
   // alignment, LE flash sector size.
   const size_t flash_write_size_bytes_;
 
+  const WriteVerification verification_;
+
   //
   // Internal state for Blob store
   //
@@ -528,6 +587,7 @@ class BlobStore {
 //     This should be chosen to balance optimal write size and required buffer
 //     size. Must be greater than or equal to flash write alignment, less than
 //     or equal to flash sector size.
+// verification - How a finished write is checked against flash.
 
 template <size_t kBufferSizeBytes>
 class BlobStoreBuffer : public BlobStore {
@@ -536,13 +596,16 @@ class BlobStoreBuffer : public BlobStore {
                            kvs::FlashPartition& partition,
                            kvs::ChecksumAlgorithm* checksum_algo,
                            kvs::KeyValueStore& kvs,
-                           size_t flash_write_size_bytes)
+                           size_t flash_write_size_bytes,
+                           WriteVerification verification =
+                               WriteVerification::kFull)
       : BlobStore(name,
                   partition,
                   checksum_algo,
                   kvs,
                   buffer_,
-                  flash_write_size_bytes) {}
+                  flash_write_size_bytes,
+                  verification) {}
 
  private:
   std::array<std::byte, kBufferSizeBytes> buffer_;
@@ -0,0 +1,137 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "pw_blob_store/blob_store.h"
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+
+namespace pw::blob_store {
+
+// A blob writer that overlaps buffering incoming data with programming flash.
+// Its buffer is split into two halves: one fills with written data while the
+// other is committed to flash by a worker, so the writer does not stall while
+// flash programs.
+//
+// Writes never touch flash. When a half fills, it is handed off for committing
+// and BufferReady() is called. The worker, usually a thread woken by
+// BufferReady(), calls CommitPending() to write it to the BlobStore. A write
+// that does not fit while both halves are in use returns RESOURCE_EXHAUSTED,
+// like BlobStore::DeferredWriter; ConservativeWriteLimit() tells how much fits.
+//
+// Each half should be a multiple of the BlobStore's flash_write_size_bytes, so
+// handed-off buffers go to flash without another copy.
+//
+// Write() and Close() are called from one thread, and CommitPending() from one
+// thread or the writing thread.
+class DoubleBufferedWriter : public stream::Writer {
+ public:
+  DoubleBufferedWriter(BlobStore& store, ByteSpan buffer);
+
+  DoubleBufferedWriter(const DoubleBufferedWriter&) = delete;
+  DoubleBufferedWriter& operator=(const DoubleBufferedWriter&) = delete;
+
+  virtual ~DoubleBufferedWriter() = default;
+
+  // Opens the blob for writing, as BlobStore::BlobWriter::Open() does.
+  Status Open() PW_LOCKS_EXCLUDED(state_lock_);
+
+  // Commits any data that is waiting, in the calling thread, then closes the
+  // blob. Waits for a commit in progress on the worker to finish first.
+  // Returns:
+  //
+  // OK - success.
+  // DATA_LOSS - Error writing data or fail to verify written data.
+  Status Close() PW_LOCKS_EXCLUDED(state_lock_, commit_lock_);
+
+  bool IsOpen() { return writer_.IsOpen(); }
+
+  // Writes the buffer handed off for committing to flash, if there is one. If
+  // the other buffer filled up in the meantime, it is committed too. Returns
+  // OK if there was nothing to commit, or the first commit error, which also
+  // fails later writes.
+  Status CommitPending() PW_LOCKS_EXCLUDED(state_lock_, commit_lock_);
+
+  // True if a buffer is waiting for or in the middle of a commit.
+  bool commit_pending() const PW_LOCKS_EXCLUDED(state_lock_);
+
+  size_t ConservativeWriteLimit() const override
+      PW_LOCKS_EXCLUDED(state_lock_);
+
+ private:
+  // Called after a buffer is handed off for committing, from the thread that
+  // called Write(). Derived classes may override this to wake the thread that
+  // calls CommitPending().
+  virtual void BufferReady() {}
+
+  Status DoWrite(ConstByteSpan data) override PW_LOCKS_EXCLUDED(state_lock_);
+
+  // Hands off the filling buffer if the other one is free. Returns true if it
+  // did.
+  bool HandOff() PW_EXCLUSIVE_LOCKS_REQUIRED(state_lock_);
+
+  size_t WriteLimit() const PW_EXCLUSIVE_LOCKS_REQUIRED(state_lock_);
+
+  Status CommitHandedOff() PW_EXCLUSIVE_LOCKS_REQUIRED(commit_lock_)
+      PW_LOCKS_EXCLUDED(state_lock_);
+
+  size_t half_size() const { return buffers_[0].size_bytes(); }
+
+  BlobStore::BlobWriter writer_;
+  const size_t max_data_size_bytes_;
+  const std::array<ByteSpan, 2> buffers_;
+
+  // Held for the duration of commits to flash.
+  sync::Mutex commit_lock_;
+
+  mutable sync::InterruptSpinLock state_lock_;
+
+  // The buffer that Write() adds to, and how many bytes it holds. Only the
+  // writing thread copies into it.
+  size_t filling_ PW_GUARDED_BY(state_lock_);
+  size_t filled_bytes_ PW_GUARDED_BY(state_lock_);
+
+  // Bytes in the other buffer, which is waiting for or being committed. Zero
+  // if that buffer is free.
+  size_t pending_bytes_ PW_GUARDED_BY(state_lock_);
+
+  // Bytes accepted by Write() since the blob was opened.
+  size_t bytes_written_ PW_GUARDED_BY(state_lock_);
+
+  // The first commit error, which fails all later writes.
+  Status commit_status_ PW_GUARDED_BY(state_lock_);
+};
+
+// Creates a DoubleBufferedWriter with its buffer of kBufferSizeBytes, split in
+// two halves.
+template <size_t kBufferSizeBytes>
+class DoubleBufferedWriterBuffer : public DoubleBufferedWriter {
+ public:
+  static_assert(kBufferSizeBytes % 2 == 0);
+
+  explicit DoubleBufferedWriterBuffer(BlobStore& store)
+      : DoubleBufferedWriter(store, buffer_) {}
+
+ private:
+  std::array<std::byte, kBufferSizeBytes> buffer_;
+};
+
+}  // namespace pw::blob_store
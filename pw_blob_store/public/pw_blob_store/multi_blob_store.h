@@ -0,0 +1,367 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "pw_assert/assert.h"
+#include "pw_bytes/span.h"
+#include "pw_checksum/crc32.h"
+#include "pw_kvs/alignment.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
+
+namespace pw::blob_store {
+
+// MultiBlobStore packs several named blobs into one FlashPartition, so small
+// blobs share flash sectors instead of each taking a partition of its own.
+//
+// The first sector of the partition is the index: a log of records that each
+// give a blob's name, location, size, and CRC32. The remaining sectors hold
+// blob data, appended one blob after another at the partition's write
+// alignment. Init() loads the index into RAM, so finding a blob does not read
+// flash.
+//
+// Writing a blob that already exists appends a new copy, which replaces the old
+// one when the writer is closed. Readers that opened the old copy keep reading
+// it. Compact() reclaims the space of replaced, deleted, and discarded blobs.
+//
+// Any number of readers may be open alongside one writer. MultiBlobStore is not
+// thread safe; callers that share it between threads must serialize calls.
+class MultiBlobStore {
+ public:
+  // The longest blob name, in bytes.
+  static constexpr size_t kMaxNameLength = 28;
+
+  // Writes a new blob. Only one writer may be open at a time.
+  class BlobWriter final : public stream::Writer {
+   public:
+    constexpr BlobWriter(MultiBlobStore& store) : store_(store), open_(false) {}
+    BlobWriter(const BlobWriter&) = delete;
+    BlobWriter& operator=(const BlobWriter&) = delete;
+    ~BlobWriter() {
+      if (open_) {
+        Close();
+      }
+    }
+
+    // Opens a new blob with the given name. Returns:
+    //
+    // OK - success.
+    // INVALID_ARGUMENT - the name is empty or longer than kMaxNameLength.
+    // UNAVAILABLE - another writer is open.
+    // RESOURCE_EXHAUSTED - the index has no room for another blob; Compact()
+    //     may make room.
+    // FAILED_PRECONDITION - the store is not initialized.
+    Status Open(std::string_view name) {
+      PW_DASSERT(!open_);
+      Status status = store_.OpenWrite(name);
+      if (status.ok()) {
+        open_ = true;
+      }
+      return status;
+    }
+
+    // Flushes the blob to flash and adds it to the index, replacing any blob
+    // with the same name. Close fails in the closed state, do NOT retry Close
+    // on error. Returns:
+    //
+    // OK - success.
+    // DATA_LOSS - error writing the data or index. The blob is not stored, and
+    //     any blob it would replace is kept.
+    Status Close() {
+      PW_DASSERT(open_);
+      open_ = false;
+      return store_.CloseWrite();
+    }
+
+    // Abandons the blob without adding it to the index. Its space is
+    // reclaimed by Compact().
+    void Discard() {
+      PW_DASSERT(open_);
+      open_ = false;
+      store_.DiscardWrite();
+    }
+
+    bool IsOpen() const { return open_; }
+
+    // The number of bytes that fit in the partition after the blob so far.
+    size_t ConservativeWriteLimit() const override {
+      PW_DASSERT(open_);
+      return store_.WriteLimit();
+    }
+
+   private:
+    Status DoWrite(ConstByteSpan data) override {
+      PW_DASSERT(open_);
+      return store_.Write(data);
+    }
+
+    MultiBlobStore& store_;
+    bool open_;
+  };
+
+  // Reads a blob. The reader keeps reading the blob it opened, even if it is
+  // replaced or deleted while the reader is open.
+  class BlobReader final : public stream::SeekableReader {
+   public:
+    constexpr BlobReader(MultiBlobStore& store)
+        : store_(store), open_(false), address_(0), size_(0), offset_(0) {}
+    BlobReader(const BlobReader&) = delete;
+    BlobReader& operator=(const BlobReader&) = delete;
+    ~BlobReader() {
+      if (open_) {
+        Close();
+      }
+    }
+
+    // Opens the blob with the given name. Returns:
+    //
+    // OK - success.
+    // NOT_FOUND - there is no blob with that name.
+    // FAILED_PRECONDITION - the store is not initialized.
+    Status Open(std::string_view name);
+
+    void Close() {
+      PW_DASSERT(open_);
+      open_ = false;
+      store_.CloseRead();
+    }
+
+    bool IsOpen() const { return open_; }
+
+    // The size of the blob in bytes.
+    size_t size() const {
+      PW_DASSERT(open_);
+      return size_;
+    }
+
+    size_t ConservativeReadLimit() const override {
+      PW_DASSERT(open_);
+      return size_ - offset_;
+    }
+
+    // Get a span with the MCU pointer and size of the data. Returns:
+    //
+    // OK with span - the blob data.
+    // UNIMPLEMENTED - the flash is not memory mapped.
+    Result<ConstByteSpan> GetMemoryMappedBlob() const;
+
+   private:
+    StatusWithSize DoRead(ByteSpan dest) override;
+
+    Status DoSeek(ptrdiff_t offset, stream::Whence origin) override;
+
+    size_t DoTell() const override { return offset_; }
+
+    MultiBlobStore& store_;
+    bool open_;
+    kvs::FlashPartition::Address address_;
+    size_t size_;
+    size_t offset_;
+  };
+
+  // The RAM copy of an index entry. MultiBlobStoreBuffer provides storage for
+  // these; they are not used directly.
+  struct Entry {
+    std::array<char, kMaxNameLength> name;
+    uint8_t name_length;
+    uint32_t address;
+    uint32_t size_bytes;
+    uint32_t crc;
+
+    std::string_view name_view() const {
+      return std::string_view(name.data(), name_length);
+    }
+  };
+
+  // partition - Flash partition for the index and blob data. Needs at least two
+  //     sectors.
+  // entries - RAM for the index; the most blobs the store can hold.
+  // write_buffer - Buffers writes to the partition's alignment, and holds
+  //     index records. Must be a multiple of the partition's alignment, and at
+  //     least one aligned index record in size.
+  MultiBlobStore(kvs::FlashPartition& partition,
+                 std::span<Entry> entries,
+                 ByteSpan write_buffer)
+      : partition_(partition),
+        entries_(entries),
+        write_buffer_(write_buffer),
+        initialized_(false),
+        writer_open_(false),
+        readers_open_(0),
+        index_end_(0),
+        data_end_(0),
+        writer_entry_{},
+        writer_buffered_(0),
+        writer_status_(OkStatus()) {}
+
+  MultiBlobStore(const MultiBlobStore&) = delete;
+  MultiBlobStore& operator=(const MultiBlobStore&) = delete;
+
+  // Loads the index from flash. An index with no valid records is erased, so a
+  // new partition needs no formatting. Returns:
+  //
+  // OK - success.
+  // RESOURCE_EXHAUSTED - flash holds more blobs than there are entries.
+  // [error status] - reading or erasing flash failed.
+  Status Init();
+
+  // Returns the size of the named blob, or NOT_FOUND.
+  StatusWithSize BlobSize(std::string_view name) const;
+
+  // Removes the named blob from the index. Open readers keep reading it.
+  // Returns:
+  //
+  // OK - success.
+  // NOT_FOUND - there is no blob with that name.
+  // UNAVAILABLE - a writer is open.
+  // RESOURCE_EXHAUSTED - the index is full; Compact() to make room.
+  // DATA_LOSS - writing the index failed.
+  Status Delete(std::string_view name);
+
+  // Reads back the named blob and checks it against its CRC32. Returns:
+  //
+  // OK - the blob is valid.
+  // NOT_FOUND - there is no blob with that name.
+  // DATA_LOSS - the blob does not match its CRC32.
+  Status Verify(std::string_view name);
+
+  // Moves the stored blobs to the start of the data sectors and rewrites the
+  // index, reclaiming the space of replaced, deleted, and discarded blobs.
+  // sector_buffer must be at least one sector in size. Compaction rewrites
+  // flash in place; blobs may be lost if power fails during it. Returns:
+  //
+  // OK - success.
+  // UNAVAILABLE - a reader or writer is open.
+  // INVALID_ARGUMENT - sector_buffer is smaller than a sector.
+  // DATA_LOSS - flash failed; blobs may have been lost.
+  Status Compact(ByteSpan sector_buffer);
+
+  // The number of blobs stored.
+  size_t blob_count() const;
+
+  // Bytes available for new blob data without compacting.
+  size_t FreeBytes() const { return partition_.size_bytes() - data_end_; }
+
+  // Bytes that Compact() would make available.
+  size_t ReclaimableBytes() const;
+
+ private:
+  // The format of an index record in flash. A record with size_bytes of
+  // kDeletedSize deletes the named blob.
+  struct IndexRecord {
+    uint32_t magic;
+    uint32_t address;
+    uint32_t size_bytes;
+    uint32_t crc;
+    std::array<char, kMaxNameLength> name;
+    uint32_t record_crc;
+
+    uint32_t CalculateRecordCrc() const {
+      return checksum::Crc32::Calculate(
+          std::as_bytes(std::span(this, 1)).first(offsetof(IndexRecord,
+                                                            record_crc)));
+    }
+  };
+  static_assert(sizeof(IndexRecord) == 48);
+
+  static constexpr uint32_t kRecordMagic = 0x424c4d4d;  // "MMLB"
+  static constexpr uint32_t kDeletedSize = 0xffffffff;
+
+  Status OpenWrite(std::string_view name);
+  Status CloseWrite();
+  void DiscardWrite();
+  Status Write(ConstByteSpan data);
+  size_t WriteLimit() const;
+
+  void CloseRead() {
+    PW_DASSERT(readers_open_ > 0);
+    readers_open_ -= 1;
+  }
+
+  // Writes data to the data sectors, erasing each sector it reaches the start
+  // of first.
+  Status CommitToFlash(kvs::FlashPartition::Address address,
+                       ConstByteSpan data);
+
+  // Adds a record to the end of the index and applies it to the entries.
+  Status AppendRecord(const Entry& entry, bool deleted);
+  Status WriteRecord(kvs::FlashPartition::Address address,
+                     const Entry& entry,
+                     bool deleted);
+
+  // Applies a record read from flash to the entries.
+  Status ApplyRecord(const IndexRecord& record);
+
+  Status MoveData(ByteSpan sector_buffer);
+  Status RewriteIndex();
+
+  Entry* FindEntry(std::string_view name);
+  const Entry* FindEntry(std::string_view name) const;
+  Entry* FreeEntry();
+
+  size_t record_size() const {
+    return AlignUp(sizeof(IndexRecord), partition_.alignment_bytes());
+  }
+  size_t data_start() const { return partition_.sector_size_bytes(); }
+  size_t AlignToFlash(size_t value) const {
+    return AlignUp(value, partition_.alignment_bytes());
+  }
+
+  kvs::FlashPartition& partition_;
+  const std::span<Entry> entries_;
+  const ByteSpan write_buffer_;
+
+  bool initialized_;
+  bool writer_open_;
+  size_t readers_open_;
+
+  // End of the records in the index sector.
+  kvs::FlashPartition::Address index_end_;
+
+  // End of the blob data written so far, where the next blob starts. The data
+  // sectors after it are either erased up to the end of its sector, or start at
+  // a sector boundary and are erased before they are written.
+  kvs::FlashPartition::Address data_end_;
+
+  // The blob being written. Its size includes writer_buffered_ bytes that are
+  // still in the write buffer.
+  Entry writer_entry_;
+  size_t writer_buffered_;
+  checksum::Crc32 writer_crc_;
+  Status writer_status_;
+};
+
+// Creates a MultiBlobStore with storage for up to kMaxBlobs blobs and a write
+// buffer of kWriteBufferSizeBytes.
+template <size_t kMaxBlobs, size_t kWriteBufferSizeBytes = 64>
+class MultiBlobStoreBuffer : public MultiBlobStore {
+ public:
+  explicit MultiBlobStoreBuffer(kvs::FlashPartition& partition)
+      : MultiBlobStore(partition, entries_, write_buffer_) {}
+
+ private:
+  std::array<Entry, kMaxBlobs> entries_;
+  std::array<std::byte, kWriteBufferSizeBytes> write_buffer_;
+};
+
+}  // namespace pw::blob_store
@@ -52,6 +52,7 @@
 //     3.7. pw_boot_PostMain()
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -69,20 +70,95 @@ extern uint8_t _pw_zero_init_ram_end;
 // Functions called as part of firmware initialization.
 void __libc_init_array(void);
 
+// Static memory is copied and zeroed in 32-byte blocks with LDM/STM, which is
+// much faster than the byte-at-a-time memcpy and memset of some C libraries.
+// This requires 8-byte aligned regions, as basic_armv7m.ld provides. Regions
+// from other linker scripts that are not aligned use memcpy and memset.
+#define BLOCK_SIZE 32u
+
+static bool IsAligned(const uint8_t* address) {
+  return ((uintptr_t)address % 8u) == 0u;
+}
+
+static void CopyAligned(uint8_t* dest, const uint8_t* src, size_t size) {
+  size_t blocks = size / BLOCK_SIZE;
+  if (blocks != 0u) {
+    __asm__ volatile(
+        "1:\n"
+        "ldmia %[src]!, {r3, r4, r5, r6}\n"
+        "stmia %[dest]!, {r3, r4, r5, r6}\n"
+        "ldmia %[src]!, {r3, r4, r5, r6}\n"
+        "stmia %[dest]!, {r3, r4, r5, r6}\n"
+        "subs %[blocks], %[blocks], #1\n"
+        "bne 1b\n"
+        : [dest] "+r"(dest), [src] "+r"(src), [blocks] "+r"(blocks)
+        :
+        : "r3", "r4", "r5", "r6", "cc", "memory");
+  }
+
+  // Copy the remaining words.
+  uint32_t* dest_word = (uint32_t*)dest;
+  const uint32_t* src_word = (const uint32_t*)src;
+  for (size = (size % BLOCK_SIZE) / 4u; size != 0u; --size) {
+    *dest_word++ = *src_word++;
+  }
+}
+
+static void ZeroAligned(uint8_t* dest, size_t size) {
+  size_t blocks = size / BLOCK_SIZE;
+  if (blocks != 0u) {
+    __asm__ volatile(
+        "movs r3, #0\n"
+        "movs r4, #0\n"
+        "movs r5, #0\n"
+        "movs r6, #0\n"
+        "1:\n"
+        "stmia %[dest]!, {r3, r4, r5, r6}\n"
+        "stmia %[dest]!, {r3, r4, r5, r6}\n"
+        "subs %[blocks], %[blocks], #1\n"
+        "bne 1b\n"
+        : [dest] "+r"(dest), [blocks] "+r"(blocks)
+        :
+        : "r3", "r4", "r5", "r6", "cc", "memory");
+  }
+
+  uint32_t* dest_word = (uint32_t*)dest;
+  for (size = (size % BLOCK_SIZE) / 4u; size != 0u; --size) {
+    *dest_word++ = 0u;
+  }
+}
+
 // WARNING: Be EXTREMELY careful when running code before this function
 // completes. The context before this function violates the C spec
 // (Section 6.7.8, paragraph 10 for example, which requires uninitialized static
 // values to be zero-initialized).
 void StaticMemoryInit(void) {
   // Static-init RAM (load static values into ram, .data section init).
-  memcpy(&_pw_static_init_ram_start,
-         &_pw_static_init_flash_start,
-         &_pw_static_init_ram_end - &_pw_static_init_ram_start);
+  const size_t static_init_size =
+      &_pw_static_init_ram_end - &_pw_static_init_ram_start;
+
+  if (IsAligned(&_pw_static_init_ram_start) &&
+      IsAligned(&_pw_static_init_flash_start) &&
+      IsAligned(&_pw_static_init_ram_end)) {
+    CopyAligned(&_pw_static_init_ram_start,
+                &_pw_static_init_flash_start,
+                static_init_size);
+  } else {
+    memcpy(&_pw_static_init_ram_start,
+           &_pw_static_init_flash_start,
+           static_init_size);
+  }
 
   // Zero-init RAM (.bss section init).
-  memset(&_pw_zero_init_ram_start,
-         0,
-         &_pw_zero_init_ram_end - &_pw_zero_init_ram_start);
+  const size_t zero_init_size =
+      &_pw_zero_init_ram_end - &_pw_zero_init_ram_start;
+
+  if (IsAligned(&_pw_zero_init_ram_start) &&
+      IsAligned(&_pw_zero_init_ram_end)) {
+    ZeroAligned(&_pw_zero_init_ram_start, zero_init_size);
+  } else {
+    memset(&_pw_zero_init_ram_start, 0, zero_init_size);
+  }
 }
 
 // WARNING: This code is run immediately upon boot, and performs initialization
@@ -46,6 +46,17 @@
 #include "pw_preprocessor/compiler.h"
 #include "pw_preprocessor/util.h"
 
+// Places a global or static variable in RAM that is not zeroed at boot, such
+// as a large ring buffer or trace buffer that is always written before it is
+// read. This saves the time to zero it in pw_boot_Entry(). The variable holds
+// arbitrary values until it is written, and keeps its contents across a reset
+// that does not power off the RAM. Objects with constructors are still
+// constructed.
+//
+//   PW_BOOT_NO_INIT std::array<std::byte, 65536> trace_buffer;
+//
+#define PW_BOOT_NO_INIT __attribute__((section(".pw_boot_no_init")))
+
 PW_EXTERN_C_START
 
 // The following extern symbols are provided by the linker script, and their
@@ -71,6 +82,11 @@ extern uint8_t pw_boot_stack_high_addr;
 extern uint8_t pw_boot_heap_low_addr;
 extern uint8_t pw_boot_heap_high_addr;
 
+// pw_boot_no_init_ram_[low/high]_addr indicate the address range of the
+// variables placed with PW_BOOT_NO_INIT.
+extern uint8_t pw_boot_no_init_ram_low_addr;
+extern uint8_t pw_boot_no_init_ram_high_addr;
+
 // The address that denotes the beginning of the .vector_table section. This
 // can be used to set VTOR (vector table offset register) by the bootloader.
 extern uint8_t pw_boot_vector_table_addr;
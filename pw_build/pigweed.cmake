@@ -284,6 +284,11 @@ endfunction(pw_set_backend)
 #   GROUPS: groups to which to add this test; if none are specified, the test is
 #       added to the 'default' and 'all' groups
 #
+# The test's main function is provided by the pw_unit_test_MAIN library.
+#
+set(pw_unit_test_MAIN pw_unit_test.main CACHE STRING
+    "Library that provides the main function for unit tests")
+
 function(pw_add_test NAME)
   _pw_parse_argv_strict(pw_add_test 1 "" "" "SOURCES;DEPS;GROUPS")
 
@@ -291,7 +296,7 @@ function(pw_add_test NAME)
   target_link_libraries("${NAME}"
     PRIVATE
       pw_unit_test
-      pw_unit_test.main
+      "${pw_unit_test_MAIN}"
       ${arg_DEPS}
   )
 
@@ -0,0 +1,101 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Converts blocks of big-endian sensor samples to native byte order, one value
+// at a time with ReadInOrder and in bulk with the span overloads. The byte
+// order and sample count are hidden from the optimizer, as they are when they
+// come from a protocol header.
+
+#include <array>
+#include <cstdint>
+
+#include "pw_benchmark/benchmark.h"
+#include "pw_bytes/endian.h"
+
+namespace pw::bytes {
+namespace {
+
+using benchmark::DoNotOptimize;
+using benchmark::State;
+
+constexpr size_t kSamples = 1000;
+
+template <typename T>
+struct Samples {
+  Samples() {
+    for (size_t i = 0; i < packed.size(); ++i) {
+      packed[i] = static_cast<std::byte>(i * 37);
+    }
+  }
+
+  std::array<std::byte, kSamples * sizeof(T)> packed;
+  std::array<T, kSamples> values;
+  std::endian order = std::endian::big;
+  size_t count = kSamples;
+};
+
+template <typename T>
+void ReadEach(State& state) {
+  Samples<T> samples;
+  DoNotOptimize(samples.order);
+  DoNotOptimize(samples.count);
+  for (auto _ : state) {
+    for (size_t i = 0; i < samples.count; ++i) {
+      samples.values[i] =
+          ReadInOrder<T>(samples.order, &samples.packed[i * sizeof(T)]);
+    }
+    DoNotOptimize(samples.values.data());
+    benchmark::ClobberMemory();
+  }
+}
+
+template <typename T>
+void ReadBulk(State& state) {
+  Samples<T> samples;
+  DoNotOptimize(samples.order);
+  DoNotOptimize(samples.count);
+  for (auto _ : state) {
+    DoNotOptimize(ReadInOrder(std::span(samples.values).first(samples.count),
+                              samples.packed,
+                              samples.order));
+    benchmark::ClobberMemory();
+  }
+}
+
+template <typename T>
+void WriteBulk(State& state) {
+  Samples<T> samples;
+  DoNotOptimize(samples.order);
+  DoNotOptimize(samples.count);
+  for (auto _ : state) {
+    DoNotOptimize(WriteInOrder(samples.packed,
+                               std::span(samples.values).first(samples.count),
+                               samples.order));
+    benchmark::ClobberMemory();
+  }
+}
+
+PW_BENCHMARK(Endian, ReadEach_1000x16Bit) { ReadEach<int16_t>(state); }
+PW_BENCHMARK(Endian, ReadBulk_1000x16Bit) { ReadBulk<int16_t>(state); }
+PW_BENCHMARK(Endian, WriteBulk_1000x16Bit) { WriteBulk<int16_t>(state); }
+
+PW_BENCHMARK(Endian, ReadEach_1000x32Bit) { ReadEach<int32_t>(state); }
+PW_BENCHMARK(Endian, ReadBulk_1000x32Bit) { ReadBulk<int32_t>(state); }
+PW_BENCHMARK(Endian, WriteBulk_1000x32Bit) { WriteBulk<int32_t>(state); }
+
+PW_BENCHMARK(Endian, ReadEach_1000x64Bit) { ReadEach<uint64_t>(state); }
+PW_BENCHMARK(Endian, ReadBulk_1000x64Bit) { ReadBulk<uint64_t>(state); }
+
+}  // namespace
+}  // namespace pw::bytes
@@ -0,0 +1,123 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_bytes/chunked_byte_builder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace pw {
+
+ChunkedByteBuilder& ChunkedByteBuilder::Append(const std::byte* bytes,
+                                               size_t count,
+                                               std::byte fill) {
+  if (!status_.ok() || count == 0u) {
+    return *this;
+  }
+
+  const size_t remaining =
+      segment_count_ == 0u
+          ? 0
+          : last_chunk_size_ - segments_[segment_count_ - 1].size();
+  size_t new_segment_count = segment_count_;
+
+  if (count > remaining) {
+    new_segment_count = AcquireChunksFor(count - remaining);
+    if (new_segment_count == 0u) {
+      status_ = Status::ResourceExhausted();
+      return *this;
+    }
+  }
+
+  size_ += count;
+
+  // Fill the rest of the last chunk, then the new chunks, which are stored in
+  // segments_ in full until they are written.
+  size_t index = segment_count_ - 1;
+  size_t chunk_size = last_chunk_size_;
+
+  if (remaining == 0u) {
+    index = segment_count_;
+    chunk_size = segments_[index].size();
+  }
+
+  while (true) {
+    ByteSpan chunk = Chunk(index, chunk_size);
+    const size_t used = index < segment_count_ ? segments_[index].size() : 0;
+    const size_t write_size = std::min(count, chunk_size - used);
+
+    if (bytes == nullptr) {
+      std::memset(&chunk[used], static_cast<int>(fill), write_size);
+    } else {
+      std::memcpy(&chunk[used], bytes, write_size);
+      bytes += write_size;
+    }
+
+    segments_[index] = chunk.first(used + write_size);
+    count -= write_size;
+
+    if (count == 0u) {
+      break;
+    }
+    index += 1;
+    chunk_size = segments_[index].size();
+  }
+
+  segment_count_ = new_segment_count;
+  last_chunk_size_ = chunk_size;
+  return *this;
+}
+
+size_t ChunkedByteBuilder::AcquireChunksFor(size_t count) {
+  size_t index = segment_count_;
+
+  while (count != 0u && index < segments_.size()) {
+    ByteSpan chunk = source_.AcquireChunk();
+    if (chunk.empty()) {
+      break;
+    }
+    segments_[index++] = chunk;
+    count -= std::min(count, chunk.size());
+  }
+
+  if (count == 0u) {
+    return index;
+  }
+
+  // The bytes do not fit, so give back what was acquired for them.
+  while (index > segment_count_) {
+    source_.ReleaseChunk(Chunk(index - 1, segments_[index - 1].size()));
+    index -= 1;
+  }
+  return 0;
+}
+
+ByteSpan ChunkedByteBuilder::Chunk(size_t index, size_t chunk_size) const {
+  // The builder only stores chunks as const spans so that segments() can
+  // return them directly; the chunks themselves are writable.
+  return ByteSpan(const_cast<std::byte*>(segments_[index].data()), chunk_size);
+}
+
+void ChunkedByteBuilder::ReleaseChunks() {
+  for (size_t i = 0; i < segment_count_; ++i) {
+    const size_t chunk_size =
+        i + 1 == segment_count_ ? last_chunk_size_ : segments_[i].size();
+    source_.ReleaseChunk(Chunk(i, chunk_size));
+  }
+  segment_count_ = 0;
+  last_chunk_size_ = 0;
+  size_ = 0;
+}
+
+}  // namespace pw
@@ -0,0 +1,210 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_bytes/chunked_byte_builder.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+using std::byte;
+
+template <typename... Args>
+constexpr std::array<byte, sizeof...(Args)> MakeBytes(Args... args) noexcept {
+  return {static_cast<byte>(args)...};
+}
+
+namespace pw {
+namespace {
+
+// Concatenates the builder's segments for comparison.
+template <size_t kSize>
+bool Equals(const ChunkedByteBuilder& builder,
+            const std::array<byte, kSize>& expected) {
+  if (builder.size() != kSize) {
+    return false;
+  }
+  size_t offset = 0;
+  for (ConstByteSpan segment : builder.segments()) {
+    if (std::memcmp(segment.data(), &expected[offset], segment.size()) != 0) {
+      return false;
+    }
+    offset += segment.size();
+  }
+  return offset == kSize;
+}
+
+TEST(ChunkedByteBuilder, Empty_HasNoSegments) {
+  ByteChunkPool<4, 2> pool;
+  ChunkedByteBuffer<2> builder(pool);
+
+  EXPECT_TRUE(builder.ok());
+  EXPECT_TRUE(builder.empty());
+  EXPECT_EQ(0u, builder.size());
+  EXPECT_EQ(2u, builder.max_segments());
+  EXPECT_TRUE(builder.segments().empty());
+  EXPECT_EQ(2u, pool.available());
+}
+
+TEST(ChunkedByteBuilder, Append_WithinChunk_OneSegment) {
+  ByteChunkPool<4, 2> pool;
+  ChunkedByteBuffer<2> builder(pool);
+
+  builder.append(MakeBytes(1, 2, 3));
+
+  ASSERT_TRUE(builder.ok());
+  ASSERT_EQ(1u, builder.segments().size());
+  EXPECT_EQ(3u, builder.segments()[0].size());
+  EXPECT_TRUE(Equals(builder, MakeBytes(1, 2, 3)));
+  EXPECT_EQ(1u, pool.available());
+}
+
+TEST(ChunkedByteBuilder, Append_FillsChunkExactly) {
+  ByteChunkPool<4, 2> pool;
+  ChunkedByteBuffer<2> builder(pool);
+
+  builder.append(MakeBytes(1, 2, 3, 4));
+
+  ASSERT_TRUE(builder.ok());
+  ASSERT_EQ(1u, builder.segments().size());
+  EXPECT_TRUE(Equals(builder, MakeBytes(1, 2, 3, 4)));
+
+  builder.push_back(byte{5});
+
+  ASSERT_TRUE(builder.ok());
+  ASSERT_EQ(2u, builder.segments().size());
+  EXPECT_EQ(4u, builder.segments()[0].size());
+  EXPECT_EQ(1u, builder.segments()[1].size());
+  EXPECT_TRUE(Equals(builder, MakeBytes(1, 2, 3, 4, 5)));
+}
+
+TEST(ChunkedByteBuilder, Append_SpansChunks) {
+  ByteChunkPool<4, 3> pool;
+  ChunkedByteBuffer<3> builder(pool);
+
+  builder.append(MakeBytes(1, 2));
+  builder.append(MakeBytes(3, 4, 5, 6, 7, 8, 9, 10, 11));
+
+  ASSERT_TRUE(builder.ok());
+  ASSERT_EQ(3u, builder.segments().size());
+  EXPECT_EQ(4u, builder.segments()[0].size());
+  EXPECT_EQ(4u, builder.segments()[1].size());
+  EXPECT_EQ(3u, builder.segments()[2].size());
+  EXPECT_TRUE(Equals(builder, MakeBytes(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11)));
+  EXPECT_EQ(0u, pool.available());
+}
+
+TEST(ChunkedByteBuilder, AppendCount_FillsAcrossChunks) {
+  ByteChunkPool<4, 2> pool;
+  ChunkedByteBuffer<2> builder(pool);
+
+  builder.push_back(byte{1});
+  builder.append(5, byte{7});
+
+  ASSERT_TRUE(builder.ok());
+  EXPECT_TRUE(Equals(builder, MakeBytes(1, 7, 7, 7, 7, 7)));
+}
+
+TEST(ChunkedByteBuilder, Append_PoolExhausted_AppendsNothing) {
+  ByteChunkPool<4, 2> pool;
+  ChunkedByteBuffer<4> builder(pool);
+
+  builder.append(MakeBytes(1, 2, 3));
+  builder.append(MakeBytes(4, 5, 6, 7, 8, 9));
+
+  EXPECT_EQ(Status::ResourceExhausted(), builder.status());
+  EXPECT_TRUE(Equals(builder, MakeBytes(1, 2, 3)));
+  EXPECT_EQ(1u, pool.available());
+
+  // Appends fail until the status is cleared.
+  builder.push_back(byte{4});
+  EXPECT_EQ(3u, builder.size());
+
+  builder.clear_status();
+  builder.append(MakeBytes(4, 5, 6, 7, 8));
+
+  EXPECT_TRUE(builder.ok());
+  EXPECT_TRUE(Equals(builder, MakeBytes(1, 2, 3, 4, 5, 6, 7, 8)));
+}
+
+TEST(ChunkedByteBuilder, Append_SegmentsExhausted_ReleasesChunks) {
+  ByteChunkPool<4, 4> pool;
+  ChunkedByteBuffer<2> builder(pool);
+
+  builder.append(MakeBytes(1, 2, 3, 4, 5, 6, 7, 8, 9));
+
+  EXPECT_EQ(Status::ResourceExhausted(), builder.status());
+  EXPECT_TRUE(builder.empty());
+  EXPECT_TRUE(builder.segments().empty());
+  EXPECT_EQ(4u, pool.available());
+}
+
+TEST(ChunkedByteBuilder, Clear_ReleasesChunksAndResetsStatus) {
+  ByteChunkPool<4, 2> pool;
+  ChunkedByteBuffer<2> builder(pool);
+
+  builder.append(MakeBytes(1, 2, 3, 4, 5));
+  builder.append(MakeBytes(1, 2, 3, 4, 5));
+  ASSERT_FALSE(builder.ok());
+  ASSERT_EQ(0u, pool.available());
+
+  builder.clear();
+
+  EXPECT_TRUE(builder.ok());
+  EXPECT_TRUE(builder.empty());
+  EXPECT_TRUE(builder.segments().empty());
+  EXPECT_EQ(2u, pool.available());
+}
+
+TEST(ChunkedByteBuilder, Destructor_ReleasesChunks) {
+  ByteChunkPool<4, 3> pool;
+  {
+    ChunkedByteBuffer<3> builder(pool);
+    builder.append(10, byte{0});
+    EXPECT_EQ(0u, pool.available());
+  }
+  EXPECT_EQ(3u, pool.available());
+}
+
+TEST(ChunkedByteBuilder, PutInts_SplitAcrossChunks) {
+  ByteChunkPool<3, 4> pool;
+  ChunkedByteBuffer<4> builder(pool);
+
+  builder.PutUint8(0x01)
+      .PutUint16(0x0203, std::endian::big)
+      .PutInt32(0x04050607, std::endian::little);
+
+  ASSERT_TRUE(builder.ok());
+  ASSERT_EQ(3u, builder.segments().size());
+  EXPECT_TRUE(
+      Equals(builder, MakeBytes(0x01, 0x02, 0x03, 0x07, 0x06, 0x05, 0x04)));
+}
+
+TEST(ChunkedByteBuilder, StatusWithSize) {
+  ByteChunkPool<2, 1> pool;
+  ChunkedByteBuffer<1> builder(pool);
+
+  builder.PutUint16(0xffff);
+  EXPECT_EQ(OkStatus(), builder.status_with_size().status());
+  EXPECT_EQ(2u, builder.status_with_size().size());
+
+  builder.push_back(byte{0});
+  EXPECT_EQ(Status::ResourceExhausted(), builder.status_with_size().status());
+  EXPECT_EQ(2u, builder.status_with_size().size());
+}
+
+}  // namespace
+}  // namespace pw
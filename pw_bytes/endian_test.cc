@@ -276,5 +276,104 @@ TEST(ReadInOrder, BoundsChecking_TooSmall) {
   EXPECT_EQ(0, value);
 }
 
+// 11 values, fewer than fit in one block.
+constexpr auto kPacked16Big = Array<0x00, 0x01, 0x00, 0x02, 0x00, 0x03, 0x00,
+                                    0x04, 0x00, 0x05, 0x00, 0x06, 0x00, 0x07,
+                                    0x00, 0x08, 0x00, 0x09, 0x80, 0x0A, 0xFF,
+                                    0xFF>();
+constexpr std::array<int16_t, 11> kValues16 = {
+    1, 2, 3, 4, 5, 6, 7, 8, 9, -32758, -1};
+
+TEST(ReadInOrder, Span_Big) {
+  std::array<int16_t, 11> values = {};
+  EXPECT_EQ(11u,
+            ReadInOrder(std::span(values), kPacked16Big, std::endian::big));
+  EXPECT_EQ(kValues16, values);
+}
+
+TEST(ReadInOrder, Span_Little) {
+  std::array<uint32_t, 5> values = {};
+  constexpr auto kPacked = Array<1, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0, 0, 4, 0, 0,
+                                 0, 0xDD, 0xCC, 0xBB, 0xAA>();
+  EXPECT_EQ(5u, ReadInOrder(std::span(values), kPacked, std::endian::little));
+  EXPECT_EQ((std::array<uint32_t, 5>{1, 2, 3, 4, 0xAABBCCDD}), values);
+}
+
+TEST(ReadInOrder, Span_UnalignedInput) {
+  std::array<std::byte, 17> buffer = {};
+  std::copy(kPacked16Big.begin(), kPacked16Big.begin() + 16, &buffer[1]);
+
+  std::array<uint16_t, 8> values = {};
+  EXPECT_EQ(8u,
+            ReadInOrder(std::span(values),
+                        std::span(buffer).subspan(1),
+                        std::endian::big));
+  EXPECT_EQ((std::array<uint16_t, 8>{1, 2, 3, 4, 5, 6, 7, 8}), values);
+}
+
+TEST(ReadInOrder, Span_InputTooSmall_ReadsWholeValues) {
+  std::array<uint64_t, 4> values = {};
+  constexpr auto kPacked = Array<0, 0, 0, 0, 0, 0, 0, 7, 0, 0, 0, 0, 0, 0>();
+  EXPECT_EQ(1u, ReadInOrder(std::span(values), kPacked, std::endian::big));
+  EXPECT_EQ((std::array<uint64_t, 4>{7, 0, 0, 0}), values);
+}
+
+template <typename T>
+void ExpectRoundTrip(std::endian order) {
+  // Enough values for a few blocks of any size, plus a remainder.
+  std::array<T, 37> values;
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<T>(0x0102030405060708u * (i + 1));
+  }
+
+  std::array<std::byte, sizeof(values)> packed = {};
+  ASSERT_EQ(values.size(), WriteInOrder(packed, std::span(values), order));
+
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(values[i], ReadInOrder<T>(order, &packed[i * sizeof(T)]));
+  }
+
+  std::array<T, 37> read = {};
+  ASSERT_EQ(values.size(), ReadInOrder(std::span(read), packed, order));
+  EXPECT_EQ(values, read);
+}
+
+TEST(ReadInOrder, Span_RoundTrip) {
+  for (std::endian order : {std::endian::big, std::endian::little}) {
+    ExpectRoundTrip<uint8_t>(order);
+    ExpectRoundTrip<int16_t>(order);
+    ExpectRoundTrip<uint32_t>(order);
+    ExpectRoundTrip<int64_t>(order);
+  }
+}
+
+TEST(WriteInOrder, Span_Big) {
+  std::array<std::byte, 22> buffer = {};
+  EXPECT_EQ(11u,
+            WriteInOrder(buffer, std::span(kValues16), std::endian::big));
+  EXPECT_EQ(kPacked16Big, buffer);
+}
+
+TEST(WriteInOrder, Span_OutputTooSmall_WritesWholeValues) {
+  std::array<std::byte, 7> buffer = {};
+  constexpr std::array<uint32_t, 2> kValues = {0x01020304, 0x05060708};
+  EXPECT_EQ(1u,
+            WriteInOrder(buffer, std::span(kValues), std::endian::little));
+  EXPECT_EQ((Array<4, 3, 2, 1, 0, 0, 0>()), buffer);
+}
+
+TEST(ConvertOrder, Span_InPlace) {
+  std::array<uint16_t, 6> values = {
+      0x0102, 0x0304, 0x0506, 0x0708, 0x090A, 0x0B0C};
+
+  ConvertOrder(std::endian::native, kNonNative, std::span(values));
+  EXPECT_EQ(
+      (std::array<uint16_t, 6>{0x0201, 0x0403, 0x0605, 0x0807, 0x0A09, 0x0C0B}),
+      values);
+
+  ConvertOrder(std::endian::native, std::endian::native, std::span(values));
+  EXPECT_EQ(0x0201u, values[0]);
+}
+
 }  // namespace
 }  // namespace pw::bytes
@@ -0,0 +1,255 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/endian.h"
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pw {
+
+// ChunkedByteBuilder builds bytes across a series of fixed-size chunks, rather
+// than in one contiguous buffer. Chunks are acquired from a ChunkSource, such
+// as a pool, only as they are needed, so large messages do not need a buffer
+// sized for the worst case. The result is a list of spans, which can be passed
+// to a vectored write such as pw::stream::Writer::WriteV.
+//
+// Like ByteBuilder, ChunkedByteBuilder never overflows. Appends that do not
+// fit in the chunks that can be acquired append nothing, set the status to
+// RESOURCE_EXHAUSTED, and fail until the status is cleared.
+//
+// A ChunkedByteBuilder does not own the storage for its list of spans. The
+// ChunkedByteBuffer template class, defined below, declares the list alongside
+// a ChunkedByteBuilder.
+class ChunkedByteBuilder {
+ public:
+  // Provides the chunks a ChunkedByteBuilder writes to.
+  class ChunkSource {
+   public:
+    virtual ~ChunkSource() = default;
+
+    // Returns a chunk to write to, or an empty span if none are available.
+    virtual ByteSpan AcquireChunk() = 0;
+
+    // Returns a chunk from AcquireChunk that is no longer used.
+    virtual void ReleaseChunk(ByteSpan chunk) = 0;
+  };
+
+  // Creates an empty ChunkedByteBuilder. segments is the storage for the list
+  // of spans, which limits the number of chunks the builder uses.
+  constexpr ChunkedByteBuilder(ChunkSource& source,
+                               std::span<ConstByteSpan> segments)
+      : source_(source),
+        segments_(segments),
+        segment_count_(0),
+        last_chunk_size_(0),
+        size_(0) {}
+
+  ChunkedByteBuilder(const ChunkedByteBuilder&) = delete;
+  ChunkedByteBuilder& operator=(const ChunkedByteBuilder&) = delete;
+
+  // Releases the chunks, which invalidates the spans from segments().
+  ~ChunkedByteBuilder() { ReleaseChunks(); }
+
+  // Returns the bytes as a list of spans, in order. Every span but the last
+  // is a full chunk. The spans are valid until the builder is cleared or
+  // destroyed.
+  std::span<const ConstByteSpan> segments() const {
+    return segments_.first(segment_count_);
+  }
+
+  // Returns the ChunkedByteBuilder's status, which reflects the most recent
+  // error that occurred while updating the bytes. After an update fails, the
+  // status remains non-OK until it is cleared with clear() or clear_status().
+  // Returns:
+  //
+  //     OK if no errors have occurred
+  //     RESOURCE_EXHAUSTED if output to the ChunkedByteBuilder was truncated
+  //
+  Status status() const { return status_; }
+
+  // Returns status() and size() as a StatusWithSize.
+  StatusWithSize status_with_size() const {
+    return StatusWithSize(status_, size_);
+  }
+
+  // True if status() is OkStatus().
+  bool ok() const { return status_.ok(); }
+
+  // True if no bytes have been appended.
+  bool empty() const { return size() == 0u; }
+
+  // Returns the total number of bytes in all of the segments.
+  size_t size() const { return size_; }
+
+  // Returns the most chunks the builder can use.
+  size_t max_segments() const { return segments_.size(); }
+
+  // Releases the chunks, clears the bytes, and resets the error state.
+  void clear() {
+    ReleaseChunks();
+    status_ = OkStatus();
+  }
+
+  // Sets the status to OkStatus().
+  void clear_status() { status_ = OkStatus(); }
+
+  // Appends a single byte.
+  void push_back(std::byte b) { append(1, b); }
+
+  // Appends the provided byte count times.
+  ChunkedByteBuilder& append(size_t count, std::byte b) {
+    return Append(nullptr, count, b);
+  }
+
+  // Appends count bytes from 'bytes'. They may be split across chunks. If they
+  // do not fit, no bytes are appended and the status is set to
+  // RESOURCE_EXHAUSTED.
+  ChunkedByteBuilder& append(const void* bytes, size_t count) {
+    return Append(static_cast<const std::byte*>(bytes), count, std::byte{0});
+  }
+
+  // Appends bytes from a byte span that calls the pointer/length version.
+  ChunkedByteBuilder& append(ConstByteSpan bytes) {
+    return append(bytes.data(), bytes.size());
+  }
+
+  // Put methods for inserting integers, matching ByteBuilder's.
+  ChunkedByteBuilder& PutUint8(uint8_t val) { return WriteInOrder(val); }
+
+  ChunkedByteBuilder& PutInt8(int8_t val) { return WriteInOrder(val); }
+
+  ChunkedByteBuilder& PutUint16(uint16_t value,
+                                std::endian order = std::endian::little) {
+    return WriteInOrder(bytes::ConvertOrderTo(order, value));
+  }
+
+  ChunkedByteBuilder& PutInt16(int16_t value,
+                               std::endian order = std::endian::little) {
+    return PutUint16(static_cast<uint16_t>(value), order);
+  }
+
+  ChunkedByteBuilder& PutUint32(uint32_t value,
+                                std::endian order = std::endian::little) {
+    return WriteInOrder(bytes::ConvertOrderTo(order, value));
+  }
+
+  ChunkedByteBuilder& PutInt32(int32_t value,
+                               std::endian order = std::endian::little) {
+    return PutUint32(static_cast<uint32_t>(value), order);
+  }
+
+  ChunkedByteBuilder& PutUint64(uint64_t value,
+                                std::endian order = std::endian::little) {
+    return WriteInOrder(bytes::ConvertOrderTo(order, value));
+  }
+
+  ChunkedByteBuilder& PutInt64(int64_t value,
+                               std::endian order = std::endian::little) {
+    return PutUint64(static_cast<uint64_t>(value), order);
+  }
+
+ private:
+  template <typename T>
+  ChunkedByteBuilder& WriteInOrder(T value) {
+    return append(&value, sizeof(value));
+  }
+
+  // Appends count bytes from bytes, or count copies of fill if bytes is null.
+  ChunkedByteBuilder& Append(const std::byte* bytes,
+                             size_t count,
+                             std::byte fill);
+
+  // Acquires chunks, after the existing segments, until count more bytes fit.
+  // Returns the new number of segments, or 0 if the bytes do not fit, in
+  // which case any chunks that were acquired have been released.
+  size_t AcquireChunksFor(size_t count);
+
+  // The full chunk that holds a segment. Only the last segment may be smaller
+  // than its chunk.
+  ByteSpan Chunk(size_t index, size_t chunk_size) const;
+
+  void ReleaseChunks();
+
+  ChunkSource& source_;
+
+  // The bytes written to each chunk.
+  const std::span<ConstByteSpan> segments_;
+  size_t segment_count_;
+
+  // The size of the last chunk, which segments_ does not record until it is
+  // full.
+  size_t last_chunk_size_;
+
+  size_t size_;
+  Status status_;
+};
+
+// ChunkedByteBuffers declare the storage for up to kMaxSegments spans along
+// with a ChunkedByteBuilder.
+template <size_t kMaxSegments>
+class ChunkedByteBuffer : public ChunkedByteBuilder {
+ public:
+  explicit ChunkedByteBuffer(ChunkSource& source)
+      : ChunkedByteBuilder(source, segments_) {}
+
+ private:
+  std::array<ConstByteSpan, kMaxSegments> segments_;
+};
+
+// A ChunkSource with kChunkCount chunks of kChunkSize bytes.
+template <size_t kChunkSize, size_t kChunkCount>
+class ByteChunkPool final : public ChunkedByteBuilder::ChunkSource {
+ public:
+  static_assert(kChunkSize > 0u && kChunkCount > 0u);
+
+  constexpr ByteChunkPool() : chunks_{}, in_use_{} {}
+
+  ByteSpan AcquireChunk() final {
+    for (size_t i = 0; i < kChunkCount; ++i) {
+      if (!in_use_[i]) {
+        in_use_[i] = true;
+        return chunks_[i];
+      }
+    }
+    return ByteSpan();
+  }
+
+  void ReleaseChunk(ByteSpan chunk) final {
+    in_use_[static_cast<size_t>(chunk.data() - chunks_[0].data()) /
+            kChunkSize] = false;
+  }
+
+  // Returns the number of chunks that are not in use.
+  size_t available() const {
+    size_t count = 0;
+    for (bool in_use : in_use_) {
+      count += in_use ? 0 : 1;
+    }
+    return count;
+  }
+
+ private:
+  std::array<std::array<std::byte, kChunkSize>, kChunkCount> chunks_;
+  std::array<bool, kChunkCount> in_use_;
+};
+
+}  // namespace pw
@@ -14,7 +14,9 @@
 #pragma once
 
 #include <array>
+#include <algorithm>
 #include <bit>
+#include <cstddef>
 #include <cstring>
 #include <span>
 #include <type_traits>
@@ -104,6 +106,67 @@ constexpr T ReverseBytes(T value) {
   }
 }
 
+template <typename T>
+T LoadReversed(const std::byte* bytes) {
+  T value;
+  std::memcpy(&value, bytes, sizeof(value));
+  return ReverseBytes(value);
+}
+
+// Whether the target can shuffle the bytes in a vector register, which is
+// needed to vectorize swapping the bytes of 32- and 64-bit values.
+#if defined(__SSSE3__) || defined(__ARM_NEON)
+inline constexpr bool kHasVectorByteShuffle = true;
+#else
+inline constexpr bool kHasVectorByteShuffle = false;
+#endif  // defined(__SSSE3__) || defined(__ARM_NEON)
+
+// Copies count values of type T from in to out, reversing the bytes of each.
+// in and out may be the same, but must not otherwise overlap.
+//
+// Compilers emit a single instruction, such as REV or BSWAP, for each value.
+// Converting 32-byte blocks, with all loads before any stores, also lets them
+// vectorize the loop when optimizing for speed without using intrinsics.
+// 16-bit values are swapped with vector shifts, which SSE2 and every other
+// SIMD extension have; wider values need a byte shuffle, and are slower in
+// blocks without one.
+template <typename T>
+void CopyReversed(const std::byte* in, std::byte* out, size_t count) {
+  constexpr size_t kBlockSize =
+      sizeof(T) == 2u || kHasVectorByteShuffle ? 32 / sizeof(T) : 1;
+
+  for (; count >= kBlockSize; count -= kBlockSize) {
+    T block[kBlockSize];
+    for (size_t i = 0; i < kBlockSize; ++i) {
+      block[i] = LoadReversed<T>(in + i * sizeof(T));
+    }
+    for (size_t i = 0; i < kBlockSize; ++i) {
+      std::memcpy(out + i * sizeof(T), &block[i], sizeof(T));
+    }
+    in += kBlockSize * sizeof(T);
+    out += kBlockSize * sizeof(T);
+  }
+
+  for (; count > 0u; --count) {
+    const T value = LoadReversed<T>(in);
+    std::memcpy(out, &value, sizeof(T));
+    in += sizeof(T);
+    out += sizeof(T);
+  }
+}
+
+template <typename T>
+void CopyInOrder(bool reverse, const void* in, void* out, size_t count) {
+  if (!reverse) {
+    if (in != out) {
+      std::memcpy(out, in, count * sizeof(T));
+    }
+    return;
+  }
+  CopyReversed<EquivalentUint<T>>(
+      static_cast<const std::byte*>(in), static_cast<std::byte*>(out), count);
+}
+
 }  // namespace internal
 
 // Functions for reordering bytes in the provided integral value to match the
@@ -187,4 +250,44 @@ template <typename T>
   return true;
 }
 
+// Converts each value in a span from one byte order to another, in place. This
+// is much faster than calling ConvertOrder on each value.
+template <typename T, size_t kExtent>
+void ConvertOrder(std::endian from,
+                  std::endian to,
+                  std::span<T, kExtent> values) {
+  internal::CopyInOrder<T>(
+      from != to, values.data(), values.data(), values.size());
+}
+
+// Reads packed values with the specified endianness from a buffer into out.
+// Returns the number of values read, which is the lesser of out.size() and the
+// number of whole values in the buffer.
+//
+//   std::array<int16_t, 256> samples;
+//   ReadInOrder(std::span(samples), sensor_data, std::endian::big);
+//
+template <typename T, size_t kExtent>
+size_t ReadInOrder(std::span<T, kExtent> out,
+                   ConstByteSpan in,
+                   std::endian order) {
+  const size_t count = std::min(out.size(), in.size() / sizeof(T));
+  internal::CopyInOrder<T>(
+      order != std::endian::native, in.data(), out.data(), count);
+  return count;
+}
+
+// Writes values to a buffer, packed with the specified endianness. Returns the
+// number of values written, which is the lesser of in.size() and the number of
+// whole values that fit in the buffer.
+template <typename T, size_t kExtent>
+size_t WriteInOrder(ByteSpan out,
+                    std::span<T, kExtent> in,
+                    std::endian order) {
+  const size_t count = std::min(in.size(), out.size() / sizeof(T));
+  internal::CopyInOrder<T>(
+      order != std::endian::native, in.data(), out.data(), count);
+  return count;
+}
+
 }  // namespace pw::bytes
@@ -0,0 +1,64 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Calculates the CRC16-CCITT and CRC32 of a short message and of a 1 KiB
+// block, such as a flash sector chunk, with the configured implementations.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_benchmark/benchmark.h"
+#include "pw_checksum/crc16_ccitt.h"
+#include "pw_checksum/crc32.h"
+
+namespace pw::checksum {
+namespace {
+
+using benchmark::DoNotOptimize;
+using benchmark::State;
+
+std::array<std::byte, 1024> data;
+
+template <typename Function>
+void Checksum(State& state, size_t size, Function calculate) {
+  uint32_t value = 1;
+  for (std::byte& byte : data) {
+    value = value * 1103515245u + 12345u;
+    byte = static_cast<std::byte>(value >> 16);
+  }
+
+  const std::span<const std::byte> input(data.data(), size);
+  for (auto _ : state) {
+    DoNotOptimize(data);
+    DoNotOptimize(calculate(input));
+  }
+}
+
+uint16_t Crc16(std::span<const std::byte> input) {
+  return Crc16Ccitt::Calculate(input);
+}
+
+uint32_t Crc32Of(std::span<const std::byte> input) {
+  return Crc32::Calculate(input);
+}
+
+PW_BENCHMARK(Checksum, Crc16Ccitt_32B) { Checksum(state, 32, Crc16); }
+PW_BENCHMARK(Checksum, Crc16Ccitt_1KiB) { Checksum(state, 1024, Crc16); }
+
+PW_BENCHMARK(Checksum, Crc32_32B) { Checksum(state, 32, Crc32Of); }
+PW_BENCHMARK(Checksum, Crc32_1KiB) { Checksum(state, 1024, Crc32Of); }
+
+}  // namespace
+}  // namespace pw::checksum
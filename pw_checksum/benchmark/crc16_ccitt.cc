@@ -0,0 +1,91 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures the throughput of each CRC-16-CCITT implementation. Each one
+// calculates the CRC of a buffer repeatedly, and the time per byte is logged
+// along with the size of the tables it needs.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_assert/check.h"
+#include "pw_checksum/crc16_ccitt.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+
+namespace {
+
+constexpr size_t kBufferSize = 4096;
+constexpr size_t kIterations = 2000;
+constexpr int64_t kTotalBytes = kBufferSize * kIterations;
+
+using Crc16Function = uint16_t (*)(const void*, size_t, uint16_t);
+
+struct Implementation {
+  const char* name;
+  Crc16Function function;
+  size_t table_size_bytes;
+};
+
+constexpr Implementation kImplementations[] = {
+    {"nibble", _pw_checksum_InternalCrc16CcittNibble, 16 * 2},
+    {"bytewise", _pw_checksum_InternalCrc16CcittBytewise, 1 * 256 * 2},
+    {"slice-by-2", _pw_checksum_InternalCrc16CcittSliceBy2, 2 * 256 * 2},
+    {"slice-by-4", _pw_checksum_InternalCrc16CcittSliceBy4, 4 * 256 * 2},
+};
+
+std::array<uint8_t, kBufferSize> buffer;
+
+}  // namespace
+
+int main() {
+  uint32_t value = 1;
+  for (uint8_t& byte : buffer) {
+    value = value * 1103515245u + 12345u;
+    byte = static_cast<uint8_t>(value >> 16);
+  }
+
+  const uint16_t expected = pw::checksum::Crc16Ccitt::Calculate(
+      std::as_bytes(std::span(buffer)));
+
+  PW_LOG_INFO("Calculating the CRC-16-CCITT of %u bytes %u times",
+              static_cast<unsigned>(kBufferSize),
+              static_cast<unsigned>(kIterations));
+
+  for (const Implementation& impl : kImplementations) {
+    uint16_t crc = 0;
+
+    const auto start = pw::chrono::SystemClock::now();
+    for (size_t i = 0; i < kIterations; ++i) {
+      crc = impl.function(buffer.data(),
+                          buffer.size(),
+                          pw::checksum::Crc16Ccitt::kInitialValue);
+    }
+    const auto elapsed = pw::chrono::SystemClock::now() - start;
+
+    PW_CHECK_UINT_EQ(crc, expected);
+
+    const auto picoseconds =
+        std::chrono::duration_cast<std::chrono::duration<int64_t, std::pico>>(
+            elapsed);
+    PW_LOG_INFO("%-12s %5u B tables: %6ld ps/byte",
+                impl.name,
+                static_cast<unsigned>(impl.table_size_bytes),
+                static_cast<long>(picoseconds.count() / kTotalBytes));
+  }
+  return 0;
+}
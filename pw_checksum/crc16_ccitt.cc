@@ -14,6 +14,10 @@
 
 #include "pw_checksum/crc16_ccitt.h"
 
+#include <array>
+
+#include "pw_checksum_private/config.h"
+
 namespace pw::checksum {
 namespace {
 
@@ -52,18 +56,105 @@ constexpr uint16_t kCrc16CcittTable[256]{
     0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0,  // 256
 };
 
+// The CRC of each nibble value, for processing 4 bits per step. These match
+// the first 16 entries of the byte table.
+constexpr uint16_t kCrc16CcittNibbleTable[16]{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+
+// Builds the tables for slicing-by-N. Table k holds the CRC of each byte value
+// followed by k zero bytes, so N bytes can be looked up at once.
+template <size_t kSlices>
+constexpr std::array<std::array<uint16_t, 256>, kSlices> SliceTables() {
+  std::array<std::array<uint16_t, 256>, kSlices> tables{};
+
+  for (size_t i = 0; i < 256; ++i) {
+    tables[0][i] = kCrc16CcittTable[i];
+  }
+  for (size_t k = 1; k < kSlices; ++k) {
+    for (size_t i = 0; i < 256; ++i) {
+      const uint16_t previous = tables[k - 1][i];
+      tables[k][i] = static_cast<uint16_t>((previous << 8) ^
+                                           kCrc16CcittTable[previous >> 8]);
+    }
+  }
+  return tables;
+}
+
+constexpr auto kSliceBy2Tables = SliceTables<2>();
+constexpr auto kSliceBy4Tables = SliceTables<4>();
+
+uint16_t Bytewise(const uint8_t* data, size_t size_bytes, uint16_t value) {
+  for (size_t i = 0; i < size_bytes; ++i) {
+    value = kCrc16CcittTable[((value >> 8) ^ data[i]) & 0xffu] ^ (value << 8);
+  }
+  return value;
+}
+
 }  // namespace
 
 extern "C" uint16_t pw_checksum_Crc16Ccitt(const void* data,
                                            size_t size_bytes,
                                            uint16_t value) {
+#if PW_CHECKSUM_CRC16_CCITT_NIBBLE_TABLE
+  return _pw_checksum_InternalCrc16CcittNibble(data, size_bytes, value);
+#elif PW_CHECKSUM_CRC16_CCITT_SLICES == 4
+  return _pw_checksum_InternalCrc16CcittSliceBy4(data, size_bytes, value);
+#elif PW_CHECKSUM_CRC16_CCITT_SLICES == 2
+  return _pw_checksum_InternalCrc16CcittSliceBy2(data, size_bytes, value);
+#else
+  return _pw_checksum_InternalCrc16CcittBytewise(data, size_bytes, value);
+#endif  // PW_CHECKSUM_CRC16_CCITT_NIBBLE_TABLE
+}
+
+extern "C" uint16_t _pw_checksum_InternalCrc16CcittBytewise(const void* data,
+                                                           size_t size_bytes,
+                                                           uint16_t value) {
+  return Bytewise(static_cast<const uint8_t*>(data), size_bytes, value);
+}
+
+extern "C" uint16_t _pw_checksum_InternalCrc16CcittNibble(const void* data,
+                                                         size_t size_bytes,
+                                                         uint16_t value) {
   const uint8_t* const array = static_cast<const uint8_t*>(data);
+  const auto& t = kCrc16CcittNibbleTable;
 
   for (size_t i = 0; i < size_bytes; ++i) {
-    value = kCrc16CcittTable[((value >> 8) ^ array[i]) & 0xffu] ^ (value << 8);
+    value = t[(value >> 12) ^ (array[i] >> 4)] ^ (value << 4);
+    value = t[(value >> 12) ^ (array[i] & 0xfu)] ^ (value << 4);
   }
 
   return value;
 }
 
+extern "C" uint16_t _pw_checksum_InternalCrc16CcittSliceBy2(const void* data,
+                                                           size_t size_bytes,
+                                                           uint16_t value) {
+  const uint8_t* array = static_cast<const uint8_t*>(data);
+  const auto& t = kSliceBy2Tables;
+
+  for (; size_bytes >= 2u; size_bytes -= 2u, array += 2) {
+    const uint16_t word = value ^ (array[0] << 8 | array[1]);
+    value = t[1][word >> 8] ^ t[0][word & 0xffu];
+  }
+
+  return Bytewise(array, size_bytes, value);
+}
+
+extern "C" uint16_t _pw_checksum_InternalCrc16CcittSliceBy4(const void* data,
+                                                           size_t size_bytes,
+                                                           uint16_t value) {
+  const uint8_t* array = static_cast<const uint8_t*>(data);
+  const auto& t = kSliceBy4Tables;
+
+  for (; size_bytes >= 4u; size_bytes -= 4u, array += 4) {
+    const uint16_t word = value ^ (array[0] << 8 | array[1]);
+    value = t[3][word >> 8] ^ t[2][word & 0xffu] ^ t[1][array[2]] ^
+            t[0][array[3]];
+  }
+
+  return Bytewise(array, size_bytes, value);
+}
+
 }  // namespace pw::checksum
@@ -79,5 +79,39 @@ TEST(Crc16FromC, String) {
   EXPECT_EQ(CallChecksumCrc16Ccitt(kString.data(), kString.size()), kStringCrc);
 }
 
+using Crc16Function = uint16_t (*)(const void*, size_t, uint16_t);
+
+void ExpectMatchesBytewise(Crc16Function crc16) {
+  EXPECT_EQ(crc16(kBytes, sizeof(kBytes), Crc16Ccitt::kInitialValue),
+            kBufferCrc);
+  EXPECT_EQ(crc16(kString.data(), kString.size(), Crc16Ccitt::kInitialValue),
+            kStringCrc);
+
+  for (size_t offset = 0; offset < 4; ++offset) {
+    for (size_t size = 0; offset + size <= kString.size(); ++size) {
+      const char* data = kString.data() + offset;
+      ASSERT_EQ(crc16(data, size, Crc16Ccitt::kInitialValue),
+                _pw_checksum_InternalCrc16CcittBytewise(
+                    data, size, Crc16Ccitt::kInitialValue));
+    }
+  }
+}
+
+TEST(Crc16Implementation, Nibble) {
+  ExpectMatchesBytewise(_pw_checksum_InternalCrc16CcittNibble);
+}
+
+TEST(Crc16Implementation, SliceBy2) {
+  ExpectMatchesBytewise(_pw_checksum_InternalCrc16CcittSliceBy2);
+}
+
+TEST(Crc16Implementation, SliceBy4) {
+  ExpectMatchesBytewise(_pw_checksum_InternalCrc16CcittSliceBy4);
+}
+
+TEST(Crc16Implementation, Configured) {
+  ExpectMatchesBytewise(pw_checksum_Crc16Ccitt);
+}
+
 }  // namespace
 }  // namespace pw::checksum
@@ -14,6 +14,15 @@
 
 #include "pw_checksum/crc32.h"
 
+#include <array>
+#include <cstring>
+
+#include "pw_checksum_private/config.h"
+
+#if PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS
+#include <arm_acle.h>
+#endif  // PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS
+
 namespace pw::checksum {
 namespace {
 
@@ -62,18 +71,112 @@ constexpr uint32_t kCrc32Table[] = {
     0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
     0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d};
 
+// Builds the tables for slicing-by-N. Table k holds the CRC of each byte value
+// followed by k zero bytes, so N bytes can be looked up at once.
+template <size_t kSlices>
+constexpr std::array<std::array<uint32_t, 256>, kSlices> SliceTables() {
+  std::array<std::array<uint32_t, 256>, kSlices> tables{};
+
+  for (size_t i = 0; i < 256; ++i) {
+    tables[0][i] = kCrc32Table[i];
+  }
+  for (size_t k = 1; k < kSlices; ++k) {
+    for (size_t i = 0; i < 256; ++i) {
+      const uint32_t previous = tables[k - 1][i];
+      tables[k][i] = (previous >> 8) ^ kCrc32Table[previous & 0xFFu];
+    }
+  }
+  return tables;
+}
+
+constexpr auto kSliceBy4Tables = SliceTables<4>();
+constexpr auto kSliceBy8Tables = SliceTables<8>();
+
+// Reads a little-endian word. Compilers reduce this to a load where possible.
+constexpr uint32_t ReadWord(const uint8_t* data) {
+  return uint32_t(data[0]) | uint32_t(data[1]) << 8 | uint32_t(data[2]) << 16 |
+         uint32_t(data[3]) << 24;
+}
+
+uint32_t Bytewise(const uint8_t* data, size_t size_bytes, uint32_t state) {
+  for (size_t i = 0; i < size_bytes; ++i) {
+    state = kCrc32Table[(state ^ data[i]) & 0xFFu] ^ (state >> 8);
+  }
+  return state;
+}
+
 }  // namespace
 
 extern "C" uint32_t _pw_checksum_InternalCrc32(const void* data,
                                                size_t size_bytes,
                                                uint32_t state) {
+#if PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS
+  return _pw_checksum_InternalCrc32Armv8(data, size_bytes, state);
+#elif PW_CHECKSUM_CRC32_SLICES == 8
+  return _pw_checksum_InternalCrc32SliceBy8(data, size_bytes, state);
+#elif PW_CHECKSUM_CRC32_SLICES == 4
+  return _pw_checksum_InternalCrc32SliceBy4(data, size_bytes, state);
+#else
+  return _pw_checksum_InternalCrc32Bytewise(data, size_bytes, state);
+#endif  // PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS
+}
+
+extern "C" uint32_t _pw_checksum_InternalCrc32Bytewise(const void* data,
+                                                       size_t size_bytes,
+                                                       uint32_t state) {
+  return Bytewise(static_cast<const uint8_t*>(data), size_bytes, state);
+}
+
+extern "C" uint32_t _pw_checksum_InternalCrc32SliceBy4(const void* data,
+                                                       size_t size_bytes,
+                                                       uint32_t state) {
   const uint8_t* array = static_cast<const uint8_t*>(data);
+  const auto& t = kSliceBy4Tables;
 
-  for (size_t i = 0; i < size_bytes; ++i) {
-    state = kCrc32Table[(state ^ array[i]) & 0xFFu] ^ (state >> 8);
+  for (; size_bytes >= 4u; size_bytes -= 4u, array += 4) {
+    const uint32_t word = state ^ ReadWord(array);
+    state = t[3][word & 0xFFu] ^ t[2][(word >> 8) & 0xFFu] ^
+            t[1][(word >> 16) & 0xFFu] ^ t[0][word >> 24];
+  }
+
+  return Bytewise(array, size_bytes, state);
+}
+
+extern "C" uint32_t _pw_checksum_InternalCrc32SliceBy8(const void* data,
+                                                       size_t size_bytes,
+                                                       uint32_t state) {
+  const uint8_t* array = static_cast<const uint8_t*>(data);
+  const auto& t = kSliceBy8Tables;
+
+  for (; size_bytes >= 8u; size_bytes -= 8u, array += 8) {
+    const uint32_t word = state ^ ReadWord(array);
+    state = t[7][word & 0xFFu] ^ t[6][(word >> 8) & 0xFFu] ^
+            t[5][(word >> 16) & 0xFFu] ^ t[4][word >> 24] ^ t[3][array[4]] ^
+            t[2][array[5]] ^ t[1][array[6]] ^ t[0][array[7]];
+  }
+
+  return Bytewise(array, size_bytes, state);
+}
+
+#if PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS
+
+extern "C" uint32_t _pw_checksum_InternalCrc32Armv8(const void* data,
+                                                    size_t size_bytes,
+                                                    uint32_t state) {
+  const uint8_t* array = static_cast<const uint8_t*>(data);
+
+  for (; size_bytes >= 4u; size_bytes -= 4u, array += 4) {
+    uint32_t word;
+    std::memcpy(&word, array, sizeof(word));
+    state = __crc32w(state, word);
+  }
+  for (; size_bytes > 0u; --size_bytes, ++array) {
+    state = __crc32b(state, *array);
   }
 
   return state;
 }
 
+#endif  // PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS
+
 }  // namespace pw::checksum
@@ -18,6 +18,7 @@
 
 #include "gtest/gtest.h"
 #include "pw_bytes/array.h"
+#include "pw_checksum_private/config.h"
 
 namespace pw::checksum {
 namespace {
@@ -105,5 +106,43 @@ TEST(Crc32AppendFromC, String) {
             kStringCrc);
 }
 
+using Crc32Function = uint32_t (*)(const void*, size_t, uint32_t);
+
+// Checks an implementation against the bytewise implementation for every
+// length and starting alignment up to the length of kString.
+void ExpectMatchesBytewise(Crc32Function crc32) {
+  EXPECT_EQ(~crc32(kString.data(),
+                   kString.size(),
+                   _PW_CHECKSUM_CRC32_INITIAL_STATE),
+            kStringCrc);
+
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t size = 0; offset + size <= kString.size(); ++size) {
+      const char* data = kString.data() + offset;
+      ASSERT_EQ(crc32(data, size, _PW_CHECKSUM_CRC32_INITIAL_STATE),
+                _pw_checksum_InternalCrc32Bytewise(
+                    data, size, _PW_CHECKSUM_CRC32_INITIAL_STATE));
+    }
+  }
+}
+
+TEST(Crc32Implementation, SliceBy4) {
+  ExpectMatchesBytewise(_pw_checksum_InternalCrc32SliceBy4);
+}
+
+TEST(Crc32Implementation, SliceBy8) {
+  ExpectMatchesBytewise(_pw_checksum_InternalCrc32SliceBy8);
+}
+
+#if PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS
+TEST(Crc32Implementation, Armv8) {
+  ExpectMatchesBytewise(_pw_checksum_InternalCrc32Armv8);
+}
+#endif  // PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS
+
+TEST(Crc32Implementation, Configured) {
+  ExpectMatchesBytewise(_pw_checksum_InternalCrc32);
+}
+
 }  // namespace
 }  // namespace pw::checksum
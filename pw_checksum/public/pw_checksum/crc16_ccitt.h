@@ -32,6 +32,22 @@ uint16_t pw_checksum_Crc16Ccitt(const void* data,
                                 size_t size_bytes,
                                 uint16_t initial_value);
 
+// The individual CRC-16-CCITT implementations, which are exposed for testing
+// and benchmarking. Do not call them directly; pw_checksum_Crc16Ccitt uses the
+// implementation selected by the module configuration.
+uint16_t _pw_checksum_InternalCrc16CcittBytewise(const void* data,
+                                                 size_t size_bytes,
+                                                 uint16_t initial_value);
+uint16_t _pw_checksum_InternalCrc16CcittNibble(const void* data,
+                                               size_t size_bytes,
+                                               uint16_t initial_value);
+uint16_t _pw_checksum_InternalCrc16CcittSliceBy2(const void* data,
+                                                 size_t size_bytes,
+                                                 uint16_t initial_value);
+uint16_t _pw_checksum_InternalCrc16CcittSliceBy4(const void* data,
+                                                 size_t size_bytes,
+                                                 uint16_t initial_value);
+
 #ifdef __cplusplus
 }  // extern "C"
 
@@ -32,11 +32,29 @@ extern "C" {
 // directly.
 #define _PW_CHECKSUM_CRC32_INITIAL_STATE 0xFFFFFFFFu
 
-// Internal implementation function for CRC32. Do not call it directly.
+// Internal implementation function for CRC32. Do not call it directly. It uses
+// the implementation selected by the module configuration.
 uint32_t _pw_checksum_InternalCrc32(const void* data,
                                     size_t size_bytes,
                                     uint32_t state);
 
+// The individual CRC32 implementations, which are exposed for testing and
+// benchmarking. Do not call them directly.
+uint32_t _pw_checksum_InternalCrc32Bytewise(const void* data,
+                                            size_t size_bytes,
+                                            uint32_t state);
+uint32_t _pw_checksum_InternalCrc32SliceBy4(const void* data,
+                                            size_t size_bytes,
+                                            uint32_t state);
+uint32_t _pw_checksum_InternalCrc32SliceBy8(const void* data,
+                                            size_t size_bytes,
+                                            uint32_t state);
+
+// Only available if PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS is set.
+uint32_t _pw_checksum_InternalCrc32Armv8(const void* data,
+                                         size_t size_bytes,
+                                         uint32_t state);
+
 // Calculates the CRC32 for the provided data.
 static inline uint32_t pw_checksum_Crc32(const void* data, size_t size_bytes) {
   return ~_pw_checksum_InternalCrc32(
@@ -0,0 +1,69 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+// Configuration macros for the pw_checksum module.
+#pragma once
+
+// The number of bytes the software CRC32 implementation processes per step,
+// which trades code size for speed:
+//
+//   1 - one byte at a time with a 256-entry table (1 KiB of tables)
+//   4 - slice-by-4 (4 KiB of tables)
+//   8 - slice-by-8 (8 KiB of tables)
+//
+#ifndef PW_CHECKSUM_CRC32_SLICES
+#define PW_CHECKSUM_CRC32_SLICES 1
+#endif  // PW_CHECKSUM_CRC32_SLICES
+
+static_assert(PW_CHECKSUM_CRC32_SLICES == 1 || PW_CHECKSUM_CRC32_SLICES == 4 ||
+                  PW_CHECKSUM_CRC32_SLICES == 8,
+              "PW_CHECKSUM_CRC32_SLICES must be 1, 4, or 8");
+
+// Whether to calculate CRC32s with the ARMv8 CRC32 instructions instead of in
+// software. Defaults to using them when the compiler targets a CPU that has
+// them.
+#ifndef PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS
+#if defined(__ARM_FEATURE_CRC32) && !defined(__ARM_BIG_ENDIAN)
+#define PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS 1
+#else
+#define PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS 0
+#endif  // defined(__ARM_FEATURE_CRC32) && !defined(__ARM_BIG_ENDIAN)
+#endif  // PW_CHECKSUM_CRC32_USE_ARM_CRC32_INSTRUCTIONS
+
+// The number of bytes the CRC-16-CCITT implementation processes per step, which
+// trades code size for speed:
+//
+//   1 - one byte at a time with a 256-entry table (512 B of tables)
+//   2 - slice-by-2 (1 KiB of tables)
+//   4 - slice-by-4 (2 KiB of tables)
+//
+#ifndef PW_CHECKSUM_CRC16_CCITT_SLICES
+#define PW_CHECKSUM_CRC16_CCITT_SLICES 1
+#endif  // PW_CHECKSUM_CRC16_CCITT_SLICES
+
+static_assert(PW_CHECKSUM_CRC16_CCITT_SLICES == 1 ||
+                  PW_CHECKSUM_CRC16_CCITT_SLICES == 2 ||
+                  PW_CHECKSUM_CRC16_CCITT_SLICES == 4,
+              "PW_CHECKSUM_CRC16_CCITT_SLICES must be 1, 2, or 4");
+
+// Whether to calculate CRC-16-CCITTs one nibble at a time with a 16-entry
+// (32 B) table instead of the 256-entry table. This is about half as fast as
+// the bytewise implementation, for targets where flash is tight.
+#ifndef PW_CHECKSUM_CRC16_CCITT_NIBBLE_TABLE
+#define PW_CHECKSUM_CRC16_CCITT_NIBBLE_TABLE 0
+#endif  // PW_CHECKSUM_CRC16_CCITT_NIBBLE_TABLE
+
+static_assert(!PW_CHECKSUM_CRC16_CCITT_NIBBLE_TABLE ||
+                  PW_CHECKSUM_CRC16_CCITT_SLICES == 1,
+              "PW_CHECKSUM_CRC16_CCITT_NIBBLE_TABLE cannot be combined with "
+              "PW_CHECKSUM_CRC16_CCITT_SLICES");
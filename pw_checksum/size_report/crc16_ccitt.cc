@@ -0,0 +1,50 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bloat/bloat_this_binary.h"
+#include "pw_checksum/crc16_ccitt.h"
+
+namespace {
+
+volatile uint8_t buffer[64];
+volatile uint16_t result;
+
+}  // namespace
+
+int main() {
+  pw::bloat::BloatThisBinary();
+
+  const void* data = const_cast<const uint8_t*>(buffer);
+  static_cast<void>(data);
+
+#if defined(_BASE)
+  result = buffer[0];
+#elif defined(_NIBBLE)
+  result = _pw_checksum_InternalCrc16CcittNibble(data, sizeof(buffer), 0xFFFF);
+#elif defined(_BYTEWISE)
+  result =
+      _pw_checksum_InternalCrc16CcittBytewise(data, sizeof(buffer), 0xFFFF);
+#elif defined(_SLICE_BY_2)
+  result =
+      _pw_checksum_InternalCrc16CcittSliceBy2(data, sizeof(buffer), 0xFFFF);
+#elif defined(_SLICE_BY_4)
+  result =
+      _pw_checksum_InternalCrc16CcittSliceBy4(data, sizeof(buffer), 0xFFFF);
+#endif  // defined(_BASE)
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_chrono/internal/counter_extender.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw::chrono::internal {
+namespace {
+
+class CounterExtenderTest : public ::testing::Test {
+ protected:
+  uint64_t Read(uint32_t count) {
+    return extender_.Extend([count] { return count; });
+  }
+
+  CounterExtender extender_;
+};
+
+TEST_F(CounterExtenderTest, BeforeFirstWrap_ReturnsCount) {
+  EXPECT_EQ(Read(0u), 0u);
+  EXPECT_EQ(Read(1000u), 1000u);
+  EXPECT_EQ(Read(0x80000000u), 0x80000000u);
+  EXPECT_EQ(Read(0xFFFFFFFFu), 0xFFFFFFFFu);
+}
+
+TEST_F(CounterExtenderTest, Wrap_CarriesIntoUpperBits) {
+  EXPECT_EQ(Read(0xF0000000u), 0x0F0000000u);
+  EXPECT_EQ(Read(0x00000010u), 0x100000010u);
+  EXPECT_EQ(Read(0x90000000u), 0x190000000u);
+  EXPECT_EQ(Read(0x00000000u), 0x200000000u);
+}
+
+TEST_F(CounterExtenderTest, ReadsWithinHalfWrap_DoNotWrap) {
+  EXPECT_EQ(Read(0x10u), 0x10u);
+  EXPECT_EQ(Read(0x7FFFFFFFu), 0x7FFFFFFFu);
+  EXPECT_EQ(Read(0x7FFFFFFFu), 0x7FFFFFFFu);
+  EXPECT_EQ(Read(0x80000001u), 0x80000001u);
+  EXPECT_EQ(Read(0xFFFFFFF0u), 0xFFFFFFF0u);
+}
+
+TEST_F(CounterExtenderTest, ManyWraps) {
+  for (uint64_t wrap = 0; wrap < 100; ++wrap) {
+    EXPECT_EQ(Read(0x40000000u), (wrap << 32) | 0x40000000u);
+    EXPECT_EQ(Read(0xC0000000u), (wrap << 32) | 0xC0000000u);
+  }
+  EXPECT_EQ(Read(0u), uint64_t{100} << 32);
+}
+
+TEST_F(CounterExtenderTest, StateChangedWhileReading_ReadsCountAgain) {
+  EXPECT_EQ(Read(0xF0000000u), 0xF0000000u);
+
+  // Simulate an interrupt that reads the counter after it wraps, between this
+  // context loading the extender's state and reading the count.
+  int reads = 0;
+  const uint64_t count = extender_.Extend([&] {
+    reads += 1;
+    if (reads == 1) {
+      EXPECT_EQ(Read(0x00000005u), 0x100000005u);
+      return 0x00000001u;  // Read before the interrupt's count.
+    }
+    return 0x00000006u;
+  });
+
+  EXPECT_GE(reads, 2);
+  EXPECT_EQ(count, 0x100000006u);
+  EXPECT_EQ(Read(0x00000007u), 0x100000007u);
+}
+
+}  // namespace
+}  // namespace pw::chrono::internal
@@ -0,0 +1,72 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_chrono/dwt_cycle_clock.h"
+
+#include "pw_assert/check.h"
+#include "pw_chrono/internal/counter_extender.h"
+
+namespace pw::chrono {
+namespace {
+
+volatile uint32_t& cortex_m_demcr =
+    *reinterpret_cast<volatile uint32_t*>(0xE000EDFCu);
+volatile uint32_t& cortex_m_dwt_ctrl =
+    *reinterpret_cast<volatile uint32_t*>(0xE0001000u);
+volatile uint32_t& cortex_m_dwt_cyccnt =
+    *reinterpret_cast<volatile uint32_t*>(0xE0001004u);
+volatile uint32_t& cortex_m_dwt_lar =
+    *reinterpret_cast<volatile uint32_t*>(0xE0001FB0u);
+
+constexpr uint32_t kDemcrTrcenaMask = 1u << 24;
+constexpr uint32_t kDwtCtrlCyccntenaMask = 1u << 0;
+constexpr uint32_t kDwtCtrlNocyccntMask = 1u << 25;
+constexpr uint32_t kDwtLarUnlockKey = 0xC5ACCE55u;
+
+internal::CounterExtender cycle_count;
+
+// CYCCNT is not reset, since a debugger may be using it, so the clock counts
+// from the cycle it was enabled on.
+bool enabled = false;
+uint32_t start_count = 0;
+
+}  // namespace
+
+SystemClock::time_point DwtCycleClock::enabled_at_;
+
+void DwtCycleClock::Enable() {
+  if (enabled) {
+    return;
+  }
+  enabled = true;
+
+  cortex_m_demcr = cortex_m_demcr | kDemcrTrcenaMask;
+  PW_CHECK_UINT_EQ(cortex_m_dwt_ctrl & kDwtCtrlNocyccntMask,
+                   0u,
+                   "This core has no DWT cycle counter");
+
+  // Some cores, such as the Cortex-M7, ignore DWT writes until it is unlocked.
+  cortex_m_dwt_lar = kDwtLarUnlockKey;
+  start_count = cortex_m_dwt_cyccnt;
+  enabled_at_ = SystemClock::now();
+  cortex_m_dwt_ctrl = cortex_m_dwt_ctrl | kDwtCtrlCyccntenaMask;
+}
+
+DwtCycleClock::time_point DwtCycleClock::now() noexcept {
+  const uint64_t count =
+      cycle_count.Extend([] { return cortex_m_dwt_cyccnt - start_count; });
+  return time_point(duration(static_cast<rep>(count)));
+}
+
+}  // namespace pw::chrono
@@ -0,0 +1,32 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Configuration macros for the pw_chrono module.
+#pragma once
+
+#include <cstdint>
+
+// The frequency of the CPU clock, which the Cortex-M DWT cycle counter counts.
+// Must be set when using pw::chrono::DwtCycleClock.
+#ifndef PW_CHRONO_CONFIG_CPU_CLOCK_HZ
+#define PW_CHRONO_CONFIG_CPU_CLOCK_HZ 0
+#endif  // PW_CHRONO_CONFIG_CPU_CLOCK_HZ
+
+namespace pw::chrono::cfg {
+
+inline constexpr uint32_t kCpuClockHz = PW_CHRONO_CONFIG_CPU_CLOCK_HZ;
+
+}  // namespace pw::chrono::cfg
+
+#undef PW_CHRONO_CONFIG_CPU_CLOCK_HZ
@@ -0,0 +1,87 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ratio>
+
+#include "pw_chrono/config.h"
+#include "pw_chrono/system_clock.h"
+
+namespace pw::chrono {
+
+// A clock that counts CPU cycles with the cycle counter of the Data Watchpoint
+// and Trace (DWT) unit on ARMv7-M and ARMv8-M Mainline cores. Its resolution is
+// one cycle, so it can time code that runs much faster than a SystemClock tick,
+// such as for benchmarks or trace timestamps. The CPU clock rate is set with
+// PW_CHRONO_CONFIG_CPU_CLOCK_HZ.
+//
+// The 32-bit hardware counter is extended to 64 bits, so now() must be called
+// at least once every 2^31 cycles (about 12 seconds at 168 MHz) for the clock
+// to stay monotonic. The clock stops while the core is halted or sleeping.
+//
+// Example:
+//
+//   DwtCycleClock::Enable();
+//
+//   const DwtCycleClock::time_point start = DwtCycleClock::now();
+//   ProcessPacket(packet);
+//   const DwtCycleClock::duration cycles = DwtCycleClock::now() - start;
+//
+//   PW_LOG_INFO("Processed packet in %u cycles at %lld ms",
+//               static_cast<unsigned>(cycles.count()),
+//               static_cast<long long>(
+//                   std::chrono::duration_cast<std::chrono::milliseconds>(
+//                       DwtCycleClock::ToSystemClock(start).time_since_epoch())
+//                       .count()));
+//
+// now() and ToSystemClock() are thread, IRQ, and NMI safe.
+struct DwtCycleClock {
+  static_assert(cfg::kCpuClockHz != 0u,
+                "PW_CHRONO_CONFIG_CPU_CLOCK_HZ must be set to use the DWT "
+                "cycle clock");
+
+  using rep = int64_t;
+  using period = std::ratio<1, cfg::kCpuClockHz>;
+  using duration = std::chrono::duration<rep, period>;
+  using time_point = std::chrono::time_point<DwtCycleClock>;
+
+  // The clock counts from when Enable() was first called, not from a known
+  // epoch; ToSystemClock() converts its time points to SystemClock time.
+  static constexpr Epoch epoch = Epoch::kUnknown;
+
+  // The clock is monotonic as long as now() is called often enough.
+  static constexpr bool is_monotonic = true;
+  static constexpr bool is_steady = false;
+
+  // Starts the cycle counter and records the SystemClock time it started at.
+  // Must be called before the clock is used; calling it again has no effect.
+  static void Enable();
+
+  static time_point now() noexcept;
+
+  // Converts a time point of this clock to the SystemClock time at which it
+  // occurred, rounded down to a SystemClock tick. This assumes that both clocks
+  // run from the same oscillator, so that they do not drift apart.
+  static SystemClock::time_point ToSystemClock(time_point time) {
+    return enabled_at_ +
+           std::chrono::floor<SystemClock::duration>(time.time_since_epoch());
+  }
+
+ private:
+  static SystemClock::time_point enabled_at_;
+};
+
+}  // namespace pw::chrono
@@ -0,0 +1,67 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace pw::chrono::internal {
+
+// Extends a free-running 32-bit hardware counter to 64 bits, without locks, so
+// that it may be read from any thread or interrupt.
+//
+// The extender remembers the number of times the counter has wrapped and the
+// top bit of the last count it saw. Wraps are detected when that bit goes from
+// one to zero, so the counter must be read at least once every 2^31 counts.
+class CounterExtender {
+ public:
+  constexpr CounterExtender() : state_(0) {}
+
+  CounterExtender(const CounterExtender&) = delete;
+  CounterExtender& operator=(const CounterExtender&) = delete;
+
+  // Returns the extended count. read_count is a function that returns the
+  // current 32-bit count; it is called again if another context updates the
+  // extender concurrently.
+  template <typename ReadCount>
+  uint64_t Extend(ReadCount&& read_count) {
+    uint32_t state = state_.load(std::memory_order_acquire);
+    while (true) {
+      const uint32_t count = read_count();
+      const uint32_t top_bit = count >> 31;
+
+      uint32_t wraps = state >> 1;
+      if ((state & 1u) != 0u && top_bit == 0u) {
+        wraps += 1;
+      }
+
+      const uint32_t new_state = (wraps << 1) | top_bit;
+      if (new_state == state ||
+          state_.compare_exchange_weak(state,
+                                       new_state,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+        return (uint64_t{wraps} << 32) | count;
+      }
+      // The state was updated after the count was read, so read it again.
+    }
+  }
+
+ private:
+  // The wrap count shifted left by one, ORed with the top bit of the last
+  // count.
+  std::atomic<uint32_t> state_;
+};
+
+}  // namespace pw::chrono::internal
@@ -0,0 +1,184 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_containers/intrusive_dlist.h"
+#include "pw_function/function.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/timed_thread_notification.h"
+#include "pw_thread/thread_core.h"
+
+namespace pw::chrono {
+
+class TimerWheel;
+
+// A one-shot timer run by a TimerWheel. The timer owns its callback and its
+// place in the wheel, so scheduling never allocates.
+class WheelTimer : public IntrusiveDList<WheelTimer>::Item {
+ public:
+  // Called with the deadline the timer was scheduled for. The callback may
+  // schedule this or any other timer.
+  using ExpiryCallback =
+      Function<void(SystemClock::time_point expired_deadline)>;
+
+  explicit WheelTimer(ExpiryCallback&& callback)
+      : callback_(std::move(callback)),
+        deadline_(),
+        expiry_tick_(0),
+        level_(kUnscheduled),
+        slot_(0) {}
+
+  WheelTimer(const WheelTimer&) = delete;
+  WheelTimer& operator=(const WheelTimer&) = delete;
+
+  // A timer must be cancelled or expire before it is destroyed.
+  ~WheelTimer() = default;
+
+ private:
+  friend class TimerWheel;
+
+  static constexpr uint8_t kUnscheduled = 0xff;
+
+  // These members, apart from the callback, are guarded by the wheel's lock.
+  ExpiryCallback callback_;
+  SystemClock::time_point deadline_;
+  uint64_t expiry_tick_;
+  uint8_t level_;
+  uint8_t slot_;
+};
+
+// A hierarchical timer wheel, for running many timeouts cheaply. Scheduling
+// and cancelling a timer are O(1), regardless of how many timers are pending.
+//
+// Time is divided into ticks of a fixed duration, and timers expire on the
+// first tick at or after their deadline, so they never expire early but may
+// expire up to one tick late. The wheel has kLevels levels of kSlots slots.
+// Level 0 holds timers due within the next kSlots ticks, one slot per tick;
+// each higher level covers kSlots times the span of the one below. As time
+// advances, the timers in a higher level slot move down to a lower level, until
+// they reach level 0 and expire. Timers further away than the top level wait
+// in an overflow list.
+//
+// The wheel is a ThreadCore: start a thread with it to run timer callbacks.
+// The thread sleeps until the next tick that has work, or until an earlier
+// timer is scheduled. Alternatively, call Advance() from a periodic tick
+// interrupt or an existing loop; callbacks then run in that context.
+//
+//   pw::chrono::TimerWheel timer_wheel(std::chrono::milliseconds(1));
+//   pw::thread::DetachedThread(options, timer_wheel);
+//
+//   pw::chrono::WheelTimer retry_timer([](auto) { RetryRequest(); });
+//   timer_wheel.ScheduleFor(retry_timer, std::chrono::milliseconds(250));
+//
+// Scheduling and cancelling are IRQ and thread safe.
+class TimerWheel : public thread::ThreadCore {
+ public:
+  static constexpr size_t kLevels = 4;
+  static constexpr size_t kSlotBits = 6;
+  static constexpr size_t kSlots = size_t{1} << kSlotBits;
+
+  explicit TimerWheel(SystemClock::duration tick,
+                      SystemClock::time_point start = SystemClock::now());
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  // Schedules a timer to expire at the deadline. A timer that is already
+  // scheduled is rescheduled.
+  void ScheduleAt(WheelTimer& timer, SystemClock::time_point deadline)
+      PW_LOCKS_EXCLUDED(lock_);
+
+  void ScheduleFor(WheelTimer& timer, SystemClock::duration delay) {
+    ScheduleAt(timer, SystemClock::TimePointAfterAtLeast(delay));
+  }
+
+  // Cancels a scheduled timer. Does nothing if the timer is not scheduled.
+  // The callback may still run if the timer is expiring concurrently.
+  void Cancel(WheelTimer& timer) PW_LOCKS_EXCLUDED(lock_);
+
+  // Returns whether the timer is scheduled on this wheel.
+  bool scheduled(const WheelTimer& timer) const PW_LOCKS_EXCLUDED(lock_);
+
+  // The number of scheduled timers.
+  size_t size() const PW_LOCKS_EXCLUDED(lock_);
+
+  // Expires every timer due at or before now, running their callbacks in the
+  // calling context. Advance() must only be called from one context at a time.
+  void Advance(SystemClock::time_point now) PW_LOCKS_EXCLUDED(lock_);
+
+  // Makes the wheel's thread return. Timers that are still scheduled remain
+  // scheduled. This is IRQ and thread safe.
+  void RequestStop() PW_LOCKS_EXCLUDED(lock_);
+
+ private:
+  static constexpr uint8_t kOverflow = kLevels;
+  static constexpr uint64_t kNoTick = UINT64_MAX;
+
+  using TimerList = IntrusiveDList<WheelTimer>;
+
+  // Runs timer callbacks as they expire, until RequestStop() is called.
+  void Run() final PW_LOCKS_EXCLUDED(lock_);
+
+  // Converts a time to the tick it falls in.
+  uint64_t TickAt(SystemClock::time_point time) const;
+
+  // Converts a tick to the time it starts.
+  SystemClock::time_point TimeOfTick(uint64_t tick) const;
+
+  // Places a timer in the slot for its expiry tick, relative to current_tick_.
+  void Insert(WheelTimer& timer) PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  void Remove(WheelTimer& timer) PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Moves every timer in a list to the slot for its expiry tick.
+  void Reinsert(TimerList& list) PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Moves timers down from the higher level slots due at current_tick_.
+  void Cascade() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the next tick after current_tick_ at which a slot must be
+  // processed, or kNoTick if no timer is scheduled.
+  uint64_t NextEventTick() const PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const SystemClock::duration tick_;
+  const SystemClock::time_point start_;
+
+  mutable sync::InterruptSpinLock lock_;
+
+  std::array<std::array<TimerList, kSlots>, kLevels> slots_
+      PW_GUARDED_BY(lock_);
+
+  // Bit i of occupied_[level] is set if slots_[level][i] holds a timer.
+  std::array<uint64_t, kLevels> occupied_ PW_GUARDED_BY(lock_);
+
+  TimerList overflow_ PW_GUARDED_BY(lock_);
+
+  uint64_t current_tick_ PW_GUARDED_BY(lock_);
+  size_t size_ PW_GUARDED_BY(lock_);
+
+  // The tick the wheel's thread sleeps until, so that scheduling an earlier
+  // timer wakes it.
+  uint64_t sleep_until_tick_ PW_GUARDED_BY(lock_);
+  bool stop_requested_ PW_GUARDED_BY(lock_);
+
+  sync::TimedThreadNotification notification_;
+};
+
+}  // namespace pw::chrono
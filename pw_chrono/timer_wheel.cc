@@ -0,0 +1,268 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_chrono/timer_wheel.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "pw_assert/check.h"
+
+namespace pw::chrono {
+namespace {
+
+constexpr uint64_t kSlotMask = TimerWheel::kSlots - 1;
+
+constexpr uint64_t Bit(size_t slot) { return uint64_t{1} << slot; }
+
+}  // namespace
+
+TimerWheel::TimerWheel(SystemClock::duration tick,
+                       SystemClock::time_point start)
+    : tick_(tick),
+      start_(start),
+      occupied_{},
+      current_tick_(0),
+      size_(0),
+      sleep_until_tick_(0),
+      stop_requested_(false) {
+  PW_CHECK(tick_.count() > 0, "The timer wheel tick must be positive");
+}
+
+void TimerWheel::ScheduleAt(WheelTimer& timer,
+                            SystemClock::time_point deadline) {
+  bool wake;
+  {
+    std::lock_guard lock(lock_);
+    if (timer.level_ != WheelTimer::kUnscheduled) {
+      Remove(timer);
+    }
+
+    // Round up, so that the timer never expires before its deadline.
+    const int64_t ticks_after_start = (deadline - start_).count();
+    uint64_t expiry_tick = 0;
+    if (ticks_after_start > 0) {
+      expiry_tick = (static_cast<uint64_t>(ticks_after_start) +
+                     static_cast<uint64_t>(tick_.count()) - 1) /
+                    static_cast<uint64_t>(tick_.count());
+    }
+
+    timer.deadline_ = deadline;
+    timer.expiry_tick_ = std::max(expiry_tick, current_tick_ + 1);
+    Insert(timer);
+    size_ += 1;
+
+    wake = timer.expiry_tick_ < sleep_until_tick_;
+  }
+
+  if (wake) {
+    notification_.release();
+  }
+}
+
+void TimerWheel::Cancel(WheelTimer& timer) {
+  std::lock_guard lock(lock_);
+  if (timer.level_ != WheelTimer::kUnscheduled) {
+    Remove(timer);
+  }
+}
+
+bool TimerWheel::scheduled(const WheelTimer& timer) const {
+  std::lock_guard lock(lock_);
+  return timer.level_ != WheelTimer::kUnscheduled;
+}
+
+size_t TimerWheel::size() const {
+  std::lock_guard lock(lock_);
+  return size_;
+}
+
+void TimerWheel::Advance(SystemClock::time_point now) {
+  const uint64_t target_tick = TickAt(now);
+
+  std::unique_lock lock(lock_);
+  while (current_tick_ < target_tick) {
+    // Skip ahead over ticks with nothing to do.
+    const uint64_t next_tick = NextEventTick();
+    if (next_tick > target_tick) {
+      current_tick_ = target_tick;
+      break;
+    }
+    current_tick_ = next_tick;
+    Cascade();
+
+    // Every timer in this level 0 slot expires on this tick. Callbacks run
+    // without the lock held, so they may schedule timers. A new timer always
+    // expires after the current tick, so it never lands in this slot.
+    const size_t slot = current_tick_ & kSlotMask;
+    TimerList& due = slots_[0][slot];
+    while (!due.empty()) {
+      WheelTimer& timer = due.front();
+      due.pop_front();
+      timer.level_ = WheelTimer::kUnscheduled;
+      size_ -= 1;
+      const SystemClock::time_point deadline = timer.deadline_;
+
+      lock.unlock();
+      timer.callback_(deadline);
+      lock.lock();
+    }
+    occupied_[0] &= ~Bit(slot);
+  }
+}
+
+void TimerWheel::RequestStop() {
+  {
+    std::lock_guard lock(lock_);
+    stop_requested_ = true;
+  }
+  notification_.release();
+}
+
+void TimerWheel::Run() {
+  while (true) {
+    Advance(SystemClock::now());
+
+    uint64_t next_tick;
+    {
+      std::lock_guard lock(lock_);
+      if (stop_requested_) {
+        stop_requested_ = false;
+        sleep_until_tick_ = 0;
+        return;
+      }
+      next_tick = NextEventTick();
+      sleep_until_tick_ = next_tick;
+    }
+
+    // Timers scheduled before this point are either accounted for in
+    // next_tick or release the notification, so no wakeup is missed.
+    if (next_tick == kNoTick) {
+      notification_.acquire();
+    } else {
+      notification_.try_acquire_until(TimeOfTick(next_tick));
+    }
+  }
+}
+
+uint64_t TimerWheel::TickAt(SystemClock::time_point time) const {
+  if (time <= start_) {
+    return 0;
+  }
+  return static_cast<uint64_t>((time - start_).count()) /
+         static_cast<uint64_t>(tick_.count());
+}
+
+SystemClock::time_point TimerWheel::TimeOfTick(uint64_t tick) const {
+  return start_ + tick_ * static_cast<int64_t>(tick);
+}
+
+void TimerWheel::Insert(WheelTimer& timer) {
+  // A timer goes in the lowest level whose span, counted from the start of the
+  // current slot above it, reaches the timer's expiry.
+  for (size_t level = 0; level < kLevels; ++level) {
+    const size_t span_bits = kSlotBits * (level + 1);
+    if ((timer.expiry_tick_ >> span_bits) == (current_tick_ >> span_bits)) {
+      const size_t slot =
+          (timer.expiry_tick_ >> (kSlotBits * level)) & kSlotMask;
+      slots_[level][slot].push_back(timer);
+      occupied_[level] |= Bit(slot);
+      timer.level_ = static_cast<uint8_t>(level);
+      timer.slot_ = static_cast<uint8_t>(slot);
+      return;
+    }
+  }
+
+  overflow_.push_back(timer);
+  timer.level_ = kOverflow;
+}
+
+void TimerWheel::Remove(WheelTimer& timer) {
+  if (timer.level_ == kOverflow) {
+    overflow_.remove(timer);
+  } else {
+    TimerList& list = slots_[timer.level_][timer.slot_];
+    list.remove(timer);
+    if (list.empty()) {
+      occupied_[timer.level_] &= ~Bit(timer.slot_);
+    }
+  }
+  timer.level_ = WheelTimer::kUnscheduled;
+  size_ -= 1;
+}
+
+void TimerWheel::Reinsert(TimerList& list) {
+  // Empty the list first, since an overflowing timer may go back into it.
+  TimerList pending;
+  while (!list.empty()) {
+    WheelTimer& timer = list.front();
+    list.pop_front();
+    pending.push_back(timer);
+  }
+  while (!pending.empty()) {
+    WheelTimer& timer = pending.front();
+    pending.pop_front();
+    Insert(timer);
+  }
+}
+
+void TimerWheel::Cascade() {
+  // Higher levels go first, since their timers may move into a lower level
+  // slot that is also due on this tick.
+  if ((current_tick_ & ((uint64_t{1} << (kSlotBits * kLevels)) - 1)) == 0) {
+    Reinsert(overflow_);
+  }
+
+  for (size_t level = kLevels - 1; level > 0; --level) {
+    const size_t slot_bits = kSlotBits * level;
+    if ((current_tick_ & ((uint64_t{1} << slot_bits) - 1)) != 0) {
+      continue;
+    }
+    const size_t slot = (current_tick_ >> slot_bits) & kSlotMask;
+    occupied_[level] &= ~Bit(slot);
+    Reinsert(slots_[level][slot]);
+  }
+}
+
+uint64_t TimerWheel::NextEventTick() const {
+  if (size_ == 0u) {
+    return kNoTick;
+  }
+
+  // Every timer in a level expires within the current slot of the level above,
+  // so the first occupied slot in the lowest level holds the next event.
+  for (size_t level = 0; level < kLevels; ++level) {
+    const size_t slot_bits = kSlotBits * level;
+    const size_t current_slot = (current_tick_ >> slot_bits) & kSlotMask;
+
+    // Slots up to and including the current one are never occupied, so only
+    // the later slots are checked. Shifting a 64-bit 2 by 63 yields 0, so the
+    // mask is correct for the last slot too.
+    const uint64_t later =
+        occupied_[level] & ~((uint64_t{2} << current_slot) - 1);
+    if (later != 0u) {
+      const size_t span_bits = slot_bits + kSlotBits;
+      const uint64_t span_start = (current_tick_ >> span_bits) << span_bits;
+      const uint64_t slot = static_cast<uint64_t>(__builtin_ctzll(later));
+      return span_start | (slot << slot_bits);
+    }
+  }
+
+  // Only overflowing timers remain. They are reinserted when the top level
+  // wraps around.
+  const size_t top_bits = kSlotBits * kLevels;
+  return ((current_tick_ >> top_bits) + 1) << top_bits;
+}
+
+}  // namespace pw::chrono
@@ -0,0 +1,228 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_chrono/timer_wheel.h"
+
+#include <array>
+#include <chrono>
+#include <optional>
+
+#include "gtest/gtest.h"
+
+namespace pw::chrono {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr SystemClock::time_point At(int64_t ticks) {
+  return SystemClock::time_point(SystemClock::duration(ticks));
+}
+
+constexpr SystemClock::time_point kStart = At(0);
+
+struct ExpiryLog {
+  std::array<SystemClock::time_point, 8> deadlines{};
+  size_t count = 0;
+
+  WheelTimer::ExpiryCallback Record() {
+    return [this](SystemClock::time_point deadline) {
+      deadlines[count++] = deadline;
+    };
+  }
+};
+
+TEST(TimerWheel, Timer_ExpiresOnFirstTickAtOrAfterDeadline) {
+  TimerWheel wheel(SystemClock::duration(10), kStart);
+  ExpiryLog log;
+  WheelTimer timer(log.Record());
+
+  wheel.ScheduleAt(timer, At(25));
+  EXPECT_TRUE(wheel.scheduled(timer));
+
+  wheel.Advance(At(29));
+  EXPECT_EQ(log.count, 0u);
+
+  wheel.Advance(At(30));
+  ASSERT_EQ(log.count, 1u);
+  EXPECT_EQ(log.deadlines[0], At(25));
+  EXPECT_FALSE(wheel.scheduled(timer));
+  EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheel, PastDeadline_ExpiresOnNextTick) {
+  TimerWheel wheel(SystemClock::duration(1), kStart);
+  ExpiryLog log;
+  WheelTimer timer(log.Record());
+
+  wheel.Advance(At(100));
+  wheel.ScheduleAt(timer, At(50));
+
+  wheel.Advance(At(100));
+  EXPECT_EQ(log.count, 0u);
+  wheel.Advance(At(101));
+  EXPECT_EQ(log.count, 1u);
+}
+
+TEST(TimerWheel, TimersOnEveryLevel_ExpireInOrder) {
+  TimerWheel wheel(SystemClock::duration(1), kStart);
+  ExpiryLog log;
+
+  // From level 0 up to the overflow list, scheduled out of order.
+  constexpr std::array<int64_t, 6> kDeadlines = {
+      300'000, 5, 20'000'000, 70, 5'000, 16'777'216};
+  std::array<std::optional<WheelTimer>, kDeadlines.size()> timers;
+  for (size_t i = 0; i < kDeadlines.size(); ++i) {
+    timers[i].emplace(log.Record());
+    wheel.ScheduleAt(*timers[i], At(kDeadlines[i]));
+  }
+  EXPECT_EQ(wheel.size(), kDeadlines.size());
+
+  wheel.Advance(At(69));
+  ASSERT_EQ(log.count, 1u);
+
+  wheel.Advance(At(20'000'000));
+  ASSERT_EQ(log.count, kDeadlines.size());
+  EXPECT_EQ(log.deadlines[0], At(5));
+  EXPECT_EQ(log.deadlines[1], At(70));
+  EXPECT_EQ(log.deadlines[2], At(5'000));
+  EXPECT_EQ(log.deadlines[3], At(300'000));
+  EXPECT_EQ(log.deadlines[4], At(16'777'216));
+  EXPECT_EQ(log.deadlines[5], At(20'000'000));
+  EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheel, Cancel_TimerDoesNotExpire) {
+  TimerWheel wheel(SystemClock::duration(1), kStart);
+  ExpiryLog log;
+  WheelTimer near(log.Record());
+  WheelTimer far(log.Record());
+
+  wheel.ScheduleAt(near, At(10));
+  wheel.ScheduleAt(far, At(100'000));
+  wheel.Cancel(near);
+  wheel.Cancel(far);
+  wheel.Cancel(far);
+
+  EXPECT_FALSE(wheel.scheduled(near));
+  EXPECT_EQ(wheel.size(), 0u);
+  wheel.Advance(At(200'000));
+  EXPECT_EQ(log.count, 0u);
+}
+
+TEST(TimerWheel, ScheduleScheduledTimer_Reschedules) {
+  TimerWheel wheel(SystemClock::duration(1), kStart);
+  ExpiryLog log;
+  WheelTimer timer(log.Record());
+
+  wheel.ScheduleAt(timer, At(10));
+  wheel.ScheduleAt(timer, At(5'000));
+  EXPECT_EQ(wheel.size(), 1u);
+
+  wheel.Advance(At(4'999));
+  EXPECT_EQ(log.count, 0u);
+  wheel.Advance(At(5'000));
+  ASSERT_EQ(log.count, 1u);
+  EXPECT_EQ(log.deadlines[0], At(5'000));
+}
+
+struct Periodic {
+  TimerWheel& wheel;
+  std::optional<WheelTimer> timer;
+  int expirations = 0;
+};
+
+TEST(TimerWheel, Callback_ReschedulesItsTimer) {
+  TimerWheel wheel(SystemClock::duration(1), kStart);
+  Periodic periodic{wheel, std::nullopt};
+  periodic.timer.emplace([&periodic](SystemClock::time_point deadline) {
+    periodic.expirations += 1;
+    periodic.wheel.ScheduleAt(*periodic.timer,
+                              deadline + SystemClock::duration(100));
+  });
+
+  wheel.ScheduleAt(*periodic.timer, At(100));
+  wheel.Advance(At(1'050));
+  EXPECT_EQ(periodic.expirations, 10);
+
+  wheel.Cancel(*periodic.timer);
+}
+
+// Checks that each timer expires in the first Advance() at or after its
+// deadline.
+struct Checker {
+  SystemClock::time_point previous_now = kStart;
+  SystemClock::time_point now = kStart;
+  size_t expired = 0;
+  size_t early_or_late = 0;
+};
+
+TEST(TimerWheel, ManyTimers_EachExpiresOnTime) {
+  constexpr size_t kTimers = 200;
+  static std::array<std::optional<WheelTimer>, kTimers> timers;
+
+  TimerWheel wheel(SystemClock::duration(1), kStart);
+  Checker checker;
+
+  uint32_t random = 1;
+  auto next_random = [&random] {
+    random = random * 1664525u + 1013904223u;
+    return random >> 8;
+  };
+
+  for (std::optional<WheelTimer>& timer : timers) {
+    timer.emplace([&checker](SystemClock::time_point deadline) {
+      checker.expired += 1;
+      if (deadline <= checker.previous_now || deadline > checker.now) {
+        checker.early_or_late += 1;
+      }
+    });
+    // Deadlines spread over every level, including the overflow list.
+    const uint32_t scale = uint32_t{1} << (next_random() % 26);
+    wheel.ScheduleAt(*timer, At(1 + next_random() % scale));
+  }
+
+  while (checker.expired < kTimers) {
+    checker.previous_now = checker.now;
+    checker.now += SystemClock::duration(1 + next_random() % 200'000);
+    wheel.Advance(checker.now);
+  }
+
+  EXPECT_EQ(checker.early_or_late, 0u);
+  EXPECT_EQ(wheel.size(), 0u);
+}
+
+struct Stopper {
+  TimerWheel& wheel;
+  bool expired = false;
+};
+
+TEST(TimerWheel, Thread_RunsCallbacksThenStops) {
+  TimerWheel wheel(SystemClock::for_at_least(1ms));
+  Stopper stopper{wheel};
+  WheelTimer timer([&stopper](SystemClock::time_point) {
+    stopper.expired = true;
+    stopper.wheel.RequestStop();
+  });
+
+  const SystemClock::time_point deadline =
+      SystemClock::TimePointAfterAtLeast(SystemClock::for_at_least(3ms));
+  wheel.ScheduleAt(timer, deadline);
+  wheel.Start();
+
+  EXPECT_TRUE(stopper.expired);
+  EXPECT_GE(SystemClock::now(), deadline);
+}
+
+}  // namespace
+}  // namespace pw::chrono
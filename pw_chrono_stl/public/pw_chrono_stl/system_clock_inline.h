@@ -13,13 +13,26 @@
 // the License.
 #pragma once
 
+#include <atomic>
 #include <chrono>
 
 #include "pw_chrono/system_clock.h"
 
 namespace pw::chrono::backend {
+namespace internal {
+
+// The clock that replaces std::chrono::steady_clock while a
+// pw::chrono::stl::VirtualTime exists.
+inline std::atomic<VirtualSystemClock*> virtual_system_clock{nullptr};
+
+}  // namespace internal
 
 inline int64_t GetSystemClockTickCount() {
+  if (VirtualSystemClock* clock =
+          internal::virtual_system_clock.load(std::memory_order_acquire);
+      clock != nullptr) {
+    return clock->now().time_since_epoch().count();
+  }
   // Note that no conversion is necessary since the steady_clock's period and
   // epoch are directly used.
   return std::chrono::steady_clock::now().time_since_epoch().count();
@@ -0,0 +1,164 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+#include "pw_chrono/simulated_system_clock.h"
+#include "pw_chrono/system_clock.h"
+
+namespace pw::chrono::stl {
+
+// Runs pw::chrono::SystemClock on a SimulatedSystemClock, so tests that sleep
+// or wait for timeouts do not wait in real time. While a VirtualTime exists:
+//
+//   - SystemClock::now() returns the simulated clock's time.
+//   - pw::this_thread::sleep_for() and sleep_until() from pw_thread_stl wait
+//     for simulated time to pass.
+//   - The timed functions of the pw_sync_stl backends, and of
+//     TimedThreadNotification built on them, time out in simulated time.
+//
+// For example, a retry loop that backs off for a minute runs instantly:
+//
+//   pw::chrono::SimulatedSystemClock clock;
+//   pw::chrono::stl::VirtualTime virtual_time(clock);
+//
+//   EXPECT_EQ(SendWithRetries(kMaxRetries), Status::DeadlineExceeded());
+//   EXPECT_EQ(clock.now().time_since_epoch(), std::chrono::minutes(1));
+//
+// Only one VirtualTime may exist at a time. It must outlive every thread that
+// uses the clock while it exists, and SystemClock time points from before it
+// was created must not be compared with ones from while it exists.
+class VirtualTime {
+ public:
+  enum class Advance {
+    // A thread that would block until a deadline advances the clock to the
+    // deadline instead. Sleeps return at once, and timed waits time out at
+    // once unless they can complete without blocking. This is deterministic
+    // for code that runs on one thread, such as retry loops and timeouts.
+    kWhenBlocked,
+
+    // The clock only advances when the test calls AdvanceTime() (or advances
+    // the SimulatedSystemClock). Threads that sleep or wait for a timeout
+    // block until then. This lets tests with several threads decide exactly
+    // when each timeout happens.
+    kManually,
+  };
+
+  explicit VirtualTime(SimulatedSystemClock& clock,
+                       Advance advance = Advance::kWhenBlocked);
+  ~VirtualTime();
+
+  VirtualTime(const VirtualTime&) = delete;
+  VirtualTime& operator=(const VirtualTime&) = delete;
+
+  // Advances the simulated clock, which wakes threads whose deadlines passed.
+  void AdvanceTime(SystemClock::duration duration) {
+    clock_.AdvanceTime(duration);
+  }
+
+  // The number of threads that are sleeping or waiting for a timeout. In
+  // kManually mode, a test waits for this before advancing time, so that the
+  // threads' deadlines are set from the time before the advance.
+  size_t waiting_threads() const {
+    return waiting_threads_.load(std::memory_order_acquire);
+  }
+
+  // Returns the VirtualTime in use, or nullptr if the clock runs in real time.
+  static VirtualTime* active() {
+    return active_.load(std::memory_order_acquire);
+  }
+
+  // The functions below are used by the pw_thread_stl and pw_sync_stl
+  // backends; tests do not need to call them.
+
+  // Blocks until simulated time reaches the deadline.
+  void SleepUntil(SystemClock::time_point deadline);
+
+  // Waits on a condition variable until the predicate is true or simulated
+  // time reaches the deadline. Returns the final value of the predicate, like
+  // std::condition_variable_any::wait_until().
+  template <typename Lock, typename Predicate>
+  bool WaitUntil(std::condition_variable_any& condition,
+                 Lock& lock,
+                 SystemClock::time_point deadline,
+                 Predicate predicate);
+
+  // Tries to lock the mutex until simulated time reaches the deadline.
+  bool TryLockUntil(std::timed_mutex& mutex, SystemClock::time_point deadline);
+
+ private:
+  // Counts a thread in waiting_threads() while it exists.
+  class Waiter {
+   public:
+    explicit Waiter(VirtualTime& virtual_time)
+        : count_(virtual_time.waiting_threads_) {
+      count_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    ~Waiter() { count_.fetch_sub(1, std::memory_order_acq_rel); }
+
+   private:
+    std::atomic<size_t>& count_;
+  };
+
+  // How often, in real time, blocked threads check the simulated clock. The
+  // SimulatedSystemClock cannot notify them when it is advanced.
+  static constexpr std::chrono::milliseconds kPollPeriod{1};
+
+  // In kWhenBlocked mode, advances the clock to the deadline if it is behind
+  // and returns true. Returns false in kManually mode.
+  bool AdvanceTo(SystemClock::time_point deadline);
+
+  static std::atomic<VirtualTime*> active_;
+
+  SimulatedSystemClock& clock_;
+  const Advance advance_;
+  std::mutex advance_lock_;
+  std::atomic<size_t> waiting_threads_{0};
+};
+
+template <typename Lock, typename Predicate>
+bool VirtualTime::WaitUntil(std::condition_variable_any& condition,
+                            Lock& lock,
+                            SystemClock::time_point deadline,
+                            Predicate predicate) {
+  const Waiter waiter(*this);
+  while (!predicate()) {
+    if (clock_.now() >= deadline || AdvanceTo(deadline)) {
+      return predicate();
+    }
+    condition.wait_for(lock, kPollPeriod);
+  }
+  return true;
+}
+
+// Waits on a condition variable with a SystemClock deadline, in simulated time
+// if a VirtualTime is active.
+template <typename Lock, typename Predicate>
+bool WaitUntil(std::condition_variable_any& condition,
+               Lock& lock,
+               SystemClock::time_point deadline,
+               Predicate predicate) {
+  if (VirtualTime* virtual_time = VirtualTime::active();
+      virtual_time != nullptr) {
+    return virtual_time->WaitUntil(condition, lock, deadline, predicate);
+  }
+  return condition.wait_until(lock, deadline, predicate);
+}
+
+}  // namespace pw::chrono::stl
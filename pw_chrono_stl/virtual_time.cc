@@ -0,0 +1,79 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_chrono_stl/virtual_time.h"
+
+#include <thread>
+
+#include "pw_assert/check.h"
+
+namespace pw::chrono::stl {
+
+std::atomic<VirtualTime*> VirtualTime::active_{nullptr};
+
+VirtualTime::VirtualTime(SimulatedSystemClock& clock, Advance advance)
+    : clock_(clock), advance_(advance) {
+  VirtualTime* expected = nullptr;
+  PW_CHECK(active_.compare_exchange_strong(expected, this),
+           "Only one VirtualTime may exist at a time");
+  backend::internal::virtual_system_clock.store(&clock_,
+                                                std::memory_order_release);
+}
+
+VirtualTime::~VirtualTime() {
+  backend::internal::virtual_system_clock.store(nullptr,
+                                                std::memory_order_release);
+  active_.store(nullptr, std::memory_order_release);
+}
+
+void VirtualTime::SleepUntil(SystemClock::time_point deadline) {
+  const Waiter waiter(*this);
+  if (AdvanceTo(deadline)) {
+    std::this_thread::yield();
+    return;
+  }
+  while (clock_.now() < deadline) {
+    std::this_thread::sleep_for(kPollPeriod);
+  }
+}
+
+bool VirtualTime::TryLockUntil(std::timed_mutex& mutex,
+                               SystemClock::time_point deadline) {
+  if (mutex.try_lock()) {
+    return true;
+  }
+  const Waiter waiter(*this);
+  while (clock_.now() < deadline && !AdvanceTo(deadline)) {
+    if (mutex.try_lock_for(kPollPeriod)) {
+      return true;
+    }
+  }
+  return mutex.try_lock();
+}
+
+bool VirtualTime::AdvanceTo(SystemClock::time_point deadline) {
+  if (advance_ != Advance::kWhenBlocked) {
+    return false;
+  }
+
+  // Serialize advancing so that concurrent sleepers never move time back.
+  std::lock_guard lock(advance_lock_);
+  const SystemClock::time_point now = clock_.now();
+  if (now < deadline) {
+    clock_.AdvanceTime(deadline - now);
+  }
+  return true;
+}
+
+}  // namespace pw::chrono::stl
@@ -0,0 +1,153 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_chrono_stl/virtual_time.h"
+
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "pw_chrono/simulated_system_clock.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_sync/event_flags.h"
+#include "pw_sync/timed_mutex.h"
+#include "pw_thread/sleep.h"
+
+using namespace std::chrono_literals;
+
+namespace pw::chrono::stl {
+namespace {
+
+using Advance = VirtualTime::Advance;
+
+SystemClock::duration Elapsed(SimulatedSystemClock& clock) {
+  return clock.now().time_since_epoch();
+}
+
+void WaitForWaiters(const VirtualTime& virtual_time, size_t count) {
+  while (virtual_time.waiting_threads() < count) {
+    std::this_thread::yield();
+  }
+}
+
+TEST(VirtualTime, SystemClockUsesSimulatedClock) {
+  SimulatedSystemClock clock;
+  VirtualTime virtual_time(clock);
+
+  EXPECT_EQ(SystemClock::now().time_since_epoch(), SystemClock::duration(0));
+  clock.AdvanceTime(42s);
+  EXPECT_EQ(SystemClock::now().time_since_epoch(), SystemClock::duration(42s));
+}
+
+TEST(VirtualTime, RealTimeRestoredAfterDestruction) {
+  SimulatedSystemClock clock;
+  { VirtualTime virtual_time(clock); }
+
+  EXPECT_EQ(VirtualTime::active(), nullptr);
+  EXPECT_GT(SystemClock::now().time_since_epoch(), SystemClock::duration(0));
+}
+
+TEST(VirtualTime, WhenBlocked_SleepAdvancesClock) {
+  SimulatedSystemClock clock;
+  VirtualTime virtual_time(clock);
+
+  this_thread::sleep_for(1h);
+  EXPECT_EQ(Elapsed(clock), SystemClock::duration(1h));
+
+  this_thread::sleep_until(SystemClock::time_point(90min));
+  EXPECT_EQ(Elapsed(clock), SystemClock::duration(90min));
+}
+
+TEST(VirtualTime, WhenBlocked_SemaphoreTimesOutImmediately) {
+  SimulatedSystemClock clock;
+  VirtualTime virtual_time(clock);
+  sync::BinarySemaphore semaphore;
+
+  EXPECT_FALSE(semaphore.try_acquire_for(10min));
+  EXPECT_EQ(Elapsed(clock), SystemClock::duration(10min));
+
+  semaphore.release();
+  EXPECT_TRUE(semaphore.try_acquire_for(10min));
+  EXPECT_EQ(Elapsed(clock), SystemClock::duration(10min));
+}
+
+TEST(VirtualTime, WhenBlocked_EventFlagsTimeOutImmediately) {
+  SimulatedSystemClock clock;
+  VirtualTime virtual_time(clock);
+  sync::EventFlags flags;
+
+  EXPECT_EQ(flags.try_wait_any_for(0b1, 5s), 0u);
+  EXPECT_EQ(Elapsed(clock), SystemClock::duration(5s));
+}
+
+TEST(VirtualTime, WhenBlocked_TimedMutexTimesOutImmediately) {
+  SimulatedSystemClock clock;
+  VirtualTime virtual_time(clock);
+  sync::TimedMutex mutex;
+
+  mutex.lock();
+  std::thread other([&mutex] { EXPECT_FALSE(mutex.try_lock_for(1min)); });
+  other.join();
+  mutex.unlock();
+  EXPECT_EQ(Elapsed(clock), SystemClock::duration(1min));
+}
+
+TEST(VirtualTime, Manually_SemaphoreTimesOutWhenClockAdvances) {
+  SimulatedSystemClock clock;
+  VirtualTime virtual_time(clock, Advance::kManually);
+  sync::BinarySemaphore semaphore;
+
+  bool acquired = true;
+  std::thread waiter([&] { acquired = semaphore.try_acquire_for(1h); });
+
+  WaitForWaiters(virtual_time, 1);
+  virtual_time.AdvanceTime(59min);
+  virtual_time.AdvanceTime(1min);
+  waiter.join();
+
+  EXPECT_FALSE(acquired);
+  EXPECT_EQ(Elapsed(clock), SystemClock::duration(1h));
+}
+
+TEST(VirtualTime, Manually_SemaphoreAcquiredBeforeTimeout) {
+  SimulatedSystemClock clock;
+  VirtualTime virtual_time(clock, Advance::kManually);
+  sync::BinarySemaphore semaphore;
+
+  bool acquired = false;
+  std::thread waiter([&] { acquired = semaphore.try_acquire_for(1h); });
+
+  semaphore.release();
+  waiter.join();
+
+  EXPECT_TRUE(acquired);
+  EXPECT_EQ(Elapsed(clock), SystemClock::duration(0));
+}
+
+TEST(VirtualTime, Manually_SleepWaitsForClock) {
+  SimulatedSystemClock clock;
+  VirtualTime virtual_time(clock, Advance::kManually);
+
+  std::thread sleeper([] { this_thread::sleep_for(30s); });
+  WaitForWaiters(virtual_time, 1);
+  virtual_time.AdvanceTime(30s);
+  sleeper.join();
+
+  EXPECT_EQ(Elapsed(clock), SystemClock::duration(30s));
+}
+
+}  // namespace
+}  // namespace pw::chrono::stl
@@ -0,0 +1,159 @@
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Tests for pw_console.log_container"""
+
+import logging
+import unittest
+from unittest.mock import Mock
+
+from pw_tokenizer import detokenize, tokens
+
+from pw_console.log_container import LogContainer
+
+
+def _record(message: str) -> logging.LogRecord:
+    return logging.makeLogRecord(dict(msg=message))
+
+
+def _messages(lines) -> list:
+    return [line.record.getMessage() for line in lines]
+
+
+class TestLogContainer(unittest.TestCase):
+    """Tests for LogContainer."""
+    def setUp(self):
+        self.on_change = Mock()
+        self.container = LogContainer(max_history=10,
+                                      on_change=self.on_change)
+
+    def test_emit_from_logger(self) -> None:
+        logger = logging.getLogger('pw_console.log_container_test')
+        logger.propagate = False
+        logger.addHandler(self.container)
+        try:
+            logger.warning('Hello %s', 'logs')
+        finally:
+            logger.removeHandler(self.container)
+
+        self.assertEqual(['Hello logs'],
+                         _messages(self.container.get_lines(5)))
+        self.on_change.assert_called_once()
+
+    def test_add_records_updates_once(self) -> None:
+        self.container.add_records(_record(str(i)) for i in range(5))
+
+        self.assertEqual(5, self.container.line_count)
+        self.on_change.assert_called_once()
+
+    def test_get_lines_follows_newest(self) -> None:
+        self.container.add_records(_record(str(i)) for i in range(8))
+
+        self.assertEqual(['5', '6', '7'],
+                         _messages(self.container.get_lines(3)))
+        self.assertEqual(8, self.container.line_number)
+
+    def test_scroll(self) -> None:
+        self.container.add_records(_record(str(i)) for i in range(8))
+
+        self.container.scroll(-2)
+        self.assertFalse(self.container.follow)
+        self.assertEqual(['3', '4', '5'],
+                         _messages(self.container.get_lines(3)))
+        self.assertEqual(6, self.container.line_number)
+
+        # New logs do not move the viewport when not following.
+        self.container.add_records([_record('8')])
+        self.assertEqual(['3', '4', '5'],
+                         _messages(self.container.get_lines(3)))
+
+        self.container.scroll(-100)
+        self.assertEqual(['0'], _messages(self.container.get_lines(3)))
+
+        self.container.scroll(100)
+        self.assertTrue(self.container.follow)
+        self.assertEqual(['6', '7', '8'],
+                         _messages(self.container.get_lines(3)))
+
+    def test_max_history(self) -> None:
+        self.container.add_records(_record(str(i)) for i in range(25))
+
+        self.assertEqual(10, self.container.line_count)
+        self.assertEqual(15, self.container.first_log_id)
+        self.assertEqual([str(i) for i in range(15, 25)],
+                         _messages(self.container.get_lines(100)))
+
+    def test_filter(self) -> None:
+        self.container.add_records(
+            _record(f'{"even" if i % 2 == 0 else "odd"} {i}')
+            for i in range(6))
+
+        self.container.set_filter('even')
+        self.assertEqual(3, self.container.line_count)
+        self.assertEqual(['even 2', 'even 4'],
+                         _messages(self.container.get_lines(2)))
+
+        # New logs are checked against the filter as they arrive.
+        self.container.add_records([_record('odd 6'), _record('even 8')])
+        self.assertEqual(['even 4', 'even 8'],
+                         _messages(self.container.get_lines(2)))
+
+        self.container.set_filter(None)
+        self.assertEqual(8, self.container.line_count)
+
+    def test_filter_with_max_history(self) -> None:
+        self.container.set_filter('keep')
+        self.container.add_records(
+            _record('keep' if i % 3 == 0 else 'drop') for i in range(30))
+
+        # Logs 20-29 are stored; 21, 24, and 27 match.
+        self.assertEqual(3, self.container.line_count)
+        self.assertEqual(['keep'] * 3,
+                         _messages(self.container.get_lines(10)))
+
+    def test_clear_logs(self) -> None:
+        self.container.add_records(_record(str(i)) for i in range(5))
+        self.container.clear_logs()
+
+        self.assertEqual(0, self.container.line_count)
+        self.assertEqual([], self.container.get_lines(5))
+
+    def test_get_formatted_text(self) -> None:
+        self.container.setFormatter(logging.Formatter('%(message)s'))
+        self.container.add_records(
+            [_record('\x1b[31mred\x1b[0m'),
+             _record('plain')])
+
+        text = ''.join(text for _, text, *_ in
+                       self.container.get_formatted_text(5))
+        self.assertEqual('red\nplain\n', text)
+
+    def test_add_tokenized_logs(self) -> None:
+        detokenizer = detokenize.Detokenizer(
+            tokens.Database([
+                tokens.TokenizedStringEntry(1, 'Hello %s'),
+                tokens.TokenizedStringEntry(2, 'Goodbye'),
+            ]))
+
+        self.container.add_tokenized_logs(detokenizer, [
+            b'\x01\x00\x00\x00\x05world',
+            b'\x02\x00\x00\x00',
+        ])
+
+        self.assertEqual(['Hello world', 'Goodbye'],
+                         _messages(self.container.get_lines(5)))
+        self.on_change.assert_called_once()
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -17,6 +17,10 @@ import builtins
 import logging
 from typing import Iterable, Optional
 
+from prompt_toolkit.application import get_app
+
+from pw_console.log_pane import LogPane
+
 _LOG = logging.getLogger(__package__)
 
 
@@ -36,10 +40,16 @@ class ConsoleApp:
 
         local_vars = local_vars or global_vars
 
+        self.log_pane = LogPane(application=self)
+
     def add_log_handler(self, logger_instance):
         """Add the Log pane as a handler for this logger instance."""
-        # TODO: Add log pane to addHandler call.
-        # logger_instance.addHandler(...)
+        logger_instance.addHandler(self.log_pane.log_container)
+
+    # pylint: disable=no-self-use
+    def redraw_ui(self):
+        """Redraw the prompt_toolkit UI. Safe to call from any thread."""
+        get_app().invalidate()
 
 
 def embed(
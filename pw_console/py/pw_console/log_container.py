@@ -0,0 +1,226 @@
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""LogContainer class."""
+
+import collections
+import logging
+import re
+from typing import (Callable, Deque, Iterable, List, Optional, Pattern,
+                    Union)
+
+from prompt_toolkit.formatted_text import (
+    ANSI,
+    StyleAndTextTuples,
+    to_formatted_text,
+)
+
+from pw_tokenizer.detokenize import Detokenizer
+
+
+class LogLine:
+    """A stored log record, formatted for display only when first shown."""
+    def __init__(self, record: logging.LogRecord):
+        self.record = record
+        self._fragments: Optional[StyleAndTextTuples] = None
+
+    def get_fragments(self,
+                      formatter: logging.Formatter) -> StyleAndTextTuples:
+        """Returns the formatted record as prompt_toolkit text fragments."""
+        if self._fragments is None:
+            self._fragments = to_formatted_text(
+                ANSI(formatter.format(self.record)))
+        return self._fragments
+
+
+class LogContainer(logging.Handler):
+    """Stores logs for a LogPane and tracks which of them are in view.
+
+    Logs are stored as unformatted records. Only the records in the viewport
+    are formatted, when they are first drawn, so the cost of drawing does not
+    depend on the number of stored logs.
+
+    When a filter is set, the IDs of the matching logs are kept in an index.
+    The index is built once when the filter is set, and then only new logs are
+    checked against the filter.
+
+    Logs are identified by sequential IDs; the oldest stored log has the ID
+    first_log_id. When max_history is exceeded, the oldest logs are dropped.
+    """
+
+    # pylint: disable=too-many-instance-attributes
+    def __init__(self,
+                 max_history: int = 1000000,
+                 on_change: Optional[Callable[[], None]] = None):
+        super().__init__()
+        self.max_history = max_history
+        self.on_change = on_change
+        self.setFormatter(logging.Formatter('%(asctime)s %(message)s'))
+
+        self.logs: Deque[LogLine] = collections.deque()
+        self.first_log_id = 0
+
+        # IDs of the logs that match the filter, if a filter is set.
+        self.filter_pattern: Optional[Pattern[str]] = None
+        self._filtered_ids: Deque[int] = collections.deque()
+
+        # When following, the viewport shows the newest logs. Otherwise, it
+        # ends at the shown log with this index.
+        self.follow = True
+        self._last_line_index = 0
+
+    @property
+    def line_count(self) -> int:
+        """The number of logs that match the filter."""
+        if self.filter_pattern is None:
+            return len(self.logs)
+        return len(self._filtered_ids)
+
+    @property
+    def line_number(self) -> int:
+        """The 1-based number of the last log in the viewport."""
+        if self.follow:
+            return self.line_count
+        return self._last_line_index + 1
+
+    def emit(self, record: logging.LogRecord) -> None:
+        """Stores a record; called by the logging module."""
+        self.add_records([record])
+
+    def add_records(self, records: Iterable[logging.LogRecord]) -> None:
+        """Stores a batch of records, with a single UI update."""
+        with self.lock:
+            for record in records:
+                self._append(LogLine(record))
+
+            self._trim()
+
+        if self.on_change is not None:
+            self.on_change()
+
+    def add_tokenized_logs(self,
+                           detokenizer: Detokenizer,
+                           encoded_messages: Iterable[bytes],
+                           name: str = 'tokenized',
+                           level: int = logging.INFO) -> None:
+        """Detokenizes and stores a batch of tokenized log messages.
+
+        Messages that cannot be detokenized are stored as their encoded form,
+        as formatted by the detokenizer.
+        """
+        self.add_records(
+            logging.makeLogRecord(
+                dict(name=name,
+                     levelno=level,
+                     levelname=logging.getLevelName(level),
+                     msg=str(detokenizer.detokenize(message))))
+            for message in encoded_messages)
+
+    def clear_logs(self) -> None:
+        """Erases all stored logs."""
+        with self.lock:
+            self.first_log_id += len(self.logs)
+            self.logs.clear()
+            self._filtered_ids.clear()
+            self._last_line_index = 0
+
+        if self.on_change is not None:
+            self.on_change()
+
+    def set_filter(self, pattern: Union[None, str, Pattern[str]]) -> None:
+        """Shows only logs whose messages match this regex; None shows all."""
+        with self.lock:
+            self.filter_pattern = (None if pattern is None else
+                                   re.compile(pattern))
+            self._filtered_ids.clear()
+
+            if self.filter_pattern is not None:
+                self._filtered_ids.extend(
+                    self.first_log_id + i for i, line in enumerate(self.logs)
+                    if self._matches(line))
+
+            self.follow = True
+
+        if self.on_change is not None:
+            self.on_change()
+
+    def toggle_follow(self) -> None:
+        """Toggles following the newest logs."""
+        with self.lock:
+            if self.follow:
+                self._last_line_index = max(self.line_count - 1, 0)
+            self.follow = not self.follow
+
+    def scroll(self, lines: int) -> None:
+        """Scrolls the viewport down by lines, or up if negative.
+
+        Scrolling stops following the newest logs, unless scrolling reaches
+        them.
+        """
+        with self.lock:
+            last_index = self.line_count - 1
+            current = last_index if self.follow else self._last_line_index
+            self._last_line_index = min(max(current + lines, 0),
+                                        max(last_index, 0))
+            self.follow = self._last_line_index >= last_index
+
+    def get_lines(self, height: int) -> List[LogLine]:
+        """Returns the logs in a viewport of this height, oldest first."""
+        with self.lock:
+            count = self.line_count
+            end = count if self.follow else min(self._last_line_index + 1,
+                                                count)
+            start = max(end - height, 0)
+
+            if self.filter_pattern is None:
+                return [self.logs[i] for i in range(start, end)]
+
+            return [
+                self.logs[self._filtered_ids[i] - self.first_log_id]
+                for i in range(start, end)
+            ]
+
+    def get_formatted_text(self, height: int) -> StyleAndTextTuples:
+        """Returns the viewport's logs as prompt_toolkit text fragments."""
+        fragments: StyleAndTextTuples = []
+        for line in self.get_lines(height):
+            fragments.extend(line.get_fragments(self.formatter))
+            fragments.append(('', '\n'))
+        return fragments
+
+    def _matches(self, line: LogLine) -> bool:
+        assert self.filter_pattern is not None
+        return self.filter_pattern.search(line.record.getMessage()) is not None
+
+    def _append(self, line: LogLine) -> None:
+        if self.filter_pattern is not None and self._matches(line):
+            self._filtered_ids.append(self.first_log_id + len(self.logs))
+
+        self.logs.append(line)
+
+    def _trim(self) -> None:
+        dropped = len(self.logs) - self.max_history
+        if dropped <= 0:
+            return
+
+        if self.filter_pattern is None:
+            self._last_line_index = max(self._last_line_index - dropped, 0)
+
+        for _ in range(dropped):
+            self.logs.popleft()
+        self.first_log_id += dropped
+
+        while (self._filtered_ids
+               and self._filtered_ids[0] < self.first_log_id):
+            self._filtered_ids.popleft()
+            self._last_line_index = max(self._last_line_index - 1, 0)
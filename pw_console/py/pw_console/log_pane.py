@@ -35,17 +35,17 @@ from prompt_toolkit.layout import (
 from prompt_toolkit.layout.dimension import AnyDimension
 from prompt_toolkit.mouse_events import MouseEvent, MouseEventType
 
+from pw_console.log_container import LogContainer
+
 
 class LogPaneLineInfoBar(ConditionalContainer):
     """One line bar for showing current and total log lines."""
     @staticmethod
-    def get_tokens(unused_log_pane):
+    def get_tokens(log_pane):
         """Return formatted text tokens for display."""
         tokens = ' Line {} / {} '.format(
-            # TODO: Replace fake counts with the current line (1) and total
-            # lines (10).
-            1,
-            10)
+            log_pane.log_container.line_number,
+            log_pane.log_container.line_count)
         return [('', tokens)]
 
     def __init__(self, log_pane):
@@ -62,11 +62,7 @@ class LogPaneLineInfoBar(ConditionalContainer):
                    align=WindowAlign.RIGHT),
             # Only show current/total line info if not auto-following
             # logs. Similar to tmux behavior.
-            filter=Condition(
-                lambda: True
-                # TODO: replace True with log follow status.
-                # not log_pane.log_container.follow
-            ))
+            filter=Condition(lambda: not log_pane.log_container.follow))
 
 
 class LogPaneBottomToolbarBar(ConditionalContainer):
@@ -244,9 +240,12 @@ class LogPane:
         # Create the bottom toolbar for the whole log pane.
         self.bottom_toolbar = LogPaneBottomToolbarBar(self)
 
-        # TODO: Render logs here
+        # Stored logs. Only the logs that fit in the pane are rendered.
+        self.log_container = LogContainer(on_change=self.redraw_ui)
+
         self.log_content_control = FormattedTextControl(
-            [('', 'Logs appear here')],
+            lambda: self.log_container.get_formatted_text(
+                self.current_log_pane_height),
             focusable=True,
         )
 
@@ -310,13 +309,12 @@ class LogPane:
 
     def toggle_follow(self):
         """Toggle following log lines."""
-        # TODO: self.log_container.toggle_follow()
+        self.log_container.toggle_follow()
         self.redraw_ui()
 
     def clear_history(self):
         """Erase stored log lines."""
-        # TODO: self.log_container.clear_logs()
-        self.redraw_ui()
+        self.log_container.clear_logs()
 
     def __pt_container__(self):
         """Return the prompt_toolkit root container for this log pane."""
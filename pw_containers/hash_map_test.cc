@@ -0,0 +1,267 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/hash_map.h"
+
+#include <cstdint>
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+// Sends every key to the same slot, so all entries collide.
+struct CollidingHash {
+  size_t operator()(int) const { return 0; }
+};
+
+// Sends each key to the slot it names, to control placement in tests.
+struct IdentityHash {
+  size_t operator()(int key) const { return static_cast<size_t>(key); }
+};
+
+// Counts live instances to check that entries are constructed and destroyed.
+struct Counted {
+  static int live;
+
+  Counted(int v = 0) : value(v) { live += 1; }
+  Counted(const Counted& other) : value(other.value) { live += 1; }
+  Counted(Counted&& other) : value(other.value) { live += 1; }
+  Counted& operator=(const Counted&) = default;
+  ~Counted() { live -= 1; }
+
+  int value;
+};
+
+int Counted::live = 0;
+
+TEST(HashMap, DefaultConstructed_IsEmpty) {
+  HashMap<int, int, 8> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.size(), 0u);
+  EXPECT_EQ(map.capacity(), 8u);
+  EXPECT_EQ(map.begin(), map.end());
+  EXPECT_EQ(map.find(1), map.end());
+}
+
+TEST(HashMap, Insert_ThenFind) {
+  HashMap<int, int, 8> map;
+  auto [it, inserted] = map.insert({1, 100});
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(it->first, 1);
+  EXPECT_EQ(it->second, 100);
+
+  EXPECT_EQ(map.size(), 1u);
+  EXPECT_TRUE(map.contains(1));
+  EXPECT_EQ(map.count(1), 1u);
+  EXPECT_FALSE(map.contains(2));
+  EXPECT_EQ(map.find(1)->second, 100);
+}
+
+TEST(HashMap, Insert_ExistingKey_DoesNotReplace) {
+  HashMap<int, int, 8> map;
+  map.insert({1, 100});
+  auto [it, inserted] = map.insert({1, 200});
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(it->second, 100);
+  EXPECT_EQ(map.size(), 1u);
+}
+
+TEST(HashMap, InsertOrAssign_ReplacesValue) {
+  HashMap<int, int, 8> map;
+  EXPECT_TRUE(map.insert_or_assign(1, 100).second);
+  EXPECT_FALSE(map.insert_or_assign(1, 200).second);
+  EXPECT_EQ(map.find(1)->second, 200);
+}
+
+TEST(HashMap, SubscriptOperator_InsertsDefault) {
+  HashMap<std::string_view, int, 8> map;
+  map["one"] += 1;
+  map["one"] += 1;
+  map["two"] = 2;
+  EXPECT_EQ(map.size(), 2u);
+  EXPECT_EQ(map["one"], 2);
+  EXPECT_EQ(map["two"], 2);
+}
+
+TEST(HashMap, InitializerList) {
+  const HashMap<int, char, 4> map = {{1, 'a'}, {2, 'b'}, {3, 'c'}};
+  EXPECT_EQ(map.size(), 3u);
+  EXPECT_EQ(map.find(2)->second, 'b');
+}
+
+TEST(HashMap, Full_InsertFails) {
+  HashMap<int, int, 4> map = {{1, 1}, {2, 2}, {3, 3}, {4, 4}};
+  ASSERT_TRUE(map.full());
+
+  auto [it, inserted] = map.insert({5, 5});
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(it, map.end());
+  EXPECT_FALSE(map.contains(5));
+
+  // Existing keys are still found in a full map.
+  for (int key = 1; key <= 4; ++key) {
+    EXPECT_EQ(map.find(key)->second, key);
+  }
+}
+
+TEST(HashMap, Collisions_AllFound) {
+  HashMap<int, int, 8, CollidingHash> map;
+  for (int key = 0; key < 8; ++key) {
+    ASSERT_TRUE(map.insert({key, key * 10}).second);
+  }
+  for (int key = 0; key < 8; ++key) {
+    EXPECT_EQ(map.find(key)->second, key * 10);
+  }
+  EXPECT_FALSE(map.contains(8));
+}
+
+TEST(HashMap, Erase_ByKey) {
+  HashMap<int, int, 8> map = {{1, 1}, {2, 2}};
+  EXPECT_EQ(map.erase(1), 1u);
+  EXPECT_EQ(map.erase(1), 0u);
+  EXPECT_FALSE(map.contains(1));
+  EXPECT_TRUE(map.contains(2));
+  EXPECT_EQ(map.size(), 1u);
+}
+
+TEST(HashMap, Erase_ShiftsCollidingEntriesBack) {
+  HashMap<int, int, 8, CollidingHash> map;
+  for (int key = 0; key < 5; ++key) {
+    map.insert({key, key});
+  }
+
+  EXPECT_EQ(map.erase(0), 1u);
+  EXPECT_EQ(map.erase(2), 1u);
+  for (int key : {1, 3, 4}) {
+    EXPECT_EQ(map.find(key)->second, key);
+  }
+  EXPECT_FALSE(map.contains(0));
+  EXPECT_FALSE(map.contains(2));
+}
+
+TEST(HashMap, RobinHood_WrapsAroundTable) {
+  // Keys 6 and 7 take the last two slots, so further keys homed at 6 wrap to
+  // the start of the table and displace keys homed there.
+  HashMap<int, int, 8, IdentityHash> map;
+  map.insert({6, 6});
+  map.insert({7, 7});
+  map.insert({0, 0});
+  map.insert({14, 14});  // Home slot 6.
+  map.insert({1, 1});
+
+  for (int key : {0, 1, 6, 7, 14}) {
+    EXPECT_EQ(map.find(key)->second, key);
+  }
+  EXPECT_FALSE(map.contains(22));  // Home slot 6, not present.
+
+  EXPECT_EQ(map.erase(6), 1u);
+  for (int key : {0, 1, 7, 14}) {
+    EXPECT_EQ(map.find(key)->second, key);
+  }
+}
+
+TEST(HashMap, Iteration_VisitsEachEntry) {
+  HashMap<int, int, 16> map;
+  for (int key = 0; key < 10; ++key) {
+    map.insert({key, key});
+  }
+
+  int sum = 0;
+  size_t count = 0;
+  for (const auto& [key, value] : map) {
+    EXPECT_EQ(key, value);
+    sum += value;
+    count += 1;
+  }
+  EXPECT_EQ(count, 10u);
+  EXPECT_EQ(sum, 45);
+}
+
+TEST(HashMap, EraseWhileIterating) {
+  HashMap<int, int, 16, CollidingHash> map;
+  for (int key = 0; key < 10; ++key) {
+    map.insert({key, key});
+  }
+
+  for (auto it = map.begin(); it != map.end();) {
+    if (it->first % 2 == 0) {
+      it = map.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  EXPECT_EQ(map.size(), 5u);
+  for (int key = 0; key < 10; ++key) {
+    EXPECT_EQ(map.contains(key), key % 2 == 1);
+  }
+}
+
+TEST(HashMap, Entries_ConstructedAndDestroyed) {
+  Counted::live = 0;
+  {
+    HashMap<int, Counted, 8, CollidingHash> map;
+    for (int key = 0; key < 6; ++key) {
+      map.try_emplace(key, key);
+    }
+    EXPECT_EQ(Counted::live, 6);
+
+    map.erase(0);
+    map.erase(3);
+    EXPECT_EQ(Counted::live, 4);
+    EXPECT_EQ(map.find(5)->second.value, 5);
+  }
+  EXPECT_EQ(Counted::live, 0);
+}
+
+TEST(HashMap, Clear) {
+  HashMap<int, int, 8> map = {{1, 1}, {2, 2}};
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+  EXPECT_TRUE(map.insert({1, 1}).second);
+}
+
+TEST(HashMap, ChurnMatchesReference) {
+  // Insert and erase pseudo-random keys and compare against a simple array.
+  constexpr int kKeys = 64;
+  HashMap<int, int, 48> map;
+  bool present[kKeys] = {};
+  size_t expected_size = 0;
+
+  uint32_t state = 1;
+  for (int i = 0; i < 5000; ++i) {
+    state = state * 1664525u + 1013904223u;
+    const int key = static_cast<int>((state >> 8) % kKeys);
+    if (present[key]) {
+      ASSERT_EQ(map.erase(key), 1u);
+      present[key] = false;
+      expected_size -= 1;
+    } else if (!map.full()) {
+      ASSERT_TRUE(map.insert({key, key}).second);
+      present[key] = true;
+      expected_size += 1;
+    }
+
+    ASSERT_EQ(map.size(), expected_size);
+    for (int k = 0; k < kKeys; ++k) {
+      ASSERT_EQ(map.contains(k), present[k]);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace pw
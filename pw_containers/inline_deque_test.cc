@@ -0,0 +1,229 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/inline_deque.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+// Since pw::InlineDeque<T, N> downcasts to a pw::InlineDeque<T, 0>, ensure
+// that the alignment doesn't change.
+static_assert(alignof(InlineDeque<std::max_align_t, 0>) ==
+              alignof(InlineDeque<std::max_align_t, 1>));
+
+static_assert(std::is_trivially_destructible_v<InlineDeque<int, 4>>);
+
+struct Counter {
+  static int created;
+  static int destroyed;
+  static int moved;
+
+  static void Reset() { created = destroyed = moved = 0; }
+
+  Counter(int val = 0) : value(val) { created += 1; }
+  Counter(const Counter& other) : value(other.value) { created += 1; }
+  Counter(Counter&& other) : value(other.value) {
+    other.value = 0;
+    moved += 1;
+  }
+  Counter& operator=(const Counter& other) {
+    value = other.value;
+    return *this;
+  }
+  ~Counter() { destroyed += 1; }
+
+  int value;
+};
+
+int Counter::created = 0;
+int Counter::destroyed = 0;
+int Counter::moved = 0;
+
+TEST(InlineDeque, DefaultConstructed_IsEmpty) {
+  InlineDeque<int, 4> deque;
+  EXPECT_TRUE(deque.empty());
+  EXPECT_EQ(deque.size(), 0u);
+  EXPECT_EQ(deque.max_size(), 4u);
+  EXPECT_EQ(deque.begin(), deque.end());
+}
+
+TEST(InlineDeque, PushBack_PopFront_IsFifo) {
+  InlineDeque<int, 4> deque;
+  deque.push_back(1);
+  deque.push_back(2);
+  deque.push_back(3);
+  EXPECT_EQ(deque.front(), 1);
+  EXPECT_EQ(deque.back(), 3);
+
+  deque.pop_front();
+  EXPECT_EQ(deque.front(), 2);
+  deque.pop_front();
+  deque.pop_front();
+  EXPECT_TRUE(deque.empty());
+}
+
+TEST(InlineDeque, PushFront) {
+  InlineDeque<int, 4> deque;
+  deque.push_front(1);
+  deque.push_front(2);
+  deque.push_back(3);
+  ASSERT_EQ(deque.size(), 3u);
+  EXPECT_EQ(deque[0], 2);
+  EXPECT_EQ(deque[1], 1);
+  EXPECT_EQ(deque[2], 3);
+
+  deque.pop_back();
+  EXPECT_EQ(deque.back(), 1);
+}
+
+TEST(InlineDeque, Full_PushHasNoEffect) {
+  InlineDeque<int, 2> deque = {1, 2};
+  ASSERT_TRUE(deque.full());
+  deque.push_back(3);
+  deque.push_front(0);
+  EXPECT_EQ(deque.size(), 2u);
+  EXPECT_EQ(deque.front(), 1);
+  EXPECT_EQ(deque.back(), 2);
+}
+
+TEST(InlineDeque, Empty_PopHasNoEffect) {
+  InlineDeque<int, 2> deque;
+  deque.pop_back();
+  deque.pop_front();
+  EXPECT_TRUE(deque.empty());
+}
+
+TEST(InlineDeque, WrapsAround) {
+  InlineDeque<int, 4> deque;
+  for (int i = 0; i < 20; ++i) {
+    deque.push_back(i);
+    if (deque.full()) {
+      deque.pop_front();
+    }
+  }
+
+  ASSERT_EQ(deque.size(), 3u);
+  EXPECT_EQ(deque[0], 17);
+  EXPECT_EQ(deque[1], 18);
+  EXPECT_EQ(deque[2], 19);
+}
+
+TEST(InlineDeque, Iterate_AcrossWrap) {
+  InlineDeque<int, 4> deque = {0, 1, 2};
+  deque.pop_front();
+  deque.pop_front();
+  deque.push_back(3);
+  deque.push_back(4);  // Stored at the start of the buffer.
+
+  int expected = 2;
+  for (int value : deque) {
+    EXPECT_EQ(value, expected++);
+  }
+  EXPECT_EQ(expected, 5);
+
+  EXPECT_EQ(deque.end() - deque.begin(), 3);
+  EXPECT_EQ(*(deque.begin() + 2), 4);
+  EXPECT_EQ(*deque.rbegin(), 4);
+  EXPECT_TRUE(std::is_sorted(deque.begin(), deque.end()));
+}
+
+TEST(InlineDeque, ConstIterator) {
+  const InlineDeque<int, 4> deque = {1, 2, 3};
+  InlineDeque<int, 4>::const_iterator it = deque.begin();
+  EXPECT_EQ(*it, 1);
+  EXPECT_EQ(it[2], 3);
+  EXPECT_EQ(std::distance(deque.cbegin(), deque.cend()), 3);
+}
+
+TEST(InlineDeque, Generic_AcceptsAnyCapacity) {
+  InlineDeque<int, 4> small = {1, 2};
+  InlineDeque<int, 16> large = {3, 4, 5};
+
+  auto sum = [](const InlineDeque<int>& deque) {
+    int total = 0;
+    for (int value : deque) {
+      total += value;
+    }
+    return total;
+  };
+  EXPECT_EQ(sum(small), 3);
+  EXPECT_EQ(sum(large), 12);
+
+  InlineDeque<int>& generic = large;
+  generic.push_front(2);
+  EXPECT_EQ(large.front(), 2);
+  EXPECT_EQ(generic.max_size(), 16u);
+}
+
+TEST(InlineDeque, CopyAndCompare) {
+  InlineDeque<int, 4> deque = {1, 2, 3};
+  InlineDeque<int, 8> copy(deque);
+  EXPECT_EQ(deque, copy);
+
+  copy.push_back(4);
+  EXPECT_NE(deque, copy);
+
+  deque = copy;
+  EXPECT_EQ(deque, copy);
+}
+
+TEST(InlineDeque, Move_MovesItems) {
+  Counter::Reset();
+  {
+    InlineDeque<Counter, 4> deque;
+    deque.emplace_back(1);
+    deque.emplace_front(2);
+
+    InlineDeque<Counter, 4> moved(std::move(deque));
+    EXPECT_TRUE(deque.empty());
+    ASSERT_EQ(moved.size(), 2u);
+    EXPECT_EQ(moved.front().value, 2);
+    EXPECT_EQ(moved.back().value, 1);
+    EXPECT_EQ(Counter::moved, 2);
+  }
+  EXPECT_EQ(Counter::created + Counter::moved, Counter::destroyed);
+}
+
+TEST(InlineDeque, Destructor_DestroysItems) {
+  Counter::Reset();
+  {
+    InlineDeque<Counter, 4> deque;
+    deque.emplace_back(1);
+    deque.emplace_back(2);
+    deque.pop_front();
+    deque.emplace_back(3);
+    deque.emplace_back(4);
+    deque.emplace_back(5);  // Wraps around.
+    EXPECT_EQ(Counter::destroyed, 1);
+  }
+  EXPECT_EQ(Counter::created, 5);
+  EXPECT_EQ(Counter::destroyed, 5);
+}
+
+TEST(InlineDeque, ZeroCapacity) {
+  InlineDeque<int, 0> deque;
+  EXPECT_TRUE(deque.empty());
+  EXPECT_TRUE(deque.full());
+  deque.push_back(1);
+  deque.push_front(1);
+  EXPECT_TRUE(deque.empty());
+}
+
+}  // namespace
+}  // namespace pw
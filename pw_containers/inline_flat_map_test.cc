@@ -0,0 +1,161 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/inline_flat_map.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+struct MoveOnly {
+  MoveOnly(int v) : value(v) {}
+  MoveOnly(MoveOnly&&) = default;
+  MoveOnly& operator=(MoveOnly&&) = default;
+
+  int value;
+};
+
+bool IsSorted(const InlineFlatMap<int, int, 16>& map) {
+  return std::is_sorted(
+      map.begin(), map.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+      });
+}
+
+TEST(InlineFlatMap, DefaultConstructed_IsEmpty) {
+  InlineFlatMap<int, int, 4> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.size(), 0u);
+  EXPECT_EQ(map.max_size(), 4u);
+  EXPECT_EQ(map.find(1), map.end());
+  EXPECT_EQ(map.lower_bound(1), map.end());
+}
+
+TEST(InlineFlatMap, Insert_KeepsEntriesSorted) {
+  InlineFlatMap<int, int, 16> map;
+  for (int key : {5, 1, 9, 3, 7, 2}) {
+    EXPECT_TRUE(map.insert({key, key * 10}).second);
+  }
+  EXPECT_TRUE(IsSorted(map));
+  EXPECT_EQ(map.size(), 6u);
+  EXPECT_EQ(map.begin()->first, 1);
+  EXPECT_EQ((map.end() - 1)->first, 9);
+}
+
+TEST(InlineFlatMap, Insert_ExistingKey_DoesNotReplace) {
+  InlineFlatMap<int, int, 4> map = {{1, 10}};
+  auto [it, inserted] = map.insert({1, 20});
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(it->second, 10);
+}
+
+TEST(InlineFlatMap, Full_InsertFails) {
+  InlineFlatMap<int, int, 2> map = {{1, 1}, {2, 2}};
+  auto [it, inserted] = map.insert({3, 3});
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(it, map.end());
+
+  // Existing keys can still be found.
+  EXPECT_FALSE(map.insert({1, 5}).second);
+  EXPECT_EQ(map.at(1), 1);
+}
+
+TEST(InlineFlatMap, Find_EveryKeyAndGap) {
+  InlineFlatMap<int, int, 16> map;
+  for (int key = 0; key < 30; key += 2) {
+    map.insert({key, key});
+  }
+
+  for (int key = -1; key < 31; ++key) {
+    if (key >= 0 && key < 30 && key % 2 == 0) {
+      ASSERT_NE(map.find(key), map.end());
+      EXPECT_EQ(map.find(key)->second, key);
+    } else {
+      EXPECT_EQ(map.find(key), map.end());
+    }
+  }
+}
+
+TEST(InlineFlatMap, Bounds_MatchStandardAlgorithms) {
+  InlineFlatMap<int, int, 16> map = {{1, 0}, {3, 0}, {5, 0}, {7, 0}, {9, 0}};
+  const auto less = [](const auto& entry, int key) { return entry.first < key; };
+  const auto greater = [](int key, const auto& entry) {
+    return key < entry.first;
+  };
+
+  for (int key = 0; key <= 10; ++key) {
+    EXPECT_EQ(map.lower_bound(key),
+              std::lower_bound(map.begin(), map.end(), key, less));
+    EXPECT_EQ(map.upper_bound(key),
+              std::upper_bound(map.begin(), map.end(), key, greater));
+  }
+}
+
+TEST(InlineFlatMap, SubscriptOperator_InsertsDefault) {
+  InlineFlatMap<int, int, 4> map;
+  map[3] += 1;
+  map[3] += 1;
+  map[1] = 5;
+  EXPECT_EQ(map.size(), 2u);
+  EXPECT_EQ(map.at(3), 2);
+  EXPECT_EQ(map.begin()->first, 1);
+}
+
+TEST(InlineFlatMap, InsertOrAssign) {
+  InlineFlatMap<int, int, 4> map;
+  EXPECT_TRUE(map.insert_or_assign(1, 10).second);
+  EXPECT_FALSE(map.insert_or_assign(1, 20).second);
+  EXPECT_EQ(map.at(1), 20);
+}
+
+TEST(InlineFlatMap, Erase) {
+  InlineFlatMap<int, int, 16> map = {{1, 1}, {2, 2}, {3, 3}, {4, 4}};
+  EXPECT_EQ(map.erase(2), 1u);
+  EXPECT_EQ(map.erase(2), 0u);
+  EXPECT_FALSE(map.contains(2));
+  EXPECT_TRUE(IsSorted(map));
+
+  auto it = map.erase(map.find(3));
+  EXPECT_EQ(it->first, 4);
+  EXPECT_EQ(map.size(), 2u);
+}
+
+TEST(InlineFlatMap, EraseWhileIterating) {
+  InlineFlatMap<int, int, 16> map;
+  for (int key = 0; key < 10; ++key) {
+    map.insert({key, key});
+  }
+  for (auto it = map.begin(); it != map.end();) {
+    it = it->first % 3 == 0 ? map.erase(it) : it + 1;
+  }
+  EXPECT_EQ(map.size(), 6u);
+  EXPECT_FALSE(map.contains(0));
+  EXPECT_TRUE(map.contains(1));
+  EXPECT_FALSE(map.contains(9));
+}
+
+TEST(InlineFlatMap, MoveOnlyValues) {
+  InlineFlatMap<int, MoveOnly, 4> map;
+  map.try_emplace(2, 20);
+  map.try_emplace(1, 10);
+  map.erase(1);
+  EXPECT_EQ(map.at(2).value, 20);
+}
+
+}  // namespace
+}  // namespace pw
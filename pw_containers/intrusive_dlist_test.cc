@@ -0,0 +1,202 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/intrusive_dlist.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+class TestItem : public IntrusiveDList<TestItem>::Item {
+ public:
+  TestItem() : number_(0) {}
+  TestItem(int number) : number_(number) {}
+
+  int GetNumber() const { return number_; }
+
+  // Add equality comparison to ensure comparisons are done by identity rather
+  // than equality for the remove function.
+  bool operator==(const TestItem& other) const {
+    return number_ == other.number_;
+  }
+
+ private:
+  int number_;
+};
+
+TEST(IntrusiveDList, Construct_Empty) {
+  IntrusiveDList<TestItem> list;
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(list.size(), 0u);
+  EXPECT_EQ(list.begin(), list.end());
+}
+
+TEST(IntrusiveDList, Construct_InitializerList) {
+  TestItem one(1), two(2), thr(3);
+  IntrusiveDList<TestItem> list({&one, &two, &thr});
+
+  EXPECT_EQ(list.size(), 3u);
+  auto it = list.begin();
+  EXPECT_EQ(&one, &(*it++));
+  EXPECT_EQ(&two, &(*it++));
+  EXPECT_EQ(&thr, &(*it++));
+  EXPECT_EQ(list.end(), it);
+  list.clear();
+}
+
+TEST(IntrusiveDList, Construct_ObjectIterator) {
+  std::array<TestItem, 3> array{{{1}, {2}, {3}}};
+  IntrusiveDList<TestItem> list(array.begin(), array.end());
+
+  EXPECT_EQ(list.size(), 3u);
+  EXPECT_EQ(&list.front(), &array[0]);
+  EXPECT_EQ(&list.back(), &array[2]);
+  list.clear();
+}
+
+TEST(IntrusiveDList, PushBackAndFront) {
+  TestItem one(1), two(2), thr(3);
+  IntrusiveDList<TestItem> list;
+  list.push_back(two);
+  list.push_back(thr);
+  list.push_front(one);
+
+  EXPECT_EQ(list.size(), 3u);
+  int expected = 1;
+  for (const TestItem& item : list) {
+    EXPECT_EQ(item.GetNumber(), expected++);
+  }
+  list.clear();
+}
+
+TEST(IntrusiveDList, ReverseIteration) {
+  TestItem one(1), two(2), thr(3);
+  IntrusiveDList<TestItem> list({&one, &two, &thr});
+
+  int expected = 3;
+  for (auto it = list.rbegin(); it != list.rend(); ++it) {
+    EXPECT_EQ(it->GetNumber(), expected--);
+  }
+  EXPECT_EQ(expected, 0);
+  list.clear();
+}
+
+TEST(IntrusiveDList, PopFrontAndBack) {
+  TestItem one(1), two(2), thr(3);
+  IntrusiveDList<TestItem> list({&one, &two, &thr});
+
+  list.pop_front();
+  EXPECT_EQ(&list.front(), &two);
+  list.pop_back();
+  EXPECT_EQ(&list.back(), &two);
+  EXPECT_EQ(list.size(), 1u);
+
+  // Popped items can be added again.
+  list.push_back(one);
+  list.push_front(thr);
+  EXPECT_EQ(list.size(), 3u);
+  EXPECT_EQ(&list.front(), &thr);
+  EXPECT_EQ(&list.back(), &one);
+  list.clear();
+}
+
+TEST(IntrusiveDList, Insert_BeforePosition) {
+  TestItem one(1), two(2), thr(3);
+  IntrusiveDList<TestItem> list({&one, &thr});
+
+  auto it = list.insert(++list.begin(), two);
+  EXPECT_EQ(&(*it), &two);
+
+  int expected = 1;
+  for (const TestItem& item : list) {
+    EXPECT_EQ(item.GetNumber(), expected++);
+  }
+  list.clear();
+}
+
+TEST(IntrusiveDList, Erase_ReturnsNext) {
+  TestItem one(1), two(2), thr(3);
+  IntrusiveDList<TestItem> list({&one, &two, &thr});
+
+  auto it = list.erase(++list.begin());
+  EXPECT_EQ(&(*it), &thr);
+  EXPECT_EQ(list.size(), 2u);
+  EXPECT_EQ(list.erase(it), list.end());
+  EXPECT_EQ(list.size(), 1u);
+  list.clear();
+}
+
+TEST(IntrusiveDList, Remove_Listed) {
+  TestItem one(1), two(2), thr(3);
+  IntrusiveDList<TestItem> list({&one, &two, &thr});
+
+  EXPECT_TRUE(list.remove(two));
+  EXPECT_EQ(list.size(), 2u);
+  EXPECT_EQ(&list.front(), &one);
+  EXPECT_EQ(&list.back(), &thr);
+
+  EXPECT_TRUE(list.remove(thr));
+  EXPECT_TRUE(list.remove(one));
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(IntrusiveDList, Remove_Unlisted) {
+  TestItem one(1), two(1);
+  IntrusiveDList<TestItem> list({&one});
+
+  // two compares equal to one, but is not in the list.
+  EXPECT_FALSE(list.remove(two));
+  EXPECT_EQ(list.size(), 1u);
+  list.clear();
+}
+
+TEST(IntrusiveDList, Clear_AllowsReinsertion) {
+  TestItem one(1), two(2);
+  IntrusiveDList<TestItem> list({&one, &two});
+  list.clear();
+  EXPECT_TRUE(list.empty());
+
+  IntrusiveDList<TestItem> other({&two, &one});
+  EXPECT_EQ(&other.front(), &two);
+  other.clear();
+}
+
+TEST(IntrusiveDList, ListDestroyedBeforeItems_UnlistsItems) {
+  TestItem one(1);
+  {
+    IntrusiveDList<TestItem> list({&one});
+  }
+  IntrusiveDList<TestItem> list;
+  list.push_back(one);
+  EXPECT_EQ(list.size(), 1u);
+  list.clear();
+}
+
+class Base : public IntrusiveDList<Base>::Item {};
+class Derived : public Base {};
+
+TEST(IntrusiveDList, ListOfDerivedClassItems) {
+  Derived derived;
+  IntrusiveDList<Base> list({&derived});
+  EXPECT_EQ(&list.front(), &derived);
+  list.clear();
+}
+
+}  // namespace
+}  // namespace pw
@@ -0,0 +1,100 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/mpsc_queue.h"
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+// Counts live instances to check that items are constructed and destroyed.
+struct Counted {
+  static int live;
+
+  Counted(int v) : value(v) { live += 1; }
+  Counted(const Counted& other) : value(other.value) { live += 1; }
+  Counted(Counted&& other) : value(other.value) { live += 1; }
+  ~Counted() { live -= 1; }
+
+  int value;
+};
+
+int Counted::live = 0;
+
+TEST(MpscQueue, DefaultConstructed_IsEmpty) {
+  MpscQueue<int, 4> queue;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.size(), 0u);
+  EXPECT_EQ(queue.capacity(), 4u);
+  EXPECT_FALSE(queue.TryPop().has_value());
+}
+
+TEST(MpscQueue, PushPop_FirstInFirstOut) {
+  MpscQueue<int, 4> queue;
+  EXPECT_TRUE(queue.TryPush(1));
+  EXPECT_TRUE(queue.TryPush(2));
+  EXPECT_TRUE(queue.TryEmplace(3));
+  EXPECT_EQ(queue.size(), 3u);
+
+  EXPECT_EQ(queue.TryPop(), 1);
+  EXPECT_EQ(queue.TryPop(), 2);
+  EXPECT_EQ(queue.TryPop(), 3);
+  EXPECT_FALSE(queue.TryPop().has_value());
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueue, Full_PushFails) {
+  MpscQueue<int, 4> queue;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.TryPush(i));
+  }
+  EXPECT_FALSE(queue.TryPush(4));
+  EXPECT_EQ(queue.size(), 4u);
+
+  EXPECT_EQ(queue.TryPop(), 0);
+  EXPECT_TRUE(queue.TryPush(4));
+  EXPECT_FALSE(queue.TryPush(5));
+}
+
+TEST(MpscQueue, WrapsAround) {
+  MpscQueue<int, 4> queue;
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(queue.TryPush(i));
+    ASSERT_TRUE(queue.TryPush(i + 1000));
+    ASSERT_EQ(queue.TryPop(), i);
+    ASSERT_EQ(queue.TryPop(), i + 1000);
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueue, Items_ConstructedAndDestroyed) {
+  Counted::live = 0;
+  {
+    MpscQueue<Counted, 8> queue;
+    queue.TryEmplace(1);
+    queue.TryPush(Counted(2));
+    queue.TryEmplace(3);
+    EXPECT_EQ(Counted::live, 3);
+
+    std::optional<Counted> item = queue.TryPop();
+    ASSERT_TRUE(item.has_value());
+    EXPECT_EQ(item->value, 1);
+    EXPECT_EQ(Counted::live, 3);  // Two queued and one popped.
+  }
+  EXPECT_EQ(Counted::live, 0);
+}
+
+}  // namespace
+}  // namespace pw
@@ -0,0 +1,62 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/notifying_queue.h"
+
+#include "gtest/gtest.h"
+#include "pw_containers/mpsc_queue.h"
+#include "pw_containers/spsc_queue.h"
+
+namespace pw {
+namespace {
+
+TEST(NotifyingQueue, Pop_ReturnsQueuedItem) {
+  NotifyingQueue<SpscQueue<int, 4>> queue;
+  ASSERT_TRUE(queue.TryPush(1));
+  ASSERT_TRUE(queue.TryEmplace(2));
+  EXPECT_EQ(queue.size(), 2u);
+
+  EXPECT_EQ(queue.Pop(), 1);
+  EXPECT_EQ(queue.Pop(), 2);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(NotifyingQueue, Pop_ConsumesStaleNotification) {
+  NotifyingQueue<MpscQueue<int, 4>> queue;
+  ASSERT_TRUE(queue.TryPush(1));
+  ASSERT_TRUE(queue.TryPush(2));
+
+  // Both pushes released the notification, which latched once. The first Pop
+  // does not consume it, so the second Pop finds an item without blocking.
+  EXPECT_EQ(queue.TryPop(), 1);
+  EXPECT_EQ(queue.Pop(), 2);
+
+  // The next Pop consumes the stale notification, finds no item, and would
+  // block; push an item first so it returns.
+  ASSERT_TRUE(queue.TryPush(3));
+  EXPECT_EQ(queue.Pop(), 3);
+}
+
+TEST(NotifyingQueue, Full_PushFails) {
+  NotifyingQueue<SpscQueue<int, 2>> queue;
+  EXPECT_TRUE(queue.TryPush(1));
+  EXPECT_TRUE(queue.TryPush(2));
+  EXPECT_FALSE(queue.TryPush(3));
+  EXPECT_EQ(queue.TryPop(), 1);
+  EXPECT_EQ(queue.TryPop(), 2);
+  EXPECT_FALSE(queue.TryPop().has_value());
+}
+
+}  // namespace
+}  // namespace pw
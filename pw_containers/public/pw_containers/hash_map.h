@@ -0,0 +1,343 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "pw_assert/assert.h"
+
+namespace pw {
+
+// A fixed-capacity hash map that stores its entries inline, without heap
+// allocation. Lookups, insertions, and removals are O(1) on average.
+//
+// Entries are stored in an open-addressed table of kCapacity slots using
+// Robin Hood linear probing: an entry that is being inserted takes the slot of
+// any entry that is closer to its home slot, so probe sequences stay short and
+// lookups for missing keys stop as soon as they pass where the key would be.
+// Removal shifts the following entries back rather than leaving tombstones, so
+// performance does not degrade as entries are added and removed.
+//
+// The map holds up to kCapacity entries, but probe sequences grow as the table
+// fills. Choose kCapacity about 25% larger than the expected number of
+// entries. Insertions into a full map fail; operator[] asserts.
+//
+// Inserting or removing an entry may move other entries, which invalidates
+// all iterators and references to entries.
+//
+//   pw::HashMap<uint32_t, Channel*, 16> channels;
+//   channels.insert({channel.id(), &channel});
+//
+//   if (auto it = channels.find(id); it != channels.end()) {
+//     it->second->Send(packet);
+//   }
+//
+template <typename Key,
+          typename Value,
+          size_t kCapacity,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class HashMap {
+ public:
+  static_assert(kCapacity > 0u, "A HashMap must have at least one slot");
+
+  using key_type = Key;
+  using mapped_type = Value;
+  // Keys are stored mutably so that entries can be moved within the table.
+  // They must not be modified through iterators.
+  using value_type = std::pair<Key, Value>;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+
+  template <typename Map, typename Entry>
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = HashMap::value_type;
+    using difference_type = ptrdiff_t;
+    using pointer = Entry*;
+    using reference = Entry&;
+
+    constexpr Iterator() : map_(nullptr), index_(0) {}
+
+    // Allow conversion from iterator to const_iterator.
+    template <typename OtherMap, typename OtherEntry>
+    constexpr Iterator(const Iterator<OtherMap, OtherEntry>& other)
+        : map_(other.map_), index_(other.index_) {}
+
+    reference operator*() const { return map_->entry(index_); }
+    pointer operator->() const { return &map_->entry(index_); }
+
+    Iterator& operator++() {
+      index_ = map_->NextOccupied(index_ + 1);
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator previous = *this;
+      operator++();
+      return previous;
+    }
+
+    bool operator==(const Iterator& rhs) const { return index_ == rhs.index_; }
+    bool operator!=(const Iterator& rhs) const { return index_ != rhs.index_; }
+
+   private:
+    friend class HashMap;
+    template <typename, typename>
+    friend class Iterator;
+
+    constexpr Iterator(Map* map, size_t index) : map_(map), index_(index) {}
+
+    Map* map_;
+    size_t index_;
+  };
+
+  using iterator = Iterator<HashMap, value_type>;
+  using const_iterator = Iterator<const HashMap, const value_type>;
+
+  HashMap() : size_(0), distances_{} {}
+
+  HashMap(std::initializer_list<value_type> entries) : HashMap() {
+    for (const value_type& entry : entries) {
+      insert(entry);
+    }
+  }
+
+  HashMap(const HashMap&) = delete;
+  HashMap& operator=(const HashMap&) = delete;
+
+  ~HashMap() { clear(); }
+
+  // Capacity.
+  size_type size() const { return size_; }
+  bool empty() const { return size_ == 0u; }
+  bool full() const { return size_ == kCapacity; }
+  static constexpr size_type max_size() { return kCapacity; }
+  static constexpr size_type capacity() { return kCapacity; }
+
+  // Iterators. Entries are visited in table order, not insertion order.
+  iterator begin() { return iterator(this, NextOccupied(0)); }
+  const_iterator begin() const { return cbegin(); }
+  const_iterator cbegin() const { return const_iterator(this, NextOccupied(0)); }
+
+  iterator end() { return iterator(this, kCapacity); }
+  const_iterator end() const { return cend(); }
+  const_iterator cend() const { return const_iterator(this, kCapacity); }
+
+  // Lookup.
+  iterator find(const key_type& key) { return iterator(this, Find(key)); }
+  const_iterator find(const key_type& key) const {
+    return const_iterator(this, Find(key));
+  }
+
+  bool contains(const key_type& key) const { return Find(key) != kCapacity; }
+  size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+  // Returns the value for a key, inserting a default-constructed value if the
+  // key is not present. Asserts if the key is not present and the map is full.
+  mapped_type& operator[](const key_type& key) {
+    auto [it, inserted] = try_emplace(key);
+    PW_ASSERT(it != end());
+    return it->second;
+  }
+
+  // Modifiers. If the map is full and the key is not present, insertions
+  // return {end(), false}.
+  std::pair<iterator, bool> insert(const value_type& entry) {
+    return try_emplace(entry.first, entry.second);
+  }
+
+  std::pair<iterator, bool> insert(value_type&& entry) {
+    return try_emplace(std::move(entry.first), std::move(entry.second));
+  }
+
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& value) {
+    auto result = try_emplace(key, std::forward<M>(value));
+    if (!result.second && result.first != end()) {
+      result.first->second = std::forward<M>(value);
+    }
+    return result;
+  }
+
+  // Constructs the value in place if the key is not present.
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+    if (const size_t index = Find(key); index != kCapacity) {
+      return {iterator(this, index), false};
+    }
+    if (full()) {
+      return {end(), false};
+    }
+
+    const size_t index = MakeRoom(Home(key));
+    new (&storage_[index]) value_type(
+        std::piecewise_construct,
+        std::forward_as_tuple(std::forward<K>(key)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+    size_ += 1;
+    return {iterator(this, index), true};
+  }
+
+  // Removes the entry with this key, if any. Returns the number removed.
+  size_type erase(const key_type& key) {
+    const size_t index = Find(key);
+    if (index == kCapacity) {
+      return 0;
+    }
+    Remove(index);
+    return 1;
+  }
+
+  // Removes an entry. Returns an iterator to the entry that followed it, so
+  // entries can be removed while iterating. An entry that shifts from the
+  // start of the table to its end may be visited twice, so loops that erase
+  // some entries must not depend on visiting each remaining entry only once.
+  iterator erase(const_iterator position) {
+    const size_t index = position.index_;
+    Remove(index);
+
+    // The next entry may have shifted into the removed entry's slot.
+    return iterator(this, NextOccupied(index));
+  }
+
+  void clear() {
+    for (size_t i = 0; i < kCapacity; ++i) {
+      if (distances_[i] != kEmpty) {
+        entry(i).~value_type();
+        distances_[i] = kEmpty;
+      }
+    }
+    size_ = 0;
+  }
+
+ private:
+  // Each slot's distance from the entry's home slot, plus one. 0 marks an
+  // empty slot.
+  using Distance = std::conditional_t<
+      (kCapacity < 0xFF),
+      uint8_t,
+      std::conditional_t<(kCapacity < 0xFFFF), uint16_t, size_t>>;
+
+  static constexpr Distance kEmpty = 0;
+
+  static constexpr size_t Next(size_t index) {
+    return index + 1 == kCapacity ? 0 : index + 1;
+  }
+
+  size_t Home(const key_type& key) const { return Hash{}(key) % kCapacity; }
+
+  value_type& entry(size_t index) {
+    return *std::launder(reinterpret_cast<value_type*>(&storage_[index]));
+  }
+  const value_type& entry(size_t index) const {
+    return *std::launder(reinterpret_cast<const value_type*>(&storage_[index]));
+  }
+
+  size_t NextOccupied(size_t index) const {
+    while (index < kCapacity && distances_[index] == kEmpty) {
+      index += 1;
+    }
+    return index;
+  }
+
+  // Returns the key's slot, or kCapacity if it is not present.
+  size_t Find(const key_type& key) const {
+    size_t index = Home(key);
+
+    // Entries are ordered by home slot, so the search ends at the first slot
+    // whose entry is closer to its home than the key would be to its own.
+    for (size_t distance = 1; distance <= kCapacity; ++distance) {
+      if (distances_[index] < distance) {
+        break;
+      }
+      if (KeyEqual{}(entry(index).first, key)) {
+        return index;
+      }
+      index = Next(index);
+    }
+    return kCapacity;
+  }
+
+  // Frees the slot for a new key with the given home slot and returns it. The
+  // entries from that slot to the next empty slot each move forward by one.
+  // The map must not be full.
+  size_t MakeRoom(size_t home) {
+    size_t index = home;
+    Distance distance = 1;
+    while (distances_[index] >= distance) {
+      index = Next(index);
+      distance += 1;
+    }
+    const size_t position = index;
+    const Distance position_distance = distance;
+
+    size_t empty = position;
+    while (distances_[empty] != kEmpty) {
+      empty = Next(empty);
+    }
+
+    while (empty != position) {
+      const size_t previous = empty == 0 ? kCapacity - 1 : empty - 1;
+      new (&storage_[empty]) value_type(std::move(entry(previous)));
+      entry(previous).~value_type();
+      distances_[empty] = distances_[previous] + 1;
+      empty = previous;
+    }
+
+    distances_[position] = position_distance;
+    return position;
+  }
+
+  // Destroys the entry at index and shifts the following entries that are
+  // not in their home slots back by one.
+  void Remove(size_t index) {
+    entry(index).~value_type();
+    size_ -= 1;
+
+    size_t next = Next(index);
+    while (distances_[next] > 1) {
+      new (&storage_[index]) value_type(std::move(entry(next)));
+      entry(next).~value_type();
+      distances_[index] = distances_[next] - 1;
+      index = next;
+      next = Next(next);
+    }
+    distances_[index] = kEmpty;
+  }
+
+  size_t size_;
+  std::array<Distance, kCapacity> distances_;
+  std::array<std::aligned_storage_t<sizeof(value_type), alignof(value_type)>,
+             kCapacity>
+      storage_;
+};
+
+}  // namespace pw
@@ -0,0 +1,479 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "pw_assert/assert.h"
+#include "pw_polyfill/language_feature_macros.h"
+
+namespace pw {
+namespace inline_deque_impl {
+
+// Used as kCapacity in the generic-capacity InlineDeque<T> interface.
+PW_INLINE_VARIABLE constexpr size_t kGeneric = size_t(-1);
+
+}  // namespace inline_deque_impl
+
+template <typename T, size_t kCapacity = inline_deque_impl::kGeneric>
+class InlineDeque;
+
+namespace inline_deque_impl {
+
+// Makes InlineDeque<T> trivially destructible if T is.
+template <typename DequeClass, bool kIsTriviallyDestructible>
+class DestructorHelper;
+
+template <typename DequeClass>
+class DestructorHelper<DequeClass, true> {
+ public:
+  ~DestructorHelper() = default;
+};
+
+template <typename DequeClass>
+class DestructorHelper<DequeClass, false> {
+ public:
+  ~DestructorHelper() { static_cast<DequeClass*>(this)->clear(); }
+};
+
+// Random access iterator over an InlineDeque. Stores the deque and a logical
+// index, so it remains valid as the deque's storage wraps around.
+template <typename Deque, typename Value>
+class Iterator {
+ public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = std::remove_const_t<Value>;
+  using pointer = Value*;
+  using reference = Value&;
+  using iterator_category = std::random_access_iterator_tag;
+
+  constexpr Iterator() : deque_(nullptr), index_(0) {}
+
+  // Allows converting an iterator to a const_iterator.
+  template <typename OtherDeque, typename OtherValue>
+  constexpr Iterator(const Iterator<OtherDeque, OtherValue>& other)
+      : deque_(other.deque_), index_(other.index_) {}
+
+  reference operator*() const { return (*deque_)[index_]; }
+  pointer operator->() const { return &(*deque_)[index_]; }
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  Iterator& operator++() {
+    index_ += 1;
+    return *this;
+  }
+  Iterator operator++(int) {
+    Iterator previous = *this;
+    operator++();
+    return previous;
+  }
+  Iterator& operator--() {
+    index_ -= 1;
+    return *this;
+  }
+  Iterator operator--(int) {
+    Iterator previous = *this;
+    operator--();
+    return previous;
+  }
+
+  Iterator& operator+=(difference_type n) {
+    index_ += n;
+    return *this;
+  }
+  Iterator& operator-=(difference_type n) {
+    index_ -= n;
+    return *this;
+  }
+  friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+  friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+  friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+  friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) {
+    return static_cast<difference_type>(lhs.index_) -
+           static_cast<difference_type>(rhs.index_);
+  }
+
+  friend bool operator==(const Iterator& lhs, const Iterator& rhs) {
+    return lhs.index_ == rhs.index_;
+  }
+  friend bool operator!=(const Iterator& lhs, const Iterator& rhs) {
+    return lhs.index_ != rhs.index_;
+  }
+  friend bool operator<(const Iterator& lhs, const Iterator& rhs) {
+    return lhs.index_ < rhs.index_;
+  }
+  friend bool operator>(const Iterator& lhs, const Iterator& rhs) {
+    return rhs < lhs;
+  }
+  friend bool operator<=(const Iterator& lhs, const Iterator& rhs) {
+    return !(rhs < lhs);
+  }
+  friend bool operator>=(const Iterator& lhs, const Iterator& rhs) {
+    return !(lhs < rhs);
+  }
+
+ private:
+  template <typename, typename>
+  friend class Iterator;
+
+  template <typename, size_t>
+  friend class ::pw::InlineDeque;
+
+  constexpr Iterator(Deque* deque, size_t index)
+      : deque_(deque), index_(index) {}
+
+  Deque* deque_;
+  size_t index_;
+};
+
+}  // namespace inline_deque_impl
+
+// InlineDeque is a double-ended queue backed by a fixed-size circular buffer,
+// similar to std::deque. Items can be added to or removed from either end in
+// O(1). Like pw::Vector, deques are declared with an explicit capacity (e.g.
+// InlineDeque<int, 10>) but can be used and referred to without it (e.g.
+// InlineDeque<int>), so functions can accept deques of any capacity.
+//
+// As with pw::Vector, adding an item to a full deque or removing an item from
+// an empty deque has no effect. Check full() or empty() first.
+template <typename T, size_t kCapacity>
+class InlineDeque : public InlineDeque<T, inline_deque_impl::kGeneric> {
+ private:
+  using Base = InlineDeque<T, inline_deque_impl::kGeneric>;
+
+ public:
+  using typename Base::const_iterator;
+  using typename Base::const_pointer;
+  using typename Base::const_reference;
+  using typename Base::difference_type;
+  using typename Base::iterator;
+  using typename Base::pointer;
+  using typename Base::reference;
+  using typename Base::size_type;
+  using typename Base::value_type;
+
+  // Construct
+  InlineDeque() noexcept : Base(kCapacity) {}
+
+  InlineDeque(size_type count, const T& value) : Base(kCapacity) {
+    this->Append(count, value);
+  }
+
+  explicit InlineDeque(size_type count) : InlineDeque(count, T()) {}
+
+  InlineDeque(const InlineDeque& other) : Base(kCapacity) {
+    this->CopyFrom(other);
+  }
+
+  template <size_t kOtherCapacity>
+  InlineDeque(const InlineDeque<T, kOtherCapacity>& other) : Base(kCapacity) {
+    this->CopyFrom(other);
+  }
+
+  InlineDeque(InlineDeque&& other) noexcept : Base(kCapacity) {
+    this->MoveFrom(other);
+  }
+
+  template <size_t kOtherCapacity>
+  InlineDeque(InlineDeque<T, kOtherCapacity>&& other) noexcept
+      : Base(kCapacity) {
+    this->MoveFrom(other);
+  }
+
+  InlineDeque(std::initializer_list<T> list) : Base(kCapacity) {
+    this->CopyFrom(list);
+  }
+
+  InlineDeque& operator=(const InlineDeque& other) {
+    Base::operator=(other);
+    return *this;
+  }
+
+  template <size_t kOtherCapacity>
+  InlineDeque& operator=(const InlineDeque<T, kOtherCapacity>& other) {
+    Base::operator=(other);
+    return *this;
+  }
+
+  InlineDeque& operator=(InlineDeque&& other) noexcept {
+    Base::operator=(std::move(other));
+    return *this;
+  }
+
+  template <size_t kOtherCapacity>
+  InlineDeque& operator=(InlineDeque<T, kOtherCapacity>&& other) noexcept {
+    Base::operator=(std::move(other));
+    return *this;
+  }
+
+  InlineDeque& operator=(std::initializer_list<T> list) {
+    Base::operator=(list);
+    return *this;
+  }
+
+  // All other deque methods are implemented on the InlineDeque<T> base class.
+
+ private:
+  friend class InlineDeque<T, inline_deque_impl::kGeneric>;
+
+  static_assert(kCapacity <= std::numeric_limits<size_type>::max());
+
+  // Provides access to the underlying array as an array of T.
+  pointer array() { return std::launder(reinterpret_cast<T*>(&array_)); }
+  const_pointer array() const {
+    return std::launder(reinterpret_cast<const T*>(&array_));
+  }
+
+  // Items are stored as uninitialized memory aligned for the type, and are
+  // constructed on demand with placement new. std::array supports a capacity
+  // of zero, which the generic class relies on.
+  alignas(T) std::array<std::aligned_storage_t<sizeof(T), alignof(T)>,
+                        kCapacity> array_;
+};
+
+// Defines the generic-capacity InlineDeque<T> specialization, which serves as
+// the base class for InlineDeque<T> of any capacity. Except for constructors,
+// all InlineDeque methods are implemented on this class.
+template <typename T>
+class InlineDeque<T, inline_deque_impl::kGeneric>
+    : public inline_deque_impl::DestructorHelper<
+          InlineDeque<T, inline_deque_impl::kGeneric>,
+          std::is_trivially_destructible<T>::value> {
+ public:
+  using value_type = T;
+
+  // Like pw::Vector, use unsigned short rather than size_t to keep the
+  // bookkeeping small. Deques are statically allocated, so 65535 items is a
+  // reasonable limit.
+  using size_type = unsigned short;
+
+  using difference_type = ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = inline_deque_impl::Iterator<InlineDeque, T>;
+  using const_iterator =
+      inline_deque_impl::Iterator<const InlineDeque, const T>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // A deque without an explicit capacity (InlineDeque<T>) cannot be
+  // constructed directly. Instead, construct an InlineDeque<T, kCapacity>.
+  // Deques of any capacity can be used through an InlineDeque<T> pointer or
+  // reference.
+
+  // Assign
+
+  InlineDeque& operator=(const InlineDeque& other) {
+    if (&other != this) {
+      clear();
+      CopyFrom(other);
+    }
+    return *this;
+  }
+
+  InlineDeque& operator=(InlineDeque&& other) noexcept {
+    if (&other != this) {
+      clear();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  InlineDeque& operator=(std::initializer_list<T> list) {
+    clear();
+    CopyFrom(list);
+    return *this;
+  }
+
+  // Access
+
+  reference at(size_type index) {
+    PW_ASSERT(index < size());
+    return (*this)[index];
+  }
+  const_reference at(size_type index) const {
+    PW_ASSERT(index < size());
+    return (*this)[index];
+  }
+
+  reference operator[](size_type index) {
+    PW_DASSERT(index < size());
+    return data()[PhysicalIndex(index)];
+  }
+  const_reference operator[](size_type index) const {
+    PW_DASSERT(index < size());
+    return data()[PhysicalIndex(index)];
+  }
+
+  reference front() { return (*this)[0]; }
+  const_reference front() const { return (*this)[0]; }
+
+  reference back() { return (*this)[size() - 1]; }
+  const_reference back() const { return (*this)[size() - 1]; }
+
+  // Iterate
+
+  iterator begin() noexcept { return iterator(this, 0); }
+  const_iterator begin() const noexcept { return cbegin(); }
+  const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+
+  iterator end() noexcept { return iterator(this, size()); }
+  const_iterator end() const noexcept { return cend(); }
+  const_iterator cend() const noexcept { return const_iterator(this, size()); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const { return crbegin(); }
+  const_reverse_iterator crbegin() const noexcept {
+    return const_reverse_iterator(cend());
+  }
+
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const { return crend(); }
+  const_reverse_iterator crend() const noexcept {
+    return const_reverse_iterator(cbegin());
+  }
+
+  // Size
+
+  [[nodiscard]] bool empty() const noexcept { return size() == 0u; }
+
+  // True if there is no free space in the deque. Operations that add items
+  // have no effect if full() is true.
+  [[nodiscard]] bool full() const noexcept { return size() == max_size(); }
+
+  size_t size() const noexcept { return size_; }
+
+  // Returns the maximum number of items in this deque.
+  size_t max_size() const noexcept { return capacity_; }
+
+  size_t capacity() const noexcept { return max_size(); }
+
+  // Modify
+
+  void clear() noexcept {
+    while (!empty()) {
+      pop_back();
+    }
+    head_ = 0;
+  }
+
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  template <typename... Args>
+  void emplace_back(Args&&... args) {
+    if (!full()) {
+      new (&data()[PhysicalIndex(size_)]) T(std::forward<Args>(args)...);
+      size_ += 1;
+    }
+  }
+
+  void pop_back() {
+    if (!empty()) {
+      back().~T();
+      size_ -= 1;
+    }
+  }
+
+  void push_front(const T& value) { emplace_front(value); }
+  void push_front(T&& value) { emplace_front(std::move(value)); }
+
+  template <typename... Args>
+  void emplace_front(Args&&... args) {
+    if (!full()) {
+      const size_type new_head = head_ == 0u ? capacity_ - 1 : head_ - 1;
+      new (&data()[new_head]) T(std::forward<Args>(args)...);
+      head_ = new_head;
+      size_ += 1;
+    }
+  }
+
+  void pop_front() {
+    if (!empty()) {
+      front().~T();
+      head_ = head_ + 1 == capacity_ ? 0 : head_ + 1;
+      size_ -= 1;
+    }
+  }
+
+ protected:
+  explicit constexpr InlineDeque(size_type capacity) noexcept
+      : capacity_(capacity), head_(0), size_(0) {}
+
+  template <typename Container>
+  void CopyFrom(const Container& other) {
+    for (const T& item : other) {
+      push_back(item);
+    }
+  }
+
+  void MoveFrom(InlineDeque& other) noexcept {
+    for (T& item : other) {
+      emplace_back(std::move(item));
+    }
+    other.clear();
+  }
+
+  void Append(size_type count, const T& value) {
+    for (size_type i = 0; i < count; ++i) {
+      push_back(value);
+    }
+  }
+
+ private:
+  // The storage is not part of the generic-capacity class. It is provided by
+  // the derived class from which this instance was constructed, and starts at
+  // the same offset for every capacity, so down-cast to a deque with a known
+  // capacity to access it.
+  T* data() noexcept { return static_cast<InlineDeque<T, 0>*>(this)->array(); }
+  const T* data() const noexcept {
+    return static_cast<const InlineDeque<T, 0>*>(this)->array();
+  }
+
+  // Maps an index from the front of the deque to an index in the storage.
+  size_t PhysicalIndex(size_t index) const {
+    const size_t physical = head_ + index;
+    return physical < capacity_ ? physical : physical - capacity_;
+  }
+
+  const size_type capacity_;
+  size_type head_;  // Storage index of the first item.
+  size_type size_;
+};
+
+// Compare
+
+template <typename T, size_t kLhsCapacity, size_t kRhsCapacity>
+bool operator==(const InlineDeque<T, kLhsCapacity>& lhs,
+                const InlineDeque<T, kRhsCapacity>& rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename T, size_t kLhsCapacity, size_t kRhsCapacity>
+bool operator!=(const InlineDeque<T, kLhsCapacity>& lhs,
+                const InlineDeque<T, kRhsCapacity>& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace pw
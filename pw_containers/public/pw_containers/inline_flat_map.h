@@ -0,0 +1,215 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+#include "pw_assert/assert.h"
+#include "pw_containers/vector.h"
+
+namespace pw {
+
+// A fixed-capacity associative container that keeps its entries sorted by key
+// in contiguous inline storage, similar to a sorted std::vector of pairs.
+//
+// Lookups use a branchless binary search, so they are O(log n) and take the
+// same number of steps for every key of a given map size. Iteration visits
+// entries in key order and touches memory sequentially. Inserting and erasing
+// shift the entries that follow, so they are O(n); this suits maps that are
+// read much more often than they are changed, such as routing or dispatch
+// tables.
+//
+// Entries are std::pair<Key, Value>. Keys must not be modified through
+// iterators, since that would break the sort order.
+//
+// Unlike pw::containers::FlatMap, which is sorted once at construction and
+// cannot be modified, InlineFlatMap supports insertion and removal.
+template <typename Key, typename Value, size_t kCapacity>
+class InlineFlatMap {
+ public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<Key, Value>;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using iterator = value_type*;
+  using const_iterator = const value_type*;
+
+  InlineFlatMap() = default;
+
+  // Inserts the entries in order. Later entries with a duplicate key are
+  // ignored, as are entries that do not fit.
+  InlineFlatMap(std::initializer_list<value_type> entries) {
+    for (const value_type& entry : entries) {
+      insert(entry);
+    }
+  }
+
+  // Capacity
+
+  [[nodiscard]] bool empty() const { return entries_.empty(); }
+  [[nodiscard]] bool full() const { return entries_.full(); }
+  size_type size() const { return entries_.size(); }
+  static constexpr size_type max_size() { return kCapacity; }
+  static constexpr size_type capacity() { return kCapacity; }
+
+  // Iterators
+
+  iterator begin() { return entries_.begin(); }
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator cbegin() const { return entries_.cbegin(); }
+  iterator end() { return entries_.end(); }
+  const_iterator end() const { return entries_.end(); }
+  const_iterator cend() const { return entries_.cend(); }
+
+  // Lookup
+
+  iterator find(const key_type& key) {
+    return const_cast<iterator>(std::as_const(*this).find(key));
+  }
+  const_iterator find(const key_type& key) const {
+    const_iterator it = lower_bound(key);
+    return it != end() && !(key < it->first) ? it : end();
+  }
+
+  bool contains(const key_type& key) const { return find(key) != end(); }
+  size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+  // Returns the first entry whose key is not less than the given key.
+  iterator lower_bound(const key_type& key) {
+    return const_cast<iterator>(std::as_const(*this).lower_bound(key));
+  }
+  const_iterator lower_bound(const key_type& key) const {
+    return LowerBound(entries_.data(), entries_.size(), key);
+  }
+
+  // Returns the first entry whose key is greater than the given key.
+  iterator upper_bound(const key_type& key) {
+    return const_cast<iterator>(std::as_const(*this).upper_bound(key));
+  }
+  const_iterator upper_bound(const key_type& key) const {
+    const_iterator it = lower_bound(key);
+    return it != end() && !(key < it->first) ? it + 1 : it;
+  }
+
+  // Returns the value for a key, which must be present.
+  mapped_type& at(const key_type& key) {
+    return const_cast<mapped_type&>(std::as_const(*this).at(key));
+  }
+  const mapped_type& at(const key_type& key) const {
+    const_iterator it = find(key);
+    PW_ASSERT(it != end());
+    return it->second;
+  }
+
+  // Returns the value for a key, inserting a default-constructed value if the
+  // key is not present. The map must not be full if the key is not present.
+  mapped_type& operator[](const key_type& key) {
+    auto [it, inserted] = try_emplace(key);
+    PW_ASSERT(it != end());
+    return it->second;
+  }
+
+  // Modify
+
+  // Inserts an entry if its key is not already present. Returns an iterator to
+  // the entry with the key and whether it was inserted. If the key is not
+  // present and the map is full, returns end() and false.
+  std::pair<iterator, bool> insert(const value_type& entry) {
+    return try_emplace(entry.first, entry.second);
+  }
+  std::pair<iterator, bool> insert(value_type&& entry) {
+    return try_emplace(std::move(entry.first), std::move(entry.second));
+  }
+
+  // Inserts an entry or assigns to the value of an existing entry.
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& value) {
+    auto result = try_emplace(key, std::forward<M>(value));
+    if (!result.second && result.first != end()) {
+      result.first->second = std::forward<M>(value);
+    }
+    return result;
+  }
+
+  // Constructs a value from args if the key is not already present.
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+    iterator it = lower_bound(key);
+    if (it != end() && !(key < it->first)) {
+      return {it, false};
+    }
+    if (full()) {
+      return {end(), false};
+    }
+
+    // pw::Vector does not support insertion in the middle yet, so append the
+    // entry and rotate it into place.
+    const difference_type index = it - begin();
+    entries_.emplace_back(std::piecewise_construct,
+                          std::forward_as_tuple(std::forward<K>(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+    std::rotate(begin() + index, end() - 1, end());
+    return {begin() + index, true};
+  }
+
+  // Removes the entry with the key, if present. Returns the number removed.
+  size_type erase(const key_type& key) {
+    iterator it = find(key);
+    if (it == end()) {
+      return 0;
+    }
+    erase(it);
+    return 1;
+  }
+
+  // Removes an entry. Returns an iterator to the entry that followed it.
+  iterator erase(const_iterator position) {
+    iterator it = begin() + (position - cbegin());
+    std::move(it + 1, end(), it);
+    entries_.pop_back();
+    return it;
+  }
+
+  void clear() { entries_.clear(); }
+
+ private:
+  // Branchless lower bound: halves the range each step with a conditional move
+  // rather than a branch, so lookups have no mispredicted branches and always
+  // take ceil(log2(size)) + 1 comparisons.
+  static const_iterator LowerBound(const_iterator base,
+                                   size_t size,
+                                   const key_type& key) {
+    if (size == 0u) {
+      return base;
+    }
+    while (size > 1u) {
+      const size_t half = size / 2;
+      base = base[half].first < key ? base + half : base;
+      size -= half;
+    }
+    return base + (base->first < key ? 1 : 0);
+  }
+
+  Vector<value_type, kCapacity> entries_;
+};
+
+}  // namespace pw
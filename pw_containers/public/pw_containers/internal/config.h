@@ -0,0 +1,24 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+// The size of a cache line, in bytes. Lock-free queues align the state written
+// by producers and the state written by the consumer to separate cache lines,
+// so that each side does not invalidate the other's cached data.
+//
+// Targets without a data cache, such as most Cortex-M0/M3/M4 devices, may set
+// this to alignof(std::max_align_t) or the word size to save RAM.
+#ifndef PW_CONTAINERS_CACHE_LINE_SIZE
+#define PW_CONTAINERS_CACHE_LINE_SIZE 64
+#endif  // PW_CONTAINERS_CACHE_LINE_SIZE
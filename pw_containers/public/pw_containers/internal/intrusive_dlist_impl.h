@@ -0,0 +1,188 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace pw {
+
+template <typename>
+class IntrusiveDList;
+
+namespace intrusive_dlist_impl {
+
+template <typename T, typename I>
+class Iterator {
+ public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = std::remove_cv_t<T>;
+  using pointer = T*;
+  using reference = T&;
+  using iterator_category = std::bidirectional_iterator_tag;
+
+  constexpr explicit Iterator() : item_(nullptr) {}
+
+  constexpr Iterator& operator++() {
+    item_ = static_cast<I*>(item_->next_);
+    return *this;
+  }
+
+  constexpr Iterator operator++(int) {
+    Iterator previous_value(item_);
+    operator++();
+    return previous_value;
+  }
+
+  constexpr Iterator& operator--() {
+    item_ = static_cast<I*>(item_->prev_);
+    return *this;
+  }
+
+  constexpr Iterator operator--(int) {
+    Iterator next_value(item_);
+    operator--();
+    return next_value;
+  }
+
+  constexpr T& operator*() const { return *static_cast<T*>(item_); }
+  constexpr T* operator->() const { return static_cast<T*>(item_); }
+
+  template <typename U, typename J>
+  constexpr bool operator==(const Iterator<U, J>& rhs) const {
+    return item_ == rhs.item_;
+  }
+
+  template <typename U, typename J>
+  constexpr bool operator!=(const Iterator<U, J>& rhs) const {
+    return item_ != rhs.item_;
+  }
+
+ private:
+  template <typename, typename>
+  friend class Iterator;
+
+  template <typename>
+  friend class ::pw::IntrusiveDList;
+
+  // Only allow IntrusiveDList to create iterators that point to something.
+  constexpr explicit Iterator(I* item) : item_{item} {}
+
+  I* item_;
+};
+
+class List {
+ public:
+  class Item {
+   protected:
+    constexpr Item() : next_(this), prev_(this) {}
+
+    // Items must be removed from their list before they are destroyed. The
+    // list's size is cached, and an item cannot update it without knowing its
+    // list.
+    ~Item();
+
+   private:
+    friend class List;
+
+    template <typename T, typename I>
+    friend class Iterator;
+
+    bool unlisted() const { return this == next_; }
+
+    // Unlisted items are self-cycles (next_ == prev_ == this).
+    Item* next_;
+    Item* prev_;
+  };
+
+  constexpr List() : size_(0) {}
+
+  template <typename Iterator>
+  List(Iterator first, Iterator last) : List() {
+    AssignFromIterator(first, last);
+  }
+
+  // Intrusive lists cannot be copied, since each Item can only be in one list.
+  List(const List&) = delete;
+  List& operator=(const List&) = delete;
+
+  // Removes all items, so none are left pointing to this list.
+  ~List() { clear(); }
+
+  template <typename Iterator>
+  void assign(Iterator first, Iterator last) {
+    clear();
+    AssignFromIterator(first, last);
+  }
+
+  bool empty() const noexcept { return size_ == 0u; }
+
+  size_t size() const noexcept { return size_; }
+
+  // Inserts item before pos.
+  void insert(Item* pos, Item& item);
+
+  // Removes an item, which must be in this list.
+  void erase(Item& item);
+
+  void clear();
+
+  constexpr Item* begin() noexcept { return head_.next_; }
+  constexpr const Item* begin() const noexcept { return head_.next_; }
+
+  constexpr Item* end() noexcept { return &head_; }
+  constexpr const Item* end() const noexcept { return &head_; }
+
+  static bool listed(const Item& item) { return !item.unlisted(); }
+
+ private:
+  template <typename Iterator>
+  void AssignFromIterator(Iterator first, Iterator last);
+
+  // The head is an Item whose next_ is the first item and prev_ is the last,
+  // so inserting and removing never needs special cases. &head_ is end().
+  Item head_;
+  size_t size_;
+};
+
+template <typename Iterator>
+void List::AssignFromIterator(Iterator first, Iterator last) {
+  for (Iterator it = first; it != last; ++it) {
+    if constexpr (std::is_pointer<std::remove_reference_t<decltype(*it)>>()) {
+      insert(end(), **it);
+    } else {
+      insert(end(), *it);
+    }
+  }
+}
+
+// Gets the element type from an Item. This is used to check that an
+// IntrusiveDList element class inherits from Item, either directly or through
+// another class.
+template <typename T, bool kIsItem = std::is_base_of<List::Item, T>()>
+struct GetListElementTypeFromItem {
+  using Type = void;
+};
+
+template <typename T>
+struct GetListElementTypeFromItem<T, true> {
+  using Type = typename T::PwIntrusiveDListElementType;
+};
+
+template <typename T>
+using ElementTypeFromItem = typename GetListElementTypeFromItem<T>::Type;
+
+}  // namespace intrusive_dlist_impl
+}  // namespace pw
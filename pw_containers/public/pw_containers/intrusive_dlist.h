@@ -0,0 +1,188 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+
+#include "pw_containers/internal/intrusive_dlist_impl.h"
+
+namespace pw {
+
+// IntrusiveDList is a doubly-linked counterpart to IntrusiveList. Each item
+// stores pointers to both of its neighbors and the list caches its size, so
+// push_back, pop_back, size, and removing a given item are O(1), rather than
+// O(n) as in IntrusiveList.
+//
+// Items inherit from IntrusiveDList<T>::Item, which costs two pointers per
+// item. As with IntrusiveList, an item can be in only one list at a time and
+// must outlive its membership in the list.
+//
+// Unlike IntrusiveList items, IntrusiveDList items do not remove themselves
+// from their list when destroyed, since they cannot update the list's cached
+// size. Destroying an item that is still in a list is a fatal error.
+//
+// Usage:
+//
+//   class Listener : public IntrusiveDList<Listener>::Item {};
+//
+//   IntrusiveDList<Listener> listeners;
+//
+//   Listener listener;
+//   listeners.push_back(listener);
+//   ...
+//   listeners.remove(listener);  // O(1)
+//
+template <typename T>
+class IntrusiveDList {
+ public:
+  class Item : public intrusive_dlist_impl::List::Item {
+   protected:
+    constexpr Item() = default;
+
+   private:
+    // GetListElementTypeFromItem is used to find the element type from an item.
+    // It is used to ensure list items inherit from the correct Item type.
+    template <typename, bool>
+    friend struct intrusive_dlist_impl::GetListElementTypeFromItem;
+
+    using PwIntrusiveDListElementType = T;
+  };
+
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using size_type = size_t;
+  using pointer = T*;
+  using reference = T&;
+  using iterator = intrusive_dlist_impl::Iterator<T, Item>;
+  using const_iterator =
+      intrusive_dlist_impl::Iterator<std::add_const_t<T>, const Item>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  constexpr IntrusiveDList() { CheckItemType(); }
+
+  // Constructs an IntrusiveDList from an iterator over Items. The iterator may
+  // dereference as either Item& (e.g. from std::array<Item>) or Item* (e.g.
+  // from std::initializer_list<Item*>).
+  template <typename Iterator>
+  IntrusiveDList(Iterator first, Iterator last) : list_(first, last) {
+    CheckItemType();
+  }
+
+  // Constructs an IntrusiveDList from a std::initializer_list of pointers to
+  // items.
+  IntrusiveDList(std::initializer_list<Item*> items)
+      : IntrusiveDList(items.begin(), items.end()) {}
+
+  template <typename Iterator>
+  void assign(Iterator first, Iterator last) {
+    list_.assign(first, last);
+  }
+
+  void assign(std::initializer_list<Item*> items) {
+    list_.assign(items.begin(), items.end());
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return list_.empty(); }
+
+  // Operation is O(1).
+  size_t size() const noexcept { return list_.size(); }
+
+  // Reference to the first element in the list. Undefined behavior if empty().
+  T& front() { return *static_cast<T*>(list_.begin()); }
+  const T& front() const { return *static_cast<const T*>(list_.begin()); }
+
+  // Reference to the last element in the list. Undefined behavior if empty().
+  T& back() { return *--end(); }
+  const T& back() const { return *--end(); }
+
+  void push_front(T& item) { list_.insert(list_.begin(), item); }
+
+  void push_back(T& item) { list_.insert(list_.end(), item); }
+
+  // Removes the first item in the list. The list must not be empty.
+  void pop_front() { list_.erase(*list_.begin()); }
+
+  // Removes the last item in the list. The list must not be empty.
+  void pop_back() { list_.erase(*(--end()).item_); }
+
+  // Inserts item before pos. Returns an iterator to the inserted item.
+  iterator insert(iterator pos, T& item) {
+    list_.insert(pos.item_, item);
+    return iterator(&item);
+  }
+
+  // Removes the item at pos from the list. The item is not destructed. Returns
+  // an iterator to the item that followed it.
+  iterator erase(iterator pos) {
+    iterator next = std::next(pos);
+    list_.erase(*pos.item_);
+    return next;
+  }
+
+  // Removes this specific item from the list in O(1). The item must be in this
+  // list or in no list. Returns true if the item was removed; false if it was
+  // not in a list.
+  bool remove(T& item) {
+    if (!intrusive_dlist_impl::List::listed(item)) {
+      return false;
+    }
+    list_.erase(item);
+    return true;
+  }
+
+  // Removes all items from the list. The items themselves are not destructed.
+  void clear() { list_.clear(); }
+
+  iterator begin() noexcept {
+    return iterator(static_cast<Item*>(list_.begin()));
+  }
+  const_iterator begin() const noexcept {
+    return const_iterator(static_cast<const Item*>(list_.begin()));
+  }
+  const_iterator cbegin() const noexcept { return begin(); }
+
+  iterator end() noexcept { return iterator(static_cast<Item*>(list_.end())); }
+  const_iterator end() const noexcept {
+    return const_iterator(static_cast<const Item*>(list_.end()));
+  }
+  const_iterator cend() const noexcept { return end(); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+ private:
+  // Check that T is an Item in a function, since the class T will not be fully
+  // defined when the IntrusiveDList<T> class is instantiated.
+  static constexpr void CheckItemType() {
+    static_assert(
+        std::is_base_of<intrusive_dlist_impl::ElementTypeFromItem<T>, T>(),
+        "IntrusiveDList items must be derived from IntrusiveDList<T>::Item, "
+        "where T is the item or one of its bases.");
+  }
+
+  intrusive_dlist_impl::List list_;
+};
+
+}  // namespace pw
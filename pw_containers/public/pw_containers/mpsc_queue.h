@@ -0,0 +1,142 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "pw_containers/internal/config.h"
+
+namespace pw {
+
+// A fixed-capacity, lock-free, multi-producer single-consumer queue.
+//
+// Any number of threads and interrupt handlers may push concurrently, and a
+// single context pops. Producers claim a slot with a compare-and-swap on the
+// shared write index, so this requires atomic read-modify-write instructions
+// (e.g. ARMv7-M, not ARMv6-M).
+//
+// Each slot has a sequence number that tells the consumer when the slot's item
+// is fully written. Pushes are lock-free but not wait-free: if a producer is
+// preempted between claiming a slot and writing it, the consumer cannot pop
+// that item or any later ones until the producer resumes. Other producers are
+// not blocked.
+//
+// kCapacity must be a power of two.
+template <typename T, size_t kCapacity>
+class MpscQueue {
+ public:
+  static_assert(kCapacity > 0u && (kCapacity & (kCapacity - 1)) == 0u,
+                "The capacity must be a power of two");
+
+  using value_type = T;
+  using size_type = size_t;
+
+  MpscQueue() : write_(0), read_(0) {
+    for (size_t i = 0; i < kCapacity; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  ~MpscQueue() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      while (TryPop().has_value()) {
+      }
+    }
+  }
+
+  // Producer side. Adds an item. Returns false if the queue is full.
+  bool TryPush(const T& value) { return TryEmplace(value); }
+  bool TryPush(T&& value) { return TryEmplace(std::move(value)); }
+
+  // Producer side. Constructs an item in place. Returns false if the queue is
+  // full, in which case the arguments are not used.
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    size_t write = write_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[write % kCapacity];
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+      if (sequence == write) {  // The slot is free; try to claim it.
+        if (write_.compare_exchange_weak(
+                write, write + 1, std::memory_order_relaxed)) {
+          new (&slot.storage) T(std::forward<Args>(args)...);
+          slot.sequence.store(write + 1, std::memory_order_release);
+          return true;
+        }
+        // The compare-and-swap failed and reloaded write; try again.
+      } else if (static_cast<std::ptrdiff_t>(sequence - write) < 0) {
+        return false;  // The slot has not been popped since the last lap.
+      } else {
+        write = write_.load(std::memory_order_relaxed);  // Another producer won.
+      }
+    }
+  }
+
+  // Consumer side. Removes and returns the oldest item, or std::nullopt if the
+  // queue is empty or the oldest item is still being written.
+  std::optional<T> TryPop() {
+    Slot& slot = slots_[read_ % kCapacity];
+    if (slot.sequence.load(std::memory_order_acquire) != read_ + 1) {
+      return std::nullopt;
+    }
+
+    T& item = *std::launder(reinterpret_cast<T*>(&slot.storage));
+    std::optional<T> value(std::move(item));
+    item.~T();
+
+    // Mark the slot free for the producer that wraps around to it.
+    slot.sequence.store(read_ + kCapacity, std::memory_order_release);
+    read_ += 1;
+    return value;
+  }
+
+  // Consumer side. Returns true if there are no items to pop.
+  bool empty() const {
+    return slots_[read_ % kCapacity].sequence.load(
+               std::memory_order_acquire) != read_ + 1;
+  }
+
+  // Consumer side. Returns the number of items pushed or being pushed that
+  // have not been popped.
+  size_type size() const {
+    return write_.load(std::memory_order_relaxed) - read_;
+  }
+
+  static constexpr size_type capacity() { return kCapacity; }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+  };
+
+  // Shared by all producers.
+  alignas(PW_CONTAINERS_CACHE_LINE_SIZE) std::atomic<size_t> write_;
+
+  // Owned by the consumer.
+  alignas(PW_CONTAINERS_CACHE_LINE_SIZE) size_t read_;
+
+  alignas(PW_CONTAINERS_CACHE_LINE_SIZE) Slot slots_[kCapacity];
+};
+
+}  // namespace pw
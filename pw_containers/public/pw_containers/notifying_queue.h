@@ -0,0 +1,90 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <optional>
+#include <utility>
+
+#include "pw_sync/thread_notification.h"
+
+namespace pw {
+
+// Wraps a single-consumer queue, such as SpscQueue or MpscQueue, with a
+// ThreadNotification, so the consuming thread can block until an item arrives.
+//
+// Pushing releases the notification. It is IRQ safe if the queue's push is.
+// Only one thread may pop.
+//
+//   pw::NotifyingQueue<pw::MpscQueue<Event, 16>> events;
+//
+//   void GpioInterruptHandler() { events.TryPush(Event::kButtonPressed); }
+//
+//   void EventThread() {
+//     while (true) {
+//       Handle(events.Pop());
+//     }
+//   }
+//
+template <typename Queue>
+class NotifyingQueue {
+ public:
+  using value_type = typename Queue::value_type;
+  using size_type = typename Queue::size_type;
+
+  NotifyingQueue() = default;
+
+  NotifyingQueue(const NotifyingQueue&) = delete;
+  NotifyingQueue& operator=(const NotifyingQueue&) = delete;
+
+  // Producer side. Adds an item and notifies the consumer. Returns false if
+  // the queue is full.
+  bool TryPush(const value_type& value) { return TryEmplace(value); }
+  bool TryPush(value_type&& value) { return TryEmplace(std::move(value)); }
+
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    if (!queue_.TryEmplace(std::forward<Args>(args)...)) {
+      return false;
+    }
+    notification_.release();
+    return true;
+  }
+
+  // Consumer side. Removes and returns the oldest item, blocking until one is
+  // available.
+  value_type Pop() {
+    while (true) {
+      std::optional<value_type> value = queue_.TryPop();
+      if (value.has_value()) {
+        return std::move(*value);
+      }
+      // The notification latches, so an item pushed after TryPop() failed
+      // still wakes this thread. Waking up with no item is harmless.
+      notification_.acquire();
+    }
+  }
+
+  // Consumer side. Removes and returns the oldest item without blocking.
+  std::optional<value_type> TryPop() { return queue_.TryPop(); }
+
+  bool empty() const { return queue_.empty(); }
+  size_type size() const { return queue_.size(); }
+  static constexpr size_type capacity() { return Queue::capacity(); }
+
+ private:
+  Queue queue_;
+  sync::ThreadNotification notification_;
+};
+
+}  // namespace pw
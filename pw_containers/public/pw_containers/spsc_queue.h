@@ -0,0 +1,129 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "pw_containers/internal/config.h"
+
+namespace pw {
+
+// A fixed-capacity, lock-free, single-producer single-consumer queue.
+//
+// One context (a thread or an interrupt handler) pushes and one other context
+// pops, without a lock. Only atomic loads and stores are used, so SpscQueue
+// also works on cores without atomic read-modify-write instructions, such as
+// the Cortex-M0.
+//
+// The producer's and consumer's indices are kept on separate cache lines. Each
+// side also caches the other side's index, and only reloads it when the queue
+// appears full or empty, which keeps cache line transfers to a minimum.
+//
+// kCapacity must be a power of two.
+template <typename T, size_t kCapacity>
+class SpscQueue {
+ public:
+  static_assert(kCapacity > 0u && (kCapacity & (kCapacity - 1)) == 0u,
+                "The capacity must be a power of two");
+
+  using value_type = T;
+  using size_type = size_t;
+
+  constexpr SpscQueue()
+      : write_(0), cached_read_(0), read_(0), cached_write_(0) {}
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  ~SpscQueue() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      while (TryPop().has_value()) {
+      }
+    }
+  }
+
+  // Producer side. Adds an item. Returns false if the queue is full.
+  bool TryPush(const T& value) { return TryEmplace(value); }
+  bool TryPush(T&& value) { return TryEmplace(std::move(value)); }
+
+  // Producer side. Constructs an item in place. Returns false if the queue is
+  // full, in which case the arguments are not used.
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    const size_t write = write_.load(std::memory_order_relaxed);
+    if (write - cached_read_ == kCapacity) {
+      cached_read_ = read_.load(std::memory_order_acquire);
+      if (write - cached_read_ == kCapacity) {
+        return false;
+      }
+    }
+    new (&slots_[write % kCapacity]) T(std::forward<Args>(args)...);
+    write_.store(write + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Removes and returns the oldest item, or std::nullopt if the
+  // queue is empty.
+  std::optional<T> TryPop() {
+    const size_t read = read_.load(std::memory_order_relaxed);
+    if (read == cached_write_) {
+      cached_write_ = write_.load(std::memory_order_acquire);
+      if (read == cached_write_) {
+        return std::nullopt;
+      }
+    }
+    T& slot = *std::launder(reinterpret_cast<T*>(&slots_[read % kCapacity]));
+    std::optional<T> value(std::move(slot));
+    slot.~T();
+    read_.store(read + 1, std::memory_order_release);
+    return value;
+  }
+
+  // Consumer side. Returns true if there are no items to pop.
+  bool empty() const {
+    return read_.load(std::memory_order_relaxed) ==
+           write_.load(std::memory_order_acquire);
+  }
+
+  // Returns the number of items. If the other side is active, the result may
+  // already be out of date.
+  size_type size() const {
+    // Load read_ first, since it never passes write_.
+    const size_t read = read_.load(std::memory_order_acquire);
+    return write_.load(std::memory_order_acquire) - read;
+  }
+
+  static constexpr size_type capacity() { return kCapacity; }
+
+ private:
+  // Written by the producer. Indices count every push or pop and wrap around
+  // at the size_t maximum; kCapacity divides that range since it is a power
+  // of two.
+  alignas(PW_CONTAINERS_CACHE_LINE_SIZE) std::atomic<size_t> write_;
+  size_t cached_read_;
+
+  // Written by the consumer.
+  alignas(PW_CONTAINERS_CACHE_LINE_SIZE) std::atomic<size_t> read_;
+  size_t cached_write_;
+
+  alignas(PW_CONTAINERS_CACHE_LINE_SIZE)
+      std::aligned_storage_t<sizeof(T), alignof(T)> slots_[kCapacity];
+};
+
+}  // namespace pw
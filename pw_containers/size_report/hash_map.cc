@@ -0,0 +1,37 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <cstdint>
+
+#include "pw_containers/hash_map.h"
+#include "pw_log/log.h"
+
+namespace {
+
+pw::HashMap<uint32_t, uint32_t, 32> table;
+
+}  // namespace
+
+uint32_t volatile* unoptimizable;
+
+int main() {
+  table.insert({*unoptimizable, *unoptimizable});
+  table.erase(uint32_t{*unoptimizable});
+
+  if (auto it = table.find(uint32_t{*unoptimizable}); it != table.end()) {
+    PW_LOG_INFO("value is %u", static_cast<unsigned>(it->second));
+    return 0;
+  }
+  return 1;
+}
@@ -0,0 +1,70 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Baseline for the HashMap size report: a hand-rolled table with linear search.
+
+#include <cstdint>
+
+#include "pw_log/log.h"
+
+namespace {
+
+struct Entry {
+  uint32_t key;
+  uint32_t value;
+};
+
+Entry table[32];
+unsigned table_size = 0;
+
+Entry* Find(uint32_t key) {
+  for (unsigned i = 0; i < table_size; ++i) {
+    if (table[i].key == key) {
+      return &table[i];
+    }
+  }
+  return nullptr;
+}
+
+bool Insert(uint32_t key, uint32_t value) {
+  if (Find(key) != nullptr || table_size == 32u) {
+    return false;
+  }
+  table[table_size++] = {key, value};
+  return true;
+}
+
+bool Erase(uint32_t key) {
+  Entry* entry = Find(key);
+  if (entry == nullptr) {
+    return false;
+  }
+  *entry = table[--table_size];
+  return true;
+}
+
+}  // namespace
+
+uint32_t volatile* unoptimizable;
+
+int main() {
+  Insert(*unoptimizable, *unoptimizable);
+  Erase(*unoptimizable);
+
+  if (Entry* entry = Find(*unoptimizable); entry != nullptr) {
+    PW_LOG_INFO("value is %u", static_cast<unsigned>(entry->value));
+    return 0;
+  }
+  return 1;
+}
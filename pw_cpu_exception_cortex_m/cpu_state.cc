@@ -19,15 +19,11 @@
 #include <span>
 
 #include "pw_cpu_exception/support.h"
+#include "pw_cpu_exception_cortex_m_private/config.h"
 #include "pw_cpu_exception_cortex_m_private/cortex_m_constants.h"
 #include "pw_log/log.h"
 #include "pw_string/string_builder.h"
 
-// TODO(amontanez): Set up config when this module is moved to *_cortex_m.
-#ifndef PW_CPU_EXCEPTION_EXTENDED_CFSR_DUMP
-#define PW_CPU_EXCEPTION_EXTENDED_CFSR_DUMP 0
-#endif  // PW_CPU_EXCEPTION_EXTENDED_CFSR_DUMP
-
 namespace pw::cpu_exception {
 namespace {
 
@@ -153,6 +149,14 @@ void AnalyzeException(const pw_cpu_exception_State& cpu_state) {
 }
 }  // namespace
 
+void CaptureFaultRegisters(pw_cpu_exception_State& cpu_state) {
+  cpu_state.extended.mmfar = cortex_m_mmfar;
+  cpu_state.extended.bfar = cortex_m_bfar;
+  cpu_state.extended.icsr = cortex_m_icsr;
+  cpu_state.extended.hfsr = cortex_m_hfsr;
+  cpu_state.extended.shcsr = cortex_m_shcsr;
+}
+
 std::span<const uint8_t> RawFaultingCpuState(
     const pw_cpu_exception_State& cpu_state) {
   return std::span(reinterpret_cast<const uint8_t*>(&cpu_state),
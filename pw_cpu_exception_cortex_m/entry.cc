@@ -19,6 +19,7 @@
 
 #include "pw_cpu_exception/handler.h"
 #include "pw_cpu_exception_cortex_m/cpu_state.h"
+#include "pw_cpu_exception_cortex_m_private/config.h"
 #include "pw_cpu_exception_cortex_m_private/cortex_m_constants.h"
 #include "pw_preprocessor/compiler.h"
 
@@ -147,13 +148,19 @@ extern "C" {
 // registers, and call application exception handler.
 PW_USED void pw_PackageAndHandleCpuException(
     pw_cpu_exception_State* cpu_state) {
-  // Capture memory mapped registers.
+  // Capture memory mapped registers. The CFSR is always needed to tell whether
+  // the CPU managed to push its context frame.
   cpu_state->extended.cfsr = cortex_m_cfsr;
-  cpu_state->extended.mmfar = cortex_m_mmfar;
-  cpu_state->extended.bfar = cortex_m_bfar;
-  cpu_state->extended.icsr = cortex_m_icsr;
-  cpu_state->extended.hfsr = cortex_m_hfsr;
-  cpu_state->extended.shcsr = cortex_m_shcsr;
+#if PW_CPU_EXCEPTION_LAZY_FAULT_REGISTERS
+  // The handler reads the rest with CaptureFaultRegisters() if it needs them.
+  cpu_state->extended.mmfar = 0;
+  cpu_state->extended.bfar = 0;
+  cpu_state->extended.icsr = 0;
+  cpu_state->extended.hfsr = 0;
+  cpu_state->extended.shcsr = 0;
+#else
+  CaptureFaultRegisters(*cpu_state);
+#endif  // PW_CPU_EXCEPTION_LAZY_FAULT_REGISTERS
 
   // CPU may have automatically pushed state to the program stack. If it did,
   // the values can be copied into in the pw_cpu_exception_State struct that is
@@ -557,6 +557,13 @@ void TestingExceptionHandler(pw_cpu_exception_State* state) {
     }
   }
 
+#if defined(PW_CPU_EXCEPTION_LAZY_FAULT_REGISTERS) && \
+    PW_CPU_EXCEPTION_LAZY_FAULT_REGISTERS
+  // Only the CFSR was captured on entry.
+  EXPECT_EQ(state->extended.hfsr, 0u);
+  CaptureFaultRegisters(*state);
+#endif
+
   if (trigger_nested_fault) {
     // Disable nesting before triggering the nested fault to prevent infinite
     // recursive crashes.
@@ -11,6 +11,8 @@
 // WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
 // License for the specific language governing permissions and limitations under
 // the License.
+#include <cstring>
+
 #include "pw_cpu_exception_cortex_m/cpu_state.h"
 #include "pw_cpu_exception_cortex_m_protos/cpu_state.pwpb.h"
 #include "pw_preprocessor/compiler.h"
@@ -61,4 +63,13 @@ Status DumpCpuStateProto(protobuf::Encoder& dest,
   return OkStatus();
 }
 
+Status DumpCpuStateProto(protobuf::Encoder& dest, ConstByteSpan raw_cpu_state) {
+  pw_cpu_exception_State cpu_state;
+  if (raw_cpu_state.size() != sizeof(cpu_state)) {
+    return Status::InvalidArgument();
+  }
+  std::memcpy(&cpu_state, raw_cpu_state.data(), sizeof(cpu_state));
+  return DumpCpuStateProto(dest, cpu_state);
+}
+
 }  // namespace pw::cpu_exception
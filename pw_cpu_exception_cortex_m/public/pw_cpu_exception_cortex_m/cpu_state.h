@@ -95,3 +95,18 @@ PW_PACKED(struct) pw_cpu_exception_State {
   // availability of the FPU registers a compile-time configuration when FPU
   // register support is added.
 };
+
+namespace pw::cpu_exception {
+
+// Reads the memory mapped fault registers other than the CFSR (MMFAR, BFAR,
+// ICSR, HFSR, and SHCSR) into cpu_state.
+//
+// Exception entry captures these by default. If
+// PW_CPU_EXCEPTION_LAZY_FAULT_REGISTERS is enabled, entry only captures the
+// CFSR and leaves the others zeroed, which shortens entry for handlers that
+// recover from expected faults. Handlers that log, dump, or inspect the other
+// registers call this first. It must be called from the exception handler,
+// before any fault status is cleared.
+void CaptureFaultRegisters(pw_cpu_exception_State& cpu_state);
+
+}  // namespace pw::cpu_exception
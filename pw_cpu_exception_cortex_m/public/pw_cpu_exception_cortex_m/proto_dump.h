@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include "pw_bytes/span.h"
 #include "pw_cpu_exception_cortex_m/cpu_state.h"
 #include "pw_protobuf/encoder.h"
 #include "pw_status/status.h"
@@ -30,4 +31,13 @@ namespace pw::cpu_exception {
 Status DumpCpuStateProto(protobuf::Encoder& dest,
                          const pw_cpu_exception_State& cpu_state);
 
+// Dumps the cpu state from the raw bytes of a pw_cpu_exception_State, such as
+// those saved by pw::snapshot::RawCaptureWriter. This can be passed to
+// pw::snapshot::EncodeRawCapture as its CpuStateEncoder.
+//
+// Returns:
+//   INVALID_ARGUMENT - raw_cpu_state is not the size of the struct.
+//   Otherwise, as DumpCpuStateProto above.
+Status DumpCpuStateProto(protobuf::Encoder& dest, ConstByteSpan raw_cpu_state);
+
 }  // namespace pw::cpu_exception
@@ -0,0 +1,27 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+// Enables extended logging in pw::cpu_exception::LogCpuState() that dumps the
+// active CFSR fields with help strings.
+#ifndef PW_CPU_EXCEPTION_EXTENDED_CFSR_DUMP
+#define PW_CPU_EXCEPTION_EXTENDED_CFSR_DUMP 0
+#endif  // PW_CPU_EXCEPTION_EXTENDED_CFSR_DUMP
+
+// When enabled, exception entry captures the CFSR but leaves the other memory
+// mapped fault registers zeroed. Handlers that need them call
+// pw::cpu_exception::CaptureFaultRegisters().
+#ifndef PW_CPU_EXCEPTION_LAZY_FAULT_REGISTERS
+#define PW_CPU_EXCEPTION_LAZY_FAULT_REGISTERS 0
+#endif  // PW_CPU_EXCEPTION_LAZY_FAULT_REGISTERS
@@ -14,6 +14,10 @@
 
 #include "pw_function/function.h"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
 #include "gtest/gtest.h"
 
 namespace pw {
@@ -222,5 +226,175 @@ TEST(Function, MoveAssign_CustomObject) {
 #endif  // __clang_analyzer__
 }
 
+TEST(Function, AssignCallable) {
+  Function<int(int, int)> function;
+  function = Multiply;
+  EXPECT_EQ(function(4, 5), 20);
+  function = [](int a, int b) { return a + b; };
+  EXPECT_EQ(function(4, 5), 9);
+}
+
+class MoveOnly {
+ public:
+  explicit MoveOnly(int value) : value_(value) {}
+
+  MoveOnly(const MoveOnly&) = delete;
+  MoveOnly& operator=(const MoveOnly&) = delete;
+
+  MoveOnly(MoveOnly&&) = default;
+  MoveOnly& operator=(MoveOnly&&) = default;
+
+  int value() const { return value_; }
+
+ private:
+  int value_;
+};
+
+TEST(Function, MoveOnlyCallable) {
+  Function<int()> moved([captured = MoveOnly(7)]() {
+    return captured.value();
+  });
+  Function<int()> function(std::move(moved));
+  EXPECT_EQ(function(), 7);
+}
+
+// A callable with a capture of the given size, which is larger than the size of
+// a default Function.
+template <size_t kSize>
+struct LargeCallable {
+  std::array<std::byte, kSize> data;
+
+  int operator()() const { return static_cast<int>(data.back()); }
+};
+
+constexpr size_t kLargeSize = 4 * PW_FUNCTION_INLINE_CALLABLE_SIZE;
+
+TEST(InlineFunction, SizeIsInlineCallableSize) {
+  static_assert(sizeof(InlineFunction<void(), 48>) == 48u);
+  static_assert(sizeof(InlineFunction<void(), 8 * sizeof(void*)>) ==
+                8 * sizeof(void*));
+  static_assert(sizeof(Function<void()>) == PW_FUNCTION_INLINE_CALLABLE_SIZE);
+}
+
+TEST(InlineFunction, StoresLargerCallable) {
+  LargeCallable<kLargeSize - sizeof(void*)> callable = {};
+  callable.data.back() = std::byte{42};
+
+  InlineFunction<int(), kLargeSize> moved(callable);
+  InlineFunction<int(), kLargeSize> function(std::move(moved));
+  EXPECT_EQ(function(), 42);
+  EXPECT_NE(function, nullptr);
+
+// Ignore use-after-move.
+#ifndef __clang_analyzer__
+  EXPECT_EQ(moved, nullptr);
+#endif  // __clang_analyzer__
+}
+
+TEST(InlineFunction, Null) {
+  InlineFunction<void(), kLargeSize> function;
+  EXPECT_EQ(function, nullptr);
+  function = []() {};
+  EXPECT_NE(function, nullptr);
+  function = nullptr;
+  EXPECT_EQ(function, nullptr);
+}
+
+// Allocates from a buffer that is large enough for one allocation.
+class TestAllocator {
+ public:
+  void* Allocate(size_t size) {
+    allocated_size_ = size;
+    if (fail_ || allocated_ || size > buffer_.size()) {
+      return nullptr;
+    }
+    allocated_ = true;
+    // Offset the memory to check that callables are aligned.
+    return buffer_.data() + sizeof(void*);
+  }
+
+  void Free(void* ptr) {
+    EXPECT_TRUE(allocated_);
+    EXPECT_EQ(ptr, buffer_.data() + sizeof(void*));
+    allocated_ = false;
+  }
+
+  void set_fail(bool fail) { fail_ = fail; }
+
+  bool allocated() const { return allocated_; }
+  size_t allocated_size() const { return allocated_size_; }
+
+ private:
+  alignas(std::max_align_t) std::array<std::byte, 256> buffer_;
+  size_t allocated_size_ = 0;
+  bool allocated_ = false;
+  bool fail_ = false;
+};
+
+TEST(Function, Allocator_SmallCallable_StoredInline) {
+  TestAllocator allocator;
+  Function<int(int, int)> function(Multiply, allocator);
+  EXPECT_FALSE(allocator.allocated());
+  EXPECT_EQ(function(2, 3), 6);
+}
+
+TEST(Function, Allocator_LargeCallable_Allocated) {
+  TestAllocator allocator;
+  LargeCallable<kLargeSize> callable = {};
+  callable.data.back() = std::byte{123};
+
+  {
+    Function<int()> function(callable, allocator);
+    EXPECT_TRUE(allocator.allocated());
+    EXPECT_GE(allocator.allocated_size(), kLargeSize);
+    EXPECT_NE(function, nullptr);
+    EXPECT_EQ(function(), 123);
+  }
+
+  EXPECT_FALSE(allocator.allocated());
+}
+
+TEST(Function, Allocator_Move_TransfersAllocation) {
+  TestAllocator allocator;
+  LargeCallable<kLargeSize> callable = {};
+  callable.data.back() = std::byte{99};
+
+  Function<int()> moved(callable, allocator);
+  Function<int()> function(std::move(moved));
+  EXPECT_TRUE(allocator.allocated());
+  EXPECT_EQ(function(), 99);
+
+// Ignore use-after-move.
+#ifndef __clang_analyzer__
+  EXPECT_EQ(moved, nullptr);
+#endif  // __clang_analyzer__
+
+  function = nullptr;
+  EXPECT_FALSE(allocator.allocated());
+}
+
+TEST(Function, Allocator_AllocationFails_Null) {
+  TestAllocator allocator;
+  allocator.set_fail(true);
+
+  Function<int()> function(LargeCallable<kLargeSize>{}, allocator);
+  EXPECT_EQ(function, nullptr);
+}
+
+struct alignas(std::max_align_t) OverAlignedCallable {
+  std::array<std::byte, kLargeSize> data;
+
+  bool operator()() const {
+    return reinterpret_cast<uintptr_t>(this) % alignof(std::max_align_t) == 0;
+  }
+};
+
+TEST(Function, Allocator_OverAlignedCallable_Aligned) {
+  TestAllocator allocator;
+  Function<bool()> function(OverAlignedCallable{}, allocator);
+  ASSERT_TRUE(allocator.allocated());
+  EXPECT_TRUE(function());
+}
+
 }  // namespace
 }  // namespace pw
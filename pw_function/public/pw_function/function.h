@@ -46,27 +46,55 @@ namespace pw {
 template <typename T>
 using Function = function_internal::Function<T>;
 
+// pw::InlineFunction is a pw::Function with its own inline size, in bytes,
+// instead of PW_FUNCTION_INLINE_CALLABLE_SIZE. As with that option, the inline
+// size is the size of the object, which includes one pointer of overhead. This
+// allows objects that hold larger callables, such as work queues, to do so
+// without increasing the size of every Function.
+//
+// Example:
+//
+//   class WorkQueue {
+//    public:
+//     using Work = pw::InlineFunction<void(), 8 * sizeof(void*)>;
+//     void Push(Work&& work);
+//   };
+//
+// Callables which do not fit inline are a compile-time error, unless the
+// function is constructed with an allocator, such as a
+// pw::allocator::FreeListHeap, to store them in:
+//
+//   pw::allocator::FreeListHeapBuffer<> heap(heap_memory);
+//   pw::Function<void()> function([large_capture]() { ... }, heap);
+//
+template <typename T, size_t kInlineCallableSize>
+using InlineFunction = function_internal::Function<T, kInlineCallableSize>;
+
 // A Closure is a function that does not take any arguments and returns nothing.
 using Closure = Function<void()>;
 
 // nullptr comparisions for functions.
-template <typename T>
-bool operator==(const Function<T>& f, std::nullptr_t) {
+template <typename T, size_t kInlineCallableSize>
+bool operator==(const InlineFunction<T, kInlineCallableSize>& f,
+                std::nullptr_t) {
   return !f;
 }
 
-template <typename T>
-bool operator!=(const Function<T>& f, std::nullptr_t) {
+template <typename T, size_t kInlineCallableSize>
+bool operator!=(const InlineFunction<T, kInlineCallableSize>& f,
+                std::nullptr_t) {
   return !!f;
 }
 
-template <typename T>
-bool operator==(std::nullptr_t, const Function<T>& f) {
+template <typename T, size_t kInlineCallableSize>
+bool operator==(std::nullptr_t,
+                const InlineFunction<T, kInlineCallableSize>& f) {
   return !f;
 }
 
-template <typename T>
-bool operator!=(std::nullptr_t, const Function<T>& f) {
+template <typename T, size_t kInlineCallableSize>
+bool operator!=(std::nullptr_t,
+                const InlineFunction<T, kInlineCallableSize>& f) {
   return !!f;
 }
 
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 #include <new>
 #include <utility>
 
@@ -170,6 +171,83 @@ class MemoryFunctionTarget final : public FunctionTarget<Return, Args...> {
   void* address_;
 };
 
+// Function target which stores a callable in memory from an allocator, such as
+// a pw::allocator::FreeListHeap. The allocator is any object with
+// void* Allocate(size_t) and void Free(void*) functions. The memory is returned
+// to the allocator when the target is destroyed.
+template <typename Callable,
+          typename Allocator,
+          typename Return,
+          typename... Args>
+class AllocatedFunctionTarget final : public FunctionTarget<Return, Args...> {
+ public:
+  // Moves the callable into memory from the allocator. If the allocation
+  // fails, the target is null.
+  AllocatedFunctionTarget(Allocator& allocator, Callable&& callable)
+      : allocation_(nullptr) {
+    void* block = allocator.Allocate(kBlockSize);
+    if (block == nullptr) {
+      return;
+    }
+    void* aligned = block;
+    size_t space = kBlockSize;
+    std::align(alignof(Allocation), sizeof(Allocation), aligned, space);
+    allocation_ =
+        new (aligned) Allocation{allocator, block, std::move(callable)};
+  }
+
+  ~AllocatedFunctionTarget() final {
+    // As with MemoryFunctionTarget, only the last target the callable was moved
+    // to owns it.
+    if (allocation_ != nullptr) {
+      Allocator& allocator = allocation_->allocator;
+      void* block = allocation_->block;
+      allocation_->~Allocation();
+      allocator.Free(block);
+    }
+  }
+
+  AllocatedFunctionTarget(const AllocatedFunctionTarget&) = delete;
+  AllocatedFunctionTarget& operator=(const AllocatedFunctionTarget&) = delete;
+
+  // Transfer the allocation to this object, clearing it from the other.
+  AllocatedFunctionTarget(AllocatedFunctionTarget&& other)
+      : allocation_(other.allocation_) {
+    other.allocation_ = nullptr;
+  }
+  AllocatedFunctionTarget& operator=(AllocatedFunctionTarget&&) = delete;
+
+  bool IsNull() const final { return allocation_ == nullptr; }
+
+  Return operator()(Args... args) const final {
+    PW_ASSERT(allocation_ != nullptr);
+    return allocation_->callable(args...);
+  }
+
+  void MoveInitializeTo(void* ptr) final {
+    new (ptr) AllocatedFunctionTarget(std::move(*this));
+  }
+
+ private:
+  struct Allocation {
+    Allocator& allocator;
+    void* block;  // The start of the allocation, which may be unaligned.
+
+    // This must be mutable to support custom objects that implement
+    // operator() in a non-const way.
+    mutable Callable callable;
+  };
+
+  // Allocators may only align to pointers, so allocate enough extra space to
+  // align the callable.
+  static constexpr size_t kBlockSize =
+      sizeof(Allocation) + (alignof(Allocation) > alignof(void*)
+                                ? alignof(Allocation) - alignof(void*)
+                                : 0);
+
+  Allocation* allocation_;
+};
+
 template <size_t kSizeBytes>
 using FunctionStorage =
     std::aligned_storage_t<kSizeBytes, alignof(std::max_align_t)>;
@@ -207,6 +285,28 @@ class FunctionTargetHolder {
     new (&bits_) InlineFunctionTarget(std::move(callable));
   }
 
+  // Initializes an InlineFunctionTarget if the callable fits, or an
+  // AllocatedFunctionTarget with memory from the allocator if it does not.
+  template <typename Callable, typename Allocator>
+  void InitializeInlineOrAllocatedTarget(Callable callable,
+                                         Allocator& allocator) {
+    using InlineFunctionTarget =
+        InlineFunctionTarget<Callable, Return, Args...>;
+    using AllocatedFunctionTarget =
+        AllocatedFunctionTarget<Callable, Allocator, Return, Args...>;
+    static_assert(
+        sizeof(AllocatedFunctionTarget) <= kSizeBytes,
+        "AllocatedFunctionTarget must fit within FunctionTargetHolder");
+
+    if constexpr (sizeof(InlineFunctionTarget) <= kSizeBytes &&
+                  alignof(InlineFunctionTarget) <=
+                      alignof(FunctionStorage<kSizeBytes>)) {
+      new (&bits_) InlineFunctionTarget(std::move(callable));
+    } else {
+      new (&bits_) AllocatedFunctionTarget(allocator, std::move(callable));
+    }
+  }
+
   // Initializes a MemoryTarget that stores the callable at the provided
   // location.
   template <typename Callable>
@@ -238,12 +338,18 @@ class FunctionTargetHolder {
   FunctionStorage<kSizeBytes> bits_;
 };
 
-template <typename Return, typename... Args>
+template <typename Signature,
+          size_t kInlineCallableSize = config::kInlineCallableSize>
 class Function;
 
-template <typename Return, typename... Args>
-class Function<Return(Args...)> {
+template <size_t kInlineCallableSize, typename Return, typename... Args>
+class Function<Return(Args...), kInlineCallableSize> {
  public:
+  static_assert(kInlineCallableSize > 0 &&
+                    kInlineCallableSize % alignof(void*) == 0,
+                "The inline size must be a positive multiple of the pointer "
+                "alignment");
+
   constexpr Function() { holder_.InitializeNullTarget(); }
   constexpr Function(std::nullptr_t) : Function() {}
 
@@ -256,6 +362,19 @@ class Function<Return(Args...)> {
     }
   }
 
+  // Stores the callable inline if it fits, or in memory from the allocator if
+  // it does not. The allocator is any object with void* Allocate(size_t) and
+  // void Free(void*) functions, such as a pw::allocator::FreeListHeap, and must
+  // outlive the function. If the allocation fails, the function is null.
+  template <typename Callable, typename Allocator>
+  Function(Callable callable, Allocator& allocator) {
+    if (IsNull(callable)) {
+      holder_.InitializeNullTarget();
+    } else {
+      holder_.InitializeInlineOrAllocatedTarget(std::move(callable), allocator);
+    }
+  }
+
   Function(Function&& other) {
     holder_.MoveInitializeTargetFrom(other.holder_);
     other.holder_.InitializeNullTarget();
@@ -277,7 +396,11 @@ class Function<Return(Args...)> {
   template <typename Callable>
   Function& operator=(Callable callable) {
     holder_.DestructTarget();
-    InitializeTarget(std::move(callable));
+    if (IsNull(callable)) {
+      holder_.InitializeNullTarget();
+    } else {
+      holder_.InitializeInlineTarget(std::move(callable));
+    }
     return *this;
   }
 
@@ -308,7 +431,7 @@ class Function<Return(Args...)> {
     }
   }
 
-  FunctionTargetHolder<config::kInlineCallableSize, Return, Args...> holder_;
+  FunctionTargetHolder<kInlineCallableSize, Return, Args...> holder_;
 };
 
 }  // namespace pw::function_internal
@@ -0,0 +1,93 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Encodes and decodes UI-frames with a typical RPC packet sized payload. The
+// payload has a few bytes that must be escaped, as most real payloads do.
+
+#include <array>
+#include <cstddef>
+
+#include "gtest/gtest.h"
+#include "pw_benchmark/benchmark.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_hdlc/encoder.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::hdlc {
+namespace {
+
+using benchmark::DoNotOptimize;
+using benchmark::State;
+
+constexpr uint64_t kAddress = 82;
+
+constexpr auto kPayload = [] {
+  std::array<std::byte, 64> payload{};
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<std::byte>(i * 11);
+  }
+  payload[7] = std::byte{0x7e};
+  payload[40] = std::byte{0x7d};
+  return payload;
+}();
+
+std::array<std::byte, 2 * kPayload.size() + 32> frame_buffer;
+
+PW_BENCHMARK(Hdlc, WriteUIFrame_64B) {
+  for (auto _ : state) {
+    stream::MemoryWriter writer(frame_buffer);
+    DoNotOptimize(WriteUIFrame(kAddress, kPayload, writer));
+    DoNotOptimize(frame_buffer);
+  }
+}
+
+PW_BENCHMARK(Hdlc, EncodeUIFrame_64B) {
+  for (auto _ : state) {
+    DoNotOptimize(EncodeUIFrame(kAddress, kPayload, frame_buffer));
+    DoNotOptimize(frame_buffer);
+  }
+}
+
+PW_BENCHMARK(Hdlc, Decode_64B) {
+  const Result<ConstByteSpan> frame =
+      EncodeUIFrame(kAddress, kPayload, frame_buffer);
+  ASSERT_EQ(OkStatus(), frame.status());
+
+  DecoderBuffer<128> decoder;
+  size_t frames = 0;
+  for (auto _ : state) {
+    decoder.Process(frame.value(), [&frames](const Result<Frame>& result) {
+      frames += result.ok() ? 1 : 0;
+    });
+  }
+  EXPECT_EQ(frames, state.iterations());
+}
+
+PW_BENCHMARK(Hdlc, DecodeBytewise_64B) {
+  const Result<ConstByteSpan> frame =
+      EncodeUIFrame(kAddress, kPayload, frame_buffer);
+  ASSERT_EQ(OkStatus(), frame.status());
+
+  DecoderBuffer<128> decoder;
+  size_t frames = 0;
+  for (auto _ : state) {
+    for (std::byte b : frame.value()) {
+      frames += decoder.Process(b).ok() ? 1 : 0;
+    }
+  }
+  EXPECT_EQ(frames, state.iterations());
+}
+
+}  // namespace
+}  // namespace pw::hdlc
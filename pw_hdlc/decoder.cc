@@ -14,6 +14,8 @@
 
 #include "pw_hdlc/decoder.h"
 
+#include <cstdint>
+
 #include "pw_assert/check.h"
 #include "pw_bytes/endian.h"
 #include "pw_hdlc/internal/protocol.h"
@@ -23,6 +25,40 @@
 using std::byte;
 
 namespace pw::hdlc {
+namespace {
+
+// Returns true if any byte of the word is zero.
+constexpr bool HasZeroByte(uintptr_t word) {
+  constexpr uintptr_t kOnes = ~uintptr_t(0) / 0xFF;
+  constexpr uintptr_t kHighBits = kOnes * 0x80;
+  return ((word - kOnes) & ~word & kHighBits) != 0u;
+}
+
+// Returns the index of the first flag or escape byte, or data.size() if there
+// are none. Checks a word at a time so that long runs are scanned quickly.
+size_t FindControlByte(ConstByteSpan data) {
+  constexpr uintptr_t kOnes = ~uintptr_t(0) / 0xFF;
+  constexpr uintptr_t kFlags = kOnes * static_cast<uint8_t>(kFlag);
+  constexpr uintptr_t kEscapes = kOnes * static_cast<uint8_t>(kEscape);
+
+  size_t i = 0;
+  for (; i + sizeof(uintptr_t) <= data.size(); i += sizeof(uintptr_t)) {
+    uintptr_t word;
+    std::memcpy(&word, &data[i], sizeof(word));
+    if (HasZeroByte(word ^ kFlags) || HasZeroByte(word ^ kEscapes)) {
+      break;
+    }
+  }
+
+  for (; i < data.size(); ++i) {
+    if (NeedsEscaping(data[i])) {
+      break;
+    }
+  }
+  return i;
+}
+
+}  // namespace
 
 Result<Frame> Frame::Parse(ConstByteSpan frame) {
   uint64_t address;
@@ -99,6 +135,25 @@ Result<Frame> Decoder::Process(const byte new_byte) {
   PW_CRASH("Bad decoder state");
 }
 
+size_t Decoder::ProcessRun(ConstByteSpan data) {
+  switch (state_) {
+    case State::kInterFrame: {
+      const size_t discarded =
+          std::find(data.begin(), data.end(), kFlag) - data.begin();
+      current_frame_size_ += discarded;
+      return discarded;
+    }
+    case State::kFrame: {
+      const size_t run = FindControlByte(data);
+      AppendBytes(data.first(run));
+      return run;
+    }
+    case State::kFrameEscape:
+      return 0;
+  }
+  PW_CRASH("Bad decoder state");
+}
+
 void Decoder::AppendByte(byte new_byte) {
   if (current_frame_size_ < max_size()) {
     buffer_[current_frame_size_] = new_byte;
@@ -117,6 +172,39 @@ void Decoder::AppendByte(byte new_byte) {
   current_frame_size_ += 1;
 }
 
+void Decoder::AppendBytes(ConstByteSpan data) {
+  if (data.size() < last_read_bytes_.size()) {
+    for (byte b : data) {
+      AppendByte(b);
+    }
+    return;
+  }
+
+  if (current_frame_size_ < max_size()) {
+    std::memcpy(&buffer_[current_frame_size_],
+                data.data(),
+                std::min(data.size(), max_size() - current_frame_size_));
+  }
+
+  // The data replaces everything in the ring buffer, so add its bytes to the
+  // checksum, oldest first, followed by all but the last four bytes of the
+  // data. The ring buffer is only full once four bytes have been read.
+  const size_t ring_size = last_read_bytes_.size();
+  if (current_frame_size_ >= ring_size) {
+    for (size_t i = 0; i < ring_size; ++i) {
+      fcs_.Update(last_read_bytes_[(last_read_bytes_index_ + i) % ring_size]);
+    }
+  } else {
+    fcs_.Update(std::span(last_read_bytes_).first(current_frame_size_));
+  }
+
+  fcs_.Update(data.first(data.size() - ring_size));
+  std::memcpy(last_read_bytes_.data(), data.last(ring_size).data(), ring_size);
+  last_read_bytes_index_ = 0;
+
+  current_frame_size_ += data.size();
+}
+
 Status Decoder::CheckFrame() const {
   // Empty frames are not an error; repeated flag characters are okay.
   if (current_frame_size_ == 0u) {
@@ -16,10 +16,13 @@
 
 #include <array>
 #include <cstddef>
+#include <cstring>
 
 #include "gtest/gtest.h"
 #include "pw_bytes/array.h"
+#include "pw_hdlc/encoder.h"
 #include "pw_hdlc/internal/protocol.h"
+#include "pw_stream/memory_stream.h"
 
 namespace pw::hdlc {
 namespace {
@@ -152,5 +155,154 @@ TEST(Decoder, TooLargeForBuffer_DecodesNextFrame) {
   EXPECT_EQ(OkStatus(), decoder.Process(kFlag).status());
 }
 
+// The status and data of a decoded frame, copied so that it outlives the
+// decoder's buffer.
+struct DecodedFrame {
+  Status status;
+  uint64_t address;
+  size_t size;
+  std::array<byte, 64> data;
+
+  bool operator==(const DecodedFrame& other) const {
+    return status == other.status && address == other.address &&
+           size == other.size && std::memcmp(data.data(), other.data.data(),
+                                             size) == 0;
+  }
+};
+
+struct DecodedFrames {
+  void Add(const Result<Frame>& result) {
+    ASSERT_LT(count, frames.size());
+    DecodedFrame& frame = frames[count++];
+    frame = {result.status(), 0, 0, {}};
+    if (result.ok()) {
+      frame.address = result.value().address();
+      frame.size = result.value().data().size();
+      std::memcpy(frame.data.data(), result.value().data().data(), frame.size);
+    }
+  }
+
+  bool operator==(const DecodedFrames& other) const {
+    return count == other.count && std::equal(frames.begin(),
+                                              frames.begin() + count,
+                                              other.frames.begin());
+  }
+
+  std::array<DecodedFrame, 16> frames;
+  size_t count = 0;
+};
+
+// A stream with valid frames that contain escaped bytes and long unescaped
+// runs, mixed with frames that are too large, corrupt, or incomplete.
+class DecodeSpanTest : public ::testing::Test {
+ protected:
+  DecodeSpanTest() : writer_(stream_) {
+    for (size_t i = 0; i < payload_.size(); ++i) {
+      payload_[i] = static_cast<byte>(i * 37 + 0x70);
+    }
+    payload_[10] = kEscape;
+    payload_[25] = kFlag;
+    payload_[26] = kEscape;
+    payload_[60] = kFlag;
+    const ConstByteSpan payload(payload_);
+
+    EXPECT_EQ(OkStatus(), WriteUIFrame(1, payload.first(40), writer_));
+    EXPECT_EQ(OkStatus(), WriteUIFrame(2, bytes::String("~}~}"), writer_));
+    Append(bytes::String("discarded before a frame"));
+    EXPECT_EQ(OkStatus(), WriteUIFrame(3, payload, writer_));  // Too large
+    EXPECT_EQ(OkStatus(), WriteUIFrame(4, {}, writer_));
+    EXPECT_EQ(OkStatus(), WriteUIFrame(5, payload.first(3), writer_));
+    Append(bytes::String("~123456789abcdef~"));  // Bad FCS
+    Append(bytes::String("~12}}34~"));           // Double escape
+    Append(bytes::String("~12}~"));              // Escaped flag
+    EXPECT_EQ(OkStatus(), WriteUIFrame(6, payload.subspan(20, 30), writer_));
+    Append(bytes::String("~abc"));  // Incomplete
+  }
+
+  template <size_t kSize>
+  void Append(const std::array<byte, kSize>& data) {
+    EXPECT_EQ(OkStatus(), writer_.Write(data));
+  }
+
+  ConstByteSpan stream() const { return writer_.WrittenData(); }
+
+  DecodedFrames DecodeByteByByte() {
+    DecodedFrames frames;
+    DecoderBuffer<64> decoder;
+    for (byte b : stream()) {
+      Result<Frame> result = decoder.Process(b);
+      if (result.status() != Status::Unavailable()) {
+        frames.Add(result);
+      }
+    }
+    return frames;
+  }
+
+  DecodedFrames DecodeInChunks(size_t chunk_size) {
+    DecodedFrames frames;
+    DecoderBuffer<64> decoder;
+    for (ConstByteSpan data = stream(); !data.empty();) {
+      const size_t size = std::min(chunk_size, data.size());
+      decoder.Process(data.first(size), [&frames](const Result<Frame>& result) {
+        frames.Add(result);
+      });
+      data = data.subspan(size);
+    }
+    return frames;
+  }
+
+ private:
+  std::array<byte, 96> payload_;
+  std::array<byte, 512> stream_;
+  stream::MemoryWriter writer_;
+};
+
+TEST_F(DecodeSpanTest, MatchesByteByByte) {
+  const DecodedFrames expected = DecodeByteByByte();
+  ASSERT_EQ(expected.count, 10u);
+
+  const std::array<DecodedFrame, 16>& frames = expected.frames;
+  EXPECT_EQ(frames[0].status, OkStatus());
+  EXPECT_EQ(frames[0].size, 40u);
+  EXPECT_EQ(frames[1].status, OkStatus());
+  EXPECT_EQ(frames[1].size, 4u);
+  EXPECT_EQ(frames[2].status, Status::DataLoss());  // Discarded bytes
+  EXPECT_EQ(frames[3].status, Status::ResourceExhausted());
+  EXPECT_EQ(frames[4].status, OkStatus());
+  EXPECT_EQ(frames[5].status, OkStatus());
+  EXPECT_EQ(frames[6].status, Status::DataLoss());  // Bad FCS
+  EXPECT_EQ(frames[7].status, Status::DataLoss());  // Double escape
+  EXPECT_EQ(frames[8].status, Status::DataLoss());  // Escaped flag
+  EXPECT_EQ(frames[9].status, OkStatus());
+  EXPECT_EQ(frames[9].address, 6u);
+  EXPECT_EQ(frames[9].size, 30u);
+
+  EXPECT_TRUE(DecodeInChunks(stream().size()) == expected);
+}
+
+TEST_F(DecodeSpanTest, MatchesByteByByte_InChunks) {
+  const DecodedFrames expected = DecodeByteByByte();
+
+  for (size_t chunk_size : {1, 2, 3, 5, 7, 8, 13, 64}) {
+    EXPECT_TRUE(DecodeInChunks(chunk_size) == expected);
+  }
+}
+
+TEST(Decoder, ProcessSpan_TooLargeForBuffer_StaysWithinBufferBoundaries) {
+  std::array<byte, 16> buffer = bytes::Initialized<16>('?');
+
+  Decoder decoder(std::span(buffer.data(), 8));
+  Status status = Status::Unknown();
+
+  decoder.Process(
+      bytes::String("~12345678901234567890\xf2\x19\x63\x90~"),
+      [&status](const Result<Frame>& result) { status = result.status(); });
+
+  for (size_t i = 8; i < buffer.size(); ++i) {
+    ASSERT_EQ(byte{'?'}, buffer[i]);
+  }
+  EXPECT_EQ(Status::ResourceExhausted(), status);
+}
+
 }  // namespace
 }  // namespace pw::hdlc
@@ -22,6 +22,7 @@
 
 #include "pw_bytes/endian.h"
 #include "pw_hdlc/internal/encoder.h"
+#include "pw_stream/memory_stream.h"
 #include "pw_varint/varint.h"
 
 using std::byte;
@@ -44,8 +45,12 @@ Status Encoder::WriteData(ConstByteSpan data) {
   while (true) {
     auto end = std::find_if(begin, data.end(), NeedsEscaping);
 
-    if (Status status = writer_.Write(std::span(begin, end)); !status.ok()) {
-      return status;
+    // Write each run of bytes that don't need escaping with one call. Skip
+    // empty runs, such as between consecutive escaped bytes.
+    if (begin != end) {
+      if (Status status = writer_.Write(std::span(begin, end)); !status.ok()) {
+        return status;
+      }
     }
     if (end == data.end()) {
       fcs_.Update(data);
@@ -95,16 +100,48 @@ Status Encoder::StartFrame(uint64_t address, std::byte control) {
   return WriteData(std::span(metadata_buffer).first(metadata_size));
 }
 
+Status WriteFrame(uint64_t address,
+                  std::byte control,
+                  ConstByteSpan payload,
+                  stream::Writer& writer) {
+  if (Encoder::MaxEncodedSize(address, payload) >
+      writer.ConservativeWriteLimit()) {
+    return Status::ResourceExhausted();
+  }
+
+  Encoder encoder(writer);
+
+  if (Status status = encoder.StartFrame(address, control); !status.ok()) {
+    return status;
+  }
+  if (Status status = encoder.WriteData(payload); !status.ok()) {
+    return status;
+  }
+  return encoder.FinishFrame();
+}
+
 }  // namespace internal
 
 Status WriteUIFrame(uint64_t address,
                     ConstByteSpan payload,
                     stream::Writer& writer) {
-  if (internal::Encoder::MaxEncodedSize(address, payload) >
-      writer.ConservativeWriteLimit()) {
+  return internal::WriteFrame(
+      address, UFrameControl::UnnumberedInformation().data(), payload, writer);
+}
+
+size_t MaxEncodedUIFrameSize(uint64_t address, ConstByteSpan payload) {
+  return internal::Encoder::MaxEncodedSize(address, payload) +
+         2 * sizeof(kFlag);
+}
+
+Result<ConstByteSpan> EncodeUIFrame(uint64_t address,
+                                    ConstByteSpan payload,
+                                    ByteSpan buffer) {
+  if (MaxEncodedUIFrameSize(address, payload) > buffer.size()) {
     return Status::ResourceExhausted();
   }
 
+  stream::MemoryWriter writer(buffer);
   internal::Encoder encoder(writer);
 
   if (Status status = encoder.StartUnnumberedFrame(address); !status.ok()) {
@@ -113,7 +150,10 @@ Status WriteUIFrame(uint64_t address,
   if (Status status = encoder.WriteData(payload); !status.ok()) {
     return status;
   }
-  return encoder.FinishFrame();
+  if (Status status = encoder.FinishFrame(); !status.ok()) {
+    return status;
+  }
+  return writer.WrittenData();
 }
 
 }  // namespace pw::hdlc
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 
 #include "gtest/gtest.h"
 #include "pw_bytes/array.h"
@@ -192,6 +193,83 @@ TEST(WriteUnnumberedFrame, WriterError) {
             WriteUIFrame(kAddress, bytes::Array<0x01>(), writer));
 }
 
+// Counts the calls to Write(), which must not be empty.
+class CountingWriter : public stream::Writer {
+ public:
+  CountingWriter(ByteSpan buffer) : writer_(buffer) {}
+
+  size_t writes() const { return writes_; }
+
+ private:
+  Status DoWrite(ConstByteSpan data) override {
+    EXPECT_FALSE(data.empty());
+    writes_ += 1;
+    return writer_.Write(data);
+  }
+
+  stream::MemoryWriter writer_;
+  size_t writes_ = 0;
+};
+
+TEST(WriteUnnumberedFrame, WritesUnescapedRunsInOneCall) {
+  std::array<byte, 64> buffer;
+  CountingWriter writer(buffer);
+
+  ASSERT_EQ(OkStatus(),
+            WriteUIFrame(kAddress, bytes::String("0123456789abcdef"), writer));
+  // Flag, address and control, payload, FCS, and flag.
+  EXPECT_EQ(writer.writes(), 5u);
+}
+
+TEST(WriteUnnumberedFrame, ConsecutiveEscapes_NoEmptyWrites) {
+  std::array<byte, 64> buffer;
+  CountingWriter writer(buffer);
+
+  ASSERT_EQ(OkStatus(),
+            WriteUIFrame(kAddress, bytes::String("ab~}~}cd"), writer));
+  // Flag, address and control, "ab", four escapes, "cd", FCS, and flag.
+  EXPECT_EQ(writer.writes(), 10u);
+}
+
+TEST(EncodeUIFrame, MatchesWriteUIFrame) {
+  constexpr auto kPayload =
+      bytes::Array<0x7E, 0x7B, 0x61, 0x62, 0x63, 0x7D, 0x7E>();
+
+  std::array<byte, 32> written;
+  stream::MemoryWriter writer(written);
+  ASSERT_EQ(OkStatus(), WriteUIFrame(kAddress, kPayload, writer));
+
+  std::array<byte, 32> buffer;
+  Result<ConstByteSpan> frame = EncodeUIFrame(kAddress, kPayload, buffer);
+  ASSERT_EQ(OkStatus(), frame.status());
+  EXPECT_EQ(frame.value().data(), buffer.data());
+  ASSERT_EQ(frame.value().size(), writer.bytes_written());
+  EXPECT_EQ(0,
+            std::memcmp(
+                frame.value().data(), written.data(), frame.value().size()));
+}
+
+TEST(EncodeUIFrame, ExactFit) {
+  constexpr auto kPayload = bytes::String("~}");
+  // Flags, address, control, escaped payload, and worst-case FCS.
+  constexpr size_t kMaxSize = 2 + 2 + 1 + 4 + 8;
+  ASSERT_EQ(kMaxSize, MaxEncodedUIFrameSize(kAddress, kPayload));
+
+  std::array<byte, kMaxSize> buffer;
+  EXPECT_EQ(OkStatus(), EncodeUIFrame(kAddress, kPayload, buffer).status());
+}
+
+TEST(EncodeUIFrame, BufferTooSmall_EncodesNothing) {
+  constexpr auto kPayload = bytes::String("~}");
+  std::array<byte, 16> buffer = bytes::Initialized<16>('?');
+
+  EXPECT_EQ(Status::ResourceExhausted(),
+            EncodeUIFrame(kAddress, kPayload, buffer).status());
+  for (byte b : buffer) {
+    ASSERT_EQ(byte{'?'}, b);
+  }
+}
+
 }  // namespace
 
 namespace internal {
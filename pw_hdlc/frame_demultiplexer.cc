@@ -0,0 +1,49 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/frame_demultiplexer.h"
+
+#include <algorithm>
+
+namespace pw::hdlc {
+
+Status FrameDemultiplexer::HandleFrame(const Frame& frame) {
+  auto route = std::find_if(routes_.begin(), routes_.end(), [&](auto& r) {
+    return r.address == frame.address();
+  });
+  if (route == routes_.end()) {
+    route_errors_.Increment();
+    return Status::NotFound();
+  }
+
+  Status status = route->handler.HandleFrame(frame);
+  if (!status.ok()) {
+    handler_errors_.Increment();
+  }
+  return status;
+}
+
+Status FrameDemultiplexer::Process(const Result<Frame>& result) {
+  if (result.ok()) {
+    return HandleFrame(result.value());
+  }
+  if (result.status().IsUnavailable()) {
+    return OkStatus();
+  }
+
+  decode_errors_.Increment();
+  return result.status();
+}
+
+}  // namespace pw::hdlc
@@ -0,0 +1,160 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/frame_demultiplexer.h"
+
+#include <array>
+#include <cstddef>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+#include "pw_hdlc/encoder.h"
+#include "pw_router/egress_function.h"
+
+namespace pw::hdlc {
+namespace {
+
+using std::byte;
+
+constexpr uint64_t kRpcAddress = 'R';
+constexpr uint64_t kLogAddress = 1;
+constexpr uint64_t kEgressAddress = 1234;
+
+// Decodes a frame with the given address and payload.
+class TestFrame {
+ public:
+  TestFrame(uint64_t address, ConstByteSpan payload) : decoder_(buffer_) {
+    std::array<byte, 64> encoded;
+    Result<ConstByteSpan> result = EncodeUIFrame(address, payload, encoded);
+    EXPECT_EQ(OkStatus(), result.status());
+    decoder_.Process(result.value(), [this](const Result<Frame>& frame) {
+      result_ = frame;
+    });
+  }
+
+  const Result<Frame>& result() const { return result_; }
+  const Frame& frame() const { return result_.value(); }
+
+ private:
+  std::array<byte, 64> buffer_;
+  Decoder decoder_;
+  Result<Frame> result_ = Status::Unknown();
+};
+
+class TestChannelOutput : public rpc::ChannelOutput {
+ public:
+  TestChannelOutput() : ChannelOutput("test") {}
+
+  std::span<byte> AcquireBuffer() override { return buffer_; }
+  Status SendAndReleaseBuffer(std::span<const byte>) override {
+    return OkStatus();
+  }
+
+ private:
+  std::array<byte, 64> buffer_;
+};
+
+class FrameDemultiplexerTest : public ::testing::Test {
+ protected:
+  FrameDemultiplexerTest()
+      : rpc_handler_(server_, output_),
+        egress_([this](ConstByteSpan packet, const router::PacketMetadata&) {
+          egress_packets_ += 1;
+          last_egress_packet_size_ = packet.size();
+          return OkStatus();
+        }),
+        egress_handler_(egress_),
+        log_handler_([this](const Frame& frame) {
+          log_frames_ += 1;
+          last_log_frame_ = frame.data().data();
+          return OkStatus();
+        }),
+        routes_{{
+            {kRpcAddress, rpc_handler_},
+            {kLogAddress, log_handler_},
+            {kEgressAddress, egress_handler_},
+        }},
+        demux_(routes_) {}
+
+  rpc::Server server_{std::span<rpc::Channel>()};
+  TestChannelOutput output_;
+  RpcFrameHandler rpc_handler_;
+
+  router::EgressFunction egress_;
+  EgressFrameHandler egress_handler_;
+  int egress_packets_ = 0;
+  size_t last_egress_packet_size_ = 0;
+
+  FrameHandlerFunction log_handler_;
+  int log_frames_ = 0;
+  const byte* last_log_frame_ = nullptr;
+
+  std::array<FrameDemultiplexer::Route, 3> routes_;
+  FrameDemultiplexer demux_;
+};
+
+TEST_F(FrameDemultiplexerTest, DispatchesByAddress) {
+  TestFrame log(kLogAddress, bytes::String("log message"));
+  ASSERT_EQ(OkStatus(), log.result().status());
+  EXPECT_EQ(OkStatus(), demux_.HandleFrame(log.frame()));
+  EXPECT_EQ(log_frames_, 1);
+  EXPECT_EQ(egress_packets_, 0);
+
+  TestFrame routed(kEgressAddress, bytes::String("routed"));
+  ASSERT_EQ(OkStatus(), routed.result().status());
+  EXPECT_EQ(OkStatus(), demux_.HandleFrame(routed.frame()));
+  EXPECT_EQ(log_frames_, 1);
+  EXPECT_EQ(egress_packets_, 1);
+  EXPECT_EQ(last_egress_packet_size_, 6u);
+
+  EXPECT_EQ(demux_.dropped_frames(), 0u);
+}
+
+TEST_F(FrameDemultiplexerTest, HandlerReceivesDecodedFrame) {
+  TestFrame log(kLogAddress, bytes::String("log message"));
+  ASSERT_EQ(OkStatus(), demux_.HandleFrame(log.frame()));
+  EXPECT_EQ(last_log_frame_, log.frame().data().data());
+}
+
+TEST_F(FrameDemultiplexerTest, RpcHandler_PassesPayloadToServer) {
+  // The payload is not a valid RPC packet, so the server rejects it.
+  TestFrame rpc(kRpcAddress, bytes::String("not a packet"));
+  EXPECT_EQ(Status::DataLoss(), demux_.HandleFrame(rpc.frame()));
+  EXPECT_EQ(demux_.dropped_frames(), 1u);
+}
+
+TEST_F(FrameDemultiplexerTest, UnknownAddress_NotFound) {
+  TestFrame frame(99, bytes::String("hello"));
+  EXPECT_EQ(Status::NotFound(), demux_.HandleFrame(frame.frame()));
+  EXPECT_EQ(demux_.dropped_frames(), 1u);
+}
+
+TEST_F(FrameDemultiplexerTest, Process_IgnoresUnavailable) {
+  EXPECT_EQ(OkStatus(), demux_.Process(Status::Unavailable()));
+  EXPECT_EQ(demux_.dropped_frames(), 0u);
+}
+
+TEST_F(FrameDemultiplexerTest, Process_CountsDecodeErrors) {
+  EXPECT_EQ(Status::DataLoss(), demux_.Process(Status::DataLoss()));
+  EXPECT_EQ(demux_.dropped_frames(), 1u);
+}
+
+TEST_F(FrameDemultiplexerTest, Process_DispatchesFrames) {
+  TestFrame log(kLogAddress, bytes::String("log message"));
+  EXPECT_EQ(OkStatus(), demux_.Process(log.result()));
+  EXPECT_EQ(log_frames_, 1);
+}
+
+}  // namespace
+}  // namespace pw::hdlc
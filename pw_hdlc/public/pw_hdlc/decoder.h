@@ -96,11 +96,20 @@ class Decoder {
   Result<Frame> Process(std::byte b);
 
   // Processes a span of data and calls the provided callback with each frame or
-  // error.
+  // error. Runs of bytes without flag or escape bytes are found a word at a
+  // time and copied and checksummed in bulk, so this is much faster than
+  // calling Process(std::byte) for each byte.
   template <typename F, typename... Args>
   void Process(ConstByteSpan data, F&& callback, Args&&... args) {
-    for (std::byte b : data) {
-      auto result = Process(b);
+    while (true) {
+      data = data.subspan(ProcessRun(data));
+      if (data.empty()) {
+        return;
+      }
+
+      auto result = Process(data.front());
+      data = data.subspan(1);
+
       if (result.status() != Status::Unavailable()) {
         std::invoke(
             std::forward<F>(callback), std::forward<Args>(args)..., result);
@@ -131,8 +140,17 @@ class Decoder {
     fcs_.clear();
   }
 
+  // Consumes bytes from the start of the data that cannot complete a frame:
+  // unescaped bytes in a frame or discarded bytes between frames. Returns the
+  // number of bytes consumed.
+  size_t ProcessRun(ConstByteSpan data);
+
   void AppendByte(std::byte new_byte);
 
+  // Appends unescaped bytes to the frame. Equivalent to calling AppendByte for
+  // each byte.
+  void AppendBytes(ConstByteSpan data);
+
   Status CheckFrame() const;
 
   bool VerifyFrameCheckSequence() const;
@@ -14,6 +14,7 @@
 #pragma once
 
 #include "pw_bytes/span.h"
+#include "pw_result/result.h"
 #include "pw_status/status.h"
 #include "pw_stream/stream.h"
 
@@ -33,4 +34,16 @@ Status WriteUIFrame(uint64_t address,
                     ConstByteSpan payload,
                     stream::Writer& writer);
 
+// Returns the worst-case size of the encoded UI-frame for a payload, including
+// both flag bytes. Scans the payload for bytes that must be escaped.
+size_t MaxEncodedUIFrameSize(uint64_t address, ConstByteSpan payload);
+
+// Encodes an HDLC UI-frame into a contiguous buffer and returns the encoded
+// frame, so that it can be sent in a single transfer, such as a UART DMA.
+// Returns RESOURCE_EXHAUSTED without encoding anything if the buffer is smaller
+// than MaxEncodedUIFrameSize(address, payload).
+Result<ConstByteSpan> EncodeUIFrame(uint64_t address,
+                                    ConstByteSpan payload,
+                                    ByteSpan buffer);
+
 }  // namespace pw::hdlc
@@ -0,0 +1,131 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "pw_function/function.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_hdlc/frame_handler.h"
+#include "pw_metric/metric.h"
+#include "pw_result/result.h"
+#include "pw_router/egress.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/server.h"
+#include "pw_status/status.h"
+
+namespace pw::hdlc {
+
+// Passes the payload of each frame to an RPC server as a packet.
+class RpcFrameHandler final : public FrameHandler {
+ public:
+  constexpr RpcFrameHandler(rpc::Server& server, rpc::ChannelOutput& output)
+      : server_(server), output_(output) {}
+
+  Status HandleFrame(const Frame& frame) final {
+    return server_.ProcessPacket(frame.data(), output_);
+  }
+
+ private:
+  rpc::Server& server_;
+  rpc::ChannelOutput& output_;
+};
+
+// Forwards the payload of each frame to a router egress.
+class EgressFrameHandler final : public FrameHandler {
+ public:
+  constexpr EgressFrameHandler(router::Egress& egress) : egress_(egress) {}
+
+  Status HandleFrame(const Frame& frame) final {
+    return egress_.SendPacket(frame.data(), {});
+  }
+
+ private:
+  router::Egress& egress_;
+};
+
+// Calls a function with each frame, for example to print log frames.
+class FrameHandlerFunction final : public FrameHandler {
+ public:
+  FrameHandlerFunction(Function<Status(const Frame&)> function)
+      : function_(std::move(function)) {}
+
+  Status HandleFrame(const Frame& frame) final { return function_(frame); }
+
+ private:
+  Function<Status(const Frame&)> function_;
+};
+
+// Dispatches decoded HDLC frames to handlers by address, using a static
+// table. Frames are decoded once and each handler receives the Frame, so links
+// that carry several services, such as RPC and logs, don't parse each frame
+// once per service.
+//
+//   RpcFrameHandler rpc_handler(server, rpc_output);
+//   FrameHandlerFunction log_handler(PrintLogFrame);
+//
+//   constexpr FrameDemultiplexer::Route kRoutes[] = {
+//       {kDefaultRpcAddress, rpc_handler},
+//       {kLogAddress, log_handler},
+//   };
+//   FrameDemultiplexer demux(kRoutes);
+//
+//   decoder.Process(received_data, [](const Result<Frame>& result) {
+//     demux.Process(result);
+//   });
+//
+// The demultiplexer is not synchronized. Call it from the thread that decodes
+// frames.
+class FrameDemultiplexer {
+ public:
+  struct Route {
+    uint64_t address;
+    FrameHandler& handler;
+  };
+
+  FrameDemultiplexer(std::span<const Route> routes)
+      : routes_(routes) {}
+
+  FrameDemultiplexer(const FrameDemultiplexer&) = delete;
+  FrameDemultiplexer& operator=(const FrameDemultiplexer&) = delete;
+
+  uint32_t dropped_frames() const {
+    return decode_errors_.value() + route_errors_.value() +
+           handler_errors_.value();
+  }
+
+  const metric::Group& metrics() { return metrics_; }
+
+  // Dispatches a frame to the handler for its address. Returns one of:
+  //
+  //   OK - The handler accepted the frame.
+  //   NOT_FOUND - There is no route for the frame's address.
+  //   Other - The status returned by the handler.
+  //
+  Status HandleFrame(const Frame& frame);
+
+  // Dispatches the result of a Decoder. Decoding errors are counted and
+  // returned; UNAVAILABLE, which means no frame was completed, is ignored.
+  Status Process(const Result<Frame>& result);
+
+ private:
+  const std::span<const Route> routes_;
+  PW_METRIC_GROUP(metrics_, "hdlc_demux");
+  PW_METRIC(metrics_, decode_errors_, "decode_errors", 0u);
+  PW_METRIC(metrics_, route_errors_, "route_errors", 0u);
+  PW_METRIC(metrics_, handler_errors_, "handler_errors", 0u);
+};
+
+}  // namespace pw::hdlc
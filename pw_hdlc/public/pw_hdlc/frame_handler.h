@@ -0,0 +1,30 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_hdlc/decoder.h"
+#include "pw_status/status.h"
+
+namespace pw::hdlc {
+
+// Receives the decoded frames sent to an address.
+class FrameHandler {
+ public:
+  virtual ~FrameHandler() = default;
+
+  // Handles a frame. The frame is only valid for the duration of the call.
+  virtual Status HandleFrame(const Frame& frame) = 0;
+};
+
+}  // namespace pw::hdlc
@@ -36,6 +36,11 @@ class Encoder {
     return StartFrame(address, UFrameControl::UnnumberedInformation().data());
   }
 
+  // Writes the header for a frame with the given control field. After
+  // successfully calling StartFrame, WriteData may be called any number of
+  // times.
+  Status StartFrame(uint64_t address, std::byte control);
+
   // Writes data for an ongoing frame. Must only be called after a successful
   // StartInformationFrame call, and prior to a FinishFrame() call.
   Status WriteData(ConstByteSpan data);
@@ -51,10 +56,16 @@ class Encoder {
   // Indicates this an information packet with sequence numbers set to 0.
   static constexpr std::byte kUnusedControl = std::byte{0};
 
-  Status StartFrame(uint64_t address, std::byte control);
-
   stream::Writer& writer_;
   checksum::Crc32 fcs_;
 };
 
+// Writes a complete frame with the given control field. Returns
+// RESOURCE_EXHAUSTED without writing anything if the frame may not fit in the
+// writer's ConservativeWriteLimit().
+Status WriteFrame(uint64_t address,
+                  std::byte control,
+                  ConstByteSpan payload,
+                  stream::Writer& writer);
+
 }  // namespace pw::hdlc::internal
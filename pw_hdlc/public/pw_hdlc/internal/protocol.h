@@ -13,7 +13,9 @@
 // the License.
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 
 #include "pw_varint/varint.h"
 
@@ -61,4 +63,86 @@ class UFrameControl {
   std::byte data_;
 };
 
+// Numbered frames use modulo-8 sequence numbers, so that the control field is a
+// single byte.
+inline constexpr uint8_t kSequenceModulus = 8;
+
+// Class that manages the 1-byte control field of an HDLC I-frame:
+//
+//   bit 0: 0
+//   bits 1-3: N(S), the sequence number of this frame
+//   bit 4: poll/final (unused)
+//   bits 5-7: N(R), the next sequence number the sender expects to receive
+//
+class IFrameControl {
+ public:
+  constexpr IFrameControl(uint8_t send_sequence, uint8_t receive_sequence)
+      : data_(std::byte((receive_sequence & kSequenceMask) << 5 |
+                        (send_sequence & kSequenceMask) << 1)) {}
+
+  // I-frames are identified by having the bottom control bit cleared.
+  static constexpr bool Matches(std::byte control) {
+    return (control & std::byte{0x01}) == std::byte{0};
+  }
+
+  static constexpr uint8_t SendSequence(std::byte control) {
+    return (std::to_integer<uint8_t>(control) >> 1) & kSequenceMask;
+  }
+
+  static constexpr uint8_t ReceiveSequence(std::byte control) {
+    return std::to_integer<uint8_t>(control) >> 5;
+  }
+
+  constexpr std::byte data() const { return data_; }
+
+ private:
+  static constexpr uint8_t kSequenceMask = kSequenceModulus - 1;
+
+  std::byte data_;
+};
+
+// Class that manages the 1-byte control field of an HDLC S-frame:
+//
+//   bits 0-1: 01
+//   bits 2-3: supervisory function
+//   bit 4: poll/final (unused)
+//   bits 5-7: N(R)
+//
+class SFrameControl {
+ public:
+  // Types of HDLC S-frames and their bit patterns.
+  enum Type : uint8_t {
+    kReceiveReady = 0x0,
+    kReceiveNotReady = 0x1,
+    kReject = 0x2,
+    kSelectiveReject = 0x3,
+  };
+
+  constexpr SFrameControl(Type type, uint8_t receive_sequence)
+      : data_(std::byte((receive_sequence & kSequenceMask) << 5 | type << 2) |
+              kSFramePattern) {}
+
+  static constexpr bool Matches(std::byte control) {
+    return (control & std::byte{0x03}) == kSFramePattern;
+  }
+
+  static constexpr Type GetType(std::byte control) {
+    return static_cast<Type>((std::to_integer<uint8_t>(control) >> 2) & 0x3);
+  }
+
+  static constexpr uint8_t ReceiveSequence(std::byte control) {
+    return std::to_integer<uint8_t>(control) >> 5;
+  }
+
+  constexpr std::byte data() const { return data_; }
+
+ private:
+  static constexpr uint8_t kSequenceMask = kSequenceModulus - 1;
+
+  // S-frames are identified by having the bottom two control bits set to 01.
+  static constexpr std::byte kSFramePattern = std::byte{0x01};
+
+  std::byte data_;
+};
+
 }  // namespace pw::hdlc
@@ -0,0 +1,190 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_function/function.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_hdlc/frame_handler.h"
+#include "pw_hdlc/internal/protocol.h"
+#include "pw_metric/metric.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+
+namespace pw::hdlc {
+
+// Sends and receives payloads over one HDLC address with numbered I-frames, so
+// that frames lost to corruption are repaired at the link layer instead of by
+// retrying whole RPCs.
+//
+// Frames carry modulo-8 send and receive sequence numbers. Up to window_size
+// frames may be unacknowledged at once. When a frame arrives out of order, the
+// receiver keeps it and sends a selective reject (SREJ) S-frame for each
+// missing frame, and the sender retransmits only those frames, so a loss costs
+// one round trip. Received payloads are delivered in order. Frames are
+// acknowledged by the receive sequence number of I-frames and of receive ready
+// (RR) S-frames, which are sent when frames are delivered.
+//
+//   ReliableLinkBuffer<kMaxPayload> link(
+//       kRpcAddress, uart_writer, [&](ConstByteSpan payload) {
+//         server.ProcessPacket(payload, rpc_output);
+//       });
+//
+//   constexpr FrameDemultiplexer::Route kRoutes[] = {{kRpcAddress, link}};
+//
+// Both ends of the link must use ReliableLink with the same window size. UI-
+// frames received on the address are delivered as they arrive.
+//
+// If the last frame sent or an SREJ is lost, nothing prompts a retransmission,
+// so the owner must call RetransmitUnacknowledged() when frames have been
+// unacknowledged for longer than the round trip time.
+//
+// ReliableLink is not synchronized. Calls to Send(), HandleFrame(), and
+// RetransmitUnacknowledged() must not run concurrently.
+class ReliableLink : public FrameHandler {
+ public:
+  // SREJ requires that the window is at most half of the sequence numbers, so
+  // that new frames are not mistaken for retransmissions.
+  static constexpr size_t kMaxWindowSize = 4;
+
+  // The send and receive buffers are divided into window_size slots, each of
+  // which holds one payload. window_size must be 1, 2, or 4.
+  ReliableLink(uint64_t address,
+               stream::Writer& writer,
+               ByteSpan send_buffer,
+               ByteSpan receive_buffer,
+               size_t window_size,
+               Function<void(ConstByteSpan)> deliver);
+
+  ReliableLink(const ReliableLink&) = delete;
+  ReliableLink& operator=(const ReliableLink&) = delete;
+
+  // The largest payload that can be sent or received.
+  size_t max_payload_size() const { return slot_size_; }
+
+  // True if another frame can be sent without waiting for an acknowledgement.
+  bool window_open() const { return outstanding_frames() < window_size_; }
+
+  // The number of frames sent but not yet acknowledged.
+  size_t outstanding_frames() const {
+    return SequenceDistance(acknowledged_, send_sequence_);
+  }
+
+  // Copies the payload into the send window and writes it as an I-frame.
+  // Returns:
+  //
+  //   OK - The frame was written and will be retransmitted until it is
+  //       acknowledged.
+  //   UNAVAILABLE - The send window is full; wait for acknowledgements.
+  //   RESOURCE_EXHAUSTED - The payload is larger than max_payload_size().
+  //   Other - The writer failed. The frame is in the window, so it is sent
+  //       again by RetransmitUnacknowledged().
+  //
+  Status Send(ConstByteSpan payload);
+
+  // Processes a frame received on the link's address: acknowledges and
+  // retransmits sent frames, and delivers received payloads in order. Returns
+  // DATA_LOSS if the frame is invalid, or an error from writing an
+  // acknowledgement.
+  Status HandleFrame(const Frame& frame) final;
+
+  // Retransmits every frame that has not been acknowledged. Call this when
+  // frames have been outstanding longer than the link's round trip time.
+  Status RetransmitUnacknowledged();
+
+  const metric::Group& metrics() { return metrics_; }
+
+ private:
+  static constexpr uint8_t SequenceDistance(uint8_t from, uint8_t to) {
+    return (to - from) & (kSequenceModulus - 1);
+  }
+
+  static constexpr uint8_t NextSequence(uint8_t sequence) {
+    return (sequence + 1) & (kSequenceModulus - 1);
+  }
+
+  size_t Slot(uint8_t sequence) const { return sequence % window_size_; }
+
+  ByteSpan SendSlot(uint8_t sequence) const {
+    return send_buffer_.subspan(Slot(sequence) * slot_size_, slot_size_);
+  }
+
+  ByteSpan ReceiveSlot(uint8_t sequence) const {
+    return receive_buffer_.subspan(Slot(sequence) * slot_size_, slot_size_);
+  }
+
+  Status WriteInformationFrame(uint8_t sequence);
+  Status WriteSupervisoryFrame(SFrameControl::Type type, uint8_t sequence);
+
+  void Acknowledge(uint8_t receive_sequence);
+  Status ReceiveInformation(uint8_t sequence, ConstByteSpan payload);
+
+  const uint64_t address_;
+  stream::Writer& writer_;
+  const ByteSpan send_buffer_;
+  const ByteSpan receive_buffer_;
+  const uint8_t window_size_;
+  const size_t slot_size_;
+  Function<void(ConstByteSpan)> deliver_;
+
+  // V(S), the sequence number of the next frame to send, and the oldest frame
+  // that has not been acknowledged.
+  uint8_t send_sequence_ = 0;
+  uint8_t acknowledged_ = 0;
+
+  // V(R), the sequence number of the next frame to deliver.
+  uint8_t receive_sequence_ = 0;
+
+  // Out-of-order frames held in each receive slot, and the missing frames
+  // that have already been selectively rejected.
+  std::array<size_t, kMaxWindowSize> send_sizes_ = {};
+  std::array<size_t, kMaxWindowSize> received_sizes_ = {};
+  std::array<bool, kMaxWindowSize> received_ = {};
+  std::array<bool, kMaxWindowSize> rejected_ = {};
+
+  PW_METRIC_GROUP(metrics_, "hdlc_reliable_link");
+  PW_METRIC(metrics_, retransmitted_frames_, "retransmitted_frames", 0u);
+  PW_METRIC(metrics_, selective_rejects_, "selective_rejects", 0u);
+  PW_METRIC(metrics_, out_of_order_frames_, "out_of_order_frames", 0u);
+  PW_METRIC(metrics_, duplicate_frames_, "duplicate_frames", 0u);
+};
+
+// A ReliableLink with send and receive windows for payloads of up to
+// kMaxPayloadSizeBytes.
+template <size_t kMaxPayloadSizeBytes,
+          size_t kWindowSize = ReliableLink::kMaxWindowSize>
+class ReliableLinkBuffer : public ReliableLink {
+ public:
+  ReliableLinkBuffer(uint64_t address,
+                     stream::Writer& writer,
+                     Function<void(ConstByteSpan)> deliver)
+      : ReliableLink(address,
+                     writer,
+                     send_buffer_,
+                     receive_buffer_,
+                     kWindowSize,
+                     std::move(deliver)) {}
+
+ private:
+  static_assert(kWindowSize == 1 || kWindowSize == 2 || kWindowSize == 4);
+
+  std::array<std::byte, kMaxPayloadSizeBytes * kWindowSize> send_buffer_;
+  std::array<std::byte, kMaxPayloadSizeBytes * kWindowSize> receive_buffer_;
+};
+
+}  // namespace pw::hdlc
@@ -0,0 +1,120 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <functional>  // std::invoke
+
+#include "pw_bytes/span.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+
+namespace pw::hdlc {
+
+// Decodes the escaped contents of one HDLC frame -- the data between two flag
+// bytes -- in place, and returns a Frame that refers to the data. Bytes are
+// only moved if the frame contains escape bytes. Returns DATA_LOSS if the
+// frame is invalid: it contains an invalid escape sequence, is too short, or
+// has the wrong frame check sequence.
+Result<Frame> DecodeFrameInPlace(ByteSpan frame);
+
+// Decodes HDLC frames in place in a circular receive buffer, such as the
+// target of a circular DMA transfer. Unlike Decoder, it does not copy frames
+// into a separate buffer. Frames that do not contain escape bytes are returned
+// as views into the ring, and escaped frames are unescaped in place. Only
+// frames that wrap around the end of the ring are copied, into the scratch
+// buffer.
+//
+// The ring buffer must be written in order, wrapping around at its end. The
+// writer must not overwrite bytes from read_index() onwards until they are
+// processed.
+//
+//   RingBufferDecoder decoder(dma_buffer, scratch_buffer);
+//
+//   void OnUartIdle() {
+//     decoder.Process(DmaWriteIndex(), [](const Result<Frame>& frame) {
+//       if (frame.ok()) {
+//         HandleFrame(frame.value());
+//       }
+//     });
+//   }
+//
+class RingBufferDecoder {
+ public:
+  constexpr RingBufferDecoder(ByteSpan ring, ByteSpan scratch)
+      : ring_(ring),
+        scratch_(scratch),
+        scan_index_(0),
+        frame_start_(0),
+        discarded_bytes_(0),
+        in_frame_(false) {}
+
+  RingBufferDecoder(const RingBufferDecoder&) = delete;
+  RingBufferDecoder& operator=(const RingBufferDecoder&) = delete;
+
+  // Processes the bytes written to the ring up to, but not including,
+  // write_index, and calls the provided callback with each frame or error. The
+  // statuses are the same as Decoder::Process, except that a frame that wraps
+  // around the end of the ring and is larger than the scratch buffer is
+  // reported as RESOURCE_EXHAUSTED without being checked. Frames refer to the
+  // ring or scratch buffer, so they are only valid during the callback.
+  template <typename F, typename... Args>
+  void Process(size_t write_index, F&& callback, Args&&... args) {
+    while (true) {
+      Result<Frame> result = Next(write_index);
+      if (result.status() == Status::Unavailable()) {
+        return;
+      }
+      std::invoke(
+          std::forward<F>(callback), std::forward<Args>(args)..., result);
+    }
+  }
+
+  // Returns the next frame or error in the bytes up to write_index, or
+  // UNAVAILABLE if there are no more. The frame is invalidated by the next
+  // call.
+  Result<Frame> Next(size_t write_index);
+
+  // The index of the first byte that has not been fully processed. The bytes
+  // from here up to the last write index belong to an incomplete frame.
+  size_t read_index() const { return in_frame_ ? frame_start_ : scan_index_; }
+
+  // Clears and resets the decoder, and resumes reading at the index.
+  void Clear(size_t read_index = 0) {
+    scan_index_ = read_index;
+    frame_start_ = read_index;
+    discarded_bytes_ = 0;
+    in_frame_ = false;
+  }
+
+ private:
+  Result<Frame> DecodeFrame(size_t begin, size_t end);
+
+  const ByteSpan ring_;
+  const ByteSpan scratch_;
+
+  // The index of the next byte to scan for a flag.
+  size_t scan_index_;
+
+  // The index of the first byte after the flag that started the current frame.
+  size_t frame_start_;
+
+  // Bytes read between frames, which are reported as an error.
+  size_t discarded_bytes_;
+
+  bool in_frame_;
+};
+
+}  // namespace pw::hdlc
@@ -32,6 +32,7 @@ _LOG = logging.getLogger(__name__)
 
 STDOUT_ADDRESS = 1
 DEFAULT_ADDRESS = ord('R')
+BINARY_LOG_ADDRESS = ord('L')
 
 
 def channel_output(writer: Callable[[bytes], Any],
@@ -63,19 +64,33 @@ def _handle_error(frame: Frame) -> None:
 
 
 FrameHandlers = Dict[int, Callable[[Frame], Any]]
+BatchFrameHandlers = Dict[int, Callable[[List[Frame]], Any]]
 
 
-def read_and_process_data(read: Callable[[], bytes],
-                          on_read_error: Callable[[Exception], Any],
-                          frame_handlers: FrameHandlers,
-                          error_handler: Callable[[Frame],
-                                                  Any] = _handle_error,
-                          handler_threads: Optional[int] = 1) -> NoReturn:
+def read_and_process_data(
+        read: Callable[[], bytes],
+        on_read_error: Callable[[Exception], Any],
+        frame_handlers: FrameHandlers,
+        error_handler: Callable[[Frame], Any] = _handle_error,
+        handler_threads: Optional[int] = 1,
+        batch_frame_handlers: Optional[BatchFrameHandlers] = None
+) -> NoReturn:
     """Continuously reads and handles HDLC frames.
 
     Passes frames to an executor that calls frame handler functions in other
-    threads.
+    threads. Frames for an address in batch_frame_handlers are collected from
+    each read and passed to its handler together, in the order they were
+    read, after the frames for other addresses in that read.
     """
+    if batch_frame_handlers is None:
+        batch_frame_handlers = {}
+
+    def handle_batch(address: int, frames: List[Frame]):
+        try:
+            batch_frame_handlers[address](frames)
+        except:  # pylint: disable=bare-except
+            _LOG.exception('Exception in HDLC frame handler thread')
+
     def handle_frame(frame: Frame):
         try:
             if not frame.ok():
@@ -106,8 +121,16 @@ def read_and_process_data(read: Callable[[], bytes],
             if data:
                 _LOG.debug('Read %2d B: %s', len(data), data)
 
+                batches: Dict[int, List[Frame]] = {}
+
                 for frame in decoder.process_valid_frames(data):
-                    executor.submit(handle_frame, frame)
+                    if frame.address in batch_frame_handlers:
+                        batches.setdefault(frame.address, []).append(frame)
+                    else:
+                        executor.submit(handle_frame, frame)
+
+                for address, frames in batches.items():
+                    executor.submit(handle_batch, address, frames)
 
 
 def write_to_file(data: bytes, output: BinaryIO = sys.stdout.buffer):
@@ -127,7 +150,8 @@ class HdlcRpcClient:
                                          python_protos.Library],
                  channels: Iterable[pw_rpc.Channel],
                  output: Callable[[bytes], Any] = write_to_file,
-                 client_impl: pw_rpc.client.ClientImpl = None):
+                 client_impl: pw_rpc.client.ClientImpl = None,
+                 binary_log_handler: Callable[[bytes], Any] = None):
         """Creates an RPC client configured to communicate using HDLC.
 
         Args:
@@ -135,6 +159,8 @@ class HdlcRpcClient:
           paths_or_modules: paths to .proto files or proto modules
           channel: RPC channels to use for output
           output: where to write "stdout" output from the device
+          binary_log_handler: called with the payload of each frame sent to
+              BINARY_LOG_ADDRESS, such as binary tokenized logs
         """
         if isinstance(paths_or_modules, python_protos.Library):
             self.protos = paths_or_modules
@@ -147,15 +173,21 @@ class HdlcRpcClient:
         self.client = pw_rpc.Client.from_modules(client_impl, channels,
                                                  self.protos.modules())
         frame_handlers: FrameHandlers = {
-            DEFAULT_ADDRESS: self._handle_rpc_packet,
             STDOUT_ADDRESS: lambda frame: output(frame.data),
         }
+        if binary_log_handler is not None:
+            frame_handlers[BINARY_LOG_ADDRESS] = (
+                lambda frame: binary_log_handler(frame.data))
+        batch_frame_handlers: BatchFrameHandlers = {
+            DEFAULT_ADDRESS: self._handle_rpc_packets,
+        }
 
         # Start background thread that reads and processes RPC packets.
         threading.Thread(target=read_and_process_data,
                          daemon=True,
-                         args=(read, lambda exc: None,
-                               frame_handlers)).start()
+                         args=(read, lambda exc: None, frame_handlers),
+                         kwargs=dict(
+                             batch_frame_handlers=batch_frame_handlers)).start()
 
     def rpcs(self, channel_id: int = None) -> Any:
         """Returns object for accessing services on the specified channel.
@@ -169,6 +201,8 @@ class HdlcRpcClient:
 
         return self.client.channel(channel_id).rpcs
 
-    def _handle_rpc_packet(self, frame: Frame) -> None:
-        if not self.client.process_packet(frame.data):
-            _LOG.error('Packet not handled by RPC client: %s', frame.data)
+    def _handle_rpc_packets(self, frames: List[Frame]) -> None:
+        statuses = self.client.process_packets(frame.data for frame in frames)
+        for frame, status in zip(frames, statuses):
+            if not status.ok():
+                _LOG.error('Packet not handled by RPC client: %s', frame.data)
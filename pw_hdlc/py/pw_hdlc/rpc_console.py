@@ -36,15 +36,18 @@ import glob
 import logging
 from pathlib import Path
 import sys
-from typing import Any, Collection, Iterable, Iterator
+from typing import Any, Callable, Collection, Iterable, Iterator, Optional
 import socket
 
 import IPython  # type: ignore
 import serial  # type: ignore
 
 from pw_hdlc.rpc import HdlcRpcClient, default_channels, write_to_file
+from pw_log_tokenized import FormatStringWithMetadata, Metadata
+from pw_tokenizer.detokenize import AutoUpdatingDetokenizer, Detokenizer
 
 _LOG = logging.getLogger(__name__)
+_DEVICE_LOG = logging.getLogger('device')
 
 PW_RPC_MAX_PACKET_SIZE = 256
 SOCKET_SERVER = 'localhost'
@@ -74,6 +77,14 @@ def _parse_args():
                        type=str,
                        help='use socket to connect to server, type default for\
             localhost:33000, or manually input the server address:port')
+    parser.add_argument(
+        '--token-databases',
+        metavar='elf_or_token_database',
+        nargs='+',
+        type=Path,
+        default=[],
+        help=('Token databases or ELF files with which to detokenize binary '
+              'logs (HDLC address L)'))
     parser.add_argument('proto_globs',
                         nargs='+',
                         help='glob pattern for .proto files')
@@ -121,8 +132,33 @@ class SocketClientImpl:
         return self.socket.recv(num_bytes)
 
 
-def console(device: str, baudrate: int, proto_globs: Collection[str],
-            socket_addr: str, output: Any) -> int:
+def _binary_log_handler(detokenizer: Detokenizer) -> Callable[[bytes], None]:
+    """Returns a function that detokenizes and logs binary tokenized logs."""
+    def handle_log(data: bytes) -> None:
+        payload, message = detokenizer.detokenize_with_payload(data)
+        if payload is None or not message.ok():
+            _LOG.error('Failed to detokenize binary log: %s', data.hex())
+            return
+
+        metadata = Metadata(payload)
+        log = FormatStringWithMetadata(str(message))
+        # pw_log levels are 1 (DEBUG) through 5 (CRITICAL), which match the
+        # Python logging levels when multiplied by 10.
+        if log.module:
+            _DEVICE_LOG.log(metadata.log_level * 10, '[%s] %s', log.module,
+                            log.message)
+        else:
+            _DEVICE_LOG.log(metadata.log_level * 10, '%s', log.message)
+
+    return handle_log
+
+
+def console(device: str,
+            baudrate: int,
+            proto_globs: Collection[str],
+            socket_addr: str,
+            output: Any,
+            token_databases: Collection[Path] = ()) -> int:
     """Starts an interactive RPC console for HDLC."""
     # argparse.FileType doesn't correctly handle '-' for binary files.
     if output is sys.stdout:
@@ -155,9 +191,17 @@ def console(device: str, baudrate: int, proto_globs: Collection[str],
             _LOG.exception('Failed to initialize socket at %s', socket_addr)
             return 1
 
+    binary_log_handler: Optional[Callable[[bytes], None]] = None
+    if token_databases:
+        binary_log_handler = _binary_log_handler(
+            AutoUpdatingDetokenizer(*token_databases))
+
     _start_ipython_terminal(
-        HdlcRpcClient(read, protos, default_channels(write),
-                      lambda data: write_to_file(data, output)))
+        HdlcRpcClient(read,
+                      protos,
+                      default_channels(write),
+                      lambda data: write_to_file(data, output),
+                      binary_log_handler=binary_log_handler))
     return 0
 
 
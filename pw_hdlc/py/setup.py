@@ -26,8 +26,10 @@ setuptools.setup(
     zip_safe=False,
     install_requires=[
         'ipython',
+        'pw_log_tokenized',
         'pw_protobuf_compiler',
         'pw_rpc',
+        'pw_tokenizer',
     ],
     tests_require=['pw_build'],
 )
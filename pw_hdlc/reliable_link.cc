@@ -0,0 +1,192 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/reliable_link.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pw_assert/check.h"
+#include "pw_hdlc/internal/encoder.h"
+
+namespace pw::hdlc {
+
+ReliableLink::ReliableLink(uint64_t address,
+                           stream::Writer& writer,
+                           ByteSpan send_buffer,
+                           ByteSpan receive_buffer,
+                           size_t window_size,
+                           Function<void(ConstByteSpan)> deliver)
+    : address_(address),
+      writer_(writer),
+      send_buffer_(send_buffer),
+      receive_buffer_(receive_buffer),
+      window_size_(static_cast<uint8_t>(window_size)),
+      slot_size_(std::min(send_buffer.size(), receive_buffer.size()) /
+                 window_size),
+      deliver_(std::move(deliver)) {
+  PW_CHECK(window_size == 1 || window_size == 2 || window_size == 4,
+           "The window size must be 1, 2, or 4");
+}
+
+Status ReliableLink::Send(ConstByteSpan payload) {
+  if (payload.size() > slot_size_) {
+    return Status::ResourceExhausted();
+  }
+  if (!window_open()) {
+    return Status::Unavailable();
+  }
+
+  const uint8_t sequence = send_sequence_;
+  std::memcpy(SendSlot(sequence).data(), payload.data(), payload.size());
+  send_sizes_[Slot(sequence)] = payload.size();
+  send_sequence_ = NextSequence(sequence);
+
+  return WriteInformationFrame(sequence);
+}
+
+Status ReliableLink::HandleFrame(const Frame& frame) {
+  const std::byte control = frame.control();
+
+  if (IFrameControl::Matches(control)) {
+    Acknowledge(IFrameControl::ReceiveSequence(control));
+    return ReceiveInformation(IFrameControl::SendSequence(control),
+                              frame.data());
+  }
+
+  if (SFrameControl::Matches(control)) {
+    const uint8_t sequence = SFrameControl::ReceiveSequence(control);
+    switch (SFrameControl::GetType(control)) {
+      case SFrameControl::kReceiveReady:
+      case SFrameControl::kReceiveNotReady:
+        Acknowledge(sequence);
+        return OkStatus();
+      case SFrameControl::kReject:
+        // Go-back-N: the frames before N(R) were received, and every frame
+        // from N(R) on must be sent again.
+        Acknowledge(sequence);
+        return RetransmitUnacknowledged();
+      case SFrameControl::kSelectiveReject:
+        // SREJ only requests N(R); it does not acknowledge earlier frames.
+        if (SequenceDistance(acknowledged_, sequence) >=
+            outstanding_frames()) {
+          return OkStatus();  // The frame was already acknowledged.
+        }
+        retransmitted_frames_.Increment();
+        return WriteInformationFrame(sequence);
+    }
+  }
+
+  if (control == UFrameControl::UnnumberedInformation().data()) {
+    deliver_(frame.data());
+    return OkStatus();
+  }
+  return Status::DataLoss();
+}
+
+Status ReliableLink::RetransmitUnacknowledged() {
+  Status status;
+  for (uint8_t sequence = acknowledged_; sequence != send_sequence_;
+       sequence = NextSequence(sequence)) {
+    retransmitted_frames_.Increment();
+    status.Update(WriteInformationFrame(sequence));
+  }
+  return status;
+}
+
+Status ReliableLink::WriteInformationFrame(uint8_t sequence) {
+  return internal::WriteFrame(
+      address_,
+      IFrameControl(sequence, receive_sequence_).data(),
+      SendSlot(sequence).first(send_sizes_[Slot(sequence)]),
+      writer_);
+}
+
+Status ReliableLink::WriteSupervisoryFrame(SFrameControl::Type type,
+                                           uint8_t sequence) {
+  return internal::WriteFrame(
+      address_,
+      SFrameControl(type, sequence).data(),
+      ConstByteSpan(),
+      writer_);
+}
+
+void ReliableLink::Acknowledge(uint8_t receive_sequence) {
+  // Ignore N(R) outside of the frames that were sent, such as from a stale
+  // retransmission.
+  if (SequenceDistance(acknowledged_, receive_sequence) <=
+      outstanding_frames()) {
+    acknowledged_ = receive_sequence;
+  }
+}
+
+Status ReliableLink::ReceiveInformation(uint8_t sequence,
+                                        ConstByteSpan payload) {
+  const uint8_t offset = SequenceDistance(receive_sequence_, sequence);
+
+  if (offset >= window_size_) {
+    // A retransmission of a frame that was already delivered, probably because
+    // the acknowledgement was lost. Acknowledge it again.
+    duplicate_frames_.Increment();
+    return WriteSupervisoryFrame(SFrameControl::kReceiveReady,
+                                 receive_sequence_);
+  }
+
+  if (offset != 0) {
+    // Keep the out-of-order frame and request each missing frame once.
+    const size_t slot = Slot(sequence);
+    if (received_[slot]) {
+      duplicate_frames_.Increment();
+      return OkStatus();
+    }
+    if (payload.size() > slot_size_) {
+      return Status::DataLoss();
+    }
+    out_of_order_frames_.Increment();
+    std::memcpy(ReceiveSlot(sequence).data(), payload.data(), payload.size());
+    received_sizes_[slot] = payload.size();
+    received_[slot] = true;
+
+    Status status;
+    for (uint8_t missing = receive_sequence_; missing != sequence;
+         missing = NextSequence(missing)) {
+      const size_t missing_slot = Slot(missing);
+      if (!received_[missing_slot] && !rejected_[missing_slot]) {
+        rejected_[missing_slot] = true;
+        selective_rejects_.Increment();
+        status.Update(
+            WriteSupervisoryFrame(SFrameControl::kSelectiveReject, missing));
+      }
+    }
+    return status;
+  }
+
+  // The next frame in order: deliver it, then any held frames that follow it.
+  deliver_(payload);
+  rejected_[Slot(receive_sequence_)] = false;
+  receive_sequence_ = NextSequence(receive_sequence_);
+
+  while (received_[Slot(receive_sequence_)]) {
+    const size_t slot = Slot(receive_sequence_);
+    deliver_(ReceiveSlot(receive_sequence_).first(received_sizes_[slot]));
+    received_[slot] = false;
+    rejected_[slot] = false;
+    receive_sequence_ = NextSequence(receive_sequence_);
+  }
+
+  return WriteSupervisoryFrame(SFrameControl::kReceiveReady,
+                               receive_sequence_);
+}
+
+}  // namespace pw::hdlc
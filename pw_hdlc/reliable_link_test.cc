@@ -0,0 +1,223 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/reliable_link.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+#include "pw_hdlc/encoder.h"
+
+namespace pw::hdlc {
+namespace {
+
+using std::byte;
+
+constexpr uint64_t kAddress = 'R';
+
+// Holds the frames written by one end of a link until they are transferred to
+// the other end.
+class Wire : public stream::Writer {
+ public:
+  ConstByteSpan data() const { return std::span(buffer_).first(size_); }
+  void clear() { size_ = 0; }
+
+ private:
+  Status DoWrite(ConstByteSpan data) override {
+    if (data.size() > buffer_.size() - size_) {
+      return Status::ResourceExhausted();
+    }
+    std::memcpy(&buffer_[size_], data.data(), data.size());
+    size_ += data.size();
+    return OkStatus();
+  }
+
+  std::array<byte, 512> buffer_;
+  size_t size_ = 0;
+};
+
+// One end of a link. Payloads are single characters, which are recorded in the
+// order they are delivered.
+class Endpoint {
+ public:
+  Endpoint()
+      : link_(kAddress, wire_, [this](ConstByteSpan payload) {
+          ASSERT_EQ(payload.size(), 1u);
+          delivered_[delivered_count_++] = std::to_integer<char>(payload[0]);
+        }) {}
+
+  ReliableLinkBuffer<8>& link() { return link_; }
+  Wire& wire() { return wire_; }
+
+  std::string_view delivered() const {
+    return std::string_view(delivered_.data(), delivered_count_);
+  }
+
+  Status Send(char c) { return link_.Send(std::as_bytes(std::span(&c, 1))); }
+
+  // Passes the frames written by this end to the other end, except for the
+  // frame at index drop. Returns the number of frames written.
+  size_t TransferTo(Endpoint& other, size_t drop = kDropNone) {
+    size_t frames = 0;
+    DecoderBuffer<32> decoder;
+    decoder.Process(wire_.data(), [&](const Result<Frame>& result) {
+      ASSERT_EQ(OkStatus(), result.status());
+      if (frames++ != drop) {
+        EXPECT_EQ(OkStatus(), other.link_.HandleFrame(result.value()));
+      }
+    });
+    wire_.clear();
+    return frames;
+  }
+
+  static constexpr size_t kDropNone = static_cast<size_t>(-1);
+
+ private:
+  Wire wire_;
+  ReliableLinkBuffer<8> link_;
+  std::array<char, 16> delivered_;
+  size_t delivered_count_ = 0;
+};
+
+class ReliableLinkTest : public ::testing::Test {
+ protected:
+  Endpoint a_;
+  Endpoint b_;
+};
+
+TEST_F(ReliableLinkTest, DeliversInOrderAndAcknowledges) {
+  ASSERT_EQ(OkStatus(), a_.Send('0'));
+  ASSERT_EQ(OkStatus(), a_.Send('1'));
+  ASSERT_EQ(OkStatus(), a_.Send('2'));
+  EXPECT_EQ(a_.link().outstanding_frames(), 3u);
+
+  EXPECT_EQ(a_.TransferTo(b_), 3u);
+  EXPECT_EQ(b_.delivered(), "012");
+
+  // B acknowledges each frame with an RR.
+  EXPECT_EQ(b_.TransferTo(a_), 3u);
+  EXPECT_EQ(a_.link().outstanding_frames(), 0u);
+}
+
+TEST_F(ReliableLinkTest, WindowFull_Unavailable) {
+  for (char c : std::string_view("0123")) {
+    ASSERT_EQ(OkStatus(), a_.Send(c));
+  }
+  EXPECT_FALSE(a_.link().window_open());
+  EXPECT_EQ(Status::Unavailable(), a_.Send('4'));
+
+  a_.TransferTo(b_);
+  b_.TransferTo(a_);
+  EXPECT_TRUE(a_.link().window_open());
+  EXPECT_EQ(OkStatus(), a_.Send('4'));
+}
+
+TEST_F(ReliableLinkTest, PayloadTooLarge) {
+  constexpr auto payload = bytes::Initialized<9>(0x55);
+  EXPECT_EQ(Status::ResourceExhausted(), a_.link().Send(payload));
+  EXPECT_EQ(a_.link().outstanding_frames(), 0u);
+}
+
+TEST_F(ReliableLinkTest, LostFrame_RepairedWithSelectiveReject) {
+  ASSERT_EQ(OkStatus(), a_.Send('0'));
+  ASSERT_EQ(OkStatus(), a_.Send('1'));
+  ASSERT_EQ(OkStatus(), a_.Send('2'));
+  ASSERT_EQ(OkStatus(), a_.Send('3'));
+
+  // Frame 1 is lost. B holds 2 and 3 and rejects 1.
+  EXPECT_EQ(a_.TransferTo(b_, 1), 4u);
+  EXPECT_EQ(b_.delivered(), "0");
+
+  // RR for frame 0 and a single SREJ for frame 1.
+  EXPECT_EQ(b_.TransferTo(a_), 2u);
+  EXPECT_EQ(a_.link().outstanding_frames(), 3u);
+
+  // A retransmits only frame 1, which completes the sequence.
+  EXPECT_EQ(a_.TransferTo(b_), 1u);
+  EXPECT_EQ(b_.delivered(), "0123");
+
+  b_.TransferTo(a_);
+  EXPECT_EQ(a_.link().outstanding_frames(), 0u);
+}
+
+TEST_F(ReliableLinkTest, LostLastFrame_RetransmitUnacknowledged) {
+  ASSERT_EQ(OkStatus(), a_.Send('0'));
+  ASSERT_EQ(OkStatus(), a_.Send('1'));
+  a_.TransferTo(b_, 1);
+  b_.TransferTo(a_);
+  EXPECT_EQ(a_.link().outstanding_frames(), 1u);
+
+  // Nothing tells A that frame 1 was lost, so the owner retransmits it.
+  ASSERT_EQ(OkStatus(), a_.link().RetransmitUnacknowledged());
+  EXPECT_EQ(a_.TransferTo(b_), 1u);
+  EXPECT_EQ(b_.delivered(), "01");
+
+  b_.TransferTo(a_);
+  EXPECT_EQ(a_.link().outstanding_frames(), 0u);
+}
+
+TEST_F(ReliableLinkTest, LostAcknowledgement_DuplicateIsAcknowledgedAgain) {
+  ASSERT_EQ(OkStatus(), a_.Send('0'));
+  a_.TransferTo(b_);
+  b_.TransferTo(a_, 0);  // The RR is lost.
+  EXPECT_EQ(a_.link().outstanding_frames(), 1u);
+
+  ASSERT_EQ(OkStatus(), a_.link().RetransmitUnacknowledged());
+  a_.TransferTo(b_);
+  EXPECT_EQ(b_.delivered(), "0");  // Not delivered twice.
+
+  EXPECT_EQ(b_.TransferTo(a_), 1u);
+  EXPECT_EQ(a_.link().outstanding_frames(), 0u);
+}
+
+TEST_F(ReliableLinkTest, BothDirections_PiggybackedAcknowledgements) {
+  ASSERT_EQ(OkStatus(), a_.Send('a'));
+  a_.TransferTo(b_);
+  b_.wire().clear();  // Drop B's RR; its I-frame acknowledges instead.
+
+  ASSERT_EQ(OkStatus(), b_.Send('b'));
+  b_.TransferTo(a_);
+  EXPECT_EQ(a_.delivered(), "b");
+  EXPECT_EQ(a_.link().outstanding_frames(), 0u);
+}
+
+TEST_F(ReliableLinkTest, SequenceNumbersWrap) {
+  std::string_view payloads = "0123456789abcdef";
+  for (char c : payloads) {
+    ASSERT_EQ(OkStatus(), a_.Send(c));
+    a_.TransferTo(b_);
+    b_.TransferTo(a_);
+  }
+  EXPECT_EQ(b_.delivered(), payloads);
+  EXPECT_EQ(a_.link().outstanding_frames(), 0u);
+}
+
+TEST_F(ReliableLinkTest, UnnumberedFrame_Delivered) {
+  std::array<byte, 32> encoded;
+  auto frame = EncodeUIFrame(kAddress, bytes::Array<'u'>(), encoded);
+  ASSERT_EQ(OkStatus(), frame.status());
+
+  DecoderBuffer<32> decoder;
+  decoder.Process(frame.value(), [this](const Result<Frame>& result) {
+    ASSERT_EQ(OkStatus(), result.status());
+    EXPECT_EQ(OkStatus(), b_.link().HandleFrame(result.value()));
+  });
+  EXPECT_EQ(b_.delivered(), "u");
+}
+
+}  // namespace
+}  // namespace pw::hdlc
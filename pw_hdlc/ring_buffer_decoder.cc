@@ -0,0 +1,118 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/ring_buffer_decoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pw_assert/assert.h"
+#include "pw_bytes/endian.h"
+#include "pw_checksum/crc32.h"
+#include "pw_hdlc/internal/protocol.h"
+
+namespace pw::hdlc {
+
+Result<Frame> DecodeFrameInPlace(ByteSpan frame) {
+  // Unescaping never makes the data longer, so the unescaped bytes are written
+  // over the escaped data. Nothing is moved before the first escape byte.
+  auto in = std::find(frame.begin(), frame.end(), kEscape);
+  size_t size = in - frame.begin();
+
+  while (in != frame.end()) {
+    std::byte b = *in++;
+    if (b == kEscape) {
+      // An escape must be followed by a byte other than an escape. This also
+      // rejects escaped flags, which end the frame data with an escape.
+      if (in == frame.end() || *in == kEscape) {
+        return Status::DataLoss();
+      }
+      b = Escape(*in++);
+    }
+    frame[size++] = b;
+  }
+
+  if (size < Frame::kMinSizeBytes) {
+    return Status::DataLoss();
+  }
+
+  const ConstByteSpan data = frame.first(size - sizeof(uint32_t));
+  const uint32_t fcs = bytes::ReadInOrder<uint32_t>(
+      std::endian::little, frame.subspan(data.size()).data());
+  if (checksum::Crc32::Calculate(data) != fcs) {
+    return Status::DataLoss();
+  }
+
+  return Frame::Parse(frame.first(size));
+}
+
+Result<Frame> RingBufferDecoder::Next(size_t write_index) {
+  PW_DASSERT(write_index < ring_.size());
+
+  while (scan_index_ != write_index) {
+    // Scan up to the write index or the end of the ring, whichever is first.
+    const size_t end = write_index > scan_index_ ? write_index : ring_.size();
+    const ByteSpan segment = ring_.subspan(scan_index_, end - scan_index_);
+    const size_t flag =
+        std::find(segment.begin(), segment.end(), kFlag) - segment.begin();
+
+    if (!in_frame_) {
+      discarded_bytes_ += flag;
+    }
+
+    if (flag == segment.size()) {
+      scan_index_ = end % ring_.size();
+      continue;
+    }
+
+    const size_t flag_index = scan_index_ + flag;
+    const size_t frame_start = frame_start_;
+    scan_index_ = (flag_index + 1) % ring_.size();
+    frame_start_ = scan_index_;
+
+    if (!in_frame_) {
+      in_frame_ = true;
+
+      // Report an error if non-flag bytes were read before the first frame.
+      if (discarded_bytes_ != 0u) {
+        discarded_bytes_ = 0;
+        return Status::DataLoss();
+      }
+    } else if (frame_start != flag_index) {
+      // Repeated flag bytes are not an error; only decode non-empty frames.
+      return DecodeFrame(frame_start, flag_index);
+    }
+  }
+
+  return Status::Unavailable();
+}
+
+Result<Frame> RingBufferDecoder::DecodeFrame(size_t begin, size_t end) {
+  if (begin < end) {
+    return DecodeFrameInPlace(ring_.subspan(begin, end - begin));
+  }
+
+  // The frame wraps around the end of the ring, so join it in the scratch
+  // buffer.
+  const size_t first_part = ring_.size() - begin;
+  if (first_part + end > scratch_.size()) {
+    return Status::ResourceExhausted();
+  }
+
+  std::memcpy(scratch_.data(), &ring_[begin], first_part);
+  std::memcpy(scratch_.data() + first_part, ring_.data(), end);
+  return DecodeFrameInPlace(scratch_.first(first_part + end));
+}
+
+}  // namespace pw::hdlc
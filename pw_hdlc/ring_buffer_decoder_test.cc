@@ -0,0 +1,247 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/ring_buffer_decoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+#include "pw_hdlc/encoder.h"
+#include "pw_hdlc/internal/protocol.h"
+
+namespace pw::hdlc {
+namespace {
+
+using std::byte;
+
+constexpr uint64_t kAddress = 0x7B;
+
+template <size_t kSizeBytes>
+class EncodedFrame {
+ public:
+  EncodedFrame(ConstByteSpan payload) {
+    Result<ConstByteSpan> result = EncodeUIFrame(kAddress, payload, buffer_);
+    EXPECT_EQ(OkStatus(), result.status());
+    size_ = result.value().size();
+  }
+
+  ConstByteSpan data() const { return std::span(buffer_).first(size_); }
+
+  // The escaped data between the flags.
+  ConstByteSpan contents() const { return data().subspan(1, size_ - 2); }
+
+ private:
+  std::array<byte, kSizeBytes> buffer_;
+  size_t size_;
+};
+
+TEST(DecodeFrameInPlace, NoEscapes_ReturnsViewOfData) {
+  EncodedFrame<32> encoded(bytes::String("hello"));
+  const ConstByteSpan contents = encoded.contents();
+  std::array<byte, 32> frame;
+  std::copy(contents.begin(), contents.end(), frame.begin());
+
+  Result<Frame> result =
+      DecodeFrameInPlace(std::span(frame).first(contents.size()));
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(result.value().address(), kAddress);
+  ASSERT_EQ(result.value().data().size(), 5u);
+  EXPECT_EQ(result.value().data().data(), &frame[2]);
+  EXPECT_EQ(0, std::memcmp(result.value().data().data(), "hello", 5));
+}
+
+TEST(DecodeFrameInPlace, Escapes_UnescapesInPlace) {
+  constexpr auto kPayload = bytes::String("a~b}c");
+  EncodedFrame<32> encoded(kPayload);
+  const ConstByteSpan contents = encoded.contents();
+  std::array<byte, 32> frame;
+  std::copy(contents.begin(), contents.end(), frame.begin());
+
+  Result<Frame> result =
+      DecodeFrameInPlace(std::span(frame).first(contents.size()));
+  ASSERT_EQ(OkStatus(), result.status());
+  ASSERT_EQ(result.value().data().size(), kPayload.size());
+  EXPECT_EQ(result.value().data().data(), &frame[2]);
+  EXPECT_EQ(0,
+            std::memcmp(result.value().data().data(),
+                        kPayload.data(),
+                        kPayload.size()));
+}
+
+TEST(DecodeFrameInPlace, InvalidFrames_DataLoss) {
+  auto bad_fcs = bytes::String("123456789abcdef");
+  EXPECT_EQ(Status::DataLoss(), DecodeFrameInPlace(bad_fcs).status());
+
+  auto too_short = bytes::String("12345");
+  EXPECT_EQ(Status::DataLoss(), DecodeFrameInPlace(too_short).status());
+
+  auto double_escape = bytes::String("1234}}5678");
+  EXPECT_EQ(Status::DataLoss(), DecodeFrameInPlace(double_escape).status());
+
+  auto trailing_escape = bytes::String("12345678}");
+  EXPECT_EQ(Status::DataLoss(), DecodeFrameInPlace(trailing_escape).status());
+}
+
+// Simulates a circular DMA transfer into a ring buffer.
+template <size_t kRingSize, size_t kScratchSize>
+class RingBufferDecoderTest : public ::testing::Test {
+ protected:
+  RingBufferDecoderTest() : decoder_(ring_, scratch_), write_index_(0) {}
+
+  void Receive(ConstByteSpan data) {
+    for (byte b : data) {
+      ring_[write_index_] = b;
+      write_index_ = (write_index_ + 1) % ring_.size();
+    }
+  }
+
+  std::array<byte, kRingSize> ring_;
+  std::array<byte, kScratchSize> scratch_;
+  RingBufferDecoder decoder_;
+  size_t write_index_;
+};
+
+using RingBufferDecoder64 = RingBufferDecoderTest<64, 32>;
+
+TEST_F(RingBufferDecoder64, FrameIsViewIntoRing) {
+  EncodedFrame<32> encoded(bytes::String("hello"));
+  Receive(encoded.data());
+
+  int frames = 0;
+  decoder_.Process(write_index_, [&](const Result<Frame>& result) {
+    frames += 1;
+    ASSERT_EQ(OkStatus(), result.status());
+    EXPECT_EQ(result.value().data().data(), &ring_[3]);
+    EXPECT_EQ(0, std::memcmp(result.value().data().data(), "hello", 5));
+  });
+  EXPECT_EQ(frames, 1);
+  EXPECT_EQ(decoder_.read_index(), write_index_);
+}
+
+TEST_F(RingBufferDecoder64, PartialFrame_DecodedWhenComplete) {
+  EncodedFrame<32> encoded(bytes::String("hello"));
+  Receive(encoded.data().first(6));
+
+  decoder_.Process(write_index_, [](const Result<Frame>&) { FAIL(); });
+  EXPECT_EQ(decoder_.read_index(), 1u);
+
+  Receive(encoded.data().subspan(6));
+
+  Status status = Status::Unknown();
+  decoder_.Process(write_index_, [&](const Result<Frame>& result) {
+    status = result.status();
+  });
+  EXPECT_EQ(OkStatus(), status);
+}
+
+TEST_F(RingBufferDecoder64, WrappedFrame_UsesScratchBuffer) {
+  Receive(bytes::Initialized<60>(0x7e));
+  decoder_.Process(write_index_, [](const Result<Frame>&) { FAIL(); });
+
+  EncodedFrame<32> encoded(bytes::String("hello"));
+  Receive(encoded.data().subspan(1));
+
+  int frames = 0;
+  decoder_.Process(write_index_, [&](const Result<Frame>& result) {
+    frames += 1;
+    ASSERT_EQ(OkStatus(), result.status());
+    EXPECT_EQ(result.value().data().data(), &scratch_[2]);
+    EXPECT_EQ(0, std::memcmp(result.value().data().data(), "hello", 5));
+  });
+  EXPECT_EQ(frames, 1);
+}
+
+TEST_F(RingBufferDecoder64, WrappedFrameTooLargeForScratch_ResourceExhausted) {
+  Receive(bytes::Initialized<40>(0x7e));
+  decoder_.Process(write_index_, [](const Result<Frame>&) { FAIL(); });
+
+  EncodedFrame<48> encoded(bytes::String("0123456789abcdef0123456789abcd"));
+  Receive(encoded.data().subspan(1));
+
+  Status status = Status::Unknown();
+  decoder_.Process(write_index_, [&](const Result<Frame>& result) {
+    status = result.status();
+  });
+  EXPECT_EQ(Status::ResourceExhausted(), status);
+}
+
+TEST_F(RingBufferDecoder64, BytesBeforeFirstFlag_DataLoss) {
+  Receive(bytes::String("xyz"));
+  EncodedFrame<32> encoded(bytes::String("hello"));
+  Receive(encoded.data());
+
+  std::array<Status, 2> statuses;
+  size_t count = 0;
+  decoder_.Process(write_index_, [&](const Result<Frame>& result) {
+    ASSERT_LT(count, statuses.size());
+    statuses[count++] = result.status();
+  });
+  ASSERT_EQ(count, 2u);
+  EXPECT_EQ(Status::DataLoss(), statuses[0]);
+  EXPECT_EQ(OkStatus(), statuses[1]);
+}
+
+TEST_F(RingBufferDecoder64, MatchesDecoder_AcrossManyWraps) {
+  std::array<byte, 512> stream;
+  size_t stream_size = 0;
+  auto append = [&](ConstByteSpan data) {
+    std::memcpy(&stream[stream_size], data.data(), data.size());
+    stream_size += data.size();
+  };
+
+  for (size_t i = 0; i < 20; ++i) {
+    std::array<byte, 12> payload;
+    for (size_t j = 0; j < payload.size(); ++j) {
+      payload[j] = static_cast<byte>(0x70 + (i * 5 + j * 3) % 16);
+    }
+    EncodedFrame<40> encoded(ConstByteSpan(payload).first(i % payload.size()));
+    append(encoded.data());
+    if (i % 7 == 3) {
+      append(bytes::String("~bad frame~"));
+    }
+  }
+
+  std::array<Status, 32> expected;
+  size_t expected_count = 0;
+  DecoderBuffer<32> reference;
+  reference.Process(std::span(stream).first(stream_size),
+                    [&](const Result<Frame>& result) {
+                      ASSERT_LT(expected_count, expected.size());
+                      expected[expected_count++] = result.status();
+                    });
+  ASSERT_EQ(expected_count, 23u);
+
+  std::array<Status, 32> actual;
+  size_t actual_count = 0;
+  for (size_t i = 0; i < stream_size; i += 7) {
+    const size_t size = std::min<size_t>(7, stream_size - i);
+    Receive(ConstByteSpan(stream).subspan(i, size));
+    decoder_.Process(write_index_, [&](const Result<Frame>& result) {
+      ASSERT_LT(actual_count, actual.size());
+      actual[actual_count++] = result.status();
+    });
+  }
+
+  ASSERT_EQ(actual_count, expected_count);
+  for (size_t i = 0; i < expected_count; ++i) {
+    EXPECT_EQ(actual[i], expected[i]);
+  }
+}
+
+}  // namespace
+}  // namespace pw::hdlc
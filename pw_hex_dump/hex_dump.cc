@@ -14,11 +14,14 @@
 
 #include "pw_hex_dump/hex_dump.h"
 
+#include <array>
 #include <cctype>
 #include <cstddef>
+#include <cstring>
 #include <string_view>
 
 #include "pw_status/status_with_size.h"
+#include "pw_status/try.h"
 #include "pw_string/string_builder.h"
 #include "pw_string/type_to_string.h"
 
@@ -37,6 +40,36 @@ constexpr const std::string_view kAsciiHeader("Text");
 // Minimum number of hex characters to use when displaying dump offset.
 constexpr const size_t kMinOffsetChars = 4;
 
+constexpr const char kHexDigits[] = "0123456789abcdef";
+
+// The two hex characters for each byte value, for BulkHexDumper.
+constexpr std::array<char, 512> kHexPairs = [] {
+  std::array<char, 512> pairs{};
+  for (size_t i = 0; i < 256; ++i) {
+    pairs[2 * i] = kHexDigits[i >> 4];
+    pairs[2 * i + 1] = kHexDigits[i & 0xF];
+  }
+  return pairs;
+}();
+
+// The ASCII interpretation of each byte value, for BulkHexDumper. Matches
+// PrintableChar() in the default "C" locale.
+constexpr std::array<char, 256> kAsciiChars = [] {
+  std::array<char, 256> chars{};
+  for (size_t i = 0; i < 256; ++i) {
+    chars[i] = (i >= 0x20 && i < 0x7f) ? static_cast<char>(i) : '.';
+  }
+  return chars;
+}();
+
+char* WriteHex(uintptr_t value, size_t digits, char* out) {
+  for (size_t i = digits; i > 0; --i) {
+    out[i - 1] = kHexDigits[value & 0xF];
+    value >>= 4;
+  }
+  return out + digits;
+}
+
 char PrintableChar(std::byte b) {
   if (std::isprint(std::to_integer<char>(b)) == 0) {
     return '.';
@@ -254,4 +287,98 @@ Status FormattedHexDumper::ValidateBufferSize() {
   return OkStatus();
 }
 
+void BulkHexDumper::BeginDump(ConstByteSpan data) {
+  current_offset_ = 0;
+  source_data_ = data;
+  offset_digits_ = std::max<uint8_t>(HexDigitCount(data.size_bytes()),
+                                     kMinOffsetChars);
+}
+
+size_t BulkHexDumper::prefix_length() const {
+  switch (prefix_mode_) {
+    case AddressMode::kOffset:
+      return offset_digits_ + kAddressSeparator.length();
+    case AddressMode::kAbsolute:
+      return kHexAddrStringSize + kAddressSeparator.length();
+    case AddressMode::kDisabled:
+      break;
+  }
+  return 0;
+}
+
+size_t BulkHexDumper::line_length() const {
+  // Each byte is two hex characters followed by a space, and the last byte's
+  // space is the first of the section separator.
+  return prefix_length() + kBytesPerLine * 3 + kSectionSeparator.length() - 1 +
+         kBytesPerLine + 1;
+}
+
+void BulkHexDumper::WriteLine(ConstByteSpan line, char* out) const {
+  if (prefix_mode_ == AddressMode::kOffset) {
+    out = WriteHex(current_offset_, offset_digits_, out);
+  } else if (prefix_mode_ == AddressMode::kAbsolute) {
+    *out++ = '0';
+    *out++ = 'x';
+    out = WriteHex(reinterpret_cast<uintptr_t>(line.data()),
+                   sizeof(uintptr_t) * 2,
+                   out);
+  }
+  if (prefix_mode_ != AddressMode::kDisabled) {
+    std::memcpy(out, kAddressSeparator.data(), kAddressSeparator.length());
+    out += kAddressSeparator.length();
+  }
+
+  // Pad short lines so the ASCII section stays aligned.
+  std::memset(out, ' ', kBytesPerLine * 3 + kSectionSeparator.length() - 1);
+  for (size_t i = 0; i < line.size(); ++i) {
+    const char* pair = &kHexPairs[2 * std::to_integer<uint8_t>(line[i])];
+    out[3 * i] = pair[0];
+    out[3 * i + 1] = pair[1];
+  }
+  out += kBytesPerLine * 3 + kSectionSeparator.length() - 1;
+
+  for (std::byte b : line) {
+    *out++ = kAsciiChars[std::to_integer<uint8_t>(b)];
+  }
+  *out = '\n';
+}
+
+StatusWithSize BulkHexDumper::DumpLines(std::span<char> dest) {
+  if (source_data_.empty()) {
+    return StatusWithSize::ResourceExhausted();
+  }
+
+  const size_t full_line_length = line_length();
+  size_t written = 0;
+  while (!source_data_.empty()) {
+    const size_t line_bytes = std::min(source_data_.size(), kBytesPerLine);
+    // A short line has no ASCII characters for its missing bytes.
+    const size_t length = full_line_length - (kBytesPerLine - line_bytes);
+    if (dest.size() - written < length) {
+      break;
+    }
+    WriteLine(source_data_.first(line_bytes), &dest[written]);
+    written += length;
+    source_data_ = source_data_.subspan(line_bytes);
+    current_offset_ += line_bytes;
+  }
+
+  if (written == 0) {
+    return StatusWithSize::FailedPrecondition();
+  }
+  return StatusWithSize(written);
+}
+
+Status BulkHexDumper::DumpLines(stream::Writer& writer,
+                                std::span<char> buffer) {
+  while (true) {
+    const StatusWithSize result = DumpLines(buffer);
+    if (result.IsResourceExhausted()) {
+      return OkStatus();
+    }
+    PW_TRY(result);
+    PW_TRY(writer.Write(std::as_bytes(buffer.first(result.size()))));
+  }
+}
+
 }  // namespace pw::dump
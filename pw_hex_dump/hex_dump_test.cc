@@ -23,6 +23,7 @@
 
 #include "gtest/gtest.h"
 #include "pw_log/log.h"
+#include "pw_stream/memory_stream.h"
 
 namespace pw::dump {
 namespace {
@@ -401,6 +402,145 @@ TEST_F(SmallBuffer, PrefixIncreasesBufferRequirement) {
   EXPECT_STREQ(expected, dest_.data());
 }
 
+constexpr std::string_view kBulkDump =
+    "0000: a4 cc 32 62 9b 46 38 1a 23 1a 2a 7a bc e2 40 a0  ..2b.F8.#.*z..@.\n"
+    "0010: ff 33 e5 2b 9e 9f 6b 3c be 9b 89 3c 7e 4a 7a 48  .3.+..k<...<~JzH\n"
+    "0020: 18                                               .\n";
+
+TEST(BulkHexDumper, DumpLines_AllLinesInOneCall) {
+  std::array<char, 256> buffer;
+  BulkHexDumper dumper;
+  dumper.BeginDump(source_data);
+
+  StatusWithSize result = dumper.DumpLines(buffer);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(kBulkDump, std::string_view(buffer.data(), result.size()));
+
+  EXPECT_EQ(dumper.DumpLines(buffer).status(), Status::ResourceExhausted());
+}
+
+TEST(BulkHexDumper, DumpLines_OneLinePerCall) {
+  BulkHexDumper dumper;
+  dumper.BeginDump(source_data);
+  std::array<char, 256> buffer;
+  std::span<char> line(buffer.data(), dumper.line_length());
+
+  StatusWithSize result = dumper.DumpLines(line);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(kBulkDump.substr(0, line.size()),
+            std::string_view(line.data(), result.size()));
+
+  result = dumper.DumpLines(line);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(kBulkDump.substr(line.size(), line.size()),
+            std::string_view(line.data(), result.size()));
+
+  result = dumper.DumpLines(line);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(kBulkDump.substr(2 * line.size()),
+            std::string_view(line.data(), result.size()));
+
+  EXPECT_EQ(dumper.DumpLines(line).status(), Status::ResourceExhausted());
+}
+
+TEST(BulkHexDumper, DumpLines_MatchesFormattedHexDumper) {
+  std::array<char, 256> buffer;
+  BulkHexDumper dumper;
+  dumper.BeginDump(source_data);
+  StatusWithSize result = dumper.DumpLines(buffer);
+  ASSERT_EQ(result.status(), OkStatus());
+  std::string_view dump(buffer.data(), result.size());
+
+  std::array<char, 256> line;
+  FormattedHexDumper formatted(line);
+  formatted.flags.show_header = false;
+  ASSERT_EQ(formatted.BeginDump(source_data), OkStatus());
+
+  // The bulk dumper ends each line with a newline rather than a null.
+  while (formatted.DumpLine().ok()) {
+    const size_t length = std::strlen(line.data());
+    ASSERT_EQ(dump[length], '\n');
+    EXPECT_EQ(std::string_view(line.data(), length), dump.substr(0, length));
+    dump.remove_prefix(length + 1);
+  }
+  EXPECT_TRUE(dump.empty());
+}
+
+TEST(BulkHexDumper, DumpLines_NoPrefix) {
+  std::array<char, 256> buffer;
+  BulkHexDumper dumper(BulkHexDumper::AddressMode::kDisabled);
+  dumper.BeginDump(std::span(source_data).first(4));
+
+  StatusWithSize result = dumper.DumpLines(buffer);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(
+      "a4 cc 32 62                                      ..2b\n",
+      std::string_view(buffer.data(), result.size()));
+}
+
+TEST(BulkHexDumper, DumpLines_AbsolutePrefix) {
+  std::array<char, kHexAddrStringSize + 1> expected1;
+  std::array<char, kHexAddrStringSize + 1> expected2;
+  DumpAddr(expected1, source_data.data());
+  DumpAddr(expected2, source_data.data() + BulkHexDumper::kBytesPerLine);
+
+  std::array<char, 256> buffer;
+  BulkHexDumper dumper(BulkHexDumper::AddressMode::kAbsolute);
+  dumper.BeginDump(source_data);
+  StatusWithSize result = dumper.DumpLines(buffer);
+  ASSERT_EQ(result.status(), OkStatus());
+
+  const std::string_view dump(buffer.data(), result.size());
+  EXPECT_EQ(dump.substr(0, kHexAddrStringSize),
+            std::string_view(expected1.data()));
+  EXPECT_EQ(dump.substr(dumper.line_length(), kHexAddrStringSize),
+            std::string_view(expected2.data()));
+  // The rest of the line matches the offset-prefixed dump.
+  const size_t rest_length = dumper.line_length() - kHexAddrStringSize;
+  EXPECT_EQ(dump.substr(kHexAddrStringSize, rest_length),
+            kBulkDump.substr(4, rest_length));
+}
+
+TEST(BulkHexDumper, DumpLines_BufferTooSmall) {
+  BulkHexDumper dumper;
+  dumper.BeginDump(source_data);
+  std::array<char, 256> buffer;
+
+  EXPECT_EQ(
+      dumper.DumpLines(std::span(buffer).first(dumper.line_length() - 1))
+          .status(),
+      Status::FailedPrecondition());
+
+  // Nothing was consumed, so the whole dump is still written.
+  StatusWithSize result = dumper.DumpLines(buffer);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(kBulkDump, std::string_view(buffer.data(), result.size()));
+}
+
+TEST(BulkHexDumper, DumpLines_ToWriter) {
+  stream::MemoryWriterBuffer<256> writer;
+  BulkHexDumper dumper;
+  dumper.BeginDump(source_data);
+
+  // Only fits two lines, so the dump takes multiple writes.
+  std::array<char, 160> buffer;
+  ASSERT_EQ(dumper.DumpLines(writer, buffer), OkStatus());
+
+  const ConstByteSpan written = writer.WrittenData();
+  EXPECT_EQ(kBulkDump,
+            std::string_view(reinterpret_cast<const char*>(written.data()),
+                             written.size()));
+}
+
+TEST(BulkHexDumper, DumpLines_ToFullWriter) {
+  stream::MemoryWriterBuffer<80> writer;
+  BulkHexDumper dumper;
+  dumper.BeginDump(source_data);
+
+  std::array<char, 80> buffer;
+  EXPECT_EQ(dumper.DumpLines(writer, buffer), Status::ResourceExhausted());
+}
+
 TEST(BadBuffer, ZeroSize) {
   char buffer[1] = {static_cast<char>(0xaf)};
   FormattedHexDumper dumper(std::span<char>(buffer, 0));
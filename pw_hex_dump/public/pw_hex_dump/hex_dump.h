@@ -19,6 +19,8 @@
 
 #include "pw_bytes/span.h"
 #include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
 
 namespace pw::dump {
 
@@ -151,6 +153,71 @@ class FormattedHexDumper {
   ConstByteSpan source_data_;
 };
 
+// Formats a hex dump many lines at a time, for dumping large regions of memory
+// such as during crash analysis. Lines are in FormattedHexDumper's default
+// format, without the header: 16 bytes per line with an offset or address
+// prefix and the ASCII interpretation. Each line is built with lookup tables
+// rather than by formatting each byte, and as many lines as fit are written to
+// the destination in a single call.
+//
+// Example usage:
+//
+//   std::array<char, 512> buffer;
+//   BulkHexDumper hex_dumper;
+//   hex_dumper.BeginDump(my_data);
+//   PW_TRY(hex_dumper.DumpLines(uart_writer, buffer));
+//
+// Which writes:
+//
+//   0000: a4 cc 32 62 9b 46 38 1a 23 1a 2a 7a bc e2 40 a0  ..2b.F8.#.*z..@.
+//   0010: ff 33 e5 2b 9e 9f 6b 3c be 9b 89 3c 7e 4a 7a 48  .3.+..k<...<~JzH
+//   0020: 18                                               .
+class BulkHexDumper {
+ public:
+  using AddressMode = FormattedHexDumper::AddressMode;
+
+  static constexpr size_t kBytesPerLine = 16;
+
+  constexpr BulkHexDumper(AddressMode prefix_mode = AddressMode::kOffset)
+      : prefix_mode_(prefix_mode), offset_digits_(0), current_offset_(0) {}
+
+  // Begin dumping the provided data.
+  void BeginDump(ConstByteSpan data);
+
+  // The length of a full line of the current dump, including its newline. The
+  // last line of a dump is shorter if it has fewer than kBytesPerLine bytes.
+  size_t line_length() const;
+
+  // Writes as many lines as fit in the destination buffer. Each line ends with
+  // a newline; the output is not null terminated.
+  //
+  // Returns:
+  //   OK - Lines were written. The size is the number of characters written.
+  //   RESOURCE_EXHAUSTED - All the data has been dumped.
+  //   FAILED_PRECONDITION - The buffer is too small to fit a line.
+  StatusWithSize DumpLines(std::span<char> dest);
+
+  // Dumps the rest of the data to a writer, formatting as many lines as fit in
+  // the buffer for each write.
+  //
+  // Returns:
+  //   OK - All the data has been dumped.
+  //   FAILED_PRECONDITION - The buffer is too small to fit a line.
+  //   Any error from the writer.
+  Status DumpLines(stream::Writer& writer, std::span<char> buffer);
+
+ private:
+  size_t prefix_length() const;
+
+  // Writes a line of up to kBytesPerLine bytes, including its newline.
+  void WriteLine(ConstByteSpan line, char* out) const;
+
+  AddressMode prefix_mode_;
+  uint8_t offset_digits_;
+  size_t current_offset_;
+  ConstByteSpan source_data_;
+};
+
 // Dumps a uintptr_t to a character buffer as a hex address. This may be useful
 // to print out an address in a generalized way when %z and %p aren't supported
 // by a standard library implementation. The destination buffer MUST be large
@@ -0,0 +1,166 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_i2c/async_initiator.h"
+
+#include <mutex>
+#include <utility>
+
+#include "pw_assert/check.h"
+#include "pw_sync/binary_semaphore.h"
+
+namespace pw::i2c {
+namespace {
+
+// Waits for the result of a submitted batch.
+class Waiter {
+ public:
+  AsyncInitiator::Callback Callback() {
+    return [this](Status status) {
+      result_ = status;
+      done_.release();
+    };
+  }
+
+  Status Wait() {
+    done_.acquire();
+    return result_;
+  }
+
+ private:
+  sync::BinarySemaphore done_;
+  Status result_;
+};
+
+}  // namespace
+
+Status AsyncInitiator::Submit(std::span<Transfer> transfers,
+                              chrono::SystemClock::duration for_at_least,
+                              Callback&& on_done) {
+  if (transfers.empty()) {
+    return Status::InvalidArgument();
+  }
+
+  {
+    std::lock_guard lock(lock_);
+    if (count_ == queue_.size()) {
+      return Status::ResourceExhausted();
+    }
+
+    Batch& batch = queue_[(head_ + count_) % queue_.size()];
+    batch.transfers_ = transfers;
+    batch.for_at_least_ = for_at_least;
+    batch.callback_ = std::move(on_done);
+    count_ += 1;
+
+    // Another context is already working through the queue.
+    if (std::exchange(running_, true)) {
+      return OkStatus();
+    }
+  }
+
+  RunQueue();
+  return OkStatus();
+}
+
+void AsyncInitiator::Complete(Status status) {
+  Callback callback;
+  bool run_queue;
+  {
+    std::lock_guard lock(lock_);
+    PW_DCHECK(in_progress_);
+    in_progress_ = false;
+    callback = PopFront();
+
+    // If the batch finished while it was being started, RunQueue() is still
+    // running and starts the next one.
+    run_queue = !starting_;
+  }
+
+  if (callback != nullptr) {
+    callback(status);
+  }
+  if (run_queue) {
+    RunQueue();
+  }
+}
+
+Status AsyncInitiator::DoWriteReadFor(
+    Address device_address,
+    ConstByteSpan tx_buffer,
+    ByteSpan rx_buffer,
+    chrono::SystemClock::duration for_at_least) {
+  Transfer transfer = WriteReadTransfer(device_address, tx_buffer, rx_buffer);
+  Waiter waiter;
+  if (!Submit(std::span(&transfer, 1), for_at_least, waiter.Callback()).ok()) {
+    // The queue is full, so the bus cannot be acquired now.
+    return Status::DeadlineExceeded();
+  }
+
+  // The driver completes every batch within its timeout, so this returns once
+  // the batches ahead of this one and the transfer itself are done.
+  return waiter.Wait();
+}
+
+void AsyncInitiator::RunQueue() {
+  while (true) {
+    Batch* batch;
+    {
+      std::lock_guard lock(lock_);
+      if (count_ == 0u) {
+        running_ = false;
+        return;
+      }
+      batch = &front();
+      starting_ = true;
+      in_progress_ = true;
+    }
+
+    // The front batch is only removed by Complete() or below, so it can be
+    // read without the lock.
+    const Status status =
+        DoStartTransfers(batch->transfers_, batch->for_at_least_);
+
+    Callback failed;
+    {
+      std::lock_guard lock(lock_);
+      starting_ = false;
+      if (status.ok()) {
+        // Complete() continues the queue once the batch finishes, unless it
+        // already has.
+        if (in_progress_) {
+          return;
+        }
+        continue;
+      }
+      in_progress_ = false;
+      failed = PopFront();
+    }
+
+    if (failed != nullptr) {
+      failed(status);
+    }
+  }
+}
+
+AsyncInitiator::Callback AsyncInitiator::PopFront() {
+  Callback callback = std::move(front().callback_);
+  front().callback_ = nullptr;
+  front().transfers_ = std::span<Transfer>();
+  head_ = (head_ + 1) % queue_.size();
+  count_ -= 1;
+  return callback;
+}
+
+}  // namespace pw::i2c
@@ -0,0 +1,319 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_i2c/async_initiator.h"
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+#include "pw_i2c/register_device.h"
+
+using namespace std::literals::chrono_literals;
+
+namespace pw::i2c {
+namespace {
+
+constexpr size_t kQueueDepth = 3;
+constexpr Address kSensor1 = Address::SevenBit<0x10>();
+constexpr Address kSensor2 = Address::SevenBit<0x20>();
+constexpr Address kMissing = Address::SevenBit<0x7f>();
+
+constexpr chrono::SystemClock::duration kTimeout =
+    std::chrono::duration_cast<chrono::SystemClock::duration>(10ms);
+
+// Runs batches when the test calls Finish(), or as soon as they start if
+// finish_immediately is set. Each device echoes the last byte written to it,
+// plus its address, for every byte read. Reads from kMissing are NACKed.
+class FakeAsyncInitiator final : public AsyncInitiatorBuffer<kQueueDepth> {
+ public:
+  // Runs the batch in progress and completes it.
+  void Finish() {
+    ASSERT_TRUE(in_progress);
+    in_progress = false;
+    Status status;
+    for (Transfer& transfer : transfers_) {
+      if (transfer.device_address.GetSevenBit() ==
+          kMissing.GetSevenBit()) {
+        status = Status::Unavailable();
+        break;
+      }
+      tx_sizes[transfers_run % tx_sizes.size()] = transfer.tx_buffer.size();
+      transfers_run += 1;
+      std::byte last = std::byte{0};
+      if (!transfer.tx_buffer.empty()) {
+        last = transfer.tx_buffer.back();
+      }
+      for (std::byte& b : transfer.rx_buffer) {
+        b = last ^ std::byte(transfer.device_address.GetSevenBit());
+      }
+    }
+    Complete(status);
+  }
+
+  bool finish_immediately = false;
+  bool in_progress = false;
+  size_t starts = 0;
+  size_t transfers_run = 0;
+  chrono::SystemClock::duration last_timeout = {};
+  Status start_error;  // Fails the next start.
+  std::array<size_t, 4> tx_sizes = {};  // Of the transfers that ran.
+
+ private:
+  Status DoStartTransfers(std::span<Transfer> transfers,
+                          chrono::SystemClock::duration for_at_least) override {
+    EXPECT_FALSE(in_progress);
+    starts += 1;
+    last_timeout = for_at_least;
+    if (!start_error.ok()) {
+      return std::exchange(start_error, OkStatus());
+    }
+    transfers_ = transfers;
+    in_progress = true;
+    if (finish_immediately) {
+      Finish();
+    }
+    return OkStatus();
+  }
+
+  std::span<Transfer> transfers_;
+};
+
+class AsyncInitiatorTest : public ::testing::Test {
+ protected:
+  AsyncInitiator::Callback Record(std::optional<Status>& result) {
+    return [&result](Status status) { result = status; };
+  }
+
+  FakeAsyncInitiator initiator_;
+  std::span<Transfer> transfers_;
+  std::optional<Status> result_;
+};
+
+TEST_F(AsyncInitiatorTest, Submit_ReturnsBeforeTransfersRun) {
+  constexpr auto kCommand = bytes::Array<0x01>();
+  std::array<std::byte, 2> rx1 = {};
+  std::array<std::byte, 1> rx2 = {};
+  std::array<Transfer, 3> transfers = {
+      WriteReadTransfer(kSensor1, kCommand, rx1),
+      ReadTransfer(kSensor2, rx2),
+      WriteTransfer(kSensor2, kCommand),
+  };
+
+  std::optional<Status> result;
+  ASSERT_EQ(OkStatus(), initiator_.Submit(transfers, kTimeout, Record(result)));
+  EXPECT_TRUE(initiator_.in_progress);
+  EXPECT_EQ(initiator_.last_timeout, kTimeout);
+  EXPECT_FALSE(result.has_value());
+  EXPECT_EQ(initiator_.pending_batches(), 1u);
+
+  initiator_.Finish();
+  EXPECT_EQ(result, OkStatus());
+  EXPECT_EQ(initiator_.pending_batches(), 0u);
+  EXPECT_EQ(initiator_.transfers_run, 3u);
+  EXPECT_EQ(rx1[0], std::byte{0x11});
+  EXPECT_EQ(rx1[1], std::byte{0x11});
+  EXPECT_EQ(rx2[0], std::byte{0x20});
+}
+
+TEST_F(AsyncInitiatorTest, Submit_NoTransfers_InvalidArgument) {
+  std::optional<Status> result;
+  EXPECT_EQ(Status::InvalidArgument(),
+            initiator_.Submit(std::span<Transfer>(), kTimeout, Record(result)));
+  EXPECT_EQ(initiator_.starts, 0u);
+}
+
+TEST_F(AsyncInitiatorTest, Batches_RunOneAtATimeInOrder) {
+  std::array<std::byte, 1> rx1 = {};
+  std::array<std::byte, 1> rx2 = {};
+  std::array<Transfer, 1> first = {ReadTransfer(kSensor1, rx1)};
+  std::array<Transfer, 1> second = {ReadTransfer(kSensor2, rx2)};
+
+  std::optional<Status> first_result;
+  std::optional<Status> second_result;
+  ASSERT_EQ(OkStatus(),
+            initiator_.Submit(first, kTimeout, Record(first_result)));
+  ASSERT_EQ(OkStatus(),
+            initiator_.Submit(second, kTimeout, Record(second_result)));
+  EXPECT_EQ(initiator_.starts, 1u);
+  EXPECT_EQ(initiator_.pending_batches(), 2u);
+
+  initiator_.Finish();
+  EXPECT_EQ(first_result, OkStatus());
+  EXPECT_FALSE(second_result.has_value());
+  EXPECT_EQ(initiator_.starts, 2u);
+
+  initiator_.Finish();
+  EXPECT_EQ(second_result, OkStatus());
+  EXPECT_EQ(rx1[0], std::byte{0x10});
+  EXPECT_EQ(rx2[0], std::byte{0x20});
+}
+
+TEST_F(AsyncInitiatorTest, Batches_QueueFull_ResourceExhausted) {
+  std::array<std::byte, 1> rx = {};
+  std::array<Transfer, 1> transfers = {ReadTransfer(kSensor1, rx)};
+
+  std::optional<Status> result;
+  for (size_t i = 0; i < kQueueDepth; ++i) {
+    ASSERT_EQ(OkStatus(),
+              initiator_.Submit(transfers, kTimeout, Record(result)));
+  }
+  EXPECT_EQ(Status::ResourceExhausted(),
+            initiator_.Submit(transfers, kTimeout, Record(result)));
+
+  initiator_.Finish();
+  EXPECT_EQ(OkStatus(), initiator_.Submit(transfers, kTimeout, Record(result)));
+}
+
+TEST_F(AsyncInitiatorTest, Batch_StopsAtFirstFailure) {
+  std::array<std::byte, 1> rx1 = {};
+  std::array<std::byte, 1> rx2 = {};
+  std::array<std::byte, 1> rx3 = {};
+  std::array<Transfer, 3> transfers = {
+      ReadTransfer(kSensor1, rx1),
+      ReadTransfer(kMissing, rx2),
+      ReadTransfer(kSensor2, rx3),
+  };
+
+  initiator_.finish_immediately = true;
+  std::optional<Status> result;
+  ASSERT_EQ(OkStatus(), initiator_.Submit(transfers, kTimeout, Record(result)));
+  EXPECT_EQ(result, Status::Unavailable());
+  EXPECT_EQ(initiator_.transfers_run, 1u);
+}
+
+TEST_F(AsyncInitiatorTest, Batches_StartFails_CallbackGetsErrorAndNextRuns) {
+  std::array<std::byte, 1> rx = {};
+  std::array<Transfer, 1> transfers = {ReadTransfer(kSensor1, rx)};
+
+  std::optional<Status> first;
+  std::optional<Status> second;
+  std::optional<Status> third;
+  ASSERT_EQ(OkStatus(), initiator_.Submit(transfers, kTimeout, Record(first)));
+  ASSERT_EQ(OkStatus(), initiator_.Submit(transfers, kTimeout, Record(second)));
+  ASSERT_EQ(OkStatus(), initiator_.Submit(transfers, kTimeout, Record(third)));
+
+  initiator_.start_error = Status::FailedPrecondition();
+  initiator_.Finish();
+  EXPECT_EQ(first, OkStatus());
+  EXPECT_EQ(second, Status::FailedPrecondition());
+  EXPECT_FALSE(third.has_value());
+  EXPECT_TRUE(initiator_.in_progress);
+
+  initiator_.Finish();
+  EXPECT_EQ(third, OkStatus());
+}
+
+TEST_F(AsyncInitiatorTest, Batches_FinishImmediately_RunsWholeQueue) {
+  std::array<std::byte, 1> rx = {};
+  std::array<Transfer, 1> transfers = {ReadTransfer(kSensor1, rx)};
+
+  std::optional<Status> first;
+  std::optional<Status> second;
+  ASSERT_EQ(OkStatus(), initiator_.Submit(transfers, kTimeout, Record(first)));
+  ASSERT_EQ(OkStatus(), initiator_.Submit(transfers, kTimeout, Record(second)));
+
+  initiator_.finish_immediately = true;
+  initiator_.Finish();
+  EXPECT_EQ(first, OkStatus());
+  EXPECT_EQ(second, OkStatus());
+  EXPECT_EQ(initiator_.pending_batches(), 0u);
+}
+
+TEST_F(AsyncInitiatorTest, Callback_CanSubmitNextBatch) {
+  std::array<std::byte, 1> rx = {};
+  std::array<Transfer, 1> transfers = {ReadTransfer(kSensor1, rx)};
+  transfers_ = transfers;
+
+  ASSERT_EQ(OkStatus(),
+            initiator_.Submit(transfers, kTimeout, [this](Status status) {
+              EXPECT_EQ(OkStatus(), status);
+              EXPECT_EQ(OkStatus(),
+                        initiator_.Submit(transfers_, kTimeout, Record(result_)));
+            }));
+
+  initiator_.Finish();
+  EXPECT_EQ(initiator_.starts, 2u);
+  initiator_.Finish();
+  EXPECT_EQ(result_, OkStatus());
+}
+
+TEST_F(AsyncInitiatorTest, WriteReadFor_Blocks) {
+  initiator_.finish_immediately = true;
+  constexpr auto kCommand = bytes::Array<0x03>();
+  std::array<std::byte, 2> rx = {};
+
+  EXPECT_EQ(OkStatus(), initiator_.WriteReadFor(kSensor1, kCommand, rx, 1ms));
+  EXPECT_EQ(rx[1], std::byte{0x13});
+  EXPECT_EQ(Status::Unavailable(), initiator_.ReadFor(kMissing, rx, 1ms));
+}
+
+TEST_F(AsyncInitiatorTest, RegisterDevice_BatchesRegisterAccesses) {
+  RegisterDevice sensor1(
+      initiator_, kSensor1, std::endian::big, RegisterAddressSize::k1Byte);
+  RegisterDevice sensor2(
+      initiator_, kSensor2, std::endian::big, RegisterAddressSize::k2Bytes);
+
+  std::array<std::byte, 1> address1;
+  std::array<std::byte, 2> address2;
+  std::array<std::byte, 4> write_buffer;
+  std::array<std::byte, 4> data1 = {};
+  std::array<std::byte, 2> data2 = {};
+  constexpr auto kConfig = bytes::Array<0xAA, 0x0F>();
+
+  Result<Transfer> read1 = sensor1.ReadRegistersTransfer(0x42, address1, data1);
+  Result<Transfer> read2 =
+      sensor2.ReadRegistersTransfer(0x1234, address2, data2);
+  Result<Transfer> write =
+      sensor1.WriteRegistersTransfer(0x07, kConfig, write_buffer);
+  ASSERT_EQ(OkStatus(), read1.status());
+  ASSERT_EQ(OkStatus(), read2.status());
+  ASSERT_EQ(OkStatus(), write.status());
+  EXPECT_EQ(address2[0], std::byte{0x12});
+  EXPECT_EQ(address2[1], std::byte{0x34});
+  EXPECT_EQ(write_buffer[0], std::byte{0x07});
+  EXPECT_EQ(write_buffer[2], std::byte{0x0F});
+
+  std::array<Transfer, 3> transfers = {
+      read1.value(), read2.value(), write.value()};
+  initiator_.finish_immediately = true;
+  std::optional<Status> result;
+  ASSERT_EQ(OkStatus(), initiator_.Submit(transfers, kTimeout, Record(result)));
+  EXPECT_EQ(result, OkStatus());
+  EXPECT_EQ(initiator_.starts, 1u);
+  EXPECT_EQ(initiator_.tx_sizes[0], 1u);
+  EXPECT_EQ(initiator_.tx_sizes[1], 2u);
+  EXPECT_EQ(initiator_.tx_sizes[2], 3u);
+  EXPECT_EQ(data1[3], std::byte{0x42 ^ 0x10});
+  EXPECT_EQ(data2[0], std::byte{0x34 ^ 0x20});
+}
+
+TEST_F(AsyncInitiatorTest, RegisterDevice_TransferBuffersTooSmall) {
+  RegisterDevice sensor(
+      initiator_, kSensor1, std::endian::big, RegisterAddressSize::k2Bytes);
+
+  std::array<std::byte, 1> small;
+  std::array<std::byte, 2> data = {};
+  EXPECT_EQ(Status::OutOfRange(),
+            sensor.ReadRegistersTransfer(0x1234, small, data).status());
+  EXPECT_EQ(Status::OutOfRange(),
+            sensor.WriteRegistersTransfer(0x1234, data, small).status());
+}
+
+}  // namespace
+}  // namespace pw::i2c
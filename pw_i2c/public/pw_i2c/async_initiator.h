@@ -0,0 +1,162 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_function/function.h"
+#include "pw_i2c/address.h"
+#include "pw_i2c/initiator.h"
+#include "pw_i2c/transfer.h"
+#include "pw_status/status.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+
+namespace pw::i2c {
+
+// An Initiator that runs lists of transfers in the background. Initiator calls
+// block their caller for each transaction. With an AsyncInitiator, a caller
+// instead submits a batch of transfers, such as a poll of every sensor on the
+// bus, and is called back once the whole batch is done. Batches run one at a
+// time, in the order they were submitted.
+//
+// Drivers implement DoStartTransfers() to start a batch and call Complete()
+// when it finishes. Because the driver gets the whole list at once, it can
+// program it as a chain of DMA descriptors, or move from one transfer to the
+// next in its interrupt handler, without waiting for a thread between
+// transfers. Complete() runs the callback and starts the next batch in the
+// calling context, so drivers that complete from an interrupt handler run
+// callbacks there; those callbacks must be short and must not block.
+//
+// The blocking Initiator calls are submitted as single-transfer batches, so
+// they are ordered with other batches and wait for the batches ahead of them.
+// They must not be called from a batch's callback. If the queue is full, they
+// return DEADLINE_EXCEEDED.
+//
+// Batches may be submitted from any thread.
+class AsyncInitiator : public Initiator {
+ public:
+  // Called with the result of a batch.
+  using Callback = Function<void(Status)>;
+
+  // Storage for a submitted batch. Drivers provide an array of these, which
+  // sets how many batches can be queued.
+  class Batch {
+   public:
+    constexpr Batch() = default;
+
+   private:
+    friend class AsyncInitiator;
+
+    std::span<Transfer> transfers_;
+    chrono::SystemClock::duration for_at_least_ = {};
+    Callback callback_;
+  };
+
+  explicit AsyncInitiator(std::span<Batch> queue)
+      : queue_(queue),
+        head_(0),
+        count_(0),
+        running_(false),
+        starting_(false),
+        in_progress_(false) {}
+
+  AsyncInitiator(const AsyncInitiator&) = delete;
+  AsyncInitiator& operator=(const AsyncInitiator&) = delete;
+
+  // Queues a batch of transfers, which run in order. The batch stops at the
+  // first transfer that fails, and on_done is called with the result. The
+  // transfers and their buffers must remain valid until on_done is called.
+  //
+  // for_at_least bounds the time the batch may take once it starts, including
+  // waiting for exclusive bus access.
+  //
+  // Returns:
+  // Ok - The batch is queued.
+  // InvalidArgument - There are no transfers.
+  // ResourceExhausted - The queue is full.
+  Status Submit(std::span<Transfer> transfers,
+                chrono::SystemClock::duration for_at_least,
+                Callback&& on_done);
+
+  // The number of queued batches, including the one in progress.
+  size_t pending_batches() const {
+    std::lock_guard lock(lock_);
+    return count_;
+  }
+
+ protected:
+  // Called by the driver when the batch it started finishes, with the status of
+  // the first transfer that failed, or OK. May be called from within
+  // DoStartTransfers() by drivers that finish immediately.
+  void Complete(Status status);
+
+ private:
+  // Starts a batch of transfers in hardware. Only one batch is started at a
+  // time. An error fails the batch, and its callback is called with it.
+  //
+  // The driver must complete the batch within for_at_least of starting it,
+  // with DEADLINE_EXCEEDED if the bus is held or a device stretches the clock
+  // for too long. Completion statuses are the same as for
+  // Initiator::WriteReadFor().
+  virtual Status DoStartTransfers(
+      std::span<Transfer> transfers,
+      chrono::SystemClock::duration for_at_least) = 0;
+
+  Status DoWriteReadFor(Address device_address,
+                        ConstByteSpan tx_buffer,
+                        ByteSpan rx_buffer,
+                        chrono::SystemClock::duration for_at_least) final;
+
+  // Starts queued batches until one is in progress or the queue is empty.
+  void RunQueue();
+
+  Callback PopFront() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  Batch& front() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_) { return queue_[head_]; }
+
+  mutable sync::InterruptSpinLock lock_;
+  const std::span<Batch> queue_;
+  size_t head_ PW_GUARDED_BY(lock_);
+  size_t count_ PW_GUARDED_BY(lock_);
+
+  // A context is working through the queue.
+  bool running_ PW_GUARDED_BY(lock_);
+
+  // RunQueue() is calling DoStartTransfers().
+  bool starting_ PW_GUARDED_BY(lock_);
+
+  // The front batch was started and has not completed.
+  bool in_progress_ PW_GUARDED_BY(lock_);
+};
+
+// Helper for declaring an AsyncInitiator driver with its queue.
+//
+//   class MyI2cDriver final : public AsyncInitiatorBuffer<4> { ... };
+//
+template <size_t kQueueDepth>
+class AsyncInitiatorBuffer : public AsyncInitiator {
+ public:
+  AsyncInitiatorBuffer() : AsyncInitiator(queue_) {}
+
+ private:
+  std::array<Batch, kQueueDepth> queue_;
+};
+
+}  // namespace pw::i2c
@@ -166,6 +166,8 @@ class Device {
     return initiator_.ProbeDeviceFor(device_address_, for_at_least);
   }
 
+  Address address() const { return device_address_; }
+
  private:
   Initiator& initiator_;
   const Address device_address_;
@@ -0,0 +1,186 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_i2c/register_device.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+
+namespace pw::i2c {
+
+// Caches a contiguous range of 8-bit registers of a RegisterDevice in RAM.
+//
+// Writes update the cache and mark the registers dirty; Flush() then writes the
+// dirty registers with as few burst (auto-increment) transactions as possible.
+// Runs of dirty registers separated by a few clean, cached registers are
+// written as a single burst, since rewriting a clean register costs less than
+// addressing a new transaction. Writes that do not change a cached value are
+// dropped.
+//
+// Reads of cached registers are served from RAM. Registers that the device
+// changes on its own, such as status, data, or interrupt registers, must be
+// marked volatile with SetVolatile(). Volatile registers are never cached:
+// reads always go to the bus, and writes go to the device immediately.
+//
+//   pw::i2c::RegisterCacheBuffer<0x40> config(imu, /*first_register=*/0x10);
+//   config.SetVolatile(kStatusRegister, 1);
+//
+//   config.WriteRegister(kGyroRange, std::byte{0x03});
+//   config.WriteRegister(kGyroRate, std::byte{0x08});
+//   config.WriteRegister(kAccelRange, std::byte{0x01});
+//   PW_TRY(config.Flush(kTimeout));  // One or two bursts instead of three.
+//
+// The cache assumes it is the only writer of the device's registers. Call
+// Invalidate() if the device is reset or written some other way.
+//
+// RegisterCache is not thread safe.
+class RegisterCache {
+ public:
+  // Caches registers first_register to first_register + values.size() - 1.
+  // flags holds the cache state of each register and must be the same size as
+  // values, and zeroed. write_buffer is used to build burst writes; longer
+  // dirty runs are split into multiple bursts. It must be larger than the
+  // register address.
+  RegisterCache(RegisterDevice& device,
+                uint32_t first_register,
+                ByteSpan values,
+                std::span<uint8_t> flags,
+                ByteSpan write_buffer);
+
+  RegisterCache(const RegisterCache&) = delete;
+  RegisterCache& operator=(const RegisterCache&) = delete;
+
+  // Marks registers that the device may change as volatile, which clears their
+  // cached value and any pending write. Returns OUT_OF_RANGE if they are not
+  // in the cached range.
+  Status SetVolatile(uint32_t register_address, size_t count);
+
+  // Reads a register, from the cache if possible.
+  //
+  // Returns:
+  //   Ok: The register value.
+  //   OutOfRange: The register is not in the cached range.
+  //   Other: The status of RegisterDevice::ReadRegisters().
+  Result<std::byte> ReadRegister(uint32_t register_address,
+                                 chrono::SystemClock::duration for_at_least);
+
+  // Reads contiguous registers. Registers that are not cached are read from
+  // the bus in one burst that spans all of them, so call this rather than
+  // ReadRegister() in a loop. Registers with pending writes read as the written
+  // value.
+  //
+  // Returns:
+  //   Ok: return_data holds the register values.
+  //   OutOfRange: The registers are not in the cached range.
+  //   Other: The status of RegisterDevice::ReadRegisters().
+  Status ReadRegisters(uint32_t register_address,
+                       ByteSpan return_data,
+                       chrono::SystemClock::duration for_at_least);
+
+  // Sets a register in the cache; it is written to the device by Flush(). A
+  // write to a volatile register goes to the device immediately, ahead of any
+  // pending writes.
+  //
+  // Returns:
+  //   Ok: The write is pending, or was written to a volatile register.
+  //   OutOfRange: The register is not in the cached range.
+  //   Other: The status of writing a volatile register.
+  Status WriteRegister(uint32_t register_address,
+                       std::byte value,
+                       chrono::SystemClock::duration for_at_least);
+
+  // Sets contiguous registers in the cache, like WriteRegister().
+  Status WriteRegisters(uint32_t register_address,
+                        ConstByteSpan register_data,
+                        chrono::SystemClock::duration for_at_least);
+
+  // Sets the bits of a register selected by mask to value. Reads the register
+  // first if it is not cached.
+  Status UpdateRegister(uint32_t register_address,
+                        std::byte mask,
+                        std::byte value,
+                        chrono::SystemClock::duration for_at_least);
+
+  // Writes all dirty registers to the device in burst transactions. Each burst
+  // has its own timeout. If a burst fails, its registers and later ones stay
+  // dirty, so Flush() can be retried.
+  Status Flush(chrono::SystemClock::duration for_at_least);
+
+  // Drops all cached values and pending writes.
+  void Invalidate();
+
+  // The number of registers with pending writes.
+  size_t dirty_count() const;
+
+  uint32_t first_register() const { return first_register_; }
+
+  size_t register_count() const { return values_.size(); }
+
+ private:
+  static constexpr uint8_t kValid = 1 << 0;
+  static constexpr uint8_t kDirty = 1 << 1;
+  static constexpr uint8_t kVolatile = 1 << 2;
+
+  // Returns whether the registers are in the cached range, and if so sets
+  // index to the position of the first one.
+  bool Contains(uint32_t register_address, size_t count, size_t& index) const;
+
+  bool has(size_t index, uint8_t flag) const {
+    return (flags_[index] & flag) != 0;
+  }
+
+  // Whether a clean register may be rewritten to join two dirty runs.
+  bool CanRewrite(size_t index) const {
+    return (flags_[index] & (kValid | kDirty | kVolatile)) == kValid;
+  }
+
+  // Writes registers [begin, end) in bursts that fit in the write buffer.
+  Status WriteRun(size_t begin,
+                  size_t end,
+                  chrono::SystemClock::duration for_at_least);
+
+  RegisterDevice& device_;
+  const uint32_t first_register_;
+  const ByteSpan values_;
+  const std::span<uint8_t> flags_;
+  const ByteSpan write_buffer_;
+
+  // Clean registers that may be rewritten to join two bursts. Starting a new
+  // burst costs a start condition, the device address, and the register
+  // address, so rewriting up to that many registers is no slower.
+  const size_t max_rewrite_gap_;
+};
+
+// A RegisterCache with storage for kRegisterCount registers, which can all be
+// written in one burst.
+template <size_t kRegisterCount>
+class RegisterCacheBuffer : public RegisterCache {
+ public:
+  RegisterCacheBuffer(RegisterDevice& device, uint32_t first_register)
+      : RegisterCache(device, first_register, values_, flags_, write_buffer_) {}
+
+ private:
+  std::array<std::byte, kRegisterCount> values_ = {};
+  std::array<uint8_t, kRegisterCount> flags_ = {};
+  std::array<std::byte, sizeof(uint32_t) + kRegisterCount> write_buffer_;
+};
+
+}  // namespace pw::i2c
@@ -19,6 +19,7 @@
 #include "pw_i2c/address.h"
 #include "pw_i2c/device.h"
 #include "pw_i2c/initiator.h"
+#include "pw_i2c/transfer.h"
 #include "pw_result/result.h"
 #include "pw_status/status.h"
 #include "pw_status/try.h"
@@ -216,6 +217,38 @@ class RegisterDevice : public Device {
   Result<uint32_t> ReadRegister32(uint32_t register_address,
                                   chrono::SystemClock::duration for_at_least);
 
+  // Builds a transfer that reads a chunk of registers, to batch register reads
+  // of one or more devices with AsyncInitiator::Submit(). The register address
+  // is encoded in address_buffer. Both buffers must remain valid until the
+  // batch completes.
+  //
+  // The data is read into return_data as bytes, in the device's byte order.
+  // Multi-byte registers can be converted once the batch completes with
+  // pw::bytes::ReadInOrder().
+  //
+  // Returns:
+  //   Ok: The transfer.
+  //   OutOfRange: address_buffer is smaller than the register address.
+  Result<Transfer> ReadRegistersTransfer(uint32_t register_address,
+                                         ByteSpan address_buffer,
+                                         ByteSpan return_data) const;
+
+  // Builds a transfer that writes bytes to a chunk of registers, to batch
+  // register writes with AsyncInitiator::Submit(). The register address and
+  // data are copied into buffer, which must remain valid until the batch
+  // completes.
+  //
+  // Returns:
+  //   Ok: The transfer.
+  //   OutOfRange: buffer is too small for the register address and data.
+  Result<Transfer> WriteRegistersTransfer(uint32_t register_address,
+                                          ConstByteSpan register_data,
+                                          ByteSpan buffer) const;
+
+  RegisterAddressSize register_address_size() const {
+    return register_address_size_;
+  }
+
  private:
   // Helper write registers.
   Status WriteRegisters(uint32_t register_address,
@@ -0,0 +1,48 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_bytes/span.h"
+#include "pw_i2c/address.h"
+
+namespace pw::i2c {
+
+// A write, read, or write then read with one device, run as part of a batch by
+// an AsyncInitiator. The signals on the bus are the same as for
+// Initiator::WriteReadFor() with the same buffers.
+//
+// The buffers must remain valid until the batch completes, since drivers may
+// run the batch with DMA after AsyncInitiator::Submit() returns.
+struct Transfer {
+  Address device_address;
+  ConstByteSpan tx_buffer;
+  ByteSpan rx_buffer;
+};
+
+constexpr Transfer WriteTransfer(Address device_address,
+                                 ConstByteSpan tx_buffer) {
+  return Transfer{device_address, tx_buffer, ByteSpan()};
+}
+
+constexpr Transfer ReadTransfer(Address device_address, ByteSpan rx_buffer) {
+  return Transfer{device_address, ConstByteSpan(), rx_buffer};
+}
+
+constexpr Transfer WriteReadTransfer(Address device_address,
+                                     ConstByteSpan tx_buffer,
+                                     ByteSpan rx_buffer) {
+  return Transfer{device_address, tx_buffer, rx_buffer};
+}
+
+}  // namespace pw::i2c
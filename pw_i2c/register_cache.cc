@@ -0,0 +1,228 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_i2c/register_cache.h"
+
+#include <algorithm>
+
+#include "pw_assert/check.h"
+#include "pw_status/try.h"
+
+namespace pw::i2c {
+
+RegisterCache::RegisterCache(RegisterDevice& device,
+                             uint32_t first_register,
+                             ByteSpan values,
+                             std::span<uint8_t> flags,
+                             ByteSpan write_buffer)
+    : device_(device),
+      first_register_(first_register),
+      values_(values),
+      flags_(flags),
+      write_buffer_(write_buffer),
+      max_rewrite_gap_(1 +
+                       static_cast<size_t>(device.register_address_size())) {
+  PW_CHECK_UINT_EQ(values.size(), flags.size());
+  PW_CHECK_UINT_GT(write_buffer.size(),
+                   static_cast<size_t>(device.register_address_size()));
+}
+
+Status RegisterCache::SetVolatile(uint32_t register_address, size_t count) {
+  size_t index;
+  if (!Contains(register_address, count, index)) {
+    return Status::OutOfRange();
+  }
+  std::fill_n(&flags_[index], count, kVolatile);
+  return OkStatus();
+}
+
+Result<std::byte> RegisterCache::ReadRegister(
+    uint32_t register_address, chrono::SystemClock::duration for_at_least) {
+  std::byte value;
+  PW_TRY(ReadRegisters(register_address, ByteSpan(&value, 1), for_at_least));
+  return value;
+}
+
+Status RegisterCache::ReadRegisters(
+    uint32_t register_address,
+    ByteSpan return_data,
+    chrono::SystemClock::duration for_at_least) {
+  size_t index;
+  if (!Contains(register_address, return_data.size(), index)) {
+    return Status::OutOfRange();
+  }
+
+  // Find the span of registers that has to come from the bus.
+  size_t first = return_data.size();
+  size_t last = 0;
+  for (size_t i = 0; i < return_data.size(); ++i) {
+    if (!has(index + i, kValid)) {
+      first = std::min(first, i);
+      last = i + 1;
+    }
+  }
+
+  if (first < last) {
+    PW_TRY(device_.ReadRegisters(register_address + first,
+                                 return_data.subspan(first, last - first),
+                                 for_at_least));
+  }
+
+  for (size_t i = 0; i < return_data.size(); ++i) {
+    const size_t entry = index + i;
+    if (has(entry, kValid)) {
+      // Cached registers inside the burst keep their cached value, since it
+      // may be a write that has not been flushed yet.
+      return_data[i] = values_[entry];
+    } else if (!has(entry, kVolatile)) {
+      values_[entry] = return_data[i];
+      flags_[entry] |= kValid;
+    }
+  }
+  return OkStatus();
+}
+
+Status RegisterCache::WriteRegister(
+    uint32_t register_address,
+    std::byte value,
+    chrono::SystemClock::duration for_at_least) {
+  return WriteRegisters(
+      register_address, ConstByteSpan(&value, 1), for_at_least);
+}
+
+Status RegisterCache::WriteRegisters(
+    uint32_t register_address,
+    ConstByteSpan register_data,
+    chrono::SystemClock::duration for_at_least) {
+  size_t index;
+  if (!Contains(register_address, register_data.size(), index)) {
+    return Status::OutOfRange();
+  }
+
+  for (size_t i = 0; i < register_data.size(); ++i) {
+    const size_t entry = index + i;
+    if (has(entry, kValid) && values_[entry] == register_data[i]) {
+      continue;
+    }
+    // Volatile registers use their slot only to stage the write below.
+    values_[entry] = register_data[i];
+    if (!has(entry, kVolatile)) {
+      flags_[entry] |= kValid | kDirty;
+    }
+  }
+
+  // Write runs of volatile registers through to the device.
+  const size_t end = index + register_data.size();
+  for (size_t begin = index; begin < end; ++begin) {
+    if (!has(begin, kVolatile)) {
+      continue;
+    }
+    size_t run_end = begin + 1;
+    while (run_end < end && has(run_end, kVolatile)) {
+      run_end += 1;
+    }
+    PW_TRY(WriteRun(begin, run_end, for_at_least));
+    begin = run_end;
+  }
+  return OkStatus();
+}
+
+Status RegisterCache::UpdateRegister(
+    uint32_t register_address,
+    std::byte mask,
+    std::byte value,
+    chrono::SystemClock::duration for_at_least) {
+  const Result<std::byte> current =
+      ReadRegister(register_address, for_at_least);
+  if (!current.ok()) {
+    return current.status();
+  }
+  return WriteRegister(register_address,
+                       (current.value() & ~mask) | (value & mask),
+                       for_at_least);
+}
+
+Status RegisterCache::Flush(chrono::SystemClock::duration for_at_least) {
+  size_t begin = 0;
+  while (begin < values_.size()) {
+    if (!has(begin, kDirty)) {
+      begin += 1;
+      continue;
+    }
+
+    // Extend the run over dirty registers, and over short gaps of clean
+    // registers when a dirty register follows them.
+    size_t end = begin + 1;
+    for (size_t next = end; next < values_.size(); ++next) {
+      if (has(next, kDirty)) {
+        end = next + 1;
+      } else if (!CanRewrite(next) || next - end >= max_rewrite_gap_) {
+        break;
+      }
+    }
+
+    PW_TRY(WriteRun(begin, end, for_at_least));
+    begin = end;
+  }
+  return OkStatus();
+}
+
+void RegisterCache::Invalidate() {
+  for (uint8_t& flags : flags_) {
+    flags &= kVolatile;
+  }
+}
+
+size_t RegisterCache::dirty_count() const {
+  return std::count_if(flags_.begin(), flags_.end(), [](uint8_t flags) {
+    return (flags & kDirty) != 0;
+  });
+}
+
+bool RegisterCache::Contains(uint32_t register_address,
+                             size_t count,
+                             size_t& index) const {
+  if (register_address < first_register_) {
+    return false;
+  }
+  const size_t offset = register_address - first_register_;
+  if (count > values_.size() || offset > values_.size() - count) {
+    return false;
+  }
+  index = offset;
+  return true;
+}
+
+Status RegisterCache::WriteRun(size_t begin,
+                               size_t end,
+                               chrono::SystemClock::duration for_at_least) {
+  const size_t max_burst =
+      write_buffer_.size() -
+      static_cast<size_t>(device_.register_address_size());
+
+  while (begin < end) {
+    const size_t count = std::min(end - begin, max_burst);
+    PW_TRY(device_.WriteRegisters(first_register_ + begin,
+                                  values_.subspan(begin, count),
+                                  write_buffer_,
+                                  for_at_least));
+    for (size_t i = begin; i < begin + count; ++i) {
+      flags_[i] &= static_cast<uint8_t>(~kDirty);
+    }
+    begin += count;
+  }
+  return OkStatus();
+}
+
+}  // namespace pw::i2c
@@ -0,0 +1,289 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#include "pw_i2c/register_cache.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace pw::i2c {
+namespace {
+
+using namespace std::literals::chrono_literals;
+
+constexpr Address kTestDeviceAddress = Address::SevenBit<0x3F>();
+
+constexpr chrono::SystemClock::duration kTimeout =
+    std::chrono::duration_cast<chrono::SystemClock::duration>(100ms);
+
+// A device with 32 auto-incrementing registers and a 1-byte register address.
+class RegisterMapInitiator : public Initiator {
+ public:
+  struct Write {
+    uint8_t first_register;
+    size_t count;
+  };
+
+  std::array<std::byte, 32> registers = {};
+  std::array<Write, 16> writes = {};
+  size_t write_count = 0;
+  size_t read_count = 0;
+  Status result = OkStatus();
+
+ private:
+  Status DoWriteReadFor(Address,
+                        ConstByteSpan tx_data,
+                        ByteSpan rx_data,
+                        chrono::SystemClock::duration) override {
+    if (!result.ok()) {
+      return result;
+    }
+
+    const uint8_t first = static_cast<uint8_t>(tx_data[0]);
+    const ConstByteSpan data = tx_data.subspan(1);
+    if (first + data.size() + rx_data.size() > registers.size()) {
+      return Status::Unavailable();
+    }
+
+    if (rx_data.empty()) {
+      writes[write_count++] = {first, data.size()};
+      std::memcpy(&registers[first], data.data(), data.size());
+    } else {
+      read_count += 1;
+      std::memcpy(rx_data.data(), &registers[first], rx_data.size());
+    }
+    return OkStatus();
+  }
+};
+
+class RegisterCacheTest : public ::testing::Test {
+ protected:
+  RegisterCacheTest()
+      : device_(initiator_,
+                kTestDeviceAddress,
+                std::endian::little,
+                RegisterAddressSize::k1Byte),
+        cache_(device_, /*first_register=*/0) {}
+
+  RegisterMapInitiator initiator_;
+  RegisterDevice device_;
+  RegisterCacheBuffer<32> cache_;
+};
+
+TEST_F(RegisterCacheTest, Read_FirstReadGoesToBus) {
+  initiator_.registers[3] = std::byte{0x42};
+
+  Result<std::byte> value = cache_.ReadRegister(3, kTimeout);
+  ASSERT_EQ(OkStatus(), value.status());
+  EXPECT_EQ(std::byte{0x42}, value.value());
+  EXPECT_EQ(1u, initiator_.read_count);
+}
+
+TEST_F(RegisterCacheTest, Read_CachedReadDoesNotUseBus) {
+  initiator_.registers[3] = std::byte{0x42};
+  ASSERT_EQ(OkStatus(), cache_.ReadRegister(3, kTimeout).status());
+
+  initiator_.registers[3] = std::byte{0x00};
+  Result<std::byte> value = cache_.ReadRegister(3, kTimeout);
+  ASSERT_EQ(OkStatus(), value.status());
+  EXPECT_EQ(std::byte{0x42}, value.value());
+  EXPECT_EQ(1u, initiator_.read_count);
+}
+
+TEST_F(RegisterCacheTest, Read_UncachedRegistersReadInOneBurst) {
+  for (size_t i = 0; i < initiator_.registers.size(); ++i) {
+    initiator_.registers[i] = static_cast<std::byte>(i);
+  }
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(5, std::byte{0xAA}, kTimeout));
+
+  std::array<std::byte, 8> data;
+  ASSERT_EQ(OkStatus(), cache_.ReadRegisters(2, data, kTimeout));
+  EXPECT_EQ(1u, initiator_.read_count);
+
+  // The pending write is read back rather than the device's value.
+  EXPECT_EQ(std::byte{2}, data[0]);
+  EXPECT_EQ(std::byte{0xAA}, data[3]);
+  EXPECT_EQ(std::byte{9}, data[7]);
+
+  ASSERT_EQ(OkStatus(), cache_.ReadRegisters(2, data, kTimeout));
+  EXPECT_EQ(1u, initiator_.read_count);
+}
+
+TEST_F(RegisterCacheTest, Read_VolatileAlwaysGoesToBus) {
+  ASSERT_EQ(OkStatus(), cache_.SetVolatile(7, 1));
+
+  initiator_.registers[7] = std::byte{1};
+  EXPECT_EQ(std::byte{1}, cache_.ReadRegister(7, kTimeout).value());
+  initiator_.registers[7] = std::byte{2};
+  EXPECT_EQ(std::byte{2}, cache_.ReadRegister(7, kTimeout).value());
+  EXPECT_EQ(2u, initiator_.read_count);
+}
+
+TEST_F(RegisterCacheTest, Read_OutOfRange) {
+  RegisterCacheBuffer<4> cache(device_, /*first_register=*/8);
+  std::array<std::byte, 2> data;
+  EXPECT_EQ(Status::OutOfRange(), cache.ReadRegisters(7, data, kTimeout));
+  EXPECT_EQ(Status::OutOfRange(), cache.ReadRegisters(11, data, kTimeout));
+  EXPECT_EQ(OkStatus(), cache.ReadRegisters(10, data, kTimeout));
+}
+
+TEST_F(RegisterCacheTest, Write_DeferredUntilFlush) {
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(1, std::byte{0x11}, kTimeout));
+  EXPECT_EQ(0u, initiator_.write_count);
+  EXPECT_EQ(1u, cache_.dirty_count());
+
+  ASSERT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  EXPECT_EQ(1u, initiator_.write_count);
+  EXPECT_EQ(0u, cache_.dirty_count());
+  EXPECT_EQ(std::byte{0x11}, initiator_.registers[1]);
+
+  ASSERT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  EXPECT_EQ(1u, initiator_.write_count);
+}
+
+TEST_F(RegisterCacheTest, Flush_ContiguousWritesCoalesced) {
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(6, std::byte{6}, kTimeout));
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(4, std::byte{4}, kTimeout));
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(5, std::byte{5}, kTimeout));
+
+  ASSERT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  ASSERT_EQ(1u, initiator_.write_count);
+  EXPECT_EQ(4u, initiator_.writes[0].first_register);
+  EXPECT_EQ(3u, initiator_.writes[0].count);
+  EXPECT_EQ(std::byte{5}, initiator_.registers[5]);
+}
+
+TEST_F(RegisterCacheTest, Flush_BridgesShortCachedGap) {
+  std::array<std::byte, 8> data;
+  ASSERT_EQ(OkStatus(), cache_.ReadRegisters(0, data, kTimeout));
+
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(1, std::byte{1}, kTimeout));
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(4, std::byte{4}, kTimeout));
+
+  // Rewriting the two cached registers between costs no more than a second
+  // transaction.
+  ASSERT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  ASSERT_EQ(1u, initiator_.write_count);
+  EXPECT_EQ(1u, initiator_.writes[0].first_register);
+  EXPECT_EQ(4u, initiator_.writes[0].count);
+}
+
+TEST_F(RegisterCacheTest, Flush_LongGapSplitsBursts) {
+  std::array<std::byte, 8> data;
+  ASSERT_EQ(OkStatus(), cache_.ReadRegisters(0, data, kTimeout));
+
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(0, std::byte{1}, kTimeout));
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(4, std::byte{1}, kTimeout));
+
+  ASSERT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  ASSERT_EQ(2u, initiator_.write_count);
+  EXPECT_EQ(0u, initiator_.writes[0].first_register);
+  EXPECT_EQ(1u, initiator_.writes[0].count);
+  EXPECT_EQ(4u, initiator_.writes[1].first_register);
+  EXPECT_EQ(1u, initiator_.writes[1].count);
+}
+
+TEST_F(RegisterCacheTest, Flush_DoesNotRewriteUncachedOrVolatile) {
+  ASSERT_EQ(OkStatus(), cache_.SetVolatile(2, 1));
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(1, std::byte{1}, kTimeout));
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(3, std::byte{3}, kTimeout));
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(5, std::byte{5}, kTimeout));
+
+  // Register 2 is volatile and register 4 was never read.
+  ASSERT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  EXPECT_EQ(3u, initiator_.write_count);
+}
+
+TEST_F(RegisterCacheTest, Write_UnchangedValueDropped) {
+  initiator_.registers[9] = std::byte{0x5A};
+  ASSERT_EQ(OkStatus(), cache_.ReadRegister(9, kTimeout).status());
+
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(9, std::byte{0x5A}, kTimeout));
+  EXPECT_EQ(0u, cache_.dirty_count());
+}
+
+TEST_F(RegisterCacheTest, Write_VolatileWrittenImmediately) {
+  ASSERT_EQ(OkStatus(), cache_.SetVolatile(10, 2));
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(9, std::byte{9}, kTimeout));
+
+  constexpr std::array<std::byte, 3> kData = {
+      std::byte{9}, std::byte{10}, std::byte{11}};
+  ASSERT_EQ(OkStatus(), cache_.WriteRegisters(9, kData, kTimeout));
+
+  ASSERT_EQ(1u, initiator_.write_count);
+  EXPECT_EQ(10u, initiator_.writes[0].first_register);
+  EXPECT_EQ(2u, initiator_.writes[0].count);
+  EXPECT_EQ(std::byte{11}, initiator_.registers[11]);
+  EXPECT_EQ(1u, cache_.dirty_count());
+}
+
+TEST_F(RegisterCacheTest, UpdateRegister_ReadsOnceThenModifiesCache) {
+  initiator_.registers[12] = std::byte{0xF0};
+
+  ASSERT_EQ(
+      OkStatus(),
+      cache_.UpdateRegister(12, std::byte{0x0F}, std::byte{0x05}, kTimeout));
+  ASSERT_EQ(
+      OkStatus(),
+      cache_.UpdateRegister(12, std::byte{0x80}, std::byte{0x00}, kTimeout));
+  EXPECT_EQ(1u, initiator_.read_count);
+
+  ASSERT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  EXPECT_EQ(1u, initiator_.write_count);
+  EXPECT_EQ(std::byte{0x75}, initiator_.registers[12]);
+}
+
+TEST_F(RegisterCacheTest, Flush_FailureLeavesRegistersDirty) {
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(1, std::byte{1}, kTimeout));
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(20, std::byte{1}, kTimeout));
+
+  initiator_.result = Status::Unavailable();
+  EXPECT_EQ(Status::Unavailable(), cache_.Flush(kTimeout));
+  EXPECT_EQ(2u, cache_.dirty_count());
+
+  initiator_.result = OkStatus();
+  EXPECT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  EXPECT_EQ(0u, cache_.dirty_count());
+}
+
+TEST_F(RegisterCacheTest, Flush_SplitsRunsLongerThanWriteBuffer) {
+  std::array<uint8_t, 3> flags = {};
+  std::array<std::byte, 3> values = {};
+  std::array<std::byte, 3> write_buffer;
+  RegisterCache cache(device_, 0, values, flags, write_buffer);
+
+  constexpr std::array<std::byte, 3> kData = {
+      std::byte{1}, std::byte{2}, std::byte{3}};
+  ASSERT_EQ(OkStatus(), cache.WriteRegisters(0, kData, kTimeout));
+  ASSERT_EQ(OkStatus(), cache.Flush(kTimeout));
+
+  ASSERT_EQ(2u, initiator_.write_count);
+  EXPECT_EQ(2u, initiator_.writes[0].count);
+  EXPECT_EQ(2u, initiator_.writes[1].first_register);
+  EXPECT_EQ(1u, initiator_.writes[1].count);
+}
+
+TEST_F(RegisterCacheTest, Invalidate_RereadsFromBus) {
+  ASSERT_EQ(OkStatus(), cache_.ReadRegister(0, kTimeout).status());
+  ASSERT_EQ(OkStatus(), cache_.WriteRegister(1, std::byte{1}, kTimeout));
+
+  cache_.Invalidate();
+  EXPECT_EQ(0u, cache_.dirty_count());
+  ASSERT_EQ(OkStatus(), cache_.ReadRegister(0, kTimeout).status());
+  EXPECT_EQ(2u, initiator_.read_count);
+}
+
+}  // namespace
+}  // namespace pw::i2c
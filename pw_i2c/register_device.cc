@@ -145,5 +145,38 @@ Status RegisterDevice::ReadRegisters(
                       for_at_least);
 }
 
+Result<Transfer> RegisterDevice::ReadRegistersTransfer(
+    uint32_t register_address,
+    ByteSpan address_buffer,
+    ByteSpan return_data) const {
+  if (address_buffer.size() < static_cast<size_t>(register_address_size_)) {
+    return pw::Status::OutOfRange();
+  }
+
+  ByteBuilder builder(address_buffer);
+  PutRegisterAddressInByteBuilder(
+      builder, register_address, order_, register_address_size_);
+
+  return WriteReadTransfer(
+      address(), ConstByteSpan(builder.data(), builder.size()), return_data);
+}
+
+Result<Transfer> RegisterDevice::WriteRegistersTransfer(
+    uint32_t register_address,
+    ConstByteSpan register_data,
+    ByteSpan buffer) const {
+  if (buffer.size() <
+      register_data.size() + static_cast<size_t>(register_address_size_)) {
+    return pw::Status::OutOfRange();
+  }
+
+  ByteBuilder builder(buffer);
+  PutRegisterAddressInByteBuilder(
+      builder, register_address, order_, register_address_size_);
+  builder.append(register_data.data(), register_data.size());
+
+  return WriteTransfer(address(), ConstByteSpan(builder.data(), builder.size()));
+}
+
 }  // namespace i2c
 }  // namespace pw
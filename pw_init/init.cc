@@ -0,0 +1,101 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_init/init.h"
+
+#include <mutex>
+
+namespace pw::init {
+
+Status Stage::Ensure() {
+  if (initializer_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+  std::lock_guard lock(initializer_->mutex_);
+  return initializer_->RunLocked(*this);
+}
+
+bool Stage::done() const {
+  if (initializer_ == nullptr) {
+    return false;
+  }
+  std::lock_guard lock(initializer_->mutex_);
+  return state_ == State::kDone;
+}
+
+Status Initializer::Register(Stage& stage) {
+  std::lock_guard lock(mutex_);
+  if (stage.initializer_ != nullptr) {
+    return Status::FailedPrecondition();
+  }
+  stage.initializer_ = this;
+  stages_.push_back(stage);
+  return OkStatus();
+}
+
+Status Initializer::RunStages(Mode mode) {
+  Status result;
+
+  // Find the next stage to run each time, since the lock is released between
+  // stages and other threads may run stages in the meantime.
+  while (true) {
+    std::lock_guard lock(mutex_);
+
+    Stage* next = nullptr;
+    for (Stage& stage : stages_) {
+      if (stage.mode_ == mode && stage.state_ == Stage::State::kPending) {
+        next = &stage;
+        break;
+      }
+    }
+    if (next == nullptr) {
+      return result;
+    }
+
+    if (Status status = RunLocked(*next); !status.ok() && result.ok()) {
+      result = status;
+    }
+  }
+}
+
+Status Initializer::RunLocked(Stage& stage) {
+  switch (stage.state_) {
+    case Stage::State::kDone:
+      return stage.status_;
+    case Stage::State::kRunning:
+      // The stage depends on itself through its dependencies.
+      return Status::FailedPrecondition();
+    case Stage::State::kPending:
+      break;
+  }
+
+  stage.state_ = Stage::State::kRunning;
+
+  Status status;
+  for (Stage* dependency : stage.dependencies_) {
+    if (dependency->initializer_ != this || !RunLocked(*dependency).ok()) {
+      status = Status::FailedPrecondition();
+      break;
+    }
+  }
+  if (status.ok()) {
+    status = stage.init_();
+  }
+
+  stage.status_ = status;
+  stage.state_ = Stage::State::kDone;
+  return status;
+}
+
+}  // namespace pw::init
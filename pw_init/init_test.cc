@@ -0,0 +1,173 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_init/init.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+
+namespace pw::init {
+namespace {
+
+// Records the order in which stages run.
+class Log {
+ public:
+  Status Record(char stage, Status result = OkStatus()) {
+    if (count_ < order_.size()) {
+      order_[count_++] = stage;
+    }
+    return result;
+  }
+
+  size_t count() const { return count_; }
+  const char* order() const { return order_.data(); }
+
+ private:
+  std::array<char, 16> order_ = {};
+  size_t count_ = 0;
+};
+
+class Init : public ::testing::Test {
+ protected:
+  Initializer initializer_;
+  Log log_;
+};
+
+TEST_F(Init, RunBootStages_RunsDependenciesFirst) {
+  Stage a("a", Mode::kOnDemand, {}, [this] { return log_.Record('a'); });
+  Stage* const b_deps[] = {&a};
+  Stage b("b", Mode::kBoot, b_deps, [this] { return log_.Record('b'); });
+  Stage* const c_deps[] = {&b, &a};
+  Stage c("c", Mode::kBoot, c_deps, [this] { return log_.Record('c'); });
+
+  ASSERT_EQ(OkStatus(), initializer_.Register(c));
+  ASSERT_EQ(OkStatus(), initializer_.Register(b));
+  ASSERT_EQ(OkStatus(), initializer_.Register(a));
+
+  EXPECT_EQ(OkStatus(), initializer_.RunBootStages());
+  EXPECT_STREQ("abc", log_.order());
+  EXPECT_TRUE(a.done());
+  EXPECT_TRUE(b.done());
+  EXPECT_TRUE(c.done());
+}
+
+TEST_F(Init, RunBootStages_SkipsDeferredStages) {
+  Stage boot("boot", Mode::kBoot, {}, [this] { return log_.Record('b'); });
+  Stage background(
+      "bg", Mode::kBackground, {}, [this] { return log_.Record('g'); });
+  Stage on_demand(
+      "od", Mode::kOnDemand, {}, [this] { return log_.Record('o'); });
+  ASSERT_EQ(OkStatus(), initializer_.Register(background));
+  ASSERT_EQ(OkStatus(), initializer_.Register(on_demand));
+  ASSERT_EQ(OkStatus(), initializer_.Register(boot));
+
+  EXPECT_EQ(OkStatus(), initializer_.RunBootStages());
+  EXPECT_STREQ("b", log_.order());
+
+  EXPECT_EQ(OkStatus(), initializer_.RunBackgroundStages());
+  EXPECT_STREQ("bg", log_.order());
+  EXPECT_FALSE(on_demand.done());
+}
+
+TEST_F(Init, Ensure_RunsStageOnce) {
+  Stage stage("s", Mode::kOnDemand, {}, [this] { return log_.Record('s'); });
+  ASSERT_EQ(OkStatus(), initializer_.Register(stage));
+
+  EXPECT_FALSE(stage.done());
+  EXPECT_EQ(OkStatus(), stage.Ensure());
+  EXPECT_EQ(OkStatus(), stage.Ensure());
+  EXPECT_EQ(1u, log_.count());
+}
+
+TEST_F(Init, Ensure_BackgroundStageBeforeThreadRuns) {
+  Stage dep("d", Mode::kBackground, {}, [this] { return log_.Record('d'); });
+  Stage* const deps[] = {&dep};
+  Stage stage(
+      "s", Mode::kBackground, deps, [this] { return log_.Record('s'); });
+  Stage other(
+      "o", Mode::kBackground, {}, [this] { return log_.Record('o'); });
+  ASSERT_EQ(OkStatus(), initializer_.Register(dep));
+  ASSERT_EQ(OkStatus(), initializer_.Register(stage));
+  ASSERT_EQ(OkStatus(), initializer_.Register(other));
+
+  EXPECT_EQ(OkStatus(), stage.Ensure());
+  EXPECT_STREQ("ds", log_.order());
+
+  EXPECT_EQ(OkStatus(), initializer_.RunBackgroundStages());
+  EXPECT_STREQ("dso", log_.order());
+}
+
+TEST_F(Init, Ensure_Unregistered) {
+  Stage stage("s", Mode::kOnDemand, {}, [this] { return log_.Record('s'); });
+  EXPECT_EQ(Status::FailedPrecondition(), stage.Ensure());
+  EXPECT_EQ(0u, log_.count());
+}
+
+TEST_F(Init, Register_Twice) {
+  Stage stage("s", Mode::kBoot, {}, [] { return OkStatus(); });
+  EXPECT_EQ(OkStatus(), initializer_.Register(stage));
+  EXPECT_EQ(Status::FailedPrecondition(), initializer_.Register(stage));
+
+  Initializer other;
+  EXPECT_EQ(Status::FailedPrecondition(), other.Register(stage));
+}
+
+TEST_F(Init, FailedStage_DependentsFailWithoutRunning) {
+  Stage bad("x", Mode::kBoot, {}, [this] {
+    return log_.Record('x', Status::DataLoss());
+  });
+  Stage* const deps[] = {&bad};
+  Stage dependent("d", Mode::kBoot, deps, [this] { return log_.Record('d'); });
+  Stage independent(
+      "i", Mode::kBoot, {}, [this] { return log_.Record('i'); });
+  ASSERT_EQ(OkStatus(), initializer_.Register(bad));
+  ASSERT_EQ(OkStatus(), initializer_.Register(dependent));
+  ASSERT_EQ(OkStatus(), initializer_.Register(independent));
+
+  EXPECT_EQ(Status::DataLoss(), initializer_.RunBootStages());
+  EXPECT_STREQ("xi", log_.order());
+
+  EXPECT_EQ(Status::DataLoss(), bad.Ensure());
+  EXPECT_EQ(Status::FailedPrecondition(), dependent.Ensure());
+  EXPECT_EQ(2u, log_.count());
+}
+
+TEST_F(Init, UnregisteredDependency_Fails) {
+  Stage unregistered("u", Mode::kBoot, {}, [this] { return log_.Record('u'); });
+  Stage* const deps[] = {&unregistered};
+  Stage stage("s", Mode::kBoot, deps, [this] { return log_.Record('s'); });
+  ASSERT_EQ(OkStatus(), initializer_.Register(stage));
+
+  EXPECT_EQ(Status::FailedPrecondition(), initializer_.RunBootStages());
+  EXPECT_EQ(0u, log_.count());
+}
+
+TEST_F(Init, Cycle_Fails) {
+  Stage* a_deps[1] = {};
+  Stage a("a", Mode::kBoot, a_deps, [this] { return log_.Record('a'); });
+  Stage* const b_deps[] = {&a};
+  Stage b("b", Mode::kBoot, b_deps, [this] { return log_.Record('b'); });
+  a_deps[0] = &b;
+  ASSERT_EQ(OkStatus(), initializer_.Register(a));
+  ASSERT_EQ(OkStatus(), initializer_.Register(b));
+
+  EXPECT_EQ(Status::FailedPrecondition(), initializer_.RunBootStages());
+  EXPECT_TRUE(a.done());
+  EXPECT_TRUE(b.done());
+  EXPECT_EQ(0u, log_.count());
+}
+
+}  // namespace
+}  // namespace pw::init
@@ -0,0 +1,155 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <span>
+
+#include "pw_containers/intrusive_list.h"
+#include "pw_function/function.h"
+#include "pw_status/status.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+#include "pw_thread/thread_core.h"
+
+namespace pw::init {
+
+class Initializer;
+
+// When a stage runs, unless another stage that depends on it runs first.
+enum class Mode {
+  kBoot,        // Run by Initializer::RunBootStages() before the system starts.
+  kBackground,  // Run by the initializer's thread, after boot.
+  kOnDemand,    // Run only when first needed, by Stage::Ensure().
+};
+
+// One step of system initialization, such as initializing a KVS or registering
+// an RPC service. A stage runs its init function once, after all of the stages
+// it depends on have succeeded.
+//
+//   pw::init::Stage flash_stage("flash", Mode::kBoot, {}, [] {
+//     return flash_partition.Init();
+//   });
+//
+//   pw::init::Stage* const kvs_deps[] = {&flash_stage};
+//   pw::init::Stage kvs_stage("kvs", Mode::kBackground, kvs_deps, [] {
+//     return kvs.Init();
+//   });
+//
+// Code that needs a stage's subsystem calls Ensure() before using it. This
+// returns immediately once the stage has run, and otherwise runs it (and its
+// dependencies) first, so deferred stages are safe to use at any time.
+//
+// Stages are not copied or allocated; they must outlive their initializer.
+class Stage : public IntrusiveList<Stage>::Item {
+ public:
+  enum class State {
+    kPending,  // The stage has not run.
+    kRunning,  // The stage or one of its dependencies is running.
+    kDone,     // The stage has run. status() holds its result.
+  };
+
+  Stage(const char* name,
+        Mode mode,
+        std::span<Stage* const> dependencies,
+        Function<Status()>&& init)
+      : name_(name),
+        mode_(mode),
+        dependencies_(dependencies),
+        init_(std::move(init)),
+        initializer_(nullptr),
+        state_(State::kPending),
+        status_(OkStatus()) {}
+
+  Stage(const Stage&) = delete;
+  Stage& operator=(const Stage&) = delete;
+
+  const char* name() const { return name_; }
+  Mode mode() const { return mode_; }
+
+  // Runs the stage and its dependencies, if they have not run, and returns the
+  // stage's result. Blocks while another thread runs any stage.
+  //
+  // Returns:
+  //   The status returned by the stage's init function.
+  //   FAILED_PRECONDITION - The stage is not registered with an initializer, a
+  //       dependency failed, or the dependencies form a cycle.
+  Status Ensure();
+
+  // True once the stage has run, successfully or not.
+  bool done() const;
+
+ private:
+  friend class Initializer;
+
+  const char* const name_;
+  const Mode mode_;
+  const std::span<Stage* const> dependencies_;
+  Function<Status()> init_;
+
+  // These members are guarded by the initializer's mutex.
+  Initializer* initializer_;
+  State state_;
+  Status status_;
+};
+
+// Runs stages in dependency order. Boot stages are run with RunBootStages()
+// before the system starts serving requests; background stages are run later,
+// either by a thread started with the initializer, which is a ThreadCore, or by
+// calling RunBackgroundStages() from an existing thread. On-demand stages run
+// only when Stage::Ensure() is called for them or a stage that depends on them.
+//
+// One stage runs at a time. A stage's init function must not call Ensure();
+// stages it needs are listed as dependencies instead.
+class Initializer : public thread::ThreadCore {
+ public:
+  Initializer() = default;
+
+  Initializer(const Initializer&) = delete;
+  Initializer& operator=(const Initializer&) = delete;
+
+  // Adds a stage. Stages are registered before they run, typically from main()
+  // before RunBootStages(). Returns FAILED_PRECONDITION if the stage is already
+  // registered.
+  Status Register(Stage& stage) PW_LOCKS_EXCLUDED(mutex_);
+
+  // Runs every boot stage that has not run, and the stages they depend on.
+  // Returns OK if all of them succeeded, or the status of the first that
+  // failed. Stages that do not depend on a failed stage still run.
+  Status RunBootStages() PW_LOCKS_EXCLUDED(mutex_) {
+    return RunStages(Mode::kBoot);
+  }
+
+  // Runs every background stage that has not run, one at a time, releasing the
+  // initializer between stages so that Ensure() calls from other threads are
+  // not held up for long. Returns as RunBootStages() does.
+  Status RunBackgroundStages() PW_LOCKS_EXCLUDED(mutex_) {
+    return RunStages(Mode::kBackground);
+  }
+
+ private:
+  friend class Stage;
+
+  // Runs the background stages, then returns.
+  void Run() final { RunBackgroundStages().IgnoreError(); }
+
+  Status RunStages(Mode mode) PW_LOCKS_EXCLUDED(mutex_);
+
+  // Runs the stage's dependencies, then the stage itself, unless it has run.
+  Status RunLocked(Stage& stage) PW_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable sync::Mutex mutex_;
+  IntrusiveList<Stage> stages_ PW_GUARDED_BY(mutex_);
+};
+
+}  // namespace pw::init
@@ -20,6 +20,15 @@ namespace pw {
 
 StatusWithSize AlignedWriter::Write(std::span<const std::byte> data) {
   while (!data.empty()) {
+    if (mode_ == Mode::kPassThrough) {
+      StatusWithSize result = WritePassThrough(data);
+      PW_TRY_WITH_SIZE(result);
+      data = data.subspan(result.size());
+      if (data.empty()) {
+        break;
+      }
+    }
+
     size_t to_copy = std::min(write_size_ - bytes_in_buffer_, data.size());
 
     std::memcpy(&buffer_[bytes_in_buffer_], data.data(), to_copy);
@@ -65,24 +74,55 @@ StatusWithSize AlignedWriter::Write(Input& input, size_t size) {
   return StatusWithSize(bytes_written_);
 }
 
+StatusWithSize AlignedWriter::WritePassThrough(
+    std::span<const std::byte> data) {
+  // Bytes needed to bring the data in the buffer to an alignment boundary.
+  const size_t head =
+      std::min(Padding(bytes_in_buffer_, alignment_bytes_), data.size());
+
+  // Only bypass the buffer if doing so avoids at least one full buffer write.
+  if (data.size() - head < write_size_) {
+    return StatusWithSize(0);
+  }
+
+  // Complete the aligned block in the buffer and write it out first, so the
+  // data reaches the output in order.
+  std::memcpy(&buffer_[bytes_in_buffer_], data.data(), head);
+  bytes_in_buffer_ += head;
+
+  if (bytes_in_buffer_ != 0u) {
+    const size_t buffered = bytes_in_buffer_;
+    bytes_in_buffer_ = 0;
+    PW_TRY_WITH_SIZE(WriteToOutput(std::span(buffer_, buffered)));
+  }
+
+  // Write the aligned portion of the rest directly. The tail is buffered.
+  const std::span<const std::byte> aligned =
+      data.subspan(head, AlignDown(data.size() - head, alignment_bytes_));
+  PW_TRY_WITH_SIZE(WriteToOutput(aligned));
+
+  return StatusWithSize(head + aligned.size());
+}
+
 StatusWithSize AlignedWriter::AddBytesToBuffer(size_t bytes_added) {
   bytes_in_buffer_ += bytes_added;
 
   // If the buffer is full, write it out.
   if (bytes_in_buffer_ == write_size_) {
-    StatusWithSize result = output_.Write(buffer_, write_size_);
-
-    // Always use write_size_ for the bytes written. If there was an error
-    // assume the space was written or at least disturbed.
-    bytes_written_ += write_size_;
     bytes_in_buffer_ = 0;
-
-    if (!result.ok()) {
-      return StatusWithSize(result.status(), bytes_written_);
-    }
+    return WriteToOutput(std::span(buffer_, write_size_));
   }
 
   return StatusWithSize(bytes_written_);
 }
 
+StatusWithSize AlignedWriter::WriteToOutput(std::span<const std::byte> data) {
+  StatusWithSize result = output_.Write(data);
+
+  // Always use the full size for the bytes written. If there was an error
+  // assume the space was written or at least disturbed.
+  bytes_written_ += data.size();
+  return StatusWithSize(result.status(), bytes_written_);
+}
+
 }  // namespace pw
@@ -14,10 +14,14 @@
 
 #include "pw_kvs/alignment.h"
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <string_view>
 
 #include "gtest/gtest.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
 #include "pw_status/status_with_size.h"
 
 namespace pw::kvs {
@@ -337,5 +341,126 @@ TEST(AlignedWriter, WriteFromInput_OutputError) {
   EXPECT_EQ(3u, result.size());  // Attempted to write 3 bytes.
 }
 
+// Output that records the size of each write and the data written.
+class RecordingOutput final : public Output {
+ public:
+  size_t writes() const { return writes_; }
+  size_t largest_write() const { return largest_write_; }
+  std::string_view data() const {
+    return std::string_view(reinterpret_cast<const char*>(data_), size_);
+  }
+
+ private:
+  StatusWithSize DoWrite(std::span<const byte> data) override {
+    EXPECT_EQ(data.size() % kAlignment, 0u);
+    EXPECT_LE(size_ + data.size(), sizeof(data_));
+    std::memcpy(&data_[size_], data.data(), data.size());
+    size_ += data.size();
+    writes_ += 1;
+    largest_write_ = std::max(largest_write_, data.size());
+    return StatusWithSize(data.size());
+  }
+
+  byte data_[256] = {};
+  size_t size_ = 0;
+  size_t writes_ = 0;
+  size_t largest_write_ = 0;
+};
+
+TEST(AlignedWriter, PassThrough_WritesLargeSpanDirectly) {
+  RecordingOutput output;
+  AlignedWriterBuffer<32> writer(
+      kAlignment, output, AlignedWriter::Mode::kPassThrough);
+
+  StatusWithSize result = writer.Write(kBytes);
+  EXPECT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(kData.size(), result.size());
+  EXPECT_EQ(1u, output.writes());
+
+  EXPECT_EQ(kData.size(), writer.Flush().size());
+  EXPECT_EQ(kData, output.data());
+}
+
+TEST(AlignedWriter, PassThrough_BuffersUnalignedHeadAndTail) {
+  RecordingOutput output;
+  AlignedWriterBuffer<32> writer(
+      kAlignment, output, AlignedWriter::Mode::kPassThrough);
+
+  // The head completes the buffered bytes to an alignment boundary, the
+  // aligned middle is written directly, and the tail stays in the buffer.
+  EXPECT_EQ(OkStatus(), writer.Write(kBytes.first(5)).status());
+  EXPECT_EQ(OkStatus(), writer.Write(kBytes.subspan(5, 93)).status());
+  EXPECT_EQ(2u, output.writes());
+  EXPECT_EQ(80u, output.largest_write());
+
+  EXPECT_EQ(OkStatus(), writer.Write(kBytes.subspan(98)).status());
+  EXPECT_EQ(kData.size(), writer.Flush().size());
+  EXPECT_EQ(3u, output.writes());
+  EXPECT_EQ(kData, output.data());
+}
+
+TEST(AlignedWriter, PassThrough_SmallWritesAreBuffered) {
+  RecordingOutput output;
+  AlignedWriterBuffer<32> writer(
+      kAlignment, output, AlignedWriter::Mode::kPassThrough);
+
+  for (size_t i = 0; i < kData.size(); i += 20) {
+    EXPECT_EQ(OkStatus(), writer.Write(kBytes.subspan(i, 20)).status());
+  }
+
+  EXPECT_EQ(kData.size(), writer.Flush().size());
+  EXPECT_EQ(4u, output.writes());  // Three full 30-byte buffers and a flush.
+  EXPECT_EQ(kData, output.data());
+}
+
+// Flash that counts the number of write operations.
+class CountingFlash : public FakeFlashMemoryBuffer<512, 2> {
+ public:
+  CountingFlash() : FakeFlashMemoryBuffer(16) {}
+
+  StatusWithSize Write(Address address,
+                       std::span<const std::byte> data) override {
+    writes += 1;
+    return FakeFlashMemoryBuffer::Write(address, data);
+  }
+
+  size_t writes = 0;
+};
+
+size_t FlashWritesForValue(AlignedWriter::Mode mode) {
+  CountingFlash flash;
+  FlashPartition partition(&flash);
+
+  std::array<byte, 400> value;
+  for (size_t i = 0; i < value.size(); ++i) {
+    value[i] = byte(i);
+  }
+  const uint32_t header = 0x12345678;
+
+  FlashPartition::Output output(partition, 0);
+  StatusWithSize result =
+      AlignedWrite<64>(output,
+                       partition.alignment_bytes(),
+                       {std::as_bytes(std::span(&header, 1)), value},
+                       mode);
+  EXPECT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(AlignUp(sizeof(header) + value.size(), 16), result.size());
+
+  EXPECT_EQ(0, std::memcmp(flash.buffer().data(), &header, sizeof(header)));
+  EXPECT_EQ(0,
+            std::memcmp(
+                &flash.buffer()[sizeof(header)], value.data(), value.size()));
+  return flash.writes;
+}
+
+TEST(AlignedWriter, PassThrough_FewerFlashWrites) {
+  // 404 bytes through a 64-byte buffer take six full writes and a flush.
+  EXPECT_EQ(7u, FlashWritesForValue(AlignedWriter::Mode::kBuffered));
+
+  // The header and first 12 bytes of the value fill one aligned block. The
+  // next 384 bytes are written directly, and the last 4 are flushed.
+  EXPECT_EQ(3u, FlashWritesForValue(AlignedWriter::Mode::kPassThrough));
+}
+
 }  // namespace
 }  // namespace pw::kvs
@@ -0,0 +1,268 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/async_flash_memory.h"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+#include "pw_assert/check.h"
+#include "pw_status/try.h"
+#include "pw_sync/binary_semaphore.h"
+
+namespace pw::kvs {
+namespace {
+
+// Waits for the result of a queued operation.
+class Waiter {
+ public:
+  AsyncFlashMemory::Callback Callback() {
+    return [this](Status status) {
+      result_ = status;
+      done_.release();
+    };
+  }
+
+  Status Wait() {
+    done_.acquire();
+    return result_;
+  }
+
+ private:
+  sync::BinarySemaphore done_;
+  Status result_;
+};
+
+}  // namespace
+
+Status AsyncFlashMemory::Erase(Address flash_address,
+                               size_t num_sectors,
+                               Callback&& on_done) {
+  const size_t offset = flash_address - start_address_;
+  if (flash_address < start_address_ ||
+      offset + num_sectors * sector_size_ > size_bytes()) {
+    return Status::OutOfRange();
+  }
+  if (offset % sector_size_ != 0) {
+    return Status::InvalidArgument();
+  }
+  return Enqueue(Operation::Type::kErase,
+                 flash_address,
+                 num_sectors,
+                 std::span<const std::byte>(),
+                 std::move(on_done));
+}
+
+Status AsyncFlashMemory::Write(Address destination_flash_address,
+                               std::span<const std::byte> data,
+                               Callback&& on_done) {
+  const size_t offset = destination_flash_address - start_address_;
+  if (destination_flash_address < start_address_ ||
+      offset + data.size_bytes() > size_bytes()) {
+    return Status::OutOfRange();
+  }
+  if (offset % alignment_ != 0 || data.size_bytes() % alignment_ != 0) {
+    return Status::InvalidArgument();
+  }
+  return Enqueue(Operation::Type::kWrite,
+                 destination_flash_address,
+                 0,
+                 data,
+                 std::move(on_done));
+}
+
+void AsyncFlashMemory::Complete(Status status) {
+  Callback callback;
+  bool run_queue;
+  {
+    std::lock_guard lock(lock_);
+    PW_DCHECK(in_progress_);
+    in_progress_ = false;
+    callback = PopFront();
+
+    // If the operation finished while it was being started, RunQueue() is
+    // still running and starts the next one.
+    run_queue = !starting_;
+  }
+
+  if (callback != nullptr) {
+    callback(status);
+  }
+  if (run_queue) {
+    RunQueue();
+  }
+}
+
+Status AsyncFlashMemory::Enqueue(Operation::Type type,
+                                 Address address,
+                                 size_t num_sectors,
+                                 std::span<const std::byte> data,
+                                 Callback&& on_done) {
+  {
+    std::lock_guard lock(lock_);
+    if (count_ == queue_.size()) {
+      return Status::ResourceExhausted();
+    }
+
+    Operation& operation = queue_[(head_ + count_) % queue_.size()];
+    operation.type_ = type;
+    operation.address_ = address;
+    operation.num_sectors_ = num_sectors;
+    operation.data_ = data;
+    operation.callback_ = std::move(on_done);
+    count_ += 1;
+
+    // Another context is already working through the queue.
+    if (std::exchange(running_, true)) {
+      return OkStatus();
+    }
+  }
+
+  RunQueue();
+  return OkStatus();
+}
+
+void AsyncFlashMemory::RunQueue() {
+  while (true) {
+    Operation* operation;
+    {
+      std::lock_guard lock(lock_);
+      if (count_ == 0u) {
+        running_ = false;
+        return;
+      }
+      operation = &front();
+      starting_ = true;
+      in_progress_ = true;
+    }
+
+    // The front operation is only removed by Complete() or below, so it can
+    // be read without the lock.
+    const Status status =
+        operation->type_ == Operation::Type::kErase
+            ? DoStartErase(operation->address_, operation->num_sectors_)
+            : DoStartWrite(operation->address_, operation->data_);
+
+    Callback failed;
+    {
+      std::lock_guard lock(lock_);
+      starting_ = false;
+      if (status.ok()) {
+        // Complete() continues the queue once the operation finishes, unless
+        // it already has.
+        if (in_progress_) {
+          return;
+        }
+        continue;
+      }
+      in_progress_ = false;
+      failed = PopFront();
+    }
+
+    if (failed != nullptr) {
+      failed(status);
+    }
+  }
+}
+
+AsyncFlashMemory::Callback AsyncFlashMemory::PopFront() {
+  Callback callback = std::move(front().callback_);
+  front().callback_ = nullptr;
+  front().data_ = std::span<const std::byte>();
+  head_ = (head_ + 1) % queue_.size();
+  count_ -= 1;
+  return callback;
+}
+
+AsyncFlashPartition::AsyncFlashPartition(
+    AsyncFlashMemory* flash,
+    uint32_t start_sector_index,
+    uint32_t sector_count,
+    uint32_t alignment_bytes,  // Defaults to flash alignment
+    PartitionPermission permission)
+    : flash_(*flash),
+      start_sector_index_(start_sector_index),
+      sector_count_(sector_count),
+      alignment_bytes_(
+          alignment_bytes == 0
+              ? flash_.alignment_bytes()
+              : std::max(alignment_bytes, uint32_t(flash_.alignment_bytes()))),
+      permission_(permission) {
+  uint32_t misalignment = (alignment_bytes_ % flash_.alignment_bytes());
+  PW_DCHECK_UINT_EQ(misalignment,
+                    0,
+                    "Flash partition alignment must be a multiple of the flash "
+                    "memory alignment");
+}
+
+Status AsyncFlashPartition::Erase(Address address,
+                                  size_t num_sectors,
+                                  Callback&& on_done) {
+  if (permission_ == PartitionPermission::kReadOnly) {
+    return Status::PermissionDenied();
+  }
+
+  PW_TRY(CheckBounds(address, num_sectors * sector_size_bytes()));
+  const size_t address_sector_offset = address % sector_size_bytes();
+  PW_CHECK_UINT_EQ(address_sector_offset, 0u);
+
+  return flash_.Erase(
+      PartitionToFlashAddress(address), num_sectors, std::move(on_done));
+}
+
+Status AsyncFlashPartition::Write(Address address,
+                                  std::span<const std::byte> data,
+                                  Callback&& on_done) {
+  if (permission_ == PartitionPermission::kReadOnly) {
+    return Status::PermissionDenied();
+  }
+  PW_TRY(CheckBounds(address, data.size()));
+  const size_t address_alignment_offset = address % alignment_bytes();
+  PW_CHECK_UINT_EQ(address_alignment_offset, 0u);
+  const size_t size_alignment_offset = data.size() % alignment_bytes();
+  PW_CHECK_UINT_EQ(size_alignment_offset, 0u);
+  return flash_.Write(
+      PartitionToFlashAddress(address), data, std::move(on_done));
+}
+
+StatusWithSize AsyncFlashPartition::Read(Address address,
+                                         std::span<std::byte> output) {
+  PW_TRY_WITH_SIZE(CheckBounds(address, output.size()));
+  return flash_.Read(PartitionToFlashAddress(address), output);
+}
+
+Status AsyncFlashPartition::CheckBounds(Address address, size_t length) const {
+  if (address + length > size_bytes()) {
+    return Status::OutOfRange();
+  }
+  return OkStatus();
+}
+
+Status BlockingFlashMemory::Erase(Address flash_address, size_t num_sectors) {
+  Waiter waiter;
+  PW_TRY(flash_.Erase(flash_address, num_sectors, waiter.Callback()));
+  return waiter.Wait();
+}
+
+StatusWithSize BlockingFlashMemory::Write(Address destination_flash_address,
+                                          std::span<const std::byte> data) {
+  Waiter waiter;
+  PW_TRY_WITH_SIZE(
+      flash_.Write(destination_flash_address, data, waiter.Callback()));
+  const Status result = waiter.Wait();
+  return StatusWithSize(result, result.ok() ? data.size_bytes() : 0);
+}
+
+}  // namespace pw::kvs
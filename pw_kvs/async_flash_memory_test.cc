@@ -0,0 +1,312 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/async_flash_memory.h"
+
+#include <array>
+#include <cstring>
+#include <optional>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+
+namespace pw::kvs {
+namespace {
+
+using std::byte;
+
+constexpr size_t kSectorSize = 256;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kAlignment = 16;
+constexpr size_t kQueueDepth = 3;
+constexpr size_t kDataSize = 2 * kAlignment;
+
+// Runs operations on a FakeFlashMemory when the test calls Finish(), or as soon
+// as they start if finish_immediately is set.
+class FakeAsyncFlash final : public AsyncFlashMemoryBuffer<kQueueDepth> {
+ public:
+  FakeAsyncFlash()
+      : AsyncFlashMemoryBuffer(kSectorSize, kSectorCount, kAlignment),
+        flash(kAlignment) {}
+
+  Status Enable() override { return OkStatus(); }
+
+  Status Disable() override { return OkStatus(); }
+
+  bool IsEnabled() const override { return true; }
+
+  StatusWithSize Read(Address address, std::span<byte> output) override {
+    return flash.Read(address, output);
+  }
+
+  // Does the operation in progress and completes it.
+  void Finish() {
+    ASSERT_TRUE(in_progress);
+    in_progress = false;
+    Complete(erasing_ ? flash.Erase(address_, num_sectors_)
+                      : flash.Write(address_, data_).status());
+  }
+
+  FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash;
+  bool finish_immediately = false;
+  bool in_progress = false;
+  size_t starts = 0;
+  Status start_error;  // Fails the next start.
+
+ private:
+  Status DoStartErase(Address address, size_t num_sectors) override {
+    erasing_ = true;
+    address_ = address;
+    num_sectors_ = num_sectors;
+    return Start();
+  }
+
+  Status DoStartWrite(Address address, std::span<const byte> data) override {
+    erasing_ = false;
+    address_ = address;
+    data_ = data;
+    return Start();
+  }
+
+  Status Start() {
+    EXPECT_FALSE(in_progress);
+    starts += 1;
+    if (!start_error.ok()) {
+      return std::exchange(start_error, OkStatus());
+    }
+    in_progress = true;
+    if (finish_immediately) {
+      Finish();
+    }
+    return OkStatus();
+  }
+
+  bool erasing_ = false;
+  Address address_ = 0;
+  size_t num_sectors_ = 0;
+  std::span<const byte> data_;
+};
+
+class AsyncFlashTest : public ::testing::Test {
+ protected:
+  AsyncFlashTest() {
+    for (size_t i = 0; i < data_.size(); ++i) {
+      data_[i] = byte(i);
+    }
+  }
+
+  AsyncFlashMemory::Callback Record(std::optional<Status>& result) {
+    return [&result](Status status) { result = status; };
+  }
+
+  bool FlashHasData(size_t address) {
+    return std::memcmp(flash_.flash.buffer().data() + address,
+                       data_.data(),
+                       data_.size()) == 0;
+  }
+
+  FakeAsyncFlash flash_;
+  std::array<byte, kDataSize> data_;
+  std::optional<Status> write_result_;
+};
+
+TEST_F(AsyncFlashTest, Erase_ReturnsBeforeErasing) {
+  std::memset(flash_.flash.buffer().data(), 0, flash_.flash.size_bytes());
+
+  std::optional<Status> result;
+  ASSERT_EQ(OkStatus(), flash_.Erase(kSectorSize, 1, Record(result)));
+
+  EXPECT_TRUE(flash_.in_progress);
+  EXPECT_FALSE(result.has_value());
+  EXPECT_EQ(flash_.pending_operations(), 1u);
+
+  flash_.Finish();
+  EXPECT_EQ(result, OkStatus());
+  EXPECT_EQ(flash_.pending_operations(), 0u);
+  EXPECT_EQ(flash_.flash.buffer()[kSectorSize], byte{0xff});
+  EXPECT_EQ(flash_.flash.buffer()[kSectorSize - 1], byte{0});
+}
+
+TEST_F(AsyncFlashTest, Operations_RunOneAtATimeInOrder) {
+  std::optional<Status> erase_result;
+  std::optional<Status> write_result;
+  ASSERT_EQ(OkStatus(), flash_.Erase(0, 1, Record(erase_result)));
+  ASSERT_EQ(OkStatus(), flash_.Write(kAlignment, data_, Record(write_result)));
+
+  EXPECT_EQ(flash_.starts, 1u);
+  EXPECT_EQ(flash_.pending_operations(), 2u);
+
+  flash_.Finish();
+  EXPECT_EQ(erase_result, OkStatus());
+  EXPECT_FALSE(write_result.has_value());
+  EXPECT_EQ(flash_.starts, 2u);
+
+  flash_.Finish();
+  EXPECT_EQ(write_result, OkStatus());
+  EXPECT_TRUE(FlashHasData(kAlignment));
+}
+
+TEST_F(AsyncFlashTest, Operations_QueueFull_ResourceExhausted) {
+  std::optional<Status> result;
+  for (size_t i = 0; i < kQueueDepth; ++i) {
+    ASSERT_EQ(OkStatus(), flash_.Erase(i * kSectorSize, 1, Record(result)));
+  }
+  EXPECT_EQ(Status::ResourceExhausted(), flash_.Erase(0, 1, Record(result)));
+
+  flash_.Finish();
+  EXPECT_EQ(OkStatus(), flash_.Erase(0, 1, Record(result)));
+}
+
+TEST_F(AsyncFlashTest, Operations_InvalidArguments) {
+  std::optional<Status> result;
+  EXPECT_EQ(Status::InvalidArgument(), flash_.Erase(1, 1, Record(result)));
+  EXPECT_EQ(Status::OutOfRange(),
+            flash_.Erase(kSectorSize, kSectorCount, Record(result)));
+  EXPECT_EQ(Status::InvalidArgument(),
+            flash_.Write(1, data_, Record(result)));
+  EXPECT_EQ(Status::InvalidArgument(),
+            flash_.Write(0, std::span(data_).first(1), Record(result)));
+  EXPECT_EQ(Status::OutOfRange(),
+            flash_.Write(kSectorSize * kSectorCount, data_, Record(result)));
+
+  EXPECT_EQ(flash_.starts, 0u);
+  EXPECT_FALSE(result.has_value());
+}
+
+TEST_F(AsyncFlashTest, Operations_StartFails_CallbackGetsErrorAndNextRuns) {
+  std::optional<Status> first;
+  std::optional<Status> second;
+  std::optional<Status> third;
+  ASSERT_EQ(OkStatus(), flash_.Erase(0, 1, Record(first)));
+  ASSERT_EQ(OkStatus(), flash_.Erase(0, 1, Record(second)));
+  ASSERT_EQ(OkStatus(), flash_.Erase(kSectorSize, 1, Record(third)));
+
+  flash_.start_error = Status::Unavailable();
+  flash_.Finish();
+  EXPECT_EQ(first, OkStatus());
+  EXPECT_EQ(second, Status::Unavailable());
+  EXPECT_FALSE(third.has_value());
+  EXPECT_EQ(flash_.starts, 3u);
+
+  flash_.Finish();
+  EXPECT_EQ(third, OkStatus());
+  EXPECT_EQ(flash_.pending_operations(), 0u);
+}
+
+TEST_F(AsyncFlashTest, Operations_FlashError_PassedToCallback) {
+  std::optional<Status> result;
+  flash_.flash.InjectWriteError(FlashError::Unconditional(Status::DataLoss()));
+  ASSERT_EQ(OkStatus(), flash_.Write(0, data_, Record(result)));
+
+  flash_.Finish();
+  EXPECT_EQ(result, Status::DataLoss());
+}
+
+TEST_F(AsyncFlashTest, Operations_FinishWhileStarting_RunsWholeQueue) {
+  flash_.finish_immediately = true;
+
+  std::optional<Status> erase_result;
+  std::optional<Status> write_result;
+  ASSERT_EQ(OkStatus(), flash_.Erase(0, 1, Record(erase_result)));
+  ASSERT_EQ(OkStatus(), flash_.Write(0, data_, Record(write_result)));
+
+  EXPECT_EQ(erase_result, OkStatus());
+  EXPECT_EQ(write_result, OkStatus());
+  EXPECT_EQ(flash_.pending_operations(), 0u);
+  EXPECT_TRUE(FlashHasData(0));
+}
+
+TEST_F(AsyncFlashTest, Callback_QueuesNextOperation) {
+  ASSERT_EQ(OkStatus(), flash_.Erase(0, 1, [this](Status status) {
+    ASSERT_EQ(OkStatus(), status);
+    EXPECT_EQ(OkStatus(), flash_.Write(0, data_, Record(write_result_)));
+  }));
+
+  flash_.Finish();
+  EXPECT_EQ(flash_.starts, 2u);
+  flash_.Finish();
+  EXPECT_EQ(write_result_, OkStatus());
+  EXPECT_TRUE(FlashHasData(0));
+}
+
+TEST_F(AsyncFlashTest, Partition_TranslatesAddresses) {
+  AsyncFlashPartition partition(&flash_, 2, 2);
+  std::optional<Status> result;
+
+  ASSERT_EQ(OkStatus(), partition.Erase(0, 1, Record(result)));
+  flash_.Finish();
+  ASSERT_EQ(OkStatus(), partition.Write(kAlignment, data_, Record(result)));
+  flash_.Finish();
+
+  EXPECT_EQ(result, OkStatus());
+  EXPECT_TRUE(FlashHasData(2 * kSectorSize + kAlignment));
+
+  std::array<byte, kDataSize> read;
+  ASSERT_EQ(OkStatus(), partition.Read(kAlignment, read).status());
+  EXPECT_EQ(std::memcmp(read.data(), data_.data(), data_.size()), 0);
+}
+
+TEST_F(AsyncFlashTest, Partition_OutOfRange) {
+  AsyncFlashPartition partition(&flash_, 2, 2);
+  std::optional<Status> result;
+
+  EXPECT_EQ(Status::OutOfRange(), partition.Erase(0, 3, Record(result)));
+  EXPECT_EQ(Status::OutOfRange(),
+            partition.Write(2 * kSectorSize, data_, Record(result)));
+  EXPECT_EQ(flash_.starts, 0u);
+}
+
+TEST_F(AsyncFlashTest, Partition_ReadOnly_PermissionDenied) {
+  AsyncFlashPartition partition(
+      &flash_, 0, kSectorCount, 0, PartitionPermission::kReadOnly);
+  std::optional<Status> result;
+
+  EXPECT_EQ(Status::PermissionDenied(), partition.Erase(0, 1, Record(result)));
+  EXPECT_EQ(Status::PermissionDenied(),
+            partition.Write(0, data_, Record(result)));
+}
+
+TEST_F(AsyncFlashTest, Blocking_WorksWithFlashPartition) {
+  flash_.finish_immediately = true;
+  BlockingFlashMemory blocking(flash_);
+  FlashPartition partition(&blocking);
+
+  ASSERT_EQ(OkStatus(), partition.Erase(kSectorSize, 1));
+  StatusWithSize written = partition.Write(kSectorSize, data_);
+  ASSERT_EQ(OkStatus(), written.status());
+  EXPECT_EQ(written.size(), data_.size());
+  EXPECT_TRUE(FlashHasData(kSectorSize));
+
+  std::array<byte, kDataSize> read;
+  ASSERT_EQ(OkStatus(), partition.Read(kSectorSize, read).status());
+  EXPECT_EQ(std::memcmp(read.data(), data_.data(), data_.size()), 0);
+}
+
+TEST_F(AsyncFlashTest, Blocking_ReturnsOperationError) {
+  flash_.finish_immediately = true;
+  BlockingFlashMemory blocking(flash_);
+  flash_.flash.InjectWriteError(FlashError::Unconditional(Status::DataLoss()));
+
+  StatusWithSize written = blocking.Write(0, data_);
+  EXPECT_EQ(Status::DataLoss(), written.status());
+  EXPECT_EQ(written.size(), 0u);
+
+  flash_.start_error = Status::Unavailable();
+  EXPECT_EQ(Status::Unavailable(), blocking.Erase(0, 1));
+}
+
+}  // namespace
+}  // namespace pw::kvs
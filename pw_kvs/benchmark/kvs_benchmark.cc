@@ -0,0 +1,170 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Reads and writes small values in a key-value store on fake flash, which
+// measures the KVS itself rather than any flash driver. Writes periodically
+// fill a sector and include the garbage collection that frees it.
+//
+// PW_KVS_BENCHMARK_KEY_INDEX_SIZE sets the size of the KVS's key index, so that
+// the kvs_runtime report can compare lookups with and without it.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_benchmark/benchmark.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_status/try.h"
+
+#ifndef PW_KVS_BENCHMARK_KEY_INDEX_SIZE
+#define PW_KVS_BENCHMARK_KEY_INDEX_SIZE 0
+#endif  // PW_KVS_BENCHMARK_KEY_INDEX_SIZE
+
+namespace pw::kvs {
+namespace {
+
+using benchmark::DoNotOptimize;
+
+constexpr size_t kMaxEntries = 32;
+constexpr size_t kMaxUsableSectors = 4;
+constexpr size_t kKeyIndexSize = PW_KVS_BENCHMARK_KEY_INDEX_SIZE;
+
+using KvsBuffer = KeyValueStoreBuffer<kMaxEntries,
+                                      kMaxUsableSectors,
+                                      /*kRedundancy=*/1,
+                                      /*kEntryFormats=*/1,
+                                      kKeyIndexSize>;
+
+constexpr const char* kKeys[] = {
+    "boot_count",
+    "calibration",
+    "device_name",
+    "log_level",
+    "serial_number",
+    "wifi_channel",
+    "wifi_ssid",
+    "uptime",
+};
+
+FakeFlashMemoryBuffer<4 * 1024, kMaxUsableSectors> flash(16);
+FlashPartition partition(&flash, 0, flash.sector_count());
+ChecksumCrc16 checksum;
+
+class Kvs {
+ public:
+  Kvs() : kvs_(&partition, {.magic = 0x5b9d41e3, .checksum = &checksum}) {
+    partition.Erase(0, partition.sector_count());
+  }
+
+  Status Init() {
+    PW_TRY(kvs_.Init());
+    for (const char* key : kKeys) {
+      PW_TRY(kvs_.Put(key, value_));
+    }
+    return OkStatus();
+  }
+
+  KvsBuffer& kvs() { return kvs_; }
+  std::array<std::byte, 16>& value() { return value_; }
+
+ private:
+  KvsBuffer kvs_;
+  std::array<std::byte, 16> value_ = {};
+};
+
+PW_BENCHMARK(KeyValueStore, Get_16B) {
+  Kvs kvs;
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  Status status;
+  size_t key = 0;
+  for (auto _ : state) {
+    status.Update(kvs.kvs().Get(kKeys[key], kvs.value()).status());
+    DoNotOptimize(kvs.value());
+    key = (key + 1) % std::size(kKeys);
+  }
+  EXPECT_EQ(OkStatus(), status);
+}
+
+PW_BENCHMARK(KeyValueStore, Put_16B) {
+  Kvs kvs;
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  Status status;
+  size_t key = 0;
+  uint8_t count = 0;
+  for (auto _ : state) {
+    kvs.value()[0] = std::byte{count++};
+    status.Update(kvs.kvs().Put(kKeys[key], kvs.value()));
+    key = (key + 1) % std::size(kKeys);
+  }
+  EXPECT_EQ(OkStatus(), status);
+}
+
+// Reads a 512 B text value, which compresses well, with and without
+// compression, to show what decompressing on every read costs.
+class TextKvs {
+ public:
+  TextKvs(ValueCompression compression)
+      : kvs_(&partition,
+             {.magic = 0x3e8a17c4,
+              .checksum = &checksum,
+              .compression = compression}) {
+    partition.Erase(0, partition.sector_count());
+    constexpr std::string_view kText = "state=idle temp=21.5 rssi=-60; ";
+    for (size_t i = 0; i < value_.size(); ++i) {
+      value_[i] = static_cast<std::byte>(kText[i % kText.size()]);
+    }
+  }
+
+  Status Init() {
+    PW_TRY(kvs_.Init());
+    return kvs_.Put("text", value_);
+  }
+
+  KvsBuffer& kvs() { return kvs_; }
+  std::array<std::byte, 512>& value() { return value_; }
+
+ private:
+  KvsBuffer kvs_;
+  std::array<std::byte, 512> value_;
+};
+
+void GetText(benchmark::State& state, ValueCompression compression) {
+  TextKvs kvs(compression);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  Status status;
+  for (auto _ : state) {
+    status.Update(kvs.kvs().Get("text", kvs.value()).status());
+    DoNotOptimize(kvs.value());
+  }
+  EXPECT_EQ(OkStatus(), status);
+}
+
+PW_BENCHMARK(KeyValueStore, Get_512B_Text) {
+  GetText(state, ValueCompression::kNone);
+}
+
+PW_BENCHMARK(KeyValueStore, Get_512B_Text_Compressed) {
+  GetText(state, ValueCompression::kLz);
+}
+
+}  // namespace
+}  // namespace pw::kvs
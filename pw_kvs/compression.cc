@@ -0,0 +1,386 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/internal/compression.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pw_assert/check.h"
+#include "pw_status/try.h"
+
+namespace pw::kvs::internal {
+
+using std::byte;
+
+namespace {
+
+size_t Hash(byte b0, byte b1, byte b2) {
+  const uint32_t value = uint32_t(b0) | (uint32_t(b1) << 8) |
+                         (uint32_t(b2) << 16);
+  return (value * 2654435761u) >> 24;
+}
+
+}  // namespace
+
+LzCompressor::LzCompressor(stream::SeekableReader& source, size_t size_bytes)
+    : source_(source),
+      source_start_(source.Tell()),
+      size_bytes_(size_bytes) {
+  PW_DCHECK_UINT_LE(size_bytes, kLzMaxValueBytes);
+  Reset().IgnoreError();  // Nothing has been read, so the seek is a no-op.
+}
+
+StatusWithSize LzCompressor::CompressedSize() {
+  PW_TRY_WITH_SIZE(Reset());
+
+  size_t size = token_size_;
+  Status status;
+  while ((status = NextToken()).ok()) {
+    size += token_size_;
+  }
+  if (!status.IsOutOfRange()) {
+    return StatusWithSize(status, 0);
+  }
+
+  PW_TRY_WITH_SIZE(Reset());
+  return StatusWithSize(size);
+}
+
+StatusWithSize LzCompressor::DoRead(ByteSpan dest) {
+  size_t bytes_read = 0;
+  while (bytes_read < dest.size()) {
+    if (token_read_ == token_size_) {
+      const Status status = NextToken();
+      if (!status.ok()) {
+        if (bytes_read == 0u) {
+          return StatusWithSize(status, 0);
+        }
+        break;
+      }
+    }
+
+    const size_t size =
+        std::min(dest.size() - bytes_read, token_size_ - token_read_);
+    std::memcpy(&dest[bytes_read], &token_[token_read_], size);
+    token_read_ += size;
+    bytes_read += size;
+  }
+
+  position_ += bytes_read;
+  return StatusWithSize(bytes_read);
+}
+
+Status LzCompressor::DoSeek(ptrdiff_t offset, stream::Whence origin) {
+  if (origin == stream::Whence::kBeginning && offset == 0) {
+    return Reset();
+  }
+  if ((origin == stream::Whence::kCurrent && offset == 0) ||
+      (origin == stream::Whence::kBeginning &&
+       static_cast<size_t>(offset) == position_)) {
+    return OkStatus();
+  }
+  return Status::Unimplemented();
+}
+
+Status LzCompressor::Reset() {
+  status_ = source_.Seek(static_cast<ptrdiff_t>(source_start_));
+  input_position_ = 0;
+  position_ = 0;
+  buffer_start_ = 0;
+  buffer_end_ = 0;
+  recent_.fill(0);
+  pending_ = {};
+
+  // The first token is the size of the original value.
+  token_[0] = byte(size_bytes_ & 0xff);
+  token_[1] = byte(size_bytes_ >> 8);
+  token_size_ = kLzHeaderBytes;
+  token_read_ = 0;
+  return status_;
+}
+
+Status LzCompressor::NextToken() {
+  PW_TRY(status_);
+  token_read_ = 0;
+  token_size_ = 0;
+
+  if (input_position_ == size_bytes_) {
+    return Status::OutOfRange();
+  }
+
+  Match match = pending_;
+  if (match.length == 0u) {
+    PW_TRY(status_ = Fill());
+    match = FindMatch();
+  }
+  pending_ = {};
+
+  if (match.length >= kLzMinCopyBytes) {
+    token_[0] = byte(0x80 | (match.length - kLzMinCopyBytes));
+    token_[1] = byte(match.distance - 1);
+    token_size_ = 2;
+
+    for (size_t i = 1; i < match.length; ++i) {
+      Insert(input_position_ + i);
+    }
+    input_position_ += match.length;
+    return OkStatus();
+  }
+
+  // Encode literals until the next copy is found.
+  size_t literals = 0;
+  while (true) {
+    token_[1 + literals] = at(input_position_);
+    literals += 1;
+    input_position_ += 1;
+
+    if (literals == kLzMaxLiteralBytes || input_position_ == size_bytes_) {
+      break;
+    }
+
+    PW_TRY(status_ = Fill());
+    match = FindMatch();
+    if (match.length >= kLzMinCopyBytes) {
+      pending_ = match;
+      break;
+    }
+  }
+
+  token_[0] = byte(literals - 1);
+  token_size_ = 1 + literals;
+  return OkStatus();
+}
+
+Status LzCompressor::Fill() {
+  const size_t needed =
+      std::min(size_bytes_, input_position_ + kLzMaxCopyBytes);
+  if (buffer_end_ >= needed) {
+    return OkStatus();
+  }
+
+  // Keep a window of bytes before the input position for copies to refer to.
+  if (needed > buffer_start_ + buffer_.size()) {
+    const size_t new_start = input_position_ - kLzWindowBytes;
+    std::memmove(buffer_.data(),
+                 &buffer_[new_start - buffer_start_],
+                 buffer_end_ - new_start);
+    buffer_start_ = new_start;
+  }
+
+  // Read as much as fits to read from the source in as few calls as possible.
+  const size_t end = std::min(size_bytes_, buffer_start_ + buffer_.size());
+  while (buffer_end_ < end) {
+    const Result<ByteSpan> result = source_.Read(
+        std::span(buffer_).subspan(buffer_end_ - buffer_start_,
+                                   end - buffer_end_));
+    if (!result.ok()) {
+      // OUT_OF_RANGE marks the end of the compressed value, so a source that
+      // ends early is reported differently.
+      return result.status().IsOutOfRange() ? Status::DataLoss()
+                                            : result.status();
+    }
+    buffer_end_ += result.value().size();
+  }
+  return OkStatus();
+}
+
+LzCompressor::Match LzCompressor::FindMatch() {
+  const size_t position = input_position_;
+  if (position + kLzMinCopyBytes > buffer_end_) {
+    return {};
+  }
+
+  const size_t hash = Hash(at(position), at(position + 1), at(position + 2));
+  const size_t recent = recent_[hash];
+  recent_[hash] = static_cast<uint16_t>(position + 1);
+
+  if (recent == 0u || position - (recent - 1) > kLzWindowBytes) {
+    return {};
+  }
+
+  const size_t candidate = recent - 1;
+  const size_t max_length =
+      std::min(kLzMaxCopyBytes, buffer_end_ - position);
+  size_t length = 0;
+  while (length < max_length &&
+         at(candidate + length) == at(position + length)) {
+    length += 1;
+  }
+
+  if (length < kLzMinCopyBytes) {
+    return {};
+  }
+  return {.length = length, .distance = position - candidate};
+}
+
+void LzCompressor::Insert(size_t position) {
+  if (position + kLzMinCopyBytes <= buffer_end_) {
+    recent_[Hash(at(position), at(position + 1), at(position + 2))] =
+        static_cast<uint16_t>(position + 1);
+  }
+}
+
+LzDecompressor::LzDecompressor(stream::SeekableReader& source,
+                               size_t compressed_size_bytes)
+    : source_(source),
+      source_start_(source.Tell()),
+      compressed_size_bytes_(compressed_size_bytes) {
+  Reset().IgnoreError();  // Nothing has been read, so the seek is a no-op.
+}
+
+StatusWithSize LzDecompressor::DecompressedSize() {
+  PW_TRY_WITH_SIZE(ReadHeader());
+  return StatusWithSize(size_bytes_);
+}
+
+size_t LzDecompressor::ConservativeReadLimit() const {
+  return header_read_ ? size_bytes_ - position_ : 0;
+}
+
+StatusWithSize LzDecompressor::DoRead(ByteSpan dest) {
+  PW_TRY_WITH_SIZE(ReadHeader());
+  if (position_ == size_bytes_) {
+    return StatusWithSize::OutOfRange();
+  }
+
+  size_t bytes_read = 0;
+  while (bytes_read < dest.size() && position_ < size_bytes_) {
+    byte value;
+
+    if (literals_remaining_ == 0u && copy_remaining_ == 0u) {
+      byte control;
+      if (!(status_ = ReadByte(control)).ok()) {
+        break;
+      }
+
+      const size_t length = size_t(control) & 0x7f;
+      if ((control & byte(0x80)) == byte(0)) {
+        literals_remaining_ = length + 1;
+      } else {
+        byte distance;
+        if (!(status_ = ReadByte(distance)).ok()) {
+          break;
+        }
+        copy_remaining_ = length + kLzMinCopyBytes;
+        copy_distance_ = size_t(distance) + 1;
+        if (copy_distance_ > position_) {
+          status_ = Status::DataLoss();
+          break;
+        }
+      }
+    }
+
+    if (literals_remaining_ != 0u) {
+      if (!(status_ = ReadByte(value)).ok()) {
+        break;
+      }
+      literals_remaining_ -= 1;
+    } else {
+      value = window_[(position_ - copy_distance_) % kLzWindowBytes];
+      copy_remaining_ -= 1;
+    }
+
+    window_[position_ % kLzWindowBytes] = value;
+    dest[bytes_read] = value;
+    bytes_read += 1;
+    position_ += 1;
+  }
+
+  // A token that continues past the end of the value means it is corrupt.
+  if (position_ == size_bytes_ &&
+      (literals_remaining_ != 0u || copy_remaining_ != 0u)) {
+    status_ = Status::DataLoss();
+  }
+
+  if (bytes_read == 0u || !status_.ok()) {
+    return StatusWithSize(status_, 0);
+  }
+  return StatusWithSize(bytes_read);
+}
+
+Status LzDecompressor::DoSeek(ptrdiff_t offset, stream::Whence origin) {
+  PW_TRY(ReadHeader());
+  PW_TRY_ASSIGN(
+      const size_t target,
+      stream::internal::SeekPosition(offset, origin, position_, size_bytes_));
+
+  if (target < position_) {
+    PW_TRY(Reset());
+    PW_TRY(ReadHeader());
+  }
+
+  std::array<byte, 32> discard;
+  while (position_ < target) {
+    PW_TRY(Read(std::span(discard).first(
+                    std::min(discard.size(), target - position_)))
+               .status());
+  }
+  return OkStatus();
+}
+
+Status LzDecompressor::Reset() {
+  status_ = source_.Seek(static_cast<ptrdiff_t>(source_start_));
+  compressed_read_ = 0;
+  input_start_ = 0;
+  input_end_ = 0;
+  header_read_ = false;
+  size_bytes_ = 0;
+  position_ = 0;
+  literals_remaining_ = 0;
+  copy_remaining_ = 0;
+  copy_distance_ = 0;
+  return status_;
+}
+
+Status LzDecompressor::ReadHeader() {
+  PW_TRY(status_);
+  if (header_read_) {
+    return OkStatus();
+  }
+
+  byte low;
+  byte high;
+  PW_TRY(status_ = ReadByte(low));
+  PW_TRY(status_ = ReadByte(high));
+  size_bytes_ = size_t(low) | (size_t(high) << 8);
+  header_read_ = true;
+  return OkStatus();
+}
+
+Status LzDecompressor::ReadByte(byte& value) {
+  if (input_start_ == input_end_) {
+    const size_t size = std::min(input_.size(),
+                                 compressed_size_bytes_ - compressed_read_);
+    if (size == 0u) {
+      return Status::DataLoss();
+    }
+
+    // Partial reads are fine, since only one byte is needed.
+    const Result<ByteSpan> result = source_.Read(std::span(input_).first(size));
+    if (!result.ok()) {
+      return result.status().IsOutOfRange() ? Status::DataLoss()
+                                            : result.status();
+    }
+    compressed_read_ += result.value().size();
+    input_start_ = 0;
+    input_end_ = result.value().size();
+  }
+
+  value = input_[input_start_];
+  input_start_ += 1;
+  return OkStatus();
+}
+
+}  // namespace pw::kvs::internal
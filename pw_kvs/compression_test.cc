@@ -0,0 +1,210 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/internal/compression.h"
+
+#include <array>
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/span.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::kvs::internal {
+namespace {
+
+using std::byte;
+
+constexpr size_t kMaxCompressedBytes = 1100;
+
+// Compresses a value and reads the compressed value in small chunks to
+// exercise token boundaries.
+ConstByteSpan Compress(ConstByteSpan value,
+                       std::span<byte, kMaxCompressedBytes> buffer) {
+  stream::MemoryReader source(value);
+  LzCompressor compressor(source, value.size());
+
+  const StatusWithSize compressed_size = compressor.CompressedSize();
+  EXPECT_EQ(OkStatus(), compressed_size.status());
+  EXPECT_LE(compressed_size.size(), buffer.size());
+
+  size_t read = 0;
+  while (read < compressed_size.size()) {
+    Result<ByteSpan> chunk = compressor.Read(
+        buffer.subspan(read, std::min<size_t>(7, buffer.size() - read)));
+    EXPECT_EQ(OkStatus(), chunk.status());
+    if (!chunk.ok()) {
+      break;
+    }
+    read += chunk.value().size();
+  }
+  EXPECT_EQ(compressed_size.size(), read);
+  EXPECT_EQ(Status::OutOfRange(), compressor.Read(buffer).status());
+  return buffer.first(read);
+}
+
+StatusWithSize Decompress(ConstByteSpan compressed, ByteSpan output) {
+  stream::MemoryReader source(compressed);
+  LzDecompressor decompressor(source, compressed.size());
+
+  size_t read = 0;
+  while (read < output.size()) {
+    Result<ByteSpan> chunk = decompressor.Read(output.subspan(read));
+    if (chunk.status().IsOutOfRange()) {
+      break;
+    }
+    if (!chunk.ok()) {
+      return StatusWithSize(chunk.status(), read);
+    }
+    read += chunk.value().size();
+  }
+  return StatusWithSize(read);
+}
+
+class LzCompression : public ::testing::Test {
+ protected:
+  LzCompression() : value_{}, compressed_{}, output_{} {}
+
+  void ExpectRoundTrip(ConstByteSpan value) {
+    const ConstByteSpan compressed = Compress(value, compressed_);
+    const StatusWithSize result = Decompress(compressed, output_);
+    EXPECT_EQ(OkStatus(), result.status());
+    ASSERT_EQ(value.size(), result.size());
+    EXPECT_EQ(0, std::memcmp(value.data(), output_.data(), value.size()));
+  }
+
+  std::array<byte, 1024> value_;
+  std::array<byte, kMaxCompressedBytes> compressed_;
+  std::array<byte, 1024> output_;
+};
+
+TEST_F(LzCompression, EmptyValue) {
+  const ConstByteSpan compressed = Compress({}, compressed_);
+  EXPECT_EQ(kLzHeaderBytes, compressed.size());
+
+  stream::MemoryReader source(compressed);
+  LzDecompressor decompressor(source, compressed.size());
+  EXPECT_EQ(0u, decompressor.DecompressedSize().size());
+  EXPECT_EQ(Status::OutOfRange(), decompressor.Read(output_).status());
+}
+
+TEST_F(LzCompression, RepetitiveValue_IsSmaller) {
+  for (size_t i = 0; i < value_.size(); ++i) {
+    value_[i] = byte("The quick brown fox. "[i % 21]);
+  }
+
+  const ConstByteSpan compressed = Compress(value_, compressed_);
+  EXPECT_LT(compressed.size(), value_.size() / 4);
+  ExpectRoundTrip(value_);
+}
+
+TEST_F(LzCompression, RunOfOneByte_IsSmaller) {
+  value_.fill(byte{0x5a});
+
+  const ConstByteSpan compressed = Compress(value_, compressed_);
+  EXPECT_LT(compressed.size(), value_.size() / 16);
+  ExpectRoundTrip(value_);
+}
+
+TEST_F(LzCompression, IncompressibleValue_RoundTrips) {
+  uint32_t state = 0x12345678;
+  for (byte& b : value_) {
+    state = state * 1664525u + 1013904223u;
+    b = byte(state >> 24);
+  }
+
+  const ConstByteSpan compressed = Compress(value_, compressed_);
+  // Literal runs cost one byte for every kLzMaxLiteralBytes.
+  EXPECT_LE(compressed.size(),
+            kLzHeaderBytes + value_.size() +
+                value_.size() / kLzMaxLiteralBytes + 1);
+  ExpectRoundTrip(value_);
+}
+
+TEST_F(LzCompression, ShortValues_RoundTrip) {
+  for (size_t i = 0; i < value_.size(); ++i) {
+    value_[i] = byte(i % 5);
+  }
+  for (size_t size = 0; size < 10; ++size) {
+    ExpectRoundTrip(ConstByteSpan(value_).first(size));
+  }
+}
+
+TEST_F(LzCompression, Compressor_SeekToStart_CompressesAgain) {
+  for (size_t i = 0; i < value_.size(); ++i) {
+    value_[i] = byte(i % 13);
+  }
+  stream::MemoryReader source(value_);
+  LzCompressor compressor(source, value_.size());
+
+  std::array<byte, 16> first;
+  ASSERT_EQ(OkStatus(), compressor.Read(first).status());
+  EXPECT_EQ(Status::Unimplemented(), compressor.Seek(3));
+
+  ASSERT_EQ(OkStatus(), compressor.Seek(0));
+  std::array<byte, 16> second;
+  ASSERT_EQ(OkStatus(), compressor.Read(second).status());
+  EXPECT_EQ(0, std::memcmp(first.data(), second.data(), first.size()));
+}
+
+TEST_F(LzCompression, Compressor_SourceTooShort) {
+  stream::MemoryReader source(ConstByteSpan(value_).first(10));
+  LzCompressor compressor(source, 20);
+  EXPECT_EQ(Status::DataLoss(), compressor.CompressedSize().status());
+}
+
+TEST_F(LzCompression, Decompressor_Seek) {
+  for (size_t i = 0; i < value_.size(); ++i) {
+    value_[i] = byte((i * 7) % 31);
+  }
+  const ConstByteSpan compressed = Compress(value_, compressed_);
+
+  stream::MemoryReader source(compressed);
+  LzDecompressor decompressor(source, compressed.size());
+  EXPECT_EQ(value_.size(), decompressor.DecompressedSize().size());
+
+  std::array<byte, 8> chunk;
+  for (size_t offset : {500u, 900u, 3u, 1016u}) {
+    ASSERT_EQ(OkStatus(), decompressor.Seek(offset));
+    EXPECT_EQ(offset, decompressor.Tell());
+    Result<ByteSpan> result = decompressor.Read(chunk);
+    ASSERT_EQ(OkStatus(), result.status());
+    ASSERT_EQ(chunk.size(), result.value().size());
+    EXPECT_EQ(0, std::memcmp(&value_[offset], chunk.data(), chunk.size()));
+  }
+  EXPECT_EQ(Status::OutOfRange(), decompressor.Read(chunk).status());
+}
+
+TEST_F(LzCompression, Decompressor_CopyBeforeStart_IsDataLoss) {
+  // Size 8, then a copy of 3 bytes from 1 byte back with nothing before it.
+  constexpr auto kCorrupt = std::array{byte{8}, byte{0}, byte{0x80}, byte{0}};
+  EXPECT_EQ(Status::DataLoss(), Decompress(kCorrupt, output_).status());
+}
+
+TEST_F(LzCompression, Decompressor_Truncated_IsDataLoss) {
+  for (size_t i = 0; i < value_.size(); ++i) {
+    value_[i] = byte(i % 11);
+  }
+  const ConstByteSpan compressed = Compress(value_, compressed_);
+
+  EXPECT_EQ(Status::DataLoss(),
+            Decompress(compressed.first(compressed.size() - 1), output_)
+                .status());
+  EXPECT_EQ(Status::DataLoss(),
+            Decompress(compressed.first(1), output_).status());
+}
+
+}  // namespace
+}  // namespace pw::kvs::internal
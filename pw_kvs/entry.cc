@@ -33,15 +33,88 @@ static_assert(
 constexpr size_t kWriteBufferSize =
     std::max(kMaxFlashAlignment, 4 * Entry::kMinAlignmentBytes);
 
+constexpr AlignedWriter::Mode kWriteMode =
+    kAlignedWritePassThrough ? AlignedWriter::Mode::kPassThrough
+                             : AlignedWriter::Mode::kBuffered;
+
+// Entries are checksummed and compared in flash through a stack buffer of this
+// size. The first chunk must hold two headers for VerifyChecksumInFlash.
+constexpr size_t kReadBufferSize =
+    std::max(2 * sizeof(EntryHeader), kValueStreamBufferSize);
+
 using std::byte;
 
+namespace {
+
+// Reads a value from a stream for an AlignedWriter, which expects each read to
+// fill its buffer. Partial reads from the stream are repeated until they do.
+// If a checksum is provided, the bytes are added to it as they are read.
+class StreamInput final : public Input {
+ public:
+  constexpr StreamInput(stream::Reader& reader,
+                        ChecksumAlgorithm* checksum = nullptr)
+      : reader_(reader), checksum_(checksum) {}
+
+ private:
+  StatusWithSize DoRead(std::span<byte> data) override {
+    size_t bytes_read = 0;
+    while (bytes_read < data.size()) {
+      Result<ByteSpan> result = reader_.Read(data.subspan(bytes_read));
+      if (!result.ok()) {
+        return StatusWithSize(result.status(), bytes_read);
+      }
+      if (checksum_ != nullptr) {
+        checksum_->Update(result.value());
+      }
+      bytes_read += result.value().size();
+    }
+    return StatusWithSize(bytes_read);
+  }
+
+  stream::Reader& reader_;
+  ChecksumAlgorithm* checksum_;
+};
+
+}  // namespace
+
 Status Entry::Read(FlashPartition& partition,
                    Address address,
                    const internal::EntryFormats& formats,
                    Entry* entry) {
   EntryHeader header;
   PW_TRY(partition.Read(address, sizeof(header), &header));
+  return FromHeader(partition, address, formats, header, entry);
+}
+
+StatusWithSize Entry::Read(FlashPartition& partition,
+                           Address address,
+                           const internal::EntryFormats& formats,
+                           Entry* entry,
+                           std::span<byte> buffer) {
+  // Entries do not cross sectors, so never read past the end of this one.
+  const size_t sector_size = partition.sector_size_bytes();
+  const size_t sector_end = (address / sector_size + 1) * sector_size;
+  buffer = buffer.first(std::min(buffer.size(), sector_end - address));
+
+  if (buffer.size() < sizeof(EntryHeader)) {
+    PW_TRY_WITH_SIZE(Read(partition, address, formats, entry));
+    return StatusWithSize(0);
+  }
 
+  PW_TRY_WITH_SIZE(partition.Read(address, buffer));
+
+  EntryHeader header;
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  PW_TRY_WITH_SIZE(FromHeader(partition, address, formats, header, entry));
+
+  return StatusWithSize(std::min(buffer.size(), entry->content_size()));
+}
+
+Status Entry::FromHeader(FlashPartition& partition,
+                         Address address,
+                         const internal::EntryFormats& formats,
+                         const EntryHeader& header,
+                         Entry* entry) {
   if (partition.AppearsErased(std::as_bytes(std::span(&header.magic, 1)))) {
     return Status::NotFound();
   }
@@ -73,6 +146,67 @@ Status Entry::ReadKey(FlashPartition& partition,
       .status();
 }
 
+Result<Entry> Entry::Valid(FlashPartition& partition,
+                           Address address,
+                           const EntryFormat& format,
+                           Key key,
+                           stream::SeekableReader& value,
+                           size_t value_size_bytes,
+                           uint32_t transaction_id) {
+  Entry entry(&partition,
+              address,
+              format,
+              CreateHeader(partition,
+                           format,
+                           key,
+                           static_cast<uint16_t>(value_size_bytes),
+                           transaction_id));
+  if (entry.checksum_algo_ == nullptr) {
+    return entry;
+  }
+
+  // The checksum precedes the value in flash, so read the value once to
+  // calculate it, then rewind so Write() can read the value again.
+  const size_t start = value.Tell();
+  ChecksumAlgorithm& checksum = *entry.checksum_algo_;
+  checksum.Reset();
+  checksum.Update(&entry.header_, sizeof(entry.header_));  // checksum is 0
+  checksum.Update(std::as_bytes(std::span(key)));
+
+  StreamInput input(value);
+  std::array<byte, kValueStreamBufferSize> buffer;
+  for (size_t remaining = value_size_bytes; remaining != 0u;) {
+    const size_t read_size = std::min(remaining, buffer.size());
+    PW_TRY(input.Read(buffer.data(), read_size).status());
+    checksum.Update(buffer.data(), read_size);
+    remaining -= read_size;
+  }
+
+  entry.AddPaddingBytesToChecksum();
+
+  const std::span<const byte> result = checksum.Finish();
+  std::memcpy(&entry.header_.checksum,
+              result.data(),
+              std::min(result.size(), sizeof(entry.header_.checksum)));
+
+  PW_TRY(value.Seek(static_cast<ptrdiff_t>(start)));
+  return entry;
+}
+
+EntryHeader Entry::CreateHeader(const FlashPartition& partition,
+                                const EntryFormat& format,
+                                Key key,
+                                uint16_t value_size_bytes,
+                                uint32_t transaction_id) {
+  return {.magic = format.magic,
+          .checksum = 0,
+          .alignment_units =
+              alignment_bytes_to_units(partition.alignment_bytes()),
+          .key_length_bytes = static_cast<uint8_t>(key.size()),
+          .value_size_bytes = value_size_bytes,
+          .transaction_id = transaction_id};
+}
+
 Entry::Entry(FlashPartition& partition,
              Address address,
              const EntryFormat& format,
@@ -83,13 +217,8 @@ Entry::Entry(FlashPartition& partition,
     : Entry(&partition,
             address,
             format,
-            {.magic = format.magic,
-             .checksum = 0,
-             .alignment_units =
-                 alignment_bytes_to_units(partition.alignment_bytes()),
-             .key_length_bytes = static_cast<uint8_t>(key.size()),
-             .value_size_bytes = value_size_bytes,
-             .transaction_id = transaction_id}) {
+            CreateHeader(
+                partition, format, key, value_size_bytes, transaction_id)) {
   if (checksum_algo_ != nullptr) {
     std::span<const byte> checksum = CalculateChecksum(key, value);
     std::memcpy(&header_.checksum,
@@ -104,12 +233,70 @@ StatusWithSize Entry::Write(Key key, std::span<const byte> value) const {
                                         alignment_bytes(),
                                         {std::as_bytes(std::span(&header_, 1)),
                                          std::as_bytes(std::span(key)),
-                                         value});
+                                         value},
+                                        kWriteMode);
+}
+
+StatusWithSize Entry::Write(Key key, stream::Reader& value) const {
+  FlashPartition::Output flash(partition(), address_);
+  AlignedWriterBuffer<kWriteBufferSize> writer(
+      alignment_bytes(), flash, kWriteMode);
+
+  PW_TRY_WITH_SIZE(writer.Write(&header_, sizeof(header_)));
+  PW_TRY_WITH_SIZE(writer.Write(std::as_bytes(std::span(key))));
+
+  // The value is read directly into the writer's buffer, one chunk at a time,
+  // and checksummed on the way, so a reader that returned different data when
+  // Valid() calculated the checksum is caught without reading flash.
+  if (checksum_algo_ != nullptr) {
+    EntryHeader header_for_checksum = header_;
+    header_for_checksum.checksum = 0;
+
+    checksum_algo_->Reset();
+    checksum_algo_->Update(&header_for_checksum, sizeof(header_for_checksum));
+    checksum_algo_->Update(std::as_bytes(std::span(key)));
+  }
+
+  StreamInput input(value, checksum_algo_);
+  PW_TRY_WITH_SIZE(writer.Write(input, value_size()));
+  const StatusWithSize result = writer.Flush();
+  PW_TRY_WITH_SIZE(result);
+
+  if (checksum_algo_ != nullptr) {
+    AddPaddingBytesToChecksum();
+    checksum_algo_->Finish();
+    if (!checksum_algo_->Verify(checksum_bytes()).ok()) {
+      PW_LOG_ERROR("Value changed while writing the entry at %u",
+                   unsigned(address_));
+      return StatusWithSize::DataLoss(result.size());
+    }
+  }
+  return result;
+}
+
+Status Entry::Write(AlignedWriter& writer,
+                    Key key,
+                    std::span<const byte> value) const {
+  PW_TRY(writer.Write(&header_, sizeof(header_)).status());
+  PW_TRY(writer.Write(std::as_bytes(std::span(key))).status());
+  PW_TRY(writer.Write(value).status());
+
+  // Pad the entry so that the next entry starts at an aligned address.
+  constexpr byte padding[kMinAlignmentBytes - 1] = {};
+  size_t padding_to_add = Padding(content_size(), alignment_bytes());
+
+  while (padding_to_add != 0u) {
+    const size_t chunk_size = std::min(padding_to_add, sizeof(padding));
+    PW_TRY(writer.Write(padding, chunk_size).status());
+    padding_to_add -= chunk_size;
+  }
+  return OkStatus();
 }
 
 Status Entry::Update(const EntryFormat& new_format,
                      uint32_t new_transaction_id) {
   checksum_algo_ = new_format.checksum;
+  compression_ = new_format.compression;
   header_.magic = new_format.magic;
   header_.alignment_units =
       alignment_bytes_to_units(partition_->alignment_bytes());
@@ -142,7 +329,8 @@ StatusWithSize Entry::Copy(Address new_address) const {
 }
 
 StatusWithSize Entry::ReadValue(std::span<byte> buffer,
-                                size_t offset_bytes) const {
+                                size_t offset_bytes,
+                                std::span<const byte> read_ahead) const {
   if (offset_bytes > value_size()) {
     return StatusWithSize::OutOfRange();
   }
@@ -150,10 +338,20 @@ StatusWithSize Entry::ReadValue(std::span<byte> buffer,
   const size_t remaining_bytes = value_size() - offset_bytes;
   const size_t read_size = std::min(buffer.size(), remaining_bytes);
 
-  StatusWithSize result = partition().Read(
-      address_ + sizeof(EntryHeader) + key_length() + offset_bytes,
-      buffer.subspan(0, read_size));
-  PW_TRY_WITH_SIZE(result);
+  // Copy the part of the value that was read with the header, if any.
+  const size_t read_ahead_start =
+      sizeof(EntryHeader) + key_length() + offset_bytes;
+  size_t copied = 0;
+  if (read_ahead.size() > read_ahead_start) {
+    copied = std::min(read_size, read_ahead.size() - read_ahead_start);
+    std::memcpy(buffer.data(), &read_ahead[read_ahead_start], copied);
+  }
+
+  if (copied < read_size) {
+    PW_TRY_WITH_SIZE(
+        partition().Read(value_address() + offset_bytes + copied,
+                         buffer.subspan(copied, read_size - copied)));
+  }
 
   if (read_size != remaining_bytes) {
     return StatusWithSize::ResourceExhausted(read_size);
@@ -161,6 +359,36 @@ StatusWithSize Entry::ReadValue(std::span<byte> buffer,
   return StatusWithSize(read_size);
 }
 
+StatusWithSize Entry::ReadValue(stream::Writer& writer,
+                                size_t offset_bytes) const {
+  if (offset_bytes > value_size()) {
+    return StatusWithSize::OutOfRange();
+  }
+
+  Address address = value_address() + offset_bytes;
+  const Address end = value_address() + value_size();
+
+  std::array<byte, kValueStreamBufferSize> buffer;
+  size_t bytes_written = 0;
+  while (address < end) {
+    const std::span<byte> chunk =
+        std::span(buffer).first(std::min(size_t(end - address), buffer.size()));
+
+    Status status = partition().Read(address, chunk).status();
+    if (status.ok()) {
+      status = writer.Write(chunk);
+    }
+    if (!status.ok()) {
+      return StatusWithSize(status, bytes_written);
+    }
+
+    address += chunk.size();
+    bytes_written += chunk.size();
+  }
+
+  return StatusWithSize(bytes_written);
+}
+
 Status Entry::ValueMatches(std::span<const std::byte> value) const {
   if (value_size() != value.size_bytes()) {
     return Status::NotFound();
@@ -170,7 +398,7 @@ Status Entry::ValueMatches(std::span<const std::byte> value) const {
   Address end = address + value_size();
   const std::byte* value_ptr = value.data();
 
-  std::array<std::byte, 2 * kMinAlignmentBytes> buffer;
+  std::array<std::byte, kReadBufferSize> buffer;
   while (address < end) {
     const size_t read_size = std::min(size_t(end - address), buffer.size());
     PW_TRY(partition_->Read(address, std::span(buffer).first(read_size)));
@@ -196,10 +424,10 @@ Status Entry::VerifyChecksum(Key key, std::span<const byte> value) const {
 
 Status Entry::VerifyChecksumInFlash() const {
   // Read the entire entry piece-by-piece into a small buffer. If the entry is
-  // 32 B or less, only one read is required.
+  // no larger than the buffer, only one read is required.
   union {
     EntryHeader header_to_verify;
-    byte buffer[sizeof(EntryHeader) * 2];
+    byte buffer[kReadBufferSize];
   };
 
   size_t bytes_to_read = size();
@@ -290,7 +518,7 @@ Status Entry::CalculateChecksumFromFlash() {
   // after checksumming the key and value from flash.
   const Address end = address_ + content_size();
 
-  std::array<std::byte, 2 * kMinAlignmentBytes> buffer;
+  std::array<std::byte, kReadBufferSize> buffer;
   while (address < end) {
     const size_t read_size = std::min(size_t(end - address), buffer.size());
     PW_TRY(partition_->Read(address, std::span(buffer).first(read_size)));
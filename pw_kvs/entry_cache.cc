@@ -17,6 +17,7 @@
 
 #include "pw_kvs/internal/entry_cache.h"
 
+#include <algorithm>
 #include <cinttypes>
 
 #include "pw_kvs/flash_memory.h"
@@ -59,6 +60,37 @@ void EntryMetadata::Reset(const KeyDescriptor& descriptor, Address address) {
   addresses_ = addresses_.first(1);
 }
 
+void KeyTable::Reset() {
+  std::fill(offsets_.begin(), offsets_.end(), kNotCached);
+  used_bytes_ = 0;
+}
+
+bool KeyTable::Set(size_t descriptor_index, Key key) {
+  if (descriptor_index >= offsets_.size()) {
+    return false;
+  }
+  if (key.empty()) {
+    offsets_[descriptor_index] = kNotCached;
+    return true;
+  }
+  if (Get(descriptor_index) == key) {
+    return true;
+  }
+
+  // Keys are limited to Entry::kMaxKeyLength, so the length fits in one byte.
+  if (key.size() > Entry::kMaxKeyLength ||
+      arena_.size() - used_bytes_ < 1 + key.size()) {
+    offsets_[descriptor_index] = kNotCached;
+    return false;
+  }
+
+  offsets_[descriptor_index] = static_cast<Offset>(used_bytes_);
+  arena_[used_bytes_] = static_cast<char>(key.size());
+  std::copy(key.begin(), key.end(), &arena_[used_bytes_ + 1]);
+  used_bytes_ += 1 + key.size();
+  return true;
+}
+
 StatusWithSize EntryCache::Find(FlashPartition& partition,
                                 const Sectors& sectors,
                                 const EntryFormats& formats,
@@ -68,70 +100,93 @@ StatusWithSize EntryCache::Find(FlashPartition& partition,
   Entry::KeyBuffer key_buffer;
   bool error_detected = false;
 
-  for (size_t i = 0; i < descriptors_.size(); ++i) {
-    if (descriptors_[i].key_hash == hash) {
-      bool key_found = false;
-      Key read_key;
-
-      for (Address address : addresses(i)) {
-        Status read_result =
-            Entry::ReadKey(partition, address, key.size(), key_buffer.data());
-
-        read_key = Key(key_buffer.data(), key.size());
-
-        if (read_result.ok() && hash == internal::Hash(read_key)) {
-          key_found = true;
-          break;
-        } else {
-          // A hash mismatch can be caused by reading invalid data or a key hash
-          // collision of keys with differing size. To verify the data read from
-          // flash is good, validate the entry.
-          Entry entry;
-          read_result = Entry::Read(partition, address, formats, &entry);
-          if (read_result.ok() && entry.VerifyChecksumInFlash().ok()) {
-            key_found = true;
-            break;
-          }
-
-          PW_LOG_WARN(
-              "   Found corrupt entry, invalidating this copy of the key");
-          error_detected = true;
-          sectors.FromAddress(address).mark_corrupt();
-        }
-      }
-      size_t error_val = error_detected ? 1 : 0;
-
-      if (!key_found) {
-        PW_LOG_ERROR("No valid entries for key. Data has been lost!");
-        return StatusWithSize::DataLoss(error_val);
-      } else if (key == read_key) {
-        PW_LOG_DEBUG("Found match for key hash 0x%08" PRIx32, hash);
-        *metadata = EntryMetadata(descriptors_[i], addresses(i));
-        return StatusWithSize(error_val);
-      } else {
-        PW_LOG_WARN("Found key hash collision for 0x%08" PRIx32, hash);
-        return StatusWithSize::AlreadyExists(error_val);
+  const int index = FindIndex(hash);
+  if (index == -1) {
+    return StatusWithSize::NotFound();
+  }
+
+  const size_t i = index;
+
+  // The key table holds the key of every descriptor it has room for, so
+  // matches and collisions are found without reading flash.
+  if (const Key cached_key = key_table_.Get(i); !cached_key.empty()) {
+    if (key != cached_key) {
+      PW_LOG_WARN("Found key hash collision for 0x%08" PRIx32, hash);
+      return StatusWithSize::AlreadyExists();
+    }
+    PW_LOG_DEBUG("Found match for key hash 0x%08" PRIx32, hash);
+    *metadata = EntryMetadata(descriptors_[i], addresses(i));
+    return StatusWithSize();
+  }
+
+  bool key_found = false;
+  Key read_key;
+
+  for (Address address : addresses(i)) {
+    Status read_result =
+        Entry::ReadKey(partition, address, key.size(), key_buffer.data());
+
+    read_key = Key(key_buffer.data(), key.size());
+
+    if (read_result.ok() && hash == internal::Hash(read_key)) {
+      key_found = true;
+      break;
+    } else {
+      // A hash mismatch can be caused by reading invalid data or a key hash
+      // collision of keys with differing size. To verify the data read from
+      // flash is good, validate the entry.
+      Entry entry;
+      read_result = Entry::Read(partition, address, formats, &entry);
+      if (read_result.ok() && entry.VerifyChecksumInFlash().ok()) {
+        key_found = true;
+        break;
       }
+
+      PW_LOG_WARN("   Found corrupt entry, invalidating this copy of the key");
+      error_detected = true;
+      sectors.FromAddress(address).mark_corrupt();
     }
   }
-  return StatusWithSize::NotFound();
+  size_t error_val = error_detected ? 1 : 0;
+
+  if (!key_found) {
+    PW_LOG_ERROR("No valid entries for key. Data has been lost!");
+    return StatusWithSize::DataLoss(error_val);
+  } else if (key == read_key) {
+    PW_LOG_DEBUG("Found match for key hash 0x%08" PRIx32, hash);
+    key_table_.Set(i, key);
+    *metadata = EntryMetadata(descriptors_[i], addresses(i));
+    return StatusWithSize(error_val);
+  } else {
+    PW_LOG_WARN("Found key hash collision for 0x%08" PRIx32, hash);
+    return StatusWithSize::AlreadyExists(error_val);
+  }
+}
+
+void EntryCache::Reset() const {
+  descriptors_.clear();
+  std::fill(key_index_.begin(), key_index_.end(), KeyIndexSlot(0));
+  key_table_.Reset();
 }
 
 EntryMetadata EntryCache::AddNew(const KeyDescriptor& descriptor,
-                                 Address entry_address) const {
+                                 Address entry_address,
+                                 Key key) const {
   // TODO(hepler): DCHECK(!full());
   Address* first_address = ResetAddresses(descriptors_.size(), entry_address);
   descriptors_.push_back(descriptor);
+  AddToKeyIndex(descriptors_.size() - 1);
+  key_table_.Set(descriptors_.size() - 1, key);
   return EntryMetadata(descriptors_.back(), std::span(first_address, 1));
 }
 
-// TODO: This method is the trigger of the O(valid_entries * all_entries) time
-// complexity for reading. At some cost to memory, this could be optimized by
-// using a hash table instead of scanning, but in practice this should be fine
-// for a small number of keys
+// Without a key index, this method is the trigger of the
+// O(valid_entries * all_entries) time complexity for reading. In practice this
+// is fine for a small number of keys; larger caches should use a key index.
 Status EntryCache::AddNewOrUpdateExisting(const KeyDescriptor& descriptor,
                                           Address address,
-                                          size_t sector_size_bytes) const {
+                                          size_t sector_size_bytes,
+                                          Key key) const {
   // With the new key descriptor, either add it to the descriptor table or
   // overwrite an existing entry with an older version of the key.
   const int index = FindIndex(descriptor.key_hash);
@@ -141,7 +196,7 @@ Status EntryCache::AddNewOrUpdateExisting(const KeyDescriptor& descriptor,
     if (full()) {
       return Status::ResourceExhausted();
     }
-    AddNew(descriptor, address);
+    AddNew(descriptor, address, key);
     return OkStatus();
   }
 
@@ -149,6 +204,7 @@ Status EntryCache::AddNewOrUpdateExisting(const KeyDescriptor& descriptor,
   if (descriptor.transaction_id > descriptors_[index].transaction_id) {
     descriptors_[index] = descriptor;
     ResetAddresses(index, address);
+    key_table_.Set(index, key);
     return OkStatus();
   }
 
@@ -180,6 +236,12 @@ Status EntryCache::AddNewOrUpdateExisting(const KeyDescriptor& descriptor,
   return OkStatus();
 }
 
+void EntryCache::CacheKey(const EntryMetadata& metadata, Key key) const {
+  if (caches_keys() && internal::Hash(key) == metadata.hash()) {
+    key_table_.Set(index(metadata), key);
+  }
+}
+
 size_t EntryCache::present_entries() const {
   size_t present_entries = 0;
 
@@ -193,6 +255,21 @@ size_t EntryCache::present_entries() const {
 }
 
 int EntryCache::FindIndex(uint32_t key_hash) const {
+  if (!key_index_.empty()) {
+    // The index has more slots than entries, so there is always an empty slot
+    // to end the probe sequence.
+    for (size_t slot = KeyIndexStart(key_hash);;
+         slot = (slot + 1) & (key_index_.size() - 1)) {
+      const KeyIndexSlot value = key_index_[slot];
+      if (value == 0u) {
+        return -1;
+      }
+      if (descriptors_[value - 1].key_hash == key_hash) {
+        return value - 1;
+      }
+    }
+  }
+
   for (size_t i = 0; i < descriptors_.size(); ++i) {
     if (descriptors_[i].key_hash == key_hash) {
       return i;
@@ -201,6 +278,18 @@ int EntryCache::FindIndex(uint32_t key_hash) const {
   return -1;
 }
 
+void EntryCache::AddToKeyIndex(size_t descriptor_index) const {
+  if (key_index_.empty()) {
+    return;
+  }
+
+  size_t slot = KeyIndexStart(descriptors_[descriptor_index].key_hash);
+  while (key_index_[slot] != 0u) {
+    slot = (slot + 1) & (key_index_.size() - 1);
+  }
+  key_index_[slot] = static_cast<KeyIndexSlot>(descriptor_index + 1);
+}
+
 void EntryCache::AddAddressIfRoom(size_t descriptor_index,
                                   Address address) const {
   Address* const existing = first_address(descriptor_index);
@@ -14,6 +14,9 @@
 
 #include "pw_kvs/internal/entry_cache.h"
 
+#include <array>
+#include <string_view>
+
 #include "gtest/gtest.h"
 #include "pw_bytes/array.h"
 #include "pw_kvs/fake_flash_memory.h"
@@ -39,6 +42,153 @@ class EmptyEntryCache : public ::testing::Test {
   EntryCache entries_;
 };
 
+class IndexedEntryCache : public ::testing::Test {
+ protected:
+  static constexpr size_t kMaxEntries = 32;
+  static constexpr size_t kRedundancy = 2;
+  static constexpr size_t kIndexSlots = 64;
+
+  IndexedEntryCache()
+      : entries_(descriptors_, addresses_, kRedundancy, key_index_) {}
+
+  // Returns a hash that lands in the same key index slot for every i.
+  static constexpr uint32_t CollidingHash(uint32_t i) {
+    return (i + 1) * kIndexSlots;
+  }
+
+  Vector<KeyDescriptor, kMaxEntries> descriptors_;
+  EntryCache::AddressList<kMaxEntries, kRedundancy> addresses_;
+  std::array<EntryCache::KeyIndexSlot, kIndexSlots> key_index_ = {};
+
+  EntryCache entries_;
+};
+
+static_assert(EntryCache::ValidKeyIndexSize(0, 32));
+static_assert(EntryCache::ValidKeyIndexSize(64, 32));
+static_assert(EntryCache::ValidKeyIndexSize(64, 63));
+static_assert(!EntryCache::ValidKeyIndexSize(32, 32));
+static_assert(!EntryCache::ValidKeyIndexSize(48, 32));
+
+TEST_F(IndexedEntryCache, AddNewOrUpdateExisting_FindsCollidingSlots) {
+  for (uint32_t i = 0; i < kMaxEntries; ++i) {
+    ASSERT_EQ(OkStatus(),
+              entries_.AddNewOrUpdateExisting(
+                  {CollidingHash(i), 1, EntryState::kValid}, i, 1));
+  }
+  ASSERT_TRUE(entries_.full());
+
+  // Newer versions of each key replace the existing descriptors.
+  for (uint32_t i = 0; i < kMaxEntries; ++i) {
+    ASSERT_EQ(OkStatus(),
+              entries_.AddNewOrUpdateExisting(
+                  {CollidingHash(i), 2, EntryState::kValid}, 100 + i, 1));
+  }
+  EXPECT_EQ(kMaxEntries, entries_.total_entries());
+
+  uint32_t i = 0;
+  for (const EntryMetadata& entry : entries_) {
+    EXPECT_EQ(CollidingHash(i), entry.hash());
+    EXPECT_EQ(2u, entry.transaction_id());
+    EXPECT_EQ(100u + i, entry.first_address());
+    i += 1;
+  }
+}
+
+TEST_F(IndexedEntryCache, AddNewOrUpdateExisting_RedundantCopy) {
+  ASSERT_EQ(OkStatus(),
+            entries_.AddNewOrUpdateExisting(
+                {CollidingHash(0), 5, EntryState::kValid}, 0, 100));
+  ASSERT_EQ(OkStatus(),
+            entries_.AddNewOrUpdateExisting(
+                {CollidingHash(0), 5, EntryState::kValid}, 100, 100));
+
+  ASSERT_EQ(1u, entries_.total_entries());
+  EXPECT_EQ(2u, (*entries_.begin()).addresses().size());
+}
+
+TEST_F(IndexedEntryCache, Reset_ClearsIndex) {
+  for (uint32_t i = 0; i < kMaxEntries; ++i) {
+    entries_.AddNew({CollidingHash(i), 1, EntryState::kValid}, i);
+  }
+
+  entries_.Reset();
+  EXPECT_EQ(0u, entries_.total_entries());
+
+  // A stale index would find the old descriptor instead of adding a new one.
+  ASSERT_EQ(OkStatus(),
+            entries_.AddNewOrUpdateExisting(
+                {CollidingHash(3), 1, EntryState::kValid}, 50, 1));
+  EXPECT_EQ(1u, entries_.total_entries());
+  EXPECT_EQ(50u, (*entries_.begin()).first_address());
+}
+
+class KeyTableTest : public ::testing::Test {
+ protected:
+  KeyTableTest() : table_(arena_, offsets_) { table_.Reset(); }
+
+  std::array<char, 16> arena_;
+  std::array<KeyTable::Offset, 4> offsets_;
+  KeyTable table_;
+};
+
+std::string_view View(Key key) { return {key.data(), key.size()}; }
+
+static_assert(KeyTable::ValidSize(0));
+static_assert(KeyTable::ValidSize(65534));
+static_assert(!KeyTable::ValidSize(65535));
+
+TEST_F(KeyTableTest, Set_PacksKeysIntoArena) {
+  EXPECT_TRUE(table_.enabled());
+  EXPECT_TRUE(table_.Set(0, "hello"));
+  EXPECT_TRUE(table_.Set(3, "hi"));
+
+  EXPECT_EQ("hello", View(table_.Get(0)));
+  EXPECT_EQ("hi", View(table_.Get(3)));
+  EXPECT_TRUE(table_.Get(1).empty());
+  EXPECT_EQ(9u, table_.used_bytes());
+}
+
+TEST_F(KeyTableTest, Set_SameKey_DoesNotUseSpace) {
+  ASSERT_TRUE(table_.Set(1, "hello"));
+  ASSERT_TRUE(table_.Set(1, "hello"));
+  EXPECT_EQ(6u, table_.used_bytes());
+}
+
+TEST_F(KeyTableTest, Set_DoesNotFit_LeavesKeyUncached) {
+  ASSERT_TRUE(table_.Set(0, "0123456789"));
+  EXPECT_FALSE(table_.Set(1, "01234"));
+  EXPECT_TRUE(table_.Get(1).empty());
+
+  // A key that was cached is removed if its replacement does not fit.
+  EXPECT_FALSE(table_.Set(0, "abcdefghij"));
+  EXPECT_TRUE(table_.Get(0).empty());
+
+  EXPECT_TRUE(table_.Set(2, "0123"));
+  EXPECT_EQ(16u, table_.used_bytes());
+}
+
+TEST_F(KeyTableTest, Set_EmptyKey_RemovesKey) {
+  ASSERT_TRUE(table_.Set(0, "hello"));
+  EXPECT_TRUE(table_.Set(0, Key()));
+  EXPECT_TRUE(table_.Get(0).empty());
+}
+
+TEST_F(KeyTableTest, Reset_RemovesAllKeys) {
+  ASSERT_TRUE(table_.Set(0, "0123456789"));
+  table_.Reset();
+
+  EXPECT_TRUE(table_.Get(0).empty());
+  EXPECT_EQ(0u, table_.used_bytes());
+  EXPECT_TRUE(table_.Set(1, "0123456789"));
+}
+
+TEST(KeyTable, Disabled) {
+  KeyTable table;
+  EXPECT_FALSE(table.enabled());
+  EXPECT_FALSE(table.Set(0, "hello"));
+  EXPECT_TRUE(table.Get(0).empty());
+}
+
 constexpr char kTheKey[] = "The Key";
 
 constexpr KeyDescriptor kDescriptor = {.key_hash = Hash(kTheKey),
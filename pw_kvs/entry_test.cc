@@ -14,6 +14,7 @@
 
 #include "pw_kvs/internal/entry.h"
 
+#include <array>
 #include <span>
 #include <string_view>
 
@@ -203,6 +204,43 @@ TEST_F(ValidEntryInFlash, ReadValue_WithOffset_PastEnd) {
   EXPECT_EQ(0u, result.size());
 }
 
+TEST_F(ValidEntryInFlash, ReadWithBuffer_ReadsEntryOnce) {
+  std::array<byte, 64> read_ahead;
+  Entry entry;
+  flash_.ResetCosts();
+  StatusWithSize result =
+      Entry::Read(partition_, 0, kFormats, &entry, read_ahead);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(kEntryWithoutPadding1.size(), result.size());
+
+  char value[16] = {};
+  result = entry.ReadValue(std::as_writable_bytes(std::span(value)),
+                           0,
+                           std::span(read_ahead).first(result.size()));
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_STREQ(value, "VALUE!");
+  EXPECT_EQ(1u, flash_.costs().reads);
+}
+
+TEST_F(ValidEntryInFlash, ReadWithBuffer_ReadsRestOfValue) {
+  // The buffer holds the header, key, and the first two bytes of the value.
+  std::array<byte, sizeof(EntryHeader) + 7> read_ahead;
+  Entry entry;
+  StatusWithSize result =
+      Entry::Read(partition_, 0, kFormats, &entry, read_ahead);
+  ASSERT_EQ(OkStatus(), result.status());
+  ASSERT_EQ(read_ahead.size(), result.size());
+
+  char value[16] = {};
+  flash_.ResetCosts();
+  result = entry.ReadValue(
+      std::as_writable_bytes(std::span(value)), 1, read_ahead);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_STREQ(value, "ALUE!");
+  EXPECT_EQ(1u, flash_.costs().reads);
+  EXPECT_EQ(4u, flash_.costs().bytes_read);
+}
+
 TEST(ValidEntry, Write) {
   FakeFlashMemoryBuffer<1024, 4> flash;
   FlashPartition partition(&flash, 0, flash.sector_count(), 32);
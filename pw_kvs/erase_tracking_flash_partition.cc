@@ -0,0 +1,141 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/erase_tracking_flash_partition.h"
+
+#include <algorithm>
+
+#include "pw_assert/check.h"
+#include "pw_kvs/alignment.h"
+#include "pw_status/try.h"
+
+namespace pw::kvs {
+
+EraseTrackingFlashPartition::EraseTrackingFlashPartition(
+    std::span<uint32_t> erased_pages,
+    size_t pages_per_sector,
+    FlashMemory* flash,
+    uint32_t start_sector_index,
+    uint32_t sector_count,
+    uint32_t alignment_bytes,
+    PartitionPermission permission)
+    : FlashPartition(flash,
+                     start_sector_index,
+                     sector_count,
+                     alignment_bytes,
+                     permission),
+      erased_pages_(erased_pages),
+      page_size_(sector_size_bytes() / pages_per_sector) {
+  PW_DCHECK_UINT_GE(erased_pages.size() * kBitsPerWord,
+                    FlashPartition::sector_count() * pages_per_sector,
+                    "There must be a bit for each page");
+  const size_t sector_misalignment = sector_size_bytes() % pages_per_sector;
+  PW_DCHECK_UINT_EQ(sector_misalignment,
+                    0,
+                    "The sector size must be a multiple of the page count");
+  const size_t page_misalignment = page_size_ % this->alignment_bytes();
+  PW_DCHECK_UINT_EQ(page_misalignment,
+                    0,
+                    "The page size must be a multiple of the alignment");
+}
+
+Status EraseTrackingFlashPartition::Erase(Address address,
+                                          size_t num_sectors) {
+  const Address end = address + num_sectors * sector_size_bytes();
+
+  // A failed erase may leave the sectors partly erased.
+  if (CheckBounds(address, end - address).ok()) {
+    SetPages(address / page_size_, end / page_size_, false);
+  }
+  PW_TRY(FlashPartition::Erase(address, num_sectors));
+  SetPages(address / page_size_, end / page_size_, true);
+  return OkStatus();
+}
+
+StatusWithSize EraseTrackingFlashPartition::Write(
+    Address address, std::span<const std::byte> data) {
+  if (!data.empty() && CheckBounds(address, data.size_bytes()).ok()) {
+    SetPages(address / page_size_,
+             AlignUp(address + data.size_bytes(), page_size_) / page_size_,
+             false);
+  }
+  return FlashPartition::Write(address, data);
+}
+
+Status EraseTrackingFlashPartition::IsRegionErased(Address source_flash_address,
+                                                   size_t length,
+                                                   bool* is_erased) {
+  // Checks that are not aligned may not be split into pages, so they are left
+  // to FlashPartition, as are invalid arguments.
+  if (is_erased == nullptr || length % alignment_bytes() != 0 ||
+      source_flash_address % alignment_bytes() != 0 ||
+      !CheckBounds(source_flash_address, length).ok()) {
+    return FlashPartition::IsRegionErased(
+        source_flash_address, length, is_erased);
+  }
+
+  const Address end = source_flash_address + length;
+  Address address = source_flash_address;
+
+  while (address < end) {
+    if (PageErased(address / page_size_)) {
+      address = std::min<Address>(end, AlignDown(address, page_size_) +
+                                           page_size_);
+      continue;
+    }
+
+    // Read the whole run of pages that are not known to be erased at once.
+    Address run_end = address;
+    while (run_end < end && !PageErased(run_end / page_size_)) {
+      run_end =
+          std::min<Address>(end, AlignDown(run_end, page_size_) + page_size_);
+    }
+
+    bool run_erased;
+    PW_TRY(FlashPartition::IsRegionErased(
+        address, run_end - address, &run_erased));
+    if (!run_erased) {
+      *is_erased = false;
+      return OkStatus();
+    }
+
+    // Only pages that were checked in full are known to be erased.
+    SetPages(AlignUp(address, page_size_) / page_size_,
+             AlignDown(run_end, page_size_) / page_size_,
+             true);
+    address = run_end;
+  }
+
+  *is_erased = true;
+  return OkStatus();
+}
+
+void EraseTrackingFlashPartition::ForgetErasedState() {
+  std::fill(erased_pages_.begin(), erased_pages_.end(), 0u);
+}
+
+void EraseTrackingFlashPartition::SetPages(size_t first_page,
+                                           size_t end_page,
+                                           bool erased) {
+  for (size_t page = first_page; page < end_page; ++page) {
+    const uint32_t bit = uint32_t{1} << (page % kBitsPerWord);
+    if (erased) {
+      erased_pages_[page / kBitsPerWord] |= bit;
+    } else {
+      erased_pages_[page / kBitsPerWord] &= ~bit;
+    }
+  }
+}
+
+}  // namespace pw::kvs
@@ -0,0 +1,138 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/erase_tracking_flash_partition.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+
+namespace pw::kvs {
+namespace {
+
+using std::byte;
+
+constexpr size_t kSectorSize = 256;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kAlignment = 16;
+constexpr size_t kPagesPerSector = 4;
+constexpr size_t kPageSize = kSectorSize / kPagesPerSector;
+
+class CountingFlash : public FakeFlashMemoryBuffer<kSectorSize, kSectorCount> {
+ public:
+  CountingFlash() : FakeFlashMemoryBuffer(kAlignment) {}
+
+  StatusWithSize Read(Address address, std::span<byte> output) override {
+    read_bytes += output.size();
+    return FakeFlashMemoryBuffer::Read(address, output);
+  }
+
+  size_t read_bytes = 0;
+};
+
+class EraseTrackingTest : public ::testing::Test {
+ protected:
+  EraseTrackingTest() : partition_(&flash_) { data_.fill(byte{0x5a}); }
+
+  bool RegionErased(FlashPartition::Address address, size_t length) {
+    bool erased = false;
+    EXPECT_EQ(OkStatus(), partition_.IsRegionErased(address, length, &erased));
+    return erased;
+  }
+
+  CountingFlash flash_;
+  EraseTrackingFlashPartitionBuffer<kSectorCount, kPagesPerSector> partition_;
+  std::array<byte, kAlignment> data_;
+};
+
+TEST_F(EraseTrackingTest, IsRegionErased_UnknownRegion_ReadsOnce) {
+  EXPECT_TRUE(RegionErased(0, kSectorSize));
+  EXPECT_EQ(flash_.read_bytes, kSectorSize);
+
+  EXPECT_TRUE(RegionErased(0, kSectorSize));
+  EXPECT_EQ(flash_.read_bytes, kSectorSize);
+}
+
+TEST_F(EraseTrackingTest, IsRegionErased_AfterErase_NoReads) {
+  ASSERT_EQ(OkStatus(), partition_.Erase(0, kSectorCount));
+
+  bool erased = false;
+  ASSERT_EQ(OkStatus(), partition_.IsErased(&erased));
+  EXPECT_TRUE(erased);
+  EXPECT_EQ(flash_.read_bytes, 0u);
+}
+
+TEST_F(EraseTrackingTest, IsRegionErased_AfterWrite_ReadsWrittenPage) {
+  ASSERT_EQ(OkStatus(), partition_.Erase(0, 1));
+  ASSERT_EQ(OkStatus(), partition_.Write(kPageSize, data_).status());
+
+  EXPECT_FALSE(RegionErased(0, kSectorSize));
+  EXPECT_EQ(flash_.read_bytes, kPageSize);
+
+  // The rest of the sector is still known to be erased.
+  flash_.read_bytes = 0;
+  EXPECT_TRUE(RegionErased(2 * kPageSize, 2 * kPageSize));
+  EXPECT_TRUE(RegionErased(0, kPageSize));
+  EXPECT_EQ(flash_.read_bytes, 0u);
+}
+
+TEST_F(EraseTrackingTest, IsRegionErased_PartOfPage_NotRemembered) {
+  EXPECT_TRUE(RegionErased(kPageSize, kAlignment));
+  EXPECT_TRUE(RegionErased(kPageSize, kAlignment));
+  EXPECT_EQ(flash_.read_bytes, 2 * kAlignment);
+}
+
+TEST_F(EraseTrackingTest, IsRegionErased_ReadsOnlyUnknownPages) {
+  EXPECT_TRUE(RegionErased(kPageSize, kPageSize));
+  flash_.read_bytes = 0;
+
+  EXPECT_TRUE(RegionErased(0, kSectorSize));
+  EXPECT_EQ(flash_.read_bytes, kSectorSize - kPageSize);
+}
+
+TEST_F(EraseTrackingTest, IsRegionErased_ErasedAgain_NoReads) {
+  ASSERT_EQ(OkStatus(), partition_.Erase(0, 1));
+  ASSERT_EQ(OkStatus(), partition_.Write(0, data_).status());
+  ASSERT_EQ(OkStatus(), partition_.Erase(0, 1));
+
+  EXPECT_TRUE(RegionErased(0, kSectorSize));
+  EXPECT_EQ(flash_.read_bytes, 0u);
+}
+
+TEST_F(EraseTrackingTest, IsRegionErased_InvalidArguments_SameAsPartition) {
+  bool erased;
+  EXPECT_EQ(Status::InvalidArgument(),
+            partition_.IsRegionErased(0, kAlignment, nullptr));
+  EXPECT_EQ(Status::InvalidArgument(),
+            partition_.IsRegionErased(0, kAlignment + 1, &erased));
+  EXPECT_EQ(Status::OutOfRange(),
+            partition_.IsRegionErased(0, 2 * kSectorCount * kSectorSize,
+                                      &erased));
+}
+
+TEST_F(EraseTrackingTest, ForgetErasedState_ReadsAgain) {
+  ASSERT_EQ(OkStatus(), partition_.Erase(0, 1));
+
+  // Written behind the partition's back.
+  flash_.buffer()[0] = byte{0};
+  partition_.ForgetErasedState();
+
+  EXPECT_FALSE(RegionErased(0, kSectorSize));
+  EXPECT_NE(flash_.read_bytes, 0u);
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -17,10 +17,19 @@
 
 #include "pw_kvs/fake_flash_memory.h"
 
+#include "pw_kvs/alignment.h"
 #include "pw_kvs_private/config.h"
 #include "pw_log/log.h"
 
 namespace pw::kvs {
+namespace {
+
+// Scales a per-KiB cost to a number of bytes, rounding up.
+constexpr uint64_t PerKibCost(uint32_t cost_per_kib, size_t bytes) {
+  return (uint64_t{cost_per_kib} * bytes + 1023) / 1024;
+}
+
+}  // namespace
 
 Status FlashError::Check(std::span<FlashError> errors,
                          FlashMemory::Address address,
@@ -76,6 +85,10 @@ Status FakeFlashMemory::Erase(Address address, size_t num_sectors) {
 
   std::memset(
       &buffer_[address], int(kErasedValue), sector_size_bytes() * num_sectors);
+
+  costs_.sectors_erased += num_sectors;
+  costs_.time_ns += uint64_t{timing_.sector_erase_ns} * num_sectors;
+  costs_.energy_nj += uint64_t{timing_.sector_erase_nj} * num_sectors;
   return OkStatus();
 }
 
@@ -88,6 +101,12 @@ StatusWithSize FakeFlashMemory::Read(Address address,
   // Check for injected read errors
   Status status = FlashError::Check(read_errors_, address, output.size());
   std::memcpy(output.data(), &buffer_[address], output.size());
+
+  costs_.reads += 1;
+  costs_.bytes_read += output.size();
+  costs_.time_ns += timing_.read_setup_ns +
+                    PerKibCost(timing_.read_ns_per_kib, output.size());
+  costs_.energy_nj += PerKibCost(timing_.read_nj_per_kib, output.size());
   return StatusWithSize(status, output.size());
 }
 
@@ -130,6 +149,16 @@ StatusWithSize FakeFlashMemory::Write(Address address,
   // Check for any injected write errors
   Status status = FlashError::Check(write_errors_, address, data.size());
   std::memcpy(&buffer_[address], data.data(), data.size());
+
+  if (!data.empty()) {
+    const size_t page = timing_.program_page_bytes;
+    const size_t pages =
+        (AlignUp(address + data.size(), page) - AlignDown(address, page)) /
+        page;
+    costs_.pages_programmed += pages;
+    costs_.time_ns += uint64_t{timing_.page_program_ns} * pages;
+    costs_.energy_nj += uint64_t{timing_.page_program_nj} * pages;
+  }
   return StatusWithSize(status, data.size());
 }
 
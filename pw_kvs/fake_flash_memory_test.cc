@@ -0,0 +1,109 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/fake_flash_memory.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+
+namespace pw::kvs {
+namespace {
+
+using std::byte;
+
+constexpr size_t kSectorSize = 1024;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kAlignment = 16;
+
+constexpr FlashTimingModel kTiming = {
+    .program_page_bytes = 256,
+    .page_program_ns = 700'000,
+    .page_program_nj = 5'000,
+    .sector_erase_ns = 45'000'000,
+    .sector_erase_nj = 300'000,
+    .read_setup_ns = 1'000,
+    .read_ns_per_kib = 20'000,
+    .read_nj_per_kib = 100,
+};
+
+class FakeFlashTimingTest : public ::testing::Test {
+ protected:
+  FakeFlashTimingTest() : flash_(kAlignment) {
+    flash_.set_timing_model(kTiming);
+    data_.fill(byte{0x42});
+  }
+
+  FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  std::array<byte, 512> data_;
+};
+
+TEST_F(FakeFlashTimingTest, NoTimingModel_CountsOperations) {
+  FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash(kAlignment);
+  ASSERT_EQ(OkStatus(), flash.Erase(0, 2));
+  ASSERT_EQ(OkStatus(), flash.Write(0, data_).status());
+  ASSERT_EQ(OkStatus(), flash.Read(0, data_).status());
+
+  EXPECT_EQ(flash.costs().sectors_erased, 2u);
+  EXPECT_EQ(flash.costs().pages_programmed, 2u);
+  EXPECT_EQ(flash.costs().reads, 1u);
+  EXPECT_EQ(flash.costs().bytes_read, data_.size());
+  EXPECT_EQ(flash.costs().time_ns, 0u);
+  EXPECT_EQ(flash.costs().energy_nj, 0u);
+}
+
+TEST_F(FakeFlashTimingTest, Erase_CostPerSector) {
+  ASSERT_EQ(OkStatus(), flash_.Erase(kSectorSize, 2));
+
+  EXPECT_EQ(flash_.costs().time_ns, 2 * kTiming.sector_erase_ns);
+  EXPECT_EQ(flash_.costs().energy_nj, 2 * kTiming.sector_erase_nj);
+}
+
+TEST_F(FakeFlashTimingTest, Write_PartialPages_CostWholePages) {
+  // 32 bytes that straddle a page boundary program two pages.
+  ASSERT_EQ(OkStatus(),
+            flash_.Write(256 - kAlignment, std::span(data_).first(32))
+                .status());
+
+  EXPECT_EQ(flash_.costs().pages_programmed, 2u);
+  EXPECT_EQ(flash_.costs().time_ns, 2 * kTiming.page_program_ns);
+  EXPECT_EQ(flash_.costs().energy_nj, 2 * kTiming.page_program_nj);
+}
+
+TEST_F(FakeFlashTimingTest, Read_SetupPlusBandwidth) {
+  ASSERT_EQ(OkStatus(), flash_.Read(0, data_).status());
+
+  EXPECT_EQ(flash_.costs().time_ns,
+            kTiming.read_setup_ns + kTiming.read_ns_per_kib / 2);
+  EXPECT_EQ(flash_.costs().energy_nj, kTiming.read_nj_per_kib / 2);
+}
+
+TEST_F(FakeFlashTimingTest, FailedOperation_NotCounted) {
+  EXPECT_EQ(Status::InvalidArgument(), flash_.Erase(1, 1));
+  EXPECT_EQ(Status::InvalidArgument(),
+            flash_.Write(1, std::span(data_).first(kAlignment)).status());
+
+  EXPECT_EQ(flash_.costs().time_ns, 0u);
+}
+
+TEST_F(FakeFlashTimingTest, ResetCosts) {
+  ASSERT_EQ(OkStatus(), flash_.Erase(0, 1));
+  flash_.ResetCosts();
+
+  EXPECT_EQ(flash_.costs().sectors_erased, 0u);
+  EXPECT_EQ(flash_.costs().time_ns, 0u);
+}
+
+}  // namespace
+}  // namespace pw::kvs
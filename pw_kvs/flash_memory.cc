@@ -43,6 +43,30 @@ StatusWithSize FlashPartition::Input::DoRead(std::span<byte> data) {
   return result;
 }
 
+StatusWithSize FlashPartition::Reader::DoRead(std::span<byte> data) {
+  if (position_ >= partition_.size_bytes()) {
+    return StatusWithSize::OutOfRange();
+  }
+
+  const size_t bytes_to_read =
+      std::min(data.size_bytes(), partition_.size_bytes() - position_);
+  StatusWithSize result =
+      partition_.Read(position_, data.first(bytes_to_read));
+  position_ += result.size();
+  return result;
+}
+
+Status FlashPartition::Reader::DoSeek(ptrdiff_t offset,
+                                      stream::Whence origin) {
+  Result<size_t> position = stream::internal::SeekPosition(
+      offset, origin, position_, partition_.size_bytes());
+  if (!position.ok()) {
+    return position.status();
+  }
+  position_ = position.value();
+  return OkStatus();
+}
+
 FlashPartition::FlashPartition(
     FlashMemory* flash,
     uint32_t start_sector_index,
@@ -12,6 +12,8 @@
 // License for the specific language governing permissions and limitations under
 // the License.
 
+#include <array>
+#include <cstring>
 #include <span>
 
 #include "gtest/gtest.h"
@@ -180,6 +182,39 @@ TEST(FlashPartitionTest, EraseTest) {
   }
 }
 
+TEST(FlashPartitionTest, Reader_Seek) {
+  FlashPartition& test_partition = FlashTestPartition();
+  ASSERT_GE(test_partition.sector_count(), 2u);
+  ASSERT_EQ(OkStatus(), test_partition.Erase(0, 2));
+
+  const size_t alignment = test_partition.alignment_bytes();
+  std::array<std::byte, kMaxFlashAlignment> test_data;
+  for (size_t i = 0; i < test_data.size(); ++i) {
+    test_data[i] = std::byte(i + 1);
+  }
+  const FlashPartition::Address address = test_partition.sector_size_bytes();
+  ASSERT_EQ(OkStatus(),
+            test_partition.Write(address, std::span(test_data).first(alignment))
+                .status());
+
+  FlashPartition::Reader reader(test_partition);
+  ASSERT_EQ(OkStatus(), reader.Seek(address));
+  EXPECT_EQ(reader.Tell(), address);
+
+  std::array<std::byte, kMaxFlashAlignment> read_data = {};
+  Result<ByteSpan> result = reader.Read(std::span(read_data).first(alignment));
+  ASSERT_EQ(OkStatus(), result.status());
+  ASSERT_EQ(alignment, result.value().size());
+  EXPECT_EQ(0, std::memcmp(read_data.data(), test_data.data(), alignment));
+  EXPECT_EQ(reader.Tell(), address + alignment);
+
+  EXPECT_EQ(OkStatus(), reader.Seek(-1, stream::Whence::kEnd));
+  EXPECT_EQ(1u, reader.ConservativeReadLimit());
+  EXPECT_EQ(OkStatus(), reader.Read(read_data).status());
+  EXPECT_EQ(Status::OutOfRange(), reader.Read(read_data).status());
+  EXPECT_EQ(Status::OutOfRange(), reader.Seek(1, stream::Whence::kCurrent));
+}
+
 TEST(FlashPartitionTest, AlignmentCheck) {
   FlashPartition& test_partition = FlashTestPartition();
   const size_t alignment = test_partition.alignment_bytes();
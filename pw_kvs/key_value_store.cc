@@ -21,11 +21,14 @@
 #include <cinttypes>
 #include <cstring>
 #include <type_traits>
+#include <utility>
 
 #include "pw_assert/check.h"
+#include "pw_kvs/internal/compression.h"
 #include "pw_kvs_private/config.h"
 #include "pw_log/shorter.h"
 #include "pw_status/try.h"
+#include "pw_stream/memory_stream.h"
 
 namespace pw::kvs {
 namespace {
@@ -36,6 +39,131 @@ constexpr bool InvalidKey(Key key) {
   return key.empty() || (key.size() > internal::Entry::kMaxKeyLength);
 }
 
+// An entry with an empty key, which is never valid for a key-value entry, holds
+// metadata about the entries around it. Its value starts with a MetadataHeader.
+enum class MetadataType : uint32_t {
+  // A summary of the sector's entries, followed by a SectorSummaryRecord for
+  // each key-value entry before it in the sector, in order, including stale
+  // entries. The count is the number of records.
+  kSectorSummary = 1,
+
+  // The start of a batch written by PutBatch. The count is the number of
+  // key-value entries in the batch, which immediately follow the header.
+  kBatch = 2,
+};
+
+struct MetadataHeader {
+  MetadataType type;
+  uint32_t count;
+};
+
+static_assert(sizeof(MetadataHeader) == 8u);
+
+struct SectorSummaryRecord {
+  uint32_t key_hash;
+  uint32_t transaction_id;
+};
+
+static_assert(sizeof(SectorSummaryRecord) == 8u);
+
+using SectorSummaryRecords =
+    std::array<SectorSummaryRecord, kMaxSectorSummaryEntries>;
+
+struct SectorSummary {
+  MetadataHeader header;
+  SectorSummaryRecords records;
+};
+
+bool IsMetadata(const internal::Entry& entry) {
+  return entry.key_length() == 0u;
+}
+
+// Reads the header of a metadata entry. The checksum is not verified.
+Status ReadMetadataHeader(const internal::Entry& entry,
+                          MetadataHeader& header) {
+  // The value may be larger than the header, so only check what was read.
+  const StatusWithSize result =
+      entry.ReadValue(std::as_writable_bytes(std::span(&header, 1)));
+  return result.size() == sizeof(header) ? OkStatus() : Status::DataLoss();
+}
+
+// The size of a metadata entry with the specified value size.
+size_t MetadataSize(const FlashPartition& partition, size_t value_size) {
+  return AlignUp(sizeof(internal::EntryHeader) + value_size,
+                 std::max(partition.alignment_bytes(),
+                          internal::Entry::kMinAlignmentBytes));
+}
+
+// The size of a summary of the specified number of entries, or 0 if that many
+// entries cannot be summarized.
+size_t SectorSummarySize(const FlashPartition& partition, size_t entries) {
+  if (entries > kMaxSectorSummaryEntries) {
+    return 0;
+  }
+  return MetadataSize(
+      partition,
+      sizeof(MetadataHeader) + entries * sizeof(SectorSummaryRecord));
+}
+
+size_t BatchHeaderSize(const FlashPartition& partition) {
+  return MetadataSize(partition, sizeof(MetadataHeader));
+}
+
+// Reads the key hash and transaction ID of each key-value entry in a sector.
+// Returns the number of entries, or more than records.size() if the sector has
+// too many entries or could not be read.
+size_t ReadSectorEntries(FlashPartition& partition,
+                         const internal::Sectors& sectors,
+                         const internal::EntryFormats& formats,
+                         const internal::SectorDescriptor& sector,
+                         SectorSummaryRecords& records) {
+  constexpr size_t kCannotSummarize = kMaxSectorSummaryEntries + 1;
+
+  if (sector.corrupt()) {
+    return kCannotSummarize;
+  }
+
+  const FlashPartition::Address end_address =
+      sectors.NextWritableAddress(sector);
+  size_t count = 0;
+  internal::Entry entry;
+
+  for (FlashPartition::Address address = sectors.BaseAddress(sector);
+       address < end_address;
+       address = entry.next_address()) {
+    if (!internal::Entry::Read(partition, address, formats, &entry).ok()) {
+      return kCannotSummarize;
+    }
+    if (IsMetadata(entry)) {
+      // Entries that follow a batch header are only valid if the whole batch
+      // was written, which a summary cannot express, so leave those sectors
+      // unsummarized.
+      MetadataHeader header;
+      if (!ReadMetadataHeader(entry, header).ok() ||
+          header.type != MetadataType::kSectorSummary) {
+        return kCannotSummarize;
+      }
+      continue;
+    }
+    if (count == records.size()) {
+      return kCannotSummarize;
+    }
+
+    internal::Entry::KeyBuffer key_buffer;
+    const StatusWithSize key_length = entry.ReadKey(key_buffer);
+    if (!key_length.ok()) {
+      return kCannotSummarize;
+    }
+    records[count] = {
+        .key_hash = internal::Hash(Key(key_buffer.data(), key_length.size())),
+        .transaction_id = entry.transaction_id(),
+    };
+    count += 1;
+  }
+
+  return count;
+}
+
 }  // namespace
 
 KeyValueStore::KeyValueStore(FlashPartition* partition,
@@ -45,14 +173,21 @@ KeyValueStore::KeyValueStore(FlashPartition* partition,
                              Vector<SectorDescriptor>& sector_descriptor_list,
                              const SectorDescriptor** temp_sectors_to_skip,
                              Vector<KeyDescriptor>& key_descriptor_list,
-                             Address* addresses)
+                             Address* addresses,
+                             std::span<KeyIndexSlot> key_index,
+                             internal::KeyTable key_table)
     : partition_(*partition),
       formats_(formats),
       sectors_(sector_descriptor_list, *partition, temp_sectors_to_skip),
-      entry_cache_(key_descriptor_list, addresses, redundancy),
+      entry_cache_(
+          key_descriptor_list, addresses, redundancy, key_index, key_table),
       options_(options),
       initialized_(InitializationState::kNotInitialized),
       error_detected_(false),
+      gc_destination_(nullptr),
+      gc_destination_entries_(0),
+      incremental_gc_sector_(nullptr),
+      value_cache_(nullptr),
       internal_stats_({}),
       last_transaction_id_(0) {}
 
@@ -61,6 +196,10 @@ Status KeyValueStore::Init() {
   error_detected_ = false;
   last_transaction_id_ = 0;
 
+  if (value_cache_ != nullptr) {
+    value_cache_->Clear();
+  }
+
   INF("Initializing key value store");
   if (partition_.sector_count() > sectors_.max_size()) {
     ERR("KVS init failed: kMaxUsableSectors (=%u) must be at least as "
@@ -88,7 +227,12 @@ Status KeyValueStore::Init() {
     return Status::FailedPrecondition();
   }
 
-  Status metadata_result = InitializeMetadata();
+  // If the partition spans enough flash devices, keep each copy of an entry on
+  // a different one.
+  sectors_.set_copies_on_separate_devices(
+      redundancy() > 1 && partition_.device_count() >= redundancy());
+
+  Status metadata_result = InitializeMetadata(/*use_sector_summaries=*/true);
 
   if (!error_detected_) {
     initialized_ = InitializationState::kReady;
@@ -136,11 +280,13 @@ Status KeyValueStore::Init() {
   return OkStatus();
 }
 
-Status KeyValueStore::InitializeMetadata() {
+Status KeyValueStore::InitializeMetadata(bool use_sector_summaries) {
   const size_t sector_size_bytes = partition_.sector_size_bytes();
 
   sectors_.Reset();
   entry_cache_.Reset();
+  gc_destination_ = nullptr;
+  incremental_gc_sector_ = nullptr;
 
   DBG("First pass: Read all entries from all sectors");
   Address sector_address = 0;
@@ -153,6 +299,21 @@ Status KeyValueStore::InitializeMetadata() {
   for (SectorDescriptor& sector : sectors_) {
     Address entry_address = sector_address;
 
+    if (use_sector_summaries) {
+      const Status summary_status = LoadSectorSummary(sector, &entry_address);
+      if (summary_status.ok()) {
+        sector.set_writable_bytes(sector_size_bytes -
+                                  (entry_address - sector_address));
+      } else if (!summary_status.IsNotFound()) {
+        // Entries from the summary may already be in the cache, so start over
+        // and read every entry instead.
+        WRN("Sector %u summary does not match its entries; reading all entries",
+            sectors_.Index(sector));
+        error_detected_ = false;
+        return InitializeMetadata(/*use_sector_summaries=*/false);
+      }
+    }
+
     size_t sector_corrupt_bytes = 0;
 
     for (int num_entries_in_sector = 0; true; num_entries_in_sector++) {
@@ -228,7 +389,8 @@ Status KeyValueStore::InitializeMetadata() {
   // For every valid entry, for each address, count the valid bytes in that
   // sector. If the address fails to read, remove the address and mark the
   // sector as corrupt. Track which entry has the newest transaction ID for
-  // initializing last_new_sector_.
+  // initializing last_new_sector_. Keys of entries loaded from sector summaries
+  // are added to the key table here.
   for (EntryMetadata& metadata : entry_cache_) {
     if (metadata.addresses().size() < redundancy()) {
       DBG("Key 0x%08x missing copies, has %u, needs %u",
@@ -249,6 +411,16 @@ Status KeyValueStore::InitializeMetadata() {
       if (read_result.ok()) {
         sector.AddValidBytes(entry.size());
         index++;
+
+        if (entry_cache_.caches_keys() &&
+            entry_cache_.cached_key(metadata).empty()) {
+          Entry::KeyBuffer key_buffer;
+          if (const StatusWithSize key_length = entry.ReadKey(key_buffer);
+              key_length.ok()) {
+            entry_cache_.CacheKey(metadata,
+                                  Key(key_buffer.data(), key_length.size()));
+          }
+        }
       } else {
         corrupt_entries++;
         total_corrupt_bytes += sector.writable_bytes();
@@ -305,6 +477,7 @@ KeyValueStore::StorageStats KeyValueStore::GetStorageStats() const {
   stats.corrupt_sectors_recovered = internal_stats_.corrupt_sectors_recovered;
   stats.missing_redundant_entries_recovered =
       internal_stats_.missing_redundant_entries_recovered;
+  stats.entries_relocated = internal_stats_.entries_relocated;
 
   for (const SectorDescriptor& sector : sectors_) {
     stats.in_use_bytes += sector.valid_bytes();
@@ -355,6 +528,20 @@ Status KeyValueStore::LoadEntry(Address entry_address,
   Entry entry;
   PW_TRY(Entry::Read(partition_, entry_address, formats_, &entry));
 
+  // Summaries are only used by LoadSectorSummary, so skip valid ones. Batch
+  // headers determine whether the entries after them are loaded.
+  if (IsMetadata(entry)) {
+    PW_TRY(entry.VerifyChecksumInFlash());
+    MetadataHeader header;
+    PW_TRY(ReadMetadataHeader(entry, header));
+
+    *next_entry_address = entry.next_address();
+    if (header.type == MetadataType::kBatch) {
+      *next_entry_address = BatchEnd(entry, header.count);
+    }
+    return OkStatus();
+  }
+
   // Read the key from flash & validate the entry (which reads the value).
   Entry::KeyBuffer key_buffer;
   PW_TRY_ASSIGN(size_t key_length, entry.ReadKey(key_buffer));
@@ -365,8 +552,125 @@ Status KeyValueStore::LoadEntry(Address entry_address,
   // A valid entry was found, so update the next entry address before doing any
   // of the checks that happen in AddNewOrUpdateExisting.
   *next_entry_address = entry.next_address();
-  return entry_cache_.AddNewOrUpdateExisting(
-      entry.descriptor(key), entry.address(), partition_.sector_size_bytes());
+  return entry_cache_.AddNewOrUpdateExisting(entry.descriptor(key),
+                                             entry.address(),
+                                             partition_.sector_size_bytes(),
+                                             key);
+}
+
+// Returns the address to continue loading entries from after a batch header.
+// If every entry in the batch was written, that is the first entry of the
+// batch. Otherwise, writing the batch was interrupted, so the entries that were
+// written are skipped, leaving the prior values in place.
+KeyValueStore::Address KeyValueStore::BatchEnd(const Entry& batch_header,
+                                               size_t batch_entries) {
+  const SectorDescriptor& sector = sectors_.FromAddress(batch_header.address());
+  Address address = batch_header.next_address();
+  Entry entry;
+
+  for (size_t i = 0; i < batch_entries; ++i) {
+    if (!sectors_.AddressInSector(sector, address) ||
+        !Entry::Read(partition_, address, formats_, &entry).ok() ||
+        IsMetadata(entry) || !entry.VerifyChecksumInFlash().ok()) {
+      WRN("Skipping %u of %u entries from an incomplete batch in sector %u",
+          unsigned(i),
+          unsigned(batch_entries),
+          sectors_.Index(sector));
+      return address;
+    }
+    address = entry.next_address();
+  }
+
+  return batch_header.next_address();
+}
+
+// Loads the entries covered by the last summary in a sector, reading only their
+// headers. Returns NOT_FOUND if the sector has no summary, or another error if
+// the summary does not match the entries; some entries may have been added to
+// the cache in that case. On success, *next_entry_address is set to the address
+// after the summary.
+Status KeyValueStore::LoadSectorSummary(const SectorDescriptor& sector,
+                                        Address* next_entry_address) {
+  const Address sector_address = sectors_.BaseAddress(sector);
+  Entry entry;
+  Entry summary;
+  bool summary_found = false;
+
+  // Summaries are appended after the entries they cover, so walk the headers
+  // to find the last one.
+  for (Address address = sector_address;
+       sectors_.AddressInSector(sector, address) &&
+       Entry::Read(partition_, address, formats_, &entry).ok();
+       address = entry.next_address()) {
+    MetadataHeader header;
+    if (IsMetadata(entry) && ReadMetadataHeader(entry, header).ok() &&
+        header.type == MetadataType::kSectorSummary) {
+      summary = entry;
+      summary_found = true;
+    }
+  }
+
+  if (!summary_found) {
+    return Status::NotFound();
+  }
+
+  SectorSummary contents;
+  const size_t summary_size_bytes = summary.value_size();
+  if (summary_size_bytes > sizeof(contents) ||
+      summary_size_bytes < sizeof(contents.header)) {
+    return Status::DataLoss();
+  }
+  PW_TRY(summary.VerifyChecksumInFlash());
+  PW_TRY(summary
+             .ReadValue(std::as_writable_bytes(std::span(&contents, 1))
+                            .first(summary_size_bytes))
+             .status());
+
+  const size_t record_count = contents.header.count;
+  if (summary_size_bytes !=
+      sizeof(contents.header) + record_count * sizeof(SectorSummaryRecord)) {
+    return Status::DataLoss();
+  }
+
+  const SectorSummaryRecords& records = contents.records;
+  size_t index = 0;
+  Address address = sector_address;
+
+  while (address < summary.address()) {
+    if (!Entry::Read(partition_, address, formats_, &entry).ok()) {
+      return Status::DataLoss();
+    }
+    address = entry.next_address();
+
+    // Sectors with batches are not summarized, so only skip summaries.
+    if (IsMetadata(entry)) {
+      MetadataHeader header;
+      if (!ReadMetadataHeader(entry, header).ok() ||
+          header.type != MetadataType::kSectorSummary) {
+        return Status::DataLoss();
+      }
+      continue;
+    }
+    if (index == record_count ||
+        records[index].transaction_id != entry.transaction_id()) {
+      return Status::DataLoss();
+    }
+    PW_TRY(entry_cache_.AddNewOrUpdateExisting(
+        entry.descriptor(records[index].key_hash),
+        entry.address(),
+        partition_.sector_size_bytes()));
+    index += 1;
+  }
+
+  if (address != summary.address() || index != record_count) {
+    return Status::DataLoss();
+  }
+
+  DBG("Loaded %u entries from the summary of sector %u",
+      unsigned(record_count),
+      sectors_.Index(sector));
+  *next_entry_address = summary.next_address();
+  return OkStatus();
 }
 
 // Scans flash memory within a sector to find a KVS entry magic.
@@ -411,8 +715,25 @@ StatusWithSize KeyValueStore::Get(Key key,
   return Get(key, metadata, value_buffer, offset_bytes);
 }
 
+StatusWithSize KeyValueStore::Get(Key key,
+                                  stream::Writer& value,
+                                  size_t offset_bytes) const {
+  PW_TRY_WITH_SIZE(CheckReadOperation(key));
+
+  EntryMetadata metadata;
+  PW_TRY_WITH_SIZE(FindExisting(key, &metadata));
+
+  return Get(metadata, value, offset_bytes);
+}
+
 Status KeyValueStore::PutBytes(Key key, std::span<const byte> value) {
   PW_TRY(CheckWriteOperation(key));
+
+  if (formats_.primary().compression != ValueCompression::kNone) {
+    stream::MemoryReader reader(value);
+    return Put(key, reader, value.size());
+  }
+
   DBG("Writing key/value; key length=%u, value length=%u",
       unsigned(key.size()),
       unsigned(value.size()));
@@ -443,6 +764,184 @@ Status KeyValueStore::PutBytes(Key key, std::span<const byte> value) {
   return status;
 }
 
+Status KeyValueStore::Put(const Key& key,
+                          stream::SeekableReader& value,
+                          size_t size_bytes) {
+  PW_TRY(CheckWriteOperation(key));
+
+  if (formats_.primary().compression == ValueCompression::kNone) {
+    return PutStoredValue(key, value, size_bytes);
+  }
+
+  if (size_bytes > internal::kLzMaxValueBytes) {
+    return Status::InvalidArgument();
+  }
+  internal::LzCompressor compressed_value(value, size_bytes);
+  PW_TRY_ASSIGN(const size_t compressed_size,
+                compressed_value.CompressedSize());
+  DBG("Compressed %u B value to %u B",
+      unsigned(size_bytes),
+      unsigned(compressed_size));
+  return PutStoredValue(key, compressed_value, compressed_size);
+}
+
+// Writes a value from a stream as it is stored in flash, which may be
+// compressed.
+Status KeyValueStore::PutStoredValue(const Key& key,
+                                     stream::SeekableReader& value,
+                                     size_t size_bytes) {
+  DBG("Writing key/value from stream; key length=%u, value length=%u",
+      unsigned(key.size()),
+      unsigned(size_bytes));
+
+  if (Entry::size(partition_, key, size_bytes) >
+      partition_.sector_size_bytes()) {
+    DBG("%u B value with %u B key cannot fit in one sector",
+        unsigned(size_bytes),
+        unsigned(key.size()));
+    return Status::InvalidArgument();
+  }
+
+  EntryMetadata metadata;
+  Status status = FindEntry(key, &metadata);
+
+  if (status.ok()) {
+    // Read the original entry to get the size for sector accounting purposes.
+    Entry prior_entry;
+    PW_TRY(ReadEntry(metadata, prior_entry));
+    return WriteEntry(key, value, size_bytes, &metadata, &prior_entry);
+  }
+
+  if (status.IsNotFound()) {
+    if (entry_cache_.full()) {
+      WRN("KVS full: trying to store a new entry, but can't. Have %u entries",
+          unsigned(entry_cache_.total_entries()));
+      return Status::ResourceExhausted();
+    }
+    return WriteEntry(key, value, size_bytes);
+  }
+
+  return status;
+}
+
+Status KeyValueStore::PutBatch(std::span<const BatchEntry> entries) {
+  if (!initialized()) {
+    return Status::FailedPrecondition();
+  }
+  if (entries.empty()) {
+    return OkStatus();
+  }
+
+  // Batch entries are written from their values as they are, so they cannot
+  // be compressed.
+  if (formats_.primary().compression != ValueCompression::kNone) {
+    return Status::Unimplemented();
+  }
+
+  size_t batch_size;
+  PW_TRY(CheckBatch(entries, &batch_size));
+  DBG("Writing batch of %u entries; %u B",
+      unsigned(entries.size()),
+      unsigned(batch_size));
+
+  // Find space for the whole batch once. This may involve garbage collecting
+  // one or more sectors, so it must happen before reading any prior entries.
+  Address* reserved_addresses = entry_cache_.TempReservedAddressesForWrite();
+  PW_TRY(GetAddressesForWrite(reserved_addresses, batch_size));
+
+  // Burn a transaction ID for the header and each entry, as CreateEntry does.
+  const uint32_t header_transaction_id = last_transaction_id_ + 1;
+  last_transaction_id_ += 1 + entries.size();
+
+  PW_TRY(WriteBatch(
+      reserved_addresses[0], entries, header_transaction_id, batch_size));
+
+  // After writing the first copy of the batch successfully, update the key
+  // descriptors, which invalidates the old entries.
+  Address address = reserved_addresses[0] + BatchHeaderSize(partition_);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const Entry entry = Entry::Valid(partition_,
+                                     address,
+                                     formats_.primary(),
+                                     entries[i].key,
+                                     entries[i].value,
+                                     header_transaction_id + 1 + i);
+    EntryMetadata metadata;
+    if (FindEntry(entries[i].key, &metadata).ok()) {
+      // If the prior entry cannot be read, its sector is marked corrupt, so
+      // its bytes are reclaimed when the sector is repaired.
+      Entry prior_entry;
+      const size_t prior_size =
+          ReadEntry(metadata, prior_entry).ok() ? prior_entry.size() : 0;
+      UpdateKeyDescriptor(entry, address, &metadata, prior_size);
+    } else {
+      entry_cache_.AddNew(
+          entry.descriptor(entries[i].key), address, entries[i].key);
+    }
+    address = entry.next_address();
+  }
+
+  // Write the additional copies of the batch, if redundancy is greater than 1.
+  for (size_t i = 1; i < redundancy(); ++i) {
+    PW_TRY(WriteBatch(
+        reserved_addresses[i], entries, header_transaction_id, batch_size));
+
+    address = reserved_addresses[i] + BatchHeaderSize(partition_);
+    for (const BatchEntry& batch_entry : entries) {
+      EntryMetadata metadata;
+      PW_TRY(FindEntry(batch_entry.key, &metadata));
+      metadata.AddNewAddress(address);
+      address += Entry::size(partition_, batch_entry.key, batch_entry.value);
+    }
+  }
+  return OkStatus();
+}
+
+// Checks that every entry in a batch can be written and calculates the size of
+// the batch, including its header.
+Status KeyValueStore::CheckBatch(std::span<const BatchEntry> entries,
+                                 size_t* batch_size) const {
+  *batch_size = BatchHeaderSize(partition_);
+  size_t new_keys = 0;
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const Key key = entries[i].key;
+    PW_TRY(CheckWriteOperation(key));
+
+    // Each entry must have its own descriptor, so keys may not share hashes.
+    const uint32_t hash = internal::Hash(key);
+    for (size_t j = 0; j < i; ++j) {
+      if (internal::Hash(entries[j].key) == hash) {
+        DBG("Key 0x%08x is in the batch more than once", unsigned(hash));
+        return Status::InvalidArgument();
+      }
+    }
+
+    EntryMetadata metadata;
+    const Status status = FindEntry(key, &metadata);
+    if (status.IsNotFound()) {
+      new_keys += 1;
+    } else if (!status.ok()) {
+      return status;
+    }
+
+    *batch_size += Entry::size(partition_, key, entries[i].value);
+  }
+
+  if (*batch_size > partition_.sector_size_bytes()) {
+    DBG("%u B batch cannot fit in one sector", unsigned(*batch_size));
+    return Status::InvalidArgument();
+  }
+
+  if (entry_cache_.total_entries() + new_keys > entry_cache_.max_entries()) {
+    WRN("KVS full: trying to store %u new entries, but can't. Have %u entries",
+        unsigned(new_keys),
+        unsigned(entry_cache_.total_entries()));
+    return Status::ResourceExhausted();
+  }
+  return OkStatus();
+}
+
 Status KeyValueStore::Delete(Key key) {
   PW_TRY(CheckWriteOperation(key));
 
@@ -460,9 +959,18 @@ Status KeyValueStore::Delete(Key key) {
 void KeyValueStore::Item::ReadKey() {
   key_buffer_.fill('\0');
 
+  if (const Key key = kvs_.entry_cache_.cached_key(*iterator_); !key.empty()) {
+    std::copy(key.begin(), key.end(), key_buffer_.begin());
+    return;
+  }
+
   Entry entry;
   if (kvs_.ReadEntry(*iterator_, entry).ok()) {
-    entry.ReadKey(key_buffer_);
+    const StatusWithSize key_length = entry.ReadKey(key_buffer_);
+    if (key_length.ok()) {
+      kvs_.entry_cache_.CacheKey(*iterator_,
+                                 Key(key_buffer_.data(), key_length.size()));
+    }
   }
 }
 
@@ -490,6 +998,14 @@ StatusWithSize KeyValueStore::ValueSize(Key key) const {
   EntryMetadata metadata;
   PW_TRY_WITH_SIZE(FindExisting(key, &metadata));
 
+  if (value_cache_ != nullptr) {
+    const ValueCache::Slot* cached =
+        value_cache_->Find(metadata.hash(), metadata.transaction_id());
+    if (cached != nullptr) {
+      return StatusWithSize(cached->size_bytes);
+    }
+  }
+
   return ValueSize(metadata);
 }
 
@@ -512,6 +1028,24 @@ Status KeyValueStore::ReadEntry(const EntryMetadata& metadata,
   return read_result;
 }
 
+StatusWithSize KeyValueStore::ReadEntry(const EntryMetadata& metadata,
+                                        Entry& entry,
+                                        std::span<byte> buffer) const {
+  StatusWithSize read_result = StatusWithSize::DataLoss();
+  for (Address address : metadata.addresses()) {
+    read_result = Entry::Read(partition_, address, formats_, &entry, buffer);
+    if (read_result.ok()) {
+      return read_result;
+    }
+
+    error_detected_ = true;
+    sectors_.FromAddress(address).mark_corrupt();
+  }
+
+  ERR("No valid entries for key. Data has been lost!");
+  return read_result;
+}
+
 Status KeyValueStore::FindEntry(Key key, EntryMetadata* found_entry) const {
   StatusWithSize find_result =
       entry_cache_.Find(partition_, sectors_, formats_, key, found_entry);
@@ -538,24 +1072,182 @@ StatusWithSize KeyValueStore::Get(Key key,
                                   const EntryMetadata& metadata,
                                   std::span<std::byte> value_buffer,
                                   size_t offset_bytes) const {
-  Entry entry;
+  if (value_cache_ != nullptr) {
+    const ValueCache::Slot* cached =
+        value_cache_->Find(metadata.hash(), metadata.transaction_id());
+    if (cached != nullptr) {
+      return value_cache_->Read(*cached, value_buffer, offset_bytes);
+    }
+  }
+
+  return GetFromFlash(key, metadata, value_buffer, offset_bytes);
+}
 
+StatusWithSize KeyValueStore::Get(const EntryMetadata& metadata,
+                                  stream::Writer& value,
+                                  size_t offset_bytes) const {
+  if (value_cache_ != nullptr) {
+    const ValueCache::Slot* cached =
+        value_cache_->Find(metadata.hash(), metadata.transaction_id());
+    if (cached != nullptr) {
+      const std::span<const byte> cached_value = value_cache_->value(*cached);
+      if (offset_bytes > cached_value.size()) {
+        return StatusWithSize::OutOfRange();
+      }
+      const std::span<const byte> remaining =
+          cached_value.subspan(offset_bytes);
+      PW_TRY_WITH_SIZE(value.Write(remaining));
+      return StatusWithSize(remaining.size());
+    }
+  }
+
+  Entry entry;
   PW_TRY_WITH_SIZE(ReadEntry(metadata, entry));
 
-  StatusWithSize result = entry.ReadValue(value_buffer, offset_bytes);
-  if (result.ok() && options_.verify_on_read && offset_bytes == 0u) {
+  // The value is written to the stream as it is read, so it cannot be checked
+  // afterwards. Verify the entry in flash first instead.
+  if (options_.verify_on_read) {
+    PW_TRY_WITH_SIZE(entry.VerifyChecksumInFlash());
+  }
+
+  if (!entry.compressed()) {
+    return entry.ReadValue(value, offset_bytes);
+  }
+
+  FlashPartition::Reader reader(partition_);
+  PW_TRY_WITH_SIZE(reader.Seek(entry.value_address()));
+  internal::LzDecompressor decompressor(reader, entry.value_size());
+  const StatusWithSize size_result = decompressor.DecompressedSize();
+  PW_TRY_WITH_SIZE(size_result);
+  const size_t size = size_result.size();
+  if (offset_bytes > size) {
+    return StatusWithSize::OutOfRange();
+  }
+  PW_TRY_WITH_SIZE(decompressor.Seek(offset_bytes));
+
+  std::array<byte, kValueStreamBufferSize> buffer;
+  size_t bytes_written = 0;
+  while (offset_bytes + bytes_written < size) {
+    const Result<ByteSpan> chunk = decompressor.Read(buffer);
+    Status status = chunk.status();
+    if (status.ok()) {
+      status = value.Write(chunk.value());
+    }
+    if (!status.ok()) {
+      return StatusWithSize(status, bytes_written);
+    }
+    bytes_written += chunk.value().size();
+  }
+  return StatusWithSize(bytes_written);
+}
+
+StatusWithSize KeyValueStore::GetFromFlash(Key key,
+                                           const EntryMetadata& metadata,
+                                           std::span<std::byte> value_buffer,
+                                           size_t offset_bytes,
+                                           bool exact_size) const {
+  Entry entry;
+
+  // Read the start of the value along with the header, so that small values
+  // take one flash read. The value is then checksummed in the caller's buffer.
+  std::array<byte, kValueStreamBufferSize> read_ahead;
+  const StatusWithSize entry_read = ReadEntry(metadata, entry, read_ahead);
+  PW_TRY_WITH_SIZE(entry_read);
+
+  if (exact_size) {
+    const StatusWithSize actual_size = ValueSize(entry);
+    PW_TRY_WITH_SIZE(actual_size);
+    if (actual_size.size() != value_buffer.size()) {
+      DBG("Requested %u B read, but value is %u B",
+          unsigned(value_buffer.size()),
+          unsigned(actual_size.size()));
+      return StatusWithSize::InvalidArgument();
+    }
+  }
+
+  StatusWithSize result =
+      entry.compressed()
+          ? ReadCompressedValue(entry, value_buffer, offset_bytes)
+          : entry.ReadValue(value_buffer,
+                            offset_bytes,
+                            std::span(read_ahead).first(entry_read.size()));
+  if (result.ok() && options_.verify_on_read && offset_bytes == 0u &&
+      !entry.compressed()) {
     Status verify_result =
         entry.VerifyChecksum(key, value_buffer.first(result.size()));
     if (!verify_result.ok()) {
       std::memset(value_buffer.data(), 0, result.size());
       return StatusWithSize(verify_result, 0);
     }
+  }
 
-    return StatusWithSize(verify_result, result.size());
+  // Only cache complete values.
+  if (value_cache_ != nullptr && result.ok() && offset_bytes == 0u) {
+    value_cache_->Store(metadata.hash(),
+                        metadata.transaction_id(),
+                        value_buffer.first(result.size()));
   }
   return result;
 }
 
+// Decompresses part of a value into a buffer. The checksum is of the compressed
+// value, so it is verified in flash rather than in the buffer.
+StatusWithSize KeyValueStore::ReadCompressedValue(
+    const Entry& entry,
+    std::span<byte> value_buffer,
+    size_t offset_bytes) const {
+  if (options_.verify_on_read) {
+    PW_TRY_WITH_SIZE(entry.VerifyChecksumInFlash());
+  }
+
+  FlashPartition::Reader reader(partition_);
+  PW_TRY_WITH_SIZE(reader.Seek(entry.value_address()));
+  internal::LzDecompressor decompressor(reader, entry.value_size());
+  const StatusWithSize size_result = decompressor.DecompressedSize();
+  PW_TRY_WITH_SIZE(size_result);
+  const size_t size = size_result.size();
+  if (offset_bytes > size) {
+    return StatusWithSize::OutOfRange();
+  }
+  PW_TRY_WITH_SIZE(decompressor.Seek(offset_bytes));
+
+  const size_t read_size = std::min(value_buffer.size(), size - offset_bytes);
+  size_t bytes_read = 0;
+  while (bytes_read < read_size) {
+    const Result<ByteSpan> chunk = decompressor.Read(
+        value_buffer.subspan(bytes_read, read_size - bytes_read));
+    if (!chunk.ok()) {
+      return StatusWithSize(chunk.status(), bytes_read);
+    }
+    bytes_read += chunk.value().size();
+  }
+
+  if (read_size != size - offset_bytes) {
+    return StatusWithSize::ResourceExhausted(read_size);
+  }
+  return StatusWithSize(read_size);
+}
+
+Result<ConstByteSpan> KeyValueStore::GetMapped(Key key) const {
+  PW_TRY(CheckReadOperation(key));
+
+  EntryMetadata metadata;
+  PW_TRY(FindExisting(key, &metadata));
+
+  Entry entry;
+  PW_TRY(ReadEntry(metadata, entry));
+
+  const byte* value =
+      partition_.PartitionAddressToMcuAddress(entry.value_address());
+  if (value == nullptr || entry.compressed()) {
+    return Status::Unimplemented();
+  }
+
+  // The caller reads the value directly, so always verify it first.
+  PW_TRY(entry.VerifyChecksumInFlash());
+  return ConstByteSpan(value, entry.value_size());
+}
+
 Status KeyValueStore::FixedSizeGet(Key key,
                                    void* value,
                                    size_t size_bytes) const {
@@ -571,27 +1263,43 @@ Status KeyValueStore::FixedSizeGet(Key key,
                                    const EntryMetadata& metadata,
                                    void* value,
                                    size_t size_bytes) const {
-  // Ensure that the size of the stored value matches the size of the type.
-  // Otherwise, report error. This check avoids potential memory corruption.
-  PW_TRY_ASSIGN(const size_t actual_size, ValueSize(metadata));
-
-  if (actual_size != size_bytes) {
-    DBG("Requested %u B read, but value is %u B",
-        unsigned(size_bytes),
-        unsigned(actual_size));
-    return Status::InvalidArgument();
+  if (value_cache_ != nullptr) {
+    const ValueCache::Slot* cached =
+        value_cache_->Find(metadata.hash(), metadata.transaction_id());
+    if (cached != nullptr) {
+      if (cached->size_bytes != size_bytes) {
+        return Status::InvalidArgument();
+      }
+      return value_cache_
+          ->Read(*cached, std::span(static_cast<byte*>(value), size_bytes), 0)
+          .status();
+    }
   }
 
-  StatusWithSize result =
-      Get(key, metadata, std::span(static_cast<byte*>(value), size_bytes), 0);
-
-  return result.status();
+  // Ensure that the size of the stored value matches the size of the type.
+  // Otherwise, report error. This check avoids potential memory corruption.
+  // The size is checked once the entry is read, so it is only read once.
+  return GetFromFlash(key,
+                      metadata,
+                      std::span(static_cast<byte*>(value), size_bytes),
+                      0,
+                      /*exact_size=*/true)
+      .status();
 }
 
 StatusWithSize KeyValueStore::ValueSize(const EntryMetadata& metadata) const {
   Entry entry;
   PW_TRY_WITH_SIZE(ReadEntry(metadata, entry));
+  return ValueSize(entry);
+}
 
+StatusWithSize KeyValueStore::ValueSize(const Entry& entry) const {
+  if (entry.compressed()) {
+    FlashPartition::Reader reader(partition_);
+    PW_TRY_WITH_SIZE(reader.Seek(entry.value_address()));
+    return internal::LzDecompressor(reader, entry.value_size())
+        .DecompressedSize();
+  }
   return StatusWithSize(entry.value_size());
 }
 
@@ -651,7 +1359,8 @@ Status KeyValueStore::WriteEntry(Key key,
   // check if the values match. Directly compare the prior and new values
   // because the checksum can not be depended on to establish equality, it can
   // only be depended on to establish inequality.
-  if (prior_entry != nullptr && prior_entry->value_size() == value.size() &&
+  if (prior_entry != nullptr && !prior_entry->compressed() &&
+      prior_entry->value_size() == value.size() &&
       prior_metadata->state() == new_state &&
       prior_entry->ValueMatches(value).ok()) {
     // The new value matches the prior value, don't need to write anything. Just
@@ -669,20 +1378,106 @@ Status KeyValueStore::WriteEntry(Key key,
   const size_t entry_size = Entry::size(partition_, key, value);
   PW_TRY(GetAddressesForWrite(reserved_addresses, entry_size));
 
-  // Write the entry at the first address that was found.
+  // Write every copy from RAM before verifying any of them. Flash made of
+  // several devices, such as ParallelFlashMemory, then writes copies on
+  // different devices at the same time.
   Entry entry = CreateEntry(reserved_addresses[0], key, value, new_state);
+  partition_.StartParallelWrites();
+  size_t copies_written = 0;
+  Status write_status;
+  while (copies_written < redundancy()) {
+    entry.set_address(reserved_addresses[copies_written]);
+    write_status =
+        FinishAppendEntry(entry, entry.Write(key, value), /*verify=*/false);
+    if (!write_status.ok()) {
+      break;
+    }
+    copies_written += 1;
+  }
+
+  // An error from a write that finished in the background is not tied to a
+  // copy, so verify all of them to find the bad ones.
+  const bool verify =
+      !partition_.FinishParallelWrites().ok() || options_.verify_on_write;
+
+  size_t prior_size = prior_entry != nullptr ? prior_entry->size() : 0;
+  EntryMetadata new_metadata;
+  for (size_t i = 0; i < copies_written; ++i) {
+    entry.set_address(reserved_addresses[i]);
+    if (verify) {
+      PW_TRY(MarkSectorCorruptIfNotOk(
+          entry.VerifyChecksumInFlash(),
+          &sectors_.FromAddress(reserved_addresses[i])));
+    }
+
+    // After the first entry is written successfully, update the key
+    // descriptors. Once a single new entry is written, the old entries are
+    // invalidated.
+    if (i == 0) {
+      new_metadata =
+          CreateOrUpdateKeyDescriptor(entry, key, prior_metadata, prior_size);
+    } else {
+      new_metadata.AddNewAddress(reserved_addresses[i]);
+    }
+  }
+  return write_status;
+}
+
+Status KeyValueStore::WriteEntry(Key key,
+                                 stream::SeekableReader& value,
+                                 size_t value_size_bytes,
+                                 EntryMetadata* prior_metadata,
+                                 const Entry* prior_entry) {
+  // List of addresses for sectors with space for this entry.
+  Address* reserved_addresses = entry_cache_.TempReservedAddressesForWrite();
+
+  // Find addresses to write the entry to. This may involve garbage collecting
+  // one or more sectors.
+  const size_t entry_size = Entry::size(partition_, key, value_size_bytes);
+  PW_TRY(GetAddressesForWrite(reserved_addresses, entry_size));
+
+  return WriteReservedEntry(key,
+                            value,
+                            value_size_bytes,
+                            prior_metadata,
+                            prior_entry != nullptr ? prior_entry->size() : 0);
+}
+
+Status KeyValueStore::WriteReservedEntry(Key key,
+                                         stream::SeekableReader& value,
+                                         size_t value_size_bytes,
+                                         EntryMetadata* prior_metadata,
+                                         size_t prior_size) {
+  Address* reserved_addresses = entry_cache_.TempReservedAddressesForWrite();
+
+  // Always bump the transaction ID when creating a new entry, as CreateEntry()
+  // does. The value is read once here to calculate the entry's checksum.
+  last_transaction_id_ += 1;
+  PW_TRY_ASSIGN(Entry entry,
+                Entry::Valid(partition_,
+                             reserved_addresses[0],
+                             formats_.primary(),
+                             key,
+                             value,
+                             value_size_bytes,
+                             last_transaction_id_));
+
+  // Write the entry at the first address that was found, reading the value
+  // again from the stream.
   PW_TRY(AppendEntry(entry, key, value));
 
   // After writing the first entry successfully, update the key descriptors.
   // Once a single new the entry is written, the old entries are invalidated.
-  size_t prior_size = prior_entry != nullptr ? prior_entry->size() : 0;
   EntryMetadata new_metadata =
       CreateOrUpdateKeyDescriptor(entry, key, prior_metadata, prior_size);
 
-  // Write the additional copies of the entry, if redundancy is greater than 1.
+  // The stream may not be read a third time, so copy the first entry from
+  // flash if redundancy is greater than 1.
   for (size_t i = 1; i < redundancy(); ++i) {
-    entry.set_address(reserved_addresses[i]);
-    PW_TRY(AppendEntry(entry, key, value));
+    PW_TRY(CopyEntryToSector(entry,
+                             &sectors_.FromAddress(reserved_addresses[i]),
+                             reserved_addresses[i])
+               .status());
     new_metadata.AddNewAddress(reserved_addresses[i]);
   }
   return OkStatus();
@@ -695,7 +1490,7 @@ KeyValueStore::EntryMetadata KeyValueStore::CreateOrUpdateKeyDescriptor(
     size_t prior_size) {
   // If there is no prior descriptor, create a new one.
   if (prior_metadata == nullptr) {
-    return entry_cache_.AddNew(entry.descriptor(key), entry.address());
+    return entry_cache_.AddNew(entry.descriptor(key), entry.address(), key);
   }
 
   return UpdateKeyDescriptor(
@@ -794,8 +1589,20 @@ Status KeyValueStore::MarkSectorCorruptIfNotOk(Status status,
 Status KeyValueStore::AppendEntry(const Entry& entry,
                                   Key key,
                                   std::span<const byte> value) {
-  const StatusWithSize result = entry.Write(key, value);
+  return FinishAppendEntry(
+      entry, entry.Write(key, value), options_.verify_on_write);
+}
+
+Status KeyValueStore::AppendEntry(const Entry& entry,
+                                  Key key,
+                                  stream::Reader& value) {
+  return FinishAppendEntry(
+      entry, entry.Write(key, value), options_.verify_on_write);
+}
 
+Status KeyValueStore::FinishAppendEntry(const Entry& entry,
+                                        const StatusWithSize result,
+                                        bool verify) {
   SectorDescriptor& sector = sectors_.FromAddress(entry.address());
 
   if (!result.ok()) {
@@ -806,7 +1613,7 @@ Status KeyValueStore::AppendEntry(const Entry& entry,
     PW_TRY(MarkSectorCorruptIfNotOk(result.status(), &sector));
   }
 
-  if (options_.verify_on_write) {
+  if (verify) {
     PW_TRY(MarkSectorCorruptIfNotOk(entry.VerifyChecksumInFlash(), &sector));
   }
 
@@ -815,6 +1622,76 @@ Status KeyValueStore::AppendEntry(const Entry& entry,
   return OkStatus();
 }
 
+// Writes one copy of a batch at the address: the batch header, followed by each
+// entry. The entries are written with one AlignedWriter, which combines them
+// into as few flash writes as possible.
+Status KeyValueStore::WriteBatch(Address address,
+                                 std::span<const BatchEntry> entries,
+                                 uint32_t header_transaction_id,
+                                 size_t batch_size) {
+  SectorDescriptor& sector = sectors_.FromAddress(address);
+
+  const MetadataHeader batch_header = {
+      .type = MetadataType::kBatch,
+      .count = static_cast<uint32_t>(entries.size()),
+  };
+  const std::span<const byte> header_value =
+      std::as_bytes(std::span(&batch_header, 1));
+
+  FlashPartition::Output output(partition_, address);
+  AlignedWriterBuffer<kBatchWriteBufferSize> writer(
+      partition_.alignment_bytes(),
+      output,
+      kAlignedWritePassThrough ? AlignedWriter::Mode::kPassThrough
+                               : AlignedWriter::Mode::kBuffered);
+
+  Entry entry = Entry::Valid(partition_,
+                             address,
+                             formats_.primary(),
+                             Key(),
+                             header_value,
+                             header_transaction_id);
+  Status status = entry.Write(writer, Key(), header_value);
+
+  for (size_t i = 0; status.ok() && i < entries.size(); ++i) {
+    entry = Entry::Valid(partition_,
+                         entry.next_address(),
+                         formats_.primary(),
+                         entries[i].key,
+                         entries[i].value,
+                         header_transaction_id + 1 + i);
+    status = entry.Write(writer, entries[i].key, entries[i].value);
+  }
+
+  if (status.ok()) {
+    status = writer.Flush().status();
+  }
+
+  if (!status.ok()) {
+    ERR("Failed to write %u B batch at %#x",
+        unsigned(batch_size),
+        unsigned(address));
+    return MarkSectorCorruptIfNotOk(status, &sector);
+  }
+
+  if (options_.verify_on_write) {
+    Address entry_address = address;
+    for (size_t i = 0; i <= entries.size(); ++i) {
+      Entry written;
+      PW_TRY(MarkSectorCorruptIfNotOk(
+          Entry::Read(partition_, entry_address, formats_, &written), &sector));
+      PW_TRY(
+          MarkSectorCorruptIfNotOk(written.VerifyChecksumInFlash(), &sector));
+      entry_address = written.next_address();
+    }
+  }
+
+  // The batch header is not a key-value entry, so its bytes are reclaimable.
+  sector.RemoveWritableBytes(batch_size);
+  sector.AddValidBytes(batch_size - BatchHeaderSize(partition_));
+  return OkStatus();
+}
+
 StatusWithSize KeyValueStore::CopyEntryToSector(Entry& entry,
                                                 SectorDescriptor* new_sector,
                                                 Address new_address) {
@@ -854,15 +1731,102 @@ Status KeyValueStore::RelocateEntry(
   // an immediate extra relocation).
   SectorDescriptor* new_sector;
 
-  PW_TRY(sectors_.FindSpaceDuringGarbageCollection(
-      &new_sector, entry.size(), metadata.addresses(), reserved_addresses));
-
+  PW_TRY(sectors_.FindSpaceDuringGarbageCollection(&new_sector,
+                                                   entry.size(),
+                                                   address,
+                                                   metadata.addresses(),
+                                                   reserved_addresses));
+
+  // Keep room to summarize the sector that garbage collection is filling. If
+  // this entry would take that room, write the summary first.
+  if (new_sector == gc_destination_ &&
+      !new_sector->HasSpace(entry.size() +
+                            SectorSummarySize(partition_,
+                                              gc_destination_entries_ + 1))) {
+    PW_TRY(FinishGarbageCollectionDestination());
+    PW_TRY(sectors_.FindSpaceDuringGarbageCollection(&new_sector,
+                                                     entry.size(),
+                                                     address,
+                                                     metadata.addresses(),
+                                                     reserved_addresses));
+  }
+
+  const bool new_sector_was_empty =
+      new_sector->Empty(partition_.sector_size_bytes());
   Address new_address = sectors_.NextWritableAddress(*new_sector);
   PW_TRY_ASSIGN(const size_t result_size,
                 CopyEntryToSector(entry, new_sector, new_address));
   sectors_.FromAddress(address).RemoveValidBytes(result_size);
   address = new_address;
+  internal_stats_.entries_relocated += 1;
+
+  if (options_.sector_summaries) {
+    if (new_sector == gc_destination_) {
+      gc_destination_entries_ += 1;
+    } else {
+      // Summarize the previous destination once garbage collection moves on
+      // from it.
+      PW_TRY(FinishGarbageCollectionDestination());
+      gc_destination_ = new_sector;
+
+      SectorSummaryRecords records;
+      gc_destination_entries_ =
+          new_sector_was_empty
+              ? 1
+              : ReadSectorEntries(
+                    partition_, sectors_, formats_, *new_sector, records);
+    }
+  }
+
+  return OkStatus();
+}
+
+Status KeyValueStore::FinishGarbageCollectionDestination() {
+  if (gc_destination_ == nullptr) {
+    return OkStatus();
+  }
+  return WriteSectorSummary(*std::exchange(gc_destination_, nullptr));
+}
+
+Status KeyValueStore::WriteSectorSummary(SectorDescriptor& sector) {
+  SectorSummary contents;
+  const size_t record_count = ReadSectorEntries(
+      partition_, sectors_, formats_, sector, contents.records);
+  if (record_count == 0u || record_count > contents.records.size()) {
+    return OkStatus();
+  }
+
+  contents.header = {
+      .type = MetadataType::kSectorSummary,
+      .count = static_cast<uint32_t>(record_count),
+  };
+  const std::span<const byte> value =
+      std::as_bytes(std::span(&contents, 1))
+          .first(sizeof(contents.header) +
+                 record_count * sizeof(SectorSummaryRecord));
+  const Entry summary = Entry::Valid(partition_,
+                                     sectors_.NextWritableAddress(sector),
+                                     formats_.primary(),
+                                     Key(),
+                                     value,
+                                     last_transaction_id_);
+  if (!sector.HasSpace(summary.size())) {
+    DBG("No room to summarize sector %u", sectors_.Index(sector));
+    return OkStatus();
+  }
+
+  DBG("Writing summary of %u entries to sector %u",
+      unsigned(record_count),
+      sectors_.Index(sector));
+  const StatusWithSize result = summary.Write(Key(), value);
+  PW_TRY(MarkSectorCorruptIfNotOk(result.status(), &sector));
+
+  if (options_.verify_on_write) {
+    PW_TRY(MarkSectorCorruptIfNotOk(summary.VerifyChecksumInFlash(), &sector));
+  }
 
+  // The summary is not a key-value entry, so its bytes are reclaimable.
+  sector.RemoveWritableBytes(result.size());
   return OkStatus();
 }
 
@@ -942,6 +1906,52 @@ Status KeyValueStore::PartialMaintenance() {
   return GarbageCollect(std::span<const Address>());
 }
 
+Status KeyValueStore::IncrementalGarbageCollect(size_t max_relocations) {
+  if (initialized_ == InitializationState::kNotInitialized) {
+    return Status::FailedPrecondition();
+  }
+  if (max_relocations == 0u) {
+    return Status::InvalidArgument();
+  }
+
+  if (incremental_gc_sector_ == nullptr) {
+    // Unlike GarbageCollect, only collect sectors with space to reclaim.
+    SectorDescriptor* sector = sectors_.FindSectorToGarbageCollect({});
+    if (sector == nullptr ||
+        sector->RecoverableBytes(partition_.sector_size_bytes()) == 0u) {
+      return Status::NotFound();
+    }
+    incremental_gc_sector_ = sector;
+
+    // Keep new entries out of the sector while it is collected over several
+    // steps. Its unwritten space is reclaimed when it is erased.
+    DBG("Incrementally garbage collecting sector %u",
+        sectors_.Index(incremental_gc_sector_));
+    incremental_gc_sector_->set_writable_bytes(0);
+  }
+
+  SectorDescriptor& sector = *incremental_gc_sector_;
+
+  // Erasing is a step of its own, since it may take as long as relocating.
+  if (sector.valid_bytes() == 0u) {
+    return GarbageCollectSector(sector, {});
+  }
+
+  size_t relocated = 0;
+  for (EntryMetadata& metadata : entry_cache_) {
+    for (Address& address : metadata.addresses()) {
+      if (relocated == max_relocations) {
+        return OkStatus();
+      }
+      if (sectors_.AddressInSector(sector, address)) {
+        PW_TRY(RelocateEntry(metadata, address, {}));
+        relocated += 1;
+      }
+    }
+  }
+  return OkStatus();
+}
+
 Status KeyValueStore::GarbageCollect(
     std::span<const Address> reserved_addresses) {
   DBG("Garbage Collect a single sector");
@@ -949,9 +1959,19 @@ Status KeyValueStore::GarbageCollect(
     DBG("   Avoid address %u", unsigned(address));
   }
 
-  // Step 1: Find the sector to garbage collect
-  SectorDescriptor* sector_to_gc =
-      sectors_.FindSectorToGarbageCollect(reserved_addresses);
+  // Step 1: Find the sector to garbage collect. Prefer a sector that is partly
+  // collected by IncrementalGarbageCollect, since it has less left to relocate.
+  SectorDescriptor* sector_to_gc = incremental_gc_sector_;
+  for (Address address : reserved_addresses) {
+    if (sector_to_gc != nullptr &&
+        sectors_.AddressInSector(*sector_to_gc, address)) {
+      sector_to_gc = nullptr;
+    }
+  }
+
+  if (sector_to_gc == nullptr) {
+    sector_to_gc = sectors_.FindSectorToGarbageCollect(reserved_addresses);
+  }
 
   if (sector_to_gc == nullptr) {
     // Nothing to GC.
@@ -991,6 +2011,8 @@ Status KeyValueStore::GarbageCollectSector(
     }
   }
 
+  PW_TRY(FinishGarbageCollectionDestination());
+
   if (sector_to_gc.valid_bytes() != 0) {
     ERR("  Failed to relocate valid entries from sector being garbage "
         "collected, %u valid bytes remain",
@@ -998,12 +2020,16 @@ Status KeyValueStore::GarbageCollectSector(
     return Status::Internal();
   }
 
+  if (&sector_to_gc == incremental_gc_sector_) {
+    incremental_gc_sector_ = nullptr;
+  }
+
   // Step 2: Reinitialize the sector
   if (!sector_to_gc.Empty(partition_.sector_size_bytes())) {
     sector_to_gc.mark_corrupt();
     internal_stats_.sector_erase_count++;
     PW_TRY(partition_.Erase(sectors_.BaseAddress(sector_to_gc), 1));
-    sector_to_gc.set_writable_bytes(partition_.sector_size_bytes());
+    sector_to_gc.MarkErased(partition_.sector_size_bytes());
   }
 
   DBG("  Garbage Collect sector %u complete", sectors_.Index(sector_to_gc));
@@ -1028,6 +2054,14 @@ StatusWithSize KeyValueStore::UpdateEntriesToPrimaryFormat() {
 
     entries_updated++;
 
+    // Changing how the value is compressed changes the value itself, so the
+    // entry cannot simply be copied with a new header.
+    if (!entry.deleted() &&
+        entry.compression() != formats_.primary().compression) {
+      PW_TRY_WITH_SIZE(RecompressEntry(prior_metadata, entry));
+      continue;
+    }
+
     last_transaction_id_ += 1;
     PW_TRY_WITH_SIZE(entry.Update(formats_.primary(), last_transaction_id_));
 
@@ -1062,6 +2096,47 @@ StatusWithSize KeyValueStore::UpdateEntriesToPrimaryFormat() {
   return StatusWithSize(entries_updated);
 }
 
+// Writes an entry again in the primary format, decompressing its value if it
+// is compressed or compressing it if it is not.
+Status KeyValueStore::RecompressEntry(EntryMetadata& metadata,
+                                      const Entry& entry) {
+  Entry::KeyBuffer key_buffer;
+  PW_TRY_ASSIGN(const size_t key_length, entry.ReadKey(key_buffer));
+  const Key key(key_buffer.data(), key_length);
+
+  size_t value_size;
+  {
+    FlashPartition::Reader reader(partition_);
+    PW_TRY(reader.Seek(entry.value_address()));
+    if (entry.compressed()) {
+      internal::LzDecompressor value(reader, entry.value_size());
+      PW_TRY_ASSIGN(value_size, value.DecompressedSize());
+    } else {
+      internal::LzCompressor value(reader, entry.value_size());
+      PW_TRY_ASSIGN(value_size, value.CompressedSize());
+    }
+  }
+
+  Address* reserved_addresses = entry_cache_.TempReservedAddressesForWrite();
+  PW_TRY(GetAddressesForWrite(reserved_addresses,
+                              Entry::size(partition_, key, value_size)));
+
+  // Garbage collection may have moved the entry, so read it again.
+  Entry prior_entry;
+  PW_TRY(ReadEntry(metadata, prior_entry));
+
+  FlashPartition::Reader reader(partition_);
+  PW_TRY(reader.Seek(prior_entry.value_address()));
+  if (prior_entry.compressed()) {
+    internal::LzDecompressor value(reader, prior_entry.value_size());
+    return WriteReservedEntry(
+        key, value, value_size, &metadata, prior_entry.size());
+  }
+  internal::LzCompressor value(reader, prior_entry.value_size());
+  return WriteReservedEntry(
+      key, value, value_size, &metadata, prior_entry.size());
+}
+
 // Add any missing redundant entries/copies for a key.
 Status KeyValueStore::AddRedundantEntries(EntryMetadata& metadata) {
   Entry entry;
@@ -1207,7 +2282,7 @@ Status KeyValueStore::Repair() {
   INF("Starting KVS repair");
 
   DBG("Reinitialize KVS metadata");
-  InitializeMetadata();
+  InitializeMetadata(/*use_sector_summaries=*/false);
 
   return FixErrors();
 }
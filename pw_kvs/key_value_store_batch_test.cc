@@ -0,0 +1,262 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/internal/entry.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_string/string_builder.h"
+
+namespace pw::kvs {
+namespace {
+
+using internal::Entry;
+using Address = FlashPartition::Address;
+using BatchEntry = KeyValueStore::BatchEntry;
+
+constexpr size_t kSectorSize = 512;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kMaxEntries = 16;
+constexpr size_t kKeys = 10;
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x5a1f03c9, .checksum = &checksum};
+
+class WriteCountingFlash
+    : public FakeFlashMemoryBuffer<kSectorSize, kSectorCount> {
+ public:
+  WriteCountingFlash() : FakeFlashMemoryBuffer(16) {}
+
+  StatusWithSize Write(Address address,
+                       std::span<const std::byte> data) override {
+    writes += 1;
+    return FakeFlashMemoryBuffer::Write(address, data);
+  }
+
+  size_t writes = 0;
+};
+
+// Returns the address of the newest entry for a key, or the partition size if
+// there is none.
+Address FindEntryInFlash(FlashPartition& partition, Key key) {
+  const internal::EntryFormats formats(kFormat);
+  Address found = partition.size_bytes();
+  uint32_t newest = 0;
+
+  for (size_t sector = 0; sector < partition.sector_count(); ++sector) {
+    const Address sector_address = sector * partition.sector_size_bytes();
+    Entry entry;
+    for (Address address = sector_address;
+         address < sector_address + partition.sector_size_bytes() &&
+         Entry::Read(partition, address, formats, &entry).ok();
+         address = entry.next_address()) {
+      Entry::KeyBuffer buffer;
+      const StatusWithSize key_length = entry.ReadKey(buffer);
+      if (key_length.ok() && Key(buffer.data(), key_length.size()) == key &&
+          entry.transaction_id() >= newest) {
+        found = address;
+        newest = entry.transaction_id();
+      }
+    }
+  }
+  return found;
+}
+
+class PutBatch : public ::testing::Test {
+ protected:
+  PutBatch() : partition_(&flash_), kvs_(&partition_, kFormat) {
+    for (size_t i = 0; i < kKeys; ++i) {
+      StringBuilder key(keys_[i]);
+      key << "key_" << i;
+      values_[i] = static_cast<uint32_t>(100 + i);
+      batch_[i] = {.key = key.view(),
+                   .value = std::as_bytes(std::span(&values_[i], 1))};
+    }
+  }
+
+  void SetUp() override { ASSERT_EQ(OkStatus(), kvs_.Init()); }
+
+  void ExpectBatchValues(KeyValueStore& kvs) {
+    for (size_t i = 0; i < kKeys; ++i) {
+      uint32_t value = 0;
+      ASSERT_EQ(OkStatus(), kvs.Get(batch_[i].key, &value));
+      EXPECT_EQ(values_[i], value);
+    }
+  }
+
+  WriteCountingFlash flash_;
+  FlashPartition partition_;
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs_;
+
+  std::array<std::array<char, 8>, kKeys> keys_;
+  std::array<uint32_t, kKeys> values_;
+  std::array<BatchEntry, kKeys> batch_;
+};
+
+TEST_F(PutBatch, Empty_WritesNothing) {
+  flash_.writes = 0;
+  EXPECT_EQ(OkStatus(), kvs_.PutBatch({}));
+  EXPECT_EQ(0u, flash_.writes);
+}
+
+TEST_F(PutBatch, AddsNewKeys) {
+  ASSERT_EQ(OkStatus(), kvs_.PutBatch(batch_));
+  EXPECT_EQ(kKeys, kvs_.size());
+  ExpectBatchValues(kvs_);
+}
+
+TEST_F(PutBatch, UpdatesExistingKeys) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key_3", uint32_t(1)));
+  ASSERT_EQ(OkStatus(), kvs_.Put("other", uint32_t(2)));
+  ASSERT_EQ(OkStatus(), kvs_.PutBatch(batch_));
+
+  EXPECT_EQ(kKeys + 1, kvs_.size());
+  ExpectBatchValues(kvs_);
+
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), kvs_.Get("other", &value));
+  EXPECT_EQ(2u, value);
+}
+
+TEST_F(PutBatch, UsesConsecutiveTransactionIds) {
+  ASSERT_EQ(OkStatus(), kvs_.PutBatch(batch_));
+
+  const internal::EntryFormats formats(kFormat);
+  Entry first;
+  Entry last;
+  ASSERT_EQ(OkStatus(),
+            Entry::Read(partition_,
+                        FindEntryInFlash(partition_, batch_.front().key),
+                        formats,
+                        &first));
+  ASSERT_EQ(OkStatus(),
+            Entry::Read(partition_,
+                        FindEntryInFlash(partition_, batch_.back().key),
+                        formats,
+                        &last));
+  EXPECT_EQ(first.transaction_id() + kKeys - 1, last.transaction_id());
+  EXPECT_EQ(first.next_address() + (kKeys - 2) * first.size(), last.address());
+}
+
+TEST_F(PutBatch, FewerFlashWritesThanPut) {
+  WriteCountingFlash other_flash;
+  FlashPartition other_partition(&other_flash);
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> other_kvs(&other_partition,
+                                                           kFormat);
+  ASSERT_EQ(OkStatus(), other_kvs.Init());
+
+  other_flash.writes = 0;
+  for (const BatchEntry& entry : batch_) {
+    ASSERT_EQ(OkStatus(), other_kvs.Put(entry.key, entry.value));
+  }
+
+  flash_.writes = 0;
+  ASSERT_EQ(OkStatus(), kvs_.PutBatch(batch_));
+
+  EXPECT_LT(flash_.writes, other_flash.writes);
+}
+
+TEST_F(PutBatch, RepeatedKey_WritesNothing) {
+  const std::array<BatchEntry, 2> batch = {batch_[0], batch_[0]};
+  flash_.writes = 0;
+  EXPECT_EQ(Status::InvalidArgument(), kvs_.PutBatch(batch));
+  EXPECT_EQ(0u, flash_.writes);
+  EXPECT_EQ(0u, kvs_.size());
+}
+
+TEST_F(PutBatch, InvalidKey_WritesNothing) {
+  const std::array<BatchEntry, 2> batch = {batch_[0], BatchEntry{}};
+  flash_.writes = 0;
+  EXPECT_EQ(Status::InvalidArgument(), kvs_.PutBatch(batch));
+  EXPECT_EQ(0u, flash_.writes);
+  EXPECT_EQ(0u, kvs_.size());
+}
+
+TEST_F(PutBatch, LargerThanSector_InvalidArgument) {
+  std::array<std::byte, kSectorSize / 2> large_value = {};
+  const std::array<BatchEntry, 2> batch = {
+      BatchEntry{.key = "large_1", .value = large_value},
+      BatchEntry{.key = "large_2", .value = large_value},
+  };
+  EXPECT_EQ(Status::InvalidArgument(), kvs_.PutBatch(batch));
+  EXPECT_EQ(0u, kvs_.size());
+}
+
+TEST_F(PutBatch, TooManyNewKeys_ResourceExhausted) {
+  for (size_t i = 0; i < kMaxEntries - kKeys + 1; ++i) {
+    StringBuffer<16> key;
+    key << "filler_" << i;
+    ASSERT_EQ(OkStatus(), kvs_.Put(key.view(), uint32_t(i)));
+  }
+
+  EXPECT_EQ(Status::ResourceExhausted(), kvs_.PutBatch(batch_));
+  EXPECT_EQ(Status::NotFound(), kvs_.ValueSize(batch_[0].key).status());
+}
+
+TEST_F(PutBatch, Init_LoadsBatch) {
+  ASSERT_EQ(OkStatus(), kvs_.PutBatch(batch_));
+
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs(&partition_, kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  EXPECT_EQ(kKeys, kvs.size());
+  ExpectBatchValues(kvs);
+}
+
+TEST_F(PutBatch, Init_IncompleteBatch_KeepsPriorValues) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key_0", uint32_t(1)));
+  ASSERT_EQ(OkStatus(), kvs_.PutBatch(batch_));
+
+  // Erase the last entry of the batch, as if power was lost while writing it.
+  const Address last = FindEntryInFlash(partition_, batch_.back().key);
+  ASSERT_LT(last, partition_.size_bytes());
+  std::memset(flash_.buffer().data() + last,
+              0xff,
+              Entry::size(partition_, batch_.back().key, batch_.back().value));
+
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs(&partition_, kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  EXPECT_EQ(1u, kvs.size());
+
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), kvs.Get("key_0", &value));
+  EXPECT_EQ(1u, value);
+  EXPECT_EQ(Status::NotFound(), kvs.ValueSize("key_1").status());
+
+  // The skipped entries are not reused; new writes go after them.
+  ASSERT_EQ(OkStatus(), kvs.PutBatch(batch_));
+  ExpectBatchValues(kvs);
+}
+
+TEST_F(PutBatch, Redundancy_WritesEveryCopy) {
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount, 2> kvs(&partition_, kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  ASSERT_EQ(OkStatus(), kvs.PutBatch(batch_));
+
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount, 2> reloaded(&partition_,
+                                                             kFormat);
+  ASSERT_EQ(OkStatus(), reloaded.Init());
+  EXPECT_FALSE(reloaded.error_detected());
+  ExpectBatchValues(reloaded);
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -0,0 +1,175 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kSectorSize = 1024;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kMaxEntries = 16;
+constexpr size_t kValueSize = 600;
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kLzFormat{.magic = 0x2c9d4e71,
+                                .checksum = &checksum,
+                                .compression = ValueCompression::kLz};
+constexpr EntryFormat kRawFormat{.magic = 0x7a0b35e2, .checksum = &checksum};
+
+constexpr std::array<EntryFormat, 2> kLzFirst = {kLzFormat, kRawFormat};
+constexpr std::array<EntryFormat, 2> kRawFirst = {kRawFormat, kLzFormat};
+
+class CompressedKvs : public ::testing::Test {
+ protected:
+  CompressedKvs()
+      : flash_(16), partition_(&flash_), kvs_(&partition_, kLzFirst) {
+    constexpr std::string_view kText = "sensor=3 state=idle temp=21.5; ";
+    for (size_t i = 0; i < value_.size(); ++i) {
+      value_[i] = static_cast<std::byte>(kText[i % kText.size()]);
+    }
+    // Vary the text so that values are not all copies.
+    value_[100] = std::byte{'!'};
+    value_[401] = std::byte{'?'};
+  }
+
+  void SetUp() override { ASSERT_EQ(OkStatus(), kvs_.Init()); }
+
+  void ExpectValue(KeyValueStore& kvs, Key key) {
+    std::array<std::byte, kValueSize> read = {};
+    StatusWithSize result = kvs.Get(key, read);
+    ASSERT_EQ(OkStatus(), result.status());
+    ASSERT_EQ(kValueSize, result.size());
+    EXPECT_EQ(0, std::memcmp(value_.data(), read.data(), kValueSize));
+  }
+
+  FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  FlashPartition partition_;
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount, 1, 2> kvs_;
+
+  std::array<std::byte, kValueSize> value_;
+};
+
+TEST_F(CompressedKvs, Put_Get) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("text", value_));
+  ExpectValue(kvs_, "text");
+  EXPECT_EQ(kValueSize, kvs_.ValueSize("text").size());
+}
+
+TEST_F(CompressedKvs, Put_UsesLessFlash) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("text", value_));
+  EXPECT_LT(kvs_.GetStorageStats().in_use_bytes, kValueSize / 2);
+}
+
+TEST_F(CompressedKvs, Put_SmallValue) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("int", uint32_t{0x12345678}));
+
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), kvs_.Get("int", &value));
+  EXPECT_EQ(0x12345678u, value);
+}
+
+TEST_F(CompressedKvs, Get_WithOffset) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("text", value_));
+
+  std::array<std::byte, 32> read = {};
+  StatusWithSize result = kvs_.Get("text", read, 390);
+  ASSERT_EQ(Status::ResourceExhausted(), result.status());
+  ASSERT_EQ(read.size(), result.size());
+  EXPECT_EQ(0, std::memcmp(&value_[390], read.data(), read.size()));
+
+  result = kvs_.Get("text", read, kValueSize - 10);
+  ASSERT_EQ(OkStatus(), result.status());
+  ASSERT_EQ(10u, result.size());
+  EXPECT_EQ(0, std::memcmp(&value_[kValueSize - 10], read.data(), 10));
+
+  EXPECT_EQ(Status::OutOfRange(),
+            kvs_.Get("text", read, kValueSize + 1).status());
+}
+
+TEST_F(CompressedKvs, Get_ToStream) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("text", value_));
+
+  stream::MemoryWriterBuffer<kValueSize> writer;
+  StatusWithSize result = kvs_.Get("text", writer);
+  ASSERT_EQ(OkStatus(), result.status());
+  ASSERT_EQ(kValueSize, writer.bytes_written());
+  EXPECT_EQ(0, std::memcmp(value_.data(), writer.data(), kValueSize));
+}
+
+TEST_F(CompressedKvs, Init_ReadsCompressedValues) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("text", value_));
+
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount, 1, 2> reopened(&partition_,
+                                                                kLzFirst);
+  ASSERT_EQ(OkStatus(), reopened.Init());
+  ExpectValue(reopened, "text");
+}
+
+TEST_F(CompressedKvs, GetMapped_Unimplemented) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("text", value_));
+  EXPECT_EQ(Status::Unimplemented(), kvs_.GetMapped("text").status());
+}
+
+TEST_F(CompressedKvs, PutBatch_Unimplemented) {
+  const KeyValueStore::BatchEntry entries[] = {{"text", value_}};
+  EXPECT_EQ(Status::Unimplemented(), kvs_.PutBatch(entries));
+}
+
+TEST_F(CompressedKvs, FullMaintenance_DecompressesForRawPrimaryFormat) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("text", value_));
+  ASSERT_EQ(OkStatus(), kvs_.Delete("text"));
+  ASSERT_EQ(OkStatus(), kvs_.Put("text2", value_));
+
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount, 1, 2> raw_kvs(&partition_,
+                                                               kRawFirst);
+  ASSERT_EQ(OkStatus(), raw_kvs.Init());
+  ASSERT_EQ(OkStatus(), raw_kvs.FullMaintenance());
+  ExpectValue(raw_kvs, "text2");
+  EXPECT_EQ(Status::NotFound(), raw_kvs.ValueSize("text").status());
+  EXPECT_EQ(OkStatus(), raw_kvs.GetMapped("text2").status());
+
+  // Only the raw format is needed after maintenance.
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> raw_only_kvs(&partition_,
+                                                              kRawFormat);
+  ASSERT_EQ(OkStatus(), raw_only_kvs.Init());
+  ExpectValue(raw_only_kvs, "text2");
+}
+
+TEST_F(CompressedKvs, FullMaintenance_CompressesForLzPrimaryFormat) {
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount, 1, 2> raw_kvs(&partition_,
+                                                               kRawFirst);
+  ASSERT_EQ(OkStatus(), raw_kvs.Init());
+  ASSERT_EQ(OkStatus(), raw_kvs.Put("text", value_));
+  const size_t raw_bytes = raw_kvs.GetStorageStats().in_use_bytes;
+
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  ASSERT_EQ(OkStatus(), kvs_.FullMaintenance());
+  ExpectValue(kvs_, "text");
+  EXPECT_LT(kvs_.GetStorageStats().in_use_bytes, raw_bytes);
+}
+
+}  // namespace
+}  // namespace pw::kvs
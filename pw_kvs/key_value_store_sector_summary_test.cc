@@ -0,0 +1,242 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/internal/entry.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_string/string_builder.h"
+
+namespace pw::kvs {
+namespace {
+
+using internal::Entry;
+using Address = FlashPartition::Address;
+
+constexpr size_t kSectorSize = 512;
+constexpr size_t kSectorCount = 8;
+constexpr size_t kMaxEntries = 32;
+constexpr size_t kKeys = 10;
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x7b20d6c1, .checksum = &checksum};
+constexpr EntryFormat kNoChecksumFormat{.magic = 0x3e81f52a,
+                                        .checksum = nullptr};
+
+class ReadCountingFlash
+    : public FakeFlashMemoryBuffer<kSectorSize, kSectorCount> {
+ public:
+  ReadCountingFlash() : FakeFlashMemoryBuffer(16) {}
+
+  StatusWithSize Read(Address address, std::span<std::byte> output) override {
+    bytes_read += output.size();
+    return FakeFlashMemoryBuffer::Read(address, output);
+  }
+
+  size_t bytes_read = 0;
+};
+
+struct Value {
+  uint32_t key_number;
+  uint32_t version;
+  std::array<char, 48> padding;
+};
+
+// Writes every key several times, then garbage collects all stale entries.
+template <typename Kvs>
+void WriteKeysAndCompact(Kvs& kvs) {
+  for (uint32_t version = 0; version < 3; ++version) {
+    for (uint32_t i = 0; i < kKeys; ++i) {
+      StringBuffer<16> key;
+      key << "key_" << i;
+      ASSERT_EQ(OkStatus(), kvs.Put(key.view(), Value{i, version, {}}));
+    }
+  }
+  ASSERT_EQ(OkStatus(), kvs.HeavyMaintenance());
+}
+
+template <typename Kvs>
+void ExpectKeys(Kvs& kvs, uint32_t version) {
+  EXPECT_EQ(kKeys, kvs.size());
+  for (uint32_t i = 0; i < kKeys; ++i) {
+    StringBuffer<16> key;
+    key << "key_" << i;
+    Value value{};
+    ASSERT_EQ(OkStatus(), kvs.Get(key.view(), &value));
+    EXPECT_EQ(i, value.key_number);
+    EXPECT_EQ(version, value.version);
+  }
+}
+
+// Returns the address of each summary in the partition.
+template <size_t kMaxSummaries>
+Vector<Address, kMaxSummaries> FindSummaries(FlashPartition& partition,
+                                             const EntryFormat& format) {
+  const internal::EntryFormats formats(format);
+  Vector<Address, kMaxSummaries> summaries;
+
+  for (size_t sector = 0; sector < partition.sector_count(); ++sector) {
+    const Address sector_address = sector * partition.sector_size_bytes();
+    Entry entry;
+    for (Address address = sector_address;
+         address < sector_address + partition.sector_size_bytes() &&
+         Entry::Read(partition, address, formats, &entry).ok();
+         address = entry.next_address()) {
+      if (entry.key_length() == 0u && !summaries.full()) {
+        summaries.push_back(address);
+      }
+    }
+  }
+  return summaries;
+}
+
+class SectorSummary : public ::testing::Test {
+ protected:
+  SectorSummary() : partition_(&flash_) {}
+
+  ReadCountingFlash flash_;
+  FlashPartition partition_;
+};
+
+TEST_F(SectorSummary, Disabled_NoSummariesWritten) {
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs(&partition_, kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  WriteKeysAndCompact(kvs);
+
+  EXPECT_TRUE((FindSummaries<4>(partition_, kFormat).empty()));
+}
+
+TEST_F(SectorSummary, GarbageCollection_WritesSummaries) {
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs(
+      &partition_, kFormat, {.sector_summaries = true});
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  WriteKeysAndCompact(kvs);
+
+  EXPECT_FALSE((FindSummaries<4>(partition_, kFormat).empty()));
+  ExpectKeys(kvs, 2);
+}
+
+TEST_F(SectorSummary, Init_ReadsLessFlash) {
+  ReadCountingFlash flash_without_summaries;
+  FlashPartition partition_without_summaries(&flash_without_summaries);
+  {
+    KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs(
+        &partition_, kFormat, {.sector_summaries = true});
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    WriteKeysAndCompact(kvs);
+
+    KeyValueStoreBuffer<kMaxEntries, kSectorCount> other_kvs(
+        &partition_without_summaries, kFormat);
+    ASSERT_EQ(OkStatus(), other_kvs.Init());
+    WriteKeysAndCompact(other_kvs);
+  }
+
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs(&partition_, kFormat);
+  flash_.bytes_read = 0;
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> other_kvs(
+      &partition_without_summaries, kFormat);
+  flash_without_summaries.bytes_read = 0;
+  ASSERT_EQ(OkStatus(), other_kvs.Init());
+
+  EXPECT_LT(flash_.bytes_read, flash_without_summaries.bytes_read);
+  ExpectKeys(kvs, 2);
+  ExpectKeys(other_kvs, 2);
+}
+
+TEST_F(SectorSummary, Init_LoadsEntriesWrittenAfterSummary) {
+  {
+    KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs(
+        &partition_, kFormat, {.sector_summaries = true});
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    WriteKeysAndCompact(kvs);
+
+    for (uint32_t i = 0; i < kKeys; ++i) {
+      StringBuffer<16> key;
+      key << "key_" << i;
+      ASSERT_EQ(OkStatus(), kvs.Put(key.view(), Value{i, 3, {}}));
+    }
+    ASSERT_EQ(OkStatus(), kvs.Delete("key_0"));
+  }
+
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs(&partition_, kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  EXPECT_EQ(kKeys - 1, kvs.size());
+  Value value{};
+  EXPECT_EQ(Status::NotFound(), kvs.Get("key_0", &value));
+  ASSERT_EQ(OkStatus(), kvs.Get("key_5", &value));
+  EXPECT_EQ(3u, value.version);
+}
+
+TEST_F(SectorSummary, Init_FillsKeyTable) {
+  {
+    KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs(
+        &partition_, kFormat, {.sector_summaries = true});
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    WriteKeysAndCompact(kvs);
+  }
+
+  // Summaries hold key hashes but not keys, so Init reads the keys it needs.
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount, 1, 1, 0, 128> kvs(&partition_,
+                                                                   kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  flash_.bytes_read = 0;
+  size_t keys = 0;
+  for (const auto& item : kvs) {
+    EXPECT_EQ(0, std::strncmp("key_", item.key(), 4));
+    keys += 1;
+  }
+  EXPECT_EQ(kKeys, keys);
+  EXPECT_EQ(0u, flash_.bytes_read);
+  ExpectKeys(kvs, 2);
+}
+
+TEST_F(SectorSummary, Init_MismatchedSummary_ReadsAllEntries) {
+  {
+    KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs(
+        &partition_, kNoChecksumFormat, {.sector_summaries = true});
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    WriteKeysAndCompact(kvs);
+  }
+
+  // Without a checksum, the summary can be changed without detection. Change
+  // the first record's key hash and transaction ID, so that the key would not
+  // be found if the summary were used.
+  auto summaries = FindSummaries<4>(partition_, kNoChecksumFormat);
+  ASSERT_FALSE(summaries.empty());
+  std::byte* record =
+      flash_.buffer().data() + summaries[0] + sizeof(internal::EntryHeader);
+  for (size_t i = 0; i < 2 * sizeof(uint32_t); ++i) {
+    record[i] ^= std::byte{0x5a};
+  }
+
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs(&partition_,
+                                                     kNoChecksumFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  ExpectKeys(kvs, 2);
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -0,0 +1,282 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kSectorSize = 1024;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kMaxEntries = 16;
+
+// Several times larger than the buffers that values are streamed through.
+constexpr size_t kValueSize = 900;
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x4b1c7e35, .checksum = &checksum};
+
+// Reads at most a few bytes at a time, as a UART or socket might.
+class TrickleReader final : public stream::SeekableReader {
+ public:
+  TrickleReader(ConstByteSpan data) : reader_(data) {}
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override {
+    Result<ByteSpan> result =
+        reader_.Read(dest.first(std::min(dest.size(), size_t{7})));
+    return result.ok() ? StatusWithSize(result.value().size())
+                       : StatusWithSize(result.status(), 0);
+  }
+
+  Status DoSeek(ptrdiff_t offset, stream::Whence origin) override {
+    return reader_.Seek(offset, origin);
+  }
+
+  size_t DoTell() const override { return reader_.Tell(); }
+
+  stream::MemoryReader reader_;
+};
+
+// Changes the data each time it seeks, as a reader of data that is being
+// modified might.
+class ChangingReader final : public stream::SeekableReader {
+ public:
+  ChangingReader(ByteSpan data) : data_(data), reader_(data) {}
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override {
+    Result<ByteSpan> result = reader_.Read(dest);
+    return result.ok() ? StatusWithSize(result.value().size())
+                       : StatusWithSize(result.status(), 0);
+  }
+
+  Status DoSeek(ptrdiff_t offset, stream::Whence origin) override {
+    data_[0] ^= std::byte{1};
+    return reader_.Seek(offset, origin);
+  }
+
+  size_t DoTell() const override { return reader_.Tell(); }
+
+  ByteSpan data_;
+  stream::MemoryReader reader_;
+};
+
+template <size_t kRedundancy>
+class StreamTest : public ::testing::Test {
+ protected:
+  StreamTest() : flash_(16), partition_(&flash_), kvs_(&partition_, kFormat) {
+    for (size_t i = 0; i < value_.size(); ++i) {
+      value_[i] = static_cast<std::byte>(i * 7);
+    }
+  }
+
+  void SetUp() override { ASSERT_EQ(OkStatus(), kvs_.Init()); }
+
+  FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  FlashPartition partition_;
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount, kRedundancy> kvs_;
+
+  std::array<std::byte, kValueSize> value_;
+};
+
+using PutStream = StreamTest<1>;
+using GetStream = StreamTest<1>;
+using RedundantStream = StreamTest<2>;
+
+TEST_F(PutStream, ReadsBackWithGet) {
+  stream::MemoryReader reader(value_);
+  ASSERT_EQ(OkStatus(), kvs_.Put("big", reader, value_.size()));
+  EXPECT_EQ(reader.bytes_read(), kValueSize);  // The reader is past the value.
+
+  std::array<std::byte, kValueSize> read = {};
+  const StatusWithSize result = kvs_.Get("big", read);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(kValueSize, result.size());
+  EXPECT_EQ(0, std::memcmp(read.data(), value_.data(), read.size()));
+}
+
+TEST_F(PutStream, PartialReads) {
+  TrickleReader reader(value_);
+  ASSERT_EQ(OkStatus(), kvs_.Put("big", reader, value_.size()));
+
+  std::array<std::byte, kValueSize> read = {};
+  ASSERT_EQ(OkStatus(), kvs_.Get("big", read).status());
+  EXPECT_EQ(0, std::memcmp(read.data(), value_.data(), read.size()));
+}
+
+TEST_F(PutStream, StartsAtReaderPosition) {
+  stream::MemoryReader reader(value_);
+  ASSERT_EQ(OkStatus(), reader.Seek(100));
+  ASSERT_EQ(OkStatus(), kvs_.Put("part", reader, 50));
+
+  std::array<std::byte, 50> read = {};
+  ASSERT_EQ(OkStatus(), kvs_.Get("part", read).status());
+  EXPECT_EQ(0, std::memcmp(read.data(), &value_[100], read.size()));
+}
+
+TEST_F(PutStream, OverwritesExistingKey) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("big", uint32_t(1)));
+
+  stream::MemoryReader reader(value_);
+  ASSERT_EQ(OkStatus(), kvs_.Put("big", reader, value_.size()));
+  EXPECT_EQ(1u, kvs_.size());
+  EXPECT_EQ(kValueSize, kvs_.ValueSize("big").size());
+}
+
+TEST_F(PutStream, ReaderTooShort_WritesNothing) {
+  stream::MemoryReader reader(std::span<const std::byte>(value_).first(10));
+  EXPECT_EQ(Status::OutOfRange(), kvs_.Put("big", reader, 11));
+
+  EXPECT_EQ(0u, kvs_.size());
+  EXPECT_EQ(0u, kvs_.GetStorageStats().in_use_bytes);
+}
+
+TEST_F(PutStream, ValueChangesBetweenReads_ReturnsDataLoss) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("big", uint32_t(1)));
+
+  ChangingReader reader(value_);
+  EXPECT_EQ(Status::DataLoss(), kvs_.Put("big", reader, value_.size()));
+
+  // The entry that was written is invalid, so the old value is kept.
+  uint32_t value = 0;
+  EXPECT_EQ(OkStatus(), kvs_.Get("big", &value));
+  EXPECT_EQ(1u, value);
+}
+
+TEST_F(PutStream, TooLargeForSector_ReturnsInvalidArgument) {
+  stream::MemoryReader reader(value_);
+  EXPECT_EQ(Status::InvalidArgument(), kvs_.Put("big", reader, kSectorSize));
+  EXPECT_EQ(reader.bytes_read(), 0u);
+}
+
+TEST_F(PutStream, PersistsAcrossInit) {
+  stream::MemoryReader reader(value_);
+  ASSERT_EQ(OkStatus(), kvs_.Put("big", reader, value_.size()));
+
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> reloaded(&partition_,
+                                                          kFormat);
+  ASSERT_EQ(OkStatus(), reloaded.Init());
+  EXPECT_FALSE(reloaded.error_detected());
+
+  std::array<std::byte, kValueSize> read = {};
+  ASSERT_EQ(OkStatus(), reloaded.Get("big", read).status());
+  EXPECT_EQ(0, std::memcmp(read.data(), value_.data(), read.size()));
+}
+
+TEST_F(GetStream, WritesValue) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("big", value_));
+
+  std::array<std::byte, kValueSize> read = {};
+  stream::MemoryWriter writer(read);
+  const StatusWithSize result = kvs_.Get("big", writer);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(kValueSize, result.size());
+  EXPECT_EQ(kValueSize, writer.bytes_written());
+  EXPECT_EQ(0, std::memcmp(read.data(), value_.data(), read.size()));
+}
+
+TEST_F(GetStream, Offset) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("big", value_));
+
+  std::array<std::byte, kValueSize> read = {};
+  stream::MemoryWriter writer(read);
+  const StatusWithSize result = kvs_.Get("big", writer, 500);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(kValueSize - 500, result.size());
+  EXPECT_EQ(0, std::memcmp(read.data(), &value_[500], result.size()));
+}
+
+TEST_F(GetStream, OffsetPastEnd_ReturnsOutOfRange) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("small", uint32_t(1)));
+
+  std::array<std::byte, 8> read = {};
+  stream::MemoryWriter writer(read);
+  EXPECT_EQ(Status::OutOfRange(), kvs_.Get("small", writer, 5).status());
+  EXPECT_EQ(OkStatus(), kvs_.Get("small", writer, 4).status());
+  EXPECT_EQ(0u, writer.bytes_written());
+}
+
+TEST_F(GetStream, WriterFull_ReturnsBytesWritten) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("big", value_));
+
+  std::array<std::byte, 100> read = {};
+  stream::MemoryWriter writer(read);
+  const StatusWithSize result = kvs_.Get("big", writer);
+  EXPECT_EQ(Status::ResourceExhausted(), result.status());
+  EXPECT_LE(result.size(), read.size());
+  EXPECT_EQ(0, std::memcmp(read.data(), value_.data(), result.size()));
+}
+
+TEST_F(GetStream, Corrupt_WritesNothing) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("big", value_));
+
+  // Flip a bit near the end of the value, after the first chunk.
+  std::span<std::byte> flash = flash_.buffer();
+  const auto found = std::search(flash.begin(),
+                                 flash.end(),
+                                 value_.end() - 16,
+                                 value_.end());
+  ASSERT_NE(found, flash.end());
+  *found ^= std::byte{1};
+
+  std::array<std::byte, kValueSize> read = {};
+  stream::MemoryWriter writer(read);
+  EXPECT_EQ(Status::DataLoss(), kvs_.Get("big", writer).status());
+  EXPECT_EQ(0u, writer.bytes_written());
+}
+
+TEST_F(GetStream, Item) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("big", value_));
+
+  for (const auto& item : kvs_) {
+    std::array<std::byte, kValueSize> read = {};
+    stream::MemoryWriter writer(read);
+    ASSERT_EQ(OkStatus(), item.Get(writer).status());
+    EXPECT_EQ(0, std::memcmp(read.data(), value_.data(), read.size()));
+  }
+}
+
+TEST_F(RedundantStream, PutWritesEveryCopy) {
+  stream::MemoryReader reader(value_);
+  ASSERT_EQ(OkStatus(), kvs_.Put("big", reader, value_.size()));
+
+  // Both copies are in flash, so reloading finds nothing to repair.
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount, 2> reloaded(&partition_,
+                                                             kFormat);
+  ASSERT_EQ(OkStatus(), reloaded.Init());
+  EXPECT_FALSE(reloaded.error_detected());
+  EXPECT_EQ(kvs_.GetStorageStats().in_use_bytes,
+            reloaded.GetStorageStats().in_use_bytes);
+
+  std::array<std::byte, kValueSize> read = {};
+  stream::MemoryWriter writer(read);
+  ASSERT_EQ(OkStatus(), reloaded.Get("big", writer).status());
+  EXPECT_EQ(0, std::memcmp(read.data(), value_.data(), read.size()));
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -295,6 +295,131 @@ TEST(InMemoryKvs, WriteOneKeyValueMultipleTimes) {
   EXPECT_EQ(stats.reclaimable_bytes, 0u);
 }
 
+TEST(InMemoryKvs, KeyIndex_PutGetAndReinitialize) {
+  Flash flash;
+  ASSERT_OK(flash.partition.Erase());
+
+  constexpr size_t kIndexedEntries = 16;
+  KeyValueStoreBuffer<kIndexedEntries, kMaxUsableSectors, 1, 1, 32> kvs(
+      &flash.partition, default_format);
+  ASSERT_OK(kvs.Init());
+
+  for (size_t i = 0; i < kIndexedEntries; ++i) {
+    StringBuffer<16> key;
+    key << "key_" << i;
+    ASSERT_OK(kvs.Put(key.view(), i));
+  }
+  EXPECT_EQ(kvs.size(), kIndexedEntries);
+  EXPECT_EQ(kvs.Put("one too many", 1), Status::ResourceExhausted());
+
+  // Rebuilding the cache rebuilds the index.
+  ASSERT_OK(kvs.Init());
+  EXPECT_EQ(kvs.size(), kIndexedEntries);
+
+  for (size_t i = 0; i < kIndexedEntries; ++i) {
+    StringBuffer<16> key;
+    key << "key_" << i;
+    size_t value = 0;
+    ASSERT_OK(kvs.Get(key.view(), &value));
+    EXPECT_EQ(value, i);
+    ASSERT_OK(kvs.Put(key.view(), i + 100));
+  }
+  EXPECT_EQ(kvs.size(), kIndexedEntries);
+
+  size_t value = 0;
+  EXPECT_EQ(kvs.Get("missing", &value), Status::NotFound());
+  ASSERT_OK(kvs.Get("key_3", &value));
+  EXPECT_EQ(value, 103u);
+}
+
+TEST(InMemoryKvs, KeyTable_IteratesWithoutReadingFlash) {
+  Flash flash;
+  ASSERT_OK(flash.partition.Erase());
+
+  constexpr size_t kTableEntries = 8;
+  KeyValueStoreBuffer<kTableEntries, kMaxUsableSectors, 1, 1, 0, 64> kvs(
+      &flash.partition, default_format);
+  ASSERT_OK(kvs.Init());
+
+  for (size_t i = 0; i < kTableEntries; ++i) {
+    StringBuffer<16> key;
+    key << "key_" << i;
+    ASSERT_OK(kvs.Put(key.view(), i));
+  }
+
+  // Init fills the key table with the keys it reads from flash.
+  ASSERT_OK(kvs.Init());
+  flash.memory.ResetCosts();
+
+  size_t i = 0;
+  for (const auto& item : kvs) {
+    StringBuffer<16> key;
+    key << "key_" << i;
+    EXPECT_STREQ(key.c_str(), item.key());
+    i += 1;
+  }
+  EXPECT_EQ(kTableEntries, i);
+  EXPECT_EQ(0u, flash.memory.costs().reads);
+
+  // Keys are matched in RAM, so only the value is read.
+  size_t value = 0;
+  ASSERT_OK(kvs.Get("key_5", &value));
+  EXPECT_EQ(5u, value);
+  EXPECT_EQ(Status::NotFound(), kvs.Get("key_9", &value));
+}
+
+TEST(InMemoryKvs, Get_SmallValue_ReadsFlashOnce) {
+  Flash flash;
+  ASSERT_OK(flash.partition.Erase());
+
+  // Keep keys in RAM, so finding the key does not read flash.
+  KeyValueStoreBuffer<4, kMaxUsableSectors, 1, 1, 0, 16> kvs(&flash.partition,
+                                                              default_format);
+  ASSERT_OK(kvs.Init());
+  ASSERT_OK(kvs.Put("small", uint32_t{0x600d}));
+
+  std::array<std::byte, 200> large = {};
+  ASSERT_OK(kvs.Put("large", large));
+
+  // The header, key, and value are read together and verified in RAM.
+  flash.memory.ResetCosts();
+  uint32_t value = 0;
+  ASSERT_OK(kvs.Get("small", &value));
+  EXPECT_EQ(0x600du, value);
+  EXPECT_EQ(1u, flash.memory.costs().reads);
+
+  // The rest of a larger value is read separately.
+  flash.memory.ResetCosts();
+  ASSERT_EQ(large.size(), kvs.Get("large", large).size());
+  EXPECT_EQ(2u, flash.memory.costs().reads);
+}
+
+TEST(InMemoryKvs, KeyTable_Full_ReadsRemainingKeysFromFlash) {
+  Flash flash;
+  ASSERT_OK(flash.partition.Erase());
+
+  // Room for two of the five-character keys and their length bytes.
+  KeyValueStoreBuffer<4, kMaxUsableSectors, 1, 1, 0, 14> kvs(&flash.partition,
+                                                              default_format);
+  ASSERT_OK(kvs.Init());
+  ASSERT_OK(kvs.Put("key_a", 1));
+  ASSERT_OK(kvs.Put("key_b", 2));
+  ASSERT_OK(kvs.Put("key_c", 3));
+
+  flash.memory.ResetCosts();
+  auto it = kvs.begin();
+  EXPECT_STREQ("key_a", it->key());
+  EXPECT_STREQ("key_b", (++it)->key());
+  EXPECT_EQ(0u, flash.memory.costs().reads);
+
+  EXPECT_STREQ("key_c", (++it)->key());
+  EXPECT_NE(0u, flash.memory.costs().reads);
+
+  int value = 0;
+  ASSERT_OK(kvs.Get("key_c", &value));
+  EXPECT_EQ(3, value);
+}
+
 TEST(InMemoryKvs, Basic) {
   const char* key1 = "Key1";
   const char* key2 = "Key2";
@@ -409,6 +534,121 @@ TEST_F(LargeEmptyInitializedKvs, FullMaintenance) {
   stats = kvs_.GetStorageStats();
   EXPECT_EQ(stats.sector_erase_count, 1u);
   EXPECT_EQ(stats.reclaimable_bytes, 0u);
+  EXPECT_EQ(stats.entries_relocated, 1u);
+}
+
+TEST(InMemoryKvs, IncrementalGarbageCollect_RelocatesOneEntryPerStep) {
+  Flash flash;
+  ASSERT_EQ(OkStatus(), flash.partition.Erase());
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&flash.partition,
+                                                          default_format);
+  ASSERT_OK(kvs.Init());
+  EXPECT_EQ(Status::NotFound(), kvs.IncrementalGarbageCollect(1));
+  EXPECT_EQ(Status::InvalidArgument(), kvs.IncrementalGarbageCollect(0));
+
+  // Write 8 keys, then overwrite half of them to leave stale entries behind.
+  constexpr uint32_t kKeys = 8;
+  for (uint32_t i = 0; i < kKeys + kKeys / 2; ++i) {
+    StringBuffer<16> key;
+    key << "key_" << i % kKeys;
+    ASSERT_EQ(OkStatus(), kvs.Put(key.view(), i));
+  }
+  const size_t valid_entries = kKeys;
+
+  ASSERT_EQ(OkStatus(), kvs.IncrementalGarbageCollect(1));
+  EXPECT_EQ(0u, kvs.GetStorageStats().sector_erase_count);
+
+  // Writes between steps go to other sectors.
+  ASSERT_EQ(OkStatus(), kvs.Put("between_steps", uint32_t(123)));
+
+  size_t steps = 1;
+  Status status;
+  while ((status = kvs.IncrementalGarbageCollect(1)).ok()) {
+    steps += 1;
+    ASSERT_LE(steps, 2 * valid_entries);
+  }
+  EXPECT_EQ(Status::NotFound(), status);
+
+  // One step per relocated entry, plus one to erase the sector.
+  EXPECT_EQ(valid_entries + 1, steps);
+
+  KeyValueStore::StorageStats stats = kvs.GetStorageStats();
+  EXPECT_EQ(1u, stats.sector_erase_count);
+  EXPECT_EQ(0u, stats.reclaimable_bytes);
+  EXPECT_EQ(valid_entries, stats.entries_relocated);
+
+  for (uint32_t i = 0; i < kKeys; ++i) {
+    StringBuffer<16> key;
+    key << "key_" << i;
+    uint32_t value;
+    ASSERT_EQ(OkStatus(), kvs.Get(key.view(), &value));
+    EXPECT_EQ(i < kKeys / 2 ? i + kKeys : i, value);
+  }
+  uint32_t value;
+  ASSERT_EQ(OkStatus(), kvs.Get("between_steps", &value));
+  EXPECT_EQ(123u, value);
+}
+
+TEST(InMemoryKvs, GetMapped_ReturnsValueInFlash) {
+  Flash flash;
+  ASSERT_EQ(OkStatus(), flash.partition.Erase());
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&flash.partition,
+                                                          default_format);
+  ASSERT_OK(kvs.Init());
+
+  constexpr auto kValue = bytes::Array<1, 2, 3, 4, 5>();
+  ASSERT_EQ(OkStatus(), kvs.Put(keys[0], kValue));
+
+  const Result<ConstByteSpan> mapped = kvs.GetMapped(keys[0]);
+  ASSERT_EQ(OkStatus(), mapped.status());
+  ASSERT_EQ(kValue.size(), mapped.value().size());
+  EXPECT_EQ(0,
+            std::memcmp(kValue.data(), mapped.value().data(), kValue.size()));
+
+  // The span points into the flash itself.
+  EXPECT_GE(mapped.value().data(), flash.memory.buffer().data());
+  EXPECT_LT(mapped.value().data(),
+            flash.memory.buffer().data() + flash.memory.buffer().size());
+
+  EXPECT_EQ(Status::NotFound(), kvs.GetMapped(keys[1]).status());
+  EXPECT_EQ(Status::InvalidArgument(), kvs.GetMapped("").status());
+}
+
+TEST(InMemoryKvs, GetMapped_CorruptValue_DataLoss) {
+  Flash flash;
+  ASSERT_EQ(OkStatus(), flash.partition.Erase());
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&flash.partition,
+                                                          default_format);
+  ASSERT_OK(kvs.Init());
+  ASSERT_EQ(OkStatus(), kvs.Put(keys[0], uint32_t(0x12345678)));
+
+  const Result<ConstByteSpan> mapped = kvs.GetMapped(keys[0]);
+  ASSERT_EQ(OkStatus(), mapped.status());
+  const_cast<std::byte*>(mapped.value().data())[0] ^= std::byte{0xff};
+
+  EXPECT_EQ(Status::DataLoss(), kvs.GetMapped(keys[0]).status());
+}
+
+class UnmappedFlash : public FakeFlashMemoryBuffer<512, 4> {
+ public:
+  std::byte* FlashAddressToMcuAddress(Address) const override {
+    return nullptr;
+  }
+};
+
+TEST(InMemoryKvs, GetMapped_NotMemoryMapped_Unimplemented) {
+  UnmappedFlash flash;
+  FlashPartition partition(&flash);
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&partition,
+                                                          default_format);
+  ASSERT_OK(kvs.Init());
+  ASSERT_EQ(OkStatus(), kvs.Put(keys[0], uint32_t(1)));
+
+  EXPECT_EQ(Status::Unimplemented(), kvs.GetMapped(keys[0]).status());
 }
 
 TEST(InMemoryKvs, Put_MaxValueSize) {
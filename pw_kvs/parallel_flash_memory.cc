@@ -0,0 +1,258 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/parallel_flash_memory.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+#include "pw_assert/check.h"
+#include "pw_status/try.h"
+
+namespace pw::kvs {
+
+void ParallelFlashMemory::Device::Finished(Status status) {
+  bool release = false;
+  {
+    std::lock_guard lock(lock_);
+    pending_ -= 1;
+    if (!status.ok() && error_.ok()) {
+      error_ = status;
+    }
+    if (pending_ == 0u && waiting_) {
+      waiting_ = false;
+      release = true;
+    }
+  }
+  if (release) {
+    done_.release();
+  }
+}
+
+void ParallelFlashMemory::Device::Wait() {
+  bool wait = false;
+  {
+    std::lock_guard lock(lock_);
+    if (pending_ != 0u) {
+      waiting_ = true;
+      wait = true;
+    }
+  }
+  if (wait) {
+    done_.acquire();
+  }
+
+  // Nothing is queued, so the whole staging buffer is free again.
+  staged_bytes_ = 0;
+}
+
+Status ParallelFlashMemory::Device::TakeError() {
+  std::lock_guard lock(lock_);
+  return std::exchange(error_, OkStatus());
+}
+
+ParallelFlashMemory::ParallelFlashMemory(
+    std::span<AsyncFlashMemory* const> flashes,
+    std::span<Device> devices,
+    ByteSpan staging_buffer)
+    : FlashMemory(flashes[0]->sector_size_bytes(),
+                  flashes[0]->sector_count() * flashes.size(),
+                  flashes[0]->alignment_bytes(),
+                  0,
+                  0,
+                  flashes[0]->erased_memory_content()),
+      flashes_(flashes),
+      devices_(devices),
+      staging_buffer_(staging_buffer),
+      parallel_(false) {
+  PW_CHECK_UINT_EQ(flashes.size(), devices.size());
+  for (const AsyncFlashMemory* flash : flashes) {
+    PW_CHECK_UINT_EQ(flash->sector_size_bytes(), sector_size_bytes());
+    PW_CHECK_UINT_EQ(flash->sector_count(), sectors_per_device());
+    PW_CHECK_UINT_EQ(flash->alignment_bytes(), alignment_bytes());
+    PW_CHECK(flash->erased_memory_content() == erased_memory_content());
+  }
+}
+
+Status ParallelFlashMemory::Enable() {
+  for (AsyncFlashMemory* flash : flashes_) {
+    PW_TRY(flash->Enable());
+  }
+  return OkStatus();
+}
+
+Status ParallelFlashMemory::Disable() {
+  for (AsyncFlashMemory* flash : flashes_) {
+    PW_TRY(flash->Disable());
+  }
+  return OkStatus();
+}
+
+bool ParallelFlashMemory::IsEnabled() const {
+  return std::all_of(flashes_.begin(),
+                     flashes_.end(),
+                     [](const AsyncFlashMemory* flash) {
+                       return flash->IsEnabled();
+                     });
+}
+
+template <typename Function>
+Status ParallelFlashMemory::ForEachDevice(Address address,
+                                          size_t size,
+                                          Function&& function) {
+  const size_t device_size = flashes_[0]->size_bytes();
+  if (address < start_address() ||
+      address - start_address() + size > size_bytes()) {
+    return Status::OutOfRange();
+  }
+
+  size_t offset = 0;
+  while (offset < size) {
+    const size_t flash_offset = address - start_address() + offset;
+    const size_t index = flash_offset / device_size;
+    const size_t device_offset = flash_offset % device_size;
+    const size_t chunk = std::min(size - offset, device_size - device_offset);
+
+    PW_TRY(function(index,
+                    flashes_[index]->start_address() + device_offset,
+                    offset,
+                    chunk));
+    offset += chunk;
+  }
+  return OkStatus();
+}
+
+template <typename StartOperation>
+Status ParallelFlashMemory::Queue(size_t index, StartOperation&& start) {
+  Device& device = devices_[index];
+  const auto queue = [&]() {
+    {
+      std::lock_guard lock(device.lock_);
+      device.pending_ += 1;
+    }
+    Status status =
+        start([&device](Status result) { device.Finished(result); });
+    if (!status.ok()) {
+      std::lock_guard lock(device.lock_);
+      device.pending_ -= 1;
+    }
+    return status;
+  };
+
+  Status status = queue();
+  if (status.IsResourceExhausted()) {
+    device.Wait();
+    status = queue();
+  }
+  return status;
+}
+
+Status ParallelFlashMemory::Erase(Address flash_address, size_t num_sectors) {
+  if ((flash_address - start_address()) % sector_size_bytes() != 0u) {
+    return Status::InvalidArgument();
+  }
+
+  // Queue the erase on every device before waiting for any of them.
+  Status status = ForEachDevice(
+      flash_address,
+      num_sectors * sector_size_bytes(),
+      [&](size_t index, Address device_address, size_t, size_t size) {
+        return Queue(index, [&](AsyncFlashMemory::Callback&& on_done) {
+          return flashes_[index]->Erase(device_address,
+                                        size / sector_size_bytes(),
+                                        std::move(on_done));
+        });
+      });
+
+  for (Device& device : devices_) {
+    device.Wait();
+    status.Update(device.TakeError());
+  }
+  return status;
+}
+
+StatusWithSize ParallelFlashMemory::Read(Address address,
+                                         std::span<std::byte> output) {
+  const Status status = ForEachDevice(
+      address,
+      output.size(),
+      [&](size_t index, Address device_address, size_t offset, size_t size) {
+        // Read what was written, even if it is still queued.
+        devices_[index].Wait();
+        return flashes_[index]
+            ->Read(device_address, output.subspan(offset, size))
+            .status();
+      });
+  return StatusWithSize(status, status.ok() ? output.size() : 0);
+}
+
+StatusWithSize ParallelFlashMemory::Write(Address destination_flash_address,
+                                          std::span<const std::byte> data) {
+  size_t written = 0;
+  const Status status = ForEachDevice(
+      destination_flash_address,
+      data.size(),
+      [&](size_t index, Address device_address, size_t offset, size_t size) {
+        const StatusWithSize result =
+            WriteToDevice(index, device_address, data.subspan(offset, size));
+        written += result.size();
+        return result.status();
+      });
+  return StatusWithSize(status, written);
+}
+
+StatusWithSize ParallelFlashMemory::WriteToDevice(
+    size_t index, Address address, std::span<const std::byte> data) {
+  Device& device = devices_[index];
+  AsyncFlashMemory& flash = *flashes_[index];
+
+  if (parallel_ && data.size() <= staging_bytes_per_device()) {
+    if (data.size() > staging_bytes_per_device() - device.staged_bytes_) {
+      device.Wait();
+    }
+
+    // The caller's data may change once Write returns, so queue a copy.
+    const ByteSpan staged = staging_buffer_.subspan(
+        index * staging_bytes_per_device() + device.staged_bytes_, data.size());
+    std::memcpy(staged.data(), data.data(), data.size());
+    device.staged_bytes_ += data.size();
+
+    PW_TRY_WITH_SIZE(Queue(index, [&](AsyncFlashMemory::Callback&& on_done) {
+      return flash.Write(address, staged, std::move(on_done));
+    }));
+    return StatusWithSize(data.size());
+  }
+
+  PW_TRY_WITH_SIZE(Queue(index, [&](AsyncFlashMemory::Callback&& on_done) {
+    return flash.Write(address, data, std::move(on_done));
+  }));
+  device.Wait();
+  const Status status = device.TakeError();
+  return StatusWithSize(status, status.ok() ? data.size() : 0);
+}
+
+Status ParallelFlashMemory::FinishParallelWrites() {
+  parallel_ = false;
+
+  Status status;
+  for (Device& device : devices_) {
+    device.Wait();
+    status.Update(device.TakeError());
+  }
+  return status;
+}
+
+}  // namespace pw::kvs
@@ -0,0 +1,323 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/parallel_flash_memory.h"
+
+#include <array>
+#include <cstring>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+using std::byte;
+
+constexpr size_t kSectorSize = 512;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kAlignment = 16;
+constexpr size_t kQueueDepth = 4;
+constexpr size_t kStagingBytes = 64;
+constexpr size_t kDataSize = 2 * kAlignment;
+
+// Runs operations on a FakeFlashMemory when the test calls Finish(), or as soon
+// as they start if finish_immediately is set.
+class FakeAsyncFlash final : public AsyncFlashMemoryBuffer<kQueueDepth> {
+ public:
+  FakeAsyncFlash()
+      : AsyncFlashMemoryBuffer(kSectorSize, kSectorCount, kAlignment),
+        flash(kAlignment) {}
+
+  Status Enable() override { return OkStatus(); }
+
+  Status Disable() override { return OkStatus(); }
+
+  bool IsEnabled() const override { return true; }
+
+  StatusWithSize Read(Address address, std::span<byte> output) override {
+    return flash.Read(address, output);
+  }
+
+  // Does the operation in progress and completes it with the result, or with
+  // the fake flash's result if result is OK.
+  void Finish(Status result = OkStatus()) {
+    ASSERT_TRUE(in_progress);
+    in_progress = false;
+    const Status status = erasing_ ? flash.Erase(address_, num_sectors_)
+                                   : flash.Write(address_, data_).status();
+    Complete(result.ok() ? status : result);
+  }
+
+  FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash;
+  bool finish_immediately = true;
+  bool in_progress = false;
+  size_t writes = 0;
+  size_t bytes_written = 0;
+
+ private:
+  Status DoStartErase(Address address, size_t num_sectors) override {
+    erasing_ = true;
+    address_ = address;
+    num_sectors_ = num_sectors;
+    return Start();
+  }
+
+  Status DoStartWrite(Address address, std::span<const byte> data) override {
+    erasing_ = false;
+    address_ = address;
+    data_ = data;
+    writes += 1;
+    bytes_written += data.size();
+    return Start();
+  }
+
+  Status Start() {
+    EXPECT_FALSE(in_progress);
+    in_progress = true;
+    if (finish_immediately) {
+      Finish();
+    }
+    return OkStatus();
+  }
+
+  bool erasing_ = false;
+  Address address_ = 0;
+  size_t num_sectors_ = 0;
+  std::span<const byte> data_;
+};
+
+class ParallelFlashTest : public ::testing::Test {
+ protected:
+  ParallelFlashTest() : devices_{&device_0_, &device_1_}, flash_(devices_) {
+    for (size_t i = 0; i < data_.size(); ++i) {
+      data_[i] = byte(i);
+    }
+  }
+
+  static bool HasData(FakeAsyncFlash& device,
+                      size_t address,
+                      std::span<const byte> data) {
+    return std::memcmp(device.flash.buffer().data() + address,
+                       data.data(),
+                       data.size()) == 0;
+  }
+
+  FakeAsyncFlash device_0_;
+  FakeAsyncFlash device_1_;
+  AsyncFlashMemory* const devices_[2];
+  ParallelFlashMemoryBuffer<2, kStagingBytes> flash_;
+  std::array<byte, kDataSize> data_;
+};
+
+constexpr size_t kDeviceSize = kSectorSize * kSectorCount;
+
+TEST_F(ParallelFlashTest, Geometry_DevicesFollowEachOther) {
+  EXPECT_EQ(flash_.sector_count(), 2 * kSectorCount);
+  EXPECT_EQ(flash_.sectors_per_device(), kSectorCount);
+  EXPECT_EQ(flash_.sector_size_bytes(), kSectorSize);
+
+  FlashPartition partition(&flash_);
+  EXPECT_EQ(partition.device_count(), 2u);
+  EXPECT_EQ(partition.DeviceIndex(kDeviceSize - 1), 0u);
+  EXPECT_EQ(partition.DeviceIndex(kDeviceSize), 1u);
+
+  FlashPartition second_device(&flash_, kSectorCount + 1, kSectorCount - 1);
+  EXPECT_EQ(second_device.device_count(), 1u);
+}
+
+TEST_F(ParallelFlashTest, Write_WritesToEachDevice) {
+  ASSERT_EQ(OkStatus(), flash_.Write(kAlignment, data_).status());
+  ASSERT_EQ(OkStatus(), flash_.Write(kDeviceSize + kAlignment, data_).status());
+
+  EXPECT_TRUE(HasData(device_0_, kAlignment, data_));
+  EXPECT_TRUE(HasData(device_1_, kAlignment, data_));
+
+  std::array<byte, 2 * kDataSize> read = {};
+  ASSERT_EQ(OkStatus(),
+            flash_.Read(kDeviceSize - kDataSize, read).status());
+  EXPECT_EQ(std::memcmp(read.data() + kDataSize + kAlignment,
+                        data_.data(),
+                        kDataSize - kAlignment),
+            0);
+}
+
+TEST_F(ParallelFlashTest, Write_AcrossDevices_SplitsWrite) {
+  ASSERT_EQ(OkStatus(), flash_.Write(kDeviceSize - kAlignment, data_).status());
+
+  EXPECT_TRUE(HasData(device_0_,
+                      kDeviceSize - kAlignment,
+                      std::span(data_).first(kAlignment)));
+  EXPECT_TRUE(HasData(device_1_, 0, std::span(data_).last(kAlignment)));
+}
+
+TEST_F(ParallelFlashTest, Write_OutsideParallelWrites_WaitsForError) {
+  device_1_.flash.InjectWriteError(
+      FlashError::Unconditional(Status::DataLoss(), 1));
+
+  EXPECT_EQ(Status::DataLoss(),
+            flash_.Write(kDeviceSize, data_).status());
+  EXPECT_EQ(OkStatus(), flash_.FinishParallelWrites());
+}
+
+TEST_F(ParallelFlashTest, ParallelWrites_RunAtTheSameTimeOnEachDevice) {
+  device_0_.finish_immediately = false;
+  device_1_.finish_immediately = false;
+
+  flash_.StartParallelWrites();
+  ASSERT_EQ(OkStatus(), flash_.Write(0, data_).status());
+  ASSERT_EQ(OkStatus(), flash_.Write(kDeviceSize, data_).status());
+
+  // Both writes were started without waiting for the other.
+  EXPECT_TRUE(device_0_.in_progress);
+  EXPECT_TRUE(device_1_.in_progress);
+
+  // The writes use copies of the data.
+  const std::array<byte, kDataSize> expected = data_;
+  data_.fill(byte{0});
+
+  device_0_.Finish();
+  device_1_.Finish();
+  EXPECT_EQ(OkStatus(), flash_.FinishParallelWrites());
+  EXPECT_TRUE(HasData(device_0_, 0, expected));
+  EXPECT_TRUE(HasData(device_1_, 0, expected));
+}
+
+TEST_F(ParallelFlashTest, ParallelWrites_ErrorReturnedByFinish) {
+  device_1_.finish_immediately = false;
+
+  flash_.StartParallelWrites();
+  ASSERT_EQ(OkStatus(), flash_.Write(0, data_).status());
+  ASSERT_EQ(OkStatus(), flash_.Write(kDeviceSize, data_).status());
+
+  device_1_.Finish(Status::Unavailable());
+  EXPECT_EQ(Status::Unavailable(), flash_.FinishParallelWrites());
+  EXPECT_EQ(OkStatus(), flash_.FinishParallelWrites());
+}
+
+TEST_F(ParallelFlashTest, ParallelWrites_StagingBufferFull_ReusesIt) {
+  flash_.StartParallelWrites();
+  for (size_t i = 0; i < 4 * kStagingBytes / kDataSize; ++i) {
+    data_[0] = byte(i);
+    ASSERT_EQ(OkStatus(), flash_.Write(i * kDataSize, data_).status());
+  }
+  ASSERT_EQ(OkStatus(), flash_.FinishParallelWrites());
+
+  for (size_t i = 0; i < 4 * kStagingBytes / kDataSize; ++i) {
+    EXPECT_EQ(device_0_.flash.buffer()[i * kDataSize], byte(i));
+  }
+}
+
+TEST_F(ParallelFlashTest, ParallelWrites_LargerThanStagingBuffer_Waits) {
+  std::array<byte, 2 * kStagingBytes> large;
+  large.fill(byte{0x5a});
+
+  flash_.StartParallelWrites();
+  ASSERT_EQ(OkStatus(), flash_.Write(kDeviceSize, large).status());
+  EXPECT_TRUE(HasData(device_1_, 0, large));
+  EXPECT_EQ(OkStatus(), flash_.FinishParallelWrites());
+}
+
+TEST_F(ParallelFlashTest, Erase_ErasesEachDevice) {
+  ASSERT_EQ(OkStatus(), flash_.Write(kDeviceSize - kDataSize, data_).status());
+  ASSERT_EQ(OkStatus(), flash_.Write(kDeviceSize, data_).status());
+
+  ASSERT_EQ(OkStatus(), flash_.Erase(kDeviceSize - kSectorSize, 2));
+
+  EXPECT_EQ(device_0_.flash.buffer()[kDeviceSize - kDataSize], byte{0xff});
+  EXPECT_EQ(device_1_.flash.buffer()[0], byte{0xff});
+}
+
+TEST_F(ParallelFlashTest, InvalidArguments) {
+  EXPECT_EQ(Status::InvalidArgument(), flash_.Erase(1, 1));
+  EXPECT_EQ(Status::OutOfRange(), flash_.Erase(kDeviceSize, kSectorCount + 1));
+  EXPECT_EQ(Status::OutOfRange(),
+            flash_.Write(2 * kDeviceSize - kAlignment, data_).status());
+  std::array<byte, kDataSize> read;
+  EXPECT_EQ(Status::OutOfRange(), flash_.Read(2 * kDeviceSize, read).status());
+}
+
+// A KeyValueStore with redundancy 2 on a partition spanning both devices.
+class ParallelFlashKvs : public ParallelFlashTest {
+ protected:
+  static constexpr Options kOptions{
+      .gc_on_write = GargbageCollectOnWrite::kAsManySectorsNeeded,
+      .recovery = ErrorRecovery::kLazy,
+      .verify_on_read = true,
+      .verify_on_write = false,
+  };
+
+  ParallelFlashKvs()
+      : partition_(&flash_),
+        format_{.magic = 0x600df00d, .checksum = &checksum_},
+        kvs_(&partition_, format_, kOptions) {
+    EXPECT_EQ(OkStatus(), partition_.Erase());
+    EXPECT_EQ(OkStatus(), kvs_.Init());
+  }
+
+  // Writes enough values to garbage collect several times.
+  void FillKvs() {
+    for (uint32_t i = 0; i < 64; ++i) {
+      const char key[] = {'k', char('0' + i % 8), '\0'};
+      ASSERT_EQ(OkStatus(), kvs_.Put(key, i));
+    }
+  }
+
+  void ExpectValues() {
+    for (uint32_t i = 0; i < 8; ++i) {
+      const char key[] = {'k', char('0' + i), '\0'};
+      uint32_t value = 0;
+      EXPECT_EQ(OkStatus(), kvs_.Get(key, &value));
+      EXPECT_EQ(value, 56 + i);
+    }
+  }
+
+  FlashPartition partition_;
+  ChecksumCrc16 checksum_;
+  EntryFormat format_;
+  KeyValueStoreBuffer<8, 2 * kSectorCount, 2> kvs_;
+};
+
+TEST_F(ParallelFlashKvs, Put_WritesOneCopyToEachDevice) {
+  device_0_.bytes_written = 0;
+  device_1_.bytes_written = 0;
+
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", uint32_t(1234)));
+
+  EXPECT_NE(device_0_.bytes_written, 0u);
+  EXPECT_EQ(device_0_.bytes_written, device_1_.bytes_written);
+}
+
+TEST_F(ParallelFlashKvs, FirstDeviceErased_NoDataLost) {
+  FillKvs();
+  ASSERT_EQ(OkStatus(), device_0_.flash.Erase(0, kSectorCount));
+
+  EXPECT_EQ(OkStatus(), kvs_.Init());
+  ExpectValues();
+}
+
+TEST_F(ParallelFlashKvs, SecondDeviceErased_NoDataLost) {
+  FillKvs();
+  ASSERT_EQ(OkStatus(), device_1_.flash.Erase(0, kSectorCount));
+
+  EXPECT_EQ(OkStatus(), kvs_.Init());
+  ExpectValues();
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -45,14 +45,27 @@ constexpr size_t Padding(size_t length, size_t alignment) {
 // calls an output function with aligned data as the buffer becomes full. Any
 // bytes remaining in the buffer are written to the output when Flush() is
 // called or the AlignedWriter goes out of scope.
+//
+// In kPassThrough mode, spans passed to Write that are at least as large as
+// the buffer are written to the output directly, rather than in buffer-sized
+// chunks. Only the unaligned head and tail of the span are buffered. This
+// reduces the number of output writes for large values, but the output must
+// accept data from anywhere in memory, not only from the buffer.
 class AlignedWriter {
  public:
+  enum class Mode {
+    kBuffered,
+    kPassThrough,
+  };
+
   AlignedWriter(std::span<std::byte> buffer,
                 size_t alignment_bytes,
-                Output& writer)
+                Output& writer,
+                Mode mode = Mode::kBuffered)
       : buffer_(buffer.data()),
         write_size_(AlignDown(buffer.size(), alignment_bytes)),
         alignment_bytes_(alignment_bytes),
+        mode_(mode),
         output_(writer),
         bytes_written_(0),
         bytes_in_buffer_(0) {
@@ -87,11 +100,19 @@ class AlignedWriter {
  private:
   static constexpr std::byte kPadByte = static_cast<std::byte>(0);
 
+  // Writes the span directly to the output in kPassThrough mode, if it is
+  // large enough. Returns the number of bytes of data that were consumed.
+  StatusWithSize WritePassThrough(std::span<const std::byte> data);
+
   StatusWithSize AddBytesToBuffer(size_t bytes_added);
 
+  // Writes aligned data to the output and adds it to bytes_written_.
+  StatusWithSize WriteToOutput(std::span<const std::byte> data);
+
   std::byte* const buffer_;
   const size_t write_size_;
   const size_t alignment_bytes_;
+  const Mode mode_;
 
   Output& output_;
   size_t bytes_written_;
@@ -112,16 +133,18 @@ class AlignedWriterBuffer : public AlignedWriter {
 
 // Writes data from multiple buffers using an AlignedWriter.
 template <size_t kBufferSize>
-StatusWithSize AlignedWrite(Output& output,
-                            size_t alignment_bytes,
-                            std::span<const std::span<const std::byte>> data) {
+StatusWithSize AlignedWrite(
+    Output& output,
+    size_t alignment_bytes,
+    std::span<const std::span<const std::byte>> data,
+    AlignedWriter::Mode mode = AlignedWriter::Mode::kBuffered) {
   // TODO: This should convert to PW_CHECK once that is available for use in
   // host tests.
   if (alignment_bytes > kBufferSize) {
     return StatusWithSize::Internal();
   }
 
-  AlignedWriterBuffer<kBufferSize> buffer(alignment_bytes, output);
+  AlignedWriterBuffer<kBufferSize> buffer(alignment_bytes, output, mode);
 
   for (const std::span<const std::byte>& chunk : data) {
     StatusWithSize result = buffer.Write(chunk);
@@ -138,11 +161,13 @@ template <size_t kBufferSize>
 StatusWithSize AlignedWrite(
     Output& output,
     size_t alignment_bytes,
-    std::initializer_list<std::span<const std::byte>> data) {
+    std::initializer_list<std::span<const std::byte>> data,
+    AlignedWriter::Mode mode = AlignedWriter::Mode::kBuffered) {
   return AlignedWrite<kBufferSize>(
       output,
       alignment_bytes,
-      std::span<const ConstByteSpan>(data.begin(), data.size()));
+      std::span<const ConstByteSpan>(data.begin(), data.size()),
+      mode);
 }
 
 }  // namespace pw
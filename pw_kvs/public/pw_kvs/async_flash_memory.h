@@ -0,0 +1,359 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+
+#include "pw_function/function.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+
+namespace pw::kvs {
+
+// Flash memory that erases and writes in the background. A FlashMemory erase
+// blocks its caller for as long as the hardware takes, which may be tens of
+// milliseconds. AsyncFlashMemory instead queues the operation, returns
+// immediately, and calls the operation's callback when it is done. Operations
+// run one at a time, in the order they were queued.
+//
+// Drivers implement DoStartErase() and DoStartWrite() to start an operation,
+// and call Complete() when it finishes. Complete() runs the callback and starts
+// the next queued operation in the calling context. Drivers whose flash signals
+// completion with an interrupt should call it from a thread or work queue, not
+// from the interrupt handler. Reads are short, so they remain synchronous.
+//
+// Operations may be queued from any thread.
+class AsyncFlashMemory {
+ public:
+  using Address = FlashMemory::Address;
+
+  // Called with the result of a queued operation.
+  using Callback = Function<void(Status)>;
+
+  // Storage for a queued operation. Drivers provide an array of these, which
+  // sets how many operations can be queued.
+  class Operation {
+   public:
+    constexpr Operation() = default;
+
+   private:
+    friend class AsyncFlashMemory;
+
+    enum class Type : bool { kErase, kWrite };
+
+    Type type_ = Type::kErase;
+    Address address_ = 0;
+    size_t num_sectors_ = 0;
+    std::span<const std::byte> data_;
+    Callback callback_;
+  };
+
+  AsyncFlashMemory(std::span<Operation> queue,
+                   size_t sector_size,
+                   size_t sector_count,
+                   size_t alignment,
+                   uint32_t start_address = 0,
+                   uint32_t sector_start = 0,
+                   std::byte erased_memory_content = std::byte(0xFF))
+      : sector_size_(sector_size),
+        flash_sector_count_(sector_count),
+        alignment_(alignment),
+        start_address_(start_address),
+        start_sector_(sector_start),
+        erased_memory_content_(erased_memory_content),
+        queue_(queue),
+        head_(0),
+        count_(0),
+        running_(false),
+        starting_(false),
+        in_progress_(false) {
+    PW_ASSERT(alignment_ != 0u);
+    PW_ASSERT(!queue_.empty());
+  }
+
+  AsyncFlashMemory(const AsyncFlashMemory&) = delete;
+  AsyncFlashMemory& operator=(const AsyncFlashMemory&) = delete;
+
+  virtual ~AsyncFlashMemory() = default;
+
+  virtual Status Enable() = 0;
+
+  virtual Status Disable() = 0;
+
+  virtual bool IsEnabled() const = 0;
+
+  // Queues an erase of num_sectors starting at a given address. on_done is
+  // called with the result of the erase. Returns:
+  //
+  // OK - the erase is queued.
+  // INVALID_ARGUMENT - address is not sector-aligned.
+  // OUT_OF_RANGE - erases past the end of the memory.
+  // RESOURCE_EXHAUSTED - the queue is full.
+  Status Erase(Address flash_address,
+               size_t num_sectors,
+               Callback&& on_done);
+
+  // Queues a write of data to flash. The data must remain valid until on_done
+  // is called with the result of the write. Returns:
+  //
+  // OK - the write is queued.
+  // INVALID_ARGUMENT - address or data size are not aligned.
+  // OUT_OF_RANGE - write does not fit in the memory.
+  // RESOURCE_EXHAUSTED - the queue is full.
+  Status Write(Address destination_flash_address,
+               std::span<const std::byte> data,
+               Callback&& on_done);
+
+  // Reads bytes from flash into buffer. Blocking call, which drivers must
+  // support while an erase or write is in progress. Returns:
+  //
+  // OK - success
+  // DEADLINE_EXCEEDED - timeout
+  // OUT_OF_RANGE - read does not fit in the flash memory
+  virtual StatusWithSize Read(Address address, std::span<std::byte> output) = 0;
+
+  // Convert an Address to an MCU pointer, this can be used for memory
+  // mapped reads. Return NULL if the memory is not memory mapped.
+  virtual std::byte* FlashAddressToMcuAddress(Address) const { return nullptr; }
+
+  // The number of queued operations, including the one in progress.
+  size_t pending_operations() const {
+    std::lock_guard lock(lock_);
+    return count_;
+  }
+
+  constexpr uint32_t start_sector() const { return start_sector_; }
+
+  constexpr size_t sector_size_bytes() const { return sector_size_; }
+
+  constexpr size_t sector_count() const { return flash_sector_count_; }
+
+  constexpr size_t alignment_bytes() const { return alignment_; }
+
+  constexpr size_t size_bytes() const {
+    return sector_size_ * flash_sector_count_;
+  }
+
+  constexpr uint32_t start_address() const { return start_address_; }
+
+  constexpr std::byte erased_memory_content() const {
+    return erased_memory_content_;
+  }
+
+ protected:
+  // Called by the driver when the operation it started finishes. May be called
+  // from within DoStartErase() or DoStartWrite() by drivers that finish
+  // immediately.
+  void Complete(Status status);
+
+ private:
+  // Starts an erase or write in hardware. Only one operation is started at a
+  // time. An error fails the operation, and its callback is called with it.
+  virtual Status DoStartErase(Address flash_address, size_t num_sectors) = 0;
+
+  virtual Status DoStartWrite(Address destination_flash_address,
+                              std::span<const std::byte> data) = 0;
+
+  Status Enqueue(Operation::Type type,
+                 Address address,
+                 size_t num_sectors,
+                 std::span<const std::byte> data,
+                 Callback&& on_done);
+
+  // Starts queued operations until one is in progress or the queue is empty.
+  void RunQueue();
+
+  Callback PopFront() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  Operation& front() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    return queue_[head_];
+  }
+
+  const uint32_t sector_size_;
+  const uint32_t flash_sector_count_;
+  const uint32_t alignment_;
+  const uint32_t start_address_;
+  const uint32_t start_sector_;
+  const std::byte erased_memory_content_;
+
+  mutable sync::InterruptSpinLock lock_;
+  const std::span<Operation> queue_;
+  size_t head_ PW_GUARDED_BY(lock_);
+  size_t count_ PW_GUARDED_BY(lock_);
+
+  // A context is working through the queue.
+  bool running_ PW_GUARDED_BY(lock_);
+
+  // RunQueue() is calling DoStartErase() or DoStartWrite().
+  bool starting_ PW_GUARDED_BY(lock_);
+
+  // The front operation was started and has not completed.
+  bool in_progress_ PW_GUARDED_BY(lock_);
+};
+
+// Helper for declaring an AsyncFlashMemory driver with its queue.
+//
+//   class MyFlash final : public AsyncFlashMemoryBuffer<4> { ... };
+//
+template <size_t kQueueDepth>
+class AsyncFlashMemoryBuffer : public AsyncFlashMemory {
+ public:
+  AsyncFlashMemoryBuffer(size_t sector_size,
+                         size_t sector_count,
+                         size_t alignment,
+                         uint32_t start_address = 0,
+                         uint32_t sector_start = 0,
+                         std::byte erased_memory_content = std::byte(0xFF))
+      : AsyncFlashMemory(queue_,
+                         sector_size,
+                         sector_count,
+                         alignment,
+                         start_address,
+                         sector_start,
+                         erased_memory_content) {}
+
+ private:
+  std::array<Operation, kQueueDepth> queue_;
+};
+
+// A partition of an AsyncFlashMemory, with the same addressing and checks as
+// FlashPartition.
+class AsyncFlashPartition {
+ public:
+  // The flash address is in the range of: 0 to PartitionSize.
+  using Address = uint32_t;
+
+  using Callback = AsyncFlashMemory::Callback;
+
+  AsyncFlashPartition(
+      AsyncFlashMemory* flash,
+      uint32_t start_sector_index,
+      uint32_t sector_count,
+      uint32_t alignment_bytes = 0,  // Defaults to flash alignment
+      PartitionPermission permission = PartitionPermission::kReadAndWrite);
+
+  // Creates an AsyncFlashPartition that uses the entire flash with its
+  // alignment.
+  AsyncFlashPartition(AsyncFlashMemory* flash)
+      : AsyncFlashPartition(
+            flash, 0, flash->sector_count(), flash->alignment_bytes()) {}
+
+  AsyncFlashPartition(const AsyncFlashPartition&) = delete;
+  AsyncFlashPartition& operator=(const AsyncFlashPartition&) = delete;
+
+  // Queues an erase of num_sectors starting at a given address, which must be
+  // on a sector boundary. Returns:
+  //
+  // OK - the erase is queued; on_done is called with its result.
+  // OUT_OF_RANGE - address or sector count is invalid.
+  // PERMISSION_DENIED - partition is read only.
+  // RESOURCE_EXHAUSTED - the flash's queue is full.
+  Status Erase(Address address, size_t num_sectors, Callback&& on_done);
+
+  // Queues a write of data to flash. Address and data.size_bytes() must both
+  // be a multiple of alignment_bytes(), and the data must remain valid until
+  // on_done is called. Returns:
+  //
+  // OK - the write is queued; on_done is called with its result.
+  // OUT_OF_RANGE - address or length is invalid.
+  // PERMISSION_DENIED - partition is read only.
+  // RESOURCE_EXHAUSTED - the flash's queue is full.
+  Status Write(Address address,
+               std::span<const std::byte> data,
+               Callback&& on_done);
+
+  // Reads bytes from flash into buffer. Blocking call.
+  StatusWithSize Read(Address address, std::span<std::byte> output);
+
+  size_t sector_size_bytes() const { return flash_.sector_size_bytes(); }
+
+  size_t size_bytes() const { return sector_count() * sector_size_bytes(); }
+
+  size_t alignment_bytes() const { return alignment_bytes_; }
+
+  size_t sector_count() const { return sector_count_; }
+
+  bool writable() const {
+    return permission_ == PartitionPermission::kReadAndWrite;
+  }
+
+  std::byte erased_memory_content() const {
+    return flash_.erased_memory_content();
+  }
+
+  uint32_t start_sector_index() const { return start_sector_index_; }
+
+ private:
+  Status CheckBounds(Address address, size_t len) const;
+
+  AsyncFlashMemory::Address PartitionToFlashAddress(Address address) const {
+    return flash_.start_address() +
+           (start_sector_index_ - flash_.start_sector()) * sector_size_bytes() +
+           address;
+  }
+
+  AsyncFlashMemory& flash_;
+  const uint32_t start_sector_index_;
+  const uint32_t sector_count_;
+  const uint32_t alignment_bytes_;
+  const PartitionPermission permission_;
+};
+
+// Adapts an AsyncFlashMemory to the blocking FlashMemory interface, so that
+// FlashPartition and everything built on it, such as KeyValueStore and
+// BlobStore, can use it unchanged. Erase() and Write() queue the operation and
+// wait for it to finish, so they must not be called from the context that
+// calls the driver's Complete().
+class BlockingFlashMemory final : public FlashMemory {
+ public:
+  BlockingFlashMemory(AsyncFlashMemory& flash)
+      : FlashMemory(flash.sector_size_bytes(),
+                    flash.sector_count(),
+                    flash.alignment_bytes(),
+                    flash.start_address(),
+                    flash.start_sector(),
+                    flash.erased_memory_content()),
+        flash_(flash) {}
+
+  Status Enable() override { return flash_.Enable(); }
+
+  Status Disable() override { return flash_.Disable(); }
+
+  bool IsEnabled() const override { return flash_.IsEnabled(); }
+
+  Status Erase(Address flash_address, size_t num_sectors) override;
+
+  StatusWithSize Read(Address address, std::span<std::byte> output) override {
+    return flash_.Read(address, output);
+  }
+
+  StatusWithSize Write(Address destination_flash_address,
+                       std::span<const std::byte> data) override;
+
+  std::byte* FlashAddressToMcuAddress(Address address) const override {
+    return flash_.FlashAddressToMcuAddress(address);
+  }
+
+ private:
+  AsyncFlashMemory& flash_;
+};
+
+}  // namespace pw::kvs
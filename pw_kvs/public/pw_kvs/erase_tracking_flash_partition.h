@@ -0,0 +1,113 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_kvs/flash_memory.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pw::kvs {
+
+// A FlashPartition that remembers which pages it knows to be erased, so that
+// IsRegionErased can answer without reading flash. It may be used in place of a
+// FlashPartition by any store, such as KeyValueStore or BlobStore.
+//
+// Each sector is divided into pages, with one bit per page. Erase marks the
+// erased pages, and Write clears the pages it touches. IsRegionErased only
+// reads pages that are not known to be erased, and marks those it finds erased.
+// Nothing is known at first, so the first check of a region reads it.
+//
+// Pages are the unit of tracking, so a write anywhere in a page means that page
+// is read by the next check. More pages per sector take more RAM but keep the
+// rest of a partly written sector known.
+//
+// Changes to the flash made other than through this partition are not seen;
+// call ForgetErasedState after them. This class is not thread safe.
+class EraseTrackingFlashPartition : public FlashPartition {
+ public:
+  using FlashPartition::Erase;
+
+  Status Erase(Address address, size_t num_sectors) override;
+
+  StatusWithSize Write(Address address,
+                       std::span<const std::byte> data) override;
+
+  // Returns the same results as FlashPartition::IsRegionErased, reading only
+  // the pages not known to be erased.
+  Status IsRegionErased(Address source_flash_address,
+                        size_t length,
+                        bool* is_erased) override;
+
+  // Marks every page as not known to be erased.
+  void ForgetErasedState();
+
+  size_t page_size_bytes() const { return page_size_; }
+
+ protected:
+  EraseTrackingFlashPartition(
+      std::span<uint32_t> erased_pages,
+      size_t pages_per_sector,
+      FlashMemory* flash,
+      uint32_t start_sector_index,
+      uint32_t sector_count,
+      uint32_t alignment_bytes = 0,  // Defaults to flash alignment
+      PartitionPermission permission = PartitionPermission::kReadAndWrite);
+
+ private:
+  static constexpr size_t kBitsPerWord = 32;
+
+  bool PageErased(size_t page) const {
+    return (erased_pages_[page / kBitsPerWord] >> (page % kBitsPerWord)) & 1u;
+  }
+
+  // Sets or clears the bits for pages [first_page, end_page).
+  void SetPages(size_t first_page, size_t end_page, bool erased);
+
+  // Bit N is set if page N is known to be erased.
+  const std::span<uint32_t> erased_pages_;
+  const size_t page_size_;
+};
+
+template <size_t kMaxSectors, size_t kPagesPerSector = 1>
+class EraseTrackingFlashPartitionBuffer : public EraseTrackingFlashPartition {
+ public:
+  EraseTrackingFlashPartitionBuffer(
+      FlashMemory* flash,
+      uint32_t start_sector_index,
+      uint32_t sector_count,
+      uint32_t alignment_bytes = 0,  // Defaults to flash alignment
+      PartitionPermission permission = PartitionPermission::kReadAndWrite)
+      : EraseTrackingFlashPartition(erased_pages_,
+                                    kPagesPerSector,
+                                    flash,
+                                    start_sector_index,
+                                    sector_count,
+                                    alignment_bytes,
+                                    permission) {}
+
+  EraseTrackingFlashPartitionBuffer(FlashMemory* flash)
+      : EraseTrackingFlashPartitionBuffer(
+            flash, 0, flash->sector_count(), flash->alignment_bytes()) {}
+
+ private:
+  std::array<uint32_t, (kMaxSectors * kPagesPerSector + 31) / 32>
+      erased_pages_ = {};
+};
+
+}  // namespace pw::kvs
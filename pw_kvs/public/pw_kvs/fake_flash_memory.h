@@ -16,9 +16,11 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <span>
 
+#include "pw_assert/assert.h"
 #include "pw_containers/vector.h"
 #include "pw_kvs/flash_memory.h"
 #include "pw_status/status.h"
@@ -75,6 +77,36 @@ class FlashError {
   size_t remaining_;
 };
 
+// Approximate costs of flash operations on a real device, taken from its
+// datasheet. FakeFlashMemory adds them up as it runs, so host tests and
+// benchmarks can estimate how long a workload would take on the device and how
+// much energy it would use. Costs that are left zero are not counted.
+struct FlashTimingModel {
+  // Writes are programmed in pages of this size. A write that covers part of a
+  // page costs a whole page.
+  size_t program_page_bytes = 256;
+  uint32_t page_program_ns = 0;
+  uint32_t page_program_nj = 0;
+
+  uint32_t sector_erase_ns = 0;
+  uint32_t sector_erase_nj = 0;
+
+  // Each read costs a fixed setup time plus a cost per KiB read.
+  uint32_t read_setup_ns = 0;
+  uint32_t read_ns_per_kib = 0;
+  uint32_t read_nj_per_kib = 0;
+};
+
+// Operations done by a FakeFlashMemory, and their cost under its timing model.
+struct FlashCosts {
+  size_t reads;
+  size_t bytes_read;
+  size_t pages_programmed;
+  size_t sectors_erased;
+  uint64_t time_ns;
+  uint64_t energy_nj;
+};
+
 // This uses a buffer to mimic the behaviour of flash (requires erase before
 // write, checks alignments, and is addressed in sectors). The underlying buffer
 // is not initialized.
@@ -94,7 +126,8 @@ class FakeFlashMemory : public FlashMemory {
       : FlashMemory(sector_size, sector_count, alignment_bytes),
         buffer_(buffer),
         read_errors_(read_errors),
-        write_errors_(write_errors) {}
+        write_errors_(write_errors),
+        costs_{} {}
 
   // The fake flash is always enabled.
   Status Enable() override { return OkStatus(); }
@@ -137,12 +170,26 @@ class FakeFlashMemory : public FlashMemory {
     return true;
   }
 
+  // Sets the costs that operations are counted with from now on.
+  void set_timing_model(const FlashTimingModel& timing) {
+    PW_ASSERT(timing.program_page_bytes != 0u);
+    timing_ = timing;
+  }
+
+  // The operations done and their total cost since the last ResetCosts().
+  const FlashCosts& costs() const { return costs_; }
+
+  void ResetCosts() { costs_ = {}; }
+
  private:
   static inline Vector<FlashError, 0> no_errors_;
 
   const std::span<std::byte> buffer_;
   Vector<FlashError>& read_errors_;
   Vector<FlashError>& write_errors_;
+
+  FlashTimingModel timing_;
+  FlashCosts costs_;
 };
 
 // Creates an FakeFlashMemory backed by a std::array. The array is initialized
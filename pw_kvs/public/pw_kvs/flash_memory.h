@@ -22,6 +22,7 @@
 #include "pw_kvs/alignment.h"
 #include "pw_status/status.h"
 #include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
 
 namespace pw {
 namespace kvs {
@@ -104,6 +105,21 @@ class FlashMemory {
   // mapped reads. Return NULL if the memory is not memory mapped.
   virtual std::byte* FlashAddressToMcuAddress(Address) const { return nullptr; }
 
+  // Flash made of several devices that write in the background, such as
+  // ParallelFlashMemory, may return from Write before the data is written
+  // between StartParallelWrites() and FinishParallelWrites(), so that writes to
+  // different devices overlap. FinishParallelWrites() waits for those writes
+  // and returns the first error from them. Other flash always writes before
+  // returning, and ignores these calls.
+  virtual void StartParallelWrites() {}
+
+  virtual Status FinishParallelWrites() { return OkStatus(); }
+
+  // The number of sectors in each device that can be written in parallel with,
+  // and fails independently of, the others. Flash with a single device returns
+  // sector_count().
+  virtual size_t sectors_per_device() const { return sector_count(); }
+
   // start_sector() is useful for FlashMemory instances where the
   // sector start is not 0. (ex.: cases where there are portions of flash
   // that should be handled independently).
@@ -166,6 +182,31 @@ class FlashPartition {
     FlashPartition::Address address_;
   };
 
+  // Reads the partition as a stream that can seek, for example to skip over
+  // parts of a structured image without reading them.
+  class Reader final : public stream::SeekableReader {
+   public:
+    constexpr Reader(FlashPartition& partition)
+        : partition_(partition), position_(0) {}
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    size_t ConservativeReadLimit() const override {
+      return partition_.size_bytes() - position_;
+    }
+
+   private:
+    StatusWithSize DoRead(std::span<std::byte> data) override;
+
+    Status DoSeek(ptrdiff_t offset, stream::Whence origin) override;
+
+    size_t DoTell() const override { return position_; }
+
+    FlashPartition& partition_;
+    size_t position_;
+  };
+
   FlashPartition(
       FlashMemory* flash,
       uint32_t start_sector_index,
@@ -285,6 +326,27 @@ class FlashPartition {
 
   uint32_t start_sector_index() const { return start_sector_index_; }
 
+  // Lets writes to different flash devices overlap until
+  // FinishParallelWrites(). See FlashMemory::StartParallelWrites().
+  void StartParallelWrites() { flash_.StartParallelWrites(); }
+
+  // Waits for the writes since StartParallelWrites() and returns the first
+  // error from them.
+  Status FinishParallelWrites() { return flash_.FinishParallelWrites(); }
+
+  // The index of the flash device that holds the address, counted from the
+  // partition's first device. Addresses on different devices can be written in
+  // parallel, and fail independently.
+  size_t DeviceIndex(Address address) const {
+    const size_t first_sector = start_sector_index_ - flash_.start_sector();
+    return (first_sector + address / sector_size_bytes()) /
+               flash_.sectors_per_device() -
+           first_sector / flash_.sectors_per_device();
+  }
+
+  // The number of flash devices the partition spans.
+  size_t device_count() const { return DeviceIndex(size_bytes() - 1) + 1; }
+
  protected:
   Status CheckBounds(Address address, size_t len) const;
 
@@ -78,6 +78,17 @@ class EntryFormats {
 
 }  // namespace internal
 
+// How the values of key-value entries are stored.
+enum class ValueCompression : uint8_t {
+  // Values are stored as they are.
+  kNone,
+
+  // Values are compressed with a small LZ77-style codec with a 256-byte
+  // window, which suits short, repetitive values such as text configuration.
+  // See pw_kvs/internal/compression.h.
+  kLz,
+};
+
 // The EntryFormat defines properties of KVS entries that use a particular magic
 // number.
 struct EntryFormat {
@@ -103,6 +114,10 @@ struct EntryFormat {
   // The checksum algorithm is used to calculate checksums for KVS entries. If
   // it is null, no checksum is used.
   ChecksumAlgorithm* checksum;
+
+  // How values are stored. The checksum is of the stored value. Compression is
+  // part of the format, so changing it requires a new magic.
+  ValueCompression compression = ValueCompression::kNone;
 };
 
 }  // namespace kvs
@@ -0,0 +1,189 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
+
+namespace pw::kvs::internal {
+
+// Values in entry formats with ValueCompression::kLz are stored as the size of
+// the original value, as a little-endian uint16_t, followed by tokens:
+//
+//   0lllllll <l + 1 bytes>  A run of l + 1 literal bytes.
+//   1lllllll dddddddd       A copy of l + 3 bytes that start d + 1 bytes back.
+//
+// Copies only refer to the previous 256 bytes, so values of any size are
+// compressed and decompressed with a fixed amount of RAM. A copy may overlap
+// the bytes it produces, which repeats a short pattern.
+inline constexpr size_t kLzWindowBytes = 256;
+inline constexpr size_t kLzMinCopyBytes = 3;
+inline constexpr size_t kLzMaxCopyBytes = 0x7f + kLzMinCopyBytes;
+inline constexpr size_t kLzMaxLiteralBytes = 0x7f + 1;
+inline constexpr size_t kLzHeaderBytes = sizeof(uint16_t);
+
+// The largest value that can be compressed.
+inline constexpr size_t kLzMaxValueBytes = 0xfffe;
+
+// Reads a value from a stream and produces it compressed. The value is
+// compressed as it is read, so neither the value nor the compressed value is
+// ever in memory all at once. Seeking back to the start compresses the value
+// again, from where the source was when the compressor was created; the
+// compressor cannot seek anywhere else.
+//
+// Matches are found with a single-entry hash table of recent positions, which
+// is fast and deterministic rather than optimal. The compressor uses about
+// 1.2 KiB of RAM.
+class LzCompressor final : public stream::SeekableReader {
+ public:
+  // Compresses size_bytes from the source, which must be at most
+  // kLzMaxValueBytes.
+  LzCompressor(stream::SeekableReader& source, size_t size_bytes);
+
+  LzCompressor(const LzCompressor&) = delete;
+  LzCompressor& operator=(const LzCompressor&) = delete;
+
+  // Compresses the whole value to find the size of the compressed value, then
+  // returns to the start. Returns DATA_LOSS if the source has fewer bytes than
+  // the value, or the source's error.
+  StatusWithSize CompressedSize();
+
+ private:
+  struct Match {
+    size_t length;
+    size_t distance;
+  };
+
+  StatusWithSize DoRead(ByteSpan dest) override;
+
+  Status DoSeek(ptrdiff_t offset, stream::Whence origin) override;
+
+  size_t DoTell() const override { return position_; }
+
+  Status Reset();
+
+  // Encodes the next token into token_. Returns OUT_OF_RANGE at the end of the
+  // value.
+  Status NextToken();
+
+  // Reads from the source so that the longest possible copy from the input
+  // position is in the buffer.
+  Status Fill();
+
+  // Finds the longest copy for the input position and adds the position to the
+  // hash table.
+  Match FindMatch();
+
+  // Adds a position to the hash table, if its first bytes are in the buffer.
+  void Insert(size_t position);
+
+  std::byte at(size_t position) const {
+    return buffer_[position - buffer_start_];
+  }
+
+  stream::SeekableReader& source_;
+  const size_t source_start_;
+  const size_t size_bytes_;
+  Status status_;
+
+  // The position of the next byte of the value to encode.
+  size_t input_position_;
+
+  // The compressed bytes produced so far.
+  size_t position_;
+
+  // Bytes of the value from at least kLzWindowBytes before the input position.
+  std::array<std::byte, 2 * kLzWindowBytes> buffer_;
+  size_t buffer_start_;
+  size_t buffer_end_;
+
+  // The most recent position plus one for each hash of three bytes, or zero.
+  std::array<uint16_t, 256> recent_;
+
+  // A copy found while encoding literals, which starts the next token.
+  Match pending_;
+
+  // The encoded token that is being read.
+  std::array<std::byte, 1 + kLzMaxLiteralBytes> token_;
+  size_t token_size_;
+  size_t token_read_;
+};
+
+// Reads a compressed value from a stream and produces the original value.
+// Seeking forward decompresses and discards the bytes in between, and seeking
+// backward starts again from the beginning. The decompressor uses about 300 B
+// of RAM.
+class LzDecompressor final : public stream::SeekableReader {
+ public:
+  // Decompresses a compressed value of compressed_size_bytes that starts at the
+  // source's position.
+  LzDecompressor(stream::SeekableReader& source, size_t compressed_size_bytes);
+
+  LzDecompressor(const LzDecompressor&) = delete;
+  LzDecompressor& operator=(const LzDecompressor&) = delete;
+
+  // Returns the size of the original value, or DATA_LOSS if the compressed
+  // value is too short to hold it.
+  StatusWithSize DecompressedSize();
+
+  size_t ConservativeReadLimit() const override;
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override;
+
+  Status DoSeek(ptrdiff_t offset, stream::Whence origin) override;
+
+  size_t DoTell() const override { return position_; }
+
+  Status Reset();
+
+  Status ReadHeader();
+
+  // Reads the next byte of the compressed value. Returns DATA_LOSS if there are
+  // no more.
+  Status ReadByte(std::byte& value);
+
+  stream::SeekableReader& source_;
+  const size_t source_start_;
+  const size_t compressed_size_bytes_;
+  Status status_;
+
+  // The bytes of the compressed value that have been read from the source, and
+  // the unused part of the input buffer.
+  size_t compressed_read_;
+  std::array<std::byte, 32> input_;
+  size_t input_start_;
+  size_t input_end_;
+
+  bool header_read_;
+  size_t size_bytes_;
+
+  // The bytes of the original value produced so far.
+  size_t position_;
+
+  // The state of the current token.
+  size_t literals_remaining_;
+  size_t copy_remaining_;
+  size_t copy_distance_;
+
+  // The last kLzWindowBytes bytes produced, indexed by position.
+  std::array<std::byte, kLzWindowBytes> window_;
+};
+
+}  // namespace pw::kvs::internal
@@ -28,6 +28,8 @@
 #include "pw_kvs/internal/hash.h"
 #include "pw_kvs/internal/key_descriptor.h"
 #include "pw_kvs/key.h"
+#include "pw_result/result.h"
+#include "pw_stream/stream.h"
 
 namespace pw {
 namespace kvs {
@@ -55,6 +57,17 @@ class Entry {
                      const internal::EntryFormats& formats,
                      Entry* entry);
 
+  // Reads an entry like Read, along with as much of its key and value as fit
+  // in the buffer, with a single flash read the size of the buffer (up to the
+  // end of the sector). Returns the number of bytes of the entry that are in
+  // the buffer, starting with the header. Buffers smaller than a header are not
+  // used, and 0 is returned.
+  static StatusWithSize Read(FlashPartition& partition,
+                             Address address,
+                             const internal::EntryFormats& formats,
+                             Entry* entry,
+                             std::span<std::byte> buffer);
+
   // Reads a key into a buffer, which must be at least key_length bytes.
   static Status ReadKey(FlashPartition& partition,
                         Address address,
@@ -72,6 +85,19 @@ class Entry {
         partition, address, format, key, value, value.size(), transaction_id);
   }
 
+  // Creates a new Entry for a valid entry whose value is read from a stream.
+  // The checksum is calculated from value_size_bytes bytes of the reader,
+  // which is then returned to where it started, so that the value can be read
+  // again by Write(key, reader). Returns OUT_OF_RANGE if the reader has fewer
+  // bytes, or the reader's error.
+  static Result<Entry> Valid(FlashPartition& partition,
+                             Address address,
+                             const EntryFormat& format,
+                             Key key,
+                             stream::SeekableReader& value,
+                             size_t value_size_bytes,
+                             uint32_t transaction_id);
+
   // Creates a new Entry for a tombstone entry, which marks a deleted key.
   static Entry Tombstone(FlashPartition& partition,
                          Address address,
@@ -99,9 +125,24 @@ class Entry {
 
   StatusWithSize Write(Key key, std::span<const std::byte> value) const;
 
+  // Writes this entry, reading the value from a stream in chunks as it is
+  // written, so the value never needs to be in memory all at once. The value is
+  // checksummed as it is written; if it does not match the checksum from
+  // Valid(), the entry in flash is invalid and DATA_LOSS is returned.
+  StatusWithSize Write(Key key, stream::Reader& value) const;
+
+  // Writes this entry, including its padding, with an existing AlignedWriter.
+  // This allows writing consecutive entries with one writer, which combines
+  // them into fewer flash writes. The writer must be at this entry's address.
+  Status Write(AlignedWriter& writer,
+               Key key,
+               std::span<const std::byte> value) const;
+
   // Changes the format and transcation ID for this entry. In order to calculate
   // the new checksum, the entire entry is read into a small stack-allocated
   // buffer. The updated entry may be written to flash using the Copy function.
+  // The value is copied as it is, so if the entry has a value, the new format
+  // must compress values in the same way.
   Status Update(const EntryFormat& new_format, uint32_t new_transaction_id);
 
   // Writes this entry at a new address. The key and value are read from the
@@ -119,9 +160,23 @@ class Entry {
         ReadKey(partition(), address_, key_length(), key.data()), key_length());
   }
 
+  // Reads the value, starting at an offset, into a buffer. Any part of the
+  // value in read_ahead, the start of the entry as read by Read() with a
+  // buffer, is copied from there instead of read from flash.
   StatusWithSize ReadValue(std::span<std::byte> buffer,
+                           size_t offset_bytes = 0,
+                           std::span<const std::byte> read_ahead = {}) const;
+
+  // Reads the value, starting at an offset, into a stream through a small
+  // buffer. Returns the number of bytes written to the stream.
+  StatusWithSize ReadValue(stream::Writer& writer,
                            size_t offset_bytes = 0) const;
 
+  // The address of the value, which follows the header and key.
+  Address value_address() const {
+    return address_ + sizeof(EntryHeader) + key_length();
+  }
+
   Status ValueMatches(std::span<const std::byte> value) const;
 
   Status VerifyChecksum(Key key, std::span<const std::byte> value) const;
@@ -132,7 +187,13 @@ class Entry {
   static size_t size(const FlashPartition& partition,
                      Key key,
                      std::span<const std::byte> value) {
-    return AlignUp(sizeof(EntryHeader) + key.size() + value.size(),
+    return size(partition, key, value.size());
+  }
+
+  static size_t size(const FlashPartition& partition,
+                     Key key,
+                     size_t value_size_bytes) {
+    return AlignUp(sizeof(EntryHeader) + key.size() + value_size_bytes,
                    std::max(partition.alignment_bytes(), kMinAlignmentBytes));
   }
 
@@ -168,6 +229,16 @@ class Entry {
     return header_.value_size_bytes == kDeletedValueLength;
   }
 
+  // How values are stored in this entry's format.
+  ValueCompression compression() const { return compression_; }
+
+  // True if the stored value is compressed. Only the values of key-value
+  // entries are compressed, not those of metadata entries, which have no key.
+  bool compressed() const {
+    return compression_ != ValueCompression::kNone && key_length() != 0u &&
+           !deleted();
+  }
+
   void DebugLog() const;
 
  private:
@@ -188,8 +259,23 @@ class Entry {
       : partition_(partition),
         address_(address),
         checksum_algo_(format.checksum),
+        compression_(format.compression),
         header_(header) {}
 
+  // Initializes an Entry from a header read from flash. Returns NOT_FOUND or
+  // DATA_LOSS as Read() does.
+  static Status FromHeader(FlashPartition& partition,
+                           Address address,
+                           const internal::EntryFormats& formats,
+                           const EntryHeader& header,
+                           Entry* entry);
+
+  static EntryHeader CreateHeader(const FlashPartition& partition,
+                                  const EntryFormat& format,
+                                  Key key,
+                                  uint16_t value_size_bytes,
+                                  uint32_t transaction_id);
+
   FlashPartition& partition() const { return *partition_; }
 
   size_t alignment_bytes() const { return (header_.alignment_units + 1) * 16; }
@@ -218,6 +304,7 @@ class Entry {
   FlashPartition* partition_;
   Address address_;
   ChecksumAlgorithm* checksum_algo_;
+  ValueCompression compression_;
   EntryHeader header_;
 };
 
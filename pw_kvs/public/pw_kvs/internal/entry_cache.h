@@ -15,6 +15,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <span>
 #include <type_traits>
 
@@ -80,6 +81,57 @@ class EntryMetadata {
   std::span<Address> addresses_;
 };
 
+// Optionally keeps the keys of the KeyDescriptors in RAM, so that they can be
+// compared and listed without reading flash. Keys are packed into an arena as a
+// length byte followed by the key's characters, and located by descriptor
+// index. Space is only reclaimed by Reset(), so a key that does not fit is left
+// uncached and read from flash as usual.
+class KeyTable {
+ public:
+  using Offset = uint16_t;
+
+  // The arena must be addressable by an Offset.
+  static constexpr bool ValidSize(size_t arena_bytes) {
+    return arena_bytes < kNotCached;
+  }
+
+  constexpr KeyTable() : KeyTable({}, {}) {}
+
+  // The offsets hold one slot per descriptor; an empty table is disabled.
+  constexpr KeyTable(std::span<char> arena, std::span<Offset> offsets)
+      : arena_(arena), offsets_(offsets), used_bytes_(0) {}
+
+  bool enabled() const { return !offsets_.empty(); }
+
+  // Removes all keys.
+  void Reset();
+
+  // Caches the key for the descriptor at this index, replacing any key it had.
+  // An empty key marks the key as unknown. Returns false if the key does not
+  // fit in the arena, in which case it is not cached.
+  bool Set(size_t descriptor_index, Key key);
+
+  // Returns the cached key for the descriptor, or an empty key if it is not
+  // cached.
+  Key Get(size_t descriptor_index) const {
+    if (descriptor_index >= offsets_.size() ||
+        offsets_[descriptor_index] == kNotCached) {
+      return {};
+    }
+    const char* const entry = &arena_[offsets_[descriptor_index]];
+    return Key(entry + 1, static_cast<uint8_t>(entry[0]));
+  }
+
+  size_t used_bytes() const { return used_bytes_; }
+
+ private:
+  static constexpr Offset kNotCached = std::numeric_limits<Offset>::max();
+
+  std::span<char> arena_;
+  std::span<Offset> offsets_;
+  size_t used_bytes_;
+};
+
 // Tracks entry metadata. Combines KeyDescriptors and with their associated
 // addresses.
 class EntryCache {
@@ -144,15 +196,33 @@ class EntryCache {
   template <size_t kMaxEntries, size_t kRedundancy>
   using AddressList = Address[kMaxEntries * kRedundancy + kRedundancy];
 
+  // The type of a slot in the optional key hash index. Slots hold the index of
+  // a descriptor plus one; zero marks an empty slot.
+  using KeyIndexSlot = uint16_t;
+
+  // The key index is an open-addressed hash table of descriptor indices, keyed
+  // by the key hash. It must be empty, which disables it, or have a power of
+  // two number of slots greater than the maximum number of entries. Lookups
+  // scan all descriptors when the index is disabled.
+  static constexpr bool ValidKeyIndexSize(size_t slots, size_t max_entries) {
+    return slots == 0u ||
+           (slots > max_entries && (slots & (slots - 1)) == 0u &&
+            max_entries < std::numeric_limits<KeyIndexSlot>::max());
+  }
+
   constexpr EntryCache(Vector<KeyDescriptor>& descriptors,
                        Address* addresses,
-                       size_t redundancy)
+                       size_t redundancy,
+                       std::span<KeyIndexSlot> key_index = {},
+                       KeyTable key_table = {})
       : descriptors_(descriptors),
         addresses_(addresses),
-        redundancy_(redundancy) {}
+        redundancy_(redundancy),
+        key_index_(key_index),
+        key_table_(key_table) {}
 
   // Clears all KeyDescriptors.
-  void Reset() const { descriptors_.clear(); }
+  void Reset() const;
 
   // Finds the metadata for an entry matching a particular key. Searches for a
   // KeyDescriptor that matches this key and sets *metadata to point to it if
@@ -166,6 +236,8 @@ class EntryCache {
   //                 key's hash collides with the hash for an existing
   //                 descriptor
   //
+  // Keys in the key table are compared without reading flash.
+  //
   StatusWithSize Find(FlashPartition& partition,
                       const Sectors& sectors,
                       const EntryFormats& formats,
@@ -173,15 +245,32 @@ class EntryCache {
                       EntryMetadata* metadata) const;
 
   // Adds a new descriptor to the descriptor list. The entry MUST be unique and
-  // the EntryCache must NOT be full!
-  EntryMetadata AddNew(const KeyDescriptor& entry, Address address) const;
+  // the EntryCache must NOT be full! The key, if known, is added to the key
+  // table.
+  EntryMetadata AddNew(const KeyDescriptor& entry,
+                       Address address,
+                       Key key = {}) const;
 
   // Adds a new descriptor, overwrites an existing one, or adds an additional
   // redundant address to one. The sector size is included for checking that
-  // redundant entries are in different sectors.
+  // redundant entries are in different sectors. The key, if known, is added to
+  // the key table.
   Status AddNewOrUpdateExisting(const KeyDescriptor& descriptor,
                                 Address address,
-                                size_t sector_size_bytes) const;
+                                size_t sector_size_bytes,
+                                Key key = {}) const;
+
+  // True if keys are kept in RAM.
+  bool caches_keys() const { return key_table_.enabled(); }
+
+  // Returns the entry's key from the key table, or an empty key if it is not
+  // cached.
+  Key cached_key(const EntryMetadata& metadata) const {
+    return key_table_.Get(index(metadata));
+  }
+
+  // Adds the entry's key to the key table, if it matches the entry's hash.
+  void CacheKey(const EntryMetadata& metadata, Key key) const;
 
   // Returns a pointer to an array of redundancy() addresses for temporary use.
   // This is used by the KeyValueStore to track reserved addresses when finding
@@ -214,6 +303,19 @@ class EntryCache {
  private:
   int FindIndex(uint32_t key_hash) const;
 
+  size_t index(const EntryMetadata& metadata) const {
+    return metadata.descriptor_ - descriptors_.begin();
+  }
+
+  // Returns the first slot to probe in the key index for this hash.
+  size_t KeyIndexStart(uint32_t key_hash) const {
+    // Mix the upper bits into the lower ones, which select the slot.
+    return (key_hash ^ (key_hash >> 16)) & (key_index_.size() - 1);
+  }
+
+  // Adds the descriptor at the specified index to the key index, if enabled.
+  void AddToKeyIndex(size_t descriptor_index) const;
+
   // Adds the address to the descriptor at the specified index if there is an
   // address slot available.
   void AddAddressIfRoom(size_t descriptor_index, Address address) const;
@@ -230,6 +332,14 @@ class EntryCache {
   Vector<KeyDescriptor>& descriptors_;
   FlashPartition::Address* const addresses_;
   const size_t redundancy_;
+
+  // Descriptor indices by key hash. Descriptors are only ever appended or
+  // cleared all at once, so slots never need to be removed.
+  const std::span<KeyIndexSlot> key_index_;
+
+  // Keys by descriptor index. Mutable so keys read from flash can be cached by
+  // const lookups.
+  mutable KeyTable key_table_;
 };
 
 }  // namespace internal
@@ -81,6 +81,18 @@ class SectorDescriptor {
     return sector_size_bytes - valid_bytes_ - writable_bytes();
   }
 
+  // The number of times this sector has been erased since the KVS was
+  // initialized. Saturates at UINT16_MAX.
+  size_t erase_count() const { return erase_count_; }
+
+  // Called when the sector is erased. Resets the writable bytes.
+  void MarkErased(uint16_t sector_size_bytes) {
+    tail_free_bytes_ = sector_size_bytes;
+    if (erase_count_ < UINT16_MAX) {
+      erase_count_ += 1;
+    }
+  }
+
   static constexpr size_t max_sector_size() { return kMaxSectorSize; }
 
  private:
@@ -90,10 +102,13 @@ class SectorDescriptor {
   static constexpr size_t kMaxSectorSize = UINT16_MAX - 1;
 
   explicit constexpr SectorDescriptor(uint16_t sector_size_bytes)
-      : tail_free_bytes_(sector_size_bytes), valid_bytes_(0) {}
+      : tail_free_bytes_(sector_size_bytes),
+        valid_bytes_(0),
+        erase_count_(0) {}
 
   uint16_t tail_free_bytes_;  // writable bytes at the end of the sector
   uint16_t valid_bytes_;      // sum of sizes of valid entries
+  uint16_t erase_count_;      // erases since the KVS was initialized
 };
 
 // Represents a list of sectors usable by the KVS.
@@ -107,7 +122,8 @@ class Sectors {
       : descriptors_(sectors),
         partition_(partition),
         last_new_(nullptr),
-        temp_sectors_to_skip_(temp_sectors_to_skip) {}
+        temp_sectors_to_skip_(temp_sectors_to_skip),
+        separate_devices_(false) {}
 
   // Resets the Sectors list. Must be called before using the object.
   void Reset() {
@@ -127,6 +143,14 @@ class Sectors {
   // because SectorDescriptor* is the standard way to identify a sector.
   SectorDescriptor* last_new() const { return last_new_; }
 
+  // Keeps the copies of each entry on different flash devices, so that they
+  // fail independently and can be written in parallel. A new copy avoids the
+  // devices of the entry's other copies, and garbage collection moves a copy
+  // only within its device.
+  void set_copies_on_separate_devices(bool separate) {
+    separate_devices_ = separate;
+  }
+
   // Sets the last new sector from the provided address.
   void set_last_new_sector(Address address) {
     last_new_ = &FromAddress(address);
@@ -162,21 +186,24 @@ class Sectors {
   Status FindSpace(SectorDescriptor** found_sector,
                    size_t size,
                    std::span<const Address> reserved_addresses) {
-    return Find(kAppendEntry, found_sector, size, {}, reserved_addresses);
+    return Find(kAppendEntry, found_sector, size, {}, reserved_addresses, 0);
   }
 
   // Same as FindSpace, except that the 1 empty sector invariant is ignored.
-  // Both addresses_to_skip and reserved_addresses are avoided.
+  // Both addresses_to_skip and reserved_addresses are avoided. The entry being
+  // relocated is at relocated_address.
   Status FindSpaceDuringGarbageCollection(
       SectorDescriptor** found_sector,
       size_t size,
+      Address relocated_address,
       std::span<const Address> addresses_to_skip,
       std::span<const Address> reserved_addresses) {
     return Find(kGarbageCollect,
                 found_sector,
                 size,
                 addresses_to_skip,
-                reserved_addresses);
+                reserved_addresses,
+                relocated_address);
   }
 
   // Finds a sector that is ready to be garbage collected. Returns nullptr if no
@@ -213,10 +240,25 @@ class Sectors {
               SectorDescriptor** found_sector,
               size_t size,
               std::span<const Address> addresses_to_skip,
-              std::span<const Address> reserved_addresses);
+              std::span<const Address> reserved_addresses,
+              Address relocated_address);
+
+  // Returns true if the sector may not hold the entry because another copy of
+  // it is on the same device. See set_copies_on_separate_devices().
+  bool OnWrongDevice(FindMode find_mode,
+                     const SectorDescriptor& sector,
+                     std::span<const Address> reserved_addresses,
+                     Address relocated_address) const;
 
   SectorDescriptor& WearLeveledSectorFromIndex(size_t idx) const;
 
+  // Returns true if garbage collecting the candidate is a better trade of bytes
+  // recovered for bytes relocated, sectors erased, and wear than the current
+  // choice.
+  bool BetterGarbageCollectionCandidate(const SectorDescriptor& candidate,
+                                        const SectorDescriptor& current,
+                                        size_t min_erase_count) const;
+
   Vector<SectorDescriptor>& descriptors_;
   FlashPartition& partition_;
 
@@ -225,6 +267,8 @@ class Sectors {
   // Temp buffer with space for redundancy * 2 - 1 sector pointers. This list is
   // used to track sectors that should be excluded from Find functions.
   const SectorDescriptor** const temp_sectors_to_skip_;
+
+  bool separate_devices_;
 };
 
 }  // namespace internal
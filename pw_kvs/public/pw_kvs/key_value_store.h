@@ -19,6 +19,7 @@
 #include <span>
 #include <type_traits>
 
+#include "pw_bytes/span.h"
 #include "pw_containers/vector.h"
 #include "pw_kvs/checksum.h"
 #include "pw_kvs/flash_memory.h"
@@ -29,8 +30,11 @@
 #include "pw_kvs/internal/sectors.h"
 #include "pw_kvs/internal/span_traits.h"
 #include "pw_kvs/key.h"
+#include "pw_kvs/value_cache.h"
+#include "pw_result/result.h"
 #include "pw_status/status.h"
 #include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
 
 namespace pw {
 namespace kvs {
@@ -77,6 +81,13 @@ struct Options {
 
   // Verify an in-flash entry's checksum after writing it.
   bool verify_on_write = true;
+
+  // Write a summary of each sector that garbage collection fills. A summary
+  // lists the key hash and transaction ID of every entry before it in the
+  // sector, so Init can load those entries without reading their keys or
+  // verifying their checksums. Existing summaries are used by Init regardless
+  // of this option.
+  bool sector_summaries = false;
 };
 
 class KeyValueStore {
@@ -120,6 +131,28 @@ class KeyValueStore {
                      std::span<std::byte> value,
                      size_t offset_bytes = 0) const;
 
+  // Reads the value of an entry into a stream, starting at an offset, so that
+  // values larger than any buffer in RAM can be read. The value is read from
+  // flash through a small buffer on the stack, sized by
+  // PW_KVS_VALUE_STREAM_BUFFER_SIZE. Returns the number of bytes written to the
+  // stream.
+  //
+  // With Options::verify_on_read, the checksum of the whole entry is verified
+  // in flash before any of the value is written to the stream.
+  //
+  //                    OK: the value was written to the stream
+  //             NOT_FOUND: the key is not present in the KVS
+  //             DATA_LOSS: found the entry, but the data was corrupted
+  //          OUT_OF_RANGE: the offset is past the end of the value
+  //   FAILED_PRECONDITION: the KVS is not initialized
+  //      INVALID_ARGUMENT: key is empty or too long
+  //
+  // Errors from writing to the stream are returned with the number of bytes
+  // that were written before the error.
+  StatusWithSize Get(Key key,
+                     stream::Writer& value,
+                     size_t offset_bytes = 0) const;
+
   // This overload of Get accepts a pointer to a trivially copyable object.
   // If the value is an array, call Get with
   // std::as_writable_bytes(std::span(array)), or pass a pointer to the array
@@ -132,6 +165,22 @@ class KeyValueStore {
     return FixedSizeGet(key, pointer, sizeof(T));
   }
 
+  // Returns the value for a key in memory-mapped flash, without copying it,
+  // after verifying its checksum. This requires a FlashMemory that implements
+  // FlashAddressToMcuAddress, such as execute-in-place flash. The span is only
+  // valid until the key is written or deleted, or garbage collection moves or
+  // erases the entry, so do not keep it across other KVS writes.
+  //
+  //                    OK: the value is in the span
+  //             NOT_FOUND: the key is not present in the KVS
+  //             DATA_LOSS: found the entry, but the checksum did not match
+  //         UNIMPLEMENTED: the flash is not memory mapped, or the value is
+  //                        compressed
+  //   FAILED_PRECONDITION: the KVS is not initialized
+  //      INVALID_ARGUMENT: key is empty or too long
+  //
+  Result<ConstByteSpan> GetMapped(Key key) const;
+
   // Adds a key-value entry to the KVS. If the key was already present, its
   // value is overwritten.
   //
@@ -141,6 +190,9 @@ class KeyValueStore {
   // If Put is called with a key whose hash matches an existing key, nothing
   // is added and ALREADY_EXISTS is returned.
   //
+  // If the primary EntryFormat compresses values, the value is written as with
+  // the stream overload of Put, so it is written even if it is unchanged.
+  //
   //                    OK: the entry was successfully added or updated
   //             DATA_LOSS: checksum validation failed after writing the data
   //    RESOURCE_EXHAUSTED: there is not enough space to add the entry
@@ -162,6 +214,59 @@ class KeyValueStore {
     return PutBytes(key, std::as_bytes(std::span<const T>(&value, 1)));
   }
 
+  // Adds a key-value entry whose value is size_bytes bytes read from a stream,
+  // starting at the reader's position, so that values larger than any buffer
+  // in RAM can be stored. The entry's checksum precedes the value in flash, so
+  // the value is read twice: once to calculate the checksum, and again while it
+  // is written to flash in chunks. The reader must return the same data both
+  // times, and is left just past the value. Reads and writes go through small
+  // buffers on the stack.
+  //
+  // If the primary EntryFormat compresses values, the value is read once more
+  // before the others to find its compressed size, and the compressed value
+  // must fit in a sector. Compressed values are at most 65534 bytes.
+  //
+  // Unlike Put, the value is written even if it is unchanged. Returns the same
+  // errors as Put, as well as the following:
+  //
+  //          OUT_OF_RANGE: the reader ended before size_bytes bytes were read;
+  //                        nothing was written
+  //             DATA_LOSS: the reader returned different data the second time;
+  //                        the entry is invalid and the old value is kept
+  //
+  // Other errors from the reader are returned as they are.
+  Status Put(const Key& key,
+             stream::SeekableReader& value,
+             size_t size_bytes);
+
+  // A key and value to write with PutBatch.
+  struct BatchEntry {
+    Key key;
+    std::span<const std::byte> value;
+  };
+
+  // Adds or updates several key-value entries at once. Space for the whole
+  // batch is found once, and the entries are written together after a batch
+  // header in one sector (one per redundant copy), with consecutive
+  // transaction IDs. If writing the batch is interrupted, for example by a
+  // power loss, Init ignores all of its entries, so the batch is applied
+  // completely or not at all. Unlike Put, entries whose value is unchanged are
+  // still written.
+  //
+  // The batch must fit in one sector, and no two keys in the batch may have the
+  // same hash. If any entry is invalid, nothing is written.
+  //
+  //                    OK: the entries were successfully added or updated
+  //             DATA_LOSS: checksum validation failed after writing the data
+  //    RESOURCE_EXHAUSTED: there is not enough space to add the entries
+  //        ALREADY_EXISTS: a key's hash matches a different key in the KVS
+  //   FAILED_PRECONDITION: the KVS is not initialized
+  //      INVALID_ARGUMENT: a key is empty, too long, or repeated in the batch,
+  //                        or the batch does not fit in one sector
+  //         UNIMPLEMENTED: the primary EntryFormat compresses values
+  //
+  Status PutBatch(std::span<const BatchEntry> entries);
+
   // Removes a key-value entry from the KVS.
   //
   //                    OK: the entry was successfully added or updated
@@ -211,6 +316,37 @@ class KeyValueStore {
   // that makes sense for the KVS implementation.
   Status PartialMaintenance();
 
+  // Performs one bounded step of garbage collection, so that collecting a
+  // sector can be spread over many calls, such as from a low-priority thread.
+  // Each step either relocates up to max_relocations valid entries out of the
+  // sector being collected or, once none remain, erases it. The sector is not
+  // written to while it is being collected. To run within a time budget, call
+  // this until the budget runs out or it returns NOT_FOUND:
+  //
+  //   while (!DeadlinePassed() && kvs.IncrementalGarbageCollect(4).ok()) {
+  //   }
+  //
+  // If a Put needs to garbage collect, it finishes the sector in progress, if
+  // possible, which takes less time than collecting a new one. Unlike
+  // PartialMaintenance, this does not repair errors.
+  //
+  //                    OK: a step was completed; more steps may be needed
+  //             NOT_FOUND: there is no reclaimable space to collect
+  //    RESOURCE_EXHAUSTED: there is no space to relocate an entry to
+  //   FAILED_PRECONDITION: the KVS is not initialized
+  //      INVALID_ARGUMENT: max_relocations is 0
+  //
+  Status IncrementalGarbageCollect(size_t max_relocations);
+
+  // Sets a cache for values read with Get, or removes it if nullptr. Clears the
+  // cache, which may only be used by this KVS.
+  void set_value_cache(ValueCache* cache) {
+    value_cache_ = cache;
+    if (cache != nullptr) {
+      cache->Clear();
+    }
+  }
+
   void LogDebugInfo() const;
 
   // Classes and functions to support STL-style iteration.
@@ -228,6 +364,12 @@ class KeyValueStore {
       return kvs_.Get(key(), *iterator_, value_buffer, offset_bytes);
     }
 
+    // Reads the value referred to by this iterator into a stream. Equivalent to
+    // KeyValueStore::Get with a stream::Writer.
+    StatusWithSize Get(stream::Writer& value, size_t offset_bytes = 0) const {
+      return kvs_.Get(*iterator_, value, offset_bytes);
+    }
+
     template <typename Pointer,
               typename = std::enable_if_t<std::is_pointer<Pointer>::value>>
     Status Get(const Pointer& pointer) const {
@@ -262,7 +404,8 @@ class KeyValueStore {
 
     iterator& operator++(int) { return operator++(); }
 
-    // Reads the entry's key from flash.
+    // Reads the entry's key from the key table, if it is cached there, or from
+    // flash.
     const Item& operator*() {
       item_.ReadKey();
       return item_;
@@ -315,6 +458,9 @@ class KeyValueStore {
     size_t sector_erase_count;
     size_t corrupt_sectors_recovered;
     size_t missing_redundant_entries_recovered;
+
+    // Valid entries copied out of sectors being garbage collected.
+    size_t entries_relocated;
   };
 
   StorageStats GetStorageStats() const;
@@ -344,6 +490,7 @@ class KeyValueStore {
   using Address = FlashPartition::Address;
   using Entry = internal::Entry;
   using KeyDescriptor = internal::KeyDescriptor;
+  using KeyIndexSlot = internal::EntryCache::KeyIndexSlot;
   using SectorDescriptor = internal::SectorDescriptor;
 
   // In the future, will be able to provide additional EntryFormats for
@@ -355,7 +502,9 @@ class KeyValueStore {
                 Vector<SectorDescriptor>& sector_descriptor_list,
                 const SectorDescriptor** temp_sectors_to_skip,
                 Vector<KeyDescriptor>& key_descriptor_list,
-                Address* addresses);
+                Address* addresses,
+                std::span<KeyIndexSlot> key_index = {},
+                internal::KeyTable key_table = {});
 
  private:
   using EntryMetadata = internal::EntryMetadata;
@@ -371,8 +520,11 @@ class KeyValueStore {
         "std::as_writable_bytes(std::span(&value, 1)).");
   }
 
-  Status InitializeMetadata();
+  Status InitializeMetadata(bool use_sector_summaries);
   Status LoadEntry(Address entry_address, Address* next_entry_address);
+  Address BatchEnd(const Entry& batch_header, size_t batch_entries);
+  Status LoadSectorSummary(const SectorDescriptor& sector,
+                           Address* next_entry_address);
   Status ScanForEntry(const SectorDescriptor& sector,
                       Address start_address,
                       Address* next_entry_address);
@@ -381,8 +533,17 @@ class KeyValueStore {
 
   StatusWithSize ValueSize(const EntryMetadata& metadata) const;
 
+  StatusWithSize ValueSize(const Entry& entry) const;
+
   Status ReadEntry(const EntryMetadata& metadata, Entry& entry) const;
 
+  // Reads an entry like ReadEntry, along with as much of its key and value as
+  // fits in the buffer, in one flash read. Returns the number of bytes of the
+  // entry in the buffer.
+  StatusWithSize ReadEntry(const EntryMetadata& metadata,
+                           Entry& entry,
+                           std::span<std::byte> buffer) const;
+
   // Finds the metadata for an entry matching a particular key. Searches for a
   // KeyDescriptor that matches this key and sets *metadata to point to it if
   // one is found.
@@ -410,6 +571,22 @@ class KeyValueStore {
                      std::span<std::byte> value_buffer,
                      size_t offset_bytes) const;
 
+  StatusWithSize Get(const EntryMetadata& metadata,
+                     stream::Writer& value,
+                     size_t offset_bytes) const;
+
+  // Reads a value from flash. If exact_size is set, returns INVALID_ARGUMENT
+  // without reading the value if it is not the size of the buffer.
+  StatusWithSize GetFromFlash(Key key,
+                              const EntryMetadata& metadata,
+                              std::span<std::byte> value_buffer,
+                              size_t offset_bytes,
+                              bool exact_size = false) const;
+
+  StatusWithSize ReadCompressedValue(const Entry& entry,
+                                     std::span<std::byte> value_buffer,
+                                     size_t offset_bytes) const;
+
   Status FixedSizeGet(Key key, void* value, size_t size_bytes) const;
 
   Status FixedSizeGet(Key key,
@@ -417,6 +594,9 @@ class KeyValueStore {
                       void* value,
                       size_t size_bytes) const;
 
+  Status CheckBatch(std::span<const BatchEntry> entries,
+                    size_t* batch_size) const;
+
   Status CheckWriteOperation(Key key) const;
   Status CheckReadOperation(Key key) const;
 
@@ -433,6 +613,23 @@ class KeyValueStore {
                     EntryMetadata* prior_metadata = nullptr,
                     const internal::Entry* prior_entry = nullptr);
 
+  Status WriteEntry(Key key,
+                    stream::SeekableReader& value,
+                    size_t value_size_bytes,
+                    EntryMetadata* prior_metadata = nullptr,
+                    const internal::Entry* prior_entry = nullptr);
+
+  // Writes an entry to the addresses from GetAddressesForWrite.
+  Status WriteReservedEntry(Key key,
+                            stream::SeekableReader& value,
+                            size_t value_size_bytes,
+                            EntryMetadata* prior_metadata,
+                            size_t prior_size);
+
+  Status PutStoredValue(const Key& key,
+                        stream::SeekableReader& value,
+                        size_t size_bytes);
+
   EntryMetadata CreateOrUpdateKeyDescriptor(const Entry& new_entry,
                                             Key key,
                                             EntryMetadata* prior_metadata,
@@ -455,6 +652,19 @@ class KeyValueStore {
                      Key key,
                      std::span<const std::byte> value);
 
+  Status AppendEntry(const Entry& entry, Key key, stream::Reader& value);
+
+  // Checks the result of writing an entry, verifies it if requested, and
+  // accounts for it in its sector.
+  Status FinishAppendEntry(const Entry& entry,
+                           StatusWithSize write_result,
+                           bool verify);
+
+  Status WriteBatch(Address address,
+                    std::span<const BatchEntry> entries,
+                    uint32_t header_transaction_id,
+                    size_t batch_size);
+
   StatusWithSize CopyEntryToSector(Entry& entry,
                                    SectorDescriptor* new_sector,
                                    Address new_address);
@@ -463,6 +673,12 @@ class KeyValueStore {
                        KeyValueStore::Address& address,
                        std::span<const Address> addresses_to_skip);
 
+  // Summarizes the sector that garbage collection is relocating entries to.
+  Status FinishGarbageCollectionDestination();
+
+  // Appends a summary of the entries in the sector, if there is room for one.
+  Status WriteSectorSummary(SectorDescriptor& sector);
+
   // Perform all maintenance possible, including all neeeded repairing of
   // corruption and garbage collection of reclaimable space in the KVS. When
   // configured for manual recovery, this is the only way KVS repair is
@@ -496,6 +712,8 @@ class KeyValueStore {
   // Return: status + number of entries updated.
   StatusWithSize UpdateEntriesToPrimaryFormat();
 
+  Status RecompressEntry(EntryMetadata& metadata, const Entry& entry);
+
   Status AddRedundantEntries(EntryMetadata& metadata);
 
   Status RepairCorruptSectors();
@@ -552,20 +770,43 @@ class KeyValueStore {
   // make it mutable.
   mutable bool error_detected_;
 
+  // The sector that garbage collection is relocating entries to, which is
+  // summarized once it is done, and the number of entries in it.
+  SectorDescriptor* gc_destination_;
+  size_t gc_destination_entries_;
+
+  // The sector that IncrementalGarbageCollect is collecting, if any.
+  SectorDescriptor* incremental_gc_sector_;
+
+  ValueCache* value_cache_;
+
   struct InternalStats {
     size_t sector_erase_count;
     size_t corrupt_sectors_recovered;
     size_t missing_redundant_entries_recovered;
+    size_t entries_relocated;
   };
   InternalStats internal_stats_;
 
   uint32_t last_transaction_id_;
 };
 
+// A KeyValueStore with storage for up to kMaxEntries keys.
+//
+// By default, finding a key scans every key descriptor. To look keys up in
+// constant time instead, set kKeyIndexSize to a power of two greater than
+// kMaxEntries. This adds a hash index of kKeyIndexSize uint16_t slots; about
+// twice kMaxEntries keeps probe sequences short.
+//
+// Iterating over the KVS and comparing keys in Get and Put read keys from
+// flash. Set kKeyTableBytes to keep keys in a RAM arena of that size instead.
+// Each key takes one byte more than its length, plus a uint16_t per entry.
 template <size_t kMaxEntries,
           size_t kMaxUsableSectors,
           size_t kRedundancy = 1,
-          size_t kEntryFormats = 1>
+          size_t kEntryFormats = 1,
+          size_t kKeyIndexSize = 0,
+          size_t kKeyTableBytes = 0>
 class KeyValueStoreBuffer : public KeyValueStore {
  public:
   // Constructs a KeyValueStore on the partition, with support for one
@@ -594,7 +835,9 @@ class KeyValueStoreBuffer : public KeyValueStore {
                       sectors_,
                       temp_sectors_to_skip_,
                       key_descriptors_,
-                      addresses_) {
+                      addresses_,
+                      key_index_,
+                      internal::KeyTable(key_table_, key_table_offsets_)) {
     std::copy(formats.begin(), formats.end(), formats_.begin());
   }
 
@@ -603,6 +846,11 @@ class KeyValueStoreBuffer : public KeyValueStore {
   static_assert(kMaxUsableSectors > 0u);
   static_assert(kRedundancy > 0u);
   static_assert(kEntryFormats > 0u);
+  static_assert(
+      internal::EntryCache::ValidKeyIndexSize(kKeyIndexSize, kMaxEntries),
+      "kKeyIndexSize must be 0 or a power of two greater than kMaxEntries");
+  static_assert(internal::KeyTable::ValidSize(kKeyTableBytes),
+                "kKeyTableBytes must be less than 65535");
 
   Vector<SectorDescriptor, kMaxUsableSectors> sectors_;
 
@@ -623,6 +871,14 @@ class KeyValueStoreBuffer : public KeyValueStore {
   // KeyDescriptors.
   internal::EntryCache::AddressList<kRedundancy, kMaxEntries> addresses_;
 
+  // Optional hash index of the KeyDescriptors, which starts out empty.
+  std::array<KeyIndexSlot, kKeyIndexSize> key_index_ = {};
+
+  // Optional arena of keys and the offset of each KeyDescriptor's key in it.
+  std::array<char, kKeyTableBytes> key_table_;
+  std::array<internal::KeyTable::Offset, kKeyTableBytes == 0 ? 0 : kMaxEntries>
+      key_table_offsets_;
+
   // EntryFormats that can be read by this KeyValueStore.
   std::array<EntryFormat, kEntryFormats> formats_;
 };
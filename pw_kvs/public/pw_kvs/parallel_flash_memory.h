@@ -0,0 +1,157 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_kvs/async_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+
+namespace pw::kvs {
+
+// A FlashMemory made of several AsyncFlashMemory devices with the same
+// geometry, one after the other. Each device holds sectors_per_device()
+// sectors. A KeyValueStore with redundancy on a partition that spans at least
+// as many devices as copies keeps each copy on a different device, so losing a
+// device loses no data.
+//
+// Outside of StartParallelWrites() and FinishParallelWrites(), each operation
+// waits for the device to finish it, as with BlockingFlashMemory. Between
+// them, writes are copied into a staging buffer for the device, queued, and
+// return immediately, so writes to different devices run at the same time.
+// A write waits only if its device's staging buffer or queue is full, and a
+// read waits only for the writes queued on its device. Errors from queued
+// writes are returned by the next call that waits for them to finish, which
+// may be a later Write, Erase, or FinishParallelWrites.
+//
+// Operations must not be called from the context that calls the devices'
+// Complete(). This class is not thread safe.
+class ParallelFlashMemory : public FlashMemory {
+ public:
+  // The state of one device.
+  class Device {
+   public:
+    Device() = default;
+
+   private:
+    friend class ParallelFlashMemory;
+
+    // Called with the result of each queued operation.
+    void Finished(Status status);
+
+    // Waits for queued operations to finish. Errors are kept for TakeError.
+    void Wait();
+
+    // Returns the first error since the last call, if any.
+    Status TakeError();
+
+    size_t staged_bytes_ = 0;
+
+    sync::InterruptSpinLock lock_;
+    size_t pending_ PW_GUARDED_BY(lock_) = 0;
+    bool waiting_ PW_GUARDED_BY(lock_) = false;
+    Status error_ PW_GUARDED_BY(lock_);
+    sync::BinarySemaphore done_;
+  };
+
+  ParallelFlashMemory(const ParallelFlashMemory&) = delete;
+  ParallelFlashMemory& operator=(const ParallelFlashMemory&) = delete;
+
+  ~ParallelFlashMemory() override { FinishParallelWrites(); }
+
+  Status Enable() override;
+
+  Status Disable() override;
+
+  bool IsEnabled() const override;
+
+  // Erases the sectors on each device at the same time.
+  Status Erase(Address flash_address, size_t num_sectors) override;
+
+  StatusWithSize Read(Address address, std::span<std::byte> output) override;
+
+  StatusWithSize Write(Address destination_flash_address,
+                       std::span<const std::byte> data) override;
+
+  void StartParallelWrites() override { parallel_ = true; }
+
+  Status FinishParallelWrites() override;
+
+  size_t sectors_per_device() const override {
+    return flashes_[0]->sector_count();
+  }
+
+  size_t device_count() const { return flashes_.size(); }
+
+ protected:
+  // The devices must have the same sector size, sector count, alignment, and
+  // erased memory content, and the list of them must outlive this object. The
+  // staging buffer is divided evenly among them.
+  ParallelFlashMemory(std::span<AsyncFlashMemory* const> flashes,
+                      std::span<Device> devices,
+                      ByteSpan staging_buffer);
+
+ private:
+  // Calls function(index, device_address, offset, size) for the part of
+  // [address, address + size) on each device it spans, where device_address is
+  // in the device's address space and offset is from address.
+  template <typename Function>
+  Status ForEachDevice(Address address, size_t size, Function&& function);
+
+  // Queues an operation, started by start(callback), on the device. Waits for
+  // the device's earlier operations if its queue is full.
+  template <typename StartOperation>
+  Status Queue(size_t index, StartOperation&& start);
+
+  StatusWithSize WriteToDevice(size_t index,
+                               Address address,
+                               std::span<const std::byte> data);
+
+  size_t staging_bytes_per_device() const {
+    return staging_buffer_.size() / flashes_.size();
+  }
+
+  const std::span<AsyncFlashMemory* const> flashes_;
+  const std::span<Device> devices_;
+  const ByteSpan staging_buffer_;
+  bool parallel_;
+};
+
+// A ParallelFlashMemory with storage for its devices and a staging buffer of
+// kStagingBufferBytes for each of them.
+//
+//   AsyncFlashMemory* const devices[] = {&flash_a, &flash_b};
+//   ParallelFlashMemoryBuffer<2, 512> flash(devices);
+//
+template <size_t kDevices, size_t kStagingBufferBytes>
+class ParallelFlashMemoryBuffer : public ParallelFlashMemory {
+ public:
+  ParallelFlashMemoryBuffer(
+      std::span<AsyncFlashMemory* const, kDevices> flashes)
+      : ParallelFlashMemory(flashes, devices_, staging_buffer_) {}
+
+ private:
+  std::array<Device, kDevices> devices_;
+  std::array<std::byte, kDevices * kStagingBufferBytes> staging_buffer_;
+};
+
+}  // namespace pw::kvs
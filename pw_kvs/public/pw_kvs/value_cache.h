@@ -0,0 +1,127 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_metric/metric.h"
+#include "pw_status/status_with_size.h"
+
+namespace pw::kvs {
+namespace internal {
+
+struct ValueCacheSlot {
+  uint32_t key_hash;
+  uint32_t transaction_id;
+  uint32_t last_used;
+  uint16_t size_bytes;
+  bool in_use;
+};
+
+}  // namespace internal
+
+// A fixed-size RAM cache of recently read KVS values, for values that are read
+// far more often than they are written, such as calibration tables. When a
+// cache is set with KeyValueStore::set_value_cache(), Get and ValueSize return
+// cached values without reading flash or verifying checksums.
+//
+// Values are cached by key hash and transaction ID. Put and Delete give a key
+// a new transaction ID, so they make its cached value stale. Garbage collection
+// copies entries without changing them, so relocated values stay cached. When
+// the cache is full, the least recently used value is replaced. Values larger
+// than the cache's slots are not cached.
+//
+// A cache may only be used by one KeyValueStore at a time. Like the
+// KeyValueStore, it is not thread safe.
+class ValueCache {
+ public:
+  ValueCache(const ValueCache&) = delete;
+  ValueCache& operator=(const ValueCache&) = delete;
+
+  // The "hits" and "misses" metrics, for exporting with pw_metric.
+  metric::Group& metrics() { return metrics_; }
+
+  uint32_t hits() const { return hits_.value(); }
+  uint32_t misses() const { return misses_.value(); }
+
+  size_t max_value_size_bytes() const { return max_value_size_bytes_; }
+
+  // Removes all values from the cache. The metrics are not reset.
+  void Clear();
+
+ protected:
+  ValueCache(std::span<internal::ValueCacheSlot> slots,
+             std::span<std::byte> values,
+             size_t max_value_size_bytes)
+      : slots_(slots),
+        values_(values),
+        max_value_size_bytes_(max_value_size_bytes),
+        use_count_(0) {
+    Clear();
+  }
+
+ private:
+  friend class KeyValueStore;
+
+  using Slot = internal::ValueCacheSlot;
+
+  // Finds the cached value for an entry and counts a hit or miss. Returns
+  // nullptr if the value is not cached.
+  const Slot* Find(uint32_t key_hash, uint32_t transaction_id);
+
+  std::span<const std::byte> value(const Slot& slot) const {
+    return std::span(values_).subspan(
+        (&slot - slots_.data()) * max_value_size_bytes_, slot.size_bytes);
+  }
+
+  // Reads a cached value in the same way as reading it from flash.
+  StatusWithSize Read(const Slot& slot,
+                      std::span<std::byte> buffer,
+                      size_t offset_bytes) const;
+
+  // Caches a value that was read from flash, if it fits.
+  void Store(uint32_t key_hash,
+             uint32_t transaction_id,
+             std::span<const std::byte> value);
+
+  const std::span<Slot> slots_;
+  const std::span<std::byte> values_;
+  const size_t max_value_size_bytes_;
+
+  // Incremented on every hit and store to find the least recently used slot.
+  uint32_t use_count_;
+
+  PW_METRIC_GROUP(metrics_, "kvs_value_cache");
+  PW_METRIC(metrics_, hits_, "hits", 0u);
+  PW_METRIC(metrics_, misses_, "misses", 0u);
+};
+
+// A ValueCache with storage for kValues values of up to kMaxValueSizeBytes.
+template <size_t kValues, size_t kMaxValueSizeBytes>
+class ValueCacheBuffer : public ValueCache {
+ public:
+  static_assert(kValues > 0u);
+  static_assert(kMaxValueSizeBytes <= UINT16_MAX);
+
+  ValueCacheBuffer() : ValueCache(slots_, values_, kMaxValueSizeBytes) {}
+
+ private:
+  std::array<internal::ValueCacheSlot, kValues> slots_;
+  std::array<std::byte, kValues * kMaxValueSizeBytes> values_;
+};
+
+}  // namespace pw::kvs
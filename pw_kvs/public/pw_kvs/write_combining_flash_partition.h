@@ -0,0 +1,145 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pw::kvs {
+
+// A FlashPartition that combines small writes into full program pages and
+// defers erases. It may be used in place of a FlashPartition by any store, such
+// as KeyValueStore or BlobStore.
+//
+// Writes are copied into a page buffer until a page is complete or a write to a
+// different location arrives, and are then written to flash at once. Writes of
+// whole, page-aligned pages go directly to flash. Reading buffered data flushes
+// it first, so reads always see the data that was written. Errors from writing
+// buffered data are returned by the call that flushes it, which may be a later
+// Write, Read, or Flush.
+//
+// Erase only marks sectors to be erased and returns immediately. Pending erases
+// are done by PerformDeferredErases, which may be called from a background
+// thread or when the system is idle, or before a sector with a pending erase is
+// next written. Until then, reads of such a sector return erased memory
+// contents. Erasing a sector again before its pending erase is done is free.
+//
+// PartitionAddressToMcuAddress bypasses this class, so call Flush and
+// PerformDeferredErases before reading from memory-mapped flash.
+//
+// This class is not thread safe.
+class WriteCombiningFlashPartition : public FlashPartition {
+ public:
+  struct Stats {
+    size_t writes;        // Write calls
+    size_t flash_writes;  // writes to flash
+    size_t erases;        // sectors passed to Erase
+    size_t flash_erases;  // sectors erased in flash
+  };
+
+  ~WriteCombiningFlashPartition() override { Flush(); }
+
+  using FlashPartition::Erase;
+
+  // Marks sectors to be erased. Returns the same errors as FlashPartition, but
+  // only for invalid arguments, since the sectors are erased later.
+  Status Erase(Address address, size_t num_sectors) override;
+
+  StatusWithSize Read(Address address, std::span<std::byte> output) override;
+
+  StatusWithSize Write(Address address,
+                       std::span<const std::byte> data) override;
+
+  // Writes buffered data to flash.
+  Status Flush();
+
+  // Erases up to max_sectors sectors that have pending erases. Returns the
+  // first error, if any.
+  Status PerformDeferredErases(size_t max_sectors = SIZE_MAX);
+
+  // The number of sectors with pending erases.
+  size_t pending_erases() const;
+
+  // Statistics for comparing the operations requested to those done in flash.
+  const Stats& stats() const { return stats_; }
+
+  void ResetStats() { stats_ = {}; }
+
+ protected:
+  WriteCombiningFlashPartition(
+      ByteSpan page_buffer,
+      std::span<bool> erase_pending,
+      FlashMemory* flash,
+      uint32_t start_sector_index,
+      uint32_t sector_count,
+      uint32_t alignment_bytes = 0,  // Defaults to flash alignment
+      PartitionPermission permission = PartitionPermission::kReadAndWrite);
+
+ private:
+  size_t page_size_bytes() const { return page_buffer_.size(); }
+
+  // Erases the sector now if its erase is pending.
+  Status EraseIfPending(size_t sector_index);
+
+  // Erases pending sectors in the range of addresses that will be written.
+  Status ErasePendingSectors(Address address, size_t size_bytes);
+
+  StatusWithSize WriteToFlash(Address address, std::span<const std::byte> data);
+
+  // Buffer for one page, which holds written data for [buffer_address_,
+  // buffer_address_ + buffered_bytes_). The data never crosses a page boundary.
+  const ByteSpan page_buffer_;
+  Address buffer_address_;
+  size_t buffered_bytes_;
+
+  // One flag per sector, set if the sector has a pending erase.
+  const std::span<bool> erase_pending_;
+
+  Stats stats_;
+};
+
+template <size_t kMaxSectors, size_t kPageSizeBytes>
+class WriteCombiningFlashPartitionBuffer : public WriteCombiningFlashPartition {
+ public:
+  WriteCombiningFlashPartitionBuffer(
+      FlashMemory* flash,
+      uint32_t start_sector_index,
+      uint32_t sector_count,
+      uint32_t alignment_bytes = 0,  // Defaults to flash alignment
+      PartitionPermission permission = PartitionPermission::kReadAndWrite)
+      : WriteCombiningFlashPartition(page_buffer_,
+                                     erase_pending_,
+                                     flash,
+                                     start_sector_index,
+                                     sector_count,
+                                     alignment_bytes,
+                                     permission) {}
+
+  WriteCombiningFlashPartitionBuffer(FlashMemory* flash)
+      : WriteCombiningFlashPartitionBuffer(
+            flash, 0, flash->sector_count(), flash->alignment_bytes()) {}
+
+ private:
+  std::array<std::byte, kPageSizeBytes> page_buffer_;
+  std::array<bool, kMaxSectors> erase_pending_ = {};
+};
+
+}  // namespace pw::kvs
@@ -30,8 +30,55 @@
 static_assert((PW_KVS_MAX_FLASH_ALIGNMENT >= 16UL),
               "Max flash alignment is required to be at least 16");
 
+// The maximum number of entries in a sector summary. Sectors with more entries
+// are not summarized. Summaries are built in a buffer of 8 bytes per entry on
+// the stack during garbage collection and Init.
+#ifndef PW_KVS_MAX_SECTOR_SUMMARY_ENTRIES
+#define PW_KVS_MAX_SECTOR_SUMMARY_ENTRIES 32
+#endif  // PW_KVS_MAX_SECTOR_SUMMARY_ENTRIES
+
+// The size of the buffer that combines the entries of a PutBatch call into
+// aligned flash writes. A larger buffer means fewer, larger writes. The buffer
+// is on the stack during PutBatch.
+#ifndef PW_KVS_BATCH_WRITE_BUFFER_SIZE
+#define PW_KVS_BATCH_WRITE_BUFFER_SIZE 512UL
+#endif  // PW_KVS_BATCH_WRITE_BUFFER_SIZE
+
+static_assert((PW_KVS_BATCH_WRITE_BUFFER_SIZE >= PW_KVS_MAX_FLASH_ALIGNMENT),
+              "The batch write buffer must hold at least one flash alignment");
+
+// Whether entries are written in AlignedWriter's kPassThrough mode, which
+// writes large values to flash directly from the caller's buffer instead of
+// copying them through a small buffer. This reduces the number of flash writes
+// for large values. Enable it only if the flash driver can write from any
+// address in RAM.
+#ifndef PW_KVS_ALIGNED_WRITE_PASS_THROUGH
+#define PW_KVS_ALIGNED_WRITE_PASS_THROUGH 0
+#endif  // PW_KVS_ALIGNED_WRITE_PASS_THROUGH
+
+// The size of the buffer that values are read through when they are streamed
+// to or from flash by KeyValueStore::Put and Get. Get also reads the start of
+// an entry into a buffer of this size, so entries that fit take one flash read,
+// and entries are checksummed in flash in chunks of at least this size. A
+// larger buffer means fewer flash reads and stream calls. The buffer is on the
+// stack during those calls.
+#ifndef PW_KVS_VALUE_STREAM_BUFFER_SIZE
+#define PW_KVS_VALUE_STREAM_BUFFER_SIZE 64UL
+#endif  // PW_KVS_VALUE_STREAM_BUFFER_SIZE
+
 namespace pw::kvs {
 
 inline constexpr size_t kMaxFlashAlignment = PW_KVS_MAX_FLASH_ALIGNMENT;
 
+inline constexpr size_t kMaxSectorSummaryEntries =
+    PW_KVS_MAX_SECTOR_SUMMARY_ENTRIES;
+
+inline constexpr size_t kBatchWriteBufferSize = PW_KVS_BATCH_WRITE_BUFFER_SIZE;
+
+inline constexpr bool kAlignedWritePassThrough =
+    PW_KVS_ALIGNED_WRITE_PASS_THROUGH;
+
+inline constexpr size_t kValueStreamBufferSize =
+    PW_KVS_VALUE_STREAM_BUFFER_SIZE;
+
 }  // namespace pw::kvs
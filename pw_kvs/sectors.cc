@@ -17,6 +17,9 @@
 
 #include "pw_kvs/internal/sectors.h"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "pw_kvs_private/config.h"
 #include "pw_log/shorter.h"
 
@@ -31,13 +34,18 @@ bool Contains(const Container& container, const T& value) {
          std::end(container);
 }
 
+// Each erase a sector has had beyond the least-erased sector adds 1/8 of its
+// base cost to its garbage collection cost.
+constexpr uint64_t kEraseCountWeight = 8;
+
 }  // namespace
 
 Status Sectors::Find(FindMode find_mode,
                      SectorDescriptor** found_sector,
                      size_t size,
                      std::span<const Address> addresses_to_skip,
-                     std::span<const Address> reserved_addresses) {
+                     std::span<const Address> reserved_addresses,
+                     Address relocated_address) {
   SectorDescriptor* first_empty_sector = nullptr;
   bool at_least_two_empty_sectors = (find_mode == kGarbageCollect);
 
@@ -102,7 +110,9 @@ Status Sectors::Find(FindMode find_mode,
     }
 
     // Skip sectors in the skip list.
-    if (Contains(std::span(temp_sectors_to_skip_, sectors_to_skip), sector)) {
+    if (Contains(std::span(temp_sectors_to_skip_, sectors_to_skip), sector) ||
+        OnWrongDevice(
+            find_mode, *sector, reserved_addresses, relocated_address)) {
       continue;
     }
 
@@ -124,7 +134,11 @@ Status Sectors::Find(FindMode find_mode,
     if (sector->Empty(sector_size_bytes)) {
       if (first_empty_sector == nullptr) {
         first_empty_sector = sector;
-      } else {
+      } else if (!separate_devices_ ||
+                 partition_.DeviceIndex(BaseAddress(*sector)) ==
+                     partition_.DeviceIndex(BaseAddress(*first_empty_sector))) {
+        // With copies on separate devices, garbage collection relocates
+        // entries within a device, so each device keeps its own empty sector.
         at_least_two_empty_sectors = true;
       }
     }
@@ -158,10 +172,54 @@ Status Sectors::Find(FindMode find_mode,
   return Status::ResourceExhausted();
 }
 
+bool Sectors::OnWrongDevice(FindMode find_mode,
+                            const SectorDescriptor& sector,
+                            std::span<const Address> reserved_addresses,
+                            Address relocated_address) const {
+  if (!separate_devices_) {
+    return false;
+  }
+
+  const size_t device = partition_.DeviceIndex(BaseAddress(sector));
+  if (find_mode == kGarbageCollect) {
+    return device != partition_.DeviceIndex(relocated_address);
+  }
+
+  // When appending, the reserved addresses hold the entry's earlier copies.
+  return std::any_of(reserved_addresses.begin(),
+                     reserved_addresses.end(),
+                     [&](Address address) {
+                       return partition_.DeviceIndex(address) == device;
+                     });
+}
+
 SectorDescriptor& Sectors::WearLeveledSectorFromIndex(size_t idx) const {
   return descriptors_[(Index(last_new_) + 1 + idx) % descriptors_.size()];
 }
 
+// Compares sectors by cost-benefit, in the style of log-structured file
+// systems. The benefit of collecting a sector is the bytes it recovers. The
+// cost is erasing the sector, counted as the sector size, plus rewriting its
+// valid bytes, scaled up for sectors that have been erased more than others.
+bool Sectors::BetterGarbageCollectionCandidate(
+    const SectorDescriptor& candidate,
+    const SectorDescriptor& current,
+    size_t min_erase_count) const {
+  const size_t sector_size_bytes = partition_.sector_size_bytes();
+
+  const auto cost = [&](const SectorDescriptor& sector) {
+    return (uint64_t(sector_size_bytes) + sector.valid_bytes()) *
+           (kEraseCountWeight + sector.erase_count() - min_erase_count);
+  };
+
+  // Compare benefit / cost without division:
+  //     candidate benefit / candidate cost > current benefit / current cost
+  return uint64_t(candidate.RecoverableBytes(sector_size_bytes)) *
+             cost(current) >
+         uint64_t(current.RecoverableBytes(sector_size_bytes)) *
+             cost(candidate);
+}
+
 // TODO: Consider breaking this function into smaller sub-chunks.
 SectorDescriptor* Sectors::FindSectorToGarbageCollect(
     std::span<const Address> reserved_addresses) const {
@@ -192,15 +250,24 @@ SectorDescriptor* Sectors::FindSectorToGarbageCollect(
     }
   }
 
-  // Step 2: If step 1 yields no sectors, just find the sector with the most
-  // reclaimable bytes but no addresses to avoid.
+  // Step 2: If step 1 yields no sectors, find the sector with reclaimable bytes
+  // that gives the best cost-benefit, which weighs the bytes recovered against
+  // the valid bytes to relocate and the sector's erase count. Ties go to the
+  // first sector in wear-leveled order.
   if (sector_candidate == nullptr) {
+    size_t min_erase_count = SIZE_MAX;
+    for (const SectorDescriptor& sector : descriptors_) {
+      min_erase_count = std::min(min_erase_count, sector.erase_count());
+    }
+
     for (size_t i = 0; i < descriptors_.size(); ++i) {
       SectorDescriptor& sector = WearLeveledSectorFromIndex(i);
-      if ((sector.RecoverableBytes(sector_size_bytes) > candidate_bytes) &&
-          !Contains(sectors_to_skip, &sector)) {
+      if ((sector.RecoverableBytes(sector_size_bytes) > 0) &&
+          !Contains(sectors_to_skip, &sector) &&
+          (sector_candidate == nullptr ||
+           BetterGarbageCollectionCandidate(
+               sector, *sector_candidate, min_erase_count))) {
         sector_candidate = &sector;
-        candidate_bytes = sector.RecoverableBytes(sector_size_bytes);
       }
     }
   }
@@ -79,8 +79,58 @@ TEST_F(SectorsTest, NextWritableAddress_PartiallyWrittenSector) {
   EXPECT_EQ(123u, sectors_.NextWritableAddress(*sectors_.begin()));
 }
 
-// TODO: Add tests for FindSpace, FindSpaceDuringGarbageCollection, and
-// FindSectorToGarbageCollect.
+// Fills a sector with entries, of which valid_bytes are still valid.
+void FillSector(SectorDescriptor& sector, uint16_t valid_bytes) {
+  sector.RemoveWritableBytes(128);
+  sector.AddValidBytes(valid_bytes);
+}
+
+TEST_F(SectorsTest, FindSectorToGarbageCollect_NoRecoverableBytes) {
+  EXPECT_EQ(nullptr, sectors_.FindSectorToGarbageCollect({}));
+}
+
+TEST_F(SectorsTest, FindSectorToGarbageCollect_PrefersNoValidBytes) {
+  SectorDescriptor& sector_1 = sectors_.FromAddress(128);
+  SectorDescriptor& sector_2 = sectors_.FromAddress(256);
+  FillSector(sector_1, 16);
+  FillSector(sector_2, 0);
+
+  EXPECT_EQ(&sector_2, sectors_.FindSectorToGarbageCollect({}));
+}
+
+TEST_F(SectorsTest, FindSectorToGarbageCollect_FewerBytesToRelocate) {
+  SectorDescriptor& sector_1 = sectors_.FromAddress(128);
+  SectorDescriptor& sector_2 = sectors_.FromAddress(256);
+
+  // Sector 1 has the most recoverable bytes, but sector 2 recovers more bytes
+  // for each byte relocated and erased.
+  FillSector(sector_1, 60);  // 68 B recoverable
+  sector_2.RemoveWritableBytes(70);
+  sector_2.AddValidBytes(10);  // 60 B recoverable
+
+  EXPECT_EQ(&sector_2, sectors_.FindSectorToGarbageCollect({}));
+}
+
+TEST_F(SectorsTest, FindSectorToGarbageCollect_AvoidsWornSectors) {
+  SectorDescriptor& sector_1 = sectors_.FromAddress(128);
+  SectorDescriptor& sector_2 = sectors_.FromAddress(256);
+  FillSector(sector_1, 32);
+  FillSector(sector_2, 32);
+
+  // The sectors are equal, so GC picks the first in wear-leveled order.
+  EXPECT_EQ(&sector_1, sectors_.FindSectorToGarbageCollect({}));
+
+  // After sector 1 is erased more than the others, sector 2 is picked.
+  sector_1.RemoveValidBytes(32);
+  sector_1.MarkErased(128);
+  sector_1.MarkErased(128);
+  FillSector(sector_1, 32);
+  EXPECT_EQ(2u, sector_1.erase_count());
+
+  EXPECT_EQ(&sector_2, sectors_.FindSectorToGarbageCollect({}));
+}
+
+// TODO: Add tests for FindSpace and FindSpaceDuringGarbageCollection.
 
 }  // namespace
 }  // namespace pw::kvs::internal
@@ -0,0 +1,90 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/value_cache.h"
+
+#include <algorithm>
+
+namespace pw::kvs {
+
+void ValueCache::Clear() {
+  for (Slot& slot : slots_) {
+    slot = {};
+  }
+}
+
+const ValueCache::Slot* ValueCache::Find(uint32_t key_hash,
+                                         uint32_t transaction_id) {
+  for (Slot& slot : slots_) {
+    if (slot.in_use && slot.key_hash == key_hash &&
+        slot.transaction_id == transaction_id) {
+      hits_.Increment();
+      slot.last_used = ++use_count_;
+      return &slot;
+    }
+  }
+  misses_.Increment();
+  return nullptr;
+}
+
+StatusWithSize ValueCache::Read(const Slot& slot,
+                                std::span<std::byte> buffer,
+                                size_t offset_bytes) const {
+  if (offset_bytes > slot.size_bytes) {
+    return StatusWithSize::OutOfRange();
+  }
+
+  const size_t remaining_bytes = slot.size_bytes - offset_bytes;
+  const size_t read_size = std::min(buffer.size(), remaining_bytes);
+  std::copy_n(value(slot).begin() + offset_bytes, read_size, buffer.begin());
+
+  if (read_size != remaining_bytes) {
+    return StatusWithSize::ResourceExhausted(read_size);
+  }
+  return StatusWithSize(read_size);
+}
+
+void ValueCache::Store(uint32_t key_hash,
+                       uint32_t transaction_id,
+                       std::span<const std::byte> value) {
+  if (value.size() > max_value_size_bytes_) {
+    return;
+  }
+
+  // Replace an older value for the same key, or else the least recently used.
+  Slot* replace = &slots_.front();
+  for (Slot& slot : slots_) {
+    if (slot.in_use && slot.key_hash == key_hash) {
+      replace = &slot;
+      break;
+    }
+    if (!slot.in_use || slot.last_used < replace->last_used) {
+      replace = &slot;
+    }
+  }
+
+  *replace = {
+      .key_hash = key_hash,
+      .transaction_id = transaction_id,
+      .last_used = ++use_count_,
+      .size_bytes = static_cast<uint16_t>(value.size()),
+      .in_use = true,
+  };
+  const size_t index = replace - slots_.data();
+  std::copy(value.begin(),
+            value.end(),
+            values_.begin() + index * max_value_size_bytes_);
+}
+
+}  // namespace pw::kvs
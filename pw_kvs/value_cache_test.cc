@@ -0,0 +1,208 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/value_cache.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kSectorSize = 512;
+constexpr size_t kSectorCount = 4;
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x2d7c91e4, .checksum = &checksum};
+
+class ReadCountingFlash
+    : public FakeFlashMemoryBuffer<kSectorSize, kSectorCount> {
+ public:
+  ReadCountingFlash() : FakeFlashMemoryBuffer(16) {}
+
+  StatusWithSize Read(Address address, std::span<std::byte> output) override {
+    reads += 1;
+    return FakeFlashMemoryBuffer::Read(address, output);
+  }
+
+  size_t reads = 0;
+};
+
+class ValueCacheTest : public ::testing::Test {
+ protected:
+  ValueCacheTest()
+      : partition_(&flash_),
+        kvs_(&partition_, kFormat, {.verify_on_read = true}) {}
+
+  void SetUp() override {
+    ASSERT_EQ(OkStatus(), kvs_.Init());
+    kvs_.set_value_cache(&cache_);
+  }
+
+  ReadCountingFlash flash_;
+  FlashPartition partition_;
+  KeyValueStoreBuffer<16, kSectorCount> kvs_;
+  ValueCacheBuffer<2, 16> cache_;
+};
+
+TEST_F(ValueCacheTest, Get_SecondRead_DoesNotReadFlash) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", uint32_t(123)));
+
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", &value));
+  EXPECT_EQ(0u, cache_.hits());
+  EXPECT_EQ(1u, cache_.misses());
+
+  // Finding the key reads it from flash, but the value is not read.
+  flash_.reads = 0;
+  value = 0;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", &value));
+  EXPECT_EQ(123u, value);
+  EXPECT_EQ(1u, cache_.hits());
+  EXPECT_EQ(1u, flash_.reads);
+}
+
+TEST_F(ValueCacheTest, Get_Span_ReadsLikeFlash) {
+  constexpr std::array<char, 6> kValue = {'c', 'a', 'c', 'h', 'e', '\0'};
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", kValue));
+
+  std::array<char, 8> buffer = {};
+  const std::span<std::byte> buffer_bytes =
+      std::as_writable_bytes(std::span(buffer));
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", buffer_bytes).status());
+  ASSERT_EQ(1u, cache_.misses());
+
+  StatusWithSize result = kvs_.Get("key", buffer_bytes);
+  EXPECT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(kValue.size(), result.size());
+  EXPECT_STREQ("cache", buffer.data());
+
+  buffer = {};
+  result = kvs_.Get("key", buffer_bytes.first(2), 2);
+  EXPECT_EQ(Status::ResourceExhausted(), result.status());
+  EXPECT_EQ(2u, result.size());
+  EXPECT_EQ('c', buffer[0]);
+  EXPECT_EQ('h', buffer[1]);
+
+  result = kvs_.Get("key", buffer_bytes, 7);
+  EXPECT_EQ(Status::OutOfRange(), result.status());
+
+  EXPECT_EQ(kValue.size(), kvs_.ValueSize("key").size());
+  EXPECT_EQ(4u, cache_.hits());
+}
+
+TEST_F(ValueCacheTest, Get_WrongSize_InvalidArgument) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", uint32_t(123)));
+
+  uint32_t value;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", &value));
+
+  uint16_t wrong_size;
+  EXPECT_EQ(Status::InvalidArgument(), kvs_.Get("key", &wrong_size));
+  EXPECT_EQ(1u, cache_.hits());
+}
+
+TEST_F(ValueCacheTest, Put_ReplacesCachedValue) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", uint32_t(1)));
+  uint32_t value;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", &value));
+
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", uint32_t(2)));
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", &value));
+  EXPECT_EQ(2u, value);
+  EXPECT_EQ(0u, cache_.hits());
+  EXPECT_EQ(2u, cache_.misses());
+}
+
+TEST_F(ValueCacheTest, Delete_CachedValueNotReturned) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", uint32_t(1)));
+  uint32_t value;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", &value));
+
+  ASSERT_EQ(OkStatus(), kvs_.Delete("key"));
+  EXPECT_EQ(Status::NotFound(), kvs_.Get("key", &value));
+}
+
+TEST_F(ValueCacheTest, GarbageCollection_ValueStaysCached) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", uint32_t(1)));
+  ASSERT_EQ(OkStatus(), kvs_.Put("stale", uint32_t(2)));
+  ASSERT_EQ(OkStatus(), kvs_.Put("stale", uint32_t(3)));
+
+  uint32_t value;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", &value));
+  ASSERT_EQ(OkStatus(), kvs_.HeavyMaintenance());
+  ASSERT_EQ(1u, kvs_.GetStorageStats().sector_erase_count);
+
+  value = 0;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", &value));
+  EXPECT_EQ(1u, value);
+  EXPECT_EQ(1u, cache_.hits());
+}
+
+TEST_F(ValueCacheTest, Full_ReplacesLeastRecentlyUsed) {
+  uint32_t value;
+  for (uint32_t i = 0; i < 3; ++i) {
+    const char key[] = {char('a' + i), '\0'};
+    ASSERT_EQ(OkStatus(), kvs_.Put(key, i));
+  }
+
+  // Cache a and b, then use a again so b is the least recently used.
+  ASSERT_EQ(OkStatus(), kvs_.Get("a", &value));
+  ASSERT_EQ(OkStatus(), kvs_.Get("b", &value));
+  ASSERT_EQ(OkStatus(), kvs_.Get("a", &value));
+  ASSERT_EQ(OkStatus(), kvs_.Get("c", &value));
+  ASSERT_EQ(1u, cache_.hits());
+
+  ASSERT_EQ(OkStatus(), kvs_.Get("a", &value));
+  EXPECT_EQ(0u, value);
+  ASSERT_EQ(OkStatus(), kvs_.Get("c", &value));
+  EXPECT_EQ(2u, value);
+  EXPECT_EQ(3u, cache_.hits());
+
+  ASSERT_EQ(OkStatus(), kvs_.Get("b", &value));
+  EXPECT_EQ(1u, value);
+  EXPECT_EQ(3u, cache_.hits());
+}
+
+TEST_F(ValueCacheTest, LargeValue_NotCached) {
+  std::array<std::byte, 32> large = {};
+  ASSERT_EQ(OkStatus(), kvs_.Put("large", large));
+
+  ASSERT_EQ(OkStatus(), kvs_.Get("large", large).status());
+  ASSERT_EQ(OkStatus(), kvs_.Get("large", large).status());
+  EXPECT_EQ(0u, cache_.hits());
+  EXPECT_EQ(2u, cache_.misses());
+}
+
+TEST_F(ValueCacheTest, Init_ClearsCache) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", uint32_t(1)));
+  uint32_t value;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", &value));
+
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", &value));
+  EXPECT_EQ(0u, cache_.hits());
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -0,0 +1,235 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#define PW_LOG_MODULE_NAME "KVS"
+#define PW_LOG_LEVEL PW_KVS_LOG_LEVEL
+
+#include "pw_kvs/write_combining_flash_partition.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pw_assert/check.h"
+#include "pw_kvs/alignment.h"
+#include "pw_kvs_private/config.h"
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+
+namespace pw::kvs {
+
+using std::byte;
+
+WriteCombiningFlashPartition::WriteCombiningFlashPartition(
+    ByteSpan page_buffer,
+    std::span<bool> erase_pending,
+    FlashMemory* flash,
+    uint32_t start_sector_index,
+    uint32_t sector_count,
+    uint32_t alignment_bytes,
+    PartitionPermission permission)
+    : FlashPartition(flash,
+                     start_sector_index,
+                     sector_count,
+                     alignment_bytes,
+                     permission),
+      page_buffer_(page_buffer),
+      buffer_address_(0),
+      buffered_bytes_(0),
+      erase_pending_(erase_pending),
+      stats_{} {
+  PW_DCHECK_UINT_GE(erase_pending.size(),
+                    FlashPartition::sector_count(),
+                    "There must be an erase flag for each sector");
+  const size_t page_misalignment = page_buffer.size() % this->alignment_bytes();
+  PW_DCHECK_UINT_EQ(page_misalignment,
+                    0,
+                    "The page size must be a multiple of the alignment");
+  const size_t sector_misalignment = sector_size_bytes() % page_buffer.size();
+  PW_DCHECK_UINT_EQ(sector_misalignment,
+                    0,
+                    "The sector size must be a multiple of the page size");
+}
+
+Status WriteCombiningFlashPartition::Erase(Address address,
+                                           size_t num_sectors) {
+  if (!writable()) {
+    return Status::PermissionDenied();
+  }
+
+  PW_TRY(CheckBounds(address, num_sectors * sector_size_bytes()));
+  const size_t address_sector_offset = address % sector_size_bytes();
+  PW_CHECK_UINT_EQ(address_sector_offset, 0u);
+
+  // Buffered data in the erased sectors would be erased anyway, so drop it.
+  const Address end = address + num_sectors * sector_size_bytes();
+  if (buffered_bytes_ != 0u && buffer_address_ >= address &&
+      buffer_address_ < end) {
+    buffered_bytes_ = 0;
+  }
+
+  const size_t first_sector = address / sector_size_bytes();
+  for (size_t i = first_sector; i < first_sector + num_sectors; ++i) {
+    erase_pending_[i] = true;
+  }
+
+  stats_.erases += num_sectors;
+  return OkStatus();
+}
+
+StatusWithSize WriteCombiningFlashPartition::Read(Address address,
+                                                  std::span<byte> output) {
+  PW_TRY_WITH_SIZE(CheckBounds(address, output.size()));
+
+  if (buffered_bytes_ != 0u && address < buffer_address_ + buffered_bytes_ &&
+      buffer_address_ < address + output.size()) {
+    PW_TRY_WITH_SIZE(Flush());
+  }
+
+  // Read one sector at a time, since sectors with pending erases are not read
+  // from flash.
+  size_t bytes_read = 0;
+  while (bytes_read < output.size()) {
+    const Address read_address = address + bytes_read;
+    const size_t sector = read_address / sector_size_bytes();
+    const size_t sector_end = (sector + 1) * sector_size_bytes();
+    const std::span<byte> chunk = output.subspan(
+        bytes_read,
+        std::min(output.size() - bytes_read, sector_end - read_address));
+
+    if (erase_pending_[sector]) {
+      std::memset(chunk.data(), int(erased_memory_content()), chunk.size());
+    } else {
+      StatusWithSize result = FlashPartition::Read(read_address, chunk);
+      if (!result.ok()) {
+        return StatusWithSize(result.status(), bytes_read + result.size());
+      }
+    }
+    bytes_read += chunk.size();
+  }
+
+  return StatusWithSize(bytes_read);
+}
+
+StatusWithSize WriteCombiningFlashPartition::Write(
+    Address address, std::span<const byte> data) {
+  if (!writable()) {
+    return StatusWithSize::PermissionDenied();
+  }
+  PW_TRY_WITH_SIZE(CheckBounds(address, data.size()));
+  const size_t address_alignment_offset = address % alignment_bytes();
+  PW_CHECK_UINT_EQ(address_alignment_offset, 0u);
+  const size_t size_alignment_offset = data.size() % alignment_bytes();
+  PW_CHECK_UINT_EQ(size_alignment_offset, 0u);
+
+  PW_TRY_WITH_SIZE(ErasePendingSectors(address, data.size()));
+  stats_.writes += 1;
+
+  const size_t size = data.size();
+
+  while (!data.empty()) {
+    // The buffer only holds contiguous data, so write it out if this write
+    // does not continue it.
+    if (buffered_bytes_ != 0u && address != buffer_address_ + buffered_bytes_) {
+      PW_TRY_WITH_SIZE(Flush());
+    }
+
+    // Write whole pages directly rather than copying them.
+    if (buffered_bytes_ == 0u && address % page_size_bytes() == 0u &&
+        data.size() >= page_size_bytes()) {
+      const size_t pages_size = AlignDown(data.size(), page_size_bytes());
+      PW_TRY_WITH_SIZE(WriteToFlash(address, data.first(pages_size)));
+      address += pages_size;
+      data = data.subspan(pages_size);
+      continue;
+    }
+
+    if (buffered_bytes_ == 0u) {
+      buffer_address_ = address;
+    }
+
+    // Copy up to the end of the buffer's page.
+    const size_t page_offset = buffer_address_ % page_size_bytes();
+    const size_t to_copy = std::min(
+        page_size_bytes() - page_offset - buffered_bytes_, data.size());
+    std::memcpy(
+        &page_buffer_[page_offset + buffered_bytes_], data.data(), to_copy);
+    buffered_bytes_ += to_copy;
+    address += to_copy;
+    data = data.subspan(to_copy);
+
+    if (page_offset + buffered_bytes_ == page_size_bytes()) {
+      PW_TRY_WITH_SIZE(Flush());
+    }
+  }
+
+  return StatusWithSize(size);
+}
+
+Status WriteCombiningFlashPartition::Flush() {
+  if (buffered_bytes_ == 0u) {
+    return OkStatus();
+  }
+
+  const size_t page_offset = buffer_address_ % page_size_bytes();
+  const size_t size = buffered_bytes_;
+  buffered_bytes_ = 0;
+  return WriteToFlash(buffer_address_, page_buffer_.subspan(page_offset, size))
+      .status();
+}
+
+Status WriteCombiningFlashPartition::PerformDeferredErases(size_t max_sectors) {
+  for (size_t i = 0; i < sector_count() && max_sectors > 0u; ++i) {
+    if (erase_pending_[i]) {
+      PW_TRY(EraseIfPending(i));
+      max_sectors -= 1;
+    }
+  }
+  return OkStatus();
+}
+
+size_t WriteCombiningFlashPartition::pending_erases() const {
+  return std::count(
+      erase_pending_.begin(), erase_pending_.begin() + sector_count(), true);
+}
+
+Status WriteCombiningFlashPartition::EraseIfPending(size_t sector_index) {
+  if (!erase_pending_[sector_index]) {
+    return OkStatus();
+  }
+
+  PW_TRY(FlashPartition::Erase(sector_index * sector_size_bytes(), 1));
+  erase_pending_[sector_index] = false;
+  stats_.flash_erases += 1;
+  return OkStatus();
+}
+
+Status WriteCombiningFlashPartition::ErasePendingSectors(Address address,
+                                                         size_t size_bytes) {
+  if (size_bytes == 0u) {
+    return OkStatus();
+  }
+
+  const size_t last_sector = (address + size_bytes - 1) / sector_size_bytes();
+  for (size_t i = address / sector_size_bytes(); i <= last_sector; ++i) {
+    PW_TRY(EraseIfPending(i));
+  }
+  return OkStatus();
+}
+
+StatusWithSize WriteCombiningFlashPartition::WriteToFlash(
+    Address address, std::span<const byte> data) {
+  stats_.flash_writes += 1;
+  return FlashPartition::Write(address, data);
+}
+
+}  // namespace pw::kvs
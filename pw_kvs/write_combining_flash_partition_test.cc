@@ -0,0 +1,231 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#include "pw_kvs/write_combining_flash_partition.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+using std::byte;
+
+constexpr size_t kSectorSize = 512;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kAlignment = 16;
+constexpr size_t kPageSize = 64;
+
+class CountingFlash : public FakeFlashMemoryBuffer<kSectorSize, kSectorCount> {
+ public:
+  CountingFlash() : FakeFlashMemoryBuffer(kAlignment) {}
+
+  Status Erase(Address address, size_t num_sectors) override {
+    erases += num_sectors;
+    return FakeFlashMemoryBuffer::Erase(address, num_sectors);
+  }
+
+  StatusWithSize Write(Address address,
+                       std::span<const std::byte> data) override {
+    writes += 1;
+    return FakeFlashMemoryBuffer::Write(address, data);
+  }
+
+  size_t erases = 0;
+  size_t writes = 0;
+};
+
+class WriteCombiningTest : public ::testing::Test {
+ protected:
+  WriteCombiningTest() : partition_(&flash_) {
+    for (size_t i = 0; i < data_.size(); ++i) {
+      data_[i] = byte(i);
+    }
+  }
+
+  std::span<const byte> data(size_t offset, size_t size) const {
+    return std::span(data_).subspan(offset, size);
+  }
+
+  bool FlashContains(size_t address, std::span<const byte> expected) const {
+    return std::memcmp(&flash_.buffer()[address],
+                       expected.data(),
+                       expected.size()) == 0;
+  }
+
+  CountingFlash flash_;
+  WriteCombiningFlashPartitionBuffer<kSectorCount, kPageSize> partition_;
+  std::array<byte, 256> data_;
+};
+
+TEST_F(WriteCombiningTest, Write_AdjacentWritesCombinedIntoPage) {
+  for (size_t offset = 0; offset < kPageSize; offset += kAlignment) {
+    ASSERT_EQ(OkStatus(),
+              partition_.Write(offset, data(offset, kAlignment)).status());
+  }
+
+  EXPECT_EQ(1u, flash_.writes);
+  EXPECT_TRUE(FlashContains(0, data(0, kPageSize)));
+  EXPECT_EQ(4u, partition_.stats().writes);
+  EXPECT_EQ(1u, partition_.stats().flash_writes);
+}
+
+TEST_F(WriteCombiningTest, Write_NonAdjacentWriteFlushesBuffer) {
+  ASSERT_EQ(OkStatus(), partition_.Write(0, data(0, kAlignment)).status());
+  EXPECT_EQ(0u, flash_.writes);
+
+  ASSERT_EQ(OkStatus(), partition_.Write(128, data(0, kAlignment)).status());
+  EXPECT_EQ(1u, flash_.writes);
+  EXPECT_TRUE(FlashContains(0, data(0, kAlignment)));
+
+  ASSERT_EQ(OkStatus(), partition_.Flush());
+  EXPECT_EQ(2u, flash_.writes);
+  EXPECT_TRUE(FlashContains(128, data(0, kAlignment)));
+}
+
+TEST_F(WriteCombiningTest, Write_WholePagesWrittenDirectly) {
+  ASSERT_EQ(OkStatus(), partition_.Write(64, data(0, 192)).status());
+
+  EXPECT_EQ(1u, flash_.writes);
+  EXPECT_TRUE(FlashContains(64, data(0, 192)));
+}
+
+TEST_F(WriteCombiningTest, Write_UnalignedStartBuffersToPageBoundary) {
+  // The first 48 bytes complete the page starting at 0, the next two pages are
+  // written directly, and the last 16 bytes are buffered.
+  ASSERT_EQ(OkStatus(), partition_.Write(16, data(0, 192)).status());
+  EXPECT_EQ(2u, flash_.writes);
+
+  ASSERT_EQ(OkStatus(), partition_.Flush());
+  EXPECT_EQ(3u, flash_.writes);
+  EXPECT_TRUE(FlashContains(16, data(0, 192)));
+}
+
+TEST_F(WriteCombiningTest, Read_FlushesBufferedData) {
+  ASSERT_EQ(OkStatus(), partition_.Write(32, data(0, kAlignment)).status());
+
+  std::array<byte, kAlignment> read;
+  ASSERT_EQ(OkStatus(), partition_.Read(32, read).status());
+  EXPECT_EQ(1u, flash_.writes);
+  EXPECT_EQ(0, std::memcmp(read.data(), data_.data(), read.size()));
+}
+
+TEST_F(WriteCombiningTest, Read_OtherDataDoesNotFlush) {
+  ASSERT_EQ(OkStatus(), partition_.Write(32, data(0, kAlignment)).status());
+
+  std::array<byte, kAlignment> read;
+  ASSERT_EQ(OkStatus(), partition_.Read(256, read).status());
+  EXPECT_EQ(0u, flash_.writes);
+}
+
+TEST_F(WriteCombiningTest, Erase_Deferred) {
+  ASSERT_EQ(OkStatus(), partition_.Write(0, data(0, kPageSize)).status());
+
+  ASSERT_EQ(OkStatus(), partition_.Erase(0, 1));
+  EXPECT_EQ(0u, flash_.erases);
+  EXPECT_EQ(1u, partition_.pending_erases());
+
+  // The sector reads as erased before it is erased in flash.
+  bool erased = false;
+  ASSERT_EQ(OkStatus(), partition_.IsRegionErased(0, kSectorSize, &erased));
+  EXPECT_TRUE(erased);
+  EXPECT_TRUE(FlashContains(0, data(0, kPageSize)));
+
+  ASSERT_EQ(OkStatus(), partition_.PerformDeferredErases());
+  EXPECT_EQ(1u, flash_.erases);
+  EXPECT_EQ(0u, partition_.pending_erases());
+  EXPECT_TRUE(partition_.AppearsErased(flash_.buffer().first(kSectorSize)));
+}
+
+TEST_F(WriteCombiningTest, Erase_Repeated_ErasedOnce) {
+  ASSERT_EQ(OkStatus(), partition_.Erase(0, 2));
+  ASSERT_EQ(OkStatus(), partition_.Erase(0, 1));
+  ASSERT_EQ(OkStatus(), partition_.PerformDeferredErases());
+
+  EXPECT_EQ(2u, flash_.erases);
+  EXPECT_EQ(3u, partition_.stats().erases);
+  EXPECT_EQ(2u, partition_.stats().flash_erases);
+}
+
+TEST_F(WriteCombiningTest, Erase_LimitedNumberOfSectors) {
+  ASSERT_EQ(OkStatus(), partition_.Erase(0, kSectorCount));
+  ASSERT_EQ(OkStatus(), partition_.PerformDeferredErases(1));
+  EXPECT_EQ(1u, flash_.erases);
+  EXPECT_EQ(kSectorCount - 1, partition_.pending_erases());
+}
+
+TEST_F(WriteCombiningTest, Erase_DropsBufferedData) {
+  ASSERT_EQ(OkStatus(), partition_.Write(0, data(0, kAlignment)).status());
+  ASSERT_EQ(OkStatus(), partition_.Erase(0, 1));
+  ASSERT_EQ(OkStatus(), partition_.Flush());
+  EXPECT_EQ(0u, flash_.writes);
+}
+
+TEST_F(WriteCombiningTest, Write_PendingEraseDoneFirst) {
+  ASSERT_EQ(OkStatus(), partition_.Write(0, data(0, kPageSize)).status());
+  ASSERT_EQ(OkStatus(), partition_.Erase(0, 1));
+
+  ASSERT_EQ(OkStatus(), partition_.Write(0, data(64, kPageSize)).status());
+  EXPECT_EQ(1u, flash_.erases);
+  EXPECT_TRUE(FlashContains(0, data(64, kPageSize)));
+}
+
+TEST_F(WriteCombiningTest, Write_ReadOnly_PermissionDenied) {
+  WriteCombiningFlashPartitionBuffer<kSectorCount, kPageSize> read_only(
+      &flash_, 0, kSectorCount, 0, PartitionPermission::kReadOnly);
+
+  EXPECT_EQ(Status::PermissionDenied(),
+            read_only.Write(0, data(0, kAlignment)).status());
+  EXPECT_EQ(Status::PermissionDenied(), read_only.Erase(0, 1));
+}
+
+ChecksumCrc16 checksum;
+
+constexpr EntryFormat kFormat{.magic = 0x5c6e1a0b, .checksum = &checksum};
+
+TEST_F(WriteCombiningTest, KeyValueStore) {
+  // Verifying each write reads it back, which flushes it immediately.
+  KeyValueStoreBuffer<8, kSectorCount> kvs(
+      &partition_, kFormat, {.verify_on_write = false});
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  // Write enough to garbage collect several times.
+  for (uint32_t i = 0; i < 200; ++i) {
+    ASSERT_EQ(OkStatus(), kvs.Put("counter", i));
+    ASSERT_EQ(OkStatus(), kvs.Put("other", i * 2));
+  }
+
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), kvs.Get("counter", &value));
+  EXPECT_EQ(199u, value);
+  EXPECT_LT(partition_.stats().flash_writes, partition_.stats().writes);
+
+  // After everything reaches flash, a KVS on a plain partition sees the values.
+  ASSERT_EQ(OkStatus(), partition_.Flush());
+  ASSERT_EQ(OkStatus(), partition_.PerformDeferredErases());
+
+  FlashPartition plain_partition(&flash_);
+  KeyValueStoreBuffer<8, kSectorCount> reloaded(&plain_partition, kFormat);
+  ASSERT_EQ(OkStatus(), reloaded.Init());
+  ASSERT_EQ(OkStatus(), reloaded.Get("other", &value));
+  EXPECT_EQ(398u, value);
+}
+
+}  // namespace
+}  // namespace pw::kvs
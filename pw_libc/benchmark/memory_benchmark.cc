@@ -0,0 +1,96 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Compares pw_libc's memory functions with the C library's, for the sizes of
+// an RPC packet header, a ring buffer entry, and a flash sector chunk. The
+// C library's functions are called through volatile function pointers, so the
+// compiler cannot inline them or replace them with its builtins.
+//
+// If pw_libc:memory_functions is linked, the C library functions are pw_libc's
+// and both sets of results are the same.
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include "pw_benchmark/benchmark.h"
+#include "pw_libc/memory.h"
+
+namespace pw::libc {
+namespace {
+
+using benchmark::DoNotOptimize;
+using benchmark::State;
+
+using CopyFunction = void* (*)(void*, const void*, size_t);
+using SetFunction = void* (*)(void*, int, size_t);
+
+CopyFunction volatile c_memcpy = std::memcpy;
+CopyFunction volatile c_memmove = std::memmove;
+SetFunction volatile c_memset = std::memset;
+
+alignas(8) std::array<std::byte, 1024 + 8> source;
+alignas(8) std::array<std::byte, 1024 + 8> destination;
+
+void Copy(State& state,
+          CopyFunction copy,
+          size_t size,
+          size_t source_offset = 0) {
+  DoNotOptimize(size);
+  for (auto _ : state) {
+    DoNotOptimize(copy(&destination[0], &source[source_offset], size));
+    benchmark::ClobberMemory();
+  }
+}
+
+void Move(State& state, CopyFunction move, size_t size) {
+  DoNotOptimize(size);
+  for (auto _ : state) {
+    // Shift the buffer up by one word, as when inserting into a sorted array.
+    DoNotOptimize(move(&destination[4], &destination[0], size));
+    benchmark::ClobberMemory();
+  }
+}
+
+void Set(State& state, SetFunction set, size_t size) {
+  DoNotOptimize(size);
+  for (auto _ : state) {
+    DoNotOptimize(set(&destination[0], 0, size));
+    benchmark::ClobberMemory();
+  }
+}
+
+PW_BENCHMARK(Memcpy, C_16B) { Copy(state, c_memcpy, 16); }
+PW_BENCHMARK(Memcpy, PwLibc_16B) { Copy(state, Memcpy, 16); }
+
+PW_BENCHMARK(Memcpy, C_256B) { Copy(state, c_memcpy, 256); }
+PW_BENCHMARK(Memcpy, PwLibc_256B) { Copy(state, Memcpy, 256); }
+
+PW_BENCHMARK(Memcpy, C_1KiB) { Copy(state, c_memcpy, 1024); }
+PW_BENCHMARK(Memcpy, PwLibc_1KiB) { Copy(state, Memcpy, 1024); }
+
+PW_BENCHMARK(Memcpy, C_1KiB_Unaligned) { Copy(state, c_memcpy, 1024, 1); }
+PW_BENCHMARK(Memcpy, PwLibc_1KiB_Unaligned) { Copy(state, Memcpy, 1024, 1); }
+
+PW_BENCHMARK(Memmove, C_1KiB) { Move(state, c_memmove, 1024); }
+PW_BENCHMARK(Memmove, PwLibc_1KiB) { Move(state, Memmove, 1024); }
+
+PW_BENCHMARK(Memset, C_256B) { Set(state, c_memset, 256); }
+PW_BENCHMARK(Memset, PwLibc_256B) { Set(state, Memset, 256); }
+
+PW_BENCHMARK(Memset, C_1KiB) { Set(state, c_memset, 1024); }
+PW_BENCHMARK(Memset, PwLibc_1KiB) { Set(state, Memset, 1024); }
+
+}  // namespace
+}  // namespace pw::libc
@@ -0,0 +1,245 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_libc/memory.h"
+
+#include <cstdint>
+
+// The compiler may recognize the byte and word loops below as memcpy or memset
+// and replace them with calls to those functions, which would recurse when
+// these functions are linked as memcpy and memset.
+#if defined(__clang__)
+#define PW_LIBC_NO_BUILTIN_CALLS __attribute__((no_builtin))
+#elif defined(__GNUC__)
+#define PW_LIBC_NO_BUILTIN_CALLS \
+  __attribute__((optimize("no-tree-loop-distribute-patterns")))
+#else
+#define PW_LIBC_NO_BUILTIN_CALLS
+#endif  // defined(__clang__)
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#define PW_LIBC_ARMV7M 1
+#else
+#define PW_LIBC_ARMV7M 0
+#endif  // defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+
+namespace pw::libc {
+namespace {
+
+// Words may alias any object, like unsigned char.
+using Word = uintptr_t __attribute__((__may_alias__));
+
+// Loads a word from an address that may not be word aligned. ARMv7-M and most
+// host CPUs support unaligned word loads in hardware.
+struct __attribute__((__packed__, __may_alias__)) UnalignedWord {
+  Word value;
+};
+
+constexpr size_t kWordSize = sizeof(Word);
+constexpr size_t kBlockSize = 4 * kWordSize;
+
+bool IsAligned(const void* address) {
+  return reinterpret_cast<uintptr_t>(address) % kWordSize == 0u;
+}
+
+// Copies blocks of four words from aligned src to aligned dest. Returns the
+// number of bytes left over.
+PW_LIBC_NO_BUILTIN_CALLS size_t CopyBlocks(Word*& dest,
+                                           const Word*& src,
+                                           size_t count) {
+#if PW_LIBC_ARMV7M
+  for (; count >= 2 * kBlockSize; count -= 2 * kBlockSize) {
+    asm volatile(
+        "ldmia %[src]!, {r3, r4, r5, r6}\n"
+        "stmia %[dest]!, {r3, r4, r5, r6}\n"
+        "ldmia %[src]!, {r3, r4, r5, r6}\n"
+        "stmia %[dest]!, {r3, r4, r5, r6}\n"
+        : [dest] "+r"(dest), [src] "+r"(src)
+        :
+        : "r3", "r4", "r5", "r6", "memory");
+  }
+#endif  // PW_LIBC_ARMV7M
+  for (; count >= kBlockSize; count -= kBlockSize) {
+    const Word a = src[0];
+    const Word b = src[1];
+    const Word c = src[2];
+    const Word d = src[3];
+    dest[0] = a;
+    dest[1] = b;
+    dest[2] = c;
+    dest[3] = d;
+    dest += 4;
+    src += 4;
+  }
+  return count;
+}
+
+// Copies forward. Every word is read before it is written, so this is also
+// safe for overlapping buffers if dest is below src.
+PW_LIBC_NO_BUILTIN_CALLS void CopyForward(unsigned char* dest,
+                                          const unsigned char* src,
+                                          size_t count) {
+  if (count >= 2 * kWordSize) {
+    while (!IsAligned(dest)) {
+      *dest++ = *src++;
+      count -= 1;
+    }
+
+    Word* dest_word = reinterpret_cast<Word*>(dest);
+
+    if (IsAligned(src)) {
+      const Word* src_word = reinterpret_cast<const Word*>(src);
+      count = CopyBlocks(dest_word, src_word, count);
+
+      for (; count >= kWordSize; count -= kWordSize) {
+        *dest_word++ = *src_word++;
+      }
+      src = reinterpret_cast<const unsigned char*>(src_word);
+    } else {
+      const UnalignedWord* src_word =
+          reinterpret_cast<const UnalignedWord*>(src);
+
+      for (; count >= kWordSize; count -= kWordSize) {
+        *dest_word++ = (src_word++)->value;
+      }
+      src = reinterpret_cast<const unsigned char*>(src_word);
+    }
+
+    dest = reinterpret_cast<unsigned char*>(dest_word);
+  }
+
+  while (count-- != 0u) {
+    *dest++ = *src++;
+  }
+}
+
+// Copies backward, for overlapping buffers where dest is above src. dest and
+// src point just past the end of the buffers.
+PW_LIBC_NO_BUILTIN_CALLS void CopyBackward(unsigned char* dest,
+                                           const unsigned char* src,
+                                           size_t count) {
+  if (count >= 2 * kWordSize) {
+    while (!IsAligned(dest)) {
+      *--dest = *--src;
+      count -= 1;
+    }
+
+    Word* dest_word = reinterpret_cast<Word*>(dest);
+
+    if (IsAligned(src)) {
+      const Word* src_word = reinterpret_cast<const Word*>(src);
+      for (; count >= kWordSize; count -= kWordSize) {
+        *--dest_word = *--src_word;
+      }
+      src = reinterpret_cast<const unsigned char*>(src_word);
+    } else {
+      const UnalignedWord* src_word =
+          reinterpret_cast<const UnalignedWord*>(src);
+      for (; count >= kWordSize; count -= kWordSize) {
+        *--dest_word = (--src_word)->value;
+      }
+      src = reinterpret_cast<const unsigned char*>(src_word);
+    }
+
+    dest = reinterpret_cast<unsigned char*>(dest_word);
+  }
+
+  while (count-- != 0u) {
+    *--dest = *--src;
+  }
+}
+
+}  // namespace
+
+PW_LIBC_NO_BUILTIN_CALLS void* Memcpy(void* dest,
+                                      const void* src,
+                                      size_t count) {
+  CopyForward(static_cast<unsigned char*>(dest),
+              static_cast<const unsigned char*>(src),
+              count);
+  return dest;
+}
+
+PW_LIBC_NO_BUILTIN_CALLS void* Memmove(void* dest,
+                                       const void* src,
+                                       size_t count) {
+  unsigned char* const dest_bytes = static_cast<unsigned char*>(dest);
+  const unsigned char* const src_bytes = static_cast<const unsigned char*>(src);
+
+  // Compare addresses as integers, since the buffers may be unrelated.
+  const uintptr_t dest_address = reinterpret_cast<uintptr_t>(dest);
+  const uintptr_t src_address = reinterpret_cast<uintptr_t>(src);
+
+  if (dest_address - src_address >= count) {
+    // dest is below src, or the buffers do not overlap.
+    CopyForward(dest_bytes, src_bytes, count);
+  } else if (dest_address != src_address) {
+    CopyBackward(dest_bytes + count, src_bytes + count, count);
+  }
+  return dest;
+}
+
+PW_LIBC_NO_BUILTIN_CALLS void* Memset(void* dest, int value, size_t count) {
+  unsigned char* bytes = static_cast<unsigned char*>(dest);
+  const unsigned char byte = static_cast<unsigned char>(value);
+
+  if (count >= 2 * kWordSize) {
+    while (!IsAligned(bytes)) {
+      *bytes++ = byte;
+      count -= 1;
+    }
+
+    // Repeat the byte in every byte of the word.
+    const Word word = static_cast<Word>(~Word{0} / 0xffu) * byte;
+    Word* dest_word = reinterpret_cast<Word*>(bytes);
+
+#if PW_LIBC_ARMV7M
+    if (size_t blocks = count / (2 * kBlockSize); blocks != 0u) {
+      count %= 2 * kBlockSize;
+      asm volatile(
+          "mov r3, %[word]\n"
+          "mov r4, %[word]\n"
+          "mov r5, %[word]\n"
+          "mov r6, %[word]\n"
+          "1:\n"
+          "stmia %[dest]!, {r3, r4, r5, r6}\n"
+          "stmia %[dest]!, {r3, r4, r5, r6}\n"
+          "subs %[blocks], %[blocks], #1\n"
+          "bne 1b\n"
+          : [dest] "+r"(dest_word), [blocks] "+r"(blocks)
+          : [word] "r"(word)
+          : "r3", "r4", "r5", "r6", "cc", "memory");
+    }
+#endif  // PW_LIBC_ARMV7M
+    for (; count >= kBlockSize; count -= kBlockSize) {
+      dest_word[0] = word;
+      dest_word[1] = word;
+      dest_word[2] = word;
+      dest_word[3] = word;
+      dest_word += 4;
+    }
+    for (; count >= kWordSize; count -= kWordSize) {
+      *dest_word++ = word;
+    }
+
+    bytes = reinterpret_cast<unsigned char*>(dest_word);
+  }
+
+  while (count-- != 0u) {
+    *bytes++ = byte;
+  }
+  return dest;
+}
+
+}  // namespace pw::libc
@@ -0,0 +1,37 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Links pw_libc's memory functions in place of the C library's. These
+// definitions take precedence over the C library's because they are in an
+// object file rather than an archive.
+
+#include <cstddef>
+
+#include "pw_libc/memory.h"
+
+extern "C" {
+
+void* memcpy(void* dest, const void* src, size_t count) {
+  return pw::libc::Memcpy(dest, src, count);
+}
+
+void* memmove(void* dest, const void* src, size_t count) {
+  return pw::libc::Memmove(dest, src, count);
+}
+
+void* memset(void* dest, int value, size_t count) {
+  return pw::libc::Memset(dest, value, count);
+}
+
+}  // extern "C"
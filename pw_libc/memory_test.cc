@@ -0,0 +1,120 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_libc/memory.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw::libc {
+namespace {
+
+// Covers every alignment of the source and destination relative to a word,
+// and sizes up to several of the largest blocks that are copied at once.
+constexpr size_t kMaxOffset = 2 * sizeof(uintptr_t);
+constexpr size_t kMaxSize = 100;
+constexpr size_t kBufferSize = kMaxSize + 2 * kMaxOffset;
+
+using Buffer = std::array<unsigned char, kBufferSize>;
+
+Buffer Pattern(unsigned seed) {
+  Buffer buffer;
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    buffer[i] = static_cast<unsigned char>(i * 7 + seed);
+  }
+  return buffer;
+}
+
+// Byte-at-a-time reference implementation of memmove.
+void ReferenceMove(unsigned char* dest, const unsigned char* src, size_t size) {
+  Buffer temp;
+  for (size_t i = 0; i < size; ++i) {
+    temp[i] = src[i];
+  }
+  for (size_t i = 0; i < size; ++i) {
+    dest[i] = temp[i];
+  }
+}
+
+TEST(Memcpy, AllAlignmentsAndSizes) {
+  const Buffer source = Pattern(1);
+
+  for (size_t dest_offset = 0; dest_offset < kMaxOffset; ++dest_offset) {
+    for (size_t src_offset = 0; src_offset < kMaxOffset; ++src_offset) {
+      for (size_t size = 0; size <= kMaxSize; ++size) {
+        Buffer actual = Pattern(2);
+        Buffer expected = Pattern(2);
+
+        void* result =
+            Memcpy(&actual[dest_offset], &source[src_offset], size);
+        ReferenceMove(&expected[dest_offset], &source[src_offset], size);
+
+        ASSERT_EQ(result, &actual[dest_offset]);
+        ASSERT_EQ(actual, expected);
+      }
+    }
+  }
+}
+
+TEST(Memmove, OverlappingBuffers) {
+  for (size_t dest_offset = 0; dest_offset < 2 * kMaxOffset; ++dest_offset) {
+    for (size_t src_offset = 0; src_offset < 2 * kMaxOffset; ++src_offset) {
+      for (size_t size = 0; size <= kMaxSize; ++size) {
+        Buffer actual = Pattern(3);
+        Buffer expected = Pattern(3);
+
+        void* result =
+            Memmove(&actual[dest_offset], &actual[src_offset], size);
+        ReferenceMove(&expected[dest_offset], &expected[src_offset], size);
+
+        ASSERT_EQ(result, &actual[dest_offset]);
+        ASSERT_EQ(actual, expected);
+      }
+    }
+  }
+}
+
+TEST(Memset, AllAlignmentsAndSizes) {
+  for (size_t offset = 0; offset < kMaxOffset; ++offset) {
+    for (size_t size = 0; size <= kMaxSize; ++size) {
+      Buffer actual = Pattern(4);
+      Buffer expected = Pattern(4);
+
+      void* result = Memset(&actual[offset], 0x1a5, size);
+      for (size_t i = 0; i < size; ++i) {
+        expected[offset + i] = 0xa5;
+      }
+
+      ASSERT_EQ(result, &actual[offset]);
+      ASSERT_EQ(actual, expected);
+    }
+  }
+}
+
+TEST(Memset, Zero) {
+  std::array<uint32_t, 16> words;
+  words.fill(0xffffffffu);
+
+  Memset(words.data(), 0, sizeof(words));
+
+  for (uint32_t word : words) {
+    EXPECT_EQ(word, 0u);
+  }
+}
+
+}  // namespace
+}  // namespace pw::libc
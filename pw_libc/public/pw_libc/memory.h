@@ -0,0 +1,37 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+
+namespace pw::libc {
+
+// Word-oriented implementations of memcpy, memmove, and memset. They copy or
+// set a byte at a time until the destination is word aligned, then a word or
+// more at a time. On ARMv7-M, aligned copies move 32 bytes per iteration with
+// LDM/STM.
+//
+// These are linked in place of the toolchain's C library functions by the
+// pw_libc:memory_functions target, and may also be called directly.
+
+// Copies count bytes from src to dest, which must not overlap. Returns dest.
+void* Memcpy(void* dest, const void* src, size_t count);
+
+// Copies count bytes from src to dest, which may overlap. Returns dest.
+void* Memmove(void* dest, const void* src, size_t count);
+
+// Sets count bytes at dest to the low byte of value. Returns dest.
+void* Memset(void* dest, int value, size_t count);
+
+}  // namespace pw::libc
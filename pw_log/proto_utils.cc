@@ -17,17 +17,16 @@
 #include "pw_log/levels.h"
 #include "pw_log/proto/log.pwpb.h"
 #include "pw_log_tokenized/metadata.h"
+#include "pw_protobuf/decoder.h"
 #include "pw_protobuf/wire_format.h"
 
 namespace pw::log {
+namespace {
 
-Result<ConstByteSpan> EncodeTokenizedLog(pw::log_tokenized::Metadata metadata,
-                                         ConstByteSpan tokenized_data,
-                                         int64_t ticks_since_epoch,
-                                         ByteSpan encode_buffer) {
-  // Encode message to the LogEntry protobuf.
-  LogEntry::RamEncoder encoder(encode_buffer);
-
+// Writes the fields that precede the timestamp.
+void EncodeMessageAndMetadata(LogEntry::RamEncoder& encoder,
+                              log_tokenized::Metadata metadata,
+                              ConstByteSpan tokenized_data) {
   encoder.WriteMessage(tokenized_data);
   encoder.WriteLineLevel(
       (metadata.level() & PW_LOG_LEVEL_BITMASK) |
@@ -35,10 +34,88 @@ Result<ConstByteSpan> EncodeTokenizedLog(pw::log_tokenized::Metadata metadata,
   if (metadata.flags() != 0) {
     encoder.WriteFlags(metadata.flags());
   }
+}
+
+}  // namespace
+
+Result<ConstByteSpan> EncodeTokenizedLog(pw::log_tokenized::Metadata metadata,
+                                         ConstByteSpan tokenized_data,
+                                         int64_t ticks_since_epoch,
+                                         ByteSpan encode_buffer) {
+  // Encode message to the LogEntry protobuf.
+  LogEntry::RamEncoder encoder(encode_buffer);
+
+  EncodeMessageAndMetadata(encoder, metadata, tokenized_data);
   encoder.WriteTimestamp(ticks_since_epoch);
 
   PW_TRY(encoder.status());
   return ConstByteSpan(encoder);
 }
 
+Result<ConstByteSpan> TokenizedLogEncoder::Encode(
+    log_tokenized::Metadata metadata,
+    ConstByteSpan tokenized_data,
+    int64_t ticks_since_epoch,
+    ByteSpan encode_buffer) {
+  LogEntry::RamEncoder encoder(encode_buffer);
+
+  EncodeMessageAndMetadata(encoder, metadata, tokenized_data);
+  if (has_previous_) {
+    encoder.WriteTimeSinceLastEntry(ticks_since_epoch - previous_ticks_);
+  } else {
+    encoder.WriteTimestamp(ticks_since_epoch);
+  }
+
+  PW_TRY(encoder.status());
+  previous_ticks_ = ticks_since_epoch;
+  has_previous_ = true;
+  return ConstByteSpan(encoder);
+}
+
+Result<LogEntryFields> LogEntryDecoder::Decode(ConstByteSpan entry) {
+  LogEntryFields fields = {};
+  fields.timestamp = previous_timestamp_;
+
+  protobuf::Decoder decoder(entry);
+  Status status;
+  while ((status = decoder.Next()).ok()) {
+    switch (static_cast<LogEntry::Fields>(decoder.FieldNumber())) {
+      case LogEntry::Fields::MESSAGE:
+        status = decoder.ReadBytes(&fields.message);
+        break;
+      case LogEntry::Fields::LINE_LEVEL: {
+        uint32_t line_level = 0;
+        status = decoder.ReadUint32(&line_level);
+        fields.level = line_level & PW_LOG_LEVEL_BITMASK;
+        fields.line = line_level >> PW_LOG_LEVEL_BITS;
+        break;
+      }
+      case LogEntry::Fields::FLAGS:
+        status = decoder.ReadUint32(&fields.flags);
+        break;
+      case LogEntry::Fields::TIMESTAMP:
+        status = decoder.ReadInt64(&fields.timestamp);
+        break;
+      case LogEntry::Fields::TIME_SINCE_LAST_ENTRY: {
+        int64_t delta = 0;
+        status = decoder.ReadInt64(&delta);
+        fields.timestamp = previous_timestamp_ + delta;
+        break;
+      }
+      default:
+        // Skip fields added after this decoder was written.
+        break;
+    }
+    if (!status.ok()) {
+      return Status::DataLoss();
+    }
+  }
+  if (!status.IsOutOfRange()) {
+    return Status::DataLoss();
+  }
+
+  previous_timestamp_ = fields.timestamp;
+  return fields;
+}
+
 }  // namespace pw::log
@@ -110,4 +110,97 @@ TEST(UtilsTest, EncodeTokenizedLog_InsufficientSpace) {
   EXPECT_TRUE(result.status().IsResourceExhausted());
 }
 
+TEST(TokenizedLogEncoder, DeltaEncodesTimestamps) {
+  constexpr std::byte kTokenizedData[1] = {(std::byte)0x01};
+  std::byte first_buffer[32];
+  std::byte second_buffer[32];
+  std::byte absolute_buffer[32];
+
+  pw::log_tokenized::Metadata metadata =
+      pw::log_tokenized::Metadata::Set<1, 2, 3, 4>();
+
+  TokenizedLogEncoder encoder;
+  Result<ConstByteSpan> first =
+      encoder.Encode(metadata, kTokenizedData, 1'000'000'000, first_buffer);
+  Result<ConstByteSpan> second =
+      encoder.Encode(metadata, kTokenizedData, 1'000'000'005, second_buffer);
+  ASSERT_TRUE(first.ok());
+  ASSERT_TRUE(second.ok());
+
+  // The first entry has an absolute timestamp and the second a small delta.
+  pw::protobuf::Decoder log_decoder(first.value());
+  VerifyLogEntry(log_decoder, metadata, kTokenizedData, 1'000'000'000);
+
+  Result<ConstByteSpan> absolute = EncodeTokenizedLog(
+      metadata, kTokenizedData, 1'000'000'005, absolute_buffer);
+  ASSERT_TRUE(absolute.ok());
+  EXPECT_LT(second.value().size() + 3, absolute.value().size());
+
+  LogEntryDecoder decoder;
+  Result<LogEntryFields> fields = decoder.Decode(first.value());
+  ASSERT_TRUE(fields.ok());
+  EXPECT_EQ(1'000'000'000, fields.value().timestamp);
+
+  fields = decoder.Decode(second.value());
+  ASSERT_TRUE(fields.ok());
+  EXPECT_EQ(1'000'000'005, fields.value().timestamp);
+  EXPECT_EQ(metadata.level(), fields.value().level);
+  EXPECT_EQ(metadata.line_number(), fields.value().line);
+  EXPECT_EQ(metadata.flags(), fields.value().flags);
+  ASSERT_EQ(sizeof(kTokenizedData), fields.value().message.size());
+  EXPECT_EQ(kTokenizedData[0], fields.value().message[0]);
+}
+
+TEST(TokenizedLogEncoder, ResetWritesAbsoluteTimestamp) {
+  constexpr std::byte kTokenizedData[1] = {(std::byte)0x01};
+  std::byte encode_buffer[32];
+
+  pw::log_tokenized::Metadata metadata =
+      pw::log_tokenized::Metadata::Set<1, 2, 0, 4>();
+
+  TokenizedLogEncoder encoder;
+  ASSERT_TRUE(encoder.Encode(metadata, kTokenizedData, 10, encode_buffer).ok());
+  encoder.Reset();
+
+  Result<ConstByteSpan> result =
+      encoder.Encode(metadata, kTokenizedData, 20, encode_buffer);
+  ASSERT_TRUE(result.ok());
+  pw::protobuf::Decoder log_decoder(result.value());
+  VerifyLogEntry(log_decoder, metadata, kTokenizedData, 20);
+}
+
+TEST(TokenizedLogEncoder, FailedEncodeKeepsPreviousTimestamp) {
+  constexpr std::byte kTokenizedData[1] = {(std::byte)0x01};
+  std::byte encode_buffer[32];
+  std::byte small_buffer[1];
+
+  pw::log_tokenized::Metadata metadata =
+      pw::log_tokenized::Metadata::Set<1, 2, 0, 4>();
+
+  TokenizedLogEncoder encoder;
+  Result<ConstByteSpan> first =
+      encoder.Encode(metadata, kTokenizedData, 10, encode_buffer);
+  ASSERT_TRUE(first.ok());
+  EXPECT_TRUE(encoder.Encode(metadata, kTokenizedData, 15, small_buffer)
+                  .status()
+                  .IsResourceExhausted());
+
+  // The delta is relative to the last entry that was encoded.
+  LogEntryDecoder decoder;
+  ASSERT_TRUE(decoder.Decode(first.value()).ok());
+  Result<ConstByteSpan> second =
+      encoder.Encode(metadata, kTokenizedData, 20, encode_buffer);
+  ASSERT_TRUE(second.ok());
+  Result<LogEntryFields> fields = decoder.Decode(second.value());
+  ASSERT_TRUE(fields.ok());
+  EXPECT_EQ(20, fields.value().timestamp);
+}
+
+TEST(LogEntryDecoder, InvalidEntry) {
+  constexpr std::byte kTruncated[] = {std::byte{0x0a}, std::byte{0x05}};
+
+  LogEntryDecoder decoder;
+  EXPECT_TRUE(decoder.Decode(kTruncated).status().IsDataLoss());
+}
+
 }  // namespace pw::log
@@ -13,6 +13,8 @@
 // the License.
 #pragma once
 
+#include <cstdint>
+
 #include "pw_bytes/span.h"
 #include "pw_log_tokenized/metadata.h"
 #include "pw_result/result.h"
@@ -44,4 +46,59 @@ inline Result<ConstByteSpan> EncodeTokenizedLog(
       encode_buffer);
 }
 
+// Encodes tokenized logs as LogEntry protos, delta encoding the timestamps of
+// consecutive entries. The first entry after construction or Reset() has an
+// absolute timestamp. Each following entry has the ticks since the previous
+// entry in time_since_last_entry, which takes 1-3 bytes for typical gaps rather
+// than 5 or more for an absolute timestamp.
+//
+// Entries must be decoded in the order they were encoded. Call Reset() before
+// any entry that may be decoded without its predecessor, such as the first
+// entry of each LogEntries message.
+class TokenizedLogEncoder {
+ public:
+  constexpr TokenizedLogEncoder() : previous_ticks_(0), has_previous_(false) {}
+
+  // Encodes a log the same way as EncodeTokenizedLog(), except for the
+  // timestamp. If encoding fails, the encoder's state is unchanged.
+  Result<ConstByteSpan> Encode(log_tokenized::Metadata metadata,
+                               ConstByteSpan tokenized_data,
+                               int64_t ticks_since_epoch,
+                               ByteSpan encode_buffer);
+
+  // The next entry is encoded with an absolute timestamp.
+  void Reset() { has_previous_ = false; }
+
+ private:
+  int64_t previous_ticks_;
+  bool has_previous_;
+};
+
+// The fields of a decoded LogEntry.
+struct LogEntryFields {
+  ConstByteSpan message;
+  uint32_t level;
+  uint32_t line;
+  uint32_t flags;
+  int64_t timestamp;
+};
+
+// Decodes LogEntry protos, converting time_since_last_entry into absolute
+// timestamps. Entries must be decoded in the order they were encoded, and
+// Reset() must be called wherever the encoder was reset. An entry without a
+// timestamp has the same timestamp as the previous entry.
+class LogEntryDecoder {
+ public:
+  constexpr LogEntryDecoder() : previous_timestamp_(0) {}
+
+  // Returns DATA_LOSS if the entry is not a valid LogEntry. The message refers
+  // to the entry's buffer.
+  Result<LogEntryFields> Decode(ConstByteSpan entry);
+
+  void Reset() { previous_timestamp_ = 0; }
+
+ private:
+  int64_t previous_timestamp_;
+};
+
 }  // namespace pw::log
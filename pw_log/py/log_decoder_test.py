@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Tests decoding LogEntry protos."""
+
+import unittest
+
+from pw_log.log_decoder import DecodedLogEntry, LogEntryDecoder
+from pw_log.proto import log_pb2
+
+
+class TestLogEntryDecoder(unittest.TestCase):
+    """Tests resolving delta encoded timestamps."""
+    def setUp(self) -> None:
+        self.decoder = LogEntryDecoder()
+
+    def test_absolute_timestamp(self):
+        entry = log_pb2.LogEntry(message=b'\x01',
+                                 line_level=1234 << 3 | 2,
+                                 flags=3,
+                                 timestamp=1000)
+        self.assertEqual(
+            self.decoder.decode(entry),
+            DecodedLogEntry(message=b'\x01',
+                            level=2,
+                            line=1234,
+                            flags=3,
+                            timestamp=1000))
+
+    def test_time_since_last_entry(self):
+        entries = log_pb2.LogEntries(entries=[
+            log_pb2.LogEntry(message=b'a', timestamp=1000),
+            log_pb2.LogEntry(message=b'b', time_since_last_entry=5),
+            log_pb2.LogEntry(message=b'c', time_since_last_entry=0),
+            log_pb2.LogEntry(message=b'd', time_since_last_entry=20),
+        ])
+        decoded = self.decoder.decode_entries(entries)
+        self.assertEqual([entry.timestamp for entry in decoded],
+                         [1000, 1005, 1005, 1025])
+
+    def test_decode_entries_resets(self):
+        entries = log_pb2.LogEntries(
+            entries=[log_pb2.LogEntry(time_since_last_entry=5)])
+        self.decoder.decode(log_pb2.LogEntry(timestamp=1000))
+        self.assertEqual(self.decoder.decode_entries(entries)[0].timestamp, 5)
+
+    def test_missing_timestamp_uses_previous(self):
+        self.decoder.decode(log_pb2.LogEntry(timestamp=1000))
+        self.assertEqual(
+            self.decoder.decode(log_pb2.LogEntry(message=b'x')).timestamp,
+            1000)
+
+
+if __name__ == '__main__':
+    unittest.main()
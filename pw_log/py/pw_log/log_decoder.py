@@ -0,0 +1,69 @@
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Decodes LogEntry protos, including delta encoded timestamps."""
+
+from dataclasses import dataclass
+from typing import List
+
+from pw_log.proto import log_pb2
+
+# Matches PW_LOG_LEVEL_BITS and PW_LOG_LEVEL_BITMASK in pw_log/levels.h.
+_LEVEL_BITS = 3
+_LEVEL_BITMASK = (1 << _LEVEL_BITS) - 1
+
+
+@dataclass(frozen=True)
+class DecodedLogEntry:
+    """The fields of a LogEntry, with an absolute timestamp."""
+    message: bytes
+    level: int
+    line: int
+    flags: int
+    timestamp: int
+
+
+class LogEntryDecoder:
+    """Converts time_since_last_entry into absolute timestamps.
+
+    Matches pw::log::LogEntryDecoder. Entries must be decoded in the order they
+    were encoded. An entry without a timestamp has the same timestamp as the
+    previous entry.
+    """
+    def __init__(self) -> None:
+        self._previous_timestamp = 0
+
+    def reset(self) -> None:
+        self._previous_timestamp = 0
+
+    def decode(self, entry: log_pb2.LogEntry) -> DecodedLogEntry:
+        time_field = entry.WhichOneof('time')
+        if time_field == 'timestamp':
+            timestamp = entry.timestamp
+        elif time_field == 'time_since_last_entry':
+            timestamp = self._previous_timestamp + entry.time_since_last_entry
+        else:
+            timestamp = self._previous_timestamp
+
+        self._previous_timestamp = timestamp
+        return DecodedLogEntry(message=entry.message,
+                               level=entry.line_level & _LEVEL_BITMASK,
+                               line=entry.line_level >> _LEVEL_BITS,
+                               flags=entry.flags,
+                               timestamp=timestamp)
+
+    def decode_entries(self,
+                       entries: log_pb2.LogEntries) -> List[DecodedLogEntry]:
+        """Decodes a LogEntries message, whose first entry starts a batch."""
+        self.reset()
+        return [self.decode(entry) for entry in entries.entries]
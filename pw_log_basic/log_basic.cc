@@ -23,6 +23,20 @@
 #include "pw_string/string_builder.h"
 #include "pw_sys_io/sys_io.h"
 
+#if PW_LOG_BASIC_DEFERRED
+#include <cstdarg>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <utility>
+
+#include "pw_bytes/span.h"
+#include "pw_ring_buffer/prefixed_entry_ring_buffer.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_tokenizer/encode_args.h"
+#include "pw_varint/varint.h"
+#endif  // PW_LOG_BASIC_DEFERRED
+
 // ANSI color constants to control the terminal. Not Windows compatible.
 // clang-format off
 #define MAGENTA   "\033[35m"
@@ -87,20 +101,14 @@ void (*write_log)(std::string_view) = [](std::string_view log) {
   sys_io::WriteLine(log);
 };
 
-}  // namespace
-
-// This is a fully loaded, inefficient-at-the-callsite, log implementation.
-extern "C" void pw_Log(int level,
-                       unsigned int flags,
-                       const char* module_name,
-                       const char* file_name,
-                       int line_number,
-                       const char* function_name,
-                       const char* message,
-                       ...) {
-  // Accumulate the log message in this buffer, then output it.
-  pw::StringBuffer<150> buffer;
-
+// Appends the columns that precede the log message.
+void AppendPrefix(StringBuilder& buffer,
+                  int level,
+                  unsigned int flags,
+                  const char* module_name,
+                  const char* file_name,
+                  int line_number,
+                  const char* function_name) {
   // Column: Timestamp
   // Note that this macro method defaults to a no-op.
   PW_LOG_APPEND_TIMESTAMP(buffer);
@@ -143,6 +151,256 @@ extern "C" void pw_Log(int level,
 
   // Column: Level
   buffer << LogLevelToLogLevelName(level) << "  ";
+}
+
+#if PW_LOG_BASIC_DEFERRED
+
+// Deferred logs are stored as this header followed by the arguments, encoded
+// by pw_tokenizer.
+struct DeferredLogHeader {
+  const char* module_name;
+  const char* file_name;
+  const char* function_name;
+  const char* message;
+  pw_tokenizer_ArgTypes arg_types;
+  int level;
+  unsigned int flags;
+  int line_number;
+};
+
+constexpr size_t kMaxDeferredLogSize =
+    sizeof(DeferredLogHeader) + PW_LOG_BASIC_DEFERRED_ARGS_SIZE_BYTES;
+
+class DeferredLogs {
+ public:
+  DeferredLogs() : dropped_(0) {
+    ring_buffer_.SetBuffer(buffer_).IgnoreError();
+  }
+
+  sync::InterruptSpinLock& lock() { return lock_; }
+  ring_buffer::PrefixedEntryRingBuffer& ring_buffer() { return ring_buffer_; }
+  size_t& dropped() { return dropped_; }
+
+ private:
+  sync::InterruptSpinLock lock_;
+  ring_buffer::PrefixedEntryRingBuffer ring_buffer_;
+  size_t dropped_;
+  std::byte buffer_[PW_LOG_BASIC_DEFERRED_BUFFER_SIZE_BYTES];
+};
+
+DeferredLogs& GetDeferredLogs() {
+  static DeferredLogs deferred_logs;
+  return deferred_logs;
+}
+
+// Reads the arguments of a deferred log in order.
+class DeferredArgs {
+ public:
+  DeferredArgs(pw_tokenizer_ArgTypes arg_types, ConstByteSpan encoded)
+      : types_(arg_types >> PW_TOKENIZER_TYPE_COUNT_SIZE_BITS),
+        count_(arg_types & PW_TOKENIZER_TYPE_COUNT_MASK),
+        encoded_(encoded) {}
+
+  // Reads an integer argument. Returns false if there are no more arguments or
+  // the next one is not an integer.
+  bool ReadInteger(int64_t& value) {
+    if (!NextTypeIs(PW_TOKENIZER_ARG_TYPE_INT) &&
+        !NextTypeIs(PW_TOKENIZER_ARG_TYPE_INT64)) {
+      return false;
+    }
+    const size_t bytes = varint::Decode(encoded_, &value);
+    return Advance(bytes);
+  }
+
+  bool ReadDouble(double& value) {
+    float encoded_value;
+    if (!NextTypeIs(PW_TOKENIZER_ARG_TYPE_DOUBLE) ||
+        encoded_.size() < sizeof(encoded_value)) {
+      return false;
+    }
+    std::memcpy(&encoded_value, encoded_.data(), sizeof(encoded_value));
+    value = encoded_value;
+    return Advance(sizeof(encoded_value));
+  }
+
+  // Copies a string argument into the buffer, null terminated.
+  bool ReadString(std::span<char, 128> string) {
+    if (!NextTypeIs(PW_TOKENIZER_ARG_TYPE_STRING) || encoded_.empty()) {
+      return false;
+    }
+    const size_t length = std::to_integer<size_t>(encoded_[0]) & 0x7Fu;
+    if (encoded_.size() < 1 + length) {
+      return false;
+    }
+    std::memcpy(string.data(), &encoded_[1], length);
+    string[length] = '\0';
+    return Advance(1 + length);
+  }
+
+  bool NextIsInt64() const { return NextTypeIs(PW_TOKENIZER_ARG_TYPE_INT64); }
+
+ private:
+  bool NextTypeIs(pw_tokenizer_ArgTypes type) const {
+    return count_ != 0u && (types_ & 0b11u) == type;
+  }
+
+  bool Advance(size_t bytes) {
+    if (bytes == 0u) {
+      return false;
+    }
+    encoded_ = encoded_.subspan(bytes);
+    types_ >>= 2;
+    count_ -= 1;
+    return true;
+  }
+
+  pw_tokenizer_ArgTypes types_;
+  size_t count_;
+  ConstByteSpan encoded_;
+};
+
+// Formats one argument with a conversion specification that takes up to two *
+// width and precision arguments.
+template <typename T>
+void FormatArg(StringBuilder& buffer,
+               const char* spec,
+               const int (&stars)[2],
+               size_t star_count,
+               T value) {
+  switch (star_count) {
+    case 0:
+      buffer.Format(spec, value);
+      break;
+    case 1:
+      buffer.Format(spec, stars[0], value);
+      break;
+    default:
+      buffer.Format(spec, stars[0], stars[1], value);
+      break;
+  }
+}
+
+// Formats the conversion specification with the next argument, passing the
+// same type that was passed to the log call. Returns false if the argument is
+// missing or has the wrong type.
+bool FormatNextArg(StringBuilder& buffer,
+                   const char* spec,
+                   char conversion,
+                   DeferredArgs& args) {
+  int stars[2] = {};
+  size_t star_count = 0;
+  for (const char* c = spec; *c != '\0'; ++c) {
+    if (*c == '*') {
+      int64_t star;
+      if (star_count == std::size(stars) || !args.ReadInteger(star)) {
+        return false;
+      }
+      stars[star_count++] = static_cast<int>(star);
+    }
+  }
+
+  switch (conversion) {
+    case 's': {
+      char string[128];
+      if (!args.ReadString(string)) {
+        return false;
+      }
+      FormatArg(
+          buffer, spec, stars, star_count, static_cast<const char*>(string));
+      return true;
+    }
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A': {
+      double value;
+      if (!args.ReadDouble(value)) {
+        return false;
+      }
+      FormatArg(buffer, spec, stars, star_count, value);
+      return true;
+    }
+    default: {
+      const bool is_int64 = args.NextIsInt64();
+      int64_t value;
+      if (!args.ReadInteger(value)) {
+        return false;
+      }
+      if (conversion == 'p') {
+        FormatArg(buffer,
+                  spec,
+                  stars,
+                  star_count,
+                  reinterpret_cast<void*>(static_cast<uintptr_t>(value)));
+      } else if (is_int64) {
+        FormatArg(buffer, spec, stars, star_count, value);
+      } else {
+        FormatArg(buffer, spec, stars, star_count, static_cast<int>(value));
+      }
+      return true;
+    }
+  }
+}
+
+// Formats a deferred log message. Conversion specifications without a matching
+// argument are output unmodified.
+void AppendDeferredMessage(StringBuilder& buffer,
+                           const char* message,
+                           DeferredArgs args) {
+  while (*message != '\0') {
+    const char* const percent = std::strchr(message, '%');
+    if (percent == nullptr) {
+      buffer << message;
+      return;
+    }
+    buffer.append(message, percent - message);
+
+    if (percent[1] == '%') {
+      buffer << '%';
+      message = percent + 2;
+      continue;
+    }
+
+    // Copy the conversion specification so it can be formatted by itself.
+    const size_t spec_size =
+        std::strcspn(percent + 1, "csdioxXufFeEgGaAnp") + 2;
+    char spec[16];
+    if (percent[spec_size - 1] == '\0' || spec_size >= sizeof(spec)) {
+      buffer << percent;
+      return;
+    }
+    std::memcpy(spec, percent, spec_size);
+    spec[spec_size] = '\0';
+    message = percent + spec_size;
+
+    if (!FormatNextArg(buffer, spec, spec[spec_size - 1], args)) {
+      buffer << spec;
+    }
+  }
+}
+
+#endif  // PW_LOG_BASIC_DEFERRED
+
+}  // namespace
+
+// This is a fully loaded, inefficient-at-the-callsite, log implementation.
+extern "C" void pw_Log(int level,
+                       unsigned int flags,
+                       const char* module_name,
+                       const char* file_name,
+                       int line_number,
+                       const char* function_name,
+                       const char* message,
+                       ...) {
+  // Accumulate the log message in this buffer, then output it.
+  pw::StringBuffer<150> buffer;
+
+  AppendPrefix(
+      buffer, level, flags, module_name, file_name, line_number, function_name);
 
   // Column: Message
   va_list args;
@@ -154,8 +412,106 @@ extern "C" void pw_Log(int level,
   write_log(buffer);
 }
 
+#if PW_LOG_BASIC_DEFERRED
+
+extern "C" void pw_log_basic_DeferLog(int level,
+                                      unsigned int flags,
+                                      const char* module_name,
+                                      const char* file_name,
+                                      int line_number,
+                                      const char* function_name,
+                                      pw_tokenizer_ArgTypes arg_types,
+                                      const char* message,
+                                      ...) {
+  const DeferredLogHeader header = {
+      module_name,
+      file_name,
+      function_name,
+      message,
+      arg_types,
+      level,
+      flags,
+      line_number,
+  };
+
+  DeferredLogs& deferred_logs = GetDeferredLogs();
+  std::lock_guard lock(deferred_logs.lock());
+
+  // Encode the log directly into the ring buffer.
+  std::span<std::byte> entry;
+  if (!deferred_logs.ring_buffer()
+           .TryReserve(kMaxDeferredLogSize, entry)
+           .ok()) {
+    deferred_logs.dropped() += 1;
+    return;
+  }
+  std::memcpy(entry.data(), &header, sizeof(header));
+
+  va_list args;
+  va_start(args, message);
+  const size_t args_size = tokenizer::EncodeArgs(
+      arg_types, args, entry.subspan(sizeof(header)));
+  va_end(args);
+
+  deferred_logs.ring_buffer().Commit(sizeof(header) + args_size).IgnoreError();
+}
+
+#endif  // PW_LOG_BASIC_DEFERRED
+
 void SetOutput(void (*log_output)(std::string_view log)) {
   write_log = log_output;
 }
 
+#if PW_LOG_BASIC_DEFERRED
+
+size_t FlushDeferredLogs() {
+  DeferredLogs& deferred_logs = GetDeferredLogs();
+  size_t logs_output = 0;
+
+  while (true) {
+    // Copy the entry out so the lock isn't held while formatting.
+    std::byte entry[kMaxDeferredLogSize];
+    size_t entry_size = 0;
+    size_t dropped = 0;
+    {
+      std::lock_guard lock(deferred_logs.lock());
+      if (deferred_logs.ring_buffer().PeekFront(entry, &entry_size).ok()) {
+        deferred_logs.ring_buffer().PopFront().IgnoreError();
+      } else {
+        // Logs are only dropped when the buffer is full, so they came after
+        // every log that was in the buffer.
+        dropped = std::exchange(deferred_logs.dropped(), 0);
+        if (dropped == 0u) {
+          return logs_output;
+        }
+      }
+    }
+
+    pw::StringBuffer<150> buffer;
+    if (dropped != 0u) {
+      AppendPrefix(buffer, PW_LOG_LEVEL_WARN, 0, "", "", 0, "");
+      buffer.Format("%u deferred logs were dropped", unsigned(dropped));
+    } else {
+      DeferredLogHeader header;
+      std::memcpy(&header, entry, sizeof(header));
+      AppendPrefix(buffer,
+                   header.level,
+                   header.flags,
+                   header.module_name,
+                   header.file_name,
+                   header.line_number,
+                   header.function_name);
+      AppendDeferredMessage(
+          buffer,
+          header.message,
+          DeferredArgs(header.arg_types,
+                       std::span(entry, entry_size).subspan(sizeof(header))));
+    }
+    write_log(buffer);
+    logs_output += 1;
+  }
+}
+
+#endif  // PW_LOG_BASIC_DEFERRED
+
 }  // namespace pw::log_basic
@@ -17,6 +17,17 @@
 #include "pw_preprocessor/compiler.h"
 #include "pw_preprocessor/util.h"
 
+// When PW_LOG_BASIC_DEFERRED is set, log calls store their arguments in a
+// buffer instead of formatting the message. The pw_log_basic:deferred backend
+// sets it.
+#ifndef PW_LOG_BASIC_DEFERRED
+#define PW_LOG_BASIC_DEFERRED 0
+#endif  // PW_LOG_BASIC_DEFERRED
+
+#if PW_LOG_BASIC_DEFERRED
+#include "pw_tokenizer/tokenize.h"
+#endif  // PW_LOG_BASIC_DEFERRED
+
 PW_EXTERN_C_START
 
 // Log a message with the listed attributes.
@@ -29,6 +40,22 @@ void pw_Log(int level,
             const char* message,
             ...) PW_PRINTF_FORMAT(7, 8);
 
+#if PW_LOG_BASIC_DEFERRED
+
+// Stores a log's attributes and arguments to be formatted later. The strings
+// other than the arguments, including the message, must be string literals.
+void pw_log_basic_DeferLog(int level,
+                           unsigned int flags,
+                           const char* module_name,
+                           const char* file_name,
+                           int line_number,
+                           const char* function_name,
+                           pw_tokenizer_ArgTypes arg_types,
+                           const char* message,
+                           ...) PW_PRINTF_FORMAT(8, 9);
+
+#endif  // PW_LOG_BASIC_DEFERRED
+
 PW_EXTERN_C_END
 
 // Log a message with many attributes included.
@@ -39,6 +66,25 @@ PW_EXTERN_C_END
 // char[] variable inside functions with a log.
 //
 // TODO(pwbug/87): Reconsider the naming of this module when more is in place.
+#if PW_LOG_BASIC_DEFERRED
+
+// In deferred mode, the argument types are determined at compile time, the
+// same way pw_tokenizer does, so the arguments can be stored without parsing
+// the format string.
+#define PW_HANDLE_LOG(level, flags, message, ...)              \
+  do {                                                         \
+    pw_log_basic_DeferLog((level),                             \
+                          (flags),                             \
+                          PW_LOG_MODULE_NAME,                  \
+                          __FILE__,                            \
+                          __LINE__,                            \
+                          __func__,                            \
+                          PW_TOKENIZER_ARG_TYPES(__VA_ARGS__), \
+                          message PW_COMMA_ARGS(__VA_ARGS__)); \
+  } while (0)
+
+#else
+
 #define PW_HANDLE_LOG(level, flags, message, ...) \
   do {                                            \
     pw_Log((level),                               \
@@ -50,8 +96,11 @@ PW_EXTERN_C_END
            message PW_COMMA_ARGS(__VA_ARGS__));   \
   } while (0)
 
+#endif  // PW_LOG_BASIC_DEFERRED
+
 #ifdef __cplusplus
 
+#include <cstddef>
 #include <string_view>
 
 namespace pw::log_basic {
@@ -60,6 +109,14 @@ namespace pw::log_basic {
 // pw::sys_io::WriteLine.
 void SetOutput(void (*log_output)(std::string_view log));
 
+#if PW_LOG_BASIC_DEFERRED
+
+// Formats and outputs the deferred logs, oldest first. Call this from a
+// low-priority thread. Returns the number of logs that were output.
+size_t FlushDeferredLogs();
+
+#endif  // PW_LOG_BASIC_DEFERRED
+
 }  // namespace pw::log_basic
 
 #endif  // __cplusplus
@@ -67,3 +67,16 @@
   do {                                  \
   } while (0)
 #endif  // PW_LOG_APPEND_TIMESTAMP
+
+// The size of the buffer that holds deferred logs when PW_LOG_BASIC_DEFERRED is
+// enabled. Logs that don't fit are dropped and counted.
+#ifndef PW_LOG_BASIC_DEFERRED_BUFFER_SIZE_BYTES
+#define PW_LOG_BASIC_DEFERRED_BUFFER_SIZE_BYTES 1024
+#endif  // PW_LOG_BASIC_DEFERRED_BUFFER_SIZE_BYTES
+
+// The maximum size of a deferred log's encoded arguments. Arguments that don't
+// fit are left out of the message. Strings are copied into the arguments, up
+// to 127 bytes each.
+#ifndef PW_LOG_BASIC_DEFERRED_ARGS_SIZE_BYTES
+#define PW_LOG_BASIC_DEFERRED_ARGS_SIZE_BYTES 64
+#endif  // PW_LOG_BASIC_DEFERRED_ARGS_SIZE_BYTES
@@ -14,6 +14,8 @@
 
 #include "pw_log_multisink/log_queue.h"
 
+#include <algorithm>
+
 #include "pw_assert/check.h"
 #include "pw_log/levels.h"
 #include "pw_log/proto/log.pwpb.h"
@@ -36,7 +38,22 @@ Status LogQueue::PushTokenizedMessage(ConstByteSpan message,
                                       uint32_t line,
                                       uint32_t /* thread */,
                                       int64_t timestamp) {
-  pw::protobuf::NestedEncoder nested_encoder(encode_buffer_);
+  // Encode the entry straight into the ring buffer if there is room for an
+  // entry of the maximum size. Otherwise, encode it into the encode buffer and
+  // copy it in, so that it is only dropped if its actual size doesn't fit.
+  // Entries are limited to the encode buffer's size either way.
+  ByteSpan entry_buffer;
+  const bool reserved =
+      ring_buffer_
+          .TryReserve(std::min(max_log_entry_size_, encode_buffer_.size()),
+                      entry_buffer,
+                      kLogKey)
+          .ok();
+  if (!reserved) {
+    entry_buffer = encode_buffer_;
+  }
+
+  pw::protobuf::NestedEncoder nested_encoder(entry_buffer);
   pw::log::LogEntry::Encoder encoder(&nested_encoder);
   Status status;
 
@@ -66,6 +83,11 @@ Status LogQueue::PushTokenizedMessage(ConstByteSpan message,
     // intentionally, and it is expected that the caller accepts this
     // possibility.
     status = PW_STATUS_INTERNAL;
+    if (reserved) {
+      ring_buffer_.Commit(0).IgnoreError();
+    }
+  } else if (reserved) {
+    status = ring_buffer_.Commit(log_entry.size_bytes());
   } else {
     // Try to push back the encoded log entry.
     status = ring_buffer_.TryPushBack(log_entry, kLogKey);
@@ -74,7 +96,8 @@ Status LogQueue::PushTokenizedMessage(ConstByteSpan message,
   if (!status.ok()) {
     // The ring buffer may hit the RESOURCE_EXHAUSTED state, causing us
     // to drop packets. However, this check captures all failures from
-    // Encode and TryPushBack, as any failure here causes packet drop.
+    // Encode, Commit, and TryPushBack, as any failure here causes packet
+    // drop.
     dropped_entries_++;
     latest_dropped_timestamp_ = timestamp;
     return status;
@@ -107,14 +130,22 @@ LogEntries LogQueue::PopMultiple(LogEntriesBuffer entries_buffer) {
   // ensure that the front entry of the ring buffer can be popped.
   PW_DCHECK_UINT_GE(entries_buffer.size_bytes(), max_log_entry_size_);
 
-  while (ring_buffer_.EntryCount() > 0 &&
-         (entries_buffer.size_bytes() - offset) > max_log_entry_size_) {
-    const Result<LogEntries> result = Pop(entries_buffer.subspan(offset));
-    if (!result.ok()) {
+  // Entries are stored with their LogEntries field key and length as the
+  // preamble, so the ring buffer copies them out already encoded as a
+  // LogEntries message. A copy stops at padding, so keep copying until no
+  // more entries fit.
+  while (pop_status_for_test_.ok()) {
+    size_t bytes_read = 0;
+    size_t entries_read = 0;
+    if (!ring_buffer_
+             .PeekFrontMultiple(
+                 entries_buffer.subspan(offset), bytes_read, entries_read)
+             .ok()) {
       break;
     }
-    offset += result.value().entries.size_bytes();
-    entry_count += result.value().entry_count;
+    PW_DCHECK_OK(ring_buffer_.PopFrontMultiple(entries_read));
+    offset += bytes_read;
+    entry_count += entries_read;
   }
 
   return LogEntries{.entries = ConstByteSpan(entries_buffer.first(offset)),
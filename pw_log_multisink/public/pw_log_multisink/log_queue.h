@@ -105,6 +105,14 @@ class LogQueue {
   // LogEntries - contains an encoded protobuf byte span of pw.log.LogEntries.
   LogEntries PopMultiple(LogEntriesBuffer entries_buffer);
 
+  // Returns true if there are no entries in the queue.
+  bool empty() { return ring_buffer_.EntryCount() == 0; }
+
+  // Returns the number of bytes the queued entries take up when encoded as a
+  // pw.log.LogEntries message. This may overestimate the size while the ring
+  // buffer holds padding.
+  size_t size_bytes() { return ring_buffer_.TotalUsedBytes(); }
+
  protected:
   friend class LogQueueTester;
   // For testing, status to return on calls to Pop.
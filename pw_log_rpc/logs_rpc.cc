@@ -16,11 +16,27 @@
 
 #include "pw_log/log.h"
 #include "pw_log/proto/log.pwpb.h"
+#include "pw_protobuf/wire_format.h"
 #include "pw_status/try.h"
+#include "pw_varint/varint.h"
 
 namespace pw::log_rpc {
 namespace {
 
+constexpr std::byte kEntriesKey = static_cast<std::byte>(
+    protobuf::MakeKey(static_cast<uint32_t>(log::LogEntries::Fields::ENTRIES),
+                      protobuf::WireType::kDelimited));
+
+// Encodes the value as a varint that fills the output, padding it with
+// continuation bytes if needed. Protobuf decoders accept padded varints.
+void EncodePaddedVarint(size_t value, ByteSpan output) {
+  for (size_t i = 0; i + 1 < output.size(); ++i) {
+    output[i] = static_cast<std::byte>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  output.back() = static_cast<std::byte>(value);
+}
+
 // TODO(prashanthsw): Handle dropped messages.
 // Result<ConstByteSpan> GenerateDroppedEntryMessage(ByteSpan encode_buffer,
 //                                                   size_t dropped_entries) {
@@ -32,46 +48,123 @@ namespace {
 
 }  // namespace
 
+Logs::Logs(multisink::MultiSink& multisink,
+           std::span<Stream> streams,
+           chrono::SystemClock::duration max_delay)
+    : multisink_(multisink), streams_(streams), max_delay_(max_delay) {
+  for (Stream& stream : streams_) {
+    multisink_.AttachDrain(stream.drain_);
+  }
+}
+
+Logs::~Logs() {
+  for (Stream& stream : streams_) {
+    multisink_.DetachDrain(stream.drain_);
+  }
+}
+
 void Logs::Get(ServerContext&, ConstByteSpan, rpc::RawServerWriter& writer) {
-  response_writer_ = std::move(writer);
+  for (Stream& stream : streams_) {
+    if (!stream.writer_.open()) {
+      stream.writer_ = std::move(writer);
+      stream.payload_size_ = 0;
+      return;
+    }
+  }
+
+  // Every stream is serving another call.
+  writer.Finish(Status::ResourceExhausted());
 }
 
 Status Logs::Flush() {
-  // If the response writer was not initialized or has since been closed,
-  // ignore the flush operation.
-  if (!response_writer_.open()) {
-    return OkStatus();
+  Status status;
+  for (Stream& stream : streams_) {
+    // Streams that are not serving a call are left for their next call.
+    if (stream.writer_.open()) {
+      status.Update(FlushStream(stream));
+    }
   }
+  return status;
+}
+
+void Logs::Finish() {
+  for (Stream& stream : streams_) {
+    stream.writer_.Finish();
+  }
+}
 
+Status Logs::FlushStream(Stream& stream) {
   // If previous calls to flush resulted in dropped entries, generate a
   // dropped entry message and write it before further log messages.
-  // TODO(prashanthsw): Handle dropped messages.
-  // if (dropped_entries_ > 0) {
-  //   ByteSpan payload = response_writer_.PayloadBuffer();
-  //   Result dropped_log = GenerateDroppedEntryMessage(payload,
-  //   dropped_entries_); PW_TRY(dropped_log.status());
-  //   PW_TRY(response_writer_.Write(dropped_log.value()));
-  //   dropped_entries_ = 0;
-  // }
-
-  // Write logs to the response writer. An important limitation of this
-  // implementation is that if this RPC call fails, the logs are lost -
-  // a subsequent call to the RPC will produce a drop count message.
-  ByteSpan payload = response_writer_.PayloadBuffer();
-  Result possible_logs = log_queue_.PopMultiple(payload);
-  PW_TRY(possible_logs.status());
-  if (possible_logs.value().entry_count == 0) {
-    return OkStatus();
+  // TODO(prashanthsw): Handle dropped messages using stream.dropped_entries_.
+
+  // Write logs to the response writer, filling each response. An important
+  // limitation of this implementation is that if this RPC call fails, the logs
+  // are lost - a subsequent call to the RPC will produce a drop count message.
+  while (ReadyToSend(stream)) {
+    ByteSpan payload = stream.writer_.PayloadBuffer();
+    stream.payload_size_ = payload.size();
+
+    const StatusWithSize encoded = EncodeEntries(stream, payload);
+    if (encoded.size() == 0) {
+      // The next entry is too large to fit in a response.
+      return encoded.IsOutOfRange() ? OkStatus() : encoded.status();
+    }
+    PW_TRY(stream.writer_.Write(payload.first(encoded.size())));
   }
+  return OkStatus();
+}
 
-  Status status = response_writer_.Write(possible_logs.value().entries);
-  if (!status.ok()) {
-    // On a failure to send logs, track the dropped entries.
-    dropped_entries_ = possible_logs.value().entry_count;
-    return status;
+bool Logs::ReadyToSend(Stream& stream) {
+  const size_t entries_size = stream.drain_.EntriesSize();
+  if (entries_size == 0) {
+    stream.holding_logs_ = false;
+    return false;
+  }
+  if (max_delay_ == chrono::SystemClock::duration::zero()) {
+    return true;
   }
 
-  return OkStatus();
+  // The payload buffer's size is learned from the first one acquired. The
+  // writer holds on to the buffer until it writes the first response.
+  if (stream.payload_size_ == 0) {
+    stream.payload_size_ = stream.writer_.PayloadBuffer().size();
+  }
+  if (entries_size >= stream.payload_size_) {
+    return true;
+  }
+
+  const chrono::SystemClock::time_point now = chrono::SystemClock::now();
+  if (!stream.holding_logs_) {
+    stream.holding_logs_ = true;
+    stream.first_held_time_ = now;
+  }
+  return now - stream.first_held_time_ >= max_delay_;
+}
+
+StatusWithSize Logs::EncodeEntries(Stream& stream, ByteSpan payload) {
+  // Entries are read from the drain straight into the payload, after their
+  // field key and length. Since the length is written after the entry is read,
+  // it is padded to the width of the largest length that fits.
+  const size_t length_bytes = varint::EncodedSize(payload.size());
+  const size_t prefix_bytes = sizeof(kEntriesKey) + length_bytes;
+
+  size_t size = 0;
+  while (size + prefix_bytes < payload.size()) {
+    uint32_t drop_count = 0;
+    const Result<ConstByteSpan> entry = stream.drain_.GetEntry(
+        payload.subspan(size + prefix_bytes), drop_count);
+    stream.dropped_entries_ += drop_count;
+    if (!entry.ok()) {
+      return StatusWithSize(entry.status(), size);
+    }
+
+    payload[size] = kEntriesKey;
+    EncodePaddedVarint(entry.value().size(),
+                       payload.subspan(size + sizeof(kEntriesKey)));
+    size += prefix_bytes + entry.value().size();
+  }
+  return StatusWithSize(size);
 }
 
 }  // namespace pw::log_rpc
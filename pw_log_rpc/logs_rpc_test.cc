@@ -14,8 +14,11 @@
 
 #include "pw_log_rpc/logs_rpc.h"
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "pw_log/log.h"
+#include "pw_protobuf/decoder.h"
 #include "pw_rpc/raw_test_method_context.h"
 
 namespace pw::log_rpc {
@@ -23,31 +26,42 @@ namespace {
 
 #define LOGS_METHOD_CONTEXT PW_RAW_TEST_METHOD_CONTEXT(Logs, Get)
 
-constexpr size_t kEncodeBufferSize = 128;
-constexpr size_t kLogBufferSize = 4096;
-
-class LogQueueTester : public LogQueueWithEncodeBuffer<kLogBufferSize> {
- public:
-  LogQueueTester(ByteSpan log_queue)
-      : LogQueueWithEncodeBuffer<kLogBufferSize>(log_queue) {}
-
-  void SetPopStatus(Status error_status) {
-    pop_status_for_test_ = error_status;
+constexpr size_t kMultiSinkBufferSize = 512;
+
+// An encoded pw.log.LogEntry with the message "message".
+constexpr std::byte kEntry[] = {std::byte{0x0a},
+                                std::byte{0x07},
+                                std::byte{'m'},
+                                std::byte{'e'},
+                                std::byte{'s'},
+                                std::byte{'s'},
+                                std::byte{'a'},
+                                std::byte{'g'},
+                                std::byte{'e'}};
+
+// Returns the number of log entries in a LogEntries response, checking that
+// each one matches kEntry.
+size_t CountEntries(ConstByteSpan response) {
+  protobuf::Decoder decoder(response);
+  size_t count = 0;
+  while (decoder.Next().ok()) {
+    std::span<const std::byte> entry;
+    EXPECT_EQ(OkStatus(), decoder.ReadBytes(&entry));
+    EXPECT_EQ(sizeof(kEntry), entry.size());
+    EXPECT_EQ(0, std::memcmp(kEntry, entry.data(), sizeof(kEntry)));
+    count += 1;
   }
-};
+  return count;
+}
 
 class LogsService : public ::testing::Test {
  public:
-  LogsService() : log_queue_(log_queue_buffer_) {}
+  LogsService() : multisink_(multisink_buffer_) {}
 
  protected:
   void AddLogs(const size_t log_count = 1) {
-    constexpr char kTokenizedMessage[] = "message";
     for (size_t i = 0; i < log_count; i++) {
-      EXPECT_EQ(
-          OkStatus(),
-          log_queue_.PushTokenizedMessage(
-              std::as_bytes(std::span(kTokenizedMessage)), 0, 0, 0, 0, 0));
+      multisink_.HandleEntry(kEntry);
     }
   }
 
@@ -55,14 +69,15 @@ class LogsService : public ::testing::Test {
     return (Logs&)(context.service());
   }
 
-  std::array<std::byte, kEncodeBufferSize> log_queue_buffer_;
-  LogQueueWithEncodeBuffer<kLogBufferSize> log_queue_;
+  std::array<std::byte, kMultiSinkBufferSize> multisink_buffer_;
+  multisink::MultiSink multisink_;
+  std::array<Logs::Stream, 2> streams_;
 };
 
 TEST_F(LogsService, Get) {
   constexpr size_t kLogEntryCount = 3;
   std::array<std::byte, 1> rpc_buffer;
-  LOGS_METHOD_CONTEXT context(log_queue_);
+  LOGS_METHOD_CONTEXT context(multisink_, streams_);
 
   context.call(rpc_buffer);
 
@@ -76,14 +91,15 @@ TEST_F(LogsService, Get) {
 
   // Although |kLogEntryCount| messages were in the queue, they are batched
   // before being written to the client, so there is only one response.
-  EXPECT_EQ(1U, context.total_responses());
+  ASSERT_EQ(1U, context.total_responses());
+  EXPECT_EQ(kLogEntryCount, CountEntries(context.responses()[0]));
 }
 
 TEST_F(LogsService, GetMultiple) {
   constexpr size_t kLogEntryCount = 1;
   constexpr size_t kFlushCount = 3;
   std::array<std::byte, 1> rpc_buffer;
-  LOGS_METHOD_CONTEXT context(log_queue_);
+  LOGS_METHOD_CONTEXT context(multisink_, streams_);
 
   context.call(rpc_buffer);
 
@@ -98,11 +114,11 @@ TEST_F(LogsService, GetMultiple) {
   EXPECT_EQ(kFlushCount, context.total_responses());
 }
 
-TEST_F(LogsService, NoEntriesOnEmptyQueue) {
+TEST_F(LogsService, NoEntriesOnEmptyMultiSink) {
   std::array<std::byte, 1> rpc_buffer;
-  LOGS_METHOD_CONTEXT context(log_queue_);
+  LOGS_METHOD_CONTEXT context(multisink_, streams_);
 
-  // Invoking flush with no logs in the queue should behave like a no-op.
+  // Invoking flush with no logs in the multisink should behave like a no-op.
   context.call(rpc_buffer);
   GetLogs(context).Flush();
   GetLogs(context).Finish();
@@ -112,20 +128,103 @@ TEST_F(LogsService, NoEntriesOnEmptyQueue) {
   EXPECT_EQ(0U, context.total_responses());
 }
 
-TEST_F(LogsService, QueueError) {
+TEST_F(LogsService, FlushSendsAllLogs) {
   std::array<std::byte, 1> rpc_buffer;
-  LogQueueTester log_queue_tester(log_queue_buffer_);
-  LOGS_METHOD_CONTEXT context(log_queue_tester);
+  LOGS_METHOD_CONTEXT context(multisink_, streams_);
 
-  // Generate failure on log queue.
-  log_queue_tester.SetPopStatus(Status::Internal());
+  // More logs than fit in one response are sent in several full responses.
   context.call(rpc_buffer);
+  AddLogs(20);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+
+  const size_t responses = context.total_responses();
+  EXPECT_GT(responses, 1U);
+  EXPECT_LT(responses, 20U);
+
   GetLogs(context).Flush();
+  EXPECT_EQ(responses, context.total_responses());
   GetLogs(context).Finish();
+}
 
-  EXPECT_TRUE(context.done());
-  EXPECT_EQ(OkStatus(), context.status());
+TEST_F(LogsService, MaxDelay_HoldsLogsUntilResponseIsFull) {
+  std::array<std::byte, 1> rpc_buffer;
+  LOGS_METHOD_CONTEXT context(multisink_, streams_, std::chrono::hours(1));
+
+  // A few logs don't fill a response, so they are held.
+  context.call(rpc_buffer);
+  AddLogs(4);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
   EXPECT_EQ(0U, context.total_responses());
+
+  // Once there are enough logs, a full response is sent and the rest are held.
+  AddLogs(5);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+  EXPECT_EQ(1U, context.total_responses());
+
+  GetLogs(context).Finish();
+  EXPECT_TRUE(context.done());
+  EXPECT_EQ(1U, context.total_responses());
+}
+
+TEST_F(LogsService, StreamsReadIndependently) {
+  std::array<std::byte, 1> rpc_buffer;
+  LOGS_METHOD_CONTEXT context(multisink_, streams_);
+
+  // Both streams are attached when the service is created, so each one reads
+  // every log, regardless of what the other stream has read.
+  AddLogs(2);
+  context.call(rpc_buffer);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+  ASSERT_EQ(1U, context.total_responses());
+  EXPECT_EQ(2U, CountEntries(context.responses()[0]));
+
+  // The first stream only sends the new log, and the second sends all three.
+  AddLogs(1);
+  context.call(rpc_buffer);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+  ASSERT_EQ(2U, context.total_responses());
+  EXPECT_EQ(1U, CountEntries(context.responses()[0]));
+  EXPECT_EQ(3U, CountEntries(context.responses()[1]));
+
+  GetLogs(context).Finish();
+}
+
+TEST_F(LogsService, NoFreeStream) {
+  std::array<std::byte, 1> rpc_buffer;
+  LOGS_METHOD_CONTEXT context(multisink_, std::span(streams_).first(1));
+
+  context.call(rpc_buffer);
+  EXPECT_FALSE(context.done());
+
+  // The only stream is in use, so the next call fails.
+  context.call(rpc_buffer);
+  EXPECT_TRUE(context.done());
+  EXPECT_EQ(Status::ResourceExhausted(), context.status());
+
+  GetLogs(context).Finish();
+}
+
+TEST_F(LogsService, DropsAreCountedPerStream) {
+  std::array<std::byte, 1> rpc_buffer;
+  LOGS_METHOD_CONTEXT context(multisink_, streams_);
+
+  context.call(rpc_buffer);
+
+  // The first stream keeps up with the logs, but the second stream has no
+  // call, so its logs are overwritten and counted as dropped.
+  for (size_t i = 0; i < kMultiSinkBufferSize / sizeof(kEntry); i++) {
+    AddLogs(2);
+    EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+  }
+  EXPECT_EQ(0U, streams_[0].dropped_entries());
+  EXPECT_EQ(0U, streams_[1].dropped_entries());
+
+  context.call(rpc_buffer);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+  EXPECT_EQ(0U, streams_[0].dropped_entries());
+  EXPECT_GT(streams_[1].dropped_entries(), 0U);
+
+  GetLogs(context).Finish();
 }
 
 }  // namespace
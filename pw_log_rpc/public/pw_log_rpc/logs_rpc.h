@@ -14,39 +14,106 @@
 
 #pragma once
 
+#include <span>
+
+#include "pw_chrono/system_clock.h"
 #include "pw_log/log.h"
 #include "pw_log/proto/log.raw_rpc.pb.h"
-#include "pw_log_multisink/log_queue.h"
+#include "pw_multisink/multisink.h"
+#include "pw_status/status_with_size.h"
 
 namespace pw::log_rpc {
 
-// The Logs RPC service will send logs when requested by Get(). For now, Get()
-// requests result in a stream of responses, containing all log entries from
-// the attached log queue.
+// The Logs RPC service will send logs when requested by Get(). Get() requests
+// result in a stream of responses, containing log entries from the attached
+// multisink. Each entry in the multisink must be an encoded pw.log.LogEntry.
+//
+// Each Get() call is served by one of the service's streams. Every stream reads
+// the multisink through its own drain, so clients such as a host tool and an
+// on-device log persister read logs independently, with their own positions
+// and drop counts. A Get() call when every stream is in use fails with
+// RESOURCE_EXHAUSTED. Streams keep their drains attached between calls, so a
+// new call starts with the logs that arrived since the stream's last call.
 //
-// The Get() method will return logs in the current queue immediately, but
-// someone else is responsible for pumping the log queue using Flush().
+// The Get() method will return immediately, but someone else is responsible
+// for pumping logs to the streams using Flush().
+//
+// Each response is filled with as many log entries as fit in the channel's
+// buffer. By default, Flush() sends every available log. To send fewer, fuller
+// responses over slow links, a max_delay can be provided. Flush() then holds
+// logs that don't fill a response until max_delay has passed since it first
+// held them. Logs are only sent from Flush(), so it must be called at least
+// every max_delay for logs to be delayed by no more than that.
 class Logs final : public pw::log::generated::Logs<Logs> {
  public:
-  Logs(LogQueue& log_queue) : log_queue_(log_queue), dropped_entries_(0) {}
+  // The state of one log stream.
+  class Stream {
+   public:
+    Stream() : dropped_entries_(0), payload_size_(0), holding_logs_(false) {}
+
+    // Streams are not copyable or movable.
+    Stream(const Stream&) = delete;
+    Stream& operator=(const Stream&) = delete;
+    Stream(Stream&&) = delete;
+    Stream& operator=(Stream&&) = delete;
+
+    // The number of entries the multisink dropped before this stream read
+    // them.
+    size_t dropped_entries() const { return dropped_entries_; }
+
+   private:
+    friend class Logs;
+
+    multisink::MultiSink::Drain drain_;
+    rpc::RawServerWriter writer_;
+    size_t dropped_entries_;
+
+    // The size of the writer's payload buffer, or 0 if it is not yet known.
+    size_t payload_size_;
+
+    // When Flush() first held back logs that are still unread.
+    bool holding_logs_;
+    chrono::SystemClock::time_point first_held_time_;
+  };
+
+  // Attaches the streams' drains to the multisink. The streams must not be
+  // used by another Logs service.
+  Logs(multisink::MultiSink& multisink,
+       std::span<Stream> streams,
+       chrono::SystemClock::duration max_delay =
+           chrono::SystemClock::duration::zero());
+
+  ~Logs();
 
   // RPC API for the Logs that produces a log stream. This method will
   // return immediately, another class must call Flush() to push logs from
-  // the queue to this stream.
+  // the multisink to this stream.
   void Get(ServerContext&, ConstByteSpan, rpc::RawServerWriter& writer);
 
-  // Interface for the owner of the service instance to flush all existing
-  // logs to the writer, if one is attached.
+  // Interface for the owner of the service instance to flush available logs to
+  // each open stream. Sends every available log, except for those held back
+  // to fill a response when a max_delay is set. Returns the first error from
+  // any stream.
   Status Flush();
 
-  // Interface for the owner of the service instance to close the RPC, if
-  // one is attached.
-  void Finish() { response_writer_.Finish(); }
+  // Interface for the owner of the service instance to close the open RPCs.
+  void Finish();
 
  private:
-  LogQueue& log_queue_;
-  rpc::RawServerWriter response_writer_;
-  size_t dropped_entries_;
+  Status FlushStream(Stream& stream);
+
+  // Returns whether the stream's unread logs should be sent now.
+  bool ReadyToSend(Stream& stream);
+
+  // Reads entries from the stream's drain into the payload, encoded as a
+  // pw.log.LogEntries message. Returns the encoded size. The status is
+  // OUT_OF_RANGE if the drain ran out of entries, and RESOURCE_EXHAUSTED if
+  // the next entry did not fit.
+  StatusWithSize EncodeEntries(Stream& stream, ByteSpan payload);
+
+  multisink::MultiSink& multisink_;
+  std::span<Stream> streams_;
+  const chrono::SystemClock::duration max_delay_;
 };
 
 }  // namespace pw::log_rpc
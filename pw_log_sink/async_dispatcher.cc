@@ -0,0 +1,79 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_log_sink/async_dispatcher.h"
+
+#include <mutex>
+
+namespace pw::log_sink {
+
+void AsyncDispatcher::AddSink(AsyncSink& sink) {
+  {
+    std::lock_guard lock(sinks_lock_);
+    multisink_.AttachDrain(sink.drain_);
+    sinks_.push_back(sink);
+  }
+
+  // The listener is not notified again until a drain catches up, which may
+  // not have happened if there were no sinks, so wake the thread to service
+  // the new one.
+  new_entries_.release();
+}
+
+void AsyncDispatcher::RemoveSink(AsyncSink& sink) {
+  std::lock_guard lock(sinks_lock_);
+  sinks_.remove(sink);
+  multisink_.DetachDrain(sink.drain_);
+}
+
+void AsyncDispatcher::ServiceSinks() {
+  std::lock_guard lock(sinks_lock_);
+  for (AsyncSink& sink : sinks_) {
+    ServiceSink(sink);
+  }
+}
+
+void AsyncDispatcher::ServiceSink(AsyncSink& sink) {
+  Result<ConstByteSpan> entry = Status::OutOfRange();
+  do {
+    uint32_t drop_count = 0;
+    entry = sink.drain_.GetEntry(entry_buffer_, drop_count);
+
+    // The drop count is always passed on before the entry, so that the sink
+    // processes drops in order.
+    if (drop_count > 0) {
+      sink.sink_.HandleDropped(drop_count);
+    }
+    if (entry.ok()) {
+      sink.sink_.HandleEntry(entry.value());
+    }
+  } while (entry.ok());
+}
+
+void AsyncDispatcher::RequestStop() {
+  stop_requested_.store(true, std::memory_order_relaxed);
+  new_entries_.release();
+}
+
+void AsyncDispatcher::Run() {
+  while (true) {
+    new_entries_.acquire();
+    ServiceSinks();
+    if (stop_requested_.load(std::memory_order_relaxed)) {
+      return;
+    }
+  }
+}
+
+}  // namespace pw::log_sink
@@ -0,0 +1,156 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_log_sink/async_dispatcher.h"
+
+#include <array>
+#include <cstddef>
+
+#include "gtest/gtest.h"
+
+namespace pw::log_sink {
+namespace {
+
+class TestSink final : public Sink {
+ public:
+  void HandleEntry(ConstByteSpan entry) final {
+    ASSERT_EQ(entry.size(), 1u);
+    last_entry_ = entry[0];
+    entry_count_ += 1;
+  }
+
+  void HandleDropped(uint32_t drop_count) final { drop_count_ += drop_count; }
+
+  std::byte last_entry() const { return last_entry_; }
+  uint32_t entry_count() const { return entry_count_; }
+  uint32_t drop_count() const { return drop_count_; }
+
+ private:
+  std::byte last_entry_ = std::byte{0};
+  uint32_t entry_count_ = 0;
+  uint32_t drop_count_ = 0;
+};
+
+class AsyncDispatcherTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kBufferSize = 64;
+
+  AsyncDispatcherTest()
+      : multisink_(buffer_),
+        dispatcher_(multisink_),
+        async_sink_a_(sink_a_),
+        async_sink_b_(sink_b_) {}
+
+  void Log(uint8_t value) {
+    const std::byte entry[] = {std::byte{value}};
+    dispatcher_.HandleEntry(entry);
+  }
+
+  std::byte buffer_[kBufferSize];
+  multisink::MultiSink multisink_;
+  AsyncDispatcher dispatcher_;
+  TestSink sink_a_;
+  TestSink sink_b_;
+  AsyncSink async_sink_a_;
+  AsyncSink async_sink_b_;
+};
+
+TEST_F(AsyncDispatcherTest, EntriesReachSinksWhenServiced) {
+  dispatcher_.AddSink(async_sink_a_);
+  dispatcher_.AddSink(async_sink_b_);
+
+  Log(1);
+  Log(2);
+  EXPECT_EQ(sink_a_.entry_count(), 0u);
+  EXPECT_EQ(sink_b_.entry_count(), 0u);
+
+  dispatcher_.ServiceSinks();
+  EXPECT_EQ(sink_a_.entry_count(), 2u);
+  EXPECT_EQ(sink_a_.last_entry(), std::byte{2});
+  EXPECT_EQ(sink_b_.entry_count(), 2u);
+  EXPECT_EQ(sink_b_.last_entry(), std::byte{2});
+
+  dispatcher_.RemoveSink(async_sink_a_);
+  dispatcher_.RemoveSink(async_sink_b_);
+}
+
+TEST_F(AsyncDispatcherTest, RemovedSinkIsNotCalled) {
+  dispatcher_.AddSink(async_sink_a_);
+  dispatcher_.AddSink(async_sink_b_);
+
+  Log(1);
+  dispatcher_.RemoveSink(async_sink_a_);
+  Log(2);
+  dispatcher_.ServiceSinks();
+
+  EXPECT_EQ(sink_a_.entry_count(), 0u);
+  EXPECT_EQ(sink_b_.entry_count(), 2u);
+
+  dispatcher_.RemoveSink(async_sink_b_);
+}
+
+TEST_F(AsyncDispatcherTest, SinkThatFallsBehindIsToldOfDrops) {
+  dispatcher_.AddSink(async_sink_a_);
+  dispatcher_.AddSink(async_sink_b_);
+
+  // Each entry takes a byte of data, a byte of length prefix, and a byte of
+  // sequence ID in the multisink, so these overflow its buffer.
+  for (uint8_t i = 1; i <= kBufferSize; ++i) {
+    Log(i);
+  }
+  dispatcher_.ServiceSinks();
+
+  EXPECT_GT(sink_a_.drop_count(), 0u);
+  EXPECT_EQ(sink_a_.entry_count() + sink_a_.drop_count(), kBufferSize);
+  EXPECT_EQ(sink_a_.last_entry(), std::byte{kBufferSize});
+  EXPECT_EQ(sink_b_.entry_count(), sink_a_.entry_count());
+  EXPECT_EQ(sink_b_.drop_count(), sink_a_.drop_count());
+
+  dispatcher_.RemoveSink(async_sink_a_);
+  dispatcher_.RemoveSink(async_sink_b_);
+}
+
+TEST_F(AsyncDispatcherTest, DropsReachEverySink) {
+  dispatcher_.AddSink(async_sink_a_);
+  dispatcher_.AddSink(async_sink_b_);
+
+  dispatcher_.HandleDropped(3);
+  std::array<std::byte, AsyncDispatcher::kMaxEntrySize + 1> oversized{};
+  dispatcher_.HandleEntry(oversized);
+  Log(1);
+  dispatcher_.ServiceSinks();
+
+  EXPECT_EQ(sink_a_.drop_count(), 4u);
+  EXPECT_EQ(sink_a_.entry_count(), 1u);
+  EXPECT_EQ(sink_b_.drop_count(), 4u);
+  EXPECT_EQ(sink_b_.entry_count(), 1u);
+
+  dispatcher_.RemoveSink(async_sink_a_);
+  dispatcher_.RemoveSink(async_sink_b_);
+}
+
+TEST_F(AsyncDispatcherTest, RunServicesSinksUntilStopped) {
+  dispatcher_.AddSink(async_sink_a_);
+  Log(1);
+
+  // With a stop requested, Run() services the sinks once and returns.
+  dispatcher_.RequestStop();
+  dispatcher_.Start();
+  EXPECT_EQ(sink_a_.entry_count(), 1u);
+
+  dispatcher_.RemoveSink(async_sink_a_);
+}
+
+}  // namespace
+}  // namespace pw::log_sink
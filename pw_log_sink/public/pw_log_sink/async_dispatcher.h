@@ -0,0 +1,135 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_containers/intrusive_list.h"
+#include "pw_log_sink/sink.h"
+#include "pw_multisink/multisink.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/thread_notification.h"
+#include "pw_thread/thread_core.h"
+
+namespace pw {
+namespace log_sink {
+
+// A sink served by an AsyncDispatcher. Each has its own drain of the
+// dispatcher's multisink, so a slow sink only falls behind on its own.
+class AsyncSink : public IntrusiveList<AsyncSink>::Item {
+ public:
+  explicit AsyncSink(Sink& sink) : sink_(sink) {}
+
+  AsyncSink(const AsyncSink&) = delete;
+  AsyncSink& operator=(const AsyncSink&) = delete;
+
+ private:
+  friend class AsyncDispatcher;
+
+  Sink& sink_;
+  multisink::MultiSink::Drain drain_;
+};
+
+// Moves log entries to sinks on a background thread. The dispatcher is itself
+// a Sink: once added with AddSink(), each log call appends its entry to the
+// multisink once, however many sinks the dispatcher serves. The dispatcher is
+// a ThreadCore, and its thread passes the entries to each AsyncSink in turn.
+//
+//   std::byte log_buffer[2048];
+//   pw::multisink::MultiSink log_multisink(log_buffer);
+//   pw::log_sink::AsyncDispatcher dispatcher(log_multisink);
+//
+//   pw::log_sink::AsyncSink uart_sink(uart_log_sink);
+//   pw::log_sink::AsyncSink flash_sink(flash_log_sink);
+//
+//   dispatcher.AddSink(uart_sink);
+//   dispatcher.AddSink(flash_sink);
+//   pw::log_sink::AddSink(dispatcher);
+//   pw::thread::DetachedThread(log_thread_options, dispatcher);
+//
+// Entries that a sink falls too far behind on are pushed out of the multisink,
+// and the sink is told of them with HandleDropped().
+class AsyncDispatcher final : public Sink,
+                              public thread::ThreadCore,
+                              private multisink::MultiSink::Listener {
+ public:
+  // The largest entry the dispatcher passes to its sinks. Larger entries are
+  // reported to the sinks as drops.
+  static constexpr size_t kMaxEntrySize = 128;
+
+  explicit AsyncDispatcher(multisink::MultiSink& multisink)
+      : multisink::MultiSink::Listener(Notification::kOnceUntilDrained),
+        multisink_(multisink),
+        stop_requested_(false) {
+    multisink_.AttachListener(*this);
+  }
+
+  ~AsyncDispatcher() { multisink_.DetachListener(*this); }
+
+  // Appends an entry to the multisink. Called by pw_LogSink_Log().
+  void HandleEntry(ConstByteSpan entry) final {
+    if (entry.size() > kMaxEntrySize) {
+      multisink_.HandleDropped();
+      return;
+    }
+    multisink_.HandleEntry(entry);
+  }
+
+  // Records drops in the multisink, so that every sink is told of them.
+  void HandleDropped(uint32_t drop_count) final {
+    multisink_.HandleDropped(drop_count);
+  }
+
+  // Starts serving a sink. The sink receives entries logged after this call.
+  void AddSink(AsyncSink& sink) PW_LOCKS_EXCLUDED(sinks_lock_);
+
+  // Stops serving a sink. Once this returns, the sink is not called again.
+  void RemoveSink(AsyncSink& sink) PW_LOCKS_EXCLUDED(sinks_lock_);
+
+  // Passes every available entry to each sink. The dispatcher's thread does
+  // this whenever there are new entries; it may also be called directly when
+  // the dispatcher is not run on a thread, such as when flushing logs before a
+  // reset.
+  void ServiceSinks() PW_LOCKS_EXCLUDED(sinks_lock_);
+
+  // Makes Run() return after it next services the sinks, so that its thread
+  // may be joined.
+  void RequestStop();
+
+ private:
+  // Services the sinks each time there are new entries, until RequestStop()
+  // is called.
+  void Run() final;
+
+  // Called with the multisink's lock held, so it only wakes the thread.
+  void OnNewEntryAvailable() final { new_entries_.release(); }
+
+  void ServiceSink(AsyncSink& sink) PW_EXCLUSIVE_LOCKS_REQUIRED(sinks_lock_);
+
+  multisink::MultiSink& multisink_;
+  sync::ThreadNotification new_entries_;
+  std::atomic<bool> stop_requested_;
+
+  sync::Mutex sinks_lock_;
+  IntrusiveList<AsyncSink> sinks_ PW_GUARDED_BY(sinks_lock_);
+  std::array<std::byte, kMaxEntrySize> entry_buffer_ PW_GUARDED_BY(sinks_lock_);
+};
+
+}  // namespace log_sink
+}  // namespace pw
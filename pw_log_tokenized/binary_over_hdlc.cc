@@ -0,0 +1,60 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This function serves as a backend for pw_tokenizer / pw_log_tokenized that
+// writes tokenized logs and their metadata as binary HDLC frames.
+
+#include "pw_log_tokenized/binary_over_hdlc.h"
+
+#include <array>
+#include <cstring>
+#include <span>
+
+#include "pw_bytes/endian.h"
+#include "pw_hdlc/encoder.h"
+#include "pw_stream/sys_io_stream.h"
+#include "pw_tokenizer/config.h"
+#include "pw_tokenizer/tokenize_to_global_handler_with_payload.h"
+
+namespace pw::log_tokenized {
+namespace {
+
+stream::SysIoWriter writer;
+
+}  // namespace
+
+// Writes the metadata and tokenized log to pw::sys_io as an HDLC frame. Unlike
+// Base64, the binary message does not grow, and nothing is encoded other than
+// the HDLC escapes.
+extern "C" void pw_tokenizer_HandleEncodedMessageWithPayload(
+    pw_tokenizer_Payload metadata,
+    const uint8_t log_buffer[],
+    size_t size_bytes) {
+  const auto metadata_bytes =
+      bytes::CopyInOrder(std::endian::little, uint32_t(metadata));
+
+  std::array<std::byte,
+             sizeof(metadata_bytes) +
+                 PW_TOKENIZER_CFG_ENCODING_BUFFER_SIZE_BYTES>
+      frame;
+  std::memcpy(frame.data(), metadata_bytes.data(), metadata_bytes.size());
+  std::memcpy(frame.data() + metadata_bytes.size(), log_buffer, size_bytes);
+
+  hdlc::WriteUIFrame(
+      PW_LOG_TOKENIZED_BINARY_LOG_HDLC_ADDRESS,
+      std::span(frame).first(metadata_bytes.size() + size_bytes),
+      writer);
+}
+
+}  // namespace pw::log_tokenized
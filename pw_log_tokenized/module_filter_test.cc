@@ -0,0 +1,125 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#define PW_LOG_MODULE_NAME "wifi"
+
+// Configure the module so that the test runs against known values.
+#undef PW_LOG_TOKENIZED_MODULE_FILTER
+#undef PW_LOG_TOKENIZED_MODULE_LEVELS
+#undef PW_LOG_TOKENIZED_ENCODE_MESSAGE
+
+#define PW_LOG_TOKENIZED_MODULE_FILTER 1
+#define PW_LOG_TOKENIZED_MODULE_LEVELS \
+  {"wifi", PW_LOG_LEVEL_INFO}, {"ble", PW_LOG_LEVEL_WARN}
+
+#include <cstdint>
+
+// Count the encoded logs rather than tokenizing them.
+namespace {
+int logs_encoded = 0;
+}  // namespace
+
+#define PW_LOG_TOKENIZED_ENCODE_MESSAGE(payload, message, ...) \
+  static_cast<void>(payload), ++logs_encoded
+
+#include "gtest/gtest.h"
+#include "pw_log/levels.h"
+#include "pw_log_tokenized/log_tokenized.h"
+
+namespace pw::log_tokenized {
+namespace {
+
+using internal::ModuleIndex;
+
+static_assert(ModuleIndex("") == 0u);
+static_assert(ModuleIndex("not listed") == 0u);
+static_assert(ModuleIndex("wifi") == 1u);
+static_assert(ModuleIndex("ble") == 2u);
+
+class ModuleFilter : public ::testing::Test {
+ protected:
+  ModuleFilter() {
+    logs_encoded = 0;
+    SetModuleLevel("wifi", 0);
+    SetModuleLevel("ble", 0);
+    SetDefaultModuleLevel(0);
+  }
+};
+
+#define TEST_LOG(level, ...) \
+  PW_LOG_TOKENIZED_TO_GLOBAL_HANDLER_WITH_PAYLOAD(level, 0, "log" __VA_ARGS__)
+
+// Unused when the log using it is compiled out.
+[[maybe_unused]] int ArgumentsEvaluated(int& count) { return ++count; }
+
+TEST_F(ModuleFilter, BelowCompileTimeLevel_NotEncoded) {
+  int evaluated = 0;
+  TEST_LOG(PW_LOG_LEVEL_DEBUG, "%d", ArgumentsEvaluated(evaluated));
+  EXPECT_EQ(logs_encoded, 0);
+  EXPECT_EQ(evaluated, 0);
+}
+
+TEST_F(ModuleFilter, AtCompileTimeLevel_Encoded) {
+  TEST_LOG(PW_LOG_LEVEL_INFO);
+  TEST_LOG(PW_LOG_LEVEL_ERROR);
+  EXPECT_EQ(logs_encoded, 2);
+}
+
+TEST_F(ModuleFilter, RuntimeLevel_FiltersLogs) {
+  ASSERT_TRUE(SetModuleLevel("wifi", PW_LOG_LEVEL_ERROR));
+  EXPECT_EQ(GetModuleLevel("wifi"), PW_LOG_LEVEL_ERROR);
+
+  TEST_LOG(PW_LOG_LEVEL_WARN);
+  EXPECT_EQ(logs_encoded, 0);
+  TEST_LOG(PW_LOG_LEVEL_ERROR);
+  EXPECT_EQ(logs_encoded, 1);
+}
+
+TEST_F(ModuleFilter, RuntimeLevel_CannotEnableCompiledOutLogs) {
+  ASSERT_TRUE(SetModuleLevel("wifi", PW_LOG_LEVEL_DEBUG));
+  EXPECT_EQ(GetModuleLevel("wifi"), PW_LOG_LEVEL_INFO);
+
+  TEST_LOG(PW_LOG_LEVEL_DEBUG);
+  EXPECT_EQ(logs_encoded, 0);
+}
+
+TEST_F(ModuleFilter, RuntimeLevel_OnlyAffectsItsModule) {
+  ASSERT_TRUE(SetModuleLevel("ble", PW_LOG_LEVEL_FATAL));
+  TEST_LOG(PW_LOG_LEVEL_INFO);
+  EXPECT_EQ(logs_encoded, 1);
+}
+
+TEST_F(ModuleFilter, SetModuleLevel_UnlistedModule_ReturnsFalse) {
+  EXPECT_FALSE(SetModuleLevel("not listed", PW_LOG_LEVEL_ERROR));
+  EXPECT_EQ(GetModuleLevel("not listed"), 0);
+}
+
+#undef PW_LOG_MODULE_NAME
+#define PW_LOG_MODULE_NAME "not listed"
+
+TEST_F(ModuleFilter, UnlistedModule_UsesDefaultLevel) {
+  TEST_LOG(PW_LOG_LEVEL_DEBUG);
+  EXPECT_EQ(logs_encoded, 1);
+
+  SetDefaultModuleLevel(PW_LOG_LEVEL_WARN);
+  EXPECT_EQ(GetModuleLevel("not listed"), PW_LOG_LEVEL_WARN);
+
+  TEST_LOG(PW_LOG_LEVEL_INFO);
+  EXPECT_EQ(logs_encoded, 1);
+  TEST_LOG(PW_LOG_LEVEL_WARN);
+  EXPECT_EQ(logs_encoded, 2);
+}
+
+}  // namespace
+}  // namespace pw::log_tokenized
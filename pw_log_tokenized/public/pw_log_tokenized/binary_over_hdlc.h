@@ -0,0 +1,22 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+// The HDLC address to which to write binary tokenized logs. Each frame is the
+// log's 32-bit metadata payload, little endian, followed by the tokenized
+// message. This is the same format as the entries that DrainToMultiSink()
+// writes, so those entries may be sent to this address as they are.
+#ifndef PW_LOG_TOKENIZED_BINARY_LOG_HDLC_ADDRESS
+#define PW_LOG_TOKENIZED_BINARY_LOG_HDLC_ADDRESS 'L'
+#endif  // PW_LOG_TOKENIZED_BINARY_LOG_HDLC_ADDRESS
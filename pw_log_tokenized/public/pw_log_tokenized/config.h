@@ -80,3 +80,22 @@ static_assert((PW_LOG_TOKENIZED_LEVEL_BITS + PW_LOG_TOKENIZED_LINE_BITS +
 #define PW_LOG_TOKENIZED_ENCODE_MESSAGE \
   PW_TOKENIZE_TO_GLOBAL_HANDLER_WITH_PAYLOAD
 #endif  // PW_LOG_TOKENIZED_ENCODE_MESSAGE
+
+// Set to 1 to filter logs by module and level before they are encoded. Logs
+// below a module's level in PW_LOG_TOKENIZED_MODULE_LEVELS are compiled out,
+// and the rest are checked against a runtime level table. Filtering only
+// applies to logs from C++; logs from C are always encoded.
+#ifndef PW_LOG_TOKENIZED_MODULE_FILTER
+#define PW_LOG_TOKENIZED_MODULE_FILTER 0
+#endif  // PW_LOG_TOKENIZED_MODULE_FILTER
+
+// The modules with their own log levels, as a comma-separated list of
+// {"module name", level} pairs. The names must match PW_LOG_MODULE_NAME.
+// Modules that are not listed share a default level, which starts at 0 (all
+// logs enabled). For example:
+//
+//   -DPW_LOG_TOKENIZED_MODULE_LEVELS='{"wifi", 3}, {"ble", 2}'
+//
+#ifndef PW_LOG_TOKENIZED_MODULE_LEVELS
+#define PW_LOG_TOKENIZED_MODULE_LEVELS
+#endif  // PW_LOG_TOKENIZED_MODULE_LEVELS
@@ -16,6 +16,7 @@
 #include <stdint.h>
 
 #include "pw_log_tokenized/config.h"
+#include "pw_log_tokenized/module_filter.h"
 #include "pw_tokenizer/tokenize_to_global_handler_with_payload.h"
 
 // TODO(hepler): Remove this include.
@@ -47,22 +48,33 @@
 //     }
 //   }
 //
-#define PW_LOG_TOKENIZED_TO_GLOBAL_HANDLER_WITH_PAYLOAD(                     \
-    level, flags, message, ...)                                              \
-  do {                                                                       \
-    _PW_TOKENIZER_CONST uintptr_t _pw_log_tokenized_module_token =           \
-        PW_TOKENIZE_STRING_MASK("pw_log_module_names",                       \
-                                ((1u << PW_LOG_TOKENIZED_MODULE_BITS) - 1u), \
-                                PW_LOG_MODULE_NAME);                         \
-    const uintptr_t _pw_log_tokenized_level = level;                         \
-    PW_LOG_TOKENIZED_ENCODE_MESSAGE(                                         \
-        (_PW_LOG_TOKENIZED_LEVEL(_pw_log_tokenized_level) |                  \
-         _PW_LOG_TOKENIZED_MODULE(_pw_log_tokenized_module_token) |          \
-         _PW_LOG_TOKENIZED_FLAGS(flags) | _PW_LOG_TOKENIZED_LINE()),         \
-        PW_LOG_TOKENIZED_FORMAT_STRING(message),                             \
-        __VA_ARGS__);                                                        \
+//
+// If PW_LOG_TOKENIZED_MODULE_FILTER is enabled, the log is checked against its
+// module's level before the module token, metadata, or arguments are evaluated.
+#define PW_LOG_TOKENIZED_TO_GLOBAL_HANDLER_WITH_PAYLOAD(                       \
+    level, flags, message, ...)                                                \
+  do {                                                                         \
+    const uintptr_t _pw_log_tokenized_level = level;                           \
+    if (_PW_LOG_TOKENIZED_ENABLED(_pw_log_tokenized_level)) {                  \
+      _PW_TOKENIZER_CONST uintptr_t _pw_log_tokenized_module_token =           \
+          PW_TOKENIZE_STRING_MASK("pw_log_module_names",                       \
+                                  ((1u << PW_LOG_TOKENIZED_MODULE_BITS) - 1u), \
+                                  PW_LOG_MODULE_NAME);                         \
+      PW_LOG_TOKENIZED_ENCODE_MESSAGE(                                         \
+          (_PW_LOG_TOKENIZED_LEVEL(_pw_log_tokenized_level) |                  \
+           _PW_LOG_TOKENIZED_MODULE(_pw_log_tokenized_module_token) |          \
+           _PW_LOG_TOKENIZED_FLAGS(flags) | _PW_LOG_TOKENIZED_LINE()),         \
+          PW_LOG_TOKENIZED_FORMAT_STRING(message),                             \
+          __VA_ARGS__);                                                        \
+    }                                                                          \
   } while (0)
 
+#if PW_LOG_TOKENIZED_MODULE_FILTER
+#define _PW_LOG_TOKENIZED_ENABLED(level) _PW_LOG_TOKENIZED_MODULE_ENABLED(level)
+#else
+#define _PW_LOG_TOKENIZED_ENABLED(level) 1
+#endif  // PW_LOG_TOKENIZED_MODULE_FILTER
+
 // If the level field is present, clamp it to the maximum value.
 #if PW_LOG_TOKENIZED_LEVEL_BITS == 0
 #define _PW_LOG_TOKENIZED_LEVEL(value) ((uintptr_t)0)
@@ -0,0 +1,113 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_log_tokenized/config.h"
+
+#ifdef __cplusplus
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+namespace pw::log_tokenized {
+
+struct ModuleLevel {
+  std::string_view module_name;
+  int level;
+};
+
+namespace internal {
+
+// The compile-time module levels. Entry 0 is for modules that are not listed
+// in PW_LOG_TOKENIZED_MODULE_LEVELS.
+inline constexpr ModuleLevel kModuleLevels[] = {
+    {"", 0}, PW_LOG_TOKENIZED_MODULE_LEVELS};
+
+inline constexpr size_t kModuleCount = std::size(kModuleLevels);
+
+// Returns the index of a module in kModuleLevels, or 0 if it is not listed.
+constexpr size_t ModuleIndex(std::string_view module_name) {
+  for (size_t i = 1; i < kModuleCount; ++i) {
+    if (kModuleLevels[i].module_name == module_name) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+// The runtime module levels. A log must be at or above both its module's
+// compile-time and runtime levels. The runtime levels start at 0, so they are
+// usable before static constructors run.
+inline std::atomic<uint8_t> runtime_module_levels[kModuleCount] = {};
+
+// The module index is a template argument, so it is always evaluated at compile
+// time. When the level is a constant below the compile-time level, the log and
+// its arguments are compiled out.
+template <size_t kModule>
+inline bool ModuleLevelEnabled(int level) {
+  static_assert(kModule < kModuleCount);
+  return level >= kModuleLevels[kModule].level &&
+         level >= static_cast<int>(runtime_module_levels[kModule].load(
+                      std::memory_order_relaxed));
+}
+
+}  // namespace internal
+
+// Sets the runtime level of a module listed in PW_LOG_TOKENIZED_MODULE_LEVELS.
+// Logs below the module's compile-time level remain disabled. Returns false if
+// the module is not listed.
+inline bool SetModuleLevel(std::string_view module_name, int level) {
+  const size_t index = internal::ModuleIndex(module_name);
+  if (index == 0) {
+    return false;
+  }
+  internal::runtime_module_levels[index].store(static_cast<uint8_t>(level),
+                                               std::memory_order_relaxed);
+  return true;
+}
+
+// Sets the runtime level of modules that are not listed in
+// PW_LOG_TOKENIZED_MODULE_LEVELS.
+inline void SetDefaultModuleLevel(int level) {
+  internal::runtime_module_levels[0].store(static_cast<uint8_t>(level),
+                                           std::memory_order_relaxed);
+}
+
+// Returns the level below which a module's logs are dropped.
+inline int GetModuleLevel(std::string_view module_name) {
+  const size_t index = internal::ModuleIndex(module_name);
+  const int runtime_level = internal::runtime_module_levels[index].load(
+      std::memory_order_relaxed);
+  return runtime_level > internal::kModuleLevels[index].level
+             ? runtime_level
+             : internal::kModuleLevels[index].level;
+}
+
+}  // namespace pw::log_tokenized
+
+// Evaluates to true if a log at this level from PW_LOG_MODULE_NAME should be
+// encoded.
+#define _PW_LOG_TOKENIZED_MODULE_ENABLED(level)      \
+  ::pw::log_tokenized::internal::ModuleLevelEnabled< \
+      ::pw::log_tokenized::internal::ModuleIndex(PW_LOG_MODULE_NAME)>(level)
+
+#else
+
+// C logs are not filtered.
+#define _PW_LOG_TOKENIZED_MODULE_ENABLED(level) 1
+
+#endif  // __cplusplus
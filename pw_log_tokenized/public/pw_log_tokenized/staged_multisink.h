@@ -0,0 +1,36 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_log_tokenized/staging_buffer.h"
+#include "pw_multisink/multisink.h"
+
+namespace pw::log_tokenized {
+
+// Returns the StagingBuffer for the calling core and execution context. The
+// staged_multisink backend calls this for every tokenized message, so it must
+// be provided by the system. Contexts that can preempt each other, such as an
+// interrupt and the thread it interrupts, must get different buffers.
+StagingBuffer& GetStagingBuffer();
+
+// Moves all entries in a StagingBuffer to a MultiSink and reports any dropped
+// messages to it. Each multisink entry is the message's payload, as a
+// little-endian uint32_t, followed by the encoded tokenized message.
+//
+// This takes the multisink's lock, so it must be called from a thread. Only
+// one thread may drain a particular StagingBuffer.
+void DrainToMultiSink(StagingBuffer& staging_buffer,
+                      multisink::MultiSink& multisink);
+
+}  // namespace pw::log_tokenized
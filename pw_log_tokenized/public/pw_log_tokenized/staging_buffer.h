@@ -0,0 +1,122 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+#include "pw_tokenizer/tokenize_to_global_handler_with_payload.h"
+
+namespace pw::log_tokenized {
+
+// A lock-free, single-producer single-consumer queue of tokenized messages.
+//
+// Each core or execution context that logs (e.g. each thread context and each
+// interrupt context on each core) gets its own StagingBuffer. The producer
+// appends messages with TryPush without taking a lock, and a single consumer
+// later removes them with Pop, typically to forward them to a pw_multisink.
+//
+// Messages that do not fit are dropped and counted. The counters are only
+// loaded and stored, never read-modify-written, so this class does not require
+// atomic read-modify-write instructions.
+class StagingBuffer {
+ public:
+  // Payloads are stored as 32 bits, which holds pw_log_tokenized's metadata.
+  static constexpr size_t kPayloadSizeBytes = sizeof(uint32_t);
+
+  // Each entry is stored with a 2-byte size and the payload.
+  static constexpr size_t kEntryOverheadBytes = 2 + kPayloadSizeBytes;
+
+  constexpr StagingBuffer(ByteSpan buffer)
+      : buffer_(buffer),
+        write_index_(0),
+        read_index_(0),
+        dropped_(0),
+        dropped_reported_(0) {}
+
+  StagingBuffer(const StagingBuffer&) = delete;
+  StagingBuffer& operator=(const StagingBuffer&) = delete;
+
+  // Producer side. Appends a message and its payload. Returns false and
+  // increments the drop count if there is not enough room for the message.
+  //
+  // Must only be called from the context that owns this buffer.
+  bool TryPush(pw_tokenizer_Payload payload,
+               std::span<const uint8_t> message);
+
+  // Consumer side. Copies the oldest entry into the provided buffer and
+  // removes it. The entry is the payload, as a little-endian uint32_t,
+  // followed by the message.
+  //
+  // Returns:
+  //   OK - the entry was copied into the buffer
+  //   OUT_OF_RANGE - no entries are staged
+  //   RESOURCE_EXHAUSTED - the buffer is too small; the entry is discarded and
+  //       counted as dropped
+  //
+  // Must only be called from a single consumer.
+  Result<ConstByteSpan> Pop(ByteSpan buffer);
+
+  // Consumer side. Returns the number of messages dropped since the last call.
+  uint32_t TakeDropCount() {
+    const uint32_t dropped = dropped_.load(std::memory_order_relaxed);
+    const uint32_t new_drops = dropped - dropped_reported_;
+    dropped_reported_ = dropped;
+    return new_drops;
+  }
+
+  // Consumer side. Returns true if no entries are staged.
+  bool empty() const {
+    return write_index_.load(std::memory_order_acquire) ==
+           read_index_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Indices run from 0 to 2 * capacity so that a full buffer can be told
+  // apart from an empty one without a separate flag.
+  size_t Advance(size_t index, size_t bytes) const {
+    index += bytes;
+    return index >= 2 * buffer_.size() ? index - 2 * buffer_.size() : index;
+  }
+
+  size_t UsedBytes(size_t write_index, size_t read_index) const {
+    return write_index >= read_index
+               ? write_index - read_index
+               : write_index + 2 * buffer_.size() - read_index;
+  }
+
+  void CopyIn(size_t index, const void* data, size_t size);
+  void CopyOut(size_t index, void* data, size_t size) const;
+
+  const ByteSpan buffer_;
+
+  // Written only by the producer.
+  std::atomic<size_t> write_index_;
+
+  // Written only by the consumer.
+  std::atomic<size_t> read_index_;
+
+  // Written only by the producer.
+  std::atomic<uint32_t> dropped_;
+
+  // Owned by the consumer. Entries the consumer discards are counted by
+  // decrementing this, so only the producer ever writes dropped_.
+  uint32_t dropped_reported_;
+};
+
+}  // namespace pw::log_tokenized
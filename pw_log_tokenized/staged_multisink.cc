@@ -0,0 +1,59 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This file provides a backend for pw_tokenizer / pw_log_tokenized that stages
+// tokenized logs in per-context lock-free buffers. The buffers are drained into
+// a pw_multisink separately, so logging never contends on the multisink lock.
+
+#include "pw_log_tokenized/staged_multisink.h"
+
+#include <array>
+#include <cstddef>
+
+#include "pw_tokenizer/config.h"
+#include "pw_tokenizer/tokenize_to_global_handler_with_payload.h"
+
+namespace pw::log_tokenized {
+
+void DrainToMultiSink(StagingBuffer& staging_buffer,
+                      multisink::MultiSink& multisink) {
+  std::array<std::byte,
+             StagingBuffer::kPayloadSizeBytes +
+                 PW_TOKENIZER_CFG_ENCODING_BUFFER_SIZE_BYTES>
+      entry;
+
+  while (true) {
+    const Result<ConstByteSpan> result = staging_buffer.Pop(entry);
+    if (result.status().IsOutOfRange()) {
+      break;
+    }
+    if (result.ok()) {
+      multisink.HandleEntry(result.value());
+    }
+  }
+
+  if (const uint32_t dropped = staging_buffer.TakeDropCount(); dropped != 0u) {
+    multisink.HandleDropped(dropped);
+  }
+}
+
+// Appends tokenized logs to the calling context's StagingBuffer.
+extern "C" void pw_tokenizer_HandleEncodedMessageWithPayload(
+    pw_tokenizer_Payload payload,
+    const uint8_t encoded_message[],
+    size_t size_bytes) {
+  GetStagingBuffer().TryPush(payload, std::span(encoded_message, size_bytes));
+}
+
+}  // namespace pw::log_tokenized
@@ -0,0 +1,103 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_log_tokenized/staging_buffer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "pw_bytes/endian.h"
+
+namespace pw::log_tokenized {
+
+bool StagingBuffer::TryPush(pw_tokenizer_Payload payload,
+                            std::span<const uint8_t> message) {
+  const size_t write_index = write_index_.load(std::memory_order_relaxed);
+  const size_t read_index = read_index_.load(std::memory_order_acquire);
+
+  const size_t entry_size = kEntryOverheadBytes + message.size();
+  if (message.size() > 0xffffu ||
+      entry_size > buffer_.size() - UsedBytes(write_index, read_index)) {
+    dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+    return false;
+  }
+
+  const auto size =
+      bytes::CopyInOrder(std::endian::little, uint16_t(message.size()));
+  const auto payload_bytes =
+      bytes::CopyInOrder(std::endian::little, uint32_t(payload));
+
+  size_t index = write_index;
+  CopyIn(index, size.data(), size.size());
+  index = Advance(index, size.size());
+  CopyIn(index, payload_bytes.data(), payload_bytes.size());
+  index = Advance(index, payload_bytes.size());
+  CopyIn(index, message.data(), message.size());
+
+  // Publish the entry to the consumer only after it is fully written.
+  write_index_.store(Advance(index, message.size()), std::memory_order_release);
+  return true;
+}
+
+Result<ConstByteSpan> StagingBuffer::Pop(ByteSpan buffer) {
+  const size_t read_index = read_index_.load(std::memory_order_relaxed);
+  const size_t write_index = write_index_.load(std::memory_order_acquire);
+
+  if (read_index == write_index) {
+    return Status::OutOfRange();
+  }
+
+  std::array<std::byte, 2> size_bytes;
+  CopyOut(read_index, size_bytes.data(), size_bytes.size());
+  const size_t entry_size =
+      kPayloadSizeBytes +
+      bytes::ReadInOrder<uint16_t>(std::endian::little, size_bytes);
+
+  const size_t entry_index = Advance(read_index, size_bytes.size());
+  const size_t next_index = Advance(entry_index, entry_size);
+
+  if (buffer.size() < entry_size) {
+    read_index_.store(next_index, std::memory_order_release);
+    dropped_reported_ -= 1;
+    return Status::ResourceExhausted();
+  }
+
+  CopyOut(entry_index, buffer.data(), entry_size);
+
+  // Release the space to the producer only after the entry is copied out.
+  read_index_.store(next_index, std::memory_order_release);
+  return ConstByteSpan(buffer.first(entry_size));
+}
+
+void StagingBuffer::CopyIn(size_t index, const void* data, size_t size) {
+  const size_t offset = index % buffer_.size();
+  const size_t first = std::min(size, buffer_.size() - offset);
+
+  std::memcpy(&buffer_[offset], data, first);
+  std::memcpy(buffer_.data(), static_cast<const std::byte*>(data) + first,
+              size - first);
+}
+
+void StagingBuffer::CopyOut(size_t index, void* data, size_t size) const {
+  const size_t offset = index % buffer_.size();
+  const size_t first = std::min(size, buffer_.size() - offset);
+
+  std::memcpy(data, &buffer_[offset], first);
+  std::memcpy(static_cast<std::byte*>(data) + first, buffer_.data(),
+              size - first);
+}
+
+}  // namespace pw::log_tokenized
@@ -0,0 +1,105 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_log_tokenized/staging_buffer.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/endian.h"
+
+namespace pw::log_tokenized {
+namespace {
+
+constexpr uint8_t kMessage[] = {0x12, 0x34, 0x56, 0x78, 0x9a};
+
+class StagingBufferTest : public ::testing::Test {
+ protected:
+  StagingBufferTest() : buffer_{}, staging_(buffer_) {}
+
+  // Pops an entry and checks its payload and message.
+  void ExpectEntry(uint32_t payload, std::span<const uint8_t> message) {
+    std::array<std::byte, 32> entry;
+    Result<ConstByteSpan> result = staging_.Pop(entry);
+    ASSERT_EQ(OkStatus(), result.status());
+    ASSERT_EQ(result.value().size(), sizeof(payload) + message.size());
+    EXPECT_EQ(payload,
+              bytes::ReadInOrder<uint32_t>(std::endian::little,
+                                           result.value().data()));
+    EXPECT_EQ(0,
+              std::memcmp(result.value().data() + sizeof(payload),
+                          message.data(),
+                          message.size()));
+  }
+
+  std::array<std::byte, 32> buffer_;
+  StagingBuffer staging_;
+};
+
+TEST_F(StagingBufferTest, Empty) {
+  std::array<std::byte, 32> entry;
+  EXPECT_TRUE(staging_.empty());
+  EXPECT_EQ(Status::OutOfRange(), staging_.Pop(entry).status());
+  EXPECT_EQ(0u, staging_.TakeDropCount());
+}
+
+TEST_F(StagingBufferTest, PushPop) {
+  ASSERT_TRUE(staging_.TryPush(0xabcd1234, kMessage));
+  ASSERT_TRUE(staging_.TryPush(7, std::span(kMessage).first(1)));
+  EXPECT_FALSE(staging_.empty());
+
+  ExpectEntry(0xabcd1234, kMessage);
+  ExpectEntry(7, std::span(kMessage).first(1));
+  EXPECT_TRUE(staging_.empty());
+}
+
+TEST_F(StagingBufferTest, Full_DropsAndCounts) {
+  // Each entry takes 11 of the 32 bytes.
+  EXPECT_TRUE(staging_.TryPush(1, kMessage));
+  EXPECT_TRUE(staging_.TryPush(2, kMessage));
+  EXPECT_FALSE(staging_.TryPush(3, kMessage));
+  EXPECT_FALSE(staging_.TryPush(4, kMessage));
+  EXPECT_EQ(2u, staging_.TakeDropCount());
+  EXPECT_EQ(0u, staging_.TakeDropCount());
+
+  ExpectEntry(1, kMessage);
+  ExpectEntry(2, kMessage);
+}
+
+TEST_F(StagingBufferTest, WrapsAround) {
+  for (uint32_t i = 0; i < 100; ++i) {
+    ASSERT_TRUE(staging_.TryPush(i, std::span(kMessage).first(i % 6)));
+    ASSERT_TRUE(staging_.TryPush(i + 1000, kMessage));
+    ExpectEntry(i, std::span(kMessage).first(i % 6));
+    ExpectEntry(i + 1000, kMessage);
+  }
+  EXPECT_TRUE(staging_.empty());
+  EXPECT_EQ(0u, staging_.TakeDropCount());
+}
+
+TEST_F(StagingBufferTest, PopToSmallBuffer_DiscardsEntry) {
+  ASSERT_TRUE(staging_.TryPush(1, kMessage));
+  ASSERT_TRUE(staging_.TryPush(2, kMessage));
+
+  std::array<std::byte, 4> too_small;
+  EXPECT_EQ(Status::ResourceExhausted(), staging_.Pop(too_small).status());
+  EXPECT_EQ(1u, staging_.TakeDropCount());
+
+  ExpectEntry(2, kMessage);
+  EXPECT_TRUE(staging_.empty());
+}
+
+}  // namespace
+}  // namespace pw::log_tokenized
@@ -12,13 +12,20 @@
 // License for the specific language governing permissions and limitations under
 // the License.
 
+#include <cstdint>
+#include <cstring>
+#include <mutex>
 #include <span>
 
+#include "pw_allocator/block_cache.h"
 #include "pw_allocator/freelist_heap.h"
 #include "pw_boot_armv7m/boot.h"
 #include "pw_malloc/malloc.h"
+#include "pw_malloc_freelist/config.h"
+#include "pw_malloc_freelist/freelist_malloc.h"
 #include "pw_preprocessor/compiler.h"
 #include "pw_preprocessor/util.h"
+#include "pw_sync/interrupt_spin_lock.h"
 
 namespace {
 std::aligned_storage_t<sizeof(pw::allocator::FreeListHeapBuffer<>),
@@ -27,6 +34,65 @@ std::aligned_storage_t<sizeof(pw::allocator::FreeListHeapBuffer<>),
 }  // namespace
 pw::allocator::FreeListHeapBuffer<>* pw_freelist_heap;
 
+namespace {
+
+#if PW_MALLOC_FREELIST_CONFIG_THREAD_CACHE
+
+using pw::allocator::BlockCache;
+
+pw::sync::InterruptSpinLock heap_lock;
+thread_local BlockCache thread_cache;
+
+void* Allocate(size_t size) {
+  if (void* ptr = thread_cache.Take(size); ptr != nullptr) {
+    return ptr;
+  }
+  std::lock_guard lock(heap_lock);
+  return pw_freelist_heap->Allocate(BlockCache::RoundUp(size));
+}
+
+void Free(void* ptr) {
+  if (ptr == nullptr || thread_cache.Put(ptr)) {
+    return;
+  }
+  std::lock_guard lock(heap_lock);
+  pw_freelist_heap->Free(ptr);
+}
+
+void* Realloc(void* ptr, size_t size) {
+  std::lock_guard lock(heap_lock);
+  return pw_freelist_heap->Realloc(ptr, size);
+}
+
+void* Calloc(size_t num, size_t size) {
+  if (num != 0u && size > SIZE_MAX / num) {
+    return nullptr;
+  }
+  void* ptr = Allocate(num * size);
+  if (ptr != nullptr) {
+    std::memset(ptr, 0, num * size);
+  }
+  return ptr;
+}
+
+#else
+
+void* Allocate(size_t size) { return pw_freelist_heap->Allocate(size); }
+
+void Free(void* ptr) { pw_freelist_heap->Free(ptr); }
+
+void* Realloc(void* ptr, size_t size) {
+  return pw_freelist_heap->Realloc(ptr, size);
+}
+
+void* Calloc(size_t num, size_t size) {
+  return pw_freelist_heap->Calloc(num, size);
+}
+
+#endif  // PW_MALLOC_FREELIST_CONFIG_THREAD_CACHE
+
+}  // namespace
+
 #if __cplusplus
 extern "C" {
 #endif  // __cplusplus
@@ -46,31 +112,34 @@ void pw_MallocInit() {
 // "__wrap_<function name>" with "<function_name>", and calling
 // "<function name>" will call "__wrap_<function name>" instead
 // Linker options are set in a config in "pw_malloc:pw_malloc_config".
-void* __wrap_malloc(size_t size) { return pw_freelist_heap->Allocate(size); }
+void* __wrap_malloc(size_t size) { return Allocate(size); }
 
-void __wrap_free(void* ptr) { pw_freelist_heap->Free(ptr); }
+void __wrap_free(void* ptr) { Free(ptr); }
 
-void* __wrap_realloc(void* ptr, size_t size) {
-  return pw_freelist_heap->Realloc(ptr, size);
-}
+void* __wrap_realloc(void* ptr, size_t size) { return Realloc(ptr, size); }
 
-void* __wrap_calloc(size_t num, size_t size) {
-  return pw_freelist_heap->Calloc(num, size);
-}
+void* __wrap_calloc(size_t num, size_t size) { return Calloc(num, size); }
 
-void* __wrap__malloc_r(struct _reent*, size_t size) {
-  return pw_freelist_heap->Allocate(size);
-}
+void* __wrap__malloc_r(struct _reent*, size_t size) { return Allocate(size); }
 
-void __wrap__free_r(struct _reent*, void* ptr) { pw_freelist_heap->Free(ptr); }
+void __wrap__free_r(struct _reent*, void* ptr) { Free(ptr); }
 
 void* __wrap__realloc_r(struct _reent*, void* ptr, size_t size) {
-  return pw_freelist_heap->Realloc(ptr, size);
+  return Realloc(ptr, size);
 }
 
 void* __wrap__calloc_r(struct _reent*, size_t num, size_t size) {
-  return pw_freelist_heap->Calloc(num, size);
+  return Calloc(num, size);
+}
+
+#if PW_MALLOC_FREELIST_CONFIG_THREAD_CACHE
+void pw_MallocFreelistFlushThreadCache() {
+  std::lock_guard lock(heap_lock);
+  while (void* ptr = thread_cache.TakeAny()) {
+    pw_freelist_heap->Free(ptr);
+  }
 }
+#endif  // PW_MALLOC_FREELIST_CONFIG_THREAD_CACHE
 #if __cplusplus
 }
 #endif  // __cplusplus
@@ -0,0 +1,27 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+// PW_MALLOC_FREELIST_CONFIG_THREAD_CACHE enables per-thread caches of small
+// free blocks in front of the global freelist heap. Threads allocate from and
+// free into their own cache without a lock, and only take the heap's lock when
+// the cache is empty or full. The global heap is then protected by an
+// InterruptSpinLock.
+//
+// This requires C++ thread_local support from the toolchain and RTOS. It is
+// disabled by default, in which case the heap is not locked and callers must
+// serialize access to it, for example with the C library's malloc lock hooks.
+#ifndef PW_MALLOC_FREELIST_CONFIG_THREAD_CACHE
+#define PW_MALLOC_FREELIST_CONFIG_THREAD_CACHE 0
+#endif  // PW_MALLOC_FREELIST_CONFIG_THREAD_CACHE
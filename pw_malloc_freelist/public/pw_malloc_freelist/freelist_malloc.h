@@ -14,6 +14,17 @@
 #pragma once
 
 #include "pw_allocator/freelist_heap.h"
+#include "pw_malloc_freelist/config.h"
 
 // Global variables to initialize a freelist heap.
 extern pw::allocator::FreeListHeapBuffer<>* pw_freelist_heap;
+
+#if PW_MALLOC_FREELIST_CONFIG_THREAD_CACHE
+
+// Returns the blocks in the calling thread's cache to the global heap. Threads
+// should call this before they exit; otherwise their cached blocks remain
+// allocated. Blocks in a thread cache are counted as allocated in the heap's
+// statistics.
+extern "C" void pw_MallocFreelistFlushThreadCache();
+
+#endif  // PW_MALLOC_FREELIST_CONFIG_THREAD_CACHE
@@ -0,0 +1,52 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_malloc_tlsf/tlsf_malloc.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace pw::allocator {
+namespace {
+
+TEST(TlsfMalloc, ReplacingMalloc) {
+  const TlsfHeap::HeapStats& stats = pw_tlsf_heap->heap_stats();
+  const size_t allocate_calls = stats.total_allocate_calls;
+  const size_t free_calls = stats.total_free_calls;
+
+  void* ptr = malloc(256);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(stats.total_allocate_calls, allocate_calls + 1);
+
+  std::memset(ptr, 0x5a, 256);
+  void* grown = realloc(ptr, 512);
+  ASSERT_NE(grown, nullptr);
+  EXPECT_EQ(static_cast<unsigned char*>(grown)[255], 0x5a);
+
+  unsigned char* zeroed = static_cast<unsigned char*>(calloc(4, 64));
+  ASSERT_NE(zeroed, nullptr);
+  for (size_t i = 0; i < 4 * 64; ++i) {
+    EXPECT_EQ(zeroed[i], 0u);
+  }
+
+  free(grown);
+  free(zeroed);
+  EXPECT_EQ(stats.total_allocate_calls, allocate_calls + 3);
+  EXPECT_EQ(stats.total_free_calls, free_calls + 3);
+}
+
+}  // namespace
+}  // namespace pw::allocator
@@ -14,7 +14,11 @@
 
 #include "pw_metric/metric.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstring>
+#include <limits>
 #include <span>
 
 #include "pw_assert/check.h"
@@ -42,6 +46,42 @@ struct Base64EncodedToken {
   std::array<char, 16> data;
 };
 
+// Access a metric's value, whether or not it is atomic. The atomic operations
+// are relaxed, since metrics don't synchronize other data.
+#if PW_METRIC_ATOMIC_UPDATES
+
+uint32_t Load(const std::atomic<uint32_t>& value) {
+  return value.load(std::memory_order_relaxed);
+}
+
+void Store(std::atomic<uint32_t>& value, uint32_t new_value) {
+  value.store(new_value, std::memory_order_relaxed);
+}
+
+void Add(std::atomic<uint32_t>& value, uint32_t amount) {
+  value.fetch_add(amount, std::memory_order_relaxed);
+}
+
+#else
+
+uint32_t Load(const uint32_t& value) { return value; }
+
+void Store(uint32_t& value, uint32_t new_value) { value = new_value; }
+
+void Add(uint32_t& value, uint32_t amount) { value += amount; }
+
+#endif  // PW_METRIC_ATOMIC_UPDATES
+
+#if PW_METRIC_TRACK_GENERATIONS
+
+std::atomic<uint32_t> current_generation{1};
+
+uint32_t CurrentGeneration() {
+  return current_generation.load(std::memory_order_relaxed);
+}
+
+#endif  // PW_METRIC_TRACK_GENERATIONS
+
 const char* Indent(int level) {
   static const char* kWhitespace8 = "        ";
   level = std::min(level, 4);
@@ -50,6 +90,14 @@ const char* Indent(int level) {
 
 }  // namespace
 
+uint32_t StartGeneration() {
+#if PW_METRIC_TRACK_GENERATIONS
+  return current_generation.fetch_add(1) + 1;
+#else
+  return 0;
+#endif  // PW_METRIC_TRACK_GENERATIONS
+}
+
 // Enable easier registration when used as a member.
 Metric::Metric(Token name, float value, IntrusiveList<Metric>& metrics)
     : Metric(name, value) {
@@ -62,27 +110,74 @@ Metric::Metric(Token name, uint32_t value, IntrusiveList<Metric>& metrics)
 
 float Metric::as_float() const {
   PW_DCHECK(is_float());
-  return float_;
+  const uint32_t bits = Load(value_);
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
 }
 
 uint32_t Metric::as_int() const {
   PW_DCHECK(is_int());
-  return uint_;
+  return Load(value_);
+}
+
+bool Metric::UpdatedSince([[maybe_unused]] uint32_t generation) const {
+#if PW_METRIC_TRACK_GENERATIONS
+  return Load(generation_) >= generation;
+#else
+  return true;
+#endif  // PW_METRIC_TRACK_GENERATIONS
+}
+
+// With atomic updates, an update may race with a StartGeneration() call in
+// MetricService::Get(). Recording the generation both before and after the
+// update, with a fence before the second, ensures that either the update
+// completes before the new generation starts, so the Get() sees both the value
+// and the old generation; or the update records the new generation, so the next
+// Get() sends it.
+void Metric::BeginUpdate() {
+#if PW_METRIC_TRACK_GENERATIONS && PW_METRIC_ATOMIC_UPDATES
+  Store(generation_, CurrentGeneration());
+#endif  // PW_METRIC_TRACK_GENERATIONS && PW_METRIC_ATOMIC_UPDATES
+}
+
+void Metric::EndUpdate() {
+#if PW_METRIC_TRACK_GENERATIONS
+#if PW_METRIC_ATOMIC_UPDATES
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif  // PW_METRIC_ATOMIC_UPDATES
+  Store(generation_, CurrentGeneration());
+#endif  // PW_METRIC_TRACK_GENERATIONS
 }
 
 void Metric::Increment(uint32_t amount) {
   PW_DCHECK(is_int());
-  uint_ += amount;
+  BeginUpdate();
+  Add(value_, amount);
+  EndUpdate();
 }
 
+// Setting a metric to its current value is not an update, so that metrics that
+// are set periodically are only sent when they change.
 void Metric::SetInt(uint32_t value) {
   PW_DCHECK(is_int());
-  uint_ = value;
+  if (Load(value_) == value) {
+    return;
+  }
+  BeginUpdate();
+  Store(value_, value);
+  EndUpdate();
 }
 
 void Metric::SetFloat(float value) {
   PW_DCHECK(is_float());
-  float_ = value;
+  const uint32_t bits = FloatBits(value);
+  if (Load(value_) == bits) {
+    return;
+  }
+  BeginUpdate();
+  Store(value_, bits);
+  EndUpdate();
 }
 
 void Metric::Dump(int level) {
@@ -104,6 +199,106 @@ void Metric::Dump(IntrusiveList<Metric>& metrics, int level) {
   }
 }
 
+Distribution::Distribution(Token name,
+                           std::span<uint32_t> buckets,
+                           IntrusiveList<Distribution>& distributions)
+    : Distribution(name, buckets) {
+  distributions.push_front(*this);
+}
+
+bool Distribution::UpdatedSince([[maybe_unused]] uint32_t generation) const {
+#if PW_METRIC_TRACK_GENERATIONS
+  return generation_ >= generation;
+#else
+  return true;
+#endif  // PW_METRIC_TRACK_GENERATIONS
+}
+
+void Distribution::Record(uint32_t value) {
+#if PW_METRIC_TRACK_GENERATIONS
+  generation_ = CurrentGeneration();
+#endif  // PW_METRIC_TRACK_GENERATIONS
+  count_ += 1;
+  sum_ += value;
+  min_ = std::min(min_, value);
+  max_ = std::max(max_, value);
+  if (!buckets_.empty()) {
+    buckets_[std::min(BucketIndex(value), buckets_.size() - 1)] += 1;
+  }
+}
+
+void Distribution::Reset() {
+#if PW_METRIC_TRACK_GENERATIONS
+  generation_ = CurrentGeneration();
+#endif  // PW_METRIC_TRACK_GENERATIONS
+  count_ = 0;
+  sum_ = 0;
+  min_ = std::numeric_limits<uint32_t>::max();
+  max_ = 0;
+  std::fill(buckets_.begin(), buckets_.end(), 0u);
+}
+
+uint32_t Distribution::Percentile(uint32_t percent) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  if (buckets_.empty()) {
+    return max_;
+  }
+
+  // The rank of the sample at the percentile, from 1 to count_.
+  const uint64_t rank = std::clamp<uint64_t>(
+      (uint64_t{count_} * std::min(percent, 100u) + 99) / 100, 1, count_);
+
+  uint64_t samples = 0;
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    samples += buckets_[i];
+    if (samples >= rank) {
+      // The last bucket holds all larger values, so its bound is max_.
+      const uint32_t bound =
+          i + 1 == buckets_.size() ? max_ : BucketUpperBound(i);
+      return std::clamp(bound, min_, max_);
+    }
+  }
+  return max_;
+}
+
+void Distribution::Dump(int level) {
+  Base64EncodedToken encoded_name(name());
+  const char* indent = Indent(level);
+  if (is_histogram()) {
+    PW_LOG_INFO(
+        "%s \"%s\": {\"count\": %u, \"sum\": %llu, \"min\": %u, "
+        "\"max\": %u, \"p50\": %u, \"p90\": %u, \"p99\": %u},",
+        indent,
+        encoded_name.value(),
+        static_cast<unsigned int>(count()),
+        static_cast<unsigned long long>(sum()),
+        static_cast<unsigned int>(min()),
+        static_cast<unsigned int>(max()),
+        static_cast<unsigned int>(Percentile(50)),
+        static_cast<unsigned int>(Percentile(90)),
+        static_cast<unsigned int>(Percentile(99)));
+  } else {
+    PW_LOG_INFO(
+        "%s \"%s\": {\"count\": %u, \"sum\": %llu, \"min\": %u, "
+        "\"max\": %u},",
+        indent,
+        encoded_name.value(),
+        static_cast<unsigned int>(count()),
+        static_cast<unsigned long long>(sum()),
+        static_cast<unsigned int>(min()),
+        static_cast<unsigned int>(max()));
+  }
+}
+
+void Distribution::Dump(IntrusiveList<Distribution>& distributions,
+                        int level) {
+  for (auto& d : distributions) {
+    d.Dump(level);
+  }
+}
+
 Group::Group(Token name) : name_(name) {}
 
 Group::Group(Token name, IntrusiveList<Group>& groups) : name_(name) {
@@ -116,6 +311,7 @@ void Group::Dump(int level) {
   PW_LOG_INFO("%s \"%s\": {", indent, encoded_name.value());
   Group::Dump(children(), level + 1);
   Metric::Dump(metrics(), level + 1);
+  Distribution::Dump(distributions(), level + 1);
   PW_LOG_INFO("%s }", indent);
 }
 
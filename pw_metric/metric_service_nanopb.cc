@@ -14,6 +14,7 @@
 
 #include "pw_metric/metric_service_nanopb.h"
 
+#include <algorithm>
 #include <cstring>
 #include <span>
 
@@ -27,9 +28,13 @@ namespace {
 
 class MetricWriter {
  public:
-  MetricWriter(rpc::ServerWriter<pw_metric_MetricResponse>& response_writer)
+  MetricWriter(rpc::ServerWriter<pw_metric_MetricResponse>& response_writer,
+               uint32_t generation)
       : response_(pw_metric_MetricResponse_init_zero),
-        response_writer_(response_writer) {}
+        response_writer_(response_writer),
+        generation_(generation) {
+    response_.generation = generation_;
+  }
 
   // TODO(keir): Figure out a pw_rpc mechanism to fill a streaming packet based
   // on transport MTU, rather than having this as a static knob. For example,
@@ -68,10 +73,45 @@ class MetricWriter {
     }
   }
 
+  void Write(const Distribution& distribution, const Vector<Token>& path) {
+    std::span<pw_metric_Distribution> distributions(response_.distributions);
+    PW_CHECK_INT_LT(response_.distributions_count, distributions.size());
+
+    pw_metric_Distribution& proto_distribution =
+        response_.distributions[response_.distributions_count];
+
+    std::span<Token> proto_path(proto_distribution.token_path);
+    PW_CHECK_INT_LE(path.size(), proto_path.size());
+    std::copy(path.begin(), path.end(), proto_path.begin());
+    proto_distribution.token_path_count = path.size();
+
+    proto_distribution.count = distribution.count();
+    proto_distribution.sum = distribution.sum();
+    proto_distribution.min = distribution.min();
+    proto_distribution.max = distribution.max();
+
+    // Histograms are limited to kMaxHistogramBuckets, which matches the proto.
+    std::span<const uint32_t> buckets = distribution.bucket_counts();
+    std::span<uint32_t> proto_buckets(proto_distribution.bucket_counts);
+    PW_CHECK_INT_LE(buckets.size(), proto_buckets.size());
+    std::copy(buckets.begin(), buckets.end(), proto_buckets.begin());
+    proto_distribution.bucket_counts_count = buckets.size();
+    if (!buckets.empty()) {
+      proto_distribution.sub_bucket_bits = Distribution::kSubBucketBits;
+    }
+
+    response_.distributions_count++;
+
+    if (response_.distributions_count == distributions.size()) {
+      Flush();
+    }
+  }
+
   void Flush() {
-    if (response_.metrics_count) {
+    if (response_.metrics_count || response_.distributions_count) {
       response_writer_.Write(response_);
       response_ = pw_metric_MetricResponse_init_zero;
+      response_.generation = generation_;
     }
   }
 
@@ -79,23 +119,38 @@ class MetricWriter {
   pw_metric_MetricResponse response_;
   // This RPC stream writer handle must be valid for the metric writer lifetime.
   rpc::ServerWriter<pw_metric_MetricResponse>& response_writer_;
+  const uint32_t generation_;
 };
 
-// Walk a metric tree recursively; passing metrics with their path (names) to a
-// metric writer which can consume them.
+// Walk a metric tree recursively; passing metrics updated since a generation
+// with their path (names) to a metric writer which can consume them.
 //
 // TODO(keir): Generalize this to support a generic visitor.
 class MetricWalker {
  public:
-  MetricWalker(MetricWriter& writer) : writer_(writer) {}
+  MetricWalker(MetricWriter& writer, uint32_t since_generation)
+      : writer_(writer), since_generation_(since_generation) {}
 
   void Walk(const IntrusiveList<Metric>& metrics) {
     for (const auto& m : metrics) {
+      if (!m.UpdatedSince(since_generation_)) {
+        continue;
+      }
       ScopedName scoped_name(m.name(), *this);
       writer_.Write(m, path_);
     }
   }
 
+  void Walk(const IntrusiveList<Distribution>& distributions) {
+    for (const auto& d : distributions) {
+      if (!d.UpdatedSince(since_generation_)) {
+        continue;
+      }
+      ScopedName scoped_name(d.name(), *this);
+      writer_.Write(d, path_);
+    }
+  }
+
   void Walk(const IntrusiveList<Group>& groups) {
     for (const auto& g : groups) {
       Walk(g);
@@ -106,6 +161,7 @@ class MetricWalker {
     ScopedName scoped_name(group.name(), *this);
     Walk(group.children());
     Walk(group.metrics());
+    Walk(group.distributions());
   }
 
  private:
@@ -123,16 +179,21 @@ class MetricWalker {
 
   Vector<Token, 4 /* max depth */> path_;
   MetricWriter& writer_;
+  const uint32_t since_generation_;
 };
 
 }  // namespace
 
 void MetricService::Get(ServerContext&,
-                        const pw_metric_MetricRequest& /* request */,
+                        const pw_metric_MetricRequest& request,
                         ServerWriter<pw_metric_MetricResponse>& response) {
-  // For now, ignore the request and just stream all the metrics back.
-  MetricWriter writer(response);
-  MetricWalker walker(writer);
+  // Start a new generation before reading any metrics, so that updates made
+  // while the metrics are sent are sent again by the next request.
+  MetricWriter writer(response, StartGeneration());
+
+  // Stream back the metrics updated since the requested generation; path
+  // matching is not yet supported.
+  MetricWalker walker(writer, request.generation);
 
   // This will stream all the metrics in the span of this Get() method call.
   // This will have the effect of blocking the RPC thread until all the metrics
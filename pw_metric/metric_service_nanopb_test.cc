@@ -131,6 +131,128 @@ TEST(MetricService, NestedGroupsWithBatches) {
   // TODO(keir): Properly check all the fields.
 }
 
+TEST(MetricService, Distributions) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+  PW_METRIC_HISTOGRAM(root, histogram, "histogram", 16);
+  PW_METRIC_SUMMARY(root, summary, "summary");
+
+  histogram.Record(2);
+  histogram.Record(9);
+  histogram.Record(9);
+  summary.Record(1000);
+
+  PW_METRIC_GROUP(parent, "parent");
+  parent.Add(root);
+
+  // Run the RPC and ensure it completes.
+  MetricMethodContext context(parent.metrics(), parent.children());
+  context.call({});
+  EXPECT_TRUE(context.done());
+  EXPECT_EQ(OkStatus(), context.status());
+
+  // Each response holds one distribution, which is sent with the metrics
+  // written before it.
+  ASSERT_EQ(2u, context.responses().size());
+  EXPECT_EQ(1, context.responses()[0].metrics_count);
+  EXPECT_EQ(0, context.responses()[1].metrics_count);
+
+  // Summaries are sent without buckets.
+  const pw_metric_Distribution& proto_summary =
+      context.responses()[0].distributions[0];
+  ASSERT_EQ(1, context.responses()[0].distributions_count);
+  ASSERT_EQ(2, proto_summary.token_path_count);
+  EXPECT_EQ(root_token, proto_summary.token_path[0]);
+  EXPECT_EQ(summary_token, proto_summary.token_path[1]);
+  EXPECT_EQ(1u, proto_summary.count);
+  EXPECT_EQ(1000u, proto_summary.sum);
+  EXPECT_EQ(0, proto_summary.bucket_counts_count);
+
+  const pw_metric_Distribution& proto_histogram =
+      context.responses()[1].distributions[0];
+  ASSERT_EQ(1, context.responses()[1].distributions_count);
+  EXPECT_EQ(histogram_token, proto_histogram.token_path[1]);
+  EXPECT_EQ(3u, proto_histogram.count);
+  EXPECT_EQ(20u, proto_histogram.sum);
+  EXPECT_EQ(2u, proto_histogram.min);
+  EXPECT_EQ(9u, proto_histogram.max);
+  EXPECT_EQ(Distribution::kSubBucketBits, proto_histogram.sub_bucket_bits);
+  ASSERT_EQ(16, proto_histogram.bucket_counts_count);
+  EXPECT_EQ(1u, proto_histogram.bucket_counts[2]);
+  EXPECT_EQ(2u, proto_histogram.bucket_counts[8]);
+}
+
+#if PW_METRIC_TRACK_GENERATIONS
+
+TEST(MetricService, Generation_OnlySendsUpdatedMetrics) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+  PW_METRIC(root, b, "b", 2u);
+  PW_METRIC(root, c, "c", 3u);
+  PW_METRIC_SUMMARY(root, summary, "summary");
+
+  // Generation 0 gets everything.
+  MetricMethodContext first(root.metrics(), root.children());
+  first.call({});
+  ASSERT_EQ(1u, first.responses().size());
+  EXPECT_EQ(3, first.responses()[0].metrics_count);
+  const uint32_t generation = first.responses()[0].generation;
+  EXPECT_NE(0u, generation);
+
+  // Nothing changed, so nothing is sent.
+  pw_metric_MetricRequest request = pw_metric_MetricRequest_init_zero;
+  request.generation = generation;
+  MetricMethodContext unchanged(root.metrics(), root.children());
+  unchanged.call(request);
+  EXPECT_TRUE(unchanged.done());
+  EXPECT_EQ(0u, unchanged.responses().size());
+
+  b.Increment();
+  c.Set(3u);  // Unchanged
+
+  MetricMethodContext changed(root.metrics(), root.children());
+  changed.call(request);
+  ASSERT_EQ(1u, changed.responses().size());
+  ASSERT_EQ(1, changed.responses()[0].metrics_count);
+  EXPECT_EQ(3u, changed.responses()[0].metrics[0].value.as_int);
+  EXPECT_GT(changed.responses()[0].generation, generation);
+}
+
+TEST(MetricService, Generation_OnlySendsUpdatedDistributions) {
+  PW_METRIC_GROUP(parent, "parent");
+  PW_METRIC_GROUP(parent, root, "/");
+  PW_METRIC_SUMMARY(root, summary, "summary");
+  PW_METRIC_HISTOGRAM(root, histogram, "histogram", 4);
+
+  pw_metric_MetricRequest request = pw_metric_MetricRequest_init_zero;
+  request.generation = StartGeneration();
+  histogram.Record(1);
+
+  MetricMethodContext context(parent.metrics(), parent.children());
+  context.call(request);
+  ASSERT_EQ(1u, context.responses().size());
+  ASSERT_EQ(1, context.responses()[0].distributions_count);
+  EXPECT_EQ(histogram_token,
+            context.responses()[0].distributions[0].token_path[1]);
+}
+
+#else
+
+TEST(MetricService, Generation_IgnoredWithoutGenerations) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+
+  pw_metric_MetricRequest request = pw_metric_MetricRequest_init_zero;
+  request.generation = 100;
+  MetricMethodContext context(root.metrics(), root.children());
+  context.call(request);
+  ASSERT_EQ(1u, context.responses().size());
+  EXPECT_EQ(1, context.responses()[0].metrics_count);
+  EXPECT_EQ(0u, context.responses()[0].generation);
+}
+
+#endif  // PW_METRIC_TRACK_GENERATIONS
+
 bool TokenPathsMatch(uint32_t expected_token_path[5],
                      const pw_metric_Metric& metric) {
   // Calculate length of expected token & compare.
@@ -0,0 +1,212 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_metric/metric_snapshot_service.h"
+
+#include <span>
+
+#include "pw_assert/check.h"
+#include "pw_containers/vector.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/serialized_size.h"
+#include "pw_protobuf/streaming_encoder.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::metric {
+namespace {
+
+// Field numbers from pw_metric_proto/metric_service.proto. The generated pwpb
+// header cannot be included here, since its message namespaces have the same
+// names as the pw::metric classes.
+namespace MetricField {
+inline constexpr uint32_t kTokenPath = 1;
+inline constexpr uint32_t kAsFloat = 3;
+inline constexpr uint32_t kAsInt = 4;
+}  // namespace MetricField
+
+namespace DistributionField {
+inline constexpr uint32_t kTokenPath = 1;
+inline constexpr uint32_t kCount = 2;
+inline constexpr uint32_t kSum = 3;
+inline constexpr uint32_t kMin = 4;
+inline constexpr uint32_t kMax = 5;
+inline constexpr uint32_t kSubBucketBits = 6;
+inline constexpr uint32_t kBucketCounts = 7;
+}  // namespace DistributionField
+
+inline constexpr uint32_t kRequestGenerationField = 2;
+
+namespace ResponseField {
+inline constexpr uint32_t kMetrics = 1;
+inline constexpr uint32_t kDistributions = 2;
+inline constexpr uint32_t kGeneration = 3;
+}  // namespace ResponseField
+
+size_t SizeOfTokenPath(std::span<const Token> path) {
+  return protobuf::SizeOfDelimitedField(MetricField::kTokenPath,
+                                        path.size_bytes());
+}
+
+// Encodes each metric and distribution updated since a generation as a
+// submessage of a MetricResponse. Submessages are sized before they are
+// written, so they are encoded in place without a scratch buffer.
+class SnapshotEncoder {
+ public:
+  SnapshotEncoder(protobuf::StreamingEncoder& encoder,
+                  uint32_t since_generation)
+      : encoder_(encoder), since_generation_(since_generation) {}
+
+  void Encode(const IntrusiveList<Metric>& metrics) {
+    for (const Metric& metric : metrics) {
+      if (metric.UpdatedSince(since_generation_)) {
+        ScopedName name(metric.name(), path_);
+        Encode(metric);
+      }
+    }
+  }
+
+  void Encode(const IntrusiveList<Distribution>& distributions) {
+    for (const Distribution& distribution : distributions) {
+      if (distribution.UpdatedSince(since_generation_)) {
+        ScopedName name(distribution.name(), path_);
+        Encode(distribution);
+      }
+    }
+  }
+
+  void Encode(const IntrusiveList<Group>& groups) {
+    for (const Group& group : groups) {
+      ScopedName name(group.name(), path_);
+      Encode(group.children());
+      Encode(group.metrics());
+      Encode(group.distributions());
+    }
+  }
+
+ private:
+  using Path = Vector<Token, MetricSnapshotService::kMaxDepth>;
+
+  // Pushes a name onto the path for the lifetime of the object.
+  class ScopedName {
+   public:
+    ScopedName(Token name, Path& path) : path_(path) {
+      PW_CHECK_INT_LT(path_.size(),
+                      path_.capacity(),
+                      "Metrics are too deep; increase kMaxDepth");
+      path_.push_back(name);
+    }
+    ~ScopedName() { path_.pop_back(); }
+
+   private:
+    Path& path_;
+  };
+
+  void Encode(const Metric& metric) {
+    size_t size = SizeOfTokenPath(path_);
+    if (metric.is_float()) {
+      size += protobuf::SizeOfFixed32Field(MetricField::kAsFloat);
+    } else {
+      size += protobuf::SizeOfVarintField(MetricField::kAsInt, metric.as_int());
+    }
+
+    // Errors are reported by the parent encoder, so they are ignored here.
+    protobuf::StreamingEncoder proto =
+        encoder_.GetNestedEncoder(ResponseField::kMetrics, size);
+    proto.WritePackedFixed32(MetricField::kTokenPath, path_).IgnoreError();
+    if (metric.is_float()) {
+      proto.WriteFloat(MetricField::kAsFloat, metric.as_float()).IgnoreError();
+    } else {
+      proto.WriteUint32(MetricField::kAsInt, metric.as_int()).IgnoreError();
+    }
+  }
+
+  void Encode(const Distribution& distribution) {
+    namespace Field = DistributionField;
+    const std::span<const uint32_t> buckets = distribution.bucket_counts();
+
+    size_t size = SizeOfTokenPath(path_) +
+                  protobuf::SizeOfVarintField(Field::kCount,
+                                              distribution.count()) +
+                  protobuf::SizeOfVarintField(Field::kSum, distribution.sum()) +
+                  protobuf::SizeOfVarintField(Field::kMin, distribution.min()) +
+                  protobuf::SizeOfVarintField(Field::kMax, distribution.max());
+    if (!buckets.empty()) {
+      size_t buckets_size = 0;
+      for (uint32_t bucket : buckets) {
+        buckets_size += varint::EncodedSize(bucket);
+      }
+      size += protobuf::SizeOfVarintField(Field::kSubBucketBits,
+                                          Distribution::kSubBucketBits) +
+              protobuf::SizeOfDelimitedField(Field::kBucketCounts,
+                                             buckets_size);
+    }
+
+    // Errors are reported by the parent encoder, so they are ignored here.
+    protobuf::StreamingEncoder proto =
+        encoder_.GetNestedEncoder(ResponseField::kDistributions, size);
+    proto.WritePackedFixed32(Field::kTokenPath, path_).IgnoreError();
+    proto.WriteUint32(Field::kCount, distribution.count()).IgnoreError();
+    proto.WriteUint64(Field::kSum, distribution.sum()).IgnoreError();
+    proto.WriteUint32(Field::kMin, distribution.min()).IgnoreError();
+    proto.WriteUint32(Field::kMax, distribution.max()).IgnoreError();
+    if (!buckets.empty()) {
+      proto.WriteUint32(Field::kSubBucketBits, Distribution::kSubBucketBits)
+          .IgnoreError();
+      proto.WritePackedUint32(Field::kBucketCounts, buckets).IgnoreError();
+    }
+  }
+
+  protobuf::StreamingEncoder& encoder_;
+  const uint32_t since_generation_;
+  Path path_;
+};
+
+}  // namespace
+
+StatusWithSize MetricSnapshotService::Snapshot(ServerContext&,
+                                               ConstByteSpan request,
+                                               ByteSpan response) {
+  uint32_t since_generation = 0;
+  protobuf::Decoder decoder(request);
+  while (decoder.Next().ok()) {
+    if (decoder.FieldNumber() == kRequestGenerationField) {
+      decoder.ReadUint32(&since_generation).IgnoreError();
+    }
+  }
+
+  if (update_ != nullptr) {
+    update_();
+  }
+
+  // As in MetricService, start a new generation before reading any metrics,
+  // so that updates made while encoding are sent again by the next request.
+  const uint32_t generation = StartGeneration();
+
+  stream::MemoryWriter writer(response);
+  protobuf::StreamingEncoder encoder(writer, ByteSpan());
+  if (generation != 0u) {
+    encoder.WriteUint32(ResponseField::kGeneration, generation).IgnoreError();
+  }
+
+  SnapshotEncoder snapshot(encoder, since_generation);
+  snapshot.Encode(metrics_);
+  snapshot.Encode(groups_);
+
+  if (!encoder.status().ok()) {
+    return StatusWithSize::ResourceExhausted();
+  }
+  return StatusWithSize(writer.bytes_written());
+}
+
+}  // namespace pw::metric
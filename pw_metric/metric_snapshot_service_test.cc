@@ -0,0 +1,391 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_metric/metric_snapshot_service.h"
+
+#include "gtest/gtest.h"
+#include "pw_bytes/endian.h"
+#include "pw_containers/vector.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/streaming_encoder.h"
+#include "pw_rpc/raw_test_method_context.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_varint/varint.h"
+
+namespace pw::metric {
+namespace {
+
+#define SnapshotContext(output_size) \
+  PW_RAW_TEST_METHOD_CONTEXT(MetricSnapshotService, Snapshot, 1, output_size)
+
+constexpr size_t kResponseSize = 512;
+
+// A decoded pw.metric.Metric or pw.metric.Distribution.
+struct DecodedMetric {
+  Vector<Token, MetricSnapshotService::kMaxDepth> path;
+  bool is_float = false;
+  uint32_t as_int = 0;
+  float as_float = 0;
+
+  // Distribution fields.
+  uint32_t count = 0;
+  uint64_t sum = 0;
+  uint32_t min = 0;
+  uint32_t max = 0;
+  uint32_t sub_bucket_bits = 0;
+  Vector<uint32_t, 64> bucket_counts;
+};
+
+struct DecodedResponse {
+  Vector<DecodedMetric, 24> metrics;
+  Vector<DecodedMetric, 4> distributions;
+  uint32_t generation = 0;
+};
+
+void DecodeTokenPath(ConstByteSpan packed, DecodedMetric& metric) {
+  for (size_t i = 0; i + sizeof(Token) <= packed.size(); i += sizeof(Token)) {
+    metric.path.push_back(bytes::ReadInOrder<Token>(std::endian::little,
+                                                    packed.data() + i));
+  }
+}
+
+DecodedMetric DecodeMetric(ConstByteSpan data) {
+  DecodedMetric metric;
+  protobuf::Decoder decoder(data);
+  while (decoder.Next().ok()) {
+    switch (decoder.FieldNumber()) {
+      case 1: {
+        ConstByteSpan packed;
+        EXPECT_EQ(OkStatus(), decoder.ReadBytes(&packed));
+        DecodeTokenPath(packed, metric);
+        break;
+      }
+      case 3:
+        metric.is_float = true;
+        EXPECT_EQ(OkStatus(), decoder.ReadFloat(&metric.as_float));
+        break;
+      case 4:
+        EXPECT_EQ(OkStatus(), decoder.ReadUint32(&metric.as_int));
+        break;
+      default:
+        ADD_FAILURE();
+    }
+  }
+  return metric;
+}
+
+DecodedMetric DecodeDistribution(ConstByteSpan data) {
+  DecodedMetric distribution;
+  protobuf::Decoder decoder(data);
+  while (decoder.Next().ok()) {
+    switch (decoder.FieldNumber()) {
+      case 1: {
+        ConstByteSpan packed;
+        EXPECT_EQ(OkStatus(), decoder.ReadBytes(&packed));
+        DecodeTokenPath(packed, distribution);
+        break;
+      }
+      case 2:
+        EXPECT_EQ(OkStatus(), decoder.ReadUint32(&distribution.count));
+        break;
+      case 3:
+        EXPECT_EQ(OkStatus(), decoder.ReadUint64(&distribution.sum));
+        break;
+      case 4:
+        EXPECT_EQ(OkStatus(), decoder.ReadUint32(&distribution.min));
+        break;
+      case 5:
+        EXPECT_EQ(OkStatus(), decoder.ReadUint32(&distribution.max));
+        break;
+      case 6:
+        EXPECT_EQ(OkStatus(),
+                  decoder.ReadUint32(&distribution.sub_bucket_bits));
+        break;
+      case 7: {
+        ConstByteSpan packed;
+        EXPECT_EQ(OkStatus(), decoder.ReadBytes(&packed));
+        while (!packed.empty()) {
+          uint64_t value = 0;
+          const size_t bytes = varint::Decode(packed, &value);
+          EXPECT_NE(0u, bytes);
+          if (bytes == 0u) {
+            break;
+          }
+          distribution.bucket_counts.push_back(static_cast<uint32_t>(value));
+          packed = packed.subspan(bytes);
+        }
+        break;
+      }
+      default:
+        ADD_FAILURE();
+    }
+  }
+  return distribution;
+}
+
+DecodedResponse DecodeResponse(ConstByteSpan data) {
+  DecodedResponse response;
+  protobuf::Decoder decoder(data);
+  while (decoder.Next().ok()) {
+    ConstByteSpan nested;
+    switch (decoder.FieldNumber()) {
+      case 1:
+        EXPECT_EQ(OkStatus(), decoder.ReadBytes(&nested));
+        response.metrics.push_back(DecodeMetric(nested));
+        break;
+      case 2:
+        EXPECT_EQ(OkStatus(), decoder.ReadBytes(&nested));
+        response.distributions.push_back(DecodeDistribution(nested));
+        break;
+      case 3:
+        EXPECT_EQ(OkStatus(), decoder.ReadUint32(&response.generation));
+        break;
+      default:
+        ADD_FAILURE();
+    }
+  }
+  return response;
+}
+
+// Finds the metric or distribution with this name.
+template <typename Container>
+const DecodedMetric* Find(const Container& metrics, Token name) {
+  for (const DecodedMetric& metric : metrics) {
+    if (!metric.path.empty() && metric.path.back() == name) {
+      return &metric;
+    }
+  }
+  return nullptr;
+}
+
+// Encodes a pw.metric.MetricRequest for the given generation.
+ConstByteSpan EncodeRequest(uint32_t generation, ByteSpan buffer) {
+  stream::MemoryWriter writer(buffer);
+  protobuf::StreamingEncoder encoder(writer, ByteSpan());
+  EXPECT_EQ(OkStatus(), encoder.WriteUint32(2, generation));
+  return writer.WrittenData();
+}
+
+TEST(MetricSnapshotService, EmptyGroup_NoMetrics) {
+  PW_METRIC_GROUP(root, "/");
+
+  SnapshotContext(kResponseSize) context(root.metrics(), root.children());
+  ASSERT_EQ(OkStatus(), context.call({}).status());
+
+  const DecodedResponse response = DecodeResponse(context.response());
+  EXPECT_TRUE(response.metrics.empty());
+  EXPECT_TRUE(response.distributions.empty());
+}
+
+TEST(MetricSnapshotService, AllMetricsInOneResponse) {
+  // More metrics than MetricService sends in one response.
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+  PW_METRIC(root, b, "b", 2.5f);
+
+  PW_METRIC_GROUP(root, inner, "inner");
+  PW_METRIC(inner, c, "c", 3u);
+  PW_METRIC(inner, d, "d", 4u);
+  PW_METRIC(inner, e, "e", 5u);
+  PW_METRIC(inner, f, "f", 6u);
+  PW_METRIC(inner, g, "g", 7u);
+  PW_METRIC(inner, h, "h", 8u);
+  PW_METRIC(inner, i, "i", 9u);
+  PW_METRIC(inner, j, "j", 10u);
+  PW_METRIC(inner, k, "k", 11u);
+  PW_METRIC(inner, l, "l", 12u);
+
+  SnapshotContext(kResponseSize) context(root.metrics(), root.children());
+  ASSERT_EQ(OkStatus(), context.call({}).status());
+
+  const DecodedResponse response = DecodeResponse(context.response());
+  ASSERT_EQ(12u, response.metrics.size());
+
+  // Metrics in the top-level list have no group in their path.
+  const DecodedMetric* metric_a = Find(response.metrics, a_token);
+  ASSERT_NE(nullptr, metric_a);
+  ASSERT_EQ(1u, metric_a->path.size());
+  EXPECT_FALSE(metric_a->is_float);
+  EXPECT_EQ(1u, metric_a->as_int);
+
+  const DecodedMetric* metric_b = Find(response.metrics, b_token);
+  ASSERT_NE(nullptr, metric_b);
+  EXPECT_TRUE(metric_b->is_float);
+  EXPECT_EQ(2.5f, metric_b->as_float);
+
+  const DecodedMetric* metric_l = Find(response.metrics, l_token);
+  ASSERT_NE(nullptr, metric_l);
+  ASSERT_EQ(2u, metric_l->path.size());
+  EXPECT_EQ(inner_token, metric_l->path[0]);
+  EXPECT_EQ(12u, metric_l->as_int);
+
+  uint32_t total = 0;
+  for (const DecodedMetric& metric : response.metrics) {
+    total += metric.as_int;
+  }
+  EXPECT_EQ(1u + 3u + 4u + 5u + 6u + 7u + 8u + 9u + 10u + 11u + 12u, total);
+}
+
+TEST(MetricSnapshotService, ZeroValuesAreSent) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, zero, "zero", 0u);
+
+  SnapshotContext(kResponseSize) context(root.metrics(), root.children());
+  ASSERT_EQ(OkStatus(), context.call({}).status());
+
+  const DecodedResponse response = DecodeResponse(context.response());
+  ASSERT_EQ(1u, response.metrics.size());
+  EXPECT_EQ(0u, response.metrics[0].as_int);
+}
+
+TEST(MetricSnapshotService, DeepGroups) {
+  PW_METRIC_GROUP(level_1, "level_1");
+  PW_METRIC_GROUP(level_1, level_2, "level_2");
+  PW_METRIC_GROUP(level_2, level_3, "level_3");
+  PW_METRIC_GROUP(level_3, level_4, "level_4");
+  PW_METRIC_GROUP(level_4, level_5, "level_5");
+  PW_METRIC(level_5, deep, "deep", 42u);
+
+  IntrusiveList<Metric> metrics;
+  IntrusiveList<Group> groups;
+  groups.push_front(level_1);
+
+  SnapshotContext(kResponseSize) context(metrics, groups);
+  ASSERT_EQ(OkStatus(), context.call({}).status());
+
+  const DecodedResponse response = DecodeResponse(context.response());
+  ASSERT_EQ(1u, response.metrics.size());
+  const DecodedMetric& metric = response.metrics[0];
+  ASSERT_EQ(6u, metric.path.size());
+  EXPECT_EQ(level_1_token, metric.path[0]);
+  EXPECT_EQ(level_5_token, metric.path[4]);
+  EXPECT_EQ(deep_token, metric.path[5]);
+  EXPECT_EQ(42u, metric.as_int);
+}
+
+TEST(MetricSnapshotService, Distributions) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC_SUMMARY(root, summary, "summary");
+  PW_METRIC_HISTOGRAM(root, histogram, "histogram", 16);
+
+  summary.Record(1000);
+  histogram.Record(2);
+  histogram.Record(9);
+  histogram.Record(9);
+
+  IntrusiveList<Metric> metrics;
+  IntrusiveList<Group> groups;
+  groups.push_front(root);
+
+  SnapshotContext(kResponseSize) context(metrics, groups);
+  ASSERT_EQ(OkStatus(), context.call({}).status());
+
+  const DecodedResponse response = DecodeResponse(context.response());
+  EXPECT_TRUE(response.metrics.empty());
+  ASSERT_EQ(2u, response.distributions.size());
+
+  const DecodedMetric* found = Find(response.distributions, summary_token);
+  ASSERT_NE(nullptr, found);
+  const DecodedMetric& proto_summary = *found;
+  ASSERT_EQ(2u, proto_summary.path.size());
+  EXPECT_EQ(root_token, proto_summary.path[0]);
+  EXPECT_EQ(1u, proto_summary.count);
+  EXPECT_EQ(1000u, proto_summary.sum);
+  EXPECT_EQ(1000u, proto_summary.min);
+  EXPECT_EQ(1000u, proto_summary.max);
+  EXPECT_EQ(0u, proto_summary.sub_bucket_bits);
+  EXPECT_TRUE(proto_summary.bucket_counts.empty());
+
+  found = Find(response.distributions, histogram_token);
+  ASSERT_NE(nullptr, found);
+  const DecodedMetric& proto_histogram = *found;
+  EXPECT_EQ(3u, proto_histogram.count);
+  EXPECT_EQ(20u, proto_histogram.sum);
+  EXPECT_EQ(2u, proto_histogram.min);
+  EXPECT_EQ(9u, proto_histogram.max);
+  EXPECT_EQ(Distribution::kSubBucketBits, proto_histogram.sub_bucket_bits);
+  ASSERT_EQ(16u, proto_histogram.bucket_counts.size());
+  EXPECT_EQ(1u, proto_histogram.bucket_counts[2]);
+  EXPECT_EQ(2u, proto_histogram.bucket_counts[8]);
+}
+
+TEST(MetricSnapshotService, UpdateCalledBeforeSnapshot) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, sampled, "sampled", 0u);
+
+  SnapshotContext(kResponseSize) context(
+      root.metrics(), root.children(), [&sampled] { sampled.Set(123u); });
+  ASSERT_EQ(OkStatus(), context.call({}).status());
+
+  const DecodedResponse response = DecodeResponse(context.response());
+  ASSERT_EQ(1u, response.metrics.size());
+  EXPECT_EQ(123u, response.metrics[0].as_int);
+}
+
+TEST(MetricSnapshotService, TooLargeForResponse_ResourceExhausted) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+  PW_METRIC(root, b, "b", 2u);
+  PW_METRIC(root, c, "c", 3u);
+  PW_METRIC(root, d, "d", 4u);
+
+  // Each metric with a one-token path takes 10 bytes.
+  SnapshotContext(32) context(root.metrics(), root.children());
+  EXPECT_EQ(Status::ResourceExhausted(), context.call({}).status());
+}
+
+#if PW_METRIC_TRACK_GENERATIONS
+
+TEST(MetricSnapshotService, Generation_OnlySendsUpdatedMetrics) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+  PW_METRIC(root, b, "b", 2u);
+
+  SnapshotContext(kResponseSize) first(root.metrics(), root.children());
+  ASSERT_EQ(OkStatus(), first.call({}).status());
+  const DecodedResponse all = DecodeResponse(first.response());
+  EXPECT_EQ(2u, all.metrics.size());
+  ASSERT_NE(0u, all.generation);
+
+  b.Increment();
+
+  std::byte request[8];
+  SnapshotContext(kResponseSize) changed(root.metrics(), root.children());
+  ASSERT_EQ(OkStatus(),
+            changed.call(EncodeRequest(all.generation, request)).status());
+  const DecodedResponse updates = DecodeResponse(changed.response());
+  ASSERT_EQ(1u, updates.metrics.size());
+  EXPECT_EQ(3u, updates.metrics[0].as_int);
+  EXPECT_GT(updates.generation, all.generation);
+}
+
+#else
+
+TEST(MetricSnapshotService, Generation_IgnoredWithoutGenerations) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+
+  std::byte request[8];
+  SnapshotContext(kResponseSize) context(root.metrics(), root.children());
+  ASSERT_EQ(OkStatus(), context.call(EncodeRequest(100, request)).status());
+
+  const DecodedResponse response = DecodeResponse(context.response());
+  EXPECT_EQ(1u, response.metrics.size());
+  EXPECT_EQ(0u, response.generation);
+}
+
+#endif  // PW_METRIC_TRACK_GENERATIONS
+
+}  // namespace
+}  // namespace pw::metric
@@ -237,4 +237,220 @@ TEST(Metric, StaticWithinAFunction) {
   EXPECT_EQ(metric->as_int(), 2u);
 }
 
+#if PW_METRIC_TRACK_GENERATIONS
+
+TEST(Metric, UpdatedSince_TracksGenerations) {
+  PW_METRIC(counter, "counter", 0u);
+  PW_METRIC(temperature, "temperature", 20.0f);
+  PW_METRIC_SUMMARY(summary, "summary");
+  EXPECT_TRUE(counter.UpdatedSince(0));
+
+  const uint32_t generation = StartGeneration();
+  EXPECT_FALSE(counter.UpdatedSince(generation));
+  EXPECT_FALSE(temperature.UpdatedSince(generation));
+  EXPECT_FALSE(summary.UpdatedSince(generation));
+
+  counter.Increment();
+  temperature.Set(20.0f);  // Unchanged
+  summary.Record(1);
+  EXPECT_TRUE(counter.UpdatedSince(generation));
+  EXPECT_FALSE(temperature.UpdatedSince(generation));
+  EXPECT_TRUE(summary.UpdatedSince(generation));
+
+  const uint32_t next_generation = StartGeneration();
+  EXPECT_GT(next_generation, generation);
+  EXPECT_FALSE(counter.UpdatedSince(next_generation));
+  EXPECT_TRUE(counter.UpdatedSince(generation));
+
+  temperature.Set(21.0f);
+  EXPECT_TRUE(temperature.UpdatedSince(next_generation));
+}
+
+TEST(ShardedCounter, PublishUnchangedSumIsNotAnUpdate) {
+  PW_METRIC_SHARDED_COUNTER(counter, "counter", 2);
+  counter.Increment(1);
+  counter.Publish();
+
+  const uint32_t generation = StartGeneration();
+  counter.Publish();
+  EXPECT_FALSE(counter.UpdatedSince(generation));
+
+  counter.Increment(0);
+  counter.Publish();
+  EXPECT_TRUE(counter.UpdatedSince(generation));
+}
+
+#else
+
+TEST(Metric, UpdatedSince_AlwaysTrueWithoutGenerations) {
+  PW_METRIC(counter, "counter", 0u);
+  PW_METRIC_SUMMARY(summary, "summary");
+  EXPECT_EQ(StartGeneration(), 0u);
+  EXPECT_TRUE(counter.UpdatedSince(0));
+  EXPECT_TRUE(counter.UpdatedSince(100));
+  EXPECT_TRUE(summary.UpdatedSince(100));
+}
+
+#endif  // PW_METRIC_TRACK_GENERATIONS
+
+TEST(ShardedCounter, SumsShards) {
+  PW_METRIC_SHARDED_COUNTER(counter, "counter", 3);
+  EXPECT_EQ(counter.value(), 0u);
+
+  counter.Increment(0);
+  counter.Increment(1, 10);
+  counter.Increment(2, 100);
+  counter.Increment(2, 100);
+  EXPECT_EQ(counter.value(), 211u);
+}
+
+TEST(ShardedCounter, SumWrapsAround) {
+  PW_METRIC_SHARDED_COUNTER(counter, "counter", 2);
+  counter.Increment(0, 0xffffffff);
+  counter.Increment(1, 2);
+  EXPECT_EQ(counter.value(), 1u);
+}
+
+TEST(ShardedCounter, PublishSetsReportedValue) {
+  PW_METRIC_GROUP(group, "group");
+  PW_METRIC_SHARDED_COUNTER(group, counter, "counter", 2);
+  ASSERT_EQ(group.metrics().size(), 1u);
+  const Metric& metric = group.metrics().front();
+  EXPECT_TRUE(metric.is_int());
+
+  counter.Increment(0, 3);
+  counter.Increment(1, 4);
+  EXPECT_EQ(metric.as_int(), 0u);
+
+  EXPECT_EQ(counter.Publish(), 7u);
+  EXPECT_EQ(metric.as_int(), 7u);
+}
+
+TEST(ShardedCounter, ShardsAreAligned) {
+  PW_METRIC_SHARDED_COUNTER(counter, "counter", 4);
+  EXPECT_GE(sizeof(counter), 4u * PW_METRIC_SHARD_ALIGNMENT);
+}
+
+TEST(Distribution, BucketIndex_LinearBelowSubBuckets) {
+  EXPECT_EQ(Distribution::BucketIndex(0), 0u);
+  EXPECT_EQ(Distribution::BucketIndex(3), 3u);
+  EXPECT_EQ(Distribution::BucketIndex(4), 4u);
+  EXPECT_EQ(Distribution::BucketIndex(7), 7u);
+}
+
+TEST(Distribution, BucketIndex_LogLinear) {
+  EXPECT_EQ(Distribution::BucketIndex(8), 8u);
+  EXPECT_EQ(Distribution::BucketIndex(9), 8u);
+  EXPECT_EQ(Distribution::BucketIndex(10), 9u);
+  EXPECT_EQ(Distribution::BucketIndex(15), 11u);
+  EXPECT_EQ(Distribution::BucketIndex(16), 12u);
+  EXPECT_EQ(Distribution::BucketIndex(511), 31u);
+  EXPECT_EQ(Distribution::BucketIndex(512), 32u);
+  EXPECT_EQ(Distribution::BucketIndex(0xffffffff), 123u);
+}
+
+TEST(Distribution, BucketLowerBound_InvertsBucketIndex) {
+  for (size_t i = 0; i < 124; ++i) {
+    const uint32_t lower_bound = Distribution::BucketLowerBound(i);
+    EXPECT_EQ(Distribution::BucketIndex(lower_bound), i);
+    if (i > 0) {
+      EXPECT_EQ(Distribution::BucketIndex(lower_bound - 1), i - 1);
+    }
+  }
+}
+
+TEST(Distribution, Summary_TracksCountSumMinMax) {
+  PW_METRIC_SUMMARY(summary, "summary");
+  EXPECT_EQ(summary.count(), 0u);
+  EXPECT_EQ(summary.min(), 0u);
+  EXPECT_EQ(summary.Percentile(50), 0u);
+  EXPECT_FALSE(summary.is_histogram());
+
+  summary.Record(20);
+  summary.Record(5);
+  summary.Record(0xffffffff);
+
+  EXPECT_EQ(summary.count(), 3u);
+  EXPECT_EQ(summary.sum(), uint64_t{25} + 0xffffffffu);
+  EXPECT_EQ(summary.min(), 5u);
+  EXPECT_EQ(summary.max(), 0xffffffffu);
+  EXPECT_EQ(summary.Percentile(50), 0xffffffffu);
+  EXPECT_TRUE(summary.bucket_counts().empty());
+
+  summary.Reset();
+  EXPECT_EQ(summary.count(), 0u);
+  EXPECT_EQ(summary.sum(), 0u);
+  EXPECT_EQ(summary.max(), 0u);
+}
+
+TEST(Distribution, Histogram_CountsBuckets) {
+  PW_METRIC_HISTOGRAM(histogram, "histogram", 16);
+  ASSERT_EQ(histogram.bucket_counts().size(), 16u);
+  EXPECT_TRUE(histogram.is_histogram());
+
+  histogram.Record(1);
+  histogram.Record(9);
+  histogram.Record(9);
+  histogram.Record(1000);  // Larger than the last bucket
+
+  EXPECT_EQ(histogram.count(), 4u);
+  EXPECT_EQ(histogram.bucket_counts()[1], 1u);
+  EXPECT_EQ(histogram.bucket_counts()[8], 2u);
+  EXPECT_EQ(histogram.bucket_counts()[15], 1u);
+
+  histogram.Reset();
+  for (uint32_t count : histogram.bucket_counts()) {
+    EXPECT_EQ(count, 0u);
+  }
+}
+
+TEST(Distribution, Histogram_Percentile) {
+  PW_METRIC_HISTOGRAM(histogram, "histogram", 32);
+  for (uint32_t i = 1; i <= 100; ++i) {
+    histogram.Record(i);
+  }
+
+  // The percentiles are the upper bounds of the buckets holding them.
+  EXPECT_EQ(histogram.Percentile(0), 1u);
+  EXPECT_EQ(histogram.Percentile(50), 55u);  // Bucket 48-55
+  EXPECT_EQ(histogram.Percentile(90), 95u);  // Bucket 80-95
+  EXPECT_EQ(histogram.Percentile(99), 100u);  // Bucket 96-111, clamped
+  EXPECT_EQ(histogram.Percentile(100), 100u);
+}
+
+TEST(Distribution, Histogram_PercentileInLastBucketIsMax) {
+  PW_METRIC_HISTOGRAM(histogram, "histogram", 8);
+  histogram.Record(2);
+  histogram.Record(5000);
+  EXPECT_EQ(histogram.Percentile(50), 2u);
+  EXPECT_EQ(histogram.Percentile(99), 5000u);
+}
+
+TEST(Distribution, GroupMembership) {
+  PW_METRIC_GROUP(group, "group");
+  PW_METRIC_SUMMARY(group, summary, "summary");
+  PW_METRIC_HISTOGRAM(group, histogram, "histogram", 4);
+  PW_METRIC(group, metric, "metric", 0u);
+
+  EXPECT_EQ(group.distributions().size(), 2u);
+  EXPECT_EQ(group.metrics().size(), 1u);
+
+  histogram.Record(2);
+  summary.Record(3);
+  group.Dump();
+}
+
+Distribution* StaticHistogramRecord() {
+  PW_METRIC_HISTOGRAM_STATIC(histogram, "histogram", 4);
+  histogram.Record(1);
+  return &histogram;
+}
+
+TEST(Distribution, StaticWithinAFunction) {
+  Distribution* histogram = StaticHistogramRecord();
+  EXPECT_EQ(histogram->count(), 1u);
+  StaticHistogramRecord();
+  EXPECT_EQ(histogram->count(), 2u);
+}
+
 }  // namespace pw::metric
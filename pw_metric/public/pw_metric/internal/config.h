@@ -0,0 +1,38 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+// Set to 1 to update metric values atomically, so that metrics may be updated
+// from multiple threads and interrupts without losing counts. Increment() is
+// then an atomic read-modify-write, which is LDREX/STREX on ARMv7-M and later.
+// ARMv6-M (Cortex-M0) has no such instructions, so its compiler calls an
+// __atomic_fetch_add_4 library function instead; prefer ShardedCounter there.
+#ifndef PW_METRIC_ATOMIC_UPDATES
+#define PW_METRIC_ATOMIC_UPDATES 0
+#endif  // PW_METRIC_ATOMIC_UPDATES
+
+// Set to 1 to record the generation in which each metric and distribution was
+// last updated, so that MetricService can send only the metrics updated since a
+// client's previous request. This adds 4 bytes to each metric and distribution,
+// and a load and store of the current generation to each update.
+#ifndef PW_METRIC_TRACK_GENERATIONS
+#define PW_METRIC_TRACK_GENERATIONS 0
+#endif  // PW_METRIC_TRACK_GENERATIONS
+
+// The alignment of each ShardedCounter shard, in bytes. Targets whose cores
+// have data caches should set this to the cache line size, so that cores
+// updating their own shards don't invalidate each other's cached shards.
+#ifndef PW_METRIC_SHARD_ALIGNMENT
+#define PW_METRIC_SHARD_ALIGNMENT 4
+#endif  // PW_METRIC_SHARD_ALIGNMENT
@@ -14,10 +14,18 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <initializer_list>
 #include <limits>
+#include <span>
 
+#include "pw_assert/assert.h"
 #include "pw_containers/intrusive_list.h"
+#include "pw_metric/internal/config.h"
 #include "pw_preprocessor/arguments.h"
 #include "pw_tokenizer/tokenize.h"
 
@@ -29,13 +37,22 @@ using tokenizer::Token;
 
 #define _PW_METRIC_TOKEN_MASK 0x7fffffff
 
+// Starts a new generation of metric updates and returns it. With
+// PW_METRIC_TRACK_GENERATIONS, metrics and distributions updated after this
+// call are UpdatedSince() the returned generation. Otherwise, returns 0.
+uint32_t StartGeneration();
+
 // An individual metric. There are only two supported types: uint32_t and
 // float. More complicated compound metrics can be built on these primitives.
 // See the documentation for a discussion for this design was selected.
 //
-// Size: 12 bytes / 96 bits - next, name, value.
+// Size: 12 bytes / 96 bits - next, name, value; plus 4 bytes for the generation
+// with PW_METRIC_TRACK_GENERATIONS.
+//
+// Updates are plain reads and writes unless PW_METRIC_ATOMIC_UPDATES is set, in
+// which case they are atomic and may race with each other, e.g. from threads
+// and interrupts. See also ShardedCounter.
 //
-// TODO(keir): Implement Set() and Increment() using atomics.
 // TODO(keir): Consider an alternative structure where metrics have pointers to
 // parent groups, which would enable (1) safe destruction and (2) safe static
 // initialization, but at the cost of an additional 4 bytes per metric and 4
@@ -50,6 +67,10 @@ class Metric : public IntrusiveList<Metric>::Item {
   float as_float() const;
   uint32_t as_int() const;
 
+  // True if the metric was updated in or after the given generation, or if
+  // generations are not tracked. Every metric is updated since generation 0.
+  bool UpdatedSince(uint32_t generation) const;
+
   // Dump a metric or metrics to logs. Level determines the indentation
   // indent_level up to a maximum of 4. Example output:
   //
@@ -66,10 +87,11 @@ class Metric : public IntrusiveList<Metric>::Item {
 
  protected:
   Metric(Token name, float value)
-      : name_and_type_((name & kTokenMask) | kTypeFloat), float_(value) {}
+      : name_and_type_((name & kTokenMask) | kTypeFloat),
+        value_(FloatBits(value)) {}
 
   Metric(Token name, uint32_t value)
-      : name_and_type_((name & kTokenMask) | kTypeInt), uint_(value) {}
+      : name_and_type_((name & kTokenMask) | kTypeInt), value_(value) {}
 
   Metric(Token name, float value, IntrusiveList<Metric>& metrics);
   Metric(Token name, uint32_t value, IntrusiveList<Metric>& metrics);
@@ -84,14 +106,33 @@ class Metric : public IntrusiveList<Metric>::Item {
   void SetFloat(float value);
 
  private:
+#if PW_METRIC_ATOMIC_UPDATES
+  using Value = std::atomic<uint32_t>;
+#else
+  using Value = uint32_t;
+#endif  // PW_METRIC_ATOMIC_UPDATES
+
+  // Record the current generation before and after updating the value.
+  void BeginUpdate();
+  void EndUpdate();
+
+  static uint32_t FloatBits(float value) {
+    static_assert(sizeof(float) == sizeof(uint32_t));
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
   // The name of this metric as a token; from PW_TOKENIZE_STRING("my_metric").
   // Last bit of the token is used to store int or float; 0 == int, 1 == float.
   Token name_and_type_;
 
-  union {
-    float float_;
-    uint32_t uint_;
-  };
+  // The uint32_t value, or the bits of the float value.
+  Value value_;
+
+#if PW_METRIC_TRACK_GENERATIONS
+  Value generation_{0};
+#endif  // PW_METRIC_TRACK_GENERATIONS
 
   enum : uint32_t {
     kTokenMask = _PW_METRIC_TOKEN_MASK,  // 0x7fff'ffff
@@ -143,9 +184,204 @@ class TypedMetric<uint32_t> : public Metric {
   uint32_t as_int() const { return 0; }
 };
 
-// A metric tree; consisting of children groups and leaf metrics.
+// A uint32_t counter split into kShards shards, such as one per core, or one
+// for threads and one for interrupts. Each shard must only be incremented by
+// one core or context at a time, so an increment is a plain load and store of
+// the shard; it needs no lock or atomic read-modify-write, yet loses no counts.
+// The shards are summed when read.
+//
+// The counter is also a Metric, so it may be added to groups. The value that
+// Dump() and MetricService report is the sum as of the last Publish().
+//
+// Size: 12 bytes plus PW_METRIC_SHARD_ALIGNMENT (4) bytes per shard.
+template <size_t kShards>
+class ShardedCounter : public Metric {
+ public:
+  static_assert(kShards > 0u, "Sharded counters must have at least one shard");
+
+  ShardedCounter(Token name) : Metric(name, 0u) {}
+  ShardedCounter(Token name, IntrusiveList<Metric>& metrics)
+      : Metric(name, 0u, metrics) {}
+
+  void Increment(size_t shard, uint32_t amount = 1u) {
+    PW_DASSERT(shard < kShards);
+    std::atomic<uint32_t>& count = shards_[shard].count;
+    count.store(count.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+  }
+
+  // Returns the sum of the shards, which wraps around like a uint32_t.
+  uint32_t value() const {
+    uint32_t sum = 0;
+    for (const Shard& shard : shards_) {
+      sum += shard.count.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  // Sets the reported value of the metric to the sum of the shards.
+  uint32_t Publish() {
+    const uint32_t sum = value();
+    SetInt(sum);
+    return sum;
+  }
+
+ private:
+  struct alignas(PW_METRIC_SHARD_ALIGNMENT) Shard {
+    std::atomic<uint32_t> count{0};
+  };
+
+  // Shadow these accessors to hide them on the sharded version of Metric.
+  float as_float() const { return 0.0; }
+  uint32_t as_int() const { return 0; }
+
+  std::array<Shard, kShards> shards_{};
+};
+
+// The most buckets a Histogram may have. This matches the max_count of
+// pw.metric.Distribution.bucket_counts in metric_service.options.
+inline constexpr size_t kMaxHistogramBuckets = 64;
+
+// A distribution of uint32_t samples, such as operation latencies. Tracks the
+// count, sum, min, and max of the samples; a Histogram also counts samples in
+// log-linear buckets, from which percentiles can be estimated. Recording a
+// sample is a few integer operations and never allocates.
+//
+// Use Summary or Histogram rather than this class directly.
+//
+// Size: 36 bytes / 288 bits - next, name, count, sum, min, max, buckets; plus
+// 4 bytes per histogram bucket, and 4 bytes for the generation with
+// PW_METRIC_TRACK_GENERATIONS.
+class Distribution : public IntrusiveList<Distribution>::Item {
+ public:
+  // Each power of two is split into 2^kSubBucketBits linear buckets, so a
+  // bucket is at most 1/4 of the values it holds wide. Values below
+  // 2^kSubBucketBits have a bucket each.
+  static constexpr uint32_t kSubBucketBits = 2;
+
+  Token name() const { return name_; }
+
+  void Record(uint32_t value);
+
+  // Clears all samples.
+  void Reset();
+
+  uint32_t count() const { return count_; }
+  uint64_t sum() const { return sum_; }
+  uint32_t min() const { return count_ == 0 ? 0 : min_; }
+  uint32_t max() const { return max_; }
+
+  bool is_histogram() const { return !buckets_.empty(); }
+
+  // True if a sample was recorded or the distribution was reset in or after the
+  // given generation, or if generations are not tracked.
+  bool UpdatedSince(uint32_t generation) const;
+
+  // The number of samples in each bucket; empty for a Summary. The last
+  // bucket also counts all samples larger than its upper bound.
+  std::span<const uint32_t> bucket_counts() const { return buckets_; }
+
+  // Estimates the value below which the given percent of samples fall, as the
+  // upper bound of the bucket that holds it, clamped to [min(), max()].
+  // Returns 0 if there are no samples, or max() for a Summary.
+  uint32_t Percentile(uint32_t percent) const;
+
+  // The bucket that holds a value, ignoring the number of buckets.
+  static constexpr size_t BucketIndex(uint32_t value) {
+    if (value < kSubBuckets) {
+      return value;
+    }
+    const uint32_t log2 = 31 - __builtin_clz(value);
+    const uint32_t shift = log2 - kSubBucketBits;
+    return (shift + 1) * kSubBuckets + ((value >> shift) & (kSubBuckets - 1));
+  }
+
+  // The smallest value in a bucket.
+  static constexpr uint32_t BucketLowerBound(size_t index) {
+    if (index < kSubBuckets) {
+      return static_cast<uint32_t>(index);
+    }
+    const uint32_t shift = static_cast<uint32_t>(index / kSubBuckets) - 1;
+    return static_cast<uint32_t>(kSubBuckets + index % kSubBuckets) << shift;
+  }
+
+  // Dump a distribution or distributions to logs. Level determines the
+  // indentation indent_level up to a maximum of 4. Example output:
+  //
+  //   "$Ij9oXA==": {"count": 12, "sum": 504, "min": 3, "max": 97, "p50": 31,
+  //                 "p90": 79, "p99": 97},
+  //
+  // Percentiles are only logged for histograms.
+  void Dump(int indent_level = 0);
+  static void Dump(IntrusiveList<Distribution>& distributions,
+                   int indent_level = 0);
+
+  // Disallow copy and assign.
+  Distribution(Distribution const&) = delete;
+  void operator=(const Distribution&) = delete;
+
+ protected:
+  // The buckets are only referred to, so they may be a member of a derived
+  // class that is not yet constructed. They must start out zeroed.
+  Distribution(Token name, std::span<uint32_t> buckets)
+      : name_(name), buckets_(buckets) {}
+
+  Distribution(Token name,
+               std::span<uint32_t> buckets,
+               IntrusiveList<Distribution>& distributions);
+
+ private:
+  static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;
+
+  // Returns one less than the lower bound of the next bucket.
+  static constexpr uint32_t BucketUpperBound(size_t index) {
+    return BucketIndex(std::numeric_limits<uint32_t>::max()) <= index
+               ? std::numeric_limits<uint32_t>::max()
+               : BucketLowerBound(index + 1) - 1;
+  }
+
+  Token name_;
+  uint32_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint32_t min_ = std::numeric_limits<uint32_t>::max();
+  uint32_t max_ = 0;
+  std::span<uint32_t> buckets_;
+
+#if PW_METRIC_TRACK_GENERATIONS
+  uint32_t generation_ = 0;
+#endif  // PW_METRIC_TRACK_GENERATIONS
+};
+
+// A distribution without buckets: the count, sum, min, and max of samples.
+class Summary : public Distribution {
+ public:
+  Summary(Token name) : Distribution(name, {}) {}
+  Summary(Token name, IntrusiveList<Distribution>& distributions)
+      : Distribution(name, {}, distributions) {}
+};
+
+// A distribution with kBuckets log-linear buckets. The buckets hold every value
+// up to BucketLowerBound(kBuckets) - 1; for example, 32 buckets cover 0-511 and
+// 64 buckets cover 0-131071. Choose the units of the recorded values (e.g.
+// microseconds or milliseconds) so that typical values fall in that range.
+template <size_t kBuckets>
+class Histogram : public Distribution {
+ public:
+  static_assert(kBuckets > 0u && kBuckets <= kMaxHistogramBuckets,
+                "Histograms must have 1 to kMaxHistogramBuckets buckets");
+
+  Histogram(Token name) : Distribution(name, buckets_) {}
+  Histogram(Token name, IntrusiveList<Distribution>& distributions)
+      : Distribution(name, buckets_, distributions) {}
+
+ private:
+  std::array<uint32_t, kBuckets> buckets_{};
+};
+
+// A metric tree; consisting of children groups, leaf metrics, and
+// distributions.
 //
-// Size: 16 bytes/128 bits - next, name, metrics, children.
+// Size: 20 bytes/160 bits - next, name, metrics, distributions, children.
 class Group : public IntrusiveList<Group>::Item {
  public:
   Group(Token name);
@@ -154,12 +390,19 @@ class Group : public IntrusiveList<Group>::Item {
   Token name() const { return name_; }
 
   void Add(Metric& metric) { metrics_.push_front(metric); }
+  void Add(Distribution& distribution) {
+    distributions_.push_front(distribution);
+  }
   void Add(Group& group) { children_.push_front(group); }
 
   IntrusiveList<Metric>& metrics() { return metrics_; }
+  IntrusiveList<Distribution>& distributions() { return distributions_; }
   IntrusiveList<Group>& children() { return children_; }
 
   const IntrusiveList<Metric>& metrics() const { return metrics_; }
+  const IntrusiveList<Distribution>& distributions() const {
+    return distributions_;
+  }
   const IntrusiveList<Group>& children() const { return children_; }
 
   // Dump a metric group or groups to logs. Level determines the indentation
@@ -190,6 +433,7 @@ class Group : public IntrusiveList<Group>::Item {
   Token name_;
 
   IntrusiveList<Metric> metrics_;
+  IntrusiveList<Distribution> distributions_;
   IntrusiveList<Group> children_;
 };
 
@@ -269,6 +513,84 @@ class Group : public IntrusiveList<Group>::Item {
   static_def ::pw::metric::TypedMetric<_PW_METRIC_FLOAT_OR_UINT32(init)>      \
       variable_name = {variable_name##_token, init, group.metrics()}
 
+// Declare a ShardedCounter, optionally adding it to a group. Works like
+// PW_METRIC, and works in the same contexts. Use:
+//
+//   PW_METRIC_SHARDED_COUNTER(variable_name, metric_name, shards)
+//   PW_METRIC_SHARDED_COUNTER(group, variable_name, metric_name, shards)
+//
+#define PW_METRIC_SHARDED_COUNTER(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_SHARDED_COUNTER_, , __VA_ARGS__)
+#define PW_METRIC_SHARDED_COUNTER_STATIC(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_SHARDED_COUNTER_, static, __VA_ARGS__)
+
+#define _PW_METRIC_SHARDED_COUNTER_4(                                         \
+    static_def, variable_name, metric_name, shards)                           \
+  static constexpr uint32_t variable_name##_token =                           \
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, metric_name); \
+  static_def ::pw::metric::ShardedCounter<shards> variable_name = {           \
+      variable_name##_token}
+
+#define _PW_METRIC_SHARDED_COUNTER_5(                                         \
+    static_def, group, variable_name, metric_name, shards)                    \
+  static constexpr uint32_t variable_name##_token =                           \
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, metric_name); \
+  static_def ::pw::metric::ShardedCounter<shards> variable_name = {           \
+      variable_name##_token, group.metrics()}
+
+// Declare a Summary or Histogram, optionally adding it to a group. Works like
+// PW_METRIC, and works in the same contexts. Use:
+//
+//   PW_METRIC_SUMMARY(variable_name, metric_name)
+//   PW_METRIC_SUMMARY(group, variable_name, metric_name)
+//   PW_METRIC_HISTOGRAM(variable_name, metric_name, buckets)
+//   PW_METRIC_HISTOGRAM(group, variable_name, metric_name, buckets)
+//
+// Example:
+//
+//   PW_METRIC_GROUP(metrics_, "flash");
+//   PW_METRIC_HISTOGRAM(metrics_, write_us_, "write_us", 48);
+//
+//   void Flash::Write(...) {
+//     const uint32_t start = NowUs();
+//     ...
+//     write_us_.Record(NowUs() - start);
+//   }
+//
+#define PW_METRIC_SUMMARY(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_SUMMARY_, , __VA_ARGS__)
+#define PW_METRIC_SUMMARY_STATIC(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_SUMMARY_, static, __VA_ARGS__)
+#define PW_METRIC_HISTOGRAM(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_HISTOGRAM_, , __VA_ARGS__)
+#define PW_METRIC_HISTOGRAM_STATIC(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_HISTOGRAM_, static, __VA_ARGS__)
+
+#define _PW_METRIC_SUMMARY_3(static_def, variable_name, metric_name)          \
+  static constexpr uint32_t variable_name##_token =                           \
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, metric_name); \
+  static_def ::pw::metric::Summary variable_name = {variable_name##_token}
+
+#define _PW_METRIC_SUMMARY_4(static_def, group, variable_name, metric_name)   \
+  static constexpr uint32_t variable_name##_token =                           \
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, metric_name); \
+  static_def ::pw::metric::Summary variable_name = {variable_name##_token,    \
+                                                    group.distributions()}
+
+#define _PW_METRIC_HISTOGRAM_4(                                               \
+    static_def, variable_name, metric_name, buckets)                          \
+  static constexpr uint32_t variable_name##_token =                           \
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, metric_name); \
+  static_def ::pw::metric::Histogram<buckets> variable_name = {               \
+      variable_name##_token}
+
+#define _PW_METRIC_HISTOGRAM_5(                                               \
+    static_def, group, variable_name, metric_name, buckets)                   \
+  static constexpr uint32_t variable_name##_token =                           \
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, metric_name); \
+  static_def ::pw::metric::Histogram<buckets> variable_name = {               \
+      variable_name##_token, group.distributions()}
+
 // Define a metric group. Works like PW_METRIC, and works in the same contexts.
 //
 // Example:
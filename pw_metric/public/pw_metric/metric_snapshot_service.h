@@ -0,0 +1,60 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_bytes/span.h"
+#include "pw_containers/intrusive_list.h"
+#include "pw_function/function.h"
+#include "pw_metric/metric.h"
+#include "pw_metric_proto/metric_service.raw_rpc.pb.h"
+#include "pw_status/status_with_size.h"
+
+namespace pw::metric {
+
+// Sends a device's metrics and distributions in a single
+// pw.metric.MetricResponse, so that monitoring reads a whole device with one
+// request and one response.
+//
+// Unlike MetricService, which batches metrics into fixed-size Nanopb
+// responses, the snapshot is encoded directly into the RPC's payload buffer,
+// and paths may be up to kMaxDepth tokens long. If the metrics do not fit in
+// one response, Snapshot() fails with RESOURCE_EXHAUSTED; request only the
+// metrics updated since a generation, or read them with MetricService.
+class MetricSnapshotService final
+    : public generated::MetricSnapshotService<MetricSnapshotService> {
+ public:
+  // The longest token path, including the metric's own name.
+  static constexpr size_t kMaxDepth = 8;
+
+  // The update function, if set, is called before each snapshot to refresh
+  // metrics that are sampled rather than counted, such as those of
+  // pw::allocator::FreeListHeapMetrics.
+  MetricSnapshotService(const IntrusiveList<Metric>& metrics,
+                        const IntrusiveList<Group>& groups,
+                        Function<void()> update = nullptr)
+      : metrics_(metrics), groups_(groups), update_(std::move(update)) {}
+
+  // Encodes the metrics and distributions updated since the requested
+  // generation as a pw.metric.MetricResponse.
+  StatusWithSize Snapshot(ServerContext&,
+                          ConstByteSpan request,
+                          ByteSpan response);
+
+ private:
+  const IntrusiveList<Metric>& metrics_;
+  const IntrusiveList<Group>& groups_;
+  Function<void()> update_;
+};
+
+}  // namespace pw::metric
@@ -0,0 +1,57 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "pw_metric/metric.h"
+#include "pw_preprocessor/compiler.h"
+#include "pw_status/status_with_size.h"
+#include "pw_tokenizer/tokenize.h"
+
+namespace pw::metric {
+
+// Returns the metrics defined with PW_METRIC_REGISTERED, in no particular
+// order. They are placed next to each other in the pw_metrics linker section,
+// so iterating over them reads one contiguous block of memory instead of
+// following list pointers around RAM.
+std::span<Metric> registered_metrics();
+
+// Copies the value of each registered metric to values, in the order of
+// registered_metrics(). Float values are copied as their bits. Returns
+// RESOURCE_EXHAUSTED with no values copied if values is too small.
+StatusWithSize SnapshotRegisteredMetrics(std::span<uint32_t> values);
+
+// Dump the registered metrics to logs, like Metric::Dump.
+void DumpRegisteredMetrics(int indent_level = 0);
+
+// Define a metric in the pw_metrics linker section, at global scope. Works like
+// PW_METRIC otherwise; registered metrics may also be added to groups.
+//
+// On Linux, the default linker script places the section automatically. Other
+// targets must include pw_metric_linker_sections.ld in their linker script.
+#define PW_METRIC_REGISTERED(variable_name, metric_name, init)                \
+  static constexpr uint32_t variable_name##_token =                           \
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, metric_name); \
+  PW_KEEP_IN_SECTION("pw_metrics")                                            \
+  ::pw::metric::TypedMetric<_PW_METRIC_FLOAT_OR_UINT32(init)> variable_name = \
+      {variable_name##_token, init}
+
+// The section is treated as an array of Metric, so the typed metrics must be
+// exactly the size of a Metric.
+static_assert(sizeof(TypedMetric<uint32_t>) == sizeof(Metric));
+static_assert(sizeof(TypedMetric<float>) == sizeof(Metric));
+
+}  // namespace pw::metric
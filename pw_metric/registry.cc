@@ -0,0 +1,70 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_metric/registry.h"
+
+#include <cstring>
+
+// The bounds of the pw_metrics section. ELF linkers define __start_ and __stop_
+// symbols for sections named like C identifiers; pw_metric_linker_sections.ld
+// defines them for linker scripts that place the section explicitly. Mach-O
+// linkers define section$start$ and section$end$ symbols instead. The symbols
+// are weak, so a program with no registered metrics still links.
+#if defined(__APPLE__)
+#define _PW_METRIC_SECTION_START "section$start$__DATA$pw_metrics"
+#define _PW_METRIC_SECTION_STOP "section$end$__DATA$pw_metrics"
+#else
+#define _PW_METRIC_SECTION_START "__start_pw_metrics"
+#define _PW_METRIC_SECTION_STOP "__stop_pw_metrics"
+#endif  // defined(__APPLE__)
+
+extern "C" {
+extern pw::metric::Metric pw_metrics_start[] __asm(_PW_METRIC_SECTION_START)
+    __attribute__((weak));
+extern pw::metric::Metric pw_metrics_stop[] __asm(_PW_METRIC_SECTION_STOP)
+    __attribute__((weak));
+}  // extern "C"
+
+namespace pw::metric {
+
+std::span<Metric> registered_metrics() {
+  if (pw_metrics_start == nullptr || pw_metrics_stop == nullptr) {
+    return std::span<Metric>();
+  }
+  return std::span<Metric>(pw_metrics_start, pw_metrics_stop);
+}
+
+StatusWithSize SnapshotRegisteredMetrics(std::span<uint32_t> values) {
+  const std::span<Metric> metrics = registered_metrics();
+  if (values.size() < metrics.size()) {
+    return StatusWithSize::ResourceExhausted();
+  }
+  for (size_t i = 0; i < metrics.size(); ++i) {
+    if (metrics[i].is_float()) {
+      const float value = metrics[i].as_float();
+      std::memcpy(&values[i], &value, sizeof(value));
+    } else {
+      values[i] = metrics[i].as_int();
+    }
+  }
+  return StatusWithSize(metrics.size());
+}
+
+void DumpRegisteredMetrics(int indent_level) {
+  for (Metric& metric : registered_metrics()) {
+    metric.Dump(indent_level);
+  }
+}
+
+}  // namespace pw::metric
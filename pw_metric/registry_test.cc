@@ -0,0 +1,75 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_metric/registry.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace pw::metric {
+namespace {
+
+PW_METRIC_REGISTERED(registered_int, "registered_int", 5u);
+PW_METRIC_REGISTERED(registered_float, "registered_float", 1.5f);
+PW_METRIC_REGISTERED(registered_other, "registered_other", 0u);
+
+bool IsRegistered(const Metric& metric) {
+  const std::span<Metric> metrics = registered_metrics();
+  return std::any_of(metrics.begin(), metrics.end(), [&](const Metric& m) {
+    return &m == &metric;
+  });
+}
+
+TEST(Registry, MetricsAreInSection) {
+  EXPECT_EQ(registered_metrics().size(), 3u);
+  EXPECT_TRUE(IsRegistered(registered_int));
+  EXPECT_TRUE(IsRegistered(registered_float));
+  EXPECT_TRUE(IsRegistered(registered_other));
+}
+
+TEST(Registry, Snapshot) {
+  registered_int.Increment();
+
+  std::array<uint32_t, 3> values{};
+  const StatusWithSize result = SnapshotRegisteredMetrics(values);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 3u);
+
+  const std::span<Metric> metrics = registered_metrics();
+  for (size_t i = 0; i < metrics.size(); ++i) {
+    if (&metrics[i] == &registered_int) {
+      EXPECT_EQ(values[i], 6u);
+    } else if (&metrics[i] == &registered_float) {
+      float value;
+      std::memcpy(&value, &values[i], sizeof(value));
+      EXPECT_EQ(value, 1.5f);
+    } else {
+      EXPECT_EQ(values[i], 0u);
+    }
+  }
+}
+
+TEST(Registry, Snapshot_TooSmall) {
+  std::array<uint32_t, 2> values{};
+  EXPECT_EQ(SnapshotRegisteredMetrics(values).status(),
+            Status::ResourceExhausted());
+}
+
+TEST(Registry, Dump) { DumpRegisteredMetrics(); }
+
+}  // namespace
+}  // namespace pw::metric
@@ -0,0 +1,54 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_multisink/flash_drain.h"
+
+#include "pw_status/try.h"
+
+namespace pw {
+namespace multisink {
+
+Status FlashDrain::Service() {
+  while (true) {
+    uint32_t drop_count = 0;
+    const Result<ConstByteSpan> entry =
+        GetEntry(log_.EntryBuffer(), drop_count);
+    dropped_entries_ += drop_count;
+
+    if (entry.ok()) {
+      log_.CommitEntry(entry.value().size());
+      continue;
+    }
+    if (entry.status().IsOutOfRange()) {
+      return OkStatus();
+    }
+    if (entry.status().IsResourceExhausted() && log_.buffered_bytes() != 0) {
+      // The chunk is full. Write it out and read the entry into a new one.
+      PW_TRY(log_.Flush());
+      continue;
+    }
+    return entry.status();
+  }
+}
+
+bool FlashDrain::ShouldDeliver(const MultiSink::EntryView& entry) {
+  if (entry.size() > log_.max_entry_size()) {
+    oversized_entries_ += 1;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace multisink
+}  // namespace pw
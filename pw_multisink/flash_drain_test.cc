@@ -0,0 +1,124 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_multisink/flash_drain.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/fake_flash_memory.h"
+
+namespace pw::multisink {
+namespace {
+
+constexpr size_t kSectorSize = 256;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kChunkSize = 64;
+
+class FlashDrainTest : public ::testing::Test {
+ protected:
+  FlashDrainTest()
+      : flash_(16),
+        partition_(&flash_),
+        log_(partition_),
+        drain_(log_),
+        multisink_buffer_{},
+        multisink_(multisink_buffer_) {}
+
+  void SetUp() override {
+    ASSERT_EQ(OkStatus(), log_.Init());
+    multisink_.AttachDrain(drain_);
+  }
+
+  void TearDown() override { multisink_.DetachDrain(drain_); }
+
+  void HandleEntry(uint8_t id, size_t size = 8) {
+    std::array<std::byte, 64> entry = {};
+    entry[0] = std::byte{id};
+    multisink_.HandleEntry(std::span(entry).first(size));
+  }
+
+  // Reads the IDs of the entries in flash into ids, and returns how many.
+  size_t ReadIds(std::span<uint8_t> ids) {
+    std::array<std::byte, kChunkSize> buffer;
+    FlashLog::Reader reader(log_, buffer);
+    size_t count = 0;
+    for (Result<ConstByteSpan> entry = reader.Next(); entry.ok();
+         entry = reader.Next()) {
+      if (count < ids.size()) {
+        ids[count] = static_cast<uint8_t>(entry.value()[0]);
+      }
+      count += 1;
+    }
+    return count;
+  }
+
+  kvs::FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  kvs::FlashPartition partition_;
+  FlashLogBuffer<kChunkSize> log_;
+  FlashDrain drain_;
+  std::array<std::byte, 512> multisink_buffer_;
+  MultiSink multisink_;
+};
+
+TEST_F(FlashDrainTest, MovesEntriesToFlash) {
+  for (uint8_t id = 0; id < 7; ++id) {
+    HandleEntry(id);
+  }
+  ASSERT_EQ(OkStatus(), drain_.Service());
+
+  // The first chunk filled and was written; the rest are buffered.
+  std::array<uint8_t, 8> ids = {};
+  ASSERT_EQ(5u, ReadIds(ids));
+  EXPECT_EQ(20u, log_.buffered_bytes());
+
+  ASSERT_EQ(OkStatus(), drain_.Flush());
+  ASSERT_EQ(7u, ReadIds(ids));
+  for (uint8_t id = 0; id < 7; ++id) {
+    EXPECT_EQ(id, ids[id]);
+  }
+  EXPECT_EQ(0u, drain_.dropped_entries());
+}
+
+TEST_F(FlashDrainTest, NoEntries) {
+  ASSERT_EQ(OkStatus(), drain_.Service());
+  EXPECT_EQ(0u, log_.buffered_bytes());
+}
+
+TEST_F(FlashDrainTest, SkipsOversizedEntries) {
+  HandleEntry(1);
+  HandleEntry(2, log_.max_entry_size() + 1);
+  HandleEntry(3, log_.max_entry_size());
+  ASSERT_EQ(OkStatus(), drain_.Service());
+  ASSERT_EQ(OkStatus(), drain_.Flush());
+
+  std::array<uint8_t, 4> ids = {};
+  ASSERT_EQ(2u, ReadIds(ids));
+  EXPECT_EQ(1u, ids[0]);
+  EXPECT_EQ(3u, ids[1]);
+  EXPECT_EQ(1u, drain_.oversized_entries());
+  EXPECT_EQ(0u, drain_.dropped_entries());
+}
+
+TEST_F(FlashDrainTest, CountsDrops) {
+  HandleEntry(1);
+  multisink_.HandleDropped(3);
+  HandleEntry(2);
+  ASSERT_EQ(OkStatus(), drain_.Service());
+  EXPECT_EQ(3u, drain_.dropped_entries());
+}
+
+}  // namespace
+}  // namespace pw::multisink
@@ -0,0 +1,326 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_multisink/flash_log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "pw_checksum/crc16_ccitt.h"
+#include "pw_kvs/alignment.h"
+#include "pw_status/try.h"
+
+namespace pw {
+namespace multisink {
+
+namespace {
+
+// A chunk holds at most one sector, and its size must fit in 16 bits.
+size_t ChunkSize(const kvs::FlashPartition& partition, ByteSpan buffer) {
+  const size_t max_size =
+      std::min(partition.sector_size_bytes(),
+               size_t{std::numeric_limits<uint16_t>::max()});
+  return AlignDown(std::min(buffer.size(), max_size),
+                   partition.alignment_bytes());
+}
+
+}  // namespace
+
+FlashLog::FlashLog(kvs::FlashPartition& partition, ByteSpan chunk_buffer)
+    : partition_(partition),
+      buffer_(chunk_buffer.first(ChunkSize(partition, chunk_buffer))),
+      chunk_bytes_(kChunkHeaderSize),
+      initialized_(false),
+      sector_(0),
+      offset_(0),
+      sequence_(0) {}
+
+Status FlashLog::Init() {
+  initialized_ = false;
+  chunk_bytes_ = kChunkHeaderSize;
+  if (buffer_.size() <= kChunkHeaderSize + kEntryHeaderSize) {
+    return Status::FailedPrecondition();
+  }
+
+  // The newest sector has the highest sequence number. Check the first chunk
+  // of the candidate, in case the device reset while it was being written, and
+  // fall back to the next highest sequence number if it is corrupt.
+  bool found = false;
+  uint32_t below = std::numeric_limits<uint32_t>::max();
+  while (!found) {
+    bool have_candidate = false;
+    ChunkHeader header;
+    for (size_t sector = 0; sector < partition_.sector_count(); ++sector) {
+      if (ReadChunkHeader(sector, 0, header) && header.sequence < below &&
+          (!have_candidate || header.sequence > sequence_)) {
+        have_candidate = true;
+        sector_ = sector;
+        sequence_ = header.sequence;
+      }
+    }
+    if (!have_candidate) {
+      break;
+    }
+
+    ReadChunkHeader(sector_, 0, header);
+    const Status status = ReadChunk(sector_, 0, header, buffer_);
+    if (status.ok()) {
+      found = true;
+    } else if (status.IsDataLoss()) {
+      below = sequence_;
+    } else {
+      return status;
+    }
+  }
+
+  if (!found) {
+    // The log is empty. Start at the first sector when the first chunk is
+    // written.
+    sector_ = partition_.sector_count() - 1;
+    offset_ = partition_.sector_size_bytes();
+    sequence_ = 0;
+    initialized_ = true;
+    return OkStatus();
+  }
+
+  // Find the end of the chunks in the newest sector.
+  offset_ = 0;
+  while (offset_ + kChunkHeaderSize <= partition_.sector_size_bytes()) {
+    ChunkHeader header;
+    if (ReadChunkHeader(sector_, offset_, header)) {
+      offset_ += AlignUp(kChunkHeaderSize + header.size,
+                         partition_.alignment_bytes());
+      continue;
+    }
+
+    bool erased = false;
+    PW_TRY(partition_.IsRegionErased(
+        SectorAddress(sector_) + offset_,
+        partition_.sector_size_bytes() - offset_,
+        &erased));
+    if (!erased) {
+      // The rest of the sector holds a partly written chunk. Continue in the
+      // next sector.
+      offset_ = partition_.sector_size_bytes();
+    }
+    break;
+  }
+
+  initialized_ = true;
+  return OkStatus();
+}
+
+Status FlashLog::Append(ConstByteSpan entry) {
+  if (!initialized_) {
+    return Status::FailedPrecondition();
+  }
+  if (entry.size() > max_entry_size()) {
+    return Status::OutOfRange();
+  }
+
+  ByteSpan destination = EntryBuffer();
+  if (destination.size() < entry.size()) {
+    PW_TRY(Flush());
+    destination = EntryBuffer();
+  }
+  std::memcpy(destination.data(), entry.data(), entry.size());
+  CommitEntry(entry.size());
+  return OkStatus();
+}
+
+ByteSpan FlashLog::EntryBuffer() {
+  if (chunk_bytes_ + kEntryHeaderSize >= buffer_.size()) {
+    return ByteSpan();
+  }
+  return buffer_.subspan(chunk_bytes_ + kEntryHeaderSize);
+}
+
+void FlashLog::CommitEntry(size_t size_bytes) {
+  const uint16_t size = static_cast<uint16_t>(size_bytes);
+  std::memcpy(&buffer_[chunk_bytes_], &size, sizeof(size));
+  chunk_bytes_ += kEntryHeaderSize + size_bytes;
+}
+
+Status FlashLog::Flush() {
+  if (!initialized_) {
+    return Status::FailedPrecondition();
+  }
+  if (buffered_bytes() == 0) {
+    return OkStatus();
+  }
+
+  const size_t write_size = AlignUp(chunk_bytes_, partition_.alignment_bytes());
+  if (offset_ + write_size > partition_.sector_size_bytes()) {
+    if (Status status = StartNextSector(); !status.ok()) {
+      chunk_bytes_ = kChunkHeaderSize;
+      return status;
+    }
+  }
+
+  ChunkHeader header;
+  header.sequence = sequence_;
+  header.size = static_cast<uint16_t>(buffered_bytes());
+  header.crc = ChunkCrc(header, buffer_.subspan(kChunkHeaderSize, header.size));
+  std::memcpy(buffer_.data(), &header, sizeof(header));
+  std::memset(&buffer_[chunk_bytes_], 0, write_size - chunk_bytes_);
+
+  const StatusWithSize result = partition_.Write(
+      SectorAddress(sector_) + offset_, buffer_.first(write_size));
+
+  // Even if the write failed, part of the chunk may have been written.
+  offset_ += write_size;
+  chunk_bytes_ = kChunkHeaderSize;
+  return result.status();
+}
+
+Status FlashLog::Clear() {
+  chunk_bytes_ = kChunkHeaderSize;
+  PW_TRY(partition_.Erase());
+
+  // Keep counting up, so that the next sector written is the newest.
+  sector_ = partition_.sector_count() - 1;
+  offset_ = partition_.sector_size_bytes();
+  return OkStatus();
+}
+
+size_t FlashLog::max_entry_size() const {
+  if (buffer_.size() <= kChunkHeaderSize + kEntryHeaderSize) {
+    return 0;
+  }
+  return buffer_.size() - kChunkHeaderSize - kEntryHeaderSize;
+}
+
+bool FlashLog::ReadChunkHeader(size_t sector,
+                               size_t offset,
+                               ChunkHeader& header) {
+  std::array<std::byte, kChunkHeaderSize> bytes;
+  if (!partition_.Read(SectorAddress(sector) + offset, bytes).ok() ||
+      partition_.AppearsErased(bytes)) {
+    return false;
+  }
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  return header.size != 0 &&
+         offset + AlignUp(kChunkHeaderSize + header.size,
+                          partition_.alignment_bytes()) <=
+             partition_.sector_size_bytes();
+}
+
+Status FlashLog::ReadChunk(size_t sector,
+                           size_t offset,
+                           const ChunkHeader& header,
+                           ByteSpan buffer) {
+  if (header.size > buffer.size()) {
+    return Status::ResourceExhausted();
+  }
+  const ByteSpan entries = buffer.first(header.size);
+  PW_TRY(partition_.Read(
+      SectorAddress(sector) + offset + kChunkHeaderSize, entries));
+  if (ChunkCrc(header, entries) != header.crc) {
+    return Status::DataLoss();
+  }
+  return OkStatus();
+}
+
+uint16_t FlashLog::ChunkCrc(const ChunkHeader& header, ConstByteSpan entries) {
+  uint16_t crc = checksum::Crc16Ccitt::Calculate(
+      std::as_bytes(std::span(&header.sequence, 1)));
+  crc = checksum::Crc16Ccitt::Calculate(
+      std::as_bytes(std::span(&header.size, 1)), crc);
+  return checksum::Crc16Ccitt::Calculate(entries, crc);
+}
+
+Status FlashLog::StartNextSector() {
+  sector_ = (sector_ + 1) % partition_.sector_count();
+  sequence_ += 1;
+
+  // If the erase fails, the next chunk tries the sector after this one.
+  offset_ = partition_.sector_size_bytes();
+  PW_TRY(partition_.Erase(SectorAddress(sector_), 1));
+  offset_ = 0;
+  return OkStatus();
+}
+
+Result<ConstByteSpan> FlashLog::Reader::Next() {
+  while (position_ + kEntryHeaderSize > chunk_.size()) {
+    PW_TRY(ReadNextChunk());
+  }
+
+  uint16_t size;
+  std::memcpy(&size, &chunk_[position_], sizeof(size));
+  position_ += kEntryHeaderSize;
+  if (position_ + size > chunk_.size()) {
+    position_ = chunk_.size();
+    return Status::DataLoss();
+  }
+
+  const ConstByteSpan entry = chunk_.subspan(position_, size);
+  position_ += size;
+  return entry;
+}
+
+Status FlashLog::Reader::ReadNextChunk() {
+  if (!log_.initialized_) {
+    return Status::FailedPrecondition();
+  }
+
+  const size_t sector_count = log_.partition_.sector_count();
+  const size_t sector_size = log_.partition_.sector_size_bytes();
+
+  // Read the sectors from the oldest, which follows the newest, to the newest.
+  while (sectors_read_ < sector_count) {
+    const size_t sector = (log_.sector_ + 1 + sectors_read_) % sector_count;
+
+    ChunkHeader header;
+    if (offset_ + kChunkHeaderSize <= sector_size &&
+        log_.ReadChunkHeader(sector, offset_, header)) {
+      if (offset_ == 0) {
+        sector_sequence_ = header.sequence;
+      }
+
+      // Sectors from before the log wrapped around to the newest sector, and
+      // chunks from other sectors, are not part of the log.
+      const bool in_log = header.sequence == sector_sequence_ &&
+                          header.sequence <= log_.sequence_ &&
+                          log_.sequence_ - header.sequence < sector_count;
+      if (in_log) {
+        const size_t chunk_offset = offset_;
+        offset_ += AlignUp(kChunkHeaderSize + header.size,
+                           log_.partition_.alignment_bytes());
+
+        const Status status =
+            log_.ReadChunk(sector, chunk_offset, header, buffer_);
+        if (status.ok()) {
+          chunk_ = buffer_.first(header.size);
+          position_ = 0;
+          return OkStatus();
+        }
+        if (!status.IsDataLoss()) {
+          return status;
+        }
+        continue;  // Skip chunks that fail their checksum.
+      }
+    }
+
+    sectors_read_ += 1;
+    offset_ = 0;
+  }
+
+  chunk_ = ConstByteSpan();
+  position_ = 0;
+  return Status::OutOfRange();
+}
+
+}  // namespace multisink
+}  // namespace pw
@@ -0,0 +1,265 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_multisink/flash_log.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/fake_flash_memory.h"
+
+namespace pw::multisink {
+namespace {
+
+constexpr size_t kSectorSize = 256;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kAlignment = 16;
+constexpr size_t kChunkSize = 64;
+
+// Chunks of 64 bytes hold 5 of these entries, and sectors hold 4 chunks.
+constexpr size_t kEntrySize = 8;
+constexpr size_t kEntriesPerSector = 20;
+
+std::array<std::byte, kEntrySize> Entry(uint32_t id) {
+  std::array<std::byte, kEntrySize> entry = {};
+  std::memcpy(entry.data(), &id, sizeof(id));
+  return entry;
+}
+
+uint32_t EntryId(ConstByteSpan entry) {
+  uint32_t id = 0;
+  std::memcpy(&id, entry.data(), sizeof(id));
+  return id;
+}
+
+class FlashLogTest : public ::testing::Test {
+ protected:
+  FlashLogTest() : flash_(kAlignment), partition_(&flash_) {}
+
+  void Append(FlashLog& log, uint32_t first_id, uint32_t count) {
+    for (uint32_t id = first_id; id < first_id + count; ++id) {
+      ASSERT_EQ(OkStatus(), log.Append(Entry(id)));
+    }
+  }
+
+  // Reads every entry, checks that their IDs count up from first_id, and
+  // returns how many there are.
+  size_t ReadAll(FlashLog& log, uint32_t first_id) {
+    std::array<std::byte, kChunkSize> buffer;
+    FlashLog::Reader reader(log, buffer);
+
+    size_t count = 0;
+    Result<ConstByteSpan> entry = reader.Next();
+    for (; entry.ok(); entry = reader.Next()) {
+      EXPECT_EQ(kEntrySize, entry.value().size());
+      EXPECT_EQ(first_id + count, EntryId(entry.value()));
+      count += 1;
+    }
+    EXPECT_EQ(Status::OutOfRange(), entry.status());
+    return count;
+  }
+
+  kvs::FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  kvs::FlashPartition partition_;
+};
+
+TEST_F(FlashLogTest, Empty) {
+  FlashLogBuffer<kChunkSize> log(partition_);
+  ASSERT_EQ(OkStatus(), log.Init());
+  EXPECT_EQ(0u, ReadAll(log, 0));
+  EXPECT_EQ(kChunkSize - 10, log.max_entry_size());
+}
+
+TEST_F(FlashLogTest, NotInitialized) {
+  FlashLogBuffer<kChunkSize> log(partition_);
+  EXPECT_EQ(Status::FailedPrecondition(), log.Append(Entry(0)));
+  EXPECT_EQ(Status::FailedPrecondition(), log.Flush());
+
+  std::array<std::byte, kChunkSize> buffer;
+  FlashLog::Reader reader(log, buffer);
+  EXPECT_EQ(Status::FailedPrecondition(), reader.Next().status());
+}
+
+TEST_F(FlashLogTest, ChunkBufferTooSmall) {
+  FlashLogBuffer<kAlignment - 1> log(partition_);
+  EXPECT_EQ(Status::FailedPrecondition(), log.Init());
+}
+
+TEST_F(FlashLogTest, EntriesAreWrittenWhenChunkFills) {
+  FlashLogBuffer<kChunkSize> log(partition_);
+  ASSERT_EQ(OkStatus(), log.Init());
+
+  Append(log, 0, 5);
+  EXPECT_EQ(50u, log.buffered_bytes());
+  EXPECT_EQ(0u, ReadAll(log, 0));
+
+  Append(log, 5, 1);
+  EXPECT_EQ(10u, log.buffered_bytes());
+  EXPECT_EQ(5u, ReadAll(log, 0));
+
+  ASSERT_EQ(OkStatus(), log.Flush());
+  EXPECT_EQ(0u, log.buffered_bytes());
+  EXPECT_EQ(6u, ReadAll(log, 0));
+
+  // Flushing with nothing buffered does not write.
+  ASSERT_EQ(OkStatus(), log.Flush());
+  EXPECT_EQ(6u, ReadAll(log, 0));
+}
+
+TEST_F(FlashLogTest, EntriesOfDifferentSizes) {
+  FlashLogBuffer<kChunkSize> log(partition_);
+  ASSERT_EQ(OkStatus(), log.Init());
+
+  const std::byte large[54] = {std::byte{1}};
+  const std::byte small[1] = {std::byte{2}};
+  EXPECT_EQ(Status::OutOfRange(), log.Append(std::array<std::byte, 55>{}));
+  ASSERT_EQ(OkStatus(), log.Append(small));
+  ASSERT_EQ(OkStatus(), log.Append(large));
+  ASSERT_EQ(OkStatus(), log.Append(small));
+  ASSERT_EQ(OkStatus(), log.Flush());
+
+  std::array<std::byte, kChunkSize> buffer;
+  FlashLog::Reader reader(log, buffer);
+  EXPECT_EQ(1u, reader.Next().value().size());
+  EXPECT_EQ(54u, reader.Next().value().size());
+  EXPECT_EQ(1u, reader.Next().value().size());
+  EXPECT_EQ(Status::OutOfRange(), reader.Next().status());
+}
+
+TEST_F(FlashLogTest, InitFindsEndOfLog) {
+  {
+    FlashLogBuffer<kChunkSize> log(partition_);
+    ASSERT_EQ(OkStatus(), log.Init());
+    Append(log, 0, 27);
+    ASSERT_EQ(OkStatus(), log.Flush());
+  }
+
+  FlashLogBuffer<kChunkSize> log(partition_);
+  ASSERT_EQ(OkStatus(), log.Init());
+  EXPECT_EQ(27u, ReadAll(log, 0));
+
+  Append(log, 27, 10);
+  ASSERT_EQ(OkStatus(), log.Flush());
+  EXPECT_EQ(37u, ReadAll(log, 0));
+}
+
+TEST_F(FlashLogTest, WrapsAroundPartition) {
+  constexpr uint32_t kEntries = 10 * kEntriesPerSector + 3;
+  {
+    FlashLogBuffer<kChunkSize> log(partition_);
+    ASSERT_EQ(OkStatus(), log.Init());
+    Append(log, 0, kEntries);
+    ASSERT_EQ(OkStatus(), log.Flush());
+
+    // The newest sector holds 3 entries, and the other sectors hold the 60
+    // entries before them.
+    EXPECT_EQ(63u, ReadAll(log, kEntries - 63));
+  }
+
+  FlashLogBuffer<kChunkSize> log(partition_);
+  ASSERT_EQ(OkStatus(), log.Init());
+  EXPECT_EQ(63u, ReadAll(log, kEntries - 63));
+
+  Append(log, kEntries, 20);
+  ASSERT_EQ(OkStatus(), log.Flush());
+  EXPECT_EQ(63u, ReadAll(log, kEntries + 20 - 63));
+}
+
+TEST_F(FlashLogTest, CorruptChunkIsSkipped) {
+  FlashLogBuffer<kChunkSize> log(partition_);
+  ASSERT_EQ(OkStatus(), log.Init());
+  Append(log, 0, 15);
+  ASSERT_EQ(OkStatus(), log.Flush());
+
+  // Corrupt an entry in the second chunk.
+  flash_.buffer()[kChunkSize + 20] ^= std::byte{0xff};
+
+  std::array<std::byte, kChunkSize> buffer;
+  FlashLog::Reader reader(log, buffer);
+  for (uint32_t id : {0, 1, 2, 3, 4, 10, 11, 12, 13, 14}) {
+    Result<ConstByteSpan> entry = reader.Next();
+    ASSERT_EQ(OkStatus(), entry.status());
+    EXPECT_EQ(id, EntryId(entry.value()));
+  }
+  EXPECT_EQ(Status::OutOfRange(), reader.Next().status());
+}
+
+TEST_F(FlashLogTest, Init_PartlyWrittenChunkStartsNextSector) {
+  {
+    FlashLogBuffer<kChunkSize> log(partition_);
+    ASSERT_EQ(OkStatus(), log.Init());
+    Append(log, 0, 10);
+    ASSERT_EQ(OkStatus(), log.Flush());
+  }
+
+  // A chunk that was being written when the device reset.
+  flash_.buffer()[2 * kChunkSize] = std::byte{0};
+
+  FlashLogBuffer<kChunkSize> log(partition_);
+  ASSERT_EQ(OkStatus(), log.Init());
+  Append(log, 10, 5);
+  ASSERT_EQ(OkStatus(), log.Flush());
+
+  EXPECT_EQ(15u, ReadAll(log, 0));
+  EXPECT_TRUE(partition_.AppearsErased(
+      flash_.buffer().subspan(3 * kChunkSize, kSectorSize - 3 * kChunkSize)));
+  EXPECT_FALSE(partition_.AppearsErased(
+      flash_.buffer().subspan(kSectorSize, kChunkSize)));
+}
+
+TEST_F(FlashLogTest, Init_CorruptNewestSectorIsIgnored) {
+  {
+    FlashLogBuffer<kChunkSize> log(partition_);
+    ASSERT_EQ(OkStatus(), log.Init());
+    Append(log, 0, kEntriesPerSector + 5);
+    ASSERT_EQ(OkStatus(), log.Flush());
+  }
+
+  // Corrupt the only chunk in the newest sector, as if the device reset while
+  // it was being written.
+  flash_.buffer()[kSectorSize + 20] ^= std::byte{0xff};
+
+  FlashLogBuffer<kChunkSize> log(partition_);
+  ASSERT_EQ(OkStatus(), log.Init());
+  EXPECT_EQ(kEntriesPerSector, ReadAll(log, 0));
+
+  // The corrupt sector is erased and written again.
+  Append(log, kEntriesPerSector, 5);
+  ASSERT_EQ(OkStatus(), log.Flush());
+  EXPECT_EQ(kEntriesPerSector + 5, ReadAll(log, 0));
+}
+
+TEST_F(FlashLogTest, Clear) {
+  FlashLogBuffer<kChunkSize> log(partition_);
+  ASSERT_EQ(OkStatus(), log.Init());
+  Append(log, 0, 30);
+  ASSERT_EQ(OkStatus(), log.Flush());
+
+  Append(log, 30, 2);
+  ASSERT_EQ(OkStatus(), log.Clear());
+  EXPECT_EQ(0u, log.buffered_bytes());
+  EXPECT_EQ(0u, ReadAll(log, 0));
+
+  Append(log, 100, 7);
+  ASSERT_EQ(OkStatus(), log.Flush());
+  EXPECT_EQ(7u, ReadAll(log, 100));
+
+  FlashLogBuffer<kChunkSize> reloaded(partition_);
+  ASSERT_EQ(OkStatus(), reloaded.Init());
+  EXPECT_EQ(7u, ReadAll(reloaded, 100));
+}
+
+}  // namespace
+}  // namespace pw::multisink
@@ -44,6 +44,7 @@ Result<ConstByteSpan> MultiSink::GetEntry(Drain& drain,
   std::lock_guard lock(lock_);
   PW_DCHECK_PTR_EQ(drain.multisink_, this);
 
+  SkipFilteredEntries(drain);
   const Status peek_status = drain.reader_.PeekFrontWithPreamble(
       buffer, entry_sequence_id, bytes_read);
   if (peek_status.IsOutOfRange()) {
@@ -64,27 +65,166 @@ Result<ConstByteSpan> MultiSink::GetEntry(Drain& drain,
   // The drop count calculation simply computes the difference between the
   // current and last sequence IDs. Consecutive successful reads will always
   // differ by one at least, so it is subtracted out. If the read was not
-  // successful, the difference is not adjusted.
+  // successful, the difference is not adjusted. Drops found before skipped
+  // entries are added in.
   drop_count_out = entry_sequence_id - drain.last_handled_sequence_id_ -
-                   (peek_status.ok() ? 1 : 0);
+                   (peek_status.ok() ? 1 : 0) + drain.pending_drop_count_;
   drain.last_handled_sequence_id_ = entry_sequence_id;
+  drain.pending_drop_count_ = 0;
+  drain.stats_.dropped_entries += drop_count_out;
 
   // The Peek above may have failed due to OutOfRange, now that we've set the
   // drop count see if we should return before attempting to pop.
   if (peek_status.IsOutOfRange()) {
+    RearmListenersIfCaughtUp(drain);
     return peek_status;
   }
 
   // Success, pop the oldest entry!
   PW_CHECK(drain.reader_.PopFront().ok());
+  drain.stats_.delivered_entries++;
+  RearmListenersIfCaughtUp(drain);
   return std::as_bytes(buffer.first(bytes_read));
 }
 
+StatusWithSize MultiSink::GetEntries(Drain& drain,
+                                     ByteSpan buffer,
+                                     std::span<ConstByteSpan> entries_out,
+                                     uint32_t& drop_count_out) {
+  size_t bytes_read = 0;
+  size_t entries_read = 0;
+  drop_count_out = 0;
+
+  std::lock_guard lock(lock_);
+  PW_DCHECK_PTR_EQ(drain.multisink_, this);
+
+  if (drain.filter_ != nullptr) {
+    return GetFilteredEntries(drain, buffer, entries_out, drop_count_out);
+  }
+
+  const Status peek_status = drain.reader_.PeekFrontMultiple(
+      buffer, bytes_read, entries_read, entries_out.size());
+  if (peek_status.IsOutOfRange()) {
+    // As in GetEntry, report any entries dropped after the last one read.
+    drop_count_out = sequence_id_ - 1 - drain.last_handled_sequence_id_ +
+                     drain.pending_drop_count_;
+    drain.last_handled_sequence_id_ = sequence_id_ - 1;
+    drain.pending_drop_count_ = 0;
+    drain.stats_.dropped_entries += drop_count_out;
+    RearmListenersIfCaughtUp(drain);
+    return StatusWithSize::OutOfRange();
+  }
+  if (!peek_status.ok()) {
+    return StatusWithSize(peek_status, 0);
+  }
+
+  // Split the entries apart. Each is a varint sequence ID and a varint length,
+  // followed by the entry's data.
+  ConstByteSpan remaining = buffer.first(bytes_read);
+  uint64_t entry_sequence_id = 0;
+  for (size_t i = 0; i < entries_read; ++i) {
+    const size_t sequence_id_bytes =
+        varint::Decode(remaining, &entry_sequence_id);
+    uint64_t entry_bytes = 0;
+    const size_t length_bytes =
+        varint::Decode(remaining.subspan(sequence_id_bytes), &entry_bytes);
+    if (sequence_id_bytes == 0 || length_bytes == 0) {
+      return StatusWithSize::DataLoss();
+    }
+    remaining = remaining.subspan(sequence_id_bytes + length_bytes);
+    if (entry_bytes > remaining.size()) {
+      return StatusWithSize::DataLoss();
+    }
+    entries_out[i] = remaining.first(entry_bytes);
+    remaining = remaining.subspan(entry_bytes);
+  }
+
+  // Every entry read accounts for one sequence ID; the rest were dropped.
+  drop_count_out = static_cast<uint32_t>(entry_sequence_id) -
+                   drain.last_handled_sequence_id_ - entries_read +
+                   drain.pending_drop_count_;
+  drain.last_handled_sequence_id_ = static_cast<uint32_t>(entry_sequence_id);
+  drain.pending_drop_count_ = 0;
+
+  PW_CHECK_OK(drain.reader_.PopFrontMultiple(entries_read));
+  drain.stats_.delivered_entries += entries_read;
+  drain.stats_.dropped_entries += drop_count_out;
+  RearmListenersIfCaughtUp(drain);
+  return StatusWithSize(entries_read);
+}
+
+StatusWithSize MultiSink::GetFilteredEntries(
+    Drain& drain,
+    ByteSpan buffer,
+    std::span<ConstByteSpan> entries_out,
+    uint32_t& drop_count_out) {
+  size_t bytes_read = 0;
+  size_t entries_read = 0;
+  Status status = Status::ResourceExhausted();
+
+  while (entries_read < entries_out.size()) {
+    SkipFilteredEntries(drain);
+
+    uint32_t entry_sequence_id = 0;
+    size_t entry_bytes = 0;
+    status = drain.reader_.PeekFrontWithPreamble(
+        buffer.subspan(bytes_read), entry_sequence_id, entry_bytes);
+    if (!status.ok()) {
+      break;
+    }
+
+    PW_CHECK_OK(drain.reader_.PopFront());
+    HandleSequenceId(drain, entry_sequence_id);
+    entries_out[entries_read++] = buffer.subspan(bytes_read, entry_bytes);
+    bytes_read += entry_bytes;
+  }
+
+  if (entries_read == 0) {
+    if (!status.IsOutOfRange()) {
+      return StatusWithSize(status, 0);
+    }
+    // As in GetEntry, report any entries dropped after the last one read.
+    drain.pending_drop_count_ +=
+        sequence_id_ - 1 - drain.last_handled_sequence_id_;
+    drain.last_handled_sequence_id_ = sequence_id_ - 1;
+  }
+
+  drop_count_out = drain.pending_drop_count_;
+  drain.pending_drop_count_ = 0;
+  drain.stats_.delivered_entries += entries_read;
+  drain.stats_.dropped_entries += drop_count_out;
+  RearmListenersIfCaughtUp(drain);
+  return entries_read == 0 ? StatusWithSize::OutOfRange()
+                           : StatusWithSize(entries_read);
+}
+
+void MultiSink::SkipFilteredEntries(Drain& drain) {
+  if (drain.filter_ == nullptr) {
+    return;
+  }
+
+  EntryView entry;
+  uint32_t entry_sequence_id = 0;
+  while (drain.reader_.PeekFrontInPlace(entry, entry_sequence_id).ok() &&
+         !drain.filter_->ShouldDeliver(entry)) {
+    PW_CHECK_OK(drain.reader_.PopFront());
+    HandleSequenceId(drain, entry_sequence_id);
+    drain.stats_.skipped_entries++;
+  }
+}
+
+void MultiSink::HandleSequenceId(Drain& drain, uint32_t sequence_id) {
+  drain.pending_drop_count_ +=
+      sequence_id - drain.last_handled_sequence_id_ - 1;
+  drain.last_handled_sequence_id_ = sequence_id;
+}
+
 void MultiSink::AttachDrain(Drain& drain) {
   std::lock_guard lock(lock_);
   PW_DCHECK_PTR_EQ(drain.multisink_, nullptr);
   drain.multisink_ = this;
   drain.last_handled_sequence_id_ = sequence_id_ - 1;
+  drain.pending_drop_count_ = 0;
   PW_CHECK_OK(ring_buffer_.AttachReader(drain.reader_));
 }
 
@@ -98,6 +238,7 @@ void MultiSink::DetachDrain(Drain& drain) {
 
 void MultiSink::AttachListener(Listener& listener) {
   std::lock_guard lock(lock_);
+  listener.notified_ = false;
   listeners_.push_back(listener);
 }
 
@@ -114,15 +255,60 @@ void MultiSink::Clear() {
 
 void MultiSink::NotifyListeners() {
   for (auto& listener : listeners_) {
+    if (listener.notified_) {
+      continue;
+    }
+    listener.notified_ =
+        listener.notification_ == Listener::Notification::kOnceUntilDrained;
     listener.OnNewEntryAvailable();
   }
 }
 
+void MultiSink::RearmListenersIfCaughtUp(Drain& drain) {
+  if (drain.reader_.EntryCount() != 0) {
+    return;
+  }
+  for (auto& listener : listeners_) {
+    listener.notified_ = false;
+  }
+}
+
 Result<ConstByteSpan> MultiSink::Drain::GetEntry(ByteSpan buffer,
                                                  uint32_t& drop_count_out) {
   PW_DCHECK_NOTNULL(multisink_);
   return multisink_->GetEntry(*this, buffer, drop_count_out);
 }
 
+void MultiSink::Drain::set_filter(Filter* filter) {
+  if (multisink_ == nullptr) {
+    filter_ = filter;
+    return;
+  }
+  std::lock_guard lock(multisink_->lock_);
+  filter_ = filter;
+}
+
+MultiSink::Drain::Stats MultiSink::Drain::stats() const {
+  if (multisink_ == nullptr) {
+    return stats_;
+  }
+  std::lock_guard lock(multisink_->lock_);
+  return stats_;
+}
+
+size_t MultiSink::Drain::EntriesSize() {
+  PW_DCHECK_NOTNULL(multisink_);
+  std::lock_guard lock(multisink_->lock_);
+  return reader_.EntriesSize();
+}
+
+StatusWithSize MultiSink::Drain::GetEntries(
+    ByteSpan buffer,
+    std::span<ConstByteSpan> entries_out,
+    uint32_t& drop_count_out) {
+  PW_DCHECK_NOTNULL(multisink_);
+  return multisink_->GetEntries(*this, buffer, entries_out, drop_count_out);
+}
+
 }  // namespace multisink
 }  // namespace pw
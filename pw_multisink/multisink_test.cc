@@ -14,6 +14,8 @@
 
 #include "pw_multisink/multisink.h"
 
+#include <array>
+
 #include "gtest/gtest.h"
 
 namespace pw::multisink {
@@ -22,6 +24,9 @@ using Listener = MultiSink::Listener;
 
 class CountingListener : public Listener {
  public:
+  CountingListener(Notification notification = Notification::kEveryEntry)
+      : Listener(notification) {}
+
   void OnNewEntryAvailable() override { notification_count_++; }
 
   size_t GetNotificationCount() { return notification_count_; }
@@ -32,6 +37,19 @@ class CountingListener : public Listener {
   size_t notification_count_ = 0;
 };
 
+// Delivers entries whose first byte is at least the minimum level.
+class LevelFilter : public Drain::Filter {
+ public:
+  LevelFilter(std::byte min_level) : min_level_(min_level) {}
+
+  bool ShouldDeliver(const MultiSink::EntryView& entry) override {
+    return entry.first[0] >= min_level_;
+  }
+
+ private:
+  std::byte min_level_;
+};
+
 class MultiSinkTest : public ::testing::Test {
  protected:
   static constexpr std::byte kMessage[] = {
@@ -194,4 +212,181 @@ TEST_F(MultiSinkTest, TooSmallBuffer) {
   ExpectMessageAndDropCount(drains_[0], {}, 0u);
 }
 
+TEST_F(MultiSinkTest, GetEntriesBatch) {
+  multisink_.AttachDrain(drains_[0]);
+
+  multisink_.HandleDropped();
+  multisink_.HandleEntry(kMessage);
+  multisink_.HandleEntry(std::span(kMessage, 2));
+  multisink_.HandleDropped(2);
+  multisink_.HandleEntry(kMessage);
+
+  const size_t entries_size = drains_[0].EntriesSize();
+  EXPECT_GT(entries_size, 2 * sizeof(kMessage) + 2);
+
+  // All entries are read at once, and the drop count includes the drops
+  // before and between them.
+  std::array<ConstByteSpan, 4> entries;
+  uint32_t drop_count = 0;
+  StatusWithSize result =
+      drains_[0].GetEntries(entry_buffer_, entries, drop_count);
+  ASSERT_TRUE(result.ok());
+  ASSERT_EQ(result.size(), 3u);
+  EXPECT_EQ(drop_count, 3u);
+  ASSERT_EQ(entries[0].size(), sizeof(kMessage));
+  EXPECT_EQ(memcmp(entries[0].data(), kMessage, sizeof(kMessage)), 0);
+  ASSERT_EQ(entries[1].size(), 2u);
+  EXPECT_EQ(memcmp(entries[1].data(), kMessage, 2), 0);
+  ASSERT_EQ(entries[2].size(), sizeof(kMessage));
+  EXPECT_EQ(memcmp(entries[2].data(), kMessage, sizeof(kMessage)), 0);
+  EXPECT_EQ(drains_[0].EntriesSize(), 0u);
+
+  // Drops after the last entry are reported once the drain is empty.
+  multisink_.HandleDropped();
+  result = drains_[0].GetEntries(entry_buffer_, entries, drop_count);
+  EXPECT_EQ(result.status(), Status::OutOfRange());
+  EXPECT_EQ(drop_count, 1u);
+  ExpectMessageAndDropCount(drains_[0], {}, 0u);
+  EXPECT_EQ(drains_[0].stats().delivered_entries, 3u);
+  EXPECT_EQ(drains_[0].stats().dropped_entries, 4u);
+}
+
+TEST_F(MultiSinkTest, GetEntriesPartialBatch) {
+  multisink_.AttachDrain(drains_[0]);
+  for (int i = 0; i < 4; ++i) {
+    multisink_.HandleEntry(kMessage);
+  }
+
+  // The batch is limited by the number of entry spans.
+  std::array<ConstByteSpan, 3> entries;
+  uint32_t drop_count = 0;
+  StatusWithSize result =
+      drains_[0].GetEntries(entry_buffer_, entries, drop_count);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.size(), 3u);
+  EXPECT_EQ(drop_count, 0u);
+
+  // Entries left over are read by the next call.
+  ExpectMessageAndDropCount(drains_[0], kMessage, 0u);
+  ExpectMessageAndDropCount(drains_[0], {}, 0u);
+
+  // The batch is limited by the buffer; the first entry must fit.
+  multisink_.HandleEntry(kMessage);
+  multisink_.HandleEntry(kMessage);
+  result = drains_[0].GetEntries(
+      std::span(entry_buffer_, sizeof(kMessage) + 2), entries, drop_count);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.size(), 1u);
+  result =
+      drains_[0].GetEntries(std::span(entry_buffer_, 1), entries, drop_count);
+  EXPECT_EQ(result.status(), Status::ResourceExhausted());
+  EXPECT_EQ(drop_count, 0u);
+  ExpectMessageAndDropCount(drains_[0], kMessage, 0u);
+}
+
+TEST_F(MultiSinkTest, ThrottledListener) {
+  CountingListener throttled(Listener::Notification::kOnceUntilDrained);
+  multisink_.AttachDrain(drains_[0]);
+  multisink_.AttachListener(throttled);
+  multisink_.AttachListener(listeners_[0]);
+
+  multisink_.HandleEntry(kMessage);
+  multisink_.HandleDropped();
+  multisink_.HandleEntry(kMessage);
+  ExpectNotificationCount(throttled, 1u);
+  ExpectNotificationCount(listeners_[0], 3u);
+
+  // Reading some, but not all, entries does not re-arm the listener.
+  ExpectMessageAndDropCount(drains_[0], kMessage, 0u);
+  multisink_.HandleEntry(kMessage);
+  ExpectNotificationCount(throttled, 0u);
+
+  // Once the drain catches up, the listener is notified again.
+  ExpectMessageAndDropCount(drains_[0], kMessage, 1u);
+  ExpectMessageAndDropCount(drains_[0], kMessage, 0u);
+  multisink_.HandleEntry(kMessage);
+  multisink_.HandleEntry(kMessage);
+  ExpectNotificationCount(throttled, 1u);
+
+  std::array<ConstByteSpan, 4> entries;
+  uint32_t drop_count = 0;
+  EXPECT_EQ(drains_[0].GetEntries(entry_buffer_, entries, drop_count).size(),
+            2u);
+  multisink_.HandleDropped();
+  ExpectNotificationCount(throttled, 1u);
+
+  multisink_.DetachListener(throttled);
+  multisink_.DetachListener(listeners_[0]);
+}
+
+TEST_F(MultiSinkTest, FilteredDrain) {
+  static constexpr std::byte kInfo[] = {std::byte{1}, std::byte{0xAA}};
+  static constexpr std::byte kWarn[] = {std::byte{2}, std::byte{0xBB}};
+  LevelFilter filter(std::byte{2});
+  drains_[0].set_filter(&filter);
+  multisink_.AttachDrain(drains_[0]);
+  multisink_.AttachDrain(drains_[1]);
+
+  multisink_.HandleEntry(kInfo);
+  multisink_.HandleDropped();
+  multisink_.HandleEntry(kInfo);
+  multisink_.HandleEntry(kWarn);
+  multisink_.HandleEntry(kInfo);
+  multisink_.HandleDropped();
+
+  // Skipped entries are not reported as drops, but drops between them are.
+  ExpectMessageAndDropCount(drains_[0], kWarn, 1u);
+  ExpectMessageAndDropCount(drains_[0], {}, 1u);
+  ExpectMessageAndDropCount(drains_[0], {}, 0u);
+  EXPECT_EQ(drains_[0].stats().delivered_entries, 1u);
+  EXPECT_EQ(drains_[0].stats().skipped_entries, 3u);
+  EXPECT_EQ(drains_[0].stats().dropped_entries, 2u);
+
+  // Drains without a filter receive every entry.
+  ExpectMessageAndDropCount(drains_[1], kInfo, 0u);
+  ExpectMessageAndDropCount(drains_[1], kInfo, 1u);
+  ExpectMessageAndDropCount(drains_[1], kWarn, 0u);
+  ExpectMessageAndDropCount(drains_[1], kInfo, 0u);
+  ExpectMessageAndDropCount(drains_[1], {}, 1u);
+  EXPECT_EQ(drains_[1].stats().delivered_entries, 4u);
+  EXPECT_EQ(drains_[1].stats().skipped_entries, 0u);
+  EXPECT_EQ(drains_[1].stats().dropped_entries, 2u);
+}
+
+TEST_F(MultiSinkTest, FilteredDrainGetEntries) {
+  static constexpr std::byte kInfo[] = {std::byte{1}, std::byte{0xAA}};
+  static constexpr std::byte kWarn[] = {std::byte{2}, std::byte{0xBB}};
+  LevelFilter filter(std::byte{2});
+  drains_[0].set_filter(&filter);
+  multisink_.AttachDrain(drains_[0]);
+
+  multisink_.HandleEntry(kWarn);
+  multisink_.HandleEntry(kInfo);
+  multisink_.HandleDropped();
+  multisink_.HandleEntry(kWarn);
+  multisink_.HandleEntry(kInfo);
+
+  std::array<ConstByteSpan, 4> entries;
+  uint32_t drop_count = 0;
+  StatusWithSize result =
+      drains_[0].GetEntries(entry_buffer_, entries, drop_count);
+  ASSERT_TRUE(result.ok());
+  ASSERT_EQ(result.size(), 2u);
+  EXPECT_EQ(drop_count, 1u);
+  EXPECT_EQ(entries[0][0], std::byte{2});
+  EXPECT_EQ(entries[1][0], std::byte{2});
+
+  result = drains_[0].GetEntries(entry_buffer_, entries, drop_count);
+  EXPECT_EQ(result.status(), Status::OutOfRange());
+  EXPECT_EQ(drop_count, 0u);
+  EXPECT_EQ(drains_[0].stats().delivered_entries, 2u);
+  EXPECT_EQ(drains_[0].stats().skipped_entries, 2u);
+  EXPECT_EQ(drains_[0].stats().dropped_entries, 1u);
+
+  // Clearing the filter delivers every entry again.
+  drains_[0].set_filter(nullptr);
+  multisink_.HandleEntry(kInfo);
+  ExpectMessageAndDropCount(drains_[0], kInfo, 0u);
+}
+
 }  // namespace pw::multisink
@@ -0,0 +1,75 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_multisink/flash_log.h"
+#include "pw_multisink/multisink.h"
+#include "pw_status/status.h"
+
+namespace pw {
+namespace multisink {
+
+// A drain that moves entries from a multisink into a FlashLog, so that they
+// are kept across resets. Entries are read from the multisink straight into
+// the log's chunk buffer, which is written to flash each time it fills.
+//
+//   FlashLogBuffer<2048> flash_log(log_partition);
+//   FlashDrain flash_drain(flash_log);
+//
+//   PW_TRY(flash_log.Init());
+//   multisink.AttachDrain(flash_drain);
+//
+//   // When the multisink has new entries, e.g. from a Listener:
+//   flash_drain.Service();
+//
+// Entries stay in RAM until the chunk buffer fills, so call Flush() when the
+// system is idle or before an intentional reset to write them out. The drain
+// uses a filter to skip entries larger than the log's max_entry_size(), so
+// another filter cannot be set on it.
+class FlashDrain : public MultiSink::Drain, private MultiSink::Drain::Filter {
+ public:
+  explicit FlashDrain(FlashLog& log)
+      : log_(log), dropped_entries_(0), oversized_entries_(0) {
+    set_filter(this);
+  }
+
+  // Moves every available entry into the flash log, writing each chunk to
+  // flash as it fills.
+  //
+  // Returns:
+  //   OK - Every available entry was moved.
+  //   Errors from GetEntry() or from writing to the flash log.
+  Status Service();
+
+  // Writes entries in the log's chunk buffer to flash.
+  Status Flush() { return log_.Flush(); }
+
+  // Entries that the multisink dropped before this drain read them.
+  uint32_t dropped_entries() const { return dropped_entries_; }
+
+  // Entries that were skipped because they do not fit in a chunk.
+  uint32_t oversized_entries() const { return oversized_entries_; }
+
+ private:
+  bool ShouldDeliver(const MultiSink::EntryView& entry) override;
+
+  FlashLog& log_;
+  uint32_t dropped_entries_;
+  uint32_t oversized_entries_;
+};
+
+}  // namespace multisink
+}  // namespace pw
@@ -0,0 +1,197 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+
+namespace pw {
+namespace multisink {
+
+// A circular log of entries in a flash partition, which keeps entries across
+// resets. Entries are collected in a RAM buffer and written to flash together
+// as a chunk once the buffer is full, or when Flush() is called, so flash is
+// written in large aligned blocks rather than once per entry.
+//
+// Each sector of the partition holds a series of chunks. When the chunk does
+// not fit in the current sector, the next sector is erased and the log
+// continues there, so the oldest sector of entries is discarded. Each chunk
+// records the sequence number of its sector, which increases each time a
+// sector is started, and a checksum of its contents.
+//
+// Init() finds the newest sector by reading the first chunk header of each
+// sector, then finds the end of the log in that sector by reading its chunk
+// headers. Chunks that were partly written when the device reset fail their
+// checksum and are skipped when reading.
+//
+// This class is not thread safe.
+class FlashLog {
+ public:
+  class Reader;
+
+  // The chunk buffer must be at least as large as the flash alignment, and
+  // holds at most one sector. Larger buffers mean fewer, larger writes.
+  FlashLog(kvs::FlashPartition& partition, ByteSpan chunk_buffer);
+
+  FlashLog(const FlashLog&) = delete;
+  FlashLog& operator=(const FlashLog&) = delete;
+
+  // Finds the end of the log in flash, so that entries can be appended to it
+  // and read. Entries buffered before Init() are discarded.
+  //
+  // Returns:
+  //   OK - The log is ready to use.
+  //   FAILED_PRECONDITION - The chunk buffer is too small for the partition.
+  //   Other errors from reading the flash partition.
+  Status Init();
+
+  // Appends an entry to the chunk buffer, first writing the buffered entries
+  // to flash if the entry does not fit.
+  //
+  // Returns:
+  //   OK - The entry was buffered.
+  //   FAILED_PRECONDITION - Init() has not succeeded.
+  //   OUT_OF_RANGE - The entry is larger than max_entry_size().
+  //   Other errors from writing the flash partition.
+  Status Append(ConstByteSpan entry);
+
+  // Returns the space in the chunk buffer for the next entry's data, so that
+  // the entry can be copied in place. CommitEntry() appends the first size
+  // bytes of it as an entry. If the entry does not fit, Flush() and try again.
+  ByteSpan EntryBuffer();
+  void CommitEntry(size_t size_bytes);
+
+  // Writes the buffered entries to flash as a chunk.
+  //
+  // Returns:
+  //   OK - The entries were written, or none were buffered.
+  //   FAILED_PRECONDITION - Init() has not succeeded.
+  //   Other errors from writing the flash partition. The buffered entries are
+  //       discarded.
+  Status Flush();
+
+  // Erases the log, including any buffered entries.
+  Status Clear();
+
+  // The largest entry that can be appended.
+  size_t max_entry_size() const;
+
+  // The number of bytes of entries in the chunk buffer, which are not yet
+  // written to flash.
+  size_t buffered_bytes() const { return chunk_bytes_ - kChunkHeaderSize; }
+
+ private:
+  friend class Reader;
+
+  struct ChunkHeader {
+    uint32_t sequence;  // The sequence number of the chunk's sector.
+    uint16_t size;      // The size of the entries, not including padding.
+    uint16_t crc;       // CRC16-CCITT of the sequence, size, and entries.
+  };
+
+  static constexpr size_t kChunkHeaderSize = sizeof(ChunkHeader);
+  static_assert(kChunkHeaderSize == 8);
+
+  // Each entry in a chunk is prefixed with its size.
+  static constexpr size_t kEntryHeaderSize = sizeof(uint16_t);
+
+  kvs::FlashPartition::Address SectorAddress(size_t sector) const {
+    return static_cast<kvs::FlashPartition::Address>(
+        sector * partition_.sector_size_bytes());
+  }
+
+  // Reads a chunk header, and returns whether it appears to start a chunk
+  // that fits in the sector from offset.
+  bool ReadChunkHeader(size_t sector, size_t offset, ChunkHeader& header);
+
+  // Reads the chunk's entries into buffer and checks them against the header.
+  Status ReadChunk(size_t sector,
+                   size_t offset,
+                   const ChunkHeader& header,
+                   ByteSpan buffer);
+
+  static uint16_t ChunkCrc(const ChunkHeader& header, ConstByteSpan entries);
+
+  // Erases the sector after the current one and starts writing there.
+  Status StartNextSector();
+
+  kvs::FlashPartition& partition_;
+  const ByteSpan buffer_;
+  size_t chunk_bytes_;
+
+  bool initialized_;
+  size_t sector_;      // The sector that is being written.
+  size_t offset_;      // Where the next chunk is written in the sector.
+  uint32_t sequence_;  // The sequence number of the sector being written.
+};
+
+// Reads the entries of a FlashLog that have been written to flash, from oldest
+// to newest. Entries still in the log's chunk buffer are not read. The log must
+// not be written while it is being read.
+class FlashLog::Reader {
+ public:
+  // The buffer must be as large as the log's chunk buffer.
+  Reader(FlashLog& log, ByteSpan buffer)
+      : log_(log),
+        buffer_(buffer),
+        sectors_read_(0),
+        offset_(0),
+        sector_sequence_(0),
+        chunk_(),
+        position_(0) {}
+
+  // Returns the next entry, which points into the reader's buffer and is valid
+  // until the next call.
+  //
+  // Returns:
+  //   OK - The next entry.
+  //   OUT_OF_RANGE - Every entry has been read.
+  //   FAILED_PRECONDITION - The log's Init() has not succeeded.
+  //   RESOURCE_EXHAUSTED - A chunk is too large for the reader's buffer. The
+  //       chunk is skipped.
+  //   Other errors from reading the flash partition.
+  Result<ConstByteSpan> Next();
+
+ private:
+  // Reads the next valid chunk into the buffer.
+  Status ReadNextChunk();
+
+  FlashLog& log_;
+  const ByteSpan buffer_;
+  size_t sectors_read_;
+  size_t offset_;
+  uint32_t sector_sequence_;
+  ConstByteSpan chunk_;
+  size_t position_;
+};
+
+// A FlashLog with a built-in chunk buffer.
+template <size_t kChunkSizeBytes>
+class FlashLogBuffer : public FlashLog {
+ public:
+  explicit FlashLogBuffer(kvs::FlashPartition& partition)
+      : FlashLog(partition, chunk_buffer_) {}
+
+ private:
+  std::array<std::byte, kChunkSizeBytes> chunk_buffer_;
+};
+
+}  // namespace multisink
+}  // namespace pw
@@ -14,12 +14,15 @@
 #pragma once
 
 #include <mutex>
+#include <span>
 
 #include "pw_bytes/span.h"
+#include "pw_containers/intrusive_dlist.h"
 #include "pw_multisink/config.h"
 #include "pw_result/result.h"
 #include "pw_ring_buffer/prefixed_entry_ring_buffer.h"
 #include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
 #include "pw_sync/lock_annotations.h"
 
 namespace pw {
@@ -33,12 +36,60 @@ namespace multisink {
 // PW_MULTISINK_LOCK_INTERRUPT_SAFE is disabled.
 class MultiSink {
  public:
+  // A view of an entry in the multisink's buffer, split in two if the entry
+  // wraps around the end of the buffer.
+  using EntryView = ring_buffer::PrefixedEntryRingBufferMulti::EntryView;
+
   // An asynchronous reader which is attached to a MultiSink via AttachDrain.
   // Each Drain holds a PrefixedEntryRingBufferMulti::Reader and abstracts away
   // entry sequence information for clients.
   class Drain {
    public:
-    constexpr Drain() : last_handled_sequence_id_(0), multisink_(nullptr) {}
+    // Selects the entries a drain delivers. Entries that the filter rejects
+    // are popped without being copied out, and are not counted as drops.
+    class Filter {
+     public:
+      virtual ~Filter() = default;
+
+      // Returns whether the drain should deliver `entry`, which points into
+      // the multisink's buffer. The multisink lock is held during this call,
+      // so neither the multisink nor its drains can be used during it.
+      virtual bool ShouldDeliver(const EntryView& entry) = 0;
+    };
+
+    // Counts of the entries a drain has read.
+    struct Stats {
+      // Entries returned by GetEntry or GetEntries.
+      uint32_t delivered_entries;
+
+      // Entries that the drain's filter rejected.
+      uint32_t skipped_entries;
+
+      // Entries reported as dropped through drop_count_out, because the
+      // multisink dropped them or they were overwritten before being read.
+      uint32_t dropped_entries;
+    };
+
+    constexpr Drain()
+        : last_handled_sequence_id_(0),
+          pending_drop_count_(0),
+          filter_(nullptr),
+          stats_{},
+          multisink_(nullptr) {}
+
+    // Sets the filter that selects which entries this drain delivers, or
+    // clears it if `filter` is null. Without a filter, every entry is
+    // delivered. The filter must outlive its use by the drain.
+    void set_filter(Filter* filter) PW_LOCKS_EXCLUDED(multisink_->lock_);
+
+    // Returns the number of entries this drain has delivered and skipped.
+    Stats stats() const PW_LOCKS_EXCLUDED(multisink_->lock_);
+
+    // Returns the number of bytes the entries available to this drain take up
+    // in the multisink's buffer, including the multisink's per-entry overhead.
+    //
+    // Precondition: The drain must be attached to a multisink.
+    size_t EntriesSize() PW_LOCKS_EXCLUDED(multisink_->lock_);
 
     // Returns the next available entry if it exists and acquires the latest
     // drop count in parallel.
@@ -106,6 +157,41 @@ class MultiSink {
     Result<ConstByteSpan> GetEntry(ByteSpan buffer, uint32_t& drop_count_out)
         PW_LOCKS_EXCLUDED(multisink_->lock_);
 
+    // Reads as many of the next available entries as fit in `buffer`, up to
+    // `entries_out.size()`, while holding the multisink lock once. Each entry
+    // read is returned as a span into `buffer`, in order, in `entries_out`.
+    // This is much cheaper than calling GetEntry once per entry when draining
+    // many entries.
+    //
+    // The `drop_count_out` is set as in GetEntry. It includes entries that
+    // were dropped between the entries that were read.
+    //
+    // Example Usage:
+    //
+    //   std::array<std::byte, kBatchBufferSize> buffer;
+    //   std::array<ConstByteSpan, kMaxBatchEntries> entries;
+    //   uint32_t drop_count = 0;
+    //
+    //   StatusWithSize result = drain.GetEntries(buffer, entries, drop_count);
+    //   if (drop_count > 0) {
+    //     ProcessDropCount(drop_count);
+    //   }
+    //   for (size_t i = 0; i < result.size(); ++i) {
+    //     ProcessEntry(entries[i]);
+    //   }
+    //
+    // Return values:
+    // Ok - At least one entry was read. The size is the number of entries.
+    // OutOfRange - No entries were available.
+    // FailedPrecondition - The drain must be attached to a sink.
+    // ResourceExhausted - The provided buffer was not large enough to store
+    // the next available entry, or `entries_out` is empty.
+    // DataLoss - Entries were read but did not match the expected format.
+    StatusWithSize GetEntries(ByteSpan buffer,
+                              std::span<ConstByteSpan> entries_out,
+                              uint32_t& drop_count_out)
+        PW_LOCKS_EXCLUDED(multisink_->lock_);
+
     // Drains are not copyable or movable.
     Drain(const Drain&) = delete;
     Drain& operator=(const Drain&) = delete;
@@ -115,19 +201,38 @@ class MultiSink {
    protected:
     friend MultiSink;
 
-    // The `reader_` and `last_handled_sequence_id_` are managed by attached
-    // multisink and are guarded by `multisink_->lock_` when used.
+    // The `reader_`, `last_handled_sequence_id_`, `pending_drop_count_`,
+    // `filter_`, and `stats_` are managed by attached multisink and are
+    // guarded by `multisink_->lock_` when used.
     ring_buffer::PrefixedEntryRingBufferMulti::Reader reader_;
     uint32_t last_handled_sequence_id_;
+
+    // Drops found before entries that were skipped or delivered in a batch,
+    // which have not yet been reported.
+    uint32_t pending_drop_count_;
+    Filter* filter_;
+    Stats stats_;
     MultiSink* multisink_;
   };
 
   // A pure-virtual listener of a MultiSink, attached via AttachListener.
   // MultiSink's invoke listeners when new data arrives, allowing them to
   // schedule the draining of messages out of the MultiSink.
-  class Listener : public IntrusiveList<Listener>::Item {
+  class Listener : public IntrusiveDList<Listener>::Item {
    public:
-    constexpr Listener() {}
+    // How often the listener is notified of new entries.
+    enum class Notification {
+      // Notify on every new entry or drop count.
+      kEveryEntry,
+
+      // Notify once, then not again until a drain of the multisink has read
+      // every entry available to it. This bounds the number of notifications
+      // when entries arrive faster than the listener's drains are serviced.
+      kOnceUntilDrained,
+    };
+
+    constexpr Listener(Notification notification = Notification::kEveryEntry)
+        : notification_(notification), notified_(false) {}
     virtual ~Listener() = default;
 
     // Listeners are not copyable or movable.
@@ -143,6 +248,13 @@ class MultiSink {
     // available. The multisink lock is held during this call, so neither the
     // multisink nor it's drains can be used during this callback.
     virtual void OnNewEntryAvailable() = 0;
+
+   private:
+    const Notification notification_;
+
+    // Whether a kOnceUntilDrained listener has been notified since a drain
+    // last caught up. Guarded by the attached multisink's lock.
+    bool notified_;
   };
 
   // Constructs a multisink using a ring buffer backed by the provided buffer.
@@ -185,7 +297,8 @@ class MultiSink {
 
   // Attach a listener to the multisink. Entries pushed before the listener was
   // attached are not seen by the listener, so listeners should be attached
-  // before entries are pushed. Listeners are invoked on all new messages.
+  // before entries are pushed. Listeners are invoked on all new messages,
+  // unless they are throttled with Notification::kOnceUntilDrained.
   //
   // Precondition: The listener must not be attached to a multisink.
   void AttachListener(Listener& listener) PW_LOCKS_EXCLUDED(lock_);
@@ -217,11 +330,38 @@ class MultiSink {
                                  uint32_t& drop_count_out)
       PW_LOCKS_EXCLUDED(lock_);
 
+  // Reads a batch of entries from the provided drain. See Drain::GetEntries.
+  StatusWithSize GetEntries(Drain& drain,
+                            ByteSpan buffer,
+                            std::span<ConstByteSpan> entries_out,
+                            uint32_t& drop_count_out) PW_LOCKS_EXCLUDED(lock_);
+
  private:
   // Notifies attached listeners of new entries or an updated drop count.
   void NotifyListeners() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
-  IntrusiveList<Listener> listeners_ PW_GUARDED_BY(lock_);
+  // Pops the entries at the front of the drain that its filter rejects.
+  void SkipFilteredEntries(Drain& drain) PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Reads entries one at a time for a drain with a filter, so that entries
+  // between the delivered ones can be skipped.
+  StatusWithSize GetFilteredEntries(Drain& drain,
+                                    ByteSpan buffer,
+                                    std::span<ConstByteSpan> entries_out,
+                                    uint32_t& drop_count_out)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Marks the entry with `sequence_id` as handled by the drain, and holds on
+  // to the number of entries dropped before it until they are reported.
+  void HandleSequenceId(Drain& drain, uint32_t sequence_id)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Allows throttled listeners to be notified again once the drain has read
+  // every entry available to it.
+  void RearmListenersIfCaughtUp(Drain& drain)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  IntrusiveDList<Listener> listeners_ PW_GUARDED_BY(lock_);
   ring_buffer::PrefixedEntryRingBufferMulti ring_buffer_ PW_GUARDED_BY(lock_);
   uint32_t sequence_id_ PW_GUARDED_BY(lock_);
   LockType lock_;
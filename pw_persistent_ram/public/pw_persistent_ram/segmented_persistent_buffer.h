@@ -0,0 +1,169 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_checksum/crc16_ccitt.h"
+#include "pw_preprocessor/compiler.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+
+namespace pw::persistent_ram {
+
+// A SegmentedPersistentBufferWriter appends to a SegmentedPersistentBuffer,
+// updating the running checksum of each segment it writes to. Like
+// PersistentBufferWriter, it should NOT be stored in persistent RAM, and only
+// one should be open at a given time.
+class SegmentedPersistentBufferWriter : public stream::Writer {
+ public:
+  SegmentedPersistentBufferWriter() = delete;
+
+  size_t ConservativeWriteLimit() const override {
+    return buffer_.size_bytes() - size_;
+  }
+
+ private:
+  template <size_t, size_t>
+  friend class SegmentedPersistentBuffer;
+
+  SegmentedPersistentBufferWriter(ByteSpan buffer,
+                                  size_t segment_size,
+                                  std::span<volatile uint16_t> checksums,
+                                  volatile size_t& size)
+      : buffer_(buffer),
+        segment_size_(segment_size),
+        checksums_(checksums),
+        size_(size) {}
+
+  Status DoWrite(ConstByteSpan data) override;
+
+  ByteSpan buffer_;
+  size_t segment_size_;
+  std::span<volatile uint16_t> checksums_;
+  volatile size_t& size_;
+};
+
+PW_MODIFY_DIAGNOSTICS_PUSH();
+PW_MODIFY_DIAGNOSTIC(ignored, "-Wuninitialized");
+PW_MODIFY_DIAGNOSTIC_GCC(ignored, "-Wmaybe-uninitialized");
+
+// A SegmentedPersistentBuffer is a PersistentBuffer that keeps a separate
+// CRC16 for each kSegmentSizeBytes of data, rather than one for all of it.
+//
+// Each write only checksums the data it appends, as with PersistentBuffer.
+// Reading differs: corruption of the data, such as from a brownout or a write
+// interrupted by a reset, only invalidates the segments it touches, so the
+// rest of a large crash log can still be recovered. Checking one segment also
+// only reads that segment.
+template <size_t kMaxSizeBytes, size_t kSegmentSizeBytes>
+class SegmentedPersistentBuffer {
+ public:
+  static_assert(kSegmentSizeBytes > 0u);
+  static_assert(kMaxSizeBytes >= kSegmentSizeBytes);
+
+  static constexpr size_t kMaxSegments =
+      (kMaxSizeBytes + kSegmentSizeBytes - 1) / kSegmentSizeBytes;
+
+  // As with PersistentBuffer, the constructor intentionally does not
+  // initialize anything, so that the contents persist across resets.
+  SegmentedPersistentBuffer() {}
+  SegmentedPersistentBuffer(const SegmentedPersistentBuffer&) = delete;
+  SegmentedPersistentBuffer(SegmentedPersistentBuffer&&) = delete;
+  ~SegmentedPersistentBuffer() {}
+
+  // Returns a writer that appends to the buffer. Clears the buffer if it does
+  // not have a value.
+  SegmentedPersistentBufferWriter GetWriter() {
+    if (!has_value()) {
+      clear();
+    }
+    return SegmentedPersistentBufferWriter(
+        ByteSpan(const_cast<std::byte*>(buffer_), kMaxSizeBytes),
+        kSegmentSizeBytes,
+        std::span<volatile uint16_t>(checksums_),
+        size_);
+  }
+
+  // Returns the number of bytes written, or 0 if there is no value. Segments
+  // after the first may still be corrupt; see segment_valid() and
+  // valid_size().
+  size_t size() const { return has_value() ? size_ : 0; }
+
+  const std::byte* data() const { return const_cast<std::byte*>(buffer_); }
+
+  void clear() { size_ = 0; }
+
+  // True if the size is in range and the first segment is valid. Only the
+  // first segment is checked.
+  bool has_value() const {
+    return size_ != 0u && size_ <= kMaxSizeBytes && SegmentValid(0);
+  }
+
+  // Returns the number of segments data has been written to.
+  size_t segment_count() const {
+    return (size() + kSegmentSizeBytes - 1) / kSegmentSizeBytes;
+  }
+
+  // Returns the data in a segment. The last segment may be partially filled.
+  ConstByteSpan segment(size_t index) const {
+    return has_value() ? Segment(index) : ConstByteSpan();
+  }
+
+  // True if the segment's data matches its checksum.
+  bool segment_valid(size_t index) const {
+    return has_value() && SegmentValid(index);
+  }
+
+  // Returns the number of bytes before the first corrupt segment.
+  size_t valid_size() const {
+    const size_t count = segment_count();
+    size_t valid = 0;
+    for (size_t i = 0; i < count && SegmentValid(i); ++i) {
+      valid += Segment(i).size();
+    }
+    return valid;
+  }
+
+ private:
+  // These check the size on each call, since it is in persistent RAM.
+  ConstByteSpan Segment(size_t index) const {
+    const size_t start = index * kSegmentSizeBytes;
+    const size_t size = size_;
+    if (size > kMaxSizeBytes || start >= size) {
+      return ConstByteSpan();
+    }
+    return ConstByteSpan(data() + start,
+                         std::min(kSegmentSizeBytes, size - start));
+  }
+
+  bool SegmentValid(size_t index) const {
+    const ConstByteSpan data = Segment(index);
+    return !data.empty() &&
+           checksums_[index] == checksum::Crc16Ccitt::Calculate(data);
+  }
+
+  // None of these members are initialized by the constructor by design.
+  volatile size_t size_;
+  volatile uint16_t checksums_[kMaxSegments];
+  volatile std::byte buffer_[kMaxSizeBytes];
+};
+
+PW_MODIFY_DIAGNOSTICS_POP();
+
+}  // namespace pw::persistent_ram
@@ -0,0 +1,58 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_persistent_ram/segmented_persistent_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace pw::persistent_ram {
+
+Status SegmentedPersistentBufferWriter::DoWrite(ConstByteSpan data) {
+  if (ConservativeWriteLimit() == 0) {
+    return Status::OutOfRange();
+  }
+  if (ConservativeWriteLimit() < data.size_bytes()) {
+    return Status::ResourceExhausted();
+  }
+  if (data.empty()) {
+    return OkStatus();
+  }
+
+  size_t offset = size_;
+  std::memcpy(buffer_.data() + offset, data.data(), data.size_bytes());
+
+  // Continue the running checksum of each segment the data was written to,
+  // starting over at the start of a segment.
+  const size_t end = offset + data.size_bytes();
+  while (offset < end) {
+    const size_t segment = offset / segment_size_;
+    const size_t segment_offset = offset % segment_size_;
+    const size_t chunk_size = std::min(segment_size_ - segment_offset,
+                                       end - offset);
+
+    checksums_[segment] = checksum::Crc16Ccitt::Calculate(
+        ByteSpan(buffer_.data() + offset, chunk_size),
+        segment_offset == 0u ? checksum::Crc16Ccitt::kInitialValue
+                             : checksums_[segment]);
+    offset += chunk_size;
+  }
+
+  // Update the size last. A reset during the write invalidates, at most, the
+  // segment that was being written when the write started.
+  size_ = end;
+  return OkStatus();
+}
+
+}  // namespace pw::persistent_ram
@@ -0,0 +1,164 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_persistent_ram/segmented_persistent_buffer.h"
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/span.h"
+#include "pw_random/xor_shift.h"
+
+namespace pw::persistent_ram {
+namespace {
+
+class SegmentedPersistentBufferTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kBufferSize = 256;
+  static constexpr size_t kSegmentSize = 64;
+  using Buffer = SegmentedPersistentBuffer<kBufferSize, kSegmentSize>;
+
+  SegmentedPersistentBufferTest() { ZeroPersistentMemory(); }
+
+  // Emulate invalidation of persistent section(s).
+  void ZeroPersistentMemory() { memset(buffer_, 0, sizeof(buffer_)); }
+  void RandomFillMemory() {
+    random::XorShiftStarRng64 rng(0x9ad75);
+    StatusWithSize sws = rng.Get(buffer_);
+    ASSERT_TRUE(sws.ok());
+    ASSERT_EQ(sws.size(), sizeof(buffer_));
+  }
+
+  Buffer& GetPersistentBuffer() { return *(new (buffer_) Buffer()); }
+
+  // Corrupts a byte of data, as a brownout might.
+  void Corrupt(Buffer& persistent, size_t offset) {
+    const_cast<std::byte*>(persistent.data())[offset] ^= std::byte{0x01};
+  }
+
+  // Writes 0, 1, 2, ... in writes of the provided size.
+  void WriteSequence(Buffer& persistent, size_t size, size_t write_size) {
+    auto writer = persistent.GetWriter();
+    for (size_t i = 0; i < size; i += write_size) {
+      std::byte chunk[kBufferSize];
+      const size_t chunk_size = std::min(write_size, size - i);
+      for (size_t j = 0; j < chunk_size; ++j) {
+        chunk[j] = static_cast<std::byte>(i + j);
+      }
+      ASSERT_EQ(OkStatus(), writer.Write(std::span(chunk, chunk_size)));
+    }
+  }
+
+  alignas(Buffer) std::byte buffer_[sizeof(Buffer)];
+};
+
+TEST_F(SegmentedPersistentBufferTest, ZeroedMemory_IsEmpty) {
+  auto& persistent = GetPersistentBuffer();
+  EXPECT_FALSE(persistent.has_value());
+  EXPECT_EQ(0u, persistent.size());
+  EXPECT_EQ(0u, persistent.segment_count());
+  EXPECT_EQ(0u, persistent.valid_size());
+}
+
+TEST_F(SegmentedPersistentBufferTest, RandomMemory_IsEmpty) {
+  RandomFillMemory();
+  auto& persistent = GetPersistentBuffer();
+  EXPECT_FALSE(persistent.has_value());
+  EXPECT_EQ(0u, persistent.size());
+}
+
+TEST_F(SegmentedPersistentBufferTest, Write_PersistsAcrossReboot) {
+  {
+    auto& persistent = GetPersistentBuffer();
+    WriteSequence(persistent, 150, 7);
+    persistent.~SegmentedPersistentBuffer();
+  }
+
+  auto& persistent = GetPersistentBuffer();
+  ASSERT_TRUE(persistent.has_value());
+  EXPECT_EQ(150u, persistent.size());
+  EXPECT_EQ(3u, persistent.segment_count());
+  EXPECT_EQ(150u, persistent.valid_size());
+  EXPECT_EQ(22u, persistent.segment(2).size());
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_TRUE(persistent.segment_valid(i));
+  }
+  EXPECT_EQ(std::byte{149}, persistent.data()[149]);
+}
+
+TEST_F(SegmentedPersistentBufferTest, ChecksumsMatchForAnyWriteSize) {
+  for (size_t write_size : {1u, 13u, 64u, 100u, 256u}) {
+    auto& persistent = GetPersistentBuffer();
+    persistent.clear();
+    WriteSequence(persistent, kBufferSize, write_size);
+    EXPECT_EQ(kBufferSize, persistent.valid_size());
+  }
+}
+
+TEST_F(SegmentedPersistentBufferTest, Corruption_OnlyLosesAffectedSegment) {
+  auto& persistent = GetPersistentBuffer();
+  WriteSequence(persistent, 200, 32);
+
+  Corrupt(persistent, 70);
+
+  ASSERT_TRUE(persistent.has_value());
+  EXPECT_TRUE(persistent.segment_valid(0));
+  EXPECT_FALSE(persistent.segment_valid(1));
+  EXPECT_TRUE(persistent.segment_valid(2));
+  EXPECT_TRUE(persistent.segment_valid(3));
+  EXPECT_EQ(kSegmentSize, persistent.valid_size());
+}
+
+TEST_F(SegmentedPersistentBufferTest, FirstSegmentCorrupt_NoValue) {
+  auto& persistent = GetPersistentBuffer();
+  WriteSequence(persistent, 100, 10);
+
+  Corrupt(persistent, 0);
+
+  EXPECT_FALSE(persistent.has_value());
+  EXPECT_EQ(0u, persistent.size());
+
+  // Getting a writer starts over.
+  auto writer = persistent.GetWriter();
+  EXPECT_EQ(kBufferSize, writer.ConservativeWriteLimit());
+}
+
+TEST_F(SegmentedPersistentBufferTest, AppendAfterReboot) {
+  WriteSequence(GetPersistentBuffer(), 90, 30);
+
+  auto& persistent = GetPersistentBuffer();
+  auto writer = persistent.GetWriter();
+  EXPECT_EQ(kBufferSize - 90, writer.ConservativeWriteLimit());
+
+  std::byte data[50] = {};
+  ASSERT_EQ(OkStatus(), writer.Write(data));
+  EXPECT_EQ(140u, persistent.valid_size());
+}
+
+TEST_F(SegmentedPersistentBufferTest, Full_WriteFails) {
+  auto& persistent = GetPersistentBuffer();
+  auto writer = persistent.GetWriter();
+
+  std::byte data[kBufferSize - 1] = {};
+  ASSERT_EQ(OkStatus(), writer.Write(data));
+  EXPECT_EQ(Status::ResourceExhausted(), writer.Write(std::span(data, 2)));
+  ASSERT_EQ(OkStatus(), writer.Write(std::span(data, 1)));
+  EXPECT_EQ(Status::OutOfRange(), writer.Write(std::span(data, 1)));
+  EXPECT_EQ(kBufferSize, persistent.valid_size());
+}
+
+}  // namespace
+}  // namespace pw::persistent_ram
@@ -0,0 +1,145 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures the cost of encoding and decoding a large repeated uint32 field,
+// such as an array of telemetry samples. Each repeated value is written and
+// read individually and as a packed field, and the time per value is logged.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/streaming_encoder.h"
+
+namespace {
+
+constexpr uint32_t kField = 1;
+constexpr size_t kValues = 2048;
+constexpr size_t kIterations = 200;
+constexpr int64_t kTotalValues = kValues * kIterations;
+
+std::array<uint32_t, kValues> values;
+std::array<uint32_t, kValues> decoded;
+std::array<float, kValues> float_values;
+std::array<float, kValues> decoded_floats;
+
+// Large enough for every value as an unpacked field with a 5-byte varint.
+std::array<std::byte, kValues * 6> encoded;
+
+template <typename Function>
+void Measure(const char* name, Function function) {
+  const auto start = pw::chrono::SystemClock::now();
+  for (size_t i = 0; i < kIterations; ++i) {
+    function();
+  }
+  const auto elapsed = pw::chrono::SystemClock::now() - start;
+
+  const auto picoseconds =
+      std::chrono::duration_cast<std::chrono::duration<int64_t, std::pico>>(
+          elapsed);
+  PW_LOG_INFO("%-24s %8ld ps/value",
+              name,
+              static_cast<long>(picoseconds.count() / kTotalValues));
+}
+
+size_t EncodeRepeated() {
+  pw::protobuf::MemoryEncoder encoder(encoded);
+  for (uint32_t value : values) {
+    encoder.WriteUint32(kField, value);
+  }
+  PW_CHECK_OK(encoder.status());
+  return encoder.size();
+}
+
+size_t EncodePacked() {
+  pw::protobuf::MemoryEncoder encoder(encoded);
+  encoder.WritePackedUint32(kField, values);
+  PW_CHECK_OK(encoder.status());
+  return encoder.size();
+}
+
+size_t EncodePackedFloat() {
+  pw::protobuf::MemoryEncoder encoder(encoded);
+  encoder.WritePackedFloat(kField, float_values);
+  PW_CHECK_OK(encoder.status());
+  return encoder.size();
+}
+
+void DecodeRepeated(pw::ConstByteSpan proto) {
+  pw::protobuf::Decoder decoder(proto);
+  size_t count = 0;
+  while (decoder.Next().ok()) {
+    PW_CHECK_OK(decoder.ReadUint32(&decoded[count++]));
+  }
+  PW_CHECK_UINT_EQ(count, kValues);
+}
+
+template <typename T>
+void DecodePacked(pw::ConstByteSpan proto,
+                  std::array<T, kValues>& out,
+                  pw::StatusWithSize (pw::protobuf::Decoder::*read)(
+                      std::span<T>)) {
+  pw::protobuf::Decoder decoder(proto);
+  PW_CHECK_OK(decoder.Next());
+  const pw::StatusWithSize result = (decoder.*read)(out);
+  PW_CHECK_OK(result.status());
+  PW_CHECK_UINT_EQ(result.size(), kValues);
+}
+
+}  // namespace
+
+int main() {
+  uint32_t value = 1;
+  for (size_t i = 0; i < kValues; ++i) {
+    value = value * 1103515245u + 12345u;
+    values[i] = value >> (i % 32);  // Mix of varint sizes.
+    float_values[i] = static_cast<float>(value);
+  }
+
+  PW_LOG_INFO("Encoding and decoding %u uint32 values %u times",
+              static_cast<unsigned>(kValues),
+              static_cast<unsigned>(kIterations));
+
+  const size_t repeated_size = EncodeRepeated();
+  Measure("encode repeated", EncodeRepeated);
+  Measure("decode repeated", [repeated_size] {
+    DecodeRepeated(pw::ConstByteSpan(encoded.data(), repeated_size));
+  });
+  PW_CHECK(decoded == values);
+
+  const size_t packed_size = EncodePacked();
+  Measure("encode packed", EncodePacked);
+  Measure("decode packed", [packed_size] {
+    DecodePacked(pw::ConstByteSpan(encoded.data(), packed_size),
+                 decoded,
+                 &pw::protobuf::Decoder::ReadPackedUint32);
+  });
+  PW_CHECK(decoded == values);
+
+  const size_t packed_float_size = EncodePackedFloat();
+  Measure("encode packed float", EncodePackedFloat);
+  Measure("decode packed float", [packed_float_size] {
+    DecodePacked(pw::ConstByteSpan(encoded.data(), packed_float_size),
+                 decoded_floats,
+                 &pw::protobuf::Decoder::ReadPackedFloat);
+  });
+  PW_CHECK(decoded_floats == float_values);
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Encodes and decodes a small message with the field types most messages use:
+// varints, a string, and a bytes field.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_benchmark/benchmark.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/streaming_encoder.h"
+
+namespace pw::protobuf {
+namespace {
+
+using benchmark::DoNotOptimize;
+using benchmark::State;
+
+enum Field : uint32_t {
+  kId = 1,
+  kTimestamp = 2,
+  kName = 3,
+  kPayload = 4,
+  kFlags = 5,
+};
+
+constexpr std::string_view kNameValue = "temperature_sensor";
+constexpr std::array<std::byte, 32> kPayloadValue = {};
+
+std::array<std::byte, 128> encoded;
+
+StatusWithSize EncodeMessage() {
+  MemoryEncoder encoder(encoded);
+  encoder.WriteUint32(kId, 1234);
+  encoder.WriteUint64(kTimestamp, 0x1'2345'6789);
+  encoder.WriteString(kName, kNameValue);
+  encoder.WriteBytes(kPayload, kPayloadValue);
+  encoder.WriteUint32(kFlags, 0x81);
+  return StatusWithSize(encoder.status(), encoder.size());
+}
+
+PW_BENCHMARK(Protobuf, Encode) {
+  for (auto _ : state) {
+    DoNotOptimize(EncodeMessage());
+    DoNotOptimize(encoded);
+  }
+}
+
+PW_BENCHMARK(Protobuf, Decode) {
+  const StatusWithSize size = EncodeMessage();
+  ASSERT_EQ(OkStatus(), size.status());
+  const ConstByteSpan message(encoded.data(), size.size());
+
+  uint32_t id = 0;
+  uint64_t timestamp = 0;
+  std::string_view name;
+  ConstByteSpan payload;
+  uint32_t flags = 0;
+
+  for (auto _ : state) {
+    DoNotOptimize(encoded);
+    Decoder decoder(message);
+    while (decoder.Next().ok()) {
+      switch (decoder.FieldNumber()) {
+        case kId:
+          decoder.ReadUint32(&id);
+          break;
+        case kTimestamp:
+          decoder.ReadUint64(&timestamp);
+          break;
+        case kName:
+          decoder.ReadString(&name);
+          break;
+        case kPayload:
+          decoder.ReadBytes(&payload);
+          break;
+        case kFlags:
+          decoder.ReadUint32(&flags);
+          break;
+      }
+    }
+    DoNotOptimize(id);
+    DoNotOptimize(timestamp);
+    DoNotOptimize(name);
+    DoNotOptimize(payload);
+    DoNotOptimize(flags);
+  }
+
+  EXPECT_EQ(name, kNameValue);
+  EXPECT_EQ(flags, 0x81u);
+}
+
+}  // namespace
+}  // namespace pw::protobuf
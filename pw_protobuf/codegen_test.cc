@@ -15,6 +15,7 @@
 
 #include "gtest/gtest.h"
 #include "pw_protobuf/encoder.h"
+#include "pw_protobuf/serialized_size.h"
 #include "pw_stream/memory_stream.h"
 
 // These header files contain the code generated by the pw_protobuf plugin.
@@ -365,5 +366,20 @@ TEST(Codegen, NonPigweedPackage) {
   EXPECT_EQ(encoder.Encode().status(), OkStatus());
 }
 
+TEST(Codegen, MaxEncodedSize) {
+  // Two uint32 fields, each a one-byte key and a varint of up to five bytes.
+  static_assert(Struct::kMaxEncodedSizeBytes == 12u);
+  std::byte buffer[Struct::kMaxEncodedSizeBytes];
+  Struct::RamEncoder encoder(buffer);
+  encoder.WriteOne(0xffffffff);
+  encoder.WriteTwo(0xffffffff);
+  EXPECT_EQ(encoder.status(), OkStatus());
+  EXPECT_EQ(encoder.size(), sizeof(buffer));
+
+  // Strings and repeated fields have no limit without a .options file.
+  static_assert(KeyValuePair::kMaxEncodedSizeBytes == kMaxSizeUnbounded);
+  static_assert(RepeatedTest::kMaxEncodedSizeBytes == kMaxSizeUnbounded);
+}
+
 }  // namespace
 }  // namespace pw::protobuf
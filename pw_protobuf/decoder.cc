@@ -231,6 +231,26 @@ Status Decoder::ReadDelimited(std::span<const std::byte>* out) {
   return OkStatus();
 }
 
+Status Decoder::PeekPacked(std::span<const std::byte>* payload,
+                           size_t* field_size) {
+  uint64_t key;
+  const size_t key_size = varint::Decode(proto_, &key);
+  if (key_size == 0 ||
+      static_cast<WireType>(key & kWireTypeMask) != WireType::kDelimited) {
+    return Status::FailedPrecondition();
+  }
+
+  uint64_t length;
+  const size_t length_size = varint::Decode(proto_.subspan(key_size), &length);
+  if (length_size == 0 || proto_.size() - key_size - length_size < length) {
+    return Status::DataLoss();
+  }
+
+  *payload = proto_.subspan(key_size + length_size, length);
+  *field_size = key_size + length_size + length;
+  return OkStatus();
+}
+
 Status CallbackDecoder::Decode(std::span<const std::byte> proto) {
   if (handler_ == nullptr || state_ != kReady) {
     return Status::FailedPrecondition();
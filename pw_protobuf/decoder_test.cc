@@ -156,6 +156,142 @@ TEST(Decoder, Decode_SkipsUnusedFields) {
   EXPECT_EQ(decoder.Next(), Status::OutOfRange());
 }
 
+TEST(Decoder, ReadPackedUint32) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=packed uint32, k=1, v={0, 50, 100, 150, 200}
+    0x0a, 0x07, 0x00, 0x32, 0x64, 0x96, 0x01, 0xc8, 0x01,
+    // type=int32, k=2, v=42
+    0x10, 0x2a,
+  };
+  // clang-format on
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 1u);
+
+  uint32_t values[8] = {};
+  StatusWithSize result = decoder.ReadPackedUint32(values);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 5u);
+  EXPECT_EQ(values[0], 0u);
+  EXPECT_EQ(values[1], 50u);
+  EXPECT_EQ(values[2], 100u);
+  EXPECT_EQ(values[3], 150u);
+  EXPECT_EQ(values[4], 200u);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 2u);
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(Decoder, ReadPackedInt32AndSint32) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=packed int32, k=1, v={-1, 1}
+    0x0a, 0x0b,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01, 0x01,
+    // type=packed sint32, k=2, v={-1, 1, -13}
+    0x12, 0x03, 0x01, 0x02, 0x19,
+  };
+  // clang-format on
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+  int32_t values[4] = {};
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  StatusWithSize result = decoder.ReadPackedInt32(values);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 2u);
+  EXPECT_EQ(values[0], -1);
+  EXPECT_EQ(values[1], 1);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  result = decoder.ReadPackedSint32(values);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 3u);
+  EXPECT_EQ(values[0], -1);
+  EXPECT_EQ(values[1], 1);
+  EXPECT_EQ(values[2], -13);
+}
+
+TEST(Decoder, ReadPackedFixed) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=packed fixed32, k=1, v={1, 0xdeadbeef}
+    0x0a, 0x08, 0x01, 0x00, 0x00, 0x00, 0xef, 0xbe, 0xad, 0xde,
+    // type=packed double, k=2, v={3.14159}
+    0x12, 0x08, 0x6e, 0x86, 0x1b, 0xf0, 0xf9, 0x21, 0x09, 0x40,
+  };
+  // clang-format on
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  uint32_t fixed[2] = {};
+  StatusWithSize result = decoder.ReadPackedFixed32(fixed);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 2u);
+  EXPECT_EQ(fixed[0], 1u);
+  EXPECT_EQ(fixed[1], 0xdeadbeef);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  double doubles[1] = {};
+  result = decoder.ReadPackedDouble(doubles);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(doubles[0], 3.14159);
+}
+
+TEST(Decoder, ReadPacked_OutputTooSmall) {
+  constexpr uint8_t encoded_proto[] = {
+      0x0a, 0x08, 0x01, 0x00, 0x00, 0x00, 0xef, 0xbe, 0xad, 0xde};
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+  ASSERT_EQ(decoder.Next(), OkStatus());
+
+  uint32_t values[1] = {};
+  EXPECT_EQ(decoder.ReadPackedFixed32(values).status(),
+            Status::ResourceExhausted());
+  EXPECT_EQ(decoder.ReadPackedUint32(values).status(),
+            Status::ResourceExhausted());
+
+  // The field was not consumed, so it can be read again.
+  uint32_t larger[2] = {};
+  EXPECT_EQ(decoder.ReadPackedFixed32(larger).status(), OkStatus());
+}
+
+TEST(Decoder, ReadPacked_Errors) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=uint32, k=1, v=1 (not packed)
+    0x08, 0x01,
+    // type=packed fixed32, k=2, with 3 bytes
+    0x12, 0x03, 0x01, 0x02, 0x03,
+    // type=packed uint32, k=3, v={0x100000000}
+    0x1a, 0x05, 0x80, 0x80, 0x80, 0x80, 0x10,
+  };
+  // clang-format on
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+  uint32_t values[4] = {};
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.ReadPackedUint32(values).status(),
+            Status::FailedPrecondition());
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.ReadPackedFixed32(values).status(), Status::DataLoss());
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.ReadPackedUint32(values).status(), Status::OutOfRange());
+
+  uint64_t values64[1] = {};
+  StatusWithSize result = decoder.ReadPackedUint64(values64);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(values64[0], 0x100000000u);
+}
+
 TEST(CallbackDecoder, Decode) {
   CallbackDecoder decoder;
   TestDecodeHandler handler;
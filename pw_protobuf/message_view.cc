@@ -0,0 +1,141 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_protobuf/message_view.h"
+
+#include "pw_protobuf/wire_format.h"
+#include "pw_varint/varint.h"
+
+namespace pw::protobuf {
+namespace {
+
+// Returns the size of the field at the start of the data, including its key,
+// or 0 if the field is malformed. Sets field_number to the field's number.
+size_t FieldSize(std::span<const std::byte> data, uint32_t& field_number) {
+  uint64_t key;
+  const size_t key_size = varint::Decode(data, &key);
+  if (key_size == 0u || key > UINT32_MAX) {
+    return 0;
+  }
+  field_number = static_cast<uint32_t>(key) >> kFieldNumberShift;
+  if (!ValidFieldNumber(field_number)) {
+    return 0;
+  }
+
+  const std::span<const std::byte> remainder = data.subspan(key_size);
+  uint64_t value;
+  size_t value_size;
+
+  switch (static_cast<WireType>(key & kWireTypeMask)) {
+    case WireType::kVarint:
+      value_size = varint::Decode(remainder, &value);
+      if (value_size == 0u) {
+        return 0;
+      }
+      break;
+    case WireType::kDelimited: {
+      const size_t length_size = varint::Decode(remainder, &value);
+      if (length_size == 0u || remainder.size() - length_size < value) {
+        return 0;
+      }
+      value_size = length_size + static_cast<size_t>(value);
+      break;
+    }
+    case WireType::kFixed32:
+      value_size = sizeof(uint32_t);
+      break;
+    case WireType::kFixed64:
+      value_size = sizeof(uint64_t);
+      break;
+    default:
+      return 0;
+  }
+
+  if (remainder.size() < value_size) {
+    return 0;
+  }
+  return key_size + value_size;
+}
+
+}  // namespace
+
+Result<std::span<const std::byte>> MessageViewBase::FindField(
+    uint32_t field_number) {
+  if (state_ == kNotIndexed) {
+    BuildIndex();
+  }
+  if (state_ == kMalformed) {
+    return Status::DataLoss();
+  }
+
+  for (size_t i = 0; i < indexed_fields_; ++i) {
+    if (index_[i].field_number == field_number) {
+      return proto_.subspan(index_[i].offset);
+    }
+  }
+
+  return FindUnindexed(field_number);
+}
+
+void MessageViewBase::BuildIndex() {
+  size_t offset = 0;
+  unindexed_offset_ = proto_.size();
+
+  while (offset < proto_.size()) {
+    uint32_t field_number;
+    const size_t size = FieldSize(proto_.subspan(offset), field_number);
+    if (size == 0u) {
+      state_ = kMalformed;
+      return;
+    }
+
+    size_t i = 0;
+    while (i < indexed_fields_ && index_[i].field_number != field_number) {
+      ++i;
+    }
+
+    if (i < indexed_fields_) {
+      index_[i].offset = static_cast<uint32_t>(offset);  // Last one wins.
+    } else if (indexed_fields_ < index_.size()) {
+      index_[indexed_fields_++] = {field_number, static_cast<uint32_t>(offset)};
+    } else if (unindexed_offset_ == proto_.size()) {
+      unindexed_offset_ = offset;  // The index is full.
+    }
+
+    offset += size;
+  }
+
+  state_ = kIndexed;
+}
+
+Result<std::span<const std::byte>> MessageViewBase::FindUnindexed(
+    uint32_t field_number) const {
+  // The message was validated when it was indexed.
+  std::span<const std::byte> found;
+  for (size_t offset = unindexed_offset_; offset < proto_.size();) {
+    uint32_t number;
+    const size_t size = FieldSize(proto_.subspan(offset), number);
+    if (number == field_number) {
+      found = proto_.subspan(offset);
+    }
+    offset += size;
+  }
+
+  if (found.empty()) {
+    return Status::NotFound();
+  }
+  return found;
+}
+
+}  // namespace pw::protobuf
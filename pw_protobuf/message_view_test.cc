@@ -0,0 +1,106 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_protobuf/message_view.h"
+
+#include "gtest/gtest.h"
+
+namespace pw::protobuf {
+namespace {
+
+// clang-format off
+constexpr uint8_t kEncodedProto[] = {
+  // type=int32, k=1, v=42
+  0x08, 0x2a,
+  // type=sint32, k=2, v=-13
+  0x10, 0x19,
+  // type=bool, k=3, v=true
+  0x18, 0x01,
+  // type=double, k=4, v=3.14159
+  0x21, 0x6e, 0x86, 0x1b, 0xf0, 0xf9, 0x21, 0x09, 0x40,
+  // type=fixed32, k=5, v=0xdeadbeef
+  0x2d, 0xef, 0xbe, 0xad, 0xde,
+  // type=string, k=6, v="Hello world"
+  0x32, 0x0b, 'H', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd',
+  // type=int32, k=1, v=43 (overrides the first value)
+  0x08, 0x2b,
+  // type=message, k=7, v={type=uint32, k=1, v=5}
+  0x3a, 0x02, 0x08, 0x05,
+};
+// clang-format on
+
+TEST(MessageView, ReadFields) {
+  MessageView<8> view(std::as_bytes(std::span(kEncodedProto)));
+
+  EXPECT_EQ(view.ReadSint32(2).value(), -13);
+  EXPECT_TRUE(view.ReadBool(3).value());
+  EXPECT_EQ(view.ReadDouble(4).value(), 3.14159);
+  EXPECT_EQ(view.ReadFixed32(5).value(), 0xdeadbeef);
+  EXPECT_EQ(view.ReadString(6).value(), "Hello world");
+}
+
+TEST(MessageView, LastValueWins) {
+  MessageView<8> view(std::as_bytes(std::span(kEncodedProto)));
+  EXPECT_EQ(view.ReadInt32(1).value(), 43);
+}
+
+TEST(MessageView, NestedMessage) {
+  MessageView<8> view(std::as_bytes(std::span(kEncodedProto)));
+
+  Result<std::span<const std::byte>> nested = view.ReadBytes(7);
+  ASSERT_EQ(nested.status(), OkStatus());
+
+  MessageView<1> nested_view(nested.value());
+  EXPECT_EQ(nested_view.ReadUint32(1).value(), 5u);
+}
+
+TEST(MessageView, MissingField) {
+  MessageView<8> view(std::as_bytes(std::span(kEncodedProto)));
+  EXPECT_FALSE(view.Has(8));
+  EXPECT_EQ(view.ReadUint32(8).status(), Status::NotFound());
+  EXPECT_TRUE(view.Has(6));
+}
+
+TEST(MessageView, WrongWireType) {
+  MessageView<8> view(std::as_bytes(std::span(kEncodedProto)));
+  EXPECT_EQ(view.ReadString(1).status(), Status::FailedPrecondition());
+}
+
+TEST(MessageView, MoreFieldsThanIndex) {
+  MessageView<2> view(std::as_bytes(std::span(kEncodedProto)));
+
+  // Fields 1 and 2 are indexed; the rest are found by scanning the tail.
+  EXPECT_EQ(view.ReadInt32(1).value(), 43);
+  EXPECT_EQ(view.ReadSint32(2).value(), -13);
+  EXPECT_EQ(view.ReadString(6).value(), "Hello world");
+  EXPECT_EQ(view.ReadFixed32(5).value(), 0xdeadbeef);
+  EXPECT_EQ(view.ReadUint32(9).status(), Status::NotFound());
+}
+
+TEST(MessageView, Empty) {
+  MessageView<1> view(std::span<const std::byte>{});
+  EXPECT_EQ(view.ReadUint32(1).status(), Status::NotFound());
+}
+
+TEST(MessageView, Malformed) {
+  // type=string, k=6, length 11 with only 2 bytes
+  constexpr uint8_t encoded_proto[] = {0x08, 0x01, 0x32, 0x0b, 'H', 'e'};
+
+  MessageView<4> view(std::as_bytes(std::span(encoded_proto)));
+  EXPECT_EQ(view.ReadUint32(1).status(), Status::DataLoss());
+  EXPECT_EQ(view.ReadString(6).status(), Status::DataLoss());
+}
+
+}  // namespace
+}  // namespace pw::protobuf
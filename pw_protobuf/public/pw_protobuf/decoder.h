@@ -13,11 +13,18 @@
 // the License.
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
 #include <span>
 #include <string_view>
+#include <type_traits>
 
 #include "pw_protobuf/wire_format.h"
 #include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
 #include "pw_varint/varint.h"
 
 // This file defines a low-level event-based protobuf wire format decoder.
@@ -133,6 +140,74 @@ class Decoder {
     return ReadDelimited(out);
   }
 
+  // Reads a packed repeated field from the current cursor into a span. Returns
+  // the number of values read.
+  //
+  // Return values:
+  //
+  //                   OK: The values were read into out.
+  //  FAILED_PRECONDITION: The field is not a length-delimited field.
+  //   RESOURCE_EXHAUSTED: The span is too small to hold all of the values.
+  //         OUT_OF_RANGE: A value does not fit in the output type.
+  //            DATA_LOSS: The packed field is malformed.
+  //
+  // The cursor is only advanced if the field was read successfully. Repeated
+  // fields that were not encoded as packed are read one value at a time with
+  // the scalar Read functions above.
+  StatusWithSize ReadPackedUint32(std::span<uint32_t> out) {
+    return ReadPackedVarints<VarintType::kNormal>(out);
+  }
+
+  StatusWithSize ReadPackedUint64(std::span<uint64_t> out) {
+    return ReadPackedVarints<VarintType::kNormal>(out);
+  }
+
+  // Negative int32 values are encoded as sign-extended 64-bit varints, which
+  // are truncated to 32 bits.
+  StatusWithSize ReadPackedInt32(std::span<int32_t> out) {
+    return ReadPackedVarints<VarintType::kNormal>(out);
+  }
+
+  StatusWithSize ReadPackedInt64(std::span<int64_t> out) {
+    return ReadPackedVarints<VarintType::kNormal>(out);
+  }
+
+  StatusWithSize ReadPackedSint32(std::span<int32_t> out) {
+    return ReadPackedVarints<VarintType::kZigZag>(out);
+  }
+
+  StatusWithSize ReadPackedSint64(std::span<int64_t> out) {
+    return ReadPackedVarints<VarintType::kZigZag>(out);
+  }
+
+  StatusWithSize ReadPackedBool(std::span<bool> out) {
+    return ReadPackedVarints<VarintType::kNormal>(out);
+  }
+
+  StatusWithSize ReadPackedFixed32(std::span<uint32_t> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedFixed64(std::span<uint64_t> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedSfixed32(std::span<int32_t> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedSfixed64(std::span<int64_t> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedFloat(std::span<float> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedDouble(std::span<double> out) {
+    return ReadPackedFixed(out);
+  }
+
   // Resets the decoder to start reading a new proto message.
   void Reset(std::span<const std::byte> proto) {
     proto_ = proto;
@@ -164,6 +239,105 @@ class Decoder {
 
   Status ReadDelimited(std::span<const std::byte>* out);
 
+  enum class VarintType {
+    kNormal,
+    kZigZag,
+  };
+
+  // Reads the payload of a packed field without advancing the cursor. The
+  // cursor is advanced with AdvancePacked() once the values are decoded.
+  Status PeekPacked(std::span<const std::byte>* payload, size_t* field_size);
+
+  void AdvancePacked(size_t field_size) {
+    proto_ = proto_.subspan(field_size);
+    previous_field_consumed_ = true;
+  }
+
+  // Decodes packed varints into an array of integers. Each element is decoded
+  // straight into the output, checked against its range, and stored.
+  template <VarintType kType, typename T>
+  StatusWithSize ReadPackedVarints(std::span<T> out) {
+    std::span<const std::byte> payload;
+    size_t field_size;
+    if (Status status = PeekPacked(&payload, &field_size); !status.ok()) {
+      return StatusWithSize(status, 0);
+    }
+
+    size_t count = 0;
+    while (!payload.empty()) {
+      if (count == out.size()) {
+        return StatusWithSize::ResourceExhausted(count);
+      }
+
+      uint64_t value;
+      const size_t bytes_read = varint::Decode(payload, &value);
+      if (bytes_read == 0u) {
+        return StatusWithSize::DataLoss(count);
+      }
+      payload = payload.subspan(bytes_read);
+
+      if constexpr (kType == VarintType::kZigZag) {
+        const int64_t signed_value = varint::ZigZagDecode(value);
+        if (signed_value < std::numeric_limits<T>::min() ||
+            signed_value > std::numeric_limits<T>::max()) {
+          return StatusWithSize::OutOfRange(count);
+        }
+        out[count++] = static_cast<T>(signed_value);
+      } else if constexpr (std::is_same_v<T, bool>) {
+        out[count++] = value != 0u;
+      } else if constexpr (std::is_same_v<T, uint32_t>) {
+        if (value > std::numeric_limits<uint32_t>::max()) {
+          return StatusWithSize::OutOfRange(count);
+        }
+        out[count++] = static_cast<T>(value);
+      } else {
+        // int32 values are sign-extended to 64 bits, so truncation is correct.
+        out[count++] = static_cast<T>(value);
+      }
+    }
+
+    AdvancePacked(field_size);
+    return StatusWithSize(count);
+  }
+
+  // Copies packed fixed-size values into an array. On little-endian systems,
+  // this is a single memcpy.
+  template <typename T>
+  StatusWithSize ReadPackedFixed(std::span<T> out) {
+    static_assert(
+        sizeof(T) == sizeof(uint32_t) || sizeof(T) == sizeof(uint64_t),
+        "Protobuf fixed-size fields must be 32- or 64-bit");
+
+    std::span<const std::byte> payload;
+    size_t field_size;
+    if (Status status = PeekPacked(&payload, &field_size); !status.ok()) {
+      return StatusWithSize(status, 0);
+    }
+
+    if (payload.size() % sizeof(T) != 0u) {
+      return StatusWithSize::DataLoss();
+    }
+    const size_t count = payload.size() / sizeof(T);
+    if (count > out.size()) {
+      return StatusWithSize::ResourceExhausted();
+    }
+
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(out.data(), payload.data(), payload.size());
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        std::array<std::byte, sizeof(T)> value;
+        std::reverse_copy(&payload[i * sizeof(T)],
+                          &payload[(i + 1) * sizeof(T)],
+                          value.begin());
+        std::memcpy(&out[i], value.data(), sizeof(T));
+      }
+    }
+
+    AdvancePacked(field_size);
+    return StatusWithSize(count);
+  }
+
   std::span<const std::byte> proto_;
   bool previous_field_consumed_;
 };
@@ -304,14 +304,25 @@ class Encoder {
       return status;
     }
 
+    // Encode directly into the remaining buffer, rather than through
+    // WriteVarint(), to avoid rechecking the status for every element.
     std::byte* original_cursor = cursor_;
+    const std::span<std::byte> remaining = buffer_.last(RemainingSize());
+    size_t written = 0;
     for (T value : values) {
-      if (zigzag) {
-        WriteZigzagVarint(static_cast<std::make_signed_t<T>>(value));
-      } else {
-        WriteVarint(value);
+      const uint64_t integer =
+          zigzag ? varint::ZigZagEncode(
+                       static_cast<std::make_signed_t<T>>(value))
+                 : static_cast<uint64_t>(value);
+      const size_t size = varint::EncodeLittleEndianBase128(
+          integer, remaining.subspan(written));
+      if (size == 0u) {
+        encode_status_ = Status::ResourceExhausted();
+        return encode_status_;
       }
+      written += size;
     }
+    cursor_ += written;
     PW_TRY(IncreaseParentSize(cursor_ - original_cursor));
 
     return Pop();
@@ -0,0 +1,177 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "pw_protobuf/decoder.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_status/try.h"
+
+namespace pw::protobuf {
+
+// Provides random access to the fields of an encoded protobuf message.
+//
+// The first lookup scans the message once and records the offset of each field
+// in a fixed-size index of up to kMaxFields distinct field numbers. Subsequent
+// lookups search only the index, rather than rescanning the message as
+// FindDecodeHandler does. Fields beyond the first kMaxFields distinct field
+// numbers are found by scanning the part of the message that was not indexed.
+//
+// If a field appears more than once, the last occurrence is returned, matching
+// protobuf semantics for singular fields. The encoded message must outlive the
+// view.
+//
+// Example:
+//
+//   MessageView<8> view(request);
+//   Result<uint32_t> id = view.ReadUint32(kIdField);
+//   Result<std::string_view> name = view.ReadString(kNameField);
+//
+//   // Nested messages are read as bytes and viewed separately.
+//   Result<ConstByteSpan> config = view.ReadBytes(kConfigField);
+//   if (config.ok()) {
+//     MessageView<4> config_view(*config);
+//     ...
+//   }
+//
+class MessageViewBase {
+ public:
+  MessageViewBase(const MessageViewBase&) = delete;
+  MessageViewBase& operator=(const MessageViewBase&) = delete;
+
+  // Returns true if the message contains the field.
+  bool Has(uint32_t field_number) { return FindField(field_number).ok(); }
+
+  // Each Read function returns:
+  //
+  //   OK - the field was found and read
+  //   NOT_FOUND - the message does not contain the field
+  //   FAILED_PRECONDITION - the field's wire type does not match the read
+  //   DATA_LOSS - the message is malformed
+  //
+  Result<uint32_t> ReadUint32(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadUint32);
+  }
+  Result<int32_t> ReadInt32(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadInt32);
+  }
+  Result<int32_t> ReadSint32(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadSint32);
+  }
+  Result<uint64_t> ReadUint64(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadUint64);
+  }
+  Result<int64_t> ReadInt64(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadInt64);
+  }
+  Result<int64_t> ReadSint64(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadSint64);
+  }
+  Result<bool> ReadBool(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadBool);
+  }
+  Result<uint32_t> ReadFixed32(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadFixed32);
+  }
+  Result<uint64_t> ReadFixed64(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadFixed64);
+  }
+  Result<int32_t> ReadSfixed32(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadSfixed32);
+  }
+  Result<int64_t> ReadSfixed64(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadSfixed64);
+  }
+  Result<float> ReadFloat(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadFloat);
+  }
+  Result<double> ReadDouble(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadDouble);
+  }
+  Result<std::string_view> ReadString(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadString);
+  }
+  Result<std::span<const std::byte>> ReadBytes(uint32_t field_number) {
+    return Read(field_number, &Decoder::ReadBytes);
+  }
+
+  // Returns the encoded field, starting at its key, which may be passed to a
+  // Decoder. Returns NOT_FOUND or DATA_LOSS as the Read functions do.
+  Result<std::span<const std::byte>> FindField(uint32_t field_number);
+
+ protected:
+  struct Entry {
+    uint32_t field_number;
+    uint32_t offset;  // Offset of the field's last occurrence.
+  };
+
+  constexpr MessageViewBase(std::span<const std::byte> proto,
+                            std::span<Entry> index)
+      : proto_(proto),
+        index_(index),
+        indexed_fields_(0),
+        unindexed_offset_(0),
+        state_(kNotIndexed) {}
+
+ private:
+  enum State : uint8_t { kNotIndexed, kIndexed, kMalformed };
+
+  template <typename T>
+  Result<T> Read(uint32_t field_number, Status (Decoder::*read)(T*)) {
+    Result<std::span<const std::byte>> field = FindField(field_number);
+    PW_TRY(field.status());
+
+    Decoder decoder(field.value());
+    PW_TRY(decoder.Next());
+    T value;
+    PW_TRY((decoder.*read)(&value));
+    return value;
+  }
+
+  // Scans the message once and records field offsets in the index.
+  void BuildIndex();
+
+  // Scans the unindexed tail of the message for a field.
+  Result<std::span<const std::byte>> FindUnindexed(uint32_t field_number) const;
+
+  std::span<const std::byte> proto_;
+  std::span<Entry> index_;
+  size_t indexed_fields_;
+
+  // Offset of the first field whose number did not fit in the index, or the
+  // end of the message if every field was indexed.
+  size_t unindexed_offset_;
+
+  State state_;
+};
+
+template <size_t kMaxFields>
+class MessageView : public MessageViewBase {
+ public:
+  static_assert(kMaxFields > 0u);
+
+  constexpr MessageView(std::span<const std::byte> proto)
+      : MessageViewBase(proto, entries_), entries_{} {}
+
+ private:
+  std::array<Entry, kMaxFields> entries_;
+};
+
+}  // namespace pw::protobuf
@@ -13,7 +13,9 @@
 // the License.
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 
 #include "pw_protobuf/wire_format.h"
 #include "pw_varint/varint.h"
@@ -49,4 +51,95 @@ constexpr size_t SizeOfFieldKey(uint32_t field_number) {
   return varint::EncodedSize(field_number << kFieldNumberShift);
 }
 
+// The helpers below return the encoded size of a complete field, including its
+// key. They can be used to compute the size of a submessage before encoding it,
+// such as for StreamingEncoder::GetNestedEncoder(field_number, encoded_size).
+
+// Size of a uint32, uint64, int64, bool, or enum field.
+constexpr size_t SizeOfVarintField(uint32_t field_number, uint64_t value) {
+  return SizeOfFieldKey(field_number) + varint::EncodedSize(value);
+}
+
+// Size of an int32 field. Negative int32 values are encoded as 64-bit varints.
+constexpr size_t SizeOfInt32Field(uint32_t field_number, int32_t value) {
+  return SizeOfVarintField(field_number,
+                           static_cast<uint64_t>(static_cast<int64_t>(value)));
+}
+
+// Size of a sint32 or sint64 field.
+constexpr size_t SizeOfZigZagField(uint32_t field_number, int64_t value) {
+  return SizeOfFieldKey(field_number) + varint::ZigZagEncodedSize(value);
+}
+
+// Size of a fixed32, sfixed32, or float field.
+constexpr size_t SizeOfFixed32Field(uint32_t field_number) {
+  return SizeOfFieldKey(field_number) + kMaxSizeBytesFixed32;
+}
+
+// Size of a fixed64, sfixed64, or double field.
+constexpr size_t SizeOfFixed64Field(uint32_t field_number) {
+  return SizeOfFieldKey(field_number) + kMaxSizeBytesFixed64;
+}
+
+// Size of a string, bytes, or submessage field with the given data length.
+constexpr size_t SizeOfDelimitedField(uint32_t field_number,
+                                      size_t data_size_bytes) {
+  return SizeOfFieldKey(field_number) + varint::EncodedSize(data_size_bytes) +
+         data_size_bytes;
+}
+
+// The helpers below compute the largest encoded size of a message from the
+// largest sizes of its fields. They are used by the kMaxEncodedSizeBytes
+// constants generated for each message. A message with a field that has no
+// size limit, such as a string without a max_size option, is unbounded.
+inline constexpr size_t kMaxSizeUnbounded = std::numeric_limits<size_t>::max();
+
+// Largest size of a string, bytes, or submessage field whose data is at most
+// max_data_size_bytes long.
+constexpr size_t MaxSizeOfDelimitedField(uint32_t field_number,
+                                         size_t max_data_size_bytes) {
+  if (max_data_size_bytes == kMaxSizeUnbounded) {
+    return kMaxSizeUnbounded;
+  }
+  return SizeOfDelimitedField(field_number, max_data_size_bytes);
+}
+
+// Largest size of max_count occurrences of a field, each at most
+// max_field_size_bytes long including its key.
+constexpr size_t MaxSizeOfRepeatedField(size_t max_count,
+                                        size_t max_field_size_bytes) {
+  if (max_field_size_bytes != 0u &&
+      max_count > kMaxSizeUnbounded / max_field_size_bytes) {
+    return kMaxSizeUnbounded;
+  }
+  return max_count * max_field_size_bytes;
+}
+
+// Largest size of a repeated scalar field with at most max_count values, each
+// encoded in at most max_value_size_bytes. Repeated scalars may be encoded
+// packed or as individual fields, so the larger of the two is returned.
+constexpr size_t MaxSizeOfRepeatedScalarField(uint32_t field_number,
+                                              size_t max_count,
+                                              size_t max_value_size_bytes) {
+  const size_t packed = MaxSizeOfDelimitedField(
+      field_number, MaxSizeOfRepeatedField(max_count, max_value_size_bytes));
+  const size_t unpacked = MaxSizeOfRepeatedField(
+      max_count, SizeOfFieldKey(field_number) + max_value_size_bytes);
+  return packed > unpacked ? packed : unpacked;
+}
+
+// Sums the largest sizes of the fields of a message. The sum is unbounded if
+// any of the sizes is, or if it overflows.
+template <typename... Sizes>
+constexpr size_t SumOfMaxSizes(Sizes... max_sizes_bytes) {
+  size_t total = 0;
+  for (size_t size : {size_t{0}, static_cast<size_t>(max_sizes_bytes)...}) {
+    if (size > kMaxSizeUnbounded - total) {
+      return kMaxSizeUnbounded;
+    }
+    total += size;
+  }
+  return total;
+}
+
 }  // namespace pw::protobuf
@@ -0,0 +1,279 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_protobuf/wire_format.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
+
+// This file defines a protobuf wire format decoder that reads from a
+// pw::stream::Reader instead of an in-memory buffer. Like Decoder, it iterates
+// over the fields of a message and the caller extracts the values it cares
+// about. Only the field being decoded is buffered, so large messages, such as
+// snapshots stored in flash, can be decoded with a small, fixed amount of RAM.
+//
+// Submessages are decoded with a nested StreamDecoder, and large bytes or
+// string fields can be read incrementally through a BytesReader. While either
+// is open, the parent decoder is locked; it resumes after the remainder of the
+// field once the child is destroyed.
+//
+// Example usage:
+//
+//   StreamDecoder decoder(reader);
+//   while (decoder.Next().ok()) {
+//     switch (decoder.FieldNumber()) {
+//       case 1:
+//         decoder.ReadUint32(&my_uint32);
+//         break;
+//       case 2: {
+//         StreamDecoder nested = decoder.GetNestedDecoder();
+//         while (nested.Next().ok()) {
+//           // ...
+//         }
+//         break;
+//       }
+//     }
+//   }
+//
+namespace pw::protobuf {
+
+class StreamDecoder {
+ public:
+  // Reads the contents of a bytes or string field as a stream. Returned by
+  // StreamDecoder::GetBytesReader(). Reads return OUT_OF_RANGE once the whole
+  // field has been read.
+  class BytesReader : public stream::Reader {
+   public:
+    ~BytesReader() {
+      if (decoder_ != nullptr) {
+        decoder_->CloseBytesReader(*this);
+      }
+    }
+
+    BytesReader(const BytesReader&) = delete;
+    BytesReader& operator=(const BytesReader&) = delete;
+
+    // The number of bytes of the field that have not been read yet.
+    size_t remaining() const { return remaining_; }
+
+    size_t ConservativeReadLimit() const override { return remaining_; }
+
+   private:
+    friend class StreamDecoder;
+
+    constexpr BytesReader(StreamDecoder* decoder, size_t size, Status status)
+        : decoder_(decoder), remaining_(size), status_(status) {}
+
+    StatusWithSize DoRead(ByteSpan dest) override;
+
+    // Null if the reader could not be opened.
+    StreamDecoder* decoder_;
+    size_t remaining_;
+    Status status_;
+  };
+
+  // Decodes a message that extends until the reader returns OUT_OF_RANGE.
+  constexpr StreamDecoder(stream::Reader& reader)
+      : StreamDecoder(reader, nullptr, nullptr, kUnbounded) {}
+
+  // Decodes a message of a known length from the reader. The reader may
+  // contain data beyond the message, which is not read.
+  constexpr StreamDecoder(stream::Reader& reader, size_t length)
+      : StreamDecoder(reader, nullptr, nullptr, length) {}
+
+  // Decodes from a reader that can seek. Skipped fields, and the unread rest
+  // of nested messages and bytes fields, are seeked over instead of read.
+  constexpr StreamDecoder(stream::SeekableReader& reader)
+      : StreamDecoder(reader, &reader, nullptr, kUnbounded) {}
+  constexpr StreamDecoder(stream::SeekableReader& reader, size_t length)
+      : StreamDecoder(reader, &reader, nullptr, length) {}
+
+  // Closes a nested decoder, which skips to the end of the submessage in the
+  // parent decoder.
+  ~StreamDecoder();
+
+  StreamDecoder(const StreamDecoder&) = delete;
+  StreamDecoder& operator=(const StreamDecoder&) = delete;
+
+  // Advances to the next field in the message. If the current field was not
+  // read, it is skipped.
+  //
+  // Return values:
+  //
+  //             OK: Advanced to a valid proto field.
+  //   OUT_OF_RANGE: Reached the end of the proto message.
+  //      DATA_LOSS: Invalid protobuf data, or the reader failed.
+  //
+  // Precondition: Decoder has no open nested decoder or bytes reader.
+  Status Next();
+
+  // Returns the field number of the current field.
+  uint32_t FieldNumber() const { return field_key_ >> kFieldNumberShift; }
+
+  // Reads a value of the current field. Each function returns
+  // FAILED_PRECONDITION if the field has a different wire type or was already
+  // read, OUT_OF_RANGE if the value does not fit in the output type, and
+  // DATA_LOSS if the value is malformed or the reader failed.
+  //
+  // Precondition: Decoder has no open nested decoder or bytes reader.
+  Status ReadInt32(int32_t* out) {
+    return ReadUint32(reinterpret_cast<uint32_t*>(out));
+  }
+  Status ReadUint32(uint32_t* out);
+  Status ReadInt64(int64_t* out) {
+    return ReadUint64(reinterpret_cast<uint64_t*>(out));
+  }
+  Status ReadUint64(uint64_t* out) { return ReadVarint(out); }
+  Status ReadSint32(int32_t* out);
+  Status ReadSint64(int64_t* out);
+  Status ReadBool(bool* out);
+  Status ReadFixed32(uint32_t* out);
+  Status ReadFixed64(uint64_t* out);
+  Status ReadSfixed32(int32_t* out) {
+    return ReadFixed32(reinterpret_cast<uint32_t*>(out));
+  }
+  Status ReadSfixed64(int64_t* out) {
+    return ReadFixed64(reinterpret_cast<uint64_t*>(out));
+  }
+  Status ReadFloat(float* out);
+  Status ReadDouble(double* out);
+
+  // Copies a bytes or string field into the provided buffer and returns the
+  // number of bytes copied. If the buffer is too small, returns
+  // RESOURCE_EXHAUSTED and the field is not consumed, so it may still be read
+  // with GetBytesReader().
+  //
+  // Precondition: Decoder has no open nested decoder or bytes reader.
+  StatusWithSize ReadBytes(ByteSpan out);
+  StatusWithSize ReadString(std::span<char> out) {
+    return ReadBytes(std::as_writable_bytes(out));
+  }
+
+  // Returns the size of the current length-delimited field's payload, or
+  // FAILED_PRECONDITION if the field is not length-delimited.
+  StatusWithSize FieldSize() const;
+
+  // Returns a reader for the current bytes or string field. The decoder is
+  // locked until the reader is destroyed. If the field is not
+  // length-delimited, the reader is empty and its reads fail.
+  //
+  // Precondition: Decoder has no open nested decoder or bytes reader.
+  BytesReader GetBytesReader();
+
+  // Returns a decoder for the current submessage field. The decoder is locked
+  // until the nested decoder is destroyed, after which decoding resumes after
+  // the submessage. If the field is not length-delimited, the nested decoder
+  // is empty and Next() returns FAILED_PRECONDITION.
+  //
+  // Precondition: Decoder has no open nested decoder or bytes reader.
+  StreamDecoder GetNestedDecoder();
+
+ private:
+  static constexpr size_t kUnbounded = std::numeric_limits<size_t>::max();
+
+  constexpr StreamDecoder(stream::Reader& reader,
+                          stream::SeekableReader* seekable,
+                          StreamDecoder* parent,
+                          size_t length)
+      : reader_(reader),
+        seekable_(seekable),
+        parent_(parent),
+        remaining_(length),
+        field_key_(0),
+        field_size_(0),
+        field_consumed_(true),
+        child_open_(false),
+        status_(OkStatus()) {}
+
+  constexpr StreamDecoder(stream::Reader& reader,
+                          stream::SeekableReader* seekable,
+                          StreamDecoder* parent,
+                          Status status)
+      : reader_(reader),
+        seekable_(seekable),
+        parent_(parent),
+        remaining_(0),
+        field_key_(0),
+        field_size_(0),
+        field_consumed_(true),
+        child_open_(false),
+        status_(status) {}
+
+  bool bounded() const { return remaining_ != kUnbounded; }
+
+  WireType field_wire_type() const {
+    return static_cast<WireType>(field_key_ & kWireTypeMask);
+  }
+
+  // Checks that the current field is unread and has the expected wire type.
+  Status CheckField(WireType expected_type) const;
+
+  Status ReadVarint(uint64_t* out);
+  Status ReadFixed(std::span<std::byte> out, WireType expected_type);
+
+  // Reads a varint directly from the stream. Sets *end if the stream is
+  // exhausted before the first byte, which marks the end of an unbounded
+  // message.
+  Status ConsumeVarint(uint64_t* out, bool* end = nullptr);
+
+  // Fills out from the stream, counting the bytes against the message length.
+  Status Consume(ByteSpan out);
+
+  // Reads and discards, or seeks past, bytes that are not counted against this
+  // message.
+  Status Discard(size_t bytes);
+
+  Status SkipField();
+
+  // Claims the current delimited field for a child reader or decoder.
+  Status OpenChild();
+  void CloseChild(Status child_status, size_t unread_bytes);
+
+  void CloseBytesReader(BytesReader& reader) {
+    CloseChild(reader.status_, reader.remaining_);
+  }
+
+  // Latches an error. Once the stream position is lost, the decoder cannot
+  // recover.
+  Status Fail(Status status) {
+    status_ = status;
+    return status;
+  }
+
+  stream::Reader& reader_;
+  stream::SeekableReader* seekable_;  // The reader, if it can seek.
+  StreamDecoder* parent_;
+
+  // Bytes left in this message, or kUnbounded for a top-level decoder that
+  // reads until the end of the stream.
+  size_t remaining_;
+
+  uint32_t field_key_;
+
+  // Payload size of the current field, if it is length-delimited.
+  size_t field_size_;
+
+  bool field_consumed_;
+  bool child_open_;
+  Status status_;
+};
+
+}  // namespace pw::protobuf
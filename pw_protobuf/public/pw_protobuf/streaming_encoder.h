@@ -18,6 +18,7 @@
 #include <bit>
 #include <cstddef>
 #include <cstring>
+#include <limits>
 #include <span>
 #include <string_view>
 
@@ -77,7 +78,8 @@ class StreamingEncoder {
         status_(OkStatus()),
         parent_(nullptr),
         nested_field_number_(0),
-        memory_writer_(scratch_buffer) {}
+        memory_writer_(scratch_buffer),
+        remaining_size_(kUnsized) {}
   ~StreamingEncoder() { Finalize(); }
 
   // Disallow copy/assign to avoid confusion about who owns the buffer.
@@ -93,7 +95,7 @@ class StreamingEncoder {
   // Precondition: Encoder has no active child encoder.
   size_t ConservativeWriteLimit() const {
     PW_ASSERT(!nested_encoder_open());
-    return writer_.ConservativeWriteLimit();
+    return std::min(writer_.ConservativeWriteLimit(), remaining_size_);
   }
 
   // Creates a nested encoder with the provided field number. Once this is
@@ -103,6 +105,21 @@ class StreamingEncoder {
   // Precondition: Encoder has no active child encoder.
   StreamingEncoder GetNestedEncoder(uint32_t field_number);
 
+  // Creates a nested encoder for a submessage whose encoded size is known in
+  // advance, e.g. computed with the helpers in pw_protobuf/serialized_size.h.
+  // The key and length are written immediately, and the nested encoder writes
+  // directly to this encoder's writer, so no scratch buffer is used and each
+  // byte of the submessage is written exactly once.
+  //
+  // The nested encoder must write exactly encoded_size bytes. Writes past that
+  // size fail with OutOfRange, and finalizing a submessage that is shorter
+  // than encoded_size sets this encoder's status to DataLoss, since the
+  // already-written length is wrong. Submessages of a sized nested encoder
+  // must also be sized.
+  //
+  // Precondition: Encoder has no active child encoder.
+  StreamingEncoder GetNestedEncoder(uint32_t field_number, size_t encoded_size);
+
   // Closes the proto encoder. If this encoder is a nested one, the parent is
   // unlocked and proto encoding may resume on the parent. This is automatically
   // called on object destruction.
@@ -386,7 +403,8 @@ class StreamingEncoder {
         status_(other.status_),
         parent_(other.parent_),
         nested_field_number_(other.nested_field_number_),
-        memory_writer_(std::move(other.memory_writer_)) {
+        memory_writer_(std::move(other.memory_writer_)),
+        remaining_size_(other.remaining_size_) {
     PW_ASSERT(nested_field_number_ == 0);
     // Make the nested encoder look like it has an open child to block writes
     // for the remainder of the object's life.
@@ -408,10 +426,28 @@ class StreamingEncoder {
                                        : OkStatus()),
         parent_(&parent),
         nested_field_number_(0),
-        memory_writer_(scratch_buffer) {}
+        memory_writer_(scratch_buffer),
+        remaining_size_(kUnsized) {}
+
+  // Constructs a sized nested encoder, which writes to its parent's writer.
+  constexpr StreamingEncoder(StreamingEncoder& parent,
+                             stream::Writer& writer,
+                             Status status,
+                             size_t encoded_size)
+      : writer_(writer),
+        status_(status),
+        parent_(&parent),
+        nested_field_number_(0),
+        memory_writer_(ByteSpan()),
+        remaining_size_(encoded_size) {}
+
+  // remaining_size_ value for encoders that are not limited to a declared size.
+  static constexpr size_t kUnsized = std::numeric_limits<size_t>::max();
 
   bool nested_encoder_open() const { return nested_field_number_ != 0; }
 
+  bool sized() const { return remaining_size_ != kUnsized; }
+
   // Finalization logic for nested encoders that call Finalize(). While
   // Finalize() is called on the child encoder, FinalizeNestedMessage() is
   // called on the parent encoder.
@@ -464,14 +500,34 @@ class StreamingEncoder {
 
     WriteVarint(MakeKey(field_number, WireType::kDelimited));
     WriteVarint(payload_size);
+
+    // Encode the values into a stack buffer and write them in chunks, rather
+    // than making a Write() call for each value.
+    std::array<std::byte, kPackedVarintChunkSizeBytes> chunk;
+    size_t chunk_size = 0;
     for (T value : values) {
-      if (encode_type == VarintEncodeType::kZigZag) {
-        WriteZigzagVarint(static_cast<std::make_signed_t<T>>(value));
-      } else {
-        WriteVarint(value);
+      if (chunk.size() - chunk_size < varint::kMaxVarint64SizeBytes) {
+        PW_TRY(WriteChunk(std::span(chunk).first(chunk_size)));
+        chunk_size = 0;
       }
+      const uint64_t integer =
+          encode_type == VarintEncodeType::kZigZag
+              ? varint::ZigZagEncode(static_cast<std::make_signed_t<T>>(value))
+              : static_cast<uint64_t>(value);
+      chunk_size += varint::EncodeLittleEndianBase128(
+          integer, std::span(chunk).subspan(chunk_size));
     }
+    return WriteChunk(std::span(chunk).first(chunk_size));
+  }
 
+  // Size of the stack buffer used to batch packed varint writes.
+  static constexpr size_t kPackedVarintChunkSizeBytes = 64;
+
+  Status WriteChunk(ConstByteSpan data) {
+    if (!status_.ok() || data.empty()) {
+      return status_;
+    }
+    status_ = writer_.Write(data);
     return status_;
   }
 
@@ -492,6 +548,8 @@ class StreamingEncoder {
   //   InvalidArgument: The field number provided was invalid.
   //   ResourceExhausted: The requested write would have exceeded the
   //     stream::Writer's conservative write limit.
+  //   OutOfRange: The requested write would have exceeded the declared size of
+  //     a sized nested encoder.
   //   Other: If any Write() operations on the stream::Writer caused an error,
   //     that error will be repeated here.
   Status UpdateStatusForWrite(uint32_t field_number,
@@ -519,6 +577,10 @@ class StreamingEncoder {
   // This memory writer is used for staging proto submessages to the
   // scratch_buffer.
   stream::MemoryWriter memory_writer_;
+
+  // For sized nested encoders, the number of bytes left to write. Otherwise,
+  // kUnsized.
+  size_t remaining_size_;
 };
 
 // A protobuf encoder that writes directly to a provided buffer. This will
@@ -0,0 +1,103 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_status/status.h"
+
+// This file defines a table-driven protobuf decoder. A constexpr table maps
+// each field number to a member of a plain struct, and the decoder fills in the
+// struct in a single pass over the encoded message. There are no virtual calls
+// and no allocations; string and bytes fields refer to the encoded message.
+//
+// pw_protobuf codegen generates a Message struct, a kFieldTable, and a Decode
+// function for each message whose fields are all singular scalars, strings, or
+// bytes. Tables may also be written by hand:
+//
+//   struct Sample {
+//     uint32_t id;
+//     int32_t value;
+//     std::string_view name;
+//   };
+//
+//   constexpr FieldDescriptor kSampleFields[] = {
+//       {1, FieldKind::kVarint32, offsetof(Sample, id)},
+//       {2, FieldKind::kZigZag32, offsetof(Sample, value)},
+//       {3, FieldKind::kString, offsetof(Sample, name)},
+//   };
+//
+//   Sample sample = {};
+//   Status status = DecodeWithTable(encoded, kSampleFields, &sample);
+//
+namespace pw::protobuf {
+
+// How a field is decoded and stored in its struct member.
+enum class FieldKind : uint8_t {
+  kVarint32,  // int32, uint32, or enum; stored in a 32-bit integer
+  kVarint64,  // int64 or uint64; stored in a 64-bit integer
+  kZigZag32,  // sint32; stored in an int32_t
+  kZigZag64,  // sint64; stored in an int64_t
+  kBool,      // bool; stored in a bool
+  kFixed32,   // fixed32, sfixed32, or float; stored in a 32-bit member
+  kFixed64,   // fixed64, sfixed64, or double; stored in a 64-bit member
+  kString,    // string; stored in a std::string_view
+  kBytes,     // bytes; stored in a BytesView
+};
+
+// Refers to a bytes field in an encoded message. std::span is not guaranteed to
+// be standard-layout, which offsetof requires of the decoded struct, so bytes
+// fields are stored as a plain pointer and size.
+struct BytesView {
+  const std::byte* data;
+  size_t size;
+
+  constexpr std::span<const std::byte> span() const { return {data, size}; }
+};
+
+// Maps a field number to the offset of its member in the decoded struct.
+struct FieldDescriptor {
+  uint32_t field_number;
+  FieldKind kind;
+  uint16_t offset;
+};
+
+// True if a field table is sorted by field number with no duplicates, which
+// DecodeWithTable requires. Use in a static_assert on constexpr tables.
+constexpr bool IsValidFieldTable(std::span<const FieldDescriptor> table) {
+  for (size_t i = 1; i < table.size(); ++i) {
+    if (table[i - 1].field_number >= table[i].field_number) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Decodes a protobuf message into the struct at message, using a table sorted
+// by field number. Fields not in the table are skipped. Members for fields that
+// are not in the message are left unchanged. If a field appears more than once,
+// the last value is kept, as in the protobuf specification.
+//
+// Returns:
+//   OK - the message was decoded
+//   DATA_LOSS - the message is malformed, or a field's wire type does not match
+//       its kind in the table
+//
+Status DecodeWithTable(std::span<const std::byte> proto,
+                       std::span<const FieldDescriptor> table,
+                       void* message);
+
+}  // namespace pw::protobuf
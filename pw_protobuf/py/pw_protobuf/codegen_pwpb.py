@@ -18,11 +18,12 @@ from datetime import datetime
 import enum
 import os
 import sys
-from typing import Dict, Iterable, List, Tuple
+from typing import Dict, Iterable, List, Optional, Set, Tuple
 from typing import cast
 
 import google.protobuf.descriptor_pb2 as descriptor_pb2
 
+from pw_protobuf.options import FieldOptions
 from pw_protobuf.output_file import OutputFile
 from pw_protobuf.proto_tree import ProtoEnum, ProtoMessage, ProtoMessageField
 from pw_protobuf.proto_tree import ProtoNode
@@ -567,6 +568,117 @@ PROTO_FIELD_METHODS: Dict[int, List] = {
 }
 
 
+# Mapping of protobuf field types to their C++ struct member types and
+# FieldKinds in table-driven decoding. Enum members use the enum's type.
+_TABLE_FIELD_TYPES: Dict[int, Tuple[str, str]] = {
+    descriptor_pb2.FieldDescriptorProto.TYPE_DOUBLE: ('double', 'kFixed64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_FLOAT: ('float', 'kFixed32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_INT32: ('int32_t', 'kVarint32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_SINT32: ('int32_t', 'kZigZag32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_SFIXED32:
+    ('int32_t', 'kFixed32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_INT64: ('int64_t', 'kVarint64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_SINT64: ('int64_t', 'kZigZag64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_SFIXED64:
+    ('int64_t', 'kFixed64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_UINT32:
+    ('uint32_t', 'kVarint32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_FIXED32:
+    ('uint32_t', 'kFixed32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_UINT64:
+    ('uint64_t', 'kVarint64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_FIXED64:
+    ('uint64_t', 'kFixed64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_BOOL: ('bool', 'kBool'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_BYTES:
+    (f'{PROTOBUF_NAMESPACE}::BytesView', 'kBytes'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_STRING:
+    ('std::string_view', 'kString'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_ENUM: ('', 'kVarint32'),
+}
+
+# Field names which cannot be used as C++ struct members as is.
+_CPP_KEYWORDS = frozenset([
+    'and', 'auto', 'bool', 'break', 'case', 'catch', 'char', 'class', 'const',
+    'continue', 'default', 'delete', 'do', 'double', 'else', 'enum',
+    'explicit', 'export', 'extern', 'false', 'float', 'for', 'friend', 'goto',
+    'if', 'inline', 'int', 'long', 'mutable', 'namespace', 'new', 'not',
+    'operator', 'or', 'private', 'protected', 'public', 'register', 'return',
+    'short', 'signed', 'sizeof', 'static', 'struct', 'switch', 'template',
+    'this', 'throw', 'true', 'try', 'typedef', 'typename', 'union',
+    'unsigned', 'using', 'virtual', 'void', 'volatile', 'while', 'xor'
+])
+
+
+def _supports_table_decoding(message: ProtoMessage) -> bool:
+    """True if every field in a message can be decoded into a struct member."""
+    fields = message.fields()
+    return bool(fields) and all(
+        field.type() in _TABLE_FIELD_TYPES and not field.is_repeated()
+        for field in fields)
+
+
+def _struct_member_name(field: ProtoMessageField) -> str:
+    name = field.field_name()
+    return f'{name}_' if name in _CPP_KEYWORDS else name
+
+
+def generate_table_decoder(message: ProtoMessage, root: ProtoNode,
+                           output: OutputFile) -> None:
+    """Generates a struct, field table, and Decode function for a message.
+
+    Only messages with singular scalar, enum, string, and bytes fields are
+    supported. Other messages must be decoded with pw::protobuf::Decoder.
+    """
+    assert message.type() == ProtoNode.Type.MESSAGE
+
+    if not _supports_table_decoding(message):
+        return
+
+    fields = sorted(message.fields(), key=lambda field: field.number())
+    namespace = message.cpp_namespace(root)
+
+    output.write_line()
+    output.write_line(f'namespace {namespace} {{')
+    output.write_line()
+
+    output.write_line('struct Message {')
+    with output.indent():
+        for field in fields:
+            member_type = _TABLE_FIELD_TYPES[field.type()][0]
+            if field.type() == descriptor_pb2.FieldDescriptorProto.TYPE_ENUM:
+                type_node = field.type_node()
+                assert type_node is not None
+                member_type = '::' + type_node.cpp_namespace().lstrip(':')
+            output.write_line(f'{member_type} {_struct_member_name(field)};')
+    output.write_line('};')
+
+    output.write_line()
+    output.write_line(f'inline constexpr {PROTOBUF_NAMESPACE}::'
+                      'FieldDescriptor kFieldTable[] = {')
+    with output.indent():
+        for field in fields:
+            kind = _TABLE_FIELD_TYPES[field.type()][1]
+            output.write_line(
+                f'{{{field.number()}, '
+                f'{PROTOBUF_NAMESPACE}::FieldKind::{kind}, '
+                f'offsetof(Message, {_struct_member_name(field)})}},')
+    output.write_line('};')
+
+    output.write_line()
+    output.write_line('// Decodes a serialized message into a Message struct '
+                      'in a single pass.')
+    output.write_line('inline ::pw::Status Decode(std::span<const std::byte> '
+                      'proto, Message& message) {')
+    with output.indent():
+        output.write_line(f'return {PROTOBUF_NAMESPACE}::DecodeWithTable('
+                          'proto, kFieldTable, &message);')
+    output.write_line('}')
+
+    output.write_line()
+    output.write_line(f'}}  // namespace {namespace}')
+
+
 def generate_code_for_message(message: ProtoMessage, root: ProtoNode,
                               output: OutputFile,
                               encoder_type: EncoderType) -> None:
@@ -688,6 +800,186 @@ def forward_declare(node: ProtoMessage, root: ProtoNode,
     output.write_line(f'}}  // namespace {namespace}')
 
 
+# Constants in serialized_size.h for the largest encoded size of each scalar
+# field type, excluding the field key.
+_SCALAR_MAX_SIZES: Dict[int, str] = {
+    descriptor_pb2.FieldDescriptorProto.TYPE_DOUBLE: 'kMaxSizeBytesDouble',
+    descriptor_pb2.FieldDescriptorProto.TYPE_FLOAT: 'kMaxSizeBytesFloat',
+    descriptor_pb2.FieldDescriptorProto.TYPE_INT32: 'kMaxSizeBytesInt32',
+    descriptor_pb2.FieldDescriptorProto.TYPE_SINT32: 'kMaxSizeBytesSint32',
+    descriptor_pb2.FieldDescriptorProto.TYPE_SFIXED32:
+    'kMaxSizeBytesSfixed32',
+    descriptor_pb2.FieldDescriptorProto.TYPE_INT64: 'kMaxSizeBytesInt64',
+    descriptor_pb2.FieldDescriptorProto.TYPE_SINT64: 'kMaxSizeBytesSint64',
+    descriptor_pb2.FieldDescriptorProto.TYPE_SFIXED64:
+    'kMaxSizeBytesSfixed64',
+    descriptor_pb2.FieldDescriptorProto.TYPE_UINT32: 'kMaxSizeBytesUint32',
+    descriptor_pb2.FieldDescriptorProto.TYPE_FIXED32: 'kMaxSizeBytesFixed32',
+    descriptor_pb2.FieldDescriptorProto.TYPE_UINT64: 'kMaxSizeBytesUint64',
+    descriptor_pb2.FieldDescriptorProto.TYPE_FIXED64: 'kMaxSizeBytesFixed64',
+    descriptor_pb2.FieldDescriptorProto.TYPE_BOOL: 'kMaxSizeBytesBool',
+}
+
+_UNBOUNDED = f'::{PROTOBUF_NAMESPACE}::kMaxSizeUnbounded'
+
+
+def _varint_size(value: int) -> int:
+    size = 1
+    while value >= 0x80:
+        value >>= 7
+        size += 1
+    return size
+
+
+def _max_value_size(field: ProtoMessageField) -> str:
+    """Returns the largest encoded size of a scalar or enum field's value."""
+    if field.type() == descriptor_pb2.FieldDescriptorProto.TYPE_ENUM:
+        # Enums defined in this file whose values are all non-negative are
+        # limited by their largest value. Negative values take ten bytes.
+        type_node = field.type_node()
+        if type_node is not None and type_node.type() == ProtoNode.Type.ENUM:
+            values = [v for _, v in cast(ProtoEnum, type_node).values()]
+            if values and min(values) >= 0:
+                return str(_varint_size(max(values)))
+
+        return f'::{PROTOBUF_NAMESPACE}::kMaxSizeBytesInt32'
+
+    return f'::{PROTOBUF_NAMESPACE}::{_SCALAR_MAX_SIZES[field.type()]}'
+
+
+def _max_data_size(field: ProtoMessageField, message: ProtoMessage,
+                   options: FieldOptions,
+                   recursive: Set[ProtoNode]) -> Optional[str]:
+    """Returns the largest data size of a delimited field, if it is limited."""
+    field_path = f'{message.proto_path()}.{field.field_name()}'
+
+    if field.type() == descriptor_pb2.FieldDescriptorProto.TYPE_MESSAGE:
+        type_node = field.type_node()
+        if type_node is None or type_node in recursive:
+            return None
+        return f'::{type_node.cpp_namespace()}::kMaxEncodedSizeBytes'
+
+    if field.type() == descriptor_pb2.FieldDescriptorProto.TYPE_STRING:
+        max_length = options.get(field_path, 'max_length')
+        if max_length is not None:
+            return str(max_length)
+
+        # As in nanopb, a string's max_size includes its null terminator.
+        max_size = options.get(field_path, 'max_size')
+        return None if max_size is None else str(max(max_size - 1, 0))
+
+    max_size = options.get(field_path, 'max_size')
+    return None if max_size is None else str(max_size)
+
+
+def _max_field_size(field: ProtoMessageField, message: ProtoMessage,
+                    options: FieldOptions, recursive: Set[ProtoNode]) -> str:
+    """Returns a C++ expression for the largest encoded size of a field."""
+    max_count: Optional[int] = None
+    if field.is_repeated():
+        max_count = options.get(f'{message.proto_path()}.{field.field_name()}',
+                                'max_count')
+        if max_count is None:
+            return _UNBOUNDED
+
+    number = field.number()
+
+    if field.type() in (descriptor_pb2.FieldDescriptorProto.TYPE_STRING,
+                        descriptor_pb2.FieldDescriptorProto.TYPE_BYTES,
+                        descriptor_pb2.FieldDescriptorProto.TYPE_MESSAGE):
+        max_data_size = _max_data_size(field, message, options, recursive)
+        if max_data_size is None:
+            return _UNBOUNDED
+
+        size = (f'::{PROTOBUF_NAMESPACE}::MaxSizeOfDelimitedField('
+                f'{number}, {max_data_size})')
+        if max_count is None:
+            return size
+        return (f'::{PROTOBUF_NAMESPACE}::MaxSizeOfRepeatedField('
+                f'{max_count}, {size})')
+
+    value_size = _max_value_size(field)
+    if max_count is None:
+        return (f'::{PROTOBUF_NAMESPACE}::SizeOfFieldKey({number}) + '
+                f'{value_size}')
+    return (f'::{PROTOBUF_NAMESPACE}::MaxSizeOfRepeatedScalarField('
+            f'{number}, {max_count}, {value_size})')
+
+
+def _messages_in_dependency_order(
+        package: ProtoNode) -> Tuple[List[ProtoMessage], Set[ProtoNode]]:
+    """Orders a file's messages so that each follows its submessages.
+
+    Also returns the messages that can contain themselves, which have no
+    largest size.
+    """
+    ordered: List[ProtoMessage] = []
+    recursive: Set[ProtoNode] = set()
+    visiting: List[ProtoNode] = []
+    visited: Set[ProtoNode] = set()
+
+    def visit(message: ProtoMessage) -> None:
+        visiting.append(message)
+        for field in message.fields():
+            type_node = field.type_node()
+            if (type_node is None
+                    or type_node.type() != ProtoNode.Type.MESSAGE):
+                continue
+
+            if type_node in visiting:
+                # Every message from the field's type up to this one is part
+                # of a cycle.
+                recursive.update(visiting[visiting.index(type_node):])
+            elif type_node not in visited:
+                visit(cast(ProtoMessage, type_node))
+
+        visiting.pop()
+        visited.add(message)
+        ordered.append(message)
+
+    for node in package:
+        if node.type() == ProtoNode.Type.MESSAGE and node not in visited:
+            visit(cast(ProtoMessage, node))
+
+    return ordered, recursive
+
+
+def generate_max_size_constants(package: ProtoNode, options: FieldOptions,
+                                output: OutputFile) -> None:
+    """Defines kMaxEncodedSizeBytes in the namespace of each message.
+
+    kMaxEncodedSizeBytes is the largest encoded size of the message, or
+    pw::protobuf::kMaxSizeUnbounded if a string, bytes, or repeated field has
+    no size option, or if the message can contain itself.
+    """
+    messages, recursive = _messages_in_dependency_order(package)
+
+    for message in messages:
+        if message in recursive:
+            sizes = [_UNBOUNDED]
+        else:
+            sizes = [
+                _max_field_size(field, message, options, recursive)
+                for field in message.fields()
+            ]
+
+        namespace = message.cpp_namespace(package)
+        output.write_line()
+        output.write_line(f'namespace {namespace} {{')
+        declaration = 'inline constexpr size_t kMaxEncodedSizeBytes'
+        if not sizes:
+            output.write_line(f'{declaration} = 0;')
+        else:
+            output.write_line(f'{declaration} =')
+            with output.indent(4):
+                output.write_line(f'::{PROTOBUF_NAMESPACE}::SumOfMaxSizes(')
+                with output.indent(4):
+                    for size in sizes[:-1]:
+                        output.write_line(f'{size},')
+                    output.write_line(f'{sizes[-1]});')
+        output.write_line(f'}}  // namespace {namespace}')
+
+
 def generate_encoder_wrappers(package: ProtoNode, encoder_type: EncoderType,
                               output: OutputFile):
     # Run through all messages in the file, generating a class for each.
@@ -711,7 +1003,8 @@ def _proto_filename_to_generated_header(proto_file: str) -> str:
 
 
 def generate_code_for_package(file_descriptor_proto, package: ProtoNode,
-                              output: OutputFile) -> None:
+                              output: OutputFile,
+                              options: FieldOptions) -> None:
     """Generates code for a single .pb.h file corresponding to a .proto file."""
 
     assert package.type() == ProtoNode.Type.PACKAGE
@@ -722,9 +1015,12 @@ def generate_code_for_package(file_descriptor_proto, package: ProtoNode,
     output.write_line('#pragma once\n')
     output.write_line('#include <cstddef>')
     output.write_line('#include <cstdint>')
-    output.write_line('#include <span>\n')
+    output.write_line('#include <span>')
+    output.write_line('#include <string_view>\n')
     output.write_line('#include "pw_protobuf/codegen.h"')
+    output.write_line('#include "pw_protobuf/serialized_size.h"')
     output.write_line('#include "pw_protobuf/streaming_encoder.h"')
+    output.write_line('#include "pw_protobuf/table_decoder.h"')
 
     for imported_file in file_descriptor_proto.dependency:
         generated_header = _proto_filename_to_generated_header(imported_file)
@@ -747,16 +1043,30 @@ def generate_code_for_package(file_descriptor_proto, package: ProtoNode,
             output.write_line()
             generate_code_for_enum(cast(ProtoEnum, node), package, output)
 
+    generate_max_size_constants(package, options, output)
+
     generate_encoder_wrappers(package, EncoderType.LEGACY, output)
     generate_encoder_wrappers(package, EncoderType.STREAMING, output)
     generate_encoder_wrappers(package, EncoderType.MEMORY, output)
 
+    # Generate table-driven decoding for messages after all enums, including
+    # those nested in messages, have been defined.
+    for node in package:
+        if node.type() == ProtoNode.Type.MESSAGE:
+            generate_table_decoder(cast(ProtoMessage, node), package, output)
+
     if package.cpp_namespace():
         output.write_line(f'\n}}  // namespace {package.cpp_namespace()}')
 
 
-def process_proto_file(proto_file) -> Iterable[OutputFile]:
-    """Generates code for a single .proto file."""
+def process_proto_file(
+        proto_file,
+        options: Optional[FieldOptions] = None) -> Iterable[OutputFile]:
+    """Generates code for a single .proto file.
+
+    Field size options, as read from nanopb-style .options files, limit the
+    sizes of string, bytes, and repeated fields in kMaxEncodedSizeBytes.
+    """
 
     # Two passes are made through the file. The first builds the tree of all
     # message/enum nodes, then the second creates the fields in each. This is
@@ -766,6 +1076,7 @@ def process_proto_file(proto_file) -> Iterable[OutputFile]:
 
     output_filename = _proto_filename_to_generated_header(proto_file.name)
     output_file = OutputFile(output_filename)
-    generate_code_for_package(proto_file, package_root, output_file)
+    generate_code_for_package(proto_file, package_root, output_file,
+                              options or FieldOptions())
 
     return [output_file]
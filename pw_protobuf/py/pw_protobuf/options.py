@@ -0,0 +1,102 @@
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Reads nanopb-style .options files, which limit the sizes of fields.
+
+Each line of an options file names a field, or a pattern of fields, followed
+by options for it:
+
+  pw.log.LogEntry.message max_size:64
+  pw.log.LogEntries.entries max_count:8
+  pw.log.*.thread max_length:16
+
+The options that limit the encoded size of a message are read:
+
+  max_size   - The most bytes in a bytes field, or in a string field including
+               its null terminator, as in nanopb.
+  max_length - The most characters in a string field.
+  max_count  - The most elements in a repeated field.
+
+Other options are ignored. A .options file applies to the .proto file with the
+same name, and is found in the same directories as nanopb looks for it.
+"""
+
+import fnmatch
+from pathlib import Path
+import shlex
+from typing import Dict, Iterable, List, Optional, Tuple
+
+_SIZE_OPTIONS = ('max_size', 'max_length', 'max_count')
+
+# A field name pattern and the options that apply to the matching fields.
+_Entry = Tuple[str, Dict[str, int]]
+
+
+class FieldOptions:
+    """The size options for the fields of a set of .proto files."""
+    def __init__(self, entries: Iterable[_Entry] = ()):
+        self._entries: List[_Entry] = list(entries)
+
+    @classmethod
+    def load(cls, include_dirs: Iterable[Path],
+             proto_files: Iterable[str]) -> 'FieldOptions':
+        """Reads the .options file for each .proto file, where one exists."""
+        entries: List[_Entry] = []
+        include_dirs = list(include_dirs)
+
+        for proto_file in proto_files:
+            options_file = Path(proto_file).with_suffix('.options')
+            for include_dir in include_dirs:
+                path = include_dir / options_file
+                if path.is_file():
+                    entries.extend(_parse(path.read_text()))
+                    break
+
+        return cls(entries)
+
+    def get(self, field_path: str, option: str) -> Optional[int]:
+        """Returns an option for a field, such as pkg.Message.field.
+
+        When several lines match the field, the last one to set the option
+        takes effect.
+        """
+        value: Optional[int] = None
+        for pattern, options in self._entries:
+            if option in options and fnmatch.fnmatchcase(field_path, pattern):
+                value = options[option]
+        return value
+
+
+def include_dirs_from_parameter(parameter: str) -> List[Path]:
+    """Finds -I<dir> flags in a protoc plugin parameter string."""
+    return [
+        Path(arg[2:]) for arg in shlex.split(parameter.replace(',', ' '))
+        if arg.startswith('-I') and len(arg) > 2
+    ]
+
+
+def _parse(text: str) -> Iterable[_Entry]:
+    for line in text.splitlines():
+        line = line.split('#', 1)[0].split('//', 1)[0].strip()
+        if not line:
+            continue
+
+        pattern, *settings = line.split()
+        options: Dict[str, int] = {}
+        for setting in settings:
+            name, _, value = setting.partition(':')
+            if name in _SIZE_OPTIONS and value.isdigit():
+                options[name] = int(value)
+
+        if options:
+            yield pattern.lstrip('.'), options
@@ -23,6 +23,7 @@ import sys
 import google.protobuf.compiler.plugin_pb2 as plugin_pb2
 
 import pw_protobuf.codegen_pwpb as codegen_pwpb
+from pw_protobuf.options import FieldOptions, include_dirs_from_parameter
 
 
 def process_proto_request(req: plugin_pb2.CodeGeneratorRequest,
@@ -36,8 +37,13 @@ def process_proto_request(req: plugin_pb2.CodeGeneratorRequest,
       req: A CodeGeneratorRequest for a proto compilation.
       res: A CodeGeneratorResponse to populate with the plugin's output.
     """
+    # Like nanopb, .options files that limit field sizes are found in the
+    # directories passed as -I flags in the plugin parameter.
+    options = FieldOptions.load(include_dirs_from_parameter(req.parameter),
+                                (f.name for f in req.proto_file))
+
     for proto_file in req.proto_file:
-        output_files = codegen_pwpb.process_proto_file(proto_file)
+        output_files = codegen_pwpb.process_proto_file(proto_file, options)
         for output_file in output_files:
             fd = res.file.add()
             fd.name = output_file.name()
@@ -0,0 +1,361 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_protobuf/stream_decoder.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "pw_assert/check.h"
+#include "pw_bytes/endian.h"
+#include "pw_status/try.h"
+#include "pw_varint/varint.h"
+
+namespace pw::protobuf {
+
+StatusWithSize StreamDecoder::BytesReader::DoRead(ByteSpan dest) {
+  if (!status_.ok()) {
+    return StatusWithSize(status_, 0);
+  }
+  if (remaining_ == 0u) {
+    return StatusWithSize::OutOfRange();
+  }
+
+  Result<ByteSpan> result =
+      decoder_->reader_.Read(dest.first(std::min(dest.size(), remaining_)));
+  if (!result.ok()) {
+    // The field is known to be this long, so running out of data is an error.
+    status_ = Status::DataLoss();
+    return StatusWithSize(status_, 0);
+  }
+
+  remaining_ -= result.value().size();
+  return StatusWithSize(result.value().size());
+}
+
+StreamDecoder::~StreamDecoder() {
+  if (parent_ != nullptr) {
+    parent_->CloseChild(status_, remaining_);
+  }
+}
+
+Status StreamDecoder::Next() {
+  PW_CHECK(!child_open_, "Next() called while a nested reader is open");
+
+  if (!status_.ok()) {
+    return status_;
+  }
+  if (!field_consumed_) {
+    if (Status status = SkipField(); !status.ok()) {
+      return Fail(status);
+    }
+  }
+
+  field_key_ = 0;
+  if (remaining_ == 0u) {
+    return Status::OutOfRange();
+  }
+
+  uint64_t key;
+  bool end = false;
+  if (Status status = ConsumeVarint(&key, &end); !status.ok()) {
+    return end && !bounded() ? Status::OutOfRange() : Fail(status);
+  }
+
+  const uint32_t field_number = key >> kFieldNumberShift;
+  if (key > std::numeric_limits<uint32_t>::max() ||
+      !ValidFieldNumber(field_number)) {
+    return Fail(Status::DataLoss());
+  }
+
+  field_key_ = key;
+  switch (field_wire_type()) {
+    case WireType::kVarint:
+      field_size_ = 0;
+      break;
+    case WireType::kFixed32:
+      field_size_ = sizeof(uint32_t);
+      break;
+    case WireType::kFixed64:
+      field_size_ = sizeof(uint64_t);
+      break;
+    case WireType::kDelimited: {
+      uint64_t length;
+      if (Status status = ConsumeVarint(&length); !status.ok()) {
+        return Fail(status);
+      }
+      if (length > remaining_) {
+        return Fail(Status::DataLoss());
+      }
+      field_size_ = length;
+      break;
+    }
+    default:
+      return Fail(Status::DataLoss());
+  }
+
+  field_consumed_ = false;
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadUint32(uint32_t* out) {
+  uint64_t value = 0;
+  PW_TRY(ReadUint64(&value));
+  if (value > std::numeric_limits<uint32_t>::max()) {
+    return Status::OutOfRange();
+  }
+  *out = value;
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadSint32(int32_t* out) {
+  int64_t value = 0;
+  PW_TRY(ReadSint64(&value));
+  if (value > std::numeric_limits<int32_t>::max() ||
+      value < std::numeric_limits<int32_t>::min()) {
+    return Status::OutOfRange();
+  }
+  *out = value;
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadSint64(int64_t* out) {
+  uint64_t value = 0;
+  PW_TRY(ReadUint64(&value));
+  *out = varint::ZigZagDecode(value);
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadBool(bool* out) {
+  uint64_t value = 0;
+  PW_TRY(ReadUint64(&value));
+  *out = value;
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadFixed32(uint32_t* out) {
+  std::array<std::byte, sizeof(uint32_t)> bytes;
+  PW_TRY(ReadFixed(bytes, WireType::kFixed32));
+  *out = bytes::ReadInOrder<uint32_t>(std::endian::little, bytes);
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadFixed64(uint64_t* out) {
+  std::array<std::byte, sizeof(uint64_t)> bytes;
+  PW_TRY(ReadFixed(bytes, WireType::kFixed64));
+  *out = bytes::ReadInOrder<uint64_t>(std::endian::little, bytes);
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadFloat(float* out) {
+  static_assert(sizeof(float) == sizeof(uint32_t),
+                "Float and uint32_t must be the same size for protobufs");
+  uint32_t value;
+  PW_TRY(ReadFixed32(&value));
+  std::memcpy(out, &value, sizeof(value));
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadDouble(double* out) {
+  static_assert(sizeof(double) == sizeof(uint64_t),
+                "Double and uint64_t must be the same size for protobufs");
+  uint64_t value;
+  PW_TRY(ReadFixed64(&value));
+  std::memcpy(out, &value, sizeof(value));
+  return OkStatus();
+}
+
+StatusWithSize StreamDecoder::ReadBytes(ByteSpan out) {
+  if (Status status = CheckField(WireType::kDelimited); !status.ok()) {
+    return StatusWithSize(status, 0);
+  }
+  if (out.size() < field_size_) {
+    return StatusWithSize::ResourceExhausted();
+  }
+
+  if (Status status = Consume(out.first(field_size_)); !status.ok()) {
+    return StatusWithSize(Fail(status), 0);
+  }
+  field_consumed_ = true;
+  return StatusWithSize(field_size_);
+}
+
+StatusWithSize StreamDecoder::FieldSize() const {
+  if (field_key_ == 0u || field_wire_type() != WireType::kDelimited) {
+    return StatusWithSize::FailedPrecondition();
+  }
+  return StatusWithSize(field_size_);
+}
+
+StreamDecoder::BytesReader StreamDecoder::GetBytesReader() {
+  if (Status status = OpenChild(); !status.ok()) {
+    return BytesReader(nullptr, 0, status);
+  }
+  return BytesReader(this, field_size_, OkStatus());
+}
+
+StreamDecoder StreamDecoder::GetNestedDecoder() {
+  if (Status status = OpenChild(); !status.ok()) {
+    return StreamDecoder(reader_, seekable_, nullptr, status);
+  }
+  return StreamDecoder(reader_, seekable_, this, field_size_);
+}
+
+Status StreamDecoder::CheckField(WireType expected_type) const {
+  PW_CHECK(!child_open_, "Decoder used while a nested reader is open");
+
+  if (!status_.ok()) {
+    return status_;
+  }
+  if (field_key_ == 0u || field_consumed_ ||
+      field_wire_type() != expected_type) {
+    return Status::FailedPrecondition();
+  }
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadVarint(uint64_t* out) {
+  PW_TRY(CheckField(WireType::kVarint));
+  if (Status status = ConsumeVarint(out); !status.ok()) {
+    return Fail(status);
+  }
+  field_consumed_ = true;
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadFixed(std::span<std::byte> out,
+                                WireType expected_type) {
+  PW_TRY(CheckField(expected_type));
+  if (Status status = Consume(out); !status.ok()) {
+    return Fail(status);
+  }
+  field_consumed_ = true;
+  return OkStatus();
+}
+
+Status StreamDecoder::ConsumeVarint(uint64_t* out, bool* end) {
+  // The stream cannot be peeked, so read one byte at a time until the last
+  // byte of the varint.
+  std::array<std::byte, varint::kMaxVarint64SizeBytes> buffer;
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    if (remaining_ == 0u) {
+      return Status::DataLoss();
+    }
+
+    Result<ByteSpan> result = reader_.Read(std::span(buffer).subspan(i, 1));
+    if (!result.ok()) {
+      if (end != nullptr && i == 0u && result.status().IsOutOfRange()) {
+        *end = true;
+      }
+      return Status::DataLoss();
+    }
+    if (bounded()) {
+      remaining_ -= 1;
+    }
+
+    if ((buffer[i] & std::byte{0x80}) == std::byte{0}) {
+      return varint::Decode(std::span(buffer).first(i + 1), out) == 0u
+                 ? Status::DataLoss()
+                 : OkStatus();
+    }
+  }
+  return Status::DataLoss();
+}
+
+Status StreamDecoder::Consume(ByteSpan out) {
+  if (out.size() > remaining_) {
+    return Status::DataLoss();
+  }
+
+  while (!out.empty()) {
+    Result<ByteSpan> result = reader_.Read(out);
+    if (!result.ok()) {
+      return Status::DataLoss();
+    }
+    out = out.subspan(result.value().size());
+    if (bounded()) {
+      remaining_ -= result.value().size();
+    }
+  }
+  return OkStatus();
+}
+
+Status StreamDecoder::Discard(size_t bytes) {
+  if (seekable_ != nullptr && bytes != 0u) {
+    if (bytes > static_cast<size_t>(std::numeric_limits<ptrdiff_t>::max()) ||
+        !seekable_->Seek(static_cast<ptrdiff_t>(bytes), stream::Whence::kCurrent)
+             .ok()) {
+      return Status::DataLoss();
+    }
+    return OkStatus();
+  }
+
+  std::array<std::byte, 16> buffer;
+  while (bytes != 0u) {
+    Result<ByteSpan> result =
+        reader_.Read(std::span(buffer).first(std::min(bytes, buffer.size())));
+    if (!result.ok()) {
+      return Status::DataLoss();
+    }
+    bytes -= result.value().size();
+  }
+  return OkStatus();
+}
+
+Status StreamDecoder::SkipField() {
+  field_consumed_ = true;
+
+  if (field_wire_type() == WireType::kVarint) {
+    uint64_t value;
+    return ConsumeVarint(&value);
+  }
+
+  if (field_size_ > remaining_) {
+    return Status::DataLoss();
+  }
+  if (bounded()) {
+    remaining_ -= field_size_;
+  }
+  return Discard(field_size_);
+}
+
+Status StreamDecoder::OpenChild() {
+  PW_TRY(CheckField(WireType::kDelimited));
+
+  // The child reads the payload, so it no longer counts against this message.
+  if (bounded()) {
+    remaining_ -= field_size_;
+  }
+  field_consumed_ = true;
+  child_open_ = true;
+  return OkStatus();
+}
+
+void StreamDecoder::CloseChild(Status child_status, size_t unread_bytes) {
+  PW_CHECK(child_open_);
+  child_open_ = false;
+
+  // A child that hit an error may have left the stream anywhere in the field.
+  if (!child_status.ok()) {
+    Fail(Status::DataLoss());
+    return;
+  }
+  if (Status status = Discard(unread_bytes); !status.ok()) {
+    Fail(status);
+  }
+}
+
+}  // namespace pw::protobuf
@@ -0,0 +1,325 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_protobuf/stream_decoder.h"
+
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::protobuf {
+namespace {
+
+// Reader that returns at most one byte per read, to exercise partial reads.
+class OneByteReader : public stream::Reader {
+ public:
+  constexpr OneByteReader(ConstByteSpan data) : data_(data) {}
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override {
+    if (data_.empty()) {
+      return StatusWithSize::OutOfRange();
+    }
+    dest[0] = data_[0];
+    data_ = data_.subspan(1);
+    return StatusWithSize(1);
+  }
+
+  ConstByteSpan data_;
+};
+
+// MemoryReader that counts the bytes read, to check that skipped data is
+// seeked over.
+class CountingSeekableReader : public stream::SeekableReader {
+ public:
+  constexpr CountingSeekableReader(ConstByteSpan data) : reader_(data) {}
+
+  size_t bytes_read = 0;
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override {
+    Result<ByteSpan> result = reader_.Read(dest);
+    if (!result.ok()) {
+      return StatusWithSize(result.status(), 0);
+    }
+    bytes_read += result.value().size();
+    return StatusWithSize(result.value().size());
+  }
+
+  Status DoSeek(ptrdiff_t offset, stream::Whence origin) override {
+    return reader_.Seek(offset, origin);
+  }
+
+  size_t DoTell() const override { return reader_.Tell(); }
+
+  stream::MemoryReader reader_;
+};
+
+// clang-format off
+constexpr uint8_t kEncodedProto[] = {
+  // type=int32, k=1, v=42
+  0x08, 0x2a,
+  // type=sint32, k=2, v=-13
+  0x10, 0x19,
+  // type=bool, k=3, v=false
+  0x18, 0x00,
+  // type=double, k=4, v=3.14159
+  0x21, 0x6e, 0x86, 0x1b, 0xf0, 0xf9, 0x21, 0x09, 0x40,
+  // type=fixed32, k=5, v=0xdeadbeef
+  0x2d, 0xef, 0xbe, 0xad, 0xde,
+  // type=string, k=6, v="Hello world"
+  0x32, 0x0b, 'H', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd',
+  // type=message, k=7, v={type=uint32, k=1, v=5; type=string, k=2, v="hi"}
+  0x3a, 0x06, 0x08, 0x05, 0x12, 0x02, 'h', 'i',
+  // type=sint64, k=8, v=-1
+  0x40, 0x01,
+};
+// clang-format on
+
+TEST(StreamDecoder, Decodes) {
+  stream::MemoryReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 1u);
+  int32_t v1 = 0;
+  EXPECT_EQ(decoder.ReadInt32(&v1), OkStatus());
+  EXPECT_EQ(v1, 42);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 2u);
+  int32_t v2 = 0;
+  EXPECT_EQ(decoder.ReadSint32(&v2), OkStatus());
+  EXPECT_EQ(v2, -13);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 3u);
+  bool v3 = true;
+  EXPECT_EQ(decoder.ReadBool(&v3), OkStatus());
+  EXPECT_FALSE(v3);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 4u);
+  double v4 = 0;
+  EXPECT_EQ(decoder.ReadDouble(&v4), OkStatus());
+  EXPECT_EQ(v4, 3.14159);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 5u);
+  uint32_t v5 = 0;
+  EXPECT_EQ(decoder.ReadFixed32(&v5), OkStatus());
+  EXPECT_EQ(v5, 0xdeadbeef);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 6u);
+  std::array<char, 16> v6;
+  StatusWithSize result = decoder.ReadString(v6);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(std::string_view(v6.data(), result.size()), "Hello world");
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 7u);
+  {
+    StreamDecoder nested = decoder.GetNestedDecoder();
+    ASSERT_EQ(nested.Next(), OkStatus());
+    ASSERT_EQ(nested.FieldNumber(), 1u);
+    uint32_t value = 0;
+    EXPECT_EQ(nested.ReadUint32(&value), OkStatus());
+    EXPECT_EQ(value, 5u);
+
+    ASSERT_EQ(nested.Next(), OkStatus());
+    ASSERT_EQ(nested.FieldNumber(), 2u);
+    std::array<char, 2> str;
+    EXPECT_EQ(nested.ReadString(str).size(), 2u);
+    EXPECT_EQ(std::memcmp(str.data(), "hi", 2), 0);
+
+    EXPECT_EQ(nested.Next(), Status::OutOfRange());
+  }
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 8u);
+  int64_t v8 = 0;
+  EXPECT_EQ(decoder.ReadSint64(&v8), OkStatus());
+  EXPECT_EQ(v8, -1);
+
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(StreamDecoder, SkipsUnreadFields) {
+  OneByteReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader);
+
+  uint32_t field_numbers = 0;
+  int64_t v8 = 0;
+  while (decoder.Next().ok()) {
+    field_numbers += decoder.FieldNumber();
+    if (decoder.FieldNumber() == 8u) {
+      EXPECT_EQ(decoder.ReadSint64(&v8), OkStatus());
+    }
+  }
+
+  EXPECT_EQ(field_numbers, 1u + 2 + 3 + 4 + 5 + 6 + 7 + 8);
+  EXPECT_EQ(v8, -1);
+}
+
+TEST(StreamDecoder, NestedDecoderSkipsUnreadFields) {
+  stream::MemoryReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader);
+
+  while (decoder.Next().ok() && decoder.FieldNumber() != 7u) {
+  }
+  {
+    StreamDecoder nested = decoder.GetNestedDecoder();
+    ASSERT_EQ(nested.Next(), OkStatus());
+    EXPECT_EQ(nested.FieldNumber(), 1u);
+  }
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.FieldNumber(), 8u);
+}
+
+TEST(StreamDecoder, SeekableReader_SeeksOverSkippedFields) {
+  CountingSeekableReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader);
+
+  while (decoder.Next().ok() && decoder.FieldNumber() != 7u) {
+  }
+  {
+    StreamDecoder nested = decoder.GetNestedDecoder();
+    ASSERT_EQ(nested.Next(), OkStatus());
+    EXPECT_EQ(nested.FieldNumber(), 1u);
+  }
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.FieldNumber(), 8u);
+  int64_t v8 = 0;
+  EXPECT_EQ(decoder.ReadSint64(&v8), OkStatus());
+  EXPECT_EQ(v8, -1);
+
+  // The double, fixed32, and string payloads and everything in the nested
+  // message after its first key were not read.
+  EXPECT_EQ(reader.bytes_read, sizeof(kEncodedProto) - 8 - 4 - 11 - 5);
+}
+
+TEST(StreamDecoder, BytesReader) {
+  OneByteReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader);
+
+  while (decoder.Next().ok() && decoder.FieldNumber() != 6u) {
+  }
+  EXPECT_EQ(decoder.FieldSize().size(), 11u);
+  {
+    StreamDecoder::BytesReader bytes_reader = decoder.GetBytesReader();
+    EXPECT_EQ(bytes_reader.remaining(), 11u);
+
+    std::array<std::byte, 5> buffer;
+    Result<ByteSpan> result = bytes_reader.Read(buffer);
+    ASSERT_EQ(result.status(), OkStatus());
+    EXPECT_EQ(result.value().size(), 1u);
+    EXPECT_EQ(buffer[0], std::byte{'H'});
+    EXPECT_EQ(bytes_reader.remaining(), 10u);
+  }
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.FieldNumber(), 7u);
+}
+
+TEST(StreamDecoder, BytesReader_ReadsToEnd) {
+  stream::MemoryReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader);
+
+  while (decoder.Next().ok() && decoder.FieldNumber() != 6u) {
+  }
+  StreamDecoder::BytesReader bytes_reader = decoder.GetBytesReader();
+
+  std::array<std::byte, 32> buffer;
+  Result<ByteSpan> result = bytes_reader.Read(buffer);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.value().size(), 11u);
+  EXPECT_EQ(bytes_reader.Read(buffer).status(), Status::OutOfRange());
+}
+
+TEST(StreamDecoder, ReadBytes_BufferTooSmall) {
+  stream::MemoryReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader);
+
+  while (decoder.Next().ok() && decoder.FieldNumber() != 6u) {
+  }
+
+  std::array<char, 4> small;
+  EXPECT_EQ(decoder.ReadString(small).status(), Status::ResourceExhausted());
+
+  // The field was not consumed, so it can still be read.
+  std::array<char, 11> exact;
+  EXPECT_EQ(decoder.ReadString(exact).status(), OkStatus());
+  EXPECT_EQ(decoder.ReadString(exact).status(), Status::FailedPrecondition());
+}
+
+TEST(StreamDecoder, WrongWireType) {
+  stream::MemoryReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  uint32_t fixed = 0;
+  EXPECT_EQ(decoder.ReadFixed32(&fixed), Status::FailedPrecondition());
+  std::array<std::byte, 4> bytes;
+  EXPECT_EQ(decoder.ReadBytes(bytes).status(), Status::FailedPrecondition());
+
+  StreamDecoder nested = decoder.GetNestedDecoder();
+  EXPECT_EQ(nested.Next(), Status::FailedPrecondition());
+}
+
+TEST(StreamDecoder, BoundedLength) {
+  stream::MemoryReader reader(std::as_bytes(std::span(kEncodedProto)));
+
+  // Only decode the first two fields.
+  StreamDecoder decoder(reader, 4);
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.FieldNumber(), 2u);
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+  EXPECT_EQ(reader.bytes_read(), 4u);
+}
+
+TEST(StreamDecoder, Truncated) {
+  // type=string, k=6, length 11 with only 2 bytes.
+  constexpr uint8_t encoded_proto[] = {0x08, 0x01, 0x32, 0x0b, 'H', 'e'};
+  stream::MemoryReader reader(std::as_bytes(std::span(encoded_proto)));
+  StreamDecoder decoder(reader);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.Next(), Status::DataLoss());
+  EXPECT_EQ(decoder.Next(), Status::DataLoss());
+}
+
+TEST(StreamDecoder, NestedLengthExceedsParent) {
+  // type=message, k=1, length 4, containing a string field of length 8.
+  constexpr uint8_t encoded_proto[] = {
+      0x0a, 0x04, 0x0a, 0x08, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'};
+  stream::MemoryReader reader(std::as_bytes(std::span(encoded_proto)));
+  StreamDecoder decoder(reader);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  {
+    StreamDecoder nested = decoder.GetNestedDecoder();
+    EXPECT_EQ(nested.Next(), Status::DataLoss());
+  }
+  EXPECT_EQ(decoder.Next(), Status::DataLoss());
+}
+
+}  // namespace
+}  // namespace pw::protobuf
@@ -56,6 +56,22 @@ StreamingEncoder StreamingEncoder::GetNestedEncoder(uint32_t field_number) {
   return StreamingEncoder(*this, nested_buffer);
 }
 
+StreamingEncoder StreamingEncoder::GetNestedEncoder(uint32_t field_number,
+                                                    size_t encoded_size) {
+  PW_CHECK(!nested_encoder_open());
+
+  // The key and length are written up front, so the nested encoder can write
+  // the submessage directly to this encoder's writer.
+  if (UpdateStatusForWrite(field_number, WireType::kDelimited, encoded_size)
+          .ok()) {
+    WriteVarint(MakeKey(field_number, WireType::kDelimited));
+    WriteVarint(encoded_size);
+  }
+
+  nested_field_number_ = field_number;
+  return StreamingEncoder(*this, writer_, status_, encoded_size);
+}
+
 Status StreamingEncoder::Finalize() {
   // If an encoder has no parent, finalize is a no-op.
   if (parent_ == nullptr) {
@@ -96,6 +112,15 @@ Status StreamingEncoder::FinalizeNestedMessage(StreamingEncoder& nested) {
   status_.Update(nested.status_);
   PW_TRY(status_);
 
+  // A sized submessage was written in place. The length prefix written when
+  // it was opened is only correct if the submessage filled its declared size.
+  if (nested.sized()) {
+    if (nested.remaining_size_ != 0u) {
+      status_ = Status::DataLoss();
+    }
+    return status_;
+  }
+
   if (varint::EncodedSize(nested.memory_writer_.bytes_written()) >
       config::kMaxVarintSize) {
     status_ = Status::OutOfRange();
@@ -177,6 +202,13 @@ Status StreamingEncoder::WritePackedFixed(uint32_t field_number,
   WriteVarint(MakeKey(field_number, WireType::kDelimited));
   WriteVarint(values.size_bytes());
 
+  // On little-endian systems the in-memory representation is the wire format,
+  // so the values are written in a single call.
+  if constexpr (std::endian::native == std::endian::little) {
+    status_.Update(writer_.Write(values));
+    return status_;
+  }
+
   for (auto val_start = values.begin(); val_start != values.end();
        val_start += elem_size) {
     // Allocates 8 bytes so both 4-byte and 8-byte types can be encoded as
@@ -213,6 +245,12 @@ Status StreamingEncoder::UpdateStatusForWrite(uint32_t field_number,
 
   if (size > writer_.ConservativeWriteLimit()) {
     status_ = Status::ResourceExhausted();
+  } else if (sized()) {
+    if (size > remaining_size_) {
+      status_ = Status::OutOfRange();
+    } else {
+      remaining_size_ -= size;
+    }
   }
   return status_;
 }
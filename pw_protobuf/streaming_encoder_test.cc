@@ -14,10 +14,14 @@
 
 #include "pw_protobuf/streaming_encoder.h"
 
+#include <algorithm>
+#include <iterator>
 #include <span>
 
 #include "gtest/gtest.h"
 #include "pw_bytes/span.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/serialized_size.h"
 #include "pw_stream/memory_stream.h"
 
 namespace pw::protobuf {
@@ -247,6 +251,136 @@ TEST(StreamingEncoder, Nested) {
             0);
 }
 
+TEST(StreamingEncoder, NestedSized) {
+  constexpr size_t kPair0Size =
+      SizeOfDelimitedField(kDoubleNestedProtoKeyField, 7) +
+      SizeOfDelimitedField(kDoubleNestedProtoValueField, 5);
+  constexpr size_t kPair1Size =
+      SizeOfDelimitedField(kDoubleNestedProtoKeyField, 6) +
+      SizeOfDelimitedField(kDoubleNestedProtoValueField, 8);
+  constexpr size_t kNestedSize =
+      SizeOfDelimitedField(kNestedProtoHelloField, 5) +
+      SizeOfDelimitedField(kNestedProtoPairField, kPair0Size) +
+      SizeOfVarintField(kNestedProtoIdField, 999) +
+      SizeOfDelimitedField(kNestedProtoPairField, kPair1Size);
+  static_assert(kNestedSize == 0x30);
+
+  // Sized nested encoders write directly to the stream; no scratch buffer is
+  // needed.
+  std::byte dest_buffer[128];
+  MemoryWriter writer(dest_buffer);
+  StreamingEncoder encoder(writer, ByteSpan());
+
+  EXPECT_EQ(encoder.WriteUint32(kTestProtoMagicNumberField, 42), OkStatus());
+  {
+    StreamingEncoder nested_proto =
+        encoder.GetNestedEncoder(kTestProtoNestedField, kNestedSize);
+    EXPECT_EQ(nested_proto.WriteString(kNestedProtoHelloField, "world"),
+              OkStatus());
+    {
+      StreamingEncoder double_nested_proto =
+          nested_proto.GetNestedEncoder(kNestedProtoPairField, kPair0Size);
+      EXPECT_EQ(double_nested_proto.WriteString(kDoubleNestedProtoKeyField,
+                                                "version"),
+                OkStatus());
+      EXPECT_EQ(double_nested_proto.WriteString(kDoubleNestedProtoValueField,
+                                                "2.9.1"),
+                OkStatus());
+      EXPECT_EQ(double_nested_proto.Finalize(), OkStatus());
+    }
+    EXPECT_EQ(nested_proto.WriteUint32(kNestedProtoIdField, 999), OkStatus());
+    {
+      StreamingEncoder double_nested_proto =
+          nested_proto.GetNestedEncoder(kNestedProtoPairField, kPair1Size);
+      EXPECT_EQ(
+          double_nested_proto.WriteString(kDoubleNestedProtoKeyField, "device"),
+          OkStatus());
+      EXPECT_EQ(double_nested_proto.WriteString(kDoubleNestedProtoValueField,
+                                                "left-soc"),
+                OkStatus());
+    }
+    EXPECT_EQ(nested_proto.Finalize(), OkStatus());
+  }
+  EXPECT_EQ(encoder.WriteSint32(kTestProtoZiggyField, -13), OkStatus());
+
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    0x08, 0x2a,
+    0x32, 0x30,
+    0x0a, 0x05, 'w', 'o', 'r', 'l', 'd',
+    0x1a, 0x10,
+    0x0a, 0x07, 'v', 'e', 'r', 's', 'i', 'o', 'n',
+    0x12, 0x05, '2', '.', '9', '.', '1',
+    0x10, 0xe7, 0x07,
+    0x1a, 0x12,
+    0x0a, 0x06, 'd', 'e', 'v', 'i', 'c', 'e',
+    0x12, 0x08, 'l', 'e', 'f', 't', '-', 's', 'o', 'c',
+    0x10, 0x19
+  };
+  // clang-format on
+
+  ASSERT_EQ(encoder.status(), OkStatus());
+  ConstByteSpan result = ConstByteSpan(writer.data(), writer.bytes_written());
+  EXPECT_EQ(result.size(), sizeof(encoded_proto));
+  EXPECT_EQ(std::memcmp(result.data(), encoded_proto, sizeof(encoded_proto)),
+            0);
+}
+
+TEST(StreamingEncoder, NestedSizedInMemoryEncoder) {
+  std::byte encode_buffer[32];
+  MemoryEncoder encoder(encode_buffer);
+
+  {
+    StreamingEncoder child = encoder.GetNestedEncoder(
+        kTestProtoNestedField, SizeOfVarintField(kNestedProtoIdField, 999));
+    EXPECT_EQ(child.WriteUint32(kNestedProtoIdField, 999), OkStatus());
+  }
+  EXPECT_EQ(encoder.WriteSint32(kTestProtoZiggyField, -13), OkStatus());
+
+  constexpr uint8_t encoded_proto[] = {
+      0x32, 0x03, 0x10, 0xe7, 0x07, 0x10, 0x19};
+
+  ASSERT_EQ(encoder.status(), OkStatus());
+  ConstByteSpan result(encoder);
+  EXPECT_EQ(result.size(), sizeof(encoded_proto));
+  EXPECT_EQ(std::memcmp(result.data(), encoded_proto, sizeof(encoded_proto)),
+            0);
+}
+
+TEST(StreamingEncoder, NestedSizedWriteTooBig) {
+  std::byte encode_buffer[32];
+  MemoryEncoder encoder(encode_buffer);
+
+  {
+    StreamingEncoder child = encoder.GetNestedEncoder(kTestProtoNestedField, 2);
+    EXPECT_EQ(child.WriteUint32(kNestedProtoIdField, 999),
+              Status::OutOfRange());
+  }
+  EXPECT_EQ(encoder.status(), Status::OutOfRange());
+}
+
+TEST(StreamingEncoder, NestedSizedTooShort) {
+  std::byte encode_buffer[32];
+  MemoryEncoder encoder(encode_buffer);
+
+  {
+    StreamingEncoder child = encoder.GetNestedEncoder(kTestProtoNestedField, 4);
+    EXPECT_EQ(child.WriteUint32(kNestedProtoIdField, 999), OkStatus());
+    EXPECT_EQ(child.Finalize(), Status::DataLoss());
+  }
+  EXPECT_EQ(encoder.status(), Status::DataLoss());
+}
+
+TEST(StreamingEncoder, NestedSizedRequiresSizedChildren) {
+  std::byte encode_buffer[32];
+  MemoryEncoder encoder(encode_buffer);
+
+  StreamingEncoder child = encoder.GetNestedEncoder(kTestProtoNestedField, 8);
+  StreamingEncoder grandchild =
+      child.GetNestedEncoder(kNestedProtoPairField);
+  EXPECT_EQ(grandchild.status(), Status::ResourceExhausted());
+}
+
 TEST(StreamingEncoder, RepeatedField) {
   std::byte encode_buffer[32];
   MemoryEncoder encoder(encode_buffer);
@@ -286,6 +420,26 @@ TEST(StreamingEncoder, PackedVarint) {
             0);
 }
 
+TEST(StreamingEncoder, PackedVarintLargerThanChunk) {
+  // Enough values to be written in several chunks.
+  std::array<uint32_t, 100> values;
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<uint32_t>(i * 1000003u);
+  }
+
+  std::byte encode_buffer[600];
+  MemoryEncoder encoder(encode_buffer);
+  ASSERT_EQ(encoder.WritePackedUint32(1, values), OkStatus());
+
+  Decoder decoder(encoder);
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  std::array<uint32_t, 100> decoded{};
+  StatusWithSize result = decoder.ReadPackedUint32(decoded);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), values.size());
+  EXPECT_EQ(decoded, values);
+}
+
 TEST(StreamingEncoder, PackedVarintInsufficientSpace) {
   std::byte encode_buffer[8];
   MemoryEncoder encoder(encode_buffer);
@@ -404,5 +558,44 @@ TEST(StreamingEncoder, NestedStatusPropagates) {
   ASSERT_EQ(parent.status(), Status::InvalidArgument());
 }
 
+TEST(StreamingEncoder, MaxSizeBoundsRepeatedFields) {
+  constexpr uint32_t kValues[] = {0xffffffff, 0xffffffff, 0xffffffff};
+  constexpr size_t kMaxSize = SumOfMaxSizes(
+      MaxSizeOfRepeatedScalarField(
+          kTestProtoMagicNumberField, std::size(kValues), kMaxSizeBytesUint32),
+      MaxSizeOfDelimitedField(kTestProtoErrorMessageField, 4));
+
+  std::byte packed_buffer[kMaxSize];
+  MemoryEncoder packed(packed_buffer);
+  EXPECT_EQ(packed.WritePackedUint32(kTestProtoMagicNumberField, kValues),
+            OkStatus());
+  EXPECT_EQ(packed.WriteString(kTestProtoErrorMessageField, "four"),
+            OkStatus());
+  EXPECT_EQ(packed.status(), OkStatus());
+
+  std::byte unpacked_buffer[kMaxSize];
+  MemoryEncoder unpacked(unpacked_buffer);
+  for (uint32_t value : kValues) {
+    EXPECT_EQ(unpacked.WriteUint32(kTestProtoMagicNumberField, value),
+              OkStatus());
+  }
+  EXPECT_EQ(unpacked.WriteString(kTestProtoErrorMessageField, "four"),
+            OkStatus());
+  EXPECT_EQ(unpacked.status(), OkStatus());
+  EXPECT_EQ(std::max(packed.size(), unpacked.size()), kMaxSize);
+}
+
+TEST(StreamingEncoder, MaxSizeUnboundedPropagates) {
+  static_assert(MaxSizeOfDelimitedField(1, kMaxSizeUnbounded) ==
+                kMaxSizeUnbounded);
+  static_assert(MaxSizeOfRepeatedField(kMaxSizeUnbounded, 2) ==
+                kMaxSizeUnbounded);
+  static_assert(MaxSizeOfRepeatedField(0, kMaxSizeUnbounded) == 0u);
+  static_assert(SumOfMaxSizes() == 0u);
+  static_assert(SumOfMaxSizes(1, kMaxSizeUnbounded) == kMaxSizeUnbounded);
+  static_assert(SumOfMaxSizes(kMaxSizeUnbounded - 1, 2) == kMaxSizeUnbounded);
+  EXPECT_EQ(SumOfMaxSizes(1, 2, 3), 6u);
+}
+
 }  // namespace
 }  // namespace pw::protobuf
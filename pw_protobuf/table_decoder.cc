@@ -0,0 +1,190 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_protobuf/table_decoder.h"
+
+#include <cstring>
+#include <string_view>
+
+#include "pw_bytes/endian.h"
+#include "pw_protobuf/wire_format.h"
+#include "pw_varint/varint.h"
+
+namespace pw::protobuf {
+namespace {
+
+constexpr WireType WireTypeFor(FieldKind kind) {
+  switch (kind) {
+    case FieldKind::kVarint32:
+    case FieldKind::kVarint64:
+    case FieldKind::kZigZag32:
+    case FieldKind::kZigZag64:
+    case FieldKind::kBool:
+      return WireType::kVarint;
+    case FieldKind::kFixed32:
+      return WireType::kFixed32;
+    case FieldKind::kFixed64:
+      return WireType::kFixed64;
+    case FieldKind::kString:
+    case FieldKind::kBytes:
+      return WireType::kDelimited;
+  }
+  return WireType::kVarint;
+}
+
+// Finds the descriptor for a field. Fields are usually encoded in field number
+// order, so the entry after the previous match is checked before searching.
+const FieldDescriptor* FindField(std::span<const FieldDescriptor> table,
+                                 uint32_t field_number,
+                                 size_t& hint) {
+  if (hint < table.size() && table[hint].field_number == field_number) {
+    return &table[hint++];
+  }
+
+  size_t low = 0;
+  size_t high = table.size();
+  while (low < high) {
+    const size_t mid = low + (high - low) / 2;
+    if (table[mid].field_number < field_number) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  if (low == table.size() || table[low].field_number != field_number) {
+    return nullptr;
+  }
+  hint = low + 1;
+  return &table[low];
+}
+
+template <typename T>
+void Store(std::byte* member, T value) {
+  std::memcpy(member, &value, sizeof(value));
+}
+
+void StoreVarint(std::byte* member, FieldKind kind, uint64_t value) {
+  switch (kind) {
+    case FieldKind::kVarint32:
+      Store(member, static_cast<uint32_t>(value));
+      break;
+    case FieldKind::kVarint64:
+      Store(member, value);
+      break;
+    case FieldKind::kZigZag32:
+      Store(member, static_cast<int32_t>(varint::ZigZagDecode(value)));
+      break;
+    case FieldKind::kZigZag64:
+      Store(member, varint::ZigZagDecode(value));
+      break;
+    case FieldKind::kBool:
+      Store(member, value != 0u);
+      break;
+    default:
+      break;
+  }
+}
+
+}  // namespace
+
+Status DecodeWithTable(std::span<const std::byte> proto,
+                       std::span<const FieldDescriptor> table,
+                       void* message) {
+  size_t hint = 0;
+
+  while (!proto.empty()) {
+    uint64_t key;
+    size_t bytes = varint::Decode(proto, &key);
+    if (bytes == 0u || key > UINT32_MAX) {
+      return Status::DataLoss();
+    }
+    proto = proto.subspan(bytes);
+
+    const uint32_t field_number = static_cast<uint32_t>(key) >>
+                                  kFieldNumberShift;
+    const WireType wire_type = static_cast<WireType>(key & kWireTypeMask);
+    if (!ValidFieldNumber(field_number)) {
+      return Status::DataLoss();
+    }
+
+    const FieldDescriptor* field = FindField(table, field_number, hint);
+    if (field != nullptr && WireTypeFor(field->kind) != wire_type) {
+      return Status::DataLoss();
+    }
+    std::byte* member =
+        field == nullptr ? nullptr
+                         : static_cast<std::byte*>(message) + field->offset;
+
+    switch (wire_type) {
+      case WireType::kVarint: {
+        uint64_t value;
+        bytes = varint::Decode(proto, &value);
+        if (bytes == 0u) {
+          return Status::DataLoss();
+        }
+        if (member != nullptr) {
+          StoreVarint(member, field->kind, value);
+        }
+        break;
+      }
+      case WireType::kFixed32:
+      case WireType::kFixed64:
+        bytes = wire_type == WireType::kFixed32 ? sizeof(uint32_t)
+                                                : sizeof(uint64_t);
+        if (proto.size() < bytes) {
+          return Status::DataLoss();
+        }
+        if (member != nullptr) {
+          // Fixed-size fields are little-endian on the wire.
+          if (bytes == sizeof(uint32_t)) {
+            Store(member,
+                  bytes::ReadInOrder<uint32_t>(std::endian::little,
+                                               proto.data()));
+          } else {
+            Store(member,
+                  bytes::ReadInOrder<uint64_t>(std::endian::little,
+                                               proto.data()));
+          }
+        }
+        break;
+      case WireType::kDelimited: {
+        uint64_t length;
+        const size_t prefix = varint::Decode(proto, &length);
+        if (prefix == 0u || proto.size() - prefix < length) {
+          return Status::DataLoss();
+        }
+        const std::span<const std::byte> value =
+            proto.subspan(prefix, static_cast<size_t>(length));
+        if (member != nullptr && field->kind == FieldKind::kString) {
+          Store(member,
+                std::string_view(reinterpret_cast<const char*>(value.data()),
+                                 value.size()));
+        } else if (member != nullptr) {
+          Store(member, BytesView{value.data(), value.size()});
+        }
+        bytes = prefix + value.size();
+        break;
+      }
+      default:
+        return Status::DataLoss();  // Groups are not supported.
+    }
+
+    proto = proto.subspan(bytes);
+  }
+
+  return OkStatus();
+}
+
+}  // namespace pw::protobuf
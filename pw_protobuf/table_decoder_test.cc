@@ -0,0 +1,209 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_protobuf/table_decoder.h"
+
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+namespace pw::protobuf {
+namespace {
+
+struct TestMessage {
+  int32_t test_int32;
+  int32_t test_sint32;
+  bool test_bool;
+  double test_double;
+  uint32_t test_fixed32;
+  std::string_view test_string;
+  BytesView test_bytes;
+  uint64_t test_uint64;
+};
+
+constexpr FieldDescriptor kTestFields[] = {
+    {1, FieldKind::kVarint32, offsetof(TestMessage, test_int32)},
+    {2, FieldKind::kZigZag32, offsetof(TestMessage, test_sint32)},
+    {3, FieldKind::kBool, offsetof(TestMessage, test_bool)},
+    {4, FieldKind::kFixed64, offsetof(TestMessage, test_double)},
+    {5, FieldKind::kFixed32, offsetof(TestMessage, test_fixed32)},
+    {6, FieldKind::kString, offsetof(TestMessage, test_string)},
+    {7, FieldKind::kBytes, offsetof(TestMessage, test_bytes)},
+    {9, FieldKind::kVarint64, offsetof(TestMessage, test_uint64)},
+};
+
+static_assert(IsValidFieldTable(kTestFields));
+
+constexpr FieldDescriptor kUnsortedFields[] = {
+    {2, FieldKind::kVarint32, 0},
+    {1, FieldKind::kVarint32, 0},
+};
+
+static_assert(!IsValidFieldTable(kUnsortedFields));
+
+TEST(TableDecoder, Decode) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=int32, k=1, v=42
+    0x08, 0x2a,
+    // type=sint32, k=2, v=-13
+    0x10, 0x19,
+    // type=bool, k=3, v=true
+    0x18, 0x01,
+    // type=double, k=4, v=3.14159
+    0x21, 0x6e, 0x86, 0x1b, 0xf0, 0xf9, 0x21, 0x09, 0x40,
+    // type=fixed32, k=5, v=0xdeadbeef
+    0x2d, 0xef, 0xbe, 0xad, 0xde,
+    // type=string, k=6, v="Hello world"
+    0x32, 0x0b, 'H', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd',
+    // type=bytes, k=7, v={1, 2, 3}
+    0x3a, 0x03, 0x01, 0x02, 0x03,
+    // type=uint64, k=9, v=0x100000000
+    0x48, 0x80, 0x80, 0x80, 0x80, 0x10,
+  };
+  // clang-format on
+
+  TestMessage message = {};
+  ASSERT_EQ(OkStatus(),
+            DecodeWithTable(std::as_bytes(std::span(encoded_proto)),
+                            kTestFields,
+                            &message));
+
+  EXPECT_EQ(message.test_int32, 42);
+  EXPECT_EQ(message.test_sint32, -13);
+  EXPECT_TRUE(message.test_bool);
+  EXPECT_EQ(message.test_double, 3.14159);
+  EXPECT_EQ(message.test_fixed32, 0xdeadbeef);
+  EXPECT_EQ(message.test_string, "Hello world");
+  ASSERT_EQ(message.test_bytes.size, 3u);
+  EXPECT_EQ(message.test_bytes.data,
+            std::as_bytes(std::span(encoded_proto)).data() + 35);
+  EXPECT_EQ(message.test_bytes.span()[2], std::byte{3});
+  EXPECT_EQ(message.test_uint64, 0x100000000u);
+}
+
+TEST(TableDecoder, NegativeInt32) {
+  // int32 -1 is encoded as a 10-byte sign-extended varint.
+  constexpr uint8_t encoded_proto[] = {
+      0x08, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01};
+
+  TestMessage message = {};
+  ASSERT_EQ(OkStatus(),
+            DecodeWithTable(std::as_bytes(std::span(encoded_proto)),
+                            kTestFields,
+                            &message));
+  EXPECT_EQ(message.test_int32, -1);
+}
+
+TEST(TableDecoder, OutOfOrderAndRepeatedFields) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=fixed32, k=5, v=1
+    0x2d, 0x01, 0x00, 0x00, 0x00,
+    // type=int32, k=1, v=7
+    0x08, 0x07,
+    // type=int32, k=1, v=8
+    0x08, 0x08,
+  };
+  // clang-format on
+
+  TestMessage message = {};
+  message.test_sint32 = 99;
+  ASSERT_EQ(OkStatus(),
+            DecodeWithTable(std::as_bytes(std::span(encoded_proto)),
+                            kTestFields,
+                            &message));
+  EXPECT_EQ(message.test_fixed32, 1u);
+  EXPECT_EQ(message.test_int32, 8);
+  EXPECT_EQ(message.test_sint32, 99);  // Missing fields are unchanged.
+}
+
+TEST(TableDecoder, SkipsUnknownFields) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=uint32, k=8 (unknown), v=300
+    0x40, 0xac, 0x02,
+    // type=string, k=20 (unknown), v="hi"
+    0xa2, 0x01, 0x02, 'h', 'i',
+    // type=fixed64, k=30 (unknown)
+    0xf1, 0x01, 0, 0, 0, 0, 0, 0, 0, 0,
+    // type=int32, k=1, v=5
+    0x08, 0x05,
+  };
+  // clang-format on
+
+  TestMessage message = {};
+  ASSERT_EQ(OkStatus(),
+            DecodeWithTable(std::as_bytes(std::span(encoded_proto)),
+                            kTestFields,
+                            &message));
+  EXPECT_EQ(message.test_int32, 5);
+}
+
+TEST(TableDecoder, Empty) {
+  TestMessage message = {};
+  EXPECT_EQ(OkStatus(),
+            DecodeWithTable(
+                std::span<const std::byte>(), kTestFields, &message));
+}
+
+TEST(TableDecoder, WrongWireType_DataLoss) {
+  // type=fixed32, k=1 (which is a varint in the table)
+  constexpr uint8_t encoded_proto[] = {0x0d, 0x01, 0x00, 0x00, 0x00};
+
+  TestMessage message = {};
+  EXPECT_EQ(Status::DataLoss(),
+            DecodeWithTable(std::as_bytes(std::span(encoded_proto)),
+                            kTestFields,
+                            &message));
+}
+
+TEST(TableDecoder, Truncated_DataLoss) {
+  TestMessage message = {};
+
+  // type=string, k=6, length 11 with only 2 bytes
+  constexpr uint8_t truncated_string[] = {0x32, 0x0b, 'H', 'e'};
+  EXPECT_EQ(Status::DataLoss(),
+            DecodeWithTable(std::as_bytes(std::span(truncated_string)),
+                            kTestFields,
+                            &message));
+
+  // type=fixed32, k=5, with only 3 bytes
+  constexpr uint8_t truncated_fixed[] = {0x2d, 0xef, 0xbe, 0xad};
+  EXPECT_EQ(Status::DataLoss(),
+            DecodeWithTable(std::as_bytes(std::span(truncated_fixed)),
+                            kTestFields,
+                            &message));
+
+  // type=int32, k=1, with an unterminated varint
+  constexpr uint8_t truncated_varint[] = {0x08, 0xff};
+  EXPECT_EQ(Status::DataLoss(),
+            DecodeWithTable(std::as_bytes(std::span(truncated_varint)),
+                            kTestFields,
+                            &message));
+}
+
+TEST(TableDecoder, InvalidFieldNumber_DataLoss) {
+  // type=varint, k=0
+  constexpr uint8_t encoded_proto[] = {0x00, 0x01};
+
+  TestMessage message = {};
+  EXPECT_EQ(Status::DataLoss(),
+            DecodeWithTable(std::as_bytes(std::span(encoded_proto)),
+                            kTestFields,
+                            &message));
+}
+
+}  // namespace
+}  // namespace pw::protobuf
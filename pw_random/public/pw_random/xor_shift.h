@@ -13,6 +13,8 @@
 // the License.
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <span>
@@ -22,6 +24,65 @@
 #include "pw_status/status_with_size.h"
 
 namespace pw::random {
+namespace internal {
+
+// For information on why this constant was selected, see:
+// https://www.jstatsoft.org/article/view/v008i14
+// http://vigna.di.unimi.it/ftp/papers/xorshift.pdf
+inline constexpr uint64_t kXorShiftStarMultiplier = 0x2545F4914F6CDD1D;
+
+// State must be nonzero, or the algorithm will get stuck and always return
+// zero. A nonzero state is never advanced to zero, so this is only needed
+// before generating from a state that may have been seeded or injected with
+// zero.
+constexpr uint64_t NonzeroXorShiftState(uint64_t state) {
+  return state == 0 ? ~uint64_t{0} : state;
+}
+
+// Advances a nonzero state and returns the next value of the "xorshift*"
+// algorithm.
+constexpr uint64_t XorShiftStar(uint64_t& state) {
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * kXorShiftStarMultiplier;
+}
+
+// Entropy is injected by rotating the state by the number of entropy bits
+// before xoring the entropy with the current state. This ensures seeding
+// the random value with single bits will progressively fill the state with
+// more entropy. num_bits must be between 1 and 32.
+constexpr uint64_t InjectXorShiftEntropy(uint64_t state,
+                                         uint32_t data,
+                                         uint_fast8_t num_bits) {
+  constexpr uint_fast8_t kNumStateBits = sizeof(state) * 8;
+
+  // Rotate state.
+  uint64_t untouched_state = state >> (kNumStateBits - num_bits);
+  state = untouched_state | (state << num_bits);
+  // Zero-out all irrelevant bits, then XOR entropy into state.
+  uint64_t mask = (uint64_t{1} << num_bits) - 1;
+  return state ^ (data & mask);
+}
+
+// Injecting up to four bytes of entropy one byte at a time rotates the state
+// by 8 bits per byte, which is the same as injecting them at once as a
+// big-endian word. This calls inject with the bits of each group of up to four
+// bytes, so generators can mix entropy in fewer, larger steps.
+template <typename Inject>
+void ForEachEntropyWord(ConstByteSpan data, Inject&& inject) {
+  while (!data.empty()) {
+    const size_t word_size = std::min(data.size(), sizeof(uint32_t));
+    uint32_t word = 0;
+    for (size_t i = 0; i < word_size; ++i) {
+      word = (word << 8) | std::to_integer<uint32_t>(data[i]);
+    }
+    inject(word, static_cast<uint_fast8_t>(word_size * 8));
+    data = data.subspan(word_size);
+  }
+}
+
+}  // namespace internal
 
 // This is the "xorshift*" algorithm which is a bit stronger than plain XOR
 // shift thanks to the nonlinear transformation at the end (multiplication).
@@ -39,55 +100,122 @@ class XorShiftStarRng64 : public RandomGenerator {
   // pool.
   StatusWithSize Get(ByteSpan dest) final {
     const size_t bytes_written = dest.size_bytes();
-    while (!dest.empty()) {
-      uint64_t random = Regenerate();
-      size_t copy_size = std::min(dest.size_bytes(), sizeof(state_));
-      std::memcpy(dest.data(), &random, copy_size);
-      dest = dest.subspan(copy_size);
+
+    // Generate whole words from a local copy of the state, so that it can stay
+    // in a register rather than being stored for each word.
+    uint64_t state = internal::NonzeroXorShiftState(state_);
+    while (dest.size_bytes() >= sizeof(state)) {
+      const uint64_t random = internal::XorShiftStar(state);
+      std::memcpy(dest.data(), &random, sizeof(random));
+      dest = dest.subspan(sizeof(random));
+    }
+    if (!dest.empty()) {
+      const uint64_t random = internal::XorShiftStar(state);
+      std::memcpy(dest.data(), &random, dest.size_bytes());
     }
+    state_ = state;
 
     return StatusWithSize(bytes_written);
   }
 
-  // Entropy is injected by rotating the state by the number of entropy bits
-  // before xoring the entropy with the current state. This ensures seeding
-  // the random value with single bits will progressively fill the state with
-  // more entropy.
   void InjectEntropyBits(uint32_t data, uint_fast8_t num_bits) final {
     if (num_bits == 0) {
       return;
     } else if (num_bits > 32) {
       num_bits = 32;
     }
+    state_ = internal::InjectXorShiftEntropy(state_, data, num_bits);
+  }
 
-    // Rotate state.
-    uint64_t untouched_state = state_ >> (kNumStateBits - num_bits);
-    state_ = untouched_state | (state_ << num_bits);
-    // Zero-out all irrelevant bits, then XOR entropy into state.
-    uint32_t mask = (1 << num_bits) - 1;
-    state_ ^= (data & mask);
+  // Mixes entropy in 32-bit words. The result is the same as injecting it one
+  // byte at a time.
+  void InjectEntropy(ConstByteSpan data) final {
+    uint64_t state = state_;
+    internal::ForEachEntropyWord(
+        data, [&state](uint32_t word, uint_fast8_t num_bits) {
+          state = internal::InjectXorShiftEntropy(state, word, num_bits);
+        });
+    state_ = state;
   }
 
  private:
-  // Calculate and return the next value based on the "xorshift*" algorithm
-  uint64_t Regenerate() {
-    // State must be nonzero, or the algorithm will get stuck and always return
-    // zero.
-    if (state_ == 0) {
-      state_--;
+  uint64_t state_;
+};
+
+// Runs kLanes independent xorshift* generators side by side, and fills buffers
+// with one word from each lane at a time. The lanes have no data dependencies
+// on each other, so on hosts the compiler can vectorize each round, which makes
+// filling large buffers, such as for test data, much faster than with
+// XorShiftStarRng64.
+//
+// The lanes are seeded with successive outputs of a XorShiftStarRng64 with the
+// initial seed, so the output differs from XorShiftStarRng64. Entropy is
+// injected into every lane.
+//
+// Like XorShiftStarRng64, this generator is NOT cryptographically secure. Its
+// state is kLanes times as large, so it is best suited to host builds.
+template <size_t kLanes = 4>
+class MultiLaneXorShiftStarRng64 : public RandomGenerator {
+ public:
+  static_assert(kLanes > 0);
+
+  MultiLaneXorShiftStarRng64(uint64_t initial_seed) {
+    uint64_t seed = internal::NonzeroXorShiftState(initial_seed);
+    for (uint64_t& state : state_) {
+      state = internal::XorShiftStar(seed);
+    }
+  }
+
+  StatusWithSize Get(ByteSpan dest) final {
+    const size_t bytes_written = dest.size_bytes();
+
+    for (uint64_t& state : state_) {
+      state = internal::NonzeroXorShiftState(state);
+    }
+    uint64_t round[kLanes];
+    while (dest.size_bytes() >= sizeof(round)) {
+      NextRound(round);
+      std::memcpy(dest.data(), round, sizeof(round));
+      dest = dest.subspan(sizeof(round));
+    }
+    if (!dest.empty()) {
+      NextRound(round);
+      std::memcpy(dest.data(), round, dest.size_bytes());
+    }
+
+    return StatusWithSize(bytes_written);
+  }
+
+  void InjectEntropyBits(uint32_t data, uint_fast8_t num_bits) final {
+    if (num_bits == 0) {
+      return;
+    } else if (num_bits > 32) {
+      num_bits = 32;
+    }
+    for (uint64_t& state : state_) {
+      state = internal::InjectXorShiftEntropy(state, data, num_bits);
+    }
+  }
+
+  // Mixes entropy in 32-bit words. The result is the same as injecting it one
+  // byte at a time.
+  void InjectEntropy(ConstByteSpan data) final {
+    internal::ForEachEntropyWord(
+        data, [this](uint32_t word, uint_fast8_t num_bits) {
+          for (uint64_t& state : state_) {
+            state = internal::InjectXorShiftEntropy(state, word, num_bits);
+          }
+        });
+  }
+
+ private:
+  void NextRound(uint64_t (&round)[kLanes]) {
+    for (size_t i = 0; i < kLanes; ++i) {
+      round[i] = internal::XorShiftStar(state_[i]);
     }
-    state_ ^= state_ >> 12;
-    state_ ^= state_ << 25;
-    state_ ^= state_ >> 27;
-    return state_ * kMultConst;
   }
-  uint64_t state_;
-  static constexpr uint8_t kNumStateBits = sizeof(state_) * 8;
 
-  // For information on why this constant was selected, see:
-  // https://www.jstatsoft.org/article/view/v008i14
-  // http://vigna.di.unimi.it/ftp/papers/xorshift.pdf
-  static constexpr uint64_t kMultConst = 0x2545F4914F6CDD1D;
+  uint64_t state_[kLanes];
 };
 
 }  // namespace pw::random
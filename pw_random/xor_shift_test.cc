@@ -13,6 +13,7 @@
 // the License.
 #include "pw_random/xor_shift.h"
 
+#include <array>
 #include <cinttypes>
 #include <cstddef>
 #include <cstdint>
@@ -118,5 +119,138 @@ TEST(XorShiftStarRng64, InjectEntropy) {
   EXPECT_NE(val, result1[0]);
 }
 
+TEST(XorShiftStarRng64, BulkGetMatchesWordByWord) {
+  XorShiftStarRng64 bulk_rng(seed1);
+  std::array<uint64_t, result1_count> bulk;
+  EXPECT_EQ(bulk_rng.Get(std::as_writable_bytes(std::span(bulk))).status(),
+            OkStatus());
+
+  for (size_t i = 0; i < result1_count; ++i) {
+    EXPECT_EQ(bulk[i], result1[i]);
+  }
+}
+
+TEST(XorShiftStarRng64, BulkGetPartialWord) {
+  XorShiftStarRng64 rng(seed1);
+  std::array<std::byte, 2 * sizeof(uint64_t) + 3> bytes;
+  StatusWithSize result = rng.Get(bytes);
+  EXPECT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.size(), bytes.size());
+
+  // The partial word uses a whole value, so the next value is the fourth.
+  uint64_t val = 0;
+  EXPECT_EQ(rng.GetInt(val).status(), OkStatus());
+  EXPECT_EQ(val, result1[3]);
+}
+
+TEST(XorShiftStarRng64, InjectEntropyMatchesByteByByte) {
+  constexpr std::array<const std::byte, 7> entropy{std::byte(0xaf),
+                                                   std::byte(0x9b),
+                                                   std::byte(0x33),
+                                                   std::byte(0x17),
+                                                   std::byte(0x02),
+                                                   std::byte(0xc4),
+                                                   std::byte(0x81)};
+  XorShiftStarRng64 rng_1(seed1);
+  rng_1.InjectEntropy(entropy);
+  uint64_t first_val = 0;
+  EXPECT_EQ(rng_1.GetInt(first_val).status(), OkStatus());
+
+  XorShiftStarRng64 rng_2(seed1);
+  for (std::byte b : entropy) {
+    rng_2.InjectEntropyBits(std::to_integer<uint32_t>(b), 8);
+  }
+  uint64_t second_val = 0;
+  EXPECT_EQ(rng_2.GetInt(second_val).status(), OkStatus());
+
+  EXPECT_EQ(first_val, second_val);
+}
+
+TEST(XorShiftStarRng64, InjectEntropyBits32) {
+  XorShiftStarRng64 rng_1(seed1);
+  rng_1.InjectEntropyBits(0x12345678, 32);
+  uint64_t first_val = 0;
+  EXPECT_EQ(rng_1.GetInt(first_val).status(), OkStatus());
+
+  XorShiftStarRng64 rng_2(seed1);
+  rng_2.InjectEntropyBits(0x1234, 16);
+  rng_2.InjectEntropyBits(0x5678, 16);
+  uint64_t second_val = 0;
+  EXPECT_EQ(rng_2.GetInt(second_val).status(), OkStatus());
+
+  EXPECT_EQ(first_val, second_val);
+}
+
+TEST(MultiLaneXorShiftStarRng64, SameSeedSameSeries) {
+  MultiLaneXorShiftStarRng64<4> rng_1(seed1);
+  MultiLaneXorShiftStarRng64<4> rng_2(seed1);
+  std::array<uint64_t, 9> first;
+  std::array<uint64_t, 9> second;
+  EXPECT_EQ(rng_1.Get(std::as_writable_bytes(std::span(first))).status(),
+            OkStatus());
+  EXPECT_EQ(rng_2.Get(std::as_writable_bytes(std::span(second))).status(),
+            OkStatus());
+  EXPECT_EQ(first, second);
+
+  // Each lane produces a different series.
+  EXPECT_NE(first[0], first[1]);
+  EXPECT_NE(first[1], first[2]);
+  EXPECT_NE(first[2], first[3]);
+}
+
+TEST(MultiLaneXorShiftStarRng64, BulkGetMatchesRoundByRound) {
+  MultiLaneXorShiftStarRng64<4> bulk_rng(seed2);
+  std::array<uint64_t, 12> bulk;
+  EXPECT_EQ(bulk_rng.Get(std::as_writable_bytes(std::span(bulk))).status(),
+            OkStatus());
+
+  MultiLaneXorShiftStarRng64<4> round_rng(seed2);
+  for (size_t i = 0; i < bulk.size(); i += 4) {
+    std::array<uint64_t, 4> round;
+    EXPECT_EQ(round_rng.Get(std::as_writable_bytes(std::span(round))).status(),
+              OkStatus());
+    for (size_t lane = 0; lane < round.size(); ++lane) {
+      EXPECT_EQ(round[lane], bulk[i + lane]);
+    }
+  }
+}
+
+TEST(MultiLaneXorShiftStarRng64, GetPartialRound) {
+  MultiLaneXorShiftStarRng64<4> rng(seed1);
+  std::array<std::byte, 5> bytes;
+  StatusWithSize result = rng.Get(bytes);
+  EXPECT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.size(), bytes.size());
+}
+
+TEST(MultiLaneXorShiftStarRng64, InjectEntropy) {
+  constexpr std::array<const std::byte, 5> entropy{std::byte(0xaf),
+                                                   std::byte(0x9b),
+                                                   std::byte(0x33),
+                                                   std::byte(0x17),
+                                                   std::byte(0x02)};
+  MultiLaneXorShiftStarRng64<2> rng_1(seed1);
+  rng_1.InjectEntropy(entropy);
+  std::array<uint64_t, 2> first;
+  EXPECT_EQ(rng_1.Get(std::as_writable_bytes(std::span(first))).status(),
+            OkStatus());
+
+  MultiLaneXorShiftStarRng64<2> rng_2(seed1);
+  for (std::byte b : entropy) {
+    rng_2.InjectEntropyBits(std::to_integer<uint32_t>(b), 8);
+  }
+  std::array<uint64_t, 2> second;
+  EXPECT_EQ(rng_2.Get(std::as_writable_bytes(std::span(second))).status(),
+            OkStatus());
+  EXPECT_EQ(first, second);
+
+  MultiLaneXorShiftStarRng64<2> rng_3(seed1);
+  std::array<uint64_t, 2> without_entropy;
+  EXPECT_EQ(
+      rng_3.Get(std::as_writable_bytes(std::span(without_entropy))).status(),
+      OkStatus());
+  EXPECT_NE(first, without_entropy);
+}
+
 }  // namespace
 }  // namespace pw::random
@@ -0,0 +1,77 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Pushes and pops entries the size of a typical log message through a
+// PrefixedEntryRingBuffer, both with space available and when full, where each
+// push drops the oldest entry.
+
+#include <array>
+#include <cstddef>
+
+#include "gtest/gtest.h"
+#include "pw_benchmark/benchmark.h"
+#include "pw_ring_buffer/prefixed_entry_ring_buffer.h"
+
+namespace pw::ring_buffer {
+namespace {
+
+using benchmark::DoNotOptimize;
+
+constexpr std::array<std::byte, 32> kEntry = {};
+
+std::array<std::byte, 1024> buffer;
+std::array<std::byte, kEntry.size()> read_buffer;
+
+PW_BENCHMARK(PrefixedEntryRingBuffer, PushBackPopFront_32B) {
+  PrefixedEntryRingBuffer ring_buffer;
+  ASSERT_EQ(OkStatus(), ring_buffer.SetBuffer(buffer));
+
+  Status status;
+  for (auto _ : state) {
+    status.Update(ring_buffer.PushBack(kEntry));
+    status.Update(ring_buffer.PopFront());
+  }
+  EXPECT_EQ(OkStatus(), status);
+}
+
+PW_BENCHMARK(PrefixedEntryRingBuffer, PushBack_Full_32B) {
+  PrefixedEntryRingBuffer ring_buffer;
+  ASSERT_EQ(OkStatus(), ring_buffer.SetBuffer(buffer));
+  while (ring_buffer.TryPushBack(kEntry).ok()) {
+  }
+
+  Status status;
+  for (auto _ : state) {
+    status.Update(ring_buffer.PushBack(kEntry));
+  }
+  EXPECT_EQ(OkStatus(), status);
+}
+
+PW_BENCHMARK(PrefixedEntryRingBuffer, PeekFront_32B) {
+  PrefixedEntryRingBuffer ring_buffer;
+  ASSERT_EQ(OkStatus(), ring_buffer.SetBuffer(buffer));
+  ASSERT_EQ(OkStatus(), ring_buffer.PushBack(kEntry));
+
+  Status status;
+  size_t bytes_read = 0;
+  for (auto _ : state) {
+    status.Update(ring_buffer.PeekFront(read_buffer, &bytes_read));
+    DoNotOptimize(read_buffer);
+  }
+  EXPECT_EQ(OkStatus(), status);
+  EXPECT_EQ(bytes_read, kEntry.size());
+}
+
+}  // namespace
+}  // namespace pw::ring_buffer
@@ -26,7 +26,23 @@ namespace ring_buffer {
 using std::byte;
 using Reader = PrefixedEntryRingBufferMulti::Reader;
 
+namespace {
+
+// Encodes value as a varint of exactly size bytes, which may be longer than
+// its minimal encoding. Varint decoders accept the extra bytes.
+void EncodeVarintWithSize(uint64_t value, byte* output, size_t size) {
+  for (size_t i = 0; i + 1 < size; ++i) {
+    output[i] = static_cast<byte>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  PW_DASSERT(value < 0x80);
+  output[size - 1] = static_cast<byte>(value);
+}
+
+}  // namespace
+
 void PrefixedEntryRingBufferMulti::Clear() {
+  reservation_ = {};
   write_idx_ = 0;
   for (Reader& reader : readers_) {
     reader.read_idx = 0;
@@ -77,7 +93,7 @@ Status PrefixedEntryRingBufferMulti::InternalPushBack(
     std::span<const byte> data,
     uint32_t user_preamble_data,
     bool drop_elements_if_needed) {
-  if (buffer_ == nullptr) {
+  if (buffer_ == nullptr || reservation_open()) {
     return Status::FailedPrecondition();
   }
   if (data.size_bytes() == 0) {
@@ -122,6 +138,174 @@ Status PrefixedEntryRingBufferMulti::InternalPushBack(
   return OkStatus();
 }
 
+Status PrefixedEntryRingBufferMulti::PushBackMultiple(
+    std::span<const std::span<const byte>> entries,
+    std::span<const uint32_t> user_preamble_data) {
+  if (buffer_ == nullptr || reservation_open()) {
+    return Status::FailedPrecondition();
+  }
+  if (!user_preamble_data.empty() &&
+      user_preamble_data.size() != entries.size()) {
+    return Status::InvalidArgument();
+  }
+
+  // Size every entry up front, so that space is made once for all of them.
+  size_t total_write_bytes = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (entries[i].size_bytes() == 0) {
+      return Status::InvalidArgument();
+    }
+    total_write_bytes += EntrySizeBytes(
+        entries[i].size_bytes(),
+        user_preamble_data.empty() ? 0 : user_preamble_data[i]);
+    if (buffer_bytes_ < total_write_bytes) {
+      return Status::OutOfRange();
+    }
+  }
+
+  while (RawAvailableBytes() < total_write_bytes) {
+    InternalPopFrontAll();
+  }
+
+  byte preamble_buf[varint::kMaxVarint32SizeBytes * 2];
+  for (size_t i = 0; i < entries.size(); ++i) {
+    size_t user_preamble_bytes = 0;
+    if (user_preamble_) {
+      user_preamble_bytes = varint::Encode<uint32_t>(
+          user_preamble_data.empty() ? 0 : user_preamble_data[i],
+          preamble_buf);
+    }
+    size_t length_bytes = varint::Encode<uint32_t>(
+        entries[i].size_bytes(),
+        std::span(preamble_buf).subspan(user_preamble_bytes));
+    RawWrite(std::span(preamble_buf, user_preamble_bytes + length_bytes));
+    RawWrite(entries[i]);
+  }
+
+  for (Reader& reader : readers_) {
+    reader.entry_count += entries.size();
+  }
+  return OkStatus();
+}
+
+PrefixedEntryRingBufferMulti::Reservation
+PrefixedEntryRingBufferMulti::PlanReservation(
+    size_t size_bytes, uint32_t user_preamble_data) const {
+  Reservation reservation = {};
+  reservation.header_bytes = varint::EncodedSize(size_bytes);
+  if (user_preamble_) {
+    reservation.header_bytes += varint::EncodedSize(user_preamble_data);
+  }
+  reservation.data_bytes = size_bytes;
+  reservation.user_preamble = user_preamble_data;
+
+  // The header may wrap, but the data may not. If the header fits before the
+  // end of the buffer and the data doesn't, pad to the end of the buffer.
+  const size_t bytes_until_wrap =
+      buffer_bytes_ - (write_idx_ == buffer_bytes_ ? 0 : write_idx_);
+  if (reservation.header_bytes < bytes_until_wrap &&
+      reservation.header_bytes + size_bytes > bytes_until_wrap) {
+    reservation.padding_bytes = bytes_until_wrap;
+  }
+  return reservation;
+}
+
+Status PrefixedEntryRingBufferMulti::InternalReserve(
+    size_t size_bytes,
+    std::span<byte>& region_out,
+    uint32_t user_preamble_data,
+    bool pop_front_if_needed) {
+  if (buffer_ == nullptr || reservation_open()) {
+    return Status::FailedPrecondition();
+  }
+  if (size_bytes == 0) {
+    return Status::InvalidArgument();
+  }
+
+  Reservation reservation = PlanReservation(size_bytes, user_preamble_data);
+  if (buffer_bytes_ < reservation.header_bytes + size_bytes) {
+    return Status::OutOfRange();
+  }
+
+  size_t total_bytes = reservation.padding_bytes + reservation.header_bytes +
+                       reservation.data_bytes;
+  while (RawAvailableBytes() < total_bytes) {
+    if (RawAvailableBytes() == buffer_bytes_) {
+      // The buffer is empty, but the padding makes the entry too large. Start
+      // over at the beginning of the buffer, where no padding is needed.
+      Clear();
+      reservation = PlanReservation(size_bytes, user_preamble_data);
+      total_bytes = reservation.header_bytes + reservation.data_bytes;
+    } else if (pop_front_if_needed) {
+      InternalPopFrontAll();
+    } else {
+      return Status::ResourceExhausted();
+    }
+  }
+
+  size_t data_idx = IncrementIndex(
+      write_idx_, reservation.padding_bytes + reservation.header_bytes);
+  if (data_idx == buffer_bytes_) {
+    data_idx = 0;
+  }
+  reservation_ = reservation;
+  region_out = std::span(buffer_ + data_idx, size_bytes);
+  return OkStatus();
+}
+
+Status PrefixedEntryRingBufferMulti::Commit(size_t size_bytes) {
+  if (!reservation_open()) {
+    return Status::FailedPrecondition();
+  }
+  if (size_bytes > reservation_.data_bytes) {
+    return Status::OutOfRange();
+  }
+
+  const Reservation reservation = reservation_;
+  reservation_ = {};
+  if (size_bytes == 0) {
+    return OkStatus();
+  }
+
+  // Padding is a zero-length entry followed by the number of padding bytes
+  // that follow it. The padding bytes themselves are not written.
+  if (reservation.padding_bytes != 0) {
+    byte padding[varint::kMaxVarint32SizeBytes * 2 + 1] = {};
+    size_t padding_header_bytes = user_preamble_ ? 2 : 1;
+    const size_t remaining = reservation.padding_bytes - padding_header_bytes;
+    size_t skip_size_bytes = 1;
+    while ((remaining - skip_size_bytes) >> (7 * skip_size_bytes) != 0) {
+      skip_size_bytes += 1;
+    }
+    EncodeVarintWithSize(remaining - skip_size_bytes,
+                         padding + padding_header_bytes,
+                         skip_size_bytes);
+    padding_header_bytes += skip_size_bytes;
+    RawWrite(std::span(padding, padding_header_bytes));
+    write_idx_ = IncrementIndex(
+        write_idx_, reservation.padding_bytes - padding_header_bytes);
+  }
+
+  // The header keeps the size it was reserved with, so that it ends where the
+  // data begins.
+  byte header[varint::kMaxVarint32SizeBytes * 2];
+  size_t user_preamble_bytes = 0;
+  if (user_preamble_) {
+    user_preamble_bytes =
+        varint::Encode<uint32_t>(reservation.user_preamble, header);
+  }
+  EncodeVarintWithSize(size_bytes,
+                       header + user_preamble_bytes,
+                       reservation.header_bytes - user_preamble_bytes);
+  RawWrite(std::span(header, reservation.header_bytes));
+  write_idx_ = IncrementIndex(write_idx_, size_bytes);
+
+  for (Reader& reader : readers_) {
+    reader.entry_count++;
+  }
+  return OkStatus();
+}
+
 auto GetOutput(std::span<byte> data_out, size_t* write_index) {
   return [data_out, write_index](std::span<const byte> src) -> Status {
     size_t copy_size = std::min(data_out.size_bytes(), src.size_bytes());
@@ -157,6 +341,36 @@ Status PrefixedEntryRingBufferMulti::InternalPeekFrontWithPreamble(
   return InternalRead(reader, output, true);
 }
 
+Status PrefixedEntryRingBufferMulti::InternalPeekFrontInPlace(
+    Reader& reader, EntryView& entry_out, uint32_t* user_preamble_out) {
+  if (buffer_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+  if (reader.entry_count == 0) {
+    return Status::OutOfRange();
+  }
+
+  EntryInfo info = FrontEntryInfo(reader);
+  if (user_preamble_out) {
+    *user_preamble_out = info.user_preamble;
+  }
+
+  // The data index may equal the buffer size, in which case all of the data is
+  // at the start of the buffer. Keep the data in first when it doesn't wrap.
+  size_t data_read_idx = IncrementIndex(reader.read_idx, info.preamble_bytes);
+  size_t bytes_until_wrap = buffer_bytes_ - data_read_idx;
+  if (bytes_until_wrap == 0) {
+    entry_out.first = std::span(buffer_, info.data_bytes);
+    entry_out.second = std::span<const byte>();
+    return OkStatus();
+  }
+
+  size_t first_bytes = std::min(info.data_bytes, bytes_until_wrap);
+  entry_out.first = std::span(buffer_ + data_read_idx, first_bytes);
+  entry_out.second = std::span(buffer_, info.data_bytes - first_bytes);
+  return OkStatus();
+}
+
 // TODO(pwbug/339): Consider whether this internal templating is required, or if
 // we can simply promote GetOutput to a static function and remove the template.
 // T should be similar to Status (*read_output)(std::span<const byte>)
@@ -251,43 +465,86 @@ Reader& PrefixedEntryRingBufferMulti::GetSlowestReader() {
                                        : slowest_reader_before_writer);
 }
 
-Status PrefixedEntryRingBufferMulti::Dering() {
-  if (buffer_ == nullptr || readers_.size() == 0) {
+Status PrefixedEntryRingBufferMulti::Dering(std::span<byte> scratch) {
+  if (buffer_ == nullptr || readers_.size() == 0 || reservation_open()) {
     return Status::FailedPrecondition();
   }
 
   // Check if by luck we're already deringed.
   Reader* slowest_reader = &GetSlowestReader();
-  if (slowest_reader->read_idx == 0) {
+  const size_t read_idx = slowest_reader->read_idx;
+  if (read_idx == 0) {
     return OkStatus();
   }
 
-  auto buffer_span = std::span(buffer_, buffer_bytes_);
-  std::rotate(buffer_span.begin(),
-              buffer_span.begin() + slowest_reader->read_idx,
-              buffer_span.end());
+  const size_t used_bytes = TotalUsedBytes();
+  if (read_idx < write_idx_ || used_bytes == 0) {
+    // The entries are contiguous, so move them down to the start.
+    std::memmove(buffer_, buffer_ + read_idx, used_bytes);
+  } else {
+    // The oldest entries are at the end of the buffer, and the newest at the
+    // start: [newer | free | older]. Reorder them to [older | newer | free].
+    const size_t older_bytes = buffer_bytes_ - read_idx;
+    const size_t newer_bytes = write_idx_;
+
+    if (older_bytes <= scratch.size_bytes()) {
+      std::memcpy(scratch.data(), buffer_ + read_idx, older_bytes);
+      std::memmove(buffer_ + older_bytes, buffer_, newer_bytes);
+      std::memcpy(buffer_, scratch.data(), older_bytes);
+    } else if (newer_bytes <= scratch.size_bytes()) {
+      std::memcpy(scratch.data(), buffer_, newer_bytes);
+      std::memmove(buffer_, buffer_ + read_idx, older_bytes);
+      std::memcpy(buffer_ + older_bytes, scratch.data(), newer_bytes);
+    } else {
+      // Close the free space, then rotate only the entries.
+      std::memmove(buffer_ + newer_bytes, buffer_ + read_idx, older_bytes);
+      std::rotate(buffer_, buffer_ + newer_bytes, buffer_ + used_bytes);
+    }
+  }
 
   // If the new index is past the end of the buffer,
   // alias it back (wrap) to the start of the buffer.
-  if (write_idx_ < slowest_reader->read_idx) {
+  if (write_idx_ < read_idx) {
     write_idx_ += buffer_bytes_;
   }
-  write_idx_ -= slowest_reader->read_idx;
+  write_idx_ -= read_idx;
 
   for (Reader& reader : readers_) {
     if (&reader == slowest_reader) {
       continue;
     }
-    if (reader.read_idx < slowest_reader->read_idx) {
+    if (reader.read_idx < read_idx) {
       reader.read_idx += buffer_bytes_;
     }
-    reader.read_idx -= slowest_reader->read_idx;
+    reader.read_idx -= read_idx;
   }
 
   slowest_reader->read_idx = 0;
   return OkStatus();
 }
 
+Status PrefixedEntryRingBufferMulti::PeekContents(EntryView& contents_out) {
+  if (buffer_ == nullptr || reservation_open()) {
+    return Status::FailedPrecondition();
+  }
+
+  contents_out = {};
+  const size_t used_bytes = TotalUsedBytes();
+  if (used_bytes == 0) {
+    return OkStatus();
+  }
+
+  const size_t read_idx = GetSlowestReader().read_idx;
+  const size_t bytes_until_wrap = buffer_bytes_ - read_idx;
+  if (used_bytes <= bytes_until_wrap) {
+    contents_out.first = std::span(buffer_ + read_idx, used_bytes);
+  } else {
+    contents_out.first = std::span(buffer_ + read_idx, bytes_until_wrap);
+    contents_out.second = std::span(buffer_, used_bytes - bytes_until_wrap);
+  }
+  return OkStatus();
+}
+
 Status PrefixedEntryRingBufferMulti::InternalPopFront(Reader& reader) {
   if (buffer_ == nullptr) {
     return Status::FailedPrecondition();
@@ -305,6 +562,80 @@ Status PrefixedEntryRingBufferMulti::InternalPopFront(Reader& reader) {
   return OkStatus();
 }
 
+Status PrefixedEntryRingBufferMulti::InternalPeekFrontMultiple(
+    Reader& reader,
+    std::span<byte> data,
+    size_t& bytes_read_out,
+    size_t& entries_read_out,
+    size_t max_entries) {
+  bytes_read_out = 0;
+  entries_read_out = 0;
+  if (buffer_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+  if (reader.entry_count == 0) {
+    return Status::OutOfRange();
+  }
+
+  // Entries are stored back to back, so find how many whole entries fit and
+  // copy them all at once.
+  // Padding is never copied, so stop at padding after the front entry.
+  FrontEntryInfo(reader);
+  const size_t max_count = std::min(max_entries, reader.entry_count);
+  size_t read_idx = reader.read_idx;
+  size_t bytes = 0;
+  size_t count = 0;
+  while (count < max_count) {
+    EntryInfo info = EntryInfoAt(read_idx);
+    size_t entry_bytes = info.preamble_bytes + info.data_bytes;
+    if (info.padding || entry_bytes > data.size_bytes() - bytes) {
+      break;
+    }
+    bytes += entry_bytes;
+    count++;
+    read_idx = IncrementIndex(read_idx, entry_bytes);
+  }
+
+  if (count == 0) {
+    return Status::ResourceExhausted();
+  }
+
+  RawRead(data.data(), reader.read_idx, bytes);
+  bytes_read_out = bytes;
+  entries_read_out = count;
+  return OkStatus();
+}
+
+Status PrefixedEntryRingBufferMulti::InternalPopFrontMultiple(
+    Reader& reader, size_t entry_count) {
+  if (buffer_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+  if (reader.entry_count < entry_count) {
+    return Status::OutOfRange();
+  }
+
+  // A reader's entries end at the write index, so popping all of them does
+  // not need to walk the entries.
+  if (entry_count == reader.entry_count) {
+    reader.read_idx = write_idx_;
+    reader.entry_count = 0;
+    return OkStatus();
+  }
+
+  size_t read_idx = reader.read_idx;
+  for (size_t i = 0; i < entry_count;) {
+    EntryInfo info = EntryInfoAt(read_idx);
+    read_idx = IncrementIndex(read_idx, info.preamble_bytes + info.data_bytes);
+    if (!info.padding) {
+      i += 1;
+    }
+  }
+  reader.read_idx = read_idx;
+  reader.entry_count -= entry_count;
+  return OkStatus();
+}
+
 size_t PrefixedEntryRingBufferMulti::InternalFrontEntryDataSizeBytes(
     Reader& reader) {
   if (reader.entry_count == 0) {
@@ -322,8 +653,32 @@ size_t PrefixedEntryRingBufferMulti::InternalFrontEntryTotalSizeBytes(
   return info.preamble_bytes + info.data_bytes;
 }
 
+size_t PrefixedEntryRingBufferMulti::InternalEntriesSize(Reader& reader) {
+  if (reader.entry_count == 0) {
+    return 0;
+  }
+  // Case: Not wrapped.
+  if (reader.read_idx < write_idx_) {
+    return write_idx_ - reader.read_idx;
+  }
+  // Case: Wrapped, or full if the read and write indices match.
+  return buffer_bytes_ - (reader.read_idx - write_idx_);
+}
+
 PrefixedEntryRingBufferMulti::EntryInfo
 PrefixedEntryRingBufferMulti::FrontEntryInfo(Reader& reader) {
+  EntryInfo info = EntryInfoAt(reader.read_idx);
+  if (info.padding) {
+    // Padding is only ever followed by an entry.
+    reader.read_idx = IncrementIndex(reader.read_idx,
+                                     info.preamble_bytes + info.data_bytes);
+    info = EntryInfoAt(reader.read_idx);
+  }
+  return info;
+}
+
+PrefixedEntryRingBufferMulti::EntryInfo
+PrefixedEntryRingBufferMulti::EntryInfoAt(size_t index) {
   // Entry headers consists of: (optional prefix byte, varint size, data...)
 
   // If a preamble exists, extract the varint and it's bytes in bytes.
@@ -331,14 +686,14 @@ PrefixedEntryRingBufferMulti::FrontEntryInfo(Reader& reader) {
   uint64_t user_preamble_data = 0;
   byte varint_buf[varint::kMaxVarint32SizeBytes];
   if (user_preamble_) {
-    RawRead(varint_buf, reader.read_idx, varint::kMaxVarint32SizeBytes);
+    RawRead(varint_buf, index, varint::kMaxVarint32SizeBytes);
     user_preamble_bytes = varint::Decode(varint_buf, &user_preamble_data);
     PW_DASSERT(user_preamble_bytes != 0u);
   }
 
   // Read the entry header; extract the varint and it's bytes in bytes.
   RawRead(varint_buf,
-          IncrementIndex(reader.read_idx, user_preamble_bytes),
+          IncrementIndex(index, user_preamble_bytes),
           varint::kMaxVarint32SizeBytes);
   uint64_t entry_bytes;
   size_t length_bytes = varint::Decode(varint_buf, &entry_bytes);
@@ -348,9 +703,32 @@ PrefixedEntryRingBufferMulti::FrontEntryInfo(Reader& reader) {
   info.preamble_bytes = user_preamble_bytes + length_bytes;
   info.user_preamble = static_cast<uint32_t>(user_preamble_data);
   info.data_bytes = entry_bytes;
+
+  // Entries are never empty, so a zero size marks padding. The number of
+  // padding bytes that follow is the next varint.
+  if (entry_bytes == 0) {
+    RawRead(varint_buf,
+            IncrementIndex(index, info.preamble_bytes),
+            varint::kMaxVarint32SizeBytes);
+    uint64_t padding_bytes;
+    size_t padding_length_bytes = varint::Decode(varint_buf, &padding_bytes);
+    PW_DASSERT(padding_length_bytes != 0u);
+    info.preamble_bytes += padding_length_bytes;
+    info.data_bytes = padding_bytes;
+    info.padding = true;
+  }
   return info;
 }
 
+size_t PrefixedEntryRingBufferMulti::EntrySizeBytes(
+    size_t data_bytes, uint32_t user_preamble_data) const {
+  size_t entry_bytes = varint::EncodedSize(data_bytes) + data_bytes;
+  if (user_preamble_) {
+    entry_bytes += varint::EncodedSize(user_preamble_data);
+  }
+  return entry_bytes;
+}
+
 // Comparisons ordered for more probable early exits, assuming the reader is
 // not far behind the writer compared to the size of the ring.
 size_t PrefixedEntryRingBufferMulti::RawAvailableBytes() {
@@ -14,8 +14,10 @@
 
 #include "pw_ring_buffer/prefixed_entry_ring_buffer.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include "pw_assert/check.h"
 #include "pw_containers/vector.h"
@@ -313,7 +315,7 @@ constexpr size_t kTestBufferSize =
 // Create statically to prevent allocating a capture in the lambda below.
 static pw::Vector<byte, kTestBufferSize> actual_result;
 
-void DeringTest(bool preload) {
+void DeringTest(bool preload, std::span<byte> scratch = {}) {
   PrefixedEntryRingBuffer ring;
 
   byte test_buffer[kTestBufferSize];
@@ -360,7 +362,11 @@ void DeringTest(bool preload) {
     EXPECT_EQ(ring.EntryCount(), kTotalEntryCount);
     EXPECT_EQ(expected_result.size(), ring.TotalUsedBytes());
 
-    ASSERT_EQ(ring.Dering(), OkStatus());
+    if (scratch.empty()) {
+      ASSERT_EQ(ring.Dering(), OkStatus());
+    } else {
+      ASSERT_EQ(ring.Dering(scratch), OkStatus());
+    }
 
     // Check values after doing the dering.
     EXPECT_EQ(ring.EntryCount(), kTotalEntryCount);
@@ -394,6 +400,122 @@ void DeringTest(bool preload) {
 TEST(PrefixedEntryRingBuffer, Dering) { DeringTest(true); }
 TEST(PrefixedEntryRingBuffer, DeringNoPreload) { DeringTest(false); }
 
+TEST(PrefixedEntryRingBuffer, DeringWithScratch) {
+  // Small scratch buffers fit one of the wrapped segments only some of the
+  // time, so these test each way of deringing.
+  for (size_t scratch_size : {1u, 7u, 16u, 64u, 200u}) {
+    byte scratch[200];
+    DeringTest(true, std::span(scratch, scratch_size));
+  }
+}
+
+TEST(PrefixedEntryRingBuffer, DeringWithScratch_MultipleReaders) {
+  // The entries wrap with 10 older bytes and 5 newer bytes. Test deringing by
+  // rotating, through scratch with the newer bytes, and with the older bytes.
+  for (size_t scratch_size : {1u, 5u, 10u}) {
+    PrefixedEntryRingBufferMulti ring;
+    byte test_buffer[16];
+    EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+    PrefixedEntryRingBufferMulti::Reader slow;
+    PrefixedEntryRingBufferMulti::Reader fast;
+    EXPECT_EQ(ring.AttachReader(slow), OkStatus());
+    EXPECT_EQ(ring.AttachReader(fast), OkStatus());
+
+    // Entries are 3 bytes: the size, then 2 bytes of data. Pushing the 7th
+    // entry evicts the 2nd, and the entries wrap around the end.
+    for (uint8_t i = 0; i < 7; ++i) {
+      const byte data[2] = {byte{i}, byte{i}};
+      ASSERT_EQ(ring.PushBack(data), OkStatus());
+      if (i == 4) {
+        ASSERT_EQ(slow.PopFront(), OkStatus());
+        ASSERT_EQ(fast.PopFront(), OkStatus());
+      }
+    }
+    ASSERT_EQ(fast.PopFront(), OkStatus());
+    ASSERT_EQ(fast.PopFront(), OkStatus());
+
+    byte scratch[10];
+    ASSERT_EQ(ring.Dering(std::span(scratch, scratch_size)), OkStatus());
+
+    const byte expected[] = {byte{2},
+                             byte{2},
+                             byte{2},
+                             byte{2},
+                             byte{3},
+                             byte{3},
+                             byte{2},
+                             byte{4},
+                             byte{4},
+                             byte{2},
+                             byte{5},
+                             byte{5},
+                             byte{2},
+                             byte{6},
+                             byte{6}};
+    EXPECT_EQ(std::memcmp(test_buffer, expected, sizeof(expected)), 0);
+
+    EXPECT_EQ(slow.EntryCount(), 5u);
+    EXPECT_EQ(fast.EntryCount(), 3u);
+
+    PrefixedEntryRingBufferMulti::EntryView entry;
+    ASSERT_EQ(slow.PeekFrontInPlace(entry), OkStatus());
+    EXPECT_EQ(entry.first.data(), test_buffer + 1);
+    ASSERT_EQ(fast.PeekFrontInPlace(entry), OkStatus());
+    EXPECT_EQ(entry.first.data(), test_buffer + 7);
+
+    // Pushing continues after the newest entry.
+    const byte data[2] = {byte{7}, byte{7}};
+    ASSERT_EQ(ring.PushBack(data), OkStatus());
+    EXPECT_EQ(slow.EntryCount(), 5u);
+    EXPECT_EQ(fast.EntryCount(), 4u);
+    EXPECT_EQ(test_buffer[15], byte{2});
+  }
+}
+
+TEST(PrefixedEntryRingBuffer, PeekContents) {
+  PrefixedEntryRingBuffer ring;
+  PrefixedEntryRingBuffer::EntryView contents;
+  EXPECT_EQ(ring.PeekContents(contents), Status::FailedPrecondition());
+
+  byte test_buffer[10];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+  ASSERT_EQ(ring.PeekContents(contents), OkStatus());
+  EXPECT_EQ(contents.size(), 0u);
+
+  const byte a[] = {byte{'a'}, byte{'a'}};
+  const byte b[] = {byte{'b'}, byte{'b'}, byte{'b'}};
+  ASSERT_EQ(ring.PushBack(a), OkStatus());
+  ASSERT_EQ(ring.PushBack(b), OkStatus());
+
+  ASSERT_EQ(ring.PeekContents(contents), OkStatus());
+  ASSERT_EQ(contents.first.size(), 7u);
+  EXPECT_EQ(contents.second.size(), 0u);
+  EXPECT_EQ(contents.first.data(), test_buffer);
+
+  // Evicts a, and wraps the new entry around the end of the buffer.
+  const byte c[] = {byte{'c'}, byte{'c'}, byte{'c'}, byte{'c'}};
+  ASSERT_EQ(ring.PushBack(c), OkStatus());
+  ASSERT_EQ(ring.PeekContents(contents), OkStatus());
+  ASSERT_EQ(contents.first.size(), 7u);
+  ASSERT_EQ(contents.second.size(), 2u);
+
+  const byte expected[] = {byte{3},
+                           byte{'b'},
+                           byte{'b'},
+                           byte{'b'},
+                           byte{4},
+                           byte{'c'},
+                           byte{'c'}};
+  EXPECT_EQ(std::memcmp(contents.first.data(), expected, 7), 0);
+  EXPECT_EQ(contents.second[0], byte{'c'});
+  EXPECT_EQ(contents.second[1], byte{'c'});
+
+  // Peeking the contents does not dering or pop anything.
+  EXPECT_EQ(ring.EntryCount(), 2u);
+  EXPECT_EQ(contents.second.data(), test_buffer);
+}
+
 template <typename T>
 Status PushBack(PrefixedEntryRingBufferMulti& ring, T element) {
   union {
@@ -611,6 +733,507 @@ TEST(PrefixedEntryRingBufferMulti, SingleBufferPerReader) {
   EXPECT_EQ(ring_one.AttachReader(reader), Status::InvalidArgument());
 }
 
+TEST(PrefixedEntryRingBuffer, PushBackMultiple) {
+  PrefixedEntryRingBuffer ring(true);
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  constexpr byte kFirst[] = {byte{1}};
+  constexpr byte kSecond[] = {byte{2}, byte{2}};
+  constexpr byte kThird[] = {byte{3}, byte{3}, byte{3}};
+  const std::span<const byte> entries[] = {kFirst, kSecond, kThird};
+  constexpr uint32_t kPreambles[] = {10, 200, 3000};
+  EXPECT_EQ(ring.PushBackMultiple(entries, kPreambles), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 3u);
+
+  for (size_t i = 0; i < 3; ++i) {
+    byte data[3] = {};
+    uint32_t preamble = 0;
+    size_t bytes_read = 0;
+    EXPECT_EQ(ring.PeekFrontWithPreamble(data, preamble, bytes_read),
+              OkStatus());
+    EXPECT_EQ(preamble, kPreambles[i]);
+    ASSERT_EQ(bytes_read, i + 1);
+    EXPECT_EQ(data[i], byte(i + 1));
+    EXPECT_EQ(ring.PopFront(), OkStatus());
+  }
+  EXPECT_EQ(ring.EntryCount(), 0u);
+}
+
+TEST(PrefixedEntryRingBuffer, PushBackMultiple_InvalidArguments) {
+  PrefixedEntryRingBuffer ring(true);
+  byte test_buffer[kTestBufferSize];
+
+  constexpr byte kEntry[] = {byte{1}};
+  const std::span<const byte> entries[] = {kEntry, kEntry};
+  EXPECT_EQ(ring.PushBackMultiple(entries), Status::FailedPrecondition());
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  constexpr uint32_t kOnePreamble[] = {1};
+  EXPECT_EQ(ring.PushBackMultiple(entries, kOnePreamble),
+            Status::InvalidArgument());
+
+  const std::span<const byte> with_empty[] = {kEntry, std::span<const byte>()};
+  EXPECT_EQ(ring.PushBackMultiple(with_empty), Status::InvalidArgument());
+
+  byte large[kTestBufferSize / 2] = {};
+  const std::span<const byte> too_large[] = {large, large};
+  EXPECT_EQ(ring.PushBackMultiple(too_large), Status::OutOfRange());
+
+  EXPECT_EQ(ring.EntryCount(), 0u);
+}
+
+TEST(PrefixedEntryRingBufferMulti, PushBackMultiple_EvictsAndWraps) {
+  PrefixedEntryRingBufferMulti ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  PrefixedEntryRingBufferMulti::Reader fast_reader;
+  PrefixedEntryRingBufferMulti::Reader slow_reader;
+  EXPECT_EQ(ring.AttachReader(fast_reader), OkStatus());
+  EXPECT_EQ(ring.AttachReader(slow_reader), OkStatus());
+
+  // Fill the buffer, then push a batch that overwrites the oldest entries and
+  // wraps around the end of the buffer.
+  uint32_t next_value = 0;
+  while (TryPushBack<uint32_t>(ring, next_value).ok()) {
+    next_value++;
+  }
+  const size_t total_items = next_value;
+  EXPECT_EQ(fast_reader.PopFront(), OkStatus());
+
+  uint32_t values[5];
+  std::span<const byte> entries[5];
+  for (size_t i = 0; i < 5; ++i) {
+    values[i] = next_value++;
+    entries[i] = std::as_bytes(std::span(&values[i], 1));
+  }
+  EXPECT_EQ(ring.PushBackMultiple(entries), OkStatus());
+
+  // Both readers lost the five oldest entries, and gained five entries.
+  EXPECT_EQ(slow_reader.EntryCount(), total_items);
+  EXPECT_EQ(fast_reader.EntryCount(), total_items);
+  EXPECT_EQ(PeekFront<uint32_t>(slow_reader), 5u);
+  EXPECT_EQ(PeekFront<uint32_t>(fast_reader), 5u);
+
+  for (uint32_t expected = 5; expected < next_value; ++expected) {
+    EXPECT_EQ(PeekFront<uint32_t>(slow_reader), expected);
+    EXPECT_EQ(slow_reader.PopFront(), OkStatus());
+  }
+  EXPECT_EQ(slow_reader.EntryCount(), 0u);
+}
+
+TEST(PrefixedEntryRingBuffer, PeekFrontMultiple) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  // Offset the entries so that they wrap around the end of the buffer.
+  for (uint32_t i = 0; i < 30; ++i) {
+    EXPECT_EQ(PushBack<uint32_t>(ring, 0), OkStatus());
+  }
+  EXPECT_EQ(ring.PopFrontMultiple(30), OkStatus());
+  for (uint32_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(PushBack<uint32_t>(ring, i), OkStatus());
+  }
+
+  // Each entry is a one byte length followed by four bytes of data. Only
+  // whole entries are copied.
+  byte data[23];
+  size_t bytes_read = 0;
+  size_t entries_read = 0;
+  EXPECT_EQ(ring.PeekFrontMultiple(data, bytes_read, entries_read),
+            OkStatus());
+  EXPECT_EQ(bytes_read, 20u);
+  ASSERT_EQ(entries_read, 4u);
+  for (uint32_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(data[i * 5], byte{4});
+    uint32_t value;
+    std::memcpy(&value, &data[i * 5 + 1], sizeof(value));
+    EXPECT_EQ(value, i);
+  }
+
+  // Peeking does not consume entries.
+  EXPECT_EQ(ring.EntryCount(), 10u);
+
+  EXPECT_EQ(ring.PeekFrontMultiple(data, bytes_read, entries_read, 2),
+            OkStatus());
+  EXPECT_EQ(bytes_read, 10u);
+  EXPECT_EQ(entries_read, 2u);
+
+  EXPECT_EQ(ring.PopFrontMultiple(entries_read), OkStatus());
+  EXPECT_EQ(PeekFront<uint32_t>(ring), 2u);
+  EXPECT_EQ(ring.EntryCount(), 8u);
+}
+
+TEST(PrefixedEntryRingBuffer, PeekFrontMultiple_Errors) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  byte data[4];
+  size_t bytes_read = 1;
+  size_t entries_read = 1;
+  EXPECT_EQ(ring.PeekFrontMultiple(data, bytes_read, entries_read),
+            Status::OutOfRange());
+  EXPECT_EQ(bytes_read, 0u);
+  EXPECT_EQ(entries_read, 0u);
+
+  // The front entry needs five bytes.
+  EXPECT_EQ(PushBack<uint32_t>(ring, 1), OkStatus());
+  EXPECT_EQ(ring.PeekFrontMultiple(data, bytes_read, entries_read),
+            Status::ResourceExhausted());
+  EXPECT_EQ(bytes_read, 0u);
+  EXPECT_EQ(entries_read, 0u);
+}
+
+TEST(PrefixedEntryRingBuffer, PopFrontMultiple) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  for (uint32_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(PushBack<uint32_t>(ring, i), OkStatus());
+  }
+
+  EXPECT_EQ(ring.PopFrontMultiple(6), Status::OutOfRange());
+  EXPECT_EQ(ring.EntryCount(), 5u);
+
+  EXPECT_EQ(ring.PopFrontMultiple(0), OkStatus());
+  EXPECT_EQ(ring.PopFrontMultiple(2), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 3u);
+  EXPECT_EQ(PeekFront<uint32_t>(ring), 2u);
+
+  EXPECT_EQ(ring.PopFrontMultiple(3), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+
+  // The buffer is usable after popping every entry.
+  EXPECT_EQ(PushBack<uint32_t>(ring, 7), OkStatus());
+  EXPECT_EQ(PeekFront<uint32_t>(ring), 7u);
+}
+
+TEST(PrefixedEntryRingBufferMulti, EntriesSize) {
+  PrefixedEntryRingBufferMulti ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  PrefixedEntryRingBufferMulti::Reader fast_reader;
+  PrefixedEntryRingBufferMulti::Reader slow_reader;
+  EXPECT_EQ(ring.AttachReader(fast_reader), OkStatus());
+  EXPECT_EQ(ring.AttachReader(slow_reader), OkStatus());
+  EXPECT_EQ(fast_reader.EntriesSize(), 0u);
+
+  // Each entry is a one byte length followed by four bytes of data.
+  constexpr size_t kEntryBytes = 1 + sizeof(uint32_t);
+  for (uint32_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(PushBack<uint32_t>(ring, i), OkStatus());
+  }
+  EXPECT_EQ(fast_reader.PopFront(), OkStatus());
+  EXPECT_EQ(fast_reader.EntriesSize(), 2 * kEntryBytes);
+  EXPECT_EQ(slow_reader.EntriesSize(), 3 * kEntryBytes);
+
+  // Fill the buffer, which wraps around its end.
+  static_assert(kTestBufferSize % kEntryBytes == 0);
+  for (uint32_t i = 0; i < kTestBufferSize / kEntryBytes; ++i) {
+    EXPECT_EQ(PushBack<uint32_t>(ring, i), OkStatus());
+  }
+  EXPECT_EQ(fast_reader.EntriesSize(), kTestBufferSize);
+  EXPECT_EQ(slow_reader.EntriesSize(), kTestBufferSize);
+
+  EXPECT_EQ(slow_reader.PopFront(), OkStatus());
+  EXPECT_EQ(slow_reader.EntriesSize(), kTestBufferSize - kEntryBytes);
+  EXPECT_EQ(ring.TotalUsedBytes(), kTestBufferSize);
+}
+
+template <typename T>
+T Value(const PrefixedEntryRingBufferMulti::EntryView& entry) {
+  union {
+    std::array<byte, sizeof(T)> buffer;
+    T item;
+  } aliased;
+  PW_CHECK_INT_EQ(entry.size(), sizeof(T));
+  std::copy(entry.first.begin(), entry.first.end(), aliased.buffer.begin());
+  std::copy(entry.second.begin(),
+            entry.second.end(),
+            aliased.buffer.begin() + entry.first.size());
+  return aliased.item;
+}
+
+TEST(PrefixedEntryRingBuffer, PeekFrontInPlace) {
+  PrefixedEntryRingBuffer ring(true);
+  byte test_buffer[kTestBufferSize];
+  PrefixedEntryRingBufferMulti::EntryView entry;
+  EXPECT_EQ(ring.PeekFrontInPlace(entry), Status::FailedPrecondition());
+
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+  EXPECT_EQ(ring.PeekFrontInPlace(entry), Status::OutOfRange());
+
+  constexpr uint32_t kValue = 0x12345678;
+  EXPECT_EQ(ring.PushBack(std::as_bytes(std::span(&kValue, 1)), 42u),
+            OkStatus());
+
+  uint32_t preamble = 0;
+  EXPECT_EQ(ring.PeekFrontInPlace(entry, preamble), OkStatus());
+  EXPECT_EQ(preamble, 42u);
+  EXPECT_EQ(entry.first.size(), sizeof(kValue));
+  EXPECT_TRUE(entry.second.empty());
+  EXPECT_EQ(Value<uint32_t>(entry), kValue);
+
+  // The view points into the ring buffer's storage.
+  EXPECT_GE(entry.first.data(), test_buffer);
+  EXPECT_LT(entry.first.data(), test_buffer + kTestBufferSize);
+
+  EXPECT_EQ(ring.PopFront(), OkStatus());
+  EXPECT_EQ(ring.PeekFrontInPlace(entry), Status::OutOfRange());
+}
+
+TEST(PrefixedEntryRingBuffer, PeekFrontInPlace_Wrapped) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  // Leave five bytes at the end of the buffer, so that an eight byte entry
+  // wraps after its one byte length and four bytes of data.
+  for (size_t i = 0; i < kTestBufferSize / 5 - 1; ++i) {
+    EXPECT_EQ(PushBack<uint32_t>(ring, 0), OkStatus());
+  }
+  EXPECT_EQ(ring.PopFrontMultiple(ring.EntryCount()), OkStatus());
+
+  constexpr uint64_t kValue = 0x0123456789abcdef;
+  EXPECT_EQ(PushBack<uint64_t>(ring, kValue), OkStatus());
+
+  PrefixedEntryRingBufferMulti::EntryView entry;
+  EXPECT_EQ(ring.PeekFrontInPlace(entry), OkStatus());
+  EXPECT_EQ(entry.first.size(), 4u);
+  EXPECT_EQ(entry.second.size(), 4u);
+  EXPECT_EQ(entry.second.data(), test_buffer);
+  EXPECT_EQ(Value<uint64_t>(entry), kValue);
+}
+
+TEST(PrefixedEntryRingBuffer, PeekFrontInPlace_DataStartsAtBufferStart) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  // Fill all but the last byte of the buffer, so that the next entry's length
+  // is the last byte and its data is at the start of the buffer.
+  for (size_t i = 0; i < kTestBufferSize / 5 - 1; ++i) {
+    EXPECT_EQ(PushBack<uint32_t>(ring, 0), OkStatus());
+  }
+  constexpr byte kThreeBytes[3] = {};
+  EXPECT_EQ(ring.PushBack(kThreeBytes), OkStatus());
+  EXPECT_EQ(ring.PopFrontMultiple(ring.EntryCount()), OkStatus());
+
+  EXPECT_EQ(PushBack<uint32_t>(ring, 0xfeedbeef), OkStatus());
+
+  PrefixedEntryRingBufferMulti::EntryView entry;
+  EXPECT_EQ(ring.PeekFrontInPlace(entry), OkStatus());
+  EXPECT_EQ(entry.first.data(), test_buffer);
+  EXPECT_EQ(entry.first.size(), 4u);
+  EXPECT_TRUE(entry.second.empty());
+  EXPECT_EQ(Value<uint32_t>(entry), 0xfeedbeef);
+}
+
+// Moves the write index of an empty ring buffer to the given offset, which
+// must be a multiple of five, with entries of a one byte length and a
+// uint32_t.
+void AdvanceWriteIndex(PrefixedEntryRingBuffer& ring, size_t offset) {
+  for (size_t i = 0; i < offset / 5; ++i) {
+    PW_CHECK_OK(PushBack<uint32_t>(ring, 0));
+    PW_CHECK_OK(ring.PopFront());
+  }
+}
+
+TEST(PrefixedEntryRingBuffer, ReserveAndCommit) {
+  PrefixedEntryRingBuffer ring(true);
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  std::span<byte> region;
+  EXPECT_EQ(ring.Reserve(10, region, 7u), OkStatus());
+  ASSERT_EQ(region.size(), 10u);
+  EXPECT_GE(region.data(), test_buffer);
+  EXPECT_LE(region.data() + region.size(), test_buffer + kTestBufferSize);
+
+  // The entry is not visible until it is committed.
+  EXPECT_EQ(ring.EntryCount(), 0u);
+
+  constexpr byte kData[] = {byte{1}, byte{2}, byte{3}, byte{4}, byte{5}};
+  std::copy(std::begin(kData), std::end(kData), region.begin());
+  EXPECT_EQ(ring.Commit(sizeof(kData)), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 1u);
+
+  byte data[10];
+  uint32_t preamble = 0;
+  size_t bytes_read = 0;
+  EXPECT_EQ(ring.PeekFrontWithPreamble(data, preamble, bytes_read), OkStatus());
+  EXPECT_EQ(preamble, 7u);
+  ASSERT_EQ(bytes_read, sizeof(kData));
+  EXPECT_TRUE(std::equal(std::begin(kData), std::end(kData), data));
+}
+
+TEST(PrefixedEntryRingBuffer, CommitLessThanReserved) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  // A reservation of 130 bytes needs a two byte length, which is kept even
+  // though the committed entry is smaller.
+  std::span<byte> region;
+  EXPECT_EQ(ring.Reserve(130, region), OkStatus());
+  EXPECT_EQ(region.data(), test_buffer + 2);
+  region[0] = byte{0xab};
+  EXPECT_EQ(ring.Commit(1), OkStatus());
+
+  EXPECT_EQ(ring.FrontEntryTotalSizeBytes(), 3u);
+  EXPECT_EQ(ring.FrontEntryDataSizeBytes(), 1u);
+  byte data[1];
+  size_t bytes_read = 0;
+  EXPECT_EQ(ring.PeekFront(data, &bytes_read), OkStatus());
+  EXPECT_EQ(bytes_read, 1u);
+  EXPECT_EQ(data[0], byte{0xab});
+
+  EXPECT_EQ(ring.PopFront(), OkStatus());
+  EXPECT_EQ(PushBack<uint32_t>(ring, 99), OkStatus());
+  EXPECT_EQ(PeekFront<uint32_t>(ring), 99u);
+}
+
+TEST(PrefixedEntryRingBuffer, ReservePadsInsteadOfWrapping) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+  AdvanceWriteIndex(ring, kTestBufferSize - 15);
+
+  // Twenty bytes do not fit in the last fifteen, so the data starts after the
+  // entry's one byte length at the beginning of the buffer.
+  std::span<byte> region;
+  EXPECT_EQ(ring.Reserve(20, region), OkStatus());
+  EXPECT_EQ(region.data(), test_buffer + 1);
+  std::fill(region.begin(), region.end(), byte{0x5a});
+  EXPECT_EQ(ring.Commit(20), OkStatus());
+
+  EXPECT_EQ(ring.EntryCount(), 1u);
+  EXPECT_EQ(ring.TotalUsedBytes(), 15u + 21u);
+  EXPECT_EQ(ring.FrontEntryDataSizeBytes(), 20u);
+
+  byte data[20];
+  size_t bytes_read = 0;
+  EXPECT_EQ(ring.PeekFront(data, &bytes_read), OkStatus());
+  EXPECT_EQ(bytes_read, 20u);
+  EXPECT_EQ(data[0], byte{0x5a});
+  EXPECT_EQ(data[19], byte{0x5a});
+
+  PrefixedEntryRingBufferMulti::EntryView entry;
+  EXPECT_EQ(ring.PeekFrontInPlace(entry), OkStatus());
+  EXPECT_EQ(entry.first.data(), test_buffer + 1);
+  EXPECT_TRUE(entry.second.empty());
+
+  EXPECT_EQ(ring.PopFront(), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+  EXPECT_EQ(ring.TotalUsedBytes(), 0u);
+}
+
+TEST(PrefixedEntryRingBufferMulti, ReadersSkipPadding) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+  AdvanceWriteIndex(ring, kTestBufferSize - 20);
+
+  PrefixedEntryRingBufferMulti::Reader reader;
+  EXPECT_EQ(ring.AttachReader(reader), OkStatus());
+  EXPECT_EQ(PushBack<uint32_t>(ring, 1), OkStatus());
+
+  std::span<byte> region;
+  EXPECT_EQ(ring.Reserve(sizeof(uint32_t) * 4, region), OkStatus());
+  EXPECT_EQ(region.data(), test_buffer + 1);
+  const uint32_t value = 2;
+  std::memcpy(region.data(), &value, sizeof(value));
+  EXPECT_EQ(ring.Commit(sizeof(value)), OkStatus());
+  EXPECT_EQ(PushBack<uint32_t>(ring, 3), OkStatus());
+  EXPECT_EQ(reader.EntryCount(), 3u);
+
+  // Copying multiple entries stops at the padding.
+  byte data[64];
+  size_t bytes_read = 0;
+  size_t entries_read = 0;
+  EXPECT_EQ(reader.PeekFrontMultiple(data, bytes_read, entries_read),
+            OkStatus());
+  EXPECT_EQ(bytes_read, 5u);
+  EXPECT_EQ(entries_read, 1u);
+
+  // Popping multiple entries skips over the padding.
+  EXPECT_EQ(reader.PopFrontMultiple(2), OkStatus());
+  EXPECT_EQ(PeekFront<uint32_t>(reader), 3u);
+
+  EXPECT_EQ(PeekFront<uint32_t>(ring), 1u);
+  EXPECT_EQ(ring.PopFront(), OkStatus());
+  EXPECT_EQ(PeekFront<uint32_t>(ring), 2u);
+  EXPECT_EQ(ring.PopFront(), OkStatus());
+  EXPECT_EQ(PeekFront<uint32_t>(ring), 3u);
+  EXPECT_EQ(ring.PopFront(), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+}
+
+TEST(PrefixedEntryRingBuffer, ReserveRestartsEmptyBuffer) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+  AdvanceWriteIndex(ring, kTestBufferSize - 15);
+
+  // With padding, this entry would not fit even in an empty buffer, so it is
+  // placed at the beginning instead.
+  std::span<byte> region;
+  EXPECT_EQ(ring.TryReserve(kTestBufferSize - 2, region), OkStatus());
+  EXPECT_EQ(region.data(), test_buffer + 2);
+  EXPECT_EQ(ring.Commit(region.size()), OkStatus());
+  EXPECT_EQ(ring.FrontEntryDataSizeBytes(), kTestBufferSize - 2);
+}
+
+TEST(PrefixedEntryRingBuffer, ReserveEvictsAndTryReserveDoesNot) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  uint32_t count = 0;
+  while (TryPushBack<uint32_t>(ring, count).ok()) {
+    count++;
+  }
+
+  std::span<byte> region;
+  EXPECT_EQ(ring.TryReserve(4, region), Status::ResourceExhausted());
+  EXPECT_EQ(ring.EntryCount(), count);
+
+  EXPECT_EQ(ring.Reserve(4, region), OkStatus());
+  EXPECT_EQ(ring.Commit(4), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), count);
+  EXPECT_EQ(PeekFront<uint32_t>(ring), 1u);
+}
+
+TEST(PrefixedEntryRingBuffer, ReserveErrors) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  std::span<byte> region;
+  EXPECT_EQ(ring.Reserve(4, region), Status::FailedPrecondition());
+  EXPECT_EQ(ring.Commit(4), Status::FailedPrecondition());
+
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+  EXPECT_EQ(ring.Reserve(0, region), Status::InvalidArgument());
+  EXPECT_EQ(ring.Reserve(kTestBufferSize, region), Status::OutOfRange());
+
+  EXPECT_EQ(ring.Reserve(8, region), OkStatus());
+  EXPECT_EQ(ring.Reserve(8, region), Status::FailedPrecondition());
+  EXPECT_EQ(PushBack<uint32_t>(ring, 1), Status::FailedPrecondition());
+  EXPECT_EQ(ring.Dering(), Status::FailedPrecondition());
+  EXPECT_EQ(ring.Commit(9), Status::OutOfRange());
+
+  // Committing nothing cancels the reservation.
+  EXPECT_EQ(ring.Commit(0), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+  EXPECT_EQ(ring.Commit(0), Status::FailedPrecondition());
+  EXPECT_EQ(PushBack<uint32_t>(ring, 1), OkStatus());
+  EXPECT_EQ(PeekFront<uint32_t>(ring), 1u);
+}
+
 }  // namespace
 }  // namespace ring_buffer
 }  // namespace pw
@@ -14,6 +14,8 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <span>
 
 #include "pw_containers/intrusive_list.h"
@@ -41,6 +43,16 @@ class PrefixedEntryRingBufferMulti {
  public:
   typedef Status (*ReadOutput)(std::span<const std::byte>);
 
+  // The data of an entry, in place in the ring buffer. An entry that wraps
+  // around the end of the buffer is split across first and second; otherwise,
+  // second is empty.
+  struct EntryView {
+    std::span<const std::byte> first;
+    std::span<const std::byte> second;
+
+    size_t size() const { return first.size() + second.size(); }
+  };
+
   // A reader that provides a single-reader interface into the multi-reader ring
   // buffer it has been attached to via AttachReader(). Readers maintain their
   // read position in the ring buffer as well as the remaining count of entries
@@ -84,6 +96,25 @@ class PrefixedEntryRingBufferMulti {
       return buffer->InternalPeekFront(*this, output);
     }
 
+    // Get the oldest stored data chunk without copying it. The view points
+    // into the ring buffer, and is valid until this reader pops the entry, or
+    // until the buffer is modified with PushBack(), Clear(), SetBuffer(), or
+    // Dering(). PushBack() may drop the entry to make space.
+    //
+    // Return values:
+    // OK - entry_out refers to the front entry's data.
+    // FAILED_PRECONDITION - Buffer not initialized.
+    // OUT_OF_RANGE - No entries in ring buffer to read.
+    Status PeekFrontInPlace(EntryView& entry_out) {
+      return buffer->InternalPeekFrontInPlace(*this, entry_out, nullptr);
+    }
+
+    // Same as PeekFrontInPlace, but also gets the entry's user preamble.
+    Status PeekFrontInPlace(EntryView& entry_out, uint32_t& user_preamble_out) {
+      return buffer->InternalPeekFrontInPlace(
+          *this, entry_out, &user_preamble_out);
+    }
+
     // Same as PeekFront but includes the entry's preamble of optional user
     // value and the varint of the data size.
     // TODO(pwbug/341): Move all other APIs to passing bytes_read by reference,
@@ -110,6 +141,40 @@ class PrefixedEntryRingBufferMulti {
     // OUT_OF_RANGE - No entries in ring buffer to pop.
     Status PopFront() { return buffer->InternalPopFront(*this); }
 
+    // Copy as many complete entries from the front of the ring buffer as fit
+    // in the provided destination std::span, up to max_entries, without
+    // popping them. Entries are copied with their preambles, in the same
+    // format as PeekFrontWithPreamble, so they can be split apart by decoding
+    // each entry's length varint. The entries are copied with at most two
+    // memcpy calls.
+    //
+    // Return values:
+    // OK - At least one entry was copied. bytes_read_out and
+    // entries_read_out are set to the bytes and entries copied.
+    // FAILED_PRECONDITION - Buffer not initialized.
+    // OUT_OF_RANGE - No entries in ring buffer to read.
+    // RESOURCE_EXHAUSTED - The front entry is larger than the destination.
+    // Nothing was copied.
+    Status PeekFrontMultiple(
+        std::span<std::byte> data,
+        size_t& bytes_read_out,
+        size_t& entries_read_out,
+        size_t max_entries = std::numeric_limits<size_t>::max()) {
+      return buffer->InternalPeekFrontMultiple(
+          *this, data, bytes_read_out, entries_read_out, max_entries);
+    }
+
+    // Pop and discard the oldest entry_count entries from the ring buffer.
+    //
+    // Return values:
+    // OK - Entries successfully popped.
+    // FAILED_PRECONDITION - Buffer not initialized.
+    // OUT_OF_RANGE - Fewer than entry_count entries to pop. Nothing was
+    // popped.
+    Status PopFrontMultiple(size_t entry_count) {
+      return buffer->InternalPopFrontMultiple(*this, entry_count);
+    }
+
     // Get the size in bytes of the next chunk, not including preamble, to be
     // read.
     size_t FrontEntryDataSizeBytes() {
@@ -128,6 +193,10 @@ class PrefixedEntryRingBufferMulti {
     // Entry count.
     size_t EntryCount() { return entry_count; }
 
+    // Get the number of bytes the unread entries take up in the ring buffer,
+    // including their preambles and any padding between them.
+    size_t EntriesSize() { return buffer->InternalEntriesSize(*this); }
+
    protected:
     friend PrefixedEntryRingBufferMulti;
 
@@ -142,7 +211,8 @@ class PrefixedEntryRingBufferMulti {
       : buffer_(nullptr),
         buffer_bytes_(0),
         write_idx_(0),
-        user_preamble_(user_preamble) {}
+        user_preamble_(user_preamble),
+        reservation_{} {}
 
   // Set the raw buffer to be used by the ring buffer.
   //
@@ -182,7 +252,7 @@ class PrefixedEntryRingBufferMulti {
   // Return values:
   // OK - Data successfully written to the ring buffer.
   // INVALID_ARGUMENT - Size of data to write is zero bytes
-  // FAILED_PRECONDITION - Buffer not initialized.
+  // FAILED_PRECONDITION - Buffer not initialized, or a reservation is open.
   // OUT_OF_RANGE - Size of data is greater than buffer size.
   Status PushBack(std::span<const std::byte> data,
                   uint32_t user_preamble_data = 0) {
@@ -205,7 +275,7 @@ class PrefixedEntryRingBufferMulti {
   // Return values:
   // OK - Data successfully written to the ring buffer.
   // INVALID_ARGUMENT - Size of data to write is zero bytes
-  // FAILED_PRECONDITION - Buffer not initialized.
+  // FAILED_PRECONDITION - Buffer not initialized, or a reservation is open.
   // OUT_OF_RANGE - Size of data is greater than buffer size.
   // RESOURCE_EXHAUSTED - The ring buffer doesn't have space for the data
   // without popping off existing elements.
@@ -221,6 +291,69 @@ class PrefixedEntryRingBufferMulti {
     return TryPushBack(data, static_cast<uint32_t>(user_preamble_data));
   }
 
+  // Write several chunks of data to the ring buffer as separate entries. This
+  // is equivalent to calling PushBack() for each chunk, but space is made for
+  // all of them at once and attached readers are updated once, rather than
+  // once per entry. Either all entries are written or none are.
+  //
+  // user_preamble_data holds the preamble for each entry, and must be empty or
+  // have one value per entry. If it is empty, every entry's preamble is 0.
+  //
+  // Return values:
+  // OK - Data successfully written to the ring buffer.
+  // INVALID_ARGUMENT - A chunk of data is zero bytes, or the number of
+  // preamble values does not match the number of entries.
+  // FAILED_PRECONDITION - Buffer not initialized, or a reservation is open.
+  // OUT_OF_RANGE - Size of all entries is greater than buffer size.
+  Status PushBackMultiple(
+      std::span<const std::span<const std::byte>> entries,
+      std::span<const uint32_t> user_preamble_data = {});
+
+  // Reserve space for an entry of up to size_bytes bytes, and get a contiguous
+  // region of the ring buffer to write the entry's data to. This lets callers
+  // encode entries in place, rather than into a temporary buffer that
+  // PushBack() copies. Once the data is written, Commit() the entry with its
+  // actual size.
+  //
+  // If the entry's data would wrap around the end of the buffer, the space up
+  // to the end is filled with padding, which readers skip, and the data starts
+  // at the beginning of the buffer.
+  //
+  // Like PushBack(), Reserve() pops and discards the oldest entries to make
+  // space, even if the reservation is later cancelled. Only one reservation
+  // may be open at a time. While it is open, PushBack(), TryPushBack(),
+  // PushBackMultiple(), and Dering() fail with FAILED_PRECONDITION.
+  //
+  // Return values:
+  // OK - region_out is where to write the entry's data.
+  // INVALID_ARGUMENT - Size of the reservation is zero bytes.
+  // FAILED_PRECONDITION - Buffer not initialized, or a reservation is open.
+  // OUT_OF_RANGE - Size of the reservation is greater than buffer size.
+  Status Reserve(size_t size_bytes,
+                 std::span<std::byte>& region_out,
+                 uint32_t user_preamble_data = 0) {
+    return InternalReserve(size_bytes, region_out, user_preamble_data, true);
+  }
+
+  // Same as Reserve(), but fails with RESOURCE_EXHAUSTED rather than popping
+  // entries if there is not enough space.
+  Status TryReserve(size_t size_bytes,
+                    std::span<std::byte>& region_out,
+                    uint32_t user_preamble_data = 0) {
+    return InternalReserve(size_bytes, region_out, user_preamble_data, false);
+  }
+
+  // Commit the open reservation as an entry of size_bytes bytes, which must
+  // be no more than the reserved size. Committing zero bytes cancels the
+  // reservation.
+  //
+  // Return values:
+  // OK - The entry was added, or the reservation was cancelled.
+  // FAILED_PRECONDITION - No reservation is open.
+  // OUT_OF_RANGE - size_bytes is greater than the reserved size. The
+  // reservation remains open.
+  Status Commit(size_t size_bytes);
+
   // Get the size in bytes of all the current entries in the ring buffer,
   // including preamble and data chunk.
   size_t TotalUsedBytes() { return buffer_bytes_ - RawAvailableBytes(); }
@@ -229,10 +362,36 @@ class PrefixedEntryRingBufferMulti {
   // rotating to have the oldest entry is at the lowest address/index with
   // newest entry at the highest address.
   //
+  // Only the bytes of the current entries are moved, not the whole buffer. If
+  // the entries wrap around the end of the buffer, either wrapped segment that
+  // fits in the scratch buffer is moved through it, so every byte is moved at
+  // most twice. Otherwise, the entries are rotated in place, which is slower.
+  //
   // Return values:
   // OK - Buffer data successfully deringed.
-  // FAILED_PRECONDITION - Buffer not initialized, or no readers attached.
-  Status Dering();
+  // FAILED_PRECONDITION - Buffer not initialized, no readers attached, or a
+  // reservation is open.
+  Status Dering(std::span<std::byte> scratch);
+  Status Dering() { return Dering(std::span<std::byte>()); }
+
+  // Get every entry that has not been popped by the slowest reader, oldest
+  // first, in place in the ring buffer. Each entry has its preamble, as with
+  // Reader::PeekFrontWithPreamble(). If the entries wrap around the end of the
+  // buffer, they are split across first and second; otherwise, second is
+  // empty. This lets users that need the contents as contiguous data, such as
+  // crash snapshots, copy them out without deringing the buffer.
+  //
+  // The contents may include padding entries left by Reserve(). A padding
+  // entry has a data size of zero, and is followed by a varint with the number
+  // of bytes after it to skip.
+  //
+  // Like EntryView, the contents are valid only until the buffer is modified.
+  //
+  // Return values:
+  // OK - contents_out holds the contents, which are empty if no readers are
+  // attached.
+  // FAILED_PRECONDITION - Buffer not initialized, or a reservation is open.
+  Status PeekContents(EntryView& contents_out);
 
  protected:
   // Read the oldest stored data chunk of data from the ring buffer to
@@ -258,6 +417,10 @@ class PrefixedEntryRingBufferMulti {
                                        size_t* bytes_read_out);
   Status InternalPeekFrontWithPreamble(Reader& reader, ReadOutput output);
 
+  Status InternalPeekFrontInPlace(Reader& reader,
+                                  EntryView& entry_out,
+                                  uint32_t* user_preamble_out);
+
   // Pop and discard the oldest stored data chunk of data from the ring buffer.
   //
   // Return values:
@@ -266,6 +429,13 @@ class PrefixedEntryRingBufferMulti {
   // OUT_OF_RANGE - No entries in ring buffer to pop.
   Status InternalPopFront(Reader& reader);
 
+  Status InternalPeekFrontMultiple(Reader& reader,
+                                   std::span<std::byte> data,
+                                   size_t& bytes_read_out,
+                                   size_t& entries_read_out,
+                                   size_t max_entries);
+  Status InternalPopFrontMultiple(Reader& reader, size_t entry_count);
+
   // Get the size in bytes of the next chunk, not including preamble, to be
   // read.
   size_t InternalFrontEntryDataSizeBytes(Reader& reader);
@@ -274,6 +444,9 @@ class PrefixedEntryRingBufferMulti {
   // chunk, to be read.
   size_t InternalFrontEntryTotalSizeBytes(Reader& reader);
 
+  // Get the number of bytes the reader's unread entries take up.
+  size_t InternalEntriesSize(Reader& reader);
+
   // Internal version of Read used by all the public interface versions. T
   // should be of type ReadOutput.
   template <typename T>
@@ -287,6 +460,19 @@ class PrefixedEntryRingBufferMulti {
     size_t preamble_bytes;
     uint32_t user_preamble;
     size_t data_bytes;
+
+    // Padding fills the space before a reserved entry that would otherwise
+    // wrap. It is marked by a data size of zero, followed by a varint with
+    // the number of padding bytes. Readers skip it.
+    bool padding;
+  };
+
+  // The layout of an open reservation, starting at write_idx_.
+  struct Reservation {
+    size_t padding_bytes;
+    size_t header_bytes;
+    size_t data_bytes;
+    uint32_t user_preamble;
   };
 
   // Push back implementation, which optionally discards front elements to fit
@@ -295,6 +481,18 @@ class PrefixedEntryRingBufferMulti {
                           uint32_t user_preamble_data,
                           bool pop_front_if_needed);
 
+  Status InternalReserve(size_t size_bytes,
+                         std::span<std::byte>& region_out,
+                         uint32_t user_preamble_data,
+                         bool pop_front_if_needed);
+
+  // Returns how an entry of size_bytes would be laid out if it were reserved
+  // at the write index.
+  Reservation PlanReservation(size_t size_bytes,
+                              uint32_t user_preamble_data) const;
+
+  bool reservation_open() const { return reservation_.data_bytes != 0; }
+
   // Internal function to pop all of the slowest readers. This function may pop
   // multiple readers if multiple are slow.
   //
@@ -308,9 +506,16 @@ class PrefixedEntryRingBufferMulti {
   Reader& GetSlowestReader();
 
   // Get info struct with the size of the preamble and data chunk for the next
-  // entry to be read.
+  // entry to be read. If the reader is at padding, moves it past the padding.
   EntryInfo FrontEntryInfo(Reader& reader);
 
+  // Get info struct with the size of the preamble and data chunk for the entry
+  // or padding that starts at the given index.
+  EntryInfo EntryInfoAt(size_t index);
+
+  // Get the total size in bytes, including preamble, of an entry.
+  size_t EntrySizeBytes(size_t data_bytes, uint32_t user_preamble_data) const;
+
   // Get the raw number of available bytes free in the ring buffer. This is
   // not available bytes for data, since there is a variable size preamble for
   // each entry.
@@ -334,6 +539,9 @@ class PrefixedEntryRingBufferMulti {
   size_t write_idx_;
   const bool user_preamble_;
 
+  // The open reservation. data_bytes is 0 if there is none.
+  Reservation reservation_;
+
   // List of attached readers.
   IntrusiveList<Reader> readers_;
 
@@ -0,0 +1,140 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "pw_status/status.h"
+
+namespace pw {
+namespace ring_buffer {
+
+// A ring buffer of variable-length entries for one writer and any number of
+// readers, which may all run concurrently without a lock.
+//
+// Unlike PrefixedEntryRingBufferMulti, the writer never waits for readers and
+// does not track them. When the buffer is full, PushBack() overwrites the
+// oldest entries, whether or not every reader has read them. Readers that fall
+// behind detect this and skip ahead to the oldest entry still in the buffer,
+// reporting how many entries they missed.
+//
+// Each entry is stored as a varint sequence number, a varint length, and the
+// data. The writer publishes two positions: the end of the newest entry and
+// the start of the oldest one. Before overwriting anything, the writer moves
+// the oldest position past the entries it is about to overwrite. A reader
+// copies an entry out and then checks, seqlock style, that the oldest position
+// has not moved past the entry while it was copying. If it has, the copy may be
+// torn, so the reader discards it and skips ahead.
+//
+// Because entries may be overwritten at any time, readers only get copies of
+// entries, never views into the buffer.
+class SingleWriterRingBuffer {
+ public:
+  // A reader with its own position in a SingleWriterRingBuffer. A reader only
+  // sees entries pushed after it was constructed. Each reader must be used by
+  // only one thread at a time.
+  class Reader {
+   public:
+    explicit Reader(const SingleWriterRingBuffer& ring_buffer);
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    // Copies the oldest entry this reader has not read into the provided
+    // buffer and moves past it. If entries were overwritten before this reader
+    // read them, drop_count_out is set to the number of entries that were
+    // skipped; otherwise, it is set to 0. Entries dropped before the reader's
+    // first successful read are not counted.
+    //
+    // Return values:
+    // OK - An entry was copied. bytes_read_out is set to its size.
+    // OUT_OF_RANGE - There are no entries to read.
+    // RESOURCE_EXHAUSTED - The destination is smaller than the oldest entry.
+    // The reader does not move past the entry. bytes_read_out is set to the
+    // size of the entry.
+    Status PopFront(std::span<std::byte> data,
+                    size_t& bytes_read_out,
+                    uint32_t& drop_count_out);
+
+    // Returns true if there are no entries to read.
+    bool empty() const {
+      return read_position_ ==
+             ring_buffer_.write_position_.load(std::memory_order_acquire);
+    }
+
+   private:
+    const SingleWriterRingBuffer& ring_buffer_;
+    size_t read_position_;
+
+    // The sequence number of the next entry, if this reader has read one.
+    uint32_t next_sequence_;
+    bool has_read_;
+  };
+
+  // The buffer may be at most half the size_t range, so that positions can be
+  // compared across wrap-around.
+  explicit SingleWriterRingBuffer(std::span<std::byte> buffer);
+
+  SingleWriterRingBuffer(const SingleWriterRingBuffer&) = delete;
+  SingleWriterRingBuffer& operator=(const SingleWriterRingBuffer&) = delete;
+
+  // Writes an entry, overwriting the oldest entries if there is not enough
+  // space. Must only be called by the single writer.
+  //
+  // Return values:
+  // OK - Data successfully written to the ring buffer.
+  // INVALID_ARGUMENT - Size of data to write is zero bytes.
+  // OUT_OF_RANGE - The entry is larger than the buffer.
+  Status PushBack(std::span<const std::byte> data);
+
+  size_t capacity() const { return buffer_.size(); }
+
+ private:
+  static constexpr size_t kMaxBufferBytes =
+      std::numeric_limits<size_t>::max() / 2;
+
+  // The size of the largest entry header: a 32-bit sequence number and a
+  // 32-bit length, each varint encoded.
+  static constexpr size_t kMaxHeaderBytes = 10;
+
+  // Returns true if position a comes before position b. Positions count bytes
+  // pushed and wrap around at the size_t maximum.
+  static bool Before(size_t a, size_t b) {
+    return static_cast<std::ptrdiff_t>(a - b) < 0;
+  }
+
+  // Copies length bytes starting at position into destination, handling
+  // wrap-around.
+  void Read(size_t position, std::byte* destination, size_t length) const;
+
+  // Copies source into the buffer starting at position, handling wrap-around.
+  void Write(size_t position, std::span<const std::byte> source);
+
+  const std::span<std::byte> buffer_;
+
+  // The start of the oldest entry, and the end of the newest entry. Both are
+  // only written by the writer.
+  std::atomic<size_t> oldest_position_;
+  std::atomic<size_t> write_position_;
+
+  // The sequence number of the next entry. Only used by the writer.
+  uint32_t sequence_;
+};
+
+}  // namespace ring_buffer
+}  // namespace pw
@@ -0,0 +1,191 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_ring_buffer/single_writer_ring_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pw_assert/assert.h"
+#include "pw_varint/varint.h"
+
+namespace pw {
+namespace ring_buffer {
+
+using std::byte;
+
+SingleWriterRingBuffer::SingleWriterRingBuffer(std::span<byte> buffer)
+    : buffer_(buffer), oldest_position_(0), write_position_(0), sequence_(0) {
+  PW_ASSERT(!buffer.empty() && buffer.size() <= kMaxBufferBytes);
+}
+
+Status SingleWriterRingBuffer::PushBack(std::span<const byte> data) {
+  if (data.empty()) {
+    return Status::InvalidArgument();
+  }
+
+  byte header[kMaxHeaderBytes];
+  size_t header_bytes = varint::Encode<uint32_t>(sequence_, header);
+  header_bytes += varint::Encode<uint32_t>(
+      data.size(), std::span(header).subspan(header_bytes));
+  const size_t entry_bytes = header_bytes + data.size();
+  if (entry_bytes > buffer_.size()) {
+    return Status::OutOfRange();
+  }
+
+  // Only the writer modifies the positions, so relaxed loads are enough.
+  const size_t write = write_position_.load(std::memory_order_relaxed);
+  size_t oldest = oldest_position_.load(std::memory_order_relaxed);
+
+  // Drop the oldest entries until the new entry fits.
+  while (write + entry_bytes - oldest > buffer_.size()) {
+    byte oldest_header[kMaxHeaderBytes];
+    const size_t oldest_header_bytes =
+        std::min(write - oldest, kMaxHeaderBytes);
+    Read(oldest, oldest_header, oldest_header_bytes);
+
+    uint64_t value;
+    size_t sequence_bytes = varint::Decode(
+        std::span(oldest_header, oldest_header_bytes), &value);
+    size_t length_bytes = varint::Decode(
+        std::span(oldest_header, oldest_header_bytes).subspan(sequence_bytes),
+        &value);
+    PW_DASSERT(sequence_bytes != 0u && length_bytes != 0u);
+    oldest += sequence_bytes + length_bytes + value;
+  }
+
+  // Publish the new oldest position before overwriting anything. The fence
+  // ensures that a reader that sees any of the bytes written below also sees
+  // the new oldest position, so it knows its copy may be torn.
+  oldest_position_.store(oldest, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  Write(write, std::span(header, header_bytes));
+  Write(write + header_bytes, data);
+  write_position_.store(write + entry_bytes, std::memory_order_release);
+  sequence_ += 1;
+  return OkStatus();
+}
+
+void SingleWriterRingBuffer::Read(size_t position,
+                                  byte* destination,
+                                  size_t length) const {
+  const size_t index = position % buffer_.size();
+  const size_t bytes_until_wrap = buffer_.size() - index;
+  const size_t bytes_to_copy = std::min(length, bytes_until_wrap);
+  std::memcpy(destination, buffer_.data() + index, bytes_to_copy);
+
+  if (bytes_to_copy < length) {
+    std::memcpy(
+        destination + bytes_to_copy, buffer_.data(), length - bytes_to_copy);
+  }
+}
+
+void SingleWriterRingBuffer::Write(size_t position,
+                                   std::span<const byte> source) {
+  const size_t index = position % buffer_.size();
+  const size_t bytes_until_wrap = buffer_.size() - index;
+  const size_t bytes_to_copy = std::min(source.size(), bytes_until_wrap);
+  std::memcpy(buffer_.data() + index, source.data(), bytes_to_copy);
+
+  if (bytes_to_copy < source.size()) {
+    std::memcpy(buffer_.data(),
+                source.data() + bytes_to_copy,
+                source.size() - bytes_to_copy);
+  }
+}
+
+SingleWriterRingBuffer::Reader::Reader(
+    const SingleWriterRingBuffer& ring_buffer)
+    : ring_buffer_(ring_buffer),
+      read_position_(
+          ring_buffer.write_position_.load(std::memory_order_acquire)),
+      next_sequence_(0),
+      has_read_(false) {}
+
+Status SingleWriterRingBuffer::Reader::PopFront(std::span<byte> data,
+                                                size_t& bytes_read_out,
+                                                uint32_t& drop_count_out) {
+  bytes_read_out = 0;
+  drop_count_out = 0;
+
+  while (true) {
+    const size_t write =
+        ring_buffer_.write_position_.load(std::memory_order_acquire);
+    if (read_position_ == write) {
+      return Status::OutOfRange();
+    }
+
+    // If the writer has overwritten this reader's next entry, skip ahead to
+    // the oldest entry. The sequence numbers show how many were skipped.
+    const size_t oldest =
+        ring_buffer_.oldest_position_.load(std::memory_order_acquire);
+    if (Before(read_position_, oldest)) {
+      read_position_ = oldest;
+      if (read_position_ == write) {
+        return Status::OutOfRange();
+      }
+    }
+
+    // The writer may be overwriting this entry while it is copied, so the
+    // header may be garbage. Bound every copy by what has been written.
+    const size_t available = write - read_position_;
+    byte header[kMaxHeaderBytes];
+    const size_t header_bytes_read = std::min(available, kMaxHeaderBytes);
+    ring_buffer_.Read(read_position_, header, header_bytes_read);
+
+    uint64_t sequence = 0;
+    uint64_t length = 0;
+    const size_t sequence_bytes =
+        varint::Decode(std::span(header, header_bytes_read), &sequence);
+    const size_t length_bytes =
+        sequence_bytes == 0
+            ? 0
+            : varint::Decode(
+                  std::span(header, header_bytes_read).subspan(sequence_bytes),
+                  &length);
+    const size_t header_bytes = sequence_bytes + length_bytes;
+    const bool header_valid =
+        length_bytes != 0 && length <= available - header_bytes;
+
+    if (header_valid && length <= data.size()) {
+      ring_buffer_.Read(read_position_ + header_bytes, data.data(), length);
+    }
+
+    // If the oldest position moved past this entry, the copy may be torn.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (Before(read_position_,
+               ring_buffer_.oldest_position_.load(std::memory_order_relaxed))) {
+      continue;
+    }
+
+    // The entry was not overwritten, so its header is intact.
+    PW_DASSERT(header_valid);
+    bytes_read_out = length;
+    if (length > data.size()) {
+      return Status::ResourceExhausted();
+    }
+
+    if (has_read_) {
+      drop_count_out = static_cast<uint32_t>(sequence) - next_sequence_;
+    }
+    next_sequence_ = static_cast<uint32_t>(sequence) + 1;
+    has_read_ = true;
+    read_position_ += header_bytes + length;
+    return OkStatus();
+  }
+}
+
+}  // namespace ring_buffer
+}  // namespace pw
@@ -0,0 +1,201 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_ring_buffer/single_writer_ring_buffer.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_unit_test/framework.h"
+
+using std::byte;
+
+namespace pw {
+namespace ring_buffer {
+namespace {
+
+// Pushes an entry of the given length, filled with the given value.
+Status Push(SingleWriterRingBuffer& ring, size_t length, uint8_t value) {
+  std::array<byte, 64> data;
+  data.fill(byte{value});
+  return ring.PushBack(std::span(data).first(length));
+}
+
+// Pops an entry and checks that it has the given length and value.
+void ExpectPop(SingleWriterRingBuffer::Reader& reader,
+               size_t length,
+               uint8_t value,
+               uint32_t drop_count = 0) {
+  std::array<byte, 64> data;
+  size_t bytes_read = 0;
+  uint32_t drops = 0;
+  ASSERT_EQ(reader.PopFront(data, bytes_read, drops), OkStatus());
+  ASSERT_EQ(bytes_read, length);
+  EXPECT_EQ(drops, drop_count);
+  for (size_t i = 0; i < length; ++i) {
+    EXPECT_EQ(data[i], byte{value});
+  }
+}
+
+void ExpectEmpty(SingleWriterRingBuffer::Reader& reader) {
+  std::array<byte, 64> data;
+  size_t bytes_read = 1;
+  uint32_t drops = 1;
+  EXPECT_TRUE(reader.empty());
+  EXPECT_EQ(reader.PopFront(data, bytes_read, drops), Status::OutOfRange());
+  EXPECT_EQ(bytes_read, 0u);
+  EXPECT_EQ(drops, 0u);
+}
+
+TEST(SingleWriterRingBuffer, PushAndPop) {
+  std::array<byte, 64> buffer;
+  SingleWriterRingBuffer ring(buffer);
+  SingleWriterRingBuffer::Reader reader(ring);
+  ExpectEmpty(reader);
+
+  EXPECT_EQ(Push(ring, 1, 1), OkStatus());
+  EXPECT_EQ(Push(ring, 5, 2), OkStatus());
+  EXPECT_EQ(Push(ring, 9, 3), OkStatus());
+  EXPECT_FALSE(reader.empty());
+
+  ExpectPop(reader, 1, 1);
+  ExpectPop(reader, 5, 2);
+  ExpectPop(reader, 9, 3);
+  ExpectEmpty(reader);
+}
+
+TEST(SingleWriterRingBuffer, InvalidEntries) {
+  std::array<byte, 16> buffer;
+  SingleWriterRingBuffer ring(buffer);
+  SingleWriterRingBuffer::Reader reader(ring);
+
+  EXPECT_EQ(ring.PushBack(std::span<const byte>()), Status::InvalidArgument());
+  // Each entry has a one byte sequence number and a one byte length.
+  EXPECT_EQ(Push(ring, 15, 1), Status::OutOfRange());
+  EXPECT_EQ(Push(ring, 14, 1), OkStatus());
+  ExpectPop(reader, 14, 1);
+  ExpectEmpty(reader);
+}
+
+TEST(SingleWriterRingBuffer, ReaderOnlySeesLaterEntries) {
+  std::array<byte, 64> buffer;
+  SingleWriterRingBuffer ring(buffer);
+  SingleWriterRingBuffer::Reader early_reader(ring);
+
+  EXPECT_EQ(Push(ring, 4, 1), OkStatus());
+  SingleWriterRingBuffer::Reader late_reader(ring);
+  EXPECT_EQ(Push(ring, 4, 2), OkStatus());
+
+  ExpectPop(early_reader, 4, 1);
+  ExpectPop(early_reader, 4, 2);
+  ExpectEmpty(early_reader);
+
+  ExpectPop(late_reader, 4, 2);
+  ExpectEmpty(late_reader);
+}
+
+TEST(SingleWriterRingBuffer, ReadersAreIndependent) {
+  std::array<byte, 64> buffer;
+  SingleWriterRingBuffer ring(buffer);
+  SingleWriterRingBuffer::Reader fast_reader(ring);
+  SingleWriterRingBuffer::Reader slow_reader(ring);
+
+  for (uint8_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(Push(ring, 6, i), OkStatus());
+    ExpectPop(fast_reader, 6, i);
+  }
+  ExpectEmpty(fast_reader);
+
+  for (uint8_t i = 0; i < 4; ++i) {
+    ExpectPop(slow_reader, 6, i);
+  }
+  ExpectEmpty(slow_reader);
+}
+
+TEST(SingleWriterRingBuffer, OverwritesOldestEntries) {
+  // Entries of six bytes of data take eight bytes, so four fit.
+  std::array<byte, 32> buffer;
+  SingleWriterRingBuffer ring(buffer);
+  SingleWriterRingBuffer::Reader reader(ring);
+
+  EXPECT_EQ(Push(ring, 6, 0), OkStatus());
+  ExpectPop(reader, 6, 0);
+
+  // The writer never waits for the reader.
+  for (uint8_t i = 1; i <= 10; ++i) {
+    EXPECT_EQ(Push(ring, 6, i), OkStatus());
+  }
+
+  // Entries 1 through 6 were overwritten.
+  ExpectPop(reader, 6, 7, 6);
+  ExpectPop(reader, 6, 8);
+  ExpectPop(reader, 6, 9);
+  ExpectPop(reader, 6, 10);
+  ExpectEmpty(reader);
+}
+
+TEST(SingleWriterRingBuffer, LargeEntryOverwritesSeveral) {
+  std::array<byte, 32> buffer;
+  SingleWriterRingBuffer ring(buffer);
+  SingleWriterRingBuffer::Reader reader(ring);
+
+  EXPECT_EQ(Push(ring, 2, 0), OkStatus());
+  ExpectPop(reader, 2, 0);
+  for (uint8_t i = 1; i <= 4; ++i) {
+    EXPECT_EQ(Push(ring, 4, i), OkStatus());
+  }
+  EXPECT_EQ(Push(ring, 30, 5), OkStatus());
+
+  ExpectPop(reader, 30, 5, 4);
+  ExpectEmpty(reader);
+}
+
+TEST(SingleWriterRingBuffer, SmallDestination) {
+  std::array<byte, 32> buffer;
+  SingleWriterRingBuffer ring(buffer);
+  SingleWriterRingBuffer::Reader reader(ring);
+  EXPECT_EQ(Push(ring, 8, 1), OkStatus());
+
+  std::array<byte, 4> small;
+  size_t bytes_read = 0;
+  uint32_t drops = 0;
+  EXPECT_EQ(reader.PopFront(small, bytes_read, drops),
+            Status::ResourceExhausted());
+  EXPECT_EQ(bytes_read, 8u);
+
+  // The reader did not move past the entry.
+  ExpectPop(reader, 8, 1);
+  ExpectEmpty(reader);
+}
+
+TEST(SingleWriterRingBuffer, EntriesWrapAroundBuffer) {
+  // Entry sizes that do not divide the buffer size, so entries are split
+  // across the end of the buffer at different offsets.
+  std::array<byte, 37> buffer;
+  SingleWriterRingBuffer ring(buffer);
+  SingleWriterRingBuffer::Reader reader(ring);
+
+  for (uint32_t i = 0; i < 200; ++i) {
+    const size_t length = 1 + i % 11;
+    const uint8_t value = static_cast<uint8_t>(i);
+    ASSERT_EQ(Push(ring, length, value), OkStatus());
+    ExpectPop(reader, length, value);
+  }
+  ExpectEmpty(reader);
+}
+
+}  // namespace
+}  // namespace ring_buffer
+}  // namespace pw
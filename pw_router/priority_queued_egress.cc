@@ -0,0 +1,143 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_router/priority_queued_egress.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "pw_assert/assert.h"
+
+namespace pw::router::internal {
+
+BasePriorityQueuedEgress::BasePriorityQueuedEgress(
+    ByteSpan pool,
+    size_t max_packet_size,
+    std::span<Queue> queues,
+    std::span<uint16_t> packet_sizes)
+    : pool_(pool),
+      max_packet_size_(max_packet_size),
+      priority_levels_(queues.size()),
+      packets_per_level_(packet_sizes.size() / queues.size()),
+      queues_(queues),
+      packet_sizes_(packet_sizes) {
+  PW_ASSERT(!queues.empty());
+  PW_ASSERT(packets_per_level_ * queues.size() == packet_sizes.size());
+  PW_ASSERT(packet_sizes.size() * max_packet_size == pool.size());
+}
+
+Status BasePriorityQueuedEgress::SendPacket(ConstByteSpan packet,
+                                            const PacketMetadata& metadata) {
+  if (packet.size() > max_packet_size_) {
+    return Status::OutOfRange();
+  }
+
+  const size_t level = Level(metadata);
+  size_t index;
+  bool congested;
+  {
+    std::lock_guard lock(lock_);
+    Queue& queue = queues_[level];
+    if (queue.count == packets_per_level_) {
+      return Status::ResourceExhausted();
+    }
+    index = slot(level, queue.head + queue.count);
+    packet_sizes_[index] = kFilling;
+    queue.count += 1;
+    congested = queue.count == packets_per_level_;
+  }
+
+  // The slot is reserved, so the packet is copied without holding the lock.
+  std::memcpy(buffer(index).data(), packet.data(), packet.size());
+
+  {
+    std::lock_guard lock(lock_);
+    packet_sizes_[index] = static_cast<uint16_t>(packet.size());
+  }
+
+  if (congested) {
+    BackpressureChanged(level, true);
+  }
+  PacketQueued();
+  return OkStatus();
+}
+
+Status BasePriorityQueuedEgress::TransmitQueuedPackets() {
+  Status status;
+
+  while (true) {
+    size_t level = priority_levels_;
+    size_t index = 0;
+    size_t size = 0;
+    {
+      std::lock_guard lock(lock_);
+
+      // Take the first packet of the highest priority queue. A packet that is
+      // still being copied in is skipped; its sender calls PacketQueued()
+      // once it is ready.
+      for (size_t i = priority_levels_; i > 0u; --i) {
+        const Queue& queue = queues_[i - 1];
+        if (queue.count == 0u) {
+          continue;
+        }
+        const size_t front = slot(i - 1, queue.head);
+        if (packet_sizes_[front] != kFilling) {
+          level = i - 1;
+          index = front;
+          size = packet_sizes_[front];
+          break;
+        }
+      }
+    }
+
+    if (level == priority_levels_) {
+      break;
+    }
+
+    // Senders only write to slots after the front of the queue, so the lock is
+    // not held while the packet is transmitted.
+    Status result = Transmit(buffer(index).first(size));
+    if (status.ok()) {
+      status = result;
+    }
+
+    bool was_congested;
+    {
+      std::lock_guard lock(lock_);
+      Queue& queue = queues_[level];
+      was_congested = queue.count == packets_per_level_;
+      queue.head = (queue.head + 1) % packets_per_level_;
+      queue.count -= 1;
+    }
+
+    if (was_congested) {
+      BackpressureChanged(level, false);
+    }
+  }
+
+  return status;
+}
+
+size_t BasePriorityQueuedEgress::queued_packets(size_t level) const {
+  std::lock_guard lock(lock_);
+  return queues_[level].count;
+}
+
+size_t BasePriorityQueuedEgress::Level(const PacketMetadata& metadata) const {
+  return std::min<size_t>(metadata.priority.value_or(0),
+                           priority_levels_ - 1);
+}
+
+}  // namespace pw::router::internal
@@ -0,0 +1,167 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_router/priority_queued_egress.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace pw::router {
+namespace {
+
+class TestEgress : public PriorityQueuedEgress<3, 2, 16> {
+ public:
+  std::vector<std::vector<std::byte>> sent;
+  std::vector<std::pair<size_t, bool>> backpressure;
+  size_t packets_queued = 0;
+  Status transmit_status;
+
+ private:
+  Status Transmit(ConstByteSpan packet) override {
+    sent.emplace_back(packet.begin(), packet.end());
+    return std::exchange(transmit_status, OkStatus());
+  }
+
+  void PacketQueued() override { packets_queued += 1; }
+
+  void BackpressureChanged(size_t level, bool congested) override {
+    backpressure.emplace_back(level, congested);
+  }
+};
+
+std::array<std::byte, 1> Packet(uint8_t value) {
+  return {std::byte{value}};
+}
+
+PacketMetadata Priority(uint32_t priority) {
+  PacketMetadata metadata;
+  metadata.priority = priority;
+  return metadata;
+}
+
+uint8_t SentValue(const std::vector<std::byte>& packet) {
+  return static_cast<uint8_t>(packet.at(0));
+}
+
+TEST(PriorityQueuedEgress, TransmitQueuedPackets_HighestPriorityFirst) {
+  TestEgress egress;
+
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(1), Priority(0)));
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(2), Priority(1)));
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(3), Priority(2)));
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(4), Priority(0)));
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(5), Priority(2)));
+  EXPECT_EQ(egress.packets_queued, 5u);
+
+  EXPECT_EQ(OkStatus(), egress.TransmitQueuedPackets());
+
+  ASSERT_EQ(egress.sent.size(), 5u);
+  EXPECT_EQ(SentValue(egress.sent[0]), 3u);
+  EXPECT_EQ(SentValue(egress.sent[1]), 5u);
+  EXPECT_EQ(SentValue(egress.sent[2]), 2u);
+  EXPECT_EQ(SentValue(egress.sent[3]), 1u);
+  EXPECT_EQ(SentValue(egress.sent[4]), 4u);
+  EXPECT_EQ(egress.queued_packets(0), 0u);
+}
+
+TEST(PriorityQueuedEgress, SendPacket_CopiesPacket) {
+  TestEgress egress;
+  constexpr std::array<std::byte, 16> kPacket = {
+      std::byte{0xf0}, std::byte{0x0d}, std::byte{0xca}, std::byte{0xfe}};
+
+  ASSERT_EQ(OkStatus(), egress.SendPacket(kPacket, {}));
+  EXPECT_EQ(OkStatus(), egress.TransmitQueuedPackets());
+
+  ASSERT_EQ(egress.sent.size(), 1u);
+  ASSERT_EQ(egress.sent[0].size(), kPacket.size());
+  EXPECT_EQ(std::memcmp(egress.sent[0].data(), kPacket.data(), kPacket.size()),
+            0);
+}
+
+TEST(PriorityQueuedEgress, SendPacket_TooLarge_OutOfRange) {
+  TestEgress egress;
+  std::array<std::byte, 17> packet = {};
+
+  EXPECT_EQ(Status::OutOfRange(), egress.SendPacket(packet, {}));
+  EXPECT_EQ(egress.packets_queued, 0u);
+}
+
+TEST(PriorityQueuedEgress, SendPacket_NoPriority_UsesLowestLevel) {
+  TestEgress egress;
+
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(1), {}));
+  EXPECT_EQ(egress.queued_packets(0), 1u);
+}
+
+TEST(PriorityQueuedEgress, SendPacket_PriorityAboveHighest_UsesHighestLevel) {
+  TestEgress egress;
+
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(1), Priority(1000)));
+  EXPECT_EQ(egress.queued_packets(2), 1u);
+}
+
+TEST(PriorityQueuedEgress, SendPacket_LevelFull_ResourceExhausted) {
+  TestEgress egress;
+
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(1), Priority(1)));
+  EXPECT_TRUE(egress.backpressure.empty());
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(2), Priority(1)));
+  ASSERT_EQ(egress.backpressure.size(), 1u);
+  EXPECT_EQ(egress.backpressure[0], std::make_pair(size_t{1}, true));
+
+  EXPECT_EQ(Status::ResourceExhausted(),
+            egress.SendPacket(Packet(3), Priority(1)));
+
+  // Other levels still have room.
+  EXPECT_EQ(OkStatus(), egress.SendPacket(Packet(4), Priority(0)));
+  EXPECT_EQ(OkStatus(), egress.SendPacket(Packet(5), Priority(2)));
+}
+
+TEST(PriorityQueuedEgress, TransmitQueuedPackets_RelievesBackpressure) {
+  TestEgress egress;
+
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(1), Priority(0)));
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(2), Priority(0)));
+  EXPECT_EQ(OkStatus(), egress.TransmitQueuedPackets());
+
+  ASSERT_EQ(egress.backpressure.size(), 2u);
+  EXPECT_EQ(egress.backpressure[1], std::make_pair(size_t{0}, false));
+
+  // The queue wraps around.
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(3), Priority(0)));
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(4), Priority(0)));
+  EXPECT_EQ(OkStatus(), egress.TransmitQueuedPackets());
+
+  ASSERT_EQ(egress.sent.size(), 4u);
+  EXPECT_EQ(SentValue(egress.sent[2]), 3u);
+  EXPECT_EQ(SentValue(egress.sent[3]), 4u);
+}
+
+TEST(PriorityQueuedEgress, TransmitQueuedPackets_Error_SendsRemainingPackets) {
+  TestEgress egress;
+
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(1), Priority(2)));
+  ASSERT_EQ(OkStatus(), egress.SendPacket(Packet(2), Priority(0)));
+  egress.transmit_status = Status::Unavailable();
+
+  EXPECT_EQ(Status::Unavailable(), egress.TransmitQueuedPackets());
+  EXPECT_EQ(egress.sent.size(), 2u);
+  EXPECT_EQ(egress.queued_packets(2), 0u);
+}
+
+}  // namespace
+}  // namespace pw::router
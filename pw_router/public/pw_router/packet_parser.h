@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <span>
 
@@ -50,4 +51,26 @@ class PacketParser {
   virtual std::optional<uint32_t> GetPriority() const { return std::nullopt; }
 };
 
+// The fields of a packet that routers use, as extracted by a
+// StatelessPacketParser.
+struct ParsedPacket {
+  uint32_t destination_address;
+
+  // Project-specific priority of the packet, if it has one.
+  std::optional<uint32_t> priority;
+};
+
+// A packet parser that returns the parsed fields instead of storing them.
+// Unlike a PacketParser, it keeps no state between packets, so a single parser
+// may parse packets from several threads at once without synchronization.
+class StatelessPacketParser {
+ public:
+  virtual ~StatelessPacketParser() = default;
+
+  // Parses a packet, returning its routing fields, or std::nullopt if the
+  // packet is incomplete or corrupt or has no destination address. May be
+  // called from several threads at once.
+  virtual std::optional<ParsedPacket> Parse(ConstByteSpan packet) const = 0;
+};
+
 }  // namespace pw::router
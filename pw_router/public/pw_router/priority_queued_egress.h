@@ -0,0 +1,156 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_router/egress.h"
+#include "pw_status/status.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+
+namespace pw::router {
+namespace internal {
+
+// The implementation of PriorityQueuedEgress, which provides the storage.
+class BasePriorityQueuedEgress : public Egress {
+ public:
+  // Copies the packet into the queue for its priority and returns OK, or
+  // returns one of the following without queueing it:
+  //
+  //   RESOURCE_EXHAUSTED - The queue for the packet's priority is full.
+  //   OUT_OF_RANGE - The packet is larger than the egress's buffers.
+  //
+  // This never blocks, so it may be called from several threads at once.
+  Status SendPacket(ConstByteSpan packet, const PacketMetadata& metadata) final
+      PW_LOCKS_EXCLUDED(lock_);
+
+  // Transmits queued packets, highest priority first, until every queue is
+  // empty. A packet queued at a higher priority while this runs is sent before
+  // the remaining lower priority packets. Only one thread may call this at a
+  // time. Returns the first error from Transmit(), but transmits all queued
+  // packets regardless.
+  Status TransmitQueuedPackets() PW_LOCKS_EXCLUDED(lock_);
+
+  // The number of packets waiting to be transmitted at a priority level.
+  size_t queued_packets(size_t level) const PW_LOCKS_EXCLUDED(lock_);
+
+  size_t priority_levels() const { return priority_levels_; }
+
+ protected:
+  struct Queue {
+    size_t head;
+    size_t count;  // Includes slots that are still being filled.
+  };
+
+  BasePriorityQueuedEgress(ByteSpan pool,
+                           size_t max_packet_size,
+                           std::span<Queue> queues,
+                           std::span<uint16_t> packet_sizes);
+
+ private:
+  // Marks a slot that has been reserved but not yet filled.
+  static constexpr uint16_t kFilling = UINT16_MAX;
+
+  // Sends a packet to the transport. Called from TransmitQueuedPackets().
+  virtual Status Transmit(ConstByteSpan packet) = 0;
+
+  // Called after a packet is queued. Derived classes may override this to wake
+  // the thread that transmits packets.
+  virtual void PacketQueued() {}
+
+  // Called when the queue for a priority level fills up, with congested set,
+  // and when it has room again, with congested clear. Derived classes may
+  // override this to tell senders to hold back traffic at that priority.
+  virtual void BackpressureChanged(size_t /* level */, bool /* congested */) {}
+
+  size_t Level(const PacketMetadata& metadata) const;
+
+  size_t slot(size_t level, size_t position) const {
+    return level * packets_per_level_ + position % packets_per_level_;
+  }
+
+  ByteSpan buffer(size_t slot) const {
+    return pool_.subspan(slot * max_packet_size_, max_packet_size_);
+  }
+
+  const ByteSpan pool_;
+  const size_t max_packet_size_;
+  const size_t priority_levels_;
+  const size_t packets_per_level_;
+
+  mutable sync::InterruptSpinLock lock_;
+
+  // A ring of slots for each priority level, lowest priority first.
+  const std::span<Queue> queues_ PW_GUARDED_BY(lock_);
+
+  // The size of the packet in each slot, or kFilling.
+  const std::span<uint16_t> packet_sizes_ PW_GUARDED_BY(lock_);
+};
+
+}  // namespace internal
+
+// An Egress that queues packets by priority, so that high-priority traffic,
+// such as control messages, overtakes bulk data on a congested link instead of
+// being dropped behind it.
+//
+// Each priority level has its own bounded queue. SendPacket() copies the packet
+// into the queue for its PacketMetadata priority and returns immediately. A
+// single transmit thread sends queued packets by calling
+// TransmitQueuedPackets(), always taking the next packet from the highest
+// priority queue that has one. Packets without a priority use the lowest level,
+// and priorities above the highest level use the highest.
+//
+// When a level's queue is full, SendPacket() returns RESOURCE_EXHAUSTED, which
+// routers report as UNAVAILABLE, and BackpressureChanged() is called so the
+// egress can signal senders to slow down.
+//
+// To use it, derive from this class and implement Transmit(). Optionally,
+// override PacketQueued() to signal the transmit thread and
+// BackpressureChanged() to signal senders.
+//
+//   class UartEgress : public pw::router::PriorityQueuedEgress<2, 8, 256> {
+//    private:
+//     pw::Status Transmit(pw::ConstByteSpan packet) override {
+//       return uart.Write(packet);
+//     }
+//
+//     void PacketQueued() override { transmit_semaphore.release(); }
+//   };
+//
+template <size_t kPriorityLevels,
+          size_t kPacketsPerLevel,
+          size_t kMaxPacketSizeBytes>
+class PriorityQueuedEgress : public internal::BasePriorityQueuedEgress {
+ public:
+  static_assert(kPriorityLevels > 0u);
+  static_assert(kPacketsPerLevel > 0u);
+  static_assert(kMaxPacketSizeBytes < UINT16_MAX);
+
+  PriorityQueuedEgress()
+      : BasePriorityQueuedEgress(pool_, kMaxPacketSizeBytes, queues_, sizes_) {}
+
+ private:
+  static constexpr size_t kSlots = kPriorityLevels * kPacketsPerLevel;
+
+  std::array<std::byte, kSlots * kMaxPacketSizeBytes> pool_;
+  std::array<Queue, kPriorityLevels> queues_ = {};
+  std::array<uint16_t, kSlots> sizes_ = {};
+};
+
+}  // namespace pw::router
@@ -27,6 +27,13 @@ namespace pw::router {
 
 // A packet router with a static routing table.
 //
+// If the routes are sorted by address, each packet's route is found with a
+// binary search. Otherwise, the routes are searched linearly.
+//
+// Packets for an address with no route may be sent to several egresses through
+// a multicast route. The packet is parsed once and the same buffer is passed to
+// each egress in turn, so it is neither parsed nor copied again per egress.
+//
 // Thread-safety:
 //   Internal packet parsing and calls to the provided PacketParser are
 //   synchronized. Synchronization at the egress level must be implemented by
@@ -40,8 +47,22 @@ class StaticRouter {
     Egress& egress;
   };
 
+  struct MulticastRoute {
+    uint32_t address;
+    std::span<Egress* const> egresses;
+  };
+
   StaticRouter(PacketParser& parser, std::span<const Route> routes)
-      : parser_(parser), routes_(routes) {}
+      : StaticRouter(parser, routes, {}) {}
+
+  // Routes are searched before multicast routes, which are searched linearly.
+  StaticRouter(PacketParser& parser,
+               std::span<const Route> routes,
+               std::span<const MulticastRoute> multicast_routes)
+      : parser_(parser),
+        routes_(routes),
+        multicast_routes_(multicast_routes),
+        routes_sorted_(AddressesAreSorted(routes)) {}
 
   StaticRouter(const StaticRouter&) = delete;
   StaticRouter(StaticRouter&&) = delete;
@@ -53,21 +74,34 @@ class StaticRouter {
            egress_errors_.value();
   }
 
-  const metric::Group& metrics() { return metrics_; }
+  metric::Group& metrics() { return metrics_; }
+  const metric::Group& metrics() const { return metrics_; }
 
-  // Routes a single packet through the appropriate egress.
-  // Returns one of the following to indicate a router-side error:
+  // Routes a single packet through the appropriate egress, or through each
+  // egress of its multicast route. Returns one of the following to indicate a
+  // router-side error:
   //
   //   OK - Packet sent successfully.
   //   DATA_LOSS - Packet corrupt or incomplete.
   //   NOT_FOUND - No registered route for the packet.
-  //   UNAVAILABLE - Route egress did not accept packet.
+  //   UNAVAILABLE - Route egress did not accept packet. For a multicast route,
+  //       at least one egress did not accept it; the others still received it.
   //
   Status RoutePacket(ConstByteSpan packet) PW_LOCKS_EXCLUDED(mutex_);
 
  private:
+  static bool AddressesAreSorted(std::span<const Route> routes);
+
+  // Returns the route for an address, or nullptr if there is none.
+  const Route* FindRoute(uint32_t address) const;
+
+  // Returns the multicast route for an address, or nullptr if there is none.
+  const MulticastRoute* FindMulticastRoute(uint32_t address) const;
+
   PacketParser& parser_ PW_GUARDED_BY(mutex_);
   const std::span<const Route> routes_;
+  const std::span<const MulticastRoute> multicast_routes_;
+  const bool routes_sorted_;
   sync::Mutex mutex_;
   PW_METRIC_GROUP(metrics_, "static_router");
   PW_METRIC(metrics_, parser_errors_, "parser_errors", 0u);
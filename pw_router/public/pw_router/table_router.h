@@ -0,0 +1,103 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_router/egress.h"
+#include "pw_router/packet_parser.h"
+#include "pw_status/status.h"
+
+namespace pw::router {
+
+// A packet router whose routing table is indexed directly by address, for
+// networks whose addresses are small integers in a known range.
+//
+// Each address in [first_address, first_address + table size) maps to the
+// egress at its offset in the table, or to no route if that entry is null, so
+// every lookup takes constant time. Packets are parsed with a
+// StatelessPacketParser and the router takes no lock, so the receive threads
+// of several links may route packets at once.
+//
+// Thread-safety:
+//   RoutePacket may be called from any number of threads at once. Egresses
+//   must synchronize themselves if they are shared between routes that may be
+//   used concurrently.
+//
+// Drop counters are atomics rather than pw_metric metrics, which are not safe
+// to increment from several threads.
+class TableRouter {
+ public:
+  constexpr TableRouter(const StatelessPacketParser& parser,
+                        std::span<Egress* const> egresses,
+                        uint32_t first_address = 0)
+      : parser_(parser),
+        egresses_(egresses),
+        first_address_(first_address),
+        parser_errors_(0),
+        route_errors_(0),
+        egress_errors_(0) {}
+
+  TableRouter(const TableRouter&) = delete;
+  TableRouter(TableRouter&&) = delete;
+  TableRouter& operator=(const TableRouter&) = delete;
+  TableRouter& operator=(TableRouter&&) = delete;
+
+  // Routes a single packet through the appropriate egress.
+  // Returns one of the following to indicate a router-side error:
+  //
+  //   OK - Packet sent successfully.
+  //   DATA_LOSS - Packet corrupt or incomplete.
+  //   NOT_FOUND - No registered route for the packet.
+  //   UNAVAILABLE - Route egress did not accept packet.
+  //
+  Status RoutePacket(ConstByteSpan packet);
+
+  uint32_t dropped_packets() const {
+    return parser_errors() + route_errors() + egress_errors();
+  }
+
+  uint32_t parser_errors() const {
+    return parser_errors_.load(std::memory_order_relaxed);
+  }
+
+  uint32_t route_errors() const {
+    return route_errors_.load(std::memory_order_relaxed);
+  }
+
+  uint32_t egress_errors() const {
+    return egress_errors_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Returns the egress for an address, or nullptr if there is none.
+  Egress* FindEgress(uint32_t address) const {
+    // Addresses below first_address wrap around to large offsets.
+    const uint32_t offset = address - first_address_;
+    return offset < egresses_.size() ? egresses_[offset] : nullptr;
+  }
+
+  const StatelessPacketParser& parser_;
+  const std::span<Egress* const> egresses_;
+  const uint32_t first_address_;
+
+  std::atomic<uint32_t> parser_errors_;
+  std::atomic<uint32_t> route_errors_;
+  std::atomic<uint32_t> egress_errors_;
+};
+
+}  // namespace pw::router
@@ -19,6 +19,50 @@
 
 namespace pw::router {
 
+bool StaticRouter::AddressesAreSorted(std::span<const Route> routes) {
+  return std::is_sorted(
+      routes.begin(), routes.end(), [](const Route& lhs, const Route& rhs) {
+        return lhs.address < rhs.address;
+      });
+}
+
+const StaticRouter::Route* StaticRouter::FindRoute(uint32_t address) const {
+  if (!routes_sorted_) {
+    for (const Route& route : routes_) {
+      if (route.address == address) {
+        return &route;
+      }
+    }
+    return nullptr;
+  }
+
+  if (routes_.empty()) {
+    return nullptr;
+  }
+
+  // Branchless lower bound: each step halves the range with a conditional
+  // move, so lookup time does not depend on the address. As with the linear
+  // search, the first of several routes with the same address is used.
+  const Route* base = routes_.data();
+  size_t size = routes_.size();
+  while (size > 1u) {
+    const size_t half = size / 2;
+    base = base[half - 1].address < address ? base + half : base;
+    size -= half;
+  }
+  return base->address == address ? base : nullptr;
+}
+
+const StaticRouter::MulticastRoute* StaticRouter::FindMulticastRoute(
+    uint32_t address) const {
+  for (const MulticastRoute& route : multicast_routes_) {
+    if (route.address == address) {
+      return &route;
+    }
+  }
+  return nullptr;
+}
+
 Status StaticRouter::RoutePacket(ConstByteSpan packet) {
   uint32_t address;
   PacketMetadata metadata = {};
@@ -45,21 +89,31 @@ Status StaticRouter::RoutePacket(ConstByteSpan packet) {
     metadata.priority = parser_.GetPriority();
   }
 
-  auto route = std::find_if(routes_.begin(), routes_.end(), [&](auto r) {
-    return r.address == address;
-  });
-  if (route == routes_.end()) {
+  if (const Route* route = FindRoute(address); route != nullptr) {
+    if (Status status = route->egress.SendPacket(packet, metadata);
+        !status.ok()) {
+      egress_errors_.Increment();
+      return Status::Unavailable();
+    }
+    return OkStatus();
+  }
+
+  const MulticastRoute* multicast = FindMulticastRoute(address);
+  if (multicast == nullptr) {
     route_errors_.Increment();
     return Status::NotFound();
   }
 
-  if (Status status = route->egress.SendPacket(packet, metadata);
-      !status.ok()) {
-    egress_errors_.Increment();
-    return Status::Unavailable();
+  // Every egress shares the caller's buffer. Each failed egress counts as a
+  // dropped packet, but does not stop the packet reaching the others.
+  Status result;
+  for (Egress* egress : multicast->egresses) {
+    if (Status status = egress->SendPacket(packet, metadata); !status.ok()) {
+      egress_errors_.Increment();
+      result = Status::Unavailable();
+    }
   }
-
-  return OkStatus();
+  return result;
 }
 
 }  // namespace pw::router
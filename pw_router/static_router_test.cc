@@ -141,5 +141,106 @@ TEST(StaticRouter, RoutePacket_TracksNumberOfDrops) {
   EXPECT_EQ(router.dropped_packets(), 3u);
 }
 
+TEST(StaticRouter, RoutePacket_FindsEveryRouteInSortedTable) {
+  BasicPacketParser parser;
+  constexpr StaticRouter::Route routes[] = {{2, GoodEgress},
+                                            {3, BadEgress},
+                                            {5, GoodEgress},
+                                            {8, BadEgress},
+                                            {13, GoodEgress}};
+  StaticRouter router(parser, std::span(routes));
+
+  for (uint32_t address = 0; address < 16; ++address) {
+    Status expected = Status::NotFound();
+    for (const StaticRouter::Route& route : routes) {
+      if (route.address == address) {
+        expected = &route.egress == &GoodEgress ? OkStatus()
+                                                : Status::Unavailable();
+      }
+    }
+    EXPECT_EQ(router.RoutePacket(BasicPacket(address, 0xdddd).data()),
+              expected);
+  }
+}
+
+TEST(StaticRouter, RoutePacket_FindsRouteInUnsortedTable) {
+  BasicPacketParser parser;
+  constexpr StaticRouter::Route routes[] = {
+      {7, BadEgress}, {1, GoodEgress}, {4, BadEgress}};
+  StaticRouter router(parser, std::span(routes));
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(1, 0xdddd).data()), OkStatus());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(4, 0xdddd).data()),
+            Status::Unavailable());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(5, 0xdddd).data()),
+            Status::NotFound());
+}
+
+TEST(StaticRouter, RoutePacket_DuplicateAddress_UsesFirstRoute) {
+  BasicPacketParser parser;
+  constexpr StaticRouter::Route routes[] = {
+      {1, BadEgress}, {2, GoodEgress}, {2, BadEgress}, {3, BadEgress}};
+  StaticRouter router(parser, std::span(routes));
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(2, 0xdddd).data()), OkStatus());
+}
+
+TEST(StaticRouter, RoutePacket_MulticastRoute_SendsToEveryEgress) {
+  BasicPacketParser parser;
+  struct {
+    const std::byte* sent[3] = {};
+    size_t sends = 0;
+  } calls;
+  EgressFunction record([&calls](ConstByteSpan packet, const PacketMetadata&) {
+    calls.sent[calls.sends++] = packet.data();
+    return OkStatus();
+  });
+
+  Egress* const group[] = {&record, &record, &record};
+  constexpr StaticRouter::Route routes[] = {{1, BadEgress}};
+  const StaticRouter::MulticastRoute multicast_routes[] = {{9, group}};
+  StaticRouter router(parser, routes, multicast_routes);
+
+  BasicPacket packet(9, 0xdddd);
+  EXPECT_EQ(router.RoutePacket(packet.data()), OkStatus());
+
+  // Each egress received the caller's buffer rather than a copy.
+  ASSERT_EQ(calls.sends, 3u);
+  for (const std::byte* data : calls.sent) {
+    EXPECT_EQ(data, packet.data().data());
+  }
+}
+
+TEST(StaticRouter, RoutePacket_MulticastRoute_EgressError_SendsToOthers) {
+  BasicPacketParser parser;
+  size_t sends = 0;
+  EgressFunction count([&sends](ConstByteSpan, const PacketMetadata&) {
+    sends += 1;
+    return OkStatus();
+  });
+
+  Egress* const group[] = {&count, &BadEgress, &count};
+  const StaticRouter::MulticastRoute multicast_routes[] = {{9, group}};
+  StaticRouter router(parser, {}, multicast_routes);
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(9, 0xdddd).data()),
+            Status::Unavailable());
+  EXPECT_EQ(sends, 2u);
+  EXPECT_EQ(router.dropped_packets(), 1u);
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(8, 0xdddd).data()),
+            Status::NotFound());
+}
+
+TEST(StaticRouter, RoutePacket_RouteAndMulticastRoute_UsesRoute) {
+  BasicPacketParser parser;
+  Egress* const group[] = {&BadEgress};
+  constexpr StaticRouter::Route routes[] = {{9, GoodEgress}};
+  const StaticRouter::MulticastRoute multicast_routes[] = {{9, group}};
+  StaticRouter router(parser, routes, multicast_routes);
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(9, 0xdddd).data()), OkStatus());
+}
+
 }  // namespace
 }  // namespace pw::router
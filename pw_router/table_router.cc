@@ -0,0 +1,43 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_router/table_router.h"
+
+#include <optional>
+
+namespace pw::router {
+
+Status TableRouter::RoutePacket(ConstByteSpan packet) {
+  const std::optional<ParsedPacket> parsed = parser_.Parse(packet);
+  if (!parsed.has_value()) {
+    parser_errors_.fetch_add(1, std::memory_order_relaxed);
+    return Status::DataLoss();
+  }
+
+  Egress* egress = FindEgress(parsed->destination_address);
+  if (egress == nullptr) {
+    route_errors_.fetch_add(1, std::memory_order_relaxed);
+    return Status::NotFound();
+  }
+
+  const PacketMetadata metadata = {.priority = parsed->priority};
+  if (!egress->SendPacket(packet, metadata).ok()) {
+    egress_errors_.fetch_add(1, std::memory_order_relaxed);
+    return Status::Unavailable();
+  }
+
+  return OkStatus();
+}
+
+}  // namespace pw::router
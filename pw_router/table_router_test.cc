@@ -0,0 +1,147 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_router/table_router.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_router/egress_function.h"
+
+namespace pw::router {
+namespace {
+
+struct BasicPacket {
+  static constexpr uint32_t kMagic = 0x8badf00d;
+
+  constexpr BasicPacket(uint32_t addr, uint64_t data)
+      : magic(kMagic), address(addr), priority(0), payload(data) {}
+
+  constexpr BasicPacket(uint32_t addr, uint32_t prio, uint64_t data)
+      : magic(kMagic), address(addr), priority(prio), payload(data) {}
+
+  ConstByteSpan data() const { return std::as_bytes(std::span(this, 1)); }
+
+  uint32_t magic;
+  uint32_t address;
+  uint32_t priority;
+  uint64_t payload;
+};
+
+class BasicPacketParser : public StatelessPacketParser {
+ public:
+  std::optional<ParsedPacket> Parse(ConstByteSpan packet) const final {
+    BasicPacket parsed(0, 0);
+    if (packet.size() < sizeof(parsed)) {
+      return std::nullopt;
+    }
+    std::memcpy(&parsed, packet.data(), sizeof(parsed));
+    if (parsed.magic != BasicPacket::kMagic) {
+      return std::nullopt;
+    }
+    return ParsedPacket{parsed.address, parsed.priority};
+  }
+};
+
+EgressFunction GoodEgress(+[](ConstByteSpan, const PacketMetadata&) {
+  return OkStatus();
+});
+EgressFunction BadEgress(+[](ConstByteSpan, const PacketMetadata&) {
+  return Status::ResourceExhausted();
+});
+
+const BasicPacketParser kParser;
+
+TEST(TableRouter, RoutePacket_RoutesToAnEgress) {
+  Egress* const egresses[] = {&GoodEgress, &BadEgress};
+  TableRouter router(kParser, egresses);
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(0, 0xdddd).data()), OkStatus());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(1, 0xdddd).data()),
+            Status::Unavailable());
+}
+
+TEST(TableRouter, RoutePacket_ForwardsPacketMetadata) {
+  PacketMetadata metadata = {};
+  EgressFunction metadata_egress(
+      [&metadata](ConstByteSpan, const PacketMetadata& md) {
+        metadata = md;
+        return OkStatus();
+      });
+
+  Egress* const egresses[] = {&metadata_egress};
+  TableRouter router(kParser, egresses);
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(0, 71, 0xdddd).data()), OkStatus());
+  ASSERT_TRUE(metadata.priority.has_value());
+  EXPECT_EQ(metadata.priority.value(), 71u);
+}
+
+TEST(TableRouter, RoutePacket_ReturnsParserError) {
+  Egress* const egresses[] = {&GoodEgress};
+  TableRouter router(kParser, egresses);
+
+  BasicPacket bad_magic(0, 0xdddd);
+  bad_magic.magic = 0x1badda7a;
+  EXPECT_EQ(router.RoutePacket(bad_magic.data()), Status::DataLoss());
+  EXPECT_EQ(router.RoutePacket(bad_magic.data().first(4)), Status::DataLoss());
+  EXPECT_EQ(router.parser_errors(), 2u);
+}
+
+TEST(TableRouter, RoutePacket_ReturnsNotFoundOutsideTable) {
+  Egress* const egresses[] = {&GoodEgress, &GoodEgress};
+  TableRouter router(kParser, egresses, 10);
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(9, 0xdddd).data()),
+            Status::NotFound());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(10, 0xdddd).data()), OkStatus());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(11, 0xdddd).data()), OkStatus());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(12, 0xdddd).data()),
+            Status::NotFound());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(0, 0xdddd).data()),
+            Status::NotFound());
+}
+
+TEST(TableRouter, RoutePacket_ReturnsNotFoundForEmptyEntry) {
+  Egress* const egresses[] = {&GoodEgress, nullptr, &GoodEgress};
+  TableRouter router(kParser, egresses);
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(1, 0xdddd).data()),
+            Status::NotFound());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(2, 0xdddd).data()), OkStatus());
+}
+
+TEST(TableRouter, RoutePacket_TracksNumberOfDrops) {
+  Egress* const egresses[] = {&GoodEgress, &BadEgress};
+  TableRouter router(kParser, egresses);
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(0, 0xdddd).data()), OkStatus());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(1, 0xdddd).data()),
+            Status::Unavailable());
+
+  BasicPacket bad_magic(0, 0xdddd);
+  bad_magic.magic = 0x1badda7a;
+  EXPECT_EQ(router.RoutePacket(bad_magic.data()), Status::DataLoss());
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(42, 0xdddd).data()),
+            Status::NotFound());
+
+  EXPECT_EQ(router.parser_errors(), 1u);
+  EXPECT_EQ(router.route_errors(), 1u);
+  EXPECT_EQ(router.egress_errors(), 1u);
+  EXPECT_EQ(router.dropped_packets(), 3u);
+}
+
+}  // namespace
+}  // namespace pw::router
@@ -14,7 +14,11 @@
 
 #include "pw_rpc/internal/base_client_call.h"
 
+#include <array>
+
+#include "pw_protobuf/wire_format.h"
 #include "pw_rpc/client.h"
+#include "pw_varint/varint.h"
 
 namespace pw::rpc::internal {
 
@@ -24,20 +28,20 @@ BaseClientCall& BaseClientCall::operator=(BaseClientCall&& other) {
   Unregister();
 
   active_ = other.active_;
-
-  if (other.active()) {
-    // If the call being assigned is active, replace it in the client's list
-    // with a reference to the current object.
-    other.Unregister();
-    other.channel_->client()->RegisterCall(*this);
-  }
-
   channel_ = other.channel_;
   service_id_ = other.service_id_;
   method_id_ = other.method_id_;
   request_ = std::move(other.request_);
   handler_ = other.handler_;
 
+  if (other.active()) {
+    // If the call being assigned is active, replace it in the client with a
+    // reference to the current object. The IDs are copied first, since the
+    // client indexes calls by them.
+    other.Unregister();
+    Register();
+  }
+
   return *this;
 }
 
@@ -47,6 +51,23 @@ void BaseClientCall::Cancel() {
   }
 }
 
+Status BaseClientCall::GrantCredits(uint32_t credits) {
+  if (!active()) {
+    return Status::FailedPrecondition();
+  }
+
+  // Encode the FlowControl message payload: a one-byte key and a varint.
+  std::array<std::byte, 1 + varint::kMaxVarint32SizeBytes> payload;
+  payload[0] = static_cast<std::byte>(protobuf::MakeKey(
+      static_cast<uint32_t>(FlowControl::Fields::CREDITS),
+      protobuf::WireType::kVarint));
+  const size_t size =
+      1 + varint::Encode(credits, std::span(payload).subspan(1));
+
+  return channel_->Send(NewPacket(PacketType::CLIENT_FLOW_CONTROL,
+                                 std::span(payload).first(size)));
+}
+
 std::span<std::byte> BaseClientCall::AcquirePayloadBuffer() {
   if (!active()) {
     return {};
@@ -58,11 +79,21 @@ std::span<std::byte> BaseClientCall::AcquirePayloadBuffer() {
 
 Status BaseClientCall::ReleasePayloadBuffer(
     std::span<const std::byte> payload) {
+  return SendPayload(PacketType::REQUEST, payload);
+}
+
+Status BaseClientCall::ReleaseClientStreamBuffer(
+    std::span<const std::byte> payload) {
+  return SendPayload(PacketType::CLIENT_STREAM, payload);
+}
+
+Status BaseClientCall::SendPayload(PacketType type,
+                                   std::span<const std::byte> payload) {
   if (!active()) {
     return Status::FailedPrecondition();
   }
 
-  return channel_->Send(request_, NewPacket(PacketType::REQUEST, payload));
+  return channel_->Send(request_, NewPacket(type, payload));
 }
 
 Packet BaseClientCall::NewPacket(PacketType type,
@@ -70,7 +101,12 @@ Packet BaseClientCall::NewPacket(PacketType type,
   return Packet(type, channel_->id(), service_id_, method_id_, payload);
 }
 
-void BaseClientCall::Register() { channel_->client()->RegisterCall(*this); }
+void BaseClientCall::Register() {
+  // A call that could not be registered is never removed from the client.
+  if (!channel_->client()->RegisterCall(*this).ok()) {
+    active_ = false;
+  }
+}
 
 void BaseClientCall::Unregister() {
   if (active()) {
@@ -68,6 +68,12 @@ class FakeClientCall : public BaseClientCall {
     std::memcpy(buffer.data(), payload.data(), payload.size());
     return ReleasePayloadBuffer(buffer.first(payload.size()));
   }
+
+  Status SendClientStream(std::span<const std::byte> payload) {
+    std::span buffer = AcquirePayloadBuffer();
+    std::memcpy(buffer.data(), payload.data(), payload.size());
+    return ReleaseClientStreamBuffer(buffer.first(payload.size()));
+  }
 };
 
 TEST(BaseClientCall, SendsPacketWithPayload) {
@@ -88,5 +94,49 @@ TEST(BaseClientCall, SendsPacketWithPayload) {
   EXPECT_EQ(std::memcmp(packet.payload().data(), payload, sizeof(payload)), 0);
 }
 
+TEST(BaseClientCall, SendsClientStreamPacket) {
+  ClientContextForTest context;
+  FakeClientCall call(&context.channel(),
+                      context.service_id(),
+                      context.method_id(),
+                      [](BaseClientCall&, const Packet&) {});
+
+  constexpr std::byte payload[]{std::byte{0x08}, std::byte{0x39}};
+  ASSERT_EQ(OkStatus(), call.SendPacket({}));
+  ASSERT_EQ(OkStatus(), call.SendClientStream(payload));
+
+  EXPECT_EQ(context.output().packet_count(), 2u);
+  Packet packet = context.output().sent_packet();
+  EXPECT_EQ(packet.type(), PacketType::CLIENT_STREAM);
+  EXPECT_EQ(packet.method_id(), context.method_id());
+  EXPECT_EQ(std::memcmp(packet.payload().data(), payload, sizeof(payload)), 0);
+}
+
+TEST(BaseClientCall, GrantCredits_SendsFlowControlPacket) {
+  ClientContextForTest context;
+  BaseClientCall call(&context.channel(),
+                      context.service_id(),
+                      context.method_id(),
+                      [](BaseClientCall&, const Packet&) {});
+
+  ASSERT_EQ(OkStatus(), call.GrantCredits(300));
+
+  EXPECT_EQ(context.output().packet_count(), 1u);
+  Packet packet = context.output().sent_packet();
+  EXPECT_EQ(packet.type(), PacketType::CLIENT_FLOW_CONTROL);
+  EXPECT_EQ(packet.method_id(), context.method_id());
+
+  constexpr std::byte kExpected[]{
+      std::byte{0x08}, std::byte{0xac}, std::byte{0x02}};
+  ASSERT_EQ(packet.payload().size(), sizeof(kExpected));
+  EXPECT_EQ(
+      std::memcmp(packet.payload().data(), kExpected, sizeof(kExpected)), 0);
+}
+
+TEST(BaseClientCall, GrantCredits_Inactive_FailsPrecondition) {
+  BaseClientCall call;
+  EXPECT_EQ(Status::FailedPrecondition(), call.GrantCredits(1));
+}
+
 }  // namespace
 }  // namespace pw::rpc::internal
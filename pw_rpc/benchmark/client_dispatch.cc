@@ -0,0 +1,139 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures how long a Client takes to route a response to its call as the
+// number of outstanding calls grows. Every call is on the same channel and
+// service but a different method, so the calls can only be told apart by the
+// lookup. Build with PW_RPC_CLIENT_CALL_INDEX_SIZE set to compare the call
+// index with searching the list of calls.
+
+#include <array>
+#include <cstddef>
+
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_rpc/client.h"
+#include "pw_rpc/internal/base_client_call.h"
+#include "pw_rpc/internal/packet.h"
+
+namespace {
+
+using pw::rpc::internal::BaseClientCall;
+using pw::rpc::internal::Packet;
+using pw::rpc::internal::PacketType;
+
+constexpr uint32_t kChannelId = 1;
+constexpr uint32_t kServiceId = 16;
+
+constexpr size_t kMaxCalls = 1024;
+constexpr size_t kResponses = 100000;
+
+class DiscardingOutput : public pw::rpc::ChannelOutput {
+ public:
+  DiscardingOutput() : ChannelOutput("discard") {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  pw::Status SendAndReleaseBuffer(std::span<const std::byte>) override {
+    return pw::OkStatus();
+  }
+
+ private:
+  std::byte buffer_[128];
+};
+
+class BenchmarkCall : public BaseClientCall {
+ public:
+  BenchmarkCall() = default;
+
+  BenchmarkCall(pw::rpc::Channel* channel, uint32_t method_id)
+      : BaseClientCall(channel, kServiceId, method_id, HandleResponse) {}
+
+  size_t responses() const { return responses_; }
+
+ private:
+  static void HandleResponse(BaseClientCall& call, const Packet&) {
+    static_cast<BenchmarkCall&>(call).responses_ += 1;
+  }
+
+  size_t responses_ = 0;
+};
+
+DiscardingOutput output;
+pw::rpc::Channel channels[] = {pw::rpc::Channel::Create<kChannelId>(&output)};
+pw::rpc::Client client(channels);
+
+std::array<BenchmarkCall, kMaxCalls> calls;
+
+std::array<std::array<std::byte, 32>, kMaxCalls> packet_buffers;
+std::array<pw::ConstByteSpan, kMaxCalls> packets;
+
+constexpr uint32_t MethodId(size_t index) {
+  return static_cast<uint32_t>(index + 1);
+}
+
+void EncodePackets() {
+  for (size_t i = 0; i < kMaxCalls; ++i) {
+    auto result =
+        Packet(PacketType::RESPONSE, kChannelId, kServiceId, MethodId(i))
+            .Encode(packet_buffers[i]);
+    PW_CHECK_OK(result.status());
+    packets[i] = result.value();
+  }
+}
+
+// Starts the calls, sends kResponses responses spread across them, then ends
+// the calls. Returns the total time spent in ProcessPacket.
+pw::chrono::SystemClock::duration Dispatch(size_t call_count) {
+  for (size_t i = 0; i < call_count; ++i) {
+    calls[i] = BenchmarkCall(&channels[0], MethodId(i));
+  }
+  PW_CHECK_UINT_EQ(client.active_calls(), call_count);
+
+  const auto start = pw::chrono::SystemClock::now();
+  for (size_t i = 0; i < kResponses; ++i) {
+    const pw::ConstByteSpan packet = packets[i % call_count];
+    PW_CHECK_OK(client.ProcessPacket(packet));
+  }
+  const auto elapsed = pw::chrono::SystemClock::now() - start;
+
+  for (size_t i = 0; i < call_count; ++i) {
+    const size_t expected =
+        kResponses / call_count + (i < kResponses % call_count ? 1 : 0);
+    PW_CHECK_UINT_EQ(calls[i].responses(), expected);
+    calls[i] = BenchmarkCall();
+  }
+  PW_CHECK_UINT_EQ(client.active_calls(), 0u);
+
+  return elapsed;
+}
+
+}  // namespace
+
+int main() {
+  EncodePackets();
+
+  PW_LOG_INFO("Dispatching %u responses with a %u-entry call index",
+              static_cast<unsigned>(kResponses),
+              static_cast<unsigned>(pw::rpc::cfg::kClientCallIndexSize));
+
+  for (size_t call_count = 1; call_count <= kMaxCalls; call_count *= 4) {
+    const auto elapsed = Dispatch(call_count);
+    PW_LOG_INFO("%4u outstanding calls: %ld ticks",
+                static_cast<unsigned>(call_count),
+                static_cast<long>(elapsed.count()));
+  }
+  return 0;
+}
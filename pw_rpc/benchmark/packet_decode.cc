@@ -0,0 +1,102 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Compares the time to decode packets with Packet::FromBuffer, which reads
+// packets in the layout written by Encode() and EncodeInPlace() directly, and
+// with the generic protobuf decoder.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_rpc/internal/packet.h"
+
+namespace {
+
+using pw::rpc::internal::Packet;
+using pw::rpc::internal::PacketType;
+
+constexpr size_t kDecodes = 1000000;
+
+using DecodeFunction = pw::Result<Packet> (*)(pw::ConstByteSpan);
+
+// Decodes the packet kDecodes times. Returns the total time spent decoding.
+pw::chrono::SystemClock::duration Decode(DecodeFunction decode,
+                                         pw::ConstByteSpan packet) {
+  uint32_t checksum = 0;
+
+  const auto start = pw::chrono::SystemClock::now();
+  for (size_t i = 0; i < kDecodes; ++i) {
+    pw::Result<Packet> result = decode(packet);
+    checksum += result.value().method_id();
+  }
+  const auto elapsed = pw::chrono::SystemClock::now() - start;
+
+  // Use the result so the loop is not optimized out.
+  PW_CHECK_UINT_EQ(checksum, static_cast<uint32_t>(kDecodes) * 0x03a82921u);
+  return elapsed;
+}
+
+void Compare(const char* name, pw::ConstByteSpan packet) {
+  const auto fast = Decode(Packet::FromBuffer, packet);
+  const auto generic = Decode(Packet::FromBufferGeneric, packet);
+  PW_LOG_INFO("%s (%u B): FromBuffer %ld ticks, generic decoder %ld ticks",
+              name,
+              static_cast<unsigned>(packet.size()),
+              static_cast<long>(fast.count()),
+              static_cast<long>(generic.count()));
+}
+
+}  // namespace
+
+int main() {
+  PW_LOG_INFO("Decoding each packet %u times",
+              static_cast<unsigned>(kDecodes));
+
+  std::array<std::byte, 256> buffer{};
+  Packet packet(PacketType::REQUEST, 1, 0xdeadbeef, 0x03a82921);
+
+  // A packet written by Encode(), with the payload first.
+  packet.set_payload(std::span(buffer).last(32));
+  auto encoded = packet.Encode(std::span(buffer).first(128));
+  PW_CHECK_OK(encoded.status());
+  Compare("Encode()", encoded.value());
+
+  // A packet written by EncodeInPlace(), with the payload last.
+  std::array<std::byte, 256> in_place_buffer{};
+  packet.set_payload(std::span(in_place_buffer)
+                         .subspan(packet.PayloadOffset(in_place_buffer.size()))
+                         .first(32));
+  auto in_place = packet.EncodeInPlace(in_place_buffer);
+  PW_CHECK_OK(in_place.status());
+  Compare("EncodeInPlace()", in_place.value());
+
+  // A packet with the payload after the type, which is not a fixed layout, so
+  // FromBuffer falls back to the generic decoder.
+  constexpr size_t kPayloadFieldSize = 2 + 32;  // key, length, and payload
+  constexpr size_t kTypeFieldSize = 2;
+  const pw::ConstByteSpan payload_field =
+      encoded.value().first(kPayloadFieldSize);
+  const pw::ConstByteSpan header = encoded.value().subspan(kPayloadFieldSize);
+
+  std::array<std::byte, 128> reordered{};
+  auto end = std::copy_n(header.begin(), kTypeFieldSize, reordered.begin());
+  end = std::copy(payload_field.begin(), payload_field.end(), end);
+  end = std::copy(header.begin() + kTypeFieldSize, header.end(), end);
+  Compare("Reordered", std::span(reordered.begin(), end));
+  return 0;
+}
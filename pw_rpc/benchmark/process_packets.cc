@@ -0,0 +1,122 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Compares processing a burst of request packets one at a time with
+// Server::ProcessPackets. Each request in the burst targets the same channel
+// and method, which is the case ProcessPackets optimizes for.
+
+#include <array>
+#include <cstddef>
+
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_rpc/internal/raw_method_union.h"
+#include "pw_rpc/server.h"
+#include "pw_rpc/server_context.h"
+#include "pw_rpc/service.h"
+
+namespace {
+
+using pw::rpc::internal::Packet;
+using pw::rpc::internal::PacketType;
+
+constexpr uint32_t kChannelId = 1;
+constexpr uint32_t kServiceId = 16;
+constexpr uint32_t kMethodId = 100;
+
+constexpr size_t kPacketsPerBurst = 32;
+constexpr size_t kBursts = 1000;
+
+class DiscardingOutput : public pw::rpc::ChannelOutput {
+ public:
+  DiscardingOutput() : ChannelOutput("discard") {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  pw::Status SendAndReleaseBuffer(std::span<const std::byte>) override {
+    return pw::OkStatus();
+  }
+
+ private:
+  std::byte buffer_[128];
+};
+
+class BenchmarkService final : public pw::rpc::Service {
+ public:
+  BenchmarkService() : Service(kServiceId, kMethods) {}
+
+  static pw::StatusWithSize Unary(pw::rpc::ServerContext&,
+                                  pw::ConstByteSpan request,
+                                  pw::ByteSpan) {
+    return pw::StatusWithSize(request.size());
+  }
+
+ private:
+  static constexpr std::array<pw::rpc::internal::RawMethodUnion, 1> kMethods = {
+      pw::rpc::internal::RawMethod::Unary<Unary>(kMethodId),
+  };
+};
+
+DiscardingOutput output;
+pw::rpc::Channel channels[] = {pw::rpc::Channel::Create<kChannelId>(&output)};
+pw::rpc::Server server(channels);
+BenchmarkService service;
+
+std::array<std::array<std::byte, 32>, kPacketsPerBurst> packet_buffers;
+std::array<pw::ConstByteSpan, kPacketsPerBurst> packets;
+
+void EncodePackets() {
+  constexpr std::byte kPayload[] = {std::byte{0x08}, std::byte{0x01}};
+
+  for (size_t i = 0; i < kPacketsPerBurst; ++i) {
+    auto result =
+        Packet(PacketType::REQUEST, kChannelId, kServiceId, kMethodId, kPayload)
+            .Encode(packet_buffers[i]);
+    PW_CHECK_OK(result.status());
+    packets[i] = result.value();
+  }
+}
+
+}  // namespace
+
+int main() {
+  server.RegisterService(service);
+  EncodePackets();
+
+  const auto individual_start = pw::chrono::SystemClock::now();
+  for (size_t burst = 0; burst < kBursts; ++burst) {
+    for (pw::ConstByteSpan packet : packets) {
+      PW_CHECK_OK(server.ProcessPacket(packet, output));
+    }
+  }
+  const auto individual = pw::chrono::SystemClock::now() - individual_start;
+
+  const auto batched_start = pw::chrono::SystemClock::now();
+  for (size_t burst = 0; burst < kBursts; ++burst) {
+    const pw::StatusWithSize result = server.ProcessPackets(packets, output);
+    PW_CHECK_OK(result.status());
+    PW_CHECK_UINT_EQ(result.size(), kPacketsPerBurst);
+  }
+  const auto batched = pw::chrono::SystemClock::now() - batched_start;
+
+  PW_LOG_INFO("Processed %u bursts of %u packets",
+              static_cast<unsigned>(kBursts),
+              static_cast<unsigned>(kPacketsPerBurst));
+  PW_LOG_INFO("ProcessPacket:  %ld ticks",
+              static_cast<long>(individual.count()));
+  PW_LOG_INFO("ProcessPackets: %ld ticks", static_cast<long>(batched.count()));
+  return 0;
+}
@@ -0,0 +1,112 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Decodes request packets and dispatches them to a raw unary method, which is
+// the path every request to an RPC server takes.
+
+#include <array>
+#include <cstddef>
+
+#include "gtest/gtest.h"
+#include "pw_benchmark/benchmark.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_rpc/internal/raw_method_union.h"
+#include "pw_rpc/server.h"
+#include "pw_rpc/server_context.h"
+#include "pw_rpc/service.h"
+
+namespace pw::rpc {
+namespace {
+
+using benchmark::DoNotOptimize;
+using internal::Packet;
+using internal::PacketType;
+
+constexpr uint32_t kChannelId = 1;
+constexpr uint32_t kServiceId = 16;
+constexpr uint32_t kMethodId = 100;
+
+class DiscardingOutput : public ChannelOutput {
+ public:
+  DiscardingOutput() : ChannelOutput("discard") {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte>) override {
+    return OkStatus();
+  }
+
+ private:
+  std::byte buffer_[128];
+};
+
+class BenchmarkService final : public Service {
+ public:
+  BenchmarkService() : Service(kServiceId, kMethods) {}
+
+  static StatusWithSize Unary(ServerContext&, ConstByteSpan request, ByteSpan) {
+    return StatusWithSize(request.size());
+  }
+
+ private:
+  static constexpr std::array<internal::RawMethodUnion, 1> kMethods = {
+      internal::RawMethod::Unary<Unary>(kMethodId),
+  };
+};
+
+constexpr std::byte kPayload[] = {std::byte{0x08}, std::byte{0x01}};
+
+std::array<std::byte, 32> packet_buffer;
+
+Result<ConstByteSpan> EncodeRequest() {
+  const Packet packet(
+      PacketType::REQUEST, kChannelId, kServiceId, kMethodId, kPayload);
+  return packet.Encode(packet_buffer);
+}
+
+PW_BENCHMARK(Rpc, PacketEncode) {
+  for (auto _ : state) {
+    DoNotOptimize(EncodeRequest());
+  }
+}
+
+PW_BENCHMARK(Rpc, PacketDecode) {
+  const Result<ConstByteSpan> packet = EncodeRequest();
+  ASSERT_EQ(OkStatus(), packet.status());
+
+  for (auto _ : state) {
+    DoNotOptimize(packet_buffer);
+    DoNotOptimize(Packet::FromBuffer(packet.value()));
+  }
+}
+
+PW_BENCHMARK(Rpc, ProcessPacket_UnaryRequest) {
+  DiscardingOutput output;
+  Channel channels[] = {Channel::Create<kChannelId>(&output)};
+  Server server(channels);
+  BenchmarkService service;
+  server.RegisterService(service);
+
+  const Result<ConstByteSpan> packet = EncodeRequest();
+  ASSERT_EQ(OkStatus(), packet.status());
+
+  Status status;
+  for (auto _ : state) {
+    status.Update(server.ProcessPacket(packet.value(), output));
+  }
+  EXPECT_EQ(OkStatus(), status);
+}
+
+}  // namespace
+}  // namespace pw::rpc
@@ -0,0 +1,210 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/buffer_pool_channel_output.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "pw_assert/assert.h"
+
+namespace pw::rpc::internal {
+
+BaseBufferPoolChannelOutput::BaseBufferPoolChannelOutput(
+    const char* name,
+    ByteSpan pool,
+    std::span<const BufferPoolClass> classes,
+    std::span<uint16_t> free_buffers,
+    std::span<uint16_t> free_counts,
+    std::span<uint16_t> queued_buffers,
+    std::span<uint16_t> packet_sizes)
+    : ChannelOutput(name),
+      pool_(pool),
+      classes_(classes),
+      free_buffers_(free_buffers),
+      free_counts_(free_counts),
+      queued_buffers_(queued_buffers),
+      queue_head_(0),
+      queue_count_(0),
+      packet_sizes_(packet_sizes) {
+  PW_ASSERT(!classes.empty());
+  PW_ASSERT(classes.size() == free_counts.size());
+  PW_ASSERT(free_buffers.size() == queued_buffers.size());
+  PW_ASSERT(free_buffers.size() == packet_sizes.size());
+
+  const BufferPoolClass& last = classes.back();
+  PW_ASSERT(size_t{last.first_index} + last.count == free_buffers.size());
+  PW_ASSERT(last.pool_offset + size_t{last.count} * last.size_bytes ==
+            pool.size());
+
+  // Hand out the buffers of each class in order, starting with the first.
+  for (size_t c = 0; c < classes.size(); ++c) {
+    const BufferPoolClass& buffers = classes[c];
+    for (uint16_t i = 0; i < buffers.count; ++i) {
+      free_buffers[buffers.first_index + i] =
+          static_cast<uint16_t>(buffers.first_index + buffers.count - 1 - i);
+    }
+    free_counts[c] = buffers.count;
+  }
+}
+
+std::span<std::byte> BaseBufferPoolChannelOutput::AcquireBuffer() {
+  const uint16_t index = Take(classes_.size() - 1, classes_.size());
+  return index == kNoBuffer ? std::span<std::byte>() : buffer(index);
+}
+
+std::span<std::byte> BaseBufferPoolChannelOutput::AcquireBufferForSize(
+    size_t size_hint) {
+  // A packet larger than every buffer gets one of the largest, and fails to
+  // encode there as it would with AcquireBuffer().
+  const size_t first_class = std::min(ClassFor(size_hint), classes_.size() - 1);
+  const uint16_t index = Take(first_class, classes_.size());
+  return index == kNoBuffer ? std::span<std::byte>() : buffer(index);
+}
+
+Status BaseBufferPoolChannelOutput::SendAndReleaseBuffer(
+    std::span<const std::byte> buffer) {
+  // A buffer from an exhausted pool is empty and has nothing to release.
+  if (buffer.data() == nullptr) {
+    return OkStatus();
+  }
+
+  PW_ASSERT(buffer.data() >= pool_.data() &&
+            buffer.data() < pool_.data() + pool_.size());
+  uint16_t index = BufferIndex(buffer.data());
+
+  if (buffer.empty()) {
+    Release(index);
+    return OkStatus();
+  }
+
+  // Packets are encoded at the start of their buffers.
+  PW_ASSERT(buffer.data() == this->buffer(index).data());
+
+  // Move the packet into a smaller buffer if one fits, so the larger buffer is
+  // free for packets that need it while this one waits to be transmitted.
+  const size_t packet_class = ClassOf(index);
+  const size_t smallest_class = ClassFor(buffer.size());
+  if (smallest_class < packet_class) {
+    const uint16_t smaller = Take(smallest_class, packet_class);
+    if (smaller != kNoBuffer) {
+      std::memcpy(this->buffer(smaller).data(), buffer.data(), buffer.size());
+      Release(index);
+      index = smaller;
+    }
+  }
+
+  packet_sizes_[index] = static_cast<uint16_t>(buffer.size());
+
+  {
+    std::lock_guard lock(lock_);
+    queued_buffers_[(queue_head_ + queue_count_) % queued_buffers_.size()] =
+        index;
+    queue_count_ += 1;
+  }
+
+  PacketQueued();
+  return OkStatus();
+}
+
+Status BaseBufferPoolChannelOutput::TransmitQueuedPackets() {
+  Status status;
+
+  while (true) {
+    uint16_t index;
+    {
+      std::lock_guard lock(lock_);
+      if (queue_count_ == 0u) {
+        break;
+      }
+      index = queued_buffers_[queue_head_];
+      queue_head_ = (queue_head_ + 1) % queued_buffers_.size();
+      queue_count_ -= 1;
+    }
+
+    // The buffer is not in the queue or the free list, so the lock is not held
+    // while the packet is transmitted.
+    Status result = Transmit(buffer(index).first(packet_sizes_[index]));
+    if (status.ok()) {
+      status = result;
+    }
+
+    Release(index);
+  }
+
+  return status;
+}
+
+size_t BaseBufferPoolChannelOutput::queued_packets() const {
+  std::lock_guard lock(lock_);
+  return queue_count_;
+}
+
+size_t BaseBufferPoolChannelOutput::ClassFor(size_t size) const {
+  size_t c = 0;
+  while (c < classes_.size() && classes_[c].size_bytes < size) {
+    c += 1;
+  }
+  return c;
+}
+
+size_t BaseBufferPoolChannelOutput::ClassOf(uint16_t index) const {
+  size_t c = 0;
+  while (index >= classes_[c].first_index + classes_[c].count) {
+    c += 1;
+  }
+  return c;
+}
+
+uint16_t BaseBufferPoolChannelOutput::BufferIndex(const std::byte* data) const {
+  const size_t offset = static_cast<size_t>(data - pool_.data());
+  size_t c = 0;
+  while (offset >= classes_[c].pool_offset +
+                       size_t{classes_[c].count} * classes_[c].size_bytes) {
+    c += 1;
+  }
+  return static_cast<uint16_t>(
+      classes_[c].first_index +
+      (offset - classes_[c].pool_offset) / classes_[c].size_bytes);
+}
+
+ByteSpan BaseBufferPoolChannelOutput::buffer(uint16_t index) const {
+  const BufferPoolClass& buffers = classes_[ClassOf(index)];
+  return pool_.subspan(
+      buffers.pool_offset +
+          size_t{buffers.size_bytes} * (index - buffers.first_index),
+      buffers.size_bytes);
+}
+
+uint16_t BaseBufferPoolChannelOutput::Take(size_t first_class,
+                                           size_t end_class) {
+  std::lock_guard lock(lock_);
+  for (size_t c = first_class; c < end_class; ++c) {
+    if (free_counts_[c] != 0u) {
+      free_counts_[c] -= 1;
+      return free_buffers_[classes_[c].first_index + free_counts_[c]];
+    }
+  }
+  return kNoBuffer;
+}
+
+void BaseBufferPoolChannelOutput::Release(uint16_t index) {
+  const size_t c = ClassOf(index);
+  std::lock_guard lock(lock_);
+  free_buffers_[classes_[c].first_index + free_counts_[c]] = index;
+  free_counts_[c] += 1;
+}
+
+}  // namespace pw::rpc::internal
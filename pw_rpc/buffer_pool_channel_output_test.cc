@@ -0,0 +1,303 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/buffer_pool_channel_output.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_rpc/internal/channel.h"
+#include "pw_rpc/internal/packet.h"
+
+namespace pw::rpc {
+namespace {
+
+using internal::Packet;
+using internal::PacketType;
+
+// Records the first byte of each transmitted packet.
+class TestPoolOutput : public BufferPoolChannelOutput<3, 32> {
+ public:
+  TestPoolOutput() : BufferPoolChannelOutput("TestPoolOutput") {}
+
+  const std::array<std::byte, 8>& first_bytes() const { return first_bytes_; }
+  size_t transmitted() const { return transmitted_; }
+  size_t queued_signals() const { return queued_signals_; }
+
+  void set_transmit_status(Status status) { transmit_status_ = status; }
+
+ private:
+  Status Transmit(std::span<const std::byte> packet) override {
+    EXPECT_FALSE(packet.empty());
+    first_bytes_[transmitted_++] = packet[0];
+    return transmit_status_;
+  }
+
+  void PacketQueued() override { queued_signals_ += 1; }
+
+  std::array<std::byte, 8> first_bytes_ = {};
+  size_t transmitted_ = 0;
+  size_t queued_signals_ = 0;
+  Status transmit_status_;
+};
+
+Status Finish(ChannelOutput& output, std::span<std::byte> buffer, int value) {
+  buffer[0] = static_cast<std::byte>(value);
+  return output.SendAndReleaseBuffer(buffer.first(1));
+}
+
+TEST(BufferPoolChannelOutput, AcquireBuffer_ReturnsDistinctBuffers) {
+  TestPoolOutput output;
+
+  std::span<std::byte> a = output.AcquireBuffer();
+  std::span<std::byte> b = output.AcquireBuffer();
+  std::span<std::byte> c = output.AcquireBuffer();
+
+  EXPECT_EQ(a.size(), 32u);
+  EXPECT_EQ(b.size(), 32u);
+  EXPECT_EQ(c.size(), 32u);
+  EXPECT_NE(a.data(), b.data());
+  EXPECT_NE(b.data(), c.data());
+  EXPECT_NE(a.data(), c.data());
+
+  output.DiscardBuffer(a);
+  output.DiscardBuffer(b);
+  output.DiscardBuffer(c);
+}
+
+TEST(BufferPoolChannelOutput, AcquireBuffer_Exhausted_ReturnsEmpty) {
+  TestPoolOutput output;
+
+  std::span<std::byte> a = output.AcquireBuffer();
+  std::span<std::byte> b = output.AcquireBuffer();
+  std::span<std::byte> c = output.AcquireBuffer();
+  EXPECT_TRUE(output.AcquireBuffer().empty());
+
+  // Releasing the empty buffer does nothing.
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer({}));
+
+  output.DiscardBuffer(b);
+  EXPECT_EQ(output.AcquireBuffer().data(), b.data());
+
+  output.DiscardBuffer(a);
+  output.DiscardBuffer(b);
+  output.DiscardBuffer(c);
+}
+
+TEST(BufferPoolChannelOutput, DiscardBuffer_IsNotQueued) {
+  TestPoolOutput output;
+
+  output.DiscardBuffer(output.AcquireBuffer());
+  EXPECT_EQ(output.queued_packets(), 0u);
+  EXPECT_EQ(output.queued_signals(), 0u);
+  EXPECT_EQ(OkStatus(), output.TransmitQueuedPackets());
+  EXPECT_EQ(output.transmitted(), 0u);
+}
+
+TEST(BufferPoolChannelOutput, TransmitsInOrderOfCompletion) {
+  TestPoolOutput output;
+
+  // Three producers acquire buffers, then finish out of order.
+  std::span<std::byte> a = output.AcquireBuffer();
+  std::span<std::byte> b = output.AcquireBuffer();
+  std::span<std::byte> c = output.AcquireBuffer();
+
+  EXPECT_EQ(OkStatus(), Finish(output, b, 1));
+  EXPECT_EQ(OkStatus(), Finish(output, c, 2));
+  EXPECT_EQ(OkStatus(), Finish(output, a, 3));
+  EXPECT_EQ(output.queued_packets(), 3u);
+  EXPECT_EQ(output.queued_signals(), 3u);
+
+  // Queued buffers are not available until they are transmitted.
+  EXPECT_TRUE(output.AcquireBuffer().empty());
+
+  EXPECT_EQ(OkStatus(), output.TransmitQueuedPackets());
+  ASSERT_EQ(output.transmitted(), 3u);
+  EXPECT_EQ(output.first_bytes()[0], std::byte{1});
+  EXPECT_EQ(output.first_bytes()[1], std::byte{2});
+  EXPECT_EQ(output.first_bytes()[2], std::byte{3});
+  EXPECT_EQ(output.queued_packets(), 0u);
+
+  // All buffers were returned to the pool.
+  a = output.AcquireBuffer();
+  b = output.AcquireBuffer();
+  c = output.AcquireBuffer();
+  EXPECT_FALSE(c.empty());
+  output.DiscardBuffer(a);
+  output.DiscardBuffer(b);
+  output.DiscardBuffer(c);
+}
+
+TEST(BufferPoolChannelOutput, QueueWrapsAround) {
+  TestPoolOutput output;
+
+  // Queue two packets at a time so the queue head moves around the ring.
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(OkStatus(), Finish(output, output.AcquireBuffer(), 2 * i));
+    EXPECT_EQ(OkStatus(), Finish(output, output.AcquireBuffer(), 2 * i + 1));
+    EXPECT_EQ(output.queued_packets(), 2u);
+    EXPECT_EQ(OkStatus(), output.TransmitQueuedPackets());
+  }
+
+  ASSERT_EQ(output.transmitted(), 8u);
+  for (size_t i = 0; i < output.transmitted(); ++i) {
+    EXPECT_EQ(output.first_bytes()[i], static_cast<std::byte>(i));
+  }
+}
+
+TEST(BufferPoolChannelOutput, TransmitError_TransmitsRemainingPackets) {
+  TestPoolOutput output;
+  output.set_transmit_status(Status::Unavailable());
+
+  EXPECT_EQ(OkStatus(), Finish(output, output.AcquireBuffer(), 1));
+  EXPECT_EQ(OkStatus(), Finish(output, output.AcquireBuffer(), 2));
+
+  EXPECT_EQ(Status::Unavailable(), output.TransmitQueuedPackets());
+  EXPECT_EQ(output.transmitted(), 2u);
+  EXPECT_EQ(output.queued_packets(), 0u);
+}
+
+TEST(BufferPoolChannelOutput, SendsPacketsThroughChannel) {
+  TestPoolOutput output;
+  internal::Channel channel(1, &output);
+
+  constexpr std::byte kPayload[] = {std::byte{0x12}};
+  EXPECT_EQ(OkStatus(),
+            channel.Send(Packet(
+                PacketType::RESPONSE, 1, 0xabcd, 0x1234, kPayload)));
+  EXPECT_EQ(output.queued_packets(), 1u);
+
+  EXPECT_EQ(OkStatus(), output.TransmitQueuedPackets());
+  EXPECT_EQ(output.transmitted(), 1u);
+}
+
+// Buffers of 24, 64, and 256 bytes.
+class MultiSizeOutput
+    : public MultiSizeBufferPoolChannelOutput<BufferPoolSize<2, 24>,
+                                              BufferPoolSize<1, 64>,
+                                              BufferPoolSize<1, 256>> {
+ public:
+  MultiSizeOutput() : MultiSizeBufferPoolChannelOutput("MultiSizeOutput") {}
+
+  size_t last_packet_size() const { return last_packet_size_; }
+
+ private:
+  Status Transmit(std::span<const std::byte> packet) override {
+    last_packet_size_ = packet.size();
+    return OkStatus();
+  }
+
+  size_t last_packet_size_ = 0;
+};
+
+TEST(MultiSizeBufferPoolChannelOutput, AcquireBuffer_ReturnsLargest) {
+  MultiSizeOutput output;
+
+  std::span<std::byte> buffer = output.AcquireBuffer();
+  EXPECT_EQ(buffer.size(), 256u);
+  EXPECT_TRUE(output.AcquireBuffer().empty());
+
+  output.DiscardBuffer(buffer);
+}
+
+TEST(MultiSizeBufferPoolChannelOutput, AcquireBufferForSize_ReturnsSmallest) {
+  MultiSizeOutput output;
+
+  std::span<std::byte> a = output.AcquireBufferForSize(10);
+  std::span<std::byte> b = output.AcquireBufferForSize(24);
+  std::span<std::byte> c = output.AcquireBufferForSize(25);
+  EXPECT_EQ(a.size(), 24u);
+  EXPECT_EQ(b.size(), 24u);
+  EXPECT_EQ(c.size(), 64u);
+
+  output.DiscardBuffer(a);
+  output.DiscardBuffer(b);
+  output.DiscardBuffer(c);
+}
+
+TEST(MultiSizeBufferPoolChannelOutput,
+     AcquireBufferForSize_FallsBackToLargerBuffer) {
+  MultiSizeOutput output;
+
+  std::span<std::byte> a = output.AcquireBufferForSize(1);
+  std::span<std::byte> b = output.AcquireBufferForSize(1);
+  std::span<std::byte> c = output.AcquireBufferForSize(1);
+  std::span<std::byte> d = output.AcquireBufferForSize(1);
+  EXPECT_EQ(c.size(), 64u);
+  EXPECT_EQ(d.size(), 256u);
+  EXPECT_TRUE(output.AcquireBufferForSize(1).empty());
+
+  output.DiscardBuffer(a);
+  output.DiscardBuffer(b);
+  output.DiscardBuffer(c);
+  output.DiscardBuffer(d);
+}
+
+TEST(MultiSizeBufferPoolChannelOutput, AcquireBufferForSize_TooLarge) {
+  MultiSizeOutput output;
+
+  // A hint larger than every buffer returns the largest buffer.
+  std::span<std::byte> buffer = output.AcquireBufferForSize(1000);
+  EXPECT_EQ(buffer.size(), 256u);
+  EXPECT_TRUE(output.AcquireBufferForSize(1000).empty());
+
+  output.DiscardBuffer(buffer);
+}
+
+TEST(MultiSizeBufferPoolChannelOutput, QueuedPacket_MovesToSmallerBuffer) {
+  MultiSizeOutput output;
+
+  std::span<std::byte> buffer = output.AcquireBuffer();
+  std::memset(buffer.data(), 0x5a, 40);
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(buffer.first(40)));
+
+  // The packet moved to the 64-byte buffer, so the large one is free again.
+  EXPECT_EQ(output.AcquireBuffer().size(), 256u);
+  EXPECT_TRUE(output.AcquireBufferForSize(40).empty());
+
+  EXPECT_EQ(OkStatus(), output.TransmitQueuedPackets());
+  EXPECT_EQ(output.last_packet_size(), 40u);
+}
+
+TEST(MultiSizeBufferPoolChannelOutput, ChannelSend_UsesSmallBuffer) {
+  MultiSizeOutput output;
+  internal::Channel channel(1, &output);
+
+  // Hold the large buffer, as a stream encoding a response would.
+  std::span<std::byte> large = output.AcquireBuffer();
+  ASSERT_EQ(large.size(), 256u);
+
+  EXPECT_EQ(OkStatus(),
+            channel.Send(Packet(PacketType::SERVER_ERROR,
+                                1,
+                                0xabcd,
+                                0x1234,
+                                {},
+                                Status::Cancelled())));
+  EXPECT_EQ(output.queued_packets(), 1u);
+
+  // The error packet's size is known, so the 64-byte buffer was not needed.
+  std::span<std::byte> medium = output.AcquireBufferForSize(25);
+  EXPECT_EQ(medium.size(), 64u);
+  output.DiscardBuffer(medium);
+
+  EXPECT_EQ(OkStatus(), output.TransmitQueuedPackets());
+  EXPECT_LE(output.last_packet_size(), 24u);
+
+  output.DiscardBuffer(large);
+}
+
+}  // namespace
+}  // namespace pw::rpc
@@ -16,19 +16,30 @@
 
 #include "pw_log/log.h"
 #include "pw_rpc/internal/packet.h"
+#include "pw_rpc/server_observer.h"
 
 namespace pw::rpc::internal {
 
 using std::byte;
 
 std::span<byte> Channel::OutputBuffer::payload(const Packet& packet) const {
-  const size_t reserved_size = packet.MinEncodedSizeBytes();
+  // Reserve the worst-case header size so that a payload written here can be
+  // sent without moving it.
+  const size_t reserved_size = packet.PayloadOffset(buffer_.size());
   return reserved_size <= buffer_.size() ? buffer_.subspan(reserved_size)
                                          : std::span<byte>();
 }
 
+Status Channel::Send(const internal::Packet& packet) {
+  OutputBuffer buffer = AcquireBuffer(packet.BufferSizeBytes());
+  return Send(buffer, packet);
+}
+
 Status Channel::Send(OutputBuffer& buffer, const internal::Packet& packet) {
-  Result encoded = packet.Encode(buffer.buffer_);
+  // Payloads encoded directly into the buffer from payload() are not copied.
+  Result encoded = packet.PayloadIsInPlace(buffer.buffer_)
+                       ? packet.EncodeInPlace(buffer.buffer_)
+                       : packet.Encode(buffer.buffer_);
 
   if (!encoded.ok()) {
     PW_LOG_ERROR("Failed to encode RPC response packet to channel %u buffer",
@@ -39,7 +50,16 @@ Status Channel::Send(OutputBuffer& buffer, const internal::Packet& packet) {
   }
 
   buffer.buffer_ = {};
-  return output().SendAndReleaseBuffer(encoded.value());
+  const Status status = output().SendAndReleaseBuffer(encoded.value());
+
+  // Only server-to-client packets are reported, since a channel may be shared
+  // by a client and a server.
+  if (observer() != nullptr && status.ok() &&
+      packet.destination() == Packet::kClient) {
+    observer()->PacketSent(
+        packet.service_id(), packet.method_id(), encoded.value().size());
+  }
+  return status;
 }
 
 }  // namespace pw::rpc::internal
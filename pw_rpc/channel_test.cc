@@ -113,6 +113,26 @@ TEST(Channel, OutputBuffer_ExtraRoom) {
   EXPECT_EQ(OkStatus(), channel.Send(output_buffer, kTestPacket));
 }
 
+TEST(Channel, OutputBuffer_PayloadInPlace_IsNotMoved) {
+  TestOutput<kReservedSize * 3> output;
+  internal::Channel channel(100, &output);
+
+  Channel::OutputBuffer output_buffer = channel.AcquireBuffer();
+  const std::span payload = output_buffer.payload(kTestPacket);
+  payload[0] = byte{0xAB};
+  payload[1] = byte{0xCD};
+
+  Packet packet = kTestPacket;
+  packet.set_payload(payload.first(2));
+  EXPECT_EQ(OkStatus(), channel.Send(output_buffer, packet));
+
+  const Packet& sent = output.sent_packet();
+  EXPECT_EQ(sent.payload().data(), output.buffer().data() + kReservedSize);
+  EXPECT_EQ(sent.payload().size(), 2u);
+  EXPECT_EQ(sent.payload()[0], byte{0xAB});
+  EXPECT_EQ(sent.method_id(), 100u);
+}
+
 TEST(Channel, OutputBuffer_ReturnsStatusFromChannelOutputSend) {
   TestOutput<kReservedSize * 3> output;
   internal::Channel channel(100, &output);
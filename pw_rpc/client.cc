@@ -14,6 +14,8 @@
 
 #include "pw_rpc/client.h"
 
+#include <algorithm>
+
 #include "pw_log/log.h"
 #include "pw_rpc/internal/packet.h"
 
@@ -45,11 +47,8 @@ Status Client::ProcessPacket(ConstByteSpan data) {
     return Status::DataLoss();
   }
 
-  auto call = std::find_if(calls_.begin(), calls_.end(), [&](auto& c) {
-    return c.channel().id() == packet.channel_id() &&
-           c.service_id() == packet.service_id() &&
-           c.method_id() == packet.method_id();
-  });
+  BaseClientCall* call =
+      FindCall(packet.channel_id(), packet.service_id(), packet.method_id());
 
   auto channel = std::find_if(channels_.begin(), channels_.end(), [&](auto& c) {
     return c.id() == packet.channel_id();
@@ -60,7 +59,7 @@ Status Client::ProcessPacket(ConstByteSpan data) {
     return Status::NotFound();
   }
 
-  if (call == calls_.end()) {
+  if (call == nullptr) {
     PW_LOG_WARN("RPC client received a packet for a request it did not make");
     channel->Send(Packet::ClientError(packet, Status::FailedPrecondition()));
     return Status::NotFound();
@@ -83,19 +82,41 @@ Status Client::ProcessPacket(ConstByteSpan data) {
 }
 
 Status Client::RegisterCall(BaseClientCall& call) {
-  auto existing_call = std::find_if(calls_.begin(), calls_.end(), [&](auto& c) {
-    return c.channel().id() == call.channel().id() &&
-           c.service_id() == call.service_id() &&
-           c.method_id() == call.method_id();
-  });
-  if (existing_call != calls_.end()) {
+  if (FindCall(call.channel_id(), call.service_id(), call.method_id()) !=
+      nullptr) {
     PW_LOG_WARN(
         "RPC client tried to call same method multiple times; aborting.");
     return Status::FailedPrecondition();
   }
 
-  calls_.push_front(call);
+  if (!call_index_.Add(call)) {
+    calls_.push_front(call);
+  }
   return OkStatus();
 }
 
+void Client::RemoveCall(const BaseClientCall& call) {
+  if (!call_index_.Remove(call)) {
+    calls_.remove(call);
+  }
+}
+
+BaseClientCall* Client::FindCall(uint32_t channel_id,
+                                 uint32_t service_id,
+                                 uint32_t method_id) {
+  BaseClientCall* indexed =
+      call_index_.Find(channel_id, service_id, method_id);
+
+  // Only calls that did not fit in the index are in the list.
+  if (indexed != nullptr || !call_index_.overflowed()) {
+    return indexed;
+  }
+
+  auto call = std::find_if(calls_.begin(), calls_.end(), [&](auto& c) {
+    return c.channel_id() == channel_id && c.service_id() == service_id &&
+           c.method_id() == method_id;
+  });
+  return call == calls_.end() ? nullptr : &*call;
+}
+
 }  // namespace pw::rpc
@@ -14,6 +14,8 @@
 
 #include "pw_rpc/client.h"
 
+#include <array>
+
 #include "gtest/gtest.h"
 #include "pw_rpc/internal/packet.h"
 #include "pw_rpc_private/internal_test_utils.h"
@@ -32,6 +34,8 @@ class TestClientCall : public BaseClientCall {
                            uint32_t method_id)
       : BaseClientCall(channel, service_id, method_id, ProcessPacket) {}
 
+  constexpr TestClientCall() = default;
+
   static void ProcessPacket(BaseClientCall& call, const Packet& packet) {
     static_cast<TestClientCall&>(call).HandlePacket(packet);
   }
@@ -69,6 +73,77 @@ TEST(Client, ProcessPacket_SendsClientErrorOnUnregisteredCall) {
   EXPECT_EQ(packet.status(), Status::FailedPrecondition());
 }
 
+Status SendResponse(Client& client,
+                    uint32_t channel_id,
+                    uint32_t service_id,
+                    uint32_t method_id) {
+  Packet packet(PacketType::RESPONSE, channel_id, service_id, method_id);
+  std::byte buffer[64];
+  Result result = packet.Encode(buffer);
+  EXPECT_EQ(result.status(), OkStatus());
+  return client.ProcessPacket(result.value_or(ConstByteSpan()));
+}
+
+TEST(Client, ProcessPacket_RoutesToMatchingCallAmongMany) {
+  ClientContextForTest context;
+
+  std::array<TestClientCall, 6> calls{
+      TestClientCall(&context.channel(), 1, 10),
+      TestClientCall(&context.channel(), 1, 20),
+      TestClientCall(&context.channel(), 1, 30),
+      TestClientCall(&context.channel(), 2, 10),
+      TestClientCall(&context.channel(), 2, 20),
+      TestClientCall(&context.channel(), 2, 30),
+  };
+  EXPECT_EQ(context.client().active_calls(), calls.size());
+
+  EXPECT_EQ(SendResponse(context.client(), context.channel_id(), 2, 20),
+            OkStatus());
+
+  for (size_t i = 0; i < calls.size(); ++i) {
+    EXPECT_EQ(calls[i].invoked(), i == 4u);
+  }
+}
+
+TEST(Client, ProcessPacket_NotFoundAfterCallIsDestroyed) {
+  ClientContextForTest context;
+
+  TestClientCall first(&context.channel(), 1, 10);
+  {
+    TestClientCall second(&context.channel(), 1, 20);
+    EXPECT_EQ(context.client().active_calls(), 2u);
+  }
+  EXPECT_EQ(context.client().active_calls(), 1u);
+
+  EXPECT_EQ(SendResponse(context.client(), context.channel_id(), 1, 20),
+            Status::NotFound());
+  EXPECT_EQ(SendResponse(context.client(), context.channel_id(), 1, 10),
+            OkStatus());
+  EXPECT_TRUE(first.invoked());
+}
+
+TEST(Client, ProcessPacket_RoutesToMoveAssignedCall) {
+  ClientContextForTest context;
+
+  TestClientCall call;
+  call = TestClientCall(&context.channel(), 1, 10);
+  EXPECT_EQ(context.client().active_calls(), 1u);
+
+  EXPECT_EQ(SendResponse(context.client(), context.channel_id(), 1, 10),
+            OkStatus());
+  EXPECT_TRUE(call.invoked());
+}
+
+TEST(Client, RegisterCall_RejectsDuplicateCall) {
+  ClientContextForTest context;
+
+  TestClientCall first(&context.channel(), 1, 10);
+  TestClientCall second(&context.channel(), 1, 10);
+  EXPECT_TRUE(first.active());
+  EXPECT_FALSE(second.active());
+  EXPECT_EQ(context.client().active_calls(), 1u);
+}
+
 TEST(Client, ProcessPacket_ReturnsDataLossOnBadPacket) {
   ClientContextForTest context;
 
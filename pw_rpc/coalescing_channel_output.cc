@@ -0,0 +1,120 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/coalescing_channel_output.h"
+
+#include <algorithm>
+
+#include "pw_assert/assert.h"
+#include "pw_varint/varint.h"
+
+namespace pw::rpc {
+
+CoalescingChannelOutput::CoalescingChannelOutput(
+    const char* name,
+    ChannelOutput& output,
+    ByteSpan buffer,
+    size_t max_packet_size,
+    chrono::SystemClock::duration max_delay)
+    : ChannelOutput(name),
+      output_(output),
+      buffer_(buffer),
+      max_packet_size_(max_packet_size),
+      prefix_size_(varint::EncodedSize(max_packet_size)),
+      max_delay_(max_delay),
+      size_(0),
+      pending_packets_(0) {
+  PW_ASSERT(prefix_size_ + max_packet_size_ <= buffer_.size());
+}
+
+std::span<std::byte> CoalescingChannelOutput::AcquireBuffer() {
+  // SendAndReleaseBuffer() sends the frame as soon as a packet might not fit,
+  // and reports if that fails. A frame is never flushed from here, where the
+  // status would be lost along with the packets.
+  if (buffer_.size() - size_ < prefix_size_ + max_packet_size_) {
+    return std::span<std::byte>();
+  }
+  return buffer_.subspan(size_ + prefix_size_, max_packet_size_);
+}
+
+Status CoalescingChannelOutput::SendAndReleaseBuffer(
+    std::span<const std::byte> buffer) {
+  if (buffer.empty()) {
+    return OkStatus();
+  }
+
+  PW_ASSERT(buffer.data() == buffer_.data() + size_ + prefix_size_);
+  PW_ASSERT(buffer.size() <= max_packet_size_);
+
+  // Each packet's length prefix is reserved before the packet is encoded, so
+  // the prefix is always the size required for the largest packet.
+  varint::EncodePadded(buffer.size(), buffer_.subspan(size_, prefix_size_));
+  size_ += prefix_size_ + buffer.size();
+
+  if (pending_packets_++ == 0u) {
+    first_packet_time_ = chrono::SystemClock::now();
+  }
+
+  if (buffer_.size() - size_ < prefix_size_ + max_packet_size_) {
+    return Flush();
+  }
+  return FlushIfDue();
+}
+
+Status CoalescingChannelOutput::Flush() {
+  if (pending_packets_ == 0u) {
+    return OkStatus();
+  }
+
+  const size_t frame_size = size_;
+  std::span<std::byte> frame = output_.AcquireBufferForSize(frame_size);
+
+  size_ = 0;
+  pending_packets_ = 0;
+
+  if (frame.size() < frame_size) {
+    output_.DiscardBuffer(frame);
+    return Status::ResourceExhausted();
+  }
+
+  std::copy_n(buffer_.begin(), frame_size, frame.begin());
+  return output_.SendAndReleaseBuffer(frame.first(frame_size));
+}
+
+Status CoalescingChannelOutput::FlushIfDue() {
+  if (pending_packets_ == 0u ||
+      chrono::SystemClock::now() - first_packet_time_ < max_delay_) {
+    return OkStatus();
+  }
+  return Flush();
+}
+
+namespace internal {
+
+Result<ConstByteSpan> ReadCoalescedPacket(ConstByteSpan& frame) {
+  uint64_t size;
+  const size_t prefix_size = varint::Decode(frame, &size);
+
+  if (prefix_size == 0u || frame.size() - prefix_size < size) {
+    frame = ConstByteSpan();
+    return Status::DataLoss();
+  }
+
+  ConstByteSpan packet = frame.subspan(prefix_size, size);
+  frame = frame.subspan(prefix_size + size);
+  return packet;
+}
+
+}  // namespace internal
+}  // namespace pw::rpc
@@ -0,0 +1,256 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/coalescing_channel_output.h"
+
+#include <array>
+#include <chrono>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+#include "pw_rpc/internal/packet.h"
+
+namespace pw::rpc {
+namespace {
+
+using internal::Packet;
+using internal::PacketType;
+
+constexpr auto kNoDelay = chrono::SystemClock::duration::zero();
+constexpr auto kLongDelay =
+    chrono::SystemClock::for_at_least(std::chrono::hours(1));
+
+// Records each frame sent through it.
+class FrameOutput : public ChannelOutput {
+ public:
+  FrameOutput() : ChannelOutput("FrameOutput") {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override {
+    if (!buffer.empty()) {
+      frame_count_ += 1;
+      frame_ = buffer;
+    }
+    return send_status_;
+  }
+
+  size_t frame_count() const { return frame_count_; }
+  ConstByteSpan frame() const { return frame_; }
+
+  void set_send_status(Status status) { send_status_ = status; }
+
+ private:
+  std::array<std::byte, 64> buffer_;
+  ConstByteSpan frame_;
+  size_t frame_count_ = 0;
+  Status send_status_;
+};
+
+// Sends a packet consisting of size bytes of the given value.
+Status SendPacket(ChannelOutput& output, size_t size, std::byte value) {
+  std::span<std::byte> buffer = output.AcquireBuffer();
+  EXPECT_GE(buffer.size(), size);
+  std::memset(buffer.data(), static_cast<int>(value), size);
+  return output.SendAndReleaseBuffer(buffer.first(size));
+}
+
+class CoalescingChannelOutputTest : public ::testing::Test {
+ protected:
+  FrameOutput frame_output_;
+};
+
+TEST_F(CoalescingChannelOutputTest, AcquireBuffer_ReturnsMaxPacketSize) {
+  CoalescingChannelOutputWithBuffer<32> output(
+      "coalesce", frame_output_, 10, kLongDelay);
+  EXPECT_EQ(output.AcquireBuffer().size(), 10u);
+}
+
+TEST_F(CoalescingChannelOutputTest, HoldsPacketsUntilFlushed) {
+  CoalescingChannelOutputWithBuffer<32> output(
+      "coalesce", frame_output_, 10, kLongDelay);
+
+  EXPECT_EQ(OkStatus(), SendPacket(output, 3, std::byte{0xa1}));
+  EXPECT_EQ(OkStatus(), SendPacket(output, 2, std::byte{0xb2}));
+  EXPECT_EQ(output.pending_packets(), 2u);
+  EXPECT_EQ(frame_output_.frame_count(), 0u);
+
+  EXPECT_EQ(OkStatus(), output.Flush());
+  EXPECT_EQ(output.pending_packets(), 0u);
+  ASSERT_EQ(frame_output_.frame_count(), 1u);
+
+  constexpr auto kExpected =
+      bytes::Array<3, 0xa1, 0xa1, 0xa1, 2, 0xb2, 0xb2>();
+  ASSERT_EQ(frame_output_.frame().size(), kExpected.size());
+  EXPECT_EQ(std::memcmp(frame_output_.frame().data(),
+                        kExpected.data(),
+                        kExpected.size()),
+            0);
+}
+
+TEST_F(CoalescingChannelOutputTest, Flush_NoPackets_SendsNothing) {
+  CoalescingChannelOutputWithBuffer<32> output(
+      "coalesce", frame_output_, 10, kLongDelay);
+
+  EXPECT_EQ(OkStatus(), output.Flush());
+  EXPECT_EQ(frame_output_.frame_count(), 0u);
+}
+
+TEST_F(CoalescingChannelOutputTest, DiscardedBuffer_IsNotSent) {
+  CoalescingChannelOutputWithBuffer<32> output(
+      "coalesce", frame_output_, 10, kLongDelay);
+
+  output.DiscardBuffer(output.AcquireBuffer());
+  EXPECT_EQ(output.pending_packets(), 0u);
+  EXPECT_EQ(OkStatus(), output.Flush());
+  EXPECT_EQ(frame_output_.frame_count(), 0u);
+}
+
+TEST_F(CoalescingChannelOutputTest, FlushesWhenNextPacketMightNotFit) {
+  // Each packet takes up to 11 bytes including its length prefix.
+  CoalescingChannelOutputWithBuffer<25> output(
+      "coalesce", frame_output_, 10, kLongDelay);
+
+  EXPECT_EQ(OkStatus(), SendPacket(output, 1, std::byte{1}));
+  EXPECT_EQ(frame_output_.frame_count(), 0u);
+
+  // There are 14 bytes left after the second packet, enough for one more full
+  // packet, so the frame is held.
+  EXPECT_EQ(OkStatus(), SendPacket(output, 8, std::byte{2}));
+  EXPECT_EQ(frame_output_.frame_count(), 0u);
+
+  // Only 3 bytes are left after this packet, so the frame is sent right away.
+  EXPECT_EQ(OkStatus(), SendPacket(output, 10, std::byte{3}));
+  EXPECT_EQ(frame_output_.frame_count(), 1u);
+  EXPECT_EQ(frame_output_.frame().size(), 22u);
+  EXPECT_EQ(output.pending_packets(), 0u);
+}
+
+TEST_F(CoalescingChannelOutputTest, NoDelay_SendsEachPacket) {
+  CoalescingChannelOutputWithBuffer<32> output(
+      "coalesce", frame_output_, 10, kNoDelay);
+
+  EXPECT_EQ(OkStatus(), SendPacket(output, 3, std::byte{1}));
+  EXPECT_EQ(frame_output_.frame_count(), 1u);
+  EXPECT_EQ(OkStatus(), SendPacket(output, 3, std::byte{2}));
+  EXPECT_EQ(frame_output_.frame_count(), 2u);
+  EXPECT_EQ(output.pending_packets(), 0u);
+}
+
+TEST_F(CoalescingChannelOutputTest, FlushIfDue_HoldsRecentPackets) {
+  CoalescingChannelOutputWithBuffer<32> output(
+      "coalesce", frame_output_, 10, kLongDelay);
+
+  EXPECT_EQ(OkStatus(), SendPacket(output, 3, std::byte{1}));
+  EXPECT_EQ(OkStatus(), output.FlushIfDue());
+  EXPECT_EQ(frame_output_.frame_count(), 0u);
+  EXPECT_EQ(output.pending_packets(), 1u);
+}
+
+TEST_F(CoalescingChannelOutputTest, Flush_ReturnsOutputStatus) {
+  CoalescingChannelOutputWithBuffer<32> output(
+      "coalesce", frame_output_, 10, kLongDelay);
+  frame_output_.set_send_status(Status::Unavailable());
+
+  EXPECT_EQ(OkStatus(), SendPacket(output, 3, std::byte{1}));
+  EXPECT_EQ(Status::Unavailable(), output.Flush());
+  EXPECT_EQ(output.pending_packets(), 0u);
+}
+
+TEST_F(CoalescingChannelOutputTest, FullFrame_SendFails_ReturnsOutputStatus) {
+  CoalescingChannelOutputWithBuffer<20> output(
+      "coalesce", frame_output_, 10, kLongDelay);
+  frame_output_.set_send_status(Status::Unavailable());
+
+  // The frame is sent, and fails, as part of the packet that fills it.
+  EXPECT_EQ(Status::Unavailable(), SendPacket(output, 10, std::byte{1}));
+  EXPECT_EQ(frame_output_.frame_count(), 1u);
+  EXPECT_EQ(output.pending_packets(), 0u);
+
+  // The next packet starts a new frame.
+  EXPECT_EQ(output.AcquireBuffer().size(), 10u);
+}
+
+TEST_F(CoalescingChannelOutputTest, Flush_OutputTooSmall_ResourceExhausted) {
+  CoalescingChannelOutputWithBuffer<128> output(
+      "coalesce", frame_output_, 40, kLongDelay);
+
+  EXPECT_EQ(OkStatus(), SendPacket(output, 40, std::byte{1}));
+  EXPECT_EQ(OkStatus(), SendPacket(output, 40, std::byte{2}));
+  EXPECT_EQ(Status::ResourceExhausted(), output.Flush());
+  EXPECT_EQ(frame_output_.frame_count(), 0u);
+}
+
+TEST(ForEachCoalescedPacket, SplitsEncodedPackets) {
+  FrameOutput frame_output;
+  CoalescingChannelOutputWithBuffer<128> output(
+      "coalesce", frame_output, 30, kLongDelay);
+
+  constexpr auto kPayload = bytes::Array<0x0a, 0x0b>();
+  for (uint32_t method_id = 1; method_id <= 2; ++method_id) {
+    std::span<std::byte> buffer = output.AcquireBuffer();
+    Result<ConstByteSpan> packet =
+        Packet(PacketType::RESPONSE, 1, 42, method_id, kPayload).Encode(buffer);
+    ASSERT_EQ(OkStatus(), packet.status());
+    ASSERT_EQ(OkStatus(), output.SendAndReleaseBuffer(packet.value()));
+  }
+  ASSERT_EQ(OkStatus(), output.Flush());
+  ASSERT_EQ(frame_output.frame_count(), 1u);
+
+  uint32_t expected_method_id = 1;
+  EXPECT_EQ(OkStatus(),
+            ForEachCoalescedPacket(frame_output.frame(), [&](ConstByteSpan data) {
+              Result<Packet> packet = Packet::FromBuffer(data);
+              ASSERT_EQ(OkStatus(), packet.status());
+              EXPECT_EQ(packet.value().type(), PacketType::RESPONSE);
+              EXPECT_EQ(packet.value().method_id(), expected_method_id);
+              EXPECT_EQ(packet.value().payload().size(), kPayload.size());
+              expected_method_id += 1;
+            }));
+  EXPECT_EQ(expected_method_id, 3u);
+}
+
+TEST(ForEachCoalescedPacket, EmptyFrame) {
+  size_t calls = 0;
+  EXPECT_EQ(OkStatus(),
+            ForEachCoalescedPacket(ConstByteSpan(), [&](ConstByteSpan) {
+              calls += 1;
+            }));
+  EXPECT_EQ(calls, 0u);
+}
+
+TEST(ForEachCoalescedPacket, Truncated_ReturnsDataLoss) {
+  // The second packet claims 5 bytes but only 2 are present.
+  constexpr auto kFrame = bytes::Array<1, 0xaa, 5, 0xbb, 0xbb>();
+
+  size_t calls = 0;
+  EXPECT_EQ(Status::DataLoss(),
+            ForEachCoalescedPacket(kFrame, [&](ConstByteSpan packet) {
+              EXPECT_EQ(packet.size(), 1u);
+              calls += 1;
+            }));
+  EXPECT_EQ(calls, 1u);
+}
+
+TEST(ForEachCoalescedPacket, BadVarint_ReturnsDataLoss) {
+  constexpr auto kFrame = bytes::Array<0x80, 0x80>();
+  EXPECT_EQ(Status::DataLoss(),
+            ForEachCoalescedPacket(kFrame, [](ConstByteSpan) {
+              FAIL();
+            }));
+}
+
+}  // namespace
+}  // namespace pw::rpc
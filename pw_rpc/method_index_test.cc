@@ -0,0 +1,119 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/internal/method_index.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+#include "pw_rpc/internal/test_method.h"
+#include "pw_rpc/service.h"
+
+namespace pw::rpc::internal {
+namespace {
+
+class TestService : public Service {
+ public:
+  TestService(uint32_t service_id, uint32_t first_method, uint32_t second_method)
+      : Service(service_id, methods_),
+        methods_{
+            TestMethod(first_method),
+            TestMethod(second_method),
+        } {}
+
+  const Method& method(size_t index) const {
+    return methods_[index].method();
+  }
+
+ private:
+  std::array<TestMethodUnion, 2> methods_;
+};
+
+TEST(MethodIndex, Find_Empty_ReturnsNull) {
+  MethodIndex<4> index;
+  EXPECT_EQ(index.Find(1, 2), std::make_tuple(nullptr, nullptr));
+  EXPECT_EQ(index.size(), 0u);
+  EXPECT_FALSE(index.overflowed());
+}
+
+TEST(MethodIndex, Find_RegisteredMethods) {
+  TestService service_1(1, 100, 200);
+  TestService service_2(2, 100, 300);
+
+  MethodIndex<8> index;
+  EXPECT_TRUE(index.Add(service_1));
+  EXPECT_TRUE(index.Add(service_2));
+  EXPECT_EQ(index.size(), 4u);
+
+  EXPECT_EQ(index.Find(1, 100),
+            std::make_tuple(static_cast<Service*>(&service_1),
+                            &service_1.method(0)));
+  EXPECT_EQ(index.Find(1, 200),
+            std::make_tuple(static_cast<Service*>(&service_1),
+                            &service_1.method(1)));
+  EXPECT_EQ(index.Find(2, 100),
+            std::make_tuple(static_cast<Service*>(&service_2),
+                            &service_2.method(0)));
+  EXPECT_EQ(index.Find(2, 300),
+            std::make_tuple(static_cast<Service*>(&service_2),
+                            &service_2.method(1)));
+}
+
+TEST(MethodIndex, Find_UnknownIds_ReturnsNull) {
+  TestService service(1, 100, 200);
+
+  MethodIndex<4> index;
+  ASSERT_TRUE(index.Add(service));
+
+  EXPECT_EQ(index.Find(1, 300), std::make_tuple(nullptr, nullptr));
+  EXPECT_EQ(index.Find(2, 100), std::make_tuple(nullptr, nullptr));
+}
+
+TEST(MethodIndex, Find_FullIndex_ProbesEverySlot) {
+  TestService service_1(1, 100, 200);
+  TestService service_2(2, 100, 300);
+
+  MethodIndex<4> index;
+  ASSERT_TRUE(index.Add(service_1));
+  ASSERT_TRUE(index.Add(service_2));
+  ASSERT_EQ(index.size(), index.capacity());
+
+  EXPECT_EQ(std::get<1>(index.Find(2, 300)), &service_2.method(1));
+  EXPECT_EQ(index.Find(3, 100), std::make_tuple(nullptr, nullptr));
+}
+
+TEST(MethodIndex, Add_TooManyMethods_Overflows) {
+  TestService service_1(1, 100, 200);
+  TestService service_2(2, 100, 300);
+
+  MethodIndex<3> index;
+  EXPECT_TRUE(index.Add(service_1));
+  EXPECT_FALSE(index.Add(service_2));
+  EXPECT_TRUE(index.overflowed());
+
+  // Methods added before the overflow are still found.
+  EXPECT_EQ(std::get<1>(index.Find(1, 200)), &service_1.method(1));
+}
+
+TEST(MethodIndex, Disabled_AlwaysMisses) {
+  TestService service(1, 100, 200);
+
+  MethodIndex<0> index;
+  EXPECT_FALSE(index.Add(service));
+  EXPECT_TRUE(index.overflowed());
+  EXPECT_EQ(index.Find(1, 100), std::make_tuple(nullptr, nullptr));
+}
+
+}  // namespace
+}  // namespace pw::rpc::internal
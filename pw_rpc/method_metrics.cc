@@ -0,0 +1,119 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/method_metrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace pw::rpc::internal {
+namespace {
+
+uint32_t Saturate(size_t value) {
+  return static_cast<uint32_t>(
+      std::min<size_t>(value, std::numeric_limits<uint32_t>::max()));
+}
+
+}  // namespace
+
+const MethodStats* BaseMethodMetrics::Find(uint32_t service_id,
+                                           uint32_t method_id) const {
+  for (const MethodStats& method : methods_) {
+    if (method.Is(service_id, method_id)) {
+      return &method;
+    }
+  }
+  return nullptr;
+}
+
+MethodStats* BaseMethodMetrics::FindOrAdd(uint32_t service_id,
+                                          uint32_t method_id) {
+  if (MethodStats* method = FindMutable(service_id, method_id);
+      method != nullptr) {
+    return method;
+  }
+
+  if (methods_.full()) {
+    return nullptr;
+  }
+
+  auto service = std::find_if(services_.begin(),
+                              services_.end(),
+                              [&](auto& s) { return s.id() == service_id; });
+
+  if (service == services_.end()) {
+    if (services_.full()) {
+      return nullptr;
+    }
+    services_.emplace_back(service_id, group_);
+    service = &services_.back();
+  }
+
+  methods_.emplace_back(service_id, method_id, service->metrics());
+  return &methods_.back();
+}
+
+void BaseMethodMetrics::PacketReceived(uint32_t service_id,
+                                       uint32_t method_id,
+                                       size_t size_bytes) {
+  MethodStats* method = FindOrAdd(service_id, method_id);
+  if (method == nullptr) {
+    untracked_packets_.Increment();
+    return;
+  }
+
+  method->bytes_in_.Increment(Saturate(size_bytes));
+}
+
+void BaseMethodMetrics::PacketSent(uint32_t service_id,
+                                   uint32_t method_id,
+                                   size_t size_bytes) {
+  // Responses are only sent for methods that have received a packet, so don't
+  // add new methods here. This keeps the table lookup read-only when packets
+  // are sent from other threads.
+  MethodStats* method = FindMutable(service_id, method_id);
+  if (method == nullptr) {
+    untracked_packets_.Increment();
+    return;
+  }
+
+  method->bytes_out_.Increment(Saturate(size_bytes));
+}
+
+void BaseMethodMetrics::InvocationStarted(uint32_t service_id,
+                                          uint32_t method_id) {
+  if (MethodStats* method = FindMutable(service_id, method_id);
+      method != nullptr) {
+    method->calls_.Increment();
+  }
+  invocation_start_ = chrono::SystemClock::now();
+}
+
+void BaseMethodMetrics::InvocationFinished(uint32_t service_id,
+                                           uint32_t method_id) {
+  MethodStats* method = FindMutable(service_id, method_id);
+  if (method == nullptr) {
+    return;
+  }
+
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      chrono::SystemClock::now() - invocation_start_);
+  const uint32_t elapsed_us = Saturate(static_cast<size_t>(elapsed.count()));
+
+  method->total_time_us_.Increment(elapsed_us);
+  method->max_time_us_.Set(std::max(method->max_time_us_.value(), elapsed_us));
+}
+
+}  // namespace pw::rpc::internal
@@ -0,0 +1,159 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/method_metrics.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_rpc/internal/test_method.h"
+#include "pw_rpc/server.h"
+#include "pw_rpc_private/internal_test_utils.h"
+
+namespace pw::rpc {
+namespace {
+
+using internal::MethodStats;
+
+TEST(MethodMetrics, PacketReceived_AddsMethod) {
+  MethodMetrics<2, 4> metrics;
+  metrics.PacketReceived(1, 10, 20);
+  metrics.PacketReceived(1, 10, 5);
+
+  const MethodStats* method = metrics.Find(1, 10);
+  ASSERT_NE(method, nullptr);
+  EXPECT_EQ(method->bytes_in(), 25u);
+  EXPECT_EQ(method->calls(), 0u);
+  EXPECT_EQ(metrics.Find(1, 11), nullptr);
+
+  // Metrics are grouped by service, then method.
+  ASSERT_EQ(metrics.group().children().size(), 1u);
+  metric::Group& service = metrics.group().children().front();
+  EXPECT_EQ(service.name(), 1u);
+  ASSERT_EQ(service.children().size(), 1u);
+  EXPECT_EQ(service.children().front().name(), 10u);
+  EXPECT_EQ(service.children().front().metrics().size(), 5u);
+}
+
+TEST(MethodMetrics, SameMethodIdInTwoServices_TrackedSeparately) {
+  MethodMetrics<2, 4> metrics;
+  metrics.PacketReceived(1, 10, 20);
+  metrics.PacketReceived(2, 10, 30);
+
+  ASSERT_NE(metrics.Find(1, 10), nullptr);
+  ASSERT_NE(metrics.Find(2, 10), nullptr);
+  EXPECT_EQ(metrics.Find(1, 10)->bytes_in(), 20u);
+  EXPECT_EQ(metrics.Find(2, 10)->bytes_in(), 30u);
+  EXPECT_EQ(metrics.group().children().size(), 2u);
+}
+
+TEST(MethodMetrics, PacketSent_RecordsBytesOut) {
+  MethodMetrics<1, 1> metrics;
+  metrics.PacketReceived(1, 10, 20);
+  metrics.PacketSent(1, 10, 7);
+  metrics.PacketSent(1, 10, 8);
+
+  EXPECT_EQ(metrics.Find(1, 10)->bytes_out(), 15u);
+  EXPECT_EQ(metrics.untracked_packets(), 0u);
+}
+
+TEST(MethodMetrics, PacketSent_UnknownMethod_CountedAsUntracked) {
+  MethodMetrics<1, 1> metrics;
+  metrics.PacketSent(1, 10, 7);
+
+  EXPECT_EQ(metrics.Find(1, 10), nullptr);
+  EXPECT_EQ(metrics.untracked_packets(), 1u);
+}
+
+TEST(MethodMetrics, Full_CountsUntrackedPackets) {
+  MethodMetrics<1, 2> metrics;
+  metrics.PacketReceived(1, 10, 1);
+  metrics.PacketReceived(1, 11, 1);
+  metrics.PacketReceived(1, 12, 1);  // No room for the method
+  metrics.PacketReceived(2, 10, 1);  // No room for the service
+
+  EXPECT_NE(metrics.Find(1, 10), nullptr);
+  EXPECT_NE(metrics.Find(1, 11), nullptr);
+  EXPECT_EQ(metrics.Find(1, 12), nullptr);
+  EXPECT_EQ(metrics.Find(2, 10), nullptr);
+  EXPECT_EQ(metrics.untracked_packets(), 2u);
+}
+
+TEST(MethodMetrics, Invocation_CountsCallsAndRecordsTime) {
+  MethodMetrics<1, 1> metrics;
+  metrics.PacketReceived(1, 10, 1);
+
+  metrics.InvocationStarted(1, 10);
+  metrics.InvocationFinished(1, 10);
+  const uint32_t first_time_us = metrics.Find(1, 10)->total_time_us();
+  EXPECT_EQ(metrics.Find(1, 10)->max_time_us(), first_time_us);
+
+  metrics.InvocationStarted(1, 10);
+  metrics.InvocationFinished(1, 10);
+
+  const MethodStats& method = *metrics.Find(1, 10);
+  EXPECT_EQ(method.calls(), 2u);
+  EXPECT_GE(method.total_time_us(), first_time_us);
+  EXPECT_GE(method.total_time_us(), method.max_time_us());
+}
+
+class TestService : public Service {
+ public:
+  TestService(uint32_t id)
+      : Service(id, methods_), methods_{internal::TestMethod(100)} {}
+
+ private:
+  std::array<internal::TestMethodUnion, 1> methods_;
+};
+
+TEST(MethodMetrics, InstalledOnServer_RecordsRequests) {
+  TestOutput<128> output;
+  std::array<Channel, 1> channels = {Channel::Create<1>(&output)};
+  Server server(channels);
+  TestService service(42);
+  server.RegisterService(service);
+
+  MethodMetrics<1, 1> metrics;
+  server.set_observer(&metrics);
+
+  std::array<std::byte, 32> buffer;
+  auto request =
+      internal::Packet(internal::PacketType::REQUEST, 1, 42, 100, {})
+          .Encode(buffer);
+  ASSERT_EQ(OkStatus(), request.status());
+
+  EXPECT_EQ(OkStatus(), server.ProcessPacket(request.value(), output));
+  EXPECT_EQ(OkStatus(), server.ProcessPacket(request.value(), output));
+
+  // Requests for unknown methods are answered with an error, which does not
+  // add the method.
+  auto unknown =
+      internal::Packet(internal::PacketType::REQUEST, 1, 42, 101, {})
+          .Encode(buffer);
+  ASSERT_EQ(OkStatus(), unknown.status());
+  EXPECT_EQ(OkStatus(), server.ProcessPacket(unknown.value(), output));
+
+  const MethodStats* method = metrics.Find(42, 100);
+  ASSERT_NE(method, nullptr);
+  EXPECT_EQ(method->calls(), 2u);
+  EXPECT_EQ(method->bytes_in(), 2 * request.value().size());
+  EXPECT_EQ(metrics.Find(42, 101), nullptr);
+  EXPECT_EQ(metrics.untracked_packets(), 1u);
+
+  server.set_observer(nullptr);
+}
+
+}  // namespace
+}  // namespace pw::rpc
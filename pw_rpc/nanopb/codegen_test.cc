@@ -41,6 +41,35 @@ class TestService final : public generated::TestService<TestService> {
 
     writer.Finish(static_cast<Status::Code>(request.status_code));
   }
+
+  void TestClientStreamRpc(
+      ServerContext&,
+      ServerReader<pw_rpc_test_TestRequest, pw_rpc_test_TestStreamResponse>&
+          reader) {
+    reader.set_on_next([this](const pw_rpc_test_TestRequest& request) {
+      sum_ += static_cast<uint32_t>(request.integer);
+    });
+    reader.set_on_client_stream_end(
+        [this]() { reader_.Finish({.chunk = {}, .number = sum_}); });
+    reader_ = std::move(reader);
+  }
+
+  void TestBidirectionalStreamRpc(
+      ServerContext&,
+      ServerReaderWriter<pw_rpc_test_TestRequest,
+                         pw_rpc_test_TestStreamResponse>& reader_writer) {
+    reader_writer.set_on_next([this](const pw_rpc_test_TestRequest& request) {
+      reader_writer_.Write(
+          {.chunk = {}, .number = static_cast<uint32_t>(request.integer)});
+    });
+    reader_writer_ = std::move(reader_writer);
+  }
+
+ private:
+  uint32_t sum_ = 0;
+  ServerReader<pw_rpc_test_TestRequest, pw_rpc_test_TestStreamResponse> reader_;
+  ServerReaderWriter<pw_rpc_test_TestRequest, pw_rpc_test_TestStreamResponse>
+      reader_writer_;
 };
 
 }  // namespace test
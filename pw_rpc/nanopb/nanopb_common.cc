@@ -14,8 +14,13 @@
 
 #include "pw_rpc/internal/nanopb_common.h"
 
+#include <utility>
+
+#include "pb_common.h"
 #include "pb_decode.h"
 #include "pb_encode.h"
+#include "pw_log/log.h"
+#include "pw_rpc/nanopb_arena.h"
 
 namespace pw::rpc::internal {
 
@@ -32,6 +37,110 @@ struct NanopbTraits<bool(pb_istream_t*, FieldsType, void*)> {
 
 using Fields = typename NanopbTraits<decltype(pb_decode)>::Fields;
 
+namespace {
+
+// The field argument of a decode callback is also version-specific, so it is
+// deduced from pb_callback_t in the same way.
+template <typename DecodeCallback>
+struct NanopbCallbackTraits;
+
+template <typename FieldType>
+struct NanopbCallbackTraits<bool (*)(pb_istream_t*, FieldType, void**)> {
+  using Field = FieldType;
+};
+
+using CallbackField = typename NanopbCallbackTraits<decltype(
+    std::declval<pb_callback_t&>().funcs.decode)>::Field;
+
+// Nanopb 4 stores the field type in the iterator; Nanopb 3 stores it in the
+// field descriptor the iterator points to.
+template <typename Iterator>
+constexpr auto FieldType(const Iterator& field, int) -> decltype(field.type) {
+  return field.type;
+}
+
+template <typename Iterator>
+constexpr auto FieldType(const Iterator& field, long)
+    -> decltype(field.pos->type) {
+  return field.pos->type;
+}
+
+// Copies one occurrence of a field into the arena and appends it to the
+// field's list.
+bool DecodeToArena(pb_istream_t* stream, CallbackField, void** arg) {
+  NanopbArenaList& list = *static_cast<NanopbArenaList*>(*arg);
+  const size_t size = stream->bytes_left;
+
+  NanopbArenaEntry* entry = list.arena->New<NanopbArenaEntry>();
+  void* data = list.arena->Allocate(size, 1);
+  if (entry == nullptr || data == nullptr) {
+    PW_LOG_WARN("RPC scratch arena is too small to decode a %u-byte field",
+                static_cast<unsigned>(size));
+    return false;
+  }
+
+  if (!pb_read(stream, static_cast<pb_byte_t*>(data), size)) {
+    return false;
+  }
+
+  entry->data = ConstByteSpan(static_cast<const std::byte*>(data), size);
+  if (list.last == nullptr) {
+    list.first = entry;
+  } else {
+    list.last->next = entry;
+  }
+  list.last = entry;
+  list.count += 1;
+  return true;
+}
+
+// Sets up the top-level callback fields of a struct to decode into the arena.
+// Fields that already have a decode callback are left alone.
+bool InstallArenaCallbacks(Fields fields,
+                           void* proto_struct,
+                           allocator::Arena& arena) {
+  pb_field_iter_t field;
+  if (!pb_field_iter_begin(&field, fields, proto_struct)) {
+    return true;  // The message has no fields.
+  }
+
+  do {
+    const auto type = FieldType(field, 0);
+    if (PB_ATYPE(type) != PB_ATYPE_CALLBACK) {
+      continue;
+    }
+    if (PB_LTYPE(type) != PB_LTYPE_BYTES && PB_LTYPE(type) != PB_LTYPE_STRING &&
+        PB_LTYPE(type) != PB_LTYPE_SUBMESSAGE) {
+      continue;
+    }
+
+    pb_callback_t& callback = *static_cast<pb_callback_t*>(field.pData);
+    if (callback.funcs.decode != nullptr) {
+      continue;
+    }
+
+    NanopbArenaList* list = arena.New<NanopbArenaList>();
+    if (list == nullptr) {
+      PW_LOG_WARN("RPC scratch arena is too small to decode a request");
+      return false;
+    }
+    list->arena = &arena;
+    callback.funcs.decode = DecodeToArena;
+    callback.arg = list;
+  } while (pb_field_iter_next(&field));
+
+  return true;
+}
+
+}  // namespace
+
+const NanopbArenaList* GetNanopbArenaList(const pb_callback_t& field) {
+  if (field.funcs.decode != DecodeToArena) {
+    return nullptr;
+  }
+  return static_cast<const NanopbArenaList*>(field.arg);
+}
+
 StatusWithSize NanopbMethodSerde::Encode(NanopbMessageDescriptor fields,
                                          ByteSpan buffer,
                                          const void* proto_struct) const {
@@ -46,7 +155,15 @@ StatusWithSize NanopbMethodSerde::Encode(NanopbMessageDescriptor fields,
 
 bool NanopbMethodSerde::Decode(NanopbMessageDescriptor fields,
                                void* proto_struct,
-                               ConstByteSpan buffer) const {
+                               ConstByteSpan buffer,
+                               allocator::Arena* arena) const {
+  if (arena != nullptr) {
+    if (!InstallArenaCallbacks(
+            static_cast<Fields>(fields), proto_struct, *arena)) {
+      return false;
+    }
+  }
+
   auto input = pb_istream_from_buffer(
       reinterpret_cast<const pb_byte_t*>(buffer.data()), buffer.size());
   return pb_decode(&input, static_cast<Fields>(fields), proto_struct);
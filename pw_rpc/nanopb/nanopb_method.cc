@@ -18,6 +18,8 @@
 #include "pb_encode.h"
 #include "pw_log/log.h"
 #include "pw_rpc/internal/packet.h"
+#include "pw_rpc/internal/server.h"
+#include "pw_rpc/server_context.h"
 
 namespace pw::rpc::internal {
 
@@ -27,7 +29,7 @@ void NanopbMethod::CallUnary(ServerCall& call,
                              const Packet& request,
                              void* request_struct,
                              void* response_struct) const {
-  if (!DecodeRequest(call.channel(), request, request_struct)) {
+  if (!DecodeRequest(call, request, request_struct)) {
     return;
   }
 
@@ -35,10 +37,29 @@ void NanopbMethod::CallUnary(ServerCall& call,
   SendResponse(call.channel(), request, response_struct, status);
 }
 
+void NanopbMethod::CallDeferredUnary(ServerCall& call,
+                                     const Packet& request,
+                                     void* request_struct) const {
+  if (!DecodeRequest(call, request, request_struct)) {
+    return;
+  }
+
+  if (!call.server().AcquireDeferredCall()) {
+    PW_LOG_WARN("Too many deferred RPCs; rejecting request on channel %u",
+                unsigned(call.channel().id()));
+    call.channel().Send(
+        Packet::ServerError(request, Status::ResourceExhausted()));
+    return;
+  }
+
+  internal::Responder responder(call, MethodType::kUnary);
+  function_.deferred_unary(call, request_struct, responder);
+}
+
 void NanopbMethod::CallServerStreaming(ServerCall& call,
                                        const Packet& request,
                                        void* request_struct) const {
-  if (!DecodeRequest(call.channel(), request, request_struct)) {
+  if (!DecodeRequest(call, request, request_struct)) {
     return;
   }
 
@@ -46,13 +67,15 @@ void NanopbMethod::CallServerStreaming(ServerCall& call,
   function_.server_streaming(call, request_struct, server_writer);
 }
 
-bool NanopbMethod::DecodeRequest(Channel& channel,
+bool NanopbMethod::DecodeRequest(ServerCall& call,
                                  const Packet& request,
                                  void* proto_struct) const {
-  if (serde_.DecodeRequest(proto_struct, request.payload())) {
+  if (serde_.DecodeRequest(
+          proto_struct, request.payload(), call.context().scratch_arena())) {
     return true;
   }
 
+  Channel& channel = call.channel();
   PW_LOG_WARN("Nanopb failed to decode request payload from channel %u",
               unsigned(channel.id()));
   channel.Send(Packet::ServerError(request, Status::DataLoss()));
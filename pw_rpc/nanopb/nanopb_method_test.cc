@@ -18,6 +18,7 @@
 
 #include "gtest/gtest.h"
 #include "pw_rpc/internal/nanopb_method_union.h"
+#include "pw_rpc/nanopb_arena.h"
 #include "pw_rpc/server_context.h"
 #include "pw_rpc/service.h"
 #include "pw_rpc_nanopb_private/internal_test_utils.h"
@@ -47,6 +48,8 @@ class TestNanopbService final : public Service {
                                     const FakePb&,
                                     ServerWriter<FakePb>&) {}
 
+  void DeferredUnary(ServerContext&, const FakePb&, UnaryResponder<FakePb>&) {}
+
   Status UnaryWrongArg(ServerContext&, FakePb&, FakePb&) { return Status(); }
 
   static void StaticUnaryVoidReturn(ServerContext&, const FakePb&, FakePb&) {}
@@ -76,6 +79,9 @@ static_assert(
     NanopbMethod::template matches<&TestNanopbService::StaticServerStreaming,
                                    FakePb,
                                    FakePb>());
+static_assert(NanopbMethod::template matches<&TestNanopbService::DeferredUnary,
+                                             FakePb,
+                                             FakePb>());
 
 // Test that the matches() function does not match the wrong method type.
 static_assert(!NanopbMethod::template matches<&TestNanopbService::UnaryWrongArg,
@@ -127,6 +133,7 @@ TEST(MethodImplTester, NanopbMethod) {
 
 pw_rpc_test_TestRequest last_request;
 ServerWriter<pw_rpc_test_TestResponse> last_writer;
+UnaryResponder<pw_rpc_test_TestResponse> last_responder;
 
 Status AddFive(ServerContext&,
                const pw_rpc_test_TestRequest& request,
@@ -147,17 +154,46 @@ void StartStream(ServerContext&,
   last_writer = std::move(writer);
 }
 
+void DeferAddFive(ServerContext&,
+                  const pw_rpc_test_TestRequest& request,
+                  UnaryResponder<pw_rpc_test_TestResponse>& responder) {
+  last_request = request;
+  last_responder = std::move(responder);
+}
+
+std::string_view last_data;
+std::array<std::string_view, 4> last_names;
+size_t last_name_count;
+uint32_t last_number;
+
+Status ReadArenaRequest(ServerContext&,
+                        const pw_rpc_test_TestArenaRequest& request,
+                        pw_rpc_test_Empty&) {
+  last_data = NanopbArenaField::Get(request.data).string();
+  last_name_count = 0;
+  for (ConstByteSpan name : NanopbArenaField::Get(request.names)) {
+    last_names[last_name_count++] = std::string_view(
+        reinterpret_cast<const char*>(name.data()), name.size());
+  }
+  last_number = request.number;
+  return OkStatus();
+}
+
 class FakeService : public Service {
  public:
   FakeService(uint32_t id) : Service(id, kMethods) {}
 
-  static constexpr std::array<NanopbMethodUnion, 3> kMethods = {
+  static constexpr std::array<NanopbMethodUnion, 5> kMethods = {
       NanopbMethod::Unary<DoNothing>(
           10u, pw_rpc_test_Empty_fields, pw_rpc_test_Empty_fields),
       NanopbMethod::Unary<AddFive>(
           11u, pw_rpc_test_TestRequest_fields, pw_rpc_test_TestResponse_fields),
       NanopbMethod::ServerStreaming<StartStream>(
           12u, pw_rpc_test_TestRequest_fields, pw_rpc_test_TestResponse_fields),
+      NanopbMethod::Unary<DeferAddFive>(
+          13u, pw_rpc_test_TestRequest_fields, pw_rpc_test_TestResponse_fields),
+      NanopbMethod::Unary<ReadArenaRequest>(
+          14u, pw_rpc_test_TestArenaRequest_fields, pw_rpc_test_Empty_fields),
   };
 };
 
@@ -245,16 +281,16 @@ TEST(NanopbMethod, ServerWriter_SendsResponse) {
 
   EXPECT_EQ(OkStatus(), last_writer.Write({.value = 100}));
 
+  // The payload is encoded in place, so compare the decoded packet rather than
+  // the bytes produced by Packet::Encode.
   PW_ENCODE_PB(pw_rpc_test_TestResponse, payload, .value = 100);
-  std::array<byte, 128> encoded_response = {};
-  auto encoded = context.packet(payload).Encode(encoded_response);
-  ASSERT_EQ(OkStatus(), encoded.status());
-
-  ASSERT_EQ(encoded.value().size(), context.output().sent_data().size());
+  const Packet& sent = context.output().sent_packet();
+  EXPECT_EQ(PacketType::RESPONSE, sent.type());
+  EXPECT_EQ(context.service_id(), sent.service_id());
+  EXPECT_EQ(method.id(), sent.method_id());
+  ASSERT_EQ(payload.size(), sent.payload().size());
   EXPECT_EQ(0,
-            std::memcmp(encoded.value().data(),
-                        context.output().sent_data().data(),
-                        encoded.value().size()));
+            std::memcmp(payload.data(), sent.payload().data(), payload.size()));
 }
 
 TEST(NanopbMethod, ServerWriter_WriteWhenClosed_ReturnsFailedPrecondition) {
@@ -308,5 +344,104 @@ TEST(NanopbMethod,
   EXPECT_EQ(Status::Internal(), last_writer.Write({.value = 1}));  // Too big
 }
 
+TEST(NanopbMethod, DeferredUnaryRpc_SendsResponseWhenFinished) {
+  PW_ENCODE_PB(
+      pw_rpc_test_TestRequest, request, .integer = 123, .status_code = 0);
+
+  const NanopbMethod& method =
+      std::get<3>(FakeService::kMethods).nanopb_method();
+  ServerContextForTest<FakeService> context(method);
+  method.Invoke(context.get(), context.packet(request));
+
+  EXPECT_EQ(0u, context.output().packet_count());
+  EXPECT_EQ(123, last_request.integer);
+  ASSERT_TRUE(last_responder.open());
+
+  EXPECT_EQ(OkStatus(),
+            last_responder.Finish({.value = last_request.integer + 5},
+                                  Status::Unauthenticated()));
+  EXPECT_FALSE(last_responder.open());
+
+  const Packet& response = context.output().sent_packet();
+  EXPECT_EQ(PacketType::RESPONSE, response.type());
+  EXPECT_EQ(response.status(), Status::Unauthenticated());
+
+  // Field 1 (encoded as 1 << 3) with 128 as the value.
+  constexpr std::byte expected[]{
+      std::byte{0x08}, std::byte{0x80}, std::byte{0x01}};
+
+  EXPECT_EQ(sizeof(expected), response.payload().size());
+  EXPECT_EQ(0,
+            std::memcmp(expected, response.payload().data(), sizeof(expected)));
+}
+
+TEST(NanopbMethod, DeferredUnaryRpc_InvalidPayload_SendsError) {
+  std::array<byte, 8> bad_payload{byte{0xFF}, byte{0xAA}, byte{0xDD}};
+
+  const NanopbMethod& method =
+      std::get<3>(FakeService::kMethods).nanopb_method();
+  ServerContextForTest<FakeService> context(method);
+  method.Invoke(context.get(), context.packet(bad_payload));
+
+  EXPECT_FALSE(last_responder.open());
+
+  const Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(PacketType::SERVER_ERROR, packet.type());
+  EXPECT_EQ(Status::DataLoss(), packet.status());
+}
+
+// TestArenaRequest with data "hello", names "ab" and "cde", and number 7.
+constexpr byte kArenaRequest[] = {
+    byte{0x0a}, byte{0x05}, byte{'h'}, byte{'e'}, byte{'l'}, byte{'l'},
+    byte{'o'},  byte{0x12}, byte{0x02}, byte{'a'}, byte{'b'}, byte{0x12},
+    byte{0x03}, byte{'c'},  byte{'d'}, byte{'e'}, byte{0x18}, byte{0x07},
+};
+
+TEST(NanopbMethod, ScratchArena_DecodesCallbackFields) {
+  std::array<byte, 256> buffer;
+  allocator::Arena arena(buffer);
+
+  const NanopbMethod& method =
+      std::get<4>(FakeService::kMethods).nanopb_method();
+  ServerContextForTest<FakeService> context(method);
+  context.server().set_scratch_arena(&arena);
+  method.Invoke(context.get(), context.packet(kArenaRequest));
+
+  EXPECT_EQ(OkStatus(), context.output().sent_packet().status());
+  EXPECT_EQ(last_data, "hello");
+  ASSERT_EQ(last_name_count, 2u);
+  EXPECT_EQ(last_names[0], "ab");
+  EXPECT_EQ(last_names[1], "cde");
+  EXPECT_EQ(last_number, 7u);
+  EXPECT_GT(arena.used(), 0u);
+}
+
+TEST(NanopbMethod, ScratchArena_NoArena_SkipsCallbackFields) {
+  const NanopbMethod& method =
+      std::get<4>(FakeService::kMethods).nanopb_method();
+  ServerContextForTest<FakeService> context(method);
+  method.Invoke(context.get(), context.packet(kArenaRequest));
+
+  EXPECT_EQ(OkStatus(), context.output().sent_packet().status());
+  EXPECT_TRUE(last_data.empty());
+  EXPECT_EQ(last_name_count, 0u);
+  EXPECT_EQ(last_number, 7u);
+}
+
+TEST(NanopbMethod, ScratchArena_TooSmall_SendsError) {
+  std::array<byte, 8> buffer;
+  allocator::Arena arena(buffer);
+
+  const NanopbMethod& method =
+      std::get<4>(FakeService::kMethods).nanopb_method();
+  ServerContextForTest<FakeService> context(method);
+  context.server().set_scratch_arena(&arena);
+  method.Invoke(context.get(), context.packet(kArenaRequest));
+
+  const Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(PacketType::SERVER_ERROR, packet.type());
+  EXPECT_EQ(Status::DataLoss(), packet.status());
+}
+
 }  // namespace
 }  // namespace pw::rpc::internal
@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include "pw_allocator/arena.h"
 #include "pw_bytes/span.h"
 #include "pw_status/status_with_size.h"
 
@@ -38,11 +39,17 @@ class NanopbMethodSerde {
     return Encode(response_fields_, buffer, proto_struct);
   }
 
-  bool DecodeRequest(void* proto_struct, ConstByteSpan buffer) const {
-    return Decode(request_fields_, proto_struct, buffer);
+  // Decodes a request. If an arena is provided, top-level bytes, string, and
+  // submessage fields without a size limit are decoded into it; see
+  // pw_rpc/nanopb_arena.h. Returns false if the request could not be decoded
+  // or the arena ran out of space.
+  bool DecodeRequest(void* proto_struct,
+                     ConstByteSpan buffer,
+                     allocator::Arena* arena = nullptr) const {
+    return Decode(request_fields_, proto_struct, buffer, arena);
   }
   bool DecodeResponse(void* proto_struct, ConstByteSpan buffer) const {
-    return Decode(response_fields_, proto_struct, buffer);
+    return Decode(response_fields_, proto_struct, buffer, nullptr);
   }
 
  private:
@@ -54,7 +61,8 @@ class NanopbMethodSerde {
   // Decodes a serialized protobuf to a nanopb struct.
   bool Decode(NanopbMessageDescriptor fields,
               void* proto_struct,
-              ConstByteSpan buffer) const;
+              ConstByteSpan buffer,
+              allocator::Arena* arena) const;
 
   NanopbMessageDescriptor request_fields_;
   NanopbMessageDescriptor response_fields_;
@@ -19,6 +19,7 @@
 #include <span>
 #include <type_traits>
 
+#include "pw_function/function.h"
 #include "pw_rpc/internal/config.h"
 #include "pw_rpc/internal/method.h"
 #include "pw_rpc/internal/method_type.h"
@@ -46,17 +47,137 @@ class ServerWriter : public internal::Responder {
   //   OK - the response was successfully sent
   //   FAILED_PRECONDITION - the writer is closed
   //   INTERNAL - pw_rpc was unable to encode the Nanopb protobuf
+  //   UNAVAILABLE - the call is flow controlled and out of credits
   //   other errors - the ChannelOutput failed to send the packet; the error
   //       codes are determined by the ChannelOutput implementation
   //
   Status Write(const T& response);
 };
 
+// The UnaryResponder is used by unary RPCs that defer their response. The
+// method moves the responder out of its arguments, returns, and calls Finish
+// later, for example from a worker thread. The channel's output must support
+// being used from the thread that calls Finish.
+template <typename T>
+class UnaryResponder : public internal::Responder {
+ public:
+  constexpr UnaryResponder() = default;
+
+  UnaryResponder(UnaryResponder&&) = default;
+  UnaryResponder& operator=(UnaryResponder&&) = default;
+
+  // Encodes and sends the response, completing the RPC. Returns the same Status
+  // codes as ServerReader::Finish.
+  Status Finish(const T& response, Status status = OkStatus());
+};
+
 namespace internal {
 
 class NanopbMethod;
 class Packet;
 
+// Base for the Nanopb client stream classes. Decodes each CLIENT_STREAM payload
+// into a Request struct and passes it to the user's on_next callback.
+template <typename Request>
+class BaseServerReader : public Responder {
+ public:
+  // Sets the callback invoked with each request struct received from the
+  // client. Requests that fail to decode are dropped.
+  void set_on_next(Function<void(const Request&)> on_next) {
+    on_next_ = std::move(on_next);
+    InstallOnNext();
+  }
+
+  // Sets the callback invoked when the client ends its stream.
+  void set_on_client_stream_end(Function<void()> on_client_stream_end) {
+    Responder::set_on_client_stream_end(std::move(on_client_stream_end));
+  }
+
+ protected:
+  constexpr BaseServerReader() = default;
+
+  BaseServerReader(ServerCall& call, MethodType type) : Responder(call, type) {}
+
+  BaseServerReader(BaseServerReader&& other) { *this = std::move(other); }
+
+  BaseServerReader& operator=(BaseServerReader&& other) {
+    Responder::operator=(std::move(other));
+    on_next_ = std::move(other.on_next_);
+
+    // The raw callback refers to the reader it was installed on, so it must be
+    // installed again for this object.
+    InstallOnNext();
+    return *this;
+  }
+
+  // Encodes a response struct into a payload buffer. Returns an empty span if
+  // encoding fails, in which case the buffer has been released.
+  std::span<const std::byte> EncodeResponse(const void* response);
+
+ private:
+  void InstallOnNext();
+
+  Function<void(const Request&)> on_next_;
+};
+
+// Generic wrapper for Nanopb client and bidirectional streaming RPCs.
+using StreamRequestFunction = void (*)(ServerCall&);
+
+}  // namespace internal
+
+// The ServerReader is used to receive a stream of request structs from the
+// client in a client streaming RPC. The RPC completes when Finish is called
+// with the response.
+template <typename Request, typename Response>
+class ServerReader : public internal::BaseServerReader<Request> {
+ public:
+  constexpr ServerReader() = default;
+
+  ServerReader(ServerReader&&) = default;
+  ServerReader& operator=(ServerReader&&) = default;
+
+  // Encodes and sends the response, completing the RPC. Returns the following
+  // Status codes:
+  //
+  //   OK - the response was successfully sent
+  //   FAILED_PRECONDITION - the reader is closed
+  //   INTERNAL - pw_rpc was unable to encode the Nanopb protobuf
+  //   other errors - the ChannelOutput failed to send the packet
+  //
+  Status Finish(const Response& response, Status status = OkStatus());
+
+ private:
+  friend class internal::NanopbMethod;
+
+  ServerReader(internal::ServerCall& call)
+      : internal::BaseServerReader<Request>(
+            call, internal::MethodType::kClientStreaming) {}
+};
+
+// The ServerReaderWriter is used for bidirectional streaming RPCs. Requests are
+// delivered to the on_next callback and responses are sent with Write.
+template <typename Request, typename Response>
+class ServerReaderWriter : public internal::BaseServerReader<Request> {
+ public:
+  constexpr ServerReaderWriter() = default;
+
+  ServerReaderWriter(ServerReaderWriter&&) = default;
+  ServerReaderWriter& operator=(ServerReaderWriter&&) = default;
+
+  // Writes a response struct. Returns the same Status codes as
+  // ServerWriter::Write.
+  Status Write(const Response& response);
+
+ private:
+  friend class internal::NanopbMethod;
+
+  ServerReaderWriter(internal::ServerCall& call)
+      : internal::BaseServerReader<Request>(
+            call, internal::MethodType::kBidirectionalStreaming) {}
+};
+
+namespace internal {
+
 // MethodTraits specialization for a static unary method.
 template <typename RequestType, typename ResponseType>
 struct MethodTraits<Status (*)(
@@ -101,6 +222,70 @@ struct MethodTraits<void (T::*)(
   using Service = T;
 };
 
+// MethodTraits specialization for a static unary method that defers its
+// response.
+template <typename RequestType, typename ResponseType>
+struct MethodTraits<void (*)(
+    ServerContext&, const RequestType&, UnaryResponder<ResponseType>&)> {
+  using Implementation = NanopbMethod;
+  using Request = RequestType;
+  using Response = ResponseType;
+
+  static constexpr MethodType kType = MethodType::kUnary;
+  static constexpr bool kServerStreaming = false;
+  static constexpr bool kClientStreaming = false;
+  static constexpr bool kDeferred = true;
+};
+
+// MethodTraits specialization for a unary method that defers its response.
+template <typename T, typename RequestType, typename ResponseType>
+struct MethodTraits<void (T::*)(
+    ServerContext&, const RequestType&, UnaryResponder<ResponseType>&)>
+    : public MethodTraits<void (*)(
+          ServerContext&, const RequestType&, UnaryResponder<ResponseType>&)> {
+  using Service = T;
+};
+
+template <typename RequestType, typename ResponseType>
+struct MethodTraits<void (*)(ServerContext&,
+                             ServerReader<RequestType, ResponseType>&)> {
+  using Implementation = NanopbMethod;
+  using Request = RequestType;
+  using Response = ResponseType;
+
+  static constexpr MethodType kType = MethodType::kClientStreaming;
+  static constexpr bool kServerStreaming = false;
+  static constexpr bool kClientStreaming = true;
+};
+
+template <typename T, typename RequestType, typename ResponseType>
+struct MethodTraits<void (T::*)(ServerContext&,
+                                ServerReader<RequestType, ResponseType>&)>
+    : public MethodTraits<void (*)(ServerContext&,
+                                   ServerReader<RequestType, ResponseType>&)> {
+  using Service = T;
+};
+
+template <typename RequestType, typename ResponseType>
+struct MethodTraits<void (*)(ServerContext&,
+                             ServerReaderWriter<RequestType, ResponseType>&)> {
+  using Implementation = NanopbMethod;
+  using Request = RequestType;
+  using Response = ResponseType;
+
+  static constexpr MethodType kType = MethodType::kBidirectionalStreaming;
+  static constexpr bool kServerStreaming = true;
+  static constexpr bool kClientStreaming = true;
+};
+
+template <typename T, typename RequestType, typename ResponseType>
+struct MethodTraits<void (T::*)(
+    ServerContext&, ServerReaderWriter<RequestType, ResponseType>&)>
+    : public MethodTraits<void (*)(
+          ServerContext&, ServerReaderWriter<RequestType, ResponseType>&)> {
+  using Service = T;
+};
+
 template <auto method>
 using Request = typename MethodTraits<decltype(method)>::Request;
 
@@ -137,19 +322,37 @@ class NanopbMethod : public Method {
     //
     // In optimized builds, the compiler inlines the user-defined function into
     // this wrapper, elminating any overhead.
-    constexpr UnaryFunction wrapper =
-        [](ServerCall& call, const void* req, void* resp) {
-          return CallMethodImplFunction<method>(
-              call,
-              *static_cast<const Request<method>*>(req),
-              *static_cast<Response<method>*>(resp));
-        };
-    return NanopbMethod(id,
-                        UnaryInvoker<AllocateSpaceFor<Request<method>>(),
-                                     AllocateSpaceFor<Response<method>>()>,
-                        Function{.unary = wrapper},
-                        request,
-                        response);
+    if constexpr (kDefersResponse<method>) {
+      // Deferred methods respond through a UnaryResponder, so no response
+      // struct is allocated.
+      constexpr ResponderFunction wrapper =
+          [](ServerCall& call, const void* req, Responder& responder) {
+            CallMethodImplFunction<method>(
+                call,
+                *static_cast<const Request<method>*>(req),
+                static_cast<UnaryResponder<Response<method>>&>(responder));
+          };
+      return NanopbMethod(
+          id,
+          DeferredUnaryInvoker<AllocateSpaceFor<Request<method>>()>,
+          Function{.deferred_unary = wrapper},
+          request,
+          response);
+    } else {
+      constexpr UnaryFunction wrapper =
+          [](ServerCall& call, const void* req, void* resp) {
+            return CallMethodImplFunction<method>(
+                call,
+                *static_cast<const Request<method>*>(req),
+                *static_cast<Response<method>*>(resp));
+          };
+      return NanopbMethod(id,
+                          UnaryInvoker<AllocateSpaceFor<Request<method>>(),
+                                       AllocateSpaceFor<Response<method>>()>,
+                          Function{.unary = wrapper},
+                          request,
+                          response);
+    }
   }
 
   // Creates a NanopbMethod for a server-streaming RPC.
@@ -162,7 +365,7 @@ class NanopbMethod : public Method {
     // struct as void* and a Responder instead of the templated ServerWriter
     // class. This wrapper is stored generically in the Function union, defined
     // below.
-    constexpr ServerStreamingFunction wrapper =
+    constexpr ResponderFunction wrapper =
         [](ServerCall& call, const void* req, Responder& writer) {
           return CallMethodImplFunction<method>(
               call,
@@ -177,6 +380,41 @@ class NanopbMethod : public Method {
         response);
   }
 
+  // Creates a NanopbMethod for a client-streaming RPC. Requests arrive through
+  // the ServerReader's on_next callback rather than the REQUEST packet.
+  template <auto method>
+  static constexpr NanopbMethod ClientStreaming(
+      uint32_t id,
+      NanopbMessageDescriptor request,
+      NanopbMessageDescriptor response) {
+    constexpr StreamRequestFunction wrapper = [](ServerCall& call) {
+      ServerReader<Request<method>, Response<method>> reader(call);
+      CallMethodImplFunction<method>(call, reader);
+    };
+    return NanopbMethod(id,
+                        StreamRequestInvoker,
+                        Function{.stream_request = wrapper},
+                        request,
+                        response);
+  }
+
+  // Creates a NanopbMethod for a bidirectional-streaming RPC.
+  template <auto method>
+  static constexpr NanopbMethod BidirectionalStreaming(
+      uint32_t id,
+      NanopbMessageDescriptor request,
+      NanopbMessageDescriptor response) {
+    constexpr StreamRequestFunction wrapper = [](ServerCall& call) {
+      ServerReaderWriter<Request<method>, Response<method>> reader_writer(call);
+      CallMethodImplFunction<method>(call, reader_writer);
+    };
+    return NanopbMethod(id,
+                        StreamRequestInvoker,
+                        Function{.stream_request = wrapper},
+                        request,
+                        response);
+  }
+
   // Represents an invalid method. Used to reduce error message verbosity.
   static constexpr NanopbMethod Invalid() {
     return {0, InvalidInvoker, {}, nullptr, nullptr};
@@ -195,6 +433,13 @@ class NanopbMethod : public Method {
     return serde_.DecodeResponse(proto_struct, response);
   }
 
+  // Decodes a request protobuf with Nanopb to the provided buffer. Used for
+  // requests received in CLIENT_STREAM packets.
+  bool DecodeRequest(std::span<const std::byte> request,
+                     void* proto_struct) const {
+    return serde_.DecodeRequest(proto_struct, request);
+  }
+
  private:
   // Generic version of the unary RPC function signature:
   //
@@ -204,21 +449,24 @@ class NanopbMethod : public Method {
                                    const void* request,
                                    void* response);
 
-  // Generic version of the server streaming RPC function signature:
+  // Generic version of the server streaming and deferred unary RPC function
+  // signatures:
   //
-  //   Status(ServerCall&, const Request&, ServerWriter<Response>&)
+  //   void(ServerCall&, const Request&, ServerWriter<Response>&)
+  //   void(ServerCall&, const Request&, UnaryResponder<Response>&)
   //
-  using ServerStreamingFunction = void (*)(ServerCall&,
-                                           const void* request,
-                                           Responder& writer);
+  using ResponderFunction = void (*)(ServerCall&,
+                                     const void* request,
+                                     Responder& responder);
 
   // The Function union stores a pointer to a generic version of the
   // user-defined RPC function. Using a union instead of void* avoids
   // reinterpret_cast, which keeps this class fully constexpr.
   union Function {
     UnaryFunction unary;
-    ServerStreamingFunction server_streaming;
-    // TODO(hepler): Add client_streaming and bidi_streaming
+    ResponderFunction deferred_unary;
+    ResponderFunction server_streaming;
+    StreamRequestFunction stream_request;
   };
 
   // Allocates space for a struct. Rounds up to a reasonable minimum size to
@@ -240,11 +488,21 @@ class NanopbMethod : public Method {
                  void* request_struct,
                  void* response_struct) const;
 
+  void CallDeferredUnary(ServerCall& call,
+                         const Packet& request,
+                         void* request_struct) const;
+
   void CallServerStreaming(ServerCall& call,
                            const Packet& request,
                            void* request_struct) const;
 
-  // TODO(hepler): Add CallClientStreaming and CallBidiStreaming
+  // Invoker function for client and bidirectional streaming RPCs. The REQUEST
+  // packet has no payload, so no request struct is allocated here.
+  static void StreamRequestInvoker(const Method& method,
+                                   ServerCall& call,
+                                   const Packet&) {
+    static_cast<const NanopbMethod&>(method).function_.stream_request(call);
+  }
 
   // Invoker function for unary RPCs. Allocates request and response structs by
   // size, with maximum alignment, to avoid generating unnecessary copies of
@@ -264,6 +522,20 @@ class NanopbMethod : public Method {
         call, request, &request_struct, &response_struct);
   }
 
+  // Invoker function for unary RPCs that respond through a UnaryResponder.
+  // Allocates space for a request struct only.
+  template <size_t kRequestSize>
+  static void DeferredUnaryInvoker(const Method& method,
+                                   ServerCall& call,
+                                   const Packet& request) {
+    _PW_RPC_NANOPB_STRUCT_STORAGE_CLASS
+    std::aligned_storage_t<kRequestSize, alignof(std::max_align_t)>
+        request_struct{};
+
+    static_cast<const NanopbMethod&>(method).CallDeferredUnary(
+        call, request, &request_struct);
+  }
+
   // Invoker function for server streaming RPCs. Allocates space for a request
   // struct. Ignores the payload buffer since resposnes are sent through the
   // ServerWriter.
@@ -279,9 +551,10 @@ class NanopbMethod : public Method {
         call, request, &request_struct);
   }
 
-  // Decodes a request protobuf with Nanopb to the provided buffer. Sends an
-  // error packet if the request failed to decode.
-  bool DecodeRequest(Channel& channel,
+  // Decodes a request protobuf with Nanopb to the provided buffer, using the
+  // server's scratch arena for callback fields if it has one. Sends an error
+  // packet if the request failed to decode.
+  bool DecodeRequest(ServerCall& call,
                      const Packet& request,
                      void* proto_struct) const;
 
@@ -319,4 +592,89 @@ Status ServerWriter<T>::Write(const T& response) {
   return Status::Internal();
 }
 
+namespace internal {
+
+template <typename Request>
+void BaseServerReader<Request>::InstallOnNext() {
+  if (!on_next_) {
+    Responder::set_on_next(nullptr);
+    return;
+  }
+
+  Responder::set_on_next([this](std::span<const std::byte> payload) {
+    Request request{};
+    if (static_cast<const NanopbMethod&>(this->method())
+            .DecodeRequest(payload, &request)) {
+      on_next_(request);
+    }
+  });
+}
+
+template <typename Request>
+std::span<const std::byte> BaseServerReader<Request>::EncodeResponse(
+    const void* response) {
+  std::span<std::byte> buffer = this->AcquirePayloadBuffer();
+
+  if (auto result = static_cast<const NanopbMethod&>(this->method())
+                        .EncodeResponse(response, buffer);
+      result.ok()) {
+    return buffer.first(result.size());
+  }
+
+  this->ReleasePayloadBuffer();
+  return {};
+}
+
+}  // namespace internal
+
+template <typename Request, typename Response>
+Status ServerReader<Request, Response>::Finish(const Response& response,
+                                               Status status) {
+  if (!this->open()) {
+    return Status::FailedPrecondition();
+  }
+
+  std::span<const std::byte> payload = this->EncodeResponse(&response);
+  if (this->buffer().empty()) {
+    this->CloseAndSendResponse({}, Status::Internal());
+    return Status::Internal();
+  }
+
+  return this->CloseAndSendResponse(payload, status);
+}
+
+template <typename T>
+Status UnaryResponder<T>::Finish(const T& response, Status status) {
+  if (!open()) {
+    return Status::FailedPrecondition();
+  }
+
+  std::span<std::byte> buffer = AcquirePayloadBuffer();
+
+  if (auto result =
+          static_cast<const internal::NanopbMethod&>(method()).EncodeResponse(
+              &response, buffer);
+      result.ok()) {
+    return CloseAndSendResponse(buffer.first(result.size()), status);
+  }
+
+  ReleasePayloadBuffer();
+  CloseAndSendResponse({}, Status::Internal());
+  return Status::Internal();
+}
+
+template <typename Request, typename Response>
+Status ServerReaderWriter<Request, Response>::Write(const Response& response) {
+  if (!this->open()) {
+    return Status::FailedPrecondition();
+  }
+
+  std::span<const std::byte> payload = this->EncodeResponse(&response);
+  if (this->buffer().empty()) {
+    return Status::Internal();
+  }
+
+  return this->ReleasePayloadBuffer(payload);
+}
+
 }  // namespace pw::rpc
@@ -0,0 +1,138 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+
+#include "pb.h"
+#include "pw_allocator/arena.h"
+#include "pw_bytes/span.h"
+
+namespace pw::rpc {
+namespace internal {
+
+// One occurrence of a field that was decoded into the scratch arena.
+struct NanopbArenaEntry {
+  NanopbArenaEntry* next;
+  ConstByteSpan data;
+};
+
+// The occurrences of a field, in the order they were decoded. Stored as the
+// arg of the field's pb_callback_t.
+struct NanopbArenaList {
+  allocator::Arena* arena;
+  NanopbArenaEntry* first;
+  NanopbArenaEntry* last;
+  size_t count;
+};
+
+// Returns the decoded occurrences of a callback field, or nullptr if the field
+// was not decoded into an arena.
+const NanopbArenaList* GetNanopbArenaList(const pb_callback_t& field);
+
+}  // namespace internal
+
+// A read-only view of a Nanopb callback field (bytes, string, or submessage)
+// that was decoded into the server's scratch arena. Each occurrence of the
+// field is one entry, so a repeated field has an entry per element and a
+// singular field that occurs more than once uses the last one.
+//
+//   Status Handle(ServerContext&, const MyRequest& request, MyResponse&) {
+//     for (ConstByteSpan name : NanopbArenaField::Get(request.names)) {
+//       ...
+//     }
+//     std::string_view label = NanopbArenaField::Get(request.label).string();
+//
+// The memory belongs to the arena and is released when the RPC function
+// returns, so the data must not be used after that.
+class NanopbArenaField {
+ public:
+  class iterator {
+   public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = ConstByteSpan;
+    using pointer = const ConstByteSpan*;
+    using reference = const ConstByteSpan&;
+    using iterator_category = std::forward_iterator_tag;
+
+    constexpr iterator() : entry_(nullptr) {}
+
+    iterator& operator++() {
+      entry_ = entry_->next;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator original = *this;
+      ++*this;
+      return original;
+    }
+
+    reference operator*() const { return entry_->data; }
+    pointer operator->() const { return &entry_->data; }
+
+    constexpr bool operator==(const iterator& rhs) const {
+      return entry_ == rhs.entry_;
+    }
+    constexpr bool operator!=(const iterator& rhs) const {
+      return entry_ != rhs.entry_;
+    }
+
+   private:
+    friend class NanopbArenaField;
+
+    constexpr iterator(const internal::NanopbArenaEntry* entry)
+        : entry_(entry) {}
+
+    const internal::NanopbArenaEntry* entry_;
+  };
+
+  // Returns a view of the field. The view is empty if the field did not occur
+  // in the request or was not decoded into an arena.
+  static NanopbArenaField Get(const pb_callback_t& field) {
+    return NanopbArenaField(internal::GetNanopbArenaList(field));
+  }
+
+  // The number of times the field occurred.
+  size_t size() const { return list_ == nullptr ? 0 : list_->count; }
+  bool empty() const { return size() == 0u; }
+
+  iterator begin() const {
+    return iterator(list_ == nullptr ? nullptr : list_->first);
+  }
+  iterator end() const { return iterator(); }
+
+  // The last occurrence of the field, which is the value of a singular field.
+  // Empty if the field did not occur.
+  ConstByteSpan back() const {
+    return empty() ? ConstByteSpan() : list_->last->data;
+  }
+
+  // The value of a singular string or bytes field as a string_view.
+  std::string_view string() const {
+    const ConstByteSpan value = back();
+    return std::string_view(reinterpret_cast<const char*>(value.data()),
+                            value.size());
+  }
+
+ private:
+  constexpr NanopbArenaField(const internal::NanopbArenaList* list)
+      : list_(list) {}
+
+  const internal::NanopbArenaList* list_;
+};
+
+}  // namespace pw::rpc
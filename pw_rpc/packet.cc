@@ -14,13 +14,175 @@
 
 #include "pw_rpc/internal/packet.h"
 
+#include <limits>
+
+#include "pw_assert/assert.h"
 #include "pw_protobuf/decoder.h"
+#include "pw_protobuf/wire_format.h"
+#include "pw_varint/varint.h"
 
 namespace pw::rpc::internal {
 
 using std::byte;
 
+namespace {
+
+// Writes a varint padded with continuation bytes to exactly size bytes. Padded
+// varints are valid protobuf encodings and decode to the same value. The value
+// must fit in size * 7 bits.
+byte* WritePaddedVarint(uint64_t value, size_t size, byte* out) {
+  return out + varint::EncodePadded(value, std::span(out, size));
+}
+
+byte* WriteFixed32(uint32_t value, byte* out) {
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    *out++ = static_cast<byte>(value >> (8 * i));
+  }
+  return out;
+}
+
+// All packet field numbers encode to single-byte keys.
+constexpr byte Key(RpcPacket::Fields field, protobuf::WireType type) {
+  return static_cast<byte>(
+      protobuf::MakeKey(static_cast<uint32_t>(field), type));
+}
+
+constexpr byte kTypeKey =
+    Key(RpcPacket::Fields::TYPE, protobuf::WireType::kVarint);
+constexpr byte kChannelIdKey =
+    Key(RpcPacket::Fields::CHANNEL_ID, protobuf::WireType::kVarint);
+constexpr byte kServiceIdKey =
+    Key(RpcPacket::Fields::SERVICE_ID, protobuf::WireType::kFixed32);
+constexpr byte kMethodIdKey =
+    Key(RpcPacket::Fields::METHOD_ID, protobuf::WireType::kFixed32);
+constexpr byte kStatusKey =
+    Key(RpcPacket::Fields::STATUS, protobuf::WireType::kVarint);
+constexpr byte kPayloadKey =
+    Key(RpcPacket::Fields::PAYLOAD, protobuf::WireType::kDelimited);
+
+// Reads the fields of a packet that is expected to be in a fixed layout. Each
+// read fails if the next field is not the expected one, in which case the
+// packet is parsed with the generic decoder instead.
+class FixedLayoutReader {
+ public:
+  constexpr FixedLayoutReader(ConstByteSpan data)
+      : pos_(data.data()), end_(data.data() + data.size()) {}
+
+  bool done() const { return pos_ == end_; }
+
+  bool NextKeyIs(byte key) const { return pos_ != end_ && *pos_ == key; }
+
+  bool ReadVarint(byte key, uint32_t& value) {
+    return ReadKey(key) && ReadVarintValue(value);
+  }
+
+  bool ReadFixed32(byte key, uint32_t& value) {
+    if (!ReadKey(key) || end_ - pos_ < 4) {
+      return false;
+    }
+    value = static_cast<uint32_t>(pos_[0]) |
+            static_cast<uint32_t>(pos_[1]) << 8 |
+            static_cast<uint32_t>(pos_[2]) << 16 |
+            static_cast<uint32_t>(pos_[3]) << 24;
+    pos_ += 4;
+    return true;
+  }
+
+  bool ReadPayload(ConstByteSpan& payload) {
+    uint32_t size;
+    if (!ReadKey(kPayloadKey) || !ReadVarintValue(size) ||
+        size > static_cast<size_t>(end_ - pos_)) {
+      return false;
+    }
+    payload = ConstByteSpan(pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+ private:
+  bool ReadKey(byte key) {
+    if (!NextKeyIs(key)) {
+      return false;
+    }
+    pos_ += 1;
+    return true;
+  }
+
+  bool ReadVarintValue(uint32_t& value) {
+    // Most packet varints are a single byte.
+    if (pos_ != end_ && (*pos_ & byte{0x80}) == byte{0}) {
+      value = static_cast<uint32_t>(*pos_++);
+      return true;
+    }
+
+    uint64_t decoded;
+    const size_t bytes =
+        varint::Decode(ConstByteSpan(pos_, end_ - pos_), &decoded);
+    if (bytes == 0u || decoded > std::numeric_limits<uint32_t>::max()) {
+      return false;
+    }
+    value = static_cast<uint32_t>(decoded);
+    pos_ += bytes;
+    return true;
+  }
+
+  const byte* pos_;
+  const byte* const end_;
+};
+
+// Decodes a packet with its fields in the order that Encode() writes them, with
+// the payload first, or the order that EncodeInPlace() writes them, with the
+// payload last. Returns false if the packet has any other layout.
+bool DecodeFixedLayout(ConstByteSpan data, Packet& packet) {
+  FixedLayoutReader reader(data);
+
+  ConstByteSpan payload;
+  const bool payload_first = reader.NextKeyIs(kPayloadKey);
+  if (payload_first && !reader.ReadPayload(payload)) {
+    return false;
+  }
+
+  uint32_t type;
+  uint32_t channel_id;
+  uint32_t service_id;
+  uint32_t method_id;
+  uint32_t status;
+
+  if (!reader.ReadVarint(kTypeKey, type) ||
+      !reader.ReadVarint(kChannelIdKey, channel_id) ||
+      !reader.ReadFixed32(kServiceIdKey, service_id) ||
+      !reader.ReadFixed32(kMethodIdKey, method_id) ||
+      !reader.ReadVarint(kStatusKey, status)) {
+    return false;
+  }
+
+  if (!payload_first && !reader.ReadPayload(payload)) {
+    return false;
+  }
+
+  if (!reader.done()) {
+    return false;
+  }
+
+  packet = Packet(static_cast<PacketType>(type),
+                  channel_id,
+                  service_id,
+                  method_id,
+                  payload,
+                  static_cast<Status::Code>(status));
+  return true;
+}
+
+}  // namespace
+
 Result<Packet> Packet::FromBuffer(ConstByteSpan data) {
+  if (Packet packet; DecodeFixedLayout(data, packet)) {
+    return packet;
+  }
+  return FromBufferGeneric(data);
+}
+
+Result<Packet> Packet::FromBufferGeneric(ConstByteSpan data) {
   Packet packet;
   Status status;
   protobuf::Decoder decoder(data);
@@ -32,8 +194,9 @@ Result<Packet> Packet::FromBuffer(ConstByteSpan data) {
     switch (field) {
       case RpcPacket::Fields::TYPE: {
         uint32_t value;
-        decoder.ReadUint32(&value);
-        packet.set_type(static_cast<PacketType>(value));
+        if (decoder.ReadUint32(&value).ok()) {
+          packet.set_type(static_cast<PacketType>(value));
+        }
         break;
       }
 
@@ -55,8 +218,9 @@ Result<Packet> Packet::FromBuffer(ConstByteSpan data) {
 
       case RpcPacket::Fields::STATUS: {
         uint32_t value;
-        decoder.ReadUint32(&value);
-        packet.set_status(static_cast<Status::Code>(value));
+        if (decoder.ReadUint32(&value).ok()) {
+          packet.set_status(static_cast<Status::Code>(value));
+        }
         break;
       }
     }
@@ -105,4 +269,56 @@ size_t Packet::MinEncodedSizeBytes() const {
   return reserved_size;
 }
 
+size_t Packet::BufferSizeBytesForPayload(size_t payload_size_bytes) const {
+  // EncodeInPlace() reserves the payload length for the size of the whole
+  // buffer, so find the smallest buffer for which that still fits. Encode()
+  // never needs more.
+  const size_t header_size = MinEncodedSizeBytes() - 1;
+  size_t size = header_size + 1 + payload_size_bytes;
+  while (header_size + varint::EncodedSize(size) + payload_size_bytes > size) {
+    size += 1;
+  }
+  return size;
+}
+
+size_t Packet::PayloadOffset(size_t buffer_size) const {
+  // MinEncodedSizeBytes() reserves one byte for the payload length. Reserve
+  // enough for the largest payload the buffer can hold instead.
+  return MinEncodedSizeBytes() - 1 + varint::EncodedSize(buffer_size);
+}
+
+bool Packet::PayloadIsInPlace(ConstByteSpan buffer) const {
+  const size_t offset = PayloadOffset(buffer.size());
+  return offset <= buffer.size() &&
+         payload_.data() == buffer.data() + offset &&
+         payload_.size() <= buffer.size() - offset;
+}
+
+Result<ConstByteSpan> Packet::EncodeInPlace(ByteSpan buffer) const {
+  if (!PayloadIsInPlace(buffer)) {
+    return Status::InvalidArgument();
+  }
+
+  // Packet types and status codes always encode to a single byte, which is
+  // what MinEncodedSizeBytes() reserves for them.
+  byte* out = buffer.data();
+  *out++ = kTypeKey;
+  out = WritePaddedVarint(static_cast<uint32_t>(type_), 1, out);
+  *out++ = kChannelIdKey;
+  out = WritePaddedVarint(channel_id_, varint::EncodedSize(channel_id_), out);
+  *out++ = kServiceIdKey;
+  out = WriteFixed32(service_id_, out);
+  *out++ = kMethodIdKey;
+  out = WriteFixed32(method_id_, out);
+  *out++ = kStatusKey;
+  out = WritePaddedVarint(status_.code(), 1, out);
+  *out++ = kPayloadKey;
+  out = WritePaddedVarint(
+      payload_.size(), varint::EncodedSize(buffer.size()), out);
+
+  PW_DASSERT(out == payload_.data());
+  return ConstByteSpan(buffer.data(),
+                       PayloadOffset(buffer.size()) + payload_.size());
+}
+
 }  // namespace pw::rpc::internal
@@ -0,0 +1,168 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/packet_scheduler.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "pw_assert/assert.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_result/result.h"
+
+namespace pw::rpc::internal {
+
+BasePacketScheduler::BasePacketScheduler(
+    std::span<const PacketPriority> priorities,
+    uint8_t default_priority,
+    size_t queue_depth,
+    size_t packet_size,
+    std::span<Queue> queues,
+    std::span<QueuedPacket> packets,
+    ByteSpan buffers)
+    : priorities_(priorities),
+      default_priority_(default_priority),
+      queue_depth_(queue_depth),
+      packet_size_(packet_size),
+      queues_(queues),
+      packets_(packets),
+      buffers_(buffers) {
+  PW_ASSERT(default_priority < queues.size());
+  PW_ASSERT(packets.size() == queues.size() * queue_depth);
+  PW_ASSERT(buffers.size() == packets.size() * packet_size);
+
+  for (const PacketPriority& priority : priorities) {
+    PW_ASSERT(priority.priority() < queues.size());
+  }
+
+  std::fill(queues.begin(), queues.end(), Queue{0, 0});
+}
+
+uint8_t BasePacketScheduler::PriorityFor(uint32_t channel_id,
+                                         uint32_t service_id) const {
+  for (const PacketPriority& priority : priorities_) {
+    if (priority.Matches(channel_id, service_id)) {
+      return priority.priority();
+    }
+  }
+  return default_priority_;
+}
+
+Status BasePacketScheduler::Enqueue(ConstByteSpan packet,
+                                    ChannelOutput& interface) {
+  Result<Packet> decoded = Packet::FromBuffer(packet);
+  if (!decoded.ok()) {
+    return Status::DataLoss();
+  }
+
+  if (packet.size() > packet_size_) {
+    return Status::ResourceExhausted();
+  }
+
+  const uint8_t priority =
+      PriorityFor(decoded.value().channel_id(), decoded.value().service_id());
+
+  Result<size_t> index = Reserve(priority);
+  if (!index.ok()) {
+    return index.status();
+  }
+
+  // The slot is reserved, so the packet is copied without holding the lock.
+  std::copy(packet.begin(), packet.end(), buffer(index.value()).begin());
+  Commit(index.value(), interface, packet.size());
+  return OkStatus();
+}
+
+Result<size_t> BasePacketScheduler::Reserve(uint8_t priority) {
+  std::lock_guard lock(lock_);
+  Queue& queue = queues_[priority];
+  if (queue.count == queue_depth_) {
+    return Status::ResourceExhausted();
+  }
+  const size_t index = slot(priority, queue.head + queue.count);
+  packets_[index] = {nullptr, kFilling};
+  queue.count += 1;
+  return index;
+}
+
+void BasePacketScheduler::Commit(size_t index,
+                                 ChannelOutput& interface,
+                                 size_t size) {
+  std::lock_guard lock(lock_);
+  packets_[index] = {&interface, size};
+}
+
+StatusWithSize BasePacketScheduler::Drain(rpc::Server& server,
+                                          size_t max_packets) {
+  Status status;
+  size_t processed = 0;
+
+  for (size_t i = 0; i < max_packets; ++i) {
+    size_t priority = 0;
+    size_t index;
+    QueuedPacket queued;
+    {
+      std::lock_guard lock(lock_);
+      while (priority < queues_.size() && queues_[priority].count == 0u) {
+        priority += 1;
+      }
+      if (priority == queues_.size()) {
+        break;
+      }
+      index = slot(static_cast<uint8_t>(priority), queues_[priority].head);
+      queued = packets_[index];
+    }
+
+    // Stop at a packet that is still being copied in, rather than process
+    // lower priority packets ahead of it. Its sender signals the draining
+    // thread after Enqueue() returns, as for any other packet.
+    if (queued.size == kFilling) {
+      break;
+    }
+
+    // The packet stays counted in its queue while it is processed, so
+    // Enqueue() does not overwrite it.
+    const Status result = server.ProcessPacket(buffer(index).first(queued.size),
+                                               *queued.interface);
+
+    if (result.ok()) {
+      processed += 1;
+    } else if (status.ok()) {
+      status = result;
+    }
+
+    std::lock_guard lock(lock_);
+    Queue& queue = queues_[priority];
+    queue.head = (queue.head + 1) % queue_depth_;
+    queue.count -= 1;
+  }
+
+  return StatusWithSize(status, processed);
+}
+
+size_t BasePacketScheduler::queued_packets() const {
+  std::lock_guard lock(lock_);
+  size_t total = 0;
+  for (const Queue& queue : queues_) {
+    total += queue.count;
+  }
+  return total;
+}
+
+size_t BasePacketScheduler::queued_packets(uint8_t priority) const {
+  std::lock_guard lock(lock_);
+  return queues_[priority].count;
+}
+
+}  // namespace pw::rpc::internal
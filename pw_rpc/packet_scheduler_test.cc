@@ -0,0 +1,329 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/packet_scheduler.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include "gtest/gtest.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_rpc/internal/test_method.h"
+#include "pw_rpc/server.h"
+#include "pw_rpc/server_observer.h"
+#include "pw_rpc/service.h"
+#include "pw_rpc_private/internal_test_utils.h"
+
+namespace pw::rpc {
+namespace internal {
+
+// Enqueues a packet one step at a time, so that tests can interleave other
+// calls between reserving a slot and filling it.
+class PacketSchedulerTester {
+ public:
+  static Result<size_t> Reserve(BasePacketScheduler& scheduler,
+                                uint8_t priority) {
+    return scheduler.Reserve(priority);
+  }
+
+  static void Fill(BasePacketScheduler& scheduler,
+                   size_t index,
+                   ConstByteSpan packet,
+                   ChannelOutput& interface) {
+    std::copy(packet.begin(), packet.end(), scheduler.buffer(index).begin());
+    scheduler.Commit(index, interface, packet.size());
+  }
+};
+
+}  // namespace internal
+
+namespace {
+
+using internal::Packet;
+using internal::PacketSchedulerTester;
+using internal::PacketType;
+using internal::TestMethod;
+using internal::TestMethodUnion;
+
+constexpr uint32_t kControlServiceId = 1;
+constexpr uint32_t kLogServiceId = 2;
+
+constexpr uint32_t kControlChannel = 1;
+constexpr uint32_t kLogChannel = 2;
+
+class TestService : public Service {
+ public:
+  TestService(uint32_t service_id)
+      : Service(service_id, methods_), methods_{TestMethod(100)} {}
+
+ private:
+  std::array<TestMethodUnion, 1> methods_;
+};
+
+// Records the order in which methods are invoked. The method ID of each packet
+// is used as a sequence number.
+class InvocationRecorder : public ServerObserver {
+ public:
+  void InvocationStarted(uint32_t service_id, uint32_t) override {
+    if (count_ < services_.size()) {
+      services_[count_] = service_id;
+    }
+    count_ += 1;
+    if (on_invocation_ != nullptr) {
+      on_invocation_();
+      on_invocation_ = nullptr;
+    }
+  }
+
+  size_t count() const { return count_; }
+  uint32_t service(size_t index) const { return services_[index]; }
+
+  void set_on_invocation(void (*on_invocation)()) {
+    on_invocation_ = on_invocation;
+  }
+
+ private:
+  std::array<uint32_t, 16> services_ = {};
+  size_t count_ = 0;
+  void (*on_invocation_)() = nullptr;
+};
+
+constexpr PacketPriority kPriorities[] = {
+    PacketPriority::ForService(kControlServiceId, 0),
+    PacketPriority::ForChannel(kLogChannel, 2),
+};
+
+class PacketSchedulerTest : public ::testing::Test {
+ public:
+  // Encodes and enqueues a REQUEST packet. Public so that it can be called
+  // while the scheduler is draining.
+  Status Enqueue(uint32_t channel_id, uint32_t service_id) {
+    return scheduler_.Enqueue(Encode(channel_id, service_id), output_);
+  }
+
+ protected:
+  PacketSchedulerTest()
+      : channels_{Channel::Create<kControlChannel>(&output_),
+                  Channel::Create<kLogChannel>(&output_)},
+        server_(channels_),
+        control_service_(kControlServiceId),
+        log_service_(kLogServiceId),
+        scheduler_(kPriorities, 1) {
+    server_.RegisterService(control_service_);
+    server_.RegisterService(log_service_);
+    server_.set_observer(&recorder_);
+  }
+
+  ConstByteSpan Encode(uint32_t channel_id, uint32_t service_id) {
+    ByteSpan buffer = packet_buffers_[next_buffer_++ % packet_buffers_.size()];
+    auto result =
+        Packet(PacketType::REQUEST, channel_id, service_id, 100).Encode(buffer);
+    EXPECT_EQ(OkStatus(), result.status());
+    return result.value_or(ConstByteSpan());
+  }
+
+  // Drains the scheduler, expecting every packet to succeed. Returns the
+  // number of packets processed.
+  size_t Drain(size_t max_packets = std::numeric_limits<size_t>::max()) {
+    const StatusWithSize result = scheduler_.Drain(server_, max_packets);
+    EXPECT_EQ(OkStatus(), result.status());
+    return result.size();
+  }
+
+  TestOutput<128> output_;
+  std::array<Channel, 2> channels_;
+  Server server_;
+  TestService control_service_;
+  TestService log_service_;
+  InvocationRecorder recorder_;
+
+  PacketScheduler<3, 2, 32> scheduler_;
+
+ private:
+  std::array<std::array<std::byte, 32>, 4> packet_buffers_;
+  size_t next_buffer_ = 0;
+};
+
+TEST_F(PacketSchedulerTest, PriorityFor_FirstMatchOrDefault) {
+  EXPECT_EQ(scheduler_.PriorityFor(kControlChannel, kControlServiceId), 0u);
+  EXPECT_EQ(scheduler_.PriorityFor(kLogChannel, kControlServiceId), 0u);
+  EXPECT_EQ(scheduler_.PriorityFor(kLogChannel, kLogServiceId), 2u);
+  EXPECT_EQ(scheduler_.PriorityFor(kControlChannel, kLogServiceId), 1u);
+}
+
+TEST(PacketScheduler, DefaultPriority_IsLowest) {
+  PacketScheduler<4, 1, 16> scheduler({});
+  EXPECT_EQ(scheduler.PriorityFor(1, 2), 3u);
+}
+
+TEST_F(PacketSchedulerTest, Enqueue_DoesNotProcessPacket) {
+  ASSERT_EQ(OkStatus(), Enqueue(kControlChannel, kControlServiceId));
+
+  EXPECT_EQ(recorder_.count(), 0u);
+  EXPECT_EQ(scheduler_.queued_packets(), 1u);
+  EXPECT_EQ(scheduler_.queued_packets(0), 1u);
+}
+
+TEST_F(PacketSchedulerTest, Enqueue_CopiesPacket) {
+  std::array<std::byte, 32> buffer;
+  auto result =
+      Packet(PacketType::REQUEST, kControlChannel, kControlServiceId, 100)
+          .Encode(buffer);
+  ASSERT_EQ(OkStatus(), scheduler_.Enqueue(result.value(), output_));
+  buffer.fill(std::byte{0});
+
+  EXPECT_EQ(1u, Drain());
+  ASSERT_EQ(recorder_.count(), 1u);
+  EXPECT_EQ(recorder_.service(0), kControlServiceId);
+}
+
+TEST_F(PacketSchedulerTest, Drain_ProcessesHighestPriorityFirst) {
+  ASSERT_EQ(OkStatus(), Enqueue(kLogChannel, kLogServiceId));
+  ASSERT_EQ(OkStatus(), Enqueue(kControlChannel, kLogServiceId));
+  ASSERT_EQ(OkStatus(), Enqueue(kLogChannel, kLogServiceId));
+  ASSERT_EQ(OkStatus(), Enqueue(kLogChannel, kControlServiceId));
+
+  EXPECT_EQ(4u, Drain());
+  EXPECT_EQ(scheduler_.queued_packets(), 0u);
+
+  ASSERT_EQ(recorder_.count(), 4u);
+  EXPECT_EQ(recorder_.service(0), kControlServiceId);  // priority 0
+  EXPECT_EQ(recorder_.service(1), kLogServiceId);      // priority 1
+  EXPECT_EQ(recorder_.service(2), kLogServiceId);      // priority 2
+  EXPECT_EQ(recorder_.service(3), kLogServiceId);      // priority 2
+}
+
+TEST_F(PacketSchedulerTest, Drain_MaxPackets_LeavesRestQueued) {
+  ASSERT_EQ(OkStatus(), Enqueue(kLogChannel, kLogServiceId));
+  ASSERT_EQ(OkStatus(), Enqueue(kControlChannel, kControlServiceId));
+
+  EXPECT_EQ(1u, Drain(1));
+  ASSERT_EQ(recorder_.count(), 1u);
+  EXPECT_EQ(recorder_.service(0), kControlServiceId);
+  EXPECT_EQ(scheduler_.queued_packets(2), 1u);
+
+  EXPECT_EQ(1u, Drain());
+  EXPECT_EQ(scheduler_.queued_packets(), 0u);
+}
+
+TEST_F(PacketSchedulerTest, Drain_Empty_ReturnsZero) {
+  EXPECT_EQ(0u, Drain());
+}
+
+TEST_F(PacketSchedulerTest, Drain_ReportsFirstError) {
+  // The server rejects packets meant for a client.
+  std::array<std::byte, 32> buffer;
+  auto response =
+      Packet(PacketType::RESPONSE, kControlChannel, kControlServiceId, 100)
+          .Encode(buffer);
+  ASSERT_EQ(OkStatus(), scheduler_.Enqueue(response.value(), output_));
+  ASSERT_EQ(OkStatus(), Enqueue(kControlChannel, kLogServiceId));
+
+  const StatusWithSize result = scheduler_.Drain(server_);
+  EXPECT_EQ(Status::InvalidArgument(), result.status());
+  EXPECT_EQ(1u, result.size());
+  EXPECT_EQ(scheduler_.queued_packets(), 0u);
+}
+
+PacketSchedulerTest* current_test;
+
+TEST_F(PacketSchedulerTest, Drain_PacketQueuedDuringDrain_ProcessedNext) {
+  ASSERT_EQ(OkStatus(), Enqueue(kLogChannel, kLogServiceId));
+  ASSERT_EQ(OkStatus(), Enqueue(kLogChannel, kLogServiceId));
+
+  // Queue a control packet from the first invocation.
+  current_test = this;
+  recorder_.set_on_invocation([] {
+    EXPECT_EQ(OkStatus(),
+              current_test->Enqueue(kControlChannel, kControlServiceId));
+  });
+
+  EXPECT_EQ(3u, Drain());
+  ASSERT_EQ(recorder_.count(), 3u);
+  EXPECT_EQ(recorder_.service(0), kLogServiceId);
+  EXPECT_EQ(recorder_.service(1), kControlServiceId);
+  EXPECT_EQ(recorder_.service(2), kLogServiceId);
+}
+
+TEST_F(PacketSchedulerTest, Enqueue_Interleaved_UsesSeparateSlots) {
+  // Start enqueuing a log packet, then enqueue more packets before it is
+  // copied in.
+  const Result<size_t> first = PacketSchedulerTester::Reserve(scheduler_, 2);
+  ASSERT_EQ(OkStatus(), first.status());
+  EXPECT_EQ(scheduler_.queued_packets(2), 1u);
+
+  ASSERT_EQ(OkStatus(), Enqueue(kLogChannel, kLogServiceId));
+  ASSERT_EQ(OkStatus(), Enqueue(kControlChannel, kControlServiceId));
+  EXPECT_EQ(Status::ResourceExhausted(), Enqueue(kLogChannel, kLogServiceId));
+
+  // Draining stops at the slot that is still filling, so the packet behind it
+  // waits.
+  EXPECT_EQ(1u, Drain());
+  ASSERT_EQ(recorder_.count(), 1u);
+  EXPECT_EQ(recorder_.service(0), kControlServiceId);
+  EXPECT_EQ(scheduler_.queued_packets(2), 2u);
+
+  PacketSchedulerTester::Fill(
+      scheduler_, first.value(), Encode(kLogChannel, kLogServiceId), output_);
+
+  EXPECT_EQ(2u, Drain());
+  ASSERT_EQ(recorder_.count(), 3u);
+  EXPECT_EQ(recorder_.service(1), kLogServiceId);
+  EXPECT_EQ(recorder_.service(2), kLogServiceId);
+  EXPECT_EQ(scheduler_.queued_packets(), 0u);
+}
+
+TEST_F(PacketSchedulerTest, Enqueue_QueueFull_OtherPrioritiesUnaffected) {
+  ASSERT_EQ(OkStatus(), Enqueue(kLogChannel, kLogServiceId));
+  ASSERT_EQ(OkStatus(), Enqueue(kLogChannel, kLogServiceId));
+  EXPECT_EQ(Status::ResourceExhausted(), Enqueue(kLogChannel, kLogServiceId));
+
+  EXPECT_EQ(OkStatus(), Enqueue(kControlChannel, kControlServiceId));
+  EXPECT_EQ(OkStatus(), Enqueue(kControlChannel, kControlServiceId));
+  EXPECT_EQ(scheduler_.queued_packets(), 4u);
+
+  // The queues wrap around after they are drained.
+  EXPECT_EQ(4u, Drain());
+  EXPECT_EQ(OkStatus(), Enqueue(kLogChannel, kLogServiceId));
+  EXPECT_EQ(OkStatus(), Enqueue(kLogChannel, kLogServiceId));
+  EXPECT_EQ(2u, Drain());
+}
+
+TEST_F(PacketSchedulerTest, Enqueue_TooLarge_ReturnsResourceExhausted) {
+  std::array<std::byte, 64> buffer;
+  constexpr std::array<std::byte, 24> kPayload = {};
+  auto result = Packet(PacketType::REQUEST,
+                       kControlChannel,
+                       kControlServiceId,
+                       100,
+                       kPayload)
+                    .Encode(buffer);
+  ASSERT_EQ(OkStatus(), result.status());
+  ASSERT_GT(result.value().size(), 32u);
+
+  EXPECT_EQ(Status::ResourceExhausted(),
+            scheduler_.Enqueue(result.value(), output_));
+  EXPECT_EQ(scheduler_.queued_packets(), 0u);
+}
+
+TEST_F(PacketSchedulerTest, Enqueue_InvalidPacket_ReturnsDataLoss) {
+  constexpr std::byte kBadData[] = {
+      std::byte{0xff}, std::byte{0x00}, std::byte{0x00}, std::byte{0xff}};
+  EXPECT_EQ(Status::DataLoss(), scheduler_.Enqueue(kBadData, output_));
+  EXPECT_EQ(scheduler_.queued_packets(), 0u);
+}
+
+}  // namespace
+}  // namespace pw::rpc
@@ -14,6 +14,9 @@
 
 #include "pw_rpc/internal/packet.h"
 
+#include <algorithm>
+#include <array>
+
 #include "gtest/gtest.h"
 #include "pw_bytes/array.h"
 #include "pw_protobuf/codegen.h"
@@ -141,6 +144,115 @@ TEST(Packet, EncodeDecode) {
   EXPECT_EQ(decoded.status(), Status::Unavailable());
 }
 
+// The same fields as kEncoded, in a different order and with the status
+// omitted, so the packet is not in the fixed layout.
+constexpr auto kReordered = bytes::Array<
+    // Method ID
+    MakeKey(4, protobuf::WireType::kFixed32),
+    100,
+    0,
+    0,
+    0,
+
+    // Channel ID
+    MakeKey(2, protobuf::WireType::kVarint),
+    1,
+
+    // Payload
+    MakeKey(5, protobuf::WireType::kDelimited),
+    0x04,
+    0x82,
+    0x02,
+    0xff,
+    0xff,
+
+    // Packet type
+    MakeKey(1, protobuf::WireType::kVarint),
+    1,  // RESPONSE
+
+    // Service ID
+    MakeKey(3, protobuf::WireType::kFixed32),
+    42,
+    0,
+    0,
+    0>();
+
+void ExpectSameAsGenericDecoder(ConstByteSpan data) {
+  const Result<Packet> fast = Packet::FromBuffer(data);
+  const Result<Packet> generic = Packet::FromBufferGeneric(data);
+
+  ASSERT_EQ(fast.status(), generic.status());
+  if (!fast.ok()) {
+    return;
+  }
+
+  EXPECT_EQ(fast.value().type(), generic.value().type());
+  EXPECT_EQ(fast.value().channel_id(), generic.value().channel_id());
+  EXPECT_EQ(fast.value().service_id(), generic.value().service_id());
+  EXPECT_EQ(fast.value().method_id(), generic.value().method_id());
+  EXPECT_EQ(fast.value().payload().data(), generic.value().payload().data());
+  EXPECT_EQ(fast.value().payload().size(), generic.value().payload().size());
+  EXPECT_EQ(fast.value().status(), generic.value().status());
+}
+
+TEST(Packet, Decode_OtherFieldOrder) {
+  auto result = Packet::FromBuffer(kReordered);
+  ASSERT_TRUE(result.ok());
+
+  auto& packet = result.value();
+  EXPECT_EQ(PacketType::RESPONSE, packet.type());
+  EXPECT_EQ(1u, packet.channel_id());
+  EXPECT_EQ(42u, packet.service_id());
+  EXPECT_EQ(100u, packet.method_id());
+  EXPECT_EQ(OkStatus(), packet.status());
+  ASSERT_EQ(sizeof(kPayload), packet.payload().size());
+  EXPECT_EQ(
+      0,
+      std::memcmp(packet.payload().data(), kPayload.data(), kPayload.size()));
+}
+
+TEST(Packet, Decode_MatchesGenericDecoder) {
+  ExpectSameAsGenericDecoder(kEncoded);
+  ExpectSameAsGenericDecoder(kReordered);
+  ExpectSameAsGenericDecoder({});
+
+  byte buffer[64];
+  Packet packet(
+      PacketType::CLIENT_STREAM_END, 300, 0xdeadbeef, 0xffffffff, kPayload);
+  packet.set_status(Status::Unauthenticated());
+  Result encoded = packet.Encode(buffer);
+  ASSERT_EQ(OkStatus(), encoded.status());
+  ExpectSameAsGenericDecoder(encoded.value());
+}
+
+TEST(Packet, Decode_Truncated_MatchesGenericDecoder) {
+  for (size_t size = 0; size < kEncoded.size(); ++size) {
+    ExpectSameAsGenericDecoder(std::span(kEncoded).first(size));
+  }
+}
+
+TEST(Packet, Decode_TrailingField_MatchesGenericDecoder) {
+  std::array<byte, kEncoded.size() + 2> data{};
+  std::copy(kEncoded.begin(), kEncoded.end(), data.begin());
+
+  // An unknown field after the status, so the packet does not match the fixed
+  // layout.
+  data[kEncoded.size()] = byte{MakeKey(15, protobuf::WireType::kVarint)};
+  data[kEncoded.size() + 1] = byte{0x01};
+  ExpectSameAsGenericDecoder(data);
+}
+
+TEST(Packet, Decode_OversizedVarint_MatchesGenericDecoder) {
+  // Replace the status with a varint that does not fit in 32 bits.
+  std::array<byte, kEncoded.size() + 5> data{};
+  std::copy(kEncoded.begin(), kEncoded.end(), data.begin());
+  for (size_t i = kEncoded.size() - 1; i < data.size() - 1; ++i) {
+    data[i] = byte{0xff};
+  }
+  data[data.size() - 1] = byte{0x01};
+  ExpectSameAsGenericDecoder(data);
+}
+
 constexpr size_t kReservedSize = 2 /* type */ + 2 /* channel */ +
                                  5 /* service */ + 5 /* method */ +
                                  2 /* payload key */ + 2 /* status */;
@@ -156,5 +268,118 @@ TEST(Packet, PayloadUsableSpace_LargerVarints) {
       Packet(PacketType::RESPONSE, 17000, 200, 200).MinEncodedSizeBytes());
 }
 
+TEST(Packet, PayloadOffset_SmallBuffer_MatchesMinEncodedSize) {
+  Packet packet(PacketType::RESPONSE, 1, 42, 100);
+  EXPECT_EQ(packet.MinEncodedSizeBytes(), packet.PayloadOffset(127));
+}
+
+TEST(Packet, PayloadOffset_LargeBuffer_ReservesLongerLength) {
+  Packet packet(PacketType::RESPONSE, 1, 42, 100);
+  EXPECT_EQ(packet.MinEncodedSizeBytes() + 1, packet.PayloadOffset(128));
+  EXPECT_EQ(packet.MinEncodedSizeBytes() + 2, packet.PayloadOffset(16384));
+}
+
+TEST(Packet, BufferSizeBytes_FitsEncode) {
+  constexpr byte kLargePayload[40] = {};
+  const Packet packet(PacketType::RESPONSE, 1, 42, 100, kLargePayload);
+
+  std::array<byte, 128> buffer{};
+  ASSERT_EQ(packet.BufferSizeBytes(), kReservedSize + sizeof(kLargePayload));
+  EXPECT_EQ(packet.Encode(std::span(buffer).first(packet.BufferSizeBytes()))
+                .status(),
+            OkStatus());
+}
+
+TEST(Packet, BufferSizeBytes_FitsPayloadInPlace) {
+  Packet packet(PacketType::RESPONSE, 1, 42, 100);
+
+  // With a 110-byte payload, the buffer's size no longer fits in one byte, so
+  // EncodeInPlace() reserves a longer payload length.
+  for (size_t payload_size : {size_t{100}, size_t{109}, size_t{110}}) {
+    std::array<byte, 200> payload{};
+    packet.set_payload(std::span(payload).first(payload_size));
+
+    const size_t size = packet.BufferSizeBytes();
+    EXPECT_GE(size, packet.MinEncodedSizeBytes() + payload_size);
+    EXPECT_LE(packet.PayloadOffset(size) + payload_size, size);
+    EXPECT_GT(packet.PayloadOffset(size - 1) + payload_size, size - 1);
+  }
+}
+
+TEST(Packet, BufferSizeBytesForPayload_MatchesPacketWithPayload) {
+  constexpr byte kPayload110[110] = {};
+  const Packet empty(PacketType::RESPONSE, 1, 42, 100);
+  const Packet full(PacketType::RESPONSE, 1, 42, 100, kPayload110);
+
+  EXPECT_EQ(empty.BufferSizeBytesForPayload(sizeof(kPayload110)),
+            full.BufferSizeBytes());
+  EXPECT_EQ(full.BufferSizeBytesForPayload(0), empty.BufferSizeBytes());
+}
+
+// Builds a packet whose payload is already in place in the buffer.
+template <size_t kSize>
+Packet InPlacePacket(std::array<byte, kSize>& buffer, size_t payload_size) {
+  Packet packet(PacketType::SERVER_STREAM_END, 12, 0xdeadbeef, 0x03a82921);
+  packet.set_status(Status::Unavailable());
+
+  std::span payload =
+      std::span(buffer).subspan(packet.PayloadOffset(buffer.size()));
+  for (size_t i = 0; i < payload_size; ++i) {
+    payload[i] = static_cast<byte>(i);
+  }
+  packet.set_payload(payload.first(payload_size));
+  return packet;
+}
+
+template <size_t kSize>
+void ExpectEncodeInPlaceRoundTrips(size_t payload_size) {
+  std::array<byte, kSize> buffer{};
+  const Packet packet = InPlacePacket(buffer, payload_size);
+  ASSERT_TRUE(packet.PayloadIsInPlace(buffer));
+
+  Result result = packet.EncodeInPlace(buffer);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.value().data(), buffer.data());
+  EXPECT_EQ(result.value().size(),
+            packet.PayloadOffset(buffer.size()) + payload_size);
+
+  ExpectSameAsGenericDecoder(result.value());
+
+  auto decode_result = Packet::FromBuffer(result.value());
+  ASSERT_TRUE(decode_result.ok());
+
+  auto& decoded = decode_result.value();
+  EXPECT_EQ(decoded.type(), PacketType::SERVER_STREAM_END);
+  EXPECT_EQ(decoded.channel_id(), 12u);
+  EXPECT_EQ(decoded.service_id(), 0xdeadbeef);
+  EXPECT_EQ(decoded.method_id(), 0x03a82921u);
+  EXPECT_EQ(decoded.status(), Status::Unavailable());
+
+  // The payload was not moved.
+  EXPECT_EQ(decoded.payload().data(), packet.payload().data());
+  EXPECT_EQ(decoded.payload().size(), payload_size);
+}
+
+TEST(Packet, EncodeInPlace_SmallBuffer) {
+  ExpectEncodeInPlaceRoundTrips<64>(0);
+  ExpectEncodeInPlaceRoundTrips<64>(10);
+}
+
+TEST(Packet, EncodeInPlace_LargeBuffer_PadsPayloadLength) {
+  // A short payload in a large buffer is encoded with a padded length varint.
+  ExpectEncodeInPlaceRoundTrips<300>(3);
+  ExpectEncodeInPlaceRoundTrips<300>(200);
+  ExpectEncodeInPlaceRoundTrips<300>(300 - 19);  // 19 byte header
+}
+
+TEST(Packet, EncodeInPlace_PayloadNotInPlace_ReturnsInvalidArgument) {
+  std::array<byte, 64> buffer{};
+  Packet packet = InPlacePacket(buffer, 4);
+  packet.set_payload(std::span(buffer).subspan(20, 4));
+
+  EXPECT_FALSE(packet.PayloadIsInPlace(buffer));
+  EXPECT_EQ(packet.EncodeInPlace(buffer).status(), Status::InvalidArgument());
+}
+
 }  // namespace
 }  // namespace pw::rpc::internal
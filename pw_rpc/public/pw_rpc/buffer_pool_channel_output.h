@@ -0,0 +1,252 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_rpc/channel.h"
+#include "pw_status/status.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+
+namespace pw::rpc {
+
+// The number and size of one class of buffers in a
+// MultiSizeBufferPoolChannelOutput.
+template <size_t kBufferCount, size_t kBufferSizeBytes>
+struct BufferPoolSize {
+  static_assert(kBufferCount > 0u);
+  static_assert(kBufferCount <= UINT16_MAX);
+  static_assert(kBufferSizeBytes > 0u);
+  static_assert(kBufferSizeBytes <= UINT16_MAX);
+
+  static constexpr size_t kCount = kBufferCount;
+  static constexpr size_t kSizeBytes = kBufferSizeBytes;
+};
+
+namespace internal {
+
+// The buffers of one size in a BaseBufferPoolChannelOutput. Buffers are
+// numbered across all classes, smallest first, and laid out in the pool in the
+// same order.
+struct BufferPoolClass {
+  uint16_t first_index;
+  uint16_t count;
+  uint16_t size_bytes;
+  size_t pool_offset;
+};
+
+template <typename... Sizes>
+constexpr std::array<BufferPoolClass, sizeof...(Sizes)>
+MakeBufferPoolClasses() {
+  constexpr size_t kCounts[] = {Sizes::kCount...};
+  constexpr size_t kSizes[] = {Sizes::kSizeBytes...};
+
+  std::array<BufferPoolClass, sizeof...(Sizes)> classes = {};
+  size_t first_index = 0;
+  size_t pool_offset = 0;
+  for (size_t i = 0; i < classes.size(); ++i) {
+    classes[i] = {static_cast<uint16_t>(first_index),
+                  static_cast<uint16_t>(kCounts[i]),
+                  static_cast<uint16_t>(kSizes[i]),
+                  pool_offset};
+    first_index += kCounts[i];
+    pool_offset += kCounts[i] * kSizes[i];
+  }
+  return classes;
+}
+
+// The implementation of BufferPoolChannelOutput and
+// MultiSizeBufferPoolChannelOutput, which provide the storage.
+class BaseBufferPoolChannelOutput : public ChannelOutput {
+ public:
+  // Returns a free buffer of the largest size, or an empty span if all of them
+  // are in use. This never blocks, so it may be called from multiple threads at
+  // once or from an interrupt.
+  std::span<std::byte> AcquireBuffer() final;
+
+  // Returns a free buffer of the smallest size that holds size_hint bytes. If
+  // all buffers of that size are in use, returns the next larger free buffer.
+  std::span<std::byte> AcquireBufferForSize(size_t size_hint) final;
+
+  // Queues the packet for transmission and returns OK, or returns the buffer to
+  // the pool if it is empty. A packet that fits in a smaller free buffer is
+  // moved into it, so that queued packets don't hold larger buffers than they
+  // need. Transmission errors are reported by TransmitQueuedPackets().
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) final;
+
+  // Transmits queued packets in the order they were queued, then returns their
+  // buffers to the pool. Only one thread may call this at a time. Returns the
+  // first error from Transmit(), but transmits all queued packets regardless.
+  Status TransmitQueuedPackets();
+
+  // The number of packets waiting to be transmitted.
+  size_t queued_packets() const PW_LOCKS_EXCLUDED(lock_);
+
+ protected:
+  // The classes must be ordered from the smallest buffers to the largest.
+  BaseBufferPoolChannelOutput(const char* name,
+                              ByteSpan pool,
+                              std::span<const BufferPoolClass> classes,
+                              std::span<uint16_t> free_buffers,
+                              std::span<uint16_t> free_counts,
+                              std::span<uint16_t> queued_buffers,
+                              std::span<uint16_t> packet_sizes);
+
+ private:
+  static constexpr uint16_t kNoBuffer = UINT16_MAX;
+
+  // Sends a packet to the transport. Called from TransmitQueuedPackets().
+  virtual Status Transmit(std::span<const std::byte> packet) = 0;
+
+  // Called after a packet is queued, possibly from an interrupt. Derived
+  // classes may override this to wake the thread that transmits packets.
+  virtual void PacketQueued() {}
+
+  // The first class whose buffers hold size bytes, or classes_.size() if none.
+  size_t ClassFor(size_t size) const;
+
+  size_t ClassOf(uint16_t index) const;
+
+  uint16_t BufferIndex(const std::byte* data) const;
+
+  ByteSpan buffer(uint16_t index) const;
+
+  // Takes a free buffer from the first class in [first_class, end_class) that
+  // has one. Returns kNoBuffer if none of them do.
+  uint16_t Take(size_t first_class, size_t end_class) PW_LOCKS_EXCLUDED(lock_);
+
+  void Release(uint16_t index) PW_LOCKS_EXCLUDED(lock_);
+
+  const ByteSpan pool_;
+  const std::span<const BufferPoolClass> classes_;
+
+  mutable sync::InterruptSpinLock lock_;
+
+  // Stacks of the indices of buffers available to AcquireBuffer(), one for
+  // each class. A class's stack uses the same range of the array as the class's
+  // buffer indices, and free_counts_ holds its depth.
+  const std::span<uint16_t> free_buffers_ PW_GUARDED_BY(lock_);
+  const std::span<uint16_t> free_counts_ PW_GUARDED_BY(lock_);
+
+  // Ring buffer of the indices of buffers that are waiting to be transmitted.
+  const std::span<uint16_t> queued_buffers_ PW_GUARDED_BY(lock_);
+  size_t queue_head_ PW_GUARDED_BY(lock_);
+  size_t queue_count_ PW_GUARDED_BY(lock_);
+
+  // The size of the packet in each queued buffer.
+  const std::span<uint16_t> packet_sizes_;
+};
+
+}  // namespace internal
+
+// A ChannelOutput for multiple threads that respond concurrently. Instead of
+// holding a lock while each packet is encoded and sent, like
+// SynchronizedChannelOutput, it hands each caller its own buffer from a pool.
+// Finished packets are queued, and a single thread sends them to the transport
+// in order by calling TransmitQueuedPackets(). The pool and queue are guarded
+// by an InterruptSpinLock, which is held only to add or remove a buffer index.
+//
+// The pool holds buffers of each of the sizes given as BufferPoolSize template
+// arguments, from smallest to largest. pw_rpc passes the size of packets it
+// knows in advance, such as stream ends and errors, to AcquireBufferForSize(),
+// which returns the smallest free buffer that fits. Other packets are written
+// into the largest buffers, and then moved into a smaller free buffer if one
+// fits when they are queued. Many small queued packets thus only need one
+// large buffer between them.
+//
+// To use it, derive from this class and implement Transmit(). Optionally,
+// override PacketQueued() to signal the transmit thread.
+//
+//   class UartOutput : public pw::rpc::MultiSizeBufferPoolChannelOutput<
+//                          pw::rpc::BufferPoolSize<8, 32>,
+//                          pw::rpc::BufferPoolSize<4, 96>,
+//                          pw::rpc::BufferPoolSize<2, 512>> {
+//    public:
+//     UartOutput() : MultiSizeBufferPoolChannelOutput("UART") {}
+//
+//    private:
+//     pw::Status Transmit(std::span<const std::byte> packet) override {
+//       return uart.Write(packet);
+//     }
+//
+//     void PacketQueued() override { transmit_semaphore.release(); }
+//   };
+//
+template <typename... Sizes>
+class MultiSizeBufferPoolChannelOutput
+    : public internal::BaseBufferPoolChannelOutput {
+ private:
+  static constexpr std::array<internal::BufferPoolClass, sizeof...(Sizes)>
+      kClasses = internal::MakeBufferPoolClasses<Sizes...>();
+
+  static constexpr size_t kBufferCount = (Sizes::kCount + ...);
+  static constexpr size_t kPoolSizeBytes =
+      ((Sizes::kCount * Sizes::kSizeBytes) + ...);
+
+  static constexpr bool SizesAreAscending() {
+    for (size_t i = 1; i < kClasses.size(); ++i) {
+      if (kClasses[i - 1].size_bytes >= kClasses[i].size_bytes) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ public:
+  static_assert(sizeof...(Sizes) > 0u);
+  static_assert(kBufferCount < UINT16_MAX);
+  static_assert(SizesAreAscending(),
+                "Buffer sizes must be distinct and listed smallest first");
+
+  MultiSizeBufferPoolChannelOutput(const char* name)
+      : BaseBufferPoolChannelOutput(name,
+                                    pool_,
+                                    kClasses,
+                                    free_buffers_,
+                                    free_counts_,
+                                    queued_buffers_,
+                                    packet_sizes_) {}
+
+ private:
+  std::array<std::byte, kPoolSizeBytes> pool_;
+  std::array<uint16_t, kBufferCount> free_buffers_;
+  std::array<uint16_t, sizeof...(Sizes)> free_counts_;
+  std::array<uint16_t, kBufferCount> queued_buffers_;
+  std::array<uint16_t, kBufferCount> packet_sizes_;
+};
+
+// A MultiSizeBufferPoolChannelOutput with buffers of a single size.
+//
+//   class UartOutput : public pw::rpc::BufferPoolChannelOutput<4, 256> {
+//    public:
+//     UartOutput() : BufferPoolChannelOutput("UART") {}
+//     ...
+//   };
+//
+template <size_t kBufferCount, size_t kBufferSizeBytes>
+class BufferPoolChannelOutput
+    : public MultiSizeBufferPoolChannelOutput<
+          BufferPoolSize<kBufferCount, kBufferSizeBytes>> {
+ public:
+  BufferPoolChannelOutput(const char* name)
+      : MultiSizeBufferPoolChannelOutput<
+            BufferPoolSize<kBufferCount, kBufferSizeBytes>>(name) {}
+};
+
+}  // namespace pw::rpc
@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <span>
 #include <type_traits>
@@ -28,6 +29,8 @@ class BaseClientCall;
 }  // namespace internal
 
 class Client;
+class Server;
+class ServerObserver;
 
 class ChannelOutput {
  public:
@@ -43,6 +46,15 @@ class ChannelOutput {
   // implementation is expected to handle synchronization if necessary.
   virtual std::span<std::byte> AcquireBuffer() = 0;
 
+  // Acquires a buffer for a packet that is known to encode to at most
+  // size_hint bytes. Outputs with buffers of several sizes may return a buffer
+  // smaller than the one from AcquireBuffer(), but no smaller than the hint if
+  // one is available. By default, this returns AcquireBuffer().
+  virtual std::span<std::byte> AcquireBufferForSize(size_t size_hint) {
+    static_cast<void>(size_hint);
+    return AcquireBuffer();
+  }
+
   // Sends the contents of a buffer previously obtained from AcquireBuffer().
   // This may be called with an empty span, in which case the buffer should be
   // released without sending any data.
@@ -66,7 +78,10 @@ class Channel {
 
   // Creates a dynamically assignable channel without a set ID or output.
   constexpr Channel()
-      : id_(kUnassignedChannelId), output_(nullptr), client_(nullptr) {}
+      : id_(kUnassignedChannelId),
+        output_(nullptr),
+        client_(nullptr),
+        observer_(nullptr) {}
 
   // Creates a channel with a static ID. The channel's output can also be
   // static, or it can set to null to allow dynamically opening connections
@@ -116,7 +131,7 @@ class Channel {
 
  protected:
   constexpr Channel(uint32_t id, ChannelOutput* output)
-      : id_(id), output_(output), client_(nullptr) {
+      : id_(id), output_(output), client_(nullptr), observer_(nullptr) {
     PW_ASSERT(id != kUnassignedChannelId);
   }
 
@@ -125,16 +140,24 @@ class Channel {
     return *output_;
   }
 
+  constexpr ServerObserver* observer() const { return observer_; }
+
  private:
   friend class internal::BaseClientCall;
   friend class Client;
+  friend class Server;
 
   constexpr Client* client() const { return client_; }
   constexpr void set_client(Client* client) { client_ = client; }
 
+  constexpr void set_observer(ServerObserver* observer) {
+    observer_ = observer;
+  }
+
   uint32_t id_;
   ChannelOutput* output_;
   Client* client_;
+  ServerObserver* observer_;
 };
 
 }  // namespace pw::rpc
@@ -18,7 +18,9 @@
 
 #include "pw_bytes/span.h"
 #include "pw_rpc/internal/base_client_call.h"
+#include "pw_rpc/internal/call_index.h"
 #include "pw_rpc/internal/channel.h"
+#include "pw_rpc/internal/config.h"
 
 namespace pw::rpc {
 
@@ -47,15 +49,24 @@ class Client {
   //
   Status ProcessPacket(ConstByteSpan data);
 
-  size_t active_calls() const { return calls_.size(); }
+  size_t active_calls() const { return call_index_.size() + calls_.size(); }
 
  private:
   friend class internal::BaseClientCall;
 
   Status RegisterCall(internal::BaseClientCall& call);
-  void RemoveCall(const internal::BaseClientCall& call) { calls_.remove(call); }
+  void RemoveCall(const internal::BaseClientCall& call);
+
+  internal::BaseClientCall* FindCall(uint32_t channel_id,
+                                     uint32_t service_id,
+                                     uint32_t method_id);
 
   std::span<internal::Channel> channels_;
+
+  // Pending calls are kept in the index if it has room, or in the list if not,
+  // so that neither lookups nor removals walk every indexed call.
+  internal::CallIndex<internal::BaseClientCall, cfg::kClientCallIndexSize>
+      call_index_;
   IntrusiveList<internal::BaseClientCall> calls_;
 };
 
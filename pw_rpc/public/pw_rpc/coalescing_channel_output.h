@@ -0,0 +1,128 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_result/result.h"
+#include "pw_rpc/channel.h"
+#include "pw_status/status.h"
+
+namespace pw::rpc {
+
+// Packs multiple encoded RPC packets into a single buffer of another
+// ChannelOutput. Each packet in the combined frame is prefixed with its length
+// as a varint. The receiver splits the frame with ForEachCoalescedPacket.
+//
+// Packets are held until one of the following occurs:
+//
+//   - The remaining space cannot hold a packet of max_packet_size bytes.
+//   - A packet is sent max_delay or more after the first held packet.
+//   - Flush() is called, or FlushIfDue() is called after max_delay has passed.
+//
+// A packet is only delayed past max_delay if no other packets are sent, so
+// applications with strict latency requirements should call FlushIfDue()
+// periodically. The wrapped output's buffer must be at least as large as the
+// coalescing buffer.
+//
+// Like other ChannelOutputs, this class is not thread safe. It may be wrapped
+// with a SynchronizedChannelOutput.
+class CoalescingChannelOutput : public ChannelOutput {
+ public:
+  CoalescingChannelOutput(const char* name,
+                          ChannelOutput& output,
+                          ByteSpan buffer,
+                          size_t max_packet_size,
+                          chrono::SystemClock::duration max_delay);
+
+  // Returns space for one packet after the held packets. The frame is sent as
+  // soon as the next packet might not fit, so this never flushes. It returns
+  // an empty span if there is no room for a max_packet_size packet.
+  std::span<std::byte> AcquireBuffer() override;
+
+  // Adds the packet to the frame. Returns the status of the wrapped output if
+  // this causes the frame to be sent, or OK otherwise.
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override;
+
+  // Sends all held packets to the wrapped output. Returns OK if there were no
+  // packets to send.
+  Status Flush();
+
+  // Sends the held packets if the oldest of them was sent max_delay or more
+  // ago.
+  Status FlushIfDue();
+
+  // The number of packets waiting to be sent.
+  size_t pending_packets() const { return pending_packets_; }
+
+ private:
+  ChannelOutput& output_;
+  ByteSpan buffer_;
+  const size_t max_packet_size_;
+  const size_t prefix_size_;
+  const chrono::SystemClock::duration max_delay_;
+
+  size_t size_;
+  size_t pending_packets_;
+  chrono::SystemClock::time_point first_packet_time_;
+};
+
+// A CoalescingChannelOutput that owns its buffer.
+template <size_t kBufferSizeBytes>
+class CoalescingChannelOutputWithBuffer final : public CoalescingChannelOutput {
+ public:
+  CoalescingChannelOutputWithBuffer(const char* name,
+                                    ChannelOutput& output,
+                                    size_t max_packet_size,
+                                    chrono::SystemClock::duration max_delay)
+      : CoalescingChannelOutput(
+            name, output, buffer_, max_packet_size, max_delay) {}
+
+ private:
+  std::array<std::byte, kBufferSizeBytes> buffer_;
+};
+
+namespace internal {
+
+// Removes the next packet from the front of a coalesced frame.
+Result<ConstByteSpan> ReadCoalescedPacket(ConstByteSpan& frame);
+
+}  // namespace internal
+
+// Calls the provided function with each packet in a frame produced by a
+// CoalescingChannelOutput, for example:
+//
+//   ForEachCoalescedPacket(frame, [&](ConstByteSpan packet) {
+//     server.ProcessPacket(packet, output);
+//   });
+//
+// Returns DATA_LOSS if the frame is malformed. Packets that precede the
+// malformed data are still passed to the function.
+template <typename Function>
+Status ForEachCoalescedPacket(ConstByteSpan frame, Function&& function) {
+  while (!frame.empty()) {
+    Result<ConstByteSpan> packet = internal::ReadCoalescedPacket(frame);
+    if (!packet.ok()) {
+      return packet.status();
+    }
+    function(packet.value());
+  }
+  return OkStatus();
+}
+
+}  // namespace pw::rpc
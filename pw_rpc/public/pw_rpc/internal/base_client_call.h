@@ -15,6 +15,7 @@
 
 #include "pw_assert/assert.h"
 #include "pw_containers/intrusive_list.h"
+#include "pw_rpc/internal/call_index.h"
 #include "pw_rpc/internal/channel.h"
 #include "pw_rpc/internal/packet.h"
 #include "pw_status/status.h"
@@ -62,23 +63,38 @@ class BaseClientCall : public IntrusiveList<BaseClientCall>::Item {
 
   void Cancel();
 
+  // Grants a server streaming or bidirectional call permission to send this
+  // many more responses. The first grant puts the call under flow control, so
+  // the server stops streaming when the credits run out.
+  Status GrantCredits(uint32_t credits);
+
  protected:
   constexpr Channel& channel() const { return *channel_; }
+  constexpr uint32_t channel_id() const { return channel_->id(); }
   constexpr uint32_t service_id() const { return service_id_; }
   constexpr uint32_t method_id() const { return method_id_; }
 
   std::span<std::byte> AcquirePayloadBuffer();
   Status ReleasePayloadBuffer(std::span<const std::byte> payload);
 
+  // Sends a payload from AcquirePayloadBuffer() in a CLIENT_STREAM packet, for
+  // client and bidirectional streaming calls. The call must have been started
+  // with a request from ReleasePayloadBuffer().
+  Status ReleaseClientStreamBuffer(std::span<const std::byte> payload);
+
   void Unregister();
 
  private:
   friend class rpc::Client;
+  template <typename, size_t>
+  friend class CallIndex;
 
   void Register();
 
   void HandleResponse(const Packet& packet) { handler_(*this, packet); }
 
+  Status SendPayload(PacketType type, std::span<const std::byte> payload);
+
   Packet NewPacket(PacketType type,
                    std::span<const std::byte> payload = {}) const;
 
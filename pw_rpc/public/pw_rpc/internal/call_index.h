@@ -0,0 +1,171 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_preprocessor/compiler.h"
+
+namespace pw::rpc::internal {
+
+// Fixed-capacity, open-addressed hash table of open RPC calls, keyed by their
+// channel, service, and method IDs. The server uses it for its Responders and
+// the client for its pending calls; Call may be any type with channel_id(),
+// service_id(), and method_id() accessors. Collisions are resolved with linear
+// probing; removals shift later entries back so that no tombstones are needed.
+//
+// Calls that are added when the index is full are not indexed. The index counts
+// them so that its owner knows when a miss must fall back to searching its list
+// of calls.
+template <typename Call, size_t kCapacity>
+class CallIndex {
+ public:
+  constexpr CallIndex() : entries_{}, size_(0), unindexed_(0) {}
+
+  CallIndex(const CallIndex&) = delete;
+  CallIndex& operator=(const CallIndex&) = delete;
+
+  // Adds a call to the index. Returns false if the index is full.
+  bool Add(Call& call) {
+    if (size_ == kCapacity) {
+      unindexed_ += 1;
+      return false;
+    }
+
+    size_t slot = Slot(call);
+    while (entries_[slot] != nullptr) {
+      slot = Next(slot);
+    }
+
+    entries_[slot] = &call;
+    size_ += 1;
+    return true;
+  }
+
+  // Removes a call from the index. Returns false if it was not indexed.
+  bool Remove(const Call& call) {
+    size_t slot = Slot(call);
+
+    for (size_t probes = 0; probes < kCapacity; ++probes) {
+      if (entries_[slot] == nullptr) {
+        break;
+      }
+      if (entries_[slot] == &call) {
+        Erase(slot);
+        return true;
+      }
+      slot = Next(slot);
+    }
+
+    if (unindexed_ > 0u) {
+      unindexed_ -= 1;
+    }
+    return false;
+  }
+
+  // Finds a call for the provided IDs. Returns nullptr if there is no matching
+  // call in the index.
+  Call* Find(uint32_t channel_id,
+             uint32_t service_id,
+             uint32_t method_id) const {
+    size_t slot = Slot(channel_id, service_id, method_id);
+
+    for (size_t probes = 0; probes < kCapacity; ++probes) {
+      Call* call = entries_[slot];
+
+      if (call == nullptr) {
+        break;
+      }
+      if (call->channel_id() == channel_id &&
+          call->service_id() == service_id && call->method_id() == method_id) {
+        return call;
+      }
+
+      slot = Next(slot);
+    }
+
+    return nullptr;
+  }
+
+  // True if some open calls are not in the index, in which case a miss
+  // in Find() is not authoritative.
+  constexpr bool overflowed() const { return unindexed_ != 0u; }
+
+  constexpr size_t size() const { return size_; }
+  static constexpr size_t capacity() { return kCapacity; }
+
+ private:
+  static size_t Slot(const Call& call) {
+    return Slot(call.channel_id(), call.service_id(), call.method_id());
+  }
+
+  static constexpr size_t Slot(uint32_t channel_id,
+                               uint32_t service_id,
+                               uint32_t method_id)
+      PW_NO_SANITIZE("unsigned-integer-overflow") {
+    return static_cast<size_t>((service_id * 65599u + method_id) * 65599u +
+                               channel_id) %
+           kCapacity;
+  }
+
+  static constexpr size_t Next(size_t slot) {
+    return slot + 1 == kCapacity ? 0 : slot + 1;
+  }
+
+  // Removes the entry at the slot, then moves back any later entries in the
+  // same probe sequence that would otherwise become unreachable.
+  void Erase(size_t slot) {
+    entries_[slot] = nullptr;
+    size_ -= 1;
+
+    for (size_t next = Next(slot); entries_[next] != nullptr;
+         next = Next(next)) {
+      const size_t home = Slot(*entries_[next]);
+
+      // Move the entry if its home slot is not cyclically within (slot, next].
+      const bool reachable = slot <= next ? (slot < home && home <= next)
+                                          : (slot < home || home <= next);
+      if (!reachable) {
+        entries_[slot] = entries_[next];
+        entries_[next] = nullptr;
+        slot = next;
+      }
+    }
+  }
+
+  std::array<Call*, kCapacity> entries_;
+  size_t size_;
+  size_t unindexed_;
+};
+
+// If the index is disabled, every lookup searches the owner's list of calls.
+template <typename Call>
+class CallIndex<Call, 0> {
+ public:
+  constexpr CallIndex() = default;
+
+  constexpr bool Add(Call&) { return false; }
+  constexpr bool Remove(const Call&) { return false; }
+
+  constexpr Call* Find(uint32_t, uint32_t, uint32_t) const { return nullptr; }
+
+  constexpr bool overflowed() const { return true; }
+
+  constexpr size_t size() const { return 0; }
+  static constexpr size_t capacity() { return 0; }
+};
+
+}  // namespace pw::rpc::internal
@@ -73,11 +73,14 @@ class Channel : public rpc::Channel {
     return OutputBuffer(output().AcquireBuffer());
   }
 
-  Status Send(const internal::Packet& packet) {
-    OutputBuffer buffer = AcquireBuffer();
-    return Send(buffer, packet);
+  // Acquires a buffer for a packet that encodes to at most size_hint bytes.
+  OutputBuffer AcquireBuffer(size_t size_hint) const {
+    return OutputBuffer(output().AcquireBufferForSize(size_hint));
   }
 
+  // Encodes the packet into a buffer sized for it and sends it.
+  Status Send(const internal::Packet& packet);
+
   Status Send(OutputBuffer& output, const internal::Packet& packet);
 
   void Release(OutputBuffer& buffer) {
@@ -17,6 +17,84 @@
 
 #include <cstddef>
 
+// pw_rpc servers can maintain a fixed-size hash table of their registered
+// methods, which makes finding the method for an incoming packet a constant
+// time operation instead of a linear search through every service and method.
+// This option sets the number of entries in the table. It should be at least
+// the total number of methods registered with a server, with some headroom to
+// keep probe sequences short. Each entry is two pointers.
+//
+// If the table overflows, lookups fall back to a linear search. Set this to 0
+// to disable the table entirely.
+#ifndef PW_RPC_METHOD_INDEX_SIZE
+#define PW_RPC_METHOD_INDEX_SIZE 0
+#endif  // PW_RPC_METHOD_INDEX_SIZE
+
+namespace pw::rpc::cfg {
+
+inline constexpr size_t kMethodIndexSize = PW_RPC_METHOD_INDEX_SIZE;
+
+}  // namespace pw::rpc::cfg
+
+#undef PW_RPC_METHOD_INDEX_SIZE
+
+// Similarly, servers can keep a fixed-size hash table of their open streaming
+// calls (Responders), indexed by channel, service, and method ID. This makes
+// handling CANCEL and CLIENT_ERROR packets constant time rather than a linear
+// search of every open call. This option sets the number of entries, each of
+// which is one pointer. It should be at least the maximum number of concurrent
+// streaming calls. If the table is full, lookups fall back to a linear search.
+// Set this to 0 to disable the table entirely.
+#ifndef PW_RPC_RESPONDER_INDEX_SIZE
+#define PW_RPC_RESPONDER_INDEX_SIZE 0
+#endif  // PW_RPC_RESPONDER_INDEX_SIZE
+
+namespace pw::rpc::cfg {
+
+inline constexpr size_t kResponderIndexSize = PW_RPC_RESPONDER_INDEX_SIZE;
+
+}  // namespace pw::rpc::cfg
+
+#undef PW_RPC_RESPONDER_INDEX_SIZE
+
+// Clients can keep the same kind of table of their pending calls, so that each
+// response is routed to its call in constant time rather than by searching
+// every pending call. This option sets the number of entries, each of which is
+// one pointer. It should be at least the maximum number of concurrent calls. If
+// the table is full, additional calls fall back to a linear search. Set this to
+// 0 to disable the table entirely.
+#ifndef PW_RPC_CLIENT_CALL_INDEX_SIZE
+#define PW_RPC_CLIENT_CALL_INDEX_SIZE 0
+#endif  // PW_RPC_CLIENT_CALL_INDEX_SIZE
+
+namespace pw::rpc::cfg {
+
+inline constexpr size_t kClientCallIndexSize = PW_RPC_CLIENT_CALL_INDEX_SIZE;
+
+}  // namespace pw::rpc::cfg
+
+#undef PW_RPC_CLIENT_CALL_INDEX_SIZE
+
+// Unary methods may defer their response by taking a responder object instead
+// of returning the response, then finishing the call later, for example from a
+// worker thread. This option limits how many deferred calls may be outstanding
+// on a server at once. Requests to deferred methods beyond this limit fail
+// with RESOURCE_EXHAUSTED without invoking the method. Deferred calls are also
+// registered with the server like streaming calls, so the responder index
+// should have room for them.
+#ifndef PW_RPC_MAX_DEFERRED_UNARY_CALLS
+#define PW_RPC_MAX_DEFERRED_UNARY_CALLS 4
+#endif  // PW_RPC_MAX_DEFERRED_UNARY_CALLS
+
+namespace pw::rpc::cfg {
+
+inline constexpr size_t kMaxDeferredUnaryCalls =
+    PW_RPC_MAX_DEFERRED_UNARY_CALLS;
+
+}  // namespace pw::rpc::cfg
+
+#undef PW_RPC_MAX_DEFERRED_UNARY_CALLS
+
 // The Nanopb-based pw_rpc implementation allocates memory to use for Nanopb
 // structs for the request and response protobufs. The template function that
 // allocates these structs rounds struct sizes up to this value so that
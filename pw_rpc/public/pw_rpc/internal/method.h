@@ -15,6 +15,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <type_traits>
 #include <utility>
 
 #include "pw_rpc/internal/call.h"
@@ -40,9 +41,11 @@ class MethodImpl : public Method {
   static constexpr MethodImpl ServerStreaming(uint32_t id, [optional args]);
 
   // Creates a client streaming method instance.
+  template <auto method>
   static constexpr MethodImpl ClientStreaming(uint32_t id, [optional args]);
 
   // Creates a bidirectional streaming method instance.
+  template <auto method>
   static constexpr MethodImpl BidirectionalStreaming(uint32_t id,
                                                      [optional args]);
 
@@ -105,6 +108,20 @@ template <auto method>
 using MethodImplementation =
     typename MethodTraits<decltype(method)>::Implementation;
 
+// Unary methods may defer their response by taking a responder object instead
+// of producing the response before they return. MethodTraits specializations
+// for these signatures set kDeferred to true.
+template <typename Traits, typename = void>
+struct DefersResponse : std::false_type {};
+
+template <typename Traits>
+struct DefersResponse<Traits, std::void_t<decltype(Traits::kDeferred)>>
+    : std::bool_constant<Traits::kDeferred> {};
+
+template <auto method>
+inline constexpr bool kDefersResponse =
+    DefersResponse<MethodTraits<decltype(method)>>::value;
+
 // Function that calls a user-defined method implementation function from a
 // ServerCall object.
 template <auto method, typename... Args>
@@ -0,0 +1,141 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+#include "pw_preprocessor/compiler.h"
+#include "pw_rpc/internal/method.h"
+#include "pw_rpc/service.h"
+
+namespace pw::rpc::internal {
+
+// Fixed-capacity, open-addressed hash table that maps (service ID, method ID)
+// pairs to the corresponding registered service and method. Service and method
+// IDs are already hashes of their names, so they are combined cheaply and
+// collisions are resolved with linear probing.
+//
+// The index is populated as services are registered and is never shrunk, since
+// services cannot be unregistered. If more methods are added than the index can
+// hold, the index is marked as overflowed and lookups that miss must fall back
+// to a linear search.
+template <size_t kCapacity>
+class MethodIndex {
+ public:
+  constexpr MethodIndex() : entries_{}, size_(0), overflowed_(false) {}
+
+  MethodIndex(const MethodIndex&) = delete;
+  MethodIndex& operator=(const MethodIndex&) = delete;
+
+  // Adds all of the service's methods to the index. Returns false if there
+  // wasn't room for every method, in which case overflowed() becomes true.
+  bool Add(Service& service) {
+    for (size_t i = 0; i < service.method_count_; ++i) {
+      if (!Add(service, service.MethodAt(i))) {
+        overflowed_ = true;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Finds the service and method for the provided IDs. Returns nullptrs if
+  // there is no such method in the index.
+  std::tuple<Service*, const Method*> Find(uint32_t service_id,
+                                           uint32_t method_id) const {
+    size_t slot = Slot(service_id, method_id);
+
+    for (size_t probes = 0; probes < kCapacity; ++probes) {
+      const Entry& entry = entries_[slot];
+
+      if (entry.service == nullptr) {
+        break;
+      }
+
+      if (entry.service->id() == service_id && entry.method->id() == method_id) {
+        return {entry.service, entry.method};
+      }
+
+      slot = Next(slot);
+    }
+
+    return {nullptr, nullptr};
+  }
+
+  // True if a service was registered after the index filled up.
+  constexpr bool overflowed() const { return overflowed_; }
+
+  constexpr size_t size() const { return size_; }
+  static constexpr size_t capacity() { return kCapacity; }
+
+ private:
+  struct Entry {
+    Service* service;
+    const Method* method;
+  };
+
+  bool Add(Service& service, const Method& method) {
+    if (size_ == kCapacity) {
+      return false;
+    }
+
+    size_t slot = Slot(service.id(), method.id());
+    while (entries_[slot].service != nullptr) {
+      slot = Next(slot);
+    }
+
+    entries_[slot] = {&service, &method};
+    size_ += 1;
+    return true;
+  }
+
+  static constexpr size_t Slot(uint32_t service_id, uint32_t method_id)
+      PW_NO_SANITIZE("unsigned-integer-overflow") {
+    // Mix in the service ID so that identically named methods in different
+    // services land in different slots.
+    return static_cast<size_t>(service_id * 65599u + method_id) % kCapacity;
+  }
+
+  static constexpr size_t Next(size_t slot) {
+    return slot + 1 == kCapacity ? 0 : slot + 1;
+  }
+
+  std::array<Entry, kCapacity> entries_;
+  size_t size_;
+  bool overflowed_;
+};
+
+// If the index is disabled, all lookups use a linear search.
+template <>
+class MethodIndex<0> {
+ public:
+  constexpr MethodIndex() = default;
+
+  constexpr bool Add(Service&) { return false; }
+
+  constexpr std::tuple<Service*, const Method*> Find(uint32_t,
+                                                     uint32_t) const {
+    return {nullptr, nullptr};
+  }
+
+  constexpr bool overflowed() const { return true; }
+
+  constexpr size_t size() const { return 0; }
+  static constexpr size_t capacity() { return 0; }
+};
+
+}  // namespace pw::rpc::internal
@@ -39,6 +39,23 @@ class MethodLookup {
     return method;
   }
 
+  // Accessors for the generated service tables, which are private to the
+  // generated service class.
+  template <typename Service>
+  static constexpr uint32_t GetServiceId() {
+    return GeneratedService<Service>::kServiceId;
+  }
+
+  template <typename Service>
+  static constexpr const auto& GetMethodIds() {
+    return GeneratedService<Service>::kMethodIds;
+  }
+
+  template <typename Service>
+  static constexpr const auto& GetMethodUnions() {
+    return GeneratedService<Service>::kMethods;
+  }
+
  private:
   template <typename Service, uint32_t kMethodId>
   static constexpr const auto& GetMethodUnion() {
@@ -88,14 +88,15 @@ constexpr auto InvalidMethod(uint32_t) {
   } else if constexpr (expected == MethodType::kClientStreaming) {
     static_assert(
         kCheckMethodSignature<decltype(method)>,
-        _PW_RPC_FUNCTION_ERROR(
-            "client streaming", "Status", "ServerReader<Request>&, Response"));
+        _PW_RPC_FUNCTION_ERROR("client streaming",
+                               "void",
+                               "ServerReader<Request, Response>&"));
   } else if constexpr (expected == MethodType::kBidirectionalStreaming) {
     static_assert(kCheckMethodSignature<decltype(method)>,
                   _PW_RPC_FUNCTION_ERROR(
                       "bidirectional streaming",
                       "void",
-                      "ServerReader<Request>&, ServerWriter<Response>&"));
+                      "ServerReaderWriter<Request, Response>&"));
   } else {
     static_assert(kCheckMethodSignature<decltype(method)>,
                   "Unsupported MethodType");
@@ -29,8 +29,16 @@ class Packet {
 
   // Parses a packet from a protobuf message. Missing or malformed fields take
   // their default values.
+  //
+  // Packets with their fields in the order written by Encode() or
+  // EncodeInPlace() are read directly from their fixed layout. Other packets
+  // are parsed with the generic protobuf decoder.
   static Result<Packet> FromBuffer(ConstByteSpan data);
 
+  // Parses a packet with the generic protobuf decoder only. Returns the same
+  // result as FromBuffer(); this is exposed for testing and benchmarking.
+  static Result<Packet> FromBufferGeneric(ConstByteSpan data);
+
   // Creates an RPC packet with the channel, service, and method ID of the
   // provided packet.
   static constexpr Packet Response(const Packet& request,
@@ -90,6 +98,29 @@ class Packet {
   // reserved space and available space for the payload.
   size_t MinEncodedSizeBytes() const;
 
+  // The size of the smallest buffer that holds this packet, whether it is
+  // encoded with Encode() or with the payload in place.
+  size_t BufferSizeBytes() const {
+    return BufferSizeBytesForPayload(payload_.size());
+  }
+
+  // The size of the smallest buffer that holds this packet with any payload of
+  // up to payload_size_bytes in place of its own.
+  size_t BufferSizeBytesForPayload(size_t payload_size_bytes) const;
+
+  // Returns the number of bytes to reserve at the start of a buffer of the
+  // given size so that any payload that fits after them can be encoded in
+  // place. The payload length is reserved for the largest possible payload.
+  size_t PayloadOffset(size_t buffer_size) const;
+
+  // Encodes the packet without copying the payload. The payload must already
+  // start at buffer[PayloadOffset(buffer.size())]; the header fields are
+  // written in front of it, padded to exactly fill the reserved space.
+  Result<ConstByteSpan> EncodeInPlace(ByteSpan buffer) const;
+
+  // True if the payload is positioned so that EncodeInPlace may be used.
+  bool PayloadIsInPlace(ConstByteSpan buffer) const;
+
   enum Destination : bool { kServer, kClient };
 
   constexpr Destination destination() const {
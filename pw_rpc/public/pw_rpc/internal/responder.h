@@ -17,10 +17,12 @@
 #include <span>
 #include <utility>
 
-#include "pw_containers/intrusive_list.h"
+#include "pw_containers/intrusive_dlist.h"
+#include "pw_function/function.h"
 #include "pw_rpc/internal/call.h"
 #include "pw_rpc/internal/channel.h"
 #include "pw_rpc/internal/method.h"
+#include "pw_rpc/internal/method_type.h"
 #include "pw_rpc/service.h"
 #include "pw_status/status.h"
 
@@ -35,13 +37,25 @@ class Packet;
 // Internal RPC Responder class. The Responder is used to respond to any type of
 // RPC. Public classes like ServerWriters inherit from it and provide a public
 // API for their use case.
-class Responder : public IntrusiveList<Responder>::Item {
+//
+// Unary Responders are used by methods that defer their response. Like
+// streaming Responders, they are registered with the server, so that they can
+// be cancelled, and each also holds one of the server's deferred call slots.
+class Responder : public IntrusiveDList<Responder>::Item {
  public:
-  Responder(ServerCall& call);
+  Responder(ServerCall& call,
+            MethodType type = MethodType::kServerStreaming);
 
   Responder(const Responder&) = delete;
 
-  Responder(Responder&& other) : state_(kClosed) { *this = std::move(other); }
+  Responder(Responder&& other)
+      : type_(MethodType::kServerStreaming),
+        state_(kClosed),
+        client_stream_open_(false),
+        flow_controlled_(false),
+        credits_(0) {
+    *this = std::move(other);
+  }
 
   ~Responder() { Finish(); }
 
@@ -56,11 +70,40 @@ class Responder : public IntrusiveList<Responder>::Item {
   uint32_t service_id() const { return call_.service().id(); }
   uint32_t method_id() const;
 
-  // Closes the Responder, if it is open.
+  // True if the client may still send CLIENT_STREAM packets for this call.
+  // Only client and bidirectional streaming calls have a client stream.
+  bool client_stream_open() const { return client_stream_open_; }
+
+  // True if the client has granted credits for this call with a
+  // CLIENT_FLOW_CONTROL packet. Once it has, each streamed response uses one
+  // credit, and writes fail with UNAVAILABLE while no credits remain. Calls
+  // whose client never grants credits are not flow controlled.
+  bool flow_controlled() const { return flow_controlled_; }
+
+  // The number of responses that may be streamed before the client grants
+  // more credits. Only meaningful if flow_controlled() is true.
+  uint32_t credits() const { return credits_; }
+
+  // Sets a callback invoked when the client grants more credits, so a producer
+  // that stopped on UNAVAILABLE can resume writing.
+  void set_on_credits(Function<void()> on_credits) {
+    on_credits_ = std::move(on_credits);
+  }
+
+  // Closes the Responder, if it is open. Server and bidirectional streaming
+  // calls end with a SERVER_STREAM_END packet; unary and client streaming calls
+  // end with a RESPONSE packet with an empty payload.
   Status Finish(Status status = OkStatus());
 
  protected:
-  constexpr Responder() : state_{kClosed} {}
+  constexpr Responder()
+      : type_(MethodType::kServerStreaming),
+        state_{kClosed},
+        client_stream_open_(false),
+        flow_controlled_(false),
+        credits_(0) {}
+
+  MethodType type() const { return type_; }
 
   const Method& method() const { return call_.method(); }
 
@@ -72,23 +115,74 @@ class Responder : public IntrusiveList<Responder>::Item {
   // when this is called!
   std::span<std::byte> AcquirePayloadBuffer();
 
+  // Acquires a buffer for a payload of at most max_payload_size_bytes. The
+  // channel is asked for a buffer that fits exactly that payload.
+  std::span<std::byte> AcquirePayloadBuffer(size_t max_payload_size_bytes);
+
   // Releases the buffer, sending a packet with the specified payload. The
-  // Responder MUST be open when this is called!
+  // Responder MUST be open when this is called! If the call is flow controlled
+  // and out of credits, the buffer is released without sending and UNAVAILABLE
+  // is returned.
   Status ReleasePayloadBuffer(std::span<const std::byte> payload);
 
   // Releases the buffer without sending a packet.
   Status ReleasePayloadBuffer();
 
+  // Copies the payload into the output buffer, if it is not already there, and
+  // sends it in a RESPONSE packet. Used by the streaming writer classes.
+  Status WritePayload(std::span<const std::byte> payload);
+
+  // Closes the Responder and sends a RESPONSE packet with the provided payload
+  // and status. This is how unary and client streaming calls complete.
+  Status CloseAndSendResponse(std::span<const std::byte> payload,
+                              Status status);
+
+  // Sets the callbacks invoked for the client stream. These are only called
+  // for client and bidirectional streaming calls.
+  void set_on_next(Function<void(std::span<const std::byte>)> on_next) {
+    on_next_ = std::move(on_next);
+  }
+
+  void set_on_client_stream_end(Function<void()> on_client_stream_end) {
+    on_client_stream_end_ = std::move(on_client_stream_end);
+  }
+
  private:
   friend class rpc::Server;
 
   void Close();
 
+  // Called by the server when a CLIENT_STREAM packet arrives for this call.
+  void HandleClientStream(std::span<const std::byte> payload) {
+    if (on_next_) {
+      on_next_(payload);
+    }
+  }
+
+  // Called by the server when a CLIENT_STREAM_END packet arrives.
+  void EndClientStream() {
+    client_stream_open_ = false;
+    if (on_client_stream_end_) {
+      on_client_stream_end_();
+    }
+  }
+
+  // Called by the server when a CLIENT_FLOW_CONTROL packet arrives.
+  void GrantCredits(uint32_t credits);
+
   Packet ResponsePacket(std::span<const std::byte> payload = {}) const;
 
   ServerCall call_;
   Channel::OutputBuffer response_;
+  MethodType type_;
   enum { kClosed, kOpen } state_;
+  bool client_stream_open_;
+  bool flow_controlled_;
+  uint32_t credits_;
+
+  Function<void(std::span<const std::byte>)> on_next_;
+  Function<void()> on_client_stream_end_;
+  Function<void()> on_credits_;
 };
 
 }  // namespace internal
@@ -0,0 +1,27 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+
+#include "pw_rpc/internal/call_index.h"
+#include "pw_rpc/internal/responder.h"
+
+namespace pw::rpc::internal {
+
+// Index of the open Responders for a server.
+template <size_t kCapacity>
+using ResponderIndex = CallIndex<Responder, kCapacity>;
+
+}  // namespace pw::rpc::internal
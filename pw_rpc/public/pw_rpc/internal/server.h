@@ -13,6 +13,10 @@
 // the License.
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+
+#include "pw_rpc/internal/config.h"
 #include "pw_rpc/server.h"
 
 namespace pw::rpc::internal {
@@ -21,9 +25,32 @@ class Server : public rpc::Server {
  public:
   Server() = delete;
 
-  void RegisterResponder(Responder& writer) { writers().push_front(writer); }
+  void RegisterResponder(Responder& writer) {
+    writers().push_front(writer);
+    responder_index().Add(writer);
+  }
+
+  void RemoveResponder(Responder& writer) {
+    writers().remove(writer);
+    responder_index().Remove(writer);
+  }
+
+  // Reserves one of the PW_RPC_MAX_DEFERRED_UNARY_CALLS slots for a unary call
+  // that responds after its method returns. Returns false if none are free.
+  bool AcquireDeferredCall() {
+    size_t count = deferred_calls().load(std::memory_order_relaxed);
+    do {
+      if (count >= cfg::kMaxDeferredUnaryCalls) {
+        return false;
+      }
+    } while (!deferred_calls().compare_exchange_weak(
+        count, count + 1, std::memory_order_relaxed));
+    return true;
+  }
 
-  void RemoveResponder(const Responder& writer) { writers().remove(writer); }
+  void ReleaseDeferredCall() {
+    deferred_calls().fetch_sub(1, std::memory_order_relaxed);
+  }
 };
 
 }  // namespace pw::rpc::internal
@@ -0,0 +1,123 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_rpc/internal/method.h"
+#include "pw_rpc/internal/method_lookup.h"
+#include "pw_rpc/internal/method_union.h"
+
+namespace pw::rpc::internal {
+
+// A method of a service whose methods are known at compile time. The entry
+// refers to the service by its index in the server's array of services.
+struct StaticMethodEntry {
+  uint32_t service_id;
+  uint32_t method_id;
+  uint16_t service_index;
+  const MethodUnion* method;
+
+  constexpr bool operator<(const StaticMethodEntry& other) const {
+    return service_id != other.service_id ? service_id < other.service_id
+                                          : method_id < other.method_id;
+  }
+};
+
+// Finds the entry with the provided IDs in a sorted table. Returns nullptr if
+// there is no such method.
+inline const StaticMethodEntry* FindStaticMethod(
+    std::span<const StaticMethodEntry> table,
+    uint32_t service_id,
+    uint32_t method_id) {
+  const StaticMethodEntry key{service_id, method_id, 0, nullptr};
+  const auto entry = std::lower_bound(table.begin(), table.end(), key);
+  if (entry == table.end() || entry->service_id != service_id ||
+      entry->method_id != method_id) {
+    return nullptr;
+  }
+  return &(*entry);
+}
+
+// Builds a table of every method of the Services at compile time, sorted by
+// service ID and then method ID, from the tables in their generated classes.
+template <typename... Services>
+class StaticMethodTable {
+ public:
+  static constexpr size_t kMethodCount =
+      (MethodLookup::GetMethodIds<Services>().size() + ... + 0);
+
+  using Table = std::array<StaticMethodEntry, kMethodCount>;
+
+  static constexpr Table Build() {
+    Table table{};
+    size_t count = 0;
+    uint16_t service_index = 0;
+    (Append<Services>(table, count, service_index++), ...);
+
+    // Insertion sort, since std::sort is not constexpr in C++17.
+    for (size_t i = 1; i < table.size(); ++i) {
+      for (size_t j = i; j > 0 && table[j] < table[j - 1]; --j) {
+        const StaticMethodEntry entry = table[j];
+        table[j] = table[j - 1];
+        table[j - 1] = entry;
+      }
+    }
+    return table;
+  }
+
+  static constexpr Table kTable = Build();
+
+  // True if no two Services have the same service ID, which also catches a
+  // service listed twice, and no service has two methods with the same ID.
+  static constexpr bool IsUnique() {
+    constexpr std::array<uint32_t, sizeof...(Services)> kServiceIds = {
+        MethodLookup::GetServiceId<Services>()...};
+    for (size_t i = 0; i < kServiceIds.size(); ++i) {
+      for (size_t j = i + 1; j < kServiceIds.size(); ++j) {
+        if (kServiceIds[i] == kServiceIds[j]) {
+          return false;
+        }
+      }
+    }
+
+    for (size_t i = 1; i < kTable.size(); ++i) {
+      if (!(kTable[i - 1] < kTable[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  template <typename Service>
+  static constexpr void Append(Table& table,
+                               size_t& count,
+                               uint16_t service_index) {
+    const auto& ids = MethodLookup::GetMethodIds<Service>();
+    const auto& methods = MethodLookup::GetMethodUnions<Service>();
+    for (size_t i = 0; i < ids.size(); ++i) {
+      table[count++] = {MethodLookup::GetServiceId<Service>(),
+                        ids[i],
+                        service_index,
+                        &methods[i]};
+    }
+  }
+};
+
+}  // namespace pw::rpc::internal
@@ -0,0 +1,170 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_containers/vector.h"
+#include "pw_metric/metric.h"
+#include "pw_rpc/server_observer.h"
+
+namespace pw::rpc {
+namespace internal {
+
+// The metrics for one RPC method. The group is named by the method ID, which
+// is the same hash of the method name that pw_tokenizer uses for tokens.
+class MethodStats {
+ public:
+  MethodStats(uint32_t service_id, uint32_t method_id, metric::Group& service)
+      : service_id_(service_id),
+        method_id_(method_id),
+        metrics_(method_id, service.children()) {}
+
+  MethodStats(const MethodStats&) = delete;
+  MethodStats& operator=(const MethodStats&) = delete;
+
+  bool Is(uint32_t service_id, uint32_t method_id) const {
+    return service_id_ == service_id && method_id_ == method_id;
+  }
+
+  metric::Group& metrics() { return metrics_; }
+
+  uint32_t calls() const { return calls_.value(); }
+  uint32_t bytes_in() const { return bytes_in_.value(); }
+  uint32_t bytes_out() const { return bytes_out_.value(); }
+  uint32_t total_time_us() const { return total_time_us_.value(); }
+  uint32_t max_time_us() const { return max_time_us_.value(); }
+
+ private:
+  friend class BaseMethodMetrics;
+
+  const uint32_t service_id_;
+  const uint32_t method_id_;
+
+  metric::Group metrics_;
+  PW_METRIC(metrics_, calls_, "calls", 0u);
+  PW_METRIC(metrics_, bytes_in_, "bytes_in", 0u);
+  PW_METRIC(metrics_, bytes_out_, "bytes_out", 0u);
+  PW_METRIC(metrics_, total_time_us_, "total_time_us", 0u);
+  PW_METRIC(metrics_, max_time_us_, "max_time_us", 0u);
+};
+
+// A group of method metrics for one service, named by the service ID.
+class ServiceStats {
+ public:
+  ServiceStats(uint32_t id, metric::Group& parent)
+      : metrics_(id, parent.children()) {}
+
+  ServiceStats(const ServiceStats&) = delete;
+  ServiceStats& operator=(const ServiceStats&) = delete;
+
+  uint32_t id() const { return metrics_.name(); }
+
+  metric::Group& metrics() { return metrics_; }
+
+ private:
+  metric::Group metrics_;
+};
+
+// The implementation of MethodMetrics, which provides the storage.
+class BaseMethodMetrics : public ServerObserver {
+ public:
+  // The group that holds every service's metrics. Pass it to a MetricService
+  // to read the metrics from a device.
+  metric::Group& group() { return group_; }
+  const metric::Group& group() const { return group_; }
+
+  // Returns the metrics for a method, or nullptr if it has not been called or
+  // did not fit.
+  const MethodStats* Find(uint32_t service_id, uint32_t method_id) const;
+
+  // The number of packets for methods that did not fit.
+  uint32_t untracked_packets() const { return untracked_packets_.value(); }
+
+  void PacketReceived(uint32_t service_id,
+                      uint32_t method_id,
+                      size_t size_bytes) override;
+
+  void PacketSent(uint32_t service_id,
+                  uint32_t method_id,
+                  size_t size_bytes) override;
+
+  void InvocationStarted(uint32_t service_id, uint32_t method_id) override;
+
+  void InvocationFinished(uint32_t service_id, uint32_t method_id) override;
+
+ protected:
+  BaseMethodMetrics(Vector<ServiceStats>& services,
+                    Vector<MethodStats>& methods)
+      : services_(services), methods_(methods) {}
+
+ private:
+  MethodStats* FindMutable(uint32_t service_id, uint32_t method_id) {
+    return const_cast<MethodStats*>(Find(service_id, method_id));
+  }
+
+  // Finds a method's metrics, adding them if there is room.
+  MethodStats* FindOrAdd(uint32_t service_id, uint32_t method_id);
+
+  Vector<ServiceStats>& services_;
+  Vector<MethodStats>& methods_;
+
+  // The start of the invocation in progress. Methods are invoked from the
+  // thread that processes packets, so only one is timed at once.
+  chrono::SystemClock::time_point invocation_start_;
+
+  PW_METRIC_GROUP(group_, "rpc_methods");
+
+  // Packets for methods that did not fit in the table.
+  PW_METRIC(group_, untracked_packets_, "untracked_packets", 0u);
+};
+
+}  // namespace internal
+
+// Records the number of calls, bytes received and sent, and invocation time of
+// each RPC method in pw_metric metrics. The metrics for each method are in a
+// group named by the method ID, inside a group named by the service ID, both
+// under group(). Install it on a server with Server::set_observer().
+//
+//   pw::rpc::MethodMetrics<2, 8> rpc_metrics;
+//   pw::metric::MetricService metric_service(pw::metric::global_metrics,
+//                                            pw::metric::global_groups);
+//
+//   pw::metric::global_groups.push_front(rpc_metrics.group());
+//   server.set_observer(&rpc_metrics);
+//
+// Methods are added the first time a packet for them is received, up to
+// kMaxMethods across kMaxServices services. Packets for other methods are
+// counted in the "untracked_packets" metric.
+//
+// The invocation time is the time spent in the method function for a REQUEST.
+// It does not include deferred or streamed responses sent later; those count
+// towards bytes_out only. Like other pw_metric metrics, these are not updated
+// atomically, so responses sent from other threads may race with the packet
+// processing thread.
+template <size_t kMaxServices, size_t kMaxMethods>
+class MethodMetrics : public internal::BaseMethodMetrics {
+ public:
+  static_assert(kMaxServices <= kMaxMethods);
+
+  MethodMetrics() : BaseMethodMetrics(services_, methods_) {}
+
+ private:
+  Vector<internal::ServiceStats, kMaxServices> services_;
+  Vector<internal::MethodStats, kMaxMethods> methods_;
+};
+
+}  // namespace pw::rpc
@@ -0,0 +1,224 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/server.h"
+#include "pw_rpc/service.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+
+namespace pw::rpc {
+
+// Assigns a priority to the packets for a channel or service. Priority 0 is the
+// highest.
+class PacketPriority {
+ public:
+  static constexpr PacketPriority ForChannel(uint32_t channel_id,
+                                             uint8_t priority) {
+    return PacketPriority(kChannel, channel_id, priority);
+  }
+
+  static constexpr PacketPriority ForService(uint32_t service_id,
+                                             uint8_t priority) {
+    return PacketPriority(kService, service_id, priority);
+  }
+
+  static PacketPriority ForService(const Service& service, uint8_t priority) {
+    return ForService(service.id(), priority);
+  }
+
+  constexpr bool Matches(uint32_t channel_id, uint32_t service_id) const {
+    return id_ == (type_ == kChannel ? channel_id : service_id);
+  }
+
+  constexpr uint8_t priority() const { return priority_; }
+
+ private:
+  enum Type : bool { kChannel, kService };
+
+  constexpr PacketPriority(Type type, uint32_t id, uint8_t priority)
+      : type_(type), priority_(priority), id_(id) {}
+
+  Type type_;
+  uint8_t priority_;
+  uint32_t id_;
+};
+
+namespace internal {
+
+// The implementation of PacketScheduler, which provides the storage.
+class BasePacketScheduler {
+ public:
+  BasePacketScheduler(const BasePacketScheduler&) = delete;
+  BasePacketScheduler& operator=(const BasePacketScheduler&) = delete;
+
+  // Copies a received packet into the queue for its priority. Returns:
+  //
+  //   OK - The packet was queued.
+  //   DATA_LOSS - The packet could not be decoded.
+  //   RESOURCE_EXHAUSTED - The packet is too large or its queue is full.
+  //
+  // Packets are only decoded far enough to find their priority. Enqueue may be
+  // called from interrupts and from several threads at once.
+  Status Enqueue(ConstByteSpan packet, ChannelOutput& interface)
+      PW_LOCKS_EXCLUDED(lock_);
+
+  // Passes queued packets to the server, highest priority first, until the
+  // queues are empty or max_packets packets have been processed. The queues are
+  // checked again after each packet, so a high priority packet that arrives
+  // during the drain is processed next. Draining stops at a packet that is
+  // still being enqueued. Only one thread may call this at once.
+  //
+  // Like Server::ProcessPackets, the returned size is the number of packets
+  // processed successfully and the status is the error for the first packet
+  // that failed.
+  StatusWithSize Drain(rpc::Server& server,
+                       size_t max_packets = std::numeric_limits<size_t>::max())
+      PW_LOCKS_EXCLUDED(lock_);
+
+  // The number of packets waiting to be processed.
+  size_t queued_packets() const PW_LOCKS_EXCLUDED(lock_);
+  size_t queued_packets(uint8_t priority) const PW_LOCKS_EXCLUDED(lock_);
+
+  // The priority for a packet for the given channel and service.
+  uint8_t PriorityFor(uint32_t channel_id, uint32_t service_id) const;
+
+ protected:
+  // The ring buffer of packets for one priority.
+  struct Queue {
+    size_t head;
+    size_t count;
+  };
+
+  // Where a queued packet was received from.
+  struct QueuedPacket {
+    ChannelOutput* interface;
+    size_t size;  // kFilling while the packet is copied in.
+  };
+
+  BasePacketScheduler(std::span<const PacketPriority> priorities,
+                      uint8_t default_priority,
+                      size_t queue_depth,
+                      size_t packet_size,
+                      std::span<Queue> queues,
+                      std::span<QueuedPacket> packets,
+                      ByteSpan buffers);
+
+ private:
+  friend class PacketSchedulerTester;
+
+  // Marks a slot that has been reserved but not yet filled.
+  static constexpr size_t kFilling = std::numeric_limits<size_t>::max();
+
+  // Counts a slot at the back of a priority's queue and marks it as filling.
+  // Returns RESOURCE_EXHAUSTED if the queue is full.
+  Result<size_t> Reserve(uint8_t priority) PW_LOCKS_EXCLUDED(lock_);
+
+  // Records the packet copied into a reserved slot.
+  void Commit(size_t index, ChannelOutput& interface, size_t size)
+      PW_LOCKS_EXCLUDED(lock_);
+
+  size_t slot(uint8_t priority, size_t position) const {
+    return priority * queue_depth_ + position % queue_depth_;
+  }
+
+  ByteSpan buffer(size_t slot) const {
+    return buffers_.subspan(slot * packet_size_, packet_size_);
+  }
+
+  const std::span<const PacketPriority> priorities_;
+  const uint8_t default_priority_;
+  const size_t queue_depth_;
+  const size_t packet_size_;
+
+  mutable sync::InterruptSpinLock lock_;
+  const std::span<Queue> queues_ PW_GUARDED_BY(lock_);
+  const std::span<QueuedPacket> packets_ PW_GUARDED_BY(lock_);
+
+  // Each slot's buffer is only written by the thread that reserved it, before
+  // it is committed, and only read by the draining thread after that.
+  const ByteSpan buffers_;
+};
+
+}  // namespace internal
+
+// Queues received packets by priority in front of a Server, so that packets for
+// latency-sensitive channels or services are handled before earlier packets
+// for other ones. Each priority has its own queue of kQueueDepth packets of up
+// to kPacketSizeBytes, so a flood of low priority packets cannot take space
+// from higher priorities.
+//
+// The thread or interrupt that receives packets passes them to Enqueue()
+// instead of Server::ProcessPacket. The RPC thread calls Drain() to process
+// them, for example when signaled that packets are waiting.
+//
+//   constexpr pw::rpc::PacketPriority kPriorities[] = {
+//       pw::rpc::PacketPriority::ForService(kMotorControlServiceId, 0),
+//       pw::rpc::PacketPriority::ForChannel(kDebugChannelId, 2),
+//   };
+//
+//   // 3 priorities, 4 packets of up to 256 bytes each. Other packets get the
+//   // default priority, 1.
+//   pw::rpc::PacketScheduler<3, 4, 256> scheduler(kPriorities, 1);
+//
+//   void OnPacketReceived(pw::ConstByteSpan packet) {
+//     scheduler.Enqueue(packet, uart_output);
+//     rpc_thread_notification.release();
+//   }
+//
+//   void RpcThread() {
+//     while (true) {
+//       rpc_thread_notification.acquire();
+//       scheduler.Drain(server);
+//     }
+//   }
+//
+// A packet's priority is set by the first PacketPriority that matches its
+// channel or service ID. Packets that match none get the default priority,
+// which is the lowest one unless specified.
+template <size_t kPriorities, size_t kQueueDepth, size_t kPacketSizeBytes>
+class PacketScheduler : public internal::BasePacketScheduler {
+ public:
+  static_assert(kPriorities > 0u);
+  static_assert(kPriorities <= std::numeric_limits<uint8_t>::max());
+  static_assert(kQueueDepth > 0u);
+
+  PacketScheduler(std::span<const PacketPriority> priorities,
+                  uint8_t default_priority = kPriorities - 1)
+      : BasePacketScheduler(priorities,
+                            default_priority,
+                            kQueueDepth,
+                            kPacketSizeBytes,
+                            queues_,
+                            packets_,
+                            buffers_) {}
+
+ private:
+  std::array<Queue, kPriorities> queues_;
+  std::array<QueuedPacket, kPriorities * kQueueDepth> packets_;
+  std::array<std::byte, kPriorities * kQueueDepth * kPacketSizeBytes> buffers_;
+};
+
+}  // namespace pw::rpc
@@ -13,17 +13,27 @@
 // the License.
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <span>
 #include <tuple>
 
+#include "pw_allocator/arena.h"
+#include "pw_bytes/span.h"
+#include "pw_containers/intrusive_dlist.h"
 #include "pw_containers/intrusive_list.h"
 #include "pw_rpc/channel.h"
 #include "pw_rpc/internal/channel.h"
+#include "pw_rpc/internal/config.h"
 #include "pw_rpc/internal/method.h"
+#include "pw_rpc/internal/method_index.h"
 #include "pw_rpc/internal/responder.h"
+#include "pw_rpc/internal/responder_index.h"
+#include "pw_rpc/internal/static_method_table.h"
+#include "pw_rpc/server_observer.h"
 #include "pw_rpc/service.h"
 #include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
 
 namespace pw::rpc {
 
@@ -37,7 +47,10 @@ class Server {
 
   // Registers a service with the server. This should not be called directly
   // with a Service; instead, use a generated class which inherits from it.
-  void RegisterService(Service& service) { services_.push_front(service); }
+  void RegisterService(Service& service) {
+    services_.push_front(service);
+    method_index_.Add(service);
+  }
 
   // Processes an RPC packet. The packet may contain an RPC request or a control
   // packet, the result of which is processed in this function. Returns whether
@@ -50,25 +63,104 @@ class Server {
   Status ProcessPacket(std::span<const std::byte> packet,
                        ChannelOutput& interface);
 
+  // Processes a burst of RPC packets received together on one interface, such
+  // as frames from a single DMA transfer. Each packet is handled as if passed
+  // to ProcessPacket, in order, but the channel and method found for a packet
+  // are reused for following packets with the same IDs.
+  //
+  // The returned size is the number of packets processed successfully. The
+  // status is OK if all were processed, or the error for the first packet that
+  // failed. Packets after a failure are still processed.
+  StatusWithSize ProcessPackets(std::span<const ConstByteSpan> packets,
+                                ChannelOutput& interface);
+
   constexpr size_t channel_count() const { return channels_.size(); }
 
+  // Installs an observer that is notified about the packets the server receives
+  // and sends, for example a MethodMetrics. Pass nullptr to remove it. The
+  // observer must outlive the server or be removed first.
+  void set_observer(ServerObserver* observer);
+
+  // Provides a scratch arena to RPC handlers through
+  // ServerContext::scratch_arena(). The arena is rolled back after each
+  // handler returns, so per-request temporaries share one region instead of
+  // each handler reserving worst-case stack. Memory from the arena must not be
+  // used after the handler returns, e.g. by a deferred response or a stream
+  // writer. Pass nullptr to remove the arena.
+  //
+  // The arena must only be used by the thread that processes packets.
+  void set_scratch_arena(allocator::Arena* arena) { scratch_arena_ = arena; }
+
+  allocator::Arena* scratch_arena() const { return scratch_arena_; }
+
  protected:
-  IntrusiveList<internal::Responder>& writers() { return writers_; }
+  // For StaticServer: services whose methods are found in a table built at
+  // compile time. The services array is indexed by the table's service_index.
+  constexpr Server(std::span<Channel> channels,
+                   std::span<const internal::StaticMethodEntry> static_methods,
+                   Service* const* static_services)
+      : channels_(static_cast<internal::Channel*>(channels.data()),
+                  channels.size()),
+        static_methods_(static_methods),
+        static_services_(static_services) {}
+
+  IntrusiveDList<internal::Responder>& writers() { return writers_; }
+
+  internal::ResponderIndex<cfg::kResponderIndexSize>& responder_index() {
+    return responder_index_;
+  }
+
+  std::atomic<size_t>& deferred_calls() { return deferred_calls_; }
 
  private:
+  // The most recently resolved channel and method, reused across a burst of
+  // packets in ProcessPackets.
+  struct LookupCache {
+    internal::Channel* channel = nullptr;
+    Service* service = nullptr;
+    const internal::Method* method = nullptr;
+  };
+
+  Status ProcessPacket(std::span<const std::byte> data,
+                       ChannelOutput& interface,
+                       LookupCache& cache);
+
   std::tuple<Service*, const internal::Method*> FindMethod(
       const internal::Packet& packet);
 
+  internal::Responder* FindResponder(const internal::Packet& packet);
+
+  void HandleClientStreamPacket(const internal::Packet& packet,
+                                internal::Channel& channel);
+  void HandleClientStreamEndPacket(const internal::Packet& packet);
+
   void HandleCancelPacket(const internal::Packet& request,
                           internal::Channel& channel);
+  void HandleFlowControlPacket(const internal::Packet& packet,
+                               internal::Channel& channel);
   void HandleClientError(const internal::Packet& packet);
 
+  // Invokes a method for a request, notifying the observer and rolling back
+  // the scratch arena afterwards.
+  void InvokeMethod(internal::ServerCall& call,
+                    const internal::Packet& request);
+
   internal::Channel* FindChannel(uint32_t id) const;
   internal::Channel* AssignChannel(uint32_t id, ChannelOutput& interface);
 
   std::span<internal::Channel> channels_;
+  std::span<const internal::StaticMethodEntry> static_methods_;
+  Service* const* static_services_ = nullptr;
   IntrusiveList<Service> services_;
-  IntrusiveList<internal::Responder> writers_;
+  internal::MethodIndex<cfg::kMethodIndexSize> method_index_;
+  IntrusiveDList<internal::Responder> writers_;
+  internal::ResponderIndex<cfg::kResponderIndexSize> responder_index_;
+  ServerObserver* observer_ = nullptr;
+  allocator::Arena* scratch_arena_ = nullptr;
+
+  // The number of unary calls whose responses are deferred. Deferred calls may
+  // finish from other threads, so this is atomic.
+  std::atomic<size_t> deferred_calls_{0};
 };
 
 }  // namespace pw::rpc
@@ -16,6 +16,7 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "pw_allocator/arena.h"
 #include "pw_rpc/internal/call.h"
 
 namespace pw::rpc {
@@ -32,6 +33,11 @@ class ServerContext : private internal::ServerCall {
   // Returns the ID for the channel this RPC is using.
   uint32_t channel_id() const { return channel().id(); }
 
+  // Returns the server's scratch arena, or nullptr if it has none. Memory
+  // allocated from the arena is released when the handler returns. See
+  // Server::set_scratch_arena().
+  allocator::Arena* scratch_arena() const;
+
   constexpr ServerContext() = delete;
 
   constexpr ServerContext(const ServerContext&) = delete;
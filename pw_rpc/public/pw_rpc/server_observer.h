@@ -0,0 +1,53 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pw::rpc {
+
+// Receives notifications about the packets a Server handles, for example to
+// profile RPC methods. An observer is installed with Server::set_observer().
+//
+// PacketReceived and the invocation functions are called from the thread that
+// calls Server::ProcessPacket. PacketSent is called from whichever thread sends
+// the packet, which may differ for deferred and streaming responses.
+//
+// Received packets are only reported for methods registered with the server.
+class ServerObserver {
+ public:
+  virtual ~ServerObserver() = default;
+
+  // Called when a packet for a method is received, before it is handled. The
+  // size is the size of the encoded packet.
+  virtual void PacketReceived(uint32_t /* service_id */,
+                              uint32_t /* method_id */,
+                              size_t /* size_bytes */) {}
+
+  // Called after a packet for a method is sent successfully. The size is the
+  // size of the encoded packet.
+  virtual void PacketSent(uint32_t /* service_id */,
+                          uint32_t /* method_id */,
+                          size_t /* size_bytes */) {}
+
+  // Called immediately before and after the server invokes a method to handle
+  // a REQUEST packet.
+  virtual void InvocationStarted(uint32_t /* service_id */,
+                                 uint32_t /* method_id */) {}
+  virtual void InvocationFinished(uint32_t /* service_id */,
+                                  uint32_t /* method_id */) {}
+};
+
+}  // namespace pw::rpc
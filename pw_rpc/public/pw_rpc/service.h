@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <span>
@@ -23,6 +24,12 @@
 #include "pw_rpc/internal/method_union.h"
 
 namespace pw::rpc {
+namespace internal {
+
+template <size_t>
+class MethodIndex;
+
+}  // namespace internal
 
 // Base class for all RPC services. This cannot be instantiated directly; use a
 // generated subclass instead.
@@ -57,9 +64,21 @@ class Service : public IntrusiveList<Service>::Item {
   friend class Server;
   friend class ServiceTestHelper;
 
+  template <size_t>
+  friend class internal::MethodIndex;
+
   // Finds the method with the provided method_id. Returns nullptr if no match.
   const internal::Method* FindMethod(uint32_t method_id) const;
 
+  // Returns the method at the provided index, which must be less than
+  // method_count_.
+  const internal::Method& MethodAt(size_t index) const {
+    const auto raw = reinterpret_cast<const std::byte*>(methods_);
+    return reinterpret_cast<const internal::MethodUnion*>(raw +
+                                                          index * method_size_)
+        ->method();
+  }
+
   const uint32_t id_;
   const internal::MethodUnion* const methods_;
   const uint16_t method_size_;
@@ -0,0 +1,172 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_rpc/channel.h"
+#include "pw_status/status.h"
+
+namespace pw::rpc {
+
+// A single-producer, single-consumer ring of fixed-size packet slots in memory
+// that is shared by two cores. One core writes packets into the ring and the
+// other reads them in place, so no framing, escaping, or copying is needed.
+//
+// Each core constructs a SharedMemoryRing over the same region with the same
+// max_packet_size. Exactly one of them calls Init() before either uses the
+// ring. The region starts with a header of two counters, which are only ever
+// written by one side each, followed by the slots:
+//
+//   [ head | tail ][ size | packet ... ][ size | packet ... ] ...
+//
+// The counters are std::atomics accessed with acquire and release ordering,
+// which orders the slot contents with the counters on cores that share a
+// coherent view of the region. On cores with data caches, the region must be
+// mapped as non-cacheable or shared.
+class SharedMemoryRing {
+ public:
+  static constexpr size_t kHeaderSizeBytes = 2 * sizeof(uint32_t);
+
+  // The number of bytes each slot uses for a packet of up to max_packet_size.
+  static constexpr size_t SlotSizeBytes(size_t max_packet_size) {
+    return sizeof(uint32_t) + (max_packet_size + sizeof(uint32_t) - 1) /
+                                  sizeof(uint32_t) * sizeof(uint32_t);
+  }
+
+  // The size of a region that holds slot_count slots.
+  static constexpr size_t RequiredSizeBytes(size_t slot_count,
+                                            size_t max_packet_size) {
+    return kHeaderSizeBytes + slot_count * SlotSizeBytes(max_packet_size);
+  }
+
+  // The region must be 4-byte aligned and large enough for at least one slot.
+  // Space past the last whole slot is unused.
+  SharedMemoryRing(ByteSpan memory, size_t max_packet_size);
+
+  SharedMemoryRing(const SharedMemoryRing&) = delete;
+  SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+  // Empties the ring. Called by one core before either core uses the ring.
+  void Init();
+
+  size_t slot_count() const { return slot_count_; }
+  size_t max_packet_size() const { return max_packet_size_; }
+
+  // The number of packets written but not yet released by the reader.
+  size_t queued_packets() const;
+
+  // Producer side. Returns the next slot to write a packet into, or an empty
+  // span if every slot holds a packet that has not been read. Repeated calls
+  // return the same slot until it is committed.
+  ByteSpan AcquireSlot();
+
+  // Producer side. Publishes the packet written at the start of the acquired
+  // slot to the reader. Packets may not be empty.
+  void CommitSlot(size_t packet_size);
+
+  // Consumer side. Returns the oldest unread packet, in shared memory, or an
+  // empty span if there are none. The packet stays valid until ReleaseSlot().
+  ConstByteSpan PeekSlot() const;
+
+  // Consumer side. Returns the oldest packet's slot to the producer.
+  void ReleaseSlot();
+
+  // Consumer side. Calls function with each queued packet, in order, and
+  // releases each slot after the function returns. Packets the producer
+  // commits while this runs are also processed. Returns the number of packets.
+  //
+  //   rx_ring.ProcessPackets([](pw::ConstByteSpan packet) {
+  //     server.ProcessPacket(packet, output);
+  //   });
+  //
+  template <typename Function>
+  size_t ProcessPackets(Function&& function) {
+    size_t count = 0;
+    for (ConstByteSpan packet = PeekSlot(); !packet.empty();
+         packet = PeekSlot()) {
+      function(packet);
+      ReleaseSlot();
+      count += 1;
+    }
+    return count;
+  }
+
+ private:
+  struct Header {
+    std::atomic<uint32_t> head;  // Packets committed; written by the producer.
+    std::atomic<uint32_t> tail;  // Packets released; written by the consumer.
+  };
+
+  static_assert(sizeof(Header) == kHeaderSizeBytes);
+  static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                "Shared memory counters must be lock free");
+
+  Header& header() const { return *reinterpret_cast<Header*>(memory_.data()); }
+
+  std::byte* slot(uint32_t count) const {
+    return memory_.data() + kHeaderSizeBytes +
+           (count % slot_count_) * slot_size_;
+  }
+
+  const ByteSpan memory_;
+  const size_t max_packet_size_;
+  const size_t slot_size_;
+  const size_t slot_count_;
+};
+
+// A ChannelOutput that sends packets to another core through a
+// SharedMemoryRing. AcquireBuffer() returns a slot in shared memory, so the
+// packet is encoded directly into the ring and the other core processes it
+// from there.
+//
+// Override RingDoorbell() to raise the interrupt that tells the other core that
+// packets are waiting. That core's interrupt handler wakes a thread, which
+// passes them to its server or client with SharedMemoryRing::ProcessPackets().
+//
+//   class RadioCoreOutput : public pw::rpc::SharedMemoryChannelOutput {
+//    public:
+//     RadioCoreOutput() : SharedMemoryChannelOutput("radio core", tx_ring) {}
+//
+//    private:
+//     void RingDoorbell() override { IPC->DOORBELL = 1; }
+//   };
+//
+// If every slot is full, AcquireBuffer() returns an empty buffer and the RPC's
+// send fails rather than blocking. Like other ChannelOutputs, this class is not
+// thread safe, since the ring has a single producer. It may be wrapped with a
+// SynchronizedChannelOutput.
+class SharedMemoryChannelOutput : public ChannelOutput {
+ public:
+  constexpr SharedMemoryChannelOutput(const char* name, SharedMemoryRing& ring)
+      : ChannelOutput(name), ring_(ring) {}
+
+  std::span<std::byte> AcquireBuffer() override;
+
+  // Commits the packet to the ring and rings the doorbell. Empty buffers leave
+  // the slot uncommitted.
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override;
+
+ private:
+  // Called after each packet is committed to the ring.
+  virtual void RingDoorbell() {}
+
+  SharedMemoryRing& ring_;
+};
+
+}  // namespace pw::rpc
@@ -0,0 +1,69 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "pw_rpc/channel.h"
+#include "pw_rpc/internal/static_method_table.h"
+#include "pw_rpc/server.h"
+
+namespace pw::rpc {
+namespace internal {
+
+// Holds a StaticServer's services. This is a base class so that it is
+// initialized before the Server that refers to it.
+template <size_t kServiceCount>
+struct StaticServiceArray {
+  std::array<Service*, kServiceCount> services;
+};
+
+}  // namespace internal
+
+// A Server whose services are fixed at compile time. The table of every
+// (service ID, method ID) pair is built from the generated service classes
+// when the program is compiled, so nothing is registered at runtime and a
+// request is dispatched with a binary search of a constant table and a call to
+// the method's invoker.
+//
+//   EchoService echo_service;
+//   TransferService transfer_service;
+//
+//   pw::rpc::StaticServer<EchoService, TransferService> server(
+//       channels, echo_service, transfer_service);
+//
+// Services may still be registered with RegisterService(), for example ones
+// that are only present in some configurations. Those are found as in a Server
+// after the static table is searched.
+template <typename... Services>
+class StaticServer
+    : private internal::StaticServiceArray<sizeof...(Services)>,
+      public Server {
+ public:
+  constexpr StaticServer(std::span<Channel> channels, Services&... services)
+      : internal::StaticServiceArray<sizeof...(Services)>{{&services...}},
+        Server(channels, Table::kTable, this->services.data()) {}
+
+ private:
+  using Table = internal::StaticMethodTable<Services...>;
+
+  static_assert(sizeof...(Services) > 0u, "StaticServer needs a service");
+  static_assert(Table::IsUnique(),
+                "The services of a StaticServer must have distinct service "
+                "IDs, and each service must have distinct method IDs");
+};
+
+}  // namespace pw::rpc
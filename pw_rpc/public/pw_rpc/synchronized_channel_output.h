@@ -38,6 +38,12 @@ class PW_LOCKABLE("pw::rpc::SynchronizedChannelOutput")
     return BaseChannelOutput::AcquireBuffer();
   }
 
+  std::span<std::byte> AcquireBufferForSize(size_t size_hint) final
+      PW_EXCLUSIVE_LOCK_FUNCTION() {
+    mutex_.lock();
+    return BaseChannelOutput::AcquireBufferForSize(size_hint);
+  }
+
   Status SendAndReleaseBuffer(std::span<const std::byte> buffer) final
       PW_UNLOCK_FUNCTION() {
     Status status = BaseChannelOutput::SendAndReleaseBuffer(buffer);
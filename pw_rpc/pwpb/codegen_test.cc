@@ -0,0 +1,150 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "gtest/gtest.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/encoder.h"
+#include "pw_rpc/internal/hash.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_rpc/server.h"
+#include "pw_rpc_private/internal_test_utils.h"
+#include "pw_rpc_test_protos/test.pwpb.h"
+#include "pw_rpc_test_protos/test.rpc.pwpb.h"
+
+namespace pw::rpc {
+namespace test {
+
+class TestService final : public generated::TestService<TestService> {
+ public:
+  Status TestRpc(ServerContext&,
+                 protobuf::Decoder& request,
+                 TestResponse::RamEncoder& response) {
+    int64_t integer = 0;
+    uint32_t status_code = 0;
+    while (request.Next().ok()) {
+      switch (static_cast<TestRequest::Fields>(request.FieldNumber())) {
+        case TestRequest::Fields::INTEGER:
+          request.ReadInt64(&integer);
+          break;
+        case TestRequest::Fields::STATUS_CODE:
+          request.ReadUint32(&status_code);
+          break;
+      }
+    }
+
+    response.WriteValue(static_cast<int32_t>(integer + 1));
+    return static_cast<Status::Code>(status_code);
+  }
+
+  void TestStreamRpc(ServerContext&,
+                     protobuf::Decoder&,
+                     PwpbServerWriter<TestStreamResponse::RamEncoder>& writer) {
+    writer_ = std::move(writer);
+  }
+
+  void TestClientStreamRpc(ServerContext&, RawServerReader&) {}
+
+  void TestBidirectionalStreamRpc(ServerContext&, RawServerReaderWriter&) {}
+
+  PwpbServerWriter<TestStreamResponse::RamEncoder>& writer() { return writer_; }
+
+ private:
+  PwpbServerWriter<TestStreamResponse::RamEncoder> writer_;
+};
+
+}  // namespace test
+
+namespace {
+
+using internal::Packet;
+using internal::PacketType;
+
+class PwpbCodegen : public ::testing::Test {
+ protected:
+  PwpbCodegen()
+      : channels_{Channel::Create<1>(&output_)}, server_(channels_) {
+    server_.RegisterService(service_);
+  }
+
+  void SendRequest(uint32_t method_id, int64_t integer, uint32_t status) {
+    std::byte payload_buffer[16];
+    protobuf::NestedEncoder encoder(payload_buffer);
+    test::TestRequest::Encoder request(&encoder);
+    request.WriteInteger(integer);
+    request.WriteStatusCode(status);
+
+    std::byte packet_buffer[64];
+    Packet packet(PacketType::REQUEST,
+                  1,
+                  service_.id(),
+                  method_id,
+                  encoder.Encode().value());
+    auto encoded = packet.Encode(packet_buffer);
+    ASSERT_EQ(OkStatus(), encoded.status());
+    ASSERT_EQ(OkStatus(), server_.ProcessPacket(encoded.value(), output_));
+  }
+
+  TestOutput<128> output_;
+  std::array<Channel, 1> channels_;
+  Server server_;
+  test::TestService service_;
+};
+
+TEST(PwpbCodegenIds, Service_HasCorrectName) {
+  test::TestService service;
+  EXPECT_STREQ(service.name(), "TestService");
+  EXPECT_EQ(service.id(), internal::Hash("pw.rpc.test.TestService"));
+}
+
+TEST_F(PwpbCodegen, UnaryRpc_InvokesPwpbMethod) {
+  SendRequest(internal::Hash("TestRpc"), 122, 5);
+
+  const Packet& response = output_.sent_packet();
+  EXPECT_EQ(response.type(), PacketType::RESPONSE);
+  EXPECT_EQ(response.method_id(), internal::Hash("TestRpc"));
+  EXPECT_EQ(response.status(), Status::NotFound());
+
+  protobuf::Decoder decoder(response.payload());
+  ASSERT_EQ(OkStatus(), decoder.Next());
+  int32_t value;
+  EXPECT_EQ(OkStatus(), decoder.ReadInt32(&value));
+  EXPECT_EQ(value, 123);
+}
+
+TEST_F(PwpbCodegen, ServerStreamingRpc_WritesEncodedResponses) {
+  SendRequest(internal::Hash("TestStreamRpc"), 0, 0);
+
+  ASSERT_TRUE(service_.writer().open());
+  EXPECT_EQ(0u, output_.packet_count());
+
+  for (uint32_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(OkStatus(),
+              service_.writer().Write(
+                  [i](test::TestStreamResponse::RamEncoder& response) {
+                    response.WriteNumber(i);
+                  }));
+
+    protobuf::Decoder decoder(output_.sent_packet().payload());
+    ASSERT_EQ(OkStatus(), decoder.Next());
+    uint32_t number;
+    EXPECT_EQ(OkStatus(), decoder.ReadUint32(&number));
+    EXPECT_EQ(number, i);
+  }
+
+  EXPECT_EQ(OkStatus(), service_.writer().Finish());
+  EXPECT_EQ(output_.sent_packet().type(), PacketType::SERVER_STREAM_END);
+}
+
+}  // namespace
+}  // namespace pw::rpc
@@ -0,0 +1,265 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <type_traits>
+
+#include "pw_bytes/span.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/serialized_size.h"
+#include "pw_protobuf/streaming_encoder.h"
+#include "pw_rpc/internal/method.h"
+#include "pw_rpc/internal/method_type.h"
+#include "pw_rpc/internal/responder.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pw::rpc {
+
+// The PwpbServerWriter is used to send responses in a pw_protobuf server
+// streaming RPC. Encoder is the generated RamEncoder class for the response
+// message, such as my_pkg::MyResponse::RamEncoder.
+template <typename Encoder>
+class PwpbServerWriter : public internal::Responder {
+ public:
+  static_assert(std::is_base_of_v<protobuf::MemoryEncoder, Encoder>,
+                "PwpbServerWriter requires a generated RamEncoder class");
+
+  constexpr PwpbServerWriter() = default;
+  PwpbServerWriter(PwpbServerWriter&&) = default;
+  PwpbServerWriter& operator=(PwpbServerWriter&&) = default;
+
+  // Encodes a response directly into the channel's output buffer and sends it.
+  // The encode function is called with an Encoder for the response message:
+  //
+  //   writer.Write([&](MyResponse::RamEncoder& response) {
+  //     response.WriteNumber(42);
+  //   });
+  //
+  // Returns the following Status codes:
+  //
+  //   OK - the response was successfully sent
+  //   FAILED_PRECONDITION - the writer is closed
+  //   INTERNAL - the response did not fit in the buffer or failed to encode
+  //   UNAVAILABLE - the call is flow controlled and out of credits
+  //   other errors - the ChannelOutput failed to send the packet; the error
+  //       codes are determined by the ChannelOutput implementation
+  //
+  template <typename EncodeFunction>
+  Status Write(EncodeFunction&& encode);
+};
+
+namespace internal {
+
+// A PwpbMethod is a method invoker for pw_protobuf RPCs. Requests are passed to
+// the user-defined function as a protobuf::Decoder over the request payload,
+// and responses are written with the generated RamEncoder for the response
+// message directly into the channel's output buffer. No message structs are
+// decoded or copied, and no field descriptor tables are used, so requests and
+// responses are processed by straight-line code.
+//
+// Only unary and server streaming RPCs are supported. Client and bidirectional
+// streaming RPCs in pw_protobuf services are implemented as raw methods.
+//
+// Generated services pass the response message's kMaxEncodedSizeBytes as
+// max_response_size_bytes. When it is bounded, response buffers are acquired
+// with a size hint for exactly the largest response, rather than the channel's
+// default buffer size.
+class PwpbMethod : public Method {
+ public:
+  template <auto method, typename ResponseEncoder>
+  static constexpr bool matches() {
+    if constexpr (std::is_same_v<MethodImplementation<method>, PwpbMethod>) {
+      return std::is_same_v<
+          typename MethodTraits<decltype(method)>::ResponseEncoder,
+          ResponseEncoder>;
+    } else {
+      return false;
+    }
+  }
+
+  template <auto method>
+  static constexpr PwpbMethod Unary(
+      uint32_t id,
+      size_t max_response_size_bytes = protobuf::kMaxSizeUnbounded) {
+    using Encoder = typename MethodTraits<decltype(method)>::ResponseEncoder;
+
+    constexpr UnaryFunction wrapper = [](ServerCall& call,
+                                         ConstByteSpan request,
+                                         ByteSpan response,
+                                         Status& status) {
+      protobuf::Decoder decoder(request);
+      Encoder encoder(response);
+      status = CallMethodImplFunction<method>(call, decoder, encoder);
+      return EncodedSize(encoder);
+    };
+    return PwpbMethod(id,
+                      UnaryInvoker,
+                      Function{.unary = wrapper},
+                      max_response_size_bytes);
+  }
+
+  template <auto method>
+  static constexpr PwpbMethod ServerStreaming(
+      uint32_t id,
+      size_t max_response_size_bytes = protobuf::kMaxSizeUnbounded) {
+    using Encoder = typename MethodTraits<decltype(method)>::ResponseEncoder;
+
+    constexpr ServerStreamingFunction wrapper =
+        [](ServerCall& call, ConstByteSpan request, Responder& writer) {
+          protobuf::Decoder decoder(request);
+          CallMethodImplFunction<method>(
+              call, decoder, static_cast<PwpbServerWriter<Encoder>&>(writer));
+        };
+    return PwpbMethod(id,
+                      ServerStreamingInvoker,
+                      Function{.server_streaming = wrapper},
+                      max_response_size_bytes);
+  }
+
+  // Represents an invalid method. Used to reduce error message verbosity.
+  static constexpr PwpbMethod Invalid() {
+    return {0, InvalidInvoker, {}, protobuf::kMaxSizeUnbounded};
+  }
+
+  // The largest encoded size of this method's response message, or
+  // protobuf::kMaxSizeUnbounded if it has no limit.
+  constexpr size_t max_response_size_bytes() const {
+    return max_response_size_bytes_;
+  }
+
+  // Returns the size of the encoded response, or INTERNAL if the encoder
+  // failed, for example because the response did not fit in the buffer.
+  static StatusWithSize EncodedSize(const protobuf::MemoryEncoder& encoder) {
+    if (!encoder.status().ok()) {
+      return StatusWithSize::Internal();
+    }
+    return StatusWithSize(encoder.size());
+  }
+
+ private:
+  // Unary RPCs return the size of the encoded response, or INTERNAL if it
+  // failed to encode. The status returned by the RPC is set in the Status
+  // argument.
+  using UnaryFunction = StatusWithSize (*)(ServerCall&,
+                                           ConstByteSpan,
+                                           ByteSpan,
+                                           Status&);
+
+  using ServerStreamingFunction = void (*)(ServerCall&,
+                                           ConstByteSpan,
+                                           Responder&);
+
+  union Function {
+    UnaryFunction unary;
+    ServerStreamingFunction server_streaming;
+  };
+
+  constexpr PwpbMethod(uint32_t id,
+                       Invoker invoker,
+                       Function function,
+                       size_t max_response_size_bytes)
+      : Method(id, invoker),
+        function_(function),
+        max_response_size_bytes_(max_response_size_bytes) {}
+
+  static void UnaryInvoker(const Method& method,
+                           ServerCall& call,
+                           const Packet& request) {
+    static_cast<const PwpbMethod&>(method).CallUnary(call, request);
+  }
+
+  static void ServerStreamingInvoker(const Method& method,
+                                     ServerCall& call,
+                                     const Packet& request) {
+    static_cast<const PwpbMethod&>(method).CallServerStreaming(call, request);
+  }
+
+  void CallUnary(ServerCall& call, const Packet& request) const;
+  void CallServerStreaming(ServerCall& call, const Packet& request) const;
+
+  // Stores the user-defined RPC in a generic wrapper.
+  Function function_;
+
+  size_t max_response_size_bytes_;
+};
+
+// MethodTraits specialization for a static pw_protobuf unary method.
+template <typename Encoder>
+struct MethodTraits<Status (*)(ServerContext&, protobuf::Decoder&, Encoder&)> {
+  using Implementation = PwpbMethod;
+  static constexpr MethodType kType = MethodType::kUnary;
+  using ResponseEncoder = Encoder;
+};
+
+// MethodTraits specialization for a pw_protobuf unary method.
+template <typename T, typename Encoder>
+struct MethodTraits<Status (T::*)(
+    ServerContext&, protobuf::Decoder&, Encoder&)> {
+  using Implementation = PwpbMethod;
+  static constexpr MethodType kType = MethodType::kUnary;
+  using ResponseEncoder = Encoder;
+  using Service = T;
+};
+
+// MethodTraits specialization for a static pw_protobuf server streaming method.
+template <typename Encoder>
+struct MethodTraits<void (*)(
+    ServerContext&, protobuf::Decoder&, PwpbServerWriter<Encoder>&)> {
+  using Implementation = PwpbMethod;
+  static constexpr MethodType kType = MethodType::kServerStreaming;
+  using ResponseEncoder = Encoder;
+};
+
+// MethodTraits specialization for a pw_protobuf server streaming method.
+template <typename T, typename Encoder>
+struct MethodTraits<void (T::*)(
+    ServerContext&, protobuf::Decoder&, PwpbServerWriter<Encoder>&)> {
+  using Implementation = PwpbMethod;
+  static constexpr MethodType kType = MethodType::kServerStreaming;
+  using ResponseEncoder = Encoder;
+  using Service = T;
+};
+
+}  // namespace internal
+
+template <typename Encoder>
+template <typename EncodeFunction>
+Status PwpbServerWriter<Encoder>::Write(EncodeFunction&& encode) {
+  if (!open()) {
+    return Status::FailedPrecondition();
+  }
+
+  const size_t max_size_bytes =
+      static_cast<const internal::PwpbMethod&>(method())
+          .max_response_size_bytes();
+  const ByteSpan buffer = max_size_bytes == protobuf::kMaxSizeUnbounded
+                              ? AcquirePayloadBuffer()
+                              : AcquirePayloadBuffer(max_size_bytes);
+  StatusWithSize encoded;
+  {
+    Encoder encoder(buffer);
+    encode(encoder);
+    encoded = internal::PwpbMethod::EncodedSize(encoder);
+  }
+
+  if (encoded.ok()) {
+    return ReleasePayloadBuffer(buffer.first(encoded.size()));
+  }
+
+  ReleasePayloadBuffer();
+  return Status::Internal();
+}
+
+}  // namespace pw::rpc
@@ -0,0 +1,60 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_bytes/span.h"
+#include "pw_rpc/internal/method_union.h"
+#include "pw_rpc/internal/pwpb_method.h"
+#include "pw_rpc/internal/raw_method_union.h"
+
+namespace pw::rpc::internal {
+
+// Method union which holds either a pw_protobuf or a raw method.
+class PwpbMethodUnion : public MethodUnion {
+ public:
+  constexpr PwpbMethodUnion(RawMethod&& method)
+      : impl_({.raw = std::move(method)}) {}
+  constexpr PwpbMethodUnion(PwpbMethod&& method)
+      : impl_({.pwpb = std::move(method)}) {}
+
+  constexpr const Method& method() const { return impl_.method; }
+  constexpr const RawMethod& raw_method() const { return impl_.raw; }
+  constexpr const PwpbMethod& pwpb_method() const { return impl_.pwpb; }
+
+ private:
+  union {
+    Method method;
+    RawMethod raw;
+    PwpbMethod pwpb;
+  } impl_;
+};
+
+// Returns either a raw or pw_protobuf method object, depending on the
+// implemented function's signature. ResponseEncoder is the generated RamEncoder
+// class for the method's response message, and max_response_size_bytes is its
+// generated kMaxEncodedSizeBytes.
+template <auto method, MethodType type, typename ResponseEncoder>
+constexpr auto GetPwpbOrRawMethodFor(
+    uint32_t id,
+    size_t max_response_size_bytes = protobuf::kMaxSizeUnbounded) {
+  if constexpr (RawMethod::matches<method>()) {
+    return GetMethodFor<method, RawMethod, type>(id);
+  } else if constexpr (PwpbMethod::matches<method, ResponseEncoder>()) {
+    return GetMethodFor<method, PwpbMethod, type>(id, max_response_size_bytes);
+  } else {
+    return InvalidMethod<method, type, RawMethod>(id);
+  }
+};
+
+}  // namespace pw::rpc::internal
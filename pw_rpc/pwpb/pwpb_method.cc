@@ -0,0 +1,66 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/internal/pwpb_method.h"
+
+#include "pw_log/log.h"
+#include "pw_rpc/internal/packet.h"
+
+namespace pw::rpc::internal {
+
+void PwpbMethod::CallUnary(ServerCall& call, const Packet& request) const {
+  // If the response's size is bounded, ask the channel for a buffer that fits
+  // exactly the largest response.
+  Channel::OutputBuffer response_buffer =
+      max_response_size_bytes_ == protobuf::kMaxSizeUnbounded
+          ? call.channel().AcquireBuffer()
+          : call.channel().AcquireBuffer(
+                Packet::Response(request).BufferSizeBytesForPayload(
+                    max_response_size_bytes_));
+  std::span payload_buffer = response_buffer.payload(request);
+
+  Status status;
+  const StatusWithSize encoded =
+      function_.unary(call, request.payload(), payload_buffer, status);
+
+  if (encoded.ok()) {
+    Packet response = Packet::Response(request);
+
+    response.set_payload(payload_buffer.first(encoded.size()));
+    response.set_status(status);
+    if (call.channel().Send(response_buffer, response).ok()) {
+      return;
+    }
+
+    PW_LOG_WARN("Failed to send response packet for channel %u",
+                unsigned(call.channel().id()));
+
+    // Re-acquire the buffer to encode an error packet.
+    response_buffer = call.channel().AcquireBuffer();
+  } else {
+    PW_LOG_WARN("pw_protobuf failed to encode response packet for channel %u",
+                unsigned(call.channel().id()));
+  }
+
+  call.channel().Send(response_buffer,
+                      Packet::ServerError(request, Status::Internal()));
+}
+
+void PwpbMethod::CallServerStreaming(ServerCall& call,
+                                     const Packet& request) const {
+  internal::Responder server_writer(call);
+  function_.server_streaming(call, request.payload(), server_writer);
+}
+
+}  // namespace pw::rpc::internal
@@ -0,0 +1,320 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/internal/pwpb_method.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/encoder.h"
+#include "pw_rpc/internal/pwpb_method_union.h"
+#include "pw_rpc/server_context.h"
+#include "pw_rpc/service.h"
+#include "pw_rpc_private/internal_test_utils.h"
+#include "pw_rpc_private/method_impl_tester.h"
+#include "pw_rpc_test_protos/test.pwpb.h"
+
+namespace pw::rpc::internal {
+namespace {
+
+namespace TestRequest = test::TestRequest;
+namespace TestResponse = test::TestResponse;
+namespace TestStreamResponse = test::TestStreamResponse;
+
+// Create a fake service for use with the MethodImplTester.
+class TestPwpbService final : public Service {
+ public:
+  Status Unary(ServerContext&, protobuf::Decoder&, TestResponse::RamEncoder&) {
+    return OkStatus();
+  }
+
+  static Status StaticUnary(ServerContext&,
+                            protobuf::Decoder&,
+                            TestResponse::RamEncoder&) {
+    return OkStatus();
+  }
+
+  void ServerStreaming(ServerContext&,
+                       protobuf::Decoder&,
+                       PwpbServerWriter<TestStreamResponse::RamEncoder>&) {}
+
+  static void StaticServerStreaming(
+      ServerContext&,
+      protobuf::Decoder&,
+      PwpbServerWriter<TestStreamResponse::RamEncoder>&) {}
+
+  Status UnaryWrongArg(ServerContext&,
+                       ConstByteSpan,
+                       TestResponse::RamEncoder&) {
+    return OkStatus();
+  }
+
+  static void StaticUnaryVoidReturn(ServerContext&,
+                                    protobuf::Decoder&,
+                                    TestResponse::RamEncoder&) {}
+
+  Status ServerStreamingBadReturn(
+      ServerContext&,
+      protobuf::Decoder&,
+      PwpbServerWriter<TestStreamResponse::RamEncoder>&) {
+    return Status();
+  }
+
+  static void StaticServerStreamingMissingArg(
+      protobuf::Decoder&, PwpbServerWriter<TestStreamResponse::RamEncoder>&) {}
+};
+
+// Test that the matches() function matches valid signatures.
+static_assert(PwpbMethod::matches<&TestPwpbService::Unary,
+                                  TestResponse::RamEncoder>());
+static_assert(PwpbMethod::matches<&TestPwpbService::StaticUnary,
+                                  TestResponse::RamEncoder>());
+static_assert(PwpbMethod::matches<&TestPwpbService::ServerStreaming,
+                                  TestStreamResponse::RamEncoder>());
+static_assert(PwpbMethod::matches<&TestPwpbService::StaticServerStreaming,
+                                  TestStreamResponse::RamEncoder>());
+
+// Test that the matches() function does not match the wrong response type or
+// method signature.
+static_assert(!PwpbMethod::matches<&TestPwpbService::Unary,
+                                   TestStreamResponse::RamEncoder>());
+static_assert(!PwpbMethod::matches<&TestPwpbService::UnaryWrongArg,
+                                   TestResponse::RamEncoder>());
+static_assert(!PwpbMethod::matches<&TestPwpbService::StaticUnaryVoidReturn,
+                                   TestResponse::RamEncoder>());
+static_assert(!PwpbMethod::matches<&TestPwpbService::ServerStreamingBadReturn,
+                                   TestStreamResponse::RamEncoder>());
+static_assert(
+    !PwpbMethod::matches<&TestPwpbService::StaticServerStreamingMissingArg,
+                         TestStreamResponse::RamEncoder>());
+
+TEST(MethodImplTester, PwpbMethod) {
+  constexpr MethodImplTester<PwpbMethod, TestPwpbService> method_tester;
+  EXPECT_TRUE(method_tester.MethodImplIsValid());
+}
+
+struct {
+  int64_t integer;
+  uint32_t status_code;
+} last_request;
+
+PwpbServerWriter<TestStreamResponse::RamEncoder> last_writer;
+
+void DecodeTestRequest(protobuf::Decoder& decoder) {
+  last_request = {};
+
+  while (decoder.Next().ok()) {
+    switch (static_cast<TestRequest::Fields>(decoder.FieldNumber())) {
+      case TestRequest::Fields::INTEGER:
+        decoder.ReadInt64(&last_request.integer);
+        break;
+      case TestRequest::Fields::STATUS_CODE:
+        decoder.ReadUint32(&last_request.status_code);
+        break;
+    }
+  }
+}
+
+Status AddFive(ServerContext&,
+               protobuf::Decoder& request,
+               TestResponse::RamEncoder& response) {
+  DecodeTestRequest(request);
+  response.WriteValue(static_cast<int32_t>(last_request.integer + 5));
+  return Status::Unauthenticated();
+}
+
+Status FillResponse(ServerContext&,
+                    protobuf::Decoder&,
+                    TestStreamResponse::RamEncoder& response) {
+  constexpr std::byte kChunk[64] = {};
+  response.WriteChunk(kChunk);
+  return OkStatus();
+}
+
+void StartStream(ServerContext&,
+                 protobuf::Decoder& request,
+                 PwpbServerWriter<TestStreamResponse::RamEncoder>& writer) {
+  DecodeTestRequest(request);
+  last_writer = std::move(writer);
+}
+
+class FakeService : public Service {
+ public:
+  FakeService(uint32_t id) : Service(id, kMethods) {}
+
+  static constexpr std::array<PwpbMethodUnion, 5> kMethods = {
+      PwpbMethod::Unary<AddFive>(10u),
+      PwpbMethod::Unary<FillResponse>(11u),
+      PwpbMethod::ServerStreaming<StartStream>(12u),
+      PwpbMethod::Unary<AddFive>(13u, 11u),
+      PwpbMethod::ServerStreaming<StartStream>(14u, 6u),
+  };
+};
+
+ConstByteSpan EncodeRequest(ByteSpan buffer,
+                            int64_t integer,
+                            uint32_t status_code) {
+  protobuf::NestedEncoder encoder(buffer);
+  TestRequest::Encoder test_request(&encoder);
+  test_request.WriteInteger(integer);
+  test_request.WriteStatusCode(status_code);
+  return encoder.Encode().value();
+}
+
+TEST(PwpbMethod, UnaryRpc_DecodesRequestAndSendsResponse) {
+  std::byte buffer[16];
+  const PwpbMethod& method = std::get<0>(FakeService::kMethods).pwpb_method();
+  ServerContextForTest<FakeService> context(method);
+  method.Invoke(context.get(),
+                context.packet(EncodeRequest(buffer, 456, 7)));
+
+  EXPECT_EQ(last_request.integer, 456);
+  EXPECT_EQ(last_request.status_code, 7u);
+
+  const Packet& response = context.output().sent_packet();
+  EXPECT_EQ(response.type(), PacketType::RESPONSE);
+  EXPECT_EQ(response.status(), Status::Unauthenticated());
+
+  protobuf::Decoder decoder(response.payload());
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  int32_t value;
+  EXPECT_EQ(decoder.ReadInt32(&value), OkStatus());
+  EXPECT_EQ(value, 461);
+}
+
+TEST(PwpbMethod, UnaryRpc_ResponseTooLarge_SendsInternalError) {
+  const PwpbMethod& method = std::get<1>(FakeService::kMethods).pwpb_method();
+  ServerContextForTest<FakeService, 32> context(method);
+  method.Invoke(context.get(), context.packet({}));
+
+  const Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(packet.type(), PacketType::SERVER_ERROR);
+  EXPECT_EQ(packet.status(), Status::Internal());
+}
+
+TEST(PwpbMethod, MaxResponseSize_DefaultsToUnbounded) {
+  EXPECT_EQ(std::get<0>(FakeService::kMethods)
+                .pwpb_method()
+                .max_response_size_bytes(),
+            protobuf::kMaxSizeUnbounded);
+  EXPECT_EQ(std::get<3>(FakeService::kMethods)
+                .pwpb_method()
+                .max_response_size_bytes(),
+            11u);
+}
+
+TEST(PwpbMethod, UnaryRpc_BoundedResponse_SendsResponse) {
+  std::byte buffer[16];
+  const PwpbMethod& method = std::get<3>(FakeService::kMethods).pwpb_method();
+  ServerContextForTest<FakeService> context(method);
+  method.Invoke(context.get(), context.packet(EncodeRequest(buffer, 1, 0)));
+
+  const Packet& response = context.output().sent_packet();
+  EXPECT_EQ(response.type(), PacketType::RESPONSE);
+
+  protobuf::Decoder decoder(response.payload());
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  int32_t value;
+  EXPECT_EQ(decoder.ReadInt32(&value), OkStatus());
+  EXPECT_EQ(value, 6);
+}
+
+TEST(PwpbMethod, ServerStreamingRpc_SendsNothingWhenInitiallyCalled) {
+  std::byte buffer[16];
+  const PwpbMethod& method = std::get<2>(FakeService::kMethods).pwpb_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(),
+                context.packet(EncodeRequest(buffer, 777, 2)));
+
+  EXPECT_EQ(0u, context.output().packet_count());
+  EXPECT_EQ(777, last_request.integer);
+  EXPECT_EQ(2u, last_request.status_code);
+  EXPECT_TRUE(last_writer.open());
+  EXPECT_EQ(OkStatus(), last_writer.Finish());
+}
+
+TEST(PwpbServerWriter, Write_EncodesIntoOutputBuffer) {
+  const PwpbMethod& method = std::get<2>(FakeService::kMethods).pwpb_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  EXPECT_EQ(OkStatus(),
+            last_writer.Write([](TestStreamResponse::RamEncoder& response) {
+              response.WriteNumber(123);
+            }));
+
+  const Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(packet.type(), PacketType::RESPONSE);
+  EXPECT_EQ(packet.method_id(), context.get().method().id());
+
+  protobuf::Decoder decoder(packet.payload());
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.FieldNumber(),
+            static_cast<uint32_t>(TestStreamResponse::Fields::NUMBER));
+  uint32_t value;
+  EXPECT_EQ(decoder.ReadUint32(&value), OkStatus());
+  EXPECT_EQ(value, 123u);
+
+  EXPECT_EQ(OkStatus(), last_writer.Finish());
+}
+
+TEST(PwpbServerWriter, Write_ResponseTooLarge_ReturnsInternal) {
+  const PwpbMethod& method = std::get<2>(FakeService::kMethods).pwpb_method();
+  ServerContextForTest<FakeService, 32> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  EXPECT_EQ(Status::Internal(),
+            last_writer.Write([](TestStreamResponse::RamEncoder& response) {
+              constexpr std::byte kChunk[64] = {};
+              response.WriteChunk(kChunk);
+            }));
+  EXPECT_EQ(0u, context.output().packet_count());
+
+  EXPECT_EQ(OkStatus(), last_writer.Finish());
+}
+
+TEST(PwpbServerWriter, Write_BoundedResponse_EncodesIntoOutputBuffer) {
+  const PwpbMethod& method = std::get<4>(FakeService::kMethods).pwpb_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  EXPECT_EQ(OkStatus(),
+            last_writer.Write([](TestStreamResponse::RamEncoder& response) {
+              response.WriteNumber(123);
+            }));
+  EXPECT_EQ(context.output().sent_packet().type(), PacketType::RESPONSE);
+
+  EXPECT_EQ(OkStatus(), last_writer.Finish());
+}
+
+TEST(PwpbServerWriter, Write_Closed_ReturnsFailedPrecondition) {
+  const PwpbMethod& method = std::get<2>(FakeService::kMethods).pwpb_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  EXPECT_EQ(OkStatus(), last_writer.Finish());
+  EXPECT_EQ(Status::FailedPrecondition(),
+            last_writer.Write([](TestStreamResponse::RamEncoder& response) {
+              response.WriteNumber(1);
+            }));
+}
+
+}  // namespace
+}  // namespace pw::rpc::internal
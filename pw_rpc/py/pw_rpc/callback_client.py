@@ -46,7 +46,7 @@ import logging
 import queue
 import textwrap
 import threading
-from typing import Any, Callable, Iterator, NamedTuple, Union, Optional
+from typing import Any, Callable, Iterator, List, NamedTuple, Union, Optional
 
 from pw_protobuf_compiler.python_protos import proto_repr
 from pw_status import Status
@@ -478,6 +478,34 @@ class Impl(client.ClientImpl):
             _LOG.exception('Response callback %s for %s raised exception',
                            context.response, rpc)
 
+    def handle_responses(self,
+                         rpc: PendingRpc,
+                         context,
+                         payloads: List[Any],
+                         *,
+                         args: tuple = (),
+                         kwargs: dict = None) -> None:
+        """Invokes the callback for each of a run of streaming responses.
+
+        Stops if a callback raises an exception, which cancels the RPC, or if
+        the RPC is cancelled or restarted from a callback. The rest of the run
+        is dropped.
+        """
+        if kwargs is None:
+            kwargs = {}
+
+        for payload in payloads:
+            try:
+                context.response(rpc, payload, *args, **kwargs)
+            except:  # pylint: disable=bare-except
+                self.rpcs.send_cancel(rpc)
+                _LOG.exception('Response callback %s for %s raised exception',
+                               context.response, rpc)
+                return
+
+            if not self.rpcs.is_pending(rpc, context):
+                return
+
     def handle_completion(self,
                           rpc: PendingRpc,
                           context,
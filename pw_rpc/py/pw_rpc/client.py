@@ -16,8 +16,8 @@
 import abc
 from dataclasses import dataclass
 import logging
-from typing import (Any, Collection, Dict, Iterable, Iterator, NamedTuple,
-                    Optional)
+from typing import (Any, Collection, Dict, Iterable, Iterator, List,
+                    NamedTuple, Optional, Tuple, Union)
 
 from google.protobuf.message import DecodeError
 from pw_status import Status
@@ -127,6 +127,11 @@ class PendingRpcs:
 
         return True
 
+    def is_pending(self, rpc: PendingRpc, context) -> bool:
+        """True if the RPC is pending with this context."""
+        metadata = self._pending.get(rpc)
+        return metadata is not None and metadata.context is context
+
     def get_pending(self, rpc: PendingRpc, status: Optional[Status]):
         """Gets the pending RPC's context. If status is set, clears the RPC."""
         if status is None:
@@ -171,6 +176,32 @@ class ClientImpl(abc.ABC):
           args, kwargs: Arbitrary arguments passed to the ClientImpl
         """
 
+    def handle_responses(self,
+                         rpc: PendingRpc,
+                         context: Any,
+                         payloads: List[Any],
+                         *,
+                         args: tuple = (),
+                         kwargs: dict = None) -> Any:
+        """Handles consecutive streaming responses for one RPC.
+
+        Called by Client.process_packets. The default calls handle_response for
+        each payload; implementations may override it to handle the responses
+        in bulk.
+
+        Args:
+          rpc: Information about the pending RPC
+          context: Arbitrary context object associated with the pending RPC
+          payloads: Protobuf messages, in the order they were received
+          args, kwargs: Arbitrary arguments passed to the ClientImpl
+        """
+        for payload in payloads:
+            self.handle_response(rpc,
+                                 context,
+                                 payload,
+                                 args=args,
+                                 kwargs=kwargs)
+
     @abc.abstractmethod
     def handle_completion(self,
                           rpc: PendingRpc,
@@ -400,11 +431,96 @@ class Client:
           INVALID_ARGUMENT - the packet is for a server, not a client
           NOT_FOUND - the packet's channel ID is not known to this client
         """
+        result = self._route_packet(pw_rpc_raw_packet_data)
+        if isinstance(result, Status):
+            return result
+
+        self._dispatch(*result, impl_args, impl_kwargs)
+        return Status.OK
+
+    def process_packets(self, pw_rpc_raw_packets: Iterable[bytes],
+                        *impl_args, **impl_kwargs) -> List[Status]:
+        """Processes a batch of incoming packets, such as from one read.
+
+        This is equivalent to calling process_packet for each packet, in order,
+        except that consecutive server streaming responses for the same RPC
+        are passed to the ClientImpl together with one handle_responses call.
+        The pending RPC is looked up once for each of these runs, so if a
+        response callback cancels or restarts the RPC, the ClientImpl decides
+        what happens to the rest of the run.
+
+        Args:
+          pw_rpc_raw_packets: raw binary data for RPC packets
+          impl_args: optional positional arguments passed to the ClientImpl
+          impl_kwargs: optional keyword arguments passed to the ClientImpl
+
+        Returns:
+          The status for each packet, as returned by process_packet
+        """
+        statuses: List[Status] = []
+
+        # A run of streaming responses to pass to handle_responses.
+        run_rpc: Optional[PendingRpc] = None
+        run_context: Any = None
+        run_payloads: List[Any] = []
+
+        def finish_run() -> None:
+            nonlocal run_rpc
+            if run_rpc is not None:
+                self._impl.handle_responses(run_rpc,
+                                            run_context,
+                                            run_payloads,
+                                            args=impl_args,
+                                            kwargs=impl_kwargs)
+                run_rpc = None
+                run_payloads.clear()
+
+        for data in pw_rpc_raw_packets:
+            result = self._route_packet(data)
+            if isinstance(result, Status):
+                statuses.append(result)
+                continue
+
+            statuses.append(Status.OK)
+            packet, rpc, channel_client = result
+
+            if (packet.type == PacketType.RESPONSE
+                    and rpc.method.server_streaming):
+                payload = _decode_payload(rpc, packet)
+
+                if rpc != run_rpc or payload is None:
+                    finish_run()
+                    try:
+                        context = self._impl.rpcs.get_pending(rpc, None)
+                    except KeyError:
+                        self._discard(packet, rpc, channel_client)
+                        continue
+
+                    if payload is None:
+                        continue
+
+                    run_rpc = rpc
+                    run_context = context
+
+                run_payloads.append(payload)
+                continue
+
+            finish_run()
+            self._dispatch(packet, rpc, channel_client, impl_args,
+                           impl_kwargs)
+
+        finish_run()
+        return statuses
+
+    def _route_packet(
+        self, data: bytes
+    ) -> Union[Status, Tuple[RpcPacket, PendingRpc, 'ChannelClient']]:
+        """Decodes a packet and finds its RPC, or returns a Status if done."""
         try:
-            packet = packets.decode(pw_rpc_raw_packet_data)
+            packet = packets.decode(data)
         except DecodeError as err:
             _LOG.warning('Failed to decode packet: %s', err)
-            _LOG.debug('Raw packet: %r', pw_rpc_raw_packet_data)
+            _LOG.debug('Raw packet: %r', data)
             return Status.DATA_LOSS
 
         if packets.for_server(packet):
@@ -424,6 +540,12 @@ class Client:
             _LOG.warning('%s', err)
             return Status.OK
 
+        return packet, rpc, channel_client
+
+    def _dispatch(self, packet: RpcPacket, rpc: PendingRpc,
+                  channel_client: 'ChannelClient', impl_args: tuple,
+                  impl_kwargs: dict) -> None:
+        """Passes a routed packet to the ClientImpl."""
         status = _decode_status(rpc, packet)
 
         if packet.type not in (PacketType.RESPONSE,
@@ -431,18 +553,15 @@ class Client:
                                PacketType.SERVER_ERROR):
             _LOG.error('%s: unexpected PacketType %s', rpc, packet.type)
             _LOG.debug('Packet:\n%s', packet)
-            return Status.OK
+            return
 
         payload = _decode_payload(rpc, packet)
 
         try:
             context = self._impl.rpcs.get_pending(rpc, status)
         except KeyError:
-            channel_client.channel.output(  # type: ignore
-                packets.encode_client_error(packet,
-                                            Status.FAILED_PRECONDITION))
-            _LOG.debug('Discarding response for %s, which is not pending', rpc)
-            return Status.OK
+            self._discard(packet, rpc, channel_client)
+            return
 
         if packet.type == PacketType.SERVER_ERROR:
             assert status is not None and not status.ok()
@@ -452,7 +571,7 @@ class Client:
                                     status,
                                     args=impl_args,
                                     kwargs=impl_kwargs)
-            return Status.OK
+            return
 
         if payload is not None:
             self._impl.handle_response(rpc,
@@ -467,7 +586,13 @@ class Client:
                                          args=impl_args,
                                          kwargs=impl_kwargs)
 
-        return Status.OK
+    @staticmethod
+    def _discard(packet: RpcPacket, rpc: PendingRpc,
+                 channel_client: 'ChannelClient') -> None:
+        """Tells the server that a response is for an RPC that is not pending."""
+        channel_client.channel.output(  # type: ignore
+            packets.encode_client_error(packet, Status.FAILED_PRECONDITION))
+        _LOG.debug('Discarding response for %s, which is not pending', rpc)
 
     def _look_up_service_and_method(
             self, packet: RpcPacket,
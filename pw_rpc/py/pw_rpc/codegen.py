@@ -35,6 +35,12 @@ STUB_RESPONSE_TODO = (
 STUB_WRITER_TODO = (
     '// TODO: Send responses with the writer as appropriate for your '
     'application')
+STUB_READER_TODO = (
+    '// TODO: Set the client stream callback and send a response as '
+    'appropriate for your application')
+STUB_READER_WRITER_TODO = (
+    '// TODO: Set the client stream callback and send responses as '
+    'appropriate for your application')
 
 ServerWriterGenerator = Callable[[OutputFile], None]
 MethodGenerator = Callable[[ProtoServiceMethod, int, OutputFile], None]
@@ -195,6 +201,30 @@ class StubGenerator(abc.ABC):
         output.write_line(STUB_WRITER_TODO)
         output.write_line('static_cast<void>(writer);')
 
+    @abc.abstractmethod
+    def client_streaming_signature(self, method: ProtoServiceMethod,
+                                   prefix: str) -> str:
+        """Returns the signature of this client streaming method."""
+
+    def client_streaming_stub(  # pylint: disable=no-self-use
+            self, unused_method: ProtoServiceMethod,
+            output: OutputFile) -> None:
+        """Returns the stub for this client streaming method."""
+        output.write_line(STUB_READER_TODO)
+        output.write_line('static_cast<void>(reader);')
+
+    @abc.abstractmethod
+    def bidirectional_streaming_signature(self, method: ProtoServiceMethod,
+                                          prefix: str) -> str:
+        """Returns the signature of this bidirectional streaming method."""
+
+    def bidirectional_streaming_stub(  # pylint: disable=no-self-use
+            self, unused_method: ProtoServiceMethod,
+            output: OutputFile) -> None:
+        """Returns the stub for this bidirectional streaming method."""
+        output.write_line(STUB_READER_WRITER_TODO)
+        output.write_line('static_cast<void>(reader_writer);')
+
 
 def _select_stub_methods(generator: StubGenerator, method: ProtoServiceMethod):
     if method.type() is ProtoServiceMethod.Type.UNARY:
@@ -204,8 +234,12 @@ def _select_stub_methods(generator: StubGenerator, method: ProtoServiceMethod):
         return (generator.server_streaming_signature,
                 generator.server_streaming_stub)
 
-    raise NotImplementedError(
-        'Client and bidirectional streaming not yet implemented')
+    if method.type() is ProtoServiceMethod.Type.CLIENT_STREAMING:
+        return (generator.client_streaming_signature,
+                generator.client_streaming_stub)
+
+    return (generator.bidirectional_streaming_signature,
+            generator.bidirectional_streaming_stub)
 
 
 _STUBS_COMMENT = r'''
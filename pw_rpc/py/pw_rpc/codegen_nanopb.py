@@ -62,6 +62,13 @@ def _generate_server_writer_alias(output: OutputFile) -> None:
     output.write_line('template <typename T>')
     output.write_line(
         f'using ServerWriter = {RPC_NAMESPACE}::ServerWriter<T>;')
+    output.write_line('template <typename Request, typename Response>')
+    output.write_line('using ServerReader = '
+                      f'{RPC_NAMESPACE}::ServerReader<Request, Response>;')
+    output.write_line('template <typename Request, typename Response>')
+    output.write_line(
+        'using ServerReaderWriter = '
+        f'{RPC_NAMESPACE}::ServerReaderWriter<Request, Response>;')
 
 
 def _generate_code_for_service(service: ProtoService, root: ProtoNode,
@@ -114,8 +121,13 @@ def _generate_code_for_client_method(method: ProtoServiceMethod,
             rpc_error,
         ]
     else:
-        raise NotImplementedError(
-            'Only unary and server streaming RPCs are currently supported')
+        # The server supports client and bidirectional streaming RPCs, but the
+        # Nanopb client does not yet, so no client method is generated.
+        rpc_type = method.type().name.lower().replace('_', ' ')
+        output.write_line()
+        output.write_line(f'// {method.name()} is a {rpc_type} RPC, which the '
+                          'Nanopb client does not support.')
+        return
 
     call_alias = f'{method.name()}Call'
 
@@ -225,6 +237,18 @@ class StubGenerator(codegen.StubGenerator):
             f'const {method.request_type().nanopb_name()}& request, '
             f'ServerWriter<{method.response_type().nanopb_name()}>& writer)')
 
+    def client_streaming_signature(self, method: ProtoServiceMethod,
+                                   prefix: str) -> str:
+        return (f'void {prefix}{method.name()}(ServerContext&, '
+                f'ServerReader<{method.request_type().nanopb_name()}, '
+                f'{method.response_type().nanopb_name()}>& reader)')
+
+    def bidirectional_streaming_signature(self, method: ProtoServiceMethod,
+                                          prefix: str) -> str:
+        return (f'void {prefix}{method.name()}(ServerContext&, '
+                f'ServerReaderWriter<{method.request_type().nanopb_name()}, '
+                f'{method.response_type().nanopb_name()}>& reader_writer)')
+
 
 def process_proto_file(proto_file) -> Iterable[OutputFile]:
     """Generates code for a single .proto file."""
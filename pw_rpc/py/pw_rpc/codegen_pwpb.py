@@ -0,0 +1,150 @@
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""This module generates the code for pw_protobuf pw_rpc services."""
+
+import os
+from typing import Iterable, Iterator
+
+from pw_protobuf.output_file import OutputFile
+from pw_protobuf.proto_tree import ProtoNode, ProtoService, ProtoServiceMethod
+from pw_protobuf.proto_tree import build_node_tree
+from pw_rpc import codegen
+from pw_rpc.codegen import RPC_NAMESPACE
+
+PROTO_H_EXTENSION = '.pwpb.h'
+
+
+def _proto_filename_to_pwpb_header(proto_file: str) -> str:
+    """Returns the generated pw_protobuf header name for a .proto file."""
+    return os.path.splitext(proto_file)[0] + PROTO_H_EXTENSION
+
+
+def _proto_filename_to_generated_header(proto_file: str) -> str:
+    """Returns the generated C++ RPC header name for a .proto file."""
+    filename = os.path.splitext(proto_file)[0]
+    return f'{filename}.rpc{PROTO_H_EXTENSION}'
+
+
+def _encoder(message: ProtoNode) -> str:
+    """Returns the generated pw_protobuf RamEncoder class for a message."""
+    return f'::{message.cpp_namespace()}::RamEncoder'
+
+
+def _max_size(message: ProtoNode) -> str:
+    """Returns the generated largest encoded size of a message."""
+    return f'::{message.cpp_namespace()}::kMaxEncodedSizeBytes'
+
+
+def _generate_method_descriptor(method: ProtoServiceMethod, method_id: int,
+                                output: OutputFile) -> None:
+    """Generates a pw_protobuf method descriptor for an RPC method."""
+
+    impl_method = f'&Implementation::{method.name()}'
+
+    output.write_line(
+        f'{RPC_NAMESPACE}::internal::GetPwpbOrRawMethodFor<{impl_method}, '
+        f'{method.type().cc_enum()}, '
+        f'{_encoder(method.response_type())}>(')
+    output.write_line(f'    0x{method_id:08x},  // Hash of "{method.name()}"')
+    output.write_line(f'    {_max_size(method.response_type())}),')
+
+
+def _generate_server_writer_alias(output: OutputFile) -> None:
+    output.write_line('template <typename T>')
+    output.write_line(
+        f'using PwpbServerWriter = {RPC_NAMESPACE}::PwpbServerWriter<T>;')
+    output.write_line(
+        f'using RawServerReader = {RPC_NAMESPACE}::RawServerReader;')
+    output.write_line('using RawServerReaderWriter = '
+                      f'{RPC_NAMESPACE}::RawServerReaderWriter;')
+
+
+def _generate_code_for_client(unused_service: ProtoService,
+                              unused_root: ProtoNode,
+                              output: OutputFile) -> None:
+    """Outputs client code for an RPC service."""
+    output.write_line('// pw_protobuf RPC clients are not yet implemented.\n')
+
+
+def _generate_code_for_service(service: ProtoService, root: ProtoNode,
+                               output: OutputFile) -> None:
+    """Generates a C++ base class for a pw_protobuf RPC service."""
+    codegen.service_class(service, root, output, _generate_server_writer_alias,
+                          'PwpbMethodUnion', _generate_method_descriptor)
+
+
+def includes(proto_file, unused_package: ProtoNode) -> Iterator[str]:
+    yield '#include "pw_rpc/internal/pwpb_method_union.h"'
+
+    # Include the corresponding pw_protobuf header file for this proto file, in
+    # which the file's message encoders are generated. All other files imported
+    # from the .proto file are #included in there.
+    pwpb_header = _proto_filename_to_pwpb_header(proto_file.name)
+    yield f'#include "{pwpb_header}"'
+
+
+def _generate_code_for_package(proto_file, package: ProtoNode,
+                               output: OutputFile) -> None:
+    """Generates code for a header file corresponding to a .proto file."""
+
+    codegen.package(proto_file, package, output, includes,
+                    _generate_code_for_service, _generate_code_for_client)
+
+
+class StubGenerator(codegen.StubGenerator):
+    def unary_signature(self, method: ProtoServiceMethod, prefix: str) -> str:
+        return (f'::pw::Status {prefix}{method.name()}(ServerContext&, '
+                '::pw::protobuf::Decoder& request, '
+                f'{_encoder(method.response_type())}& response)')
+
+    def unary_stub(self, method: ProtoServiceMethod,
+                   output: OutputFile) -> None:
+        output.write_line(codegen.STUB_REQUEST_TODO)
+        output.write_line('static_cast<void>(request);')
+        output.write_line(codegen.STUB_RESPONSE_TODO)
+        output.write_line('static_cast<void>(response);')
+        output.write_line('return ::pw::Status::Unimplemented();')
+
+    def server_streaming_signature(self, method: ProtoServiceMethod,
+                                   prefix: str) -> str:
+        return (f'void {prefix}{method.name()}(ServerContext&, '
+                '::pw::protobuf::Decoder& request, '
+                f'PwpbServerWriter<{_encoder(method.response_type())}>& '
+                'writer)')
+
+    # pw_protobuf methods do not support client streams, so client and
+    # bidirectional streaming RPCs are implemented as raw methods.
+    def client_streaming_signature(self, method: ProtoServiceMethod,
+                                   prefix: str) -> str:
+        return (f'void {prefix}{method.name()}(ServerContext&, '
+                'RawServerReader& reader)')
+
+    def bidirectional_streaming_signature(self, method: ProtoServiceMethod,
+                                          prefix: str) -> str:
+        return (f'void {prefix}{method.name()}(ServerContext&, '
+                'RawServerReaderWriter& reader_writer)')
+
+
+def process_proto_file(proto_file) -> Iterable[OutputFile]:
+    """Generates code for a single .proto file."""
+
+    _, package_root = build_node_tree(proto_file)
+    output_filename = _proto_filename_to_generated_header(proto_file.name)
+    output_file = OutputFile(output_filename)
+    _generate_code_for_package(proto_file, package_root, output_file)
+
+    output_file.write_line()
+    codegen.package_stubs(package_root, output_file, StubGenerator())
+
+    return [output_file]
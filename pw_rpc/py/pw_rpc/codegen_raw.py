@@ -52,6 +52,10 @@ def _generate_method_descriptor(method: ProtoServiceMethod, method_id: int,
 def _generate_server_writer_alias(output: OutputFile) -> None:
     output.write_line(
         f'using RawServerWriter = {RPC_NAMESPACE}::RawServerWriter;')
+    output.write_line(
+        f'using RawServerReader = {RPC_NAMESPACE}::RawServerReader;')
+    output.write_line('using RawServerReaderWriter = '
+                      f'{RPC_NAMESPACE}::RawServerReaderWriter;')
 
 
 def _generate_code_for_client(unused_service: ProtoService,
@@ -96,6 +100,16 @@ class StubGenerator(codegen.StubGenerator):
         return (f'void {prefix}{method.name()}(ServerContext&, '
                 'pw::ConstByteSpan request, RawServerWriter& writer)')
 
+    def client_streaming_signature(self, method: ProtoServiceMethod,
+                                   prefix: str) -> str:
+        return (f'void {prefix}{method.name()}(ServerContext&, '
+                'RawServerReader& reader)')
+
+    def bidirectional_streaming_signature(self, method: ProtoServiceMethod,
+                                          prefix: str) -> str:
+        return (f'void {prefix}{method.name()}(ServerContext&, '
+                'RawServerReaderWriter& reader_writer)')
+
 
 def process_proto_file(proto_file) -> Iterable[OutputFile]:
     """Generates code for a single .proto file."""
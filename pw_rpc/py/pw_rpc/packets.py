@@ -13,6 +13,8 @@
 # the License.
 """Functions for working with pw_rpc packets."""
 
+from typing import Iterator
+
 from google.protobuf import message
 from pw_status import Status
 
@@ -73,5 +75,45 @@ def encode_cancel(rpc: tuple) -> bytes:
                                 method_id=method).SerializeToString()
 
 
+def encode_flow_control(rpc: tuple, credits: int) -> bytes:
+    channel, service, method = _ids(rpc)
+    return packet_pb2.RpcPacket(
+        type=packet_pb2.PacketType.CLIENT_FLOW_CONTROL,
+        channel_id=channel,
+        service_id=service,
+        method_id=method,
+        payload=packet_pb2.FlowControl(
+            credits=credits).SerializeToString()).SerializeToString()
+
+
 def for_server(packet):
     return packet.type % 2 == 0
+
+
+def split_coalesced(frame: bytes) -> Iterator[bytes]:
+    """Yields the packets in a frame from a C++ CoalescingChannelOutput.
+
+    Each packet in the frame is prefixed with its length as a varint.
+
+    Raises:
+      ValueError: the frame is malformed
+    """
+    index = 0
+    while index < len(frame):
+        size = shift = 0
+        while True:
+            if index >= len(frame) or shift >= 64:
+                raise ValueError('Coalesced frame has a truncated length')
+            byte = frame[index]
+            index += 1
+            size |= (byte & 0x7f) << shift
+            shift += 7
+            if not byte & 0x80:
+                break
+
+        if index + size > len(frame):
+            raise ValueError(
+                f'Coalesced packet of {size} B exceeds the frame size')
+
+        yield frame[index:index + size]
+        index += size
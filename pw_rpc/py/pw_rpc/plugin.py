@@ -19,12 +19,14 @@ import sys
 import google.protobuf.compiler.plugin_pb2 as plugin_pb2
 
 import pw_rpc.codegen_nanopb as codegen_nanopb
+import pw_rpc.codegen_pwpb as codegen_pwpb
 import pw_rpc.codegen_raw as codegen_raw
 
 
 class Codegen(enum.Enum):
     RAW = 0
     NANOPB = 1
+    PWPB = 2
 
 
 def process_proto_request(codegen: Codegen,
@@ -44,6 +46,8 @@ def process_proto_request(codegen: Codegen,
             output_files = codegen_raw.process_proto_file(proto_file)
         elif codegen is Codegen.NANOPB:
             output_files = codegen_nanopb.process_proto_file(proto_file)
+        elif codegen is Codegen.PWPB:
+            output_files = codegen_pwpb.process_proto_file(proto_file)
         else:
             raise NotImplementedError(f'Unknown codegen type {codegen}')
 
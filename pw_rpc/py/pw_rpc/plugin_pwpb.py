@@ -0,0 +1,27 @@
+#!/usr/bin/env python3
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""pw_rpc pw_protobuf protoc plugin."""
+
+import sys
+
+from pw_rpc import plugin
+
+
+def main() -> int:
+    return plugin.main(plugin.Codegen.PWPB)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -354,6 +354,52 @@ class CallbackClientImplTest(unittest.TestCase):
             mock.call(_rpc(stub), Status.OK),
         ])
 
+    def test_process_packets_server_streaming_batch(self):
+        stub = self._service.SomeServerStreaming
+
+        responses = [
+            stub.method.response_type(payload=str(i)) for i in range(5)
+        ]
+        for response in responses:
+            self._enqueue_response(1, stub.method, response=response)
+        self._enqueue_stream_end(1, stub.method, Status.ABORTED)
+
+        self._send_responses_on_request = False
+        callback = mock.Mock()
+        stub.invoke(self._request(magic_number=3), callback, callback)
+
+        packets_to_process = [packet for packet, _ in self._next_packets]
+        self.assertEqual([Status.OK] * 6,
+                         self._client.process_packets(packets_to_process))
+
+        callback.assert_has_calls(
+            [mock.call(_rpc(stub), response) for response in responses] +
+            [mock.call(_rpc(stub), Status.ABORTED)])
+
+    def test_process_packets_callback_exception_drops_rest_of_batch(self):
+        stub = self._service.SomeServerStreaming
+
+        for i in range(3):
+            self._enqueue_response(
+                1,
+                stub.method,
+                response=stub.method.response_type(payload=str(i)))
+
+        self._send_responses_on_request = False
+        callback = mock.Mock(side_effect=ValueError('oh no'))
+        stub.invoke(self._request(magic_number=3), callback)
+
+        # Process the responses directly, but record the CANCEL packet.
+        packets_to_process = [packet for packet, _ in self._next_packets]
+        self._next_packets.clear()
+        self._send_responses_on_request = True
+
+        self._client.process_packets(packets_to_process)
+
+        callback.assert_called_once_with(
+            _rpc(stub), stub.method.response_type(payload='0'))
+        self.assertEqual(self._last_request.type, packet_pb2.PacketType.CANCEL)
+
     def test_ignore_bad_packets_with_pending_rpc(self):
         method = self._service.SomeUnary.method
         service_id = method.service.id
@@ -235,6 +235,16 @@ class ClientTest(unittest.TestCase):
                     self._protos.packages.pw.test2.Request())),
             Status.NOT_FOUND)
 
+    def test_process_packets_returns_status_for_each_packet(self) -> None:
+        self.assertEqual(
+            self._client.process_packets([
+                b'NOT a packet!',
+                RpcPacket(type=PacketType.REQUEST).SerializeToString(),
+                packets.encode_response(
+                    (123, 456, 789),
+                    self._protos.packages.pw.test2.Request()),
+            ]), [Status.DATA_LOSS, Status.INVALID_ARGUMENT, Status.NOT_FOUND])
+
     def test_process_packet_unrecognized_service(self) -> None:
         self.assertIs(
             self._client.process_packet(
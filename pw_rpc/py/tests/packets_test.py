@@ -18,7 +18,7 @@ import unittest
 
 from pw_status import Status
 
-from pw_rpc.internal.packet_pb2 import PacketType, RpcPacket
+from pw_rpc.internal.packet_pb2 import FlowControl, PacketType, RpcPacket
 from pw_rpc import packets
 
 _TEST_REQUEST = RpcPacket(type=PacketType.REQUEST,
@@ -63,6 +63,18 @@ class PacketsTest(unittest.TestCase):
                       service_id=8,
                       method_id=7))
 
+    def test_encode_flow_control(self):
+        data = packets.encode_flow_control((9, 8, 7), 3)
+
+        packet = RpcPacket()
+        packet.ParseFromString(data)
+
+        self.assertEqual(packet.type, PacketType.CLIENT_FLOW_CONTROL)
+        self.assertEqual((packet.channel_id, packet.service_id,
+                          packet.method_id), (9, 8, 7))
+        self.assertEqual(
+            packets.decode_payload(packet, FlowControl).credits, 3)
+
     def test_encode_client_error(self):
         data = packets.encode_client_error(_TEST_REQUEST, Status.NOT_FOUND)
 
@@ -92,6 +104,27 @@ class PacketsTest(unittest.TestCase):
                           method_id=3,
                           payload=RpcPacket(status=321).SerializeToString())))
 
+    def test_split_coalesced(self):
+        first = _TEST_REQUEST.SerializeToString()
+        second = packets.encode_cancel((9, 8, 7))
+
+        # The C++ implementation pads lengths to a fixed number of bytes.
+        frame = (bytes([len(first)]) + first +
+                 bytes([0x80 | len(second), 0x00]) + second)
+
+        self.assertEqual([first, second],
+                         list(packets.split_coalesced(frame)))
+
+    def test_split_coalesced_empty(self):
+        self.assertEqual([], list(packets.split_coalesced(b'')))
+
+    def test_split_coalesced_truncated(self):
+        with self.assertRaises(ValueError):
+            list(packets.split_coalesced(b'\x05abc'))
+
+        with self.assertRaises(ValueError):
+            list(packets.split_coalesced(b'\x80'))
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -15,7 +15,10 @@
 #include "gtest/gtest.h"
 #include "pw_protobuf/decoder.h"
 #include "pw_rpc/internal/hash.h"
+#include "pw_rpc/internal/packet.h"
 #include "pw_rpc/raw_test_method_context.h"
+#include "pw_rpc/server.h"
+#include "pw_rpc_private/internal_test_utils.h"
 #include "pw_rpc_test_protos/test.pwpb.h"
 #include "pw_rpc_test_protos/test.raw_rpc.pb.h"
 
@@ -59,6 +62,41 @@ class TestService final : public generated::TestService<TestService> {
     writer.Finish(status);
   }
 
+  void TestClientStreamRpc(ServerContext&, RawServerReader& reader) {
+    reader.set_on_next([this](ConstByteSpan request) {
+      int64_t integer;
+      Status status;
+      ASSERT_TRUE(DecodeRequest(request, integer, status));
+      sum_ += integer;
+    });
+    reader.set_on_client_stream_end([this]() {
+      ByteSpan buffer = reader_.PayloadBuffer();
+      protobuf::NestedEncoder encoder(buffer);
+      TestStreamResponse::Encoder test_stream_response(&encoder);
+      test_stream_response.WriteNumber(static_cast<uint32_t>(sum_));
+      reader_.Finish(encoder.Encode().value());
+    });
+    reader_ = std::move(reader);
+  }
+
+  void TestBidirectionalStreamRpc(ServerContext&,
+                                  RawServerReaderWriter& reader_writer) {
+    reader_writer.set_on_next([this](ConstByteSpan request) {
+      int64_t integer;
+      Status status;
+      ASSERT_TRUE(DecodeRequest(request, integer, status));
+
+      ByteSpan buffer = reader_writer_.PayloadBuffer();
+      protobuf::NestedEncoder encoder(buffer);
+      TestStreamResponse::Encoder test_stream_response(&encoder);
+      test_stream_response.WriteNumber(static_cast<uint32_t>(integer));
+      reader_writer_.Write(encoder.Encode().value());
+    });
+    reader_writer.set_on_client_stream_end(
+        [this]() { reader_writer_.Finish(OkStatus()); });
+    reader_writer_ = std::move(reader_writer);
+  }
+
  private:
   static bool DecodeRequest(ConstByteSpan request,
                             int64_t& integer,
@@ -89,6 +127,10 @@ class TestService final : public generated::TestService<TestService> {
     EXPECT_TRUE(has_status);
     return has_integer && has_status;
   }
+
+  int64_t sum_ = 0;
+  RawServerReader reader_;
+  RawServerReaderWriter reader_writer_;
 };
 
 }  // namespace test
@@ -158,5 +200,97 @@ TEST(RawCodegen, Server_InvokeServerStreamingRpc) {
   }
 }
 
+// Client and bidirectional streaming RPCs are exercised through a Server, which
+// routes CLIENT_STREAM packets to the open call.
+class RawStreamingCodegen : public ::testing::Test {
+ protected:
+  RawStreamingCodegen()
+      : channels_{Channel::Create<1>(&output_)}, server_(channels_) {
+    server_.RegisterService(service_);
+  }
+
+  void Send(internal::PacketType type,
+            uint32_t method_id,
+            ConstByteSpan payload = {}) {
+    std::byte buffer[64];
+    auto encoded = internal::Packet(type,
+                                    1,
+                                    internal::Hash("pw.rpc.test.TestService"),
+                                    method_id,
+                                    payload)
+                       .Encode(buffer);
+    ASSERT_EQ(OkStatus(), encoded.status());
+    EXPECT_EQ(OkStatus(), server_.ProcessPacket(encoded.value(), output_));
+  }
+
+  void SendRequest(uint32_t method_id, int64_t integer) {
+    std::byte buffer[32];
+    protobuf::NestedEncoder encoder(buffer);
+    test::TestRequest::Encoder test_request(&encoder);
+    test_request.WriteInteger(integer);
+    test_request.WriteStatusCode(OkStatus().code());
+    Send(internal::PacketType::CLIENT_STREAM,
+         method_id,
+         encoder.Encode().value());
+  }
+
+  uint32_t LastResponseNumber() {
+    uint32_t number = 0;
+    protobuf::Decoder decoder(output_.sent_packet().payload());
+    while (decoder.Next().ok()) {
+      if (static_cast<test::TestStreamResponse::Fields>(
+              decoder.FieldNumber()) ==
+          test::TestStreamResponse::Fields::NUMBER) {
+        EXPECT_EQ(OkStatus(), decoder.ReadUint32(&number));
+      }
+    }
+    return number;
+  }
+
+  TestOutput<128> output_;
+  std::array<Channel, 1> channels_;
+  Server server_;
+  test::TestService service_;
+};
+
+TEST_F(RawStreamingCodegen, Server_InvokeClientStreamingRpc) {
+  constexpr uint32_t kMethodId = internal::Hash("TestClientStreamRpc");
+
+  Send(internal::PacketType::REQUEST, kMethodId);
+  SendRequest(kMethodId, 1);
+  SendRequest(kMethodId, 2);
+  SendRequest(kMethodId, 3);
+  EXPECT_EQ(output_.packet_count(), 0u);
+
+  Send(internal::PacketType::CLIENT_STREAM_END, kMethodId);
+
+  ASSERT_EQ(output_.packet_count(), 1u);
+  EXPECT_EQ(output_.sent_packet().type(), internal::PacketType::RESPONSE);
+  EXPECT_EQ(output_.sent_packet().status(), OkStatus());
+  EXPECT_EQ(LastResponseNumber(), 6u);
+}
+
+TEST_F(RawStreamingCodegen, Server_InvokeBidirectionalStreamingRpc) {
+  constexpr uint32_t kMethodId = internal::Hash("TestBidirectionalStreamRpc");
+
+  Send(internal::PacketType::REQUEST, kMethodId);
+  EXPECT_EQ(output_.packet_count(), 0u);
+
+  SendRequest(kMethodId, 11);
+  ASSERT_EQ(output_.packet_count(), 1u);
+  EXPECT_EQ(output_.sent_packet().type(), internal::PacketType::RESPONSE);
+  EXPECT_EQ(LastResponseNumber(), 11u);
+
+  SendRequest(kMethodId, 22);
+  ASSERT_EQ(output_.packet_count(), 2u);
+  EXPECT_EQ(LastResponseNumber(), 22u);
+
+  Send(internal::PacketType::CLIENT_STREAM_END, kMethodId);
+  ASSERT_EQ(output_.packet_count(), 3u);
+  EXPECT_EQ(output_.sent_packet().type(),
+            internal::PacketType::SERVER_STREAM_END);
+  EXPECT_EQ(output_.sent_packet().status(), OkStatus());
+}
+
 }  // namespace
 }  // namespace pw::rpc
@@ -14,6 +14,7 @@
 #pragma once
 
 #include "pw_bytes/span.h"
+#include "pw_function/function.h"
 #include "pw_rpc/internal/method.h"
 #include "pw_rpc/internal/method_type.h"
 #include "pw_rpc/internal/responder.h"
@@ -38,6 +39,86 @@ class RawServerWriter : public internal::Responder {
   Status Write(ConstByteSpan response);
 };
 
+// The RawServerReader is used to receive a stream of raw messages from the
+// client in a client streaming RPC. The RPC completes when Finish is called
+// with the final response.
+class RawServerReader : public internal::Responder {
+ public:
+  RawServerReader() = default;
+  RawServerReader(RawServerReader&&) = default;
+  RawServerReader& operator=(RawServerReader&&) = default;
+
+  ~RawServerReader();
+
+  // Sets the callback invoked with each raw request received from the client.
+  void set_on_next(Function<void(ConstByteSpan)> on_next) {
+    Responder::set_on_next(std::move(on_next));
+  }
+
+  // Sets the callback invoked when the client ends its stream.
+  void set_on_client_stream_end(Function<void()> on_client_stream_end) {
+    Responder::set_on_client_stream_end(std::move(on_client_stream_end));
+  }
+
+  // Returns a buffer in which the response payload can be built.
+  ByteSpan PayloadBuffer() { return AcquirePayloadBuffer(); }
+
+  // Sends the response and completes the RPC. The payload can either be in the
+  // buffer previously acquired from PayloadBuffer(), or an arbitrary external
+  // buffer.
+  Status Finish(ConstByteSpan response, Status status = OkStatus()) {
+    return CloseAndSendResponse(response, status);
+  }
+};
+
+// The RawServerReaderWriter is used for bidirectional streaming RPCs. Raw
+// requests from the client are delivered to the on_next callback, while
+// responses are sent with Write. Finish ends the RPC.
+class RawServerReaderWriter : public internal::Responder {
+ public:
+  RawServerReaderWriter() = default;
+  RawServerReaderWriter(RawServerReaderWriter&&) = default;
+  RawServerReaderWriter& operator=(RawServerReaderWriter&&) = default;
+
+  ~RawServerReaderWriter();
+
+  void set_on_next(Function<void(ConstByteSpan)> on_next) {
+    Responder::set_on_next(std::move(on_next));
+  }
+
+  void set_on_client_stream_end(Function<void()> on_client_stream_end) {
+    Responder::set_on_client_stream_end(std::move(on_client_stream_end));
+  }
+
+  ByteSpan PayloadBuffer() { return AcquirePayloadBuffer(); }
+
+  // Sends a response packet with the given raw payload.
+  Status Write(ConstByteSpan response) { return WritePayload(response); }
+};
+
+// The RawUnaryResponder is used by unary RPCs that defer their response. The
+// method moves the responder out of its arguments, returns, and calls Finish
+// later, for example from a worker thread. The channel's output must support
+// being used from the thread that calls Finish.
+class RawUnaryResponder : public internal::Responder {
+ public:
+  RawUnaryResponder() = default;
+  RawUnaryResponder(RawUnaryResponder&&) = default;
+  RawUnaryResponder& operator=(RawUnaryResponder&&) = default;
+
+  ~RawUnaryResponder();
+
+  // Returns a buffer in which the response payload can be built.
+  ByteSpan PayloadBuffer() { return AcquirePayloadBuffer(); }
+
+  // Sends the response and completes the RPC. The payload can either be in the
+  // buffer previously acquired from PayloadBuffer(), or an arbitrary external
+  // buffer.
+  Status Finish(ConstByteSpan response, Status status = OkStatus()) {
+    return CloseAndSendResponse(response, status);
+  }
+};
+
 namespace internal {
 
 // A RawMethod is a method invoker which does not perform any automatic protobuf
@@ -55,16 +136,26 @@ class RawMethod : public Method {
 
   template <auto method>
   static constexpr RawMethod Unary(uint32_t id) {
-    constexpr UnaryFunction wrapper =
-        [](ServerCall& call, ConstByteSpan req, ByteSpan res) {
-          return CallMethodImplFunction<method>(call, req, res);
-        };
-    return RawMethod(id, UnaryInvoker, Function{.unary = wrapper});
+    if constexpr (kDefersResponse<method>) {
+      constexpr ResponderFunction wrapper =
+          [](ServerCall& call, ConstByteSpan request, Responder& responder) {
+            CallMethodImplFunction<method>(
+                call, request, static_cast<RawUnaryResponder&>(responder));
+          };
+      return RawMethod(
+          id, DeferredUnaryInvoker, Function{.deferred_unary = wrapper});
+    } else {
+      constexpr UnaryFunction wrapper =
+          [](ServerCall& call, ConstByteSpan req, ByteSpan res) {
+            return CallMethodImplFunction<method>(call, req, res);
+          };
+      return RawMethod(id, UnaryInvoker, Function{.unary = wrapper});
+    }
   }
 
   template <auto method>
   static constexpr RawMethod ServerStreaming(uint32_t id) {
-    constexpr ServerStreamingFunction wrapper =
+    constexpr ResponderFunction wrapper =
         [](ServerCall& call, ConstByteSpan request, Responder& writer) {
           CallMethodImplFunction<method>(
               call, request, static_cast<RawServerWriter&>(writer));
@@ -73,6 +164,29 @@ class RawMethod : public Method {
         id, ServerStreamingInvoker, Function{.server_streaming = wrapper});
   }
 
+  template <auto method>
+  static constexpr RawMethod ClientStreaming(uint32_t id) {
+    constexpr StreamRequestFunction wrapper = [](ServerCall& call,
+                                                 Responder& reader) {
+      CallMethodImplFunction<method>(call,
+                                     static_cast<RawServerReader&>(reader));
+    };
+    return RawMethod(
+        id, ClientStreamingInvoker, Function{.stream_request = wrapper});
+  }
+
+  template <auto method>
+  static constexpr RawMethod BidirectionalStreaming(uint32_t id) {
+    constexpr StreamRequestFunction wrapper = [](ServerCall& call,
+                                                 Responder& reader_writer) {
+      CallMethodImplFunction<method>(
+          call, static_cast<RawServerReaderWriter&>(reader_writer));
+    };
+    return RawMethod(id,
+                     BidirectionalStreamingInvoker,
+                     Function{.stream_request = wrapper});
+  }
+
   // Represents an invalid method. Used to reduce error message verbosity.
   static constexpr RawMethod Invalid() { return {0, InvalidInvoker, {}}; }
 
@@ -81,13 +195,19 @@ class RawMethod : public Method {
                                            ConstByteSpan,
                                            ByteSpan);
 
-  using ServerStreamingFunction = void (*)(ServerCall&,
-                                           ConstByteSpan,
-                                           Responder&);
+  // Server streaming and deferred unary RPCs receive the request and a
+  // Responder, so they share a signature.
+  using ResponderFunction = void (*)(ServerCall&, ConstByteSpan, Responder&);
+
+  // Client and bidirectional streaming RPCs receive their requests through
+  // callbacks, so they share a signature.
+  using StreamRequestFunction = void (*)(ServerCall&, Responder&);
+
   union Function {
     UnaryFunction unary;
-    ServerStreamingFunction server_streaming;
-    // TODO(frolv): Support client and bidirectional streaming.
+    ResponderFunction deferred_unary;
+    ResponderFunction server_streaming;
+    StreamRequestFunction stream_request;
   };
 
   constexpr RawMethod(uint32_t id, Invoker invoker, Function function)
@@ -99,14 +219,36 @@ class RawMethod : public Method {
     static_cast<const RawMethod&>(method).CallUnary(call, request);
   }
 
+  static void DeferredUnaryInvoker(const Method& method,
+                                   ServerCall& call,
+                                   const Packet& request) {
+    static_cast<const RawMethod&>(method).CallDeferredUnary(call, request);
+  }
+
   static void ServerStreamingInvoker(const Method& method,
                                      ServerCall& call,
                                      const Packet& request) {
     static_cast<const RawMethod&>(method).CallServerStreaming(call, request);
   }
 
+  static void ClientStreamingInvoker(const Method& method,
+                                     ServerCall& call,
+                                     const Packet&) {
+    static_cast<const RawMethod&>(method).CallStreamRequest(
+        call, MethodType::kClientStreaming);
+  }
+
+  static void BidirectionalStreamingInvoker(const Method& method,
+                                            ServerCall& call,
+                                            const Packet&) {
+    static_cast<const RawMethod&>(method).CallStreamRequest(
+        call, MethodType::kBidirectionalStreaming);
+  }
+
   void CallUnary(ServerCall& call, const Packet& request) const;
+  void CallDeferredUnary(ServerCall& call, const Packet& request) const;
   void CallServerStreaming(ServerCall& call, const Packet& request) const;
+  void CallStreamRequest(ServerCall& call, MethodType type) const;
 
   // Stores the user-defined RPC in a generic wrapper.
   Function function_;
@@ -129,6 +271,25 @@ struct MethodTraits<StatusWithSize (T::*)(
   using Service = T;
 };
 
+// MethodTraits specialization for a static raw unary method that defers its
+// response.
+template <>
+struct MethodTraits<void (*)(ServerContext&, ConstByteSpan, RawUnaryResponder&)> {
+  using Implementation = RawMethod;
+  static constexpr MethodType kType = MethodType::kUnary;
+  static constexpr bool kDeferred = true;
+};
+
+// MethodTraits specialization for a raw unary method that defers its response.
+template <typename T>
+struct MethodTraits<void (T::*)(
+    ServerContext&, ConstByteSpan, RawUnaryResponder&)> {
+  using Implementation = RawMethod;
+  static constexpr MethodType kType = MethodType::kUnary;
+  static constexpr bool kDeferred = true;
+  using Service = T;
+};
+
 // MethodTraits specialization for a static raw server streaming method.
 template <>
 struct MethodTraits<void (*)(ServerContext&, ConstByteSpan, RawServerWriter&)> {
@@ -145,5 +306,31 @@ struct MethodTraits<void (T::*)(
   using Service = T;
 };
 
+template <>
+struct MethodTraits<void (*)(ServerContext&, RawServerReader&)> {
+  using Implementation = RawMethod;
+  static constexpr MethodType kType = MethodType::kClientStreaming;
+};
+
+template <typename T>
+struct MethodTraits<void (T::*)(ServerContext&, RawServerReader&)> {
+  using Implementation = RawMethod;
+  static constexpr MethodType kType = MethodType::kClientStreaming;
+  using Service = T;
+};
+
+template <>
+struct MethodTraits<void (*)(ServerContext&, RawServerReaderWriter&)> {
+  using Implementation = RawMethod;
+  static constexpr MethodType kType = MethodType::kBidirectionalStreaming;
+};
+
+template <typename T>
+struct MethodTraits<void (T::*)(ServerContext&, RawServerReaderWriter&)> {
+  using Implementation = RawMethod;
+  static constexpr MethodType kType = MethodType::kBidirectionalStreaming;
+  using Service = T;
+};
+
 }  // namespace internal
 }  // namespace pw::rpc
@@ -14,10 +14,9 @@
 
 #include "pw_rpc/internal/raw_method.h"
 
-#include <cstring>
-
 #include "pw_log/log.h"
 #include "pw_rpc/internal/packet.h"
+#include "pw_rpc/internal/server.h"
 
 namespace pw::rpc {
 
@@ -28,23 +27,25 @@ RawServerWriter::~RawServerWriter() {
 }
 
 Status RawServerWriter::Write(ConstByteSpan response) {
-  if (!open()) {
-    return Status::FailedPrecondition();
-  }
+  return WritePayload(response);
+}
 
-  if (buffer().Contains(response)) {
-    return ReleasePayloadBuffer(response);
+RawServerReader::~RawServerReader() {
+  if (!buffer().empty()) {
+    ReleasePayloadBuffer();
   }
+}
 
-  std::span<std::byte> buffer = AcquirePayloadBuffer();
-
-  if (response.size() > buffer.size()) {
+RawServerReaderWriter::~RawServerReaderWriter() {
+  if (!buffer().empty()) {
     ReleasePayloadBuffer();
-    return Status::OutOfRange();
   }
+}
 
-  std::memcpy(buffer.data(), response.data(), response.size());
-  return ReleasePayloadBuffer(buffer.first(response.size()));
+RawUnaryResponder::~RawUnaryResponder() {
+  if (!buffer().empty()) {
+    ReleasePayloadBuffer();
+  }
 }
 
 namespace internal {
@@ -67,11 +68,32 @@ void RawMethod::CallUnary(ServerCall& call, const Packet& request) const {
   call.channel().Send(Packet::ServerError(request, Status::Internal()));
 }
 
+void RawMethod::CallDeferredUnary(ServerCall& call,
+                                  const Packet& request) const {
+  if (!call.server().AcquireDeferredCall()) {
+    PW_LOG_WARN("Too many deferred RPCs; rejecting request on channel %u",
+                unsigned(call.channel().id()));
+    call.channel().Send(
+        Packet::ServerError(request, Status::ResourceExhausted()));
+    return;
+  }
+
+  internal::Responder responder(call, MethodType::kUnary);
+  function_.deferred_unary(call, request.payload(), responder);
+}
+
 void RawMethod::CallServerStreaming(ServerCall& call,
                                     const Packet& request) const {
   internal::Responder server_writer(call);
   function_.server_streaming(call, request.payload(), server_writer);
 }
 
+void RawMethod::CallStreamRequest(ServerCall& call, MethodType type) const {
+  // The REQUEST packet for a client or bidirectional streaming call carries no
+  // payload; requests arrive in subsequent CLIENT_STREAM packets.
+  internal::Responder responder(call, type);
+  function_.stream_request(call, responder);
+}
+
 }  // namespace internal
 }  // namespace pw::rpc
@@ -47,6 +47,21 @@ class TestRawService final : public Service {
                                     ConstByteSpan,
                                     RawServerWriter&) {}
 
+  void ClientStreaming(ServerContext&, RawServerReader&) {}
+
+  static void StaticClientStreaming(ServerContext&, RawServerReader&) {}
+
+  void BidirectionalStreaming(ServerContext&, RawServerReaderWriter&) {}
+
+  static void StaticBidirectionalStreaming(ServerContext&,
+                                           RawServerReaderWriter&) {}
+
+  void DeferredUnary(ServerContext&, ConstByteSpan, RawUnaryResponder&) {}
+
+  static void StaticDeferredUnary(ServerContext&,
+                                  ConstByteSpan,
+                                  RawUnaryResponder&) {}
+
   StatusWithSize UnaryWrongArg(ServerContext&, ConstByteSpan, ConstByteSpan) {
     return StatusWithSize(0);
   }
@@ -69,6 +84,18 @@ static_assert(RawMethod::template matches<&TestRawService::ServerStreaming>());
 static_assert(RawMethod::template matches<&TestRawService::StaticUnary>());
 static_assert(
     RawMethod::template matches<&TestRawService::StaticServerStreaming>());
+static_assert(RawMethod::template matches<&TestRawService::ClientStreaming>());
+static_assert(
+    RawMethod::template matches<&TestRawService::StaticClientStreaming>());
+static_assert(
+    RawMethod::template matches<&TestRawService::BidirectionalStreaming>());
+static_assert(RawMethod::template matches<
+              &TestRawService::StaticBidirectionalStreaming>());
+static_assert(RawMethod::template matches<&TestRawService::DeferredUnary>());
+static_assert(
+    RawMethod::template matches<&TestRawService::StaticDeferredUnary>());
+static_assert(kDefersResponse<&TestRawService::DeferredUnary>);
+static_assert(!kDefersResponse<&TestRawService::Unary>);
 
 // Test that the matches() function does not match the wrong method type.
 static_assert(!RawMethod::template matches<&TestRawService::UnaryWrongArg>());
@@ -90,6 +117,9 @@ struct {
 } last_request;
 
 RawServerWriter last_writer;
+RawServerReader last_reader;
+RawServerReaderWriter last_reader_writer;
+RawUnaryResponder last_unary_responder;
 
 void DecodeRawTestRequest(ConstByteSpan request) {
   protobuf::Decoder decoder(request);
@@ -130,13 +160,31 @@ void StartStream(ServerContext&,
   last_writer = std::move(writer);
 }
 
+void StartClientStream(ServerContext&, RawServerReader& reader) {
+  last_reader = std::move(reader);
+}
+
+void StartBidiStream(ServerContext&, RawServerReaderWriter& reader_writer) {
+  last_reader_writer = std::move(reader_writer);
+}
+
+void DeferUnary(ServerContext&,
+                ConstByteSpan request,
+                RawUnaryResponder& responder) {
+  DecodeRawTestRequest(request);
+  last_unary_responder = std::move(responder);
+}
+
 class FakeService : public Service {
  public:
   FakeService(uint32_t id) : Service(id, kMethods) {}
 
-  static constexpr std::array<RawMethodUnion, 2> kMethods = {
+  static constexpr std::array<RawMethodUnion, 5> kMethods = {
       RawMethod::Unary<AddFive>(10u),
       RawMethod::ServerStreaming<StartStream>(11u),
+      RawMethod::ClientStreaming<StartClientStream>(12u),
+      RawMethod::BidirectionalStreaming<StartBidiStream>(13u),
+      RawMethod::Unary<DeferUnary>(14u),
   };
 };
 
@@ -264,5 +312,204 @@ TEST(RawServerWriter,
   EXPECT_EQ(output.sent_packet().type(), PacketType::SERVER_STREAM_END);
 }
 
+TEST(RawMethod, ClientStreamingRpc_SendsNothingWhenInitiallyCalled) {
+  const RawMethod& method = std::get<2>(FakeService::kMethods).raw_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  EXPECT_EQ(0u, context.output().packet_count());
+  EXPECT_TRUE(last_reader.open());
+  EXPECT_TRUE(last_reader.client_stream_open());
+}
+
+TEST(RawServerReader, Finish_SendsResponseWithPayloadAndStatus) {
+  const RawMethod& method = std::get<2>(FakeService::kMethods).raw_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  constexpr auto data = bytes::Array<0x0d, 0x06, 0xf0, 0x0d>();
+  EXPECT_EQ(last_reader.Finish(data, Status::Unauthenticated()), OkStatus());
+  EXPECT_FALSE(last_reader.open());
+
+  const internal::Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(context.output().packet_count(), 1u);
+  EXPECT_EQ(packet.type(), internal::PacketType::RESPONSE);
+  EXPECT_EQ(packet.method_id(), context.get().method().id());
+  ASSERT_EQ(packet.payload().size(), data.size());
+  EXPECT_EQ(std::memcmp(packet.payload().data(), data.data(), data.size()), 0);
+  EXPECT_EQ(packet.status(), Status::Unauthenticated());
+}
+
+TEST(RawServerReader, Finish_SendsPreviouslyAcquiredBuffer) {
+  const RawMethod& method = std::get<2>(FakeService::kMethods).raw_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  auto buffer = last_reader.PayloadBuffer();
+  constexpr auto data = bytes::Array<0x0d, 0x06, 0xf0, 0x0d>();
+  std::memcpy(buffer.data(), data.data(), data.size());
+
+  EXPECT_EQ(last_reader.Finish(buffer.first(data.size())), OkStatus());
+
+  const internal::Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(packet.type(), internal::PacketType::RESPONSE);
+  ASSERT_EQ(packet.payload().size(), data.size());
+  EXPECT_EQ(std::memcmp(packet.payload().data(), data.data(), data.size()), 0);
+  EXPECT_EQ(packet.status(), OkStatus());
+}
+
+TEST(RawServerReader, Finish_Closed_ReturnsFailedPrecondition) {
+  const RawMethod& method = std::get<2>(FakeService::kMethods).raw_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  EXPECT_EQ(OkStatus(), last_reader.Finish({}));
+  EXPECT_EQ(Status::FailedPrecondition(), last_reader.Finish({}));
+}
+
+TEST(RawServerReader, Destructor_SendsEmptyResponse) {
+  const RawMethod& method = std::get<2>(FakeService::kMethods).raw_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  { RawServerReader reader = std::move(last_reader); }
+
+  const internal::Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(context.output().packet_count(), 1u);
+  EXPECT_EQ(packet.type(), internal::PacketType::RESPONSE);
+  EXPECT_TRUE(packet.payload().empty());
+}
+
+TEST(RawServerReaderWriter, Write_SendsResponsePackets) {
+  const RawMethod& method = std::get<3>(FakeService::kMethods).raw_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+  EXPECT_EQ(0u, context.output().packet_count());
+  EXPECT_TRUE(last_reader_writer.client_stream_open());
+
+  constexpr auto data = bytes::Array<0x0d, 0x06, 0xf0, 0x0d>();
+  EXPECT_EQ(last_reader_writer.Write(data), OkStatus());
+  EXPECT_EQ(last_reader_writer.Write(data), OkStatus());
+
+  const internal::Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(context.output().packet_count(), 2u);
+  EXPECT_EQ(packet.type(), internal::PacketType::RESPONSE);
+  EXPECT_EQ(std::memcmp(packet.payload().data(), data.data(), data.size()), 0);
+}
+
+TEST(RawServerReaderWriter, Finish_SendsStreamEnd) {
+  const RawMethod& method = std::get<3>(FakeService::kMethods).raw_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  EXPECT_EQ(last_reader_writer.Finish(Status::NotFound()), OkStatus());
+
+  const internal::Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(packet.type(), internal::PacketType::SERVER_STREAM_END);
+  EXPECT_EQ(packet.status(), Status::NotFound());
+  EXPECT_FALSE(last_reader_writer.open());
+}
+
+TEST(RawMethod, DeferredUnaryRpc_SendsNothingWhenInitiallyCalled) {
+  std::byte buffer[16];
+  protobuf::NestedEncoder encoder(buffer);
+  test::TestRequest::Encoder test_request(&encoder);
+  test_request.WriteInteger(123);
+  test_request.WriteStatusCode(4);
+
+  const RawMethod& method = std::get<4>(FakeService::kMethods).raw_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet(encoder.Encode().value()));
+
+  EXPECT_EQ(0u, context.output().packet_count());
+  EXPECT_EQ(123, last_request.integer);
+  EXPECT_EQ(4u, last_request.status_code);
+  EXPECT_TRUE(last_unary_responder.open());
+  EXPECT_EQ(OkStatus(), last_unary_responder.Finish({}));
+}
+
+TEST(RawUnaryResponder, Finish_SendsResponseWithPayloadAndStatus) {
+  const RawMethod& method = std::get<4>(FakeService::kMethods).raw_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  constexpr auto data = bytes::Array<0x0d, 0x06, 0xf0, 0x0d>();
+  EXPECT_EQ(last_unary_responder.Finish(data, Status::Unauthenticated()),
+            OkStatus());
+  EXPECT_FALSE(last_unary_responder.open());
+
+  const internal::Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(context.output().packet_count(), 1u);
+  EXPECT_EQ(packet.type(), internal::PacketType::RESPONSE);
+  EXPECT_EQ(packet.method_id(), context.get().method().id());
+  ASSERT_EQ(packet.payload().size(), data.size());
+  EXPECT_EQ(std::memcmp(packet.payload().data(), data.data(), data.size()), 0);
+  EXPECT_EQ(packet.status(), Status::Unauthenticated());
+}
+
+TEST(RawUnaryResponder, Finish_Closed_ReturnsFailedPrecondition) {
+  const RawMethod& method = std::get<4>(FakeService::kMethods).raw_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  EXPECT_EQ(OkStatus(), last_unary_responder.Finish({}));
+  EXPECT_EQ(Status::FailedPrecondition(), last_unary_responder.Finish({}));
+}
+
+TEST(RawUnaryResponder, Destructor_SendsEmptyResponse) {
+  const RawMethod& method = std::get<4>(FakeService::kMethods).raw_method();
+  ServerContextForTest<FakeService> context(method);
+
+  method.Invoke(context.get(), context.packet({}));
+
+  { RawUnaryResponder responder = std::move(last_unary_responder); }
+
+  const internal::Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(context.output().packet_count(), 1u);
+  EXPECT_EQ(packet.type(), internal::PacketType::RESPONSE);
+  EXPECT_TRUE(packet.payload().empty());
+  EXPECT_EQ(packet.status(), OkStatus());
+}
+
+TEST(RawUnaryResponder, TooManyDeferredCalls_SendsResourceExhausted) {
+  const RawMethod& method = std::get<4>(FakeService::kMethods).raw_method();
+  ServerContextForTest<FakeService> context(method);
+
+  std::array<RawUnaryResponder, cfg::kMaxDeferredUnaryCalls> responders;
+  for (RawUnaryResponder& responder : responders) {
+    method.Invoke(context.get(), context.packet({}));
+    responder = std::move(last_unary_responder);
+  }
+  EXPECT_EQ(0u, context.output().packet_count());
+
+  method.Invoke(context.get(), context.packet({}));
+  EXPECT_FALSE(last_unary_responder.open());
+
+  const internal::Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(context.output().packet_count(), 1u);
+  EXPECT_EQ(packet.type(), internal::PacketType::SERVER_ERROR);
+  EXPECT_EQ(packet.status(), Status::ResourceExhausted());
+
+  // Finishing a call frees its slot for the next request.
+  EXPECT_EQ(OkStatus(), responders[0].Finish({}));
+  method.Invoke(context.get(), context.packet({}));
+  EXPECT_TRUE(last_unary_responder.open());
+  responders[0] = std::move(last_unary_responder);
+
+  for (RawUnaryResponder& responder : responders) {
+    EXPECT_EQ(OkStatus(), responder.Finish({}));
+  }
+}
+
 }  // namespace
 }  // namespace pw::rpc::internal
@@ -14,6 +14,9 @@
 
 #include "pw_rpc/internal/responder.h"
 
+#include <cstring>
+#include <limits>
+
 #include "pw_assert/check.h"
 #include "pw_rpc/internal/method.h"
 #include "pw_rpc/internal/packet.h"
@@ -21,7 +24,14 @@
 
 namespace pw::rpc::internal {
 
-Responder::Responder(ServerCall& call) : call_(call), state_(kOpen) {
+Responder::Responder(ServerCall& call, MethodType type)
+    : call_(call),
+      type_(type),
+      state_(kOpen),
+      client_stream_open_(type == MethodType::kClientStreaming ||
+                          type == MethodType::kBidirectionalStreaming),
+      flow_controlled_(false),
+      credits_(0) {
   call_.server().RegisterResponder(*this);
 }
 
@@ -29,17 +39,26 @@ Responder& Responder::operator=(Responder&& other) {
   Finish();
 
   state_ = other.state_;
+  type_ = other.type_;
+  client_stream_open_ = other.client_stream_open_;
+  flow_controlled_ = other.flow_controlled_;
+  credits_ = other.credits_;
+  call_ = std::move(other.call_);
+  response_ = std::move(other.response_);
+  on_next_ = std::move(other.on_next_);
+  on_client_stream_end_ = std::move(other.on_client_stream_end_);
+  on_credits_ = std::move(other.on_credits_);
 
+  // The call must be moved before registering, since the server indexes
+  // responders by their channel, service, and method IDs. A deferred unary
+  // call's slot moves with it.
   if (other.open()) {
     other.call_.server().RemoveResponder(other);
+    call_.server().RegisterResponder(*this);
     other.state_ = kClosed;
-
-    other.call_.server().RegisterResponder(*this);
+    other.client_stream_open_ = false;
   }
 
-  call_ = std::move(other.call_);
-  response_ = std::move(other.response_);
-
   return *this;
 }
 
@@ -56,6 +75,12 @@ Status Responder::Finish(Status status) {
     ReleasePayloadBuffer();
   }
 
+  // Unary and client streaming RPCs complete with a RESPONSE rather than a
+  // stream end.
+  if (type_ == MethodType::kUnary || type_ == MethodType::kClientStreaming) {
+    return CloseAndSendResponse({}, status);
+  }
+
   Close();
 
   // Send a control packet indicating that the stream (and RPC) has terminated.
@@ -67,6 +92,56 @@ Status Responder::Finish(Status status) {
                                      status));
 }
 
+Status Responder::CloseAndSendResponse(std::span<const std::byte> payload,
+                                       Status status) {
+  if (!open()) {
+    return Status::FailedPrecondition();
+  }
+
+  // The response payload may already be in the acquired buffer. Otherwise,
+  // acquire one sized for the packet so it can be encoded.
+  if (response_.empty()) {
+    response_ = call_.channel().AcquireBuffer(
+        ResponsePacket(payload).BufferSizeBytes());
+  } else if (!response_.Contains(payload)) {
+    ReleasePayloadBuffer();
+    response_ = call_.channel().AcquireBuffer(
+        ResponsePacket(payload).BufferSizeBytes());
+  }
+
+  Close();
+
+  Packet response = ResponsePacket(payload);
+  response.set_status(status);
+  return call_.channel().Send(response_, response);
+}
+
+Status Responder::WritePayload(std::span<const std::byte> payload) {
+  if (!open()) {
+    return Status::FailedPrecondition();
+  }
+
+  if (!response_.empty() && response_.Contains(payload)) {
+    return ReleasePayloadBuffer(payload);
+  }
+
+  // The payload's size is known, so the buffer only needs to fit it.
+  if (response_.empty()) {
+    response_ = call_.channel().AcquireBuffer(
+        ResponsePacket(payload).BufferSizeBytes());
+  }
+
+  std::span<std::byte> buffer = response_.payload(ResponsePacket());
+
+  if (payload.size() > buffer.size()) {
+    ReleasePayloadBuffer();
+    return Status::OutOfRange();
+  }
+
+  std::memcpy(buffer.data(), payload.data(), payload.size());
+  return ReleasePayloadBuffer(buffer.first(payload.size()));
+}
+
 std::span<std::byte> Responder::AcquirePayloadBuffer() {
   PW_DCHECK(open());
 
@@ -78,8 +153,29 @@ std::span<std::byte> Responder::AcquirePayloadBuffer() {
   return response_.payload(ResponsePacket());
 }
 
+std::span<std::byte> Responder::AcquirePayloadBuffer(
+    size_t max_payload_size_bytes) {
+  PW_DCHECK(open());
+
+  if (response_.empty()) {
+    response_ = call_.channel().AcquireBuffer(
+        ResponsePacket().BufferSizeBytesForPayload(max_payload_size_bytes));
+  }
+
+  return response_.payload(ResponsePacket());
+}
+
 Status Responder::ReleasePayloadBuffer(std::span<const std::byte> payload) {
   PW_DCHECK(open());
+
+  if (flow_controlled_) {
+    if (credits_ == 0u) {
+      ReleasePayloadBuffer();
+      return Status::Unavailable();
+    }
+    credits_ -= 1;
+  }
+
   return call_.channel().Send(response_, ResponsePacket(payload));
 }
 
@@ -89,13 +185,30 @@ Status Responder::ReleasePayloadBuffer() {
   return OkStatus();
 }
 
+void Responder::GrantCredits(uint32_t credits) {
+  flow_controlled_ = true;
+
+  // Saturate rather than wrap if the client grants more than can be counted.
+  credits_ = credits > std::numeric_limits<uint32_t>::max() - credits_
+                 ? std::numeric_limits<uint32_t>::max()
+                 : credits_ + credits;
+
+  if (on_credits_) {
+    on_credits_();
+  }
+}
+
 void Responder::Close() {
   if (!open()) {
     return;
   }
 
   call_.server().RemoveResponder(*this);
+  if (type_ == MethodType::kUnary) {
+    call_.server().ReleaseDeferredCall();
+  }
   state_ = kClosed;
+  client_stream_open_ = false;
 }
 
 Packet Responder::ResponsePacket(std::span<const std::byte> payload) const {
@@ -0,0 +1,161 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/internal/responder_index.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+#include "pw_rpc/internal/test_method.h"
+#include "pw_rpc/server.h"
+#include "pw_rpc/service.h"
+#include "pw_rpc_private/internal_test_utils.h"
+
+namespace pw::rpc::internal {
+namespace {
+
+class TestService : public Service {
+ public:
+  TestService(uint32_t service_id)
+      : Service(service_id, methods_),
+        methods_{
+            TestMethod(100),
+            TestMethod(200),
+            TestMethod(300),
+        } {}
+
+  const Method& method(size_t index) const {
+    return methods_[index].method();
+  }
+
+ private:
+  std::array<TestMethodUnion, 3> methods_;
+};
+
+class ResponderIndexTest : public ::testing::Test {
+ protected:
+  ResponderIndexTest()
+      : channels_{
+            Channel::Create<1>(&output_),
+            Channel::Create<2>(&output_),
+        },
+        server_(channels_),
+        service_(42) {}
+
+  ServerCall Call(size_t channel, size_t method) {
+    return ServerCall(static_cast<internal::Server&>(server_),
+                      static_cast<internal::Channel&>(channels_[channel]),
+                      service_,
+                      service_.method(method));
+  }
+
+  TestOutput<128> output_;
+  std::array<rpc::Channel, 2> channels_;
+  rpc::Server server_;
+  TestService service_;
+};
+
+TEST_F(ResponderIndexTest, Find_Empty_ReturnsNull) {
+  ResponderIndex<4> index;
+  EXPECT_EQ(index.Find(1, 42, 100), nullptr);
+  EXPECT_FALSE(index.overflowed());
+}
+
+TEST_F(ResponderIndexTest, Find_AddedResponders) {
+  ServerCall call_1 = Call(0, 0);
+  ServerCall call_2 = Call(1, 0);
+  ServerCall call_3 = Call(0, 2);
+  Responder responder_1(call_1);
+  Responder responder_2(call_2);
+  Responder responder_3(call_3);
+
+  ResponderIndex<8> index;
+  ASSERT_TRUE(index.Add(responder_1));
+  ASSERT_TRUE(index.Add(responder_2));
+  ASSERT_TRUE(index.Add(responder_3));
+  EXPECT_EQ(index.size(), 3u);
+
+  EXPECT_EQ(index.Find(1, 42, 100), &responder_1);
+  EXPECT_EQ(index.Find(2, 42, 100), &responder_2);
+  EXPECT_EQ(index.Find(1, 42, 300), &responder_3);
+  EXPECT_EQ(index.Find(2, 42, 300), nullptr);
+  EXPECT_EQ(index.Find(1, 43, 100), nullptr);
+}
+
+TEST_F(ResponderIndexTest, Remove_NoLongerFound) {
+  ServerCall call_1 = Call(0, 0);
+  ServerCall call_2 = Call(0, 1);
+  Responder responder_1(call_1);
+  Responder responder_2(call_2);
+
+  ResponderIndex<4> index;
+  ASSERT_TRUE(index.Add(responder_1));
+  ASSERT_TRUE(index.Add(responder_2));
+
+  EXPECT_TRUE(index.Remove(responder_1));
+  EXPECT_EQ(index.size(), 1u);
+  EXPECT_EQ(index.Find(1, 42, 100), nullptr);
+  EXPECT_EQ(index.Find(1, 42, 200), &responder_2);
+
+  EXPECT_FALSE(index.Remove(responder_1));
+}
+
+TEST_F(ResponderIndexTest, Remove_FromFullIndex_KeepsCollidingEntries) {
+  std::array<ServerCall, 6> calls = {
+      Call(0, 0), Call(0, 1), Call(0, 2), Call(1, 0), Call(1, 1), Call(1, 2)};
+  std::array<Responder, 6> responders = {Responder(calls[0]),
+                                         Responder(calls[1]),
+                                         Responder(calls[2]),
+                                         Responder(calls[3]),
+                                         Responder(calls[4]),
+                                         Responder(calls[5])};
+
+  // With three slots, every remaining responder is found in some probe
+  // sequence regardless of which entries are removed.
+  ResponderIndex<3> index;
+  ASSERT_TRUE(index.Add(responders[0]));
+  ASSERT_TRUE(index.Add(responders[1]));
+  ASSERT_TRUE(index.Add(responders[2]));
+  EXPECT_FALSE(index.Add(responders[3]));
+  EXPECT_TRUE(index.overflowed());
+
+  EXPECT_FALSE(index.Remove(responders[3]));
+  EXPECT_FALSE(index.overflowed());
+
+  for (size_t removed = 0; removed < 3; ++removed) {
+    ASSERT_TRUE(index.Remove(responders[removed]));
+
+    for (size_t i = removed + 1; i < 3; ++i) {
+      EXPECT_EQ(index.Find(responders[i].channel_id(),
+                           responders[i].service_id(),
+                           responders[i].method_id()),
+                &responders[i]);
+    }
+  }
+
+  EXPECT_EQ(index.size(), 0u);
+}
+
+TEST_F(ResponderIndexTest, Disabled_AlwaysMisses) {
+  ServerCall call = Call(0, 0);
+  Responder responder(call);
+
+  ResponderIndex<0> index;
+  EXPECT_FALSE(index.Add(responder));
+  EXPECT_TRUE(index.overflowed());
+  EXPECT_EQ(index.Find(1, 42, 100), nullptr);
+}
+
+}  // namespace
+}  // namespace pw::rpc::internal
@@ -73,6 +73,10 @@ class FakeServerWriter : public Responder {
     return ReleasePayloadBuffer(buffer.first(response.size()));
   }
 
+  Status WriteCopy(std::span<const byte> response) {
+    return WritePayload(response);
+  }
+
   ByteSpan PayloadBuffer() { return AcquirePayloadBuffer(); }
   const Channel::OutputBuffer& output_buffer() { return buffer(); }
 };
@@ -165,15 +169,41 @@ TEST(ServerWriter, Open_SendsPacketWithPayload) {
   constexpr byte data[] = {byte{0xf0}, byte{0x0d}};
   ASSERT_EQ(OkStatus(), writer.Write(data));
 
-  byte encoded[64];
-  auto result = context.packet(data).Encode(encoded);
-  ASSERT_EQ(OkStatus(), result.status());
+  // The payload is encoded in place, so the header layout may differ from
+  // Packet::Encode. Compare the decoded packets instead of the raw bytes.
+  const Packet expected = context.packet(data);
+  const Packet& sent = context.output().sent_packet();
+  EXPECT_EQ(sent.type(), expected.type());
+  EXPECT_EQ(sent.channel_id(), expected.channel_id());
+  EXPECT_EQ(sent.service_id(), expected.service_id());
+  EXPECT_EQ(sent.method_id(), expected.method_id());
+  EXPECT_EQ(sent.status(), expected.status());
+  ASSERT_EQ(sent.payload().size(), sizeof(data));
+  EXPECT_EQ(0, std::memcmp(sent.payload().data(), data, sizeof(data)));
+}
+
+TEST(ServerWriter, WritePayload_CopiesPayloadIntoBuffer) {
+  ServerContextForTest<TestService> context(TestService::method.method());
+  FakeServerWriter writer(context.get());
+
+  constexpr byte data[] = {byte{0xab}, byte{0xcd}, byte{0xef}};
+  ASSERT_EQ(OkStatus(), writer.WriteCopy(data));
+  EXPECT_TRUE(writer.output_buffer().empty());
+
+  const Packet& sent = context.output().sent_packet();
+  EXPECT_EQ(sent.type(), PacketType::RESPONSE);
+  ASSERT_EQ(sent.payload().size(), sizeof(data));
+  EXPECT_EQ(0, std::memcmp(sent.payload().data(), data, sizeof(data)));
+}
 
-  EXPECT_EQ(result.value().size(), context.output().sent_data().size());
-  EXPECT_EQ(
-      0,
-      std::memcmp(
-          encoded, context.output().sent_data().data(), result.value().size()));
+TEST(ServerWriter, WritePayload_TooLarge_ReturnsOutOfRange) {
+  ServerContextForTest<TestService> context(TestService::method.method());
+  FakeServerWriter writer(context.get());
+
+  constexpr std::array<byte, 128> data = {};
+  EXPECT_EQ(Status::OutOfRange(), writer.WriteCopy(data));
+  EXPECT_TRUE(writer.output_buffer().empty());
+  EXPECT_EQ(context.output().packet_count(), 0u);
 }
 
 TEST(ServerWriter, Closed_IgnoresFinish) {
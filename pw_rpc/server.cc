@@ -16,7 +16,9 @@
 
 #include <algorithm>
 
+#include "pw_assert/check.h"
 #include "pw_log/log.h"
+#include "pw_protobuf/decoder.h"
 #include "pw_rpc/internal/packet.h"
 #include "pw_rpc/internal/server.h"
 #include "pw_rpc/server_context.h"
@@ -64,10 +66,47 @@ Server::~Server() {
   while (!writers_.empty()) {
     writers_.front().Finish();
   }
+
+  // Deferred unary calls are registered as writers, so none remain.
+  PW_DCHECK_UINT_EQ(deferred_calls_.load(std::memory_order_relaxed), 0u);
+}
+
+void Server::set_observer(ServerObserver* observer) {
+  observer_ = observer;
+
+  // Channels report the packets they send to the observer.
+  for (internal::Channel& channel : channels_) {
+    channel.set_observer(observer);
+  }
 }
 
 Status Server::ProcessPacket(std::span<const byte> data,
                              ChannelOutput& interface) {
+  LookupCache cache;
+  return ProcessPacket(data, interface, cache);
+}
+
+StatusWithSize Server::ProcessPackets(std::span<const ConstByteSpan> packets,
+                                      ChannelOutput& interface) {
+  LookupCache cache;
+  Status first_error;
+  size_t processed = 0;
+
+  for (ConstByteSpan data : packets) {
+    const Status status = ProcessPacket(data, interface, cache);
+    if (status.ok()) {
+      processed += 1;
+    } else if (first_error.ok()) {
+      first_error = status;
+    }
+  }
+
+  return StatusWithSize(first_error, processed);
+}
+
+Status Server::ProcessPacket(std::span<const byte> data,
+                             ChannelOutput& interface,
+                             LookupCache& cache) {
   Packet packet;
   if (!DecodePacket(interface, data, packet)) {
     return Status::DataLoss();
@@ -77,7 +116,11 @@ Status Server::ProcessPacket(std::span<const byte> data,
     return Status::InvalidArgument();
   }
 
-  internal::Channel* channel = FindChannel(packet.channel_id());
+  internal::Channel* channel = cache.channel;
+  if (channel == nullptr || channel->id() != packet.channel_id()) {
+    channel = FindChannel(packet.channel_id());
+  }
+
   if (channel == nullptr) {
     // If the requested channel doesn't exist, try to dynamically assign one.
     channel = AssignChannel(packet.channel_id(), interface);
@@ -89,23 +132,40 @@ Status Server::ProcessPacket(std::span<const byte> data,
       return OkStatus();  // OK since the packet was handled
     }
   }
+  cache.channel = channel;
+
+  if (cache.method == nullptr ||
+      cache.service->id() != packet.service_id() ||
+      cache.method->id() != packet.method_id()) {
+    std::tie(cache.service, cache.method) = FindMethod(packet);
+  }
 
-  const auto [service, method] = FindMethod(packet);
+  Service* const service = cache.service;
+  const internal::Method* const method = cache.method;
 
   if (method == nullptr) {
     channel->Send(Packet::ServerError(packet, Status::NotFound()));
     return OkStatus();
   }
 
+  if (observer_ != nullptr) {
+    observer_->PacketReceived(service->id(), method->id(), data.size());
+  }
+
   switch (packet.type()) {
     case PacketType::REQUEST: {
       internal::ServerCall call(
           static_cast<internal::Server&>(*this), *channel, *service, *method);
-      method->Invoke(call, packet);
+      if (scratch_arena_ != nullptr) {
+        allocator::Arena::Checkpoint checkpoint(*scratch_arena_);
+        InvokeMethod(call, packet);
+      } else {
+        InvokeMethod(call, packet);
+      }
       break;
     }
     case PacketType::CLIENT_STREAM:
-      // TODO(hepler): Support client streaming RPCs.
+      HandleClientStreamPacket(packet, *channel);
       break;
     case PacketType::CLIENT_ERROR:
       HandleClientError(packet);
@@ -114,7 +174,10 @@ Status Server::ProcessPacket(std::span<const byte> data,
       HandleCancelPacket(packet, *channel);
       break;
     case PacketType::CLIENT_STREAM_END:
-      // TODO(hepler): Handle client stream end packets.
+      HandleClientStreamEndPacket(packet);
+      break;
+    case PacketType::CLIENT_FLOW_CONTROL:
+      HandleFlowControlPacket(packet, *channel);
       break;
     default:
       channel->Send(Packet::ServerError(packet, Status::Unimplemented()));
@@ -127,6 +190,22 @@ Status Server::ProcessPacket(std::span<const byte> data,
 std::tuple<Service*, const internal::Method*> Server::FindMethod(
     const internal::Packet& packet) {
   // Packets always include service and method IDs.
+  if (!static_methods_.empty()) {
+    const internal::StaticMethodEntry* entry = internal::FindStaticMethod(
+        static_methods_, packet.service_id(), packet.method_id());
+    if (entry != nullptr) {
+      return {static_services_[entry->service_index], &entry->method->method()};
+    }
+  }
+
+  const auto indexed =
+      method_index_.Find(packet.service_id(), packet.method_id());
+
+  // If every registered method is in the index, a miss is authoritative.
+  if (std::get<0>(indexed) != nullptr || !method_index_.overflowed()) {
+    return indexed;
+  }
+
   auto service = std::find_if(services_.begin(), services_.end(), [&](auto& s) {
     return s.id() == packet.service_id();
   });
@@ -138,15 +217,37 @@ std::tuple<Service*, const internal::Method*> Server::FindMethod(
   return {&(*service), service->FindMethod(packet.method_id())};
 }
 
+void Server::HandleClientStreamPacket(const Packet& packet,
+                                      internal::Channel& channel) {
+  internal::Responder* reader = FindResponder(packet);
+
+  if (reader == nullptr || !reader->client_stream_open()) {
+    channel.Send(Packet::ServerError(packet, Status::FailedPrecondition()));
+    PW_LOG_WARN("Received CLIENT_STREAM packet for method that is not pending");
+    return;
+  }
+
+  reader->HandleClientStream(packet.payload());
+}
+
+void Server::HandleClientStreamEndPacket(const Packet& packet) {
+  internal::Responder* reader = FindResponder(packet);
+
+  // The server may have already completed the RPC, so a missing call is not an
+  // error. Don't send a SERVER_ERROR in this case.
+  if (reader == nullptr || !reader->client_stream_open()) {
+    PW_LOG_DEBUG("Received CLIENT_STREAM_END for method that is not pending");
+    return;
+  }
+
+  reader->EndClientStream();
+}
+
 void Server::HandleCancelPacket(const Packet& packet,
                                 internal::Channel& channel) {
-  auto writer = std::find_if(writers_.begin(), writers_.end(), [&](auto& w) {
-    return w.channel_id() == packet.channel_id() &&
-           w.service_id() == packet.service_id() &&
-           w.method_id() == packet.method_id();
-  });
+  internal::Responder* writer = FindResponder(packet);
 
-  if (writer == writers_.end()) {
+  if (writer == nullptr) {
     channel.Send(Packet::ServerError(packet, Status::FailedPrecondition()));
     PW_LOG_WARN("Received CANCEL packet for method that is not pending");
   } else {
@@ -154,19 +255,82 @@ void Server::HandleCancelPacket(const Packet& packet,
   }
 }
 
+void Server::HandleFlowControlPacket(const Packet& packet,
+                                     internal::Channel& channel) {
+  internal::Responder* writer = FindResponder(packet);
+
+  // Only calls that stream responses can be flow controlled.
+  if (writer == nullptr ||
+      !(writer->type() == internal::MethodType::kServerStreaming ||
+        writer->type() == internal::MethodType::kBidirectionalStreaming)) {
+    channel.Send(Packet::ServerError(packet, Status::FailedPrecondition()));
+    PW_LOG_WARN("Received CLIENT_FLOW_CONTROL for method that is not pending");
+    return;
+  }
+
+  uint32_t credits = 0;
+  protobuf::Decoder decoder(packet.payload());
+  Status status;
+  while ((status = decoder.Next()).ok()) {
+    if (decoder.FieldNumber() ==
+        static_cast<uint32_t>(internal::FlowControl::Fields::CREDITS)) {
+      if (!decoder.ReadUint32(&credits).ok()) {
+        status = Status::DataLoss();
+        break;
+      }
+    }
+  }
+
+  if (!status.IsOutOfRange()) {
+    channel.Send(Packet::ServerError(packet, Status::DataLoss()));
+    PW_LOG_WARN("Received malformed CLIENT_FLOW_CONTROL packet");
+    return;
+  }
+
+  writer->GrantCredits(credits);
+}
+
 void Server::HandleClientError(const Packet& packet) {
   // A client error indicates that the client received a packet that it did not
   // expect. If the packet belongs to a streaming RPC, cancel the stream without
   // sending a final SERVER_STREAM_END packet.
+  internal::Responder* writer = FindResponder(packet);
+
+  if (writer != nullptr) {
+    writer->Close();
+  }
+}
+
+internal::Responder* Server::FindResponder(const Packet& packet) {
+  internal::Responder* indexed = responder_index_.Find(
+      packet.channel_id(), packet.service_id(), packet.method_id());
+
+  // If every open responder is in the index, a miss is authoritative.
+  if (indexed != nullptr || !responder_index_.overflowed()) {
+    return indexed;
+  }
+
   auto writer = std::find_if(writers_.begin(), writers_.end(), [&](auto& w) {
     return w.channel_id() == packet.channel_id() &&
            w.service_id() == packet.service_id() &&
            w.method_id() == packet.method_id();
   });
 
-  if (writer != writers_.end()) {
-    writer->Close();
+  return writer == writers_.end() ? nullptr : &(*writer);
+}
+
+void Server::InvokeMethod(internal::ServerCall& call,
+                          const internal::Packet& request) {
+  if (observer_ == nullptr) {
+    call.method().Invoke(call, request);
+    return;
   }
+
+  const uint32_t service_id = call.service().id();
+  const uint32_t method_id = call.method().id();
+  observer_->InvocationStarted(service_id, method_id);
+  call.method().Invoke(call, request);
+  observer_->InvocationFinished(service_id, method_id);
 }
 
 internal::Channel* Server::FindChannel(uint32_t id) const {
@@ -186,7 +350,12 @@ internal::Channel* Server::AssignChannel(uint32_t id,
   }
 
   *channel = internal::Channel(id, &interface);
+  channel->set_observer(observer_);
   return channel;
 }
 
+allocator::Arena* ServerContext::scratch_arena() const {
+  return server().scratch_arena();
+}
+
 }  // namespace pw::rpc
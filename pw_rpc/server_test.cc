@@ -16,12 +16,15 @@
 
 #include <array>
 #include <cstdint>
+#include <optional>
 
 #include "gtest/gtest.h"
 #include "pw_assert/check.h"
 #include "pw_rpc/internal/method.h"
 #include "pw_rpc/internal/packet.h"
+#include "pw_rpc/internal/server.h"
 #include "pw_rpc/internal/test_method.h"
+#include "pw_rpc/server_observer.h"
 #include "pw_rpc/service.h"
 #include "pw_rpc_private/internal_test_utils.h"
 
@@ -86,6 +89,20 @@ class BasicServer : public ::testing::Test {
     return result.value_or(ConstByteSpan());
   }
 
+  // Encodes a packet into a caller-provided buffer, so that several packets can
+  // be passed to ProcessPackets at once.
+  static ConstByteSpan Encode(ByteSpan buffer,
+                              PacketType type,
+                              uint32_t channel_id,
+                              uint32_t service_id,
+                              uint32_t method_id) {
+    auto result =
+        Packet(type, channel_id, service_id, method_id, kDefaultPayload)
+            .Encode(buffer);
+    EXPECT_EQ(OkStatus(), result.status());
+    return result.value_or(ConstByteSpan());
+  }
+
   TestOutput<128> output_;
   std::array<Channel, 3> channels_;
   Server server_;
@@ -109,6 +126,27 @@ TEST_F(BasicServer, ProcessPacket_ValidMethod_InvokesMethod) {
             0);
 }
 
+TEST_F(BasicServer, ProcessPacket_ScratchArena_RolledBackAfterInvocation) {
+  std::byte arena_buffer[64];
+  allocator::Arena arena(arena_buffer);
+  ASSERT_NE(arena.Allocate(8, 1), nullptr);  // Allocated outside the RPC.
+
+  server_.set_scratch_arena(&arena);
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::REQUEST, 1, 42, 100), output_));
+
+  EXPECT_EQ(service_.method(100).scratch_bytes_used(), 8u + 16u);
+  EXPECT_EQ(arena.used(), 8u);
+}
+
+TEST_F(BasicServer, ProcessPacket_NoScratchArena) {
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::REQUEST, 1, 42, 100), output_));
+  EXPECT_EQ(service_.method(100).scratch_bytes_used(), 0u);
+}
+
 TEST_F(BasicServer, ProcessPacket_IncompletePacket_NothingIsInvoked) {
   EXPECT_EQ(Status::DataLoss(),
             server_.ProcessPacket(
@@ -224,6 +262,126 @@ TEST_F(BasicServer, ProcessPacket_Cancel_MethodNotActive_SendsError) {
   EXPECT_EQ(packet.status(), Status::FailedPrecondition());
 }
 
+TEST_F(BasicServer, ProcessPackets_InvokesMethodForEachPacket) {
+  std::array<byte, 32> buffers[3];
+  const std::array<ConstByteSpan, 3> packets = {
+      Encode(buffers[0], PacketType::REQUEST, 1, 42, 100),
+      Encode(buffers[1], PacketType::REQUEST, 1, 42, 100),
+      Encode(buffers[2], PacketType::REQUEST, 2, 42, 200),
+  };
+
+  StatusWithSize result = server_.ProcessPackets(packets, output_);
+  EXPECT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(3u, result.size());
+
+  EXPECT_EQ(2u, service_.method(100).invocations());
+  EXPECT_EQ(1u, service_.method(100).last_channel_id());
+  EXPECT_EQ(1u, service_.method(200).invocations());
+  EXPECT_EQ(2u, service_.method(200).last_channel_id());
+}
+
+TEST_F(BasicServer, ProcessPackets_ContinuesAfterFailure) {
+  std::array<byte, 32> buffers[3];
+  const std::array<ConstByteSpan, 3> packets = {
+      Encode(buffers[0], PacketType::REQUEST, 1, 42, 100),
+      Encode(buffers[1], PacketType::RESPONSE, 1, 42, 100),
+      Encode(buffers[2], PacketType::REQUEST, 1, 42, 100),
+  };
+
+  StatusWithSize result = server_.ProcessPackets(packets, output_);
+  EXPECT_EQ(Status::InvalidArgument(), result.status());
+  EXPECT_EQ(2u, result.size());
+  EXPECT_EQ(2u, service_.method(100).invocations());
+}
+
+TEST_F(BasicServer, ProcessPackets_UnknownMethodAfterValid_SendsError) {
+  std::array<byte, 32> buffers[2];
+  const std::array<ConstByteSpan, 2> packets = {
+      Encode(buffers[0], PacketType::REQUEST, 1, 42, 100),
+      Encode(buffers[1], PacketType::REQUEST, 1, 42, 101),
+  };
+
+  EXPECT_EQ(OkStatus(), server_.ProcessPackets(packets, output_).status());
+  EXPECT_EQ(1u, service_.method(100).invocations());
+  EXPECT_EQ(output_.sent_packet().type(), PacketType::SERVER_ERROR);
+  EXPECT_EQ(output_.sent_packet().status(), Status::NotFound());
+  EXPECT_EQ(output_.sent_packet().method_id(), 101u);
+}
+
+class RecordingObserver : public ServerObserver {
+ public:
+  void PacketReceived(uint32_t service_id,
+                      uint32_t method_id,
+                      size_t size_bytes) override {
+    last_service_id = service_id;
+    last_method_id = method_id;
+    received_bytes += size_bytes;
+  }
+
+  void PacketSent(uint32_t, uint32_t, size_t size_bytes) override {
+    sent_packets += 1;
+    sent_bytes += size_bytes;
+  }
+
+  void InvocationStarted(uint32_t, uint32_t) override { started += 1; }
+  void InvocationFinished(uint32_t, uint32_t) override { finished += 1; }
+
+  uint32_t last_service_id = 0;
+  uint32_t last_method_id = 0;
+  size_t received_bytes = 0;
+  size_t sent_packets = 0;
+  size_t sent_bytes = 0;
+  int started = 0;
+  int finished = 0;
+};
+
+TEST_F(BasicServer, Observer_NotifiedOfRequest) {
+  RecordingObserver observer;
+  server_.set_observer(&observer);
+
+  ConstByteSpan request = EncodeRequest(PacketType::REQUEST, 1, 42, 200);
+  EXPECT_EQ(OkStatus(), server_.ProcessPacket(request, output_));
+
+  EXPECT_EQ(observer.last_service_id, 42u);
+  EXPECT_EQ(observer.last_method_id, 200u);
+  EXPECT_EQ(observer.received_bytes, request.size());
+  EXPECT_EQ(observer.started, 1);
+  EXPECT_EQ(observer.finished, 1);
+
+  server_.set_observer(nullptr);
+}
+
+TEST_F(BasicServer, Observer_UnknownMethod_NotNotifiedOfReceive) {
+  RecordingObserver observer;
+  server_.set_observer(&observer);
+
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::REQUEST, 1, 42, 101), output_));
+
+  EXPECT_EQ(observer.received_bytes, 0u);
+  EXPECT_EQ(observer.started, 0);
+
+  // The SERVER_ERROR response is still reported.
+  EXPECT_EQ(observer.sent_packets, 1u);
+
+  server_.set_observer(nullptr);
+}
+
+TEST_F(BasicServer, Observer_AssignedChannel_ReportsSentPackets) {
+  RecordingObserver observer;
+  server_.set_observer(&observer);
+
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::REQUEST, 99, 42, 101), output_));
+
+  EXPECT_EQ(output_.sent_packet().channel_id(), 99u);
+  EXPECT_EQ(observer.sent_packets, 1u);
+
+  server_.set_observer(nullptr);
+}
+
 class MethodPending : public BasicServer {
  protected:
   MethodPending()
@@ -271,6 +429,18 @@ TEST_F(MethodPending,
   EXPECT_EQ(output_.packet_count(), 0u);
 }
 
+TEST_F(MethodPending, Observer_NotifiedOfSentPackets) {
+  RecordingObserver observer;
+  server_.set_observer(&observer);
+
+  EXPECT_EQ(OkStatus(), writer_.Finish());
+
+  EXPECT_EQ(observer.sent_packets, 1u);
+  EXPECT_EQ(observer.sent_bytes, output_.sent_data().size());
+
+  server_.set_observer(nullptr);
+}
+
 TEST_F(MethodPending, ProcessPacket_Cancel_IncorrectChannel) {
   EXPECT_EQ(OkStatus(),
             server_.ProcessPacket(EncodeRequest(PacketType::CANCEL, 2, 42, 100),
@@ -302,5 +472,282 @@ TEST_F(MethodPending, ProcessPacket_CancelIncorrectMethod) {
   EXPECT_TRUE(writer_.open());
 }
 
+TEST_F(MethodPending, ProcessPacket_ClientStream_NotClientStreaming_SendsError) {
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::CLIENT_STREAM, 1, 42, 100), output_));
+
+  EXPECT_EQ(output_.sent_packet().type(), PacketType::SERVER_ERROR);
+  EXPECT_EQ(output_.sent_packet().status(), Status::FailedPrecondition());
+  EXPECT_TRUE(writer_.open());
+}
+
+class DeferredUnaryPending : public BasicServer {
+ protected:
+  DeferredUnaryPending()
+      : call_(static_cast<internal::Server&>(server_),
+              static_cast<internal::Channel&>(channels_[0]),
+              service_,
+              service_.method(100)),
+        acquired_(call_.server().AcquireDeferredCall()),
+        responder_(call_, internal::MethodType::kUnary) {
+    EXPECT_TRUE(acquired_);
+  }
+
+  internal::ServerCall call_;
+  bool acquired_;
+  internal::Responder responder_;
+};
+
+TEST_F(DeferredUnaryPending, ProcessPacket_Cancel_SendsCancelledResponse) {
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(EncodeRequest(PacketType::CANCEL, 1, 42, 100),
+                                  output_));
+
+  EXPECT_FALSE(responder_.open());
+  const Packet& packet = output_.sent_packet();
+  EXPECT_EQ(output_.packet_count(), 1u);
+  EXPECT_EQ(packet.type(), PacketType::RESPONSE);
+  EXPECT_EQ(packet.method_id(), 100u);
+  EXPECT_EQ(packet.status(), Status::Cancelled());
+
+  EXPECT_EQ(Status::FailedPrecondition(), responder_.Finish());
+  EXPECT_EQ(output_.packet_count(), 1u);
+}
+
+TEST_F(DeferredUnaryPending, ProcessPacket_ClientError_ClosesWithoutResponse) {
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::CLIENT_ERROR, 1, 42, 100), output_));
+
+  EXPECT_FALSE(responder_.open());
+  EXPECT_EQ(output_.packet_count(), 0u);
+}
+
+TEST_F(DeferredUnaryPending, Close_ReleasesSlot) {
+  internal::Server& server = call_.server();
+  EXPECT_EQ(OkStatus(), responder_.Finish());
+
+  for (size_t i = 0; i < cfg::kMaxDeferredUnaryCalls; ++i) {
+    EXPECT_TRUE(server.AcquireDeferredCall());
+  }
+  EXPECT_FALSE(server.AcquireDeferredCall());
+
+  for (size_t i = 0; i < cfg::kMaxDeferredUnaryCalls; ++i) {
+    server.ReleaseDeferredCall();
+  }
+}
+
+TEST_F(BasicServer, DestroyServer_FinishesDeferredCall) {
+  std::optional<Server> server(std::in_place, channels_);
+  internal::ServerCall call(static_cast<internal::Server&>(*server),
+                            static_cast<internal::Channel&>(channels_[0]),
+                            service_,
+                            service_.method(100));
+  ASSERT_TRUE(call.server().AcquireDeferredCall());
+  internal::Responder responder(call, internal::MethodType::kUnary);
+
+  server.reset();
+
+  EXPECT_FALSE(responder.open());
+  EXPECT_EQ(output_.packet_count(), 1u);
+  EXPECT_EQ(output_.sent_packet().type(), PacketType::RESPONSE);
+  EXPECT_EQ(output_.sent_packet().status(), OkStatus());
+
+  EXPECT_EQ(Status::FailedPrecondition(), responder.Finish());
+  EXPECT_EQ(output_.packet_count(), 1u);
+}
+
+// Exposes the client stream callbacks, which are protected in Responder.
+class TestReader : public internal::Responder {
+ public:
+  TestReader(internal::ServerCall& call)
+      : Responder(call, internal::MethodType::kBidirectionalStreaming) {}
+
+  using Responder::set_on_client_stream_end;
+  using Responder::set_on_next;
+};
+
+class ClientStreamPending : public BasicServer {
+ protected:
+  ClientStreamPending()
+      : call_(static_cast<internal::Server&>(server_),
+              static_cast<internal::Channel&>(channels_[0]),
+              service_,
+              service_.method(100)),
+        reader_(call_) {
+    reader_.set_on_next([this](ConstByteSpan payload) {
+      requests_ += 1;
+      last_request_size_ = payload.size();
+    });
+    reader_.set_on_client_stream_end([this]() { stream_ended_ = true; });
+  }
+
+  internal::ServerCall call_;
+  TestReader reader_;
+
+  int requests_ = 0;
+  size_t last_request_size_ = 0;
+  bool stream_ended_ = false;
+};
+
+TEST_F(ClientStreamPending, ProcessPacket_ClientStream_InvokesOnNext) {
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::CLIENT_STREAM, 1, 42, 100), output_));
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::CLIENT_STREAM, 1, 42, 100), output_));
+
+  EXPECT_EQ(requests_, 2);
+  EXPECT_EQ(last_request_size_, sizeof(kDefaultPayload));
+  EXPECT_EQ(output_.packet_count(), 0u);
+  EXPECT_TRUE(reader_.open());
+}
+
+TEST_F(ClientStreamPending, ProcessPacket_ClientStreamEnd_ClosesClientStream) {
+  EXPECT_TRUE(reader_.client_stream_open());
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::CLIENT_STREAM_END, 1, 42, 100),
+                output_));
+
+  EXPECT_TRUE(stream_ended_);
+  EXPECT_FALSE(reader_.client_stream_open());
+  EXPECT_TRUE(reader_.open());
+  EXPECT_EQ(output_.packet_count(), 0u);
+}
+
+TEST_F(ClientStreamPending, ProcessPacket_ClientStreamAfterEnd_SendsError) {
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::CLIENT_STREAM_END, 1, 42, 100),
+                output_));
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::CLIENT_STREAM, 1, 42, 100), output_));
+
+  EXPECT_EQ(requests_, 0);
+  EXPECT_EQ(output_.sent_packet().type(), PacketType::SERVER_ERROR);
+  EXPECT_EQ(output_.sent_packet().status(), Status::FailedPrecondition());
+}
+
+TEST_F(BasicServer, ProcessPacket_ClientStreamEnd_NotPending_SendsNothing) {
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::CLIENT_STREAM_END, 1, 42, 100),
+                output_));
+
+  EXPECT_EQ(output_.packet_count(), 0u);
+}
+
+// Exposes WritePayload, which is protected in Responder.
+class TestWriter : public internal::Responder {
+ public:
+  TestWriter(internal::ServerCall& call) : Responder(call) {}
+
+  using Responder::WritePayload;
+};
+
+class FlowControlPending : public BasicServer {
+ protected:
+  FlowControlPending()
+      : call_(static_cast<internal::Server&>(server_),
+              static_cast<internal::Channel&>(channels_[0]),
+              service_,
+              service_.method(100)),
+        writer_(call_) {}
+
+  Status GrantCredits(std::span<const byte> flow_control) {
+    return server_.ProcessPacket(
+        EncodeRequest(
+            PacketType::CLIENT_FLOW_CONTROL, 1, 42, 100, flow_control),
+        output_);
+  }
+
+  static constexpr byte kResponse[] = {byte{1}, byte{2}};
+
+  // FlowControl messages with 2 and 300 credits.
+  static constexpr byte kTwoCredits[] = {byte{0x08}, byte{2}};
+  static constexpr byte kManyCredits[] = {byte{0x08}, byte{0xac}, byte{0x02}};
+
+  internal::ServerCall call_;
+  TestWriter writer_;
+};
+
+TEST_F(FlowControlPending, NoGrant_NotFlowControlled) {
+  EXPECT_FALSE(writer_.flow_controlled());
+
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(OkStatus(), writer_.WritePayload(kResponse));
+  }
+  EXPECT_EQ(output_.packet_count(), 5u);
+}
+
+TEST_F(FlowControlPending, Grant_LimitsResponses) {
+  ASSERT_EQ(OkStatus(), GrantCredits(kTwoCredits));
+  EXPECT_TRUE(writer_.flow_controlled());
+  EXPECT_EQ(writer_.credits(), 2u);
+
+  EXPECT_EQ(OkStatus(), writer_.WritePayload(kResponse));
+  EXPECT_EQ(OkStatus(), writer_.WritePayload(kResponse));
+  EXPECT_EQ(Status::Unavailable(), writer_.WritePayload(kResponse));
+
+  EXPECT_EQ(output_.packet_count(), 2u);
+  EXPECT_EQ(writer_.credits(), 0u);
+  EXPECT_TRUE(writer_.open());
+}
+
+TEST_F(FlowControlPending, Grant_Accumulates) {
+  ASSERT_EQ(OkStatus(), GrantCredits(kTwoCredits));
+  ASSERT_EQ(OkStatus(), GrantCredits(kManyCredits));
+  EXPECT_EQ(writer_.credits(), 302u);
+}
+
+TEST_F(FlowControlPending, Grant_ResumesAfterUnavailable) {
+  int grants = 0;
+  writer_.set_on_credits([&grants] { grants += 1; });
+
+  ASSERT_EQ(OkStatus(), GrantCredits(kTwoCredits));
+  writer_.WritePayload(kResponse);
+  writer_.WritePayload(kResponse);
+  ASSERT_EQ(Status::Unavailable(), writer_.WritePayload(kResponse));
+
+  ASSERT_EQ(OkStatus(), GrantCredits(kTwoCredits));
+  EXPECT_EQ(grants, 2);
+  EXPECT_EQ(OkStatus(), writer_.WritePayload(kResponse));
+  EXPECT_EQ(output_.packet_count(), 3u);
+}
+
+TEST_F(FlowControlPending, Grant_Finish_IgnoresCredits) {
+  ASSERT_EQ(OkStatus(), GrantCredits(kTwoCredits));
+  writer_.WritePayload(kResponse);
+  writer_.WritePayload(kResponse);
+
+  EXPECT_EQ(OkStatus(), writer_.Finish());
+  EXPECT_EQ(output_.sent_packet().type(), PacketType::SERVER_STREAM_END);
+}
+
+TEST_F(FlowControlPending, Grant_Malformed_SendsError) {
+  constexpr byte kTruncated[] = {byte{0x08}, byte{0xac}};
+  ASSERT_EQ(OkStatus(), GrantCredits(kTruncated));
+
+  EXPECT_EQ(output_.sent_packet().type(), PacketType::SERVER_ERROR);
+  EXPECT_EQ(output_.sent_packet().status(), Status::DataLoss());
+  EXPECT_FALSE(writer_.flow_controlled());
+}
+
+TEST_F(BasicServer, ProcessPacket_FlowControl_NotPending_SendsError) {
+  constexpr byte kCredits[] = {byte{0x08}, byte{1}};
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::CLIENT_FLOW_CONTROL, 1, 42, 100,
+                              kCredits),
+                output_));
+
+  EXPECT_EQ(output_.sent_packet().type(), PacketType::SERVER_ERROR);
+  EXPECT_EQ(output_.sent_packet().status(), Status::FailedPrecondition());
+}
+
 }  // namespace
 }  // namespace pw::rpc
@@ -0,0 +1,108 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/shared_memory_channel_output.h"
+
+#include <cstring>
+#include <new>
+
+#include "pw_assert/assert.h"
+
+namespace pw::rpc {
+
+SharedMemoryRing::SharedMemoryRing(ByteSpan memory, size_t max_packet_size)
+    : memory_(memory),
+      max_packet_size_(max_packet_size),
+      slot_size_(SlotSizeBytes(max_packet_size)),
+      slot_count_(memory.size() < kHeaderSizeBytes
+                      ? 0
+                      : (memory.size() - kHeaderSizeBytes) / slot_size_) {
+  PW_ASSERT(max_packet_size > 0u);
+  PW_ASSERT(reinterpret_cast<uintptr_t>(memory.data()) % alignof(Header) == 0);
+  PW_ASSERT(slot_count_ > 0u);
+}
+
+void SharedMemoryRing::Init() { new (memory_.data()) Header{{0}, {0}}; }
+
+size_t SharedMemoryRing::queued_packets() const {
+  return header().head.load(std::memory_order_acquire) -
+         header().tail.load(std::memory_order_acquire);
+}
+
+ByteSpan SharedMemoryRing::AcquireSlot() {
+  // Only the producer writes head, so its own value needs no ordering. The
+  // acquire on tail keeps the writes below from starting before the reader is
+  // done with the slot.
+  const uint32_t head = header().head.load(std::memory_order_relaxed);
+  if (head - header().tail.load(std::memory_order_acquire) >= slot_count_) {
+    return ByteSpan();
+  }
+  return ByteSpan(slot(head) + sizeof(uint32_t), max_packet_size_);
+}
+
+void SharedMemoryRing::CommitSlot(size_t packet_size) {
+  PW_ASSERT(packet_size > 0u && packet_size <= max_packet_size_);
+
+  const uint32_t head = header().head.load(std::memory_order_relaxed);
+  const uint32_t size = static_cast<uint32_t>(packet_size);
+  std::memcpy(slot(head), &size, sizeof(size));
+
+  // Publish the size and the packet before the new head.
+  header().head.store(head + 1, std::memory_order_release);
+}
+
+ConstByteSpan SharedMemoryRing::PeekSlot() const {
+  const uint32_t tail = header().tail.load(std::memory_order_relaxed);
+  if (header().head.load(std::memory_order_acquire) == tail) {
+    return ConstByteSpan();
+  }
+
+  uint32_t size;
+  std::memcpy(&size, slot(tail), sizeof(size));
+
+  // The size comes from the other core, so keep it within the slot. A bad
+  // size yields a packet that fails to decode rather than a stalled ring.
+  if (size == 0u || size > max_packet_size_) {
+    size = static_cast<uint32_t>(max_packet_size_);
+  }
+  return ConstByteSpan(slot(tail) + sizeof(uint32_t), size);
+}
+
+void SharedMemoryRing::ReleaseSlot() {
+  const uint32_t tail = header().tail.load(std::memory_order_relaxed);
+  PW_ASSERT(header().head.load(std::memory_order_acquire) != tail);
+
+  // Finish reading the slot before handing it back to the producer.
+  header().tail.store(tail + 1, std::memory_order_release);
+}
+
+std::span<std::byte> SharedMemoryChannelOutput::AcquireBuffer() {
+  return ring_.AcquireSlot();
+}
+
+Status SharedMemoryChannelOutput::SendAndReleaseBuffer(
+    std::span<const std::byte> buffer) {
+  // Discarded and empty buffers leave the slot to be acquired again.
+  if (buffer.empty()) {
+    return OkStatus();
+  }
+
+  // Packets are encoded at the start of the acquired slot.
+  PW_ASSERT(buffer.data() == ring_.AcquireSlot().data());
+  ring_.CommitSlot(buffer.size());
+  RingDoorbell();
+  return OkStatus();
+}
+
+}  // namespace pw::rpc
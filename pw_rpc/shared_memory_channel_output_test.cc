@@ -0,0 +1,193 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/shared_memory_channel_output.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_rpc/internal/channel.h"
+#include "pw_rpc/internal/packet.h"
+
+namespace pw::rpc {
+namespace {
+
+using internal::Packet;
+using internal::PacketType;
+
+constexpr size_t kMaxPacketSize = 30;
+constexpr size_t kSlots = 3;
+
+class SharedMemory : public ::testing::Test {
+ protected:
+  SharedMemory()
+      : producer_(memory_, kMaxPacketSize), consumer_(memory_, kMaxPacketSize) {
+    producer_.Init();
+  }
+
+  // Writes a packet of size bytes, each set to value.
+  void Write(size_t size, int value) {
+    ByteSpan slot = producer_.AcquireSlot();
+    ASSERT_GE(slot.size(), size);
+    std::memset(slot.data(), value, size);
+    producer_.CommitSlot(size);
+  }
+
+  alignas(uint32_t) std::array<std::byte,
+                               SharedMemoryRing::RequiredSizeBytes(
+                                   kSlots, kMaxPacketSize)> memory_;
+
+  // Each core has its own view of the ring.
+  SharedMemoryRing producer_;
+  SharedMemoryRing consumer_;
+};
+
+TEST_F(SharedMemory, Init_Empty) {
+  EXPECT_EQ(producer_.slot_count(), kSlots);
+  EXPECT_EQ(consumer_.slot_count(), kSlots);
+  EXPECT_EQ(consumer_.queued_packets(), 0u);
+  EXPECT_TRUE(consumer_.PeekSlot().empty());
+}
+
+TEST_F(SharedMemory, AcquireSlot_SameSlotUntilCommitted) {
+  ByteSpan slot = producer_.AcquireSlot();
+  EXPECT_EQ(slot.size(), kMaxPacketSize);
+  EXPECT_EQ(slot.data(), producer_.AcquireSlot().data());
+
+  producer_.CommitSlot(1);
+  EXPECT_NE(slot.data(), producer_.AcquireSlot().data());
+}
+
+TEST_F(SharedMemory, PeekSlot_ReadsPacketInPlace) {
+  ByteSpan slot = producer_.AcquireSlot();
+  Write(5, 0x5a);
+
+  ConstByteSpan packet = consumer_.PeekSlot();
+  EXPECT_EQ(packet.data(), slot.data());
+  ASSERT_EQ(packet.size(), 5u);
+  EXPECT_EQ(packet[4], std::byte{0x5a});
+  EXPECT_EQ(consumer_.queued_packets(), 1u);
+
+  consumer_.ReleaseSlot();
+  EXPECT_EQ(consumer_.queued_packets(), 0u);
+  EXPECT_TRUE(consumer_.PeekSlot().empty());
+}
+
+TEST_F(SharedMemory, AcquireSlot_Full_ReturnsEmpty) {
+  for (size_t i = 0; i < kSlots; ++i) {
+    Write(kMaxPacketSize, 1);
+  }
+  EXPECT_TRUE(producer_.AcquireSlot().empty());
+
+  consumer_.ReleaseSlot();
+  EXPECT_FALSE(producer_.AcquireSlot().empty());
+}
+
+TEST_F(SharedMemory, Wraparound_KeepsOrder) {
+  // Keep a packet queued while writing enough to wrap several times.
+  Write(1, 0);
+  for (int i = 1; i < 10; ++i) {
+    Write(1 + i % 3, i);
+
+    ConstByteSpan packet = consumer_.PeekSlot();
+    ASSERT_EQ(packet.size(), 1u + (i - 1) % 3);
+    EXPECT_EQ(packet[0], static_cast<std::byte>(i - 1));
+    consumer_.ReleaseSlot();
+  }
+
+  EXPECT_EQ(consumer_.queued_packets(), 1u);
+  EXPECT_EQ(consumer_.PeekSlot()[0], std::byte{9});
+}
+
+TEST_F(SharedMemory, ProcessPackets_ReleasesEachSlot) {
+  Write(1, 1);
+  Write(2, 2);
+
+  int sum = 0;
+  EXPECT_EQ(consumer_.ProcessPackets([&sum](ConstByteSpan packet) {
+    sum += static_cast<int>(packet[0]) * static_cast<int>(packet.size());
+  }),
+            2u);
+  EXPECT_EQ(sum, 5);
+  EXPECT_EQ(consumer_.queued_packets(), 0u);
+  EXPECT_EQ(consumer_.ProcessPackets([](ConstByteSpan) {}), 0u);
+}
+
+TEST_F(SharedMemory, PeekSlot_CorruptSize_StaysInSlot) {
+  ByteSpan slot = producer_.AcquireSlot();
+  producer_.CommitSlot(1);
+
+  const uint32_t bad_size = 0xffffff;
+  std::memcpy(slot.data() - sizeof(uint32_t), &bad_size, sizeof(bad_size));
+  EXPECT_EQ(consumer_.PeekSlot().size(), kMaxPacketSize);
+}
+
+class TestOutput : public SharedMemoryChannelOutput {
+ public:
+  TestOutput(SharedMemoryRing& ring)
+      : SharedMemoryChannelOutput("TestOutput", ring) {}
+
+  int doorbells() const { return doorbells_; }
+
+ private:
+  void RingDoorbell() override { doorbells_ += 1; }
+
+  int doorbells_ = 0;
+};
+
+TEST_F(SharedMemory, ChannelOutput_SendsPacketThroughRing) {
+  TestOutput output(producer_);
+  internal::Channel channel(1, &output);
+
+  constexpr std::byte kPayload[] = {std::byte{1}, std::byte{2}, std::byte{3}};
+  ASSERT_EQ(OkStatus(),
+            channel.Send(Packet(PacketType::RESPONSE, 1, 42, 100, kPayload)));
+  EXPECT_EQ(output.doorbells(), 1);
+
+  Result<Packet> result = Packet::FromBuffer(consumer_.PeekSlot());
+  ASSERT_EQ(OkStatus(), result.status());
+  const Packet& packet = result.value();
+  EXPECT_EQ(packet.type(), PacketType::RESPONSE);
+  EXPECT_EQ(packet.service_id(), 42u);
+  EXPECT_EQ(packet.method_id(), 100u);
+  ASSERT_EQ(packet.payload().size(), sizeof(kPayload));
+  EXPECT_EQ(std::memcmp(packet.payload().data(), kPayload, sizeof(kPayload)),
+            0);
+}
+
+TEST_F(SharedMemory, ChannelOutput_Discard_LeavesSlotFree) {
+  TestOutput output(producer_);
+
+  std::span<std::byte> buffer = output.AcquireBuffer();
+  output.DiscardBuffer(buffer);
+
+  EXPECT_EQ(output.doorbells(), 0);
+  EXPECT_EQ(consumer_.queued_packets(), 0u);
+  EXPECT_EQ(output.AcquireBuffer().data(), buffer.data());
+}
+
+TEST_F(SharedMemory, ChannelOutput_Full_SendFails) {
+  TestOutput output(producer_);
+  internal::Channel channel(1, &output);
+
+  for (size_t i = 0; i < kSlots; ++i) {
+    ASSERT_EQ(OkStatus(), channel.Send(Packet(PacketType::RESPONSE, 1, 2, 3)));
+  }
+  EXPECT_NE(OkStatus(), channel.Send(Packet(PacketType::RESPONSE, 1, 2, 3)));
+  EXPECT_EQ(output.doorbells(), static_cast<int>(kSlots));
+}
+
+}  // namespace
+}  // namespace pw::rpc
@@ -0,0 +1,147 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/static_server.h"
+
+#include <array>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "pw_rpc/internal/method_lookup.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_rpc/internal/test_method.h"
+#include "pw_rpc_private/internal_test_utils.h"
+
+namespace pw::rpc {
+namespace {
+
+using std::byte;
+
+using internal::Packet;
+using internal::PacketType;
+using internal::TestMethod;
+using internal::TestMethodUnion;
+
+// Stands in for a generated service class, with the same method tables.
+template <uint32_t kId, uint32_t kFirstMethodId, uint32_t kSecondMethodId>
+class FakeGeneratedService : public Service {
+ public:
+  constexpr FakeGeneratedService() : Service(kServiceId, kMethods) {}
+
+  static const TestMethod& method(size_t index) {
+    return kMethods[index].test_method();
+  }
+
+  constexpr void _PwRpcInternalGeneratedBase() const {}
+
+ private:
+  friend class internal::MethodLookup;
+
+  static constexpr uint32_t kServiceId = kId;
+
+  static constexpr std::array<TestMethodUnion, 2> kMethods = {
+      TestMethod(kFirstMethodId),
+      TestMethod(kSecondMethodId),
+  };
+
+  static constexpr std::array<uint32_t, 2> kMethodIds = {kFirstMethodId,
+                                                          kSecondMethodId};
+};
+
+class ServiceA final : public FakeGeneratedService<300, 20, 10> {};
+class ServiceB final : public FakeGeneratedService<100, 10, 30> {};
+class ServiceC final : public FakeGeneratedService<200, 40, 50> {};
+
+// Shares ServiceA's ID, but none of its method IDs.
+class ServiceD final : public FakeGeneratedService<300, 30, 40> {};
+class ServiceE final : public FakeGeneratedService<400, 10, 10> {};
+
+using TestTable = internal::StaticMethodTable<ServiceA, ServiceB>;
+
+static_assert(TestTable::kMethodCount == 4u);
+static_assert(TestTable::IsUnique());
+static_assert(TestTable::kTable[0].service_id == 100u);
+static_assert(TestTable::kTable[0].method_id == 10u);
+static_assert(TestTable::kTable[0].service_index == 1u);
+static_assert(TestTable::kTable[1].method_id == 30u);
+static_assert(TestTable::kTable[2].service_id == 300u);
+static_assert(TestTable::kTable[2].method_id == 10u);
+static_assert(TestTable::kTable[2].service_index == 0u);
+static_assert(TestTable::kTable[3].method_id == 20u);
+
+static_assert(!internal::StaticMethodTable<ServiceA, ServiceA>::IsUnique());
+static_assert(!internal::StaticMethodTable<ServiceA, ServiceD>::IsUnique());
+static_assert(
+    !internal::StaticMethodTable<ServiceB, ServiceC, ServiceD, ServiceA>::
+        IsUnique());
+static_assert(!internal::StaticMethodTable<ServiceE>::IsUnique());
+
+class StaticServerTest : public ::testing::Test {
+ protected:
+  StaticServerTest()
+      : channels_{
+            Channel::Create<1>(&output_),
+        },
+        server_(channels_, service_a_, service_b_) {}
+
+  Status SendRequest(uint32_t service_id, uint32_t method_id) {
+    auto result = Packet(PacketType::REQUEST, 1, service_id, method_id)
+                      .Encode(request_buffer_);
+    EXPECT_EQ(OkStatus(), result.status());
+    return server_.ProcessPacket(result.value_or(ConstByteSpan()), output_);
+  }
+
+  TestOutput<128> output_;
+  std::array<Channel, 1> channels_;
+  ServiceA service_a_;
+  ServiceB service_b_;
+  StaticServer<ServiceA, ServiceB> server_;
+
+ private:
+  byte request_buffer_[64];
+};
+
+TEST_F(StaticServerTest, InvokesMethodsOfEachService) {
+  const size_t a_invocations = ServiceA::method(1).invocations();
+  const size_t b_invocations = ServiceB::method(0).invocations();
+
+  EXPECT_EQ(OkStatus(), SendRequest(300, 10));
+  EXPECT_EQ(OkStatus(), SendRequest(100, 10));
+  EXPECT_EQ(OkStatus(), SendRequest(100, 10));
+
+  EXPECT_EQ(ServiceA::method(1).invocations(), a_invocations + 1);
+  EXPECT_EQ(ServiceB::method(0).invocations(), b_invocations + 2);
+  EXPECT_EQ(ServiceB::method(0).last_channel_id(), 1u);
+  EXPECT_EQ(output_.packet_count(), 0u);
+}
+
+TEST_F(StaticServerTest, UnknownMethod_SendsNotFound) {
+  EXPECT_EQ(OkStatus(), SendRequest(300, 30));
+
+  const Packet& packet = output_.sent_packet();
+  EXPECT_EQ(packet.type(), PacketType::SERVER_ERROR);
+  EXPECT_EQ(packet.status(), Status::NotFound());
+}
+
+TEST_F(StaticServerTest, RegisteredServicesAreStillFound) {
+  ServiceC service_c;
+  server_.RegisterService(service_c);
+
+  const size_t invocations = ServiceC::method(1).invocations();
+  EXPECT_EQ(OkStatus(), SendRequest(200, 50));
+  EXPECT_EQ(ServiceC::method(1).invocations(), invocations + 1);
+}
+
+}  // namespace
+}  // namespace pw::rpc
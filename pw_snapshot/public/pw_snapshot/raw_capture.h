@@ -0,0 +1,152 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "pw_bytes/span.h"
+#include "pw_multisink/multisink.h"
+#include "pw_protobuf/encoder.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+
+namespace pw::snapshot {
+
+// The kinds of records in a raw capture.
+enum class RawRecordType : uint32_t {
+  // The reason for the capture, written to Metadata.reason.
+  kReason = 1,
+
+  // The raw CPU state struct for the ARMv7-M architecture, e.g. a
+  // pw_cpu_exception_State from pw_cpu_exception_cortex_m.
+  kArmV7mCpuState = 2,
+
+  // A thread's name, stack pointers, and a slice of its stack.
+  kThread = 3,
+
+  // An encoded pw.log.LogEntry.
+  kLogEntry = 4,
+};
+
+// Writes the state of a crashing device as raw records, deferring encoding it
+// as a pw.snapshot.Snapshot proto until EncodeRawCapture is called after the
+// next boot. Writing a record is a header and a few copies, so capturing is
+// fast and cannot fail because of encoding, even from a fault handler.
+//
+// Raw captures are typically written to a PersistentBuffer in persistent RAM:
+//
+//   PW_KEEP_IN_SECTION(".noinit")
+//   pw::persistent_ram::PersistentBuffer<2048> persistent_capture;
+//
+//   void HandleCrash(const pw_cpu_exception_State& cpu_state) {
+//     persistent_capture.clear();
+//     auto writer = persistent_capture.GetWriter();
+//     pw::snapshot::RawCaptureWriter capture(writer);
+//     capture.WriteReason("HardFault");
+//     capture.WriteArmV7mCpuState(cpu_state);
+//     capture.WriteLogs(crash_drain, log_entry_buffer);
+//   }
+//
+// Records are only written whole. If a record does not fit in the writer's
+// ConservativeWriteLimit(), nothing is written and RESOURCE_EXHAUSTED is
+// returned, so the records that were written can still be encoded.
+class RawCaptureWriter {
+ public:
+  explicit constexpr RawCaptureWriter(stream::Writer& writer)
+      : writer_(writer) {}
+
+  // Writes a record with the provided type and contents.
+  Status WriteRecord(RawRecordType type, ConstByteSpan contents) {
+    return WriteRecord(type, contents, {}, {});
+  }
+
+  Status WriteReason(std::string_view reason) {
+    return WriteRecord(RawRecordType::kReason,
+                       std::as_bytes(std::span(reason)));
+  }
+
+  // Writes the bytes of the CPU state struct. EncodeRawCapture passes them to
+  // a CpuStateEncoder, e.g. pw::cpu_exception::DumpCpuStateProto.
+  template <typename CpuState>
+  Status WriteArmV7mCpuState(const CpuState& cpu_state) {
+    static_assert(std::is_trivially_copyable_v<CpuState>);
+    return WriteRecord(RawRecordType::kArmV7mCpuState,
+                       std::as_bytes(std::span(&cpu_state, 1)));
+  }
+
+  // Writes a thread's name, stack pointers, and a slice of its stack, which
+  // usually starts at the stack pointer.
+  Status WriteThread(std::string_view name,
+                     uintptr_t stack_start_pointer,
+                     uintptr_t stack_pointer,
+                     ConstByteSpan stack);
+
+  // Writes the entries available to the drain as log entry records, until the
+  // drain is empty or the writer is full. entry_buffer must be large enough
+  // for any entry in the multisink.
+  //
+  // The drain's multisink is locked while each entry is read, so this must not
+  // be used if the capture may interrupt code that holds the lock.
+  //
+  // Returns:
+  //   OK - Every available entry was written.
+  //   RESOURCE_EXHAUSTED - The writer filled; remaining entries were dropped.
+  //   Other - Reading an entry failed.
+  Status WriteLogs(multisink::MultiSink::Drain& drain, ByteSpan entry_buffer);
+
+ private:
+  Status WriteRecord(RawRecordType type,
+                     ConstByteSpan contents0,
+                     ConstByteSpan contents1,
+                     ConstByteSpan contents2);
+
+  stream::Writer& writer_;
+};
+
+// Encodes the state of an ARMv7-M CPU as a
+// pw.cpu_exception.cortex_m.ArmV7mCpuState proto from the raw bytes of the
+// CPU state struct. Returns INVALID_ARGUMENT if the raw state is not the size
+// of the struct.
+using CpuStateEncoder = Status (*)(protobuf::Encoder& cpu_state_encoder,
+                                   ConstByteSpan raw_cpu_state);
+
+// Encodes a raw capture as pw.snapshot.Snapshot fields. The Snapshot is marked
+// as fatal. Records of unknown types are skipped, as are CPU state records if
+// no CpuStateEncoder is provided.
+//
+// Call this after boot, before clearing the capture:
+//
+//   if (persistent_capture.has_value()) {
+//     pw::snapshot::EncodeRawCapture(
+//         pw::ConstByteSpan(persistent_capture.data(),
+//                           persistent_capture.size()),
+//         snapshot_encoder,
+//         pw::cpu_exception::DumpCpuStateProto);
+//     persistent_capture.clear();
+//   }
+//
+// Returns:
+//   OK - The capture was encoded.
+//   DATA_LOSS - The capture is corrupt. Records before the corruption were
+//       encoded.
+//   Other - Encoding failed, e.g. RESOURCE_EXHAUSTED from the encoder.
+Status EncodeRawCapture(ConstByteSpan raw_capture,
+                        protobuf::Encoder& snapshot_encoder,
+                        CpuStateEncoder encode_cpu_state = nullptr);
+
+}  // namespace pw::snapshot
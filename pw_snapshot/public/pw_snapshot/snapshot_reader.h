@@ -0,0 +1,230 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_protobuf/stream_decoder.h"
+#include "pw_snapshot_protos/snapshot.pwpb.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+
+namespace pw::snapshot {
+
+// Reads a serialized pw.snapshot.Snapshot from a seekable stream, such as a
+// file or a flash partition, without loading it into memory.
+//
+// Index() makes a single pass over the snapshot and records where each
+// top-level field is. Submessages and bytes fields are seeked over, so indexing
+// is fast even when the snapshot holds large stacks or log buffers. Sections
+// are then decoded only when requested, with a StreamDecoder for each
+// occurrence of the field:
+//
+//   SnapshotReaderBuffer<8> snapshot(file_reader);
+//   PW_TRY(snapshot.Index());
+//
+//   PW_LOG_INFO("%u threads", static_cast<unsigned>(snapshot.thread_count()));
+//   PW_TRY(snapshot.DecodeThread(2, [](protobuf::StreamDecoder& thread) {
+//     // Decode pw.thread.Thread fields...
+//     return OkStatus();
+//   }));
+//
+// Only length-delimited top-level fields are indexed. Every top-level field of
+// the Snapshot message is a submessage, as are project-specific fields that
+// extend it, such as a metrics section; those are read with ForEach() and
+// Decode() by field number.
+class SnapshotReader {
+ public:
+  // The location of a top-level field in the stream.
+  struct Field {
+    uint32_t number;
+
+    // The number of times the field occurs.
+    uint32_t count;
+
+    // The region of the stream that holds every occurrence: a field boundary
+    // at or before the first occurrence's key, and the offset just past the
+    // last occurrence. Other fields may be interleaved with the occurrences.
+    size_t begin;
+    size_t end;
+  };
+
+  // The snapshot starts at the reader's position when Index() is called. The
+  // index holds one Field per distinct field number.
+  constexpr SnapshotReader(stream::SeekableReader& reader,
+                           std::span<Field> index)
+      : reader_(reader), index_(index), field_count_(0) {}
+
+  SnapshotReader(const SnapshotReader&) = delete;
+  SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+  // Indexes the top-level fields of the snapshot. The snapshot extends to the
+  // end of the reader.
+  //
+  // Returns:
+  //   OK - The snapshot was indexed.
+  //   RESOURCE_EXHAUSTED - The snapshot has more distinct fields than the index
+  //       holds. The fields that fit were indexed.
+  //   DATA_LOSS - The snapshot is malformed, or the reader failed. Fields
+  //       before the error were indexed.
+  Status Index();
+
+  // The indexed fields, in the order they first occur.
+  std::span<const Field> fields() const {
+    return index_.first(field_count_);
+  }
+
+  // Returns the indexed field with this number, or nullptr if the snapshot
+  // does not contain it.
+  const Field* Find(uint32_t field_number) const {
+    return const_cast<SnapshotReader*>(this)->FindMutable(field_number);
+  }
+
+  // The number of times a field occurs.
+  size_t count(uint32_t field_number) const {
+    const Field* field = Find(field_number);
+    return field == nullptr ? 0 : field->count;
+  }
+
+  // Calls function with a decoder for each occurrence of the field, in order.
+  // Occurrences of a singular submessage are merged when decoded, so each is
+  // passed to the function as if it were repeated. The function has the signature Status(protobuf::StreamDecoder&); decoding
+  // stops at the first error it returns, which is returned from ForEach.
+  //
+  // Returns NOT_FOUND if the field does not occur, or DATA_LOSS if the stream
+  // cannot be read.
+  template <typename Function>
+  Status ForEach(uint32_t field_number, Function&& function) {
+    return Visit(field_number, kAllOccurrences, function);
+  }
+
+  // Calls function with a decoder for one occurrence of a repeated field.
+  // Returns NOT_FOUND if the field has fewer occurrences.
+  template <typename Function>
+  Status Decode(uint32_t field_number, size_t index, Function&& function) {
+    return Visit(field_number, index, function);
+  }
+
+  // Accessors for the sections of the upstream Snapshot message.
+
+  size_t log_count() const { return count(Number(Snapshot::Fields::LOGS)); }
+
+  size_t thread_count() const {
+    return count(Number(Snapshot::Fields::THREADS));
+  }
+
+  // Calls function for each pw.log.LogEntry in the snapshot.
+  template <typename Function>
+  Status ForEachLog(Function&& function) {
+    return ForEach(Number(Snapshot::Fields::LOGS), function);
+  }
+
+  // Calls function for each pw.thread.Thread in the snapshot.
+  template <typename Function>
+  Status ForEachThread(Function&& function) {
+    return ForEach(Number(Snapshot::Fields::THREADS), function);
+  }
+
+  // Calls function for the pw.thread.Thread at this index.
+  template <typename Function>
+  Status DecodeThread(size_t index, Function&& function) {
+    return Decode(Number(Snapshot::Fields::THREADS), index, function);
+  }
+
+  // Calls function with the pw.snapshot.Metadata.
+  template <typename Function>
+  Status DecodeMetadata(Function&& function) {
+    return ForEach(Number(Snapshot::Fields::METADATA), function);
+  }
+
+  // Calls function with the pw.cpu_exception.cortex_m.ArmV7mCpuState.
+  template <typename Function>
+  Status DecodeArmV7mCpuState(Function&& function) {
+    return ForEach(Number(Snapshot::Fields::ARMV7M_CPU_STATE), function);
+  }
+
+ private:
+  static constexpr size_t kAllOccurrences = static_cast<size_t>(-1);
+
+  static constexpr uint32_t Number(Snapshot::Fields field) {
+    return static_cast<uint32_t>(field);
+  }
+
+  Field* FindMutable(uint32_t field_number);
+
+  template <typename Function>
+  Status Visit(uint32_t field_number, size_t index, Function& function);
+
+  // Positions the reader at the field's first occurrence and returns the
+  // length of the region that holds all of its occurrences.
+  StatusWithSize SeekTo(const Field& field);
+
+  stream::SeekableReader& reader_;
+  std::span<Field> index_;
+  size_t field_count_;
+};
+
+// A SnapshotReader with storage to index kMaxFields distinct fields.
+template <size_t kMaxFields>
+class SnapshotReaderBuffer : public SnapshotReader {
+ public:
+  explicit constexpr SnapshotReaderBuffer(stream::SeekableReader& reader)
+      : SnapshotReader(reader, index_), index_{} {}
+
+ private:
+  std::array<Field, kMaxFields> index_;
+};
+
+template <typename Function>
+Status SnapshotReader::Visit(uint32_t field_number,
+                             size_t index,
+                             Function& function) {
+  const Field* field = Find(field_number);
+  if (field == nullptr ||
+      (index != kAllOccurrences && index >= field->count)) {
+    return Status::NotFound();
+  }
+
+  const StatusWithSize region = SeekTo(*field);
+  if (!region.ok()) {
+    return region.status();
+  }
+
+  protobuf::StreamDecoder decoder(reader_, region.size());
+  size_t occurrence = 0;
+  Status status;
+  while ((status = decoder.Next()).ok()) {
+    if (decoder.FieldNumber() != field_number) {
+      continue;
+    }
+    if (index == kAllOccurrences || occurrence == index) {
+      protobuf::StreamDecoder nested = decoder.GetNestedDecoder();
+      if (Status result = function(nested); !result.ok()) {
+        return result;
+      }
+      if (index != kAllOccurrences) {
+        return OkStatus();
+      }
+    }
+    occurrence += 1;
+  }
+
+  // The region was indexed, so reaching its end is the only expected way out.
+  return status.IsOutOfRange() ? OkStatus() : Status::DataLoss();
+}
+
+}  // namespace pw::snapshot
@@ -0,0 +1,205 @@
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Reads serialized pw.snapshot.Snapshot protos section by section.
+
+Decoding a whole Snapshot with the protobuf library parses every thread stack
+and log entry, even when only a few are needed. SnapshotReader instead makes a
+single pass over the top-level fields, recording where each occurrence of a
+field is, and only decodes a section when it is accessed.
+
+  reader = SnapshotReader.from_file('crash.snapshot')
+  print(reader.metadata().reason)
+  for thread in reader.threads():
+      print(thread.name)
+"""
+
+import mmap
+from pathlib import Path
+from typing import (Dict, Iterator, List, NamedTuple, Optional, Tuple, Type,
+                    TypeVar, Union)
+
+from google.protobuf.message import Message
+
+from pw_cpu_exception_cortex_m_protos import cpu_state_pb2
+from pw_log.proto import log_pb2
+from pw_snapshot_metadata_proto import snapshot_metadata_pb2
+from pw_thread_protos import thread_pb2
+
+# Field numbers of the pw.snapshot.Snapshot message.
+LOGS_FIELD = 1
+METADATA_FIELD = 16
+TAGS_FIELD = 17
+THREADS_FIELD = 18
+RELATED_SNAPSHOTS_FIELD = 19
+ARMV7M_CPU_STATE_FIELD = 20
+
+_VARINT = 0
+_FIXED64 = 1
+_DELIMITED = 2
+_FIXED32 = 5
+
+_MessageT = TypeVar('_MessageT', bound=Message)
+
+
+class DecodeError(Exception):
+    """The snapshot is not a valid protobuf message."""
+
+
+class Section(NamedTuple):
+    """The location of the payload of one length-delimited field."""
+    offset: int
+    size: int
+
+
+def _read_varint(data: memoryview, offset: int) -> Tuple[int, int]:
+    """Returns the varint at offset and the offset after it."""
+    value = 0
+    for shift in range(0, 64, 7):
+        if offset >= len(data):
+            raise DecodeError('Varint is cut off')
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7f) << shift
+        if not byte & 0x80:
+            return value, offset
+    raise DecodeError('Varint is too long')
+
+
+def index_fields(data: memoryview) -> Dict[int, List[Section]]:
+    """Finds the length-delimited top-level fields of a message.
+
+    Payloads are skipped, not parsed, so indexing takes time proportional to
+    the number of fields rather than the size of the message.
+    """
+    index: Dict[int, List[Section]] = {}
+    offset = 0
+
+    while offset < len(data):
+        key, offset = _read_varint(data, offset)
+        field_number, wire_type = key >> 3, key & 0x7
+
+        if wire_type == _VARINT:
+            _, offset = _read_varint(data, offset)
+            continue
+        if wire_type == _FIXED64:
+            offset += 8
+        elif wire_type == _FIXED32:
+            offset += 4
+        elif wire_type == _DELIMITED:
+            size, offset = _read_varint(data, offset)
+            index.setdefault(field_number, []).append(Section(offset, size))
+            offset += size
+        else:
+            raise DecodeError(f'Unsupported wire type {wire_type}')
+
+        if offset > len(data):
+            raise DecodeError(f'Field {field_number} is cut off')
+
+    return index
+
+
+class SnapshotReader:
+    """Decodes the sections of a serialized Snapshot on demand."""
+    def __init__(self, data: Union[bytes, bytearray, memoryview, mmap.mmap]):
+        self._data = memoryview(data)
+        self._index = index_fields(self._data)
+
+    @classmethod
+    def from_file(cls, path: Union[str, Path]) -> 'SnapshotReader':
+        """Memory-maps a snapshot file, so only accessed sections are read."""
+        with open(path, 'rb') as file:
+            if file.seek(0, 2) == 0:  # Empty files cannot be mapped.
+                return cls(b'')
+            return cls(mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ))
+
+    def field_numbers(self) -> List[int]:
+        """The numbers of the indexed fields, in the order they first occur."""
+        return list(self._index)
+
+    def count(self, field_number: int) -> int:
+        """The number of times a field occurs."""
+        return len(self._index.get(field_number, ()))
+
+    def raw(self, field_number: int) -> List[memoryview]:
+        """Returns the payload of each occurrence of a field, without copying.
+
+        This is how project-specific fields that extend the Snapshot, such as
+        metrics, are read.
+        """
+        return [
+            self._data[section.offset:section.offset + section.size]
+            for section in self._index.get(field_number, ())
+        ]
+
+    def decode_all(self, field_number: int,
+                   message_type: Type[_MessageT]) -> Iterator[_MessageT]:
+        """Decodes each occurrence of a repeated submessage field in turn."""
+        for payload in self.raw(field_number):
+            yield message_type.FromString(bytes(payload))
+
+    def decode(self, field_number: int, index: int,
+               message_type: Type[_MessageT]) -> _MessageT:
+        """Decodes one occurrence of a repeated submessage field."""
+        section = self._index.get(field_number, [])[index]
+        return message_type.FromString(
+            bytes(self._data[section.offset:section.offset + section.size]))
+
+    def decode_merged(self, field_number: int,
+                      message_type: Type[_MessageT]) -> Optional[_MessageT]:
+        """Decodes a singular submessage field, or returns None if absent.
+
+        Occurrences of the field are merged, as when decoding the whole message.
+        """
+        payloads = self.raw(field_number)
+        if not payloads:
+            return None
+
+        message = message_type()
+        for payload in payloads:
+            message.MergeFromString(bytes(payload))
+        return message
+
+    def metadata(self) -> Optional[snapshot_metadata_pb2.Metadata]:
+        return self.decode_merged(METADATA_FIELD,
+                                  snapshot_metadata_pb2.Metadata)
+
+    def armv7m_cpu_state(self) -> Optional[cpu_state_pb2.ArmV7mCpuState]:
+        return self.decode_merged(ARMV7M_CPU_STATE_FIELD,
+                                  cpu_state_pb2.ArmV7mCpuState)
+
+    def thread_count(self) -> int:
+        return self.count(THREADS_FIELD)
+
+    def thread(self, index: int) -> thread_pb2.Thread:
+        return self.decode(THREADS_FIELD, index, thread_pb2.Thread)
+
+    def threads(self) -> Iterator[thread_pb2.Thread]:
+        return self.decode_all(THREADS_FIELD, thread_pb2.Thread)
+
+    def log_count(self) -> int:
+        return self.count(LOGS_FIELD)
+
+    def logs(self) -> Iterator[log_pb2.LogEntry]:
+        return self.decode_all(LOGS_FIELD, log_pb2.LogEntry)
+
+    def tags(self) -> Dict[str, str]:
+        """Decodes the tags map. Later entries replace earlier ones."""
+        tags: Dict[str, str] = {}
+        for entry in self.raw(TAGS_FIELD):
+            fields = index_fields(entry)
+            key = fields.get(1, [Section(0, 0)])[-1]
+            value = fields.get(2, [Section(0, 0)])[-1]
+            tags[str(entry[key.offset:key.offset + key.size], 'utf-8')] = str(
+                entry[value.offset:value.offset + value.size], 'utf-8')
+        return tags
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Tests reading snapshots section by section."""
+
+import tempfile
+import unittest
+
+from pw_snapshot.reader import DecodeError, SnapshotReader, index_fields
+from pw_snapshot_metadata_proto import snapshot_metadata_pb2
+from pw_snapshot_protos import snapshot_pb2
+from pw_thread_protos import thread_pb2
+from pw_log.proto import log_pb2
+
+
+def _snapshot() -> snapshot_pb2.Snapshot:
+    return snapshot_pb2.Snapshot(
+        metadata=snapshot_metadata_pb2.Metadata(reason=b'Assert', fatal=True),
+        threads=[
+            thread_pb2.Thread(name=b'main', raw_stack=bytes(4096)),
+            thread_pb2.Thread(name=b'idle'),
+        ],
+        logs=[
+            log_pb2.LogEntry(message=b'one'),
+            log_pb2.LogEntry(message=b'two'),
+        ],
+        tags={'BtState': 'connected'},
+    )
+
+
+class IndexFieldsTest(unittest.TestCase):
+    """Tests indexing the top-level fields of a message."""
+    def test_empty(self):
+        self.assertEqual({}, index_fields(memoryview(b'')))
+
+    def test_skips_scalar_fields(self):
+        # Field 1 varint, field 2 fixed32, field 3 bytes, field 4 fixed64.
+        data = b'\x08\x96\x01\x15abcd\x1a\x02hi\x21abcdefgh'
+        index = index_fields(memoryview(data))
+        self.assertEqual([3], list(index))
+        section = index[3][0]
+        self.assertEqual(b'hi', data[section.offset:section.offset +
+                                     section.size])
+
+    def test_truncated(self):
+        with self.assertRaises(DecodeError):
+            index_fields(memoryview(b'\x1a\x05hi'))
+        with self.assertRaises(DecodeError):
+            index_fields(memoryview(b'\x08\x96'))
+
+
+class SnapshotReaderTest(unittest.TestCase):
+    """Tests decoding snapshot sections on demand."""
+    def setUp(self):
+        self._proto = _snapshot()
+        self._reader = SnapshotReader(self._proto.SerializeToString())
+
+    def test_counts(self):
+        self.assertEqual(2, self._reader.thread_count())
+        self.assertEqual(2, self._reader.log_count())
+        self.assertEqual(1, self._reader.count(16))
+        self.assertEqual(0, self._reader.count(20))
+
+    def test_metadata(self):
+        self.assertEqual(self._proto.metadata, self._reader.metadata())
+
+    def test_missing_section(self):
+        self.assertIsNone(self._reader.armv7m_cpu_state())
+
+    def test_threads(self):
+        self.assertEqual(list(self._proto.threads),
+                         list(self._reader.threads()))
+        self.assertEqual(b'idle', self._reader.thread(1).name)
+        with self.assertRaises(IndexError):
+            self._reader.thread(2)
+
+    def test_logs(self):
+        self.assertEqual([b'one', b'two'],
+                         [log.message for log in self._reader.logs()])
+
+    def test_tags(self):
+        self.assertEqual({'BtState': 'connected'}, self._reader.tags())
+
+    def test_merges_singular_sections(self):
+        extra = snapshot_pb2.Snapshot(metadata=snapshot_metadata_pb2.Metadata(
+            project_name=b'pigweed'))
+        reader = SnapshotReader(self._proto.SerializeToString() +
+                                extra.SerializeToString())
+
+        merged = snapshot_pb2.Snapshot()
+        merged.MergeFrom(self._proto)
+        merged.MergeFrom(extra)
+        self.assertEqual(merged.metadata, reader.metadata())
+
+    def test_raw_project_field(self):
+        data = self._proto.SerializeToString() + b'\xc2\x0c\x03abc'
+        self.assertEqual([b'abc'],
+                         [bytes(raw) for raw in SnapshotReader(data).raw(200)])
+
+    def test_from_file(self):
+        with tempfile.NamedTemporaryFile() as file:
+            file.write(self._proto.SerializeToString())
+            file.flush()
+            reader = SnapshotReader.from_file(file.name)
+            self.assertEqual(list(self._proto.threads), list(reader.threads()))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,189 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_snapshot/raw_capture.h"
+
+#include <cstring>
+
+#include "pw_snapshot_metadata_proto/snapshot_metadata.pwpb.h"
+#include "pw_snapshot_protos/snapshot.pwpb.h"
+#include "pw_status/try.h"
+#include "pw_thread_protos/thread.pwpb.h"
+
+namespace pw::snapshot {
+namespace {
+
+// Records are written in the device's byte order, since they are only read by
+// the device that wrote them.
+struct RecordHeader {
+  uint32_t type;
+  uint32_t size;
+};
+
+// The contents of a kThread record start with this header, followed by the
+// thread's name and stack.
+struct ThreadHeader {
+  uint64_t stack_start_pointer;
+  uint64_t stack_pointer;
+  uint32_t name_size;
+  uint32_t reserved;
+};
+
+template <typename T>
+ConstByteSpan AsBytes(const T& value) {
+  return std::as_bytes(std::span(&value, 1));
+}
+
+template <typename T>
+T Read(ConstByteSpan bytes) {
+  T value;
+  std::memcpy(&value, bytes.data(), sizeof(value));
+  return value;
+}
+
+Status EncodeThread(ConstByteSpan contents, protobuf::Encoder& encoder) {
+  if (contents.size() < sizeof(ThreadHeader)) {
+    return Status::DataLoss();
+  }
+  const ThreadHeader header = Read<ThreadHeader>(contents);
+  contents = contents.subspan(sizeof(header));
+
+  if (contents.size() < header.name_size) {
+    return Status::DataLoss();
+  }
+
+  PW_TRY(encoder.Push(static_cast<uint32_t>(Snapshot::Fields::THREADS)));
+  encoder.WriteBytes(static_cast<uint32_t>(thread::Thread::Fields::NAME),
+                     contents.first(header.name_size));
+  encoder.WriteBool(static_cast<uint32_t>(thread::Thread::Fields::ACTIVE),
+                    true);
+  encoder.WriteUint64(
+      static_cast<uint32_t>(thread::Thread::Fields::STACK_START_POINTER),
+      header.stack_start_pointer);
+  encoder.WriteUint64(
+      static_cast<uint32_t>(thread::Thread::Fields::STACK_POINTER),
+      header.stack_pointer);
+  encoder.WriteBytes(static_cast<uint32_t>(thread::Thread::Fields::RAW_STACK),
+                     contents.subspan(header.name_size));
+  return encoder.Pop();
+}
+
+}  // namespace
+
+Status RawCaptureWriter::WriteThread(std::string_view name,
+                                     uintptr_t stack_start_pointer,
+                                     uintptr_t stack_pointer,
+                                     ConstByteSpan stack) {
+  const ThreadHeader header = {stack_start_pointer,
+                               stack_pointer,
+                               static_cast<uint32_t>(name.size()),
+                               0};
+  return WriteRecord(RawRecordType::kThread,
+                     AsBytes(header),
+                     std::as_bytes(std::span(name)),
+                     stack);
+}
+
+Status RawCaptureWriter::WriteLogs(multisink::MultiSink::Drain& drain,
+                                   ByteSpan entry_buffer) {
+  while (true) {
+    uint32_t drop_count;
+    const Result<ConstByteSpan> entry =
+        drain.GetEntry(entry_buffer, drop_count);
+    if (entry.status().IsOutOfRange()) {
+      return OkStatus();
+    }
+    PW_TRY(entry.status());
+    PW_TRY(WriteRecord(RawRecordType::kLogEntry, entry.value()));
+  }
+}
+
+Status RawCaptureWriter::WriteRecord(RawRecordType type,
+                                     ConstByteSpan contents0,
+                                     ConstByteSpan contents1,
+                                     ConstByteSpan contents2) {
+  const size_t size = contents0.size() + contents1.size() + contents2.size();
+  if (writer_.ConservativeWriteLimit() < sizeof(RecordHeader) + size) {
+    return Status::ResourceExhausted();
+  }
+
+  const RecordHeader header = {static_cast<uint32_t>(type),
+                               static_cast<uint32_t>(size)};
+  PW_TRY(writer_.Write(AsBytes(header)));
+  PW_TRY(writer_.Write(contents0));
+  PW_TRY(writer_.Write(contents1));
+  return writer_.Write(contents2);
+}
+
+Status EncodeRawCapture(ConstByteSpan raw_capture,
+                        protobuf::Encoder& snapshot_encoder,
+                        CpuStateEncoder encode_cpu_state) {
+  bool wrote_metadata = false;
+
+  while (!raw_capture.empty()) {
+    if (raw_capture.size() < sizeof(RecordHeader)) {
+      return Status::DataLoss();
+    }
+    const RecordHeader header = Read<RecordHeader>(raw_capture);
+    raw_capture = raw_capture.subspan(sizeof(header));
+
+    if (raw_capture.size() < header.size) {
+      return Status::DataLoss();
+    }
+    const ConstByteSpan contents = raw_capture.first(header.size);
+    raw_capture = raw_capture.subspan(header.size);
+
+    switch (static_cast<RawRecordType>(header.type)) {
+      case RawRecordType::kReason:
+        PW_TRY(snapshot_encoder.Push(
+            static_cast<uint32_t>(Snapshot::Fields::METADATA)));
+        snapshot_encoder.WriteBytes(
+            static_cast<uint32_t>(Metadata::Fields::REASON), contents);
+        snapshot_encoder.WriteBool(
+            static_cast<uint32_t>(Metadata::Fields::FATAL), true);
+        PW_TRY(snapshot_encoder.Pop());
+        wrote_metadata = true;
+        break;
+      case RawRecordType::kArmV7mCpuState:
+        if (encode_cpu_state != nullptr) {
+          PW_TRY(snapshot_encoder.Push(
+              static_cast<uint32_t>(Snapshot::Fields::ARMV7M_CPU_STATE)));
+          PW_TRY(encode_cpu_state(snapshot_encoder, contents));
+          PW_TRY(snapshot_encoder.Pop());
+        }
+        break;
+      case RawRecordType::kThread:
+        PW_TRY(EncodeThread(contents, snapshot_encoder));
+        break;
+      case RawRecordType::kLogEntry:
+        PW_TRY(snapshot_encoder.WriteBytes(
+            static_cast<uint32_t>(Snapshot::Fields::LOGS), contents));
+        break;
+      default:
+        // Skip records added after this encoder was written.
+        break;
+    }
+  }
+
+  if (!wrote_metadata) {
+    PW_TRY(snapshot_encoder.Push(
+        static_cast<uint32_t>(Snapshot::Fields::METADATA)));
+    snapshot_encoder.WriteBool(static_cast<uint32_t>(Metadata::Fields::FATAL),
+                               true);
+    PW_TRY(snapshot_encoder.Pop());
+  }
+  return OkStatus();
+}
+
+}  // namespace pw::snapshot
@@ -0,0 +1,275 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_snapshot/raw_capture.h"
+
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_multisink/multisink.h"
+#include "pw_persistent_ram/persistent_buffer.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_snapshot_metadata_proto/snapshot_metadata.pwpb.h"
+#include "pw_snapshot_protos/snapshot.pwpb.h"
+#include "pw_thread_protos/thread.pwpb.h"
+
+namespace pw::snapshot {
+namespace {
+
+using namespace std::literals::string_view_literals;
+
+// A stand-in for a CPU state struct such as pw_cpu_exception_State.
+struct FakeCpuState {
+  uint32_t pc;
+  uint32_t lr;
+};
+
+// Encodes the fake CPU state as fields 1 and 2.
+Status EncodeFakeCpuState(protobuf::Encoder& encoder, ConstByteSpan raw) {
+  if (raw.size() != sizeof(FakeCpuState)) {
+    return Status::InvalidArgument();
+  }
+  FakeCpuState state;
+  std::memcpy(&state, raw.data(), sizeof(state));
+  encoder.WriteUint32(1, state.pc);
+  return encoder.WriteUint32(2, state.lr);
+}
+
+std::string_view AsString(ConstByteSpan bytes) {
+  return std::string_view(reinterpret_cast<const char*>(bytes.data()),
+                          bytes.size());
+}
+
+class RawCapture : public ::testing::Test {
+ protected:
+  RawCapture() : encoder_(encode_buffer_) {
+    persistent_buffer_.clear();
+  }
+
+  ConstByteSpan capture() const {
+    return ConstByteSpan(persistent_buffer_.data(), persistent_buffer_.size());
+  }
+
+  // Encodes the capture and returns the Snapshot.
+  ConstByteSpan Encode(CpuStateEncoder encode_cpu_state = nullptr) {
+    EXPECT_EQ(OkStatus(),
+              EncodeRawCapture(capture(), encoder_, encode_cpu_state));
+    Result<ConstByteSpan> snapshot = encoder_.Encode();
+    EXPECT_EQ(OkStatus(), snapshot.status());
+    return snapshot.value_or(ConstByteSpan());
+  }
+
+  persistent_ram::PersistentBuffer<256> persistent_buffer_;
+  std::array<std::byte, 512> encode_buffer_ = {};
+  protobuf::NestedEncoder<4, 8> encoder_;
+};
+
+TEST_F(RawCapture, Empty_EncodesFatalMetadata) {
+  protobuf::Decoder snapshot(Encode());
+
+  ASSERT_EQ(OkStatus(), snapshot.Next());
+  ASSERT_EQ(static_cast<uint32_t>(Snapshot::Fields::METADATA),
+            snapshot.FieldNumber());
+  ConstByteSpan metadata_bytes;
+  ASSERT_EQ(OkStatus(), snapshot.ReadBytes(&metadata_bytes));
+
+  protobuf::Decoder metadata(metadata_bytes);
+  ASSERT_EQ(OkStatus(), metadata.Next());
+  EXPECT_EQ(static_cast<uint32_t>(Metadata::Fields::FATAL),
+            metadata.FieldNumber());
+  bool fatal = false;
+  EXPECT_EQ(OkStatus(), metadata.ReadBool(&fatal));
+  EXPECT_TRUE(fatal);
+
+  EXPECT_EQ(Status::OutOfRange(), snapshot.Next());
+}
+
+TEST_F(RawCapture, ReasonAndCpuState) {
+  auto writer = persistent_buffer_.GetWriter();
+  RawCaptureWriter capture_writer(writer);
+  ASSERT_EQ(OkStatus(), capture_writer.WriteReason("HardFault"));
+  ASSERT_EQ(OkStatus(),
+            capture_writer.WriteArmV7mCpuState(FakeCpuState{0x1234, 0x5678}));
+
+  protobuf::Decoder snapshot(Encode(EncodeFakeCpuState));
+
+  ASSERT_EQ(OkStatus(), snapshot.Next());
+  ASSERT_EQ(static_cast<uint32_t>(Snapshot::Fields::METADATA),
+            snapshot.FieldNumber());
+  ConstByteSpan metadata_bytes;
+  ASSERT_EQ(OkStatus(), snapshot.ReadBytes(&metadata_bytes));
+
+  protobuf::Decoder metadata(metadata_bytes);
+  ASSERT_EQ(OkStatus(), metadata.Next());
+  ASSERT_EQ(static_cast<uint32_t>(Metadata::Fields::REASON),
+            metadata.FieldNumber());
+  ConstByteSpan reason;
+  ASSERT_EQ(OkStatus(), metadata.ReadBytes(&reason));
+  EXPECT_EQ("HardFault"sv, AsString(reason));
+
+  ASSERT_EQ(OkStatus(), snapshot.Next());
+  ASSERT_EQ(static_cast<uint32_t>(Snapshot::Fields::ARMV7M_CPU_STATE),
+            snapshot.FieldNumber());
+  ConstByteSpan cpu_state_bytes;
+  ASSERT_EQ(OkStatus(), snapshot.ReadBytes(&cpu_state_bytes));
+
+  protobuf::Decoder cpu_state(cpu_state_bytes);
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), cpu_state.Next());
+  ASSERT_EQ(OkStatus(), cpu_state.ReadUint32(&value));
+  EXPECT_EQ(0x1234u, value);
+  ASSERT_EQ(OkStatus(), cpu_state.Next());
+  ASSERT_EQ(OkStatus(), cpu_state.ReadUint32(&value));
+  EXPECT_EQ(0x5678u, value);
+
+  EXPECT_EQ(Status::OutOfRange(), snapshot.Next());
+}
+
+TEST_F(RawCapture, CpuState_NoEncoder_Skipped) {
+  auto writer = persistent_buffer_.GetWriter();
+  RawCaptureWriter capture_writer(writer);
+  ASSERT_EQ(OkStatus(),
+            capture_writer.WriteArmV7mCpuState(FakeCpuState{1, 2}));
+
+  protobuf::Decoder snapshot(Encode());
+
+  ASSERT_EQ(OkStatus(), snapshot.Next());
+  EXPECT_EQ(static_cast<uint32_t>(Snapshot::Fields::METADATA),
+            snapshot.FieldNumber());
+  EXPECT_EQ(Status::OutOfRange(), snapshot.Next());
+}
+
+TEST_F(RawCapture, Thread) {
+  constexpr auto kStack = std::array<std::byte, 4>{
+      std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}};
+
+  auto writer = persistent_buffer_.GetWriter();
+  RawCaptureWriter capture_writer(writer);
+  ASSERT_EQ(OkStatus(),
+            capture_writer.WriteThread("main", 0x2000, 0x1F00, kStack));
+
+  protobuf::Decoder snapshot(Encode());
+
+  ASSERT_EQ(OkStatus(), snapshot.Next());
+  ASSERT_EQ(static_cast<uint32_t>(Snapshot::Fields::THREADS),
+            snapshot.FieldNumber());
+  ConstByteSpan thread_bytes;
+  ASSERT_EQ(OkStatus(), snapshot.ReadBytes(&thread_bytes));
+
+  protobuf::Decoder thread(thread_bytes);
+  ConstByteSpan bytes;
+  uint64_t pointer = 0;
+  bool active = false;
+
+  ASSERT_EQ(OkStatus(), thread.Next());
+  ASSERT_EQ(OkStatus(), thread.ReadBytes(&bytes));
+  EXPECT_EQ("main"sv, AsString(bytes));
+
+  ASSERT_EQ(OkStatus(), thread.Next());
+  ASSERT_EQ(OkStatus(), thread.ReadBool(&active));
+  EXPECT_TRUE(active);
+
+  ASSERT_EQ(OkStatus(), thread.Next());
+  ASSERT_EQ(static_cast<uint32_t>(thread::Thread::Fields::STACK_START_POINTER),
+            thread.FieldNumber());
+  ASSERT_EQ(OkStatus(), thread.ReadUint64(&pointer));
+  EXPECT_EQ(0x2000u, pointer);
+
+  ASSERT_EQ(OkStatus(), thread.Next());
+  ASSERT_EQ(static_cast<uint32_t>(thread::Thread::Fields::STACK_POINTER),
+            thread.FieldNumber());
+  ASSERT_EQ(OkStatus(), thread.ReadUint64(&pointer));
+  EXPECT_EQ(0x1F00u, pointer);
+
+  ASSERT_EQ(OkStatus(), thread.Next());
+  ASSERT_EQ(static_cast<uint32_t>(thread::Thread::Fields::RAW_STACK),
+            thread.FieldNumber());
+  ASSERT_EQ(OkStatus(), thread.ReadBytes(&bytes));
+  ASSERT_EQ(kStack.size(), bytes.size());
+  EXPECT_EQ(0, std::memcmp(kStack.data(), bytes.data(), kStack.size()));
+}
+
+TEST_F(RawCapture, Logs_DrainedUntilFull) {
+  std::array<std::byte, 512> multisink_buffer;
+  multisink::MultiSink multisink(multisink_buffer);
+  multisink::MultiSink::Drain drain;
+  multisink.AttachDrain(drain);
+
+  constexpr auto kEntry = std::array<std::byte, 60>{};
+  for (int i = 0; i < 5; ++i) {
+    multisink.HandleEntry(kEntry);
+  }
+
+  auto writer = persistent_buffer_.GetWriter();
+  RawCaptureWriter capture_writer(writer);
+  std::array<std::byte, 64> entry_buffer;
+
+  // Only 3 entries fit in the capture, with their record headers.
+  EXPECT_EQ(Status::ResourceExhausted(),
+            capture_writer.WriteLogs(drain, entry_buffer));
+  EXPECT_EQ(3 * (8 + kEntry.size()), persistent_buffer_.size());
+
+  protobuf::Decoder snapshot(Encode());
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(OkStatus(), snapshot.Next());
+    EXPECT_EQ(static_cast<uint32_t>(Snapshot::Fields::LOGS),
+              snapshot.FieldNumber());
+  }
+  ASSERT_EQ(OkStatus(), snapshot.Next());
+  EXPECT_EQ(static_cast<uint32_t>(Snapshot::Fields::METADATA),
+            snapshot.FieldNumber());
+}
+
+TEST_F(RawCapture, RecordTooLarge_WritesNothing) {
+  constexpr std::array<std::byte, 250> kStack = {};
+
+  auto writer = persistent_buffer_.GetWriter();
+  RawCaptureWriter capture_writer(writer);
+  ASSERT_EQ(OkStatus(), capture_writer.WriteReason("Assert"));
+  const size_t size = persistent_buffer_.size();
+
+  EXPECT_EQ(Status::ResourceExhausted(),
+            capture_writer.WriteThread("main", 0, 0, kStack));
+  EXPECT_EQ(size, persistent_buffer_.size());
+}
+
+TEST_F(RawCapture, Truncated_DataLoss) {
+  auto writer = persistent_buffer_.GetWriter();
+  RawCaptureWriter capture_writer(writer);
+  ASSERT_EQ(OkStatus(), capture_writer.WriteReason("Assert"));
+  ASSERT_EQ(OkStatus(), capture_writer.WriteReason("Second"));
+
+  EXPECT_EQ(Status::DataLoss(),
+            EncodeRawCapture(capture().first(capture().size() - 1), encoder_));
+}
+
+TEST_F(RawCapture, UnknownRecord_Skipped) {
+  auto writer = persistent_buffer_.GetWriter();
+  RawCaptureWriter capture_writer(writer);
+  ASSERT_EQ(OkStatus(),
+            capture_writer.WriteRecord(static_cast<RawRecordType>(1000),
+                                       std::as_bytes(std::span("data"))));
+  ASSERT_EQ(OkStatus(), capture_writer.WriteReason("Assert"));
+
+  protobuf::Decoder snapshot(Encode());
+  ASSERT_EQ(OkStatus(), snapshot.Next());
+  EXPECT_EQ(static_cast<uint32_t>(Snapshot::Fields::METADATA),
+            snapshot.FieldNumber());
+  EXPECT_EQ(Status::OutOfRange(), snapshot.Next());
+}
+
+}  // namespace
+}  // namespace pw::snapshot
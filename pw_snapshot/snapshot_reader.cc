@@ -0,0 +1,83 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_snapshot/snapshot_reader.h"
+
+namespace pw::snapshot {
+
+Status SnapshotReader::Index() {
+  field_count_ = 0;
+  bool index_full = false;
+
+  // The end of the last indexed field. Only delimited fields have a known end
+  // without reading them, so this is a field boundary at or before the key of
+  // the current field.
+  size_t boundary = reader_.Tell();
+
+  // A delimited field is indexed once Next() has skipped its payload, so a
+  // field that is cut off is not indexed.
+  bool pending = false;
+  uint32_t pending_number = 0;
+  size_t pending_end = 0;
+
+  protobuf::StreamDecoder decoder(reader_);
+  Status status;
+  do {
+    status = decoder.Next();
+
+    if (pending && (status.ok() || status.IsOutOfRange())) {
+      if (Field* field = FindMutable(pending_number); field != nullptr) {
+        field->count += 1;
+        field->end = pending_end;
+      } else if (field_count_ < index_.size()) {
+        index_[field_count_++] = {pending_number, 1, boundary, pending_end};
+      } else {
+        index_full = true;
+      }
+      boundary = pending_end;
+    }
+
+    // Next() has read the key and length, so a delimited field's payload
+    // starts at the reader's position.
+    const StatusWithSize payload_size = decoder.FieldSize();
+    pending = status.ok() && payload_size.ok();
+    if (pending) {
+      pending_number = decoder.FieldNumber();
+      pending_end = reader_.Tell() + payload_size.size();
+    }
+  } while (status.ok());
+
+  if (!status.IsOutOfRange()) {
+    return Status::DataLoss();
+  }
+  return index_full ? Status::ResourceExhausted() : OkStatus();
+}
+
+SnapshotReader::Field* SnapshotReader::FindMutable(uint32_t field_number) {
+  for (Field& field : index_.first(field_count_)) {
+    if (field.number == field_number) {
+      return &field;
+    }
+  }
+  return nullptr;
+}
+
+StatusWithSize SnapshotReader::SeekTo(const Field& field) {
+  if (!reader_.Seek(field.begin).ok()) {
+    return StatusWithSize::DataLoss();
+  }
+  return StatusWithSize(field.end - field.begin);
+}
+
+}  // namespace pw::snapshot
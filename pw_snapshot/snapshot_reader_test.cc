@@ -0,0 +1,310 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_snapshot/snapshot_reader.h"
+
+#include <array>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_log/proto/log.pwpb.h"
+#include "pw_protobuf/encoder.h"
+#include "pw_snapshot_metadata_proto/snapshot_metadata.pwpb.h"
+#include "pw_snapshot_protos/snapshot.pwpb.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_thread_protos/thread.pwpb.h"
+
+namespace pw::snapshot {
+namespace {
+
+using namespace std::literals::string_view_literals;
+
+constexpr uint32_t Number(Snapshot::Fields field) {
+  return static_cast<uint32_t>(field);
+}
+
+// A MemoryReader that counts the bytes read, to check which sections are
+// decoded.
+class CountingReader final : public stream::SeekableReader {
+ public:
+  CountingReader(ConstByteSpan source) : reader_(source), bytes_read_(0) {}
+
+  size_t bytes_read() const { return bytes_read_; }
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override {
+    Result<ByteSpan> read = reader_.Read(dest);
+    if (!read.ok()) {
+      return StatusWithSize(read.status(), 0);
+    }
+    bytes_read_ += read.value().size();
+    return StatusWithSize(read.value().size());
+  }
+
+  Status DoSeek(ptrdiff_t offset, stream::Whence origin) override {
+    return reader_.Seek(offset, origin);
+  }
+
+  size_t DoTell() const override { return reader_.Tell(); }
+
+  stream::MemoryReader reader_;
+  size_t bytes_read_;
+};
+
+class SnapshotReaderTest : public ::testing::Test {
+ protected:
+  SnapshotReaderTest() : encoder_(encode_buffer_) {}
+
+  void AddThread(std::string_view name, size_t stack_size = 0) {
+    encoder_.Push(Number(Snapshot::Fields::THREADS));
+    encoder_.WriteBytes(static_cast<uint32_t>(thread::Thread::Fields::NAME),
+                        std::as_bytes(std::span(name)));
+    if (stack_size != 0u) {
+      encoder_.WriteBytes(
+          static_cast<uint32_t>(thread::Thread::Fields::RAW_STACK),
+          std::span(stack_).first(stack_size));
+    }
+    encoder_.Pop();
+  }
+
+  void AddLog(std::string_view message) {
+    encoder_.Push(Number(Snapshot::Fields::LOGS));
+    encoder_.WriteBytes(static_cast<uint32_t>(log::LogEntry::Fields::MESSAGE),
+                        std::as_bytes(std::span(message)));
+    encoder_.Pop();
+  }
+
+  void AddMetadata(std::string_view reason) {
+    encoder_.Push(Number(Snapshot::Fields::METADATA));
+    encoder_.WriteBytes(static_cast<uint32_t>(Metadata::Fields::REASON),
+                        std::as_bytes(std::span(reason)));
+    encoder_.Pop();
+  }
+
+  ConstByteSpan Encode() {
+    Result<ConstByteSpan> snapshot = encoder_.Encode();
+    EXPECT_EQ(OkStatus(), snapshot.status());
+    return snapshot.value_or(ConstByteSpan());
+  }
+
+  std::array<std::byte, 2048> stack_ = {};
+  std::array<std::byte, 4096> encode_buffer_ = {};
+  protobuf::NestedEncoder<4, 16> encoder_;
+};
+
+// Reads the first field of a submessage as a string.
+Status ReadFirstString(protobuf::StreamDecoder& decoder,
+                       std::span<char> buffer,
+                       std::string_view& out) {
+  if (Status status = decoder.Next(); !status.ok()) {
+    return status;
+  }
+  StatusWithSize result = decoder.ReadString(buffer);
+  out = std::string_view(buffer.data(), result.size());
+  return result.status();
+}
+
+TEST_F(SnapshotReaderTest, Index_Empty) {
+  stream::MemoryReader stream(ConstByteSpan{});
+  SnapshotReaderBuffer<4> reader(stream);
+
+  EXPECT_EQ(OkStatus(), reader.Index());
+  EXPECT_TRUE(reader.fields().empty());
+  EXPECT_EQ(0u, reader.thread_count());
+  EXPECT_EQ(0u, reader.log_count());
+  EXPECT_EQ(Status::NotFound(),
+            reader.DecodeMetadata(
+                [](protobuf::StreamDecoder&) { return OkStatus(); }));
+}
+
+TEST_F(SnapshotReaderTest, Index_CountsEachField) {
+  AddMetadata("Assert");
+  AddThread("main");
+  AddLog("first");
+  AddThread("idle");
+  AddLog("second");
+  AddLog("third");
+  stream::MemoryReader stream(Encode());
+  SnapshotReaderBuffer<4> reader(stream);
+
+  ASSERT_EQ(OkStatus(), reader.Index());
+  ASSERT_EQ(3u, reader.fields().size());
+  EXPECT_EQ(Number(Snapshot::Fields::METADATA), reader.fields()[0].number);
+  EXPECT_EQ(Number(Snapshot::Fields::THREADS), reader.fields()[1].number);
+  EXPECT_EQ(Number(Snapshot::Fields::LOGS), reader.fields()[2].number);
+  EXPECT_EQ(1u, reader.count(Number(Snapshot::Fields::METADATA)));
+  EXPECT_EQ(2u, reader.thread_count());
+  EXPECT_EQ(3u, reader.log_count());
+  EXPECT_EQ(0u, reader.count(Number(Snapshot::Fields::ARMV7M_CPU_STATE)));
+}
+
+TEST_F(SnapshotReaderTest, DecodeThread_ByIndex) {
+  AddThread("main");
+  AddLog("interleaved");
+  AddThread("idle");
+  AddThread("worker");
+  stream::MemoryReader stream(Encode());
+  SnapshotReaderBuffer<4> reader(stream);
+  ASSERT_EQ(OkStatus(), reader.Index());
+
+  std::array<char, 16> buffer;
+  std::string_view name;
+  auto read_name = [&](protobuf::StreamDecoder& thread) {
+    return ReadFirstString(thread, buffer, name);
+  };
+
+  EXPECT_EQ(OkStatus(), reader.DecodeThread(2, read_name));
+  EXPECT_EQ("worker"sv, name);
+  EXPECT_EQ(OkStatus(), reader.DecodeThread(0, read_name));
+  EXPECT_EQ("main"sv, name);
+  EXPECT_EQ(OkStatus(), reader.DecodeThread(1, read_name));
+  EXPECT_EQ("idle"sv, name);
+  EXPECT_EQ(Status::NotFound(), reader.DecodeThread(3, read_name));
+}
+
+TEST_F(SnapshotReaderTest, ForEachLog_InOrder) {
+  AddLog("one");
+  AddThread("main", 64);
+  AddLog("two");
+  AddMetadata("Assert");
+  AddLog("three");
+  stream::MemoryReader stream(Encode());
+  SnapshotReaderBuffer<4> reader(stream);
+  ASSERT_EQ(OkStatus(), reader.Index());
+
+  std::array<std::string_view, 3> expected = {"one"sv, "two"sv, "three"sv};
+  size_t logs = 0;
+  EXPECT_EQ(OkStatus(),
+            reader.ForEachLog([&](protobuf::StreamDecoder& log) {
+              std::array<char, 16> buffer;
+              std::string_view message;
+              if (Status status = ReadFirstString(log, buffer, message);
+                  !status.ok()) {
+                return status;
+              }
+              EXPECT_EQ(expected[logs], message);
+              logs += 1;
+              return OkStatus();
+            }));
+  EXPECT_EQ(3u, logs);
+}
+
+TEST_F(SnapshotReaderTest, ForEach_StopsAtFunctionError) {
+  AddLog("one");
+  AddLog("two");
+  AddLog("three");
+  stream::MemoryReader stream(Encode());
+  SnapshotReaderBuffer<4> reader(stream);
+  ASSERT_EQ(OkStatus(), reader.Index());
+
+  size_t logs = 0;
+  EXPECT_EQ(Status::Cancelled(),
+            reader.ForEachLog([&](protobuf::StreamDecoder&) {
+              logs += 1;
+              return logs == 2 ? Status::Cancelled() : OkStatus();
+            }));
+  EXPECT_EQ(2u, logs);
+}
+
+TEST_F(SnapshotReaderTest, ForEach_ProjectSpecificField) {
+  constexpr uint32_t kMetricsField = 200;
+  AddThread("main");
+  encoder_.Push(kMetricsField);
+  encoder_.WriteUint32(1, 42);
+  encoder_.Pop();
+  stream::MemoryReader stream(Encode());
+  SnapshotReaderBuffer<4> reader(stream);
+  ASSERT_EQ(OkStatus(), reader.Index());
+
+  uint32_t value = 0;
+  EXPECT_EQ(OkStatus(),
+            reader.ForEach(kMetricsField, [&](protobuf::StreamDecoder& metrics) {
+              if (Status status = metrics.Next(); !status.ok()) {
+                return status;
+              }
+              return metrics.ReadUint32(&value);
+            }));
+  EXPECT_EQ(42u, value);
+}
+
+TEST_F(SnapshotReaderTest, Index_SkipsScalarFields) {
+  encoder_.WriteUint32(100, 7);
+  AddLog("one");
+  encoder_.WriteFixed64(101, 7);
+  AddLog("two");
+  stream::MemoryReader stream(Encode());
+  SnapshotReaderBuffer<4> reader(stream);
+  ASSERT_EQ(OkStatus(), reader.Index());
+
+  ASSERT_EQ(1u, reader.fields().size());
+  EXPECT_EQ(2u, reader.log_count());
+
+  size_t logs = 0;
+  EXPECT_EQ(OkStatus(), reader.ForEachLog([&](protobuf::StreamDecoder&) {
+    logs += 1;
+    return OkStatus();
+  }));
+  EXPECT_EQ(2u, logs);
+}
+
+TEST_F(SnapshotReaderTest, Index_OnlyReadsKeys) {
+  AddThread("main", sizeof(stack_));
+  AddThread("idle", sizeof(stack_) / 2);
+  AddLog("one");
+  CountingReader stream(Encode());
+  SnapshotReaderBuffer<4> reader(stream);
+
+  ASSERT_EQ(OkStatus(), reader.Index());
+  EXPECT_LT(stream.bytes_read(), 16u);
+  EXPECT_EQ(2u, reader.thread_count());
+
+  // Decoding a log seeks over the threads' stacks.
+  const size_t indexed = stream.bytes_read();
+  std::array<char, 16> buffer;
+  std::string_view message;
+  EXPECT_EQ(OkStatus(), reader.ForEachLog([&](protobuf::StreamDecoder& log) {
+    return ReadFirstString(log, buffer, message);
+  }));
+  EXPECT_EQ("one"sv, message);
+  EXPECT_LT(stream.bytes_read() - indexed, 16u);
+}
+
+TEST_F(SnapshotReaderTest, Index_FullIndex) {
+  AddMetadata("Assert");
+  AddThread("main");
+  AddLog("one");
+  AddThread("idle");
+  stream::MemoryReader stream(Encode());
+  SnapshotReaderBuffer<2> reader(stream);
+
+  EXPECT_EQ(Status::ResourceExhausted(), reader.Index());
+  EXPECT_EQ(2u, reader.fields().size());
+  EXPECT_EQ(2u, reader.thread_count());
+  EXPECT_EQ(0u, reader.log_count());
+}
+
+TEST_F(SnapshotReaderTest, Index_Truncated) {
+  AddThread("main");
+  AddLog("one");
+  ConstByteSpan snapshot = Encode();
+  stream::MemoryReader stream(snapshot.first(snapshot.size() - 1));
+  SnapshotReaderBuffer<4> reader(stream);
+
+  EXPECT_EQ(Status::DataLoss(), reader.Index());
+  EXPECT_EQ(1u, reader.thread_count());
+  EXPECT_EQ(0u, reader.log_count());
+}
+
+}  // namespace
+}  // namespace pw::snapshot
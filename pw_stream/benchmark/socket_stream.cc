@@ -0,0 +1,179 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures SocketServer and SocketStream over loopback. The latency test sends
+// small requests as a header and a payload, as HDLC and RPC do, and waits for a
+// response each time; without TCP_NODELAY, the second write waits for the
+// acknowledgement of the first. The throughput test has many clients streaming
+// data to one thread that services them all with SocketStream::Poll(). Host
+// only.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_stream/socket_stream.h"
+
+namespace {
+
+using pw::stream::SocketOptions;
+using pw::stream::SocketServer;
+using pw::stream::SocketStream;
+
+constexpr size_t kRoundTrips = 200;
+constexpr size_t kMaxClients = 32;
+constexpr size_t kBytesPerClient = 4 << 20;
+
+int64_t ElapsedMicroseconds(pw::chrono::SystemClock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             pw::chrono::SystemClock::now() - start)
+      .count();
+}
+
+void MeasureRoundTrips(const char* name, const SocketOptions& options) {
+  SocketServer server;
+  PW_CHECK_OK(server.Listen(0, options));
+
+  std::thread echo([&server] {
+    SocketStream connection;
+    PW_CHECK_OK(server.Accept(connection));
+    std::array<std::byte, 64> request;
+    for (size_t i = 0; i < kRoundTrips; ++i) {
+      size_t received = 0;
+      while (received < request.size()) {
+        auto result = connection.Read(std::span(request).subspan(received));
+        PW_CHECK_OK(result.status());
+        received += result.value().size();
+      }
+      PW_CHECK_OK(connection.Write(std::span(request).first(8)));
+    }
+  });
+
+  SocketStream client;
+  PW_CHECK_OK(client.Connect(nullptr, server.port(), options));
+  std::array<std::byte, 64> request = {};
+  std::array<std::byte, 8> response;
+
+  const auto start = pw::chrono::SystemClock::now();
+  for (size_t i = 0; i < kRoundTrips; ++i) {
+    PW_CHECK_OK(client.Write(std::span(request).first(8)));
+    PW_CHECK_OK(client.Write(std::span(request).subspan(8)));
+    size_t received = 0;
+    while (received < response.size()) {
+      auto result = client.Read(std::span(response).subspan(received));
+      PW_CHECK_OK(result.status());
+      received += result.value().size();
+    }
+  }
+  const int64_t elapsed_us = ElapsedMicroseconds(start);
+  echo.join();
+
+  PW_LOG_INFO("%-40s %8ld us/round trip",
+              name,
+              static_cast<long>(elapsed_us / int64_t{kRoundTrips}));
+}
+
+void MeasureThroughput(size_t clients, const SocketOptions& options) {
+  SocketServer server;
+  PW_CHECK_OK(server.Listen(0, options));
+
+  std::array<std::thread, kMaxClients> senders;
+  for (size_t i = 0; i < clients; ++i) {
+    senders[i] = std::thread([&server, &options] {
+      SocketStream client;
+      PW_CHECK_OK(client.Connect(nullptr, server.port(), options));
+      std::array<std::byte, 1024> data = {};
+      for (size_t sent = 0; sent < kBytesPerClient; sent += data.size()) {
+        PW_CHECK_OK(client.Write(data));
+      }
+    });
+  }
+
+  std::array<SocketStream, kMaxClients> connections;
+  std::array<SocketStream*, kMaxClients> open;
+  for (size_t i = 0; i < clients; ++i) {
+    PW_CHECK_OK(server.Accept(connections[i]));
+    open[i] = &connections[i];
+  }
+
+  const auto start = pw::chrono::SystemClock::now();
+  size_t open_count = clients;
+  size_t total_bytes = 0;
+  std::array<bool, kMaxClients> ready;
+  std::array<std::byte, 16 * 1024> buffer;
+  while (open_count != 0u) {
+    PW_CHECK_OK(SocketStream::Poll(std::span(open).first(open_count),
+                                   SocketStream::Readiness::kReadable,
+                                   ready,
+                                   -1)
+                    .status());
+    for (size_t i = 0; i < open_count;) {
+      if (ready[i]) {
+        auto result = open[i]->TryRead(buffer);
+        if (result.status().IsOutOfRange()) {
+          // Replace the closed connection with the last one.
+          ready[i] = ready[open_count - 1];
+          open[i] = open[--open_count];
+          continue;
+        }
+        if (result.ok()) {
+          total_bytes += result.value().size();
+        }
+      }
+      ++i;
+    }
+  }
+  const int64_t elapsed_us = ElapsedMicroseconds(start);
+
+  for (size_t i = 0; i < clients; ++i) {
+    senders[i].join();
+  }
+  PW_CHECK_UINT_EQ(total_bytes, clients * kBytesPerClient);
+
+  const int64_t bytes_per_second = static_cast<int64_t>(total_bytes) *
+                                   1'000'000 / std::max<int64_t>(elapsed_us, 1);
+  PW_LOG_INFO("%2u clients, %7d byte kernel buffers %10ld MiB/s",
+              static_cast<unsigned>(clients),
+              options.receive_buffer_bytes,
+              static_cast<long>(bytes_per_second >> 20));
+}
+
+}  // namespace
+
+int main() {
+  SocketOptions nagle;
+  nagle.no_delay = false;
+
+  PW_LOG_INFO("Round trips of a 64-byte request in two writes");
+  MeasureRoundTrips("TCP_NODELAY", SocketOptions{});
+  MeasureRoundTrips("Nagle's algorithm", nagle);
+
+  SocketOptions large_buffers;
+  large_buffers.send_buffer_bytes = 1 << 20;
+  large_buffers.receive_buffer_bytes = 1 << 20;
+
+  PW_LOG_INFO("Streaming %u KiB from each client to one polling thread",
+              static_cast<unsigned>(kBytesPerClient / 1024));
+  for (size_t clients : {1u, 8u, 32u}) {
+    MeasureThroughput(clients, SocketOptions{});  // Kernel default buffers
+    MeasureThroughput(clients, large_buffers);
+  }
+  return 0;
+}
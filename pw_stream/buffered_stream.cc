@@ -0,0 +1,126 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_stream/buffered_stream.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+namespace pw::stream {
+
+Status BufferedWriter::Flush() {
+  if (buffered_bytes_ == 0) {
+    return OkStatus();
+  }
+  if (Status status = writer_.Write(buffer_.first(buffered_bytes_));
+      !status.ok()) {
+    return status;
+  }
+  buffered_bytes_ = 0;
+  return OkStatus();
+}
+
+size_t BufferedWriter::ConservativeWriteLimit() const {
+  const size_t limit = writer_.ConservativeWriteLimit();
+  if (limit == std::numeric_limits<size_t>::max()) {
+    return limit;
+  }
+  return limit > buffered_bytes_ ? limit - buffered_bytes_ : 0;
+}
+
+Status BufferedWriter::DoWrite(ConstByteSpan data) {
+  // Send a large write and the buffered data together in one operation.
+  if (data.size_bytes() >= buffer_.size_bytes() && buffered_bytes_ != 0) {
+    const std::array<ConstByteSpan, 2> buffers = {
+        buffer_.first(buffered_bytes_), data};
+    if (Status status = writer_.WriteV(buffers); !status.ok()) {
+      return status;
+    }
+    buffered_bytes_ = 0;
+    return OkStatus();
+  }
+
+  const std::array<ConstByteSpan, 1> buffers = {data};
+  return DoWriteV(buffers);
+}
+
+Status BufferedWriter::DoWriteV(std::span<const ConstByteSpan> data) {
+  size_t total_bytes = 0;
+  for (ConstByteSpan buffer : data) {
+    total_bytes += buffer.size_bytes();
+  }
+
+  // Writes that don't fit are passed through after flushing the buffer.
+  // Writes that would fit after a flush are still buffered.
+  if (total_bytes > buffer_.size_bytes() - buffered_bytes_) {
+    if (total_bytes >= buffer_.size_bytes()) {
+      if (buffered_bytes_ != 0) {
+        if (Status status = Flush(); !status.ok()) {
+          return status;
+        }
+      }
+      return writer_.WriteV(data);
+    }
+    if (Status status = Flush(); !status.ok()) {
+      return status;
+    }
+  }
+
+  for (ConstByteSpan buffer : data) {
+    std::memcpy(buffer_.data() + buffered_bytes_,
+                buffer.data(),
+                buffer.size_bytes());
+    buffered_bytes_ += buffer.size_bytes();
+  }
+  return OkStatus();
+}
+
+size_t BufferedReader::ConservativeReadLimit() const {
+  const size_t limit = reader_.ConservativeReadLimit();
+  if (limit > std::numeric_limits<size_t>::max() - buffered_bytes()) {
+    return std::numeric_limits<size_t>::max();
+  }
+  return limit + buffered_bytes();
+}
+
+StatusWithSize BufferedReader::DoRead(ByteSpan dest) {
+  if (buffered_bytes() != 0) {
+    const size_t bytes_to_copy = std::min(dest.size_bytes(), buffered_bytes());
+    std::memcpy(dest.data(), buffer_.data() + position_, bytes_to_copy);
+    position_ += bytes_to_copy;
+    return StatusWithSize(bytes_to_copy);
+  }
+
+  if (dest.size_bytes() >= buffer_.size_bytes()) {
+    Result<ByteSpan> result = reader_.Read(dest);
+    return result.ok() ? StatusWithSize(result.value().size_bytes())
+                       : StatusWithSize(result.status(), 0);
+  }
+
+  // Read into the destination and then the buffer, so the one read both
+  // answers this call and refills the buffer.
+  const std::array<ByteSpan, 2> buffers = {dest, buffer_};
+  const StatusWithSize result = reader_.ReadV(buffers);
+  if (!result.ok()) {
+    return result;
+  }
+  const size_t bytes_to_dest = std::min(result.size(), dest.size_bytes());
+  position_ = 0;
+  buffered_bytes_ = result.size() - bytes_to_dest;
+  return StatusWithSize(bytes_to_dest);
+}
+
+}  // namespace pw::stream
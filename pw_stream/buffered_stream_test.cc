@@ -0,0 +1,219 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_stream/buffered_stream.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::stream {
+namespace {
+
+// A MemoryWriter that counts the write operations it receives.
+class CountingWriter : public Writer {
+ public:
+  CountingWriter(ByteSpan dest) : writer_(dest) {}
+
+  ConstByteSpan WrittenData() const { return writer_.WrittenData(); }
+
+  size_t writes = 0;
+
+ private:
+  Status DoWrite(ConstByteSpan data) override {
+    writes += 1;
+    return writer_.Write(data);
+  }
+
+  Status DoWriteV(std::span<const ConstByteSpan> data) override {
+    writes += 1;
+    return writer_.WriteV(data);
+  }
+
+  MemoryWriter writer_;
+};
+
+// A MemoryReader that counts the read operations it receives.
+class CountingReader : public Reader {
+ public:
+  CountingReader(ConstByteSpan source) : reader_(source) {}
+
+  size_t ConservativeReadLimit() const override {
+    return reader_.ConservativeReadLimit();
+  }
+
+  size_t reads = 0;
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override {
+    reads += 1;
+    Result<ByteSpan> result = reader_.Read(dest);
+    return result.ok() ? StatusWithSize(result.value().size())
+                       : StatusWithSize(result.status(), 0);
+  }
+
+  StatusWithSize DoReadV(std::span<const ByteSpan> dest) override {
+    reads += 1;
+    return reader_.ReadV(dest);
+  }
+
+  MemoryReader reader_;
+};
+
+TEST(BufferedWriter, SmallWrites_AreBuffered) {
+  std::array<std::byte, 32> dest = {};
+  std::array<std::byte, 8> buffer;
+  CountingWriter counting_writer(dest);
+  BufferedWriter writer(counting_writer, buffer);
+
+  for (uint8_t i = 0; i < 7; ++i) {
+    ASSERT_EQ(writer.Write(std::byte{i}), OkStatus());
+  }
+  EXPECT_EQ(counting_writer.writes, 0u);
+  EXPECT_EQ(writer.buffered_bytes(), 7u);
+
+  ASSERT_EQ(writer.Flush(), OkStatus());
+  EXPECT_EQ(counting_writer.writes, 1u);
+  EXPECT_EQ(writer.buffered_bytes(), 0u);
+  ASSERT_EQ(counting_writer.WrittenData().size(), 7u);
+  for (uint8_t i = 0; i < 7; ++i) {
+    EXPECT_EQ(counting_writer.WrittenData()[i], std::byte{i});
+  }
+}
+
+TEST(BufferedWriter, FullBuffer_IsFlushed) {
+  std::array<std::byte, 32> dest = {};
+  std::array<std::byte, 4> buffer;
+  CountingWriter counting_writer(dest);
+  BufferedWriter writer(counting_writer, buffer);
+
+  constexpr std::array<std::byte, 3> kData = {
+      std::byte{1}, std::byte{2}, std::byte{3}};
+  ASSERT_EQ(writer.Write(kData), OkStatus());
+  ASSERT_EQ(writer.Write(kData), OkStatus());
+  EXPECT_EQ(counting_writer.writes, 1u);
+  EXPECT_EQ(counting_writer.WrittenData().size(), 3u);
+  EXPECT_EQ(writer.buffered_bytes(), 3u);
+}
+
+TEST(BufferedWriter, LargeWrite_IsSentWithBufferedData) {
+  std::array<std::byte, 32> dest = {};
+  std::array<std::byte, 4> buffer;
+  CountingWriter counting_writer(dest);
+  BufferedWriter writer(counting_writer, buffer);
+
+  constexpr std::array<std::byte, 6> kData = {std::byte{2},
+                                              std::byte{3},
+                                              std::byte{4},
+                                              std::byte{5},
+                                              std::byte{6},
+                                              std::byte{7}};
+  ASSERT_EQ(writer.Write(std::byte{1}), OkStatus());
+  ASSERT_EQ(writer.Write(kData), OkStatus());
+  EXPECT_EQ(counting_writer.writes, 1u);
+  EXPECT_EQ(writer.buffered_bytes(), 0u);
+  ASSERT_EQ(counting_writer.WrittenData().size(), 7u);
+  for (uint8_t i = 0; i < 7; ++i) {
+    EXPECT_EQ(counting_writer.WrittenData()[i], std::byte(i + 1));
+  }
+}
+
+TEST(BufferedWriter, FailedFlush_KeepsData) {
+  std::array<std::byte, 2> dest = {};
+  std::array<std::byte, 4> buffer;
+  CountingWriter counting_writer(dest);
+  BufferedWriter writer(counting_writer, buffer);
+
+  constexpr std::array<std::byte, 3> kData = {};
+  ASSERT_EQ(writer.Write(kData), OkStatus());
+  EXPECT_EQ(writer.Flush(), Status::ResourceExhausted());
+  EXPECT_EQ(writer.buffered_bytes(), 3u);
+}
+
+TEST(BufferedWriter, Destructor_Flushes) {
+  std::array<std::byte, 8> dest = {};
+  std::array<std::byte, 4> buffer;
+  MemoryWriter memory_writer(dest);
+  {
+    BufferedWriter writer(memory_writer, buffer);
+    ASSERT_EQ(writer.Write(std::byte{1}), OkStatus());
+    EXPECT_EQ(memory_writer.bytes_written(), 0u);
+  }
+  EXPECT_EQ(memory_writer.bytes_written(), 1u);
+}
+
+TEST(BufferedWriter, ConservativeWriteLimit) {
+  std::array<std::byte, 8> dest = {};
+  std::array<std::byte, 4> buffer;
+  MemoryWriter memory_writer(dest);
+  BufferedWriter writer(memory_writer, buffer);
+
+  ASSERT_EQ(writer.Write(std::byte{1}), OkStatus());
+  EXPECT_EQ(writer.ConservativeWriteLimit(), 7u);
+}
+
+TEST(BufferedReader, SmallReads_AreServedFromBuffer) {
+  constexpr std::array<std::byte, 6> kSource = {std::byte{1},
+                                                std::byte{2},
+                                                std::byte{3},
+                                                std::byte{4},
+                                                std::byte{5},
+                                                std::byte{6}};
+  std::array<std::byte, 4> buffer;
+  CountingReader counting_reader(kSource);
+  BufferedReader reader(counting_reader, buffer);
+  EXPECT_EQ(reader.ConservativeReadLimit(), 6u);
+
+  for (uint8_t i = 1; i <= 5; ++i) {
+    std::byte value;
+    Result<ByteSpan> result = reader.Read(&value, 1);
+    ASSERT_EQ(result.status(), OkStatus());
+    ASSERT_EQ(result.value().size(), 1u);
+    EXPECT_EQ(value, std::byte{i});
+  }
+  EXPECT_EQ(counting_reader.reads, 1u);
+  EXPECT_EQ(reader.ConservativeReadLimit(), 1u);
+}
+
+TEST(BufferedReader, LargeRead_IsPassedThrough) {
+  constexpr std::array<std::byte, 8> kSource = {};
+  std::array<std::byte, 4> buffer;
+  CountingReader counting_reader(kSource);
+  BufferedReader reader(counting_reader, buffer);
+
+  std::array<std::byte, 6> dest;
+  Result<ByteSpan> result = reader.Read(dest);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.value().size(), 6u);
+  EXPECT_EQ(reader.buffered_bytes(), 0u);
+  EXPECT_EQ(counting_reader.reads, 1u);
+}
+
+TEST(BufferedReader, EndOfStream) {
+  constexpr std::array<std::byte, 1> kSource = {std::byte{7}};
+  std::array<std::byte, 4> buffer;
+  MemoryReader memory_reader(kSource);
+  BufferedReader reader(memory_reader, buffer);
+
+  std::array<std::byte, 2> dest;
+  Result<ByteSpan> result = reader.Read(dest);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.value().size(), 1u);
+  EXPECT_EQ(reader.Read(dest).status(), Status::OutOfRange());
+}
+
+}  // namespace
+}  // namespace pw::stream
@@ -14,6 +14,7 @@
 
 #include "pw_stream/memory_stream.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 
@@ -30,12 +31,45 @@ Status MemoryWriter::DoWrite(ConstByteSpan data) {
   }
 
   size_t bytes_to_write = data.size_bytes();
-  std::memmove(dest_.data() + bytes_written_, data.data(), bytes_to_write);
-  bytes_written_ += bytes_to_write;
+  std::memmove(dest_.data() + position_, data.data(), bytes_to_write);
+  position_ += bytes_to_write;
+  bytes_written_ = std::max(bytes_written_, position_);
 
   return OkStatus();
 }
 
+Status MemoryWriter::DoWriteV(std::span<const ConstByteSpan> data) {
+  size_t total_bytes = 0;
+  for (ConstByteSpan buffer : data) {
+    total_bytes += buffer.size_bytes();
+  }
+
+  if (ConservativeWriteLimit() == 0) {
+    return Status::OutOfRange();
+  }
+  if (ConservativeWriteLimit() < total_bytes) {
+    return Status::ResourceExhausted();
+  }
+
+  for (ConstByteSpan buffer : data) {
+    std::memmove(dest_.data() + position_, buffer.data(), buffer.size_bytes());
+    position_ += buffer.size_bytes();
+  }
+  bytes_written_ = std::max(bytes_written_, position_);
+
+  return OkStatus();
+}
+
+Status MemoryWriter::DoSeek(ptrdiff_t offset, Whence origin) {
+  Result<size_t> position =
+      internal::SeekPosition(offset, origin, position_, bytes_written_);
+  if (!position.ok()) {
+    return position.status();
+  }
+  position_ = position.value();
+  return OkStatus();
+}
+
 StatusWithSize MemoryReader::DoRead(ByteSpan dest) {
   if (source_.size_bytes() == bytes_read_) {
     return StatusWithSize::OutOfRange();
@@ -50,4 +84,35 @@ StatusWithSize MemoryReader::DoRead(ByteSpan dest) {
   return StatusWithSize(bytes_to_read);
 }
 
+StatusWithSize MemoryReader::DoReadV(std::span<const ByteSpan> dest) {
+  if (source_.size_bytes() == bytes_read_) {
+    return StatusWithSize::OutOfRange();
+  }
+
+  size_t total_bytes_read = 0;
+  for (ByteSpan buffer : dest) {
+    size_t bytes_to_read =
+        std::min(buffer.size_bytes(), source_.size_bytes() - bytes_read_);
+    if (bytes_to_read == 0) {
+      continue;
+    }
+
+    std::memcpy(buffer.data(), source_.data() + bytes_read_, bytes_to_read);
+    bytes_read_ += bytes_to_read;
+    total_bytes_read += bytes_to_read;
+  }
+
+  return StatusWithSize(total_bytes_read);
+}
+
+Status MemoryReader::DoSeek(ptrdiff_t offset, Whence origin) {
+  Result<size_t> position = internal::SeekPosition(
+      offset, origin, bytes_read_, source_.size_bytes());
+  if (!position.ok()) {
+    return position.status();
+  }
+  bytes_read_ = position.value();
+  return OkStatus();
+}
+
 }  // namespace pw::stream
@@ -131,6 +131,60 @@ TEST(MemoryWriter, EmptyData) {
   EXPECT_EQ(memory_writer.bytes_written(), 0u);
 }
 
+TEST(MemoryWriter, WriteV) {
+  constexpr std::array<std::byte, 2> kHeader = {std::byte{1}, std::byte{2}};
+  constexpr std::array<std::byte, 3> kPayload = {
+      std::byte{3}, std::byte{4}, std::byte{5}};
+  constexpr std::array<std::byte, 1> kFooter = {std::byte{6}};
+  const std::array<ConstByteSpan, 4> buffers = {
+      kHeader, ConstByteSpan(), kPayload, kFooter};
+
+  MemoryWriter memory_writer(memory_buffer);
+  EXPECT_EQ(memory_writer.WriteV(buffers), OkStatus());
+  ASSERT_EQ(memory_writer.bytes_written(), 6u);
+  for (size_t i = 0; i < 6u; ++i) {
+    EXPECT_EQ(memory_writer.WrittenData()[i], std::byte(i + 1));
+  }
+}
+
+TEST(MemoryWriter, WriteV_DoesNotFit_WritesNothing) {
+  std::array<std::byte, 4> dest = {};
+  constexpr std::array<std::byte, 3> kData = {};
+  const std::array<ConstByteSpan, 2> buffers = {kData, kData};
+
+  MemoryWriter memory_writer(dest);
+  EXPECT_EQ(memory_writer.WriteV(buffers), Status::ResourceExhausted());
+  EXPECT_EQ(memory_writer.bytes_written(), 0u);
+
+  EXPECT_EQ(memory_writer.WriteV(std::span(buffers).first(1)), OkStatus());
+  EXPECT_EQ(memory_writer.Write(kData.data(), 1), OkStatus());
+  EXPECT_EQ(memory_writer.WriteV(buffers), Status::OutOfRange());
+}
+
+TEST(MemoryWriter, Seek_Overwrites) {
+  std::array<std::byte, 8> dest = {};
+  MemoryWriter memory_writer(dest);
+
+  constexpr std::array<std::byte, 3> kData = {
+      std::byte{1}, std::byte{2}, std::byte{3}};
+  ASSERT_EQ(memory_writer.Write(kData), OkStatus());
+
+  EXPECT_EQ(memory_writer.Seek(1), OkStatus());
+  EXPECT_EQ(memory_writer.Tell(), 1u);
+  EXPECT_EQ(memory_writer.ConservativeWriteLimit(), 7u);
+  ASSERT_EQ(memory_writer.Write(std::byte{9}), OkStatus());
+  EXPECT_EQ(memory_writer.bytes_written(), 3u);
+  EXPECT_EQ(dest[1], std::byte{9});
+  EXPECT_EQ(dest[2], std::byte{3});
+
+  EXPECT_EQ(memory_writer.Seek(-1, Whence::kEnd), OkStatus());
+  ASSERT_EQ(memory_writer.Write(kData), OkStatus());
+  EXPECT_EQ(memory_writer.bytes_written(), 5u);
+
+  EXPECT_EQ(memory_writer.Seek(1, Whence::kEnd), Status::OutOfRange());
+  EXPECT_EQ(memory_writer.Tell(), 5u);
+}
+
 TEST(MemoryWriter, ValidateContents_SingleByteWrites) {
   MemoryWriter memory_writer(memory_buffer);
   EXPECT_TRUE(memory_writer.Write(std::byte{0x01}).ok());
@@ -294,5 +348,51 @@ TEST(MemoryReader, MultipleReads) {
   }
 }
 
+TEST(MemoryReader, Seek) {
+  constexpr std::array<std::byte, 4> kSource = {
+      std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}};
+  MemoryReader memory_reader(kSource);
+  std::byte value;
+
+  EXPECT_EQ(memory_reader.Seek(2), OkStatus());
+  EXPECT_EQ(memory_reader.Tell(), 2u);
+  ASSERT_EQ(memory_reader.Read(&value, 1).status(), OkStatus());
+  EXPECT_EQ(value, std::byte{3});
+
+  EXPECT_EQ(memory_reader.Seek(-3, Whence::kCurrent), OkStatus());
+  ASSERT_EQ(memory_reader.Read(&value, 1).status(), OkStatus());
+  EXPECT_EQ(value, std::byte{1});
+
+  EXPECT_EQ(memory_reader.Seek(-1, Whence::kEnd), OkStatus());
+  EXPECT_EQ(memory_reader.ConservativeReadLimit(), 1u);
+
+  EXPECT_EQ(memory_reader.Seek(0, Whence::kEnd), OkStatus());
+  EXPECT_EQ(memory_reader.Read(&value, 1).status(), Status::OutOfRange());
+
+  EXPECT_EQ(memory_reader.Seek(5), Status::OutOfRange());
+  EXPECT_EQ(memory_reader.Seek(-5, Whence::kEnd), Status::OutOfRange());
+  EXPECT_EQ(memory_reader.Tell(), 4u);
+}
+
+TEST(MemoryReader, ReadV) {
+  constexpr std::array<std::byte, 5> kSource = {
+      std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}, std::byte{5}};
+  std::array<std::byte, 2> header = {};
+  std::array<std::byte, 4> payload = {};
+  const std::array<ByteSpan, 3> buffers = {header, ByteSpan(), payload};
+
+  MemoryReader memory_reader(kSource);
+  StatusWithSize result = memory_reader.ReadV(buffers);
+  EXPECT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.size(), 5u);
+  EXPECT_EQ(header[0], std::byte{1});
+  EXPECT_EQ(header[1], std::byte{2});
+  EXPECT_EQ(payload[0], std::byte{3});
+  EXPECT_EQ(payload[2], std::byte{5});
+  EXPECT_EQ(payload[3], std::byte{0});
+
+  EXPECT_EQ(memory_reader.ReadV(buffers).status(), Status::OutOfRange());
+}
+
 }  // namespace
 }  // namespace pw::stream
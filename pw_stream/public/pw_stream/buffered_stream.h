@@ -0,0 +1,88 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
+
+namespace pw::stream {
+
+// Collects small writes in a caller-provided buffer and passes them to another
+// Writer in larger pieces, so that byte-at-a-time producers don't make an I/O
+// call per byte.
+//
+// Buffered data is written when the buffer is full, when Flush() is called,
+// and when the BufferedWriter is destroyed. Writes at least as large as the
+// buffer are not copied into it; a Write() is passed to the writer together
+// with the buffered data in one WriteV() call.
+class BufferedWriter : public Writer {
+ public:
+  BufferedWriter(Writer& writer, ByteSpan buffer)
+      : writer_(writer), buffer_(buffer), buffered_bytes_(0) {}
+
+  BufferedWriter(const BufferedWriter&) = delete;
+  BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+  // Flushes the buffer. Errors are ignored; call Flush() first to check them.
+  ~BufferedWriter() override { Flush().IgnoreError(); }
+
+  // Writes the buffered data to the writer. Returns the writer's status. If the
+  // write fails, the data remains buffered.
+  Status Flush();
+
+  size_t buffered_bytes() const { return buffered_bytes_; }
+
+  size_t ConservativeWriteLimit() const override;
+
+ private:
+  Status DoWrite(ConstByteSpan data) override;
+
+  Status DoWriteV(std::span<const ConstByteSpan> data) override;
+
+  Writer& writer_;
+  ByteSpan buffer_;
+  size_t buffered_bytes_;
+};
+
+// Reads from another Reader in pieces as large as a caller-provided buffer, and
+// serves small reads from the buffer. A read is passed directly to the reader
+// if the buffer is empty and the read is at least as large as the buffer.
+class BufferedReader : public Reader {
+ public:
+  constexpr BufferedReader(Reader& reader, ByteSpan buffer)
+      : reader_(reader), buffer_(buffer), position_(0), buffered_bytes_(0) {}
+
+  BufferedReader(const BufferedReader&) = delete;
+  BufferedReader& operator=(const BufferedReader&) = delete;
+
+  // The number of bytes read from the reader but not yet from this.
+  size_t buffered_bytes() const { return buffered_bytes_ - position_; }
+
+  size_t ConservativeReadLimit() const override;
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override;
+
+  Reader& reader_;
+  ByteSpan buffer_;
+  size_t position_;
+  size_t buffered_bytes_;
+};
+
+}  // namespace pw::stream
@@ -23,7 +23,9 @@
 
 namespace pw::stream {
 
-class MemoryWriter : public Writer {
+// Writes to a caller-provided buffer. Seeking back and writing overwrites the
+// data there; bytes_written() is the total size of the data written.
+class MemoryWriter : public SeekableWriter {
  public:
   constexpr MemoryWriter(ByteSpan dest) : dest_(dest) {}
 
@@ -33,14 +35,14 @@ class MemoryWriter : public Writer {
   // Precondition: The number of pre-written bytes must not be greater than the
   // size of the provided buffer.
   constexpr MemoryWriter(ByteSpan dest, size_t bytes_written)
-      : dest_(dest), bytes_written_(bytes_written) {
+      : dest_(dest), bytes_written_(bytes_written), position_(bytes_written) {
     PW_ASSERT(bytes_written_ <= dest.size_bytes());
   }
 
   size_t bytes_written() const { return bytes_written_; }
 
   size_t ConservativeWriteLimit() const override {
-    return dest_.size_bytes() - bytes_written_;
+    return dest_.size_bytes() - position_;
   }
 
   ConstByteSpan WrittenData() const { return dest_.first(bytes_written_); }
@@ -55,8 +57,16 @@ class MemoryWriter : public Writer {
   // perform a partial write and Status::ResourceExhausted() will be returned.
   Status DoWrite(ConstByteSpan data) override;
 
+  // Writes all of the buffers, or none of them if they don't fit.
+  Status DoWriteV(std::span<const ConstByteSpan> data) override;
+
+  Status DoSeek(ptrdiff_t offset, Whence origin) override;
+
+  size_t DoTell() const override { return position_; }
+
   ByteSpan dest_;
   size_t bytes_written_ = 0;
+  size_t position_ = 0;
 };
 
 template <size_t kSizeBytes>
@@ -68,7 +78,7 @@ class MemoryWriterBuffer final : public MemoryWriter {
   std::array<std::byte, kSizeBytes> buffer_;
 };
 
-class MemoryReader final : public Reader {
+class MemoryReader final : public SeekableReader {
  public:
   constexpr MemoryReader(ConstByteSpan source)
       : source_(source), bytes_read_(0) {}
@@ -88,6 +98,12 @@ class MemoryReader final : public Reader {
   // requested, this will perform a partial read and OK will still be returned.
   StatusWithSize DoRead(ByteSpan dest) override;
 
+  StatusWithSize DoReadV(std::span<const ByteSpan> dest) override;
+
+  Status DoSeek(ptrdiff_t offset, Whence origin) override;
+
+  size_t DoTell() const override { return bytes_read_; }
+
   ConstByteSpan source_;
   size_t bytes_read_;
 };
@@ -17,6 +17,7 @@
 #include <netinet/in.h>
 #include <stdio.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <array>
@@ -31,30 +32,137 @@ namespace pw::stream {
 static constexpr int kExitCode = -1;
 static constexpr int kInvalidFd = -1;
 
+// Options for connected sockets.
+struct SocketOptions {
+  // Sets TCP_NODELAY, which sends small writes immediately instead of waiting
+  // to combine them with later writes. This lowers the latency of small
+  // request and response packets, such as RPCs.
+  bool no_delay = true;
+
+  // The kernel's send and receive buffer sizes (SO_SNDBUF and SO_RCVBUF), or 0
+  // to keep the system defaults. Larger buffers let a fast writer get further
+  // ahead of a slow reader.
+  int send_buffer_bytes = 0;
+  int receive_buffer_bytes = 0;
+};
+
 class SocketStream : public ReaderWriter {
  public:
   explicit SocketStream() {}
   ~SocketStream();
 
   // Listen to the port and return after a client is connected
-  Status Serve(uint16_t port);
+  Status Serve(uint16_t port, const SocketOptions& options = {});
 
   // Connect to a local or remote endpoint. Host must be an IPv4 address. If
   // host is nullptr then the locahost address is used instead.
-  Status Connect(const char* host, uint16_t port);
+  Status Connect(const char* host,
+                 uint16_t port,
+                 const SocketOptions& options = {});
 
   // Close the socket stream and release all resources
   void Close();
 
+  bool connected() const { return conn_fd_ != kInvalidFd; }
+
+  // The events that Poll() waits for.
+  enum class Readiness {
+    kReadable,  // TryRead() would not return UNAVAILABLE.
+    kWritable,  // TryWrite() would write at least one byte.
+  };
+
+  // The most streams that one Poll() call can wait on.
+  static constexpr size_t kMaxPollStreams = 64;
+
+  // Waits up to timeout_ms milliseconds, or indefinitely if timeout_ms is
+  // negative, for at least one of the connected streams to become ready. Sets
+  // ready[i] to whether streams[i] is ready, so one thread can service many
+  // connections with TryRead() and TryWrite(). A stream whose peer closed the
+  // connection or that has an error is reported as ready; its next read or
+  // write reports the problem.
+  //
+  // Returns:
+  //
+  // OK - the size is the number of ready streams, at least one.
+  // DEADLINE_EXCEEDED - no stream became ready in time.
+  // INVALID_ARGUMENT - ready is smaller than streams, or there are more than
+  //     kMaxPollStreams streams.
+  // INTERNAL - poll() failed.
+  static StatusWithSize Poll(std::span<SocketStream* const> streams,
+                             Readiness readiness,
+                             std::span<bool> ready,
+                             int timeout_ms);
+
  private:
+  friend class SocketServer;
+
+  // The most buffers passed to one sendmsg() or recvmsg() call.
+  static constexpr size_t kMaxIovecs = 16;
+
   Status DoWrite(std::span<const std::byte> data) override;
 
+  // Sends the buffers with sendmsg(), in one call per kMaxIovecs buffers.
+  Status DoWriteV(std::span<const ConstByteSpan> data) override;
+
   StatusWithSize DoRead(ByteSpan dest) override;
 
+  // Receives into up to kMaxIovecs buffers with one recvmsg() call.
+  StatusWithSize DoReadV(std::span<const ByteSpan> dest) override;
+
+  // Sends or receives with MSG_DONTWAIT, so these never block even though the
+  // socket itself stays blocking for Write() and Read().
+  StatusWithSize DoTryWrite(ConstByteSpan data) override;
+  StatusWithSize DoTryRead(ByteSpan dest) override;
+
   uint16_t listen_port_ = 0;
   int socket_fd_ = kInvalidFd;
   int conn_fd_ = kInvalidFd;
   struct sockaddr_in sockaddr_client_;
 };
 
+// Accepts any number of connections on a port, for example to serve RPCs to
+// many clients. Service the connections from one thread with
+// SocketStream::Poll() and the Try methods, or give each its own thread.
+class SocketServer {
+ public:
+  SocketServer() = default;
+  ~SocketServer() { Close(); }
+
+  SocketServer(const SocketServer&) = delete;
+  SocketServer& operator=(const SocketServer&) = delete;
+
+  // Listens for connections on a port, or on a free port if port is 0. The
+  // options are applied to each accepted connection.
+  //
+  // Returns:
+  //
+  // OK - the server is listening.
+  // FAILED_PRECONDITION - the server is already listening.
+  // INTERNAL - the socket could not be created or bound.
+  Status Listen(uint16_t port = 0, const SocketOptions& options = {});
+
+  // Waits up to timeout_ms milliseconds, or indefinitely if timeout_ms is
+  // negative, for a client to connect, and connects the stream to it.
+  //
+  // Returns:
+  //
+  // OK - the stream is connected to a new client.
+  // DEADLINE_EXCEEDED - no client connected in time.
+  // FAILED_PRECONDITION - the server is not listening, or the stream is
+  //     already connected.
+  // INTERNAL - the connection could not be accepted.
+  Status Accept(SocketStream& connection, int timeout_ms = -1);
+
+  // The port the server is listening on.
+  uint16_t port() const { return port_; }
+
+  // Stops listening. Accepted connections stay open.
+  void Close();
+
+ private:
+  int listen_fd_ = kInvalidFd;
+  uint16_t port_ = 0;
+  SocketOptions options_;
+};
+
 }  // namespace pw::stream
@@ -15,6 +15,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <span>
 
 #include "pw_assert/assert.h"
@@ -69,6 +70,32 @@ class Writer {
   }
   Status Write(const std::byte b) { return Write(&b, 1); }
 
+  // Writes several buffers, in order, as if they were one contiguous buffer.
+  // Writers that can gather buffers, such as SocketStream and MemoryWriter,
+  // write them in one operation, so a message split into a header, payload,
+  // and footer need not be copied together or sent with several syscalls.
+  //
+  // Returns the same statuses as Write(). Writers that do not override
+  // DoWriteV() write each buffer with DoWrite() in turn, stopping at the first
+  // error; buffers before the failing one may then have been written.
+  Status WriteV(std::span<const ConstByteSpan> data) { return DoWriteV(data); }
+
+  // Writes as much of data as possible without blocking, for writers serviced
+  // by polling or an event loop. Writers that cannot tell whether they would
+  // block, which is the default, write all of the data as Write() does.
+  //
+  // Returns:
+  //
+  // OK - all of the data was written; the size is data.size_bytes().
+  // UNAVAILABLE - the writer could not accept more data without blocking. The
+  //     size is the number of bytes written, which may be zero. Try again with
+  //     the rest of the data once the writer is ready.
+  // Other errors, with size zero, as Write().
+  StatusWithSize TryWrite(ConstByteSpan data) {
+    PW_DASSERT(data.empty() || data.data() != nullptr);
+    return DoTryWrite(data);
+  }
+
   // Probable (not guaranteed) minimum number of bytes at this time that can be
   // written. This number is advisory and not guaranteed to write without a
   // RESOURCE_EXHAUSTED or OUT_OF_RANGE. As Writer processes/handles enqueued of
@@ -84,6 +111,25 @@ class Writer {
 
  private:
   virtual Status DoWrite(ConstByteSpan data) = 0;
+
+  virtual Status DoWriteV(std::span<const ConstByteSpan> data) {
+    for (ConstByteSpan buffer : data) {
+      if (buffer.empty()) {
+        continue;
+      }
+      if (Status status = Write(buffer); !status.ok()) {
+        return status;
+      }
+    }
+    return OkStatus();
+  }
+
+  virtual StatusWithSize DoTryWrite(ConstByteSpan data) {
+    if (Status status = DoWrite(data); !status.ok()) {
+      return StatusWithSize(status, 0);
+    }
+    return StatusWithSize(data.size_bytes());
+  }
 };
 
 // General-purpose reader interface
@@ -126,6 +172,32 @@ class Reader {
     return Read(std::span(static_cast<std::byte*>(dest), size_bytes));
   }
 
+  // Reads into several buffers, in order, as if they were one contiguous
+  // buffer. Readers that can scatter data, such as SocketStream and
+  // MemoryReader, read in one operation.
+  //
+  // Returns OK with the total number of bytes read, which fill the buffers in
+  // order, or the same errors as Read() if no bytes were read. Readers that do
+  // not override DoReadV() read each buffer with DoRead() in turn, stopping
+  // after a read that does not fill its buffer.
+  StatusWithSize ReadV(std::span<const ByteSpan> dest) {
+    return DoReadV(dest);
+  }
+
+  // Reads like Read(), but returns UNAVAILABLE instead of blocking if no data
+  // is available. Readers that cannot tell whether they would block, which is
+  // the default, read as Read() does.
+  Result<ByteSpan> TryRead(ByteSpan dest) {
+    PW_DASSERT(dest.empty() || dest.data() != nullptr);
+    StatusWithSize result = DoTryRead(dest);
+
+    if (result.ok()) {
+      return dest.first(result.size());
+    } else {
+      return result.status();
+    }
+  }
+
   // Probable (not guaranteed) minimum number of bytes at this time that can be
   // read. This number is advisory and not guaranteed to read full number of
   // requested bytes or without a RESOURCE_EXHAUSTED or OUT_OF_RANGE. As Reader
@@ -142,10 +214,122 @@ class Reader {
 
  private:
   virtual StatusWithSize DoRead(ByteSpan dest) = 0;
+
+  virtual StatusWithSize DoReadV(std::span<const ByteSpan> dest) {
+    size_t total = 0;
+    for (ByteSpan buffer : dest) {
+      if (buffer.empty()) {
+        continue;
+      }
+      Result<ByteSpan> result = Read(buffer);
+      if (!result.ok()) {
+        return total == 0 ? StatusWithSize(result.status(), 0)
+                          : StatusWithSize(total);
+      }
+      total += result.value().size();
+      if (result.value().size() < buffer.size()) {
+        break;
+      }
+    }
+    return StatusWithSize(total);
+  }
+
+  virtual StatusWithSize DoTryRead(ByteSpan dest) { return DoRead(dest); }
 };
 
 // A general-purpose ReaderWriter class that combines interfaces of Reader and
 // Writer.
 class ReaderWriter : public Writer, public Reader {};
 
+// The position that a Seek() offset is relative to.
+enum class Whence : uint8_t {
+  kBeginning,  // The start of the stream.
+  kCurrent,    // The current position.
+  kEnd,        // The end of the stream's data.
+};
+
+namespace internal {
+
+// Returns the position offset bytes from origin, or OUT_OF_RANGE if it is
+// before the beginning or after end.
+constexpr Result<size_t> SeekPosition(ptrdiff_t offset,
+                                      Whence origin,
+                                      size_t current,
+                                      size_t end) {
+  size_t base = 0;
+  switch (origin) {
+    case Whence::kBeginning:
+      base = 0;
+      break;
+    case Whence::kCurrent:
+      base = current;
+      break;
+    case Whence::kEnd:
+      base = end;
+      break;
+  }
+
+  if (offset < 0) {
+    const size_t distance = static_cast<size_t>(-(offset + 1)) + 1;
+    if (distance > base) {
+      return Status::OutOfRange();
+    }
+    return base - distance;
+  }
+  if (static_cast<size_t>(offset) > end - base) {
+    return Status::OutOfRange();
+  }
+  return base + static_cast<size_t>(offset);
+}
+
+}  // namespace internal
+
+// A Reader that can move its read position, so that parts of the data can be
+// skipped or read again without reading from the beginning.
+class SeekableReader : public Reader {
+ public:
+  // Moves the read position to offset bytes from origin. The position may be
+  // anywhere from the beginning to the end of the data.
+  //
+  // Derived classes should NOT try to override these public methods. Instead,
+  // provide an implementation by overriding DoSeek() and DoTell().
+  //
+  // Returns:
+  //
+  // OK - the position was moved.
+  // OUT_OF_RANGE - the position would be outside the data. The position is
+  //     unchanged.
+  // FAILED_PRECONDITION - the reader is not in a state to seek.
+  Status Seek(ptrdiff_t offset, Whence origin = Whence::kBeginning) {
+    return DoSeek(offset, origin);
+  }
+
+  // Returns the read position, in bytes from the beginning.
+  size_t Tell() const { return DoTell(); }
+
+ private:
+  virtual Status DoSeek(ptrdiff_t offset, Whence origin) = 0;
+  virtual size_t DoTell() const = 0;
+};
+
+// A Writer that can move its write position, for example to fill in a length
+// or checksum once the data it covers has been written. Writing at a position
+// before the end overwrites the data there.
+class SeekableWriter : public Writer {
+ public:
+  // Moves the write position to offset bytes from origin. The position may be
+  // anywhere from the beginning to the end of the data written so far. Returns
+  // the same statuses as SeekableReader::Seek().
+  Status Seek(ptrdiff_t offset, Whence origin = Whence::kBeginning) {
+    return DoSeek(offset, origin);
+  }
+
+  // Returns the write position, in bytes from the beginning.
+  size_t Tell() const { return DoTell(); }
+
+ private:
+  virtual Status DoSeek(ptrdiff_t offset, Whence origin) = 0;
+  virtual size_t DoTell() const = 0;
+};
+
 }  // namespace pw::stream
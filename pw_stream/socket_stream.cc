@@ -13,15 +13,59 @@
 // the License.
 
 #include "pw_stream/socket_stream.h"
+
+#include <netinet/tcp.h>
+#include <poll.h>
+
+#include <algorithm>
+#include <cerrno>
+
 namespace pw::stream {
 
 static constexpr uint32_t kMaxConcurrentUser = 1;
 static constexpr char kLocalhostAddress[] = "127.0.0.1";
 
+namespace {
+
+// Report a write to a connection the peer closed as an error instead of
+// raising SIGPIPE, which would end the process. macOS has no MSG_NOSIGNAL.
+#if defined(MSG_NOSIGNAL)
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif  // defined(MSG_NOSIGNAL)
+
+Status ApplyOptions(int fd, const SocketOptions& options) {
+  const int no_delay = options.no_delay ? 1 : 0;
+  if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay)) <
+      0) {
+    return Status::Internal();
+  }
+  if (options.send_buffer_bytes > 0 &&
+      setsockopt(fd,
+                 SOL_SOCKET,
+                 SO_SNDBUF,
+                 &options.send_buffer_bytes,
+                 sizeof(options.send_buffer_bytes)) < 0) {
+    return Status::Internal();
+  }
+  if (options.receive_buffer_bytes > 0 &&
+      setsockopt(fd,
+                 SOL_SOCKET,
+                 SO_RCVBUF,
+                 &options.receive_buffer_bytes,
+                 sizeof(options.receive_buffer_bytes)) < 0) {
+    return Status::Internal();
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
 SocketStream::~SocketStream() { Close(); }
 
 // Listen to the port and return after a client is connected
-Status SocketStream::Serve(uint16_t port) {
+Status SocketStream::Serve(uint16_t port, const SocketOptions& options) {
   listen_port_ = port;
   socket_fd_ = socket(AF_INET, SOCK_STREAM, 0);
   if (socket_fd_ == kInvalidFd) {
@@ -51,10 +95,12 @@ Status SocketStream::Serve(uint16_t port) {
   if (conn_fd_ < 0) {
     return Status::Internal();
   }
-  return OkStatus();
+  return ApplyOptions(conn_fd_, options);
 }
 
-Status SocketStream::SocketStream::Connect(const char* host, uint16_t port) {
+Status SocketStream::SocketStream::Connect(const char* host,
+                                           uint16_t port,
+                                           const SocketOptions& options) {
   conn_fd_ = socket(AF_INET, SOCK_STREAM, 0);
 
   sockaddr_in addr;
@@ -69,6 +115,11 @@ Status SocketStream::SocketStream::Connect(const char* host, uint16_t port) {
     return Status::Unknown();
   }
 
+  // Buffer sizes must be set before connecting to affect the TCP window.
+  if (!ApplyOptions(conn_fd_, options).ok()) {
+    return Status::Unknown();
+  }
+
   int result = connect(
       conn_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
   if (result < 0) {
@@ -91,7 +142,8 @@ void SocketStream::Close() {
 }
 
 Status SocketStream::DoWrite(std::span<const std::byte> data) {
-  ssize_t bytes_sent = send(conn_fd_, data.data(), data.size_bytes(), 0);
+  ssize_t bytes_sent =
+      send(conn_fd_, data.data(), data.size_bytes(), kSendFlags);
 
   if (bytes_sent < 0 || static_cast<uint64_t>(bytes_sent) != data.size()) {
     return Status::Internal();
@@ -99,6 +151,31 @@ Status SocketStream::DoWrite(std::span<const std::byte> data) {
   return OkStatus();
 }
 
+Status SocketStream::DoWriteV(std::span<const ConstByteSpan> data) {
+  while (!data.empty()) {
+    std::array<iovec, kMaxIovecs> iovecs;
+    const size_t count = std::min(data.size(), iovecs.size());
+    size_t bytes_to_send = 0;
+    for (size_t i = 0; i < count; ++i) {
+      // iovec is shared by reads and writes, so its base is not const.
+      iovecs[i].iov_base = const_cast<std::byte*>(data[i].data());
+      iovecs[i].iov_len = data[i].size_bytes();
+      bytes_to_send += data[i].size_bytes();
+    }
+
+    msghdr message = {};
+    message.msg_iov = iovecs.data();
+    message.msg_iovlen = count;
+    ssize_t bytes_sent = sendmsg(conn_fd_, &message, kSendFlags);
+
+    if (bytes_sent < 0 || static_cast<size_t>(bytes_sent) != bytes_to_send) {
+      return Status::Internal();
+    }
+    data = data.subspan(count);
+  }
+  return OkStatus();
+}
+
 StatusWithSize SocketStream::DoRead(ByteSpan dest) {
   ssize_t bytes_rcvd = recv(conn_fd_, dest.data(), dest.size_bytes(), 0);
   if (bytes_rcvd < 0) {
@@ -107,4 +184,171 @@ StatusWithSize SocketStream::DoRead(ByteSpan dest) {
   return StatusWithSize(bytes_rcvd);
 }
 
+StatusWithSize SocketStream::DoReadV(std::span<const ByteSpan> dest) {
+  std::array<iovec, kMaxIovecs> iovecs;
+  const size_t count = std::min(dest.size(), iovecs.size());
+  for (size_t i = 0; i < count; ++i) {
+    iovecs[i].iov_base = dest[i].data();
+    iovecs[i].iov_len = dest[i].size_bytes();
+  }
+
+  msghdr message = {};
+  message.msg_iov = iovecs.data();
+  message.msg_iovlen = count;
+  ssize_t bytes_rcvd = recvmsg(conn_fd_, &message, 0);
+  if (bytes_rcvd < 0) {
+    return StatusWithSize::Internal();
+  }
+  return StatusWithSize(bytes_rcvd);
+}
+
+StatusWithSize SocketStream::DoTryWrite(ConstByteSpan data) {
+  ssize_t bytes_sent = send(
+      conn_fd_, data.data(), data.size_bytes(), MSG_DONTWAIT | kSendFlags);
+
+  if (bytes_sent < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return StatusWithSize::Unavailable();
+    }
+    return StatusWithSize::Internal();
+  }
+  if (static_cast<size_t>(bytes_sent) != data.size_bytes()) {
+    return StatusWithSize::Unavailable(bytes_sent);
+  }
+  return StatusWithSize(bytes_sent);
+}
+
+StatusWithSize SocketStream::DoTryRead(ByteSpan dest) {
+  ssize_t bytes_rcvd =
+      recv(conn_fd_, dest.data(), dest.size_bytes(), MSG_DONTWAIT);
+
+  if (bytes_rcvd < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return StatusWithSize::Unavailable();
+    }
+    return StatusWithSize::Internal();
+  }
+  if (bytes_rcvd == 0 && !dest.empty()) {
+    return StatusWithSize::OutOfRange();  // The peer closed the connection.
+  }
+  return StatusWithSize(bytes_rcvd);
+}
+
+StatusWithSize SocketStream::Poll(std::span<SocketStream* const> streams,
+                                  Readiness readiness,
+                                  std::span<bool> ready,
+                                  int timeout_ms) {
+  if (ready.size() < streams.size() || streams.size() > kMaxPollStreams) {
+    return StatusWithSize::InvalidArgument();
+  }
+
+  std::array<pollfd, kMaxPollStreams> fds;
+  for (size_t i = 0; i < streams.size(); ++i) {
+    fds[i].fd = streams[i]->conn_fd_;
+    fds[i].events = readiness == Readiness::kReadable ? POLLIN : POLLOUT;
+    fds[i].revents = 0;
+  }
+
+  int ready_count;
+  do {
+    ready_count = poll(fds.data(), streams.size(), timeout_ms);
+  } while (ready_count < 0 && errno == EINTR);
+
+  if (ready_count < 0) {
+    return StatusWithSize::Internal();
+  }
+  if (ready_count == 0) {
+    return StatusWithSize::DeadlineExceeded();
+  }
+
+  for (size_t i = 0; i < streams.size(); ++i) {
+    ready[i] = fds[i].revents != 0;
+  }
+  return StatusWithSize(ready_count);
+}
+
+Status SocketServer::Listen(uint16_t port, const SocketOptions& options) {
+  if (listen_fd_ != kInvalidFd) {
+    return Status::FailedPrecondition();
+  }
+
+  listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ == kInvalidFd) {
+    return Status::Internal();
+  }
+
+  // Allow restarting a server without waiting for old connections to time out.
+  const int reuse_address = 1;
+  setsockopt(listen_fd_,
+             SOL_SOCKET,
+             SO_REUSEADDR,
+             &reuse_address,
+             sizeof(reuse_address));
+
+  // Accepted sockets inherit the listening socket's buffer sizes, which must be
+  // set before the connection is established to affect the TCP window.
+  if (!ApplyOptions(listen_fd_, options).ok()) {
+    Close();
+    return Status::Internal();
+  }
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = INADDR_ANY;
+  if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+      listen(listen_fd_, SOMAXCONN) < 0) {
+    Close();
+    return Status::Internal();
+  }
+
+  socklen_t len = sizeof(addr);
+  if (getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+    Close();
+    return Status::Internal();
+  }
+  port_ = ntohs(addr.sin_port);
+  options_ = options;
+  return OkStatus();
+}
+
+Status SocketServer::Accept(SocketStream& connection, int timeout_ms) {
+  if (listen_fd_ == kInvalidFd || connection.connected()) {
+    return Status::FailedPrecondition();
+  }
+
+  pollfd fd = {};
+  fd.fd = listen_fd_;
+  fd.events = POLLIN;
+  int ready_count;
+  do {
+    ready_count = poll(&fd, 1, timeout_ms);
+  } while (ready_count < 0 && errno == EINTR);
+
+  if (ready_count < 0) {
+    return Status::Internal();
+  }
+  if (ready_count == 0) {
+    return Status::DeadlineExceeded();
+  }
+
+  const int conn_fd = accept(listen_fd_, nullptr, nullptr);
+  if (conn_fd < 0) {
+    return Status::Internal();
+  }
+  if (!ApplyOptions(conn_fd, options_).ok()) {
+    close(conn_fd);
+    return Status::Internal();
+  }
+  connection.conn_fd_ = conn_fd;
+  return OkStatus();
+}
+
+void SocketServer::Close() {
+  if (listen_fd_ != kInvalidFd) {
+    close(listen_fd_);
+    listen_fd_ = kInvalidFd;
+  }
+}
+
 };  // namespace pw::stream
@@ -14,6 +14,8 @@
 
 #include "pw_stream/stream.h"
 
+#include <algorithm>
+#include <array>
 #include <limits>
 
 #include "gtest/gtest.h"
@@ -40,5 +42,101 @@ TEST(Stream, DefaultConservativeReadWriteLimit) {
   EXPECT_EQ(stream.ConservativeReadLimit(), std::numeric_limits<size_t>::max());
 }
 
+// Records the size of each DoWrite() and DoRead(), to test the default
+// DoWriteV() and DoReadV().
+class RecordingStream : public ReaderWriter {
+ public:
+  std::array<size_t, 4> writes = {};
+  size_t write_count = 0;
+  size_t bytes_to_read = 0;
+  size_t read_count = 0;
+
+ private:
+  Status DoWrite(ConstByteSpan data) override {
+    if (write_count == writes.size()) {
+      return Status::ResourceExhausted();
+    }
+    writes[write_count++] = data.size();
+    return OkStatus();
+  }
+
+  StatusWithSize DoRead(ByteSpan dest) override {
+    read_count += 1;
+    if (bytes_to_read == 0) {
+      return StatusWithSize::OutOfRange();
+    }
+    const size_t bytes = std::min(dest.size(), bytes_to_read);
+    bytes_to_read -= bytes;
+    return StatusWithSize(bytes);
+  }
+};
+
+TEST(Stream, DefaultWriteV_WritesEachBuffer) {
+  RecordingStream stream;
+  std::array<std::byte, 3> data = {};
+  const std::array<ConstByteSpan, 3> buffers = {
+      std::span(data).first(1), ConstByteSpan(), data};
+
+  EXPECT_EQ(stream.WriteV(buffers), OkStatus());
+  EXPECT_EQ(stream.write_count, 2u);
+  EXPECT_EQ(stream.writes[0], 1u);
+  EXPECT_EQ(stream.writes[1], 3u);
+}
+
+TEST(Stream, DefaultWriteV_StopsAtError) {
+  RecordingStream stream;
+  std::array<std::byte, 1> data = {};
+  const std::array<ConstByteSpan, 6> buffers = {
+      data, data, data, data, data, data};
+
+  EXPECT_EQ(stream.WriteV(buffers), Status::ResourceExhausted());
+  EXPECT_EQ(stream.write_count, 4u);
+}
+
+TEST(Stream, DefaultReadV_StopsAfterShortRead) {
+  RecordingStream stream;
+  stream.bytes_to_read = 5;
+  std::array<std::byte, 4> dest = {};
+  const std::array<ByteSpan, 3> buffers = {dest, dest, dest};
+
+  StatusWithSize result = stream.ReadV(buffers);
+  EXPECT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.size(), 5u);
+  EXPECT_EQ(stream.read_count, 2u);
+
+  EXPECT_EQ(stream.ReadV(buffers).status(), Status::OutOfRange());
+}
+
+TEST(Stream, DefaultTryWrite_WritesAllData) {
+  RecordingStream stream;
+  std::array<std::byte, 3> data = {};
+
+  StatusWithSize result = stream.TryWrite(data);
+  EXPECT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.size(), 3u);
+  EXPECT_EQ(stream.write_count, 1u);
+}
+
+TEST(Stream, DefaultTryWrite_Error) {
+  RecordingStream stream;
+  stream.write_count = stream.writes.size();
+  std::array<std::byte, 3> data = {};
+
+  StatusWithSize result = stream.TryWrite(data);
+  EXPECT_EQ(result.status(), Status::ResourceExhausted());
+  EXPECT_EQ(result.size(), 0u);
+}
+
+TEST(Stream, DefaultTryRead_Reads) {
+  RecordingStream stream;
+  stream.bytes_to_read = 2;
+  std::array<std::byte, 4> dest = {};
+
+  Result<ByteSpan> result = stream.TryRead(dest);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.value().size(), 2u);
+  EXPECT_EQ(stream.TryRead(dest).status(), Status::OutOfRange());
+}
+
 }  // namespace
 }  // namespace pw::stream
@@ -0,0 +1,101 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Converts integers and floats to strings, as StringBuilder and log arguments
+// do. FloatToString is compared to the rounding FloatAsIntToString it can
+// replace. Build with PW_STRING_CONFIG_COMPACT_TABLES set to compare with
+// writing integers one digit at a time and computing FloatToString's powers of
+// 5 as they are needed.
+
+#include <array>
+#include <cstdint>
+
+#include "pw_benchmark/benchmark.h"
+#include "pw_string/type_to_string.h"
+
+namespace pw::string {
+namespace {
+
+using benchmark::DoNotOptimize;
+using benchmark::State;
+
+template <typename T, size_t kSize, typename Function>
+void Convert(State& state,
+             const std::array<T, kSize>& values,
+             Function to_string) {
+  std::array<char, 32> buffer;
+  for (auto _ : state) {
+    for (T value : values) {
+      DoNotOptimize(value);
+      DoNotOptimize(to_string(value, std::span(buffer)));
+      benchmark::ClobberMemory();
+    }
+  }
+}
+
+constexpr std::array<uint32_t, 4> kSmallIntegers = {0, 7, 42, 365};
+constexpr std::array<uint32_t, 4> kIntegers = {
+    65535, 1000000, 123456789, 4294967295};
+constexpr std::array<int64_t, 4> kLargeIntegers = {
+    -9223372036854775807 - 1,
+    -1234567890123,
+    98765432109876543,
+    9223372036854775807,
+};
+constexpr std::array<float, 4> kFloats = {0.1f, 3.14159f, -273.15f, 1e6f};
+constexpr std::array<float, 4> kExtremeFloats = {
+    1e-45f, 1.17549435e-38f, 6.02214076e23f, 3.4028235e38f};
+
+StatusWithSize Decimal(int64_t value, std::span<char> buffer) {
+  return IntToString(value, buffer);
+}
+
+StatusWithSize Hex(int64_t value, std::span<char> buffer) {
+  return IntToHexString(value, buffer);
+}
+
+PW_BENCHMARK(TypeToString, IntToString_Small) {
+  Convert(state, kSmallIntegers, Decimal);
+}
+
+PW_BENCHMARK(TypeToString, IntToString_32Bit) {
+  Convert(state, kIntegers, Decimal);
+}
+
+PW_BENCHMARK(TypeToString, IntToString_64Bit) {
+  Convert(state, kLargeIntegers, Decimal);
+}
+
+PW_BENCHMARK(TypeToString, IntToHexString_32Bit) {
+  Convert(state, kIntegers, Hex);
+}
+
+PW_BENCHMARK(TypeToString, IntToHexString_64Bit) {
+  Convert(state, kLargeIntegers, Hex);
+}
+
+PW_BENCHMARK(TypeToString, FloatAsIntToString) {
+  Convert(state, kFloats, FloatAsIntToString);
+}
+
+PW_BENCHMARK(TypeToString, FloatToString) {
+  Convert(state, kFloats, FloatToString);
+}
+
+PW_BENCHMARK(TypeToString, FloatToString_Extremes) {
+  Convert(state, kExtremeFloats, FloatToString);
+}
+
+}  // namespace
+}  // namespace pw::string
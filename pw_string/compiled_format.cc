@@ -0,0 +1,51 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_string/compiled_format.h"
+
+#include "pw_string/type_to_string.h"
+
+namespace pw::string::internal {
+
+void FormatWriter::Integer(StringBuilder& builder, int64_t value) {
+  builder.HandleStatusWithSize(
+      IntToString(value, builder.buffer_.subspan(builder.size_)));
+}
+
+void FormatWriter::Integer(StringBuilder& builder, uint64_t value) {
+  builder.HandleStatusWithSize(
+      IntToString(value, builder.buffer_.subspan(builder.size_)));
+}
+
+void FormatWriter::Hex(StringBuilder& builder,
+                       uint64_t value,
+                       uint_fast8_t width) {
+  builder.HandleStatusWithSize(
+      IntToHexString(value, builder.buffer_.subspan(builder.size_), width));
+}
+
+void FormatWriter::String(StringBuilder& builder, const char* value) {
+  if (value == nullptr) {
+    builder.append(kNullPointerString);
+  } else {
+    builder.append(value);
+  }
+}
+
+void FormatWriter::Pointer(StringBuilder& builder, const void* value) {
+  builder.HandleStatusWithSize(
+      PointerToString(value, builder.buffer_.subspan(builder.size_)));
+}
+
+}  // namespace pw::string::internal
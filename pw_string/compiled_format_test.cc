@@ -0,0 +1,188 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_string/compiled_format.h"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+namespace pw::string {
+namespace {
+
+using namespace std::literals::string_view_literals;
+
+// The format string is split into literal and conversion segments.
+static_assert(internal::CountSegments("") == 0u);
+static_assert(internal::CountSegments("abc") == 1u);
+static_assert(internal::CountSegments("%d") == 1u);
+static_assert(internal::CountSegments("a%db%%c") == 4u);
+static_assert(internal::CountConversions("a%db%%c%s") == 2u);
+
+TEST(CompiledFormat, Literal) {
+  StringBuffer<16> sb;
+  FormatTo(sb, PW_FORMAT_STRING("-_-"));
+
+  EXPECT_EQ(OkStatus(), sb.status());
+  EXPECT_EQ("-_-"sv, sb.view());
+}
+
+TEST(CompiledFormat, EmptyFormat) {
+  StringBuffer<16> sb;
+  FormatTo(sb, PW_FORMAT_STRING(""));
+
+  EXPECT_EQ(OkStatus(), sb.status());
+  EXPECT_EQ(""sv, sb.view());
+}
+
+TEST(CompiledFormat, Percent) {
+  StringBuffer<16> sb;
+  FormatTo(sb, PW_FORMAT_STRING("%%100%%"));
+
+  EXPECT_EQ("%100%"sv, sb.view());
+}
+
+TEST(CompiledFormat, Integers) {
+  StringBuffer<64> sb;
+  FormatTo(sb,
+           PW_FORMAT_STRING("%d %i %u %d %d"),
+           -123,
+           int8_t{-1},
+           456u,
+           INT64_MIN,
+           UINT64_MAX);
+
+  EXPECT_EQ(OkStatus(), sb.status());
+  EXPECT_EQ("-123 -1 456 -9223372036854775808 18446744073709551615"sv,
+            sb.view());
+}
+
+TEST(CompiledFormat, IntegersOfCharAndBoolTypes_WrittenAsNumbers) {
+  StringBuffer<16> sb;
+  FormatTo(sb, PW_FORMAT_STRING("%d %d"), 'A', true);
+
+  EXPECT_EQ("65 1"sv, sb.view());
+}
+
+enum class Color : int16_t { kRed = -2 };
+
+TEST(CompiledFormat, Enum) {
+  StringBuffer<16> sb;
+  FormatTo(sb, PW_FORMAT_STRING("%d %x"), Color::kRed, Color::kRed);
+
+  EXPECT_EQ("-2 fffe"sv, sb.view());
+}
+
+TEST(CompiledFormat, LengthModifiers_Ignored) {
+  StringBuffer<32> sb;
+  FormatTo(sb,
+           PW_FORMAT_STRING("%ld %llu %zu %hhx"),
+           1l,
+           2ull,
+           size_t{3},
+           uint8_t{0xab});
+
+  EXPECT_EQ("1 2 3 ab"sv, sb.view());
+}
+
+TEST(CompiledFormat, Hex) {
+  StringBuffer<32> sb;
+  FormatTo(sb, PW_FORMAT_STRING("%x %08x %x"), 0xc, 0xbeefu, -1);
+
+  EXPECT_EQ("c 0000beef ffffffff"sv, sb.view());
+}
+
+TEST(CompiledFormat, Char) {
+  StringBuffer<16> sb;
+  FormatTo(sb, PW_FORMAT_STRING("a%cc"), 'b');
+
+  EXPECT_EQ("abc"sv, sb.view());
+}
+
+TEST(CompiledFormat, Strings) {
+  const char* c_string = "two";
+  const char* null_string = nullptr;
+
+  StringBuffer<32> sb;
+  FormatTo(sb,
+           PW_FORMAT_STRING("%s %s %s %s"),
+           "one",
+           c_string,
+           "three"sv,
+           null_string);
+
+  EXPECT_EQ(OkStatus(), sb.status());
+  EXPECT_EQ("one two three (null)"sv, sb.view());
+}
+
+TEST(CompiledFormat, Pointers) {
+  StringBuffer<32> sb;
+  FormatTo(sb,
+           PW_FORMAT_STRING("%p %p"),
+           reinterpret_cast<const void*>(0xf00d),
+           nullptr);
+
+  EXPECT_EQ("f00d (null)"sv, sb.view());
+}
+
+TEST(CompiledFormat, AppendsToBuilder) {
+  StringBuffer<32> sb;
+  sb << "x";
+  FormatTo(sb, PW_FORMAT_STRING("=%d"), 1);
+  FormatTo(sb, PW_FORMAT_STRING(", y=%d"), 2);
+
+  EXPECT_EQ("x=1, y=2"sv, sb.view());
+}
+
+TEST(CompiledFormat, Buffer) {
+  char buffer[32];
+  const StatusWithSize result =
+      FormatTo(buffer, PW_FORMAT_STRING("%d4%s"), 123, "5");
+
+  EXPECT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(5u, result.size());
+  EXPECT_STREQ("12345", buffer);
+}
+
+TEST(CompiledFormat, LiteralLargerThanBuffer_Truncated) {
+  char buffer[5];
+  const StatusWithSize result = FormatTo(buffer, PW_FORMAT_STRING("2big!"));
+
+  EXPECT_EQ(Status::ResourceExhausted(), result.status());
+  EXPECT_EQ(4u, result.size());
+  EXPECT_STREQ("2big", buffer);
+}
+
+TEST(CompiledFormat, NumberLargerThanBuffer_NotWritten) {
+  char buffer[5];
+  const StatusWithSize result =
+      FormatTo(buffer, PW_FORMAT_STRING("1%d"), 23456);
+
+  EXPECT_EQ(Status::ResourceExhausted(), result.status());
+  EXPECT_EQ(1u, result.size());
+  EXPECT_STREQ("1", buffer);
+}
+
+TEST(CompiledFormat, EmptyBuffer_ReturnsResourceExhausted) {
+  const StatusWithSize result =
+      FormatTo(std::span<char>(), PW_FORMAT_STRING("?"));
+
+  EXPECT_EQ(Status::ResourceExhausted(), result.status());
+  EXPECT_EQ(0u, result.size());
+}
+
+}  // namespace
+}  // namespace pw::string
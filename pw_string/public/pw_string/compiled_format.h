@@ -0,0 +1,342 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+// This provides pw::string::FormatTo, a printf-style formatting function whose
+// format string is parsed and checked against the argument types at compile
+// time. Each argument is written with a small function for its type, such as
+// IntToString, rather than with std::vsnprintf. This avoids parsing the format
+// at run time and linking in the libc formatting code.
+//
+// Format strings are passed with the PW_FORMAT_STRING macro:
+//
+//   pw::StringBuffer<32> sb;
+//   pw::string::FormatTo(sb, PW_FORMAT_STRING("%s: %d"), name, value);
+//
+// These conversions are supported:
+//
+//   %d, %i, %u  Any integer or enum, written as a decimal in its own type.
+//   %x, %0Nx    Any integer or enum, as lowercase hexadecimal, optionally
+//               zero-padded to N digits.
+//   %c          Any integer, written as a char.
+//   %s          A C string or anything convertible to std::string_view. A null
+//               C string is written as "(null)".
+//   %p          A pointer.
+//   %%          A literal '%'.
+//
+// Length modifiers, such as the l in %lu, are accepted and ignored, since the
+// argument types are known. Any other conversion, flag, width, or precision is
+// a compile error, as is an argument of the wrong type or a mismatch between
+// the number of conversions and arguments.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "pw_status/status_with_size.h"
+#include "pw_string/string_builder.h"
+
+// Wraps a string literal so that it can be used as a compile-time format string
+// with pw::string::FormatTo.
+#define PW_FORMAT_STRING(format)                                   \
+  [] {                                                             \
+    struct PwFormatString : ::pw::string::internal::FormatString { \
+      static constexpr std::string_view value() { return format; } \
+    };                                                             \
+    return PwFormatString();                                       \
+  }()
+
+namespace pw::string {
+namespace internal {
+
+// Base of the types created by PW_FORMAT_STRING.
+struct FormatString {};
+
+enum class FormatKind : uint8_t {
+  kLiteral,
+  kInteger,
+  kHex,
+  kChar,
+  kString,
+  kPointer,
+  kInvalid,
+};
+
+// A piece of a format string: either literal text or a conversion.
+struct FormatSegment {
+  FormatKind kind;
+  size_t begin;  // Offset of the text or conversion in the format string.
+  size_t size;   // Length of the text or conversion.
+  size_t arg;    // Index of the argument for a conversion.
+  uint8_t width;
+};
+
+constexpr bool IsLengthModifier(char c) {
+  return c == 'h' || c == 'l' || c == 'j' || c == 'z' || c == 't';
+}
+
+constexpr FormatKind ConversionKind(char c) {
+  switch (c) {
+    case 'd':
+    case 'i':
+    case 'u':
+      return FormatKind::kInteger;
+    case 'x':
+      return FormatKind::kHex;
+    case 'c':
+      return FormatKind::kChar;
+    case 's':
+      return FormatKind::kString;
+    case 'p':
+      return FormatKind::kPointer;
+    default:
+      return FormatKind::kInvalid;
+  }
+}
+
+// Splits a format string into segments, calling on_segment for each.
+template <typename Function>
+constexpr void ParseFormatString(std::string_view format,
+                                 Function&& on_segment) {
+  size_t literal_begin = 0;
+  size_t args = 0;
+
+  for (size_t i = 0; i < format.size();) {
+    if (format[i] != '%') {
+      i += 1;
+      continue;
+    }
+
+    if (i != literal_begin) {
+      on_segment(FormatSegment{
+          FormatKind::kLiteral, literal_begin, i - literal_begin, 0, 0});
+    }
+
+    const size_t begin = i;
+    i += 1;
+
+    // %% is written as the text of the second %.
+    if (i < format.size() && format[i] == '%') {
+      literal_begin = i;
+      i += 1;
+      continue;
+    }
+
+    // Only %x may have a width, which must be zero-padded.
+    bool zero_padded = false;
+    unsigned width = 0;
+    if (i < format.size() && format[i] == '0') {
+      zero_padded = true;
+      for (i += 1; i < format.size() && '0' <= format[i] && format[i] <= '9';
+           i += 1) {
+        width = std::min(width * 10 + static_cast<unsigned>(format[i] - '0'),
+                         1000u);
+      }
+    }
+
+    while (i < format.size() && IsLengthModifier(format[i])) {
+      i += 1;
+    }
+
+    FormatKind kind = FormatKind::kInvalid;
+    if (i < format.size()) {
+      kind = ConversionKind(format[i]);
+      i += 1;
+    }
+    if (zero_padded &&
+        (kind != FormatKind::kHex || width == 0u || width > 64u)) {
+      kind = FormatKind::kInvalid;
+    }
+
+    on_segment(FormatSegment{kind,
+                             begin,
+                             i - begin,
+                             args,
+                             static_cast<uint8_t>(width)});
+    args += 1;
+    literal_begin = i;
+  }
+
+  if (literal_begin != format.size()) {
+    on_segment(FormatSegment{FormatKind::kLiteral,
+                             literal_begin,
+                             format.size() - literal_begin,
+                             0,
+                             0});
+  }
+}
+
+constexpr size_t CountSegments(std::string_view format) {
+  size_t count = 0;
+  ParseFormatString(format, [&count](const FormatSegment&) { count += 1; });
+  return count;
+}
+
+constexpr size_t CountConversions(std::string_view format) {
+  size_t count = 0;
+  ParseFormatString(format, [&count](const FormatSegment& segment) {
+    if (segment.kind != FormatKind::kLiteral) {
+      count += 1;
+    }
+  });
+  return count;
+}
+
+template <typename Format>
+constexpr auto ParseFormat() {
+  constexpr std::string_view format = Format::value();
+  std::array<FormatSegment, CountSegments(format)> segments{};
+  size_t index = 0;
+  ParseFormatString(format, [&](const FormatSegment& segment) {
+    segments[index] = segment;
+    index += 1;
+  });
+  return segments;
+}
+
+template <typename Format>
+inline constexpr auto kFormatSegments = ParseFormat<Format>();
+
+// Writes each kind of argument. These are not templated, so all calls share
+// one copy of each.
+class FormatWriter {
+ public:
+  static void Literal(StringBuilder& builder, const char* text, size_t size) {
+    builder.append(text, size);
+  }
+  static void Integer(StringBuilder& builder, int64_t value);
+  static void Integer(StringBuilder& builder, uint64_t value);
+  static void Hex(StringBuilder& builder, uint64_t value, uint_fast8_t width);
+  static void Char(StringBuilder& builder, char value) {
+    builder.push_back(value);
+  }
+  static void String(StringBuilder& builder, const char* value);
+  static void String(StringBuilder& builder, std::string_view value) {
+    builder.append(value);
+  }
+  static void Pointer(StringBuilder& builder, const void* value);
+};
+
+template <typename T>
+constexpr auto ToInteger(T value) {
+  if constexpr (std::is_enum_v<T>) {
+    return static_cast<std::underlying_type_t<T>>(value);
+  } else {
+    return value;
+  }
+}
+
+template <typename Format, size_t kIndex, typename Args>
+void WriteSegment(StringBuilder& builder, const Args& args) {
+  constexpr FormatSegment segment = kFormatSegments<Format>[kIndex];
+
+  if constexpr (segment.kind == FormatKind::kLiteral) {
+    FormatWriter::Literal(
+        builder, Format::value().data() + segment.begin, segment.size);
+  } else if constexpr (segment.kind == FormatKind::kInvalid) {
+    static_assert(segment.kind != FormatKind::kInvalid,
+                  "Unsupported conversion in format string; only %d, %i, %u, "
+                  "%x, %0Nx, %c, %s, %p, and %% are supported");
+  } else if constexpr (segment.arg < std::tuple_size_v<Args>) {
+    const auto& value = std::get<segment.arg>(args);
+    using T = std::remove_cv_t<std::remove_reference_t<decltype(value)>>;
+
+    if constexpr (segment.kind == FormatKind::kInteger) {
+      static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+                    "%d, %i, and %u require an integer argument");
+      using Integer = decltype(ToInteger(value));
+      if constexpr (std::is_signed_v<Integer>) {
+        FormatWriter::Integer(builder, static_cast<int64_t>(ToInteger(value)));
+      } else {
+        FormatWriter::Integer(builder, static_cast<uint64_t>(ToInteger(value)));
+      }
+    } else if constexpr (segment.kind == FormatKind::kHex) {
+      static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+                    "%x requires an integer argument");
+      using Integer = decltype(ToInteger(value));
+      if constexpr (std::is_same_v<Integer, bool>) {
+        FormatWriter::Hex(builder, value ? 1u : 0u, segment.width);
+      } else {
+        // Like printf, write negative numbers as two's complement.
+        FormatWriter::Hex(builder,
+                          static_cast<std::make_unsigned_t<Integer>>(
+                              ToInteger(value)),
+                          segment.width);
+      }
+    } else if constexpr (segment.kind == FormatKind::kChar) {
+      static_assert(std::is_integral_v<T>, "%c requires a char argument");
+      FormatWriter::Char(builder, static_cast<char>(value));
+    } else if constexpr (segment.kind == FormatKind::kString) {
+      if constexpr (std::is_convertible_v<const T&, const char*>) {
+        FormatWriter::String(builder, static_cast<const char*>(value));
+      } else {
+        static_assert(std::is_convertible_v<const T&, std::string_view>,
+                      "%s requires a string argument");
+        FormatWriter::String(builder, std::string_view(value));
+      }
+    } else if constexpr (segment.kind == FormatKind::kPointer) {
+      static_assert(std::is_pointer_v<T> || std::is_null_pointer_v<T>,
+                    "%p requires a pointer argument");
+      FormatWriter::Pointer(builder, static_cast<const void*>(value));
+    }
+  }
+}
+
+template <typename Format, typename Args, size_t... kIndices>
+void WriteSegments(StringBuilder& builder,
+                   const Args& args,
+                   std::index_sequence<kIndices...>) {
+  (WriteSegment<Format, kIndices>(builder, args), ...);
+}
+
+}  // namespace internal
+
+// Appends a formatted string to a StringBuilder. The format string must be
+// passed with PW_FORMAT_STRING. Errors, such as running out of space, are
+// recorded in the StringBuilder's status, as with its other functions.
+template <typename Format, typename... Args>
+StringBuilder& FormatTo(StringBuilder& builder, Format, const Args&... args) {
+  static_assert(std::is_base_of_v<internal::FormatString, Format>,
+                "Format strings must be passed with PW_FORMAT_STRING");
+  static_assert(
+      internal::CountConversions(Format::value()) == sizeof...(Args),
+      "The number of arguments does not match the number of conversions in "
+      "the format string");
+
+  internal::WriteSegments<Format>(
+      builder,
+      std::forward_as_tuple(args...),
+      std::make_index_sequence<internal::kFormatSegments<Format>.size()>());
+  return builder;
+}
+
+// Writes a formatted string to a buffer. Returns the number of characters
+// written, excluding the null terminator, and a status like that of
+// pw::string::Format. The buffer is always null-terminated unless it is empty.
+template <typename Format, typename... Args>
+StatusWithSize FormatTo(std::span<char> buffer,
+                        Format format,
+                        const Args&... args) {
+  StringBuilder builder(buffer);
+  FormatTo(builder, format, args...);
+  return builder.status_with_size();
+}
+
+}  // namespace pw::string
@@ -0,0 +1,25 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Configuration macros for the pw_string module.
+#pragma once
+
+// Trades the speed of number to string conversions for code size. By default,
+// decimal integers are written two digits at a time from a 200-byte table, and
+// FloatToString reads the powers of 5 it needs from about 600 bytes of tables.
+// If set, integers are written one digit at a time, and the powers of 5 are
+// computed as they are needed instead.
+#ifndef PW_STRING_CONFIG_COMPACT_TABLES
+#define PW_STRING_CONFIG_COMPACT_TABLES 0
+#endif  // PW_STRING_CONFIG_COMPACT_TABLES
@@ -28,6 +28,11 @@
 #include "pw_string/to_string.h"
 
 namespace pw {
+namespace string::internal {
+
+class FormatWriter;
+
+}  // namespace string::internal
 
 // StringBuilder facilitates building formatted strings in a fixed-size buffer.
 // StringBuilders are always null terminated (unless they are constructed with
@@ -241,6 +246,9 @@ class StringBuilder {
   void CopySizeAndStatus(const StringBuilder& other);
 
  private:
+  // Compile-time formatting writes arguments directly into the buffer.
+  friend class string::internal::FormatWriter;
+
   size_t ResizeAndTerminate(size_t chars_to_append);
 
   void HandleStatusWithSize(StatusWithSize written);
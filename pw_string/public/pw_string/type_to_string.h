@@ -98,6 +98,22 @@ StatusWithSize IntToHexString(uint64_t value,
 //
 StatusWithSize FloatAsIntToString(float value, std::span<char> buffer);
 
+// Writes the shortest decimal string that reads back as the same float, in
+// fixed or scientific notation, whichever is shorter. The output matches
+// std::to_chars(first, last, value), except that NaN is written as "NaN" or
+// "-NaN", like FloatAsIntToString. Semantics otherwise match IntToString.
+//
+// Examples:
+//
+//   FloatToString(1.25f, buffer)     -> writes "1.25" to the buffer
+//   FloatToString(0.1f, buffer)      -> writes "0.1" to the buffer
+//   FloatToString(-1e-7f, buffer)    -> writes "-1e-07" to the buffer
+//   FloatToString(3.5e20f, buffer)   -> writes "3.5e+20" to the buffer
+//   FloatToString(120000.0f, buffer) -> writes "120000" to the buffer
+//   FloatToString(1e6f, buffer)      -> writes "1e+06" to the buffer
+//
+StatusWithSize FloatToString(float value, std::span<char> buffer);
+
 // Writes a bool as "true" or "false". Semantics match CopyEntireString.
 StatusWithSize BoolToString(bool value, std::span<char> buffer);
 
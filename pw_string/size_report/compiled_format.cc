@@ -0,0 +1,69 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This size report writes the same few strings to a buffer with
+// pw::string::Format and with the compile-time checked pw::string::FormatTo.
+//
+// pw::string::Format calls std::vsnprintf, which parses the format string and
+// supports every conversion at run time. FormatTo parses the format string
+// when compiling and only links in the writers for the conversions it uses.
+
+#include <cstddef>
+
+#include "pw_bloat/bloat_this_binary.h"
+#include "pw_string/compiled_format.h"
+#include "pw_string/format.h"
+
+#ifndef USE_COMPILED_FORMAT
+#error "USE_COMPILED_FORMAT must be defined!"
+#endif  // USE_COMPILED_FORMAT
+
+namespace pw::string {
+
+char buffer_1[128];
+char buffer_2[128];
+
+char* volatile get_buffer_1 = buffer_1;
+char* volatile get_buffer_2 = buffer_2;
+volatile unsigned get_size;
+
+#if USE_COMPILED_FORMAT
+#define FORMAT_TO(buffer, format, ...) \
+  FormatTo(buffer, PW_FORMAT_STRING(format), __VA_ARGS__)
+#else
+#define FORMAT_TO(buffer, format, ...) Format(buffer, format, __VA_ARGS__)
+#endif  // USE_COMPILED_FORMAT
+
+unsigned OutputStringsToBuffer() {
+  std::span<char> buffer(get_buffer_1, get_size);
+  size_t written = 0;
+
+  written += FORMAT_TO(buffer, "hello %s %d", get_buffer_2, 1).size();
+  written += FORMAT_TO(buffer.subspan(written), "[%08x]", get_size).size();
+  written += FORMAT_TO(buffer.subspan(written), "%u bytes", get_size).size();
+  written +=
+      FORMAT_TO(buffer.subspan(written), "%c%s%c", '<', get_buffer_2, '>')
+          .size();
+  written +=
+      FORMAT_TO(buffer.subspan(written), "%p: %d%%", get_buffer_2, -5).size();
+
+  return written;
+}
+
+}  // namespace pw::string
+
+int main() {
+  pw::bloat::BloatThisBinary();
+  return pw::string::OutputStringsToBuffer();
+}
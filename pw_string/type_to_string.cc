@@ -14,11 +14,14 @@
 
 #include "pw_string/type_to_string.h"
 
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <cstring>
 #include <limits>
 
+#include "pw_string/config.h"
+
 namespace pw::string {
 namespace {
 
@@ -47,6 +50,39 @@ constexpr std::array<uint64_t, 20> kPowersOf10{
     10000000000000000000ull,  // 10^19
 };
 
+#if !PW_STRING_CONFIG_COMPACT_TABLES
+
+// The decimal digits of 00 through 99, so that two digits can be written per
+// division.
+constexpr std::array<char, 200> kDecimalDigitPairs = [] {
+  std::array<char, 200> pairs{};
+  for (size_t i = 0; i < 100u; ++i) {
+    pairs[2 * i] = static_cast<char>('0' + i / 10);
+    pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+  }
+  return pairs;
+}();
+
+#endif  // !PW_STRING_CONFIG_COMPACT_TABLES
+
+// Writes the lowest count decimal digits of value, with leading 0s, to the
+// characters before end.
+void WriteDecimalDigits(uint32_t value, uint_fast8_t count, char* end) {
+#if !PW_STRING_CONFIG_COMPACT_TABLES
+  for (; count >= 2u; count -= 2u) {
+    const uint32_t pair = 2 * (value % 100);
+    value /= 100;
+    *--end = kDecimalDigitPairs[pair + 1];
+    *--end = kDecimalDigitPairs[pair];
+  }
+#endif  // !PW_STRING_CONFIG_COMPACT_TABLES
+
+  for (; count > 0u; --count) {
+    *--end = static_cast<char>(value % 10 + '0');
+    value /= 10;
+  }
+}
+
 StatusWithSize HandleExhaustedBuffer(std::span<char> buffer) {
   if (!buffer.empty()) {
     buffer[0] = '\0';
@@ -54,6 +90,372 @@ StatusWithSize HandleExhaustedBuffer(std::span<char> buffer) {
   return StatusWithSize::ResourceExhausted();
 }
 
+StatusWithSize NonFiniteFloatToString(float value, std::span<char> buffer) {
+  if (const size_t written = 3 + std::signbit(value); written < buffer.size()) {
+    char* out = buffer.data();
+    if (std::signbit(value)) {
+      *out++ = '-';
+    }
+    std::memcpy(out, std::isnan(value) ? "NaN" : "inf", sizeof("NaN"));
+    return StatusWithSize(written);
+  }
+
+  return HandleExhaustedBuffer(buffer);
+}
+
+// FloatToString finds the shortest decimal that rounds to a float with the Ryu
+// algorithm, described in Ulf Adams. 2018. Ryu: fast float-to-string
+// conversion. https://doi.org/10.1145/3192366.3192369. This follows the
+// reference implementation of its float variant, which only needs 32- and
+// 64-bit arithmetic.
+
+constexpr int32_t kFloatMantissaBits = 23;
+constexpr int32_t kFloatExponentBias = 127;
+
+// The number of bits kept from the powers of 5 and their inverses.
+constexpr int32_t kPow5BitCount = 61;
+constexpr int32_t kPow5InverseBitCount = 59;
+
+// The largest powers of 5 needed for float exponents, plus one for the extra
+// digit that is sometimes computed.
+constexpr uint32_t kMaxPow5 = 47;
+constexpr uint32_t kMaxPow5Inverse = 30;
+
+// Returns ceil(log2(5^e)), or 1 for e == 0.
+constexpr int32_t Pow5Bits(int32_t e) {
+  return static_cast<int32_t>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+}
+
+// Returns floor(log10(2^e)).
+constexpr uint32_t Log10Pow2(int32_t e) {
+  return (static_cast<uint32_t>(e) * 78913) >> 18;
+}
+
+// Returns floor(log10(5^e)).
+constexpr uint32_t Log10Pow5(int32_t e) {
+  return (static_cast<uint32_t>(e) * 732923) >> 20;
+}
+
+// Just enough of a 128-bit integer to calculate the powers of 5 and their
+// inverses, which have up to 110 and 128 bits.
+struct UInt128 {
+  uint64_t high;
+  uint64_t low;
+};
+
+constexpr bool operator>=(UInt128 lhs, UInt128 rhs) {
+  return lhs.high != rhs.high ? lhs.high > rhs.high : lhs.low >= rhs.low;
+}
+
+constexpr UInt128 Pow5(uint32_t e) {
+  UInt128 value = {0, 1};
+  for (uint32_t i = 0; i < e; ++i) {
+    const uint64_t carry =
+        ((value.low >> 32) * 5 + (((value.low & 0xFFFFFFFFu) * 5) >> 32)) >>
+        32;
+    value = {value.high * 5 + carry, value.low * 5};
+  }
+  return value;
+}
+
+// Returns 5^e, shifted to have kPow5BitCount significant bits.
+constexpr uint64_t Pow5Split(uint32_t e) {
+  const UInt128 pow5 = Pow5(e);
+  const int32_t shift = Pow5Bits(static_cast<int32_t>(e)) - kPow5BitCount;
+  if (shift <= 0) {
+    return pow5.low << -shift;
+  }
+  return (pow5.low >> shift) | (pow5.high << (64 - shift));
+}
+
+// Returns floor(2^(Pow5Bits(e) - 1 + kPow5InverseBitCount) / 5^e) + 1. The
+// dividend is one bit too wide for UInt128, so this divides one bit at a time.
+constexpr uint64_t Pow5InverseSplit(uint32_t e) {
+  const UInt128 pow5 = Pow5(e);
+  const int32_t dividend_bits =
+      Pow5Bits(static_cast<int32_t>(e)) - 1 + kPow5InverseBitCount;
+
+  UInt128 remainder = {0, 1};
+  uint64_t quotient = 0;
+  for (int32_t i = 0; i < dividend_bits; ++i) {
+    remainder = {(remainder.high << 1) | (remainder.low >> 63),
+                 remainder.low << 1};
+    quotient <<= 1;
+    if (remainder >= pow5) {
+      const uint64_t borrow = remainder.low < pow5.low ? 1 : 0;
+      remainder = {remainder.high - pow5.high - borrow,
+                   remainder.low - pow5.low};
+      quotient |= 1;
+    }
+  }
+  return quotient + 1;
+}
+
+#if !PW_STRING_CONFIG_COMPACT_TABLES
+
+template <uint32_t kMax, uint64_t (*kFunction)(uint32_t)>
+constexpr std::array<uint64_t, kMax + 1> MakeTable() {
+  std::array<uint64_t, kMax + 1> table{};
+  for (uint32_t i = 0; i <= kMax; ++i) {
+    table[i] = kFunction(i);
+  }
+  return table;
+}
+
+constexpr auto kPow5Table = MakeTable<kMaxPow5, Pow5Split>();
+constexpr auto kPow5InverseTable =
+    MakeTable<kMaxPow5Inverse, Pow5InverseSplit>();
+
+#endif  // !PW_STRING_CONFIG_COMPACT_TABLES
+
+// Returns (m * factor) >> shift, for shift > 32.
+uint32_t MulShift32(uint32_t m, uint64_t factor, int32_t shift) {
+  const uint64_t low = static_cast<uint64_t>(m) * (factor & 0xFFFFFFFFu);
+  const uint64_t high = static_cast<uint64_t>(m) * (factor >> 32);
+  return static_cast<uint32_t>(((low >> 32) + high) >> (shift - 32));
+}
+
+// Returns floor(m * 5^i / 2^j).
+uint32_t MulPow5DivPow2(uint32_t m, uint32_t i, int32_t j) {
+#if PW_STRING_CONFIG_COMPACT_TABLES
+  return MulShift32(m, Pow5Split(i), j);
+#else
+  return MulShift32(m, kPow5Table[i], j);
+#endif  // PW_STRING_CONFIG_COMPACT_TABLES
+}
+
+// Returns floor(m / 5^q / 2^j), for the j chosen by ShortestDecimal.
+uint32_t MulPow5InverseDivPow2(uint32_t m, uint32_t q, int32_t j) {
+#if PW_STRING_CONFIG_COMPACT_TABLES
+  return MulShift32(m, Pow5InverseSplit(q), j);
+#else
+  return MulShift32(m, kPow5InverseTable[q], j);
+#endif  // PW_STRING_CONFIG_COMPACT_TABLES
+}
+
+constexpr bool IsMultipleOfPow5(uint32_t value, uint32_t p) {
+  for (; p > 0u; --p, value /= 5) {
+    if (value % 5 != 0u) {
+      return false;
+    }
+  }
+  return true;
+}
+
+constexpr bool IsMultipleOfPow2(uint32_t value, uint32_t p) {
+  return (value & ((1u << p) - 1)) == 0u;
+}
+
+// A number equal to mantissa * 10^exponent.
+struct Decimal {
+  uint32_t mantissa;
+  int32_t exponent;
+};
+
+// Finds the decimal with the fewest digits that rounds to the positive, finite,
+// nonzero float with the given IEEE 754 fields. If there are several, returns
+// the closest one.
+Decimal ShortestDecimal(uint32_t ieee_mantissa, uint32_t ieee_exponent) {
+  // Subtract 2 from the exponent so that the halfway points to the neighboring
+  // floats are integers.
+  int32_t e2;
+  uint32_t m2;
+  if (ieee_exponent == 0u) {
+    e2 = 1 - kFloatExponentBias - kFloatMantissaBits - 2;
+    m2 = ieee_mantissa;
+  } else {
+    e2 = static_cast<int32_t>(ieee_exponent) - kFloatExponentBias -
+         kFloatMantissaBits - 2;
+    m2 = (1u << kFloatMantissaBits) | ieee_mantissa;
+  }
+
+  // Round-to-even parsing accepts the bounds of the interval when m2 is even.
+  const bool accept_bounds = (m2 & 1u) == 0u;
+
+  // The value and the bounds of the interval that round to it, times 2^-e2.
+  // The interval below is half as wide at the smallest mantissa of an exponent.
+  const uint32_t mv = 4 * m2;
+  const uint32_t mp = 4 * m2 + 2;
+  const uint32_t mm_shift = ieee_mantissa != 0u || ieee_exponent <= 1u;
+  const uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+  // Convert the value and bounds to vr, vp, and vm times 10^e10, dropping the
+  // digits that cannot be needed. Track whether the dropped digits were all
+  // zero, and the last of them, to round correctly.
+  uint32_t vr;
+  uint32_t vp;
+  uint32_t vm;
+  int32_t e10;
+  bool vm_is_trailing_zeros = false;
+  bool vr_is_trailing_zeros = false;
+  uint32_t last_removed_digit = 0;
+
+  if (e2 >= 0) {
+    const uint32_t q = Log10Pow2(e2);
+    e10 = static_cast<int32_t>(q);
+    const int32_t k =
+        kPow5InverseBitCount + Pow5Bits(static_cast<int32_t>(q)) - 1;
+    const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+    vr = MulPow5InverseDivPow2(mv, q, i);
+    vp = MulPow5InverseDivPow2(mp, q, i);
+    vm = MulPow5InverseDivPow2(mm, q, i);
+
+    if (q != 0u && (vp - 1) / 10 <= vm / 10) {
+      // At most one digit is removed below, so it must be calculated here.
+      const int32_t l =
+          kPow5InverseBitCount + Pow5Bits(static_cast<int32_t>(q - 1)) - 1;
+      const int32_t j = -e2 + static_cast<int32_t>(q) - 1 + l;
+      last_removed_digit = MulPow5InverseDivPow2(mv, q - 1, j) % 10;
+    }
+    if (q <= 9u) {
+      // Only one of mv, mp, and mm can be a multiple of 5.
+      if (mv % 5 == 0u) {
+        vr_is_trailing_zeros = IsMultipleOfPow5(mv, q);
+      } else if (accept_bounds) {
+        vm_is_trailing_zeros = IsMultipleOfPow5(mm, q);
+      } else {
+        vp -= IsMultipleOfPow5(mp, q) ? 1 : 0;
+      }
+    }
+  } else {
+    const uint32_t q = Log10Pow5(-e2);
+    e10 = static_cast<int32_t>(q) + e2;
+    const int32_t i = -e2 - static_cast<int32_t>(q);
+    const int32_t k = Pow5Bits(i) - kPow5BitCount;
+    int32_t j = static_cast<int32_t>(q) - k;
+    vr = MulPow5DivPow2(mv, static_cast<uint32_t>(i), j);
+    vp = MulPow5DivPow2(mp, static_cast<uint32_t>(i), j);
+    vm = MulPow5DivPow2(mm, static_cast<uint32_t>(i), j);
+
+    if (q != 0u && (vp - 1) / 10 <= vm / 10) {
+      j = static_cast<int32_t>(q) - 1 - (Pow5Bits(i + 1) - kPow5BitCount);
+      last_removed_digit =
+          MulPow5DivPow2(mv, static_cast<uint32_t>(i + 1), j) % 10;
+    }
+    if (q <= 1u) {
+      // mv = 4 * m2, so it has at least two trailing 0 bits, and mp = mv + 2
+      // has at least one. mm has one only if mm_shift is 1.
+      vr_is_trailing_zeros = true;
+      if (accept_bounds) {
+        vm_is_trailing_zeros = mm_shift == 1u;
+      } else {
+        --vp;
+      }
+    } else if (q < 31u) {
+      vr_is_trailing_zeros = IsMultipleOfPow2(mv, q - 1);
+    }
+  }
+
+  // Remove digits while the bounds still differ, so that the result is the
+  // shortest decimal in the interval.
+  int32_t removed = 0;
+  uint32_t output;
+  if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+    // The uncommon case, where the interval is exact and may include vm.
+    while (vp / 10 > vm / 10) {
+      vm_is_trailing_zeros &= vm % 10 == 0u;
+      vr_is_trailing_zeros &= last_removed_digit == 0u;
+      last_removed_digit = vr % 10;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    if (vm_is_trailing_zeros) {
+      while (vm % 10 == 0u) {
+        vr_is_trailing_zeros &= last_removed_digit == 0u;
+        last_removed_digit = vr % 10;
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        ++removed;
+      }
+    }
+    if (vr_is_trailing_zeros && last_removed_digit == 5u && vr % 2 == 0u) {
+      // Round exact halves to even.
+      last_removed_digit = 4;
+    }
+    output = vr + (((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                    last_removed_digit >= 5u)
+                       ? 1
+                       : 0);
+  } else {
+    while (vp / 10 > vm / 10) {
+      last_removed_digit = vr % 10;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    output = vr + ((vr == vm || last_removed_digit >= 5u) ? 1 : 0);
+  }
+
+  return Decimal{output, e10 + removed};
+}
+
+// Writes a float like std::to_chars does: the shortest decimal that rounds to
+// it, in fixed or scientific notation, whichever is shorter, preferring fixed.
+StatusWithSize WriteDecimal(float value,
+                            Decimal decimal,
+                            std::span<char> buffer) {
+  const bool negative = std::signbit(value);
+  const int32_t digits = DecimalDigitCount(decimal.mantissa);
+  const int32_t exponent = decimal.exponent;
+  const int32_t scientific_exponent = exponent + digits - 1;
+
+  int32_t fixed_size;
+  if (exponent >= 0) {
+    fixed_size = digits + exponent;  // 12300
+  } else if (scientific_exponent >= 0) {
+    fixed_size = digits + 1;  // 12.3
+  } else {
+    fixed_size = 1 - scientific_exponent + digits;  // 0.0123
+  }
+
+  // Float exponents always have two digits: 1.23e+04
+  const int32_t scientific_size = digits + (digits > 1 ? 1 : 0) + 4;
+
+  const bool fixed = fixed_size <= scientific_size;
+  const size_t size = (negative ? 1u : 0u) +
+                      static_cast<size_t>(fixed ? fixed_size : scientific_size);
+  if (size >= buffer.size()) {
+    return HandleExhaustedBuffer(buffer);
+  }
+
+  char* out = buffer.data();
+  if (negative) {
+    *out++ = '-';
+  }
+
+  if (!fixed) {
+    // Write the digits one character later, then move the first in front of
+    // the decimal point.
+    WriteDecimalDigits(decimal.mantissa, digits, out + 1 + digits);
+    out[0] = out[1];
+    out[1] = '.';
+    out += digits + (digits > 1 ? 1 : 0);
+    *out++ = 'e';
+    *out++ = scientific_exponent < 0 ? '-' : '+';
+    WriteDecimalDigits(std::abs(scientific_exponent), 2, out + 2);
+  } else if (exponent >= 0) {
+    // Whole numbers are written exactly rather than padded with 0s, which
+    // gives the same number of digits. They are under 10^14, so they fit.
+    IntToString<uint64_t>(static_cast<uint64_t>(std::abs(value)),
+                          buffer.subspan(out - buffer.data()));
+  } else if (scientific_exponent >= 0) {
+    WriteDecimalDigits(decimal.mantissa, digits, out + 1 + digits);
+    std::memmove(out, out + 1, scientific_exponent + 1);
+    out[scientific_exponent + 1] = '.';
+  } else {
+    std::memset(out, '0', -scientific_exponent + 1);
+    out[1] = '.';
+    WriteDecimalDigits(decimal.mantissa, digits, out + fixed_size);
+  }
+
+  buffer[size] = '\0';
+  return StatusWithSize(size);
+}
+
 }  // namespace
 
 uint_fast8_t DecimalDigitCount(uint64_t integer) {
@@ -73,7 +475,6 @@ uint_fast8_t DecimalDigitCount(uint64_t integer) {
 // think std::to_chars will be faster, so I kept this implementation for now.
 template <>
 StatusWithSize IntToString(uint64_t value, std::span<char> buffer) {
-  constexpr uint32_t base = 10;
   constexpr uint32_t max_uint32_base_power = 1'000'000'000;
   constexpr uint_fast8_t max_uint32_base_power_exponent = 9;
 
@@ -101,11 +502,8 @@ StatusWithSize IntToString(uint64_t value, std::span<char> buffer) {
       value /= max_uint32_base_power;
     }
 
-    // Write the specified number of digits, with leading 0s.
-    for (uint_fast8_t i = 0; i < digit_count; ++i) {
-      buffer[--remaining] = lower_digits % base + '0';
-      lower_digits /= base;
-    }
+    WriteDecimalDigits(lower_digits, digit_count, &buffer[remaining]);
+    remaining -= digit_count;
   }
   return StatusWithSize(total_digits);
 }
@@ -157,16 +555,25 @@ StatusWithSize FloatAsIntToString(float value, std::span<char> buffer) {
   }
 
   // Otherwise, print inf or NaN, if they fit.
-  if (const size_t written = 3 + std::signbit(value); written < buffer.size()) {
-    char* out = buffer.data();
-    if (std::signbit(value)) {
-      *out++ = '-';
-    }
-    std::memcpy(out, std::isnan(value) ? "NaN" : "inf", sizeof("NaN"));
-    return StatusWithSize(written);
+  return NonFiniteFloatToString(value, buffer);
+}
+
+StatusWithSize FloatToString(float value, std::span<char> buffer) {
+  if (!std::isfinite(value)) {
+    return NonFiniteFloatToString(value, buffer);
   }
 
-  return HandleExhaustedBuffer(buffer);
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  const uint32_t ieee_mantissa = bits & ((1u << kFloatMantissaBits) - 1);
+  const uint32_t ieee_exponent = (bits >> kFloatMantissaBits) & 0xFFu;
+
+  Decimal decimal = {};  // Zero is written as 0e0.
+  if (ieee_mantissa != 0u || ieee_exponent != 0u) {
+    decimal = ShortestDecimal(ieee_mantissa, ieee_exponent);
+  }
+  return WriteDecimal(value, decimal, buffer);
 }
 
 StatusWithSize BoolToString(bool value, std::span<char> buffer) {
@@ -15,6 +15,7 @@
 #include "pw_string/type_to_string.h"
 
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <limits>
 #include <string_view>
@@ -407,6 +408,127 @@ TEST_F(FloatAsIntToStringTest, TooSmall_NaN_NullTerminates) {
   EXPECT_STREQ("", buffer_);
 }
 
+class FloatToStringTest : public TestWithBuffer {};
+
+TEST_F(FloatToStringTest, Zero) {
+  EXPECT_EQ(1u, FloatToString(0.0f, buffer_).size());
+  EXPECT_STREQ("0", buffer_);
+}
+
+TEST_F(FloatToStringTest, NegativeZero) {
+  EXPECT_EQ(2u, FloatToString(-0.0f, buffer_).size());
+  EXPECT_STREQ("-0", buffer_);
+}
+
+TEST_F(FloatToStringTest, PositiveInfinity) {
+  EXPECT_EQ(3u, FloatToString(INFINITY, buffer_).size());
+  EXPECT_STREQ("inf", buffer_);
+}
+
+TEST_F(FloatToStringTest, NegativeNan) {
+  EXPECT_EQ(4u, FloatToString(-NAN, buffer_).size());
+  EXPECT_STREQ("-NaN", buffer_);
+}
+
+TEST_F(FloatToStringTest, Fraction_WritesShortestDigits) {
+  EXPECT_EQ(3u, FloatToString(0.1f, buffer_).size());
+  EXPECT_STREQ("0.1", buffer_);
+}
+
+TEST_F(FloatToStringTest, Fraction_WritesAllDigitsNeeded) {
+  EXPECT_EQ(10u, FloatToString(1.0f / 3.0f, buffer_).size());
+  EXPECT_STREQ("0.33333334", buffer_);
+}
+
+TEST_F(FloatToStringTest, Negative) {
+  EXPECT_EQ(6u, FloatToString(-12.75f, buffer_).size());
+  EXPECT_STREQ("-12.75", buffer_);
+}
+
+TEST_F(FloatToStringTest, SmallFraction_Fixed) {
+  EXPECT_EQ(6u, FloatToString(0.0025f, buffer_).size());
+  EXPECT_STREQ("0.0025", buffer_);
+}
+
+TEST_F(FloatToStringTest, SmallFraction_Scientific) {
+  EXPECT_EQ(5u, FloatToString(1e-7f, buffer_).size());
+  EXPECT_STREQ("1e-07", buffer_);
+}
+
+TEST_F(FloatToStringTest, WholeNumber_Fixed) {
+  EXPECT_EQ(6u, FloatToString(120000.0f, buffer_).size());
+  EXPECT_STREQ("120000", buffer_);
+}
+
+TEST_F(FloatToStringTest, WholeNumber_Scientific) {
+  EXPECT_EQ(5u, FloatToString(1e6f, buffer_).size());
+  EXPECT_STREQ("1e+06", buffer_);
+}
+
+TEST_F(FloatToStringTest, WholeNumber_WritesExactValue) {
+  EXPECT_EQ(8u, FloatToString(33871888.0f, buffer_).size());
+  EXPECT_STREQ("33871888", buffer_);
+}
+
+TEST_F(FloatToStringTest, LargeNumber_Scientific) {
+  EXPECT_EQ(7u, FloatToString(3.5e20f, buffer_).size());
+  EXPECT_STREQ("3.5e+20", buffer_);
+}
+
+TEST_F(FloatToStringTest, Max) {
+  EXPECT_EQ(13u,
+            FloatToString(std::numeric_limits<float>::max(), buffer_).size());
+  EXPECT_STREQ("3.4028235e+38", buffer_);
+}
+
+TEST_F(FloatToStringTest, SmallestNormal) {
+  EXPECT_EQ(13u,
+            FloatToString(std::numeric_limits<float>::min(), buffer_).size());
+  EXPECT_STREQ("1.1754944e-38", buffer_);
+}
+
+TEST_F(FloatToStringTest, SmallestSubnormal) {
+  EXPECT_EQ(
+      5u,
+      FloatToString(std::numeric_limits<float>::denorm_min(), buffer_).size());
+  EXPECT_STREQ("1e-45", buffer_);
+}
+
+TEST_F(FloatToStringTest, FitsExactly) {
+  auto result = FloatToString(-1.5f, std::span(buffer_, 5));
+  EXPECT_EQ(4u, result.size());
+  EXPECT_TRUE(result.ok());
+  EXPECT_STREQ("-1.5", buffer_);
+}
+
+TEST_F(FloatToStringTest, TooSmall_NullTerminates) {
+  auto result = FloatToString(-1.5f, std::span(buffer_, 4));
+  EXPECT_EQ(0u, result.size());
+  EXPECT_FALSE(result.ok());
+  EXPECT_STREQ("", buffer_);
+}
+
+TEST_F(FloatToStringTest, EmptyBuffer_WritesNothing) {
+  auto result = FloatToString(1.0f, std::span(buffer_, 0));
+  EXPECT_EQ(0u, result.size());
+  EXPECT_FALSE(result.ok());
+  EXPECT_STREQ(kStartingString, buffer_);
+}
+
+TEST(FloatToString, Sweep_RoundTrips) {
+  // Check floats with every exponent and a spread of mantissas.
+  for (uint32_t bits = 1; bits < 0x7f800000u; bits += 0x7f0b1u) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+
+    char buffer[16];
+    auto result = FloatToString(value, buffer);
+    ASSERT_TRUE(result.ok());
+    ASSERT_EQ(std::strlen(buffer), result.size());
+    ASSERT_EQ(value, std::strtof(buffer, nullptr));
+  }
+}
+
 class CopyStringOrNullTest : public TestWithBuffer {};
 
 using namespace std::literals::string_view_literals;
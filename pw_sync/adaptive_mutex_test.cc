@@ -0,0 +1,67 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/adaptive_mutex.h"
+
+#include <mutex>
+
+#include "gtest/gtest.h"
+
+namespace pw::sync {
+namespace {
+
+TEST(AdaptiveMutex, LockUnlock) {
+  AdaptiveMutex mutex;
+  mutex.lock();
+  mutex.unlock();
+}
+
+AdaptiveMutex static_mutex;
+TEST(AdaptiveMutex, LockUnlockStatic) {
+  static_mutex.lock();
+  static_mutex.unlock();
+}
+
+TEST(AdaptiveMutex, TryLockUnlock) {
+  AdaptiveMutex mutex;
+  const bool locked = mutex.try_lock();
+  EXPECT_TRUE(locked);
+  if (locked) {
+    mutex.unlock();
+  }
+}
+
+TEST(AdaptiveMutex, NoSpinning_LockUnlock) {
+  AdaptiveMutex mutex(0);
+  EXPECT_EQ(mutex.spin_count(), 0u);
+  mutex.lock();
+  mutex.unlock();
+}
+
+TEST(AdaptiveMutex, DefaultSpinCount) {
+  AdaptiveMutex mutex;
+  EXPECT_EQ(mutex.spin_count(), uint32_t{PW_SYNC_ADAPTIVE_MUTEX_SPIN_COUNT});
+}
+
+TEST(AdaptiveMutex, LockGuard) {
+  AdaptiveMutex mutex;
+  {
+    std::lock_guard lock(mutex);
+  }
+  std::unique_lock lock(mutex, std::try_to_lock);
+  EXPECT_TRUE(lock.owns_lock());
+}
+
+}  // namespace
+}  // namespace pw::sync
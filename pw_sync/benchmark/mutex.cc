@@ -0,0 +1,156 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures the latency of taking and releasing a lock around a very short
+// critical section with Mutex, AdaptiveMutex, and InterruptSpinLock, both
+// uncontended and contended by several threads. The results are for the
+// configured pw_sync_MUTEX_BACKEND and pw_sync_INTERRUPT_SPIN_LOCK_BACKEND, so
+// build with each backend to compare them.
+//
+// Under contention, each thread takes the lock the same number of times. The
+// spread between the first and last thread to finish shows how fair the lock
+// is: an unfair lock lets some threads finish long before the others.
+// InterruptSpinLock is contended by at most one thread per hardware thread.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_sync/adaptive_mutex.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/mutex.h"
+
+namespace {
+
+constexpr uint32_t kIterations = 1000000;
+constexpr size_t kThreads = 4;
+
+// The critical section: a counter update, as for a metric.
+template <typename Lock>
+class Counter {
+ public:
+  void Increment() {
+    std::lock_guard lock(lock_);
+    count_ += 1;
+  }
+
+  uint32_t count() {
+    std::lock_guard lock(lock_);
+    return count_;
+  }
+
+ private:
+  Lock lock_;
+  uint32_t count_ = 0;
+};
+
+long NanosecondsPerLock(pw::chrono::SystemClock::duration elapsed,
+                        uint32_t locks) {
+  return static_cast<long>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() /
+      locks);
+}
+
+template <typename Lock>
+void Uncontended(const char* name) {
+  Counter<Lock> counter;
+
+  const auto start = pw::chrono::SystemClock::now();
+  for (uint32_t i = 0; i < kIterations; ++i) {
+    counter.Increment();
+  }
+  const auto elapsed = pw::chrono::SystemClock::now() - start;
+
+  PW_CHECK_UINT_EQ(counter.count(), kIterations);
+  PW_LOG_INFO("%-18s uncontended %5ld ns per lock + unlock",
+              name,
+              NanosecondsPerLock(elapsed, kIterations));
+}
+
+template <typename Lock>
+void Contended(const char* name, size_t thread_count) {
+  Counter<Lock> counter;
+  std::thread threads[kThreads];
+  pw::chrono::SystemClock::time_point finished[kThreads];
+
+  const auto start = pw::chrono::SystemClock::now();
+  for (size_t t = 0; t < thread_count; ++t) {
+    threads[t] = std::thread([&counter, &finished, t, thread_count] {
+      for (uint32_t i = 0; i < kIterations / thread_count; ++i) {
+        counter.Increment();
+      }
+      finished[t] = pw::chrono::SystemClock::now();
+    });
+  }
+  for (size_t t = 0; t < thread_count; ++t) {
+    threads[t].join();
+  }
+  const auto elapsed = pw::chrono::SystemClock::now() - start;
+
+  const auto [first, last] =
+      std::minmax_element(finished, finished + thread_count);
+  const long spread_us = static_cast<long>(
+      std::chrono::duration_cast<std::chrono::microseconds>(*last - *first)
+          .count());
+
+  const uint32_t locks = kIterations / thread_count * thread_count;
+  PW_CHECK_UINT_EQ(counter.count(), locks);
+  PW_LOG_INFO("%-18s contended   %5ld ns per lock + unlock, %ld us spread",
+              name,
+              NanosecondsPerLock(elapsed, locks),
+              spread_us);
+}
+
+template <typename Lock>
+void Run(const char* name) {
+  Uncontended<Lock>(name);
+  Contended<Lock>(name, kThreads);
+}
+
+// Spin locks assume that each waiter has a core to itself, as when interrupts
+// are masked on a multicore device. With more threads than cores, waiters spin
+// for whole time slices while the thread they wait for is descheduled, which
+// fair spin locks are especially prone to, so use at most one thread per core.
+template <typename Lock>
+void RunSpinLock(const char* name) {
+  Uncontended<Lock>(name);
+
+  const size_t thread_count = std::min<size_t>(
+      kThreads, std::max(1u, std::thread::hardware_concurrency()));
+  if (thread_count < 2u) {
+    PW_LOG_INFO("%-18s contended   skipped, needs 2 or more cores", name);
+    return;
+  }
+  Contended<Lock>(name, thread_count);
+}
+
+}  // namespace
+
+int main() {
+  PW_LOG_INFO("%u locks, contended by %u threads, %u hardware threads",
+              static_cast<unsigned>(kIterations),
+              static_cast<unsigned>(kThreads),
+              std::thread::hardware_concurrency());
+
+  Run<pw::sync::Mutex>("Mutex");
+  Run<pw::sync::AdaptiveMutex>("AdaptiveMutex");
+  RunSpinLock<pw::sync::InterruptSpinLock>("InterruptSpinLock");
+  return 0;
+}
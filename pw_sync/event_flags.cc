@@ -0,0 +1,59 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/event_flags.h"
+
+using pw::chrono::SystemClock;
+
+extern "C" void pw_sync_EventFlags_Set(pw_sync_EventFlags* event_flags,
+                                       uint32_t flags) {
+  event_flags->set(flags);
+}
+
+extern "C" void pw_sync_EventFlags_Clear(pw_sync_EventFlags* event_flags,
+                                         uint32_t flags) {
+  event_flags->clear(flags);
+}
+
+extern "C" uint32_t pw_sync_EventFlags_WaitAny(pw_sync_EventFlags* event_flags,
+                                               uint32_t mask) {
+  return event_flags->wait_any(mask);
+}
+
+extern "C" uint32_t pw_sync_EventFlags_TryWaitAny(
+    pw_sync_EventFlags* event_flags, uint32_t mask) {
+  return event_flags->try_wait_any(mask);
+}
+
+extern "C" uint32_t pw_sync_EventFlags_TryWaitAnyFor(
+    pw_sync_EventFlags* event_flags,
+    uint32_t mask,
+    pw_chrono_SystemClock_Duration for_at_least) {
+  return event_flags->try_wait_any_for(
+      mask, SystemClock::duration(for_at_least.ticks));
+}
+
+extern "C" uint32_t pw_sync_EventFlags_TryWaitAnyUntil(
+    pw_sync_EventFlags* event_flags,
+    uint32_t mask,
+    pw_chrono_SystemClock_TimePoint until_at_least) {
+  return event_flags->try_wait_any_until(
+      mask,
+      SystemClock::time_point(
+          SystemClock::duration(until_at_least.duration_since_epoch.ticks)));
+}
+
+extern "C" uint32_t pw_sync_EventFlags_AllFlags(void) {
+  return pw::sync::EventFlags::all_flags();
+}
@@ -0,0 +1,237 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_sync/event_flags.h"
+
+using pw::chrono::SystemClock;
+using namespace std::chrono_literals;
+
+namespace pw::sync {
+namespace {
+
+extern "C" {
+
+// Functions defined in event_flags_facade_test_c.c which call the API from C.
+void pw_sync_EventFlags_CallSet(pw_sync_EventFlags* event_flags,
+                                uint32_t flags);
+void pw_sync_EventFlags_CallClear(pw_sync_EventFlags* event_flags,
+                                  uint32_t flags);
+uint32_t pw_sync_EventFlags_CallWaitAny(pw_sync_EventFlags* event_flags,
+                                        uint32_t mask);
+uint32_t pw_sync_EventFlags_CallTryWaitAny(pw_sync_EventFlags* event_flags,
+                                           uint32_t mask);
+uint32_t pw_sync_EventFlags_CallTryWaitAnyFor(
+    pw_sync_EventFlags* event_flags,
+    uint32_t mask,
+    pw_chrono_SystemClock_Duration for_at_least);
+uint32_t pw_sync_EventFlags_CallTryWaitAnyUntil(
+    pw_sync_EventFlags* event_flags,
+    uint32_t mask,
+    pw_chrono_SystemClock_TimePoint until_at_least);
+uint32_t pw_sync_EventFlags_CallAllFlags(void);
+
+}  // extern "C"
+
+// Every backend supports at least 8 flags.
+constexpr uint32_t kRpc = 1u << 0;
+constexpr uint32_t kFlash = 1u << 1;
+constexpr uint32_t kTimer = 1u << 7;
+constexpr uint32_t kAll = kRpc | kFlash | kTimer;
+
+// We can't control the SystemClock's period configuration, so just in case
+// duration cannot be accurately expressed in integer ticks, round the
+// duration up.
+constexpr SystemClock::duration kRoundedArbitraryDuration =
+    SystemClock::for_at_least(42ms);
+constexpr pw_chrono_SystemClock_Duration kRoundedArbitraryDurationInC =
+    PW_SYSTEM_CLOCK_MS(42);
+
+TEST(EventFlags, EmptyInitialState) {
+  EventFlags event_flags;
+  EXPECT_EQ(event_flags.try_wait_any(kAll), 0u);
+}
+
+// TODO(pwbug/291): Add real concurrency tests once we have pw::thread.
+
+TEST(EventFlags, Set_WaitAnyReturnsAndClearsFlags) {
+  EventFlags event_flags;
+  event_flags.set(kFlash);
+  EXPECT_EQ(event_flags.wait_any(kAll), kFlash);
+  // Ensure the flag was consumed.
+  EXPECT_EQ(event_flags.try_wait_any(kAll), 0u);
+}
+
+TEST(EventFlags, SetSeveral_WaitAnyReturnsAllSetFlags) {
+  EventFlags event_flags;
+  event_flags.set(kRpc);
+  event_flags.set(kTimer);
+  EXPECT_EQ(event_flags.wait_any(kAll), kRpc | kTimer);
+  EXPECT_EQ(event_flags.try_wait_any(kAll), 0u);
+}
+
+TEST(EventFlags, SetTwice_ReportedOnce) {
+  EventFlags event_flags;
+  event_flags.set(kRpc);
+  event_flags.set(kRpc);
+  EXPECT_EQ(event_flags.wait_any(kRpc), kRpc);
+  EXPECT_EQ(event_flags.try_wait_any(kRpc), 0u);
+}
+
+TEST(EventFlags, WaitAny_LeavesFlagsOutsideMask) {
+  EventFlags event_flags;
+  event_flags.set(kRpc | kFlash);
+  EXPECT_EQ(event_flags.wait_any(kFlash | kTimer), kFlash);
+  EXPECT_EQ(event_flags.try_wait_any(kFlash | kTimer), 0u);
+  EXPECT_EQ(event_flags.try_wait_any(kRpc), kRpc);
+}
+
+TEST(EventFlags, Clear) {
+  EventFlags event_flags;
+  event_flags.set(kRpc | kFlash | kTimer);
+  event_flags.clear(kRpc | kTimer);
+  EXPECT_EQ(event_flags.try_wait_any(kAll), kFlash);
+}
+
+EventFlags empty_initial_event_flags;
+TEST(EventFlags, EmptyInitialStateStatic) {
+  EXPECT_EQ(empty_initial_event_flags.try_wait_any(kAll), 0u);
+}
+
+EventFlags set_event_flags;
+TEST(EventFlags, SetStatic) {
+  set_event_flags.set(kTimer);
+  EXPECT_EQ(set_event_flags.wait_any(kAll), kTimer);
+  EXPECT_EQ(set_event_flags.try_wait_any(kAll), 0u);
+}
+
+TEST(EventFlags, TryWaitAnyFor) {
+  EventFlags event_flags;
+  event_flags.set(kFlash);
+
+  SystemClock::time_point before = SystemClock::now();
+  EXPECT_EQ(event_flags.try_wait_any_for(kAll, kRoundedArbitraryDuration),
+            kFlash);
+  SystemClock::duration time_elapsed = SystemClock::now() - before;
+  EXPECT_LT(time_elapsed, kRoundedArbitraryDuration);
+
+  // Ensure it blocks and fails when no flags are set.
+  before = SystemClock::now();
+  EXPECT_EQ(event_flags.try_wait_any_for(kAll, kRoundedArbitraryDuration), 0u);
+  time_elapsed = SystemClock::now() - before;
+  EXPECT_GE(time_elapsed, kRoundedArbitraryDuration);
+}
+
+TEST(EventFlags, TryWaitAnyFor_IgnoresFlagsOutsideMask) {
+  EventFlags event_flags;
+  event_flags.set(kRpc);
+
+  const SystemClock::time_point before = SystemClock::now();
+  EXPECT_EQ(event_flags.try_wait_any_for(kTimer, kRoundedArbitraryDuration),
+            0u);
+  EXPECT_GE(SystemClock::now() - before, kRoundedArbitraryDuration);
+  EXPECT_EQ(event_flags.try_wait_any(kRpc), kRpc);
+}
+
+TEST(EventFlags, TryWaitAnyUntil) {
+  EventFlags event_flags;
+  event_flags.set(kFlash);
+
+  const SystemClock::time_point deadline =
+      SystemClock::now() + kRoundedArbitraryDuration;
+  EXPECT_EQ(event_flags.try_wait_any_until(kAll, deadline), kFlash);
+  EXPECT_LT(SystemClock::now(), deadline);
+
+  // Ensure it blocks and fails when no flags are set.
+  EXPECT_EQ(event_flags.try_wait_any_until(kAll, deadline), 0u);
+  EXPECT_GE(SystemClock::now(), deadline);
+}
+
+TEST(EventFlags, AllFlags_IncludesAtLeastEightFlags) {
+  EXPECT_EQ(EventFlags::all_flags() & 0xFFu, 0xFFu);
+}
+
+TEST(EventFlags, EmptyInitialStateInC) {
+  EventFlags event_flags;
+  EXPECT_EQ(pw_sync_EventFlags_CallTryWaitAny(&event_flags, kAll), 0u);
+}
+
+TEST(EventFlags, SetAndWaitAnyInC) {
+  EventFlags event_flags;
+  pw_sync_EventFlags_CallSet(&event_flags, kRpc | kFlash);
+  EXPECT_EQ(pw_sync_EventFlags_CallWaitAny(&event_flags, kRpc), kRpc);
+  EXPECT_EQ(pw_sync_EventFlags_CallTryWaitAny(&event_flags, kAll), kFlash);
+}
+
+TEST(EventFlags, ClearInC) {
+  EventFlags event_flags;
+  pw_sync_EventFlags_CallSet(&event_flags, kRpc | kTimer);
+  pw_sync_EventFlags_CallClear(&event_flags, kRpc);
+  EXPECT_EQ(pw_sync_EventFlags_CallTryWaitAny(&event_flags, kAll), kTimer);
+}
+
+TEST(EventFlags, TryWaitAnyForInC) {
+  EventFlags event_flags;
+  pw_sync_EventFlags_CallSet(&event_flags, kTimer);
+
+  pw_chrono_SystemClock_TimePoint before = pw_chrono_SystemClock_Now();
+  ASSERT_EQ(pw_sync_EventFlags_CallTryWaitAnyFor(
+                &event_flags, kAll, kRoundedArbitraryDurationInC),
+            kTimer);
+  pw_chrono_SystemClock_Duration time_elapsed =
+      pw_chrono_SystemClock_TimeElapsed(before, pw_chrono_SystemClock_Now());
+  EXPECT_LT(time_elapsed.ticks, kRoundedArbitraryDurationInC.ticks);
+
+  // Ensure it blocks and fails when no flags are set.
+  before = pw_chrono_SystemClock_Now();
+  EXPECT_EQ(pw_sync_EventFlags_CallTryWaitAnyFor(
+                &event_flags, kAll, kRoundedArbitraryDurationInC),
+            0u);
+  time_elapsed =
+      pw_chrono_SystemClock_TimeElapsed(before, pw_chrono_SystemClock_Now());
+  EXPECT_GE(time_elapsed.ticks, kRoundedArbitraryDurationInC.ticks);
+}
+
+TEST(EventFlags, TryWaitAnyUntilInC) {
+  EventFlags event_flags;
+  pw_sync_EventFlags_CallSet(&event_flags, kTimer);
+
+  pw_chrono_SystemClock_TimePoint deadline;
+  deadline.duration_since_epoch = {
+      .ticks = pw_chrono_SystemClock_Now().duration_since_epoch.ticks +
+               kRoundedArbitraryDurationInC.ticks,
+  };
+  ASSERT_EQ(
+      pw_sync_EventFlags_CallTryWaitAnyUntil(&event_flags, kAll, deadline),
+      kTimer);
+  EXPECT_LT(pw_chrono_SystemClock_Now().duration_since_epoch.ticks,
+            deadline.duration_since_epoch.ticks);
+
+  // Ensure it blocks and fails when no flags are set.
+  EXPECT_EQ(
+      pw_sync_EventFlags_CallTryWaitAnyUntil(&event_flags, kAll, deadline),
+      0u);
+  EXPECT_GE(pw_chrono_SystemClock_Now().duration_since_epoch.ticks,
+            deadline.duration_since_epoch.ticks);
+}
+
+TEST(EventFlags, AllFlagsInC) {
+  EXPECT_EQ(EventFlags::all_flags(), pw_sync_EventFlags_CallAllFlags());
+}
+
+}  // namespace
+}  // namespace pw::sync
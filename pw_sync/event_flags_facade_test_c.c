@@ -0,0 +1,58 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// These tests call the pw_sync module event_flags API from C. The return values
+// are checked in the main C++ tests.
+
+#include <stdint.h>
+
+#include "pw_sync/event_flags.h"
+
+void pw_sync_EventFlags_CallSet(pw_sync_EventFlags* event_flags,
+                                uint32_t flags) {
+  pw_sync_EventFlags_Set(event_flags, flags);
+}
+
+void pw_sync_EventFlags_CallClear(pw_sync_EventFlags* event_flags,
+                                  uint32_t flags) {
+  pw_sync_EventFlags_Clear(event_flags, flags);
+}
+
+uint32_t pw_sync_EventFlags_CallWaitAny(pw_sync_EventFlags* event_flags,
+                                        uint32_t mask) {
+  return pw_sync_EventFlags_WaitAny(event_flags, mask);
+}
+
+uint32_t pw_sync_EventFlags_CallTryWaitAny(pw_sync_EventFlags* event_flags,
+                                           uint32_t mask) {
+  return pw_sync_EventFlags_TryWaitAny(event_flags, mask);
+}
+
+uint32_t pw_sync_EventFlags_CallTryWaitAnyFor(
+    pw_sync_EventFlags* event_flags,
+    uint32_t mask,
+    pw_chrono_SystemClock_Duration for_at_least) {
+  return pw_sync_EventFlags_TryWaitAnyFor(event_flags, mask, for_at_least);
+}
+
+uint32_t pw_sync_EventFlags_CallTryWaitAnyUntil(
+    pw_sync_EventFlags* event_flags,
+    uint32_t mask,
+    pw_chrono_SystemClock_TimePoint until_at_least) {
+  return pw_sync_EventFlags_TryWaitAnyUntil(event_flags, mask, until_at_least);
+}
+
+uint32_t pw_sync_EventFlags_CallAllFlags(void) {
+  return pw_sync_EventFlags_AllFlags();
+}
@@ -0,0 +1,67 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/instrumented_mutex.h"
+
+#include <chrono>
+
+namespace pw::sync {
+#if PW_SYNC_LOCK_PROFILING
+namespace {
+
+uint32_t Microseconds(chrono::SystemClock::duration duration) {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+}
+
+}  // namespace
+
+void InstrumentedMutex::lock() {
+  if (mutex_.try_lock()) {
+    Acquired(chrono::SystemClock::now());
+    return;
+  }
+
+  const chrono::SystemClock::time_point start = chrono::SystemClock::now();
+  mutex_.lock();
+  const chrono::SystemClock::time_point now = chrono::SystemClock::now();
+
+  contentions_.Increment();
+  wait_us_.Record(Microseconds(now - start));
+  Acquired(now);
+}
+
+bool InstrumentedMutex::try_lock() {
+  if (!mutex_.try_lock()) {
+    return false;
+  }
+  Acquired(chrono::SystemClock::now());
+  return true;
+}
+
+void InstrumentedMutex::unlock() {
+  hold_us_.Record(Microseconds(chrono::SystemClock::now() - acquired_at_));
+  mutex_.unlock();
+}
+
+#else
+
+void InstrumentedMutex::lock() { mutex_.lock(); }
+
+bool InstrumentedMutex::try_lock() { return mutex_.try_lock(); }
+
+void InstrumentedMutex::unlock() { mutex_.unlock(); }
+
+#endif  // PW_SYNC_LOCK_PROFILING
+}  // namespace pw::sync
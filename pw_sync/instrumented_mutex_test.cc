@@ -0,0 +1,106 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/instrumented_mutex.h"
+
+#include <mutex>
+
+#include "gtest/gtest.h"
+
+namespace pw::sync {
+namespace {
+
+// This test is built with PW_SYNC_LOCK_PROFILING enabled.
+static_assert(PW_SYNC_LOCK_PROFILING);
+
+// TODO(pwbug/291): Test contention once we have pw::thread.
+
+constexpr metric::Token kAcquisitions =
+    PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, "acquisitions");
+constexpr metric::Token kContentions =
+    PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, "contentions");
+constexpr metric::Token kWaitUs =
+    PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, "wait_us");
+constexpr metric::Token kHoldUs =
+    PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, "hold_us");
+constexpr metric::Token kStaticMutex =
+    PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, "static_mutex");
+
+uint32_t GetMetric(metric::Group& group, metric::Token token) {
+  for (const metric::Metric& metric : group.metrics()) {
+    if (metric.name() == token) {
+      return metric.as_int();
+    }
+  }
+  ADD_FAILURE() << "No metric with token " << token;
+  return 0;
+}
+
+const metric::Distribution* GetSummary(metric::Group& group,
+                                       metric::Token token) {
+  for (const metric::Distribution& summary : group.distributions()) {
+    if (summary.name() == token) {
+      return &summary;
+    }
+  }
+  return nullptr;
+}
+
+PW_SYNC_INSTRUMENTED_MUTEX(static_mutex, "static_mutex");
+
+TEST(InstrumentedMutex, LockUnlock_CountsAcquisition) {
+  InstrumentedMutex mutex(1);
+  mutex.lock();
+  mutex.unlock();
+
+  EXPECT_EQ(GetMetric(mutex.metrics(), kAcquisitions), 1u);
+  EXPECT_EQ(GetMetric(mutex.metrics(), kContentions), 0u);
+}
+
+TEST(InstrumentedMutex, TryLock_CountsAcquisition) {
+  InstrumentedMutex mutex(1);
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+  {
+    std::lock_guard lock(mutex);
+  }
+
+  EXPECT_EQ(GetMetric(mutex.metrics(), kAcquisitions), 2u);
+}
+
+TEST(InstrumentedMutex, Unlock_RecordsHoldTime) {
+  InstrumentedMutex mutex(1);
+  for (int i = 0; i < 3; ++i) {
+    std::lock_guard lock(mutex);
+  }
+
+  const metric::Distribution* hold_us = GetSummary(mutex.metrics(), kHoldUs);
+  ASSERT_NE(hold_us, nullptr);
+  EXPECT_EQ(hold_us->count(), 3u);
+
+  const metric::Distribution* wait_us = GetSummary(mutex.metrics(), kWaitUs);
+  ASSERT_NE(wait_us, nullptr);
+  EXPECT_EQ(wait_us->count(), 0u);
+}
+
+TEST(InstrumentedMutex, Macro_TokenizesName) {
+  static_mutex.lock();
+  static_mutex.unlock();
+
+  EXPECT_EQ(static_mutex.metrics().name(), kStaticMutex);
+  EXPECT_EQ(GetMetric(static_mutex.metrics(), kAcquisitions), 1u);
+}
+
+}  // namespace
+}  // namespace pw::sync
@@ -0,0 +1,95 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/yield_core.h"
+
+// The number of times AdaptiveMutex tries to take the lock, yielding the core
+// between attempts, before blocking. Spinning only helps when the holder can
+// run at the same time on another core, so single-core targets should set this
+// to 0.
+#ifndef PW_SYNC_ADAPTIVE_MUTEX_SPIN_COUNT
+#define PW_SYNC_ADAPTIVE_MUTEX_SPIN_COUNT 100
+#endif  // PW_SYNC_ADAPTIVE_MUTEX_SPIN_COUNT
+
+namespace pw::sync {
+
+// A Mutex that spins briefly before blocking.
+//
+// Blocking on a Mutex costs at least two context switches, which for very short
+// critical sections, such as pushing to a ring buffer or updating a counter, is
+// far longer than the critical section itself. On SMP targets, the holder of
+// such a lock is likely to release it within a few hundred cycles, so lock()
+// first retries try_lock() up to spin_count times, yielding the core between
+// attempts, and only then blocks on the underlying Mutex.
+//
+// AdaptiveMutex works with any Mutex backend. Like Mutex, it is thread safe but
+// NOT IRQ safe. Use a plain Mutex for long critical sections, where spinning
+// only wastes cycles, and on single-core targets, where the holder cannot run
+// while another thread spins.
+class PW_LOCKABLE("pw::sync::AdaptiveMutex") AdaptiveMutex {
+ public:
+  explicit AdaptiveMutex(
+      uint32_t spin_count = PW_SYNC_ADAPTIVE_MUTEX_SPIN_COUNT)
+      : spin_count_(spin_count) {}
+
+  AdaptiveMutex(const AdaptiveMutex&) = delete;
+  AdaptiveMutex(AdaptiveMutex&&) = delete;
+  AdaptiveMutex& operator=(const AdaptiveMutex&) = delete;
+  AdaptiveMutex& operator=(AdaptiveMutex&&) = delete;
+
+  // Locks the mutex, spinning up to spin_count times and then blocking
+  // indefinitely. Failures are fatal.
+  //
+  // PRECONDITION:
+  //   The lock isn't already held by this thread. Recursive locking is
+  //   undefined behavior.
+  void lock() PW_EXCLUSIVE_LOCK_FUNCTION() {
+    for (uint32_t i = 0; i < spin_count_; ++i) {
+      if (mutex_.try_lock()) {
+        return;
+      }
+      PW_SYNC_YIELD_CORE_FOR_SMT();
+    }
+    mutex_.lock();
+  }
+
+  // Attempts to lock the mutex in a non-blocking manner, without spinning.
+  // Returns true if the mutex was successfully acquired.
+  //
+  // PRECONDITION:
+  //   The lock isn't already held by this thread. Recursive locking is
+  //   undefined behavior.
+  bool try_lock() PW_EXCLUSIVE_TRYLOCK_FUNCTION(true) {
+    return mutex_.try_lock();
+  }
+
+  // Unlocks the mutex. Failures are fatal.
+  //
+  // PRECONDITION:
+  //   The mutex is held by this thread.
+  void unlock() PW_UNLOCK_FUNCTION() { mutex_.unlock(); }
+
+  uint32_t spin_count() const { return spin_count_; }
+
+ private:
+  Mutex mutex_;
+  const uint32_t spin_count_;
+};
+
+}  // namespace pw::sync
@@ -0,0 +1,93 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_sync/shared_mutex.h"
+
+namespace pw::sync {
+
+inline SharedMutex::SharedMutex() : native_type_{} {
+  native_type_.readers = 0;
+  native_type_.room_empty.release();
+}
+
+inline SharedMutex::~SharedMutex() {}
+
+// The turnstile is held from lock() to unlock(), so the lock analysis, which
+// only tracks the SharedMutex itself, is disabled for these functions.
+PW_NO_LOCK_SAFETY_ANALYSIS inline void SharedMutex::lock() {
+  native_type_.turnstile.lock();
+  native_type_.room_empty.acquire();
+}
+
+PW_NO_LOCK_SAFETY_ANALYSIS inline bool SharedMutex::try_lock() {
+  if (!native_type_.turnstile.try_lock()) {
+    return false;
+  }
+  if (!native_type_.room_empty.try_acquire()) {
+    native_type_.turnstile.unlock();
+    return false;
+  }
+  return true;
+}
+
+PW_NO_LOCK_SAFETY_ANALYSIS inline void SharedMutex::unlock() {
+  native_type_.room_empty.release();
+  native_type_.turnstile.unlock();
+}
+
+PW_NO_LOCK_SAFETY_ANALYSIS inline void SharedMutex::lock_shared() {
+  native_type_.turnstile.lock();
+  native_type_.turnstile.unlock();
+
+  native_type_.readers_mutex.lock();
+  if (native_type_.readers == 0u) {
+    native_type_.room_empty.acquire();
+  }
+  native_type_.readers += 1;
+  native_type_.readers_mutex.unlock();
+}
+
+PW_NO_LOCK_SAFETY_ANALYSIS inline bool SharedMutex::try_lock_shared() {
+  if (!native_type_.turnstile.try_lock()) {
+    return false;
+  }
+  native_type_.turnstile.unlock();
+
+  if (!native_type_.readers_mutex.try_lock()) {
+    return false;
+  }
+  const bool acquired = native_type_.readers != 0u ||
+                        native_type_.room_empty.try_acquire();
+  if (acquired) {
+    native_type_.readers += 1;
+  }
+  native_type_.readers_mutex.unlock();
+  return acquired;
+}
+
+PW_NO_LOCK_SAFETY_ANALYSIS inline void SharedMutex::unlock_shared() {
+  native_type_.readers_mutex.lock();
+  native_type_.readers -= 1;
+  if (native_type_.readers == 0u) {
+    native_type_.room_empty.release();
+  }
+  native_type_.readers_mutex.unlock();
+}
+
+inline SharedMutex::native_handle_type SharedMutex::native_handle() {
+  return native_type_;
+}
+
+}  // namespace pw::sync
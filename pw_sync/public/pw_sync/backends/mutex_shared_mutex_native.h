@@ -0,0 +1,40 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+
+#include "pw_sync/binary_semaphore.h"
+#include "pw_sync/mutex.h"
+
+namespace pw::sync::backend {
+
+// A shared mutex built from a Mutex and a BinarySemaphore, for RTOSes with no
+// native reader-writer lock, such as FreeRTOS, ThreadX, and embOS.
+//
+// The first reader in takes room_empty on behalf of all readers and the last
+// reader out gives it back, so it must be a semaphore, which has no owner. A
+// writer holds the turnstile while it waits for and holds room_empty; readers
+// pass through the turnstile before entering, so a waiting writer blocks new
+// readers and cannot be starved.
+struct NativeSharedMutex {
+  Mutex turnstile;
+  Mutex readers_mutex;
+  BinarySemaphore room_empty;
+  size_t readers;
+};
+
+using NativeSharedMutexHandle = NativeSharedMutex&;
+
+}  // namespace pw::sync::backend
@@ -0,0 +1,139 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_preprocessor/util.h"
+
+#ifdef __cplusplus
+
+#include "pw_sync_backend/event_flags_native.h"
+
+namespace pw::sync {
+
+// EventFlags is a set of flags which threads and interrupts set to signal
+// events, and which a thread can block on until any of several events occur.
+// This lets one thread serve many event sources, such as RPC requests, flash
+// completions, and timers, without polling or a thread per source.
+//
+// Waiting for flags consumes them: the flags that woke the waiter are cleared
+// when the wait returns, and are returned to the waiter. Flags that are set
+// again before they are consumed are only reported once, so like a
+// ThreadNotification, a flag should signal that there is work to check for
+// rather than count events. Only one thread should wait on each flag.
+//
+// Only the flags in all_flags() may be used; some backends reserve the rest.
+//
+// The entire API is thread safe, but only a subset is IRQ safe.
+//
+// WARNING: In order to support global statically constructed EventFlags, the
+// user and/or backend MUST ensure that any initialization required in your
+// environment is done prior to the creation and/or initialization of the
+// native synchronization primitives (e.g. kernel initialization).
+class EventFlags {
+ public:
+  using flags_type = uint32_t;
+  using native_handle_type = backend::NativeEventFlagsHandle;
+
+  EventFlags();
+  ~EventFlags();
+  EventFlags(const EventFlags&) = delete;
+  EventFlags(EventFlags&&) = delete;
+  EventFlags& operator=(const EventFlags&) = delete;
+  EventFlags& operator=(EventFlags&&) = delete;
+
+  // Sets the flags, unblocking a thread waiting for any of them.
+  // This is IRQ safe.
+  //
+  // PRECONDITION:
+  //   (flags & ~all_flags()) == 0
+  void set(flags_type flags);
+
+  // Clears the flags without waiting for them.
+  // This is thread safe.
+  void clear(flags_type flags);
+
+  // Blocks indefinitely until any of the flags in mask are set, then clears
+  // and returns the flags in mask which were set.
+  // This is thread safe.
+  //
+  // PRECONDITION:
+  //   mask != 0 && (mask & ~all_flags()) == 0
+  flags_type wait_any(flags_type mask);
+
+  // Clears and returns the flags in mask which are set, without blocking.
+  // Returns 0 if none are set.
+  // This is thread safe.
+  flags_type try_wait_any(flags_type mask);
+
+  // Blocks for at least the specified duration until any of the flags in mask
+  // are set, then clears and returns the flags in mask which were set. Returns
+  // 0 if none were set before the timeout.
+  // This is thread safe.
+  flags_type try_wait_any_for(flags_type mask,
+                              chrono::SystemClock::duration for_at_least);
+
+  // Blocks until at least the specified time point until any of the flags in
+  // mask are set, then clears and returns the flags in mask which were set.
+  // Returns 0 if none were set before the deadline.
+  // This is thread safe.
+  flags_type try_wait_any_until(
+      flags_type mask, chrono::SystemClock::time_point until_at_least);
+
+  // The flags that the backend supports.
+  static constexpr flags_type all_flags() noexcept {
+    return backend::kEventFlagsAllFlags;
+  }
+
+  native_handle_type native_handle();
+
+ private:
+  // This may be a wrapper around a native type with additional members.
+  backend::NativeEventFlags native_type_;
+};
+
+}  // namespace pw::sync
+
+#include "pw_sync_backend/event_flags_inline.h"
+
+using pw_sync_EventFlags = pw::sync::EventFlags;
+
+#else  // !defined(__cplusplus)
+
+typedef struct pw_sync_EventFlags pw_sync_EventFlags;
+
+#endif  // __cplusplus
+
+PW_EXTERN_C_START
+
+void pw_sync_EventFlags_Set(pw_sync_EventFlags* event_flags, uint32_t flags);
+void pw_sync_EventFlags_Clear(pw_sync_EventFlags* event_flags, uint32_t flags);
+uint32_t pw_sync_EventFlags_WaitAny(pw_sync_EventFlags* event_flags,
+                                    uint32_t mask);
+uint32_t pw_sync_EventFlags_TryWaitAny(pw_sync_EventFlags* event_flags,
+                                       uint32_t mask);
+uint32_t pw_sync_EventFlags_TryWaitAnyFor(
+    pw_sync_EventFlags* event_flags,
+    uint32_t mask,
+    pw_chrono_SystemClock_Duration for_at_least);
+uint32_t pw_sync_EventFlags_TryWaitAnyUntil(
+    pw_sync_EventFlags* event_flags,
+    uint32_t mask,
+    pw_chrono_SystemClock_TimePoint until_at_least);
+uint32_t pw_sync_EventFlags_AllFlags(void);
+
+PW_EXTERN_C_END
@@ -0,0 +1,115 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_metric/metric.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+#include "pw_tokenizer/tokenize.h"
+
+// Whether InstrumentedMutex records lock metrics. Set with the
+// pw_sync_ENABLE_LOCK_PROFILING build arg. When disabled, an InstrumentedMutex
+// is a Mutex plus an empty metric group.
+#ifndef PW_SYNC_LOCK_PROFILING
+#define PW_SYNC_LOCK_PROFILING 0
+#endif  // PW_SYNC_LOCK_PROFILING
+
+namespace pw::sync {
+
+// A Mutex that records how often and for how long it is contended, to find
+// lock hot spots on devices. Each InstrumentedMutex has a metric group named
+// after the lock, with these metrics:
+//
+//   acquisitions - Number of times the lock was taken.
+//   contentions - Number of times lock() found the lock held and blocked.
+//   wait_us - Summary of how long each contended lock() blocked.
+//   hold_us - Summary of how long the lock was held each time.
+//
+// The summaries record the count, sum, min, and max of their samples, so they
+// give the total and max wait and hold times. Times are measured with
+// pw::chrono::SystemClock and truncated to microseconds. The metrics are only
+// updated while the mutex is held, so they need no lock of their own.
+//
+// Declare InstrumentedMutexes with PW_SYNC_INSTRUMENTED_MUTEX, which tokenizes
+// the name, and add their groups to a parent group to report them:
+//
+//   PW_SYNC_INSTRUMENTED_MUTEX(uart_tx_mutex, "uart_tx");
+//
+//   void RegisterLockMetrics(pw::metric::Group& parent) {
+//     parent.Add(uart_tx_mutex.metrics());
+//   }
+//
+class PW_LOCKABLE("pw::sync::InstrumentedMutex") InstrumentedMutex {
+ public:
+  explicit InstrumentedMutex(metric::Token name) : metrics_(name) {}
+
+  InstrumentedMutex(const InstrumentedMutex&) = delete;
+  InstrumentedMutex(InstrumentedMutex&&) = delete;
+  InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+  InstrumentedMutex& operator=(InstrumentedMutex&&) = delete;
+
+  // Locks the mutex, blocking indefinitely. Failures are fatal.
+  //
+  // PRECONDITION:
+  //   The lock isn't already held by this thread. Recursive locking is
+  //   undefined behavior.
+  void lock() PW_EXCLUSIVE_LOCK_FUNCTION();
+
+  // Attempts to lock the mutex in a non-blocking manner.
+  // Returns true if the mutex was successfully acquired.
+  //
+  // PRECONDITION:
+  //   The lock isn't already held by this thread. Recursive locking is
+  //   undefined behavior.
+  bool try_lock() PW_EXCLUSIVE_TRYLOCK_FUNCTION(true);
+
+  // Unlocks the mutex. Failures are fatal.
+  //
+  // PRECONDITION:
+  //   The mutex is held by this thread.
+  void unlock() PW_UNLOCK_FUNCTION();
+
+  metric::Group& metrics() { return metrics_; }
+  const metric::Group& metrics() const { return metrics_; }
+
+ private:
+  Mutex mutex_;
+  metric::Group metrics_;
+
+#if PW_SYNC_LOCK_PROFILING
+  void Acquired(chrono::SystemClock::time_point now) {
+    acquired_at_ = now;
+    acquisitions_.Increment();
+  }
+
+  PW_METRIC(metrics_, acquisitions_, "acquisitions", 0u);
+  PW_METRIC(metrics_, contentions_, "contentions", 0u);
+  PW_METRIC_SUMMARY(metrics_, wait_us_, "wait_us");
+  PW_METRIC_SUMMARY(metrics_, hold_us_, "hold_us");
+
+  chrono::SystemClock::time_point acquired_at_;
+#endif  // PW_SYNC_LOCK_PROFILING
+};
+
+}  // namespace pw::sync
+
+// Declares an InstrumentedMutex with a tokenized name. Works at global and
+// member scope.
+#define PW_SYNC_INSTRUMENTED_MUTEX(variable_name, lock_name)                \
+  static constexpr uint32_t variable_name##_token =                         \
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, lock_name); \
+  ::pw::sync::InstrumentedMutex variable_name { variable_name##_token }
@@ -0,0 +1,107 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace pw::sync {
+
+// A SeqLock holds a small, trivially copyable value, such as a timestamp or a
+// set of counters, that is read far more often than it is written. Readers take
+// no lock and never block the writer: a read copies the value and then checks a
+// sequence number, which the writer makes odd for the duration of each write,
+// and retries if the value was being written.
+//
+// Writes must be serialized, either by having a single writer or by holding a
+// lock around Write(). Since a reader retries until it sees a complete write,
+// Read() must not be called from a context that preempts the writer, such as an
+// interrupt handler when a thread writes, or it never returns. Use TryRead() in
+// such contexts.
+//
+// The value is stored as relaxed atomic words, so concurrent reads and writes
+// are well-defined.
+template <typename T>
+class SeqLock {
+ public:
+  static_assert(std::is_trivially_copyable_v<T>,
+                "SeqLock values are copied byte by byte, so they must be "
+                "trivially copyable");
+
+  constexpr SeqLock() : sequence_(0), words_{} {}
+
+  explicit SeqLock(const T& value) : SeqLock() { Store(value); }
+
+  SeqLock(const SeqLock&) = delete;
+  SeqLock& operator=(const SeqLock&) = delete;
+
+  // Replaces the value. Writes must not run concurrently with each other.
+  void Write(const T& value) {
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    Store(value);
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  // Returns the value, retrying while a write is in progress.
+  T Read() const {
+    T value;
+    while (!TryRead(value)) {
+    }
+    return value;
+  }
+
+  // Copies the value to value and returns true, or returns false if a write
+  // was in progress, in which case value is unspecified.
+  bool TryRead(T& value) const {
+    const uint32_t before = sequence_.load(std::memory_order_acquire);
+    if (before % 2u != 0u) {
+      return false;
+    }
+
+    uint32_t words[kWords];
+    for (size_t i = 0; i < kWords; ++i) {
+      words[i] = words_[i].load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence_.load(std::memory_order_relaxed) != before) {
+      return false;
+    }
+
+    std::memcpy(&value, words, sizeof(T));
+    return true;
+  }
+
+ private:
+  static constexpr size_t kWords =
+      (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+  void Store(const T& value) {
+    uint32_t words[kWords] = {};
+    std::memcpy(words, &value, sizeof(T));
+    for (size_t i = 0; i < kWords; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic<uint32_t> sequence_;
+  std::atomic<uint32_t> words_[kWords];
+};
+
+}  // namespace pw::sync
@@ -0,0 +1,78 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/seqlock.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw::sync {
+namespace {
+
+struct TimeSync {
+  uint64_t local_ticks;
+  uint64_t remote_ticks;
+  uint16_t drift_ppm;
+};
+
+bool operator==(const TimeSync& lhs, const TimeSync& rhs) {
+  return lhs.local_ticks == rhs.local_ticks &&
+         lhs.remote_ticks == rhs.remote_ticks &&
+         lhs.drift_ppm == rhs.drift_ppm;
+}
+
+TEST(SeqLock, DefaultConstructed_ReadsZero) {
+  SeqLock<uint32_t> lock;
+  EXPECT_EQ(lock.Read(), 0u);
+}
+
+TEST(SeqLock, InitialValue) {
+  SeqLock<uint32_t> lock(0xfeedf00d);
+  EXPECT_EQ(lock.Read(), 0xfeedf00du);
+}
+
+TEST(SeqLock, Write_Read) {
+  SeqLock<TimeSync> lock;
+  constexpr TimeSync kValue = {1234567890123, 987654321, 42};
+
+  lock.Write(kValue);
+  EXPECT_EQ(lock.Read(), kValue);
+}
+
+TEST(SeqLock, ValueSmallerThanWord) {
+  SeqLock<uint8_t> lock;
+  lock.Write(0xab);
+  lock.Write(0xcd);
+
+  uint8_t value = 0;
+  ASSERT_TRUE(lock.TryRead(value));
+  EXPECT_EQ(value, 0xcd);
+}
+
+TEST(SeqLock, TryRead_NoWriteInProgress_Succeeds) {
+  SeqLock<uint64_t> lock(UINT64_MAX);
+  uint64_t value = 0;
+  ASSERT_TRUE(lock.TryRead(value));
+  EXPECT_EQ(value, UINT64_MAX);
+}
+
+SeqLock<TimeSync> static_lock;
+TEST(SeqLock, Static) {
+  static_lock.Write({1, 2, 3});
+  EXPECT_EQ(static_lock.Read().remote_ticks, 2u);
+}
+
+}  // namespace
+}  // namespace pw::sync
@@ -0,0 +1,140 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "pw_assert/assert.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/yield_core.h"
+
+namespace pw::sync {
+namespace backend {
+
+// Masks interrupts on the calling core and returns the previous mask. Other
+// cores are not affected; they are excluded by the ticket lock.
+#if defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+
+// Returns a nonzero ID for the calling core, or 0 if it is not known. Cortex-M
+// has no architectural core ID, so multicore targets define
+// PW_SYNC_BAREMETAL_CORE_ID() to read their vendor's core ID register and
+// return a nonzero ID for each core.
+inline uintptr_t CurrentCoreId() {
+#ifdef PW_SYNC_BAREMETAL_CORE_ID
+  return PW_SYNC_BAREMETAL_CORE_ID();
+#else
+  return 0;
+#endif  // PW_SYNC_BAREMETAL_CORE_ID
+}
+
+inline uint32_t DisableLocalInterrupts() {
+  uint32_t primask;
+  asm volatile(
+      "mrs %0, primask\n"
+      "cpsid i"
+      : "=r"(primask)
+      :
+      : "memory");
+  return primask;
+}
+
+inline void RestoreLocalInterrupts(uint32_t primask) {
+  asm volatile("msr primask, %0" : : "r"(primask) : "memory");
+}
+
+#elif defined(__unix__) || defined(__APPLE__) || defined(_WIN32)
+
+// Host processes have no interrupts to mask. The lock is still exercised by
+// threads, which stand in for cores in host tests and benchmarks, so each
+// thread is identified by the address of a thread-local variable.
+inline uintptr_t CurrentCoreId() {
+  static thread_local char core;
+  return reinterpret_cast<uintptr_t>(&core);
+}
+
+inline uint32_t DisableLocalInterrupts() { return 0; }
+inline void RestoreLocalInterrupts(uint32_t) {}
+
+#else
+#error "No local interrupt masking for this architecture."
+#endif  // defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+
+}  // namespace backend
+
+constexpr InterruptSpinLock::InterruptSpinLock() : native_type_() {}
+
+inline void InterruptSpinLock::lock() {
+  const uint32_t interrupt_state = backend::DisableLocalInterrupts();
+
+  // A core that locks the lock it holds would wait for itself forever, so
+  // crash instead.
+  const uintptr_t core = backend::CurrentCoreId();
+  PW_DASSERT(core == 0u ||
+             native_type_.holder.load(std::memory_order_relaxed) != core);
+
+  const uint32_t ticket =
+      native_type_.next_ticket.fetch_add(1, std::memory_order_relaxed);
+
+  while (true) {
+    const uint32_t serving =
+        native_type_.now_serving.load(std::memory_order_acquire);
+    if (serving == ticket) {
+      break;
+    }
+    // Back off in proportion to the number of cores ahead in line, so waiters
+    // do not all read the lock's cache line each time it changes hands.
+    for (uint32_t ahead = ticket - serving; ahead != 0u; --ahead) {
+      PW_SYNC_YIELD_CORE_FOR_SMT();
+    }
+  }
+  native_type_.saved_interrupt_state = interrupt_state;
+  native_type_.holder.store(core, std::memory_order_relaxed);
+}
+
+inline bool InterruptSpinLock::try_lock() {
+  const uint32_t interrupt_state = backend::DisableLocalInterrupts();
+
+  // The lock is free if no tickets are waiting to be served. Taking the ticket
+  // only succeeds if no other core took one since now_serving was read.
+  uint32_t serving = native_type_.now_serving.load(std::memory_order_acquire);
+  if (native_type_.next_ticket.compare_exchange_strong(
+          serving, serving + 1, std::memory_order_relaxed)) {
+    native_type_.saved_interrupt_state = interrupt_state;
+    native_type_.holder.store(backend::CurrentCoreId(),
+                              std::memory_order_relaxed);
+    return true;
+  }
+
+  backend::RestoreLocalInterrupts(interrupt_state);
+  return false;
+}
+
+inline void InterruptSpinLock::unlock() {
+  const uint32_t interrupt_state = native_type_.saved_interrupt_state;
+  native_type_.holder.store(0, std::memory_order_relaxed);
+
+  // Only the holder writes now_serving, so no read-modify-write is needed.
+  native_type_.now_serving.store(
+      native_type_.now_serving.load(std::memory_order_relaxed) + 1,
+      std::memory_order_release);
+  backend::RestoreLocalInterrupts(interrupt_state);
+}
+
+inline InterruptSpinLock::native_handle_type
+InterruptSpinLock::native_handle() {
+  return native_type_;
+}
+
+}  // namespace pw::sync
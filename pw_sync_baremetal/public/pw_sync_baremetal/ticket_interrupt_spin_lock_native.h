@@ -0,0 +1,38 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace pw::sync::backend {
+
+// A ticket lock: each core that locks takes the next ticket and waits until
+// the lock serves that ticket, so cores acquire the lock in the order they
+// asked for it.
+struct NativeTicketInterruptSpinLock {
+  std::atomic<uint32_t> next_ticket{0};
+  std::atomic<uint32_t> now_serving{0};
+
+  // The interrupt mask of the core that holds the lock, from before it locked.
+  uint32_t saved_interrupt_state = 0;
+
+  // The ID of the core that holds the lock, or 0. Used to detect recursion.
+  std::atomic<uintptr_t> holder{0};
+};
+
+using NativeInterruptSpinLock = NativeTicketInterruptSpinLock;
+using NativeInterruptSpinLockHandle = NativeTicketInterruptSpinLock&;
+
+}  // namespace pw::sync::backend
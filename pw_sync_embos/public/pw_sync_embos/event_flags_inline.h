@@ -0,0 +1,64 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "RTOS.h"
+#include "pw_assert/assert.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_interrupt/context.h"
+#include "pw_sync/event_flags.h"
+
+namespace pw::sync {
+
+inline EventFlags::EventFlags() : native_type_() {
+  // In auto reset mode, the flags that satisfy a wait are cleared when it
+  // returns.
+  OS_EVENT_CreateEx(&native_type_,
+                    OS_EVENT_RESET_MODE_AUTO | OS_EVENT_MASK_MODE_OR_LOGIC);
+}
+
+inline EventFlags::~EventFlags() { OS_EVENT_Delete(&native_type_); }
+
+inline void EventFlags::set(flags_type flags) {
+  OS_EVENT_SetMask(&native_type_, static_cast<OS_TASKEVENT>(flags));
+}
+
+inline void EventFlags::clear(flags_type flags) {
+  // Getting the flags clears them.
+  OS_EVENT_GetMask(&native_type_, static_cast<OS_TASKEVENT>(flags));
+}
+
+inline EventFlags::flags_type EventFlags::wait_any(flags_type mask) {
+  PW_ASSERT(!interrupt::InInterruptContext());
+  return static_cast<flags_type>(
+      OS_EVENT_WaitMask(&native_type_, static_cast<OS_TASKEVENT>(mask)));
+}
+
+inline EventFlags::flags_type EventFlags::try_wait_any(flags_type mask) {
+  return static_cast<flags_type>(
+      OS_EVENT_GetMask(&native_type_, static_cast<OS_TASKEVENT>(mask)));
+}
+
+inline EventFlags::flags_type EventFlags::try_wait_any_until(
+    flags_type mask, chrono::SystemClock::time_point until_at_least) {
+  // Note that if this deadline is in the future, it will get rounded up by
+  // one whole tick due to how try_wait_any_for is implemented.
+  return try_wait_any_for(mask, until_at_least - chrono::SystemClock::now());
+}
+
+inline EventFlags::native_handle_type EventFlags::native_handle() {
+  return native_type_;
+}
+
+}  // namespace pw::sync
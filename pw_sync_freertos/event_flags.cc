@@ -0,0 +1,108 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/event_flags.h"
+
+#include "FreeRTOS.h"
+#include "event_groups.h"
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_chrono_freertos/system_clock_constants.h"
+#include "pw_interrupt/context.h"
+
+using pw::chrono::SystemClock;
+
+namespace pw::sync {
+namespace {
+
+static_assert(configSUPPORT_STATIC_ALLOCATION != 0,
+              "FreeRTOS static allocations are required for this backend.");
+
+// Event group bits set from interrupts are set later by the timer daemon task.
+static_assert(configUSE_TIMERS != 0 && INCLUDE_xTimerPendFunctionCall != 0,
+              "FreeRTOS timers and xTimerPendFunctionCall() are required to "
+              "set event flags from interrupts.");
+
+// Waits for any of the flags in mask, then clears and returns those that are
+// set.
+EventFlags::flags_type WaitAnyTicks(EventGroupHandle_t handle,
+                                    EventFlags::flags_type mask,
+                                    TickType_t ticks) {
+  return xEventGroupWaitBits(handle,
+                             mask,
+                             /*xClearOnExit=*/pdTRUE,
+                             /*xWaitForAllBits=*/pdFALSE,
+                             ticks) &
+         mask;
+}
+
+}  // namespace
+
+void EventFlags::set(flags_type flags) {
+  PW_DCHECK_UINT_EQ(flags & ~all_flags(), 0u, "Reserved event flags set.");
+  if (interrupt::InInterruptContext()) {
+    BaseType_t woke_higher_task = pdFALSE;
+    const BaseType_t result = xEventGroupSetBitsFromISR(
+        native_type_.handle, flags, &woke_higher_task);
+    PW_CHECK_UINT_EQ(result, pdPASS, "The timer command queue is full.");
+    portYIELD_FROM_ISR(woke_higher_task);
+  } else {  // Task context
+    xEventGroupSetBits(native_type_.handle, flags);
+  }
+}
+
+EventFlags::flags_type EventFlags::wait_any(flags_type mask) {
+  PW_DCHECK(!interrupt::InInterruptContext());
+  PW_DCHECK_UINT_NE(mask, 0u);
+  PW_DCHECK_UINT_EQ(mask & ~all_flags(), 0u, "Reserved event flags used.");
+
+  // portMAX_DELAY is only indefinite with INCLUDE_vTaskSuspend, so wait until
+  // the flags are set in either case.
+  flags_type flags = 0;
+  while (flags == 0) {
+    flags = WaitAnyTicks(native_type_.handle, mask, portMAX_DELAY);
+  }
+  return flags;
+}
+
+EventFlags::flags_type EventFlags::try_wait_any_for(
+    flags_type mask, SystemClock::duration for_at_least) {
+  PW_DCHECK(!interrupt::InInterruptContext());
+  PW_DCHECK_UINT_NE(mask, 0u);
+
+  // Use non-blocking try_wait_any for negative and zero length durations.
+  if (for_at_least <= SystemClock::duration::zero()) {
+    return try_wait_any(mask);
+  }
+
+  // On a tick based kernel we cannot tell how far along we are on the current
+  // tick, ergo we add one whole tick to the final duration.
+  constexpr SystemClock::duration kMaxTimeoutMinusOne =
+      pw::chrono::freertos::kMaxTimeout - SystemClock::duration(1);
+  while (for_at_least > kMaxTimeoutMinusOne) {
+    const flags_type flags = WaitAnyTicks(
+        native_type_.handle,
+        mask,
+        static_cast<TickType_t>(kMaxTimeoutMinusOne.count()));
+    if (flags != 0) {
+      return flags;
+    }
+    for_at_least -= kMaxTimeoutMinusOne;
+  }
+  return WaitAnyTicks(native_type_.handle,
+                      mask,
+                      static_cast<TickType_t>(for_at_least.count() + 1));
+}
+
+}  // namespace pw::sync
@@ -0,0 +1,34 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "FreeRTOS.h"
+#include "event_groups.h"
+
+namespace pw::sync::backend {
+
+struct NativeEventFlags {
+  StaticEventGroup_t buffer;
+  EventGroupHandle_t handle;
+};
+using NativeEventFlagsHandle = EventGroupHandle_t;
+
+// The top byte of an event group is reserved by the kernel, leaving 8 flags
+// with 16-bit ticks and 24 flags with 32-bit ticks.
+inline constexpr uint32_t kEventFlagsAllFlags =
+    configUSE_16_BIT_TICKS == 1 ? 0x000000FFu : 0x00FFFFFFu;
+
+}  // namespace pw::sync::backend
@@ -15,6 +15,7 @@
 #include "pw_sync/counting_semaphore.h"
 
 #include "pw_assert/check.h"
+#include "pw_chrono_stl/virtual_time.h"
 
 using pw::chrono::SystemClock;
 
@@ -48,8 +49,9 @@ bool CountingSemaphore::try_acquire() noexcept {
 bool CountingSemaphore::try_acquire_until(
     SystemClock::time_point until_at_least) {
   std::unique_lock lock(native_type_.mutex);
-  if (native_type_.condition.wait_until(
-          lock, until_at_least, [&] { return native_type_.count != 0; })) {
+  const auto available = [&] { return native_type_.count != 0; };
+  if (chrono::stl::WaitUntil(
+          native_type_.condition, lock, until_at_least, available)) {
     --native_type_.count;
     return true;
   }
@@ -0,0 +1,65 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/event_flags.h"
+
+#include "pw_assert/check.h"
+#include "pw_chrono_stl/virtual_time.h"
+
+using pw::chrono::SystemClock;
+
+namespace pw::sync {
+
+void EventFlags::set(flags_type flags) {
+  std::lock_guard lock(native_type_.mutex);
+  native_type_.flags |= flags;
+  // Waiters may be waiting on different flags, so wake all of them.
+  native_type_.condition.notify_all();
+}
+
+void EventFlags::clear(flags_type flags) {
+  std::lock_guard lock(native_type_.mutex);
+  native_type_.flags &= ~flags;
+}
+
+EventFlags::flags_type EventFlags::wait_any(flags_type mask) {
+  PW_DCHECK_UINT_NE(mask, 0u);
+  std::unique_lock lock(native_type_.mutex);
+  native_type_.condition.wait(lock,
+                              [&] { return (native_type_.flags & mask) != 0; });
+  const flags_type flags = native_type_.flags & mask;
+  native_type_.flags &= ~flags;
+  return flags;
+}
+
+EventFlags::flags_type EventFlags::try_wait_any(flags_type mask) {
+  std::lock_guard lock(native_type_.mutex);
+  const flags_type flags = native_type_.flags & mask;
+  native_type_.flags &= ~flags;
+  return flags;
+}
+
+EventFlags::flags_type EventFlags::try_wait_any_until(
+    flags_type mask, SystemClock::time_point until_at_least) {
+  PW_DCHECK_UINT_NE(mask, 0u);
+  std::unique_lock lock(native_type_.mutex);
+  chrono::stl::WaitUntil(native_type_.condition, lock, until_at_least, [&] {
+    return (native_type_.flags & mask) != 0;
+  });
+  const flags_type flags = native_type_.flags & mask;
+  native_type_.flags &= ~flags;
+  return flags;
+}
+
+}  // namespace pw::sync
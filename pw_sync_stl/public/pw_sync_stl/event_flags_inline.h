@@ -0,0 +1,36 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_chrono/system_clock.h"
+#include "pw_sync/event_flags.h"
+
+namespace pw::sync {
+
+inline EventFlags::EventFlags()
+    : native_type_{.mutex = {}, .condition = {}, .flags = 0} {}
+
+inline EventFlags::~EventFlags() {}
+
+inline EventFlags::flags_type EventFlags::try_wait_any_for(
+    flags_type mask, chrono::SystemClock::duration for_at_least) {
+  // Due to spurious condition variable wakeups this cannot use wait_for().
+  return try_wait_any_until(mask, chrono::SystemClock::now() + for_at_least);
+}
+
+inline EventFlags::native_handle_type EventFlags::native_handle() {
+  return native_type_;
+}
+
+}  // namespace pw::sync
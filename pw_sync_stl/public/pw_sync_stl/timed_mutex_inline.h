@@ -14,17 +14,26 @@
 #pragma once
 
 #include "pw_chrono/system_clock.h"
+#include "pw_chrono_stl/virtual_time.h"
 #include "pw_sync/mutex.h"
 
 namespace pw::sync {
 
 inline bool TimedMutex::try_lock_for(
     chrono::SystemClock::duration for_at_least) {
+  if (chrono::stl::VirtualTime::active() != nullptr) {
+    return try_lock_until(chrono::SystemClock::now() + for_at_least);
+  }
   return native_handle().try_lock_for(for_at_least);
 }
 
 inline bool TimedMutex::try_lock_until(
     chrono::SystemClock::time_point until_at_least) {
+  if (chrono::stl::VirtualTime* virtual_time =
+          chrono::stl::VirtualTime::active();
+      virtual_time != nullptr) {
+    return virtual_time->TryLockUntil(native_handle(), until_at_least);
+  }
   return native_handle().try_lock_until(until_at_least);
 }
 
@@ -0,0 +1,69 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/event_flags.h"
+
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_chrono_threadx/system_clock_constants.h"
+#include "pw_interrupt/context.h"
+#include "tx_api.h"
+
+using pw::chrono::SystemClock;
+
+namespace pw::sync {
+
+EventFlags::flags_type EventFlags::try_wait_any_for(
+    flags_type mask, SystemClock::duration for_at_least) {
+  // Enforce the pw::sync::EventFlags IRQ contract.
+  PW_DCHECK(!interrupt::InInterruptContext());
+
+  // Use non-blocking try_wait_any for negative and zero length durations.
+  if (for_at_least <= SystemClock::duration::zero()) {
+    return try_wait_any(mask);
+  }
+
+  // On a tick based kernel we cannot tell how far along we are on the current
+  // tick, ergo we add one whole tick to the final duration.
+  constexpr SystemClock::duration kMaxTimeoutMinusOne =
+      pw::chrono::threadx::kMaxTimeout - SystemClock::duration(1);
+  ULONG actual_flags = 0;
+  while (for_at_least > kMaxTimeoutMinusOne) {
+    const UINT result =
+        tx_event_flags_get(&native_type_,
+                           mask,
+                           TX_OR_CLEAR,
+                           &actual_flags,
+                           static_cast<ULONG>(kMaxTimeoutMinusOne.count()));
+    if (result != TX_NO_EVENTS) {
+      // If we didn't time out (TX_NO_EVENTS), then we should have succeeded.
+      PW_CHECK_UINT_EQ(TX_SUCCESS, result);
+      return static_cast<flags_type>(actual_flags) & mask;
+    }
+    for_at_least -= kMaxTimeoutMinusOne;
+  }
+  const UINT result =
+      tx_event_flags_get(&native_type_,
+                         mask,
+                         TX_OR_CLEAR,
+                         &actual_flags,
+                         static_cast<ULONG>(for_at_least.count() + 1));
+  if (result == TX_NO_EVENTS) {
+    return 0;  // We timed out, none of the flags were set.
+  }
+  PW_CHECK_UINT_EQ(TX_SUCCESS, result);
+  return static_cast<flags_type>(actual_flags) & mask;
+}
+
+}  // namespace pw::sync
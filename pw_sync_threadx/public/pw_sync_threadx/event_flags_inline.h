@@ -0,0 +1,81 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_assert/assert.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_interrupt/context.h"
+#include "pw_sync/event_flags.h"
+#include "tx_api.h"
+
+namespace pw::sync {
+namespace backend {
+
+inline constexpr char kEventFlagsName[] = "pw::EventFlags";
+
+}  // namespace backend
+
+inline EventFlags::EventFlags() : native_type_() {
+  PW_ASSERT(tx_event_flags_create(
+                &native_type_, const_cast<char*>(backend::kEventFlagsName)) ==
+            TX_SUCCESS);
+}
+
+inline EventFlags::~EventFlags() {
+  PW_ASSERT(tx_event_flags_delete(&native_type_) == TX_SUCCESS);
+}
+
+inline void EventFlags::set(flags_type flags) {
+  PW_ASSERT(tx_event_flags_set(&native_type_, flags, TX_OR) == TX_SUCCESS);
+}
+
+inline void EventFlags::clear(flags_type flags) {
+  PW_ASSERT(tx_event_flags_set(&native_type_, ~flags, TX_AND) == TX_SUCCESS);
+}
+
+inline EventFlags::flags_type EventFlags::wait_any(flags_type mask) {
+  // Enforce the pw::sync::EventFlags IRQ contract.
+  PW_DASSERT(!interrupt::InInterruptContext());
+  ULONG actual_flags = 0;
+  PW_ASSERT(tx_event_flags_get(&native_type_,
+                               mask,
+                               TX_OR_CLEAR,
+                               &actual_flags,
+                               TX_WAIT_FOREVER) == TX_SUCCESS);
+  return static_cast<flags_type>(actual_flags) & mask;
+}
+
+inline EventFlags::flags_type EventFlags::try_wait_any(flags_type mask) {
+  ULONG actual_flags = 0;
+  const UINT result = tx_event_flags_get(
+      &native_type_, mask, TX_OR_CLEAR, &actual_flags, TX_NO_WAIT);
+  if (result == TX_NO_EVENTS) {
+    return 0;
+  }
+  PW_ASSERT(result == TX_SUCCESS);
+  return static_cast<flags_type>(actual_flags) & mask;
+}
+
+inline EventFlags::flags_type EventFlags::try_wait_any_until(
+    flags_type mask, chrono::SystemClock::time_point until_at_least) {
+  // Note that if this deadline is in the future, it will get rounded up by
+  // one whole tick due to how try_wait_any_for is implemented.
+  return try_wait_any_for(mask, until_at_least - chrono::SystemClock::now());
+}
+
+inline EventFlags::native_handle_type EventFlags::native_handle() {
+  return native_type_;
+}
+
+}  // namespace pw::sync
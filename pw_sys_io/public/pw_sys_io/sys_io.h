@@ -85,10 +85,12 @@ Status WriteByte(std::byte b);
 StatusWithSize WriteLine(const std::string_view& s);
 
 // Fill a byte std::span from the sys io backend using ReadByte().
-// Implemented by: Facade
+// Implemented by: Facade, or Backend
 //
-// This function is implemented by this facade and simply uses ReadByte() to
-// read enough bytes to fill the destination span. If there's an error reading a
+// This function is implemented by this facade's default_putget_bytes library
+// and simply uses ReadByte() to read enough bytes to fill the destination span.
+// Backends that can transfer blocks of bytes more efficiently, such as with
+// DMA, may implement it instead. If there's an error reading a
 // byte, the read is aborted and the contents of the destination span are
 // undefined. This function blocks until either an error occurs, or all bytes
 // are successfully read from the backend's ReadByte() implementation.
@@ -99,10 +101,11 @@ StatusWithSize WriteLine(const std::string_view& s);
 StatusWithSize ReadBytes(std::span<std::byte> dest);
 
 // Write std::span of bytes out the sys io backend using WriteByte().
-// Implemented by: Facade
+// Implemented by: Facade, or Backend
 //
-// This function is implemented by this facade and simply writes the source
-// contents using WriteByte(). If an error writing a byte is encountered, the
+// This function is implemented by this facade's default_putget_bytes library
+// and simply writes the source contents using WriteByte(). Backends may
+// implement it instead, as with ReadBytes(). If an error writing a byte is encountered, the
 // write is aborted and the error status returned. This function blocks until
 // either an error occurs, or all bytes are successfully read from the backend's
 // WriteByte() implementation.
@@ -20,4 +20,9 @@ PW_EXTERN_C_START
 // The actual implement of PreMainInit() in sys_io_BACKEND.
 void pw_sys_io_Init();
 
+// Interrupt handlers for the DMA2 streams that read and write USART1. These
+// must be installed in the vector table for reads and writes to complete.
+void DMA2_Stream2_IRQHandler();
+void DMA2_Stream7_IRQHandler();
+
 PW_EXTERN_C_END
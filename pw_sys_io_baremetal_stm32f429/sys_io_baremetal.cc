@@ -13,6 +13,9 @@
 // the License.
 
 #include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <span>
 
 #include "pw_preprocessor/compiler.h"
 #include "pw_sys_io/sys_io.h"
@@ -43,6 +46,9 @@ PW_PACKED(struct) RccBlock {
 // Mask for ahb1_config (AHB1ENR) to enable the "A" GPIO pins.
 constexpr uint32_t kGpioAEnable = 0x1u;
 
+// Mask for ahb1_config (AHB1ENR) to enable DMA2.
+constexpr uint32_t kDma2Enable = 0x1u << 22;
+
 // Mask for apb2_config (APB2ENR) to enable USART1.
 constexpr uint32_t kUsart1Enable = 0x1u << 4;
 
@@ -93,6 +99,10 @@ constexpr uint32_t kTransmitEnable = 0x1 << 3;
 constexpr uint32_t kReadDataReady = 0x1u << 5;
 constexpr uint32_t kEnableUsart = 0x1 << 13;
 
+// USART configuration flags for config3 register.
+constexpr uint32_t kDmaReceiveEnable = 0x1u << 6;
+constexpr uint32_t kDmaTransmitEnable = 0x1u << 7;
+
 // Layout of memory mapped registers for USART blocks.
 PW_PACKED(struct) UsartBlock {
   uint32_t status;
@@ -105,6 +115,61 @@ PW_PACKED(struct) UsartBlock {
   uint32_t config4;
 };
 
+// Layout of memory mapped registers for one DMA stream.
+PW_PACKED(struct) DmaStreamBlock {
+  uint32_t config;
+  uint32_t count;
+  uint32_t peripheral_address;
+  uint32_t memory0_address;
+  uint32_t memory1_address;
+  uint32_t fifo_control;
+};
+
+// Layout of memory mapped registers for DMA controllers.
+PW_PACKED(struct) DmaBlock {
+  uint32_t low_status;
+  uint32_t high_status;
+  uint32_t low_flag_clear;
+  uint32_t high_flag_clear;
+  DmaStreamBlock stream[8];
+};
+
+// DMA stream configuration flags. Fields that are left zero select byte
+// transfers, a fixed peripheral address, and a normal (non-circular) transfer.
+constexpr uint32_t kDmaStreamEnable = 0x1u;
+constexpr uint32_t kDmaTransferErrorInterruptEnable = 0x1u << 2;
+constexpr uint32_t kDmaTransferCompleteInterruptEnable = 0x1u << 4;
+constexpr uint32_t kDmaPeripheralToMemory = 0x0u << 6;
+constexpr uint32_t kDmaMemoryToPeripheral = 0x1u << 6;
+constexpr uint32_t kDmaMemoryIncrement = 0x1u << 10;
+constexpr uint32_t kDmaChannelPos = 25;
+
+// USART1 requests are DMA2 channel 4, on stream 2 for RX and stream 7 for TX.
+constexpr uint32_t kUsart1DmaChannel = 4;
+constexpr size_t kRxStream = 2;
+constexpr size_t kTxStream = 7;
+
+// Interrupt flags of a DMA stream, shifted into place in the status and flag
+// clear registers. Streams 2 and 7 are the third and fourth stream of the low
+// and high registers.
+constexpr uint32_t kDmaTransferError = 0x1u << 3;
+constexpr uint32_t kDmaTransferComplete = 0x1u << 5;
+constexpr uint32_t kDmaAllFlags = 0x3Du;
+constexpr uint32_t kRxStreamFlagsPos = 16;
+constexpr uint32_t kTxStreamFlagsPos = 22;
+
+// NVIC interrupt numbers of the DMA streams.
+constexpr uint32_t kRxStreamIrq = 58;
+constexpr uint32_t kTxStreamIrq = 70;
+
+// Transfers shorter than this are written by polling, since that finishes
+// before a DMA transfer could be set up.
+constexpr size_t kMinDmaWriteBytes = 8;
+
+// The core coupled memory cannot be reached by the DMA controllers.
+constexpr uintptr_t kCcmBegin = 0x10000000u;
+constexpr uintptr_t kCcmEnd = 0x10010000u;
+
 // Sets the UART baud register using the peripheral clock and target baud rate.
 // These calculations are specific to the default oversample by 16 mode.
 // TODO(amontanez): Document magic calculations in full UART implementation.
@@ -125,11 +190,107 @@ volatile GpioBlock& gpio_a =
     *reinterpret_cast<volatile GpioBlock*>(kAhb1PeripheralBase + 0x0000U);
 
 // Declare a reference to the memory mapped block for USART1.
+constexpr uint32_t kUsart1BaseAddr = kApb2PeripheralBase + 0x1000U;
 volatile UsartBlock& usart1 =
-    *reinterpret_cast<volatile UsartBlock*>(kApb2PeripheralBase + 0x1000U);
+    *reinterpret_cast<volatile UsartBlock*>(kUsart1BaseAddr);
+
+// The USART1 data register, which the DMA streams read and write.
+constexpr uint32_t kUsart1DataRegisterAddr =
+    kUsart1BaseAddr + offsetof(UsartBlock, data_register);
+
+// Declare a reference to the memory mapped block for DMA2.
+volatile DmaBlock& dma2 =
+    *reinterpret_cast<volatile DmaBlock*>(kAhb1PeripheralBase + 0x6400U);
+
+// Declare a reference to the NVIC interrupt set-enable registers.
+volatile uint32_t* const nvic_interrupt_set_enable =
+    reinterpret_cast<volatile uint32_t*>(0xE000E100U);
+
+// Set by the DMA interrupt handlers when a transfer ends.
+volatile bool rx_done;
+volatile bool rx_error;
+volatile bool tx_done;
+volatile bool tx_error;
+
+bool DmaCanAccess(const void* address) {
+  const uintptr_t value = reinterpret_cast<uintptr_t>(address);
+  return value < kCcmBegin || value >= kCcmEnd;
+}
+
+void EnableInterrupt(uint32_t irq) {
+  nvic_interrupt_set_enable[irq / 32] = 0x1u << (irq % 32);
+}
+
+// Sleeps until a DMA interrupt sets done. Interrupts are masked while done is
+// checked, so one that arrives just before WFI still wakes the core.
+void WaitFor(volatile bool& done) {
+  while (true) {
+    asm volatile("cpsid i" ::: "memory");
+    if (done) {
+      asm volatile("cpsie i" ::: "memory");
+      return;
+    }
+    asm volatile("wfi");
+    asm volatile("cpsie i" ::: "memory");
+  }
+}
+
+// Runs one DMA transfer between USART1 and memory on the RX or TX stream,
+// sleeping until it ends. Returns the number of bytes that were not
+// transferred.
+size_t Transfer(bool receive, uintptr_t memory_address, size_t size) {
+  const size_t index = receive ? kRxStream : kTxStream;
+  volatile bool& done = receive ? rx_done : tx_done;
+  volatile bool& error = receive ? rx_error : tx_error;
+
+  // A stream that was stopped by an error may still be disabling.
+  while (dma2.stream[index].config & kDmaStreamEnable) {
+  }
+  if (receive) {
+    dma2.low_flag_clear = kDmaAllFlags << kRxStreamFlagsPos;
+  } else {
+    dma2.high_flag_clear = kDmaAllFlags << kTxStreamFlagsPos;
+  }
+
+  done = false;
+  error = false;
+  dma2.stream[index].peripheral_address = kUsart1DataRegisterAddr;
+  dma2.stream[index].memory0_address = memory_address;
+  dma2.stream[index].count = size;
+  dma2.stream[index].config =
+      (kUsart1DmaChannel << kDmaChannelPos) |
+      (receive ? kDmaPeripheralToMemory : kDmaMemoryToPeripheral) |
+      kDmaMemoryIncrement | kDmaTransferCompleteInterruptEnable |
+      kDmaTransferErrorInterruptEnable | kDmaStreamEnable;
+
+  WaitFor(done);
+  return error ? dma2.stream[index].count : 0;
+}
+
+// Records the end of a transfer from a stream's interrupt flags.
+void HandleDmaFlags(uint32_t flags, volatile bool& done, volatile bool& error) {
+  if (flags & kDmaTransferError) {
+    error = true;
+    done = true;
+  } else if (flags & kDmaTransferComplete) {
+    done = true;
+  }
+}
 
 }  // namespace
 
+extern "C" void DMA2_Stream2_IRQHandler() {
+  const uint32_t flags = (dma2.low_status >> kRxStreamFlagsPos) & kDmaAllFlags;
+  dma2.low_flag_clear = flags << kRxStreamFlagsPos;
+  HandleDmaFlags(flags, rx_done, rx_error);
+}
+
+extern "C" void DMA2_Stream7_IRQHandler() {
+  const uint32_t flags = (dma2.high_status >> kTxStreamFlagsPos) & kDmaAllFlags;
+  dma2.high_flag_clear = flags << kTxStreamFlagsPos;
+  HandleDmaFlags(flags, tx_done, tx_error);
+}
+
 extern "C" void pw_sys_io_Init() {
   // Enable 'A' GIPO clocks.
   platform_rcc.ahb1_config |= kGpioAEnable;
@@ -157,24 +318,24 @@ extern "C" void pw_sys_io_Init() {
   usart1.baud_rate = CalcBaudRegister(kSystemCoreClock, /*target_baud=*/115200);
 
   usart1.config1 = kEnableUsart | kReceiveEnable | kTransmitEnable;
+
+  // Let DMA2 service USART1 for bulk reads and writes. The USART only requests
+  // a transfer while a DMA stream is enabled for it.
+  platform_rcc.ahb1_config |= kDma2Enable;
+  usart1.config3 = kDmaReceiveEnable | kDmaTransmitEnable;
+  EnableInterrupt(kRxStreamIrq);
+  EnableInterrupt(kTxStreamIrq);
 }
 
 namespace pw::sys_io {
 
-// Wait for a byte to read on USART1. This blocks until a byte is read. This is
-// extremely inefficient as it requires the target to burn CPU cycles polling to
-// see if a byte is ready yet.
+// Wait for a byte to read on USART1. This blocks until a byte is read, with the
+// core asleep if the byte can be read with DMA.
 Status ReadByte(std::byte* dest) {
-  while (true) {
-    if (TryReadByte(dest).ok()) {
-      return OkStatus();
-    }
-  }
+  return ReadBytes(std::span(dest, 1)).status();
 }
 
-// Wait for a byte to read on USART1. This blocks until a byte is read. This is
-// extremely inefficient as it requires the target to burn CPU cycles polling to
-// see if a byte is ready yet.
+// Read a byte from USART1 if one has been received.
 Status TryReadByte(std::byte* dest) {
   if (!(usart1.status & kReadDataReady)) {
     return Status::Unavailable();
@@ -196,6 +357,48 @@ Status WriteByte(std::byte b) {
   return OkStatus();
 }
 
+// Fill dest from USART1 with one DMA transfer. The core sleeps until the last
+// byte arrives, rather than polling for each one. A byte that was received
+// before the call is transferred first.
+StatusWithSize ReadBytes(std::span<std::byte> dest) {
+  if (dest.empty()) {
+    return StatusWithSize(0);
+  }
+
+  if (!DmaCanAccess(dest.data())) {
+    for (size_t i = 0; i < dest.size(); ++i) {
+      while (!TryReadByte(&dest[i]).ok()) {
+      }
+    }
+    return StatusWithSize(dest.size());
+  }
+
+  const size_t remaining = Transfer(
+      /*receive=*/true, reinterpret_cast<uintptr_t>(dest.data()), dest.size());
+  if (remaining != 0) {
+    return StatusWithSize::Internal(dest.size() - remaining);
+  }
+  return StatusWithSize(dest.size());
+}
+
+// Write src to USART1 with one DMA transfer, sleeping until the last byte has
+// been handed to the USART. Short writes are polled.
+StatusWithSize WriteBytes(std::span<const std::byte> src) {
+  if (src.size() < kMinDmaWriteBytes || !DmaCanAccess(src.data())) {
+    for (std::byte b : src) {
+      WriteByte(b);
+    }
+    return StatusWithSize(src.size());
+  }
+
+  const size_t remaining = Transfer(
+      /*receive=*/false, reinterpret_cast<uintptr_t>(src.data()), src.size());
+  if (remaining != 0) {
+    return StatusWithSize::Internal(src.size() - remaining);
+  }
+  return StatusWithSize(src.size());
+}
+
 // Writes a string using pw::sys_io, and add newline characters at the end.
 StatusWithSize WriteLine(const std::string_view& s) {
   size_t chars_written = 0;
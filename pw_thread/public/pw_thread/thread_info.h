@@ -0,0 +1,98 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace pw::thread {
+
+// A snapshot of a thread's stack and runtime, as reported by ForEachThread().
+//
+// Each backend fills in what its RTOS tracks; anything it does not track is
+// left empty. Addresses assume a stack that grows down, from stack_high_addr
+// towards stack_low_addr.
+class ThreadInfo {
+ public:
+  constexpr ThreadInfo() = default;
+
+  // The thread's name. This is not guaranteed to be null terminated.
+  std::optional<std::span<const std::byte>> thread_name() const {
+    return thread_name_;
+  }
+  void set_thread_name(std::span<const std::byte> name) { thread_name_ = name; }
+
+  // The lowest address of the stack, which it overflows past.
+  std::optional<uintptr_t> stack_low_addr() const { return stack_low_addr_; }
+  void set_stack_low_addr(uintptr_t addr) { stack_low_addr_ = addr; }
+
+  // The address the stack starts from.
+  std::optional<uintptr_t> stack_high_addr() const { return stack_high_addr_; }
+  void set_stack_high_addr(uintptr_t addr) { stack_high_addr_ = addr; }
+
+  // The stack pointer when the thread was last switched out.
+  std::optional<uintptr_t> stack_pointer() const { return stack_pointer_; }
+  void set_stack_pointer(uintptr_t addr) { stack_pointer_ = addr; }
+
+  // The deepest the stack pointer has been, as estimated by the RTOS (usually
+  // by scanning for the fill pattern the stack was painted with).
+  std::optional<uintptr_t> stack_peak_addr() const { return stack_peak_addr_; }
+  void set_stack_peak_addr(uintptr_t addr) { stack_peak_addr_ = addr; }
+
+  // The share of CPU time the thread has used since the RTOS started counting,
+  // in hundredths of a percent (e.g. 5.00% = 500).
+  std::optional<uint32_t> cpu_usage_hundredths() const {
+    return cpu_usage_hundredths_;
+  }
+  void set_cpu_usage_hundredths(uint32_t usage) {
+    cpu_usage_hundredths_ = usage;
+  }
+
+  // The size of the stack in bytes.
+  std::optional<size_t> stack_size_bytes() const {
+    if (!stack_low_addr_.has_value() || !stack_high_addr_.has_value()) {
+      return std::nullopt;
+    }
+    return *stack_high_addr_ - *stack_low_addr_;
+  }
+
+  // The most stack the thread has used, in bytes.
+  std::optional<size_t> stack_peak_bytes() const {
+    if (!stack_high_addr_.has_value() || !stack_peak_addr_.has_value()) {
+      return std::nullopt;
+    }
+    return *stack_high_addr_ - *stack_peak_addr_;
+  }
+
+  // The stack the thread has never touched, in bytes. This is the headroom
+  // that could be reclaimed by shrinking the stack.
+  std::optional<size_t> stack_unused_bytes() const {
+    if (!stack_low_addr_.has_value() || !stack_peak_addr_.has_value()) {
+      return std::nullopt;
+    }
+    return *stack_peak_addr_ - *stack_low_addr_;
+  }
+
+ private:
+  std::optional<std::span<const std::byte>> thread_name_;
+  std::optional<uintptr_t> stack_low_addr_;
+  std::optional<uintptr_t> stack_high_addr_;
+  std::optional<uintptr_t> stack_pointer_;
+  std::optional<uintptr_t> stack_peak_addr_;
+  std::optional<uint32_t> cpu_usage_hundredths_;
+};
+
+}  // namespace pw::thread
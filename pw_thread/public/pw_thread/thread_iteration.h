@@ -0,0 +1,40 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_function/function.h"
+#include "pw_status/status.h"
+#include "pw_thread/thread_info.h"
+
+namespace pw::thread {
+
+// Called once per thread by ForEachThread(). Returning false stops the
+// iteration.
+using ThreadCallback = pw::Function<bool(const ThreadInfo&)>;
+
+// Calls the callback with a snapshot of every thread known to the RTOS,
+// including threads not created through pw::thread::Thread.
+//
+// Backends may hold off the scheduler while iterating, so the callback must
+// not block and should return quickly; copy out what is needed and process it
+// afterwards.
+//
+// Returns:
+//   OK - Every thread was visited, or the callback stopped the iteration.
+//   FAILED_PRECONDITION - The RTOS is not configured to track threads.
+//   RESOURCE_EXHAUSTED - There were more threads than the backend can visit.
+//   UNIMPLEMENTED - The backend cannot enumerate threads.
+Status ForEachThread(const ThreadCallback& cb);
+
+}  // namespace pw::thread
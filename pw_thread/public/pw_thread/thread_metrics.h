@@ -0,0 +1,81 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "pw_metric/metric.h"
+#include "pw_status/status.h"
+#include "pw_thread/thread_info.h"
+#include "pw_tokenizer/tokenize.h"
+
+namespace pw::thread {
+
+// Stack and CPU metrics for one thread, matched to the RTOS's threads by name.
+// Each ThreadMetrics has a metric group with these metrics:
+//
+//   stack_size_bytes - Size of the thread's stack.
+//   stack_peak_bytes - Most stack the thread has used.
+//   stack_unused_bytes - Stack the thread has never touched.
+//   cpu_usage_hundredths - Share of CPU time used, in hundredths of a percent.
+//
+// Metrics the backend cannot report stay at 0. The metrics are refreshed by
+// UpdateThreadMetrics(), typically from a low priority housekeeping thread.
+//
+// Declare ThreadMetrics with PW_THREAD_METRICS, which tokenizes the name:
+//
+//   PW_THREAD_METRICS(uart_thread_metrics, "uart");
+//
+class ThreadMetrics {
+ public:
+  ThreadMetrics(metric::Token group_name, std::string_view thread_name)
+      : thread_name_(thread_name), metrics_(group_name) {}
+
+  ThreadMetrics(const ThreadMetrics&) = delete;
+  ThreadMetrics& operator=(const ThreadMetrics&) = delete;
+
+  // Updates the metrics if the info is for this thread. Returns whether it was.
+  bool Update(const ThreadInfo& info);
+
+  std::string_view thread_name() const { return thread_name_; }
+
+  metric::Group& metrics() { return metrics_; }
+  const metric::Group& metrics() const { return metrics_; }
+
+ private:
+  const std::string_view thread_name_;
+  metric::Group metrics_;
+
+  PW_METRIC(metrics_, stack_size_bytes_, "stack_size_bytes", 0u);
+  PW_METRIC(metrics_, stack_peak_bytes_, "stack_peak_bytes", 0u);
+  PW_METRIC(metrics_, stack_unused_bytes_, "stack_unused_bytes", 0u);
+  PW_METRIC(metrics_, cpu_usage_hundredths_, "cpu_usage_hundredths", 0u);
+};
+
+// Refreshes the metrics in a single pass over the RTOS's threads. Returns the
+// status of ForEachThread().
+Status UpdateThreadMetrics(std::span<ThreadMetrics* const> threads);
+
+}  // namespace pw::thread
+
+// Declares a ThreadMetrics for the thread with the given name, using the name
+// for its tokenized metric group too. Works at global and member scope.
+#define PW_THREAD_METRICS(variable_name, thread_name)                         \
+  static constexpr uint32_t variable_name##_token =                           \
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, thread_name); \
+  ::pw::thread::ThreadMetrics variable_name {                                 \
+    variable_name##_token, thread_name                                        \
+  }
@@ -0,0 +1,40 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_thread/thread_info.h"
+#include "pw_thread_protos/thread.pwpb.h"
+#include "pw_thread_protos/thread_snapshot_service.raw_rpc.pb.h"
+
+namespace pw::thread {
+
+// Encodes the fields of the ThreadInfo that are known into a pw.thread.Thread
+// message.
+Status EncodeThreadInfo(const ThreadInfo& info, Thread::StreamEncoder& encoder);
+
+// Reports the stack and CPU usage of every thread from ForEachThread(). The
+// whole report is encoded into the response buffer, so the RPC channel's
+// buffer must fit a Thread message per thread.
+class ThreadSnapshotService final
+    : public generated::ThreadSnapshotService<ThreadSnapshotService> {
+ public:
+  StatusWithSize GetThreadStats(ServerContext&,
+                                ConstByteSpan request,
+                                ByteSpan response);
+};
+
+}  // namespace pw::thread
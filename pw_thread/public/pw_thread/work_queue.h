@@ -0,0 +1,115 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_function/function.h"
+#include "pw_status/status.h"
+#include "pw_sync/counting_semaphore.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_thread/thread_core.h"
+
+namespace pw::thread {
+
+using WorkItem = Function<void()>;
+
+// A queue of work items that one or more threads run, so that subsystems which
+// need background work, such as deferred responses or flushes, can share a few
+// threads and their stacks instead of each having its own.
+//
+// Work is stored in a fixed number of slots. Each item has a priority; workers
+// always run the highest priority item first, and items of equal priority in
+// the order they were pushed. The queue is a ThreadCore: start one or more
+// threads with it to run the work. All workers take items from the shared
+// queue, so an idle worker always picks up the next item and none sits idle
+// while work is queued.
+//
+//   pw::thread::WorkQueueWithBuffer<8> work_queue;
+//
+//   pw::thread::DetachedThread(options_a, work_queue);
+//   pw::thread::DetachedThread(options_b, work_queue);
+//
+//   work_queue.PushWork([] { FlushLogs(); });
+//   work_queue.PushWork([] { SendDeferredResponse(); }, /*priority=*/1);
+//
+// Each item runs to completion on one worker; items on different workers may
+// run concurrently.
+class WorkQueue : public ThreadCore {
+ public:
+  // Queues a work item. Returns OK, or one of the following without queueing
+  // it:
+  //
+  //   RESOURCE_EXHAUSTED - Every slot holds queued work.
+  //   FAILED_PRECONDITION - RequestStop() was called.
+  //
+  // This is IRQ safe, provided the item's callable can be moved in an IRQ.
+  Status PushWork(WorkItem&& work_item, uint8_t priority = 0)
+      PW_LOCKS_EXCLUDED(lock_);
+
+  // Stops accepting work. Workers finish the work already queued, then return
+  // from Run(), so their threads may be joined. This is IRQ safe.
+  void RequestStop() PW_LOCKS_EXCLUDED(lock_);
+
+  // The number of work items waiting to run.
+  size_t queued() const PW_LOCKS_EXCLUDED(lock_);
+
+ protected:
+  struct Slot {
+    WorkItem work_item;
+    uint32_t sequence;
+    uint8_t priority;
+  };
+
+  explicit WorkQueue(std::span<Slot> slots)
+      : slots_(slots), next_sequence_(0), workers_(0), stopping_(false) {}
+
+ private:
+  // Runs work until RequestStop() is called and the queue is empty. Several
+  // threads may run the same WorkQueue.
+  void Run() final PW_LOCKS_EXCLUDED(lock_);
+
+  // Removes and returns the next item to run, or returns an empty WorkItem if
+  // there is none.
+  WorkItem PopWork() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  mutable sync::InterruptSpinLock lock_;
+
+  // A slot is free when its work_item is empty.
+  const std::span<Slot> slots_ PW_GUARDED_BY(lock_);
+
+  uint32_t next_sequence_ PW_GUARDED_BY(lock_);
+  size_t workers_ PW_GUARDED_BY(lock_);
+  bool stopping_ PW_GUARDED_BY(lock_);
+
+  // Released once for each queued item, and once for each worker on stop.
+  sync::CountingSemaphore work_ready_;
+};
+
+template <size_t kCapacity>
+class WorkQueueWithBuffer : public WorkQueue {
+ public:
+  static_assert(kCapacity > 0u);
+
+  WorkQueueWithBuffer() : WorkQueue(slots_) {}
+
+ private:
+  std::array<Slot, kCapacity> slots_;
+};
+
+}  // namespace pw::thread
@@ -0,0 +1,62 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_metrics.h"
+
+#include <cstring>
+
+#include "pw_thread/thread_iteration.h"
+
+namespace pw::thread {
+
+bool ThreadMetrics::Update(const ThreadInfo& info) {
+  if (!info.thread_name().has_value()) {
+    return false;
+  }
+
+  const std::span<const std::byte> name = info.thread_name().value();
+  if (name.size() != thread_name_.size() ||
+      std::memcmp(name.data(), thread_name_.data(), name.size()) != 0) {
+    return false;
+  }
+
+  if (std::optional<size_t> size = info.stack_size_bytes(); size.has_value()) {
+    stack_size_bytes_.Set(static_cast<uint32_t>(size.value()));
+  }
+  if (std::optional<size_t> peak = info.stack_peak_bytes(); peak.has_value()) {
+    stack_peak_bytes_.Set(static_cast<uint32_t>(peak.value()));
+  }
+  if (std::optional<size_t> unused = info.stack_unused_bytes();
+      unused.has_value()) {
+    stack_unused_bytes_.Set(static_cast<uint32_t>(unused.value()));
+  }
+  if (std::optional<uint32_t> cpu = info.cpu_usage_hundredths();
+      cpu.has_value()) {
+    cpu_usage_hundredths_.Set(cpu.value());
+  }
+  return true;
+}
+
+Status UpdateThreadMetrics(std::span<ThreadMetrics* const> threads) {
+  return ForEachThread([&threads](const ThreadInfo& info) {
+    for (ThreadMetrics* thread : threads) {
+      if (thread->Update(info)) {
+        break;
+      }
+    }
+    return true;
+  });
+}
+
+}  // namespace pw::thread
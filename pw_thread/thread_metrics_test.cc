@@ -0,0 +1,125 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_metrics.h"
+
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+namespace pw::thread {
+namespace {
+
+constexpr metric::Token kStackSizeBytes = PW_TOKENIZE_STRING_MASK(
+    "metrics", _PW_METRIC_TOKEN_MASK, "stack_size_bytes");
+constexpr metric::Token kStackPeakBytes = PW_TOKENIZE_STRING_MASK(
+    "metrics", _PW_METRIC_TOKEN_MASK, "stack_peak_bytes");
+constexpr metric::Token kStackUnusedBytes = PW_TOKENIZE_STRING_MASK(
+    "metrics", _PW_METRIC_TOKEN_MASK, "stack_unused_bytes");
+constexpr metric::Token kCpuUsageHundredths = PW_TOKENIZE_STRING_MASK(
+    "metrics", _PW_METRIC_TOKEN_MASK, "cpu_usage_hundredths");
+
+constexpr std::string_view kName = "worker";
+
+uint32_t GetMetric(metric::Group& group, metric::Token token) {
+  for (const metric::Metric& metric : group.metrics()) {
+    if (metric.name() == token) {
+      return metric.as_int();
+    }
+  }
+  ADD_FAILURE() << "No metric with token " << token;
+  return 0;
+}
+
+ThreadInfo WorkerInfo() {
+  ThreadInfo info;
+  info.set_thread_name(std::as_bytes(std::span(kName)));
+  info.set_stack_low_addr(0x1000);
+  info.set_stack_high_addr(0x1400);
+  info.set_stack_peak_addr(0x1100);
+  info.set_cpu_usage_hundredths(1234);
+  return info;
+}
+
+TEST(ThreadInfo, Empty_ReportsNothing) {
+  ThreadInfo info;
+  EXPECT_FALSE(info.thread_name().has_value());
+  EXPECT_FALSE(info.stack_size_bytes().has_value());
+  EXPECT_FALSE(info.stack_peak_bytes().has_value());
+  EXPECT_FALSE(info.stack_unused_bytes().has_value());
+  EXPECT_FALSE(info.cpu_usage_hundredths().has_value());
+}
+
+TEST(ThreadInfo, StackAddresses_GiveUsage) {
+  const ThreadInfo info = WorkerInfo();
+  EXPECT_EQ(info.stack_size_bytes(), 0x400u);
+  EXPECT_EQ(info.stack_peak_bytes(), 0x300u);
+  EXPECT_EQ(info.stack_unused_bytes(), 0x100u);
+}
+
+TEST(ThreadInfo, NoHighAddress_OnlyUnusedBytesKnown) {
+  ThreadInfo info;
+  info.set_stack_low_addr(0x1000);
+  info.set_stack_peak_addr(0x1080);
+  EXPECT_FALSE(info.stack_size_bytes().has_value());
+  EXPECT_FALSE(info.stack_peak_bytes().has_value());
+  EXPECT_EQ(info.stack_unused_bytes(), 0x80u);
+}
+
+TEST(ThreadMetrics, Update_MatchingName_SetsMetrics) {
+  ThreadMetrics metrics(1, kName);
+  EXPECT_TRUE(metrics.Update(WorkerInfo()));
+
+  EXPECT_EQ(GetMetric(metrics.metrics(), kStackSizeBytes), 0x400u);
+  EXPECT_EQ(GetMetric(metrics.metrics(), kStackPeakBytes), 0x300u);
+  EXPECT_EQ(GetMetric(metrics.metrics(), kStackUnusedBytes), 0x100u);
+  EXPECT_EQ(GetMetric(metrics.metrics(), kCpuUsageHundredths), 1234u);
+}
+
+TEST(ThreadMetrics, Update_OtherName_Ignored) {
+  ThreadMetrics metrics(1, "work");
+  EXPECT_FALSE(metrics.Update(WorkerInfo()));
+  EXPECT_FALSE(metrics.Update(ThreadInfo()));
+
+  EXPECT_EQ(GetMetric(metrics.metrics(), kStackSizeBytes), 0u);
+  EXPECT_EQ(GetMetric(metrics.metrics(), kCpuUsageHundredths), 0u);
+}
+
+TEST(ThreadMetrics, Update_UnknownFields_KeepLastValue) {
+  ThreadMetrics metrics(1, kName);
+  ASSERT_TRUE(metrics.Update(WorkerInfo()));
+
+  ThreadInfo partial;
+  partial.set_thread_name(std::as_bytes(std::span(kName)));
+  partial.set_stack_low_addr(0x1000);
+  partial.set_stack_peak_addr(0x1040);
+  EXPECT_TRUE(metrics.Update(partial));
+
+  EXPECT_EQ(GetMetric(metrics.metrics(), kStackSizeBytes), 0x400u);
+  EXPECT_EQ(GetMetric(metrics.metrics(), kStackUnusedBytes), 0x40u);
+  EXPECT_EQ(GetMetric(metrics.metrics(), kCpuUsageHundredths), 1234u);
+}
+
+PW_THREAD_METRICS(worker_metrics, "worker");
+
+TEST(ThreadMetrics, Macro_TokenizesGroupName) {
+  EXPECT_EQ(worker_metrics.thread_name(), kName);
+  constexpr metric::Token kWorker =
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, "worker");
+  EXPECT_EQ(worker_metrics.metrics().name(), kWorker);
+  EXPECT_TRUE(worker_metrics.Update(WorkerInfo()));
+}
+
+}  // namespace
+}  // namespace pw::thread
@@ -0,0 +1,99 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_snapshot_service.h"
+
+#include <cstring>
+
+#include "pw_log/log.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_thread/thread_iteration.h"
+#include "pw_thread_protos/thread_snapshot_service.pwpb.h"
+
+namespace pw::thread {
+namespace {
+
+bool NameMatches(const ThreadInfo& info, ConstByteSpan name) {
+  if (!info.thread_name().has_value()) {
+    return false;
+  }
+  const ConstByteSpan thread_name = info.thread_name().value();
+  return thread_name.size() == name.size() &&
+         std::memcmp(thread_name.data(), name.data(), name.size()) == 0;
+}
+
+}  // namespace
+
+Status EncodeThreadInfo(const ThreadInfo& info,
+                        Thread::StreamEncoder& encoder) {
+  if (info.thread_name().has_value()) {
+    encoder.WriteName(info.thread_name().value());
+  }
+  if (info.stack_high_addr().has_value()) {
+    encoder.WriteStackStartPointer(info.stack_high_addr().value());
+  }
+  if (info.stack_low_addr().has_value()) {
+    encoder.WriteStackEndPointer(info.stack_low_addr().value());
+  }
+  if (info.stack_size_bytes().has_value()) {
+    encoder.WriteStackSize(info.stack_size_bytes().value());
+  }
+  if (info.stack_pointer().has_value()) {
+    encoder.WriteStackPointer(info.stack_pointer().value());
+  }
+  if (info.stack_peak_addr().has_value()) {
+    encoder.WriteStackPointerEstPeak(info.stack_peak_addr().value());
+  }
+  if (info.cpu_usage_hundredths().has_value()) {
+    encoder.WriteCpuUsageHundredths(info.cpu_usage_hundredths().value());
+  }
+  return encoder.status();
+}
+
+StatusWithSize ThreadSnapshotService::GetThreadStats(ServerContext&,
+                                                     ConstByteSpan request,
+                                                     ByteSpan response) {
+  ConstByteSpan name_filter;
+  protobuf::Decoder decoder(request);
+  while (decoder.Next().ok()) {
+    if (static_cast<ThreadStatsRequest::Fields>(decoder.FieldNumber()) ==
+        ThreadStatsRequest::Fields::NAME) {
+      decoder.ReadBytes(&name_filter);
+    }
+  }
+
+  // Each thread is encoded straight into the response, since the backend may
+  // have the scheduler held off while calling back.
+  ThreadStats::RamEncoder encoder(response);
+  const Status status = ForEachThread([&](const ThreadInfo& info) {
+    if (!name_filter.empty() && !NameMatches(info, name_filter)) {
+      return true;
+    }
+    Thread::StreamEncoder thread = encoder.GetThreadsEncoder();
+    return EncodeThreadInfo(info, thread).ok();
+  });
+
+  if (!status.ok()) {
+    PW_LOG_ERROR("Failed to iterate over threads");
+    return StatusWithSize(status, 0);
+  }
+  if (!encoder.status().ok()) {
+    PW_LOG_WARN("Thread stats do not fit in a %u byte response",
+                static_cast<unsigned>(response.size()));
+    return StatusWithSize::ResourceExhausted();
+  }
+  return StatusWithSize(encoder.size());
+}
+
+}  // namespace pw::thread
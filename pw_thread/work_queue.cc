@@ -0,0 +1,134 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/work_queue.h"
+
+#include <mutex>
+#include <utility>
+
+namespace pw::thread {
+
+Status WorkQueue::PushWork(WorkItem&& work_item, uint8_t priority) {
+  {
+    std::lock_guard lock(lock_);
+    if (stopping_) {
+      return Status::FailedPrecondition();
+    }
+
+    Slot* free_slot = nullptr;
+    for (Slot& slot : slots_) {
+      if (slot.work_item == nullptr) {
+        free_slot = &slot;
+        break;
+      }
+    }
+    if (free_slot == nullptr) {
+      return Status::ResourceExhausted();
+    }
+
+    free_slot->work_item = std::move(work_item);
+    free_slot->sequence = next_sequence_++;
+    free_slot->priority = priority;
+  }
+
+  work_ready_.release();
+  return OkStatus();
+}
+
+void WorkQueue::RequestStop() {
+  size_t workers;
+  {
+    std::lock_guard lock(lock_);
+    if (stopping_) {
+      return;
+    }
+    stopping_ = true;
+    workers = workers_;
+  }
+
+  // Wake every worker, so that each finds the queue stopping once it is empty.
+  // Each is released separately, since not every backend wakes several waiters
+  // for a single release.
+  for (size_t i = 0; i < workers; ++i) {
+    work_ready_.release();
+  }
+}
+
+size_t WorkQueue::queued() const {
+  std::lock_guard lock(lock_);
+  size_t count = 0;
+  for (const Slot& slot : slots_) {
+    if (slot.work_item != nullptr) {
+      count += 1;
+    }
+  }
+  return count;
+}
+
+void WorkQueue::Run() {
+  bool stopping;
+  {
+    std::lock_guard lock(lock_);
+    workers_ += 1;
+    stopping = stopping_;
+  }
+
+  // A worker that starts after RequestStop() provides its own wakeup, so that
+  // it does not take one meant for another worker.
+  if (stopping) {
+    work_ready_.release();
+  }
+
+  while (true) {
+    // Each queued item and each worker's stop releases the semaphore once, so
+    // a worker only finds the queue empty once it is stopping.
+    work_ready_.acquire();
+
+    WorkItem work_item;
+    {
+      std::lock_guard lock(lock_);
+      work_item = PopWork();
+      if (work_item == nullptr) {
+        workers_ -= 1;
+        return;
+      }
+    }
+
+    work_item();
+  }
+}
+
+WorkItem WorkQueue::PopWork() {
+  Slot* next = nullptr;
+  for (Slot& slot : slots_) {
+    if (slot.work_item == nullptr) {
+      continue;
+    }
+    // Sequence numbers wrap, so compare them by difference.
+    if (next == nullptr || slot.priority > next->priority ||
+        (slot.priority == next->priority &&
+         static_cast<int32_t>(slot.sequence - next->sequence) < 0)) {
+      next = &slot;
+    }
+  }
+
+  if (next == nullptr) {
+    return nullptr;
+  }
+  WorkItem work_item = std::move(next->work_item);
+  next->work_item = nullptr;
+  return work_item;
+}
+
+}  // namespace pw::thread
@@ -0,0 +1,123 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/work_queue.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+
+namespace pw::thread {
+namespace {
+
+// These tests run the queue on the test's own thread: work is queued, the queue
+// is stopped, and Start() then runs the queued work and returns.
+
+struct Log {
+  std::array<int, 8> order{};
+  size_t count = 0;
+
+  void Record(int value) { order[count++] = value; }
+};
+
+TEST(WorkQueue, RunsQueuedWork_ThenReturnsOnStop) {
+  WorkQueueWithBuffer<4> queue;
+  Log log;
+
+  ASSERT_EQ(OkStatus(), queue.PushWork([&log] { log.Record(1); }));
+  ASSERT_EQ(OkStatus(), queue.PushWork([&log] { log.Record(2); }));
+  EXPECT_EQ(queue.queued(), 2u);
+
+  queue.RequestStop();
+  queue.Start();
+
+  ASSERT_EQ(log.count, 2u);
+  EXPECT_EQ(log.order[0], 1);
+  EXPECT_EQ(log.order[1], 2);
+  EXPECT_EQ(queue.queued(), 0u);
+}
+
+TEST(WorkQueue, HigherPriorityRunsFirst_FifoWithinPriority) {
+  WorkQueueWithBuffer<6> queue;
+  Log log;
+
+  ASSERT_EQ(OkStatus(), queue.PushWork([&log] { log.Record(1); }, 0));
+  ASSERT_EQ(OkStatus(), queue.PushWork([&log] { log.Record(2); }, 2));
+  ASSERT_EQ(OkStatus(), queue.PushWork([&log] { log.Record(3); }, 1));
+  ASSERT_EQ(OkStatus(), queue.PushWork([&log] { log.Record(4); }, 2));
+  ASSERT_EQ(OkStatus(), queue.PushWork([&log] { log.Record(5); }, 0));
+
+  queue.RequestStop();
+  queue.Start();
+
+  ASSERT_EQ(log.count, 5u);
+  EXPECT_EQ(log.order[0], 2);
+  EXPECT_EQ(log.order[1], 4);
+  EXPECT_EQ(log.order[2], 3);
+  EXPECT_EQ(log.order[3], 1);
+  EXPECT_EQ(log.order[4], 5);
+}
+
+TEST(WorkQueue, Full_ResourceExhausted) {
+  WorkQueueWithBuffer<2> queue;
+  Log log;
+
+  ASSERT_EQ(OkStatus(), queue.PushWork([&log] { log.Record(1); }));
+  ASSERT_EQ(OkStatus(), queue.PushWork([&log] { log.Record(2); }));
+  EXPECT_EQ(Status::ResourceExhausted(),
+            queue.PushWork([&log] { log.Record(3); }));
+
+  queue.RequestStop();
+  queue.Start();
+  EXPECT_EQ(log.count, 2u);
+}
+
+TEST(WorkQueue, WorkCanQueueMoreWork) {
+  WorkQueueWithBuffer<1> queue;
+  Log log;
+
+  struct Context {
+    WorkQueue& queue;
+    Log& log;
+  } context{queue, log};
+
+  // The first item's slot is free while it runs, so it can queue the second,
+  // which stops the queue.
+  ASSERT_EQ(OkStatus(), queue.PushWork([&context] {
+    context.log.Record(1);
+    EXPECT_EQ(OkStatus(), context.queue.PushWork([&context] {
+      context.log.Record(2);
+      context.queue.RequestStop();
+    }));
+  }));
+
+  queue.Start();
+
+  ASSERT_EQ(log.count, 2u);
+  EXPECT_EQ(log.order[0], 1);
+  EXPECT_EQ(log.order[1], 2);
+}
+
+TEST(WorkQueue, PushAfterStop_FailedPrecondition) {
+  WorkQueueWithBuffer<2> queue;
+  queue.RequestStop();
+
+  EXPECT_EQ(Status::FailedPrecondition(), queue.PushWork([] {}));
+  EXPECT_EQ(queue.queued(), 0u);
+
+  queue.Start();
+}
+
+}  // namespace
+}  // namespace pw::thread
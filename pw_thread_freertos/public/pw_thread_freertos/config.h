@@ -58,6 +58,13 @@
 #define PW_THREAD_FREERTOS_CONFIG_DEFAULT_PRIORITY (tskIDLE_PRIORITY + 1)
 #endif  // PW_THREAD_FREERTOS_CONFIG_DEFAULT_PRIORITY
 
+// The most threads pw::thread::ForEachThread() can report. Their
+// TaskStatus_t entries are held in a static buffer, since FreeRTOS only
+// reports threads as a whole array.
+#ifndef PW_THREAD_FREERTOS_CONFIG_MAX_ITERATED_THREADS
+#define PW_THREAD_FREERTOS_CONFIG_MAX_ITERATED_THREADS 16
+#endif  // PW_THREAD_FREERTOS_CONFIG_MAX_ITERATED_THREADS
+
 namespace pw::thread::freertos::config {
 
 inline constexpr size_t kMinimumStackSizeWords = configMINIMAL_STACK_SIZE;
@@ -65,5 +72,7 @@ inline constexpr size_t kDefaultStackSizeWords =
     PW_THREAD_FREERTOS_CONFIG_DEFAULT_STACK_SIZE_WORDS;
 inline constexpr UBaseType_t kDefaultPriority =
     PW_THREAD_FREERTOS_CONFIG_DEFAULT_PRIORITY;
+inline constexpr size_t kMaxIteratedThreads =
+    PW_THREAD_FREERTOS_CONFIG_MAX_ITERATED_THREADS;
 
 }  // namespace pw::thread::freertos::config
@@ -0,0 +1,90 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_iteration.h"
+
+#include <array>
+#include <cstring>
+
+#include "FreeRTOS.h"
+#include "pw_thread_freertos/config.h"
+#include "task.h"
+
+namespace pw::thread {
+namespace {
+
+#if configUSE_TRACE_FACILITY
+
+// Only accessed with the scheduler suspended.
+std::array<TaskStatus_t, freertos::config::kMaxIteratedThreads> task_statuses;
+
+ThreadInfo ToThreadInfo(const TaskStatus_t& status,
+                        [[maybe_unused]] uint32_t total_run_time) {
+  ThreadInfo info;
+  info.set_thread_name(std::as_bytes(
+      std::span(status.pcTaskName,
+                strnlen(status.pcTaskName, configMAX_TASK_NAME_LEN))));
+
+  // FreeRTOS tracks the start of the stack and its high-water mark, which is
+  // the number of words at the bottom of the stack that were never written.
+  const uintptr_t stack_low_addr =
+      reinterpret_cast<uintptr_t>(status.pxStackBase);
+  info.set_stack_low_addr(stack_low_addr);
+  info.set_stack_peak_addr(stack_low_addr + status.usStackHighWaterMark *
+                                                sizeof(StackType_t));
+
+#if configGENERATE_RUN_TIME_STATS
+  if (total_run_time != 0) {
+    info.set_cpu_usage_hundredths(static_cast<uint32_t>(
+        uint64_t{status.ulRunTimeCounter} * 10000u / total_run_time));
+  }
+#endif  // configGENERATE_RUN_TIME_STATS
+  return info;
+}
+
+#endif  // configUSE_TRACE_FACILITY
+
+}  // namespace
+
+Status ForEachThread(const ThreadCallback& cb) {
+#if configUSE_TRACE_FACILITY
+  // Suspending the scheduler keeps the tasks, and the task status buffer, from
+  // changing until the callbacks are done.
+  vTaskSuspendAll();
+
+  uint32_t total_run_time = 0;
+  const UBaseType_t task_count = uxTaskGetSystemState(
+      task_statuses.data(), task_statuses.size(), &total_run_time);
+
+  // uxTaskGetSystemState() reports nothing if the buffer is too small.
+  Status status = OkStatus();
+  if (task_count == 0) {
+    status = Status::ResourceExhausted();
+  }
+
+  for (UBaseType_t i = 0; i < task_count; ++i) {
+    if (!cb(ToThreadInfo(task_statuses[i], total_run_time))) {
+      break;
+    }
+  }
+
+  xTaskResumeAll();
+  return status;
+#else
+  static_cast<void>(cb);
+  return Status::FailedPrecondition();
+#endif  // configUSE_TRACE_FACILITY
+}
+
+}  // namespace pw::thread
@@ -0,0 +1,89 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread_stl/options.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif  // defined(__linux__)
+
+#include "gtest/gtest.h"
+#include "pw_thread/thread.h"
+
+namespace pw::thread::stl {
+namespace {
+
+#if defined(__linux__)
+
+struct ThreadState {
+  int policy = -1;
+  int cpu = -1;
+};
+
+void RecordState(void* arg) {
+  ThreadState& state = *static_cast<ThreadState*>(arg);
+  sched_param param;
+  pthread_getschedparam(pthread_self(), &state.policy, &param);
+  state.cpu = sched_getcpu();
+}
+
+TEST(Options, Default_InheritsPolicy) {
+  ThreadState state;
+  Thread thread(Options(), RecordState, &state);
+  thread.join();
+
+  int policy;
+  sched_param param;
+  pthread_getschedparam(pthread_self(), &policy, &param);
+  EXPECT_EQ(state.policy, policy);
+}
+
+TEST(Options, SchedulingPolicy_AppliedBeforeEntry) {
+  ThreadState state;
+  Thread thread(
+      Options().set_scheduling_policy(Options::SchedulingPolicy::kBatch),
+      RecordState,
+      &state);
+  thread.join();
+
+  EXPECT_EQ(state.policy, SCHED_BATCH);
+}
+
+TEST(Options, CpuAffinity_RunsOnlyOnSelectedCpu) {
+  cpu_set_t allowed;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+
+  // Pick the last CPU this process may run on.
+  int cpu = -1;
+  for (int i = 0; i < 64; ++i) {
+    if (CPU_ISSET(i, &allowed)) {
+      cpu = i;
+    }
+  }
+  ASSERT_GE(cpu, 0);
+
+  ThreadState state;
+  Thread thread(Options().set_cpu_affinity(uint64_t{1} << cpu),
+                RecordState,
+                &state);
+  thread.join();
+
+  EXPECT_EQ(state.cpu, cpu);
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+}  // namespace pw::thread::stl
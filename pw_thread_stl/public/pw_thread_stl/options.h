@@ -13,14 +13,76 @@
 // the License.
 #pragma once
 
+#include <cstdint>
+
 #include "pw_thread/thread.h"
 
 namespace pw::thread::stl {
 
 // Unfortunately std::thread:attributes was not accepted into the C++ standard.
-// Instead, users are expected to start the thread and after dynamically adjust
-// the thread's attributes using std::thread::native_handle based on the native
-// threading APIs.
-class Options : public thread::Options {};
+// Instead, the new thread applies these options to itself using the native
+// threading APIs before its entry function runs.
+//
+// By default, threads inherit the scheduling policy and priority of the
+// creating thread and may run on any CPU. The scheduling policy, priority, and
+// CPU affinity are only applied on Linux, where they allow host simulations to
+// match the contention on a device and to pin hot threads to cores. They are
+// ignored on other hosts.
+//
+// If the OS rejects the options, for example because real-time policies
+// require CAP_SYS_NICE, the process crashes rather than silently running the
+// thread with different scheduling than requested.
+class Options : public thread::Options {
+ public:
+  // Linux scheduling policies, see sched(7).
+  enum class SchedulingPolicy {
+    kInherit,     // Keep the creating thread's policy and priority.
+    kOther,       // SCHED_OTHER: default time-sharing.
+    kBatch,       // SCHED_BATCH: time-sharing for CPU-bound threads.
+    kIdle,        // SCHED_IDLE: only runs when the CPU is otherwise idle.
+    kFifo,        // SCHED_FIFO: real-time, first in first out.
+    kRoundRobin,  // SCHED_RR: real-time, round robin.
+  };
+
+  constexpr Options() = default;
+  constexpr Options(const Options&) = default;
+  constexpr Options(Options&&) = default;
+
+  // Sets the scheduling policy of the thread.
+  constexpr Options& set_scheduling_policy(SchedulingPolicy policy) {
+    policy_ = policy;
+    return *this;
+  }
+
+  // Sets the static priority of the thread, which is used by the kFifo and
+  // kRoundRobin policies. It must be between 1 (lowest) and 99 (highest) for
+  // those policies, and 0 for the others.
+  constexpr Options& set_priority(int priority) {
+    priority_ = priority;
+    return *this;
+  }
+
+  // Restricts the thread to the CPUs whose bits are set in the mask, where bit
+  // N is CPU N. A mask of 0, the default, allows the thread to run on any CPU.
+  constexpr Options& set_cpu_affinity(uint64_t cpu_mask) {
+    cpu_mask_ = cpu_mask;
+    return *this;
+  }
+
+ private:
+  friend thread::Thread;
+
+  // True if the thread is created without changing any scheduling options.
+  constexpr bool inherits_scheduling() const {
+    return policy_ == SchedulingPolicy::kInherit && cpu_mask_ == 0u;
+  }
+
+  // Applies the options to the calling thread.
+  void ApplyToCurrentThread() const;
+
+  SchedulingPolicy policy_ = SchedulingPolicy::kInherit;
+  int priority_ = 0;
+  uint64_t cpu_mask_ = 0;
+};
 
 }  // namespace pw::thread::stl
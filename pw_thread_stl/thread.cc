@@ -0,0 +1,108 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#include "pw_thread/thread.h"
+
+#include "pw_thread/thread.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif  // defined(__linux__)
+
+#include "pw_assert/check.h"
+#include "pw_thread_stl/options.h"
+
+namespace pw::thread {
+namespace stl {
+namespace {
+
+#if defined(__linux__)
+
+int NativePolicy(Options::SchedulingPolicy policy) {
+  switch (policy) {
+    case Options::SchedulingPolicy::kOther:
+      return SCHED_OTHER;
+    case Options::SchedulingPolicy::kBatch:
+      return SCHED_BATCH;
+    case Options::SchedulingPolicy::kIdle:
+      return SCHED_IDLE;
+    case Options::SchedulingPolicy::kFifo:
+      return SCHED_FIFO;
+    case Options::SchedulingPolicy::kRoundRobin:
+      return SCHED_RR;
+    case Options::SchedulingPolicy::kInherit:
+      break;
+  }
+  PW_CRASH("Unknown scheduling policy %d", static_cast<int>(policy));
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+
+void Options::ApplyToCurrentThread() const {
+#if defined(__linux__)
+  if (policy_ != SchedulingPolicy::kInherit) {
+    sched_param param = {};
+    param.sched_priority = priority_;
+    const int result =
+        pthread_setschedparam(pthread_self(), NativePolicy(policy_), &param);
+    PW_CHECK_INT_EQ(result,
+                    0,
+                    "Failed to set scheduling policy %d with priority %d; "
+                    "real-time policies require CAP_SYS_NICE",
+                    static_cast<int>(policy_),
+                    priority_);
+  }
+
+  if (cpu_mask_ != 0u) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int cpu = 0; cpu < 64; ++cpu) {
+      if ((cpu_mask_ >> cpu) & 1u) {
+        CPU_SET(cpu, &cpus);
+      }
+    }
+    const int result =
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    PW_CHECK_INT_EQ(result,
+                    0,
+                    "Failed to set CPU affinity to 0x%llx",
+                    static_cast<unsigned long long>(cpu_mask_));
+  }
+#endif  // defined(__linux__)
+}
+
+}  // namespace stl
+
+Thread::Thread(const thread::Options& facade_options,
+               ThreadRoutine entry,
+               void* arg) {
+  // Cast the generic facade options to the backend specific option of which
+  // only one type can exist at compile time.
+  const auto& options = static_cast<const stl::Options&>(facade_options);
+  if (options.inherits_scheduling()) {
+    native_type_ = std::thread(entry, arg);
+    return;
+  }
+
+  // Apply the settings in the new thread so that they are in effect before the
+  // entry function starts.
+  native_type_ = std::thread([options, entry, arg] {
+    options.ApplyToCurrentThread();
+    entry(arg);
+  });
+}
+
+}  // namespace pw::thread
@@ -0,0 +1,86 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_iteration.h"
+
+#include <cstring>
+
+#include "pw_assert/check.h"
+#include "tx_api.h"
+#include "tx_thread.h"
+
+namespace pw::thread {
+namespace {
+
+ThreadInfo ToThreadInfo(const TX_THREAD& thread) {
+  ThreadInfo info;
+  if (thread.tx_thread_name != nullptr) {
+    info.set_thread_name(std::as_bytes(std::span(
+        thread.tx_thread_name, std::strlen(thread.tx_thread_name))));
+  }
+
+  info.set_stack_low_addr(
+      reinterpret_cast<uintptr_t>(thread.tx_thread_stack_start));
+  // tx_thread_stack_end is the last byte of the stack, not one past it.
+  info.set_stack_high_addr(
+      reinterpret_cast<uintptr_t>(thread.tx_thread_stack_end) + 1);
+  info.set_stack_pointer(
+      reinterpret_cast<uintptr_t>(thread.tx_thread_stack_ptr));
+
+#if defined(TX_ENABLE_STACK_CHECKING)
+  // ThreadX only tracks the deepest stack use when stack checking is enabled.
+  info.set_stack_peak_addr(
+      reinterpret_cast<uintptr_t>(thread.tx_thread_stack_highest_ptr));
+#endif  // defined(TX_ENABLE_STACK_CHECKING)
+
+  // ThreadX does not track per-thread run time without the execution profile
+  // kit, so CPU usage is not reported.
+  return info;
+}
+
+}  // namespace
+
+Status ForEachThread(const ThreadCallback& cb) {
+  TX_THREAD* const current_thread = tx_thread_identify();
+  PW_DCHECK_NOTNULL(current_thread, "Threads can only be iterated by a thread");
+
+  // Raise our preemption threshold as a thread only critical section, so no
+  // thread is created or deleted while walking the list.
+  UINT original_preemption_threshold = TX_MAX_PRIORITIES;  // Invalid.
+  UINT preemption_success = tx_thread_preemption_change(
+      current_thread, 0, &original_preemption_threshold);
+  PW_DCHECK_UINT_EQ(TX_SUCCESS,
+                    preemption_success,
+                    "Failed to enter thread critical section");
+
+  // The created threads form a circular list.
+  const TX_THREAD* const first_thread = _tx_thread_created_ptr;
+  const TX_THREAD* thread = first_thread;
+  for (ULONG i = 0; i < _tx_thread_created_count; ++i) {
+    if (!cb(ToThreadInfo(*thread))) {
+      break;
+    }
+    thread = thread->tx_thread_created_next;
+  }
+
+  UINT unused = 0;
+  preemption_success = tx_thread_preemption_change(
+      current_thread, original_preemption_threshold, &unused);
+  PW_DCHECK_UINT_EQ(TX_SUCCESS,
+                    preemption_success,
+                    "Failed to leave thread critical section");
+  return OkStatus();
+}
+
+}  // namespace pw::thread
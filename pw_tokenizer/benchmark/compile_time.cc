@@ -0,0 +1,23 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Tokenizes strings with the constexpr C++ hash. See compile_time_strings.h.
+
+#include "compile_time_strings.h"
+
+namespace pw::tokenizer {
+
+PW_TOKENIZER_DEFINE_COMPILE_TIME_BENCHMARK(CompileTimeBenchmark)
+
+}  // namespace pw::tokenizer
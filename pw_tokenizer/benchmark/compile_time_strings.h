@@ -0,0 +1,63 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Tokenizes 100 different strings, for measuring how long tokenization takes
+// to compile. This file is included by one C and one C++ source, which are
+// built as separate targets: the C file hashes with the
+// PW_TOKENIZER_CFG_C_HASH_LENGTH hash macro, and the C++ file with the
+// constexpr pw::tokenizer::Hash. Compare their compilation times with
+//
+//   ninja -C out -t clean <target> && time ninja -C out <target>
+//
+// The strings are shorter than the default hash length of 128 characters, so
+// both produce identical tokens.
+#pragma once
+
+#include <stdint.h>
+
+#include "pw_tokenizer/tokenize.h"
+
+#define _PW_TOKENIZER_BENCHMARK_STRING(n)                                 \
+  "Compile time benchmark message " #n ": the sensor reading was stable " \
+  "within the expected range, so no recalibration is needed."
+
+#define _PW_TOKENIZER_BENCHMARK_TOKENIZE(n) \
+  tokens[n - 10] = PW_TOKENIZE_STRING(_PW_TOKENIZER_BENCHMARK_STRING(n));
+
+#define _PW_TOKENIZER_BENCHMARK_TOKENIZE_10(tens) \
+  _PW_TOKENIZER_BENCHMARK_TOKENIZE(tens##0)       \
+  _PW_TOKENIZER_BENCHMARK_TOKENIZE(tens##1)       \
+  _PW_TOKENIZER_BENCHMARK_TOKENIZE(tens##2)       \
+  _PW_TOKENIZER_BENCHMARK_TOKENIZE(tens##3)       \
+  _PW_TOKENIZER_BENCHMARK_TOKENIZE(tens##4)       \
+  _PW_TOKENIZER_BENCHMARK_TOKENIZE(tens##5)       \
+  _PW_TOKENIZER_BENCHMARK_TOKENIZE(tens##6)       \
+  _PW_TOKENIZER_BENCHMARK_TOKENIZE(tens##7)       \
+  _PW_TOKENIZER_BENCHMARK_TOKENIZE(tens##8)       \
+  _PW_TOKENIZER_BENCHMARK_TOKENIZE(tens##9)
+
+// Defines a function that writes the 100 tokens to an array.
+#define PW_TOKENIZER_DEFINE_COMPILE_TIME_BENCHMARK(function_name) \
+  void function_name(uint32_t tokens[100]) {                      \
+    _PW_TOKENIZER_BENCHMARK_TOKENIZE_10(1)                        \
+    _PW_TOKENIZER_BENCHMARK_TOKENIZE_10(2)                        \
+    _PW_TOKENIZER_BENCHMARK_TOKENIZE_10(3)                        \
+    _PW_TOKENIZER_BENCHMARK_TOKENIZE_10(4)                        \
+    _PW_TOKENIZER_BENCHMARK_TOKENIZE_10(5)                        \
+    _PW_TOKENIZER_BENCHMARK_TOKENIZE_10(6)                        \
+    _PW_TOKENIZER_BENCHMARK_TOKENIZE_10(7)                        \
+    _PW_TOKENIZER_BENCHMARK_TOKENIZE_10(8)                        \
+    _PW_TOKENIZER_BENCHMARK_TOKENIZE_10(9)                        \
+    _PW_TOKENIZER_BENCHMARK_TOKENIZE_10(10)                       \
+  }
@@ -0,0 +1,216 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures how long it takes to construct each detokenizer from a large token
+// database and to detokenize a realistic mix of log messages with it. Most of
+// the messages use a small fraction of the format strings, as in real logs.
+// The messages are also detokenized in batches with multiple threads.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_tokenizer/detokenize.h"
+#include "pw_varint/varint.h"
+
+namespace {
+
+constexpr size_t kFormatStrings = 4000;
+constexpr size_t kMessages = 100000;
+constexpr size_t kBatchThreads[] = {1, 2, 4};
+
+// Each format string in the database is one of these with a unique suffix.
+// The argument types are the letters after each %.
+constexpr const char* kTemplates[] = {
+    "Battery at %d%%, temperature %d C",
+    "Sensor %s read %u samples in %u ms",
+    "Connection to %s failed with status %d",
+    "Queue %u is %d%% full",
+    "Task %s took %u us (limit %u us)",
+    "Received %u bytes on channel %u",
+    "Retrying %s, attempt %d of %d",
+    "Heartbeat",
+};
+
+uint32_t random_state = 1;
+
+uint32_t Random() {
+  random_state = random_state * 1103515245u + 12345u;
+  return random_state >> 8;
+}
+
+struct Format {
+  uint32_t token;
+  std::string string;
+};
+
+std::vector<Format> MakeFormatStrings() {
+  std::vector<Format> formats;
+  for (size_t i = 0; i < kFormatStrings; ++i) {
+    formats.push_back({static_cast<uint32_t>(i * 2654435761u),
+                       kTemplates[i % std::size(kTemplates)] +
+                           (" [" + std::to_string(i) + ']')});
+  }
+  std::sort(formats.begin(), formats.end(), [](const auto& a, const auto& b) {
+    return a.token < b.token;
+  });
+  return formats;
+}
+
+// Builds a binary token database, as created by database.py.
+std::vector<char> MakeDatabase(const std::vector<Format>& formats) {
+  std::vector<char> data(16);
+  std::memcpy(data.data(), "TOKENS\0\0", 8);
+  const uint32_t count = formats.size();
+  std::memcpy(&data[8], &count, sizeof(count));
+
+  for (const Format& format : formats) {
+    const uint32_t entry[2] = {format.token, 0xFFFFFFFFu};
+    data.insert(data.end(),
+                reinterpret_cast<const char*>(entry),
+                reinterpret_cast<const char*>(entry) + sizeof(entry));
+  }
+  for (const Format& format : formats) {
+    data.insert(data.end(), format.string.begin(), format.string.end());
+    data.push_back('\0');
+  }
+  return data;
+}
+
+// Encodes a message for the format string, with arguments for each %d, %u,
+// and %s.
+std::string Encode(const Format& format) {
+  std::string message(reinterpret_cast<const char*>(&format.token),
+                      sizeof(format.token));
+
+  for (size_t i = 0; i + 1 < format.string.size(); ++i) {
+    if (format.string[i] != '%') {
+      continue;
+    }
+    const char type = format.string[++i];
+    if (type == 'd' || type == 'u') {
+      std::byte buffer[pw::varint::kMaxVarint64SizeBytes];
+      const size_t size =
+          pw::varint::Encode(static_cast<int64_t>(Random() % 100000), buffer);
+      message.append(reinterpret_cast<const char*>(buffer), size);
+    } else if (type == 's') {
+      const std::string value = "name" + std::to_string(Random() % 1000);
+      message.push_back(static_cast<char>(value.size()));
+      message.append(value);
+    }
+  }
+  return message;
+}
+
+// Picks format strings so that a few hundred of them account for most of the
+// messages.
+std::vector<std::string> MakeMessages(const std::vector<Format>& formats) {
+  std::vector<std::string> messages;
+  messages.reserve(kMessages);
+  for (size_t i = 0; i < kMessages; ++i) {
+    const uint64_t random = Random() % formats.size();
+    const size_t index = random * random * random / formats.size() /
+                         formats.size();
+    messages.push_back(Encode(formats[index]));
+  }
+  return messages;
+}
+
+long ElapsedUs(pw::chrono::SystemClock::time_point start) {
+  return static_cast<long>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          pw::chrono::SystemClock::now() - start)
+          .count());
+}
+
+template <typename Detokenizer>
+void Benchmark(const char* name,
+               const pw::tokenizer::TokenDatabase& database,
+               const std::vector<std::string>& messages) {
+  auto start = pw::chrono::SystemClock::now();
+  Detokenizer detokenizer(database);
+  const long construct_us = ElapsedUs(start);
+
+  // The first pass includes parsing each format string the first time it is
+  // used, if the detokenizer parses them lazily.
+  long pass_us[2];
+  size_t total_size = 0;
+  for (long& elapsed_us : pass_us) {
+    start = pw::chrono::SystemClock::now();
+    for (const std::string& message : messages) {
+      const pw::tokenizer::DetokenizedString result =
+          detokenizer.Detokenize(message);
+      PW_CHECK(result.ok());
+      total_size += result.BestString().size();
+    }
+    elapsed_us = ElapsedUs(start);
+  }
+
+  PW_LOG_INFO("%-16s construct: %7ld us, first pass: %5ld ns/msg, "
+              "second pass: %5ld ns/msg (%u B decoded)",
+              name,
+              construct_us,
+              pass_us[0] * 1000 / static_cast<long>(messages.size()),
+              pass_us[1] * 1000 / static_cast<long>(messages.size()),
+              static_cast<unsigned>(total_size));
+
+  std::vector<std::span<const uint8_t>> encoded;
+  for (const std::string& message : messages) {
+    encoded.emplace_back(reinterpret_cast<const uint8_t*>(message.data()),
+                         message.size());
+  }
+  std::vector<pw::tokenizer::DetokenizedString> output(messages.size());
+
+  for (size_t threads : kBatchThreads) {
+    start = pw::chrono::SystemClock::now();
+    detokenizer.DetokenizeBatch(encoded, output, threads);
+    const long elapsed_us = ElapsedUs(start);
+
+    PW_CHECK(output.back().ok());
+    PW_LOG_INFO("%-16s batch with %u threads: %5ld ns/msg",
+                name,
+                static_cast<unsigned>(threads),
+                elapsed_us * 1000 / static_cast<long>(messages.size()));
+  }
+}
+
+}  // namespace
+
+int main() {
+  const std::vector<Format> formats = MakeFormatStrings();
+  const std::vector<char> data = MakeDatabase(formats);
+  const std::vector<std::string> messages = MakeMessages(formats);
+
+  const pw::tokenizer::TokenDatabase database =
+      pw::tokenizer::TokenDatabase::Create(data);
+  PW_CHECK(database.ok());
+
+  PW_LOG_INFO("Detokenizing %u messages from %u format strings (%u B)",
+              static_cast<unsigned>(messages.size()),
+              static_cast<unsigned>(database.size()),
+              static_cast<unsigned>(data.size()));
+
+  Benchmark<pw::tokenizer::Detokenizer>("Detokenizer", database, messages);
+  Benchmark<pw::tokenizer::FlatDetokenizer>(
+      "FlatDetokenizer", database, messages);
+  return 0;
+}
@@ -0,0 +1,140 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_tokenizer/compact_token_database.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pw_varint/varint.h"
+
+namespace pw::tokenizer {
+namespace {
+
+constexpr char kMagicAndVersion[] = {'T', 'O', 'K', 'E', 'N', 'S', '\1', '\0'};
+
+uint32_t ReadUint32(const std::byte* bytes) {
+  return static_cast<uint32_t>(bytes[0]) |
+         static_cast<uint32_t>(bytes[1]) << 8 |
+         static_cast<uint32_t>(bytes[2]) << 16 |
+         static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+// Decodes a varint that must fit in a uint32_t. Returns the number of bytes
+// read, or 0 if the varint is invalid, too large, or longer than 5 bytes.
+size_t DecodeUint32(std::span<const std::byte> data, uint32_t& value) {
+  uint64_t decoded;
+  const size_t bytes = varint::Decode(
+      data.first(std::min(data.size(), varint::kMaxVarint32SizeBytes)),
+      &decoded);
+  if (bytes == 0u || decoded > UINT32_MAX) {
+    return 0;
+  }
+  value = static_cast<uint32_t>(decoded);
+  return bytes;
+}
+
+}  // namespace
+
+bool CompactTokenDatabase::IsValid(std::span<const std::byte> bytes) {
+  if (bytes.size() < kHeaderSize ||
+      std::memcmp(bytes.data(), kMagicAndVersion, sizeof(kMagicAndVersion)) !=
+          0) {
+    return false;
+  }
+
+  const uint32_t entry_count = ReadUint32(&bytes[8]);
+  const uint32_t entries_size = ReadUint32(&bytes[12]);
+
+  if (bytes.size() - kHeaderSize < entries_size) {
+    return false;
+  }
+
+  std::span<const std::byte> entries = bytes.subspan(kHeaderSize, entries_size);
+  const std::span<const std::byte> strings =
+      bytes.subspan(kHeaderSize + entries_size);
+
+  // Every string must be terminated, so the table must end with a null.
+  if (entry_count != 0u &&
+      (strings.empty() || strings.back() != std::byte{'\0'})) {
+    return false;
+  }
+
+  uint64_t token = 0;
+  for (uint32_t i = 0; i < entry_count; ++i) {
+    uint32_t values[3];  // token delta, date removed + 1, string offset
+    for (uint32_t& value : values) {
+      const size_t bytes_read = DecodeUint32(entries, value);
+      if (bytes_read == 0u) {
+        return false;
+      }
+      entries = entries.subspan(bytes_read);
+    }
+
+    token += values[0];
+    if (token > UINT32_MAX || values[2] >= strings.size()) {
+      return false;
+    }
+  }
+
+  // The entry table must contain exactly the entries.
+  return entries.empty();
+}
+
+CompactTokenDatabase::CompactTokenDatabase(std::span<const std::byte> bytes)
+    : entries_(&bytes[kHeaderSize]),
+      strings_(reinterpret_cast<const char*>(&bytes[kHeaderSize]) +
+               ReadUint32(&bytes[12])),
+      size_(ReadUint32(&bytes[8])) {}
+
+CompactTokenDatabase::Iterator CompactTokenDatabase::begin() const {
+  Iterator it(entries_, strings_, size_);
+  if (size_ != 0u) {
+    it.Decode();
+  }
+  return it;
+}
+
+CompactTokenDatabase::Iterator CompactTokenDatabase::Find(
+    uint32_t token) const {
+  Iterator it = begin();
+  while (it != end() && it->token < token) {
+    ++it;
+  }
+  return it != end() && it->token == token ? it : end();
+}
+
+CompactTokenDatabase::Iterator& CompactTokenDatabase::Iterator::operator++() {
+  remaining_ -= 1;
+  if (remaining_ != 0u) {
+    Decode();
+  }
+  return *this;
+}
+
+void CompactTokenDatabase::Iterator::Decode() {
+  // The database was validated when it was created, so the varints are known
+  // to be well formed and in bounds.
+  uint32_t values[3];
+  for (uint32_t& value : values) {
+    next_ += DecodeUint32(std::span(next_, varint::kMaxVarint32SizeBytes),
+                          value);
+  }
+
+  entry_.token += values[0];
+  entry_.date_removed = values[1] - 1;  // 0 wraps to 0xFFFFFFFF (not removed)
+  entry_.string = strings_ + values[2];
+}
+
+}  // namespace pw::tokenizer
@@ -0,0 +1,146 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_tokenizer/compact_token_database.h"
+
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_tokenizer/detokenize.h"
+
+namespace pw::tokenizer {
+namespace {
+
+using namespace std::literals::string_view_literals;
+
+// Four entries. "i!" shares storage with "hi!", and two entries share
+// "goodbye".
+constexpr char kBasicData[] =
+    "TOKENS\1\0\x04\0\0\0\x0d\0\0\0"
+    "\x01\x00\x00"      // token 1, not removed, "hi!"
+    "\x01\x06\x04"      // token 2, removed on date 5, "goodbye"
+    "\xfe\x01\x00\x01"  // token 0x100, not removed, "i!"
+    "\x00\x00\x04"      // token 0x100, not removed, "goodbye"
+    "hi!\0"
+    "goodbye";  // Last byte is null terminator.
+
+constexpr char kEmptyData[] = "TOKENS\1\0\0\0\0\0\0\0\0";
+
+TEST(CompactTokenDatabase, IsValid) {
+  EXPECT_TRUE(CompactTokenDatabase::IsValid(kBasicData));
+  EXPECT_TRUE(CompactTokenDatabase::IsValid(kEmptyData));
+
+  // The version 0 format is not a compact database.
+  EXPECT_FALSE(CompactTokenDatabase::IsValid("TOKENS\0\0\0\0\0\0\0\0\0"sv));
+  EXPECT_FALSE(CompactTokenDatabase::IsValid("TOKENS\1\0\0\0\0"sv));
+}
+
+TEST(CompactTokenDatabase, IsValid_EntryTableMismatch) {
+  // Entry table size too small for the entries.
+  EXPECT_FALSE(CompactTokenDatabase::IsValid(
+      "TOKENS\1\0\x01\0\0\0\x02\0\0\0\x01\x00\x00hi\0"sv));
+  // Entry table size larger than the entries.
+  EXPECT_FALSE(CompactTokenDatabase::IsValid(
+      "TOKENS\1\0\x01\0\0\0\x04\0\0\0\x01\x00\x00\x00hi\0"sv));
+  // Entry table size larger than the data.
+  EXPECT_FALSE(CompactTokenDatabase::IsValid(
+      "TOKENS\1\0\x01\0\0\0\x40\0\0\0\x01\x00\x00hi\0"sv));
+}
+
+TEST(CompactTokenDatabase, IsValid_BadStrings) {
+  // String offset past the string table.
+  EXPECT_FALSE(CompactTokenDatabase::IsValid(
+      "TOKENS\1\0\x01\0\0\0\x03\0\0\0\x01\x00\x03hi\0"sv));
+  // Unterminated string table.
+  EXPECT_FALSE(CompactTokenDatabase::IsValid(
+      "TOKENS\1\0\x01\0\0\0\x03\0\0\0\x01\x00\x00hi"sv));
+}
+
+TEST(CompactTokenDatabase, IsValid_TokenOverflow) {
+  EXPECT_FALSE(CompactTokenDatabase::IsValid(
+      "TOKENS\1\0\x02\0\0\0\x0a\0\0\0"
+      "\xff\xff\xff\xff\x0f\x00\x00"
+      "\x01\x00\x00"
+      "\0"sv));
+}
+
+TEST(CompactTokenDatabase, Create_Invalid) {
+  const CompactTokenDatabase db = CompactTokenDatabase::Create("TOKENS"sv);
+  EXPECT_FALSE(db.ok());
+  EXPECT_EQ(db.begin(), db.end());
+}
+
+TEST(CompactTokenDatabase, Empty) {
+  const CompactTokenDatabase db = CompactTokenDatabase::Create(kEmptyData);
+  ASSERT_TRUE(db.ok());
+  EXPECT_EQ(0u, db.size());
+  EXPECT_EQ(db.begin(), db.end());
+  EXPECT_EQ(db.Find(0), db.end());
+}
+
+TEST(CompactTokenDatabase, Iterate) {
+  const CompactTokenDatabase db = CompactTokenDatabase::Create(kBasicData);
+  ASSERT_TRUE(db.ok());
+  EXPECT_EQ(4u, db.size());
+
+  auto it = db.begin();
+  EXPECT_EQ(1u, it->token);
+  EXPECT_EQ(0xFFFFFFFFu, it->date_removed);
+  EXPECT_EQ("hi!"sv, it->string);
+
+  ++it;
+  EXPECT_EQ(2u, it->token);
+  EXPECT_EQ(5u, it->date_removed);
+  EXPECT_EQ("goodbye"sv, it->string);
+
+  ++it;
+  EXPECT_EQ(0x100u, it->token);
+  EXPECT_EQ(0xFFFFFFFFu, it->date_removed);
+  EXPECT_EQ("i!"sv, it->string);
+
+  ++it;
+  EXPECT_EQ(0x100u, it->token);
+  EXPECT_EQ("goodbye"sv, it->string);
+
+  ++it;
+  EXPECT_EQ(db.end(), it);
+}
+
+TEST(CompactTokenDatabase, Find) {
+  const CompactTokenDatabase db = CompactTokenDatabase::Create(kBasicData);
+
+  EXPECT_EQ("goodbye"sv, db.Find(2)->string);
+  EXPECT_EQ(db.end(), db.Find(0));
+  EXPECT_EQ(db.end(), db.Find(3));
+  EXPECT_EQ(db.end(), db.Find(0x101));
+
+  auto it = db.Find(0x100);
+  EXPECT_EQ("i!"sv, it->string);
+  ++it;
+  EXPECT_EQ(0x100u, it->token);
+  EXPECT_EQ("goodbye"sv, it->string);
+}
+
+TEST(CompactTokenDatabase, Detokenize) {
+  const CompactTokenDatabase db = CompactTokenDatabase::Create(kBasicData);
+
+  Detokenizer detok(db);
+  EXPECT_EQ("hi!", detok.Detokenize("\1\0\0\0"sv).BestString());
+
+  FlatDetokenizer flat(db);
+  EXPECT_EQ("goodbye", flat.Detokenize("\2\0\0\0"sv).BestString());
+}
+
+}  // namespace
+}  // namespace pw::tokenizer
@@ -303,6 +303,38 @@ size_t DecodedFormatString::decoding_errors() const {
   });
 }
 
+std::optional<uint32_t> DecodedFormatString::NestedToken(size_t index) const {
+  const DecodedArg& arg = segments_[index];
+  const std::string& prefix = segments_[index - 1].value();
+
+  if (!arg.ok() || arg.spec().empty() ||
+      (arg.spec().back() != 'x' && arg.spec().back() != 'X') ||
+      !segments_[index - 1].spec().empty() || prefix.size() < 2u ||
+      prefix.compare(prefix.size() - 2, 2, "$#") != 0) {
+    return std::nullopt;
+  }
+
+  const std::string& digits = arg.value();
+  if (digits.empty() || digits.size() > 8u) {
+    return std::nullopt;
+  }
+
+  uint32_t token = 0;
+  for (char digit : digits) {
+    token <<= 4;
+    if (digit >= '0' && digit <= '9') {
+      token |= static_cast<uint32_t>(digit - '0');
+    } else if (digit >= 'a' && digit <= 'f') {
+      token |= static_cast<uint32_t>(digit - 'a' + 10);
+    } else if (digit >= 'A' && digit <= 'F') {
+      token |= static_cast<uint32_t>(digit - 'A' + 10);
+    } else {
+      return std::nullopt;
+    }
+  }
+  return token;
+}
+
 FormatString::FormatString(const char* format) {
   const char* text_start = format;
 
@@ -334,6 +366,7 @@ FormatString::FormatString(const char* format) {
 DecodedFormatString FormatString::Format(
     std::span<const uint8_t> arguments) const {
   std::vector<DecodedArg> results;
+  results.reserve(segments_.size());
   bool skip = false;
 
   for (const auto& segment : segments_) {
@@ -99,6 +99,14 @@ TEST(TokenizedStringDecode, Truncation_NotAnError) {
   EXPECT_EQ(result.decoding_errors(), 0u);
 }
 
+TEST(TokenizedStringDecode, LongValues_AreNotTruncated) {
+  EXPECT_EQ(FormatString("%40d").Format("\x02").value(),
+            std::string(39, ' ') + "1");
+  const std::string long_string(100, 'x');
+  EXPECT_EQ(kOneArg.Format(std::string("\x64") + long_string).value(),
+            "Hello " + long_string);
+}
+
 TEST(TokenizedStringDecode, WrongStringLenth_IsErrorAndConsumesRestOfString) {
   auto result = kTwoArgs.Format("\6\x0amusketeer");
   EXPECT_EQ(result.value(), "The 3 %s");
@@ -15,12 +15,33 @@
 #include "pw_tokenizer/detokenize.h"
 
 #include <algorithm>
+#include <optional>
 
+// Some embedded standard libraries, such as libstdc++ for arm-none-eabi, do not
+// provide std::thread. Batches are decoded on the calling thread with them.
+#if defined(__GLIBCXX__) && !defined(_GLIBCXX_HAS_GTHREADS)
+#define PW_TOKENIZER_DETOKENIZE_THREADS 0
+#else
+#define PW_TOKENIZER_DETOKENIZE_THREADS 1
+#include <thread>
+#endif  // defined(__GLIBCXX__) && !defined(_GLIBCXX_HAS_GTHREADS)
+
+#include "pw_assert/assert.h"
 #include "pw_tokenizer/internal/decode.h"
 
 namespace pw::tokenizer {
 namespace {
 
+template <typename Database>
+std::vector<TokenDatabase::Entry> CopyEntries(const Database& database) {
+  std::vector<TokenDatabase::Entry> entries;
+  entries.reserve(database.size());
+  for (const TokenDatabase::Entry& entry : database) {
+    entries.push_back(entry);
+  }
+  return entries;
+}
+
 std::string UnknownTokenMessage(uint32_t value) {
   std::string output(PW_TOKENIZER_ARG_DECODING_ERROR_PREFIX "unknown token ");
 
@@ -65,26 +86,123 @@ bool IsBetterResult(const DecodingResult& lhs, const DecodingResult& rhs) {
   return lhs.second > rhs.second;
 }
 
-}  // namespace
+const FormatString& GetFormat(const FormatString& format) { return format; }
+const FormatString& GetFormat(const FormatString* format) { return *format; }
+
+// Decodes the arguments with each entry's format string. Returns the results
+// with the best matches first.
+template <typename Entry>
+std::vector<DecodedFormatString> DecodeMatches(
+    const std::span<const Entry>& entries,
+    const std::span<const uint8_t>& arguments) {
+  std::vector<DecodedFormatString> matches;
+
+  // Most tokens have only one string, so there is nothing to sort.
+  if (entries.size() == 1u) {
+    matches.push_back(GetFormat(entries[0].first).Format(arguments));
+    return matches;
+  }
 
-DetokenizedString::DetokenizedString(
-    uint32_t token,
-    const std::span<const TokenizedStringEntry>& entries,
-    const std::span<const uint8_t>& arguments)
-    : token_(token), has_token_(true) {
   std::vector<DecodingResult> results;
+  results.reserve(entries.size());
 
   for (const auto& [format, date_removed] : entries) {
-    results.push_back(DecodingResult{format.Format(arguments), date_removed});
+    results.push_back(
+        DecodingResult{GetFormat(format).Format(arguments), date_removed});
   }
 
   std::sort(results.begin(), results.end(), IsBetterResult);
 
+  matches.reserve(results.size());
   for (auto& result : results) {
-    matches_.push_back(std::move(result.first));
+    matches.push_back(std::move(result.first));
   }
+  return matches;
 }
 
+// Detokenizes each message in a batch, starting threads - 1 threads to decode
+// some of them.
+template <typename DetokenizerType>
+void DetokenizeInParallel(const DetokenizerType& detokenizer,
+                          std::span<const std::span<const uint8_t>> encoded,
+                          std::span<DetokenizedString> output,
+                          size_t threads) {
+  PW_ASSERT(output.size() >= encoded.size());
+
+  const auto detokenize_range = [&detokenizer, encoded, output](size_t begin,
+                                                                size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      output[i] = detokenizer.Detokenize(encoded[i]);
+    }
+  };
+
+#if !PW_TOKENIZER_DETOKENIZE_THREADS
+  threads = 1;
+#endif  // !PW_TOKENIZER_DETOKENIZE_THREADS
+
+  threads = std::max<size_t>(1, std::min(threads, encoded.size()));
+  const size_t per_thread = (encoded.size() + threads - 1) / threads;
+
+#if PW_TOKENIZER_DETOKENIZE_THREADS
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+
+  for (size_t begin = per_thread; begin < encoded.size(); begin += per_thread) {
+    workers.emplace_back(detokenize_range,
+                         begin,
+                         std::min(begin + per_thread, encoded.size()));
+  }
+#endif  // PW_TOKENIZER_DETOKENIZE_THREADS
+
+  // Decode the first part of the batch on this thread.
+  detokenize_range(0, std::min(per_thread, encoded.size()));
+
+#if PW_TOKENIZER_DETOKENIZE_THREADS
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+#endif  // PW_TOKENIZER_DETOKENIZE_THREADS
+}
+
+// Reads the little-endian token from the start of an encoded message.
+uint32_t ReadToken(const std::span<const uint8_t>& encoded) {
+  return encoded[3] << 24 | encoded[2] << 16 | encoded[1] << 8 | encoded[0];
+}
+
+// Returns the string for a nested token, if it detokenizes successfully.
+template <typename DetokenizerType>
+std::optional<std::string> DetokenizeNested(const DetokenizerType& detokenizer,
+                                            uint32_t token) {
+  const uint8_t encoded[] = {static_cast<uint8_t>(token),
+                             static_cast<uint8_t>(token >> 8),
+                             static_cast<uint8_t>(token >> 16),
+                             static_cast<uint8_t>(token >> 24)};
+  const DetokenizedString nested =
+      detokenizer.Detokenize(std::span<const uint8_t>(encoded));
+  if (!nested.ok()) {
+    return std::nullopt;
+  }
+  return nested.BestString();
+}
+
+}  // namespace
+
+DetokenizedString::DetokenizedString(
+    uint32_t token,
+    const std::span<const TokenizedStringEntry>& entries,
+    const std::span<const uint8_t>& arguments)
+    : token_(token),
+      has_token_(true),
+      matches_(DecodeMatches(entries, arguments)) {}
+
+DetokenizedString::DetokenizedString(
+    uint32_t token,
+    const std::span<const FormatStringEntry>& entries,
+    const std::span<const uint8_t>& arguments)
+    : token_(token),
+      has_token_(true),
+      matches_(DecodeMatches(entries, arguments)) {}
+
 std::string DetokenizedString::BestString() const {
   return matches_.empty() ? std::string() : matches_[0].value();
 }
@@ -103,6 +221,12 @@ Detokenizer::Detokenizer(const TokenDatabase& database) {
   }
 }
 
+Detokenizer::Detokenizer(const CompactTokenDatabase& database) {
+  for (const auto& entry : database) {
+    database_[entry.token].emplace_back(entry.string, entry.date_removed);
+  }
+}
+
 DetokenizedString Detokenizer::Detokenize(
     const std::span<const uint8_t>& encoded) const {
   // The token is missing from the encoded data; there is nothing to do.
@@ -110,16 +234,119 @@ DetokenizedString Detokenizer::Detokenize(
     return DetokenizedString();
   }
 
-  const uint32_t token =
-      encoded[3] << 24 | encoded[2] << 16 | encoded[1] << 8 | encoded[0];
+  const uint32_t token = ReadToken(encoded);
 
   const auto result = database_.find(token);
 
-  return DetokenizedString(token,
-                           result == database_.end()
-                               ? std::span<TokenizedStringEntry>()
-                               : std::span(result->second),
-                           encoded.subspan(sizeof(token)));
+  DetokenizedString detokenized(token,
+                                result == database_.end()
+                                    ? std::span<TokenizedStringEntry>()
+                                    : std::span(result->second),
+                                encoded.subspan(sizeof(token)));
+  detokenized.ExpandNestedTokens(
+      [this](uint32_t nested) { return DetokenizeNested(*this, nested); });
+  return detokenized;
+}
+
+void Detokenizer::DetokenizeBatch(
+    std::span<const std::span<const uint8_t>> encoded,
+    std::span<DetokenizedString> output,
+    size_t threads) const {
+  DetokenizeInParallel(*this, encoded, output, threads);
+}
+
+FlatDetokenizer::FlatDetokenizer(const TokenDatabase& database)
+    : FlatDetokenizer(CopyEntries(database)) {}
+
+FlatDetokenizer::FlatDetokenizer(const CompactTokenDatabase& database)
+    : FlatDetokenizer(CopyEntries(database)) {}
+
+FlatDetokenizer::FlatDetokenizer(std::vector<TokenDatabase::Entry>&& entries)
+    : entries_(std::move(entries)) {
+  // Binary token databases are sorted by token, so this is usually a no-op.
+  constexpr auto by_token = [](const TokenDatabase::Entry& lhs,
+                               const TokenDatabase::Entry& rhs) {
+    return lhs.token < rhs.token;
+  };
+  if (!std::is_sorted(entries_.begin(), entries_.end(), by_token)) {
+    std::stable_sort(entries_.begin(), entries_.end(), by_token);
+  }
+
+  formats_ = std::make_unique<std::atomic<const FormatString*>[]>(
+      entries_.size());
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    formats_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+FlatDetokenizer::~FlatDetokenizer() {
+  if (formats_ == nullptr) {  // Moved from
+    return;
+  }
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    delete formats_[i].load(std::memory_order_relaxed);
+  }
+}
+
+const FormatString& FlatDetokenizer::Format(size_t index) const {
+  std::atomic<const FormatString*>& cached = formats_[index];
+
+  const FormatString* format = cached.load(std::memory_order_acquire);
+  if (format != nullptr) {
+    return *format;
+  }
+
+  // Parse the string without a lock. If another thread cached it first, use
+  // that thread's copy instead.
+  auto parsed = std::make_unique<FormatString>(entries_[index].string);
+  if (cached.compare_exchange_strong(format,
+                                     parsed.get(),
+                                     std::memory_order_acq_rel,
+                                     std::memory_order_acquire)) {
+    return *parsed.release();
+  }
+  return *format;
+}
+
+DetokenizedString FlatDetokenizer::Detokenize(
+    const std::span<const uint8_t>& encoded) const {
+  // The token is missing from the encoded data; there is nothing to do.
+  if (encoded.size() < sizeof(uint32_t)) {
+    return DetokenizedString();
+  }
+
+  const uint32_t token = ReadToken(encoded);
+
+  struct ByToken {
+    bool operator()(const TokenDatabase::Entry& entry, uint32_t value) const {
+      return entry.token < value;
+    }
+    bool operator()(uint32_t value, const TokenDatabase::Entry& entry) const {
+      return value < entry.token;
+    }
+  };
+  const auto [begin, end] =
+      std::equal_range(entries_.begin(), entries_.end(), token, ByToken());
+
+  std::vector<DetokenizedString::FormatStringEntry> matches;
+  matches.reserve(end - begin);
+  for (auto entry = begin; entry != end; ++entry) {
+    matches.emplace_back(&Format(entry - entries_.begin()),
+                         entry->date_removed);
+  }
+
+  DetokenizedString detokenized(
+      token, matches, encoded.subspan(sizeof(token)));
+  detokenized.ExpandNestedTokens(
+      [this](uint32_t nested) { return DetokenizeNested(*this, nested); });
+  return detokenized;
+}
+
+void FlatDetokenizer::DetokenizeBatch(
+    std::span<const std::span<const uint8_t>> encoded,
+    std::span<DetokenizedString> output,
+    size_t threads) const {
+  DetokenizeInParallel(*this, encoded, output, threads);
 }
 
 }  // namespace pw::tokenizer
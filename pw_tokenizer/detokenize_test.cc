@@ -14,6 +14,8 @@
 
 #include "pw_tokenizer/detokenize.h"
 
+#include <array>
+#include <span>
 #include <string_view>
 
 #include "gtest/gtest.h"
@@ -285,5 +287,232 @@ TEST_F(DetokenizeWithCollisions, Collision_TracksAllMatches) {
   EXPECT_EQ(result.matches().size(), 7u);
 }
 
+class FlatDetokenize : public ::testing::Test {
+ protected:
+  FlatDetokenize()
+      : basic_(TokenDatabase::Create<kBasicData>()),
+        args_(kWithArgs),
+        collisions_(kWithCollisions) {}
+
+  FlatDetokenizer basic_;
+  FlatDetokenizer args_;
+  FlatDetokenizer collisions_;
+};
+
+TEST_F(FlatDetokenize, NoFormatting) {
+  EXPECT_EQ(basic_.Detokenize("\1\0\0\0"sv).BestString(), "One");
+  EXPECT_EQ(basic_.Detokenize("\5\0\0\0"sv).BestString(), "TWO");
+  EXPECT_EQ(basic_.Detokenize("\xff\x00\x00\x00"sv).BestString(), "333");
+  EXPECT_EQ(basic_.Detokenize("\xff\xee\xee\xdd"sv).BestString(), "FOUR");
+}
+
+TEST_F(FlatDetokenize, MissingToken_ErrorMessage) {
+  EXPECT_FALSE(basic_.Detokenize("").ok());
+  EXPECT_EQ(basic_.Detokenize("\1\0\0"sv).BestStringWithErrors(),
+            ERR("missing token"));
+}
+
+TEST_F(FlatDetokenize, UnknownToken_ErrorMessage) {
+  EXPECT_FALSE(basic_.Detokenize("\2\0\0\0"sv).ok());
+  EXPECT_EQ(basic_.Detokenize("\2\0\0\0"sv).BestStringWithErrors(),
+            ERR("unknown token 00000002"));
+  EXPECT_EQ(basic_.Detokenize("\x00\x00\x00\xff"sv).BestStringWithErrors(),
+            ERR("unknown token ff000000"));
+}
+
+TEST_F(FlatDetokenize, UnsortedDatabase_FindsAllTokens) {
+  // The entries in kDataWithArguments are not sorted by token.
+  for (auto [data, expected] : TestCases(
+           Case{"\x0A\x0B\x0C\x0D\5force\4Luke"sv, "Use the force, Luke."},
+           Case{"\x0E\x0F\x00\x01\4\4them"sv, "Now there are 2 of them!"},
+           Case{"\xAA\xAA\xAA\xAA\xfc\x01"sv, "~!"},
+           Case{"\xCC\xCC\xCC\xCC\xfe\xff\x07"sv, "65535!"},
+           Case{"\xDD\xDD\xDD\xDD\xfe\xff\x07"sv, "65535!"},
+           Case{"\xEE\xEE\xEE\xEE\xfe\xff\x07"sv, "65535!"})) {
+    EXPECT_EQ(args_.Detokenize(data).BestString(), expected);
+  }
+  EXPECT_EQ(args_.Detokenize("\x00\x00\x00\x00"sv).matches().size(), 1u);
+  EXPECT_TRUE(args_.Detokenize("\x23\xab\xc9\x87"sv).matches().empty());
+}
+
+TEST_F(FlatDetokenize, Collisions_MatchDetokenizer) {
+  Detokenizer detok(kWithCollisions);
+
+  for (std::string_view data : {"\0\0\0\0"sv,
+                                "\0\0\0\0\x01"sv,
+                                "\0\0\0\0\4Hey!\x04"sv,
+                                "\0\0\0\0\x80\x80\x80\x80\x00"sv,
+                                "\0\0\0\0\x01\x00\x01\x02"sv,
+                                "\xAA\xAA\xAA\xAA"sv,
+                                "\xBB\xBB\xBB\xBB\x00"sv,
+                                "\xCC\xCC\xCC\xCC\2Yo\5?"sv,
+                                "\xDD\xDD\xDD\xDD\x01\x02\x01\x04\x05"sv}) {
+    auto expected = detok.Detokenize(data);
+    auto result = collisions_.Detokenize(data);
+
+    ASSERT_EQ(result.matches().size(), expected.matches().size());
+    EXPECT_EQ(result.ok(), expected.ok());
+    EXPECT_EQ(result.BestString(), expected.BestString());
+    EXPECT_EQ(result.BestStringWithErrors(), expected.BestStringWithErrors());
+  }
+}
+
+TEST_F(FlatDetokenize, CachedFormatStrings_DecodeEachMessage) {
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(args_.Detokenize("\x0A\x0B\x0C\x0D\5force\4Luke"sv).BestString(),
+              "Use the force, Luke.");
+    EXPECT_EQ(args_.Detokenize("\x0A\x0B\x0C\x0D\4Jedi\3Rey"sv).BestString(),
+              "Use the Jedi, Rey.");
+  }
+}
+
+TEST_F(FlatDetokenize, MovedFrom_KeepsCachedFormatStrings) {
+  EXPECT_EQ(args_.Detokenize("\xAA\xAA\xAA\xAA\xfc\x01"sv).BestString(), "~!");
+
+  FlatDetokenizer moved(std::move(args_));
+  EXPECT_EQ(moved.Detokenize("\xAA\xAA\xAA\xAA\xfc\x01"sv).BestString(), "~!");
+  EXPECT_EQ(moved.Detokenize("\x0E\x0F\x00\x01\4\4them"sv).BestString(),
+            "Now there are 2 of them!");
+}
+
+TEST_F(FlatDetokenize, Collisions_TracksAllMatches) {
+  EXPECT_EQ(collisions_.Detokenize("\0\0\0\0"sv).matches().size(), 7u);
+  EXPECT_EQ(collisions_.Detokenize("\xAA\xAA\xAA\xAA"sv).BestString(),
+            "This one is present");
+}
+
+alignas(TokenDatabase::RawEntry) constexpr char kDataWithNestedTokens[] =
+    "TOKENS\0\0"
+    "\x05\x00\x00\x00"
+    "\0\0\0\0"
+    "\x01\x00\x00\x00----"
+    "\x02\x00\x00\x00----"
+    "\x03\x00\x00\x00----"
+    "\x04\x00\x00\x00----"
+    "\xFF\xEE\xEE\xDD----"
+    "Entering $#%08x state\0"
+    "IDLE\0"
+    "$#%08x -> $#%08X\0"
+    "Cost: $%x\0"
+    "RUNNING";
+
+class DetokenizeNestedTokens : public ::testing::Test {
+ protected:
+  DetokenizeNestedTokens()
+      : detok_(TokenDatabase::Create<kDataWithNestedTokens>()),
+        flat_detok_(TokenDatabase::Create<kDataWithNestedTokens>()) {}
+
+  Detokenizer detok_;
+  FlatDetokenizer flat_detok_;
+};
+
+TEST_F(DetokenizeNestedTokens, KnownToken_Expanded) {
+  EXPECT_EQ(detok_.Detokenize("\1\0\0\0\x04"sv).BestString(),
+            "Entering IDLE state");
+  EXPECT_EQ(flat_detok_.Detokenize("\1\0\0\0\x04"sv).BestString(),
+            "Entering IDLE state");
+}
+
+TEST_F(DetokenizeNestedTokens, LargeToken_Expanded) {
+  EXPECT_EQ(
+      detok_.Detokenize("\1\0\0\0\x81\xc4\x88\xa1\x04"sv).BestString(),
+      "Entering RUNNING state");
+}
+
+TEST_F(DetokenizeNestedTokens, MultipleTokens_Expanded) {
+  EXPECT_EQ(detok_.Detokenize("\3\0\0\0\x04\x81\xc4\x88\xa1\x04"sv)
+                .BestString(),
+            "IDLE -> RUNNING");
+}
+
+TEST_F(DetokenizeNestedTokens, UnknownToken_LeftAsIs) {
+  EXPECT_EQ(detok_.Detokenize("\1\0\0\0\x0e"sv).BestString(),
+            "Entering $#00000007 state");
+  EXPECT_EQ(flat_detok_.Detokenize("\1\0\0\0\x0e"sv).BestString(),
+            "Entering $#00000007 state");
+}
+
+TEST_F(DetokenizeNestedTokens, HexWithoutMarker_NotExpanded) {
+  EXPECT_EQ(detok_.Detokenize("\4\0\0\0\x04"sv).BestString(), "Cost: $2");
+}
+
+class DetokenizeBatch : public ::testing::Test {
+ protected:
+  static constexpr std::string_view kMessages[] = {
+      "\x0A\x0B\x0C\x0D\5force\4Luke"sv,
+      "\x0E\x0F\x00\x01\4\4them"sv,
+      "\xAA\xAA\xAA\xAA\xfc\x01"sv,
+      "\x23\xab\xc9\x87"sv,
+      "\x0A\x0B"sv,
+      "\x0E\x0F\x00\x01\xFF"sv,
+      "\xCC\xCC\xCC\xCC\xfe\xff\x07"sv,
+  };
+
+  DetokenizeBatch() : detok_(kWithArgs), flat_detok_(kWithArgs) {
+    for (size_t i = 0; i < encoded_.size(); ++i) {
+      const std::string_view message = kMessages[i % std::size(kMessages)];
+      encoded_[i] = std::span(
+          reinterpret_cast<const uint8_t*>(message.data()), message.size());
+    }
+  }
+
+  template <typename DetokenizerType>
+  void ExpectMatchesSingleMessages(
+      const DetokenizerType& detok,
+      const std::span<const DetokenizedString>& output) {
+    for (size_t i = 0; i < encoded_.size(); ++i) {
+      const DetokenizedString expected = detok.Detokenize(encoded_[i]);
+      EXPECT_EQ(output[i].ok(), expected.ok());
+      EXPECT_EQ(output[i].BestStringWithErrors(),
+                expected.BestStringWithErrors());
+    }
+  }
+
+  Detokenizer detok_;
+  FlatDetokenizer flat_detok_;
+  std::array<std::span<const uint8_t>, 100> encoded_;
+  std::array<DetokenizedString, 100> output_;
+};
+
+TEST_F(DetokenizeBatch, OneThread_MatchesSingleMessages) {
+  detok_.DetokenizeBatch(encoded_, output_);
+  ExpectMatchesSingleMessages(detok_, output_);
+
+  EXPECT_EQ(output_[0].BestString(), "Use the force, Luke.");
+  EXPECT_EQ(output_[3].BestStringWithErrors(),
+            ERR("unknown token 87c9ab23"));
+  EXPECT_EQ(output_[4].BestStringWithErrors(), ERR("missing token"));
+}
+
+TEST_F(DetokenizeBatch, MultipleThreads_MatchesSingleMessages) {
+  for (size_t threads : {2u, 3u, 8u, 1000u}) {
+    output_ = {};
+    detok_.DetokenizeBatch(encoded_, output_, threads);
+    ExpectMatchesSingleMessages(detok_, output_);
+  }
+}
+
+TEST_F(DetokenizeBatch, FlatDetokenizer_MatchesSingleMessages) {
+  flat_detok_.DetokenizeBatch(encoded_, output_, 4);
+  ExpectMatchesSingleMessages(flat_detok_, output_);
+
+  output_ = {};
+  flat_detok_.DetokenizeBatch(encoded_, output_);
+  ExpectMatchesSingleMessages(flat_detok_, output_);
+}
+
+TEST_F(DetokenizeBatch, EmptyBatch_DoesNothing) {
+  detok_.DetokenizeBatch({}, output_, 4);
+  flat_detok_.DetokenizeBatch({}, output_, 4);
+  EXPECT_TRUE(output_[0].matches().empty());
+}
+
+TEST_F(DetokenizeBatch, LargerOutput_OnlyFillsBatchSize) {
+  detok_.DetokenizeBatch(std::span(encoded_).first(2), output_, 2);
+  EXPECT_EQ(output_[0].BestString(), "Use the force, Luke.");
+  EXPECT_EQ(output_[1].BestString(), "Now there are 2 of them!");
+  EXPECT_TRUE(output_[2].matches().empty());
+}
+
 }  // namespace
 }  // namespace pw::tokenizer
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <type_traits>
 
 #include "pw_preprocessor/compiler.h"
 #include "pw_varint/varint.h"
@@ -38,12 +39,46 @@ static_assert(0b01u == static_cast<uint8_t>(ArgType::kInt64));
 static_assert(0b10u == static_cast<uint8_t>(ArgType::kDouble));
 static_assert(0b11u == static_cast<uint8_t>(ArgType::kString));
 
+// Encodes an unsigned integer as a LEB128 varint. Unlike the general-purpose
+// varint encoder, this supports only one format and uses the integer's own
+// width, so ints are encoded without 64-bit arithmetic on 32-bit targets.
+template <typename T>
+size_t EncodeVarint(T value, const std::span<std::byte>& output) {
+  static_assert(std::is_unsigned_v<T>);
+  constexpr size_t kMaxBytes = (sizeof(T) * 8 + 6) / 7;
+
+  std::byte* const data = output.data();
+  size_t size = 0;
+
+  // Skip the bounds checks if the output has room for any value.
+  if (output.size() >= kMaxBytes) {
+    while (value > 0x7Fu) {
+      data[size++] = static_cast<std::byte>(value | 0x80u);
+      value >>= 7;
+    }
+  } else {
+    while (value > 0x7Fu) {
+      if (size + 1 >= output.size()) {
+        return 0;
+      }
+      data[size++] = static_cast<std::byte>(value | 0x80u);
+      value >>= 7;
+    }
+    if (size == output.size()) {
+      return 0;
+    }
+  }
+
+  data[size++] = static_cast<std::byte>(value);
+  return size;
+}
+
 size_t EncodeInt(int value, const std::span<std::byte>& output) {
-  return varint::Encode(value, std::as_writable_bytes(output));
+  return EncodeVarint(varint::ZigZagEncode(value), output);
 }
 
 size_t EncodeInt64(int64_t value, const std::span<std::byte>& output) {
-  return varint::Encode(value, std::as_writable_bytes(output));
+  return EncodeVarint(varint::ZigZagEncode(value), output);
 }
 
 size_t EncodeFloat(float value, const std::span<std::byte>& output) {
@@ -0,0 +1,157 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+
+#include "pw_tokenizer/token_database.h"
+
+namespace pw::tokenizer {
+
+// Reads entries from a compact binary token string database. This class does
+// not copy or modify the contents of the database.
+//
+// The compact format is version 1 of the binary token database format. It has
+// the same 16-byte header as TokenDatabase, except that the reserved field
+// holds the size of the entry table. Entries are variable length and strings
+// are shared where possible, which makes the database much smaller than the
+// version 0 format read by TokenDatabase.
+//
+//            Header
+//            ======
+//   Offset  Size  Field
+//   -----------------------------------
+//        0     6  Magic number (TOKENS)
+//        6     2  Version (01 00)
+//        8     4  Entry count
+//       12     4  Entry table size in bytes
+//
+// The entry table follows the header. Entries are sorted by token. Each entry
+// is three unsigned LEB128 varints:
+//
+//   - The token, as the difference from the previous entry's token. The first
+//     entry's token is stored as is.
+//   - The removal date plus one, modulo 2^32. Entries that were never removed
+//     (0xFFFFFFFF) store 0 in a single byte.
+//   - The offset of the entry's string in the string table.
+//
+// The string table follows the entry table and contains null-terminated
+// strings. Duplicate strings are stored once, and a string that is a suffix of
+// another string points into that string.
+//
+// Entries are accessed by iterating over the database. Since entries must be
+// decoded in order, Find is O(n).
+class CompactTokenDatabase {
+ public:
+  using Entry = TokenDatabase::Entry;
+
+  // Iterator for CompactTokenDatabase entries. Each increment decodes the next
+  // entry from the entry table.
+  class Iterator {
+   public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = Entry;
+    using pointer = const Entry*;
+    using reference = const Entry&;
+    using iterator_category = std::forward_iterator_tag;
+
+    constexpr Iterator() : Iterator(nullptr, nullptr, 0) {}
+
+    const Entry& operator*() const { return entry_; }
+    const Entry* operator->() const { return &entry_; }
+
+    Iterator& operator++();
+    Iterator operator++(int) {
+      Iterator previous = *this;
+      operator++();
+      return previous;
+    }
+
+    bool operator==(const Iterator& rhs) const {
+      return remaining_ == rhs.remaining_;
+    }
+    bool operator!=(const Iterator& rhs) const { return !(*this == rhs); }
+
+   private:
+    friend class CompactTokenDatabase;
+
+    constexpr Iterator(const std::byte* entry,
+                       const char* strings,
+                       uint32_t remaining)
+        : next_(entry), strings_(strings), remaining_(remaining), entry_{} {}
+
+    // Decodes the entry at next_ into entry_ and advances next_ past it.
+    void Decode();
+
+    const std::byte* next_;
+    const char* strings_;
+    uint32_t remaining_;  // Entries left, including the current one.
+    Entry entry_;
+  };
+
+  // Returns true if the provided data is a valid compact token database. This
+  // checks the header and decodes every entry, so it is O(n).
+  template <typename ByteArray>
+  static bool IsValid(const ByteArray& bytes) {
+    static_assert(sizeof(*std::data(bytes)) == 1u);
+    return IsValid(std::as_bytes(std::span(std::data(bytes), std::size(bytes))));
+  }
+
+  static bool IsValid(std::span<const std::byte> bytes);
+
+  // Creates a CompactTokenDatabase from the provided byte array. If the data is
+  // not valid, returns a default-constructed database for which ok() is false.
+  template <typename ByteArray>
+  static CompactTokenDatabase Create(const ByteArray& database_bytes) {
+    static_assert(sizeof(*std::data(database_bytes)) == 1u);
+    return Create(std::as_bytes(
+        std::span(std::data(database_bytes), std::size(database_bytes))));
+  }
+
+  static CompactTokenDatabase Create(std::span<const std::byte> bytes) {
+    return IsValid(bytes) ? CompactTokenDatabase(bytes)
+                          : CompactTokenDatabase();
+  }
+
+  // Creates a database with no data. ok() returns false.
+  constexpr CompactTokenDatabase()
+      : entries_(nullptr), strings_(nullptr), size_(0) {}
+
+  // Returns an iterator to the first entry with this token, or end() if there
+  // is none. Entries with the same token follow each other. This is O(n).
+  Iterator Find(uint32_t token) const;
+
+  // Returns the total number of entries (unique token-string pairs).
+  constexpr size_t size() const { return size_; }
+
+  // True if this database was constructed with valid data.
+  constexpr bool ok() const { return entries_ != nullptr; }
+
+  Iterator begin() const;
+  Iterator end() const { return Iterator(nullptr, strings_, 0); }
+
+ private:
+  static constexpr size_t kHeaderSize = 16;
+
+  CompactTokenDatabase(std::span<const std::byte> bytes);
+
+  const std::byte* entries_;
+  const char* strings_;
+  uint32_t size_;
+};
+
+}  // namespace pw::tokenizer
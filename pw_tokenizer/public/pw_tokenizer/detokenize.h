@@ -22,16 +22,22 @@
 //   DetokenizedString result = detok.Detokenize(my_data);
 //   std::cout << result.BestString() << '\n';
 //
+// For large databases, a FlatDetokenizer starts much faster and uses less
+// memory, but requires the database to outlive it.
+//
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <span>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "pw_tokenizer/compact_token_database.h"
 #include "pw_tokenizer/internal/decode.h"
 #include "pw_tokenizer/token_database.h"
 
@@ -65,6 +71,24 @@ class DetokenizedString {
   std::string BestStringWithErrors() const;
 
  private:
+  friend class Detokenizer;
+  friend class FlatDetokenizer;
+
+  using FormatStringEntry =
+      std::pair<const FormatString*, uint32_t /*date removed*/>;
+
+  DetokenizedString(uint32_t token,
+                    const std::span<const FormatStringEntry>& entries,
+                    const std::span<const uint8_t>& arguments);
+
+  // Expands nested tokens in each match with detokenize(token).
+  template <typename Function>
+  void ExpandNestedTokens(Function&& detokenize) {
+    for (DecodedFormatString& match : matches_) {
+      match.ExpandNestedTokens(detokenize);
+    }
+  }
+
   uint32_t token_;
   bool has_token_;
   std::vector<DecodedFormatString> matches_;
@@ -78,8 +102,13 @@ class Detokenizer {
   // referenced by the Detokenizer after construction; its memory can be freed.
   Detokenizer(const TokenDatabase& database);
 
+  // Constructs a detokenizer from a CompactTokenDatabase. The database is not
+  // referenced by the Detokenizer after construction.
+  Detokenizer(const CompactTokenDatabase& database);
+
   // Decodes and detokenizes the encoded message. Returns a DetokenizedString
-  // that stores all possible detokenized string results.
+  // that stores all possible detokenized string results. Nested tokens, which
+  // are formatted with PW_TOKEN_FMT(), are replaced with their strings.
   DetokenizedString Detokenize(const std::span<const uint8_t>& encoded) const;
 
   DetokenizedString Detokenize(const std::string_view& encoded) const {
@@ -91,8 +120,83 @@ class Detokenizer {
         std::span(static_cast<const uint8_t*>(encoded), size_bytes));
   }
 
+  // Detokenizes each encoded message into the DetokenizedString at the same
+  // index in output, which must be at least as large. The batch is split
+  // across up to the requested number of threads, including the calling
+  // thread. Starting threads is costly, so only use multiple threads for
+  // batches of thousands of messages. If the standard library does not support
+  // threads, the whole batch is decoded on the calling thread.
+  void DetokenizeBatch(std::span<const std::span<const uint8_t>> encoded,
+                       std::span<DetokenizedString> output,
+                       size_t threads = 1) const;
+
  private:
   std::unordered_map<uint32_t, std::vector<TokenizedStringEntry>> database_;
 };
 
+// Decodes and detokenizes strings from a TokenDatabase without copying it. A
+// Detokenizer parses every entry's format string into a hash table, which is
+// slow and memory-hungry for large databases. A FlatDetokenizer instead builds
+// a single sorted array of the entries, which refer to the database's strings,
+// and looks tokens up with a binary search. Each format string is parsed the
+// first time its token is detokenized and cached, so later messages with that
+// token only decode their arguments.
+//
+// The TokenDatabase's memory, such as a memory-mapped database file, must
+// outlive the FlatDetokenizer. Detokenize may be called from multiple threads
+// at once.
+class FlatDetokenizer {
+ public:
+  // Constructs a detokenizer from a TokenDatabase, which must outlive it.
+  FlatDetokenizer(const TokenDatabase& database);
+
+  // Constructs a detokenizer from a CompactTokenDatabase, which must outlive
+  // it.
+  FlatDetokenizer(const CompactTokenDatabase& database);
+
+  FlatDetokenizer(const FlatDetokenizer&) = delete;
+  FlatDetokenizer& operator=(const FlatDetokenizer&) = delete;
+
+  FlatDetokenizer(FlatDetokenizer&&) = default;
+
+  ~FlatDetokenizer();
+
+  // Decodes and detokenizes the encoded message. Returns a DetokenizedString
+  // that stores all possible detokenized string results. Nested tokens, which
+  // are formatted with PW_TOKEN_FMT(), are replaced with their strings.
+  DetokenizedString Detokenize(const std::span<const uint8_t>& encoded) const;
+
+  DetokenizedString Detokenize(const std::string_view& encoded) const {
+    return Detokenize(encoded.data(), encoded.size());
+  }
+
+  DetokenizedString Detokenize(const void* encoded, size_t size_bytes) const {
+    return Detokenize(
+        std::span(static_cast<const uint8_t*>(encoded), size_bytes));
+  }
+
+  // Detokenizes each encoded message into the DetokenizedString at the same
+  // index in output, which must be at least as large. The batch is split
+  // across up to the requested number of threads, including the calling
+  // thread. Starting threads is costly, so only use multiple threads for
+  // batches of thousands of messages. If the standard library does not support
+  // threads, the whole batch is decoded on the calling thread.
+  void DetokenizeBatch(std::span<const std::span<const uint8_t>> encoded,
+                       std::span<DetokenizedString> output,
+                       size_t threads = 1) const;
+
+ private:
+  explicit FlatDetokenizer(std::vector<TokenDatabase::Entry>&& entries);
+
+  // Returns the parsed format string for an entry, parsing it on first use.
+  const FormatString& Format(size_t index) const;
+
+  // Sorted by token. Entries with the same token are in database order.
+  std::vector<TokenDatabase::Entry> entries_;
+
+  // The parsed format string for each entry, or nullptr if it has not been
+  // used. Parsed format strings are set once and not freed until destruction.
+  std::unique_ptr<std::atomic<const FormatString*>[]> formats_;
+};
+
 }  // namespace pw::tokenizer
@@ -20,6 +20,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -108,6 +109,8 @@ class DecodedArg {
   size_t raw_size_bytes() const { return raw_data_size_bytes_; }
 
  private:
+  friend class DecodedFormatString;
+
   DecodedArg(const char* format, size_t raw_size_bytes, ArgStatus status)
       : spec_(format), raw_data_size_bytes_(raw_size_bytes), status_(status) {}
 
@@ -215,7 +218,17 @@ class DecodedFormatString {
   // Returns the number of arguments that failed to decode.
   size_t decoding_errors() const;
 
+  // Replaces each nested token, a hexadecimal argument that directly follows
+  // "$#" as formatted by PW_TOKEN_FMT(), with the string that
+  // detokenize(token) returns. Tokens for which it returns std::nullopt are
+  // left as is.
+  template <typename Function>
+  void ExpandNestedTokens(Function&& detokenize);
+
  private:
+  // Returns the token if the segment at this index is a nested token.
+  std::optional<uint32_t> NestedToken(size_t index) const;
+
   std::vector<DecodedArg> segments_;
   size_t remaining_bytes_;
 };
@@ -240,6 +253,26 @@ class FormatString {
   std::vector<StringSegment> segments_;
 };
 
+template <typename Function>
+void DecodedFormatString::ExpandNestedTokens(Function&& detokenize) {
+  for (size_t i = 1; i < segments_.size(); ++i) {
+    const std::optional<uint32_t> token = NestedToken(i);
+    if (!token.has_value()) {
+      continue;
+    }
+
+    std::optional<std::string> nested = detokenize(*token);
+    if (!nested.has_value()) {
+      continue;
+    }
+
+    // Drop the "$#" that marks the token from the preceding literal.
+    std::string& prefix = segments_[i - 1].value_;
+    prefix.resize(prefix.size() - 2);
+    segments_[i].value_ = std::move(*nested);
+  }
+}
+
 // Implementation of DecodedArg::FromValue template function.
 template <typename ArgumentType>
 DecodedArg DecodedArg::FromValue(const char* format,
@@ -247,13 +280,22 @@ DecodedArg DecodedArg::FromValue(const char* format,
                                  size_t raw_size_bytes,
                                  ArgStatus status) {
   DecodedArg arg(format, raw_size_bytes, status);
-  const int value_size = std::snprintf(nullptr, 0u, format, value);
+
+  // Most values are short, so print to a small buffer first. This avoids a
+  // second snprintf call to measure the value.
+  char buffer[32];
+  const int value_size = std::snprintf(buffer, sizeof(buffer), format, value);
 
   if (value_size < 0) {
     arg.status_.Update(ArgStatus::kDecodeError);
     return arg;
   }
 
+  if (static_cast<size_t>(value_size) < sizeof(buffer)) {
+    arg.value_.assign(buffer, value_size);
+    return arg;
+  }
+
   // Reserve space in the value string for the snprintf call.
   arg.value_.append(value_size + 1, '\0');
 
@@ -37,6 +37,10 @@ namespace pw {
 namespace tokenizer {
 namespace internal {
 
+// A token calculated during compilation. See _PW_TOKENIZER_MASK_TOKEN.
+template <uint32_t kToken>
+inline constexpr uint32_t kCompileTimeToken = kToken;
+
 // The C++ tokenzied string entry supports both string literals and char arrays,
 // such as __func__.
 template <uint32_t kDomainSize, uint32_t kStringSize>
@@ -0,0 +1,140 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+#include "pw_tokenizer/base64.h"
+#include "pw_tokenizer/detokenize.h"
+
+namespace pw::tokenizer {
+
+// Detokenizes prefixed Base64 messages in a stream of text, such as a serial
+// log capture. Text is written to the output as it is processed, with each
+// prefixed Base64 message that detokenizes successfully replaced by its
+// detokenized string. Other text, including messages that fail to decode, is
+// written unmodified. This matches detokenize_base64 in the Python
+// pw_tokenizer.detokenize module, but does not need the text split into lines.
+//
+// Data may be provided in chunks of any size. A message split across chunks is
+// held until the first character after it arrives, or until Flush() is
+// called. Detokenized strings that contain prefixed Base64 messages, such as
+// from a %s argument, are detokenized recursively.
+//
+//   FlatDetokenizer detokenizer(database);
+//   pw::stream::SysIoWriter output;
+//   StreamDetokenizer stream_detokenizer(detokenizer, output);
+//
+//   // Detokenize everything from the serial port until it is closed.
+//   stream_detokenizer.Process(serial_port_reader);
+//
+// The detokenizer must outlive the StreamDetokenizer.
+class StreamDetokenizer {
+ public:
+  // Runs of Base64 characters longer than this are written as text.
+  static constexpr size_t kMaxMessageSizeBytes = 2048;
+
+  StreamDetokenizer(const Detokenizer& detokenizer,
+                    stream::Writer& output,
+                    char prefix = kBase64Prefix)
+      : StreamDetokenizer(&detokenizer,
+                          &DetokenizeWith<Detokenizer>,
+                          output,
+                          prefix,
+                          kMaxRecursion) {}
+
+  StreamDetokenizer(const FlatDetokenizer& detokenizer,
+                    stream::Writer& output,
+                    char prefix = kBase64Prefix)
+      : StreamDetokenizer(&detokenizer,
+                          &DetokenizeWith<FlatDetokenizer>,
+                          output,
+                          prefix,
+                          kMaxRecursion) {}
+
+  StreamDetokenizer(const StreamDetokenizer&) = delete;
+  StreamDetokenizer& operator=(const StreamDetokenizer&) = delete;
+
+  // Detokenizes a chunk of text and writes the results to the output. Returns
+  // the first error from writing to the output stream, if any.
+  Status Process(ConstByteSpan data);
+
+  Status Process(std::string_view text);
+
+  // Reads and detokenizes data from the reader until it is exhausted, then
+  // calls Flush(). Returns OK at the end of the stream, or an error from
+  // reading or writing. Reading stops at RESOURCE_EXHAUSTED, which is
+  // returned; call Process again when more data is available.
+  Status Process(stream::Reader& input);
+
+  // Detokenizes and writes a message in progress, if any. Call this at the end
+  // of the input or when the input has been idle.
+  Status Flush();
+
+ private:
+  using DetokenizeFunction =
+      DetokenizedString (*)(const void*, const std::span<const uint8_t>&);
+
+  // Decodes nested messages as many times as the Python detokenizer.
+  static constexpr int kMaxRecursion = 9;
+
+  template <typename DetokenizerType>
+  static DetokenizedString DetokenizeWith(
+      const void* detokenizer, const std::span<const uint8_t>& message) {
+    return static_cast<const DetokenizerType*>(detokenizer)
+        ->Detokenize(message);
+  }
+
+  StreamDetokenizer(const void* detokenizer,
+                    DetokenizeFunction detokenize,
+                    stream::Writer& output,
+                    char prefix,
+                    int recursion)
+      : detokenizer_(detokenizer),
+        detokenize_(detokenize),
+        output_(output),
+        prefix_(prefix),
+        recursion_(recursion),
+        skipping_(false) {}
+
+  // Writes the message in progress, detokenized if possible, and clears it.
+  Status WriteMessage();
+
+  Status Write(std::string_view text);
+
+  const void* const detokenizer_;
+  const DetokenizeFunction detokenize_;
+  stream::Writer& output_;
+  const char prefix_;
+  const int recursion_;
+
+  // True while writing out a run of Base64 characters that was too long.
+  bool skipping_;
+
+  // The prefix and Base64 characters of the message in progress, if any.
+  std::string message_;
+
+  // Buffer for the binary version of the message in progress.
+  std::vector<std::byte> decoded_;
+};
+
+}  // namespace pw::tokenizer
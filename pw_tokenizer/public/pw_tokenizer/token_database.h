@@ -51,6 +51,15 @@ namespace pw::tokenizer {
 // Entries are accessed by iterating over the database. A O(n) Find function is
 // also provided. In typical use, a TokenDatabase is preprocessed by a
 // Detokenizer into a std::unordered_map.
+//
+// Find is O(log n) for databases created with a string index, which holds the
+// offset of each entry's string in the string table. The index is stored
+// separately from the database, so the binary format is unchanged. Create it
+// at compile time with CreateIndex:
+//
+//   constexpr auto kIndex = TokenDatabase::CreateIndex<kMyData>();
+//   constexpr TokenDatabase db = TokenDatabase::Create<kMyData, kIndex>();
+//
 class TokenDatabase {
  public:
   // Internal struct that describes how the underlying binary token database
@@ -180,6 +189,46 @@ class TokenDatabase {
     return TokenDatabase(std::data(kDatabaseBytes));
   }
 
+  // Creates the string index for a database at compile time. The index is a
+  // std::array<uint32_t, N> with the offset of each of the N entries' strings
+  // in the string table. The entries must be sorted by token.
+  template <const auto& kDatabaseBytes>
+  static constexpr auto CreateIndex() {
+    static_assert(
+        HasValidHeader<decltype(kDatabaseBytes)>(kDatabaseBytes),
+        "Databases must start with a 16-byte header that begins with TOKENS.");
+
+    static_assert(EachEntryHasAString<decltype(kDatabaseBytes)>(kDatabaseBytes),
+                  "The database must have at least one string for each entry.");
+
+    static_assert(IsSortedByToken<decltype(kDatabaseBytes)>(kDatabaseBytes),
+                  "The database entries must be sorted by token.");
+
+    std::array<uint32_t, ReadEntryCount(std::data(kDatabaseBytes))> index{};
+    const size_t string_table = StringTable(index.size());
+
+    uint32_t offset = 0;
+    for (uint32_t& string_offset : index) {
+      string_offset = offset;
+      while (kDatabaseBytes[string_table + offset] != '\0') {
+        offset += 1;
+      }
+      offset += 1;  // Skip the null terminator.
+    }
+    return index;
+  }
+
+  // Creates a TokenDatabase with a string index from CreateIndex. Find uses a
+  // binary search and the index instead of scanning the database.
+  template <const auto& kDatabaseBytes, const auto& kIndex>
+  static constexpr TokenDatabase Create() {
+    static_assert(std::size(kIndex) ==
+                      ReadEntryCount(std::data(kDatabaseBytes)),
+                  "The index must be from CreateIndex for this database.");
+
+    return TokenDatabase(Create<kDatabaseBytes>(), std::data(kIndex));
+  }
+
   // Creates a TokenDatabase from the provided byte array. The array may be a
   // span, array, or other container type. If the data is not valid, returns a
   // default-constructed database for which ok() is false.
@@ -196,9 +245,13 @@ class TokenDatabase {
   // Creates a database with no data. ok() returns false.
   constexpr TokenDatabase() : begin_{.data = nullptr}, end_{.data = nullptr} {}
 
-  // Returns all entries associated with this token. This is a O(n) operation.
+  // Returns all entries associated with this token. This is a O(n) operation,
+  // or O(log n) if the database has a string index.
   Entries Find(uint32_t token) const;
 
+  // True if this database has a string index, which speeds up Find.
+  constexpr bool has_index() const { return string_offsets_ != nullptr; }
+
   // Returns the total number of entries (unique token-string pairs).
   constexpr size_t size() const {
     return (end_.data - begin_.data) / sizeof(RawEntry);
@@ -258,15 +311,37 @@ class TokenDatabase {
     return string_count >= entries;
   }
 
-  // Reads the number of entries from a database header. Cast to the bytes to
-  // uint8_t to avoid sign extension if T is signed.
+  // Checks that the entries are sorted by token, which Find relies on when the
+  // database has an index.
+  template <typename ByteArray>
+  static constexpr bool IsSortedByToken(const ByteArray& bytes) {
+    const size_t entries = ReadEntryCount(std::data(bytes));
+    for (size_t i = 1; i < entries; ++i) {
+      if (ReadToken(std::data(bytes), i - 1) > ReadToken(std::data(bytes), i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   template <typename T>
-  static constexpr uint32_t ReadEntryCount(const T* header_bytes) {
-    const T* bytes = header_bytes + offsetof(Header, entry_count);
+  static constexpr uint32_t ReadToken(const T* bytes, size_t entry) {
+    return ReadUint32(bytes + sizeof(Header) + entry * sizeof(RawEntry));
+  }
+
+  template <typename T>
+  static constexpr uint32_t ReadUint32(const T* bytes) {
     return static_cast<uint8_t>(bytes[0]) |
            static_cast<uint8_t>(bytes[1]) << 8 |
            static_cast<uint8_t>(bytes[2]) << 16 |
-           static_cast<uint8_t>(bytes[3]) << 24;
+           static_cast<uint32_t>(static_cast<uint8_t>(bytes[3])) << 24;
+  }
+
+  // Reads the number of entries from a database header. Cast to the bytes to
+  // uint8_t to avoid sign extension if T is signed.
+  template <typename T>
+  static constexpr uint32_t ReadEntryCount(const T* header_bytes) {
+    return ReadUint32(header_bytes + offsetof(Header, entry_count));
   }
 
   // Calculates the offset of the string table.
@@ -279,6 +354,15 @@ class TokenDatabase {
   static constexpr std::array<char, 8> kMagicAndVersion = {
       'T', 'O', 'K', 'E', 'N', 'S', '\0', '\0'};
 
+  constexpr TokenDatabase(const TokenDatabase& database,
+                          const uint32_t* string_offsets)
+      : TokenDatabase(database) {
+    string_offsets_ = string_offsets;
+  }
+
+  // Returns an iterator for the entry at the index, using the string index.
+  Iterator IndexedIterator(size_t index) const;
+
   template <typename Byte>
   constexpr TokenDatabase(const Byte bytes[])
       : TokenDatabase(bytes + sizeof(Header),
@@ -307,6 +391,9 @@ class TokenDatabase {
     const unsigned char* unsigned_data;
     const signed char* signed_data;
   } begin_, end_;
+
+  // The offset of each entry's string from the string table, or nullptr.
+  const uint32_t* string_offsets_ = nullptr;
 };
 
 }  // namespace pw::tokenizer
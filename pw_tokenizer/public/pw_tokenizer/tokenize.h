@@ -15,12 +15,14 @@
 
 #ifdef __cplusplus
 
+#include <cinttypes>
 #include <cstddef>
 #include <cstdint>
 
 #else
 
 #include <assert.h>
+#include <inttypes.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -78,9 +80,43 @@ typedef uint32_t pw_tokenizer_Token;
   _PW_TOKENIZER_RECORD_ORIGINAL_STRING(                                      \
       _PW_TOKENIZER_MASK_TOKEN(mask, string_literal), domain, string_literal)
 
+// Format specifier for a token argument in a tokenized string. A string that is
+// known at compile time, such as the name of a state, can be tokenized and
+// passed as a token instead of with %s, which encodes every character:
+//
+//   const char* StateName(State state);  // Before: copies the name.
+//
+//   pw_tokenizer_Token StateToken(State state) {  // After: 4-byte token.
+//     switch (state) {
+//       case kIdle:
+//         return PW_TOKENIZE_STRING("IDLE");
+//       ...
+//     }
+//   }
+//
+//   PW_LOG_INFO("Entering " PW_TOKEN_FMT() " state", StateToken(state));
+//
+// The token is encoded like any other integer argument. The detokenizers
+// replace the token with its string, and leave it as $#<token> if the token
+// is not in the database.
+#define PW_TOKEN_FMT() "$#%08" PRIx32
+
+#ifdef __cplusplus
+
+// In C++, pass the token through a template argument so that it is always
+// calculated during compilation, even when it initializes a non-constexpr
+// variable in an unoptimized build.
+#define _PW_TOKENIZER_MASK_TOKEN(mask, string_literal) \
+  ::pw::tokenizer::internal::kCompileTimeToken<(       \
+      (pw_tokenizer_Token)(mask)&PW_TOKENIZER_STRING_TOKEN(string_literal))>
+
+#else
+
 #define _PW_TOKENIZER_MASK_TOKEN(mask, string_literal) \
   ((pw_tokenizer_Token)(mask)&PW_TOKENIZER_STRING_TOKEN(string_literal))
 
+#endif  // __cplusplus
+
 // Encodes a tokenized string and arguments to the provided buffer. The size of
 // the buffer is passed via a pointer to a size_t. After encoding is complete,
 // the size_t is set to the number of bytes written to the buffer.
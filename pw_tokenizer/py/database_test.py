@@ -16,6 +16,7 @@
 
 import json
 import io
+import os
 from pathlib import Path
 import shutil
 import sys
@@ -239,6 +240,46 @@ class DatabaseCommandLineTest(unittest.TestCase):
         self.assertEqual(json.loads(mock_stdout.buffer.getvalue()),
                          EXPECTED_REPORT)
 
+    def test_create_csv_from_multiple_elfs(self):
+        copies = [self._dir / f'copy_{i}.elf' for i in range(3)]
+        for copy in copies:
+            shutil.copyfile(self._elf, copy)
+
+        run_cli('create', '--database', self._csv, *copies)
+
+        self.assertEqual(CSV_DEFAULT_DOMAIN.splitlines(),
+                         self._csv.read_text().splitlines())
+
+    def test_create_csv_with_cache(self):
+        cache_dir = self._dir / 'cache'
+
+        with mock.patch.dict(os.environ,
+                             {database.CACHE_DIR_ENV_VAR: str(cache_dir)}):
+            run_cli('create', '--database', self._csv, self._elf)
+            self.assertEqual(1, len(list(cache_dir.iterdir())))
+
+            # The second run reads the strings from the cache.
+            self._csv.unlink()
+            with mock.patch.object(database,
+                                   '_database_from_elf',
+                                   side_effect=AssertionError):
+                run_cli('create', '--database', self._csv, self._elf)
+
+        self.assertEqual(CSV_DEFAULT_DOMAIN.splitlines(),
+                         self._csv.read_text().splitlines())
+
+    def test_cache_is_keyed_by_domain(self):
+        cache_dir = self._dir / 'cache'
+
+        with mock.patch.dict(os.environ,
+                             {database.CACHE_DIR_ENV_VAR: str(cache_dir)}):
+            run_cli('create', '--database', self._csv, self._elf)
+            run_cli('create', '--force', '--database', self._csv,
+                    f'{self._elf}#TEST_DOMAIN')
+
+        self.assertEqual(2, len(list(cache_dir.iterdir())))
+        self.assertEqual(self._csv_test_domain, self._csv.read_text())
+
     def test_replace(self):
         sub = 'replace/ment'
         run_cli('create', '--database', self._csv, self._elf, '--replace',
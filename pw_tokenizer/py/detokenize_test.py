@@ -305,6 +305,44 @@ class DetokenizeTest(unittest.TestCase):
         self.assertEqual(expected_tokens,
                          frozenset(detok.database.token_to_entries.keys()))
 
+    def test_decode_from_mapped_binary_database(self):
+        db = database.load_token_database(
+            io.BytesIO(ELF_WITH_TOKENIZER_SECTIONS))
+
+        binary_file = tempfile.NamedTemporaryFile('wb', delete=False)
+        try:
+            tokens.write_binary(db, binary_file)
+            binary_file.close()
+
+            mapped = tokens.MappedBinaryDatabase(binary_file.name)
+            self.assertEqual(len(mapped), TOKENS_IN_ELF)
+            self.assertEqual(str(tokens.Database(mapped.entries())), str(db))
+
+            detok = detokenize.Detokenizer(mapped)
+            self.assertIs(detok.database, mapped)
+            self.assertEqual(str(detok.detokenize(JELLO_WORLD_TOKEN)),
+                             'Jello, world!')
+            self.assertFalse(detok.detokenize(b'\xff\xff\xff\xff').ok())
+
+            # Mapped databases are loaded normally when merged with others.
+            detok = detokenize.Detokenizer(mapped, tokens.Database())
+            self.assertEqual(str(detok.detokenize(JELLO_WORLD_TOKEN)),
+                             'Jello, world!')
+            mapped.close()
+        finally:
+            os.unlink(binary_file.name)
+
+    def test_mapped_binary_database_rejects_other_formats(self):
+        csv_file = tempfile.NamedTemporaryFile('w', delete=False)
+        try:
+            csv_file.write('00000001,          ,"hello"\n')
+            csv_file.close()
+
+            with self.assertRaises(tokens.DatabaseFormatError):
+                tokens.MappedBinaryDatabase(csv_file.name)
+        finally:
+            os.unlink(csv_file.name)
+
 
 class DetokenizeWithCollisions(unittest.TestCase):
     """Tests collision resolution."""
@@ -382,6 +420,67 @@ class DetokenizeWithCollisions(unittest.TestCase):
         self.assertIn('#0 -1', repr(unambiguous))
 
 
+class DetokenizeNestedTokens(unittest.TestCase):
+    """Tests expanding tokens formatted with PW_TOKEN_FMT()."""
+    def setUp(self):
+        super().setUp()
+        self.detok = detokenize.Detokenizer(tokens.Database([
+            tokens.TokenizedStringEntry(1, 'Entering $#%08x state'),
+            tokens.TokenizedStringEntry(2, 'IDLE'),
+            tokens.TokenizedStringEntry(3, '$#%08x -> $#%08X'),
+            tokens.TokenizedStringEntry(4, 'Cost: $%x'),
+            tokens.TokenizedStringEntry(0xddeeeeff, 'RUNNING'),
+        ]))  # yapf: disable
+
+    def test_known_token_is_expanded(self):
+        result = self.detok.detokenize(b'\1\0\0\0\x04')
+        self.assertTrue(result.ok())
+        self.assertEqual(str(result), 'Entering IDLE state')
+
+    def test_multiple_tokens_are_expanded(self):
+        result = self.detok.detokenize(b'\3\0\0\0\x04\x81\xc4\x88\xa1\x04')
+        self.assertEqual(str(result), 'IDLE -> RUNNING')
+
+    def test_unknown_token_is_left_as_is(self):
+        result = self.detok.detokenize(b'\1\0\0\0\x0e')
+        self.assertEqual(str(result), 'Entering $#00000007 state')
+
+    def test_hex_without_marker_is_not_expanded(self):
+        result = self.detok.detokenize(b'\4\0\0\0\x04')
+        self.assertEqual(str(result), 'Cost: $2')
+
+    def test_format_string_is_unchanged_after_expanding(self):
+        self.detok.detokenize(b'\1\0\0\0\x04')
+        result = self.detok.detokenize(b'\1\0\0\0\x0e')
+        self.assertEqual(str(result), 'Entering $#00000007 state')
+
+
+class DetokenizeWithPayload(unittest.TestCase):
+    """Tests detokenizing messages prefixed with their payload argument."""
+    def setUp(self):
+        super().setUp()
+        self.detok = detokenize.Detokenizer(
+            tokens.Database([tokens.TokenizedStringEntry(1, 'Hello %d')]))
+
+    def test_payload_and_message(self):
+        payload, result = self.detok.detokenize_with_payload(
+            b'\x12\x34\x56\x78\1\0\0\0\x04')
+        self.assertEqual(payload, 0x78563412)
+        self.assertTrue(result.ok())
+        self.assertEqual(str(result), 'Hello 2')
+
+    def test_payload_without_message(self):
+        payload, result = self.detok.detokenize_with_payload(b'\5\0\0\0')
+        self.assertEqual(payload, 5)
+        self.assertFalse(result.ok())
+
+    def test_too_short_for_payload(self):
+        payload, result = self.detok.detokenize_with_payload(b'\5\0\0')
+        self.assertIsNone(payload)
+        self.assertFalse(result.ok())
+        self.assertEqual(result.encoded_message, b'\5\0\0')
+
+
 @mock.patch('os.path.getmtime')
 class AutoUpdatingDetokenizerTest(unittest.TestCase):
     """Tests the AutoUpdatingDetokenizer class."""
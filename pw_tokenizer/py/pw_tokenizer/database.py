@@ -19,8 +19,11 @@ maintaining token databases.
 """
 
 import argparse
+from concurrent.futures import ProcessPoolExecutor
 from datetime import datetime
 import glob
+import hashlib
+import itertools
 import json
 import logging
 import os
@@ -28,8 +31,9 @@ from pathlib import Path
 import re
 import struct
 import sys
-from typing import (Any, Callable, Dict, Iterable, Iterator, List, Pattern,
-                    Set, TextIO, Tuple, Union)
+import tempfile
+from typing import (Any, Callable, Dict, Iterable, Iterator, List, Optional,
+                    Pattern, Set, TextIO, Tuple, Union)
 
 try:
     from pw_tokenizer import elf_reader, tokens
@@ -58,6 +62,13 @@ _TOKENIZED_ENTRY_SECTIONS = re.compile(
 _LEGACY_STRING_SECTIONS = re.compile(
     r'^\.pw_tokenized\.(?P<domain>[^.]+)(?:\.\d+)?$')
 
+# Matches every section from which _database_from_elf reads strings.
+_TOKENIZER_SECTIONS = re.compile(
+    f'{_TOKENIZED_ENTRY_SECTIONS.pattern}|{_LEGACY_STRING_SECTIONS.pattern}')
+
+# If set, databases read from ELF files are cached in this directory.
+CACHE_DIR_ENV_VAR = 'PW_TOKENIZER_CACHE_DIR'
+
 _ERROR_HANDLER = 'surrogateescape'  # How to deal with UTF-8 decoding errors
 
 
@@ -135,6 +146,100 @@ def _database_from_elf(elf, domain: Pattern[str]) -> tokens.Database:
     return tokens.Database([])
 
 
+def _tokenizer_sections_hash(reader: elf_reader.Elf,
+                             domain: Pattern[str]) -> str:
+    """Hashes the domain and every section that strings are read from."""
+    digest = hashlib.sha256(domain.pattern.encode())
+
+    for name, data in sorted(reader.dump_sections(_TOKENIZER_SECTIONS).items()):
+        digest.update(struct.pack('<2I', len(name), len(data)))
+        digest.update(name.encode())
+        digest.update(data)
+
+    return digest.hexdigest()
+
+
+def _read_cached_database(path: Path) -> Optional[tokens.Database]:
+    try:
+        with path.open() as fd:
+            return tokens.Database(
+                tokens.TokenizedStringEntry(token, string, domain)
+                for token, string, domain in json.load(fd))
+    except FileNotFoundError:
+        return None
+    except (TypeError, ValueError) as err:
+        _LOG.warning('Ignoring corrupt cached database %s: %s', path, err)
+        return None
+
+
+def _write_cached_database(path: Path, database: tokens.Database) -> None:
+    # Write to a temporary file and rename it, so that processes reading the
+    # same cache never see a partially written file.
+    with tempfile.NamedTemporaryFile('w', dir=path.parent,
+                                     delete=False) as fd:
+        json.dump([[entry.token, entry.string, entry.domain]
+                   for entry in database.entries()], fd)
+
+    os.replace(fd.name, path)
+
+
+def _database_from_elf_path(path: Path, domain: Pattern[str],
+                            cache_dir: Optional[Path]) -> tokens.Database:
+    """Reads the strings from an ELF file, using the cache if provided."""
+    with open(path, 'rb') as fd:
+        if cache_dir is None:
+            return _database_from_elf(fd, domain)
+
+        reader = elf_reader.Elf(fd)
+        cache_file = cache_dir / (_tokenizer_sections_hash(reader, domain) +
+                                  '.json')
+
+        database = _read_cached_database(cache_file)
+        if database is not None:
+            _LOG.debug('Read cached strings for %s from %s', path, cache_file)
+            return database
+
+        database = _database_from_elf(reader, domain)
+        _write_cached_database(cache_file, database)
+        return database
+
+
+def load_elf_databases(elfs: Iterable[Tuple[Union[str, Path],
+                                            Pattern[str]]],
+                       cache_dir: Union[str, Path, None] = None,
+                       jobs: Optional[int] = None) -> List[tokens.Database]:
+    """Reads the tokenized strings from ELF files in parallel.
+
+    Args:
+      elfs: (path, domain) pairs of ELF files and the domains to read from them
+      cache_dir: if provided, the database read from an ELF is cached in this
+          directory, keyed by a hash of the sections it was read from; ELFs
+          whose tokenized string sections have not changed are not parsed again
+      jobs: the number of processes to use; defaults to the number of CPUs
+
+    Returns:
+      A database for each ELF file, in the same order
+    """
+    elfs = list(elfs)
+    cache_path = None if cache_dir is None else Path(cache_dir)
+
+    if cache_path is not None:
+        cache_path.mkdir(parents=True, exist_ok=True)
+
+    if len(elfs) < 2 or jobs == 1:
+        return [
+            _database_from_elf_path(Path(path), domain, cache_path)
+            for path, domain in elfs
+        ]
+
+    with ProcessPoolExecutor(max_workers=jobs) as executor:
+        return list(
+            executor.map(_database_from_elf_path,
+                         (Path(path) for path, _ in elfs),
+                         (domain for _, domain in elfs),
+                         itertools.repeat(cache_path)))
+
+
 def tokenization_domains(elf) -> Iterator[str]:
     """Lists all tokenization domains in an ELF file."""
     reader = _elf_reader(elf)
@@ -174,6 +279,9 @@ def _load_token_database(db, domain: Pattern[str]) -> tokens.Database:
     if isinstance(db, tokens.Database):
         return db
 
+    if isinstance(db, tokens.MappedBinaryDatabase):
+        return tokens.Database(db.entries())
+
     if isinstance(db, elf_reader.Elf):
         return _database_from_elf(db, domain)
 
@@ -277,6 +385,8 @@ def _handle_create(databases, database, force, output_type, include, exclude,
             tokens.write_csv(database, fd)
         elif output_type == 'binary':
             tokens.write_binary(database, fd)
+        elif output_type == 'compact':
+            tokens.write_compact_binary(database, fd)
         else:
             raise ValueError(f'Unknown database type "{output_type}"')
 
@@ -344,38 +454,47 @@ class ExpandGlobs(argparse.Action):
         setattr(namespace, self.dest, list(expand_paths_or_globs(*values)))
 
 
-def _read_elf_with_domain(elf: str,
-                          domain: Pattern[str]) -> Iterable[tokens.Database]:
+def _elfs_with_domain(
+        elf: str, domain: Pattern[str]) -> Iterable[Tuple[Path, Pattern[str]]]:
     for path in expand_paths_or_globs(elf):
-        with path.open('rb') as file:
-            if not elf_reader.compatible_file(file):
-                raise ValueError(f'{elf} is not an ELF file, '
-                                 f'but the "{domain}" domain was specified')
+        if not elf_reader.compatible_file(path):
+            raise ValueError(f'{elf} is not an ELF file, '
+                             f'but the "{domain}" domain was specified')
 
-            yield _database_from_elf(file, domain)
+        yield path, domain
 
 
 class LoadTokenDatabases(argparse.Action):
     """Argparse action that reads tokenize databases from paths or globs.
 
     ELF files may have #domain appended to them to specify a tokenization domain
-    other than the default.
+    other than the default. ELF files are read in parallel, and are cached in
+    the directory set by the PW_TOKENIZER_CACHE_DIR environment variable, if
+    any.
     """
     def __call__(self, parser, namespace, values, option_string=None):
         databases: List[tokens.Database] = []
+        elfs: List[Tuple[Path, Pattern[str]]] = []
         paths: Set[Path] = set()
 
         try:
             for value in values:
                 if value.count('#') == 1:
                     path, domain = value.split('#')
-                    domain = re.compile(domain)
-                    databases.extend(_read_elf_with_domain(path, domain))
+                    elfs.extend(_elfs_with_domain(path, re.compile(domain)))
                 else:
                     paths.update(expand_paths_or_globs(value))
 
             for path in paths:
-                databases.append(load_token_database(path))
+                if elf_reader.compatible_file(path):
+                    elfs.append((path, re.compile(tokens.DEFAULT_DOMAIN)))
+                else:
+                    databases.append(load_token_database(path))
+
+            # Name the ELF files in the error messages below.
+            path = ', '.join(str(path) for path, _ in elfs)
+            databases.extend(
+                load_elf_databases(elfs, os.environ.get(CACHE_DIR_ENV_VAR)))
         except tokens.DatabaseFormatError as err:
             parser.error(
                 f'argument elf_or_token_database: {path} is not a supported '
@@ -457,7 +576,7 @@ def _parse_args():
         '-t',
         '--type',
         dest='output_type',
-        choices=('csv', 'binary'),
+        choices=('csv', 'binary', 'compact'),
         default='csv',
         help='Which type of database to create. (default: csv)')
     subparser.add_argument('-f',
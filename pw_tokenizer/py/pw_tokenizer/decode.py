@@ -22,7 +22,11 @@ in the resulting string with an error message.
 
 import re
 import struct
-from typing import Iterable, List, NamedTuple, Match, Sequence, Tuple
+from typing import (Callable, Iterable, List, NamedTuple, Match, Optional,
+                    Sequence, Tuple)
+
+# Marks an argument formatted with PW_TOKEN_FMT() as a nested token.
+NESTED_TOKEN_PREFIX = '$#'
 
 
 def zigzag_decode(value: int) -> int:
@@ -351,15 +355,21 @@ class FormatString:
 
         return tuple(decoded_args), encoded[index:]
 
-    def format(self,
-               encoded_args: bytes,
-               show_errors: bool = False) -> FormattedString:
+    def format(
+        self,
+        encoded_args: bytes,
+        show_errors: bool = False,
+        nested_tokens: Optional[Callable[[int], Optional[str]]] = None
+    ) -> FormattedString:
         """Decodes arguments and formats the string with them.
 
         Args:
           encoded_args: the arguments to decode and format the string with
           show_errors: if True, an error message is used in place of the %
               conversion specifier when an argument fails to decode
+          nested_tokens: if provided, called with each nested token, a %x
+              argument that follows $# as formatted by PW_TOKEN_FMT(); the
+              token is replaced with the returned string unless it is None
 
         Returns:
           tuple with the formatted string, decoded arguments, and remaining data
@@ -374,7 +384,31 @@ class FormatString:
                                     if arg.ok() else arg.specifier.specifier
                                     for arg in args)
 
-        return FormattedString(''.join(self._segments), args, remaining)
+        if nested_tokens is None:
+            return FormattedString(''.join(self._segments), args, remaining)
+
+        return FormattedString(
+            ''.join(self._expand_nested_tokens(args, nested_tokens)), args,
+            remaining)
+
+    def _expand_nested_tokens(
+            self, args: Sequence[DecodedArg],
+            nested_tokens: Callable[[int], Optional[str]]) -> List[str]:
+        """Returns the formatted segments with nested tokens replaced."""
+        segments = list(self._segments)
+
+        for i, arg in enumerate(args):
+            literal = segments[2 * i]
+            if (not arg.ok() or arg.specifier.type not in 'xX'
+                    or not literal.endswith(NESTED_TOKEN_PREFIX)):
+                continue
+
+            nested = nested_tokens(arg.value)
+            if nested is not None:
+                segments[2 * i] = literal[:-len(NESTED_TOKEN_PREFIX)]
+                segments[2 * i + 1] = nested
+
+        return segments
 
 
 def decode(format_string: str,
@@ -59,6 +59,7 @@ except ImportError:
 _LOG = logging.getLogger('pw_tokenizer')
 
 ENCODED_TOKEN = struct.Struct('<I')
+ENCODED_PAYLOAD = struct.Struct('<I')
 BASE64_PREFIX = encode.BASE64_PREFIX.encode()
 DEFAULT_RECURSION = 9
 
@@ -69,7 +70,9 @@ class DetokenizedString:
                  token: Optional[int],
                  format_string_entries: Iterable[tuple],
                  encoded_message: bytes,
-                 show_errors: bool = False):
+                 show_errors: bool = False,
+                 nested_tokens: Optional[Callable[[int],
+                                                  Optional[str]]] = None):
         self.token = token
         self.encoded_message = encoded_message
         self._show_errors = show_errors
@@ -81,7 +84,7 @@ class DetokenizedString:
 
         for entry, fmt in format_string_entries:
             result = fmt.format(encoded_message[ENCODED_TOKEN.size:],
-                                show_errors)
+                                show_errors, nested_tokens)
 
             # Sort competing entries so the most likely matches appear first.
             # Decoded strings are prioritized by whether they
@@ -178,7 +181,8 @@ class Detokenizer:
 
         Args:
           *token_database_or_elf: a path or file object for an ELF or CSV
-              database, a tokens.Database, or an elf_reader.Elf
+              database, a tokens.Database, a tokens.MappedBinaryDatabase, or
+              an elf_reader.Elf
           show_errors: if True, an error message is used in place of the %
               conversion specifier when an argument fails to decode
         """
@@ -190,7 +194,17 @@ class Detokenizer:
         self._initialize_database(token_database_or_elf)
 
     def _initialize_database(self, token_sources: Iterable) -> None:
-        self.database = database.load_token_database(*token_sources)
+        token_sources = tuple(token_sources)
+
+        # Look up tokens directly in a single memory-mapped database rather
+        # than loading all of its entries.
+        if (len(token_sources) == 1
+                and isinstance(token_sources[0], tokens.MappedBinaryDatabase)):
+            self.database: Union[tokens.Database,
+                                 tokens.MappedBinaryDatabase] = token_sources[0]
+        else:
+            self.database = database.load_token_database(*token_sources)
+
         self._cache.clear()
 
     def lookup(self, token: int) -> List[_TokenizedFormatString]:
@@ -213,7 +227,32 @@ class Detokenizer:
 
         token, = ENCODED_TOKEN.unpack_from(encoded_message)
         return DetokenizedString(token, self.lookup(token), encoded_message,
-                                 self.show_errors)
+                                 self.show_errors, self._detokenize_nested)
+
+    def detokenize_with_payload(
+            self,
+            encoded: bytes) -> Tuple[Optional[int], DetokenizedString]:
+        """Detokenizes a message prefixed by its 32-bit payload argument.
+
+        This is the format of binary tokenized logs, such as those written by
+        pw_log_tokenized's binary_over_hdlc backend: the payload argument to
+        pw_tokenizer_HandleEncodedMessageWithPayload, little endian, followed by
+        the tokenized message.
+
+        Returns:
+          the payload, or None if the data is too short to hold one, and the
+          detokenized message
+        """
+        if len(encoded) < ENCODED_PAYLOAD.size:
+            return None, DetokenizedString(None, (), encoded, self.show_errors)
+
+        payload, = ENCODED_PAYLOAD.unpack_from(encoded)
+        return payload, self.detokenize(encoded[ENCODED_PAYLOAD.size:])
+
+    def _detokenize_nested(self, token: int) -> Optional[str]:
+        """Returns the string for a nested token, or None if it is unknown."""
+        result = self.detokenize(ENCODED_TOKEN.pack(token & 0xFFFFFFFF))
+        return str(result) if result.ok() else None
 
     def detokenize_base64(self,
                           data: bytes,
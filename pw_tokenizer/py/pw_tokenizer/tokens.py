@@ -19,6 +19,7 @@ from dataclasses import dataclass
 from datetime import datetime
 import io
 import logging
+import mmap
 from pathlib import Path
 import re
 import struct
@@ -333,6 +334,10 @@ class _BinaryFileFormat(NamedTuple):
 
 BINARY_FORMAT = _BinaryFileFormat()
 
+# The compact binary format is version 1 of the binary format. The reserved
+# header field holds the size of the variable-length entry table.
+COMPACT_BINARY_MAGIC = b'TOKENS\1\0'
+
 
 class DatabaseFormatError(Exception):
     """Failed to parse a token database file."""
@@ -344,7 +349,7 @@ def file_is_binary_database(fd: BinaryIO) -> bool:
         fd.seek(0)
         magic = fd.read(len(BINARY_FORMAT.magic))
         fd.seek(0)
-        return BINARY_FORMAT.magic == magic
+        return magic in (BINARY_FORMAT.magic, COMPACT_BINARY_MAGIC)
     except IOError:
         return False
 
@@ -371,11 +376,38 @@ def _check_that_file_is_csv_database(path: Path) -> None:
         ) from err
 
 
+def _date_from_packed(day: int, month: int,
+                      year: int) -> Optional[datetime]:
+    try:
+        return datetime(year, month, day)
+    except ValueError:
+        return None
+
+
+def _packed_date(date_removed: Optional[datetime]) -> Tuple[int, int, int]:
+    """Returns the day, month, and year stored for a removal date."""
+    if date_removed:
+        return date_removed.day, date_removed.month, date_removed.year
+
+    # If there is no removal date, use the special value 0xffffffff for the
+    # day/month/year. That ensures that still-present tokens appear as the
+    # newest tokens when sorted by removal date.
+    return 0xff, 0xff, 0xffff
+
+
 def parse_binary(fd: BinaryIO) -> Iterable[TokenizedStringEntry]:
-    """Parses TokenizedStringEntries from a binary token database file."""
+    """Parses TokenizedStringEntries from a binary token database file.
+
+    Reads both the original and compact binary formats.
+    """
     magic, entry_count = BINARY_FORMAT.header.unpack(
         fd.read(BINARY_FORMAT.header.size))
 
+    if magic == COMPACT_BINARY_MAGIC:
+        fd.seek(-BINARY_FORMAT.header.size, io.SEEK_CUR)
+        yield from _parse_compact_binary(fd.read())
+        return
+
     if magic != BINARY_FORMAT.magic:
         raise DatabaseFormatError(
             f'Binary token database magic number mismatch (found {magic!r}, '
@@ -387,12 +419,7 @@ def parse_binary(fd: BinaryIO) -> Iterable[TokenizedStringEntry]:
         token, day, month, year = BINARY_FORMAT.entry.unpack(
             fd.read(BINARY_FORMAT.entry.size))
 
-        try:
-            date_removed: Optional[datetime] = datetime(year, month, day)
-        except ValueError:
-            date_removed = None
-
-        entries.append((token, date_removed))
+        entries.append((token, _date_from_packed(day, month, year)))
 
     # Read the entire string table and define a function for looking up strings.
     string_table = fd.read()
@@ -417,28 +444,217 @@ def write_binary(database: Database, fd: BinaryIO) -> None:
     string_table = bytearray()
 
     for entry in entries:
-        if entry.date_removed:
-            removed_day = entry.date_removed.day
-            removed_month = entry.date_removed.month
-            removed_year = entry.date_removed.year
-        else:
-            # If there is no removal date, use the special value 0xffffffff for
-            # the day/month/year. That ensures that still-present tokens appear
-            # as the newest tokens when sorted by removal date.
-            removed_day = 0xff
-            removed_month = 0xff
-            removed_year = 0xffff
-
         string_table += entry.string.encode()
         string_table.append(0)
 
         fd.write(
-            BINARY_FORMAT.entry.pack(entry.token, removed_day, removed_month,
-                                     removed_year))
+            BINARY_FORMAT.entry.pack(entry.token,
+                                     *_packed_date(entry.date_removed)))
 
     fd.write(string_table)
 
 
+def _encode_varint(value: int) -> bytes:
+    encoded = bytearray()
+    while value > 0x7f:
+        encoded.append(0x80 | (value & 0x7f))
+        value >>= 7
+    encoded.append(value)
+    return bytes(encoded)
+
+
+def _decode_varint(data: bytes, offset: int) -> Tuple[int, int]:
+    """Returns the decoded value and the offset after the varint."""
+    value = 0
+    shift = 0
+    while True:
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7f) << shift
+        if not byte & 0x80:
+            return value, offset
+        shift += 7
+
+
+def _suffix_shared_string_table(
+        strings: Iterable[bytes]) -> Tuple[bytes, Dict[bytes, int]]:
+    """Builds a null-terminated string table that shares common suffixes.
+
+    Duplicate strings are stored once. A string that is a suffix of another
+    string points into the longer string instead of being stored separately.
+    """
+    # After sorting by the reversed strings, a string that is a suffix of any
+    # other string is a suffix of the string immediately after it.
+    by_suffix = sorted(set(strings), key=lambda string: string[::-1])
+
+    table = bytearray()
+    offsets: Dict[bytes, int] = {}
+    longer: Optional[bytes] = None
+
+    for string in reversed(by_suffix):
+        if longer is not None and longer.endswith(string):
+            offsets[string] = offsets[longer] + len(longer) - len(string)
+        else:
+            offsets[string] = len(table)
+            table += string
+            table.append(0)
+
+        longer = string
+
+    return bytes(table), offsets
+
+
+def write_compact_binary(database: Database, fd: BinaryIO) -> None:
+    """Writes the database in the compact binary format.
+
+    Tokens are delta encoded as varints, removal dates are varints, and strings
+    are deduplicated and share common suffixes. Read these databases with
+    parse_binary in Python or pw::tokenizer::CompactTokenDatabase in C++.
+    """
+    entries = sorted(database.entries())
+    string_table, offsets = _suffix_shared_string_table(
+        entry.string.encode() for entry in entries)
+
+    entry_table = bytearray()
+    previous_token = 0
+
+    for entry in entries:
+        day, month, year = _packed_date(entry.date_removed)
+        date = day | month << 8 | year << 16
+
+        entry_table += _encode_varint(entry.token - previous_token)
+        entry_table += _encode_varint((date + 1) & 0xffffffff)
+        entry_table += _encode_varint(offsets[entry.string.encode()])
+        previous_token = entry.token
+
+    fd.write(
+        struct.pack('<8sII', COMPACT_BINARY_MAGIC, len(entries),
+                    len(entry_table)))
+    fd.write(entry_table)
+    fd.write(string_table)
+
+
+def _parse_compact_binary(data: bytes) -> Iterable[TokenizedStringEntry]:
+    magic, entry_count, entry_table_size = struct.unpack_from('<8sII', data)
+    assert magic == COMPACT_BINARY_MAGIC
+
+    offset = struct.calcsize('<8sII')
+    string_table = offset + entry_table_size
+    token = 0
+
+    for _ in range(entry_count):
+        delta, offset = _decode_varint(data, offset)
+        date, offset = _decode_varint(data, offset)
+        string_offset, offset = _decode_varint(data, offset)
+
+        token += delta
+        date = (date - 1) & 0xffffffff
+
+        start = string_table + string_offset
+        string = data[start:data.index(b'\0', start)].decode()
+
+        yield TokenizedStringEntry(
+            token, string, DEFAULT_DOMAIN,
+            _date_from_packed(date & 0xff, date >> 8 & 0xff, date >> 16))
+
+
+class _MappedTokenLookup:
+    """Maps tokens to entries like Database.token_to_entries, but lazily."""
+    def __init__(self, database: 'MappedBinaryDatabase'):
+        self._database = database
+
+    def __getitem__(self, token: int) -> List[TokenizedStringEntry]:
+        return self._database.find(token)
+
+
+class MappedBinaryDatabase:
+    """A read-only view of a binary token database file backed by mmap.
+
+    Entries are not parsed when the database is opened. Each lookup binary
+    searches the sorted entries in the mapped file and decodes only the
+    matching entries, so opening a large database is nearly instant and uses
+    little memory. Only the original (version 0) binary format is supported.
+
+    The file must not be modified while it is mapped.
+    """
+    def __init__(self, path: Union[Path, str]):
+        self.path = Path(path)
+
+        with self.path.open('rb') as fd:
+            try:
+                self._data = mmap.mmap(fd.fileno(),
+                                       0,
+                                       access=mmap.ACCESS_READ)
+            except ValueError as err:  # The file is empty.
+                raise DatabaseFormatError(
+                    f'{self.path} is not a binary token database') from err
+
+        if (len(self._data) < BINARY_FORMAT.header.size
+                or self._data[:len(BINARY_FORMAT.magic)] !=
+                BINARY_FORMAT.magic):
+            self._data.close()
+            raise DatabaseFormatError(
+                f'{self.path} is not a version 0 binary token database')
+
+        _, self._entry_count = BINARY_FORMAT.header.unpack_from(self._data)
+
+        # Offsets of each string, which are found as strings are accessed.
+        self._string_offsets: List[int] = [
+            BINARY_FORMAT.header.size +
+            self._entry_count * BINARY_FORMAT.entry.size
+        ]
+
+        self.token_to_entries = _MappedTokenLookup(self)
+
+    def _raw_entry(self, index: int) -> Tuple[int, int, int, int]:
+        return BINARY_FORMAT.entry.unpack_from(
+            self._data,
+            BINARY_FORMAT.header.size + index * BINARY_FORMAT.entry.size)
+
+    def _string(self, index: int) -> str:
+        while len(self._string_offsets) <= index:
+            end = self._data.find(b'\0', self._string_offsets[-1])
+            self._string_offsets.append(end + 1)
+
+        start = self._string_offsets[index]
+        return self._data[start:self._data.find(b'\0', start)].decode()
+
+    def _entry(self, index: int) -> TokenizedStringEntry:
+        token, day, month, year = self._raw_entry(index)
+        return TokenizedStringEntry(token, self._string(index),
+                                    DEFAULT_DOMAIN,
+                                    _date_from_packed(day, month, year))
+
+    def find(self, token: int) -> List[TokenizedStringEntry]:
+        """Returns the entries for a token, which are decoded on demand."""
+        low, high = 0, self._entry_count
+
+        while low < high:  # Find the first entry with the token.
+            mid = (low + high) // 2
+            if self._raw_entry(mid)[0] < token:
+                low = mid + 1
+            else:
+                high = mid
+
+        entries = []
+        while low < self._entry_count and self._raw_entry(low)[0] == token:
+            entries.append(self._entry(low))
+            low += 1
+
+        return entries
+
+    def entries(self) -> Iterator[TokenizedStringEntry]:
+        """Decodes and yields every entry in the database."""
+        for index in range(self._entry_count):
+            yield self._entry(index)
+
+    def close(self) -> None:
+        self._data.close()
+
+    def __len__(self) -> int:
+        return self._entry_count
+
+
 class DatabaseFile(Database):
     """A token database that is associated with a particular file.
 
@@ -451,8 +667,11 @@ class DatabaseFile(Database):
         # Read the path as a packed binary file.
         with self.path.open('rb') as fd:
             if file_is_binary_database(fd):
+                compact = fd.read(len(COMPACT_BINARY_MAGIC))
+                fd.seek(0)
                 super().__init__(parse_binary(fd))
-                self._export = write_binary
+                self._export = (write_compact_binary if compact
+                                == COMPACT_BINARY_MAGIC else write_binary)
                 return
 
         # Read the path as a CSV file.
@@ -392,6 +392,46 @@ class TokenDatabaseTest(unittest.TestCase):
 
         self.assertEqual(str(db), CSV_DATABASE)
 
+    def test_compact_binary_format_round_trip(self):
+        db = read_db_from_csv(CSV_DATABASE)
+
+        with io.BytesIO() as fd:
+            tokens.write_compact_binary(db, fd)
+            compact_db = fd.getvalue()
+
+        self.assertLess(len(compact_db), len(BINARY_DATABASE))
+
+        with io.BytesIO(compact_db) as fd:
+            self.assertTrue(tokens.file_is_binary_database(fd))
+            parsed = tokens.Database(tokens.parse_binary(fd))
+
+        self.assertEqual(str(parsed), CSV_DATABASE)
+
+    def test_compact_binary_format_shares_strings(self):
+        db = tokens.Database([
+            tokens.TokenizedStringEntry(1, 'hello world'),
+            tokens.TokenizedStringEntry(2, 'world'),
+            tokens.TokenizedStringEntry(3, 'hello world'),
+            tokens.TokenizedStringEntry(4, 'abc'),
+        ])
+
+        with io.BytesIO() as fd:
+            tokens.write_compact_binary(db, fd)
+            compact_db = fd.getvalue()
+
+        self.assertEqual(
+            compact_db, b'TOKENS\1\0\4\0\0\0\x0c\0\0\0'
+            b'\1\0\0'
+            b'\1\0\6'
+            b'\1\0\0'
+            b'\1\0\x0c'
+            b'hello world\0abc\0')
+
+        with io.BytesIO(compact_db) as fd:
+            parsed = tokens.Database(tokens.parse_binary(fd))
+
+        self.assertEqual(str(parsed), str(db))
+
 
 class TestDatabaseFile(unittest.TestCase):
     """Tests the DatabaseFile class."""
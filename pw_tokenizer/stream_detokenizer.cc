@@ -0,0 +1,173 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_tokenizer/stream_detokenizer.h"
+
+#include <array>
+
+#include "pw_base64/base64.h"
+#include "pw_result/result.h"
+#include "pw_status/try.h"
+
+namespace pw::tokenizer {
+namespace {
+
+constexpr bool IsBase64(char c) {
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+         (c >= '0' && c <= '9') || c == '+' || c == '/' || c == '-' ||
+         c == '_' || c == '=';
+}
+
+// Returns the number of characters that form complete, correctly padded blocks
+// of four Base64 characters at the start of the text.
+size_t ValidBase64Size(std::string_view base64) {
+  const size_t padding = base64.find('=');
+  if (padding == std::string_view::npos) {
+    return base64.size() / 4 * 4;
+  }
+
+  const size_t block_start = padding / 4 * 4;
+  if (padding % 4 == 3u) {
+    return padding + 1;
+  }
+  if (padding % 4 == 2u && padding + 1 < base64.size() &&
+      base64[padding + 1] == '=') {
+    return padding + 2;
+  }
+  return block_start;
+}
+
+}  // namespace
+
+Status StreamDetokenizer::Process(ConstByteSpan data) {
+  return Process(std::string_view(reinterpret_cast<const char*>(data.data()),
+                                  data.size()));
+}
+
+Status StreamDetokenizer::Process(std::string_view text) {
+  while (!text.empty()) {
+    if (message_.empty() && !skipping_) {
+      // Write everything up to the next message as text.
+      const size_t prefix = text.find(prefix_);
+      PW_TRY(Write(text.substr(0, prefix)));
+
+      if (prefix == std::string_view::npos) {
+        return OkStatus();
+      }
+      message_.push_back(prefix_);
+      text.remove_prefix(prefix + 1);
+      continue;
+    }
+
+    size_t run = 0;
+    while (run < text.size() && IsBase64(text[run])) {
+      run += 1;
+    }
+
+    if (skipping_) {
+      PW_TRY(Write(text.substr(0, run)));
+    } else if (message_.size() + run > kMaxMessageSizeBytes) {
+      PW_TRY(Write(message_));
+      PW_TRY(Write(text.substr(0, run)));
+      message_.clear();
+      skipping_ = true;
+    } else {
+      message_.append(text.substr(0, run));
+    }
+    text.remove_prefix(run);
+
+    // A character that is not Base64 ends the message. It is processed as
+    // text, since it may be the prefix of another message.
+    if (!text.empty()) {
+      skipping_ = false;
+      PW_TRY(WriteMessage());
+    }
+  }
+  return OkStatus();
+}
+
+Status StreamDetokenizer::Process(stream::Reader& input) {
+  std::array<std::byte, 512> buffer;
+
+  while (true) {
+    Result<ByteSpan> data = input.Read(buffer);
+    if (!data.ok()) {
+      if (data.status() == Status::OutOfRange()) {
+        return Flush();
+      }
+      return data.status();
+    }
+    PW_TRY(Process(data.value()));
+  }
+}
+
+Status StreamDetokenizer::Flush() {
+  skipping_ = false;
+  return WriteMessage();
+}
+
+Status StreamDetokenizer::WriteMessage() {
+  if (message_.empty()) {
+    return OkStatus();
+  }
+
+  const std::string_view base64 = std::string_view(message_).substr(1);
+  const size_t valid_size = ValidBase64Size(base64);
+
+  decoded_.resize(base64::MaxDecodedSize(valid_size));
+  const size_t decoded_size =
+      base64::Decode(base64.substr(0, valid_size), decoded_);
+
+  const DetokenizedString result = detokenize_(
+      detokenizer_,
+      std::span(reinterpret_cast<const uint8_t*>(decoded_.data()),
+                decoded_size));
+
+  Status status;
+
+  if (result.matches().empty()) {
+    status = Write(message_);
+  } else {
+    const std::string detokenized = result.BestString();
+
+    // Detokenize any messages in the arguments of this message.
+    if (recursion_ > 0 && detokenized.find(prefix_) != std::string::npos) {
+      StreamDetokenizer nested(
+          detokenizer_, detokenize_, output_, prefix_, recursion_ - 1);
+      status = nested.Process(detokenized);
+      if (status.ok()) {
+        status = nested.Flush();
+      }
+    } else {
+      status = Write(detokenized);
+    }
+
+    // Characters after the last complete Base64 block are plain text.
+    if (status.ok()) {
+      status = Write(base64.substr(valid_size));
+    }
+  }
+
+  message_.clear();
+  return status;
+}
+
+Status StreamDetokenizer::Write(std::string_view text) {
+  if (text.empty()) {
+    return OkStatus();
+  }
+  return output_.Write(text.data(), text.size());
+}
+
+}  // namespace pw::tokenizer
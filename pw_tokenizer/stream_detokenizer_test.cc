@@ -0,0 +1,159 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_tokenizer/stream_detokenizer.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::tokenizer {
+namespace {
+
+using namespace std::literals::string_view_literals;
+
+alignas(TokenDatabase::RawEntry) constexpr char kData[] =
+    "TOKENS\0\0"
+    "\x03\x00\x00\x00"
+    "\0\0\0\0"
+    "\x01\x00\x00\x00----"
+    "\x02\x00\x00\x00----"
+    "\x05\x00\x00\x00----"
+    "One\0"
+    "Hello %s\0"
+    "TWO";
+
+constexpr TokenDatabase kDatabase = TokenDatabase::Create<kData>();
+
+class StreamDetokenizerTest : public ::testing::Test {
+ protected:
+  StreamDetokenizerTest()
+      : detokenizer_(kDatabase), stream_detokenizer_(detokenizer_, output_) {}
+
+  std::string_view output() const {
+    return std::string_view(
+        reinterpret_cast<const char*>(output_.WrittenData().data()),
+        output_.bytes_written());
+  }
+
+  // Processes the text one character at a time.
+  void ProcessBytewise(std::string_view text) {
+    for (char c : text) {
+      ASSERT_EQ(OkStatus(),
+                stream_detokenizer_.Process(std::string_view(&c, 1)));
+    }
+  }
+
+  Detokenizer detokenizer_;
+  stream::MemoryWriterBuffer<4096> output_;
+  StreamDetokenizer stream_detokenizer_;
+};
+
+TEST_F(StreamDetokenizerTest, NoMessages_WritesText) {
+  EXPECT_EQ(OkStatus(), stream_detokenizer_.Process("Plain text\n"sv));
+  EXPECT_EQ(output(), "Plain text\n");
+}
+
+TEST_F(StreamDetokenizerTest, Message_Detokenized) {
+  EXPECT_EQ(OkStatus(), stream_detokenizer_.Process("Log: $AQAAAA== done\n"sv));
+  EXPECT_EQ(output(), "Log: One done\n");
+}
+
+TEST_F(StreamDetokenizerTest, AdjacentMessages_Detokenized) {
+  EXPECT_EQ(OkStatus(),
+            stream_detokenizer_.Process("$AQAAAA==$BQAAAA==$AQAAAA==\n"sv));
+  EXPECT_EQ(output(), "OneTWOOne\n");
+}
+
+TEST_F(StreamDetokenizerTest, MessageSplitAcrossChunks_Detokenized) {
+  ProcessBytewise("a$AQAAAA==b$BQAAAA==\n$$AQAAAA==.");
+  EXPECT_EQ(output(), "aOnebTWO\n$One.");
+}
+
+TEST_F(StreamDetokenizerTest, MessageAtEnd_WrittenOnFlush) {
+  EXPECT_EQ(OkStatus(), stream_detokenizer_.Process("End: $BQAAAA=="sv));
+  EXPECT_EQ(output(), "End: ");
+
+  EXPECT_EQ(OkStatus(), stream_detokenizer_.Flush());
+  EXPECT_EQ(output(), "End: TWO");
+
+  EXPECT_EQ(OkStatus(), stream_detokenizer_.Flush());
+  EXPECT_EQ(output(), "End: TWO");
+}
+
+TEST_F(StreamDetokenizerTest, UnknownToken_WrittenUnmodified) {
+  EXPECT_EQ(OkStatus(), stream_detokenizer_.Process("$CQAAAA== $AQAA\n"sv));
+  EXPECT_EQ(output(), "$CQAAAA== $AQAA\n");
+}
+
+TEST_F(StreamDetokenizerTest, InvalidBase64_WrittenUnmodified) {
+  EXPECT_EQ(OkStatus(), stream_detokenizer_.Process("$ costs $5, $=A= $\n"sv));
+  EXPECT_EQ(output(), "$ costs $5, $=A= $\n");
+}
+
+TEST_F(StreamDetokenizerTest, CharactersAfterPadding_WrittenAsText) {
+  EXPECT_EQ(OkStatus(), stream_detokenizer_.Process("$AQAAAA==xyz\n"sv));
+  EXPECT_EQ(output(), "Onexyz\n");
+}
+
+TEST_F(StreamDetokenizerTest, NestedMessage_DetokenizedRecursively) {
+  EXPECT_EQ(OkStatus(),
+            stream_detokenizer_.Process("[$AgAAAAkkQVFBQUFBPT0=]\n"sv));
+  EXPECT_EQ(output(), "[Hello One]\n");
+}
+
+TEST_F(StreamDetokenizerTest, LongBase64Run_WrittenUnmodified) {
+  const std::string text = '$' +
+                           std::string(StreamDetokenizer::kMaxMessageSizeBytes,
+                                       'A') +
+                           " $AQAAAA==\n";
+  ProcessBytewise(text);
+  EXPECT_EQ(output(),
+            text.substr(0, text.size() - sizeof("$AQAAAA==")) + "One\n");
+}
+
+TEST_F(StreamDetokenizerTest, Reader_ProcessesEntireStream) {
+  constexpr std::string_view kText = "1 $AQAAAA==\n2 $BQAAAA==\n3 $AQAAAA==";
+  stream::MemoryReader reader(std::as_bytes(std::span(kText)));
+
+  EXPECT_EQ(OkStatus(), stream_detokenizer_.Process(reader));
+  EXPECT_EQ(output(), "1 One\n2 TWO\n3 One");
+}
+
+TEST_F(StreamDetokenizerTest, WriteError_Returned) {
+  stream::MemoryWriterBuffer<4> small_output;
+  StreamDetokenizer stream_detokenizer(detokenizer_, small_output);
+
+  EXPECT_EQ(Status::ResourceExhausted(),
+            stream_detokenizer.Process("$AQAAAA== and more\n"sv));
+}
+
+TEST(StreamDetokenizer, FlatDetokenizer_Detokenizes) {
+  FlatDetokenizer detokenizer(kDatabase);
+  stream::MemoryWriterBuffer<64> output;
+  StreamDetokenizer stream_detokenizer(detokenizer, output);
+
+  EXPECT_EQ(OkStatus(), stream_detokenizer.Process("$AQAAAA== $BQAAAA=="sv));
+  EXPECT_EQ(OkStatus(), stream_detokenizer.Flush());
+  EXPECT_EQ(std::string_view(
+                reinterpret_cast<const char*>(output.WrittenData().data()),
+                output.bytes_written()),
+            "One TWO");
+}
+
+}  // namespace
+}  // namespace pw::tokenizer
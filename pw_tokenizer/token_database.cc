@@ -14,6 +14,8 @@
 
 #include "pw_tokenizer/token_database.h"
 
+#include <algorithm>
+
 namespace pw::tokenizer {
 
 TokenDatabase::Entry TokenDatabase::Entries::operator[](size_t index) const {
@@ -24,7 +26,26 @@ TokenDatabase::Entry TokenDatabase::Entries::operator[](size_t index) const {
   return it.entry();
 }
 
+TokenDatabase::Iterator TokenDatabase::IndexedIterator(size_t index) const {
+  const char* string =
+      index < size() ? end_.data + string_offsets_[index] : nullptr;
+  return Iterator(begin_.entry + index, string);
+}
+
 TokenDatabase::Entries TokenDatabase::Find(const uint32_t token) const {
+  if (has_index()) {
+    const RawEntry* const entries = begin_.entry;
+    const auto [first, last] =
+        std::equal_range(entries,
+                         entries + size(),
+                         RawEntry{token, 0},
+                         [](const RawEntry& lhs, const RawEntry& rhs) {
+                           return lhs.token < rhs.token;
+                         });
+    return Entries(IndexedIterator(first - entries),
+                   IndexedIterator(last - entries));
+  }
+
   Iterator first = begin();
   while (first != end() && token > first->token) {
     ++first;
@@ -238,6 +238,85 @@ TEST(TokenDatabase, MultipleEntriesWithSameToken) {
   }
 }
 
+constexpr auto kBasicIndex = TokenDatabase::CreateIndex<kBasicData>();
+constexpr TokenDatabase kIndexedBasic =
+    TokenDatabase::Create<kBasicData, kBasicIndex>();
+
+static_assert(kBasicIndex.size() == 3u);
+static_assert(kBasicIndex[0] == 0u);
+static_assert(kBasicIndex[1] == sizeof("hi!"));
+static_assert(kBasicIndex[2] == sizeof("hi!") + sizeof("goodbye"));
+static_assert(kIndexedBasic.has_index());
+static_assert(!kBasicDatabase.has_index());
+static_assert(kIndexedBasic.size() == 3u);
+
+TEST(TokenDatabase, Indexed_SingleEntryLookup) {
+  auto match = kIndexedBasic.Find(1);
+  ASSERT_EQ(match.size(), 1u);
+  EXPECT_EQ(match[0].token, 1u);
+  EXPECT_STREQ(match[0].string, "hi!");
+
+  match = kIndexedBasic.Find(2);
+  ASSERT_EQ(match.size(), 1u);
+  EXPECT_STREQ(match[0].string, "goodbye");
+
+  match = kIndexedBasic.Find(0xff);
+  ASSERT_EQ(match.size(), 1u);
+  EXPECT_STREQ(match[0].string, ":)");
+}
+
+TEST(TokenDatabase, Indexed_NonPresent) {
+  EXPECT_TRUE(kIndexedBasic.Find(0).empty());
+  EXPECT_TRUE(kIndexedBasic.Find(3).empty());
+  EXPECT_TRUE(kIndexedBasic.Find(10239).empty());
+  EXPECT_TRUE(kIndexedBasic.Find(0xFFFFFFFFu).empty());
+}
+
+TEST(TokenDatabase, Indexed_IteratesLikeUnindexed) {
+  auto indexed = kIndexedBasic.begin();
+  for (const auto& entry : kBasicDatabase) {
+    ASSERT_NE(indexed, kIndexedBasic.end());
+    EXPECT_EQ(indexed->token, entry.token);
+    EXPECT_STREQ(indexed.entry().string, entry.string);
+    ++indexed;
+  }
+  EXPECT_EQ(indexed, kIndexedBasic.end());
+}
+
+constexpr auto kCollisionsIndex = TokenDatabase::CreateIndex<kCollisionsData>();
+constexpr TokenDatabase kIndexedCollisions =
+    TokenDatabase::Create<kCollisionsData, kCollisionsIndex>();
+
+TEST(TokenDatabase, Indexed_MultipleEntriesWithSameToken) {
+  TokenDatabase::Entries match = kIndexedCollisions.Find(1);
+
+  EXPECT_EQ(match.begin()->token, 1u);
+  EXPECT_EQ(match.end()->token, 2u);
+  ASSERT_EQ(match.size(), 3u);
+
+  EXPECT_STREQ(match[0].string, "hi!");
+  EXPECT_STREQ(match[1].string, "goodbye");
+  EXPECT_STREQ(match[2].string, ":)");
+
+  match = kIndexedCollisions.Find(2);
+  ASSERT_EQ(match.size(), 1u);
+  EXPECT_STREQ(match[0].string, "");
+
+  match = kIndexedCollisions.Find(0xff);
+  ASSERT_EQ(match.size(), 1u);
+  EXPECT_STREQ(match[0].string, "");
+}
+
+TEST(TokenDatabase, Indexed_Empty) {
+  static constexpr auto kIndex = TokenDatabase::CreateIndex<kEmptyData>();
+  constexpr TokenDatabase empty_db =
+      TokenDatabase::Create<kEmptyData, kIndex>();
+  static_assert(empty_db.size() == 0u);
+
+  EXPECT_TRUE(empty_db.Find(0).empty());
+  EXPECT_TRUE(empty_db.Find(123).empty());
+}
+
 TEST(TokenDatabase, Empty) {
   constexpr TokenDatabase empty_db = TokenDatabase::Create<kEmptyData>();
   static_assert(empty_db.size() == 0u);
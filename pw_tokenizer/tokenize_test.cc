@@ -127,6 +127,25 @@ TEST(TokenizeString, NullInString) {
   static_assert(Hash("abc\0def") != Hash("abc\0def\0"));
 }
 
+#define TEN_CHARS "0123456789"
+#define HUNDRED_CHARS                                                     \
+  TEN_CHARS TEN_CHARS TEN_CHARS TEN_CHARS TEN_CHARS TEN_CHARS TEN_CHARS \
+      TEN_CHARS TEN_CHARS TEN_CHARS
+
+TEST(TokenizeString, LongerThanAnyHashMacro_HashesWholeString) {
+  constexpr char kLong[] =
+      HUNDRED_CHARS HUNDRED_CHARS HUNDRED_CHARS HUNDRED_CHARS "!";
+
+  // Not constexpr, so the token would be calculated at run time if the macro
+  // did not force it to be calculated during compilation.
+  const uint32_t token = PW_TOKENIZE_STRING(kLong);
+  EXPECT_EQ(Hash(kLong), token);
+  EXPECT_NE(PwTokenizer65599FixedLengthHash(kLong, 256), token);
+}
+
+#undef TEN_CHARS
+#undef HUNDRED_CHARS
+
 // Verify that we can tokenize multiple strings from one source line.
 #define THREE_FOR_ONE(first, second, third)             \
   [[maybe_unused]] constexpr uint32_t token_1 =         \
@@ -240,6 +259,54 @@ TEST_F(TokenizeToBuffer, IntegerDoesntFit) {
   EXPECT_EQ(std::memcmp(expected.data(), buffer_, expected.size()), 0);
 }
 
+TEST_F(TokenizeToBuffer, IntegerOverflow) {
+  for (size_t size = 4; size < 12; ++size) {
+    std::memset(buffer_, 0, sizeof(buffer_));
+    size_t message_size = size;
+
+    PW_TOKENIZE_TO_BUFFER(buffer_, &message_size, "%" PRIx32, 0x12345678u);
+
+    if (size < 9) {
+      ASSERT_EQ(sizeof(uint32_t), message_size);
+
+      // Make sure nothing was written past the end of the buffer.
+      EXPECT_TRUE(std::all_of(&buffer_[size], std::end(buffer_), [](uint8_t v) {
+        return v == '\0';
+      }));
+    } else {
+      // 0x12345678 -zig-zag-> 0x2468acf0
+      constexpr std::array<uint8_t, 9> expected =
+          ExpectedData<0xf0, 0xd9, 0xa2, 0xa3, 0x02>("%" PRIx32);
+      ASSERT_EQ(expected.size(), message_size);
+      EXPECT_EQ(std::memcmp(expected.data(), buffer_, expected.size()), 0);
+    }
+  }
+}
+
+TEST_F(TokenizeToBuffer, MultipleIntegers) {
+  size_t message_size = sizeof(buffer_);
+  PW_TOKENIZE_TO_BUFFER(
+      buffer_, &message_size, "%d %d %d %d", 0, -64, 64, 1 << 20);
+
+  constexpr std::array<uint8_t, 12> expected =
+      ExpectedData<0x00, 0x7f, 0x80, 0x01, 0x80, 0x80, 0x80, 0x01>(
+          "%d %d %d %d");
+  ASSERT_EQ(expected.size(), message_size);
+  EXPECT_EQ(std::memcmp(expected.data(), buffer_, expected.size()), 0);
+}
+
+TEST_F(TokenizeToBuffer, NestedToken_EncodedAsInteger) {
+  size_t message_size = sizeof(buffer_);
+  constexpr pw_tokenizer_Token token = 2;
+  PW_TOKENIZE_TO_BUFFER(
+      buffer_, &message_size, "State: " PW_TOKEN_FMT(), token);
+
+  constexpr std::array<uint8_t, 5> expected =
+      ExpectedData<0x04>("State: $#%08x");
+  ASSERT_EQ(expected.size(), message_size);
+  EXPECT_EQ(std::memcmp(expected.data(), buffer_, expected.size()), 0);
+}
+
 TEST_F(TokenizeToBuffer, String) {
   size_t message_size = sizeof(buffer_);
 
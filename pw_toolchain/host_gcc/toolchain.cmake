@@ -15,10 +15,19 @@
 include($ENV{PW_ROOT}/pw_build/pigweed.cmake)
 
 pw_set_backend(pw_assert pw_assert_log)
+pw_set_backend(pw_benchmark.timer pw_benchmark.system_clock_timer)
 pw_set_backend(pw_chrono.system_clock pw_chrono_stl.system_clock)
 pw_set_backend(pw_log pw_log_basic)
 pw_set_backend(pw_rpc.system_server targets.host.system_rpc_server)
+pw_set_backend(pw_sync.binary_semaphore pw_sync_stl.binary_semaphore_backend)
+pw_set_backend(pw_sync.event_flags pw_sync_stl.event_flags_backend)
+pw_set_backend(pw_sync.interrupt_spin_lock pw_sync_stl.interrupt_spin_lock)
 pw_set_backend(pw_sync.mutex pw_sync_stl.mutex_backend)
+pw_set_backend(pw_sync.shared_mutex pw_sync_stl.shared_mutex_backend)
+pw_set_backend(pw_sync.thread_notification
+    pw_sync.binary_semaphore_thread_notification_backend)
+pw_set_backend(pw_sync.timed_thread_notification
+    pw_sync.binary_semaphore_timed_thread_notification_backend)
 pw_set_backend(pw_sys_io pw_sys_io_stdio)
 
 set(CMAKE_C_COMPILER gcc)
@@ -0,0 +1,103 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_trace_tokenized/trace_tokenized.h"
+
+namespace pw::trace::internal {
+namespace {
+
+class CompactHeaderEncoderTest : public ::testing::Test {
+ protected:
+  size_t Encode(uint32_t token, uint64_t delta) {
+    return encoder_.Encode(token, delta, buffer_);
+  }
+
+  uint8_t TokenBits() const {
+    return std::to_integer<uint8_t>(buffer_[0]) >> 5;
+  }
+  uint8_t DeltaBits() const {
+    return std::to_integer<uint8_t>(buffer_[0]) & 0x1f;
+  }
+
+  uint32_t LiteralToken() const {
+    uint32_t token;
+    std::memcpy(&token, &buffer_[1], sizeof(token));
+    return token;
+  }
+
+  CompactHeaderEncoder encoder_;
+  std::array<std::byte, 15> buffer_;
+};
+
+TEST_F(CompactHeaderEncoderTest, NewToken_WritesLiteral) {
+  ASSERT_EQ(Encode(0x12345678, 3), 5u);
+  EXPECT_EQ(TokenBits(), 7u);
+  EXPECT_EQ(DeltaBits(), 3u);
+  EXPECT_EQ(LiteralToken(), 0x12345678u);
+}
+
+TEST_F(CompactHeaderEncoderTest, RecentToken_WritesOneByte) {
+  Encode(1, 0);
+  ASSERT_EQ(Encode(1, 30), 1u);
+  EXPECT_EQ(TokenBits(), 0u);
+  EXPECT_EQ(DeltaBits(), 30u);
+}
+
+TEST_F(CompactHeaderEncoderTest, RecentTokens_MoveToFront) {
+  Encode(1, 0);
+  Encode(2, 0);
+  Encode(3, 0);  // [3, 2, 1]
+
+  ASSERT_EQ(Encode(1, 0), 1u);  // [1, 3, 2]
+  EXPECT_EQ(TokenBits(), 2u);
+  ASSERT_EQ(Encode(2, 0), 1u);  // [2, 1, 3]
+  EXPECT_EQ(TokenBits(), 2u);
+  ASSERT_EQ(Encode(2, 0), 1u);
+  EXPECT_EQ(TokenBits(), 0u);
+  ASSERT_EQ(Encode(3, 0), 1u);
+  EXPECT_EQ(TokenBits(), 2u);
+}
+
+TEST_F(CompactHeaderEncoderTest, LeastRecentToken_IsDropped) {
+  for (uint32_t token = 1; token <= 8; ++token) {
+    Encode(token, 0);
+  }
+  ASSERT_EQ(Encode(2, 0), 1u);
+  EXPECT_EQ(TokenBits(), 6u);
+  ASSERT_EQ(Encode(1, 0), 5u);
+  EXPECT_EQ(TokenBits(), 7u);
+}
+
+TEST_F(CompactHeaderEncoderTest, LargeDelta_WritesVarint) {
+  Encode(1, 0);
+  ASSERT_EQ(Encode(1, 31), 2u);
+  EXPECT_EQ(DeltaBits(), 31u);
+  EXPECT_EQ(buffer_[1], std::byte{31});
+
+  ASSERT_EQ(Encode(2, 300), 7u);
+  EXPECT_EQ(TokenBits(), 7u);
+  EXPECT_EQ(DeltaBits(), 31u);
+  EXPECT_EQ(LiteralToken(), 2u);
+  EXPECT_EQ(buffer_[5], std::byte{0xac});
+  EXPECT_EQ(buffer_[6], std::byte{0x02});
+}
+
+}  // namespace
+}  // namespace pw::trace::internal
@@ -0,0 +1,32 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Timestamps trace events in CPU cycles with pw::chrono::DwtCycleClock.
+// pw::chrono::DwtCycleClock::Enable() must be called before tracing starts.
+
+#include "pw_chrono/dwt_cycle_clock.h"
+#include "pw_trace_tokenized/trace_tokenized.h"
+
+using pw::chrono::DwtCycleClock;
+
+// Trace time deltas are unsigned differences, so the time may wrap when
+// PW_TRACE_TIME_TYPE is narrower than the clock.
+PW_TRACE_TIME_TYPE pw_trace_GetTraceTime() {
+  return static_cast<PW_TRACE_TIME_TYPE>(
+      DwtCycleClock::now().time_since_epoch().count());
+}
+
+size_t pw_trace_GetTraceTimeTicksPerSecond() {
+  return DwtCycleClock::period::den;
+}
@@ -0,0 +1,192 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_trace_tokenized/event_queue.h"
+
+#include <array>
+#include <cstring>
+#include <deque>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_trace_tokenized/trace_callback.h"
+#include "pw_trace_tokenized/trace_tokenized.h"
+#include "pw_varint/varint.h"
+
+namespace pw::trace {
+namespace {
+
+// Records the token and time delta of each event sent to the sinks.
+class TestSink {
+ public:
+  struct Event {
+    uint32_t trace_token;
+    uint64_t delta;
+  };
+
+  TestSink() {
+    TokenizedTrace::Instance().Enable(true);
+    Callbacks::Instance().RegisterSink(
+        nullptr, AddBytes, EndBlock, this, &handle_);
+  }
+
+  ~TestSink() {
+    Callbacks::Instance().UnregisterSink(handle_);
+    TokenizedTrace::Instance().Enable(false);
+  }
+
+  std::deque<Event>& events() { return events_; }
+
+ private:
+  static void AddBytes(void* user_data, const void* bytes, size_t size) {
+    TestSink& sink = *static_cast<TestSink*>(user_data);
+    if (sink.header_received_) {
+      return;  // Ignore the event data.
+    }
+    sink.header_received_ = true;
+
+    Event event;
+    std::memcpy(&event.trace_token, bytes, sizeof(event.trace_token));
+    varint::Decode(std::span(static_cast<const std::byte*>(bytes), size)
+                       .subspan(sizeof(event.trace_token)),
+                   &event.delta);
+    sink.events_.push_back(event);
+  }
+
+  static void EndBlock(void* user_data) {
+    static_cast<TestSink*>(user_data)->header_received_ = false;
+  }
+
+  CallbacksImpl::SinkHandle handle_;
+  bool header_received_ = false;
+  std::deque<Event> events_;
+};
+
+bool Push(EventQueue& queue, uint32_t token, PW_TRACE_TIME_TYPE time) {
+  return queue.TryPush(token,
+                       PW_TRACE_EVENT_TYPE_INSTANT,
+                       "module",
+                       0,
+                       0,
+                       time,
+                       nullptr,
+                       0);
+}
+
+TEST(EventQueue, PeekAndPop) {
+  EventQueue queue;
+  EXPECT_EQ(queue.Peek(), nullptr);
+
+  const uint8_t data[] = {1, 2, 3};
+  ASSERT_TRUE(queue.TryPush(
+      1, PW_TRACE_EVENT_TYPE_INSTANT, "module", 2, 3, 4, data, sizeof(data)));
+  ASSERT_TRUE(Push(queue, 5, 6));
+
+  const QueuedEvent* event = queue.Peek();
+  ASSERT_NE(event, nullptr);
+  EXPECT_EQ(event->trace_token, 1u);
+  EXPECT_EQ(event->trace_id, 2u);
+  EXPECT_EQ(event->flags, 3u);
+  EXPECT_EQ(event->time, 4u);
+  ASSERT_EQ(event->data_size, sizeof(data));
+  EXPECT_EQ(std::memcmp(event->data_buffer, data, sizeof(data)), 0);
+  EXPECT_EQ(queue.Peek(), event);
+
+  queue.Pop();
+  event = queue.Peek();
+  ASSERT_NE(event, nullptr);
+  EXPECT_EQ(event->trace_token, 5u);
+
+  queue.Pop();
+  EXPECT_EQ(queue.Peek(), nullptr);
+}
+
+TEST(EventQueue, Full_DropsAndCountsEvents) {
+  EventQueue queue;
+  for (uint32_t i = 0; i < PW_TRACE_EVENT_QUEUE_SIZE_EVENTS; ++i) {
+    ASSERT_TRUE(Push(queue, i, i));
+  }
+  EXPECT_FALSE(Push(queue, 100, 100));
+  EXPECT_FALSE(Push(queue, 101, 101));
+  EXPECT_EQ(queue.dropped_events(), 2u);
+}
+
+TEST(EventQueue, DataTooLarge_DropsEvent) {
+  EventQueue queue;
+  std::array<std::byte, PW_TRACE_BUFFER_MAX_DATA_SIZE_BYTES + 1> data{};
+  EXPECT_FALSE(queue.TryPush(
+      1, PW_TRACE_EVENT_TYPE_INSTANT, "module", 0, 0, 0, &data, data.size()));
+  EXPECT_EQ(queue.dropped_events(), 1u);
+  EXPECT_EQ(queue.Peek(), nullptr);
+}
+
+// Returns a time after every event processed so far, with room for events
+// before it. This relies on the fake trace time, which counts calls.
+PW_TRACE_TIME_TYPE AdvanceTime() {
+  for (int i = 0; i < 100; ++i) {
+    pw_trace_GetTraceTime();
+  }
+  return pw_trace_GetTraceTime();
+}
+
+TEST(EventQueue, ProcessEventQueues_MergesByTime) {
+  const PW_TRACE_TIME_TYPE time = AdvanceTime();
+  TestSink sink;
+  EventQueue first;
+  EventQueue second;
+  ASSERT_TRUE(Push(first, 1, time - 40));
+  ASSERT_TRUE(Push(second, 2, time - 35));
+  ASSERT_TRUE(Push(first, 3, time - 30));
+  ASSERT_TRUE(Push(first, 4, time - 20));
+  ASSERT_TRUE(Push(second, 5, time - 19));
+
+  std::array<EventQueue*, 2> queues = {&first, &second};
+  EXPECT_EQ(TokenizedTrace::Instance().ProcessEventQueues(queues), 5u);
+  EXPECT_EQ(first.Peek(), nullptr);
+  EXPECT_EQ(second.Peek(), nullptr);
+
+  ASSERT_EQ(sink.events().size(), 5u);
+  const uint32_t expected_tokens[] = {1, 2, 3, 4, 5};
+  const uint64_t expected_deltas[] = {5, 5, 10, 1};
+  for (size_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(sink.events()[i].trace_token, expected_tokens[i]);
+    if (i > 0) {
+      EXPECT_EQ(sink.events()[i].delta, expected_deltas[i - 1]);
+    }
+  }
+}
+
+TEST(EventQueue, ProcessEventQueues_LateEvent_HasNoDelta) {
+  const PW_TRACE_TIME_TYPE time = AdvanceTime();
+  TestSink sink;
+  EventQueue first;
+  EventQueue second;
+  ASSERT_TRUE(Push(first, 1, time - 20));
+  std::array<EventQueue*, 2> queues = {&first, &second};
+  EXPECT_EQ(TokenizedTrace::Instance().ProcessEventQueues(queues), 1u);
+
+  // Recorded before the processed event, but pushed after it was processed.
+  ASSERT_TRUE(Push(second, 2, time - 30));
+  ASSERT_TRUE(Push(first, 3, time - 10));
+  EXPECT_EQ(TokenizedTrace::Instance().ProcessEventQueues(queues), 2u);
+
+  ASSERT_EQ(sink.events().size(), 3u);
+  EXPECT_EQ(sink.events()[1].trace_token, 2u);
+  EXPECT_EQ(sink.events()[1].delta, 0u);
+  EXPECT_EQ(sink.events()[2].trace_token, 3u);
+  EXPECT_EQ(sink.events()[2].delta, 10u);
+}
+
+}  // namespace
+}  // namespace pw::trace
@@ -28,9 +28,12 @@ python pw_trace_tokenized/py/pw_trace_tokenized/get_trace.py
  out/host_clang_debug/obj/pw_trace_tokenized/bin/trace_tokenized_example_rpc
  pw_trace_tokenized/pw_trace_protos/trace_rpc.proto
 
+To stream the trace while the app runs, add --stream and stop with Ctrl-C.
+
 VIEW
 In chrome navigate to chrome://tracing, and load the trace.json file.
 */
+#include <chrono>
 #include <thread>
 
 #include "pw_log/log.h"
@@ -52,10 +55,19 @@ void RpcThread() {
   pw::rpc::system_server::Start();
 }
 
+void TraceFlushThread() {
+  while (true) {
+    // Streams entries if a StreamTraceData call is open.
+    trace_service.Flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+}
+
 }  // namespace
 
 int main() {
   std::thread rpc_thread(RpcThread);
+  std::thread flush_thread(TraceFlushThread);
 
   // Enable tracing.
   PW_TRACE_SET_ENABLED(true);
@@ -0,0 +1,703 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+//==============================================================================
+//
+
+#include "pw_trace_tokenized/perfetto_exporter.h"
+
+#include <cstring>
+#include <vector>
+
+#include "pw_varint/varint.h"
+
+namespace pw::trace {
+namespace {
+
+// Field numbers from Perfetto's protos/perfetto/trace/trace.proto and the
+// messages it includes.
+namespace Trace {
+constexpr uint32_t kPacket = 1;
+}  // namespace Trace
+
+namespace TracePacket {
+constexpr uint32_t kTimestamp = 8;
+constexpr uint32_t kTrustedPacketSequenceId = 10;
+constexpr uint32_t kTrackEvent = 11;
+constexpr uint32_t kInternedData = 12;
+constexpr uint32_t kSequenceFlags = 13;
+constexpr uint32_t kTrackDescriptor = 60;
+
+constexpr uint32_t kSeqIncrementalStateCleared = 1;
+constexpr uint32_t kSeqNeedsIncrementalState = 2;
+}  // namespace TracePacket
+
+namespace TrackDescriptor {
+constexpr uint32_t kUuid = 1;
+constexpr uint32_t kName = 2;
+constexpr uint32_t kProcess = 3;
+constexpr uint32_t kParentUuid = 5;
+constexpr uint32_t kCounter = 8;
+}  // namespace TrackDescriptor
+
+namespace ProcessDescriptor {
+constexpr uint32_t kPid = 1;
+constexpr uint32_t kProcessName = 6;
+}  // namespace ProcessDescriptor
+
+namespace TrackEvent {
+constexpr uint32_t kDebugAnnotations = 4;
+constexpr uint32_t kType = 9;
+constexpr uint32_t kNameIid = 10;
+constexpr uint32_t kTrackUuid = 11;
+constexpr uint32_t kName = 23;
+constexpr uint32_t kCounterValue = 30;
+
+constexpr uint32_t kTypeSliceBegin = 1;
+constexpr uint32_t kTypeSliceEnd = 2;
+constexpr uint32_t kTypeInstant = 3;
+constexpr uint32_t kTypeCounter = 4;
+}  // namespace TrackEvent
+
+namespace DebugAnnotation {
+constexpr uint32_t kUintValue = 3;
+constexpr uint32_t kIntValue = 4;
+constexpr uint32_t kDoubleValue = 5;
+constexpr uint32_t kStringValue = 6;
+constexpr uint32_t kName = 10;
+}  // namespace DebugAnnotation
+
+namespace InternedData {
+constexpr uint32_t kEventNames = 2;
+}  // namespace InternedData
+
+namespace EventName {
+constexpr uint32_t kIid = 1;
+constexpr uint32_t kName = 2;
+}  // namespace EventName
+
+// All packets are written to one sequence.
+constexpr uint32_t kSequenceId = 1;
+
+// The first byte of a compact entry holds the recent token index in bits 7-5
+// and the time delta in bits 4-0. These values mean that the token or varint
+// delta follows.
+constexpr uint8_t kCompactLiteralToken = 7;
+constexpr uint8_t kCompactVarintDelta = 31;
+
+std::string_view AsString(ConstByteSpan data) {
+  return std::string_view(reinterpret_cast<const char*>(data.data()),
+                          data.size());
+}
+
+// A decoded value of a @pw_py_struct_fmt argument.
+struct Value {
+  enum Kind { kUint, kInt, kDouble, kString } kind;
+  uint64_t uint_value = 0;
+  int64_t int_value = 0;
+  double double_value = 0;
+  std::string_view string_value;
+};
+
+uint64_t ReadUint(ConstByteSpan data, bool big_endian) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < data.size(); ++i) {
+    const size_t index = big_endian ? i : data.size() - 1 - i;
+    value = value << 8 | std::to_integer<uint8_t>(data[index]);
+  }
+  return value;
+}
+
+// Decodes data with a Python struct format string, as pw_trace does for
+// @pw_py_struct_fmt. Supports the byte order prefixes and the integer, bool,
+// float, double, char, string, and padding codes. Returns false if the format
+// is not supported or does not match the data.
+bool DecodeStruct(std::string_view format,
+                  ConstByteSpan data,
+                  std::vector<Value>& values) {
+  bool big_endian = false;
+  bool aligned = true;
+  if (!format.empty() && std::strchr("@=<>!", format[0]) != nullptr) {
+    big_endian = format[0] == '>' || format[0] == '!';
+    aligned = format[0] == '@';
+    format.remove_prefix(1);
+  }
+
+  size_t offset = 0;
+  while (!format.empty()) {
+    size_t count = 1;
+    if (format[0] >= '0' && format[0] <= '9') {
+      count = 0;
+      while (!format.empty() && format[0] >= '0' && format[0] <= '9') {
+        count = count * 10 + (format[0] - '0');
+        format.remove_prefix(1);
+      }
+      if (format.empty()) {
+        return false;
+      }
+    }
+    const char code = format[0];
+    format.remove_prefix(1);
+
+    if (code == ' ') {
+      continue;
+    }
+    if (code == 'x' || code == 's') {
+      if (data.size() - offset < count) {
+        return false;
+      }
+      if (code == 's') {
+        Value& value = values.emplace_back();
+        value.kind = Value::kString;
+        value.string_value = AsString(data.subspan(offset, count));
+        // Python keeps the null padding of strings; drop it for display.
+        while (!value.string_value.empty() &&
+               value.string_value.back() == '\0') {
+          value.string_value.remove_suffix(1);
+        }
+      }
+      offset += count;
+      continue;
+    }
+
+    size_t size;
+    Value::Kind kind;
+    switch (code) {
+      case 'c':
+      case 'B':
+      case '?':
+        size = 1;
+        kind = Value::kUint;
+        break;
+      case 'b':
+        size = 1;
+        kind = Value::kInt;
+        break;
+      case 'H':
+        size = 2;
+        kind = Value::kUint;
+        break;
+      case 'h':
+        size = 2;
+        kind = Value::kInt;
+        break;
+      case 'I':
+      case 'L':
+        size = 4;
+        kind = Value::kUint;
+        break;
+      case 'i':
+      case 'l':
+        size = 4;
+        kind = Value::kInt;
+        break;
+      case 'Q':
+        size = 8;
+        kind = Value::kUint;
+        break;
+      case 'q':
+        size = 8;
+        kind = Value::kInt;
+        break;
+      case 'f':
+        size = 4;
+        kind = Value::kDouble;
+        break;
+      case 'd':
+        size = 8;
+        kind = Value::kDouble;
+        break;
+      default:
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      if (aligned && offset % size != 0) {
+        offset += size - offset % size;
+      }
+      if (offset > data.size() || data.size() - offset < size) {
+        return false;
+      }
+      const uint64_t raw = ReadUint(data.subspan(offset, size), big_endian);
+      offset += size;
+
+      Value& value = values.emplace_back();
+      value.kind = kind;
+      if (kind == Value::kUint) {
+        value.uint_value = raw;
+      } else if (kind == Value::kInt) {
+        const uint64_t sign_bit = uint64_t(1) << (size * 8 - 1);
+        value.int_value = static_cast<int64_t>((raw ^ sign_bit) - sign_bit);
+      } else if (size == sizeof(float)) {
+        const uint32_t bits = static_cast<uint32_t>(raw);
+        float float_value;
+        std::memcpy(&float_value, &bits, sizeof(float_value));
+        value.double_value = float_value;
+      } else {
+        std::memcpy(&value.double_value, &raw, sizeof(value.double_value));
+      }
+    }
+  }
+  return true;
+}
+
+void WriteHexAnnotation(protobuf::Encoder& encoder, ConstByteSpan data) {
+  static constexpr char kHexDigits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(data.size() * 2);
+  for (std::byte b : data) {
+    hex.push_back(kHexDigits[std::to_integer<uint8_t>(b) >> 4]);
+    hex.push_back(kHexDigits[std::to_integer<uint8_t>(b) & 0xf]);
+  }
+  encoder.Push(TrackEvent::kDebugAnnotations);
+  encoder.WriteString(DebugAnnotation::kName, "data");
+  encoder.WriteString(DebugAnnotation::kStringValue, hex.data(), hex.size());
+  encoder.Pop();
+}
+
+}  // namespace
+
+PerfettoExporter::PerfettoExporter(const tokenizer::Detokenizer& detokenizer,
+                                   std::ostream& output,
+                                   const Options& options)
+    : detokenizer_(detokenizer),
+      output_(output),
+      options_(options),
+      packet_(packet_buffer_) {}
+
+size_t PerfettoExporter::ExportCapture(ConstByteSpan data) {
+  size_t used = 0;
+  while (used < data.size()) {
+    const size_t size = std::to_integer<uint8_t>(data[used]);
+    if (data.size() - used - 1 < size) {
+      break;  // The rest of the entry is in the next piece.
+    }
+    ExportEntry(data.subspan(used + 1, size)).IgnoreError();
+    used += 1 + size;
+  }
+  return used;
+}
+
+Status PerfettoExporter::ExportEntry(ConstByteSpan entry) {
+  uint32_t token = 0;
+  bool token_known = true;
+  uint64_t time_delta;
+  size_t offset;
+
+  if (options_.compact) {
+    if (entry.empty()) {
+      skipped_events_ += 1;
+      return Status::DataLoss();
+    }
+    const uint8_t header = std::to_integer<uint8_t>(entry[0]);
+    const uint8_t token_index = header >> 5;
+    time_delta = header & 0x1f;
+    offset = 1;
+
+    if (token_index == kCompactLiteralToken) {
+      if (entry.size() < offset + sizeof(token)) {
+        skipped_events_ += 1;
+        return Status::DataLoss();
+      }
+      std::memcpy(&token, &entry[offset], sizeof(token));
+      offset += sizeof(token);
+      recent_tokens_.Add(token);
+    } else {
+      const std::optional<uint32_t> recent = recent_tokens_.Use(token_index);
+      token_known = recent.has_value();
+      token = recent.value_or(0);
+    }
+
+    if (time_delta == kCompactVarintDelta) {
+      const size_t delta_bytes =
+          varint::Decode(entry.subspan(offset), &time_delta);
+      if (delta_bytes == 0) {
+        skipped_events_ += 1;
+        return Status::DataLoss();
+      }
+      offset += delta_bytes;
+    }
+  } else {
+    if (entry.size() < sizeof(token)) {
+      skipped_events_ += 1;
+      return Status::DataLoss();
+    }
+    std::memcpy(&token, entry.data(), sizeof(token));
+    offset = sizeof(token);
+
+    const size_t delta_bytes =
+        varint::Decode(entry.subspan(offset), &time_delta);
+    if (delta_bytes == 0) {
+      skipped_events_ += 1;
+      return Status::DataLoss();
+    }
+    offset += delta_bytes;
+  }
+
+  time_ticks_ += time_delta;
+
+  if (!token_known) {
+    skipped_events_ += 1;
+    return Status::Unavailable();
+  }
+
+  TokenInfo& info = LookUp(token);
+  if (!info.found) {
+    skipped_events_ += 1;
+    return Status::NotFound();
+  }
+
+  uint64_t trace_id = 0;
+  if ((info.type == EventType::kAsyncStart ||
+       info.type == EventType::kAsyncStep ||
+       info.type == EventType::kAsyncEnd) &&
+      offset < entry.size()) {
+    const size_t id_bytes = varint::Decode(entry.subspan(offset), &trace_id);
+    if (id_bytes == 0) {
+      skipped_events_ += 1;
+      return Status::DataLoss();
+    }
+    offset += id_bytes;
+  }
+
+  const ConstByteSpan data =
+      info.data_format.has_value() ? entry.subspan(offset) : ConstByteSpan();
+  if (Status status = WriteEvent(
+          info, static_cast<uint32_t>(trace_id), data, TimestampNs());
+      !status.ok()) {
+    skipped_events_ += 1;
+    return status;
+  }
+  exported_events_ += 1;
+  return OkStatus();
+}
+
+PerfettoExporter::TokenInfo& PerfettoExporter::LookUp(uint32_t token) {
+  auto [entry, inserted] = tokens_.try_emplace(token);
+  TokenInfo& info = entry->second;
+  if (!inserted) {
+    return info;
+  }
+
+  std::array<uint8_t, sizeof(token)> encoded;
+  std::memcpy(encoded.data(), &token, sizeof(token));
+  const std::string string =
+      detokenizer_.Detokenize(encoded.data(), encoded.size()).BestString();
+
+  // Split "event_type|flags|module|group|label|data_format".
+  std::array<std::string_view, 6> fields;
+  size_t field_count = 0;
+  std::string_view remaining = string;
+  while (field_count < fields.size()) {
+    const size_t end = remaining.find('|');
+    fields[field_count++] = remaining.substr(0, end);
+    if (end == std::string_view::npos) {
+      break;
+    }
+    remaining.remove_prefix(end + 1);
+  }
+  if (field_count < 5) {
+    return info;
+  }
+
+  static constexpr std::pair<std::string_view, EventType> kEventTypes[] = {
+      {"PW_TRACE_EVENT_TYPE_INSTANT", EventType::kInstant},
+      {"PW_TRACE_EVENT_TYPE_INSTANT_GROUP", EventType::kInstantGroup},
+      {"PW_TRACE_EVENT_TYPE_ASYNC_START", EventType::kAsyncStart},
+      {"PW_TRACE_EVENT_TYPE_ASYNC_STEP", EventType::kAsyncStep},
+      {"PW_TRACE_EVENT_TYPE_ASYNC_END", EventType::kAsyncEnd},
+      {"PW_TRACE_EVENT_TYPE_DURATION_START", EventType::kDurationStart},
+      {"PW_TRACE_EVENT_TYPE_DURATION_END", EventType::kDurationEnd},
+      {"PW_TRACE_EVENT_TYPE_DURATION_GROUP_START",
+       EventType::kDurationGroupStart},
+      {"PW_TRACE_EVENT_TYPE_DURATION_GROUP_END", EventType::kDurationGroupEnd},
+  };
+  for (const auto& [name, type] : kEventTypes) {
+    if (fields[0] == name) {
+      info.type = type;
+    }
+  }
+  if (info.type == EventType::kInvalid) {
+    return info;
+  }
+
+  info.found = true;
+  info.module = fields[2];
+  info.group = fields[3];
+  info.label = fields[4];
+  if (field_count > 5) {
+    info.data_format = std::string(fields[5]);
+  }
+  return info;
+}
+
+Status PerfettoExporter::WriteEvent(TokenInfo& info,
+                                    uint32_t trace_id,
+                                    ConstByteSpan data,
+                                    uint64_t timestamp_ns) {
+  const bool has_data = info.data_format.has_value();
+  const std::string_view format =
+      has_data ? std::string_view(*info.data_format) : std::string_view();
+  const bool counter = has_data && format == "@pw_arg_counter";
+  const bool async = info.type == EventType::kAsyncStart ||
+                     info.type == EventType::kAsyncStep ||
+                     info.type == EventType::kAsyncEnd;
+
+  std::string_view name = info.label;
+  bool interned_name = !counter;
+  if (has_data && format == "@pw_arg_label") {
+    name = AsString(data);
+    interned_name = false;
+  }
+
+  std::string_view group = info.group;
+  if (has_data && format == "@pw_arg_group") {
+    group = AsString(data);
+  }
+
+  uint32_t type;
+  switch (info.type) {
+    case EventType::kDurationStart:
+    case EventType::kDurationGroupStart:
+    case EventType::kAsyncStart:
+      type = TrackEvent::kTypeSliceBegin;
+      break;
+    case EventType::kDurationEnd:
+    case EventType::kDurationGroupEnd:
+    case EventType::kAsyncEnd:
+      type = TrackEvent::kTypeSliceEnd;
+      break;
+    default:
+      type = TrackEvent::kTypeInstant;
+      break;
+  }
+  if (counter) {
+    type = TrackEvent::kTypeCounter;
+  }
+
+  // Find the event's track, which is written before the event packet since
+  // they share the encoder. Unless the track depends on the event's data or
+  // trace ID, it is cached to avoid looking it up by name.
+  const bool same_track_for_token = !async && format != "@pw_arg_group";
+  uint64_t track = same_track_for_token ? info.track_uuid : 0;
+  if (track == 0) {
+    if (counter) {
+      track = ChildTrack(info.module, name, std::nullopt, true);
+    } else if (async) {
+      track = ChildTrack(info.module, group, trace_id, false);
+    } else if (info.type == EventType::kDurationStart ||
+               info.type == EventType::kDurationEnd) {
+      const std::string_view thread =
+          format == "@pw_arg_group" ? group : std::string_view(info.label);
+      track = ChildTrack(info.module, thread, std::nullopt, false);
+    } else if (info.type == EventType::kInstant) {
+      track = ProcessTrack(info.module);
+    } else {
+      track = ChildTrack(info.module, group, std::nullopt, false);
+    }
+    if (same_track_for_token) {
+      info.track_uuid = track;
+    }
+  }
+
+  StartPacket(TracePacket::kSeqNeedsIncrementalState);
+  packet_.WriteUint64(TracePacket::kTimestamp, timestamp_ns);
+
+  if (interned_name && info.name_iid == 0) {
+    info.name_iid = next_name_iid_++;
+    packet_.Push(TracePacket::kInternedData);
+    packet_.Push(InternedData::kEventNames);
+    packet_.WriteUint64(EventName::kIid, info.name_iid);
+    packet_.WriteString(EventName::kName, name.data(), name.size());
+    packet_.Pop();
+    packet_.Pop();
+  }
+
+  packet_.Push(TracePacket::kTrackEvent);
+  packet_.WriteUint32(TrackEvent::kType, type);
+  packet_.WriteUint64(TrackEvent::kTrackUuid, track);
+
+  if (counter) {
+    packet_.WriteInt64(
+        TrackEvent::kCounterValue,
+        static_cast<int64_t>(ReadUint(
+            data.first(std::min<size_t>(data.size(), sizeof(uint64_t))),
+            false)));
+  } else if (type != TrackEvent::kTypeSliceEnd) {
+    if (interned_name) {
+      packet_.WriteUint64(TrackEvent::kNameIid, info.name_iid);
+    } else {
+      packet_.WriteString(TrackEvent::kName, name.data(), name.size());
+    }
+  }
+
+  if (async) {
+    packet_.Push(TrackEvent::kDebugAnnotations);
+    packet_.WriteString(DebugAnnotation::kName, "id");
+    packet_.WriteUint64(DebugAnnotation::kUintValue, trace_id);
+    packet_.Pop();
+  }
+
+  static constexpr std::string_view kStructFormat = "@pw_py_struct_fmt:";
+  if (has_data && format.substr(0, kStructFormat.size()) == kStructFormat) {
+    std::vector<Value> values;
+    if (DecodeStruct(format.substr(kStructFormat.size()), data, values)) {
+      for (size_t i = 0; i < values.size(); ++i) {
+        const std::string annotation_name = "data_" + std::to_string(i);
+        packet_.Push(TrackEvent::kDebugAnnotations);
+        packet_.WriteString(DebugAnnotation::kName,
+                            annotation_name.data(),
+                            annotation_name.size());
+        const Value& value = values[i];
+        switch (value.kind) {
+          case Value::kUint:
+            packet_.WriteUint64(DebugAnnotation::kUintValue, value.uint_value);
+            break;
+          case Value::kInt:
+            packet_.WriteInt64(DebugAnnotation::kIntValue, value.int_value);
+            break;
+          case Value::kDouble:
+            packet_.WriteDouble(DebugAnnotation::kDoubleValue,
+                                value.double_value);
+            break;
+          case Value::kString:
+            packet_.WriteString(DebugAnnotation::kStringValue,
+                                value.string_value.data(),
+                                value.string_value.size());
+            break;
+        }
+        packet_.Pop();
+      }
+    } else {
+      WriteHexAnnotation(packet_, data);
+    }
+  } else if (has_data && format != "@pw_arg_label" &&
+             format != "@pw_arg_group" && !counter) {
+    WriteHexAnnotation(packet_, data);
+  }
+
+  packet_.Pop();
+  return FinishPacket();
+}
+
+uint64_t PerfettoExporter::ProcessTrack(const std::string& module) {
+  std::string key = "p";
+  key += module;
+  auto [entry, inserted] = tracks_.try_emplace(std::move(key), 0);
+  if (!inserted) {
+    return entry->second;
+  }
+  entry->second = tracks_.size();
+
+  StartPacket(0);
+  packet_.Push(TracePacket::kTrackDescriptor);
+  packet_.WriteUint64(TrackDescriptor::kUuid, entry->second);
+  packet_.Push(TrackDescriptor::kProcess);
+  packet_.WriteInt32(ProcessDescriptor::kPid, next_pid_++);
+  packet_.WriteString(
+      ProcessDescriptor::kProcessName, module.data(), module.size());
+  packet_.Pop();
+  packet_.Pop();
+  FinishPacket().IgnoreError();
+  return entry->second;
+}
+
+uint64_t PerfettoExporter::ChildTrack(const std::string& module,
+                                      std::string_view name,
+                                      std::optional<uint32_t> trace_id,
+                                      bool counter) {
+  // Look up the parent first, so its UUID is lower.
+  const uint64_t parent = ProcessTrack(module);
+
+  std::string key(counter ? "c" : trace_id.has_value() ? "a" : "t");
+  key += module;
+  key.push_back('\0');
+  key += name;
+  if (trace_id.has_value()) {
+    key.push_back('\0');
+    key += std::to_string(*trace_id);
+  }
+  auto [entry, inserted] = tracks_.try_emplace(std::move(key), 0);
+  if (!inserted) {
+    return entry->second;
+  }
+  entry->second = tracks_.size();
+
+  StartPacket(0);
+  packet_.Push(TracePacket::kTrackDescriptor);
+  packet_.WriteUint64(TrackDescriptor::kUuid, entry->second);
+  packet_.WriteUint64(TrackDescriptor::kParentUuid, parent);
+  packet_.WriteString(TrackDescriptor::kName, name.data(), name.size());
+  if (counter) {
+    packet_.Push(TrackDescriptor::kCounter);
+    packet_.Pop();
+  }
+  packet_.Pop();
+  FinishPacket().IgnoreError();
+  return entry->second;
+}
+
+void PerfettoExporter::StartPacket(uint32_t sequence_flags) {
+  packet_.Clear();
+  packet_.WriteUint32(TracePacket::kTrustedPacketSequenceId, kSequenceId);
+  if (first_packet_) {
+    sequence_flags |= TracePacket::kSeqIncrementalStateCleared;
+    first_packet_ = false;
+  }
+  if (sequence_flags != 0) {
+    packet_.WriteUint32(TracePacket::kSequenceFlags, sequence_flags);
+  }
+}
+
+Status PerfettoExporter::FinishPacket() {
+  const Result<ConstByteSpan> encoded = packet_.Encode();
+  if (!encoded.ok()) {
+    return encoded.status();
+  }
+
+  // Write the packet as a field of the Trace message.
+  std::array<std::byte, 1 + varint::kMaxVarint64SizeBytes> key;
+  key[0] = std::byte(Trace::kPacket << 3 | 2);  // Length-delimited
+  const size_t key_size =
+      1 + varint::Encode(encoded.value().size(), std::span(key).subspan(1));
+  output_.write(reinterpret_cast<const char*>(key.data()), key_size);
+  output_.write(reinterpret_cast<const char*>(encoded.value().data()),
+                encoded.value().size());
+  return output_ ? OkStatus() : Status::DataLoss();
+}
+
+uint64_t PerfettoExporter::TimestampNs() const {
+  constexpr uint64_t kNsPerSecond = 1'000'000'000;
+  const uint64_t seconds = time_ticks_ / options_.ticks_per_second;
+  const uint64_t remainder = time_ticks_ % options_.ticks_per_second;
+  return seconds * kNsPerSecond +
+         remainder * kNsPerSecond / options_.ticks_per_second;
+}
+
+void PerfettoExporter::RecentTokens::Add(uint32_t token) {
+  for (size_t i = kSize - 1; i > 0; --i) {
+    tokens_[i] = tokens_[i - 1];
+  }
+  tokens_[0] = token;
+}
+
+std::optional<uint32_t> PerfettoExporter::RecentTokens::Use(size_t index) {
+  const std::optional<uint32_t> token = tokens_[index];
+  for (size_t i = index; i > 0; --i) {
+    tokens_[i] = tokens_[i - 1];
+  }
+  tokens_[0] = token;
+  return token;
+}
+
+}  // namespace pw::trace
@@ -0,0 +1,125 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+//==============================================================================
+// Converts a binary trace capture to a Perfetto trace file.
+//
+// BUILD
+// ninja -C out
+// host_clang_debug/obj/pw_trace_tokenized/bin/trace_tokenized_to_perfetto
+//
+// RUN
+// python -m pw_tokenizer.database create --type binary -o tokens.bin app.elf
+// ./out/host_clang_debug/obj/pw_trace_tokenized/bin/trace_tokenized_to_perfetto
+// tokens.bin trace.bin trace.perfetto
+//
+// VIEW
+// Open trace.perfetto in ui.perfetto.dev.
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "pw_log/log.h"
+#include "pw_tokenizer/detokenize.h"
+#include "pw_tokenizer/token_database.h"
+#include "pw_trace_tokenized/perfetto_exporter.h"
+
+namespace {
+
+constexpr size_t kReadSize = 1 << 20;
+
+void Usage() {
+  PW_LOG_ERROR(
+      "Usage: trace_tokenized_to_perfetto [--compact] "
+      "[--ticks-per-second TICKS] DATABASE INPUT OUTPUT");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  pw::trace::PerfettoExporter::Options options;
+  std::vector<const char*> paths;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--compact") == 0) {
+      options.compact = true;
+    } else if (std::strcmp(argv[i], "--ticks-per-second") == 0 &&
+               i + 1 < argc) {
+      options.ticks_per_second = std::strtoull(argv[++i], nullptr, 10);
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.size() != 3 || options.ticks_per_second == 0) {
+    Usage();
+    return 1;
+  }
+
+  // The database must be a binary token database.
+  std::ifstream database_file(paths[0], std::ios::binary);
+  const std::string database_bytes(
+      (std::istreambuf_iterator<char>(database_file)),
+      std::istreambuf_iterator<char>());
+  const pw::tokenizer::TokenDatabase database =
+      pw::tokenizer::TokenDatabase::Create(database_bytes);
+  if (!database.ok()) {
+    PW_LOG_ERROR("%s is not a binary token database", paths[0]);
+    return 1;
+  }
+  const pw::tokenizer::Detokenizer detokenizer(database);
+
+  std::ifstream input(paths[1], std::ios::binary);
+  if (!input) {
+    PW_LOG_ERROR("Failed to open %s", paths[1]);
+    return 1;
+  }
+  std::ofstream output(paths[2], std::ios::binary);
+  if (!output) {
+    PW_LOG_ERROR("Failed to open %s", paths[2]);
+    return 1;
+  }
+
+  pw::trace::PerfettoExporter exporter(detokenizer, output, options);
+
+  // Read the capture in large pieces, carrying an incomplete entry at the end
+  // of each piece over to the next.
+  std::vector<std::byte> buffer(kReadSize);
+  size_t buffered = 0;
+  while (input) {
+    input.read(reinterpret_cast<char*>(buffer.data() + buffered),
+               buffer.size() - buffered);
+    buffered += input.gcount();
+
+    const size_t used =
+        exporter.ExportCapture(std::span(buffer.data(), buffered));
+    std::memmove(buffer.data(), buffer.data() + used, buffered - used);
+    buffered -= used;
+  }
+
+  output.close();
+  if (!output) {
+    PW_LOG_ERROR("Failed to write %s", paths[2]);
+    return 1;
+  }
+
+  if (buffered != 0) {
+    PW_LOG_WARN("Ignored an incomplete entry at the end of the capture");
+  }
+  PW_LOG_INFO("Exported %u events; skipped %u",
+              static_cast<unsigned>(exporter.exported_events()),
+              static_cast<unsigned>(exporter.skipped_events()));
+  return 0;
+}
@@ -0,0 +1,348 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_trace_tokenized/perfetto_exporter.h"
+
+#include <cstring>
+#include <initializer_list>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "pw_varint/varint.h"
+
+namespace pw::trace {
+namespace {
+
+// The database's tokens are chosen by the test rather than hashed.
+alignas(tokenizer::TokenDatabase::RawEntry) constexpr char kDatabase[] =
+    "TOKENS\0\0"
+    "\x06\x00\x00\x00"
+    "\0\0\0\0"
+    "\x01\x00\x00\x00----"
+    "\x02\x00\x00\x00----"
+    "\x03\x00\x00\x00----"
+    "\x04\x00\x00\x00----"
+    "\x05\x00\x00\x00----"
+    "\x06\x00\x00\x00----"
+    "PW_TRACE_EVENT_TYPE_INSTANT|0|radio||rx\0"
+    "PW_TRACE_EVENT_TYPE_DURATION_START|0|radio||send\0"
+    "PW_TRACE_EVENT_TYPE_DURATION_END|0|radio||send\0"
+    "PW_TRACE_EVENT_TYPE_ASYNC_START|0|radio|jobs|job\0"
+    "PW_TRACE_EVENT_TYPE_INSTANT|0|radio||rssi|@pw_arg_counter\0"
+    "PW_TRACE_EVENT_TYPE_INSTANT|0|radio||pkt|@pw_py_struct_fmt:<Hb";
+
+constexpr uint32_t kInstant = 1;
+constexpr uint32_t kDurationStart = 2;
+constexpr uint32_t kDurationEnd = 3;
+constexpr uint32_t kAsyncStart = 4;
+constexpr uint32_t kCounter = 5;
+constexpr uint32_t kStruct = 6;
+constexpr uint32_t kUnknown = 99;
+
+// A decoded protobuf message. Varint fields are stored as integers and
+// length-delimited fields as bytes.
+struct Message {
+  Message() = default;
+
+  explicit Message(ConstByteSpan data) {
+    while (!data.empty()) {
+      uint64_t key;
+      size_t size = varint::Decode(data, &key);
+      data = data.subspan(size);
+      const uint32_t field = static_cast<uint32_t>(key >> 3);
+      if ((key & 7) == 0) {
+        uint64_t value;
+        data = data.subspan(varint::Decode(data, &value));
+        ints.emplace(field, value);
+      } else if ((key & 7) == 1) {
+        uint64_t value;
+        std::memcpy(&value, data.data(), sizeof(value));
+        data = data.subspan(sizeof(value));
+        ints.emplace(field, value);
+      } else {
+        uint64_t length;
+        data = data.subspan(varint::Decode(data, &length));
+        messages.emplace(field, data.first(length));
+        data = data.subspan(length);
+      }
+    }
+  }
+
+  bool Has(uint32_t field) const {
+    return ints.count(field) != 0 || messages.count(field) != 0;
+  }
+  uint64_t Int(uint32_t field) const {
+    auto it = ints.find(field);
+    return it == ints.end() ? 0 : it->second;
+  }
+  std::string_view String(uint32_t field) const {
+    auto it = messages.find(field);
+    return it == messages.end()
+               ? std::string_view()
+               : std::string_view(
+                     reinterpret_cast<const char*>(it->second.data()),
+                     it->second.size());
+  }
+  Message Sub(uint32_t field) const {
+    auto it = messages.find(field);
+    return it == messages.end() ? Message() : Message(it->second);
+  }
+  std::vector<Message> All(uint32_t field) const {
+    std::vector<Message> all;
+    auto [begin, end] = messages.equal_range(field);
+    for (auto it = begin; it != end; ++it) {
+      all.emplace_back(it->second);
+    }
+    return all;
+  }
+
+  std::multimap<uint32_t, uint64_t> ints;
+  std::multimap<uint32_t, ConstByteSpan> messages;
+};
+
+// Field numbers of the Perfetto messages.
+constexpr uint32_t kPacket = 1;
+constexpr uint32_t kTimestamp = 8;
+constexpr uint32_t kTrackEvent = 11;
+constexpr uint32_t kInternedData = 12;
+constexpr uint32_t kSequenceFlags = 13;
+constexpr uint32_t kTrackDescriptor = 60;
+
+constexpr uint32_t kEventType = 9;
+constexpr uint32_t kEventNameIid = 10;
+constexpr uint32_t kEventTrackUuid = 11;
+constexpr uint32_t kEventCounterValue = 30;
+constexpr uint32_t kEventAnnotations = 4;
+
+class PerfettoExporterTest : public ::testing::Test {
+ protected:
+  PerfettoExporterTest()
+      : detokenizer_(tokenizer::TokenDatabase::Create<kDatabase>()) {}
+
+  static std::vector<std::byte> Entry(uint32_t token,
+                                      uint64_t delta,
+                                      std::initializer_list<uint8_t> rest = {}) {
+    std::vector<std::byte> entry(sizeof(token));
+    std::memcpy(entry.data(), &token, sizeof(token));
+    std::array<std::byte, varint::kMaxVarint64SizeBytes> varint;
+    const size_t size = varint::Encode(delta, varint);
+    entry.insert(entry.end(), varint.begin(), varint.begin() + size);
+    for (uint8_t b : rest) {
+      entry.push_back(std::byte(b));
+    }
+    return entry;
+  }
+
+  Status Export(const PerfettoExporter::Options& options,
+                std::initializer_list<std::vector<std::byte>> entries) {
+    PerfettoExporter exporter(detokenizer_, output_, options);
+    Status status;
+    for (const std::vector<std::byte>& entry : entries) {
+      Status entry_status = exporter.ExportEntry(entry);
+      if (status.ok()) {
+        status = entry_status;
+      }
+    }
+    exported_ = exporter.exported_events();
+    skipped_ = exporter.skipped_events();
+    return status;
+  }
+
+  Status Export(std::initializer_list<std::vector<std::byte>> entries) {
+    return Export(PerfettoExporter::Options(), entries);
+  }
+
+  std::vector<Message> Packets() {
+    output_string_ = output_.str();
+    return Message(std::as_bytes(std::span(output_string_))).All(kPacket);
+  }
+
+  std::vector<Message> Events() {
+    std::vector<Message> events;
+    for (Message& packet : Packets()) {
+      if (packet.Has(kTrackEvent)) {
+        events.push_back(packet);
+      }
+    }
+    return events;
+  }
+
+  std::vector<Message> Tracks() {
+    std::vector<Message> tracks;
+    for (Message& packet : Packets()) {
+      if (packet.Has(kTrackDescriptor)) {
+        tracks.push_back(packet.Sub(kTrackDescriptor));
+      }
+    }
+    return tracks;
+  }
+
+  tokenizer::Detokenizer detokenizer_;
+  std::ostringstream output_;
+  std::string output_string_;
+  size_t exported_ = 0;
+  size_t skipped_ = 0;
+};
+
+TEST_F(PerfettoExporterTest, Instant_WritesProcessTrackAndInternedName) {
+  ASSERT_EQ(OkStatus(), Export({Entry(kInstant, 5), Entry(kInstant, 7)}));
+  EXPECT_EQ(exported_, 2u);
+
+  const std::vector<Message> packets = Packets();
+  ASSERT_EQ(packets.size(), 3u);
+
+  // The first packet clears the incremental state.
+  EXPECT_EQ(packets[0].Int(kSequenceFlags), 1u);
+  const Message track = packets[0].Sub(kTrackDescriptor);
+  EXPECT_EQ(track.Sub(3).String(6), "radio");
+
+  // The first event interns its name; the second refers to it.
+  const Message interned = packets[1].Sub(kInternedData).Sub(2);
+  EXPECT_EQ(interned.String(2), "rx");
+  EXPECT_FALSE(packets[2].Has(kInternedData));
+
+  for (size_t i = 1; i < 3; ++i) {
+    const Message event = packets[i].Sub(kTrackEvent);
+    EXPECT_EQ(packets[i].Int(kSequenceFlags), 2u);
+    EXPECT_EQ(event.Int(kEventType), 3u);  // Instant
+    EXPECT_EQ(event.Int(kEventTrackUuid), track.Int(1));
+    EXPECT_EQ(event.Int(kEventNameIid), interned.Int(1));
+  }
+
+  // The default is 1000 ticks per second.
+  EXPECT_EQ(packets[1].Int(kTimestamp), 5'000'000u);
+  EXPECT_EQ(packets[2].Int(kTimestamp), 12'000'000u);
+}
+
+TEST_F(PerfettoExporterTest, Duration_WritesSliceOnLabelTrack) {
+  PerfettoExporter::Options options;
+  options.ticks_per_second = 1'000'000;
+  ASSERT_EQ(OkStatus(),
+            Export(options, {Entry(kDurationStart, 1), Entry(kDurationEnd, 2)}));
+
+  const std::vector<Message> tracks = Tracks();
+  ASSERT_EQ(tracks.size(), 2u);
+  EXPECT_EQ(tracks[1].String(2), "send");
+  EXPECT_EQ(tracks[1].Int(5), tracks[0].Int(1));  // Parent is the module.
+
+  const std::vector<Message> events = Events();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].Sub(kTrackEvent).Int(kEventType), 1u);  // Begin
+  EXPECT_EQ(events[1].Sub(kTrackEvent).Int(kEventType), 2u);  // End
+  EXPECT_EQ(events[0].Sub(kTrackEvent).Int(kEventTrackUuid), tracks[1].Int(1));
+  EXPECT_EQ(events[1].Sub(kTrackEvent).Int(kEventTrackUuid), tracks[1].Int(1));
+  EXPECT_FALSE(events[1].Sub(kTrackEvent).Has(kEventNameIid));
+  EXPECT_EQ(events[1].Int(kTimestamp), 3'000u);
+}
+
+TEST_F(PerfettoExporterTest, Async_WritesTrackPerTraceId) {
+  ASSERT_EQ(OkStatus(),
+            Export({Entry(kAsyncStart, 0, {1}),
+                    Entry(kAsyncStart, 0, {2}),
+                    Entry(kAsyncStart, 0, {1})}));
+
+  const std::vector<Message> events = Events();
+  ASSERT_EQ(events.size(), 3u);
+  const uint64_t track_1 = events[0].Sub(kTrackEvent).Int(kEventTrackUuid);
+  const uint64_t track_2 = events[1].Sub(kTrackEvent).Int(kEventTrackUuid);
+  EXPECT_NE(track_1, track_2);
+  EXPECT_EQ(events[2].Sub(kTrackEvent).Int(kEventTrackUuid), track_1);
+
+  const Message id = events[1].Sub(kTrackEvent).Sub(kEventAnnotations);
+  EXPECT_EQ(id.String(10), "id");
+  EXPECT_EQ(id.Int(3), 2u);
+}
+
+TEST_F(PerfettoExporterTest, Counter_WritesCounterTrackValue) {
+  ASSERT_EQ(OkStatus(), Export({Entry(kCounter, 0, {0x34, 0x12})}));
+
+  const std::vector<Message> tracks = Tracks();
+  ASSERT_EQ(tracks.size(), 2u);
+  EXPECT_EQ(tracks[1].String(2), "rssi");
+  EXPECT_TRUE(tracks[1].Has(8));  // Counter descriptor
+
+  const Message event = Events()[0].Sub(kTrackEvent);
+  EXPECT_EQ(event.Int(kEventType), 4u);  // Counter
+  EXPECT_EQ(event.Int(kEventCounterValue), 0x1234u);
+}
+
+TEST_F(PerfettoExporterTest, StructFormat_WritesAnnotations) {
+  ASSERT_EQ(OkStatus(), Export({Entry(kStruct, 0, {0x02, 0x01, 0xff})}));
+
+  const std::vector<Message> annotations =
+      Events()[0].Sub(kTrackEvent).All(kEventAnnotations);
+  ASSERT_EQ(annotations.size(), 2u);
+  EXPECT_EQ(annotations[0].String(10), "data_0");
+  EXPECT_EQ(annotations[0].Int(3), 0x0102u);
+  EXPECT_EQ(annotations[1].String(10), "data_1");
+  EXPECT_EQ(static_cast<int64_t>(annotations[1].Int(4)), -1);
+}
+
+TEST_F(PerfettoExporterTest, UnknownToken_SkippedButAdvancesTime) {
+  EXPECT_EQ(Status::NotFound(),
+            Export({Entry(kUnknown, 10), Entry(kInstant, 1)}));
+  EXPECT_EQ(exported_, 1u);
+  EXPECT_EQ(skipped_, 1u);
+  EXPECT_EQ(Events()[0].Int(kTimestamp), 11'000'000u);
+}
+
+TEST_F(PerfettoExporterTest, Compact_DecodesRecentTokens) {
+  PerfettoExporter::Options options;
+  options.compact = true;
+  const std::vector<std::byte> literal = {
+      std::byte{7 << 5 | 3}, std::byte{1}, std::byte{0}, std::byte{0},
+      std::byte{0}};
+  const std::vector<std::byte> recent = {std::byte{0 << 5 | 4}};
+  const std::vector<std::byte> varint_delta = {std::byte{0 << 5 | 31},
+                                               std::byte{100}};
+  // Index 1 refers to a token from before the capture started.
+  const std::vector<std::byte> unknown = {std::byte{1 << 5 | 2}};
+
+  EXPECT_EQ(Status::Unavailable(),
+            Export(options, {literal, recent, varint_delta, unknown}));
+  EXPECT_EQ(exported_, 3u);
+  EXPECT_EQ(skipped_, 1u);
+
+  const std::vector<Message> events = Events();
+  ASSERT_EQ(events.size(), 3u);
+  EXPECT_EQ(events[0].Int(kTimestamp), 3'000'000u);
+  EXPECT_EQ(events[1].Int(kTimestamp), 7'000'000u);
+  EXPECT_EQ(events[2].Int(kTimestamp), 107'000'000u);
+}
+
+TEST_F(PerfettoExporterTest, ExportCapture_StopsAtIncompleteEntry) {
+  std::vector<std::byte> capture;
+  for (const std::vector<std::byte>& entry :
+       {Entry(kInstant, 1), Entry(kInstant, 2)}) {
+    capture.push_back(std::byte(entry.size()));
+    capture.insert(capture.end(), entry.begin(), entry.end());
+  }
+
+  PerfettoExporter exporter(detokenizer_, output_, {});
+  const size_t first_entry_size = 1 + Entry(kInstant, 1).size();
+  EXPECT_EQ(exporter.ExportCapture(std::span(capture).first(capture.size() - 1)),
+            first_entry_size);
+  EXPECT_EQ(exporter.exported_events(), 1u);
+
+  EXPECT_EQ(exporter.ExportCapture(std::span(capture).subspan(first_entry_size)),
+            capture.size() - first_entry_size);
+  EXPECT_EQ(exporter.exported_events(), 2u);
+}
+
+}  // namespace
+}  // namespace pw::trace
@@ -28,6 +28,29 @@
 #define PW_TRACE_QUEUE_SIZE_EVENTS 5
 #endif  // PW_TRACE_QUEUE_SIZE_EVENTS
 
+// PW_TRACE_LOCK_FREE_QUEUES records trace events into per-context EventQueues
+// (see pw_trace_tokenized/event_queue.h) instead of the locked queue above.
+// Producers do not take PW_TRACE_QUEUE_LOCK or PW_TRACE_TRY_LOCK, and events
+// are only processed when the system calls
+// TokenizedTraceImpl::ProcessEventQueues().
+#ifndef PW_TRACE_LOCK_FREE_QUEUES
+#define PW_TRACE_LOCK_FREE_QUEUES 0
+#endif  // PW_TRACE_LOCK_FREE_QUEUES
+
+// PW_TRACE_EVENT_QUEUE_SIZE_EVENTS configures the number of events each
+// EventQueue holds. It must be a power of two.
+#ifndef PW_TRACE_EVENT_QUEUE_SIZE_EVENTS
+#define PW_TRACE_EVENT_QUEUE_SIZE_EVENTS 32
+#endif  // PW_TRACE_EVENT_QUEUE_SIZE_EVENTS
+
+// PW_TRACE_COMPACT_ENCODING encodes each event's token and time delta in as
+// little as one byte, by referring to recently used tokens. See
+// pw::trace::internal::CompactHeaderEncoder for the format. Decode these traces
+// with the --compact option of pw_trace_tokenized.trace_tokenized.
+#ifndef PW_TRACE_COMPACT_ENCODING
+#define PW_TRACE_COMPACT_ENCODING 0
+#endif  // PW_TRACE_COMPACT_ENCODING
+
 // --- Config options for time source ----
 
 // PW_TRACE_TIME_TYPE sets the type for trace time.
@@ -84,6 +107,13 @@ static_assert(
 #define PW_TRACE_CONFIG_MAX_SINKS 2
 #endif  // PW_TRACE_CONFIG_MAX_SINKS
 
+// PW_TRACE_CONFIG_MAX_SAMPLING_RULES is the maximum number of trace tokens
+// which can have a sampling or rate limit rule at a time. See
+// pw::trace::TraceSampler.
+#ifndef PW_TRACE_CONFIG_MAX_SAMPLING_RULES
+#define PW_TRACE_CONFIG_MAX_SAMPLING_RULES 4
+#endif  // PW_TRACE_CONFIG_MAX_SAMPLING_RULES
+
 // --- Config options for locks ---
 
 // PW_TRACE_LOCK  Is is also called when registering and unregistering callbacks
@@ -0,0 +1,138 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+//==============================================================================
+//
+// This file provides lock-free, per-context trace event queues. When
+// PW_TRACE_LOCK_FREE_QUEUES is enabled, trace events are recorded into the
+// calling context's EventQueue, and a single consumer merges the queues by
+// timestamp with TokenizedTraceImpl::ProcessEventQueues().
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#include "pw_containers/spsc_queue.h"
+#include "pw_trace_tokenized/config.h"
+#include "pw_trace_tokenized/trace_tokenized.h"
+
+namespace pw {
+namespace trace {
+
+// A trace event and the time it was recorded.
+struct QueuedEvent {
+  QueuedEvent(uint32_t token,
+              EventType type,
+              const char* event_module,
+              uint32_t id,
+              uint8_t event_flags,
+              PW_TRACE_TIME_TYPE event_time,
+              const void* data,
+              size_t size)
+      : trace_token(token),
+        event_type(type),
+        module(event_module),
+        trace_id(id),
+        flags(event_flags),
+        time(event_time),
+        data_size(size) {
+    if (size > 0) {
+      std::memcpy(data_buffer, data, size);
+    }
+  }
+
+  uint32_t trace_token;
+  EventType event_type;
+  const char* module;
+  uint32_t trace_id;
+  uint8_t flags;
+  PW_TRACE_TIME_TYPE time;
+  size_t data_size;
+  std::byte data_buffer[PW_TRACE_BUFFER_MAX_DATA_SIZE_BYTES];
+};
+
+// A queue of trace events from one execution context. Recording an event is
+// wait-free: it copies the event into the queue without a lock or atomic
+// read-modify-write operations. If the queue is full, the event is dropped and
+// counted.
+//
+// Each queue has one producer and one consumer. Contexts that can preempt each
+// other, such as an interrupt and the thread it interrupts, or that run on
+// different cores, must use different queues.
+class EventQueue {
+ public:
+  constexpr EventQueue() : dropped_events_(0) {}
+
+  EventQueue(const EventQueue&) = delete;
+  EventQueue& operator=(const EventQueue&) = delete;
+
+  // Producer side. Records an event. Returns false if the queue is full or the
+  // data is larger than PW_TRACE_BUFFER_MAX_DATA_SIZE_BYTES, in which case the
+  // event is dropped.
+  bool TryPush(uint32_t trace_token,
+               EventType event_type,
+               const char* module,
+               uint32_t trace_id,
+               uint8_t flags,
+               PW_TRACE_TIME_TYPE time,
+               const void* data_buffer,
+               size_t data_size) {
+    if (data_size <= PW_TRACE_BUFFER_MAX_DATA_SIZE_BYTES &&
+        queue_.TryEmplace(trace_token,
+                          event_type,
+                          module,
+                          trace_id,
+                          flags,
+                          time,
+                          data_buffer,
+                          data_size)) {
+      return true;
+    }
+    // Only the producer writes the count, so no read-modify-write is needed.
+    dropped_events_.store(dropped_events_.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+    return false;
+  }
+
+  // The number of events dropped because the queue was full.
+  uint32_t dropped_events() const {
+    return dropped_events_.load(std::memory_order_relaxed);
+  }
+
+  // Consumer side. Returns the oldest event without removing it, or nullptr if
+  // the queue is empty.
+  const QueuedEvent* Peek() {
+    if (!next_.has_value()) {
+      next_ = queue_.TryPop();
+    }
+    return next_.has_value() ? &next_.value() : nullptr;
+  }
+
+  // Consumer side. Removes the event returned by Peek().
+  void Pop() { next_.reset(); }
+
+ private:
+  SpscQueue<QueuedEvent, PW_TRACE_EVENT_QUEUE_SIZE_EVENTS> queue_;
+  std::optional<QueuedEvent> next_;
+  std::atomic<uint32_t> dropped_events_;
+};
+
+// Returns the EventQueue for the calling execution context. This must be
+// implemented by the system when PW_TRACE_LOCK_FREE_QUEUES is enabled.
+EventQueue& GetEventQueue();
+
+}  // namespace trace
+}  // namespace pw
@@ -0,0 +1,165 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+//==============================================================================
+//
+// This file provides a host-side converter from tokenized trace captures to
+// the Perfetto trace format, which can be opened in ui.perfetto.dev.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "pw_bytes/span.h"
+#include "pw_protobuf/encoder.h"
+#include "pw_status/status.h"
+#include "pw_tokenizer/detokenize.h"
+
+namespace pw::trace {
+
+// Converts tokenized trace entries to Perfetto TracePackets and writes them to
+// an output stream as a Perfetto Trace message. Entries are converted one at a
+// time, so captures of any size can be converted in fixed memory apart from
+// per-token and per-track tables.
+//
+// Each token is detokenized and parsed once. Its event name is then interned,
+// so later events of the token only refer to it by ID.
+//
+// The events are mapped to Perfetto tracks like the JSON output of
+// pw_trace_tokenized.trace_tokenized:
+//
+//   - Each module is a process track.
+//   - Duration events are slices on a track named for the label, or for the
+//     group for group events.
+//   - Instant events are on the module's track, or on the group's track for
+//     group events.
+//   - Async events are slices on a track for each group and trace ID.
+//   - @pw_arg_counter events are values on a counter track for the label.
+class PerfettoExporter {
+ public:
+  struct Options {
+    // The trace time ticks per second of the device.
+    uint64_t ticks_per_second = 1000;
+
+    // True if the trace was encoded with PW_TRACE_COMPACT_ENCODING.
+    bool compact = false;
+  };
+
+  PerfettoExporter(const tokenizer::Detokenizer& detokenizer,
+                   std::ostream& output,
+                   const Options& options);
+
+  PerfettoExporter(const PerfettoExporter&) = delete;
+  PerfettoExporter& operator=(const PerfettoExporter&) = delete;
+
+  // Converts the entries in a capture. Each entry is preceded by its size as
+  // one byte, as written by trace_to_file.h and get_trace.py. A capture may be
+  // passed in pieces; returns the number of bytes used, which excludes an
+  // incomplete entry at the end. Pass the remaining bytes again with the next
+  // piece.
+  size_t ExportCapture(ConstByteSpan data);
+
+  // Converts one trace entry, without its size. Returns DATA_LOSS if the entry
+  // is malformed, NOT_FOUND if its token is not in the database, or
+  // UNAVAILABLE if it is a compact entry whose token was recorded before the
+  // start of the capture. Skipped entries still advance the trace time.
+  Status ExportEntry(ConstByteSpan entry);
+
+  size_t exported_events() const { return exported_events_; }
+  size_t skipped_events() const { return skipped_events_; }
+
+ private:
+  enum class EventType : uint8_t {
+    kInvalid,
+    kInstant,
+    kInstantGroup,
+    kAsyncStart,
+    kAsyncStep,
+    kAsyncEnd,
+    kDurationStart,
+    kDurationEnd,
+    kDurationGroupStart,
+    kDurationGroupEnd,
+  };
+
+  // The fields of a token's string, "event_type|flags|module|group|label",
+  // optionally followed by "|data_format".
+  struct TokenInfo {
+    bool found = false;
+    EventType type = EventType::kInvalid;
+    std::string module;
+    std::string group;
+    std::string label;
+    std::optional<std::string> data_format;
+    uint64_t name_iid = 0;    // Interned name ID, or 0 if not yet written.
+    uint64_t track_uuid = 0;  // The token's track, if it does not vary.
+  };
+
+  // Mirrors the encoder's list of recently used tokens for compact traces. It
+  // starts out unknown, so decoding can start at any entry.
+  class RecentTokens {
+   public:
+    void Add(uint32_t token);
+    std::optional<uint32_t> Use(size_t index);
+
+   private:
+    static constexpr size_t kSize = 7;
+    std::array<std::optional<uint32_t>, kSize> tokens_{};
+  };
+
+  TokenInfo& LookUp(uint32_t token);
+
+  Status WriteEvent(TokenInfo& info,
+                    uint32_t trace_id,
+                    ConstByteSpan data,
+                    uint64_t timestamp_ns);
+
+  // Returns the UUID of a track, writing its descriptor if it is new.
+  uint64_t ProcessTrack(const std::string& module);
+  uint64_t ChildTrack(const std::string& module,
+                      std::string_view name,
+                      std::optional<uint32_t> trace_id,
+                      bool counter);
+
+  void StartPacket(uint32_t sequence_flags);
+  Status FinishPacket();
+
+  uint64_t TimestampNs() const;
+
+  const tokenizer::Detokenizer& detokenizer_;
+  std::ostream& output_;
+  const Options options_;
+
+  std::unordered_map<uint32_t, TokenInfo> tokens_;
+  std::unordered_map<std::string, uint64_t> tracks_;
+  RecentTokens recent_tokens_;
+  uint64_t next_name_iid_ = 1;
+  int32_t next_pid_ = 1;
+  bool first_packet_ = true;
+
+  uint64_t time_ticks_ = 0;
+  size_t exported_events_ = 0;
+  size_t skipped_events_ = 0;
+
+  std::array<std::byte, 1024> packet_buffer_{};
+  protobuf::NestedEncoder<4, 16> packet_;
+};
+
+}  // namespace pw::trace
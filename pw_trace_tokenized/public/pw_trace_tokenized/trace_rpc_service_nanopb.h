@@ -13,6 +13,8 @@
 // the License.
 #pragma once
 
+#include "pw_ring_buffer/prefixed_entry_ring_buffer.h"
+#include "pw_status/status.h"
 #include "pw_trace_protos/trace_rpc.rpc.pb.h"
 
 namespace pw::trace {
@@ -30,6 +32,40 @@ class TraceService final : public generated::TraceService<TraceService> {
   void GetTraceData(ServerContext&,
                     const pw_trace_Empty& request,
                     ServerWriter<pw_trace_TraceDataMessage>& writer);
+
+  // Opens a stream of the entries added to the trace buffer from now on. Only
+  // one stream may be open at a time. The entries are sent by Flush().
+  void StreamTraceData(ServerContext&,
+                       const pw_trace_Empty& request,
+                       ServerWriter<pw_trace_TraceDataBatch>& writer);
+
+  // Sends the entries added to the trace buffer since the last flush to the
+  // open StreamTraceData call, packing as many entries as fit into each
+  // batch. Call this periodically while tracing runs, often enough that the
+  // trace buffer does not wrap between calls; entries overwritten before they
+  // are flushed are lost.
+  //
+  // Returns FAILED_PRECONDITION if no stream is open, or the error from
+  // writing a batch.
+  Status Flush();
+
+  // Sets the sampling and rate limit rule for a trace token. A rule with
+  // neither removes the token's rule. Returns RESOURCE_EXHAUSTED if too many
+  // tokens have rules.
+  pw::Status SetSamplingRule(ServerContext&,
+                             const pw_trace_SamplingRule& request,
+                             pw_trace_Empty& response);
+
+  pw::Status ClearSamplingRules(ServerContext&,
+                                const pw_trace_Empty& request,
+                                pw_trace_Empty& response);
+
+ private:
+  void DetachStreamReader();
+
+  ServerWriter<pw_trace_TraceDataBatch> stream_writer_;
+  ring_buffer::PrefixedEntryRingBufferMulti::Reader stream_reader_;
+  bool stream_reader_attached_ = false;
 };
 
 }  // namespace pw::trace
@@ -0,0 +1,105 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+//==============================================================================
+//
+// This file provides per-token sampling and rate limiting for the tokenized
+// trace backend.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "pw_status/status.h"
+#include "pw_trace_tokenized/config.h"
+
+namespace pw {
+namespace trace {
+
+// Decides which events of a trace token are recorded, so that a few hot events
+// cannot fill the trace buffer. Each rule applies to one token and may:
+//
+//   - sample the token, recording only every Nth event, and/or
+//   - rate limit the token with a token bucket, recording at most
+//     max_events_per_second events on average, and up to burst events at once.
+//
+// Sampling is applied first, so the rate limit counts only sampled events.
+// Tokens without a rule are always recorded. Checking an event is a single
+// branch when no rules are set, and a scan of the rules otherwise.
+//
+// The tokenized trace backend checks each event after the event callbacks and
+// before encoding it, while holding the trace lock. The rule setters take
+// PW_TRACE_LOCK.
+class TraceSampler {
+ public:
+  struct Rule {
+    // Records one of every sample_every events. 0 and 1 record every event.
+    uint32_t sample_every = 1;
+
+    // The average number of events recorded per second. 0 disables the rate
+    // limit.
+    uint32_t max_events_per_second = 0;
+
+    // The number of events that may be recorded at once after the token has
+    // been idle. Treated as 1 if 0.
+    uint32_t burst = 1;
+  };
+
+  constexpr TraceSampler() = default;
+
+  // Sets the rule for a token, replacing any existing rule. A rule that
+  // neither samples nor rate limits removes the token's rule.
+  //
+  // Returns RESOURCE_EXHAUSTED if PW_TRACE_CONFIG_MAX_SAMPLING_RULES tokens
+  // already have rules.
+  Status SetRule(uint32_t trace_token, const Rule& rule);
+
+  void ClearRule(uint32_t trace_token);
+  void ClearAllRules();
+
+  // Returns true if an event for the token at trace_time should be recorded,
+  // and updates the token's sampling and rate limit state.
+  bool ShouldRecord(uint32_t trace_token, PW_TRACE_TIME_TYPE trace_time) {
+    return rule_count_ == 0 || CheckRules(trace_token, trace_time);
+  }
+
+  // The number of events not recorded because of a rule.
+  size_t skipped_events() const { return skipped_events_; }
+
+ private:
+  struct Entry {
+    bool in_use = false;
+    bool started = false;
+    uint32_t trace_token = 0;
+    Rule rule;
+    uint32_t sample_count = 0;
+
+    // The bucket level, in units of 1/ticks_per_second events, and the time it
+    // was last refilled.
+    uint64_t bucket = 0;
+    PW_TRACE_TIME_TYPE last_time = 0;
+  };
+
+  bool CheckRules(uint32_t trace_token, PW_TRACE_TIME_TYPE trace_time);
+  static bool TakeFromBucket(Entry& entry, PW_TRACE_TIME_TYPE trace_time);
+
+  std::array<Entry, PW_TRACE_CONFIG_MAX_SAMPLING_RULES> entries_;
+  size_t rule_count_ = 0;
+  size_t skipped_events_ = 0;
+};
+
+}  // namespace trace
+}  // namespace pw
@@ -34,11 +34,18 @@
 #include "pw_trace_tokenized/internal/trace_tokenized_internal.h"
 
 #ifdef __cplusplus
+#include <array>
+#include <span>
+
+#include "pw_trace_tokenized/trace_sampler.h"
+
 namespace pw {
 namespace trace {
 
 using EventType = pw_trace_EventType;
 
+class EventQueue;
+
 namespace internal {
 
 // Simple ring buffer which is suitable for use in a critical section.
@@ -111,6 +118,35 @@ class TraceQueue {
       true;  // Used to distinquish if head==tail is empty or full
 };
 
+// Encodes the token and time delta of a trace event for
+// PW_TRACE_COMPACT_ENCODING. The first byte holds:
+//
+//   bits 7-5: The token's index in a move-to-front list of the 7 most recently
+//             encoded tokens, or 7 if the 4-byte token follows.
+//   bits 4-0: The time delta, or 31 if the delta follows as a varint.
+//
+// An event with a recent token and a small delta takes one byte instead of
+// five or more. A decoder starts with seven unknown tokens and mirrors the
+// list, so it can start at any event, such as the oldest one left in a ring
+// buffer. It skips the few events whose tokens it has not seen yet.
+class CompactHeaderEncoder {
+ public:
+  // Encodes the token and time delta into the buffer, which must hold at least
+  // 15 bytes. Returns the number of bytes written.
+  size_t Encode(uint32_t trace_token,
+                uint64_t time_delta,
+                std::span<std::byte> buffer);
+
+ private:
+  static constexpr size_t kRecentTokens = 7;
+  static constexpr uint8_t kLiteralToken = 7;
+  static constexpr uint8_t kVarintDelta = 31;
+  static constexpr int kTokenShift = 5;
+
+  std::array<uint32_t, kRecentTokens> recent_tokens_ = {};
+  size_t recent_count_ = 0;
+};
+
 }  // namespace internal
 
 class TokenizedTraceImpl {
@@ -131,14 +167,41 @@ class TokenizedTraceImpl {
                         const void* data_buffer,
                         size_t data_size);
 
+  // Processes the events in the given EventQueues in timestamp order, until
+  // all of them are empty. Returns the number of events processed. Only one
+  // context may process a set of queues at a time.
+  size_t ProcessEventQueues(std::span<EventQueue* const> queues);
+
+  // The per-token sampling and rate limit rules, which are checked before
+  // events are encoded.
+  TraceSampler& sampler() { return sampler_; }
+
+  // The number of events dropped because the queue was full. With
+  // PW_TRACE_LOCK_FREE_QUEUES, drops are counted by each EventQueue instead.
+  uint32_t dropped_events() const { return dropped_events_; }
+
  private:
   using TraceQueue = internal::TraceQueue<PW_TRACE_QUEUE_SIZE_EVENTS>;
   PW_TRACE_TIME_TYPE last_trace_time_ = 0;
   bool enabled_ = false;
+  uint32_t dropped_events_ = 0;
   TraceQueue event_queue_;
+  TraceSampler sampler_;
+#if PW_TRACE_COMPACT_ENCODING
+  internal::CompactHeaderEncoder compact_encoder_;
+#endif  // PW_TRACE_COMPACT_ENCODING
 
   void HandleNextItemInQueue(
       const volatile TraceQueue::QueueEventBlock* event_block);
+
+  void ProcessEvent(uint32_t trace_token,
+                    EventType event_type,
+                    const char* module,
+                    uint32_t trace_id,
+                    uint8_t flags,
+                    PW_TRACE_TIME_TYPE trace_time,
+                    const std::byte* data_buffer,
+                    size_t data_size);
 };
 
 // A singleton object of the TokenizedTraceImpl class which can be used to
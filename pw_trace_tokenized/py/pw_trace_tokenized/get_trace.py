@@ -21,6 +21,9 @@ python pw_trace_tokenized/py/pw_trace_tokenized/get_trace.py -s localhost:33000
   -o trace.json
   -t out/host_clang_debug/obj/pw_trace_tokenized/bin/trace_tokenized_example_rpc
   pw_trace_tokenized/pw_trace_protos/trace_rpc.proto
+
+With --stream, the trace is streamed while it is recorded until interrupted
+with Ctrl-C, rather than read from the device's trace buffer afterwards.
 """
 import argparse
 import logging
@@ -98,6 +101,21 @@ def get_trace_data_from_device(client):
     return data
 
 
+def stream_trace_data_from_device(client):
+    """Streams trace data using RPC from a Client until interrupted."""
+    data = b''
+    responses = client.client.channel(
+        1).rpcs.pw.trace.TraceService.StreamTraceData(pw_rpc_timeout_s=None)
+    try:
+        for batch in responses:
+            # Each batch holds entries that are already prefixed by their size.
+            data = data + batch.data
+            _LOG.debug(''.join(format(x, '02x') for x in batch.data))
+    except KeyboardInterrupt:
+        _LOG.info('Stopped streaming the trace')
+    return data
+
+
 def _parse_args():
     """Parse and return command line arguments."""
 
@@ -124,6 +142,14 @@ def _parse_args():
         '-t',
         '--trace_token_database',
         help='Databases (ELF, binary, or CSV) to use to lookup trace tokens.')
+    parser.add_argument(
+        '--stream',
+        action='store_true',
+        help='Stream the trace as it is recorded until interrupted.')
+    parser.add_argument(
+        '--compact',
+        action='store_true',
+        help='Decode traces encoded with PW_TRACE_COMPACT_ENCODING.')
     parser.add_argument('proto_globs',
                         nargs='+',
                         help='glob pattern for .proto files')
@@ -136,8 +162,12 @@ def _main(args):
         database.load_token_database(args.trace_token_database, domain="trace")
     _LOG.info(database.database_summary(token_database))
     client = get_hdlc_rpc_client(**vars(args))
-    data = get_trace_data_from_device(client)
-    events = trace_tokenized.get_trace_events([token_database], data)
+    if args.stream:
+        data = stream_trace_data_from_device(client)
+    else:
+        data = get_trace_data_from_device(client)
+    events = trace_tokenized.get_trace_events([token_database], data,
+                                              args.compact)
     json_lines = trace.generate_trace_json(events)
     trace_tokenized.save_trace_file(json_lines, args.trace_output_file)
 
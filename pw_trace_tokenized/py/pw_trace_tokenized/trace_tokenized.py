@@ -25,6 +25,7 @@ import argparse
 import logging
 import struct
 import sys
+from typing import List, Optional
 from pw_tokenizer import database, tokens
 from pw_trace import trace
 
@@ -106,25 +107,43 @@ def create_trace_event(token_string, timestamp_us, trace_id, data):
                             data=data if has_data(token_string) else b'')
 
 
-def parse_trace_event(buffer, db, last_time, ticks_per_second=1000):
-    """Parse a single trace event from bytes"""
-    us_per_tick = 1000000 / ticks_per_second
-    idx = 0
-    # Read token
-    token = struct.unpack('I', buffer[idx:idx + 4])[0]
-    idx += 4
+class RecentTokens:
+    """Mirrors the encoder's list of recent tokens for compact traces.
 
-    # Decode token
+    The list starts with unknown tokens, so decoding can start at any event.
+    """
+    SIZE = 7
+
+    def __init__(self) -> None:
+        self._tokens: List[Optional[int]] = [None] * self.SIZE
+
+    def add(self, token: int) -> None:
+        """Adds a new token to the front, dropping the least recent one."""
+        self._tokens.insert(0, token)
+        self._tokens.pop()
+
+    def use(self, index: int) -> Optional[int]:
+        """Moves a token to the front. Returns None if it is not known."""
+        token = self._tokens.pop(index)
+        self._tokens.insert(0, token)
+        return token
+
+
+# The first byte of a compact event holds the recent token index in bits 7-5
+# and the time delta in bits 4-0. These values mean that the token or varint
+# delta follows.
+_COMPACT_LITERAL_TOKEN = 7
+_COMPACT_VARINT_DELTA = 31
+
+
+def _decode_event(token, buffer, db, timestamp_us):
+    """Decodes the trace ID and data that follow an event's time delta."""
     if len(db.token_to_entries[token]) == 0:
         _LOG.error("token not found: %08x", token)
         return None
 
     token_string = str(db.token_to_entries[token][0])
-
-    # Read time
-    time_delta, time_bytes = varint_decode(buffer[idx:])
-    timestamp_us = last_time + us_per_tick * time_delta
-    idx += time_bytes
+    idx = 0
 
     # Trace ID
     trace_id = None
@@ -141,10 +160,72 @@ def parse_trace_event(buffer, db, last_time, ticks_per_second=1000):
     return create_trace_event(token_string, timestamp_us, trace_id, data)
 
 
-def get_trace_events(databases, raw_trace_data):
-    """Handles the decoding traces."""
+def parse_trace_event(buffer, db, last_time, ticks_per_second=1000):
+    """Parse a single trace event from bytes"""
+    us_per_tick = 1000000 / ticks_per_second
+    idx = 0
+    # Read token
+    token = struct.unpack('I', buffer[idx:idx + 4])[0]
+    idx += 4
+
+    # Decode token
+    if len(db.token_to_entries[token]) == 0:
+        _LOG.error("token not found: %08x", token)
+        return None
+
+    # Read time
+    time_delta, time_bytes = varint_decode(buffer[idx:])
+    timestamp_us = last_time + us_per_tick * time_delta
+    idx += time_bytes
+
+    return _decode_event(token, buffer[idx:], db, timestamp_us)
+
+
+def parse_compact_trace_event(buffer,
+                              db,
+                              last_time,
+                              recent_tokens,
+                              ticks_per_second=1000):
+    """Parse a single trace event encoded with PW_TRACE_COMPACT_ENCODING.
+
+    Returns the event, or None if it could not be decoded, and its timestamp.
+    The timestamp is returned even if the event refers to a token from before
+    the start of the trace, so later events keep the correct times.
+    """
+    us_per_tick = 1000000 / ticks_per_second
+    token_index = buffer[0] >> 5
+    time_delta = buffer[0] & 0x1f
+    idx = 1
+
+    # Read token
+    if token_index == _COMPACT_LITERAL_TOKEN:
+        token = struct.unpack('I', buffer[idx:idx + 4])[0]
+        idx += 4
+        recent_tokens.add(token)
+    else:
+        token = recent_tokens.use(token_index)
+
+    # Read time
+    if time_delta == _COMPACT_VARINT_DELTA:
+        time_delta, time_bytes = varint_decode(buffer[idx:])
+        idx += time_bytes
+    timestamp_us = last_time + us_per_tick * time_delta
+
+    if token is None:
+        _LOG.debug("skipping event with a token from before the trace start")
+        return None, timestamp_us
+
+    return _decode_event(token, buffer[idx:], db, timestamp_us), timestamp_us
+
+
+def get_trace_events(databases, raw_trace_data, compact=False):
+    """Handles the decoding traces.
+
+    Set compact to decode traces encoded with PW_TRACE_COMPACT_ENCODING.
+    """
 
     db = tokens.Database.merged(*databases)
+    recent_tokens = RecentTokens()
     last_timestamp = 0
     events = []
     idx = 0
@@ -156,10 +237,15 @@ def get_trace_events(databases, raw_trace_data):
             _LOG.error("incomplete file")
             break
 
-        event = parse_trace_event(raw_trace_data[idx + 1:idx + 1 + size], db,
-                                  last_timestamp)
+        block = raw_trace_data[idx + 1:idx + 1 + size]
+        if compact:
+            event, last_timestamp = parse_compact_trace_event(
+                block, db, last_timestamp, recent_tokens)
+        else:
+            event = parse_trace_event(block, db, last_timestamp)
+            if event:
+                last_timestamp = event.timestamp_us
         if event:
-            last_timestamp = event.timestamp_us
             events.append(event)
         idx = idx + size + 1
     return events
@@ -181,10 +267,10 @@ def save_trace_file(trace_lines, file_name):
         output_file.write("{}]")
 
 
-def get_trace_events_from_file(databases, input_file_name):
+def get_trace_events_from_file(databases, input_file_name, compact=False):
     """Get trace events from a file."""
     raw_trace_data = get_trace_data_from_file(input_file_name)
-    return get_trace_events(databases, raw_trace_data)
+    return get_trace_events(databases, raw_trace_data, compact)
 
 
 def _parse_args():
@@ -207,12 +293,17 @@ def _parse_args():
                         '--output',
                         dest='output_file',
                         help=('The json file to which to write the output.'))
+    parser.add_argument(
+        '--compact',
+        action='store_true',
+        help='Decode traces encoded with PW_TRACE_COMPACT_ENCODING.')
 
     return parser.parse_args()
 
 
 def _main(args):
-    events = get_trace_events_from_file(args.databases, args.input_file)
+    events = get_trace_events_from_file(args.databases, args.input_file,
+                                        args.compact)
     json_lines = trace.generate_trace_json(events)
     save_trace_file(json_lines, args.output_file)
 
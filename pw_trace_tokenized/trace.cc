@@ -16,14 +16,16 @@
 
 #include "pw_trace/trace.h"
 
+#include <cstring>
+
 #include "pw_preprocessor/util.h"
+#include "pw_trace_tokenized/event_queue.h"
 #include "pw_trace_tokenized/trace_callback.h"
 #include "pw_trace_tokenized/trace_tokenized.h"
 #include "pw_varint/varint.h"
 
 namespace pw {
 namespace trace {
-
 TokenizedTraceImpl TokenizedTrace::instance_;
 CallbacksImpl Callbacks::instance_;
 
@@ -40,6 +42,18 @@ void TokenizedTraceImpl::HandleTraceEvent(uint32_t trace_token,
     return;
   }
 
+#if PW_TRACE_LOCK_FREE_QUEUES
+  // Record the event in this context's queue. It is processed when the system
+  // calls ProcessEventQueues().
+  GetEventQueue().TryPush(trace_token,
+                          event_type,
+                          module,
+                          trace_id,
+                          flags,
+                          pw_trace_GetTraceTime(),
+                          data_buffer,
+                          data_size);
+#else
   // Create trace event
   PW_TRACE_QUEUE_LOCK();
   if (!event_queue_
@@ -54,6 +68,7 @@ void TokenizedTraceImpl::HandleTraceEvent(uint32_t trace_token,
     // Queue full dropping sample
     // TODO(rgoliver): Allow other strategies, for example: drop oldest, try
     // empty queue, or block.
+    dropped_events_ += 1;
   }
   PW_TRACE_QUEUE_UNLOCK();
 
@@ -66,6 +81,60 @@ void TokenizedTraceImpl::HandleTraceEvent(uint32_t trace_token,
     }
     PW_TRACE_UNLOCK();
   }
+#endif  // PW_TRACE_LOCK_FREE_QUEUES
+}
+
+size_t TokenizedTraceImpl::ProcessEventQueues(
+    std::span<EventQueue* const> queues) {
+  size_t processed = 0;
+
+  while (true) {
+    // Events are ordered by their age, which is exact across timer wraps as
+    // long as no event is a full wrap old. The time is read before peeking, so
+    // every queued event is older than it.
+    const PW_TRACE_TIME_TYPE now = pw_trace_GetTraceTime();
+
+    // Find the queue with the oldest event at its head.
+    EventQueue* oldest_queue = nullptr;
+    const QueuedEvent* oldest = nullptr;
+    PW_TRACE_TIME_TYPE oldest_age = 0;
+    for (EventQueue* queue : queues) {
+      const QueuedEvent* event = queue->Peek();
+      if (event == nullptr) {
+        continue;
+      }
+      const PW_TRACE_TIME_TYPE age = PW_TRACE_GET_TIME_DELTA(event->time, now);
+      if (oldest == nullptr || age > oldest_age) {
+        oldest_queue = queue;
+        oldest = event;
+        oldest_age = age;
+      }
+    }
+
+    if (oldest == nullptr) {
+      return processed;
+    }
+
+    // An event may be pushed after a newer event from another context was
+    // already processed. Report it at the time of the newer event rather than
+    // with a negative delta.
+    PW_TRACE_TIME_TYPE trace_time = oldest->time;
+    if (last_trace_time_ != 0 &&
+        oldest_age > PW_TRACE_GET_TIME_DELTA(last_trace_time_, now)) {
+      trace_time = last_trace_time_;
+    }
+
+    ProcessEvent(oldest->trace_token,
+                 oldest->event_type,
+                 oldest->module,
+                 oldest->trace_id,
+                 oldest->flags,
+                 trace_time,
+                 oldest->data_buffer,
+                 oldest->data_size);
+    oldest_queue->Pop();
+    processed += 1;
+  }
 }
 
 void TokenizedTraceImpl::HandleNextItemInQueue(
@@ -80,6 +149,24 @@ void TokenizedTraceImpl::HandleNextItemInQueue(
       const_cast<const std::byte*>(event_block->data_buffer);
   size_t data_size = event_block->data_size;
 
+  ProcessEvent(trace_token,
+               event_type,
+               module,
+               trace_id,
+               flags,
+               pw_trace_GetTraceTime(),
+               data_buffer,
+               data_size);
+}
+
+void TokenizedTraceImpl::ProcessEvent(uint32_t trace_token,
+                                      EventType event_type,
+                                      const char* module,
+                                      uint32_t trace_id,
+                                      uint8_t flags,
+                                      PW_TRACE_TIME_TYPE trace_time,
+                                      const std::byte* data_buffer,
+                                      size_t data_size) {
   // Call any event callback which is registered to receive every event.
   pw_trace_TraceEventReturnFlags ret_flags = 0;
   ret_flags |=
@@ -108,24 +195,38 @@ void TokenizedTraceImpl::HandleNextItemInQueue(
     return;
   }
 
+  // Drop events which are sampled out or over their rate limit before
+  // encoding them. A callback may still have asked to stop tracing.
+  if (!sampler_.ShouldRecord(trace_token, trace_time)) {
+    if (PW_TRACE_EVENT_RETURN_FLAGS_DISABLE_AFTER_PROCESSING & ret_flags) {
+      enabled_ = false;
+    }
+    return;
+  }
+
   // Create header to store trace info
   static constexpr size_t kMaxHeaderSize =
+      1 +                                                        // compact
       sizeof(trace_token) + pw::varint::kMaxVarint64SizeBytes +  // time
       pw::varint::kMaxVarint64SizeBytes;                         // trace_id
   std::byte header[kMaxHeaderSize];
-  memcpy(header, &trace_token, sizeof(trace_token));
-  size_t header_size = sizeof(trace_token);
 
   // Compute delta of time elapsed since last trace entry.
-  PW_TRACE_TIME_TYPE trace_time = pw_trace_GetTraceTime();
   PW_TRACE_TIME_TYPE delta =
       (last_trace_time_ == 0)
           ? 0
           : PW_TRACE_GET_TIME_DELTA(last_trace_time_, trace_time);
+  last_trace_time_ = trace_time;
+
+#if PW_TRACE_COMPACT_ENCODING
+  size_t header_size = compact_encoder_.Encode(trace_token, delta, header);
+#else
+  memcpy(header, &trace_token, sizeof(trace_token));
+  size_t header_size = sizeof(trace_token);
   header_size += pw::varint::Encode(
       delta,
       std::span<std::byte>(&header[header_size], kMaxHeaderSize - header_size));
-  last_trace_time_ = trace_time;
+#endif  // PW_TRACE_COMPACT_ENCODING
 
   // Calculate packet id if needed.
   if (PW_TRACE_HAS_TRACE_ID(event_type)) {
@@ -146,6 +247,49 @@ void TokenizedTraceImpl::HandleNextItemInQueue(
   }
 }
 
+namespace internal {
+
+size_t CompactHeaderEncoder::Encode(uint32_t trace_token,
+                                    uint64_t time_delta,
+                                    std::span<std::byte> buffer) {
+  // Find the token in the recent tokens and move it to the front. If it is
+  // not there, insert it at the front, dropping the least recent token.
+  size_t index = 0;
+  while (index < recent_count_ && recent_tokens_[index] != trace_token) {
+    index += 1;
+  }
+  const bool literal_token = index == recent_count_;
+  if (literal_token) {
+    if (recent_count_ < kRecentTokens) {
+      recent_count_ += 1;
+    }
+    index = recent_count_ - 1;
+  }
+  for (size_t i = index; i > 0; --i) {
+    recent_tokens_[i] = recent_tokens_[i - 1];
+  }
+  recent_tokens_[0] = trace_token;
+
+  const uint8_t token_bits =
+      literal_token ? kLiteralToken : static_cast<uint8_t>(index);
+  const uint8_t delta_bits = time_delta < kVarintDelta
+                                 ? static_cast<uint8_t>(time_delta)
+                                 : kVarintDelta;
+  buffer[0] = std::byte(token_bits << kTokenShift | delta_bits);
+  size_t size = 1;
+
+  if (literal_token) {
+    std::memcpy(&buffer[size], &trace_token, sizeof(trace_token));
+    size += sizeof(trace_token);
+  }
+  if (delta_bits == kVarintDelta) {
+    size += varint::Encode(time_delta, buffer.subspan(size));
+  }
+  return size;
+}
+
+}  // namespace internal
+
 pw_trace_TraceEventReturnFlags CallbacksImpl::CallEventCallbacks(
     CallOnEveryEvent called_on_every_event,
     uint32_t trace_ref,
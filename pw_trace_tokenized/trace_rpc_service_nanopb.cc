@@ -15,6 +15,8 @@
 
 #include "pw_trace_tokenized/trace_rpc_service_nanopb.h"
 
+#include <utility>
+
 #include "pw_log/log.h"
 #include "pw_preprocessor/util.h"
 #include "pw_trace_tokenized/trace_buffer.h"
@@ -37,6 +39,24 @@ pw::Status TraceService::IsEnabled(ServerContext&,
   return PW_STATUS_OK;
 }
 
+pw::Status TraceService::SetSamplingRule(ServerContext&,
+                                         const pw_trace_SamplingRule& request,
+                                         pw_trace_Empty&) {
+  TraceSampler::Rule rule;
+  rule.sample_every = request.sample_every;
+  rule.max_events_per_second = request.max_events_per_second;
+  rule.burst = request.burst;
+  return TokenizedTrace::Instance().sampler().SetRule(request.trace_token,
+                                                      rule);
+}
+
+pw::Status TraceService::ClearSamplingRules(ServerContext&,
+                                            const pw_trace_Empty&,
+                                            pw_trace_Empty&) {
+  TokenizedTrace::Instance().sampler().ClearAllRules();
+  return PW_STATUS_OK;
+}
+
 void TraceService::GetTraceData(
     ServerContext&,
     const pw_trace_Empty&,
@@ -60,4 +80,79 @@ void TraceService::GetTraceData(
   }
   writer.Finish();
 }
+
+void TraceService::StreamTraceData(
+    ServerContext&,
+    const pw_trace_Empty&,
+    ServerWriter<pw_trace_TraceDataBatch>& writer) {
+  if (stream_writer_.open()) {
+    writer.Finish(Status::ResourceExhausted());
+    return;
+  }
+
+  // The reader only sees entries added after it is attached. Any entries left
+  // from a previous stream are dropped.
+  DetachStreamReader();
+  PW_TRACE_LOCK();
+  stream_reader_attached_ = GetBuffer()->AttachReader(stream_reader_).ok();
+  PW_TRACE_UNLOCK();
+
+  if (!stream_reader_attached_) {
+    writer.Finish(Status::Internal());
+    return;
+  }
+  stream_writer_ = std::move(writer);
+}
+
+Status TraceService::Flush() {
+  if (!stream_writer_.open()) {
+    DetachStreamReader();
+    return Status::FailedPrecondition();
+  }
+
+  pw_trace_TraceDataBatch batch = pw_trace_TraceDataBatch_init_default;
+  static_assert(sizeof(batch.data.bytes) >
+                    PW_TRACE_BUFFER_MAX_BLOCK_SIZE_BYTES,
+                "A trace entry and its size must fit in a batch");
+
+  while (true) {
+    size_t bytes = 0;
+    size_t entries = 0;
+
+    // Entries are added to the buffer while the trace lock is held.
+    PW_TRACE_LOCK();
+    Status status = stream_reader_.PeekFrontMultiple(
+        std::as_writable_bytes(std::span(batch.data.bytes)), bytes, entries);
+    if (status.ok()) {
+      stream_reader_.PopFrontMultiple(entries);
+    }
+    PW_TRACE_UNLOCK();
+
+    if (status.IsOutOfRange()) {
+      return OkStatus();
+    }
+    if (!status.ok()) {
+      return status;
+    }
+
+    batch.data.size = bytes;
+    if (Status write_status = stream_writer_.Write(batch);
+        !write_status.ok()) {
+      PW_LOG_ERROR("Error streaming trace; the stream may be missing entries. "
+                   "Error: %s",
+                   write_status.str());
+      return write_status;
+    }
+  }
+}
+
+void TraceService::DetachStreamReader() {
+  if (stream_reader_attached_) {
+    PW_TRACE_LOCK();
+    GetBuffer()->DetachReader(stream_reader_);
+    PW_TRACE_UNLOCK();
+    stream_reader_attached_ = false;
+  }
+}
+
 }  // namespace pw::trace
\ No newline at end of file
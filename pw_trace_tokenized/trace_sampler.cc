@@ -0,0 +1,138 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+//==============================================================================
+//
+
+#include "pw_trace_tokenized/trace_sampler.h"
+
+#include <algorithm>
+
+namespace pw {
+namespace trace {
+
+Status TraceSampler::SetRule(uint32_t trace_token, const Rule& rule) {
+  if (rule.sample_every <= 1 && rule.max_events_per_second == 0) {
+    ClearRule(trace_token);
+    return OkStatus();
+  }
+
+  Status status = Status::ResourceExhausted();
+  PW_TRACE_LOCK();
+  Entry* entry = nullptr;
+  Entry* free_entry = nullptr;
+  for (Entry& current : entries_) {
+    if (current.in_use && current.trace_token == trace_token) {
+      entry = &current;
+      break;
+    }
+    if (!current.in_use && free_entry == nullptr) {
+      free_entry = &current;
+    }
+  }
+  if (entry == nullptr && free_entry != nullptr) {
+    entry = free_entry;
+    rule_count_ += 1;
+  }
+  if (entry != nullptr) {
+    *entry = Entry();
+    entry->in_use = true;
+    entry->trace_token = trace_token;
+    entry->rule = rule;
+    status = OkStatus();
+  }
+  PW_TRACE_UNLOCK();
+  return status;
+}
+
+void TraceSampler::ClearRule(uint32_t trace_token) {
+  PW_TRACE_LOCK();
+  for (Entry& entry : entries_) {
+    if (entry.in_use && entry.trace_token == trace_token) {
+      entry.in_use = false;
+      rule_count_ -= 1;
+      break;
+    }
+  }
+  PW_TRACE_UNLOCK();
+}
+
+void TraceSampler::ClearAllRules() {
+  PW_TRACE_LOCK();
+  for (Entry& entry : entries_) {
+    entry.in_use = false;
+  }
+  rule_count_ = 0;
+  PW_TRACE_UNLOCK();
+}
+
+bool TraceSampler::CheckRules(uint32_t trace_token,
+                              PW_TRACE_TIME_TYPE trace_time) {
+  for (Entry& entry : entries_) {
+    if (!entry.in_use || entry.trace_token != trace_token) {
+      continue;
+    }
+
+    // Record the first event, then every sample_every events after it.
+    if (entry.rule.sample_every > 1) {
+      const bool sampled = entry.sample_count == 0;
+      entry.sample_count += 1;
+      if (entry.sample_count == entry.rule.sample_every) {
+        entry.sample_count = 0;
+      }
+      if (!sampled) {
+        skipped_events_ += 1;
+        return false;
+      }
+    }
+
+    if (entry.rule.max_events_per_second != 0 &&
+        !TakeFromBucket(entry, trace_time)) {
+      skipped_events_ += 1;
+      return false;
+    }
+    return true;
+  }
+  return true;
+}
+
+bool TraceSampler::TakeFromBucket(Entry& entry, PW_TRACE_TIME_TYPE trace_time) {
+  // The bucket is measured in 1/ticks_per_second events, so it refills by
+  // max_events_per_second units per tick without dividing.
+  const uint64_t event_cost = PW_TRACE_GET_TIME_TICKS_PER_SECOND();
+  const uint64_t capacity =
+      event_cost * std::max<uint64_t>(entry.rule.burst, 1);
+
+  if (!entry.started) {
+    entry.started = true;
+    entry.bucket = capacity;
+  } else {
+    const uint64_t elapsed =
+        PW_TRACE_GET_TIME_DELTA(entry.last_time, trace_time);
+    const uint64_t rate = entry.rule.max_events_per_second;
+    const uint64_t room = capacity - entry.bucket;
+    // Compare before multiplying, since a long idle time could overflow.
+    entry.bucket =
+        elapsed > room / rate ? capacity : entry.bucket + elapsed * rate;
+  }
+  entry.last_time = trace_time;
+
+  if (entry.bucket < event_cost) {
+    return false;
+  }
+  entry.bucket -= event_cost;
+  return true;
+}
+
+}  // namespace trace
+}  // namespace pw
@@ -0,0 +1,209 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_trace_tokenized/trace_sampler.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "pw_trace_tokenized/trace_callback.h"
+#include "pw_trace_tokenized/trace_tokenized.h"
+
+namespace pw::trace {
+namespace {
+
+// The fake trace time has one tick per second.
+constexpr uint32_t kToken = 0x1234;
+constexpr uint32_t kOtherToken = 0x5678;
+
+TraceSampler::Rule SampleEvery(uint32_t sample_every) {
+  TraceSampler::Rule rule;
+  rule.sample_every = sample_every;
+  return rule;
+}
+
+TraceSampler::Rule RateLimit(uint32_t max_events_per_second, uint32_t burst) {
+  TraceSampler::Rule rule;
+  rule.max_events_per_second = max_events_per_second;
+  rule.burst = burst;
+  return rule;
+}
+
+TEST(TraceSampler, NoRules_RecordsEveryEvent) {
+  TraceSampler sampler;
+  for (PW_TRACE_TIME_TYPE time = 0; time < 10; ++time) {
+    EXPECT_TRUE(sampler.ShouldRecord(kToken, time));
+  }
+  EXPECT_EQ(sampler.skipped_events(), 0u);
+}
+
+TEST(TraceSampler, SampleEvery_RecordsOneInN) {
+  TraceSampler sampler;
+  ASSERT_EQ(OkStatus(), sampler.SetRule(kToken, SampleEvery(3)));
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+    EXPECT_FALSE(sampler.ShouldRecord(kToken, 0));
+    EXPECT_FALSE(sampler.ShouldRecord(kToken, 0));
+  }
+  EXPECT_EQ(sampler.skipped_events(), 6u);
+}
+
+TEST(TraceSampler, RateLimit_AllowsBurstThenRefills) {
+  TraceSampler sampler;
+  ASSERT_EQ(OkStatus(), sampler.SetRule(kToken, RateLimit(2, 3)));
+
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 100));
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 100));
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 100));
+  EXPECT_FALSE(sampler.ShouldRecord(kToken, 100));
+
+  // One second refills two events.
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 101));
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 101));
+  EXPECT_FALSE(sampler.ShouldRecord(kToken, 101));
+}
+
+TEST(TraceSampler, RateLimit_LongIdleRefillsOnlyBurst) {
+  TraceSampler sampler;
+  ASSERT_EQ(OkStatus(), sampler.SetRule(kToken, RateLimit(1000, 2)));
+
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+  EXPECT_FALSE(sampler.ShouldRecord(kToken, 0));
+
+  constexpr PW_TRACE_TIME_TYPE kLater = 0xfffffff0;
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, kLater));
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, kLater));
+  EXPECT_FALSE(sampler.ShouldRecord(kToken, kLater));
+}
+
+TEST(TraceSampler, SampleAndRateLimit_LimitsSampledEvents) {
+  TraceSampler sampler;
+  TraceSampler::Rule rule = RateLimit(1, 1);
+  rule.sample_every = 2;
+  ASSERT_EQ(OkStatus(), sampler.SetRule(kToken, rule));
+
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+  EXPECT_FALSE(sampler.ShouldRecord(kToken, 0));  // Sampled out
+  EXPECT_FALSE(sampler.ShouldRecord(kToken, 0));  // Rate limited
+  EXPECT_FALSE(sampler.ShouldRecord(kToken, 1));  // Sampled out
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 1));
+}
+
+TEST(TraceSampler, Rule_OnlyAppliesToItsToken) {
+  TraceSampler sampler;
+  ASSERT_EQ(OkStatus(), sampler.SetRule(kToken, SampleEvery(100)));
+
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+  EXPECT_FALSE(sampler.ShouldRecord(kToken, 0));
+  EXPECT_TRUE(sampler.ShouldRecord(kOtherToken, 0));
+  EXPECT_TRUE(sampler.ShouldRecord(kOtherToken, 0));
+}
+
+TEST(TraceSampler, SetRule_ReplacesExistingRule) {
+  TraceSampler sampler;
+  ASSERT_EQ(OkStatus(), sampler.SetRule(kToken, SampleEvery(100)));
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+  EXPECT_FALSE(sampler.ShouldRecord(kToken, 0));
+
+  ASSERT_EQ(OkStatus(), sampler.SetRule(kToken, SampleEvery(2)));
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+  EXPECT_FALSE(sampler.ShouldRecord(kToken, 0));
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+}
+
+TEST(TraceSampler, SetRule_NoLimit_ClearsRule) {
+  TraceSampler sampler;
+  ASSERT_EQ(OkStatus(), sampler.SetRule(kToken, SampleEvery(100)));
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+
+  ASSERT_EQ(OkStatus(), sampler.SetRule(kToken, TraceSampler::Rule()));
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+}
+
+TEST(TraceSampler, SetRule_Full_ReturnsResourceExhausted) {
+  TraceSampler sampler;
+  for (uint32_t token = 1; token <= PW_TRACE_CONFIG_MAX_SAMPLING_RULES;
+       ++token) {
+    ASSERT_EQ(OkStatus(), sampler.SetRule(token, SampleEvery(2)));
+  }
+  EXPECT_EQ(Status::ResourceExhausted(),
+            sampler.SetRule(kToken, SampleEvery(2)));
+  EXPECT_EQ(OkStatus(), sampler.SetRule(1, SampleEvery(3)));
+
+  sampler.ClearRule(1);
+  EXPECT_EQ(OkStatus(), sampler.SetRule(kToken, SampleEvery(2)));
+}
+
+TEST(TraceSampler, ClearAllRules_RecordsEveryEvent) {
+  TraceSampler sampler;
+  ASSERT_EQ(OkStatus(), sampler.SetRule(kToken, SampleEvery(100)));
+  ASSERT_EQ(OkStatus(), sampler.SetRule(kOtherToken, SampleEvery(100)));
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+  EXPECT_FALSE(sampler.ShouldRecord(kToken, 0));
+
+  sampler.ClearAllRules();
+  EXPECT_TRUE(sampler.ShouldRecord(kToken, 0));
+  EXPECT_TRUE(sampler.ShouldRecord(kOtherToken, 0));
+}
+
+// Counts the events sent to the sinks.
+class CountingSink {
+ public:
+  CountingSink() {
+    TokenizedTrace::Instance().Enable(true);
+    Callbacks::Instance().RegisterSink(
+        nullptr, nullptr, EndBlock, this, &handle_);
+  }
+
+  ~CountingSink() {
+    Callbacks::Instance().UnregisterSink(handle_);
+    TokenizedTrace::Instance().Enable(false);
+    TokenizedTrace::Instance().sampler().ClearAllRules();
+  }
+
+  size_t events() const { return events_; }
+
+ private:
+  static void EndBlock(void* user_data) {
+    static_cast<CountingSink*>(user_data)->events_ += 1;
+  }
+
+  CallbacksImpl::SinkHandle handle_;
+  size_t events_ = 0;
+};
+
+void TraceInstant(uint32_t token) {
+  pw_trace_TraceEvent(
+      token, PW_TRACE_EVENT_TYPE_INSTANT, "module", 0, 0, nullptr, 0);
+}
+
+TEST(TraceSampler, TokenizedTrace_SkipsSampledOutEvents) {
+  CountingSink sink;
+  ASSERT_EQ(OkStatus(),
+            TokenizedTrace::Instance().sampler().SetRule(kToken,
+                                                         SampleEvery(4)));
+
+  for (int i = 0; i < 8; ++i) {
+    TraceInstant(kToken);
+    TraceInstant(kOtherToken);
+  }
+  EXPECT_EQ(sink.events(), 2u + 8u);
+}
+
+}  // namespace
+}  // namespace pw::trace
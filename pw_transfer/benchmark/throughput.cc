@@ -0,0 +1,397 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures transfer throughput over a simulated link, to pick the window and
+// chunk sizes for a deployment. The link models bandwidth, latency, loss, and
+// reordering in simulated time, so results are repeatable and do not depend on
+// the host. Each link runs reads and writes with every transfer configuration
+// in kTransferConfigs.
+//
+// Usage: throughput [bytes_per_second latency_ms loss_percent reorder_percent]
+//
+// With no arguments, the links in kLinks are simulated.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <utility>
+
+#include "pw_assert/check.h"
+#include "pw_log/log.h"
+#include "pw_random/xor_shift.h"
+#include "pw_rpc/client.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_rpc/server.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_transfer/client.h"
+#include "pw_transfer/internal/chunk.h"
+#include "pw_transfer/transfer.h"
+
+namespace {
+
+using pw::transfer::internal::Chunk;
+
+// Simulated time, in microseconds.
+using Micros = uint64_t;
+
+constexpr uint32_t kTransferId = 1;
+constexpr size_t kTransferSizeBytes = 32 * 1024;
+constexpr size_t kMaxPacketSizeBytes = 512;
+
+// Packets sent while this many are waiting for the link are dropped, as a UART
+// or radio driver with a full transmit queue would.
+constexpr size_t kLinkQueuePackets = 32;
+
+// Transfers that take longer than this are reported as stuck.
+constexpr Micros kTimeLimit = Micros{3600} * 1'000'000;
+
+struct LinkConfig {
+  const char* name;
+  uint32_t bytes_per_second;
+  uint32_t latency_ms;
+  double loss_percent;
+  double reorder_percent;
+};
+
+constexpr LinkConfig kLinks[] = {
+    {"UART 115200", 11'520, 2, 0, 0},
+    {"BLE, good signal", 40'000, 30, 0.5, 0},
+    {"BLE, poor signal", 20'000, 60, 5, 2},
+    {"Long range radio", 1'000, 400, 10, 5},
+};
+
+struct TransferConfig {
+  uint32_t max_pending_bytes;
+  uint32_t max_chunk_size_bytes;
+};
+
+constexpr TransferConfig kTransferConfigs[] = {
+    {256, 64},
+    {1024, 128},
+    {1024, 256},
+    {4096, 256},
+    {4096, 416},
+};
+
+// What one direction of the link carried.
+struct LinkStats {
+  size_t packets = 0;
+  size_t dropped = 0;
+  size_t data_bytes = 0;
+  size_t retransmit_requests = 0;
+};
+
+// One direction of a simulated link. Packets are serialized at the link's
+// bandwidth, then arrive after its latency. Lost packets still take up the
+// link, and reordered ones arrive up to one latency late, behind later packets.
+class SimulatedLink : public pw::rpc::ChannelOutput {
+ public:
+  SimulatedLink(const char* name,
+                const LinkConfig& config,
+                const Micros& now,
+                uint64_t seed)
+      : ChannelOutput(name), config_(config), now_(now), rng_(seed) {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  pw::Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override {
+    if (buffer.empty()) {
+      return pw::OkStatus();
+    }
+    Count(buffer);
+
+    if (std::count_if(packets_.begin(), packets_.end(), [this](auto& p) {
+          return p.size != 0 && p.sent_at > now_;
+        }) >= static_cast<ptrdiff_t>(kLinkQueuePackets)) {
+      stats_.dropped += 1;
+      return pw::OkStatus();
+    }
+
+    link_free_at_ = std::max(link_free_at_, now_) +
+                    buffer.size() * 1'000'000 / config_.bytes_per_second;
+    if (Chance(config_.loss_percent)) {
+      stats_.dropped += 1;
+      return pw::OkStatus();
+    }
+
+    Micros latency = Micros{config_.latency_ms} * 1000;
+    if (Chance(config_.reorder_percent)) {
+      latency += latency * Random() / UINT32_MAX;
+    }
+
+    auto free = std::find_if(packets_.begin(), packets_.end(), [](auto& p) {
+      return p.size == 0;
+    });
+    PW_CHECK(free != packets_.end(), "Too many packets in flight");
+    std::copy(buffer.begin(), buffer.end(), free->data.begin());
+    free->size = buffer.size();
+    free->sent_at = link_free_at_;
+    free->arrives_at = link_free_at_ + latency;
+    return pw::OkStatus();
+  }
+
+  // The time at which the next packet arrives, if any are in flight.
+  std::optional<Micros> next_arrival() const {
+    std::optional<Micros> next;
+    for (const Packet& packet : packets_) {
+      if (packet.size != 0 && (!next || packet.arrives_at < *next)) {
+        next = packet.arrives_at;
+      }
+    }
+    return next;
+  }
+
+  // Moves the next packet to arrive into the buffer.
+  pw::ConstByteSpan Receive(std::span<std::byte> buffer) {
+    Packet* next = nullptr;
+    for (Packet& packet : packets_) {
+      if (packet.size != 0 &&
+          (next == nullptr || packet.arrives_at < next->arrives_at)) {
+        next = &packet;
+      }
+    }
+    PW_CHECK_NOTNULL(next);
+    std::copy_n(next->data.begin(), next->size, buffer.begin());
+    return buffer.first(std::exchange(next->size, 0));
+  }
+
+  const LinkStats& stats() const { return stats_; }
+
+ private:
+  struct Packet {
+    std::array<std::byte, kMaxPacketSizeBytes> data;
+    size_t size = 0;
+    Micros sent_at = 0;
+    Micros arrives_at = 0;
+  };
+
+  uint32_t Random() {
+    uint32_t value;
+    rng_.GetInt(value);
+    return value;
+  }
+
+  bool Chance(double percent) {
+    return percent > 0 && Random() < percent / 100 * UINT32_MAX;
+  }
+
+  // Records the transfer chunk in the packet.
+  void Count(pw::ConstByteSpan buffer) {
+    stats_.packets += 1;
+
+    auto packet = pw::rpc::internal::Packet::FromBuffer(buffer);
+    Chunk chunk;
+    if (!packet.ok() ||
+        !pw::transfer::internal::DecodeChunk(packet.value().payload(), chunk)
+             .ok()) {
+      return;
+    }
+    stats_.data_bytes += chunk.data.size();
+    if (chunk.type == Chunk::Type::kParametersRetransmit) {
+      stats_.retransmit_requests += 1;
+    }
+  }
+
+  const LinkConfig config_;
+  const Micros& now_;
+  pw::random::XorShiftStarRng64 rng_;
+
+  std::array<std::byte, kMaxPacketSizeBytes> buffer_;
+  std::array<Packet, 2 * kLinkQueuePackets + 32> packets_;
+  Micros link_free_at_ = 0;
+  LinkStats stats_;
+};
+
+std::array<std::byte, kTransferSizeBytes> source_data;
+std::array<std::byte, kTransferSizeBytes> sink_data;
+
+// A transfer client and service connected by a simulated link.
+class Simulation {
+ public:
+  Simulation(const LinkConfig& link, const TransferConfig& transfer)
+      : client_link_("client", link, now_, 1),
+        server_link_("server", link, now_, 2),
+        client_channels_{pw::rpc::Channel::Create<1>(&client_link_)},
+        server_channels_{pw::rpc::Channel::Create<1>(&server_link_)},
+        rpc_client_(client_channels_),
+        rpc_server_(server_channels_),
+        service_(transfer.max_pending_bytes, transfer.max_chunk_size_bytes),
+        client_(client_channels_[0],
+                transfer.max_pending_bytes,
+                transfer.max_chunk_size_bytes),
+        source_(source_data),
+        sink_(sink_data),
+        handler_(kTransferId, source_, sink_) {
+    rpc_server_.RegisterService(service_);
+    service_.RegisterHandler(handler_);
+
+    // Retry after a couple of round trips and window transmissions, which
+    // is about the soonest a lost window can be noticed.
+    const Micros round_trip = Micros{link.latency_ms} * 2000;
+    const Micros window = Micros{transfer.max_pending_bytes} * 1'000'000 /
+                          link.bytes_per_second;
+    retry_interval_ = 2 * (round_trip + window);
+  }
+
+  // Runs a read or write to completion, and returns its status.
+  pw::Status Run(bool read) {
+    std::optional<pw::Status> result;
+    auto on_completion = [&result](pw::Status status) { result = status; };
+
+    pw::stream::MemoryReader input(source_data);
+    pw::stream::MemoryWriter output(sink_data);
+    const pw::Status start =
+        read ? client_.Read(kTransferId, output, on_completion)
+             : client_.Write(kTransferId, input, on_completion);
+    PW_CHECK_OK(start);
+
+    Micros next_retry = retry_interval_;
+    std::array<std::byte, kMaxPacketSizeBytes> packet;
+
+    while (!result.has_value() && now_ < kTimeLimit) {
+      const std::optional<Micros> to_server = client_link_.next_arrival();
+      const std::optional<Micros> to_client = server_link_.next_arrival();
+      now_ = std::min({next_retry,
+                       to_server.value_or(kTimeLimit),
+                       to_client.value_or(kTimeLimit)});
+
+      if (to_server == now_) {
+        rpc_server_.ProcessPacket(client_link_.Receive(packet), server_link_);
+      } else if (to_client == now_) {
+        rpc_client_.ProcessPacket(server_link_.Receive(packet));
+      } else if (next_retry == now_) {
+        client_.RetryStalledTransfers();
+        service_.RetryStalledTransfers();
+        next_retry += retry_interval_;
+      }
+    }
+    return result.value_or(pw::Status::DeadlineExceeded());
+  }
+
+  Micros now() const { return now_; }
+
+  // The link in the direction that data flows.
+  const LinkStats& data_stats(bool read) const {
+    return read ? server_link_.stats() : client_link_.stats();
+  }
+
+  // The link in the direction that transfer parameters flow.
+  const LinkStats& parameter_stats(bool read) const {
+    return read ? client_link_.stats() : server_link_.stats();
+  }
+
+ private:
+  Micros now_ = 0;
+  Micros retry_interval_;
+
+  SimulatedLink client_link_;
+  SimulatedLink server_link_;
+  std::array<pw::rpc::Channel, 1> client_channels_;
+  std::array<pw::rpc::Channel, 1> server_channels_;
+  pw::rpc::Client rpc_client_;
+  pw::rpc::Server rpc_server_;
+
+  pw::transfer::TransferService service_;
+  pw::transfer::Client client_;
+
+  pw::stream::MemoryReader source_;
+  pw::stream::MemoryWriter sink_;
+  pw::transfer::ReadWriteHandler handler_;
+};
+
+std::optional<Simulation> simulation;
+
+void MeasureLink(const LinkConfig& link) {
+  PW_LOG_INFO("%s: %u B/s, %u ms latency, %.1f%% loss, %.1f%% reordered",
+              link.name,
+              static_cast<unsigned>(link.bytes_per_second),
+              static_cast<unsigned>(link.latency_ms),
+              link.loss_percent,
+              link.reorder_percent);
+  PW_LOG_INFO(
+      "  dir   window  chunk  status             time ms      B/s  link %%  "
+      "lost  resent B  retransmits");
+
+  for (const TransferConfig& transfer : kTransferConfigs) {
+    for (bool read : {true, false}) {
+      simulation.emplace(link, transfer);
+      const pw::Status status = simulation->Run(read);
+
+      // Throughput is only meaningful for transfers that completed.
+      const double seconds = simulation->now() / 1e6;
+      const double throughput = status.ok() ? kTransferSizeBytes / seconds : 0;
+
+      const LinkStats& data = simulation->data_stats(read);
+      const LinkStats& parameters = simulation->parameter_stats(read);
+      const size_t resent_bytes =
+          data.data_bytes - std::min(data.data_bytes, kTransferSizeBytes);
+
+      // The first parameters of each transfer ask for its data from offset 0,
+      // and are not counted as retransmits.
+      const size_t retransmits =
+          std::max<size_t>(parameters.retransmit_requests, 1) - 1;
+
+      PW_LOG_INFO("  %-5s %6u  %5u  %-17s  %7.0f  %7.0f  %6.1f  %4u  %8u  %11u",
+                  read ? "read" : "write",
+                  static_cast<unsigned>(transfer.max_pending_bytes),
+                  static_cast<unsigned>(transfer.max_chunk_size_bytes),
+                  status.str(),
+                  seconds * 1000,
+                  throughput,
+                  100 * throughput / link.bytes_per_second,
+                  static_cast<unsigned>(data.dropped + parameters.dropped),
+                  static_cast<unsigned>(resent_bytes),
+                  static_cast<unsigned>(retransmits));
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  for (size_t i = 0; i < source_data.size(); ++i) {
+    source_data[i] = static_cast<std::byte>(i * 7 + 3);
+  }
+
+  if (argc == 5) {
+    const LinkConfig link = {
+        "Custom link",
+        static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)),
+        static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)),
+        std::strtod(argv[3], nullptr),
+        std::strtod(argv[4], nullptr),
+    };
+    PW_CHECK_UINT_GT(link.bytes_per_second, 0);
+    MeasureLink(link);
+    return 0;
+  }
+
+  if (argc != 1) {
+    PW_LOG_ERROR(
+        "Usage: %s [bytes_per_second latency_ms loss_percent "
+        "reorder_percent]",
+        argv[0]);
+    return 1;
+  }
+
+  PW_LOG_INFO("Transferring %u bytes in simulated time",
+              static_cast<unsigned>(kTransferSizeBytes));
+  for (const LinkConfig& link : kLinks) {
+    MeasureLink(link);
+  }
+  return 0;
+}
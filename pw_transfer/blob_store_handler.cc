@@ -0,0 +1,53 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_transfer/blob_store_handler.h"
+
+#include "pw_status/try.h"
+
+namespace pw::transfer {
+
+Status BlobStoreHandler::PrepareRead() {
+  PW_TRY(blob_reader_.Open());
+
+  // The reader stays open while the mapped blob is read, so that the blob is
+  // not rewritten under it.
+  if (Result<ConstByteSpan> blob = blob_reader_.GetMemoryMappedBlob();
+      blob.ok()) {
+    set_reader(mapped_reader_.emplace(blob.value()));
+  } else {
+    set_reader(blob_reader_);
+  }
+  return OkStatus();
+}
+
+void BlobStoreHandler::FinalizeRead(Status) {
+  blob_reader_.Close();
+  mapped_reader_.reset();
+  set_reader(blob_reader_);
+}
+
+Status BlobStoreHandler::PrepareWrite() { return blob_writer_.Open(); }
+
+Status BlobStoreHandler::FinalizeWrite(Status status) {
+  if (status.ok()) {
+    return blob_writer_.Close();
+  }
+
+  blob_writer_.Discard();
+  blob_writer_.Close();
+  return status;
+}
+
+}  // namespace pw::transfer
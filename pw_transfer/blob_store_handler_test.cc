@@ -0,0 +1,207 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_transfer/blob_store_handler.h"
+
+#include <array>
+#include <cstring>
+#include <optional>
+
+#include "gtest/gtest.h"
+#include "pw_blob_store/blob_store.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/test_key_value_store.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_transfer_private/test_loopback.h"
+
+namespace pw::transfer {
+namespace {
+
+constexpr uint32_t kTransferId = 5;
+constexpr size_t kSectorSize = 1024;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kFlashWriteSize = 16;
+
+// Fake flash that can be memory mapped, like the internal flash of most MCUs.
+class TestFlash : public kvs::FakeFlashMemoryBuffer<kSectorSize, kSectorCount> {
+ public:
+  TestFlash() : FakeFlashMemoryBuffer(kFlashWriteSize) {}
+
+  std::byte* FlashAddressToMcuAddress(Address address) const override {
+    return memory_mapped ? buffer().data() + address : nullptr;
+  }
+
+  bool memory_mapped = false;
+};
+
+template <size_t kSize>
+constexpr std::array<std::byte, kSize> MakeData() {
+  std::array<std::byte, kSize> data{};
+  for (size_t i = 0; i < kSize; ++i) {
+    data[i] = static_cast<std::byte>(i * 11 + 5);
+  }
+  return data;
+}
+
+// Not a multiple of the flash write size, so the last chunk is padded.
+constexpr auto kData = MakeData<1001>();
+
+class BlobStoreHandlerTest : public ::testing::Test {
+ protected:
+  BlobStoreHandlerTest()
+      : loopback_(256, 64),
+        partition_(&flash_),
+        blob_("TransferBlob",
+              partition_,
+              nullptr,
+              kvs::TestKvs(),
+              kFlashWriteSize),
+        handler_(kTransferId, blob_),
+        source_(kData),
+        sink_buffer_{},
+        sink_(sink_buffer_) {
+    loopback_.service().RegisterHandler(handler_);
+  }
+
+  void SetUp() override {
+    ASSERT_EQ(OkStatus(), partition_.Erase());
+    ASSERT_EQ(OkStatus(), blob_.Init());
+
+    // The KVS with the blob's metadata is shared by every test, so the blob
+    // from an earlier test is invalidated.
+    blob_store::BlobStore::BlobWriter writer(blob_);
+    ASSERT_EQ(OkStatus(), writer.Open());
+    ASSERT_EQ(OkStatus(), writer.Close());
+  }
+
+  void StoreBlob() {
+    blob_store::BlobStore::BlobWriter writer(blob_);
+    ASSERT_EQ(OkStatus(), writer.Open());
+    ASSERT_EQ(OkStatus(), writer.Write(kData));
+    ASSERT_EQ(OkStatus(), writer.Close());
+  }
+
+  bool BlobHasData() {
+    blob_store::BlobStore::BlobReader reader(blob_);
+    if (!reader.Open().ok()) {
+      return false;
+    }
+    std::array<std::byte, kData.size() + 1> buffer;
+    Result<ByteSpan> read = reader.Read(buffer);
+    return read.ok() && read.value().size() == kData.size() &&
+           std::memcmp(read.value().data(), kData.data(), kData.size()) == 0;
+  }
+
+  bool SinkHasData() const {
+    return sink_.bytes_written() == kData.size() &&
+           std::memcmp(sink_buffer_.data(), kData.data(), kData.size()) == 0;
+  }
+
+  void RunTransfers() {
+    loopback_.RunTransfers([this] { return result_.has_value(); });
+  }
+
+  Client::CompletionFunc RecordResult() {
+    return [this](Status status) { result_ = status; };
+  }
+
+  test::TransferLoopback loopback_;
+
+  TestFlash flash_;
+  kvs::FlashPartition partition_;
+  blob_store::BlobStoreBuffer<64> blob_;
+  BlobStoreHandler handler_;
+
+  stream::MemoryReader source_;
+  std::array<std::byte, 1024> sink_buffer_;
+  stream::MemoryWriter sink_;
+
+  std::optional<Status> result_;
+};
+
+TEST_F(BlobStoreHandlerTest, Write_StoresBlob) {
+  loopback_.client_output().set_drop_interval(7);
+
+  ASSERT_EQ(OkStatus(),
+            loopback_.client().Write(kTransferId, source_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  EXPECT_TRUE(BlobHasData());
+}
+
+TEST_F(BlobStoreHandlerTest, Write_Cancelled_DiscardsBlob) {
+  StoreBlob();
+
+  ASSERT_EQ(OkStatus(),
+            loopback_.client().Write(kTransferId, source_, RecordResult()));
+  loopback_.client().Cancel(kTransferId);
+  loopback_.RunUntilIdle();
+
+  EXPECT_EQ(result_, Status::Cancelled());
+  EXPECT_FALSE(BlobHasData());
+
+  // The writer was closed, so the blob can be written again.
+  result_.reset();
+  ASSERT_EQ(OkStatus(),
+            loopback_.client().Write(kTransferId, source_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  EXPECT_TRUE(BlobHasData());
+}
+
+TEST_F(BlobStoreHandlerTest, Read_FromFlash) {
+  StoreBlob();
+  loopback_.server_output().set_drop_interval(7);
+
+  ASSERT_EQ(OkStatus(),
+            loopback_.client().Read(kTransferId, sink_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  EXPECT_TRUE(SinkHasData());
+}
+
+TEST_F(BlobStoreHandlerTest, Read_MemoryMapped) {
+  flash_.memory_mapped = true;
+  StoreBlob();
+  loopback_.server_output().set_drop_interval(7);
+
+  ASSERT_EQ(OkStatus(),
+            loopback_.client().Read(kTransferId, sink_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  EXPECT_TRUE(SinkHasData());
+
+  // The read closed the blob, so it can be written again.
+  result_.reset();
+  ASSERT_EQ(OkStatus(),
+            loopback_.client().Write(kTransferId, source_, RecordResult()));
+  RunTransfers();
+  EXPECT_EQ(result_, OkStatus());
+}
+
+TEST_F(BlobStoreHandlerTest, Read_NoBlob_FailedPrecondition) {
+  ASSERT_EQ(OkStatus(),
+            loopback_.client().Read(kTransferId, sink_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, Status::FailedPrecondition());
+}
+
+}  // namespace
+}  // namespace pw::transfer
@@ -0,0 +1,181 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_transfer/internal/chunk.h"
+
+#include "pw_assert/assert.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/streaming_encoder.h"
+#include "pw_protobuf/wire_format.h"
+#include "pw_status/try.h"
+#include "pw_transfer/transfer.pwpb.h"
+#include "pw_varint/varint.h"
+
+namespace pw::transfer::internal {
+namespace {
+
+using ProtoChunk = transfer::Chunk::Fields;
+
+constexpr uint32_t Field(ProtoChunk field) {
+  return static_cast<uint32_t>(field);
+}
+
+constexpr std::byte kDataKey = static_cast<std::byte>(protobuf::MakeKey(
+    Field(ProtoChunk::DATA), protobuf::WireType::kDelimited));
+
+// Encodes the value as a varint that fills the output, padding it with
+// continuation bytes if needed. Protobuf decoders accept padded varints.
+void EncodePaddedVarint(size_t value, ByteSpan output) {
+  for (size_t i = 0; i + 1 < output.size(); ++i) {
+    output[i] = static_cast<std::byte>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  output.back() = static_cast<std::byte>(value);
+}
+
+Status ReadOptionalUint32(protobuf::Decoder& decoder,
+                          std::optional<uint32_t>& value) {
+  uint32_t read;
+  PW_TRY(decoder.ReadUint32(&read));
+  value = read;
+  return OkStatus();
+}
+
+// Encodes every field except data.
+Status EncodeFields(const Chunk& chunk, protobuf::StreamingEncoder& encoder) {
+  encoder.WriteUint32(Field(ProtoChunk::TRANSFER_ID), chunk.transfer_id);
+
+  if (chunk.pending_bytes.has_value()) {
+    encoder.WriteUint32(Field(ProtoChunk::PENDING_BYTES),
+                        chunk.pending_bytes.value());
+  }
+  if (chunk.max_chunk_size_bytes.has_value()) {
+    encoder.WriteUint32(Field(ProtoChunk::MAX_CHUNK_SIZE_BYTES),
+                        chunk.max_chunk_size_bytes.value());
+  }
+  if (chunk.min_delay_microseconds.has_value()) {
+    encoder.WriteUint32(Field(ProtoChunk::MIN_DELAY_MICROSECONDS),
+                        chunk.min_delay_microseconds.value());
+  }
+  if (chunk.offset != 0u) {
+    encoder.WriteUint64(Field(ProtoChunk::OFFSET), chunk.offset);
+  }
+  if (chunk.remaining_bytes.has_value()) {
+    encoder.WriteUint64(Field(ProtoChunk::REMAINING_BYTES),
+                        chunk.remaining_bytes.value());
+  }
+  if (chunk.status.has_value()) {
+    encoder.WriteUint32(Field(ProtoChunk::STATUS),
+                        chunk.status.value().code());
+  }
+  if (chunk.type != Chunk::Type::kTransferData) {
+    encoder.WriteUint32(Field(ProtoChunk::TYPE),
+                        static_cast<uint32_t>(chunk.type));
+  }
+  return encoder.status();
+}
+
+}  // namespace
+
+Status DecodeChunk(ConstByteSpan message, Chunk& chunk) {
+  chunk = Chunk();
+  protobuf::Decoder decoder(message);
+  Status status;
+
+  while ((status = decoder.Next()).ok()) {
+    switch (static_cast<ProtoChunk>(decoder.FieldNumber())) {
+      case ProtoChunk::TRANSFER_ID:
+        PW_TRY(decoder.ReadUint32(&chunk.transfer_id));
+        break;
+      case ProtoChunk::PENDING_BYTES:
+        PW_TRY(ReadOptionalUint32(decoder, chunk.pending_bytes));
+        break;
+      case ProtoChunk::MAX_CHUNK_SIZE_BYTES:
+        PW_TRY(ReadOptionalUint32(decoder, chunk.max_chunk_size_bytes));
+        break;
+      case ProtoChunk::MIN_DELAY_MICROSECONDS:
+        PW_TRY(ReadOptionalUint32(decoder, chunk.min_delay_microseconds));
+        break;
+      case ProtoChunk::OFFSET:
+        PW_TRY(decoder.ReadUint64(&chunk.offset));
+        break;
+      case ProtoChunk::DATA:
+        PW_TRY(decoder.ReadBytes(&chunk.data));
+        break;
+      case ProtoChunk::REMAINING_BYTES: {
+        uint64_t remaining_bytes;
+        PW_TRY(decoder.ReadUint64(&remaining_bytes));
+        chunk.remaining_bytes = remaining_bytes;
+        break;
+      }
+      case ProtoChunk::STATUS: {
+        uint32_t code;
+        PW_TRY(decoder.ReadUint32(&code));
+        chunk.status = static_cast<Status::Code>(code);
+        break;
+      }
+      case ProtoChunk::TYPE: {
+        uint32_t type;
+        PW_TRY(decoder.ReadUint32(&type));
+        chunk.type = static_cast<Chunk::Type>(type);
+        break;
+      }
+
+      // Skip unknown fields.
+      default:
+        break;
+    }
+  }
+
+  return status.IsOutOfRange() ? OkStatus() : Status::DataLoss();
+}
+
+Result<ConstByteSpan> EncodeChunk(const Chunk& chunk, ByteSpan buffer) {
+  protobuf::MemoryEncoder encoder(buffer);
+
+  if (!chunk.data.empty()) {
+    encoder.WriteBytes(Field(ProtoChunk::DATA), chunk.data);
+  }
+
+  PW_TRY(EncodeFields(chunk, encoder));
+  return ConstByteSpan(encoder.data(), encoder.size());
+}
+
+ByteSpan DataChunkPayload(ByteSpan buffer, size_t max_data_bytes) {
+  const size_t prefix_size = 1 + varint::EncodedSize(max_data_bytes);
+  PW_ASSERT(prefix_size + max_data_bytes <= buffer.size());
+  return buffer.subspan(prefix_size, max_data_bytes);
+}
+
+Result<ConstByteSpan> EncodeDataChunk(const Chunk& chunk,
+                                      ByteSpan buffer,
+                                      size_t max_data_bytes) {
+  const ByteSpan payload = DataChunkPayload(buffer, max_data_bytes);
+  PW_ASSERT(chunk.data.data() == payload.data());
+  PW_ASSERT(chunk.data.size() <= max_data_bytes);
+
+  // The size is padded to the size that was reserved for the largest data.
+  buffer[0] = kDataKey;
+  EncodePaddedVarint(chunk.data.size(),
+                     buffer.subspan(1, varint::EncodedSize(max_data_bytes)));
+
+  const size_t data_end =
+      static_cast<size_t>(payload.data() - buffer.data()) + chunk.data.size();
+  protobuf::MemoryEncoder encoder(buffer.subspan(data_end));
+  PW_TRY(EncodeFields(chunk, encoder));
+
+  return ConstByteSpan(buffer.data(), data_end + encoder.size());
+}
+
+}  // namespace pw::transfer::internal
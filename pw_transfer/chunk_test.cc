@@ -0,0 +1,111 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_transfer/internal/chunk.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+
+namespace pw::transfer::internal {
+namespace {
+
+TEST(Chunk, EncodeDecode_Parameters) {
+  Chunk chunk;
+  chunk.transfer_id = 7;
+  chunk.offset = 1024;
+  chunk.pending_bytes = 256;
+  chunk.max_chunk_size_bytes = 64;
+  chunk.type = Chunk::Type::kParametersContinue;
+
+  std::array<std::byte, 64> buffer;
+  Result<ConstByteSpan> encoded = EncodeChunk(chunk, buffer);
+  ASSERT_EQ(OkStatus(), encoded.status());
+
+  Chunk decoded;
+  ASSERT_EQ(OkStatus(), DecodeChunk(encoded.value(), decoded));
+  EXPECT_EQ(decoded.transfer_id, 7u);
+  EXPECT_EQ(decoded.offset, 1024u);
+  EXPECT_EQ(decoded.pending_bytes.value(), 256u);
+  EXPECT_EQ(decoded.max_chunk_size_bytes.value(), 64u);
+  EXPECT_FALSE(decoded.min_delay_microseconds.has_value());
+  EXPECT_FALSE(decoded.remaining_bytes.has_value());
+  EXPECT_FALSE(decoded.status.has_value());
+  EXPECT_EQ(decoded.type, Chunk::Type::kParametersContinue);
+  EXPECT_TRUE(decoded.data.empty());
+}
+
+TEST(Chunk, EncodeDecode_Status) {
+  Chunk chunk;
+  chunk.transfer_id = 3;
+  chunk.status = Status::DataLoss();
+
+  std::array<std::byte, 16> buffer;
+  Result<ConstByteSpan> encoded = EncodeChunk(chunk, buffer);
+  ASSERT_EQ(OkStatus(), encoded.status());
+
+  Chunk decoded;
+  ASSERT_EQ(OkStatus(), DecodeChunk(encoded.value(), decoded));
+  EXPECT_EQ(decoded.transfer_id, 3u);
+  EXPECT_EQ(decoded.status.value(), Status::DataLoss());
+  EXPECT_EQ(decoded.type, Chunk::Type::kTransferData);
+}
+
+TEST(Chunk, Encode_BufferTooSmall) {
+  Chunk chunk;
+  chunk.transfer_id = 3;
+  chunk.offset = 1u << 30;
+
+  std::array<std::byte, 4> buffer;
+  EXPECT_EQ(Status::ResourceExhausted(), EncodeChunk(chunk, buffer).status());
+}
+
+TEST(Chunk, EncodeDataChunk_InPlace) {
+  constexpr auto kData = bytes::Array<1, 2, 3, 4, 5>();
+
+  std::array<std::byte, 96> buffer;
+  ByteSpan payload = DataChunkPayload(buffer, 16);
+  ASSERT_GE(payload.size(), 16u);
+  std::memcpy(payload.data(), kData.data(), kData.size());
+
+  Chunk chunk;
+  chunk.transfer_id = 9;
+  chunk.offset = 40;
+  chunk.data = payload.first(kData.size());
+  chunk.remaining_bytes = 0;
+
+  Result<ConstByteSpan> encoded = EncodeDataChunk(chunk, buffer, 16);
+  ASSERT_EQ(OkStatus(), encoded.status());
+
+  Chunk decoded;
+  ASSERT_EQ(OkStatus(), DecodeChunk(encoded.value(), decoded));
+  EXPECT_EQ(decoded.transfer_id, 9u);
+  EXPECT_EQ(decoded.offset, 40u);
+  EXPECT_EQ(decoded.remaining_bytes.value(), 0u);
+  ASSERT_EQ(decoded.data.size(), kData.size());
+  EXPECT_EQ(std::memcmp(decoded.data.data(), kData.data(), kData.size()), 0);
+}
+
+TEST(Chunk, Decode_Malformed) {
+  // A length-delimited data field that runs past the end of the message.
+  constexpr auto kMalformed = bytes::Array<0x32, 0x10, 0x01>();
+
+  Chunk chunk;
+  EXPECT_EQ(Status::DataLoss(), DecodeChunk(kMalformed, chunk));
+}
+
+}  // namespace
+}  // namespace pw::transfer::internal
@@ -0,0 +1,320 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_transfer/client.h"
+
+#include <utility>
+
+#include "pw_log/log.h"
+#include "pw_rpc/internal/hash.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_status/try.h"
+#include "pw_transfer/internal/chunk.h"
+
+namespace pw::transfer {
+namespace {
+
+using internal::Chunk;
+
+constexpr uint32_t kServiceId = rpc::internal::Hash("pw.transfer.Transfer");
+constexpr uint32_t kReadMethodId = rpc::internal::Hash("Read");
+constexpr uint32_t kWriteMethodId = rpc::internal::Hash("Write");
+
+}  // namespace
+
+Client::ChunkStream::ChunkStream(Client& client, uint32_t method_id, bool reads)
+    : BaseClientCall(&client.channel_, kServiceId, method_id, &HandlePacket),
+      client_(&client),
+      reads_(reads),
+      reopen_(false) {}
+
+Status Client::ChunkStream::Open() {
+  if (!active()) {
+    return Status::Unavailable();
+  }
+  return ReleasePayloadBuffer(AcquirePayloadBuffer().first(0));
+}
+
+void Client::ChunkStream::ReopenIfLost() {
+  if (std::exchange(reopen_, false)) {
+    Open();
+  }
+}
+
+void Client::ChunkStream::HandlePacket(rpc::internal::BaseClientCall& call,
+                                       const rpc::internal::Packet& packet) {
+  ChunkStream& stream = static_cast<ChunkStream&>(call);
+
+  if (packet.type() == rpc::internal::PacketType::RESPONSE) {
+    stream.client_->HandleChunk(stream.reads_, packet.payload());
+    return;
+  }
+
+  // The server does not have the stream open, because the request that opened
+  // it was lost or the server restarted. The stream is opened again on the
+  // next retry, and its transfers recover from there.
+  if (packet.type() == rpc::internal::PacketType::SERVER_ERROR &&
+      packet.status().IsFailedPrecondition()) {
+    stream.reopen_ = true;
+    return;
+  }
+
+  // The server ended the stream. A stream end with OK still ends every
+  // transfer on it, so it is reported as UNAVAILABLE.
+  stream.Unregister();
+  stream.client_->HandleStreamError(
+      stream.reads_,
+      packet.status().ok() ? Status::Unavailable() : packet.status());
+}
+
+Status Client::Read(uint32_t transfer_id,
+                    stream::Writer& output,
+                    CompletionFunc&& on_completion) {
+  return ResumeRead(transfer_id, 0, output, std::move(on_completion));
+}
+
+Status Client::ResumeRead(uint32_t transfer_id,
+                          uint64_t offset,
+                          stream::Writer& output,
+                          CompletionFunc&& on_completion) {
+  Result<Transfer*> transfer = StartTransfer(transfer_id, true);
+  PW_TRY(transfer.status());
+
+  transfer.value()->on_completion = std::move(on_completion);
+  transfer.value()->receiver.Start(
+      transfer_id, output, max_pending_bytes_, max_chunk_size_bytes_, offset);
+  SendReadResponse(*transfer.value());
+  return OkStatus();
+}
+
+Status Client::Write(uint32_t transfer_id,
+                     stream::SeekableReader& input,
+                     CompletionFunc&& on_completion) {
+  return StartWrite(transfer_id, input, std::move(on_completion), false);
+}
+
+Status Client::ResumeWrite(uint32_t transfer_id,
+                           stream::SeekableReader& input,
+                           CompletionFunc&& on_completion) {
+  return StartWrite(transfer_id, input, std::move(on_completion), true);
+}
+
+void Client::Cancel(uint32_t transfer_id) {
+  for (Transfer& transfer : transfers_) {
+    if (transfer.active() && transfer.id() == transfer_id) {
+      SendStatus(transfer, Status::Cancelled());
+      Complete(transfer, Status::Cancelled());
+    }
+  }
+}
+
+void Client::RetryStalledTransfers() {
+  read_stream_.ReopenIfLost();
+  write_stream_.ReopenIfLost();
+
+  for (Transfer& transfer : transfers_) {
+    if (!transfer.active()) {
+      continue;
+    }
+
+    if (transfer.reads) {
+      // A read that stalled too many times sends its failure to the server.
+      Status status = transfer.receiver.RetryIfStalled();
+      SendReadResponse(transfer);
+      if (!status.ok()) {
+        Complete(transfer, status);
+      }
+    } else {
+      if (Status status = transfer.transmitter.RetryIfStalled(); !status.ok()) {
+        SendStatus(transfer, status);
+        Complete(transfer, status);
+      } else if (transfer.transmitter.awaiting_parameters()) {
+        SendWriteStart(transfer);
+      } else {
+        SendData(transfer);
+      }
+    }
+  }
+}
+
+Status Client::StartWrite(uint32_t transfer_id,
+                          stream::SeekableReader& input,
+                          CompletionFunc&& on_completion,
+                          bool resumes) {
+  Result<Transfer*> transfer = StartTransfer(transfer_id, false);
+  PW_TRY(transfer.status());
+
+  transfer.value()->resumes = resumes;
+  transfer.value()->on_completion = std::move(on_completion);
+  transfer.value()->transmitter.Start(transfer_id, input);
+  SendWriteStart(*transfer.value());
+  return OkStatus();
+}
+
+void Client::HandleChunk(bool reads, ConstByteSpan message) {
+  Chunk chunk;
+  if (!internal::DecodeChunk(message, chunk).ok()) {
+    PW_LOG_WARN("Discarding malformed transfer chunk");
+    return;
+  }
+
+  // Chunks for transfers that already ended, such as chunks that were in
+  // flight when a transfer was cancelled, are dropped.
+  Transfer* transfer = FindTransfer(chunk.transfer_id, reads);
+  if (transfer == nullptr) {
+    return;
+  }
+
+  // A status from the server ends the transfer: a read with an error, or a
+  // write successfully or not.
+  if (chunk.status.has_value()) {
+    Complete(*transfer, chunk.status.value());
+    return;
+  }
+
+  if (reads) {
+    transfer->receiver.HandleDataChunk(chunk);
+    SendReadResponse(*transfer);
+
+    if (transfer->receiver.completed()) {
+      Complete(*transfer, transfer->receiver.status());
+    }
+    return;
+  }
+
+  if (Status status = transfer->transmitter.HandleParameters(chunk);
+      !status.ok()) {
+    SendStatus(*transfer, status);
+    Complete(*transfer, status);
+    return;
+  }
+
+  SendData(*transfer);
+}
+
+void Client::HandleStreamError(bool reads, Status status) {
+  for (Transfer& transfer : transfers_) {
+    if (transfer.active() && transfer.reads == reads) {
+      Complete(transfer, status);
+    }
+  }
+}
+
+void Client::SendReadResponse(Transfer& transfer) {
+  internal::Receiver& receiver = transfer.receiver;
+  if (!receiver.response_pending()) {
+    return;
+  }
+
+  read_stream_.Send(
+      [&receiver](ByteSpan buffer) { return receiver.EncodeResponse(buffer); });
+}
+
+void Client::SendWriteStart(Transfer& transfer) {
+  Chunk start;
+  start.transfer_id = transfer.id();
+  start.type = transfer.resumes ? Chunk::Type::kTransferResume
+                                : Chunk::Type::kTransferStart;
+
+  write_stream_.Send([&start](ByteSpan buffer) {
+    return internal::EncodeChunk(start, buffer);
+  });
+}
+
+void Client::SendData(Transfer& transfer) {
+  internal::Transmitter& transmitter = transfer.transmitter;
+
+  while (transmitter.ReadyToSend()) {
+    Status read_status;
+    Status send_status = write_stream_.Send([&](ByteSpan buffer) {
+      Result<ConstByteSpan> chunk = transmitter.EncodeNextChunk(buffer);
+      read_status = chunk.status();
+      return chunk;
+    });
+
+    if (!read_status.ok()) {
+      SendStatus(transfer, read_status);
+      Complete(transfer, read_status);
+      return;
+    }
+
+    // A chunk that could not be sent is lost like any other, and the server
+    // asks for it again.
+    if (!send_status.ok()) {
+      return;
+    }
+  }
+}
+
+void Client::SendStatus(Transfer& transfer, Status status) {
+  Chunk chunk;
+  chunk.transfer_id = transfer.id();
+  chunk.status = status;
+
+  stream(transfer.reads).Send([&chunk](ByteSpan buffer) {
+    return internal::EncodeChunk(chunk, buffer);
+  });
+}
+
+void Client::Complete(Transfer& transfer, Status status) {
+  transfer.receiver.Finish();
+  transfer.transmitter.Finish();
+
+  // The transfer is free before the callback, which may start another one.
+  CompletionFunc on_completion = std::move(transfer.on_completion);
+  transfer.on_completion = nullptr;
+  if (on_completion != nullptr) {
+    on_completion(status);
+  }
+}
+
+Result<Client::Transfer*> Client::StartTransfer(uint32_t transfer_id,
+                                                bool reads) {
+  if (FindTransfer(transfer_id, reads) != nullptr) {
+    return Status::FailedPrecondition();
+  }
+
+  Transfer* free_transfer = nullptr;
+  for (Transfer& transfer : transfers_) {
+    if (!transfer.active()) {
+      free_transfer = &transfer;
+      break;
+    }
+  }
+  if (free_transfer == nullptr) {
+    return Status::ResourceExhausted();
+  }
+
+  ChunkStream& chunk_stream = stream(reads);
+  if (!chunk_stream.active()) {
+    chunk_stream =
+        ChunkStream(*this, reads ? kReadMethodId : kWriteMethodId, reads);
+    PW_TRY(chunk_stream.Open());
+  }
+
+  free_transfer->reads = reads;
+  return free_transfer;
+}
+
+Client::Transfer* Client::FindTransfer(uint32_t transfer_id, bool reads) {
+  for (Transfer& transfer : transfers_) {
+    if (transfer.active() && transfer.reads == reads &&
+        transfer.id() == transfer_id) {
+      return &transfer;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace pw::transfer
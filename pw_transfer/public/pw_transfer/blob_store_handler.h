@@ -0,0 +1,53 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "pw_blob_store/blob_store.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_transfer/handler.h"
+
+namespace pw::transfer {
+
+// A handler that transfers the blob in a BlobStore.
+//
+// A write replaces the stored blob. Chunk data is written to flash straight
+// from the RPC packet, and the blob is only valid once the whole write
+// succeeds; a failed write leaves no blob behind.
+//
+// If the blob's flash is memory mapped, reads are served from the mapped blob
+// rather than copied through the blob store.
+class BlobStoreHandler final : public Handler {
+ public:
+  BlobStoreHandler(uint32_t id, blob_store::BlobStore& blob_store)
+      : Handler(id, &blob_reader_, &blob_writer_),
+        blob_reader_(blob_store),
+        blob_writer_(blob_store) {}
+
+  Status PrepareRead() override;
+  void FinalizeRead(Status status) override;
+
+  Status PrepareWrite() override;
+  Status FinalizeWrite(Status status) override;
+
+ private:
+  blob_store::BlobStore::BlobReader blob_reader_;
+  std::optional<stream::MemoryReader> mapped_reader_;
+
+  blob_store::BlobStore::BlobWriter blob_writer_;
+};
+
+}  // namespace pw::transfer
@@ -0,0 +1,199 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_function/function.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/internal/base_client_call.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+#include "pw_transfer/internal/config.h"
+#include "pw_transfer/internal/receiver.h"
+#include "pw_transfer/internal/transmitter.h"
+
+namespace pw::transfer {
+
+// The client side of the transfer protocol, which reads data from and writes
+// data to a TransferService over an RPC channel. The client opens each of the
+// service's Read and Write streams the first time it is used, and runs all of
+// its transfers in that direction over it.
+//
+// For reads, the client is the receiver. It asks the server for
+// max_pending_bytes at a time, in chunks of up to max_chunk_size_bytes, which
+// should fit in an RPC packet on the channel. The chunk size adapts to the
+// link, as described in internal/receiver.h.
+//
+// The client runs in the thread that processes RPC packets, which must also
+// call RetryStalledTransfers() periodically. Completion callbacks are called
+// from that thread.
+class Client {
+ public:
+  using CompletionFunc = Function<void(Status)>;
+
+  Client(rpc::Channel& channel,
+         uint32_t max_pending_bytes,
+         uint32_t max_chunk_size_bytes)
+      : channel_(channel),
+        max_pending_bytes_(max_pending_bytes),
+        max_chunk_size_bytes_(max_chunk_size_bytes) {}
+
+  Client(const Client&) = delete;
+  Client& operator=(const Client&) = delete;
+
+  // Reads the data of a transfer from the server to the writer. on_completion
+  // is called with the status of the transfer when it ends. Returns:
+  //
+  //   OK - the transfer started.
+  //   FAILED_PRECONDITION - a read of this transfer is already running.
+  //   RESOURCE_EXHAUSTED - cfg::kClientMaxTransfers transfers are running.
+  //   Other errors - the Read stream could not be opened.
+  //
+  Status Read(uint32_t transfer_id,
+              stream::Writer& output,
+              CompletionFunc&& on_completion);
+
+  // Writes the reader's data to a transfer on the server. The reader must be
+  // seekable, so that lost data can be sent again. on_completion is called with
+  // the status of the transfer when it ends. Returns the same statuses as
+  // Read().
+  Status Write(uint32_t transfer_id,
+               stream::SeekableReader& input,
+               CompletionFunc&& on_completion);
+
+  // Resumes a read that was interrupted, such as by a dropped link, from
+  // offset: the amount of its data that the writer already holds. The writer
+  // must be positioned to write the data from that offset. Returns the same
+  // statuses as Read().
+  Status ResumeRead(uint32_t transfer_id,
+                    uint64_t offset,
+                    stream::Writer& output,
+                    CompletionFunc&& on_completion);
+
+  // Resumes a write that was interrupted. The server answers with the offset
+  // that it kept the data up to, and the write carries on from there, or from
+  // the beginning if the server cannot resume it. The reader is seeked to that
+  // offset, so it must hold the whole transfer. Returns the same statuses as
+  // Read().
+  Status ResumeWrite(uint32_t transfer_id,
+                     stream::SeekableReader& input,
+                     CompletionFunc&& on_completion);
+
+  // Ends a transfer early, with CANCELLED.
+  void Cancel(uint32_t transfer_id);
+
+  // Recovers transfers that have made no progress since the previous call, as
+  // TransferService::RetryStalledTransfers() does.
+  void RetryStalledTransfers();
+
+ private:
+  // One of the service's Read or Write streams.
+  class ChunkStream : public rpc::internal::BaseClientCall {
+   public:
+    constexpr ChunkStream()
+        : client_(nullptr), reads_(false), reopen_(false) {}
+
+    ChunkStream(Client& client, uint32_t method_id, bool reads);
+
+    ChunkStream(ChunkStream&&) = default;
+    ChunkStream& operator=(ChunkStream&&) = default;
+
+    // Starts the RPC on the server.
+    Status Open();
+
+    // Starts the RPC again if the server reported that it is not open.
+    void ReopenIfLost();
+
+    // Sends a chunk encoded by the function, which encodes it in the buffer it
+    // is given. Returns the encoding error if it fails.
+    template <typename Encode>
+    Status Send(Encode&& encode) {
+      ByteSpan buffer = AcquirePayloadBuffer();
+      Result<ConstByteSpan> chunk = encode(buffer);
+      if (!chunk.ok()) {
+        ReleaseClientStreamBuffer({});
+        return chunk.status();
+      }
+      return ReleaseClientStreamBuffer(chunk.value());
+    }
+
+   private:
+    static void HandlePacket(rpc::internal::BaseClientCall& call,
+                             const rpc::internal::Packet& packet);
+
+    Client* client_;
+    bool reads_;
+    bool reopen_;
+  };
+
+  struct Transfer {
+    bool active() const { return receiver.active() || transmitter.active(); }
+
+    uint32_t id() const {
+      return reads ? receiver.transfer_id() : transmitter.transfer_id();
+    }
+
+    bool reads = false;
+    bool resumes = false;  // Used in writes.
+    CompletionFunc on_completion;
+    internal::Receiver receiver;        // Used in reads.
+    internal::Transmitter transmitter;  // Used in writes.
+  };
+
+  Status StartWrite(uint32_t transfer_id,
+                    stream::SeekableReader& input,
+                    CompletionFunc&& on_completion,
+                    bool resumes);
+
+  void HandleChunk(bool reads, ConstByteSpan message);
+
+  // Fails every transfer on a stream that the server closed.
+  void HandleStreamError(bool reads, Status status);
+
+  // Sends the read's parameters or status, if it has one to send.
+  void SendReadResponse(Transfer& transfer);
+
+  // Asks the server to start or resume a write, which it answers with
+  // parameters.
+  void SendWriteStart(Transfer& transfer);
+
+  // Sends the data in the write's window.
+  void SendData(Transfer& transfer);
+
+  void SendStatus(Transfer& transfer, Status status);
+
+  // Ends a transfer and calls its completion callback.
+  void Complete(Transfer& transfer, Status status);
+
+  Result<Transfer*> StartTransfer(uint32_t transfer_id, bool reads);
+  Transfer* FindTransfer(uint32_t transfer_id, bool reads);
+
+  ChunkStream& stream(bool reads) {
+    return reads ? read_stream_ : write_stream_;
+  }
+
+  rpc::Channel& channel_;
+  const uint32_t max_pending_bytes_;
+  const uint32_t max_chunk_size_bytes_;
+
+  ChunkStream read_stream_;
+  ChunkStream write_stream_;
+
+  std::array<Transfer, cfg::kClientMaxTransfers> transfers_;
+};
+
+}  // namespace pw::transfer
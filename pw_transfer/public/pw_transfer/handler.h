@@ -0,0 +1,120 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_containers/intrusive_list.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+#include "pw_transfer/internal/receiver.h"
+#include "pw_transfer/internal/transmitter.h"
+
+namespace pw::transfer {
+
+// The source or destination of the data in transfers with a particular transfer
+// ID. Handlers are registered with a TransferService, which serves reads from
+// the handler's reader and writes to its writer. The reader must be seekable,
+// so that lost data can be sent again from where it was lost.
+//
+// Each handler runs at most one read and one write at a time. A new transfer
+// with the handler's ID replaces a transfer in progress.
+//
+// The Prepare and Finalize functions may be overridden to set up the streams
+// before a transfer, for example by erasing flash before a write, and to act on
+// the data afterwards.
+class Handler : public IntrusiveList<Handler>::Item {
+ public:
+  virtual ~Handler() = default;
+
+  uint32_t id() const { return id_; }
+
+  // Called before a read starts. Returning an error ends the read with it.
+  virtual Status PrepareRead() { return OkStatus(); }
+
+  // Called when a read ends, with the status of the read.
+  virtual void FinalizeRead(Status) {}
+
+  // Called before a write starts. Returning an error ends the write with it.
+  virtual Status PrepareWrite() { return OkStatus(); }
+
+  // Called when a write ends, with the status of the write. The status returned
+  // is the one sent to the client, so that a complete write can still fail, for
+  // example if the data does not verify.
+  virtual Status FinalizeWrite(Status status) { return status; }
+
+  // Called before a write resumes, instead of PrepareWrite, when the client
+  // resumes a write that was interrupted. Returns the offset to resume from:
+  // the amount of data from the interrupted write that the handler kept. The
+  // writer must be positioned to write the data from that offset. Handlers
+  // that return UNIMPLEMENTED, as the default does, start the write over with
+  // PrepareWrite; other errors end the write.
+  //
+  // To resume, a handler must keep the data of a write that failed, rather
+  // than discarding it in FinalizeWrite.
+  virtual Result<uint64_t> PrepareResumeWrite() {
+    return Status::Unimplemented();
+  }
+
+  // Called every cfg::kCheckpointIntervalBytes of a write, with the amount of
+  // data the writer has accepted so far. Handlers that resume writes after a
+  // reset record this, for example in a KVS, once the data is committed to
+  // storage.
+  virtual void CheckpointWrite(uint64_t) {}
+
+ protected:
+  Handler(uint32_t id, stream::SeekableReader* reader, stream::Writer* writer)
+      : id_(id), reader_(reader), writer_(writer) {}
+
+  // Changes the reader that reads are served from. PrepareRead may call this to
+  // pick the reader for the read it prepares.
+  void set_reader(stream::SeekableReader& reader) { reader_ = &reader; }
+
+ private:
+  friend class TransferService;
+
+  uint32_t id_;
+  stream::SeekableReader* reader_;
+  stream::Writer* writer_;
+  uint64_t checkpoint_offset_ = 0;
+
+  internal::Transmitter transmitter_;
+  internal::Receiver receiver_;
+};
+
+// A handler that serves reads from a reader.
+class ReadOnlyHandler : public Handler {
+ public:
+  ReadOnlyHandler(uint32_t id, stream::SeekableReader& reader)
+      : Handler(id, &reader, nullptr) {}
+};
+
+// A handler that accepts writes to a writer.
+class WriteOnlyHandler : public Handler {
+ public:
+  WriteOnlyHandler(uint32_t id, stream::Writer& writer)
+      : Handler(id, nullptr, &writer) {}
+};
+
+// A handler that serves reads from a reader and accepts writes to a writer.
+class ReadWriteHandler : public Handler {
+ public:
+  ReadWriteHandler(uint32_t id,
+                   stream::SeekableReader& reader,
+                   stream::Writer& writer)
+      : Handler(id, &reader, &writer) {}
+};
+
+}  // namespace pw::transfer
@@ -0,0 +1,68 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+
+namespace pw::transfer::internal {
+
+// A decoded pw.transfer.Chunk message.
+struct Chunk {
+  // Mirrors pw.transfer.Chunk.Type.
+  enum class Type : uint8_t {
+    kTransferData = 0,
+    kTransferStart = 1,
+    kParametersRetransmit = 2,
+    kParametersContinue = 3,
+    kTransferResume = 4,
+  };
+
+  uint32_t transfer_id = 0;
+  std::optional<uint32_t> pending_bytes;
+  std::optional<uint32_t> max_chunk_size_bytes;
+  std::optional<uint32_t> min_delay_microseconds;
+  uint64_t offset = 0;
+  ConstByteSpan data;
+  std::optional<uint64_t> remaining_bytes;
+  std::optional<Status> status;
+  Type type = Type::kTransferData;
+};
+
+// The most bytes a chunk's fields other than data take up when encoded,
+// including the key and size of the data field.
+inline constexpr size_t kMaxChunkOverheadBytes = 64;
+
+// Decodes a Chunk message. The chunk's data refers to the message. Returns
+// DATA_LOSS if the message is malformed.
+Status DecodeChunk(ConstByteSpan message, Chunk& chunk);
+
+// Encodes a chunk to the buffer. Returns RESOURCE_EXHAUSTED if it does not fit.
+Result<ConstByteSpan> EncodeChunk(const Chunk& chunk, ByteSpan buffer);
+
+// Data chunks are encoded with the data field first, so that data can be read
+// straight into the buffer before its size is known. DataChunkPayload() returns
+// the part of a buffer in which to place up to max_data_bytes of data, and
+// EncodeDataChunk() encodes the rest of the chunk around that data without
+// copying it. chunk.data must be at the start of the payload.
+ByteSpan DataChunkPayload(ByteSpan buffer, size_t max_data_bytes);
+Result<ConstByteSpan> EncodeDataChunk(const Chunk& chunk,
+                                      ByteSpan buffer,
+                                      size_t max_data_bytes);
+
+}  // namespace pw::transfer::internal
@@ -0,0 +1,52 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Configuration macros for the pw_transfer module.
+#pragma once
+
+#include <cstddef>
+
+// The number of times in a row that a stalled transfer is retried before it
+// fails with DEADLINE_EXCEEDED. Transfers are retried from
+// RetryStalledTransfers(), so the time a transfer may stall for is this many
+// times the interval at which that is called.
+#ifndef PW_TRANSFER_MAX_RETRIES
+#define PW_TRANSFER_MAX_RETRIES 3
+#endif  // PW_TRANSFER_MAX_RETRIES
+
+// The number of transfers that a transfer client can run at once. Each one
+// takes a few dozen bytes.
+#ifndef PW_TRANSFER_CLIENT_MAX_TRANSFERS
+#define PW_TRANSFER_CLIENT_MAX_TRANSFERS 2
+#endif  // PW_TRANSFER_CLIENT_MAX_TRANSFERS
+
+// How much data a write receives between calls to its handler's
+// CheckpointWrite(), which resumable handlers use to record how far the write
+// got. Each checkpoint may cost a flash write, such as a KVS entry.
+#ifndef PW_TRANSFER_CHECKPOINT_INTERVAL_BYTES
+#define PW_TRANSFER_CHECKPOINT_INTERVAL_BYTES 4096
+#endif  // PW_TRANSFER_CHECKPOINT_INTERVAL_BYTES
+
+namespace pw::transfer::cfg {
+
+inline constexpr unsigned kMaxRetries = PW_TRANSFER_MAX_RETRIES;
+inline constexpr size_t kClientMaxTransfers = PW_TRANSFER_CLIENT_MAX_TRANSFERS;
+inline constexpr size_t kCheckpointIntervalBytes =
+    PW_TRANSFER_CHECKPOINT_INTERVAL_BYTES;
+
+}  // namespace pw::transfer::cfg
+
+#undef PW_TRANSFER_MAX_RETRIES
+#undef PW_TRANSFER_CLIENT_MAX_TRANSFERS
+#undef PW_TRANSFER_CHECKPOINT_INTERVAL_BYTES
@@ -0,0 +1,147 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+#include "pw_transfer/internal/chunk.h"
+
+namespace pw::transfer::internal {
+
+// The receiving side of a transfer. The receiver writes data chunks to a writer
+// in order, and controls the flow of data with transfer parameters:
+//
+//   - The window (pending_bytes) is the most data the transmitter may send
+//     ahead of the receiver. Once half of a window has arrived, the receiver
+//     sends PARAMETERS_CONTINUE to extend it, so that the transmitter does not
+//     stall waiting for parameters while the link is idle.
+//   - If a chunk arrives past the expected offset, the chunks before it were
+//     lost. The receiver sends PARAMETERS_RETRANSMIT with the offset of the
+//     missing data and drops chunks until that data arrives.
+//   - The chunk size adapts to the link, like a TCP congestion window. Each
+//     loss halves max_chunk_size_bytes, down to an eighth of its maximum, since
+//     large chunks are the most likely to be corrupted on a noisy link, and
+//     cost the most to resend. Every window extension grows it again by an
+//     eighth of the maximum.
+//
+// The receiver does not send anything itself. After each chunk, the owner sends
+// the response from EncodeResponse(), if there is one.
+class Receiver {
+ public:
+  constexpr Receiver()
+      : writer_(nullptr),
+        transfer_id_(0),
+        offset_(0),
+        window_end_offset_(0),
+        max_pending_bytes_(0),
+        max_chunk_size_bytes_(0),
+        chunk_size_bytes_(0),
+        response_(Response::kNone),
+        awaiting_retransmit_(false),
+        chunk_received_(false),
+        completed_(false),
+        retries_(0),
+        status_(OkStatus()) {}
+
+  Receiver(const Receiver&) = delete;
+  Receiver& operator=(const Receiver&) = delete;
+
+  // Starts a transfer to the writer. The initial transfer parameters are ready
+  // to send with EncodeResponse(). A transfer that resumes an earlier one starts
+  // at the offset that the earlier one got to; the writer must be positioned
+  // to write the data from that offset.
+  void Start(uint32_t transfer_id,
+             stream::Writer& writer,
+             uint32_t max_pending_bytes,
+             uint32_t max_chunk_size_bytes,
+             uint64_t offset = 0);
+
+  // Ends the transfer without sending anything.
+  void Finish() { writer_ = nullptr; }
+
+  bool active() const { return writer_ != nullptr; }
+  uint32_t transfer_id() const { return transfer_id_; }
+
+  // The offset of the next data to receive.
+  uint64_t offset() const { return offset_; }
+
+  // The max_chunk_size_bytes of the next transfer parameters.
+  uint32_t chunk_size_bytes() const { return chunk_size_bytes_; }
+
+  // True once the final chunk has been written, or the transfer failed. The
+  // response is then a status chunk, after which the transfer is over.
+  bool completed() const { return completed_; }
+
+  // The status of a completed transfer.
+  Status status() const { return status_; }
+
+  // Fails the transfer with an error, which is sent to the transmitter.
+  void Fail(Status status) {
+    completed_ = true;
+    status_ = status;
+    response_ = Response::kStatus;
+  }
+
+  // Processes a data chunk from the transmitter.
+  void HandleDataChunk(const Chunk& chunk);
+
+  // Called periodically by the owner of the transfer. If no chunk arrived since
+  // the previous call, the last parameters or the chunks they asked for were
+  // lost, so the receiver asks for the data again from its offset. After
+  // cfg::kMaxRetries retries in a row, the transfer fails with
+  // DEADLINE_EXCEEDED instead, which is returned.
+  Status RetryIfStalled();
+
+  // True if there is a chunk to send to the transmitter.
+  bool response_pending() const { return response_ != Response::kNone; }
+
+  // Encodes the chunk to send to the transmitter: transfer parameters, or the
+  // status of a completed transfer. Only call this if response_pending() is
+  // true.
+  Result<ConstByteSpan> EncodeResponse(ByteSpan buffer);
+
+ private:
+  enum class Response : uint8_t {
+    kNone,
+    kContinue,
+    kRetransmit,
+    kStatus,
+  };
+
+  uint32_t chunk_size_step() const {
+    return max_chunk_size_bytes_ < 8u ? 1u : max_chunk_size_bytes_ / 8u;
+  }
+
+  void RequestRetransmit();
+
+  stream::Writer* writer_;
+  uint32_t transfer_id_;
+  uint64_t offset_;
+  uint64_t window_end_offset_;
+  uint32_t max_pending_bytes_;
+  uint32_t max_chunk_size_bytes_;
+  uint32_t chunk_size_bytes_;
+  Response response_;
+  bool awaiting_retransmit_;
+  bool chunk_received_;
+  bool completed_;
+  uint8_t retries_;
+  Status status_;
+};
+
+}  // namespace pw::transfer::internal
@@ -0,0 +1,117 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+#include "pw_transfer/internal/chunk.h"
+
+namespace pw::transfer::internal {
+
+// The sending side of a transfer. The transmitter sends data from a reader in
+// a window of bytes set by the receiver's transfer parameters. Every chunk in
+// the window is sent without waiting for an acknowledgement, and the receiver
+// extends the window with PARAMETERS_CONTINUE chunks before it runs out, so
+// the transmitter sends continuously while the receiver keeps up.
+//
+// When the receiver finds a chunk missing, it sends PARAMETERS_RETRANSMIT with
+// the offset of the missing data. The transmitter seeks the reader back to that
+// offset and carries on from there, so only the data from the lost chunk on is
+// sent again, not the whole transfer.
+class Transmitter {
+ public:
+  constexpr Transmitter()
+      : reader_(nullptr),
+        transfer_id_(0),
+        offset_(0),
+        window_end_offset_(0),
+        max_chunk_size_bytes_(0),
+        parameters_received_(false),
+        sent_final_chunk_(false),
+        chunk_received_(false),
+        retries_(0) {}
+
+  Transmitter(const Transmitter&) = delete;
+  Transmitter& operator=(const Transmitter&) = delete;
+
+  // Starts a transfer of the reader's data. Offsets in the transfer are
+  // positions in the reader. Nothing is sent until the receiver's transfer
+  // parameters arrive.
+  void Start(uint32_t transfer_id, stream::SeekableReader& reader);
+
+  // Ends the transfer.
+  void Finish() { reader_ = nullptr; }
+
+  bool active() const { return reader_ != nullptr; }
+  uint32_t transfer_id() const { return transfer_id_; }
+
+  // The offset of the next data to send.
+  uint64_t offset() const { return offset_; }
+
+  // True until the receiver's first transfer parameters arrive. The owner
+  // started the transfer with a request to the receiver, which it sends again
+  // if this is still true after RetryIfStalled().
+  bool awaiting_parameters() const {
+    return active() && !parameters_received_;
+  }
+
+  // Applies transfer parameters from the receiver. Returns:
+  //
+  //   OK - the window was updated.
+  //   INVALID_ARGUMENT - the chunk did not set pending_bytes.
+  //   Other errors - the reader could not seek to the requested offset.
+  //
+  Status HandleParameters(const Chunk& parameters);
+
+  // Called periodically by the owner of the transfer. The transfer is stalled
+  // if it is waiting for the receiver and nothing arrived from the receiver
+  // since the previous call. If the final chunk was sent, the final chunk or
+  // the receiver's status was lost, so the final chunk is sent again. Stalls
+  // in the middle of the transfer are left to the receiver, which asks for the
+  // missing data. Returns DEADLINE_EXCEEDED after cfg::kMaxRetries stalls in a
+  // row, which fails the transfer.
+  Status RetryIfStalled();
+
+  // True if there is data left to send in the current window. The final chunk
+  // is sent even if it is empty.
+  bool ReadyToSend() const {
+    return active() && !sent_final_chunk_ && offset_ < window_end_offset_;
+  }
+
+  // Reads the next chunk of data into the buffer, which is usually an RPC
+  // payload buffer, and encodes it as a data chunk. The chunk is no larger
+  // than the receiver's max_chunk_size_bytes or the buffer. Only call this if
+  // ReadyToSend() is true.
+  //
+  // Returns the encoded chunk, RESOURCE_EXHAUSTED if the buffer is too small
+  // for any data, or the reader's error if it failed.
+  Result<ConstByteSpan> EncodeNextChunk(ByteSpan buffer);
+
+ private:
+  stream::SeekableReader* reader_;
+  uint32_t transfer_id_;
+  uint64_t offset_;
+  uint64_t window_end_offset_;
+  uint32_t max_chunk_size_bytes_;
+  bool parameters_received_;
+  bool sent_final_chunk_;
+  bool chunk_received_;
+  uint8_t retries_;
+};
+
+}  // namespace pw::transfer::internal
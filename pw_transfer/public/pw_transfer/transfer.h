@@ -0,0 +1,92 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_containers/intrusive_list.h"
+#include "pw_transfer/handler.h"
+#include "pw_transfer/transfer.raw_rpc.pb.h"
+
+namespace pw::transfer {
+
+// The server side of the transfer protocol. Reads and writes are served by the
+// Handler registered for their transfer ID. Each of the Read and Write RPCs is
+// one stream that carries every transfer in its direction, so clients open the
+// streams once and then run transfers over them.
+//
+// For writes, the service is the receiver. It asks the client for
+// max_pending_bytes at a time, in chunks of up to max_chunk_size_bytes, which
+// should fit in an RPC packet on the channel. The chunk size adapts to the
+// link, as described in internal/receiver.h.
+//
+// The service runs entirely in the thread that processes RPC packets, which
+// must also call RetryStalledTransfers() periodically.
+class TransferService : public generated::Transfer<TransferService> {
+ public:
+  TransferService(uint32_t max_pending_bytes, uint32_t max_chunk_size_bytes)
+      : max_pending_bytes_(max_pending_bytes),
+        max_chunk_size_bytes_(max_chunk_size_bytes) {}
+
+  TransferService(const TransferService&) = delete;
+  TransferService& operator=(const TransferService&) = delete;
+
+  void Read(ServerContext&, RawServerReaderWriter& reader_writer);
+
+  void Write(ServerContext&, RawServerReaderWriter& reader_writer);
+
+  void RegisterHandler(Handler& handler) { handlers_.push_front(handler); }
+
+  void UnregisterHandler(Handler& handler) { handlers_.remove(handler); }
+
+  // Recovers transfers that have made no progress since the previous call,
+  // whose last chunks were lost: writes ask for their data again, and reads
+  // that sent the final chunk send it again. Transfers fail with
+  // DEADLINE_EXCEEDED if they stall several times in a row. Call this every
+  // few hundred milliseconds, or a few times the round trip time of the link.
+  void RetryStalledTransfers();
+
+ private:
+  void HandleReadChunk(ConstByteSpan message);
+  void HandleWriteChunk(ConstByteSpan message);
+
+  // Starts or resumes a write, which replaces a write that is in progress.
+  void StartWrite(Handler& handler, const internal::Chunk& chunk);
+
+  // Sends the data in the read's window.
+  void SendData(Handler& handler);
+
+  // Sends the write's parameters or status, if it has one to send.
+  void SendWriteResponse(Handler& handler);
+
+  void FinishRead(Handler& handler, Status status);
+  void FinishWrite(Handler& handler, Status status);
+
+  static void SendStatus(RawServerReaderWriter& stream,
+                         uint32_t transfer_id,
+                         Status status);
+
+  Handler* FindHandler(uint32_t transfer_id);
+
+  RawServerReaderWriter read_stream_;
+  RawServerReaderWriter write_stream_;
+
+  IntrusiveList<Handler> handlers_;
+
+  const uint32_t max_pending_bytes_;
+  const uint32_t max_chunk_size_bytes_;
+};
+
+}  // namespace pw::transfer
@@ -0,0 +1,157 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_assert/assert.h"
+#include "pw_rpc/client.h"
+#include "pw_rpc/server.h"
+#include "pw_transfer/client.h"
+#include "pw_transfer/transfer.h"
+
+namespace pw::transfer::test {
+
+inline constexpr size_t kMaxPacketSizeBytes = 128;
+
+// Queues the packets sent on a channel until the test delivers them. Packets
+// can be dropped to simulate a lossy link.
+class QueuedOutput : public rpc::ChannelOutput {
+ public:
+  QueuedOutput(const char* name) : ChannelOutput(name) {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override {
+    if (buffer.empty()) {
+      return OkStatus();
+    }
+
+    sent_ += 1;
+    if (sent_ == drop_packet_ || (drop_from_ != 0 && sent_ >= drop_from_) ||
+        (drop_interval_ != 0 && sent_ % drop_interval_ == 0)) {
+      return OkStatus();
+    }
+
+    PW_ASSERT(count_ < queue_.size());
+    Packet& packet = queue_[(head_ + count_) % queue_.size()];
+    std::copy(buffer.begin(), buffer.end(), packet.data.begin());
+    packet.size = buffer.size();
+    count_ += 1;
+    return OkStatus();
+  }
+
+  bool empty() const { return count_ == 0; }
+
+  ConstByteSpan front() const {
+    const Packet& packet = queue_[head_];
+    return std::span(packet.data).first(packet.size);
+  }
+
+  void pop() {
+    head_ = (head_ + 1) % queue_.size();
+    count_ -= 1;
+  }
+
+  // 0 delivers every packet; N drops every Nth one; 1 drops them all.
+  void set_drop_interval(size_t interval) { drop_interval_ = interval; }
+
+  // Drops the Nth packet sent, counting from 1.
+  void DropPacket(size_t n) { drop_packet_ = n; }
+
+  // Drops the Nth packet sent and every one after it, as if the link went
+  // down. 0 brings the link back up.
+  void DropFrom(size_t n) { drop_from_ = n; }
+
+ private:
+  struct Packet {
+    std::array<std::byte, kMaxPacketSizeBytes> data;
+    size_t size;
+  };
+
+  std::array<std::byte, kMaxPacketSizeBytes> buffer_;
+  std::array<Packet, 64> queue_;
+  size_t head_ = 0;
+  size_t count_ = 0;
+
+  size_t sent_ = 0;
+  size_t drop_interval_ = 0;
+  size_t drop_packet_ = 0;
+  size_t drop_from_ = 0;
+};
+
+// A transfer client and service connected by an RPC channel in each direction.
+// Packets are queued until the test runs the loopback.
+class TransferLoopback {
+ public:
+  TransferLoopback(uint32_t max_pending_bytes, uint32_t max_chunk_size_bytes)
+      : client_output_("client"),
+        server_output_("server"),
+        client_channels_{rpc::Channel::Create<1>(&client_output_)},
+        server_channels_{rpc::Channel::Create<1>(&server_output_)},
+        rpc_client_(client_channels_),
+        rpc_server_(server_channels_),
+        service_(max_pending_bytes, max_chunk_size_bytes),
+        client_(client_channels_[0], max_pending_bytes, max_chunk_size_bytes) {
+    rpc_server_.RegisterService(service_);
+  }
+
+  TransferService& service() { return service_; }
+  Client& client() { return client_; }
+
+  QueuedOutput& client_output() { return client_output_; }
+  QueuedOutput& server_output() { return server_output_; }
+
+  // Delivers packets in both directions until none are left in flight.
+  void RunUntilIdle() {
+    while (!client_output_.empty() || !server_output_.empty()) {
+      if (!client_output_.empty()) {
+        rpc_server_.ProcessPacket(client_output_.front(), server_output_);
+        client_output_.pop();
+      }
+      if (!server_output_.empty()) {
+        rpc_client_.ProcessPacket(server_output_.front());
+        server_output_.pop();
+      }
+    }
+  }
+
+  // Runs transfers until done() returns true, retrying them as their owners
+  // would.
+  template <typename Done>
+  void RunTransfers(Done&& done) {
+    for (int i = 0; i < 100 && !done(); ++i) {
+      RunUntilIdle();
+      client_.RetryStalledTransfers();
+      service_.RetryStalledTransfers();
+    }
+    RunUntilIdle();
+  }
+
+ private:
+  QueuedOutput client_output_;
+  QueuedOutput server_output_;
+  std::array<rpc::Channel, 1> client_channels_;
+  std::array<rpc::Channel, 1> server_channels_;
+  rpc::Client rpc_client_;
+  rpc::Server rpc_server_;
+
+  TransferService service_;
+  Client client_;
+};
+
+}  // namespace pw::transfer::test
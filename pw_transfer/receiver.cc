@@ -0,0 +1,142 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_transfer/internal/receiver.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "pw_assert/assert.h"
+#include "pw_transfer/internal/config.h"
+
+namespace pw::transfer::internal {
+
+void Receiver::Start(uint32_t transfer_id,
+                     stream::Writer& writer,
+                     uint32_t max_pending_bytes,
+                     uint32_t max_chunk_size_bytes,
+                     uint64_t offset) {
+  writer_ = &writer;
+  transfer_id_ = transfer_id;
+  offset_ = offset;
+  window_end_offset_ = offset;
+  max_pending_bytes_ = max_pending_bytes;
+  max_chunk_size_bytes_ = max_chunk_size_bytes;
+  chunk_size_bytes_ = max_chunk_size_bytes;
+  response_ = Response::kRetransmit;
+  awaiting_retransmit_ = false;
+  chunk_received_ = false;
+  completed_ = false;
+  retries_ = 0;
+  status_ = OkStatus();
+}
+
+void Receiver::HandleDataChunk(const Chunk& chunk) {
+  if (completed_) {
+    // The transmitter sent the final chunk again, so it did not get the
+    // status.
+    chunk_received_ = true;
+    response_ = Response::kStatus;
+    return;
+  }
+
+  // Chunks that are not at the offset are not progress, so they do not stop
+  // RetryIfStalled() from asking for the data again.
+  if (chunk.offset != offset_) {
+    // A chunk past the offset means that data was lost. Chunks that were in
+    // flight when the retransmit was requested are dropped without asking
+    // again, as are chunks before the offset, which were received already.
+    if (chunk.offset > offset_ && !awaiting_retransmit_) {
+      RequestRetransmit();
+    }
+    return;
+  }
+
+  chunk_received_ = true;
+  awaiting_retransmit_ = false;
+
+  if (!chunk.data.empty()) {
+    if (Status status = writer_->Write(chunk.data); !status.ok()) {
+      Fail(status);
+      return;
+    }
+    offset_ += chunk.data.size();
+  }
+
+  if (chunk.remaining_bytes == 0u) {
+    completed_ = true;
+    response_ = Response::kStatus;
+    return;
+  }
+
+  // Extend the window once half of it has arrived, so that the transmitter
+  // gets the parameters before it runs out of data to send.
+  if (window_end_offset_ - offset_ <= max_pending_bytes_ / 2) {
+    chunk_size_bytes_ = std::min(max_chunk_size_bytes_,
+                                 chunk_size_bytes_ + chunk_size_step());
+    response_ = Response::kContinue;
+  }
+}
+
+Status Receiver::RetryIfStalled() {
+  if (std::exchange(chunk_received_, false)) {
+    retries_ = 0;
+    return OkStatus();
+  }
+
+  // A completed transfer waits for the transmitter, which sends the final
+  // chunk again if it did not get the status.
+  if (completed_) {
+    return OkStatus();
+  }
+
+  if (retries_ >= cfg::kMaxRetries) {
+    Fail(Status::DeadlineExceeded());
+    return status_;
+  }
+
+  retries_ += 1;
+  RequestRetransmit();
+  return OkStatus();
+}
+
+void Receiver::RequestRetransmit() {
+  chunk_size_bytes_ = std::max(chunk_size_step(), chunk_size_bytes_ / 2);
+  awaiting_retransmit_ = true;
+  response_ = Response::kRetransmit;
+}
+
+Result<ConstByteSpan> Receiver::EncodeResponse(ByteSpan buffer) {
+  PW_DASSERT(response_pending());
+
+  Chunk chunk;
+  chunk.transfer_id = transfer_id_;
+
+  if (response_ == Response::kStatus) {
+    chunk.status = status_;
+  } else {
+    chunk.type = response_ == Response::kContinue
+                     ? Chunk::Type::kParametersContinue
+                     : Chunk::Type::kParametersRetransmit;
+    chunk.offset = offset_;
+    chunk.pending_bytes = max_pending_bytes_;
+    chunk.max_chunk_size_bytes = chunk_size_bytes_;
+    window_end_offset_ = offset_ + max_pending_bytes_;
+  }
+
+  response_ = Response::kNone;
+  return EncodeChunk(chunk, buffer);
+}
+
+}  // namespace pw::transfer::internal
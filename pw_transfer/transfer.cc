@@ -0,0 +1,276 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_transfer/transfer.h"
+
+#include "pw_log/log.h"
+#include "pw_transfer/internal/chunk.h"
+#include "pw_transfer/internal/config.h"
+
+namespace pw::transfer {
+
+using internal::Chunk;
+
+void TransferService::Read(ServerContext&,
+                           RawServerReaderWriter& reader_writer) {
+  read_stream_ = std::move(reader_writer);
+  read_stream_.set_on_next(
+      [this](ConstByteSpan message) { HandleReadChunk(message); });
+}
+
+void TransferService::Write(ServerContext&,
+                            RawServerReaderWriter& reader_writer) {
+  write_stream_ = std::move(reader_writer);
+  write_stream_.set_on_next(
+      [this](ConstByteSpan message) { HandleWriteChunk(message); });
+}
+
+void TransferService::RetryStalledTransfers() {
+  for (Handler& handler : handlers_) {
+    internal::Transmitter& transmitter = handler.transmitter_;
+    if (transmitter.active()) {
+      if (Status status = transmitter.RetryIfStalled(); !status.ok()) {
+        FinishRead(handler, status);
+        SendStatus(read_stream_, handler.id(), status);
+      } else {
+        SendData(handler);
+      }
+    }
+
+    internal::Receiver& receiver = handler.receiver_;
+    if (receiver.active() && !receiver.completed()) {
+      if (!receiver.RetryIfStalled().ok()) {
+        handler.FinalizeWrite(receiver.status());
+      }
+      SendWriteResponse(handler);
+    }
+  }
+}
+
+void TransferService::HandleReadChunk(ConstByteSpan message) {
+  Chunk chunk;
+  if (!internal::DecodeChunk(message, chunk).ok()) {
+    PW_LOG_WARN("Discarding malformed transfer chunk");
+    return;
+  }
+
+  Handler* handler = FindHandler(chunk.transfer_id);
+  if (handler == nullptr || handler->reader_ == nullptr) {
+    SendStatus(read_stream_, chunk.transfer_id, Status::NotFound());
+    return;
+  }
+
+  internal::Transmitter& transmitter = handler->transmitter_;
+
+  // A status from the client ends the read, successfully or not.
+  if (chunk.status.has_value()) {
+    if (transmitter.active()) {
+      FinishRead(*handler, chunk.status.value());
+    }
+    return;
+  }
+
+  if (!transmitter.active()) {
+    if (Status status = handler->PrepareRead(); !status.ok()) {
+      SendStatus(read_stream_, chunk.transfer_id, status);
+      return;
+    }
+    transmitter.Start(chunk.transfer_id, *handler->reader_);
+  }
+
+  if (Status status = transmitter.HandleParameters(chunk); !status.ok()) {
+    FinishRead(*handler, status);
+    SendStatus(read_stream_, chunk.transfer_id, status);
+    return;
+  }
+
+  SendData(*handler);
+}
+
+void TransferService::HandleWriteChunk(ConstByteSpan message) {
+  Chunk chunk;
+  if (!internal::DecodeChunk(message, chunk).ok()) {
+    PW_LOG_WARN("Discarding malformed transfer chunk");
+    return;
+  }
+
+  Handler* handler = FindHandler(chunk.transfer_id);
+  if (handler == nullptr || handler->writer_ == nullptr) {
+    SendStatus(write_stream_, chunk.transfer_id, Status::NotFound());
+    return;
+  }
+
+  internal::Receiver& receiver = handler->receiver_;
+
+  if (chunk.type == Chunk::Type::kTransferStart ||
+      chunk.type == Chunk::Type::kTransferResume) {
+    StartWrite(*handler, chunk);
+    return;
+  }
+
+  if (!receiver.active()) {
+    SendStatus(write_stream_, chunk.transfer_id, Status::FailedPrecondition());
+    return;
+  }
+
+  // A status from the client ends the write early.
+  if (chunk.status.has_value()) {
+    if (!receiver.completed()) {
+      FinishWrite(*handler, chunk.status.value());
+    }
+    receiver.Finish();
+    return;
+  }
+
+  // The write is finalized when it completes, so that the handler's status is
+  // the one sent to the client. A completed write stays active, so that its
+  // status can be sent again if the client sends the final chunk again.
+  const bool was_completed = receiver.completed();
+  receiver.HandleDataChunk(chunk);
+
+  if (receiver.completed() && !was_completed) {
+    if (Status status = handler->FinalizeWrite(receiver.status());
+        !status.ok()) {
+      receiver.Fail(status);
+    }
+  }
+
+  const uint64_t since_checkpoint =
+      receiver.offset() - handler->checkpoint_offset_;
+  if (!receiver.completed() &&
+      since_checkpoint >= cfg::kCheckpointIntervalBytes) {
+    handler->checkpoint_offset_ = receiver.offset();
+    handler->CheckpointWrite(receiver.offset());
+  }
+
+  SendWriteResponse(*handler);
+}
+
+void TransferService::StartWrite(Handler& handler, const Chunk& chunk) {
+  internal::Receiver& receiver = handler.receiver_;
+  const bool resumes = chunk.type == Chunk::Type::kTransferResume;
+
+  // The server may still be running a write that the client gave up on, if
+  // the client lost contact for longer. Resuming it carries on from where it
+  // is, without involving the handler.
+  if (receiver.active() && !receiver.completed()) {
+    if (resumes) {
+      receiver.Start(chunk.transfer_id,
+                     *handler.writer_,
+                     max_pending_bytes_,
+                     max_chunk_size_bytes_,
+                     receiver.offset());
+      SendWriteResponse(handler);
+      return;
+    }
+    FinishWrite(handler, Status::Aborted());
+  }
+
+  Status status = Status::Unimplemented();
+  uint64_t offset = 0;
+  if (resumes) {
+    Result<uint64_t> resume_offset = handler.PrepareResumeWrite();
+    status = resume_offset.status();
+    offset = resume_offset.value_or(0);
+  }
+
+  // Handlers that cannot resume writes start them over.
+  if (status.IsUnimplemented()) {
+    status = handler.PrepareWrite();
+  }
+  if (!status.ok()) {
+    SendStatus(write_stream_, chunk.transfer_id, status);
+    return;
+  }
+
+  handler.checkpoint_offset_ = offset;
+  receiver.Start(chunk.transfer_id,
+                 *handler.writer_,
+                 max_pending_bytes_,
+                 max_chunk_size_bytes_,
+                 offset);
+  SendWriteResponse(handler);
+}
+
+void TransferService::SendData(Handler& handler) {
+  internal::Transmitter& transmitter = handler.transmitter_;
+
+  while (transmitter.ReadyToSend() && read_stream_.open()) {
+    Result<ConstByteSpan> chunk =
+        transmitter.EncodeNextChunk(read_stream_.PayloadBuffer());
+    if (!chunk.ok()) {
+      FinishRead(handler, chunk.status());
+      SendStatus(read_stream_, handler.id(), chunk.status());
+      return;
+    }
+
+    // A chunk that could not be sent is lost like any other, and the client
+    // asks for it again.
+    if (!read_stream_.Write(chunk.value()).ok()) {
+      return;
+    }
+  }
+}
+
+void TransferService::SendWriteResponse(Handler& handler) {
+  internal::Receiver& receiver = handler.receiver_;
+  if (!receiver.response_pending() || !write_stream_.open()) {
+    return;
+  }
+
+  Result<ConstByteSpan> chunk =
+      receiver.EncodeResponse(write_stream_.PayloadBuffer());
+  if (chunk.ok()) {
+    write_stream_.Write(chunk.value());
+  }
+}
+
+void TransferService::FinishRead(Handler& handler, Status status) {
+  handler.transmitter_.Finish();
+  handler.FinalizeRead(status);
+}
+
+void TransferService::FinishWrite(Handler& handler, Status status) {
+  handler.receiver_.Finish();
+  handler.FinalizeWrite(status);
+}
+
+void TransferService::SendStatus(RawServerReaderWriter& stream,
+                                 uint32_t transfer_id,
+                                 Status status) {
+  if (!stream.open()) {
+    return;
+  }
+
+  Chunk chunk;
+  chunk.transfer_id = transfer_id;
+  chunk.status = status;
+
+  Result<ConstByteSpan> encoded =
+      internal::EncodeChunk(chunk, stream.PayloadBuffer());
+  if (encoded.ok()) {
+    stream.Write(encoded.value());
+  }
+}
+
+Handler* TransferService::FindHandler(uint32_t transfer_id) {
+  for (Handler& handler : handlers_) {
+    if (handler.id() == transfer_id) {
+      return &handler;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace pw::transfer
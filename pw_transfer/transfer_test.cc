@@ -0,0 +1,322 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_transfer/transfer.h"
+
+#include <array>
+#include <cstring>
+#include <optional>
+
+#include "gtest/gtest.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_transfer/client.h"
+#include "pw_transfer_private/test_loopback.h"
+
+namespace pw::transfer {
+namespace {
+
+constexpr uint32_t kMaxPendingBytes = 256;
+constexpr uint32_t kMaxChunkSizeBytes = 64;
+
+// A handler that records how its transfers ended.
+class TestHandler final : public ReadWriteHandler {
+ public:
+  TestHandler(uint32_t id,
+              stream::SeekableReader& reader,
+              stream::Writer& writer)
+      : ReadWriteHandler(id, reader, writer) {}
+
+  void FinalizeRead(Status status) override { read_status = status; }
+
+  Status FinalizeWrite(Status status) override {
+    write_status = status;
+    return finalize_write_result.value_or(status);
+  }
+
+  std::optional<Status> read_status;
+  std::optional<Status> write_status;
+  std::optional<Status> finalize_write_result;
+};
+
+// A handler that resumes writes from its last checkpoint. A real handler would
+// keep the checkpoint in persistent storage, such as a KVS.
+class ResumableHandler final : public WriteOnlyHandler {
+ public:
+  ResumableHandler(uint32_t id, stream::MemoryWriter& sink)
+      : WriteOnlyHandler(id, sink), sink_(sink) {}
+
+  Result<uint64_t> PrepareResumeWrite() override {
+    resumed_from = checkpoint;
+    if (Status status = sink_.Seek(checkpoint); !status.ok()) {
+      return status;
+    }
+    return checkpoint;
+  }
+
+  void CheckpointWrite(uint64_t offset) override { checkpoint = offset; }
+
+  uint64_t checkpoint = 0;
+  std::optional<uint64_t> resumed_from;
+
+ private:
+  stream::MemoryWriter& sink_;
+};
+
+template <size_t kSize>
+constexpr std::array<std::byte, kSize> MakeData() {
+  std::array<std::byte, kSize> data{};
+  for (size_t i = 0; i < kSize; ++i) {
+    data[i] = static_cast<std::byte>(i * 7 + 3);
+  }
+  return data;
+}
+
+constexpr auto kData = MakeData<1000>();
+
+// Spans a few checkpoints.
+constexpr auto kLargeData = MakeData<3 * cfg::kCheckpointIntervalBytes>();
+
+class TransferTest : public ::testing::Test {
+ protected:
+  TransferTest()
+      : loopback_(kMaxPendingBytes, kMaxChunkSizeBytes),
+        service_(loopback_.service()),
+        client_(loopback_.client()),
+        client_output_(loopback_.client_output()),
+        server_output_(loopback_.server_output()),
+        source_(kData),
+        sink_(sink_buffer_),
+        handler_(3, source_, sink_) {
+    service_.RegisterHandler(handler_);
+  }
+
+  void RunUntilIdle() { loopback_.RunUntilIdle(); }
+
+  void RunTransfers() {
+    loopback_.RunTransfers([this] { return result_.has_value(); });
+  }
+
+  Client::CompletionFunc RecordResult() {
+    return [this](Status status) { result_ = status; };
+  }
+
+  bool SinkHasData() const {
+    return sink_.bytes_written() == kData.size() &&
+           std::memcmp(sink_buffer_.data(), kData.data(), kData.size()) == 0;
+  }
+
+  test::TransferLoopback loopback_;
+  TransferService& service_;
+  Client& client_;
+  test::QueuedOutput& client_output_;
+  test::QueuedOutput& server_output_;
+
+  stream::MemoryReader source_;
+  std::array<std::byte, 1024> sink_buffer_;
+  stream::MemoryWriter sink_;
+  TestHandler handler_;
+
+  std::optional<Status> result_;
+};
+
+TEST_F(TransferTest, Read_SpansSeveralWindows) {
+  ASSERT_EQ(OkStatus(), client_.Read(3, sink_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  EXPECT_EQ(handler_.read_status, OkStatus());
+  EXPECT_TRUE(SinkHasData());
+}
+
+TEST_F(TransferTest, Write_SpansSeveralWindows) {
+  ASSERT_EQ(OkStatus(), client_.Write(3, source_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  EXPECT_EQ(handler_.write_status, OkStatus());
+  EXPECT_TRUE(SinkHasData());
+}
+
+TEST_F(TransferTest, Read_LossyLink_Recovers) {
+  server_output_.set_drop_interval(5);
+
+  ASSERT_EQ(OkStatus(), client_.Read(3, sink_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  EXPECT_TRUE(SinkHasData());
+}
+
+TEST_F(TransferTest, Write_LossyLink_Recovers) {
+  client_output_.set_drop_interval(5);
+  server_output_.set_drop_interval(3);
+
+  ASSERT_EQ(OkStatus(), client_.Write(3, source_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  EXPECT_EQ(handler_.write_status, OkStatus());
+  EXPECT_TRUE(SinkHasData());
+}
+
+TEST_F(TransferTest, Read_StreamOpenLost_ReopensStream) {
+  client_output_.DropPacket(1);
+
+  ASSERT_EQ(OkStatus(), client_.Read(3, sink_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  EXPECT_TRUE(SinkHasData());
+}
+
+TEST_F(TransferTest, Read_UnknownTransfer_NotFound) {
+  ASSERT_EQ(OkStatus(), client_.Read(99, sink_, RecordResult()));
+  RunUntilIdle();
+
+  EXPECT_EQ(result_, Status::NotFound());
+}
+
+TEST_F(TransferTest, Write_FinalizeWriteError_SentToClient) {
+  handler_.finalize_write_result = Status::DataLoss();
+
+  ASSERT_EQ(OkStatus(), client_.Write(3, source_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(handler_.write_status, OkStatus());
+  EXPECT_EQ(result_, Status::DataLoss());
+}
+
+TEST_F(TransferTest, Read_Cancel_EndsTransferOnBothSides) {
+  ASSERT_EQ(OkStatus(), client_.Read(3, sink_, RecordResult()));
+  client_.Cancel(3);
+  RunUntilIdle();
+
+  EXPECT_EQ(result_, Status::Cancelled());
+  EXPECT_EQ(handler_.read_status, Status::Cancelled());
+}
+
+TEST_F(TransferTest, Read_SameTransferTwice_FailedPrecondition) {
+  ASSERT_EQ(OkStatus(), client_.Read(3, sink_, RecordResult()));
+  EXPECT_EQ(Status::FailedPrecondition(),
+            client_.Read(3, sink_, RecordResult()));
+}
+
+TEST_F(TransferTest, Read_TooManyTransfers_ResourceExhausted) {
+  for (uint32_t id = 0; id < cfg::kClientMaxTransfers; ++id) {
+    ASSERT_EQ(OkStatus(), client_.Read(10 + id, sink_, RecordResult()));
+  }
+  EXPECT_EQ(Status::ResourceExhausted(),
+            client_.Read(3, sink_, RecordResult()));
+}
+
+TEST_F(TransferTest, Write_NoResponses_DeadlineExceeded) {
+  server_output_.set_drop_interval(1);
+
+  ASSERT_EQ(OkStatus(), client_.Write(3, source_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, Status::DeadlineExceeded());
+}
+
+TEST_F(TransferTest, Read_Resume_ContinuesFromOffset) {
+  constexpr size_t kReceived = 600;
+  std::memcpy(sink_buffer_.data(), kData.data(), kReceived);
+  stream::MemoryWriter partial_sink(sink_buffer_, kReceived);
+
+  ASSERT_EQ(OkStatus(),
+            client_.ResumeRead(3, kReceived, partial_sink, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  ASSERT_EQ(partial_sink.bytes_written(), kData.size());
+  EXPECT_EQ(std::memcmp(sink_buffer_.data(), kData.data(), kData.size()), 0);
+}
+
+TEST_F(TransferTest, Write_Resume_HandlerCannotResume_StartsOver) {
+  ASSERT_EQ(OkStatus(), client_.ResumeWrite(3, source_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  EXPECT_TRUE(SinkHasData());
+}
+
+class ResumeTest : public TransferTest {
+ protected:
+  ResumeTest()
+      : large_source_(kLargeData),
+        large_sink_buffer_{},
+        large_sink_(large_sink_buffer_),
+        resumable_handler_(7, large_sink_) {
+    service_.RegisterHandler(resumable_handler_);
+  }
+
+  bool LargeSinkHasData() const {
+    return large_sink_.bytes_written() == kLargeData.size() &&
+           std::memcmp(large_sink_buffer_.data(),
+                       kLargeData.data(),
+                       kLargeData.size()) == 0;
+  }
+
+  stream::MemoryReader large_source_;
+  std::array<std::byte, kLargeData.size()> large_sink_buffer_;
+  stream::MemoryWriter large_sink_;
+  ResumableHandler resumable_handler_;
+};
+
+TEST_F(ResumeTest, Write_ServerGaveUp_ResumesFromCheckpoint) {
+  // The link goes down two thirds of the way through, and both sides give up.
+  client_output_.DropFrom(kLargeData.size() * 2 / 3 / kMaxChunkSizeBytes);
+
+  ASSERT_EQ(OkStatus(), client_.Write(7, large_source_, RecordResult()));
+  loopback_.RunTransfers([] { return false; });
+
+  ASSERT_EQ(result_, Status::DeadlineExceeded());
+  const uint64_t checkpoint = resumable_handler_.checkpoint;
+  ASSERT_GE(checkpoint, cfg::kCheckpointIntervalBytes);
+
+  client_output_.DropFrom(0);
+  result_.reset();
+
+  ASSERT_EQ(OkStatus(), client_.ResumeWrite(7, large_source_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  EXPECT_EQ(resumable_handler_.resumed_from, checkpoint);
+  EXPECT_TRUE(LargeSinkHasData());
+}
+
+TEST_F(ResumeTest, Write_ServerStillRunning_ContinuesFromItsOffset) {
+  // The link goes down, so the client's cancellation never arrives and the
+  // server's write carries on waiting for data.
+  client_output_.DropFrom(kLargeData.size() / 2 / kMaxChunkSizeBytes);
+
+  ASSERT_EQ(OkStatus(), client_.Write(7, large_source_, RecordResult()));
+  RunUntilIdle();
+  client_.Cancel(7);
+  RunUntilIdle();
+
+  ASSERT_EQ(result_, Status::Cancelled());
+  client_output_.DropFrom(0);
+  result_.reset();
+
+  ASSERT_EQ(OkStatus(), client_.ResumeWrite(7, large_source_, RecordResult()));
+  RunTransfers();
+
+  EXPECT_EQ(result_, OkStatus());
+  EXPECT_FALSE(resumable_handler_.resumed_from.has_value());
+  EXPECT_TRUE(LargeSinkHasData());
+}
+
+}  // namespace
+}  // namespace pw::transfer
@@ -0,0 +1,135 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_transfer/internal/transmitter.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "pw_assert/assert.h"
+#include "pw_status/try.h"
+#include "pw_transfer/internal/config.h"
+
+namespace pw::transfer::internal {
+
+void Transmitter::Start(uint32_t transfer_id, stream::SeekableReader& reader) {
+  reader_ = &reader;
+  transfer_id_ = transfer_id;
+  offset_ = reader.Tell();
+  window_end_offset_ = offset_;
+  max_chunk_size_bytes_ = 0;
+  parameters_received_ = false;
+  sent_final_chunk_ = false;
+  chunk_received_ = false;
+  retries_ = 0;
+}
+
+Status Transmitter::HandleParameters(const Chunk& parameters) {
+  chunk_received_ = true;
+
+  if (!parameters.pending_bytes.has_value()) {
+    return Status::InvalidArgument();
+  }
+
+  parameters_received_ = true;
+
+  if (parameters.max_chunk_size_bytes.has_value()) {
+    max_chunk_size_bytes_ = parameters.max_chunk_size_bytes.value();
+  }
+
+  // Continue parameters extend the window from the receiver's offset. Chunks
+  // sent past that offset are still in flight, so they are not sent again.
+  // Any other parameters ask for data from their offset, which may go back to
+  // data that was lost, or even to the final chunk.
+  if (parameters.type != Chunk::Type::kParametersContinue) {
+    if (parameters.offset != offset_) {
+      PW_TRY(reader_->Seek(static_cast<ptrdiff_t>(parameters.offset)));
+      offset_ = parameters.offset;
+    }
+    sent_final_chunk_ = false;
+  }
+
+  window_end_offset_ = parameters.offset + parameters.pending_bytes.value();
+  return OkStatus();
+}
+
+Status Transmitter::RetryIfStalled() {
+  // The transfer is stalled if it is waiting for the receiver, and nothing
+  // arrived from the receiver since the previous call.
+  if (std::exchange(chunk_received_, false) || ReadyToSend()) {
+    retries_ = 0;
+    return OkStatus();
+  }
+
+  if (retries_ >= cfg::kMaxRetries) {
+    return Status::DeadlineExceeded();
+  }
+  retries_ += 1;
+
+  // The reader is at its end, so the next chunk is an empty final chunk. The
+  // window is extended so that it is sent even if the window is used up.
+  if (sent_final_chunk_) {
+    sent_final_chunk_ = false;
+    window_end_offset_ = std::max(window_end_offset_, offset_ + 1);
+  }
+  return OkStatus();
+}
+
+Result<ConstByteSpan> Transmitter::EncodeNextChunk(ByteSpan buffer) {
+  PW_DASSERT(ReadyToSend());
+
+  if (buffer.size() <= kMaxChunkOverheadBytes) {
+    return Status::ResourceExhausted();
+  }
+
+  size_t max_data_bytes = std::min<uint64_t>(
+      buffer.size() - kMaxChunkOverheadBytes, window_end_offset_ - offset_);
+  if (max_chunk_size_bytes_ != 0u) {
+    max_data_bytes = std::min<size_t>(max_data_bytes, max_chunk_size_bytes_);
+  }
+
+  Chunk chunk;
+  chunk.transfer_id = transfer_id_;
+  chunk.offset = offset_;
+
+  // Data is read straight into the buffer.
+  const ByteSpan payload = DataChunkPayload(buffer, max_data_bytes);
+  Result<ByteSpan> data = reader_->Read(payload);
+
+  if (data.ok()) {
+    chunk.data = data.value();
+  } else if (!data.status().IsOutOfRange()) {
+    return data.status();
+  }
+
+  // Flag the final chunk as soon as the reader knows it has run out, rather
+  // than sending an extra empty chunk.
+  if (!data.ok() || reader_->ConservativeReadLimit() == 0u) {
+    chunk.remaining_bytes = 0;
+    sent_final_chunk_ = true;
+  }
+
+  if (chunk.data.empty()) {
+    chunk.data = payload.first(0);
+  }
+
+  Result<ConstByteSpan> encoded =
+      EncodeDataChunk(chunk, buffer, max_data_bytes);
+  if (encoded.ok()) {
+    offset_ += chunk.data.size();
+  }
+  return encoded;
+}
+
+}  // namespace pw::transfer::internal
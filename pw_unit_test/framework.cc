@@ -56,7 +56,12 @@ int Framework::RunAllTests() {
   if (event_handler_ != nullptr) {
     event_handler_->RunAllTestsStart();
   }
+  size_t test_index = 0;
   for (const TestInfo* test = tests_; test != nullptr; test = test->next()) {
+    if (in_shard_ != nullptr && !in_shard_(test_index++)) {
+      continue;
+    }
+
     if (ShouldRunTest(*test)) {
       test->run();
     } else if (!test->enabled()) {
@@ -124,6 +129,12 @@ void Framework::ExpectationResult(const char* expression,
   event_handler_->TestCaseExpect(current_test_->test_case(), expectation);
 }
 
+void Framework::RecordBenchmark(const BenchmarkResult& result) {
+  if (event_handler_ != nullptr) {
+    event_handler_->TestCaseBenchmark(current_test_->test_case(), result);
+  }
+}
+
 bool Framework::ShouldRunTest(const TestInfo& test_info) {
 #if PW_CXX_STANDARD_IS_SUPPORTED(17)
   // Test suite filtering is only supported if using C++17.
@@ -79,6 +79,20 @@ void LoggingEventHandler::TestCaseExpect(const TestCase& test_case,
          expectation.evaluated_expression);
 }
 
+void LoggingEventHandler::TestCaseBenchmark(const TestCase& test_case,
+                                            const BenchmarkResult& result) {
+  // Report the time per iteration to a tenth of a unit.
+  const unsigned long long tenths =
+      result.iterations == 0 ? 0 : result.total_time * 10 / result.iterations;
+  PW_LOG_INFO("[    BENCH ] %s.%s: %llu.%llu %s/iteration (%u iterations)",
+              test_case.suite_name,
+              test_case.test_name,
+              tenths / 10,
+              tenths % 10,
+              result.time_units,
+              static_cast<unsigned>(result.iterations));
+}
+
 void LoggingEventHandler::TestCaseDisabled(const TestCase& test) {
   PW_LOG_DEBUG("Skipping disabled test %s.%s", test.suite_name, test.test_name);
 }
@@ -0,0 +1,42 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <cstdlib>
+#include <span>
+#include <string_view>
+#include <thread>
+
+#include "pw_sys_io/sys_io.h"
+#include "pw_unit_test/parallel_runner.h"
+#include "pw_unit_test/simple_printing_event_handler.h"
+
+int main() {
+  pw::unit_test::SimplePrintingEventHandler handler(
+      [](const std::string_view& s, bool append_newline) {
+        if (append_newline) {
+          pw::sys_io::WriteLine(s);
+        } else {
+          pw::sys_io::WriteBytes(std::as_bytes(std::span(s)));
+        }
+      });
+
+  // The number of test processes may be set with PW_UNIT_TEST_JOBS, and
+  // defaults to the number of hardware threads.
+  unsigned jobs = std::thread::hardware_concurrency();
+  if (const char* value = std::getenv("PW_UNIT_TEST_JOBS"); value != nullptr) {
+    jobs = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+  }
+
+  return pw::unit_test::RunAllTestsInParallel(handler, jobs);
+}
@@ -0,0 +1,467 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_unit_test/parallel_runner.h"
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <span>
+#include <vector>
+
+#include "pw_unit_test/framework.h"
+
+namespace pw::unit_test {
+namespace {
+
+// Test processes send their events to the parent as records: a header
+// followed by size bytes of fixed fields and then NUL-terminated strings. The
+// processes run the same executable, so the fields are sent as they are laid
+// out in memory.
+enum class EventType : uint32_t {
+  kTestCaseStart,
+  kTestCaseEnd,
+  kTestCaseDisabled,
+  kTestCaseExpect,
+  kTestCaseBenchmark,
+  kRunAllTestsEnd,
+};
+
+struct RecordHeader {
+  uint32_t size;
+  EventType type;
+};
+
+struct ExpectFields {
+  int32_t line_number;
+  uint32_t success;
+};
+
+struct BenchmarkFields {
+  uint64_t total_time;
+  uint32_t iterations;
+};
+
+// The next test to be claimed by a test process. This is shared by all of the
+// test processes.
+std::atomic<uint32_t>* next_test;
+
+// The test this process claimed, if any.
+bool has_claimed_test = false;
+uint32_t claimed_test;
+
+// Claims tests for the process one at a time. The processes see the tests in
+// the same order, so the process that claims a test runs it when it reaches
+// it. A process always holds a claim at or after the test it is on.
+bool ClaimTest(size_t test_index) {
+  if (!has_claimed_test) {
+    claimed_test = next_test->fetch_add(1, std::memory_order_relaxed);
+    has_claimed_test = true;
+  }
+
+  if (claimed_test != test_index) {
+    return false;
+  }
+
+  has_claimed_test = false;
+  return true;
+}
+
+// Sends the events of a test process to the parent over a pipe.
+class PipeEventHandler final : public EventHandler {
+ public:
+  explicit PipeEventHandler(int fd) : fd_(fd) {}
+
+  void RunAllTestsStart() override {}
+
+  void RunAllTestsEnd(const RunTestsSummary& summary) override {
+    Send(EventType::kRunAllTestsEnd, &summary, sizeof(summary), {});
+  }
+
+  void TestCaseStart(const TestCase& test_case) override {
+    SendTestCase(EventType::kTestCaseStart, test_case);
+  }
+
+  void TestCaseEnd(const TestCase&, TestResult result) override {
+    Send(EventType::kTestCaseEnd, &result, sizeof(result), {});
+  }
+
+  void TestCaseDisabled(const TestCase& test_case) override {
+    SendTestCase(EventType::kTestCaseDisabled, test_case);
+  }
+
+  void TestCaseExpect(const TestCase&,
+                      const TestExpectation& expectation) override {
+    const ExpectFields fields = {
+        .line_number = expectation.line_number,
+        .success = expectation.success,
+    };
+    const char* strings[] = {expectation.expression,
+                             expectation.evaluated_expression};
+    Send(EventType::kTestCaseExpect, &fields, sizeof(fields), strings);
+  }
+
+  void TestCaseBenchmark(const TestCase&,
+                         const BenchmarkResult& result) override {
+    const BenchmarkFields fields = {
+        .total_time = result.total_time,
+        .iterations = result.iterations,
+    };
+    const char* strings[] = {result.time_units};
+    Send(EventType::kTestCaseBenchmark, &fields, sizeof(fields), strings);
+  }
+
+ private:
+  void SendTestCase(EventType type, const TestCase& test_case) {
+    const char* strings[] = {
+        test_case.suite_name, test_case.test_name, test_case.file_name};
+    Send(type, nullptr, 0, strings);
+  }
+
+  void Send(EventType type,
+            const void* fields,
+            size_t fields_size,
+            std::span<const char* const> strings) {
+    buffer_.clear();
+    buffer_.resize(sizeof(RecordHeader) + fields_size);
+    if (fields_size != 0u) {
+      std::memcpy(&buffer_[sizeof(RecordHeader)], fields, fields_size);
+    }
+    for (const char* string : strings) {
+      buffer_.insert(buffer_.end(), string, string + std::strlen(string) + 1);
+    }
+
+    const RecordHeader header = {
+        .size = static_cast<uint32_t>(buffer_.size() - sizeof(RecordHeader)),
+        .type = type,
+    };
+    std::memcpy(buffer_.data(), &header, sizeof(header));
+
+    for (size_t written = 0; written < buffer_.size();) {
+      const ssize_t result =
+          write(fd_, &buffer_[written], buffer_.size() - written);
+      if (result < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        std::_Exit(EXIT_FAILURE);  // The parent is gone.
+      }
+      written += static_cast<size_t>(result);
+    }
+  }
+
+  int fd_;
+  std::vector<char> buffer_;
+};
+
+// Receives the events of one test process and sends them to the handler a
+// test at a time.
+class TestProcess {
+ public:
+  TestProcess(pid_t pid, int fd) : pid_(pid), fd_(fd) {}
+
+  pid_t pid() const { return pid_; }
+  int fd() const { return fd_; }
+
+  // Reads the events that are available from the process and dispatches those
+  // of each test that has ended. Returns false when the process closed its
+  // end of the pipe.
+  bool Receive(EventHandler& handler, RunTestsSummary& summary) {
+    char chunk[4096];
+    const ssize_t result = read(fd_, chunk, sizeof(chunk));
+    if (result < 0) {
+      return errno == EINTR || errno == EAGAIN;
+    }
+    if (result == 0) {
+      close(fd_);
+      fd_ = -1;
+      return false;
+    }
+
+    received_.insert(received_.end(), chunk, chunk + result);
+    DispatchEndedTests(handler, summary);
+    return true;
+  }
+
+  // Reports the test that was running when the process ended, if any, as a
+  // failure. Returns whether the process completed its test run.
+  bool Finish(EventHandler& handler, RunTestsSummary& summary) {
+    if (!received_.empty()) {
+      // Dispatch the events of the test as far as it got.
+      size_t end = 0;
+      while (RecordAt(end) != nullptr) {
+        end += sizeof(RecordHeader) + RecordAt(end)->size;
+      }
+      const TestCase test_case = Dispatch(handler, summary, end);
+
+      const TestExpectation expectation = {
+          .expression = "(test process exited during the test)",
+          .evaluated_expression = "(test process exited during the test)",
+          .line_number = 0,
+          .success = false,
+      };
+      handler.TestCaseExpect(test_case, expectation);
+      handler.TestCaseEnd(test_case, TestResult::kFailure);
+      summary.failed_tests += 1;
+      received_.clear();
+    }
+    return completed_;
+  }
+
+ private:
+  // Returns the header of the complete record at the offset, if there is one.
+  const RecordHeader* RecordAt(size_t offset) const {
+    if (received_.size() - offset < sizeof(RecordHeader)) {
+      return nullptr;
+    }
+    const auto* header =
+        reinterpret_cast<const RecordHeader*>(&received_[offset]);
+    if (received_.size() - offset - sizeof(RecordHeader) < header->size) {
+      return nullptr;
+    }
+    return header;
+  }
+
+  void DispatchEndedTests(EventHandler& handler, RunTestsSummary& summary) {
+    // Find the end of the last record that ends a test, or that is not part of
+    // a test, and dispatch everything before it.
+    size_t offset = 0;
+    size_t end = 0;
+    for (const RecordHeader* header; (header = RecordAt(offset)) != nullptr;) {
+      offset += sizeof(RecordHeader) + header->size;
+      if (header->type != EventType::kTestCaseStart &&
+          header->type != EventType::kTestCaseExpect &&
+          header->type != EventType::kTestCaseBenchmark) {
+        end = offset;
+      }
+    }
+
+    if (end != 0u) {
+      Dispatch(handler, summary, end);
+      received_.erase(received_.begin(), received_.begin() + end);
+    }
+  }
+
+  // Dispatches the records before the end offset, and returns the test case
+  // that was running at the end.
+  TestCase Dispatch(EventHandler& handler,
+                    RunTestsSummary& summary,
+                    size_t end) {
+    // The current test case's strings point into received_, which is not
+    // modified until the records are dispatched.
+    TestCase test_case = {};
+
+    for (size_t offset = 0; offset < end;) {
+      const RecordHeader& header =
+          *reinterpret_cast<const RecordHeader*>(&received_[offset]);
+      const char* fields = &received_[offset + sizeof(RecordHeader)];
+      offset += sizeof(RecordHeader) + header.size;
+
+      switch (header.type) {
+        case EventType::kTestCaseStart:
+          test_case = ReadTestCase(fields);
+          handler.TestCaseStart(test_case);
+          break;
+        case EventType::kTestCaseEnd: {
+          TestResult result;
+          std::memcpy(&result, fields, sizeof(result));
+          if (result == TestResult::kSuccess) {
+            summary.passed_tests += 1;
+          } else {
+            summary.failed_tests += 1;
+          }
+          handler.TestCaseEnd(test_case, result);
+          break;
+        }
+        case EventType::kTestCaseDisabled:
+          summary.disabled_tests += 1;
+          handler.TestCaseDisabled(ReadTestCase(fields));
+          break;
+        case EventType::kTestCaseExpect: {
+          ExpectFields expect;
+          std::memcpy(&expect, fields, sizeof(expect));
+          const char* expression = fields + sizeof(expect);
+          const TestExpectation expectation = {
+              .expression = expression,
+              .evaluated_expression = expression + std::strlen(expression) + 1,
+              .line_number = expect.line_number,
+              .success = expect.success != 0u,
+          };
+          handler.TestCaseExpect(test_case, expectation);
+          break;
+        }
+        case EventType::kTestCaseBenchmark: {
+          BenchmarkFields benchmark;
+          std::memcpy(&benchmark, fields, sizeof(benchmark));
+          const BenchmarkResult result = {
+              .iterations = benchmark.iterations,
+              .total_time = benchmark.total_time,
+              .time_units = fields + sizeof(benchmark),
+          };
+          handler.TestCaseBenchmark(test_case, result);
+          break;
+        }
+        case EventType::kRunAllTestsEnd: {
+          // Passed, failed, and disabled tests are counted as they are
+          // dispatched. Only tests skipped by the suite filter are not sent.
+          RunTestsSummary process_summary;
+          std::memcpy(&process_summary, fields, sizeof(process_summary));
+          summary.skipped_tests += process_summary.skipped_tests;
+          completed_ = true;
+          break;
+        }
+      }
+    }
+    return test_case;
+  }
+
+  static TestCase ReadTestCase(const char* strings) {
+    TestCase test_case;
+    test_case.suite_name = strings;
+    test_case.test_name = strings + std::strlen(strings) + 1;
+    test_case.file_name =
+        test_case.test_name + std::strlen(test_case.test_name) + 1;
+    return test_case;
+  }
+
+  pid_t pid_;
+  int fd_;
+  bool completed_ = false;
+  std::vector<char> received_;
+};
+
+// Runs this process's share of the tests and exits.
+[[noreturn]] void RunTestProcess(int fd) {
+  PipeEventHandler handler(fd);
+  internal::Framework& framework = internal::Framework::Get();
+  framework.RegisterEventHandler(&handler);
+  framework.SetShardFunction(ClaimTest);
+
+  const int status = framework.RunAllTests();
+  std::fflush(nullptr);
+  std::_Exit(status);
+}
+
+}  // namespace
+
+int RunAllTestsInParallel(EventHandler& handler, unsigned jobs) {
+  if (jobs <= 1u) {
+    RegisterEventHandler(&handler);
+    return RUN_ALL_TESTS();
+  }
+
+  void* shared = mmap(nullptr,
+                      sizeof(std::atomic<uint32_t>),
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS,
+                      -1,
+                      0);
+  if (shared == MAP_FAILED) {
+    std::perror("Failed to map memory for parallel tests");
+    return EXIT_FAILURE;
+  }
+  next_test = new (shared) std::atomic<uint32_t>(0);
+
+  // Output buffered before the fork would otherwise be written by every test
+  // process too.
+  std::fflush(nullptr);
+
+  std::vector<TestProcess> processes;
+  int exit_status = 0;
+
+  for (unsigned i = 0; i < jobs; ++i) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+      std::perror("Failed to create a pipe for a test process");
+      exit_status = EXIT_FAILURE;
+      break;
+    }
+
+    const pid_t pid = fork();
+    if (pid < 0) {
+      std::perror("Failed to start a test process");
+      close(fds[0]);
+      close(fds[1]);
+      exit_status = EXIT_FAILURE;
+      break;
+    }
+
+    if (pid == 0) {
+      close(fds[0]);
+      for (const TestProcess& process : processes) {
+        close(process.fd());
+      }
+      RunTestProcess(fds[1]);
+    }
+
+    close(fds[1]);
+    processes.emplace_back(pid, fds[0]);
+  }
+
+  RunTestsSummary summary = {};
+  handler.RunAllTestsStart();
+
+  std::vector<pollfd> fds;
+  while (true) {
+    fds.clear();
+    for (const TestProcess& process : processes) {
+      if (process.fd() >= 0) {
+        fds.push_back({.fd = process.fd(), .events = POLLIN, .revents = 0});
+      }
+    }
+    if (fds.empty()) {
+      break;
+    }
+
+    if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) {
+      std::perror("Failed to wait for test processes");
+      std::exit(EXIT_FAILURE);
+    }
+
+    for (TestProcess& process : processes) {
+      for (const pollfd& fd : fds) {
+        if (fd.fd == process.fd() && fd.revents != 0) {
+          process.Receive(handler, summary);
+        }
+      }
+    }
+  }
+
+  for (TestProcess& process : processes) {
+    int status;
+    while (waitpid(process.pid(), &status, 0) < 0 && errno == EINTR) {
+    }
+
+    const bool completed = process.Finish(handler, summary);
+    if (!completed || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      exit_status = EXIT_FAILURE;
+    }
+  }
+
+  handler.RunAllTestsEnd(summary);
+  munmap(shared, sizeof(std::atomic<uint32_t>));
+  return exit_status;
+}
+
+}  // namespace pw::unit_test
@@ -13,6 +13,8 @@
 // the License.
 #pragma once
 
+#include <cstdint>
+
 namespace pw {
 namespace unit_test {
 
@@ -78,6 +80,17 @@ struct TestExpectation {
   bool success;
 };
 
+struct BenchmarkResult {
+  // The number of iterations of the benchmark loop that were timed.
+  uint32_t iterations;
+
+  // The total time taken by the timed iterations.
+  uint64_t total_time;
+
+  // The unit of total_time, such as "ns" or "cycles".
+  const char* time_units;
+};
+
 struct RunTestsSummary {
   // The number of passed tests among the run tests.
   int passed_tests;
@@ -119,6 +132,9 @@ class EventHandler {
   // result of the expectation.
   virtual void TestCaseExpect(const TestCase& test_case,
                               const TestExpectation& expectation) = 0;
+
+  // Called when a benchmark within a test case reports its timing.
+  virtual void TestCaseBenchmark(const TestCase&, const BenchmarkResult&) {}
 };
 
 // Sets the event handler for a test run. Must be called before RUN_ALL_TESTS()
@@ -164,6 +164,7 @@ class Framework {
                            .disabled_tests = 0},
         exit_status_(0),
         event_handler_(nullptr),
+        in_shard_(nullptr),
         memory_pool_() {}
 
   static Framework& Get() { return framework_; }
@@ -192,6 +193,15 @@ class Framework {
   }
 #endif  // PW_CXX_STANDARD_IS_SUPPORTED(17)
 
+  // Sets a function which decides whether this process runs each registered
+  // test, given the test's index in registration order. Tests for which it
+  // returns false are left to another process and are not reported at all.
+  // The function is called for each test in order, once per run. Used to
+  // split a test run across processes; by default every test is run.
+  void SetShardFunction(bool (*in_shard)(size_t test_index)) {
+    in_shard_ = in_shard;
+  }
+
   bool ShouldRunTest(const TestInfo& test_info);
 
   // Constructs an instance of a unit test class and runs the test.
@@ -268,6 +278,9 @@ class Framework {
                          int line,
                          bool success);
 
+  // Dispatches an event with the timing of a benchmark in the current test.
+  void RecordBenchmark(const BenchmarkResult& result);
+
  private:
   // Sets current_test_ and dispatches an event indicating that a test started.
   void StartTest(const TestInfo& test);
@@ -297,6 +310,9 @@ class Framework {
   // Handler to which to dispatch test events.
   EventHandler* event_handler_;
 
+  // Decides which tests this process runs, if set.
+  bool (*in_shard_)(size_t test_index);
+
 #if PW_CXX_STANDARD_IS_SUPPORTED(17)
   std::span<std::string_view> test_suites_to_run_;
 #endif  // PW_CXX_STANDARD_IS_SUPPORTED(17)
@@ -0,0 +1,38 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_unit_test/event_handler.h"
+
+namespace pw::unit_test {
+
+// Runs all registered tests across a number of forked test processes, and
+// returns a status of 0 if all succeeded or nonzero if there were any
+// failures. This is only available on POSIX hosts.
+//
+// Each process takes the next test that has not been run until all tests have
+// run, so long tests do not hold up the rest. The events of each test are
+// buffered and sent to the handler together once the test ends, so the output
+// of concurrent tests is not interleaved. A test whose process crashes is
+// reported as failed, but the tests run by other processes still complete.
+//
+// Tests run concurrently in separate processes, so they must not share
+// resources outside of the process, such as files or sockets. Output that
+// tests write directly, such as logs, is not buffered.
+//
+// With jobs set to 1 or less, the tests run in this process, as with
+// RUN_ALL_TESTS().
+int RunAllTestsInParallel(EventHandler& handler, unsigned jobs);
+
+}  // namespace pw::unit_test
@@ -48,6 +48,7 @@ class UnitTestService final : public generated::UnitTest<UnitTestService> {
   void WriteTestCaseEnd(TestResult result);
   void WriteTestCaseDisabled(const TestCase& test_case);
   void WriteTestCaseExpectation(const TestExpectation& expectation);
+  void WriteTestCaseBenchmark(const BenchmarkResult& result);
 
   internal::RpcEventHandler handler_;
   RawServerWriter writer_;
@@ -52,6 +52,20 @@ class TestExpectation:
         return f'TestExpectation({str(self)})'
 
 
+@dataclass(frozen=True)
+class BenchmarkResult:
+    iterations: int
+    total_time: int
+    time_units: str
+
+    def time_per_iteration(self) -> float:
+        return self.total_time / self.iterations if self.iterations else 0.0
+
+    def __str__(self) -> str:
+        return (f'{self.time_per_iteration():.1f} {self.time_units}/iteration '
+                f'({self.iterations} iterations)')
+
+
 class EventHandler(abc.ABC):
     @abc.abstractmethod
     def run_all_tests_start(self):
@@ -78,6 +92,10 @@ class EventHandler(abc.ABC):
                          expectation: TestExpectation):
         """Called after each expect/assert statement within a test case."""
 
+    def test_case_benchmark(self, test_case: TestCase,
+                            result: BenchmarkResult):
+        """Called when a benchmark within a test case reports its timing."""
+
 
 class LoggingEventHandler(EventHandler):
     """Event handler that logs test events using Google Test format."""
@@ -110,6 +128,10 @@ class LoggingEventHandler(EventHandler):
         log('      Expected: %s', expectation.expression)
         log('        Actual: %s', expectation.evaluated_expression)
 
+    def test_case_benchmark(self, test_case: TestCase,
+                            result: BenchmarkResult):
+        _LOG.info('[    BENCH ] %s: %s', test_case, result)
+
 
 def run_tests(rpcs: pw_rpc.client.Services,
               report_passed_expectations: bool = False,
@@ -174,5 +196,12 @@ def run_tests(rpcs: pw_rpc.client.Services,
                     raw_expectation.success,
                 )
                 event_handler.test_case_expect(current_test_case, expectation)
+            elif response.HasField('test_case_benchmark'):
+                raw_benchmark = response.test_case_benchmark
+                event_handler.test_case_benchmark(
+                    current_test_case,
+                    BenchmarkResult(raw_benchmark.iterations,
+                                    raw_benchmark.total_time,
+                                    raw_benchmark.time_units))
 
     return all_tests_passed
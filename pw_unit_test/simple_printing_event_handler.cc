@@ -66,6 +66,20 @@ void SimplePrintingEventHandler::TestCaseExpect(
   write_(expectation.evaluated_expression, true);
 }
 
+void SimplePrintingEventHandler::TestCaseBenchmark(
+    const TestCase& test_case, const BenchmarkResult& result) {
+  // Report the time per iteration to a tenth of a unit.
+  const unsigned long long tenths =
+      result.iterations == 0 ? 0 : result.total_time * 10 / result.iterations;
+  WriteLine("[    BENCH ] %s.%s: %llu.%llu %s/iteration (%u iterations)",
+            test_case.suite_name,
+            test_case.test_name,
+            tenths / 10,
+            tenths % 10,
+            result.time_units,
+            static_cast<unsigned>(result.iterations));
+}
+
 void SimplePrintingEventHandler::WriteLine(const char* format, ...) {
   va_list args;
 
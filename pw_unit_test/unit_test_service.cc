@@ -139,4 +139,14 @@ void UnitTestService::WriteTestCaseExpectation(
   });
 }
 
+void UnitTestService::WriteTestCaseBenchmark(const BenchmarkResult& result) {
+  WriteEvent([&](Event::Encoder& event) {
+    TestCaseBenchmark::Encoder test_case_benchmark =
+        event.GetTestCaseBenchmarkEncoder();
+    test_case_benchmark.WriteIterations(result.iterations);
+    test_case_benchmark.WriteTotalTime(result.total_time);
+    test_case_benchmark.WriteTimeUnits(result.time_units);
+  });
+}
+
 }  // namespace pw::unit_test
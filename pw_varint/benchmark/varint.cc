@@ -0,0 +1,121 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures varint encoding and decoding. The standard (protobuf) format has
+// dedicated fast paths; the custom formats use the generic implementation and
+// are included for comparison. Decoding is measured both with at least 10 bytes
+// of input, which needs no bounds checks, and with input that ends right after
+// each varint. Build for a device target to measure on Cortex-M.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_varint/varint.h"
+
+namespace {
+
+using pw::varint::Format;
+
+constexpr size_t kValues = 1024;
+constexpr size_t kIterations = 200;
+constexpr int64_t kTotalValues = kValues * kIterations;
+
+std::array<uint64_t, kValues> values;
+std::array<std::byte, kValues * pw::varint::kMaxVarint64SizeBytes> encoded;
+std::array<uint8_t, kValues> sizes;
+
+template <typename Function>
+void Measure(const char* name, Function function) {
+  const auto start = pw::chrono::SystemClock::now();
+  for (size_t i = 0; i < kIterations; ++i) {
+    function();
+  }
+  const auto elapsed = pw::chrono::SystemClock::now() - start;
+
+  const auto picoseconds =
+      std::chrono::duration_cast<std::chrono::duration<int64_t, std::pico>>(
+          elapsed);
+  PW_LOG_INFO("%-32s %8ld ps/value",
+              name,
+              static_cast<long>(picoseconds.count() / kTotalValues));
+}
+
+// Encodes each value in its own 10-byte slot.
+void EncodeAll(Format format) {
+  for (size_t i = 0; i < kValues; ++i) {
+    const size_t size = pw::varint::Encode(
+        values[i],
+        std::span(encoded).subspan(i * pw::varint::kMaxVarint64SizeBytes,
+                                   pw::varint::kMaxVarint64SizeBytes),
+        format);
+    sizes[i] = static_cast<uint8_t>(size);
+  }
+}
+
+void DecodeAll(Format format, bool exact_size) {
+  for (size_t i = 0; i < kValues; ++i) {
+    std::span<const std::byte> input = std::span(encoded).subspan(
+        i * pw::varint::kMaxVarint64SizeBytes,
+        exact_size ? sizes[i] : pw::varint::kMaxVarint64SizeBytes);
+    uint64_t value;
+    PW_CHECK_UINT_EQ(pw::varint::Decode(input, &value, format), sizes[i]);
+    PW_CHECK_UINT_EQ(value, values[i]);
+  }
+}
+
+struct FormatInfo {
+  const char* name;
+  Format format;
+};
+
+constexpr FormatInfo kFormats[] = {
+    {"standard", Format::kZeroTerminatedMostSignificant},
+    {"custom", Format::kOneTerminatedLeastSignificant},
+};
+
+}  // namespace
+
+int main() {
+  // Use a mix of sizes, weighted towards small values as in typical protobufs.
+  uint64_t state = 1;
+  for (uint64_t& value : values) {
+    state = state * 6364136223846793005u + 1442695040888963407u;
+    value = state >> (state % 64);
+  }
+
+  PW_LOG_INFO("Encoding and decoding %u varints %u times",
+              static_cast<unsigned>(kValues),
+              static_cast<unsigned>(kIterations));
+
+  char name[48];
+  for (const FormatInfo& format : kFormats) {
+    std::snprintf(name, sizeof(name), "%s encode", format.name);
+    Measure(name, [&format] { EncodeAll(format.format); });
+
+    std::snprintf(name, sizeof(name), "%s decode", format.name);
+    Measure(name, [&format] { DecodeAll(format.format, false); });
+
+    std::snprintf(name, sizeof(name), "%s decode (exact size)", format.name);
+    Measure(name, [&format] { DecodeAll(format.format, true); });
+  }
+
+  return 0;
+}
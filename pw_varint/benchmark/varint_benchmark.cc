@@ -0,0 +1,66 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Encodes and decodes varints of the smallest, a typical, and the largest
+// encoded size.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_benchmark/benchmark.h"
+#include "pw_varint/varint.h"
+
+namespace pw::varint {
+namespace {
+
+using benchmark::DoNotOptimize;
+using benchmark::State;
+
+constexpr uint64_t kOneByte = 0x7f;
+constexpr uint64_t kFiveBytes = 0xffffffff;
+constexpr uint64_t kTenBytes = 0xffffffffffffffff;
+
+void MeasureEncode(State& state, uint64_t value) {
+  std::array<std::byte, kMaxVarint64SizeBytes> buffer;
+  for (auto _ : state) {
+    DoNotOptimize(value);
+    DoNotOptimize(Encode(value, buffer));
+    DoNotOptimize(buffer);
+  }
+}
+
+void MeasureDecode(State& state, uint64_t value) {
+  std::array<std::byte, kMaxVarint64SizeBytes> buffer;
+  const size_t size = Encode(value, buffer);
+  const std::span<const std::byte> encoded(buffer.data(), size);
+
+  uint64_t decoded;
+  for (auto _ : state) {
+    DoNotOptimize(buffer);
+    DoNotOptimize(Decode(encoded, &decoded));
+    DoNotOptimize(decoded);
+  }
+}
+
+PW_BENCHMARK(Varint, Encode_1Byte) { MeasureEncode(state, kOneByte); }
+PW_BENCHMARK(Varint, Encode_5Bytes) { MeasureEncode(state, kFiveBytes); }
+PW_BENCHMARK(Varint, Encode_10Bytes) { MeasureEncode(state, kTenBytes); }
+
+PW_BENCHMARK(Varint, Decode_1Byte) { MeasureDecode(state, kOneByte); }
+PW_BENCHMARK(Varint, Decode_5Bytes) { MeasureDecode(state, kFiveBytes); }
+PW_BENCHMARK(Varint, Decode_10Bytes) { MeasureDecode(state, kTenBytes); }
+
+}  // namespace
+}  // namespace pw::varint
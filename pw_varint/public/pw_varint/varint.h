@@ -221,6 +221,26 @@ constexpr uint64_t MaxValueInBytes(size_t bytes) {
                                         : (uint64_t(1) << (7 * bytes)) - 1;
 }
 
+// Encodes an unsigned integer as a varint that fills the output exactly,
+// padding it with continuation bytes. A padded varint decodes to the same
+// value, so space for a value such as a length can be reserved before the
+// value is known.
+//
+// Returns output.size(), or 0 if the output is empty, longer than
+// kMaxVarint64SizeBytes, or too short for the value.
+inline size_t EncodePadded(uint64_t integer, std::span<std::byte> output) {
+  if (output.empty() || output.size() > kMaxVarint64SizeBytes ||
+      integer > MaxValueInBytes(output.size())) {
+    return 0;
+  }
+  for (size_t i = 0; i + 1 < output.size(); ++i) {
+    output[i] = static_cast<std::byte>((integer & 0x7f) | 0x80);
+    integer >>= 7;
+  }
+  output.back() = static_cast<std::byte>(integer);
+  return output.size();
+}
+
 }  // namespace varint
 }  // namespace pw
 
@@ -28,12 +28,57 @@ inline bool LeastSignificant(pw_varint_Format format) {
   return (static_cast<unsigned>(format) & 0b01) == 0;
 }
 
+// Encodes a standard (protobuf) LEB128 varint. The size is computed up front,
+// so the loop writes each byte without checking for the end of the buffer.
+size_t EncodeStandard(uint64_t input, std::byte* output, size_t output_size) {
+  const size_t size = EncodedSize(input);
+  if (size > output_size) {
+    return 0;
+  }
+
+  for (size_t i = 0; i < size - 1; ++i) {
+    output[i] = static_cast<std::byte>(input | 0x80u);
+    input >>= 7;
+  }
+  output[size - 1] = static_cast<std::byte>(input);
+  return size;
+}
+
+// Decodes a standard (protobuf) LEB128 varint. When kCheckSize is false, the
+// input must have at least kMaxVarint64SizeBytes bytes. Since the loop bound is
+// a constant, the compiler can fully unroll it.
+template <bool kCheckSize>
+size_t DecodeStandard(const uint8_t* input,
+                      size_t input_size,
+                      uint64_t* output) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < kMaxVarint64SizeBytes; ++i) {
+    if constexpr (kCheckSize) {
+      if (i == input_size) {
+        return 0;
+      }
+    }
+
+    const uint64_t byte = input[i];
+    value |= (byte & 0x7fu) << (7 * i);
+    if (byte < 0x80u) {
+      *output = value;
+      return i + 1;
+    }
+  }
+  return 0;  // The varint is more than 10 bytes long.
+}
+
 }  // namespace
 
 extern "C" size_t pw_varint_EncodeCustom(uint64_t input,
                                          void* output,
                                          size_t output_size,
                                          pw_varint_Format format) {
+  if (format == PW_VARINT_ZERO_TERMINATED_MOST_SIGNIFICANT) {
+    return EncodeStandard(input, static_cast<std::byte*>(output), output_size);
+  }
+
   size_t written = 0;
   std::byte* buffer = static_cast<std::byte*>(output);
 
@@ -77,6 +122,14 @@ extern "C" size_t pw_varint_DecodeCustom(const void* input,
                                          size_t input_size,
                                          uint64_t* output,
                                          pw_varint_Format format) {
+  if (format == PW_VARINT_ZERO_TERMINATED_MOST_SIGNIFICANT) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(input);
+    if (input_size >= kMaxVarint64SizeBytes) {
+      return DecodeStandard<false>(bytes, input_size, output);
+    }
+    return DecodeStandard<true>(bytes, input_size, output);
+  }
+
   uint64_t decoded_value = 0;
   uint_fast8_t count = 0;
   const std::byte* buffer = static_cast<const std::byte*>(input);
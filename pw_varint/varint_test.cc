@@ -1062,6 +1062,73 @@ constexpr uint64_t CalculateMaxValueInBytes(size_t bytes) {
   return value;
 }
 
+TEST(Varint, EncodeDecode_AllSizes) {
+  for (size_t bits = 0; bits <= 64; ++bits) {
+    const uint64_t value =
+        bits == 64 ? std::numeric_limits<uint64_t>::max()
+                   : (uint64_t(1) << bits) - 1;
+    const size_t size = EncodedSize(value);
+
+    // Buffers of at least 10 bytes are decoded without checking the size.
+    std::byte large[16] = {};
+    ASSERT_EQ(size, Encode(value, large));
+
+    uint64_t decoded = 0;
+    EXPECT_EQ(size, Decode(large, &decoded));
+    EXPECT_EQ(value, decoded);
+
+    // Decode from a buffer exactly the size of the varint.
+    decoded = 0;
+    EXPECT_EQ(size, Decode(std::span(large).first(size), &decoded));
+    EXPECT_EQ(value, decoded);
+
+    // The generic decoder must agree with the standard format fast path.
+    decoded = 0;
+    EXPECT_EQ(size,
+              Decode(std::span(large).first(size),
+                     &decoded,
+                     Format::kZeroTerminatedMostSignificant));
+    EXPECT_EQ(value, decoded);
+
+    // Encoding fails if the buffer is one byte too small.
+    EXPECT_EQ(0u, Encode(value, std::span(large).first(size - 1)));
+
+    // Decoding fails if the varint is truncated.
+    EXPECT_EQ(0u, Decode(std::span(large).first(size - 1), &decoded));
+  }
+}
+
+TEST(Varint, Decode_TooLong) {
+  std::byte too_long[16];
+  std::memset(too_long, 0x80, sizeof(too_long));
+
+  uint64_t value = 0;
+  EXPECT_EQ(0u, Decode(too_long, &value));
+  EXPECT_EQ(0u, Decode(std::span(too_long).first(10), &value));
+}
+
+TEST(Varint, EncodePadded_DecodesToSameValue) {
+  for (size_t size = 1; size <= kMaxVarint64SizeBytes; ++size) {
+    for (uint64_t value : {uint64_t{0}, uint64_t{1}, MaxValueInBytes(size)}) {
+      std::byte buffer[kMaxVarint64SizeBytes] = {};
+      ASSERT_EQ(size, EncodePadded(value, std::span(buffer).first(size)));
+
+      uint64_t decoded = 0;
+      EXPECT_EQ(size, Decode(std::span(buffer).first(size), &decoded));
+      EXPECT_EQ(value, decoded);
+    }
+  }
+}
+
+TEST(Varint, EncodePadded_DoesNotFit_ReturnsZero) {
+  std::byte buffer[kMaxVarint64SizeBytes + 1] = {};
+  EXPECT_EQ(0u, EncodePadded(0, std::span(buffer).first(0)));
+  EXPECT_EQ(0u, EncodePadded(128, std::span(buffer).first(1)));
+  EXPECT_EQ(0u, EncodePadded(MaxValueInBytes(3) + 1,
+                             std::span(buffer).first(3)));
+  EXPECT_EQ(0u, EncodePadded(1, buffer));
+}
+
 TEST(Varint, MaxValueInBytes) {
   static_assert(MaxValueInBytes(0) == 0);
   static_assert(MaxValueInBytes(1) == 0x7f);
@@ -12,6 +12,7 @@
 // License for the specific language governing permissions and limitations under
 // the License.
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 
@@ -28,45 +29,111 @@ namespace {
 constexpr size_t kMaxTransmissionUnit = 256;
 constexpr uint16_t kSocketPort = 33000;
 
-stream::SocketStream socket_stream;
-sync::Mutex channel_output_mutex;
-rpc::SynchronizedChannelOutput<
-    hdlc::RpcChannelOutputBuffer<kMaxTransmissionUnit>>
-    hdlc_channel_output(channel_output_mutex,
-                        socket_stream,
-                        hdlc::kDefaultRpcAddress,
-                        "HDLC channel");
-Channel channels[] = {rpc::Channel::Create<1>(&hdlc_channel_output)};
+// Each client connection slot has its own RPC channel: responses to packets
+// from the client in slot i go out on channel i + 1. The first client to
+// connect takes slot 0, so single-client tools that use channel 1 work
+// unchanged; additional clients must use their slot's channel ID.
+constexpr size_t kMaxClients = 8;
+
+// How long Start() waits for input before checking for new clients.
+constexpr int kPollTimeoutMs = 100;
+
+struct Connection {
+  Connection()
+      : output(mutex, stream, hdlc::kDefaultRpcAddress, "HDLC channel") {}
+
+  stream::SocketStream stream;
+  sync::Mutex mutex;
+  rpc::SynchronizedChannelOutput<
+      hdlc::RpcChannelOutputBuffer<kMaxTransmissionUnit>>
+      output;
+  hdlc::DecoderBuffer<kMaxTransmissionUnit> decoder;
+};
+
+stream::SocketServer socket_server;
+std::array<Connection, kMaxClients> connections;
+Channel channels[kMaxClients];
 rpc::Server server(channels);
 
+void Disconnect(Connection& connection) {
+  connection.stream.Close();
+  connection.decoder.Clear();
+}
+
+void ProcessInput(Connection& connection) {
+  std::array<std::byte, kMaxTransmissionUnit> data;
+  auto ret_val = connection.stream.TryRead(data);
+  if (ret_val.status().IsUnavailable()) {
+    return;
+  }
+  if (!ret_val.ok()) {
+    Disconnect(connection);  // The client closed the connection.
+    return;
+  }
+  for (std::byte byte : ret_val.value()) {
+    if (auto result = connection.decoder.Process(byte); result.ok()) {
+      hdlc::Frame& frame = result.value();
+      if (frame.address() == hdlc::kDefaultRpcAddress) {
+        server.ProcessPacket(frame.data(), connection.output);
+      }
+    }
+  }
+}
+
 }  // namespace
 
 void Init() {
+  for (size_t i = 0; i < kMaxClients; ++i) {
+    channels[i].Configure(i + 1, connections[i].output);
+  }
+
+  // Logs go to the first client.
   log_basic::SetOutput([](std::string_view log) {
-    hdlc::WriteUIFrame(1, std::as_bytes(std::span(log)), socket_stream);
+    hdlc::WriteUIFrame(
+        1, std::as_bytes(std::span(log)), connections[0].stream);
   });
 
-  socket_stream.Serve(kSocketPort);
+  socket_server.Listen(kSocketPort).IgnoreError();
+  socket_server.Accept(connections[0].stream).IgnoreError();
 }
 
 rpc::Server& Server() { return server; }
 
 Status Start() {
-  // Declare a buffer for decoding incoming HDLC frames.
-  std::array<std::byte, kMaxTransmissionUnit> input_buffer;
-  hdlc::Decoder decoder(input_buffer);
+  std::array<stream::SocketStream*, kMaxClients> streams;
+  std::array<Connection*, kMaxClients> connected;
+  std::array<bool, kMaxClients> ready;
 
   while (true) {
-    std::array<std::byte, kMaxTransmissionUnit> data;
-    auto ret_val = socket_stream.Read(data);
-    if (ret_val.ok()) {
-      for (std::byte byte : ret_val.value()) {
-        if (auto result = decoder.Process(byte); result.ok()) {
-          hdlc::Frame& frame = result.value();
-          if (frame.address() == hdlc::kDefaultRpcAddress) {
-            server.ProcessPacket(frame.data(), hdlc_channel_output);
-          }
-        }
+    size_t count = 0;
+    for (Connection& connection : connections) {
+      if (!connection.stream.connected()) {
+        socket_server.Accept(connection.stream, 0).IgnoreError();
+      }
+      if (connection.stream.connected()) {
+        streams[count] = &connection.stream;
+        connected[count] = &connection;
+        count += 1;
+      }
+    }
+
+    if (count == 0u) {
+      // Block until a client connects rather than spinning.
+      socket_server.Accept(connections[0].stream).IgnoreError();
+      continue;
+    }
+
+    const StatusWithSize polled =
+        stream::SocketStream::Poll(std::span(streams).first(count),
+                                   stream::SocketStream::Readiness::kReadable,
+                                   ready,
+                                   kPollTimeoutMs);
+    if (!polled.ok()) {
+      continue;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      if (ready[i]) {
+        ProcessInput(*connected[i]);
       }
     }
   }
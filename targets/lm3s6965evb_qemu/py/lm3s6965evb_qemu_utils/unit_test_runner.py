@@ -17,6 +17,7 @@
 import argparse
 import subprocess
 import sys
+from typing import Optional
 
 _TARGET_QEMU_COMMAND = 'qemu-system-arm'
 _TESTS_STARTING_STRING = b'[==========] Running all tests.'
@@ -39,15 +40,22 @@ def parse_args():
     """Parses command-line arguments."""
     parser = argparse.ArgumentParser(description=__doc__)
     parser.add_argument('binary', help='The target test binary to run')
+    parser.add_argument(
+        '--icount-shift',
+        type=int,
+        help=('Advance the virtual clock by 2^N ns per instruction, rather '
+              'than with the host clock, so that timing is repeatable'))
     return parser.parse_args()
 
 
-def launch_tests(binary: str) -> int:
+def launch_tests(binary: str, icount_shift: Optional[int] = None) -> int:
     """Start a process that runs test on binary."""
     cmd = [
         _TARGET_QEMU_COMMAND, '-cpu', 'cortex-m3', '-machine', 'lm3s6965evb',
         '-nographic', '-no-reboot', '-kernel', binary
     ]
+    if icount_shift is not None:
+        cmd.extend(['-icount', f'shift={icount_shift}'])
     test_process = subprocess.run(cmd, stdout=subprocess.PIPE)
     print(test_process.stdout.decode('utf-8'))
     return handle_test_results(test_process.stdout)
@@ -56,7 +64,7 @@ def launch_tests(binary: str) -> int:
 def main():
     """Set up runner."""
     args = parse_args()
-    return launch_tests(args.binary)
+    return launch_tests(args.binary, args.icount_shift)
 
 
 if __name__ == '__main__':
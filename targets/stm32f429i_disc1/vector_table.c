@@ -15,6 +15,7 @@
 #include <stdbool.h>
 
 #include "pw_boot_armv7m/boot.h"
+#include "pw_sys_io_baremetal_stm32f429/init.h"
 
 // Default handler to insert into the ARMv7-M vector table (below).
 // This function exists for convenience. If a device isn't doing what you
@@ -54,4 +55,9 @@ const InterruptHandler vector_table[] = {
     [2] = DefaultFaultHandler,
     // HardFault handler.
     [3] = DefaultFaultHandler,
+
+    // External interrupts start at entry 16. DMA2 streams 2 and 7 carry
+    // pw_sys_io reads and writes on USART1.
+    [16 + 58] = DMA2_Stream2_IRQHandler,
+    [16 + 70] = DMA2_Stream7_IRQHandler,
 };